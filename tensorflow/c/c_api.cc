@@ -68,6 +68,7 @@ limitations under the License.
 #include "tensorflow/core/platform/strcat.h"
 #include "tensorflow/core/platform/stringpiece.h"
 #include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/threadpool_options.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/public/session.h"
 #include "tensorflow/core/public/version.h"
@@ -2434,6 +2435,104 @@ void TF_DeletePRunHandle(const char* handle) {
   // TODO(suharshs): Free up any resources held by the partial run state.
 }
 
+TF_SessionCallable* TF_SessionMakeCallable(
+    TF_Session* session, const TF_Output* inputs, int ninputs,
+    const TF_Output* outputs, int noutputs,
+    const TF_Operation* const* target_opers, int ntargets, TF_Status* status) {
+  if (session->extend_before_run &&
+      !ExtendSessionGraphHelper(session, status)) {
+    return nullptr;
+  }
+
+  tensorflow::CallableOptions options;
+  for (int i = 0; i < ninputs; ++i) {
+    options.add_feed(OutputName(inputs[i]));
+  }
+  for (int i = 0; i < noutputs; ++i) {
+    options.add_fetch(OutputName(outputs[i]));
+  }
+  for (int i = 0; i < ntargets; ++i) {
+    options.add_target(target_opers[i]->node.name());
+  }
+
+  Session::CallableHandle handle;
+  status->status = session->session->MakeCallable(options, &handle);
+  if (!status->status.ok()) return nullptr;
+  return new TF_SessionCallable{handle, ninputs, noutputs};
+}
+
+static bool TF_Callable_Inputs(const TF_SessionCallable* callable,
+                               TF_Tensor* const* input_values,
+                               std::vector<Tensor>* inputs, TF_Status* status) {
+  inputs->resize(callable->ninputs);
+  for (int i = 0; i < callable->ninputs; ++i) {
+    status->status = TF_TensorToTensorV1(input_values[i], &(*inputs)[i]);
+    if (!status->status.ok()) return false;
+  }
+  return true;
+}
+
+void TF_SessionRunCallable(TF_Session* session, TF_SessionCallable* callable,
+                           TF_Tensor* const* input_values,
+                           TF_Tensor** output_values, TF_Status* status) {
+  std::vector<Tensor> inputs;
+  if (!TF_Callable_Inputs(callable, input_values, &inputs, status)) return;
+
+  std::vector<Tensor> outputs;
+  status->status = session->session->RunCallable(callable->handle, inputs,
+                                                 &outputs, nullptr);
+  if (!status->status.ok()) return;
+
+  for (int i = 0; i < callable->noutputs; ++i) {
+    const Tensor& src = outputs[i];
+    TF_Tensor* value;
+    if (!src.IsInitialized() || src.NumElements() == 0) {
+      value = EmptyTensor(static_cast<TF_DataType>(src.dtype()), src.shape());
+    } else if (output_values[i] == nullptr) {
+      value = TF_TensorFromTensor(src, &status->status);
+      if (!status->status.ok()) return;
+    } else {
+      // Reuse the caller's TF_Tensor instead of allocating a new one.
+      tensorflow::TensorFromInterface(output_values[i]->tensor) = src;
+      continue;
+    }
+
+    if (output_values[i] == nullptr) {
+      output_values[i] = value;
+    } else {
+      tensorflow::TensorFromInterface(output_values[i]->tensor) =
+          tensorflow::TensorFromInterface(value->tensor);
+      TF_DeleteTensor(value);
+    }
+  }
+}
+
+void TF_SessionRunCallableWithOutputBuffers(TF_Session* session,
+                                            TF_SessionCallable* callable,
+                                            TF_Tensor* const* input_values,
+                                            TF_Tensor* const* output_buffers,
+                                            TF_Status* status) {
+  std::vector<Tensor> inputs;
+  if (!TF_Callable_Inputs(callable, input_values, &inputs, status)) return;
+
+  // The tensors share the buffers of `output_buffers`.
+  std::vector<Tensor> outputs(callable->noutputs);
+  for (int i = 0; i < callable->noutputs; ++i) {
+    status->status = TF_TensorToTensor(output_buffers[i], &outputs[i]);
+    if (!status->status.ok()) return;
+  }
+  status->status = session->session->RunCallableWithFetchBuffers(
+      callable->handle, inputs, absl::MakeSpan(outputs), nullptr,
+      tensorflow::thread::ThreadPoolOptions());
+}
+
+void TF_SessionReleaseCallable(TF_Session* session,
+                               TF_SessionCallable* callable,
+                               TF_Status* status) {
+  status->status = session->session->ReleaseCallable(callable->handle);
+  delete callable;
+}
+
 void TF_SessionPRun(TF_Session* session, const char* handle,
                     const TF_Output* inputs, TF_Tensor* const* input_values,
                     int ninputs, const TF_Output* outputs,
@@ -1359,6 +1359,59 @@ TF_CAPI_EXPORT extern void TF_SessionPRun(
 // Once called, no more calls to TF_SessionPRun should be made.
 TF_CAPI_EXPORT extern void TF_DeletePRunHandle(const char* handle);
 
+// A subgraph of a session's graph, with fixed feeds (inputs), fetches
+// (outputs) and targets, that can be run repeatedly with less per-call work
+// than TF_SessionRun: the subgraph is looked up once, when the callable is
+// made, instead of from the names of the feeds and fetches on each run.
+typedef struct TF_SessionCallable TF_SessionCallable;
+
+// Makes a callable that runs `session` with the given feeds, fetches and
+// targets. The callable must be released with TF_SessionReleaseCallable.
+//
+// NOTE: This API is experimental and may change.
+TF_CAPI_EXPORT extern TF_SessionCallable* TF_SessionMakeCallable(
+    TF_Session* session,
+    // Input names
+    const TF_Output* inputs, int ninputs,
+    // Output names
+    const TF_Output* outputs, int noutputs,
+    // Target operations
+    const TF_Operation* const* target_opers, int ntargets,
+    // Output status
+    TF_Status* status);
+
+// Runs `callable` with `input_values`, one per input of the callable, and
+// stores the values of its outputs in `output_values`, one per output.
+//
+// Unlike TF_SessionRun, `output_values` may be reused across calls: a NULL
+// element receives a new TF_Tensor that the caller must eventually delete with
+// TF_DeleteTensor, and a non-NULL element must be a tensor returned by an
+// earlier call, whose value is replaced in place.
+//
+// NOTE: This API is experimental and may change.
+TF_CAPI_EXPORT extern void TF_SessionRunCallable(
+    TF_Session* session, TF_SessionCallable* callable,
+    TF_Tensor* const* input_values, TF_Tensor** output_values,
+    TF_Status* status);
+
+// Like TF_SessionRunCallable, but writes the values of the outputs into the
+// caller-allocated `output_buffers`, one per output, which must have the type
+// and shape of the output. The tensors can adopt caller memory, e.g. through
+// TF_NewTensor with a custom deallocator. Where possible, the kernels on a CPU
+// device then produce their outputs directly in that memory; otherwise, the
+// values are copied into it. Types that can't be copied with memcpy, e.g.
+// TF_STRING, are not supported.
+//
+// NOTE: This API is experimental and may change.
+TF_CAPI_EXPORT extern void TF_SessionRunCallableWithOutputBuffers(
+    TF_Session* session, TF_SessionCallable* callable,
+    TF_Tensor* const* input_values, TF_Tensor* const* output_buffers,
+    TF_Status* status);
+
+// Releases `callable`, which must not be used afterwards.
+TF_CAPI_EXPORT extern void TF_SessionReleaseCallable(
+    TF_Session* session, TF_SessionCallable* callable, TF_Status* status);
+
 // --------------------------------------------------------------------------
 // The deprecated session API.  Please switch to the above instead of
 // TF_ExtendGraph(). This deprecated API can be removed at any time without
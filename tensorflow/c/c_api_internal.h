@@ -58,6 +58,12 @@ struct TF_SessionOptions {
   tensorflow::SessionOptions options;
 };
 
+struct TF_SessionCallable {
+  tensorflow::Session::CallableHandle handle;
+  int ninputs;
+  int noutputs;
+};
+
 struct TF_DeprecatedSession {
   tensorflow::Session* session;
 };
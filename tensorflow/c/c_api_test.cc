@@ -1165,6 +1165,71 @@ TEST(CAPI, SessionPRun) {
   TF_DeleteStatus(s);
 }
 
+TEST(CAPI, SessionCallable) {
+  TF_Status* s = TF_NewStatus();
+  TF_Graph* graph = TF_NewGraph();
+
+  // Construct the graph: A + 2
+  TF_Operation* a = Placeholder(graph, s, "A");
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  TF_Operation* two = ScalarConst(2, graph, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  TF_Operation* plus2 = Add(a, two, graph, s, "plus2");
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+
+  TF_SessionOptions* opts = TF_NewSessionOptions();
+  TF_Session* sess = TF_NewSession(graph, opts, s);
+  TF_DeleteSessionOptions(opts);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+
+  TF_Output feeds[] = {TF_Output{a, 0}};
+  TF_Output fetches[] = {TF_Output{plus2, 0}};
+  TF_SessionCallable* callable =
+      TF_SessionMakeCallable(sess, feeds, 1, fetches, 1, nullptr, 0, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+
+  // The output tensor is reused by the second run.
+  TF_Tensor* feed_values[] = {Int32Tensor(1)};
+  TF_Tensor* fetch_values[] = {nullptr};
+  TF_SessionRunCallable(sess, callable, feed_values, fetch_values, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  EXPECT_EQ(3, *(static_cast<int32*>(TF_TensorData(fetch_values[0]))));
+  TF_Tensor* fetch_value = fetch_values[0];
+  TF_DeleteTensor(feed_values[0]);
+
+  feed_values[0] = Int32Tensor(5);
+  TF_SessionRunCallable(sess, callable, feed_values, fetch_values, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  EXPECT_EQ(fetch_value, fetch_values[0]);
+  EXPECT_EQ(7, *(static_cast<int32*>(TF_TensorData(fetch_values[0]))));
+  TF_DeleteTensor(fetch_values[0]);
+
+  // Write the output into caller memory.
+  alignas(EIGEN_MAX_ALIGN_BYTES) int32 result = 0;
+  bool deallocator_called = false;
+  auto mark_deallocated = [](void*, size_t, void* arg) {
+    *static_cast<bool*>(arg) = true;
+  };
+  TF_Tensor* output_buffers[] = {TF_NewTensor(TF_INT32, nullptr, 0, &result,
+                                               sizeof(result), mark_deallocated,
+                                               &deallocator_called)};
+  TF_SessionRunCallableWithOutputBuffers(sess, callable, feed_values,
+                                         output_buffers, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  EXPECT_EQ(7, result);
+  TF_DeleteTensor(output_buffers[0]);
+  EXPECT_TRUE(deallocator_called);
+  TF_DeleteTensor(feed_values[0]);
+
+  // Clean up.
+  TF_SessionReleaseCallable(sess, callable, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  TF_DeleteSession(sess, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  TF_DeleteGraph(graph);
+  TF_DeleteStatus(s);
+}
+
 TEST(CAPI, ShapeInferenceError) {
   // TF_FinishOperation should fail if the shape of the added operation cannot
   // be inferred.
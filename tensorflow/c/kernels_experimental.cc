@@ -51,7 +51,8 @@ struct TF_VariableInputLockHolder {
   std::unique_ptr<std::vector<tensorflow::tf_shared_lock>> shared_locks;
 };
 
-tensorflow::Status EnsureSparseVariableAccess(
+// Requires an exclusive lock on `var->mu()`.
+tensorflow::Status EnsureSparseVariableAccessLocked(
     TF_OpKernelContext* ctx, bool variantType,
     void (*copyFunc)(TF_OpKernelContext* ctx, TF_Tensor* source,
                      TF_Tensor* dest),
@@ -60,7 +61,6 @@ tensorflow::Status EnsureSparseVariableAccess(
   if (var->copy_on_read_mode.load()) {
     return Status::OK();
   }
-  mutex_lock ml(*var->mu());
   // Once copy-on-read mode is True the refcount is guaranteed to be 1. This can
   // also happen if there are no concurrent reads of the variable and
   // copy-on-read mode is false.
@@ -96,6 +96,18 @@ tensorflow::Status EnsureSparseVariableAccess(
   return Status::OK();
 }
 
+tensorflow::Status EnsureSparseVariableAccess(
+    TF_OpKernelContext* ctx, bool variantType,
+    void (*copyFunc)(TF_OpKernelContext* ctx, TF_Tensor* source,
+                     TF_Tensor* dest),
+    tensorflow::Var* var) {
+  if (var->copy_on_read_mode.load()) {
+    return Status::OK();
+  }
+  mutex_lock ml(*var->mu());
+  return EnsureSparseVariableAccessLocked(ctx, variantType, copyFunc, var);
+}
+
 tensorflow::Status PrepareToUpdateVariable(
     TF_OpKernelContext* ctx, tensorflow::Tensor* tensor, bool copy_on_read_mode,
     bool variantType,
@@ -273,6 +285,7 @@ void TF_MaybeLockVariableInputMutexesInOrder(
       absl::make_unique<std::vector<tensorflow::tf_shared_lock>>();
   locks->reserve(acquire_order.size());
 
+  std::vector<tensorflow::mutex*> acquired;
   for (auto input : acquire_order) {
     tensorflow::Var* var;
     tensorflow::mutex* mu =
@@ -284,6 +297,24 @@ void TF_MaybeLockVariableInputMutexesInOrder(
       } else {
         shared_locks->emplace_back(*mu);
       }
+      acquired.push_back(mu);
+    }
+  }
+  // A dense read may have switched a variable back to copy-on-write mode
+  // before its shared lock was acquired, in which case the variables are
+  // locked exclusively instead and switched to copy-on-read mode again.
+  if (sparse && !do_lock &&
+      !std::all_of(vars.begin(), vars.end(), [](tensorflow::Var* var) {
+        return var->copy_on_read_mode.load();
+      })) {
+    shared_locks->clear();
+    for (tensorflow::mutex* mu : acquired) {
+      locks->emplace_back(*mu);
+    }
+  }
+  if (sparse && !locks->empty()) {
+    for (tensorflow::Var* var : vars) {
+      TF_CHECK_OK(EnsureSparseVariableAccessLocked(ctx, false, copyFunc, var));
     }
   }
   *lockHolder = new TF_VariableInputLockHolder(
@@ -0,0 +1,284 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/cc/saved_model/lazy_restore.h"
+
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/resource_handle.h"
+#include "tensorflow/core/framework/resource_var.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/tensor_id.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/util/saved_tensor_slice_util.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
+
+namespace tensorflow {
+namespace internal {
+namespace {
+
+// A resource variable assigned from an output of a RestoreV2 op.
+struct RestoredVariable {
+  // The VarHandleOp node producing the handle of the variable.
+  string handle_node;
+  DataType dtype;
+  // The tensor to restore, as passed to RestoreV2.
+  string tensor_name;
+  string shape_and_slice;
+};
+
+// The checkpoint read by the lazy loaders of all variables of a SavedModel.
+// BundleReader is not thread-safe, so reads are serialized.
+class LazyCheckpoint {
+ public:
+  explicit LazyCheckpoint(const string& prefix)
+      : reader_(Env::Default(), prefix) {}
+
+  Status status() const { return reader_.status(); }
+  BundleReader* reader() { return &reader_; }
+
+  // Reads "variable" into "*tensor", allocated with "allocator".
+  Status Read(const RestoredVariable& variable, Allocator* allocator,
+              Tensor* tensor) {
+    mutex_lock l(mu_);
+    TensorShape full_shape;
+    TF_RETURN_IF_ERROR(
+        reader_.LookupTensorShape(variable.tensor_name, &full_shape));
+    if (variable.shape_and_slice.empty()) {
+      *tensor = Tensor(allocator, variable.dtype, full_shape);
+      return reader_.Lookup(variable.tensor_name, tensor);
+    }
+    TensorShape parsed_full_shape;
+    TensorSlice slice;
+    TensorShape slice_shape;
+    TF_RETURN_IF_ERROR(checkpoint::ParseShapeAndSlice(
+        variable.shape_and_slice, &parsed_full_shape, &slice, &slice_shape));
+    if (!full_shape.IsSameSize(parsed_full_shape)) {
+      return errors::InvalidArgument(
+          "tensor_name = ", variable.tensor_name,
+          "; shape in shape_and_slice spec ", parsed_full_shape.DebugString(),
+          " does not match the shape stored in checkpoint: ",
+          full_shape.DebugString());
+    }
+    *tensor = Tensor(allocator, variable.dtype, slice_shape);
+    return reader_.LookupSlice(variable.tensor_name, slice, tensor);
+  }
+
+ private:
+  mutex mu_;
+  BundleReader reader_ TF_GUARDED_BY(mu_);
+};
+
+// Returns the node producing "input" of a node, looking through Identity ops,
+// and sets "*index" to the output of that node.  Returns nullptr if a node is
+// missing.
+const NodeDef* ResolveInput(
+    const std::unordered_map<StringPiece, const NodeDef*, StringPieceHasher>&
+        nodes,
+    const string& input, int* index) {
+  TensorId id = ParseTensorName(input);
+  while (true) {
+    auto it = nodes.find(id.node());
+    if (it == nodes.end()) return nullptr;
+    const NodeDef* node = it->second;
+    if (node->op() != "Identity" || node->input_size() < 1) {
+      *index = id.index();
+      return node;
+    }
+    id = ParseTensorName(node->input(0));
+  }
+}
+
+// Returns element "index" of the string Const "node" in "*value".
+bool GetConstString(const NodeDef* node, int index, string* value) {
+  if (node == nullptr || node->op() != "Const") return false;
+  Tensor tensor;
+  const AttrValue* attr = AttrSlice(*node).Find("value");
+  if (attr == nullptr || !tensor.FromProto(attr->tensor()) ||
+      tensor.dtype() != DT_STRING || index < 0 ||
+      index >= tensor.NumElements()) {
+    return false;
+  }
+  *value = tensor.flat<tstring>()(index);
+  return true;
+}
+
+// Collects the variables assigned by the restore op "restore_op_name" into
+// "*variables".  Returns false if the restore op does anything else.
+bool CollectRestoredVariables(const GraphDef& graph_def,
+                              const string& restore_op_name,
+                              std::vector<RestoredVariable>* variables) {
+  std::unordered_map<StringPiece, const NodeDef*, StringPieceHasher> nodes;
+  for (const NodeDef& node : graph_def.node()) {
+    nodes[node.name()] = &node;
+  }
+  std::vector<string> stack = {restore_op_name};
+  std::unordered_set<string> visited;
+  while (!stack.empty()) {
+    const string name(ParseTensorName(stack.back()).node());
+    stack.pop_back();
+    if (!visited.insert(name).second) continue;
+    auto it = nodes.find(name);
+    if (it == nodes.end()) return false;
+    const NodeDef* node = it->second;
+
+    if (node->op() == "NoOp") {
+      stack.insert(stack.end(), node->input().begin(), node->input().end());
+      continue;
+    }
+    if (node->op() != "AssignVariableOp" || node->input_size() < 2) {
+      VLOG(1) << "Restore op " << restore_op_name << " runs " << node->name()
+              << " (" << node->op() << ")";
+      return false;
+    }
+    RestoredVariable variable;
+    int handle_index, restore_index;
+    const NodeDef* handle = ResolveInput(nodes, node->input(0), &handle_index);
+    const NodeDef* restore =
+        ResolveInput(nodes, node->input(1), &restore_index);
+    if (handle == nullptr || handle->op() != "VarHandleOp" ||
+        restore == nullptr || restore->op() != "RestoreV2" ||
+        restore->input_size() < 3 ||
+        !GetNodeAttr(*node, "dtype", &variable.dtype).ok()) {
+      return false;
+    }
+    int unused_index;
+    if (!GetConstString(ResolveInput(nodes, restore->input(1), &unused_index),
+                        restore_index, &variable.tensor_name) ||
+        !GetConstString(ResolveInput(nodes, restore->input(2), &unused_index),
+                        restore_index, &variable.shape_and_slice)) {
+      return false;
+    }
+    variable.handle_node = handle->name();
+    variables->push_back(std::move(variable));
+    // Control dependencies of the assignment.
+    for (int i = 2; i < node->input_size(); ++i) {
+      stack.push_back(node->input(i));
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+Status RestoreVariablesLazily(const RunOptions& run_options,
+                              const MetaGraphDef& meta_graph,
+                              const string& variables_path, Session* session,
+                              bool* restored) {
+  *restored = false;
+  std::vector<RestoredVariable> variables;
+  if (!CollectRestoredVariables(meta_graph.graph_def(),
+                                meta_graph.saver_def().restore_op_name(),
+                                &variables)) {
+    LOG(INFO) << "The restore op restores more than resource variables; "
+                 "restoring the variables eagerly.";
+    return Status::OK();
+  }
+  const DeviceMgr* device_mgr;
+  if (!session->LocalDeviceManager(&device_mgr).ok()) {
+    LOG(INFO) << "The session does not expose its devices; restoring the "
+                 "variables eagerly.";
+    return Status::OK();
+  }
+
+  // Creates the handles of the variables to find their resource managers.
+  std::vector<string> handle_names;
+  handle_names.reserve(variables.size());
+  for (const RestoredVariable& variable : variables) {
+    handle_names.push_back(variable.handle_node);
+  }
+  std::vector<Tensor> handle_tensors;
+  RunMetadata run_metadata;
+  TF_RETURN_IF_ERROR(session->Run(run_options, {}, handle_names, {},
+                                  &handle_tensors, &run_metadata));
+  std::vector<ResourceHandle> handles;
+  std::vector<Device*> devices;
+  for (const Tensor& handle_tensor : handle_tensors) {
+    const ResourceHandle& handle = handle_tensor.scalar<ResourceHandle>()();
+    Device* device;
+    TF_RETURN_IF_ERROR(device_mgr->LookupDevice(handle.device(), &device));
+    if (device->device_type() != DEVICE_CPU) {
+      LOG(INFO) << "Variable " << handle.name() << " is placed on "
+                << handle.device() << "; restoring the variables eagerly.";
+      return Status::OK();
+    }
+    handles.push_back(handle);
+    devices.push_back(device);
+  }
+
+  auto checkpoint = std::make_shared<LazyCheckpoint>(variables_path);
+  TF_RETURN_IF_ERROR(checkpoint->status());
+  // Only the index is read here, so missing tensors fail the load rather than
+  // the first read.
+  std::vector<int> order(variables.size());
+  for (int i = 0; i < variables.size(); ++i) {
+    order[i] = i;
+    DataType dtype;
+    TensorShape shape;
+    TF_RETURN_IF_ERROR(checkpoint->reader()->LookupDtypeAndShape(
+        variables[i].tensor_name, &dtype, &shape));
+    if (dtype != variables[i].dtype) {
+      return errors::InvalidArgument(
+          "tensor_name = ", variables[i].tensor_name, "; expected dtype ",
+          DataTypeString(variables[i].dtype),
+          " does not equal original dtype ", DataTypeString(dtype));
+    }
+  }
+  TF_RETURN_IF_ERROR(checkpoint->reader()->SortForSequentialAccess<int>(
+      order, [&variables](const int& i) { return variables[i].tensor_name; }));
+
+  std::vector<Var*> vars;
+  for (int i : order) {
+    const RestoredVariable& variable = variables[i];
+    Var* var;
+    TF_RETURN_IF_ERROR(
+        devices[i]->resource_manager()->LookupOrCreate<Var>(
+            handles[i].container(), handles[i].name(), &var,
+            [&variable](Var** ptr) {
+              *ptr = new Var(variable.dtype);
+              return Status::OK();
+            }));
+    Allocator* allocator = devices[i]->GetAllocator(AllocatorAttributes());
+    var->SetLazyLoader([checkpoint, variable, allocator](Tensor* tensor) {
+      return checkpoint->Read(variable, allocator, tensor);
+    });
+    vars.push_back(var);
+  }
+  LOG(INFO) << "Restoring " << vars.size() << " variables lazily.";
+  // Prefetches the variables that are not read first.
+  Env::Default()->SchedClosure([vars]() {
+    for (Var* var : vars) {
+      var->LoadLazily().IgnoreError();
+      var->Unref();
+    }
+  });
+  *restored = true;
+  return Status::OK();
+}
+
+}  // namespace internal
+}  // namespace tensorflow
@@ -0,0 +1,48 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CC_SAVED_MODEL_LAZY_RESTORE_H_
+#define TENSORFLOW_CC_SAVED_MODEL_LAZY_RESTORE_H_
+
+#include <string>
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/core/protobuf/meta_graph.pb.h"
+#include "tensorflow/core/public/session.h"
+
+namespace tensorflow {
+namespace internal {
+
+// Makes the resource variables restored by the saver of "meta_graph" restore
+// themselves from the checkpoint at "variables_path" on first use, instead of
+// running the restore op: each variable, or each partition of a partitioned
+// variable, is read from the bundle when it is first accessed, and a
+// background thread prefetches the others in checkpoint order.  Load time is
+// then dominated by reading the bundle index rather than the variables.
+//
+// Only restore graphs whose RestoreV2 outputs are all assigned to resource
+// variables on CPU devices are supported.  For any other graph "*restored" is
+// set to false and the session is left unchanged, so the caller should run the
+// restore op instead.
+Status RestoreVariablesLazily(const RunOptions& run_options,
+                              const MetaGraphDef& meta_graph,
+                              const string& variables_path, Session* session,
+                              bool* restored);
+
+}  // namespace internal
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CC_SAVED_MODEL_LAZY_RESTORE_H_
@@ -18,6 +18,7 @@ limitations under the License.
 #include <unordered_set>
 
 #include "tensorflow/cc/saved_model/constants.h"
+#include "tensorflow/cc/saved_model/lazy_restore.h"
 #include "tensorflow/cc/saved_model/loader_util.h"
 #include "tensorflow/cc/saved_model/metrics.h"
 #include "tensorflow/cc/saved_model/reader.h"
@@ -39,6 +40,7 @@ limitations under the License.
 #include "tensorflow/core/protobuf/saver.pb.h"
 #include "tensorflow/core/public/session.h"
 #include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/tensor_bundle/naming.h"
 
 namespace tensorflow {
@@ -221,6 +223,7 @@ Status RunInitOp(const RunOptions& run_options, const string& export_dir,
 }
 
 Status RunRestore(const RunOptions& run_options, const string& export_dir,
+                  const MetaGraphDef& meta_graph,
                   const StringPiece restore_op_name,
                   const StringPiece variable_filename_const_op_name,
                   const std::vector<AssetFileDef>& asset_file_defs,
@@ -243,6 +246,18 @@ Status RunRestore(const RunOptions& run_options, const string& export_dir,
   const string variables_path =
       io::JoinPath(variables_directory, kSavedModelVariablesFilename);
 
+  // Servers that only touch part of a large model at first can make it
+  // available before all of its variables are read.
+  bool lazy_load_variables;
+  TF_RETURN_IF_ERROR(ReadBoolFromEnvVar("TF_SAVED_MODEL_LAZY_LOAD_VARIABLES",
+                                        false, &lazy_load_variables));
+  if (lazy_load_variables) {
+    bool restored;
+    TF_RETURN_IF_ERROR(internal::RestoreVariablesLazily(
+        run_options, meta_graph, variables_path, session, &restored));
+    if (restored) return Status::OK();
+  }
+
   // Add variables to the graph.
   Tensor variables_path_tensor(DT_STRING, TensorShape({}));
   variables_path_tensor.scalar<tstring>()() = variables_path;
@@ -276,12 +291,19 @@ Status LoadSavedModelInternal(const SessionOptions& session_options,
                               const string& export_dir,
                               const std::unordered_set<string>& tags,
                               SavedModelBundle* const bundle) {
+  const uint64 read_start_microseconds = Env::Default()->NowMicros();
   TF_RETURN_IF_ERROR(ReadMetaGraphDefFromSavedModel(export_dir, tags,
                                                     &bundle->meta_graph_def));
   TF_RETURN_IF_ERROR(
       ReadSavedModelDebugInfoIfPresent(export_dir, &bundle->debug_info));
+  load_latency_by_stage->GetCell(export_dir, "read_meta_graph")
+      ->Add(GetLatencyMicroseconds(read_start_microseconds));
+  // Record wall time spent importing the graph into the new session.
+  const uint64 session_start_microseconds = Env::Default()->NowMicros();
   TF_RETURN_IF_ERROR(LoadMetagraphIntoSession(
       session_options, bundle->meta_graph_def, &bundle->session));
+  load_latency_by_stage->GetCell(export_dir, "create_session")
+      ->Add(GetLatencyMicroseconds(session_start_microseconds));
   TF_RETURN_IF_ERROR(RestoreSession(run_options, bundle->meta_graph_def,
                                     export_dir, &bundle->session));
   return Status::OK();
@@ -429,7 +451,7 @@ Status RestoreSession(const RunOptions& run_options,
   std::vector<AssetFileDef> asset_file_defs;
   TF_RETURN_IF_ERROR(internal::GetAssetFileDefs(meta_graph, &asset_file_defs));
   if (meta_graph.has_saver_def()) {
-    TF_RETURN_IF_ERROR(RunRestore(run_options, export_dir,
+    TF_RETURN_IF_ERROR(RunRestore(run_options, export_dir, meta_graph,
                                   meta_graph.saver_def().restore_op_name(),
                                   meta_graph.saver_def().filename_tensor_name(),
                                   asset_file_defs, session->get()));
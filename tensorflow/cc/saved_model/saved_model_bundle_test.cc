@@ -13,6 +13,8 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <stdlib.h>
+
 #include "tensorflow/cc/saved_model/constants.h"
 #include "tensorflow/cc/saved_model/loader.h"
 #include "tensorflow/cc/saved_model/metrics.h"
@@ -385,5 +387,47 @@ TEST_F(LoaderTest, UpdateMetricsV1) {
   EXPECT_EQ(metrics::SavedModelReadApi(kCCLoadLabel).value(), api_count + 1);
 }
 
+TEST_F(LoaderTest, LazyLoadVariables) {
+  SessionOptions session_options;
+  RunOptions run_options;
+  const string export_dir =
+      io::JoinPath(testing::TensorFlowSrcRoot(), kTestSimpleV1Model);
+  SavedModelBundle eager_bundle;
+  TF_ASSERT_OK(LoadSavedModel(session_options, run_options, export_dir,
+                              {kSavedModelTagServe}, &eager_bundle));
+  std::vector<Tensor> eager_outputs;
+  TF_ASSERT_OK(eager_bundle.session->Run(
+      {}, {"Variable/Read/ReadVariableOp:0"}, {}, &eager_outputs));
+
+  setenv("TF_SAVED_MODEL_LAZY_LOAD_VARIABLES", "1", 1 /* overwrite */);
+  SavedModelBundle lazy_bundle;
+  const Status status = LoadSavedModel(session_options, run_options,
+                                       export_dir, {kSavedModelTagServe},
+                                       &lazy_bundle);
+  unsetenv("TF_SAVED_MODEL_LAZY_LOAD_VARIABLES");
+  TF_ASSERT_OK(status);
+  std::vector<Tensor> lazy_outputs;
+  TF_ASSERT_OK(lazy_bundle.session->Run(
+      {}, {"Variable/Read/ReadVariableOp:0"}, {}, &lazy_outputs));
+  test::ExpectEqual(eager_outputs[0], lazy_outputs[0]);
+}
+
+TEST_F(LoaderTest, LazyLoadFallsBackToRestoreOp) {
+  // The variables of this model are reference variables, which are always
+  // restored by the restore op.
+  setenv("TF_SAVED_MODEL_LAZY_LOAD_VARIABLES", "1", 1 /* overwrite */);
+  SavedModelBundle bundle;
+  SessionOptions session_options;
+  RunOptions run_options;
+  const string export_dir =
+      io::JoinPath(testing::TensorFlowSrcRoot(), kTestDataSharded);
+  const Status status = LoadSavedModel(session_options, run_options,
+                                       export_dir, {kSavedModelTagServe},
+                                       &bundle);
+  unsetenv("TF_SAVED_MODEL_LAZY_LOAD_VARIABLES");
+  TF_ASSERT_OK(status);
+  CheckSavedModelBundle(export_dir, bundle);
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -107,6 +107,12 @@ void DumpStatsToStdout(const Stats& stats) {
     printf("  %-*s %*.3f us\n", max_label_size, g.first.c_str(), max_digits + 4,
            g.second);
   }
+  if (stats.total_us > 0) {
+    const double runs = static_cast<double>(stats.runs_per_iter) * count_us;
+    printf("  Throughput: %.3f runs/s (%lld runs per iteration)\n",
+           runs * 1e6 / stats.total_us,
+           static_cast<long long>(stats.runs_per_iter));  // NOLINT
+  }
 }
 
 void Benchmark(const Options& options, const BenchmarkFn& fn, Stats* stats) {
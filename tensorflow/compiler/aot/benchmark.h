@@ -48,6 +48,7 @@ struct Options {
 struct Stats {
   std::vector<int64_t> per_iter_us;  // Per-iteration deltas in us.
   int64_t total_us;                  // Total time in us.
+  int64_t runs_per_iter = 1;         // Computation runs per iteration.
 
   Stats() : total_us(0) { per_iter_us.reserve(5000); }
 };
@@ -522,6 +522,16 @@ extern "C" void {{ENTRY}}(
 // buffers, and outputs written to result buffers. Each Run call may also use
 // a set of temporary buffers for the computation.
 //
+// Computations compiled with parallel task assignment split their large ops
+// over the threads of the pool passed to the constructor or to
+// set_thread_pool, and run them on the calling thread if there is no pool.
+// To run the computation on many independent inputs, RunMany spreads the runs
+// over the threads of a pool instead:
+//
+//   CHECK({{CLASS}}::RunMany(&pool, num_inputs,
+//       [&]({{CLASS}}* c, int64_t i) { /* ...set args of input i */ },
+//       [&]({{CLASS}}* c, int64_t i) { /* ...read results of input i */ }));
+//
 // By default each instance of this class manages its own arg, result and temp
 // buffers. The AllocMode constructor parameter may be used to modify the
 // buffer allocation strategy.
@@ -580,6 +590,35 @@ class {{CLASS}} final : public tensorflow::XlaCompiledCpuFunction {
             AllocMode::ARGS_VARIABLES_RESULTS_PROFILES_AND_TEMPS)
       : XlaCompiledCpuFunction(StaticData(), alloc_mode) {}
 
+  // Runs the computation with its parallel tasks split over the threads of
+  // `pool`.
+  explicit {{CLASS}}(
+      const Eigen::ThreadPoolDevice* pool,
+      AllocMode alloc_mode =
+          AllocMode::ARGS_VARIABLES_RESULTS_PROFILES_AND_TEMPS)
+      : XlaCompiledCpuFunction(StaticData(), alloc_mode) {
+    set_thread_pool(pool);
+  }
+
+  // Runs the computation once for each of `num_runs` inputs, spreading the
+  // runs over the threads of `pool`. See XlaCompiledCpuFunction::RunMany.
+  static bool RunMany(
+      const Eigen::ThreadPoolDevice* pool, ::int64_t num_runs,
+      const std::function<void({{CLASS}}*, ::int64_t)>& set_args,
+      const std::function<void({{CLASS}}*, ::int64_t)>& read_results) {
+    return XlaCompiledCpuFunction::RunMany(
+        pool, num_runs,
+        []() {
+          return std::unique_ptr<XlaCompiledCpuFunction>(new {{CLASS}});
+        },
+        [&set_args](XlaCompiledCpuFunction* function, ::int64_t i) {
+          set_args(static_cast<{{CLASS}}*>(function), i);
+        },
+        [&read_results](XlaCompiledCpuFunction* function, ::int64_t i) {
+          read_results(static_cast<{{CLASS}}*>(function), i);
+        });
+  }
+
   {{CLASS}}(const {{CLASS}}&) = delete;
   {{CLASS}}& operator=(const {{CLASS}}&) = delete;
 
@@ -160,6 +160,8 @@ Status CompileGraph(GraphDef graph_def, const tf2xla::Config& config,
       flags.entry_point,
       xla::cpu::CpuAotCompilationOptions::RelocationModel::BigPic);
   aot_opts.set_use_mlir_hlo_lowering(use_mlir_hlo_lowering);
+  aot_opts.set_use_parallel_task_assignment(flags.parallel_task_assignment);
+  aot_opts.set_max_parallelism(flags.max_parallelism);
 
   return CompileXla(client, computation, aot_opts, compile_result);
 }
@@ -59,6 +59,14 @@ void AppendMainFlags(std::vector<Flag>* flag_list, MainFlags* flags) {
        "Name of the generated function.  If multiple generated object files "
        "will be linked into the same binary, each will need a unique entry "
        "point."},
+      {"parallel_task_assignment", &flags->parallel_task_assignment,
+       "If set, large ops are split into tasks that run in parallel on the "
+       "thread pool set with set_thread_pool, or one after the other if no "
+       "thread pool is set."},
+      {"max_parallelism", &flags->max_parallelism,
+       "Maximum number of parallel tasks per op, used with "
+       "--parallel_task_assignment.  Defaults to the number of CPUs of the "
+       "compiling machine."},
       {"cpp_class", &flags->cpp_class,
        "Name of the generated C++ class, wrapping the generated function.  The "
        "syntax of this flag is [[<optional_namespace>::],...]<class_name>.  "
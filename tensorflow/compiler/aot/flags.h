@@ -36,6 +36,8 @@ struct MainFlags {
   string target_cpu;
   string target_features;
   string entry_point;
+  bool parallel_task_assignment = true;
+  int32 max_parallelism = 0;
   string cpp_class;
   string out_function_object;
   string out_metadata_object;
@@ -101,6 +101,27 @@ TEST(TFCompileTest, Add) {
   EXPECT_EQ(add_const.result0_data(), add_const.results()[0]);
 }
 
+TEST(TFCompileTest, Add_RunMany) {
+  constexpr int kNumRuns = 100;
+  Eigen::ThreadPool tp(4);
+  Eigen::ThreadPoolDevice device(&tp, tp.NumThreads());
+  // Without a pool, all the runs execute on the calling thread.
+  const std::vector<const Eigen::ThreadPoolDevice*> pools = {&device, nullptr};
+  for (const Eigen::ThreadPoolDevice* pool : pools) {
+    std::vector<int32> results(kNumRuns, -1);
+    EXPECT_TRUE(AddComp::RunMany(
+        pool, kNumRuns,
+        [](AddComp* add, int64_t i) {
+          add->arg0() = i;
+          add->arg1() = 2 * i;
+        },
+        [&results](AddComp* add, int64_t i) { results[i] = add->result0(); }));
+    for (int i = 0; i < kNumRuns; ++i) {
+      EXPECT_EQ(results[i], 3 * i) << i;
+    }
+  }
+}
+
 // Run tests that use set_argN_data separately, to avoid accidentally re-using
 // non-existent buffers.
 TEST(TFCompileTest, Add_SetArg) {
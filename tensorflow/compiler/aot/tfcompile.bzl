@@ -191,6 +191,11 @@ def tf_library(
 
     target_cpu = tfcompile_target_cpu()
     extra_flags = "--target_cpu=" + target_cpu + " " if target_cpu else " "
+
+    # Parallel tasks need the ParallelForkJoin runtime, which is one of the
+    # standard runtime deps.
+    if not include_standard_runtime_deps:
+        extra_flags += "--parallel_task_assignment=false "
     flags = extra_flags + flags
 
     if enable_xla_hlo_profiling:
@@ -277,6 +282,7 @@ def tf_library(
             # needed.
             "//tensorflow/compiler/xla/service/cpu:runtime_conv2d",
             "//tensorflow/compiler/xla/service/cpu:runtime_custom_call_status",
+            "//tensorflow/compiler/xla/service/cpu:runtime_fork_join",
             "//tensorflow/compiler/xla/service/cpu:runtime_key_value_sort",
             "//tensorflow/compiler/xla/service/cpu:runtime_matmul",
             "//tensorflow/compiler/xla/service/cpu:runtime_topk",
@@ -149,7 +149,26 @@ void AppendMarkForCompilationPassFlagsInternal(std::vector<Flag>* flag_list) {
       Flag("tf_xla_persistent_cache_prefix",
            &mark_for_compilation_flags->tf_xla_persistent_cache_prefix,
            "Specifies the persistance cache prefix. Default is "
-           "\"xla_compile_cache\"")};
+           "\"xla_compile_cache\""),
+      Flag("tf_xla_compilation_cache_capacity",
+           &mark_for_compilation_flags->tf_xla_compilation_cache_capacity,
+           "If positive, the maximum number of executables kept in each XLA "
+           "compile cache, beyond which the least recently used ones are "
+           "evicted. Defaults to 0, i.e. unbounded."),
+      Flag("tf_xla_clustering_cost_profile",
+           &mark_for_compilation_flags->tf_xla_clustering_cost_profile,
+           "If non-empty, the path of a CostGraphDef (e.g. the cost_graph of "
+           "a RunMetadata) with the runtimes of the graph's nodes in "
+           "TensorFlow. Clusters that are not expected to run faster with XLA "
+           "are then left to TensorFlow."),
+      Flag("tf_xla_cluster_launch_overhead_us",
+           &mark_for_compilation_flags->tf_xla_cluster_launch_overhead_us,
+           "Fixed cost in microseconds of running a cluster with XLA, used "
+           "with tf_xla_clustering_cost_profile."),
+      Flag("tf_xla_cluster_expected_speedup",
+           &mark_for_compilation_flags->tf_xla_cluster_expected_speedup,
+           "Speedup expected from compiling the profiled nodes of a cluster, "
+           "used with tf_xla_clustering_cost_profile.")};
   flag_list->insert(flag_list->end(), new_flags.begin(), new_flags.end());
 }
 
@@ -195,6 +214,10 @@ void AllocateAndParseFlags() {
   mark_for_compilation_flags->tf_xla_disable_strict_signature_checks = false;
   mark_for_compilation_flags->tf_xla_persistent_cache_prefix =
       "xla_compile_cache";
+  mark_for_compilation_flags->tf_xla_compilation_cache_capacity = 0;
+  mark_for_compilation_flags->tf_xla_clustering_cost_profile = "";
+  mark_for_compilation_flags->tf_xla_cluster_launch_overhead_us = 50;
+  mark_for_compilation_flags->tf_xla_cluster_expected_speedup = 1.5;
 
   device_flags = new XlaDeviceFlags;
   device_flags->tf_xla_compile_on_demand = false;
@@ -203,6 +226,7 @@ void AllocateAndParseFlags() {
   ops_flags = new XlaOpsCommonFlags;
   ops_flags->tf_xla_always_defer_compilation = false;
   ops_flags->tf_xla_async_compilation = false;
+  ops_flags->tf_xla_launch_elide_variable_locks = false;
 
   jitter_flags = new IntroduceFloatingPointJitterPassFlags;
   jitter_flags->jitter_amount = 1e-5;
@@ -263,6 +287,11 @@ void AllocateAndParseFlags() {
             "When lazy compilation is enabled, asynchronous compilation starts "
             "the cluster compilation in the background, and the fallback path "
             "is executed until the compilation has finished."),
+       Flag("tf_xla_launch_elide_variable_locks",
+            &ops_flags->tf_xla_launch_elide_variable_locks,
+            "If true, XlaLaunch does not lock the resource variables it reads "
+            "and writes. Only safe if no other op accesses them concurrently, "
+            "e.g. in training loops that run one step at a time."),
 
        Flag("tf_introduce_floating_point_jitter_to_tensors",
             setter_for_jitter_tensor_names, "",
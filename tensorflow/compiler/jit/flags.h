@@ -97,6 +97,26 @@ struct MarkForCompilationPassFlags {
 
   // Specifies the persistance cache prefix. Default is "xla_compile_cache"
   string tf_xla_persistent_cache_prefix;
+
+  // If positive, the maximum number of executables kept in each XLA compile
+  // cache. The least recently used ones are evicted beyond it. Defaults to 0,
+  // i.e. unbounded.
+  int64_t tf_xla_compilation_cache_capacity;
+
+  // If non-empty, the path of a CostGraphDef (binary or text) with the
+  // runtimes of the graph's nodes recorded when running them in TensorFlow.
+  // Auto-clustering then only compiles clusters that are expected to run
+  // faster with XLA, and cuts clusters at statically shaped edges where
+  // possible.
+  string tf_xla_clustering_cost_profile;
+
+  // Fixed cost, in microseconds, of compiling a cluster into an XLA launch,
+  // used with tf_xla_clustering_cost_profile.
+  int64_t tf_xla_cluster_launch_overhead_us;
+
+  // Speedup expected from compiling the profiled nodes of a cluster, used
+  // with tf_xla_clustering_cost_profile.
+  float tf_xla_cluster_expected_speedup;
 };
 
 // Flags associated with the XLA bridge's xla_device module.
@@ -119,6 +139,10 @@ struct XlaOpsCommonFlags {
   // If true, _XlaCompile compiles the cluster asynchronously with respect to
   // the main execution. The fallback path is taken while compilation happens.
   bool tf_xla_async_compilation;
+  // If true, XlaLaunch does not lock the resource variables it reads and
+  // writes.  Only safe if no other op accesses these variables concurrently,
+  // e.g. in training loops that run one step at a time.  Defaults to false.
+  bool tf_xla_launch_elide_variable_locks;
 };
 
 // Flags for the build_xla_ops pass.
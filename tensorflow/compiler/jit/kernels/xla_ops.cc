@@ -40,6 +40,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -86,10 +87,12 @@ class XlaExecutableClosure {
   explicit XlaExecutableClosure(
       xla::LocalClient* client, xla::LocalExecutable* executable,
       const XlaCompiler::CompilationResult* compilation_result,
+      XlaCompilationCache::EntryRef entry_ref,
       ResourceVarsSnapshot resource_var_snapshots, int num_constant_args)
       : client_(client),
         executable_(executable),
         compilation_result_(compilation_result),
+        entry_ref_(std::move(entry_ref)),
         resource_var_snapshots_(std::move(resource_var_snapshots)),
         num_constant_args_(num_constant_args) {}
 
@@ -110,6 +113,9 @@ class XlaExecutableClosure {
   xla::LocalClient* client_;
   xla::LocalExecutable* executable_;
   const XlaCompiler::CompilationResult* compilation_result_;
+  // Keeps `executable_` and `compilation_result_` alive if they are evicted
+  // from the compilation cache before the cluster runs.
+  XlaCompilationCache::EntryRef entry_ref_;
   ResourceVarsSnapshot resource_var_snapshots_;
   int num_constant_args_;
 
@@ -228,7 +234,8 @@ static Status CompileToLocalExecutable(
     XlaCompilationCache::CompileMode compile_mode,
     bool may_alias_resource_update, xla::LocalClient** client,
     const XlaCompiler::CompilationResult** compilation_result,
-    xla::LocalExecutable** executable) {
+    xla::LocalExecutable** executable,
+    XlaCompilationCache::EntryRef* entry_ref) {
   // We store information about the JIT-compiled XLA computation
   // in the ResourceMgr.
   ResourceMgr* rm = ctx->resource_manager();
@@ -268,7 +275,7 @@ static Status CompileToLocalExecutable(
           static_cast<Device*>(ctx->device()));
   TF_RETURN_IF_ERROR(args.status());
   return cache->Compile(options, function, *args, compile_options, compile_mode,
-                        compilation_result, executable);
+                        compilation_result, executable, entry_ref);
 }
 
 void XlaLocalLaunchBase::Compute(OpKernelContext* ctx) {
@@ -281,18 +288,23 @@ void XlaLocalLaunchBase::Compute(OpKernelContext* ctx) {
   xla::LocalClient* client;
   const XlaCompiler::CompilationResult* compilation_result;
   xla::LocalExecutable* executable;
+  XlaCompilationCache::EntryRef entry_ref;
 
   std::vector<VariableInfo> variable_infos;
   {
     OP_REQUIRES_OK(
         ctx, GetVariableInfosFromInputs(ctx->resource_manager(), ctx->device(),
                                         inputs, resources_, &variable_infos));
-    OP_REQUIRES_OK(ctx, LockVariables(absl::MakeSpan(variable_infos)));
+    if (GetXlaOpsCommonFlags().tf_xla_launch_elide_variable_locks) {
+      OP_REQUIRES_OK(ctx, ElideVariableLocks(absl::MakeSpan(variable_infos)));
+    } else {
+      OP_REQUIRES_OK(ctx, LockVariables(absl::MakeSpan(variable_infos)));
+    }
     Status s = CompileToLocalExecutable(
         ctx, function_, /*has_ref_vars=*/has_ref_vars_, platform_info_, inputs,
         variable_infos, constants_, XlaCompilationCache::CompileMode::kStrict,
         /*may_alias_resource_update=*/true, &client, &compilation_result,
-        &executable);
+        &executable, &entry_ref);
     OP_REQUIRES_OK(ctx, s);
   }
 
@@ -307,10 +319,13 @@ void XlaLocalLaunchBase::Compute(OpKernelContext* ctx) {
 
   const xla::HloInputOutputAliasConfig& input_output_alias =
       executable->executable()->module().input_output_alias_config();
+  std::shared_ptr<const InputLayouts> input_layouts =
+      GetInputLayouts(*compilation_result, entry_ref, resource_var_ptrs,
+                      input_output_alias);
   StatusOr<std::vector<xla::ExecutionInput>> execution_inputs =
       launch_context.PopulateInputs(ctx, compilation_result, resource_var_ptrs,
                                     /*missing_ctx_input_prefix=*/0,
-                                    input_output_alias);
+                                    input_output_alias, *input_layouts);
   OP_REQUIRES_OK(ctx, execution_inputs.status());
 
   // Execute the computation.
@@ -346,6 +361,38 @@ void XlaLocalLaunchBase::Compute(OpKernelContext* ctx) {
   VLOG(1) << "Done";
 }
 
+std::shared_ptr<const XlaLocalLaunchBase::InputLayouts>
+XlaLocalLaunchBase::GetInputLayouts(
+    const XlaCompiler::CompilationResult& compilation_result,
+    const XlaCompilationCache::EntryRef& entry_ref,
+    const std::map<int, const Tensor*>& resource_vars,
+    const xla::HloInputOutputAliasConfig& input_output_alias) {
+  if (entry_ref != nullptr) {
+    tf_shared_lock lock(input_layouts_mu_);
+    auto it = input_layouts_.find(&compilation_result);
+    if (it != input_layouts_.end() && !it->second.entry.expired()) {
+      return it->second.layouts;
+    }
+  }
+
+  auto layouts = std::make_shared<const InputLayouts>(
+      XlaComputationLaunchContext::ComputeInputLayouts(
+          compilation_result, resource_vars, input_output_alias));
+  if (entry_ref != nullptr) {
+    mutex_lock lock(input_layouts_mu_);
+    // Drop the layouts of evicted entries.
+    for (auto it = input_layouts_.begin(); it != input_layouts_.end();) {
+      if (it->second.entry.expired()) {
+        input_layouts_.erase(it++);
+      } else {
+        ++it;
+      }
+    }
+    input_layouts_[&compilation_result] = {entry_ref, layouts};
+  }
+  return layouts;
+}
+
 namespace {
 // Helper static functions to construct parameters for
 // XlaLocalLaunchBase constructor from OpKernelConstruction.
@@ -422,6 +469,7 @@ void XlaCompileOp::Compute(OpKernelContext* ctx) {
   xla::LocalClient* client;
   const XlaCompiler::CompilationResult* kernel;
   xla::LocalExecutable* executable;
+  XlaCompilationCache::EntryRef entry_ref;
   ResourceVarsSnapshot variables;
 
   std::vector<const Tensor*> inputs = InputsFromContext(ctx);
@@ -454,7 +502,7 @@ void XlaCompileOp::Compute(OpKernelContext* ctx) {
     Status status = CompileToLocalExecutable(
         ctx, function_, has_ref_vars_, platform_info_, inputs, variable_infos,
         constants_, compile_mode, /*may_alias_resource_update=*/false, &client,
-        &kernel, &executable);
+        &kernel, &executable, &entry_ref);
     OP_REQUIRES_OK(ctx, SnapshotResourceVariables(ctx, resources_,
                                                   variable_infos, &variables));
     if (compile_mode != XlaCompilationCache::CompileMode::kLazy ||
@@ -483,6 +531,9 @@ void XlaCompileOp::Compute(OpKernelContext* ctx) {
   // Async compilation returns nullptr executable without an error.
   if (!executable) {
     DCHECK(!must_compile_);
+    if (compile_mode == XlaCompilationCache::CompileMode::kAsync) {
+      metrics::RecordXlaAsyncCompilationFallback();
+    }
     Tensor compilation_key(cpu_allocator, DT_STRING, TensorShape({}));
 
     Tensor compilation_successful(cpu_allocator, DT_BOOL, TensorShape({}));
@@ -498,7 +549,8 @@ void XlaCompileOp::Compute(OpKernelContext* ctx) {
   // variables.
   XlaExecutableClosureStore::KeyT key =
       XlaExecutableClosureStore::Global()->Produce(XlaExecutableClosure(
-          client, executable, kernel, std::move(variables), constants_.size()));
+          client, executable, kernel, std::move(entry_ref),
+          std::move(variables), constants_.size()));
 
   Tensor compilation_key(cpu_allocator, DT_STRING, TensorShape({}));
   compilation_key.flat<tstring>()(0) = key;
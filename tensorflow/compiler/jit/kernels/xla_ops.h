@@ -17,7 +17,9 @@ limitations under the License.
 #define TENSORFLOW_COMPILER_JIT_KERNELS_XLA_OPS_H_
 
 #include <atomic>
+#include <memory>
 
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/compiler/jit/xla_compilation_cache.h"
 #include "tensorflow/compiler/jit/xla_device.h"
 #include "tensorflow/compiler/jit/xla_launch_util.h"
@@ -27,6 +29,8 @@ limitations under the License.
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/util/stream_executor_util.h"
 #include "tensorflow/stream_executor/tf_allocator_adapter.h"
 
@@ -66,6 +70,30 @@ class XlaLocalLaunchBase : public OpKernel {
   const XlaPlatformInfo platform_info_;
 
   bool has_ref_vars_;
+
+ private:
+  using InputLayouts =
+      std::vector<XlaComputationLaunchContext::InputLayout>;
+
+  // Returns the input layouts of `compilation_result`, computing them on the
+  // first run of its executable.
+  std::shared_ptr<const InputLayouts> GetInputLayouts(
+      const XlaCompiler::CompilationResult& compilation_result,
+      const XlaCompilationCache::EntryRef& entry_ref,
+      const std::map<int, const Tensor*>& resource_vars,
+      const xla::HloInputOutputAliasConfig& input_output_alias);
+
+  struct CachedInputLayouts {
+    // The compilation cache entry owning the compilation result.  The entry
+    // may be evicted, after which its compilation result's address may be
+    // reused.
+    std::weak_ptr<const void> entry;
+    std::shared_ptr<const InputLayouts> layouts;
+  };
+
+  mutex input_layouts_mu_;
+  absl::flat_hash_map<const XlaCompiler::CompilationResult*, CachedInputLayouts>
+      input_layouts_ TF_GUARDED_BY(input_layouts_mu_);
 };
 
 // XlaLocalLaunchOp is used to replace a region of the TensorFlow graph
@@ -0,0 +1,186 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/kernels/xla_ops.h"
+
+#include <memory>
+
+#include "tensorflow/compiler/jit/flags.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/resource_var.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/notification.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Long enough for XlaLaunch to compile and run the test functions.
+constexpr int64_t kLaunchTimeoutMicros = 60 * 1000 * 1000;
+
+// x * 2, for a float x.
+FunctionDef XTimesTwo() {
+  return FunctionDefHelper::Define(
+      // Name
+      "XTimesTwo",
+      // Args
+      {"x: float"},
+      // Return values
+      {"y: float"},
+      // Attr def
+      {},
+      // Nodes
+      {
+          {{"two"},
+           "Const",
+           {},
+           {{"value", test::AsScalar<float>(2.0f)}, {"dtype", DT_FLOAT}}},
+          {{"y"}, "Mul", {"x", "two"}, {{"T", DT_FLOAT}}},
+      });
+}
+
+// x * y, for a float x and a float resource variable y.
+FunctionDef XTimesY() {
+  return FunctionDefHelper::Define(
+      // Name
+      "XTimesY",
+      // Args
+      {"x: float", "y: resource"},
+      // Return values
+      {"z: float"},
+      // Attr def
+      {},
+      // Nodes
+      {
+          {{"y0"}, "ReadVariableOp", {"y"}, {{"dtype", DT_FLOAT}}},
+          {{"z"}, "Mul", {"x", "y0"}, {{"T", DT_FLOAT}}},
+      });
+}
+
+class XlaLaunchOpTest : public OpsTestBase {
+ protected:
+  // Makes an XlaLaunch op that calls `fdef` with one float argument and
+  // `num_resources` resource arguments, and returns one float.
+  void MakeLaunchOp(const FunctionDef& fdef, int num_resources) {
+    TF_ASSERT_OK(flib_def_->AddFunctionDef(fdef));
+    NameAttrList function;
+    function.set_name(fdef.signature().name());
+    TF_ASSERT_OK(NodeDefBuilder("launch", "XlaLaunch")
+                     .Input(FakeInput(DataTypeVector()))
+                     .Input(FakeInput({DT_FLOAT}))
+                     .Input(FakeInput(num_resources, DT_RESOURCE))
+                     .Attr("Tresults", {DT_FLOAT})
+                     .Attr("function", function)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+
+  // Makes a float variable holding `value` and adds it as the op's next
+  // input.
+  Var* AddVariableInput(const Tensor& value) {
+    Var* var = new Var(DT_FLOAT);
+    *var->tensor() = value;
+    var->is_initialized = true;
+    // The resource manager takes the reference that `var` is created with.
+    var->Ref();
+    AddResourceInput<Var>("", "var", var);
+    return var;
+  }
+
+  // Runs the op on another thread and notifies `done` when it returns.
+  std::unique_ptr<Thread> StartRunOpKernel(Status* status, Notification* done) {
+    return std::unique_ptr<Thread>(Env::Default()->StartThread(
+        ThreadOptions(), "launch", [this, status, done]() {
+          *status = RunOpKernel();
+          done->Notify();
+        }));
+  }
+};
+
+TEST_F(XlaLaunchOpTest, RerunsWithPreviousShapeAfterShapeChange) {
+  MakeLaunchOp(XTimesTwo(), /*num_resources=*/0);
+
+  // The third run reuses the executable, and the input layouts, of the first.
+  AddInputFromArray<float>(TensorShape({2}), {1, 2});
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorEqual<float>(*GetOutput(0), test::AsTensor<float>({2, 4}));
+
+  inputs_.clear();
+  AddInputFromArray<float>(TensorShape({3}), {1, 2, 3});
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorEqual<float>(*GetOutput(0),
+                                 test::AsTensor<float>({2, 4, 6}));
+
+  inputs_.clear();
+  AddInputFromArray<float>(TensorShape({2}), {3, 4});
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorEqual<float>(*GetOutput(0), test::AsTensor<float>({6, 8}));
+}
+
+TEST_F(XlaLaunchOpTest, WaitsForConcurrentVariableUpdate) {
+  if (GetXlaOpsCommonFlags().tf_xla_launch_elide_variable_locks) {
+    GTEST_SKIP() << "Variable locks are elided";
+  }
+  MakeLaunchOp(XTimesY(), /*num_resources=*/1);
+  AddInputFromArray<float>(TensorShape({2}), {1, 2});
+  core::RefCountPtr<Var> var(AddVariableInput(test::AsTensor<float>({2, 2})));
+
+  Status status;
+  Notification done;
+  std::unique_ptr<Thread> launch;
+  {
+    // Update the variable the way AssignVariableOp does while XlaLaunch runs.
+    mutex_lock lock(*var->mu());
+    launch = StartRunOpKernel(&status, &done);
+    EXPECT_FALSE(WaitForNotificationWithTimeout(&done, 100 * 1000));
+    *var->tensor() = test::AsTensor<float>({3, 3});
+  }
+  launch.reset();
+  TF_ASSERT_OK(status);
+  test::ExpectTensorEqual<float>(*GetOutput(0), test::AsTensor<float>({3, 6}));
+}
+
+TEST_F(XlaLaunchOpTest, ElidesVariableLockDuringConcurrentUpdate) {
+  if (!GetXlaOpsCommonFlags().tf_xla_launch_elide_variable_locks) {
+    GTEST_SKIP() << "Requires --tf_xla_launch_elide_variable_locks";
+  }
+  MakeLaunchOp(XTimesY(), /*num_resources=*/1);
+  AddInputFromArray<float>(TensorShape({2}), {1, 2});
+  core::RefCountPtr<Var> var(AddVariableInput(test::AsTensor<float>({2, 2})));
+
+  Status status;
+  Notification done;
+  std::unique_ptr<Thread> launch;
+  {
+    // XlaLaunch must not wait for an update that holds the variable's lock.
+    mutex_lock lock(*var->mu());
+    *var->tensor() = test::AsTensor<float>({3, 3});
+    launch = StartRunOpKernel(&status, &done);
+    EXPECT_TRUE(WaitForNotificationWithTimeout(&done, kLaunchTimeoutMicros));
+  }
+  launch.reset();
+  TF_ASSERT_OK(status);
+  test::ExpectTensorEqual<float>(*GetOutput(0), test::AsTensor<float>({3, 6}));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -32,6 +32,7 @@ limitations under the License.
 #include "tensorflow/compiler/jit/device_util.h"
 #include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/jit/resource_operation_safety_analysis.h"
+#include "tensorflow/compiler/jit/shape_inference.h"
 #include "tensorflow/compiler/jit/xla_cluster_util.h"
 #include "tensorflow/compiler/tf2xla/const_analysis.h"
 #include "tensorflow/compiler/tf2xla/resource_operation_table.h"
@@ -43,6 +44,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/common_runtime/graph_constructor.h"
 #include "tensorflow/core/framework/bounds_check.h"
+#include "tensorflow/core/framework/cost_graph.pb.h"
 #include "tensorflow/core/framework/graph_def_util.h"
 #include "tensorflow/core/framework/memory_types.h"
 #include "tensorflow/core/framework/node_def.pb.h"
@@ -54,6 +56,7 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/gtl/flatmap.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/statusor.h"
@@ -115,6 +118,18 @@ class MarkForCompilationPassImpl {
     std::atomic<int64_t>* fuel;
 
     bool dump_graphs;
+
+    // TensorFlow runtimes of the graph's nodes in microseconds, by node name.
+    // If non-empty, clusters that are not expected to run faster with XLA are
+    // not compiled, and edges carrying tensors of unknown shape are
+    // contracted first.
+    absl::flat_hash_map<string, int64_t> node_runtimes_us;
+
+    // Fixed cost of running a cluster with XLA, in microseconds.
+    int64_t cluster_launch_overhead_us;
+
+    // Speedup of the profiled nodes of a cluster when compiled with XLA.
+    float expected_cluster_speedup;
   };
 
   MarkForCompilationPassImpl(DebugOptions debug_options, Graph* graph,
@@ -300,6 +315,18 @@ class MarkForCompilationPassImpl {
   // tf_xla_min_cluster_size, are applied here.
   Status CreateClusters();
 
+  // Returns the TensorFlow runtime of the profiled nodes of each cluster, for
+  // the clusters that have at least one profiled node.
+  absl::flat_hash_map<const Cluster*, int64_t> GetProfiledClusterRuntimes();
+
+  // Returns true if running a cluster whose profiled nodes take `runtime_us`
+  // in TensorFlow is expected to be faster with XLA.
+  bool HasPositiveExpectedBenefit(int64_t runtime_us) const;
+
+  // Finds the data edges between compilation candidates that carry tensors of
+  // unknown shape.
+  Status FindShapePolymorphicEdges();
+
   Status DumpDebugInfo();
 
   bool IsCompilationCandidate(Node* n) const {
@@ -464,6 +491,11 @@ class MarkForCompilationPassImpl {
   std::unique_ptr<DeadnessAnalysis> deadness_analysis_;
   int64_t iteration_count_ = 0;
   absl::flat_hash_set<std::pair<int, int>> unsafe_resource_deps_;
+
+  // Data edges, as (src, dst) node IDs, between compilation candidates that
+  // carry tensors of unknown shape. Only computed when clustering with node
+  // runtimes.
+  std::vector<std::pair<int, int>> shape_polymorphic_edges_;
 };
 
 std::vector<int> MarkForCompilationPassImpl::FindAlternatePathForDebugging(
@@ -661,9 +693,40 @@ StatusOr<bool> MarkForCompilationPassImpl::Initialize() {
   // representative names the node in the 'cycles' graph that represents the
   // cluster.
   TF_RETURN_IF_ERROR(BuildInitialClusterSet());
+
+  if (!debug_options_.node_runtimes_us.empty()) {
+    XLA_SCOPED_LOGGING_TIMER_LEVEL("FindShapePolymorphicEdges", 1);
+    TF_RETURN_IF_ERROR(FindShapePolymorphicEdges());
+  }
   return true;
 }
 
+Status MarkForCompilationPassImpl::FindShapePolymorphicEdges() {
+  GraphShapeInfo shape_info;
+  Status status =
+      InferShapes(graph_, /*arg_shapes=*/{}, flib_def_, &shape_info);
+  if (!status.ok()) {
+    VLOG(2) << "Not preferring statically shaped cluster boundaries: "
+            << status;
+    return Status::OK();
+  }
+
+  for (const Edge* e : graph_->edges()) {
+    if (e->IsControlEdge() || !IsCompilationCandidate(e->src()) ||
+        !IsCompilationCandidate(e->dst())) {
+      continue;
+    }
+    auto it = shape_info.find(e->src()->name());
+    if (it == shape_info.end() || e->src_output() >= it->second.size()) {
+      continue;
+    }
+    if (!it->second[e->src_output()].shape.IsFullyDefined()) {
+      shape_polymorphic_edges_.push_back({e->src()->id(), e->dst()->id()});
+    }
+  }
+  return Status::OK();
+}
+
 template <typename FnTy>
 StatusOr<bool> MarkForCompilationPassImpl::ForEachEdgeInPostOrder(FnTy fn) {
   bool changed = false;
@@ -792,10 +855,26 @@ Status MarkForCompilationPassImpl::RunEdgeContractionLoop() {
         return TryToContractEdge(from, to);
       }).status());
 
-  // Phase 1: apply a heuristic to ensure that we don't mess up clustering due
-  // to "group_deps".  After this phase most edges should have been contracted.
+  // Phase 1: when clustering with node runtimes, contract the edges that carry
+  // tensors of unknown shape.  A cluster is compiled for each distinct shape of
+  // its inputs, so cutting clusters at statically shaped edges instead avoids
+  // recompilations.
 
   VLOG(4) << "Running phase 1";
+  for (const auto& edge : shape_polymorphic_edges_) {
+    Cluster* from = cluster_for_node_[edge.first].Get();
+    Cluster* to = cluster_for_node_[edge.second].Get();
+    if (from == to || !cycles_graph_.HasEdge(from->cycles_graph_node_id(),
+                                             to->cycles_graph_node_id())) {
+      continue;
+    }
+    TF_RETURN_IF_ERROR(TryToContractEdge(from, to).status());
+  }
+
+  // Phase 2: apply a heuristic to ensure that we don't mess up clustering due
+  // to "group_deps".  After this phase most edges should have been contracted.
+
+  VLOG(4) << "Running phase 2";
   TF_RETURN_IF_ERROR(
       ForEachEdgeInPostOrder([&](Cluster* from, Cluster* to) -> StatusOr<bool> {
         // We split out this phase to get good clustering in the presence of a
@@ -841,7 +920,7 @@ Status MarkForCompilationPassImpl::RunEdgeContractionLoop() {
         return TryToContractEdge(from, to);
       }).status());
 
-  // Phase 2: contract any remaining edges.  After this phase we should have a
+  // Phase 3: contract any remaining edges.  After this phase we should have a
   // maximal clustering:
   //
   // A. We visit a cluster only after maximally clustering all its children.
@@ -851,7 +930,7 @@ Status MarkForCompilationPassImpl::RunEdgeContractionLoop() {
   //    leaving it more contractable. That is, if we have
   //    digraph { X->Y; Y->Z; } then collapsing X->Y does not make it possible
   //    to contract Y->Z if Y->Z was not contractible originally.
-  VLOG(4) << "Running phase 2";
+  VLOG(4) << "Running phase 3";
   TF_RETURN_IF_ERROR(ForEachEdgeInPostOrder([&](Cluster* from, Cluster* to) {
                        return TryToContractEdge(from, to);
                      }).status());
@@ -947,7 +1026,10 @@ Status MarkForCompilationPassImpl::CreateClusters() {
   // * are explicitly marked for compilation (_XlaCompile=true), or
   // * have more than debug_options_.xla_min_cluster_size elements (applicable
   //   only if compilation is enabled, otherwise there will be no such
-  //   candidates).
+  //   candidates), and, if node runtimes are known, are expected to be faster
+  //   with XLA.
+  const absl::flat_hash_map<const Cluster*, int64_t> cluster_runtimes_us =
+      GetProfiledClusterRuntimes();
   for (Node* n : compilation_candidates_) {
     Cluster* cluster = GetClusterForNode(n);
     TF_ASSIGN_OR_RETURN(bool should_compile_cluster,
@@ -961,6 +1043,16 @@ Status MarkForCompilationPassImpl::CreateClusters() {
     // to (recursively) verify this fact, but that's probably not worth the
     // trouble.
 
+    if (!cluster->is_xla_compile_attr_true()) {
+      auto it = cluster_runtimes_us.find(cluster);
+      if (it != cluster_runtimes_us.end() &&
+          !HasPositiveExpectedBenefit(it->second)) {
+        VLOG(3) << "Not compiling " << cluster->DebugString(*graph_)
+                << ": its nodes only take " << it->second << " us in TF";
+        continue;
+      }
+    }
+
     if (cluster->effective_cluster_size() >= debug_options_.min_cluster_size ||
         cluster->has_functional_control_flow() ||
         cluster->is_xla_compile_attr_true()) {
@@ -985,6 +1077,31 @@ Status MarkForCompilationPassImpl::CreateClusters() {
   return Status::OK();
 }
 
+absl::flat_hash_map<const MarkForCompilationPassImpl::Cluster*, int64_t>
+MarkForCompilationPassImpl::GetProfiledClusterRuntimes() {
+  absl::flat_hash_map<const Cluster*, int64_t> cluster_runtimes_us;
+  if (debug_options_.node_runtimes_us.empty()) {
+    return cluster_runtimes_us;
+  }
+  for (Node* n : compilation_candidates_) {
+    auto it = debug_options_.node_runtimes_us.find(n->name());
+    if (it != debug_options_.node_runtimes_us.end()) {
+      cluster_runtimes_us[GetClusterForNode(n)] += it->second;
+    }
+  }
+  return cluster_runtimes_us;
+}
+
+bool MarkForCompilationPassImpl::HasPositiveExpectedBenefit(
+    int64_t runtime_us) const {
+  // XLA saves a fraction of the TF runtime of the nodes it fuses, but running
+  // the cluster costs a fixed launch overhead on top.
+  const double xla_runtime_us =
+      runtime_us / std::max(debug_options_.expected_cluster_speedup, 1.0f) +
+      debug_options_.cluster_launch_overhead_us;
+  return xla_runtime_us < runtime_us;
+}
+
 Status MarkForCompilationPassImpl::DumpDebugInfo() {
   TF_RET_CHECK(initialized_ && edges_contracted_ && clusters_created_);
 
@@ -1834,6 +1951,34 @@ std::atomic<int64_t>* GetPointerToFuel(int64_t initial_value) {
 
   return fuel;
 }
+
+// Sets the options of profile-guided clustering from `flags`.
+void SetCostProfileDebugOptions(
+    const MarkForCompilationPassFlags& flags,
+    MarkForCompilationPassImpl::DebugOptions* debug_options) {
+  debug_options->cluster_launch_overhead_us =
+      flags.tf_xla_cluster_launch_overhead_us;
+  debug_options->expected_cluster_speedup =
+      flags.tf_xla_cluster_expected_speedup;
+  if (flags.tf_xla_clustering_cost_profile.empty()) {
+    return;
+  }
+
+  const string& path = flags.tf_xla_clustering_cost_profile;
+  CostGraphDef cost_graph;
+  Status status = ReadBinaryProto(Env::Default(), path, &cost_graph);
+  if (!status.ok()) {
+    status = ReadTextProto(Env::Default(), path, &cost_graph);
+  }
+  if (!status.ok()) {
+    LOG(WARNING) << "Clustering without node runtimes, could not read "
+                 << path << ": " << status;
+    return;
+  }
+  for (const CostGraphDef::Node& node : cost_graph.node()) {
+    debug_options->node_runtimes_us[node.name()] += node.compute_cost();
+  }
+}
 }  // anonymous namespace
 
 Status MarkForCompilationPass::Run(
@@ -1852,6 +1997,7 @@ Status MarkForCompilationPass::Run(
   debug_options.min_cluster_size = flags->tf_xla_min_cluster_size;
   debug_options.fuel = GetPointerToFuel(flags->tf_xla_clustering_fuel);
   debug_options.dump_graphs = flags->tf_xla_clustering_debug;
+  SetCostProfileDebugOptions(*flags, &debug_options);
 
   return MarkForCompilation(options, debug_options);
 }
@@ -1871,6 +2017,7 @@ Status MarkForCompilationPass::RunForTest(
   debug_options.min_cluster_size = flags->tf_xla_min_cluster_size;
   debug_options.fuel = GetPointerToFuel(flags->tf_xla_clustering_fuel);
   debug_options.dump_graphs = flags->tf_xla_clustering_debug;
+  SetCostProfileDebugOptions(*flags, &debug_options);
 
   return MarkForCompilation(options, debug_options);
 }
@@ -33,6 +33,7 @@ limitations under the License.
 #include "tensorflow/cc/ops/sendrecv_ops.h"
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/compiler/jit/defs.h"
+#include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/jit/mark_for_compilation_pass_test_helper.h"
 #include "tensorflow/compiler/jit/node_matchers.h"
 #include "tensorflow/compiler/jit/xla_cluster_util.h"
@@ -40,11 +41,13 @@ limitations under the License.
 #include "tensorflow/compiler/tf2xla/xla_op_registry.h"
 #include "tensorflow/core/common_runtime/graph_constructor.h"
 #include "tensorflow/core/common_runtime/graph_def_builder_util.h"
+#include "tensorflow/core/framework/cost_graph.pb.h"
 #include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/graph/graph_def_builder.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/test.h"
 
@@ -1614,6 +1617,44 @@ TEST(XlaCompilationTest, ClusterShapeConsumerWithProducerAndConsumer) {
   EXPECT_EQ(clusters["test/y"], clusters["test/z"]);
 }
 
+// Clusters the chain test/a -> test/x0 -> ... -> test/x4 with a profile where
+// each node of the chain takes `node_runtime_us`, and returns the clusters.
+std::unordered_map<string, string> ClusterChainWithProfile(
+    int64_t node_runtime_us) {
+  Scope root = Scope::NewRootScope().ExitOnError();
+  Output x = ops::Placeholder(root.WithOpName("test/a"), DT_FLOAT);
+  CostGraphDef cost_graph;
+  for (int i = 0; i < 5; ++i) {
+    const string name = absl::StrCat("test/x", i);
+    x = ops::Relu(root.WithOpName(name), x);
+    CostGraphDef::Node* node = cost_graph.add_node();
+    node->set_name(name);
+    node->set_compute_cost(node_runtime_us);
+  }
+
+  MarkForCompilationPassFlags* flags = GetMarkForCompilationPassFlags();
+  const string path = io::JoinPath(testing::TmpDir(), "cost_graph.pbtxt");
+  TF_CHECK_OK(WriteTextProto(Env::Default(), path, cost_graph));
+  flags->tf_xla_clustering_cost_profile = path;
+  std::unique_ptr<Graph> graph(new Graph(OpRegistry::Global()));
+  TF_CHECK_OK(root.ToGraph(graph.get()));
+  TF_CHECK_OK(MarkForCompilationPassTestHelper::MarkForCompilation(&graph));
+  flags->tf_xla_clustering_cost_profile = "";
+  return GetClusters(*graph);
+}
+
+TEST(XlaCompilationTest, ProfileGuidedClustering) {
+  // 5 * 1ms of TF runtime is worth compiling.
+  std::unordered_map<string, string> clusters = ClusterChainWithProfile(1000);
+  EXPECT_NE(clusters["test/x0"], "");
+  for (int i = 1; i < 5; ++i) {
+    EXPECT_EQ(clusters[absl::StrCat("test/x", i)], clusters["test/x0"]);
+  }
+
+  // 5 * 10us of TF runtime is not, given the launch overhead of the cluster.
+  EXPECT_TRUE(ClusterChainWithProfile(10).empty());
+}
+
 void AddCtrlEdge(const Scope& scope, Operation a, Operation b) {
   scope.graph()->AddControlEdge(a.node(), b.node());
 }
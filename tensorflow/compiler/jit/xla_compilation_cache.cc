@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/compiler/jit/xla_compilation_cache.h"
 
+#include <algorithm>
+#include <functional>
 #include <memory>
 #include <numeric>
 #include <string>
@@ -24,6 +26,7 @@ limitations under the License.
 #include "tensorflow/compiler/mlir/mlir_bridge_rollout_policy.h"
 #include "absl/base/call_once.h"
 #include "absl/status/status.h"
+#include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "absl/types/variant.h"
@@ -39,6 +42,7 @@ limitations under the License.
 #include "tensorflow/compiler/tf2xla/xla_compiler.h"
 #include "tensorflow/compiler/tf2xla/xla_context.h"
 #include "tensorflow/compiler/xla/client/client_library.h"
+#include "tensorflow/compiler/xla/debug_options_flags.h"
 #include "tensorflow/compiler/xla/protobuf_util.h"
 #include "tensorflow/compiler/xla/service/compiler.h"
 #include "tensorflow/compiler/xla/service/hlo.pb.h"
@@ -62,6 +66,7 @@ limitations under the License.
 #include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/protobuf/debug_event.pb.h"
@@ -140,7 +145,27 @@ std::string XlaSerializedCacheKeyToString(const XlaSerializedCacheKey& key) {
       key.prefix(), key.prefix().empty() ? "" : kXlaSerializedCacheKeySeparator,
       key.signature_fingerprint(), kXlaSerializedCacheKeySeparator,
       key.cluster_fingerprint(), kXlaSerializedCacheKeySeparator,
-      key.device_type());
+      key.device_type(), kXlaSerializedCacheKeySeparator,
+      key.compiler_fingerprint());
+}
+
+// Waits for all stream executors of `client` to complete.
+void WaitForProgramsToComplete(xla::LocalClient* client) {
+  for (auto* executor : client->backend().stream_executors()) {
+    bool ok = executor->SynchronizeAllActivity();
+    if (!ok) {
+      LOG(ERROR) << "Error synchronizing activity while waiting for all "
+                    "programs to complete";
+    }
+  }
+}
+
+// Returns the thread that destroys evicted entries, which outlives the caches
+// since evicted entries may outlive them.
+thread::ThreadPool* EvictedEntryDeletionThread() {
+  static thread::ThreadPool* thread = new thread::ThreadPool(
+      Env::Default(), "xla_evicted_entry_deletion", /*num_threads=*/1);
+  return thread;
 }
 
 }  // namespace
@@ -150,6 +175,8 @@ constexpr int64_t
     XlaCompilationCache::AsyncCompilationState::kNumCompilerThreads;
 constexpr int64_t
     XlaCompilationCache::AsyncCompilationState::kMaxNumOngoingCompilations;
+constexpr int64_t
+    XlaCompilationCache::AsyncCompilationState::kMaxNumPendingCompilations;
 
 XlaCompilationCache::XlaCompilationCache(Config config,
                                          xla::LocalClient* client,
@@ -158,19 +185,21 @@ XlaCompilationCache::XlaCompilationCache(Config config,
       device_type_(std::move(device_type)),
       disable_strict_signature_checks_(config.disable_strict_signature_checks),
       persistance_prefix_(config.persistance_prefix),
+      compiler_fingerprint_(CompilerFingerprint(
+          client->platform()->Name(), xla::GetDebugOptionsFromFlags())),
+      capacity_(config.capacity),
       persistent_cache_directory_(config.persistent_cache_directory) {}
 
 XlaCompilationCache::~XlaCompilationCache() {
   // Ensure any use of our programs have completed by waiting for all stream
   // executors to complete.
-  for (auto* executor : client_->backend().stream_executors()) {
-    bool ok = executor->SynchronizeAllActivity();
-    if (!ok) {
-      LOG(ERROR) << "Error synchronizing activity while waiting for all "
-                    "programs to complete";
-    }
+  WaitForProgramsToComplete(client_);
+  // Drop the compilations that have not started, and wait for all outstanding
+  // compilations to finish.
+  {
+    mutex_lock lock(async_compilation_state_.async_compilation_state_mu);
+    async_compilation_state_.pending_compilations.clear();
   }
-  // Wait for all outstanding compilations to finish.
   // Resetting the pointer explicitly in the top level destructor.
   // Without this, the pointer would be reset when the AsyncCompilationState
   // is destructed, which is dependent on the order of the members in the
@@ -184,6 +213,29 @@ XlaCompilationCache::~XlaCompilationCache() {
   // about?
 }
 
+uint64 XlaCompilationCache::CompilerFingerprint(
+    absl::string_view platform_name, xla::DebugOptions debug_options) {
+  // Dumping and logging must not invalidate the persisted entries, as they are
+  // often enabled for a single run to debug it.
+  const protobuf::Descriptor* descriptor = debug_options.GetDescriptor();
+  const protobuf::Reflection* reflection = debug_options.GetReflection();
+  for (int i = 0; i < descriptor->field_count(); ++i) {
+    const protobuf::FieldDescriptor* field = descriptor->field(i);
+    if (absl::StartsWith(field->name(), "xla_dump_")) {
+      reflection->ClearField(&debug_options, field);
+    }
+  }
+  debug_options.clear_xla_hlo_graph_addresses();
+  debug_options.clear_xla_hlo_graph_sharding_color();
+  debug_options.clear_xla_gpu_dump_llvmir();
+  debug_options.clear_xla_detailed_logging_and_dumping();
+
+  std::string serialized_debug_options;
+  SerializeToStringDeterministic(debug_options, &serialized_debug_options);
+  return Fingerprint64(absl::StrCat(TF_VERSION_STRING, ";", platform_name, ";",
+                                    serialized_debug_options));
+}
+
 string XlaCompilationCache::DebugString() const {
   return "XLA JIT compilation cache";
 }
@@ -256,7 +308,8 @@ static std::vector<const xla::Shape*> GetShapePointers(
 
 static xla::ExecutableBuildOptions GetBuildOptions(
     const XlaCompiler::Options& options,
-    const XlaCompiler::CompilationResult& result, int default_device_ordinal) {
+    const XlaCompiler::CompilationResult& result, int default_device_ordinal,
+    absl::string_view persistent_cache_directory) {
   xla::ExecutableBuildOptions build_options;
   if (result.collective_info) {
     build_options.set_num_replicas(result.collective_info->group_size);
@@ -272,6 +325,14 @@ static xla::ExecutableBuildOptions GetBuildOptions(
   if (tensorflow::OpDeterminismRequired()) {
     build_options.mutable_debug_options()->set_xla_gpu_deterministic_ops(true);
   }
+  // Keep the matmul autotuning results of XLA:CPU next to the executables
+  // they were used for, for other processes to reuse them too.
+  xla::DebugOptions* debug_options = build_options.mutable_debug_options();
+  if (!persistent_cache_directory.empty() &&
+      debug_options->xla_cpu_matmul_autotuning_database().empty()) {
+    debug_options->set_xla_cpu_matmul_autotuning_database(io::JoinPath(
+        persistent_cache_directory, "xla_cpu_matmul_autotuning_database"));
+  }
   return build_options;
 }
 
@@ -284,7 +345,8 @@ Status XlaCompilationCache::BuildExecutable(
   std::vector<const xla::Shape*> argument_layouts =
       GetShapePointers(result.xla_input_shapes);
   xla::ExecutableBuildOptions build_options =
-      GetBuildOptions(options, result, client_->default_device_ordinal());
+      GetBuildOptions(options, result, client_->default_device_ordinal(),
+                      persistent_cache_directory_);
   TF_ASSIGN_OR_RETURN(
       auto executables,
       client_->Compile(*result.computation, argument_layouts, build_options));
@@ -302,7 +364,8 @@ XlaCompilationCache::BuildSerializedExecutable(
   std::vector<const xla::Shape*> argument_layouts =
       GetShapePointers(result.xla_input_shapes);
   xla::ExecutableBuildOptions build_options =
-      GetBuildOptions(options, result, client_->default_device_ordinal());
+      GetBuildOptions(options, result, client_->default_device_ordinal(),
+                      persistent_cache_directory_);
   TF_ASSIGN_OR_RETURN(
       std::vector<std::unique_ptr<xla::AotCompilationResult>> aot_results,
       client_->CompileAheadOfTime(*result.computation, argument_layouts,
@@ -319,7 +382,8 @@ XlaCompilationCache::LoadExecutable(
   VLOG(2) << "Loading local executable using BEF.";
 
   xla::ExecutableBuildOptions build_options =
-      GetBuildOptions(options, result, client_->default_device_ordinal());
+      GetBuildOptions(options, result, client_->default_device_ordinal(),
+                      persistent_cache_directory_);
   return client_->Load(serialized_aot_result, build_options);
 }
 
@@ -329,10 +393,10 @@ Status XlaCompilationCache::Compile(
     const XlaCompiler::CompileOptions& compile_options,
     CompileMode compile_mode,
     const XlaCompiler::CompilationResult** out_compilation_result,
-    xla::LocalExecutable** out_executable) {
+    xla::LocalExecutable** out_executable, EntryRef* out_entry_ref) {
   return CompileImpl(compile_options, options, function, args,
                      /*ctx=*/nullptr, CompileScope::kFunction, compile_mode,
-                     out_compilation_result, out_executable);
+                     out_compilation_result, out_executable, out_entry_ref);
 }
 
 static bool ShouldBeMegamorphic(int64_t compile_count,
@@ -453,7 +517,7 @@ Status XlaCompilationCache::CompileSingleOp(
     const std::vector<XlaCompiler::Argument>& args, OpKernelContext* ctx,
     const XlaCompiler::CompileOptions& compile_options,
     const XlaCompiler::CompilationResult** out_compilation_result,
-    xla::LocalExecutable** out_executable) {
+    xla::LocalExecutable** out_executable, EntryRef* out_entry_ref) {
   const NodeDef& def = ctx->op_kernel().def();
   NameAttrList name;
   name.set_name(def.op());
@@ -464,7 +528,7 @@ Status XlaCompilationCache::CompileSingleOp(
   name.mutable_attr()->erase("_class");
   return CompileImpl(compile_options, options, name, args, ctx,
                      CompileScope::kOp, CompileMode::kStrict,
-                     out_compilation_result, out_executable);
+                     out_compilation_result, out_executable, out_entry_ref);
 }
 
 namespace {
@@ -538,14 +602,23 @@ Status XlaCompilationCache::CompileStrict(
     entry->compilation_status =
         BuildExecutable(options, entry->compilation_result, &entry->executable);
 
-    // Caching is done regardless of the entry->compilation_status. To take
-    // advantage of newer compilation code, a cache flush is required.
+    // Caching is done regardless of the entry->compilation_status. Failing
+    // to persist an entry, e.g. because the backend can't serialize its
+    // executables, only costs a compilation in the next process, so it is not
+    // an error.
     if (!persistent_cache_directory_.empty()) {
       XLA_SCOPED_LOGGING_TIMER(absl::StrCat(
           "Serializing and saving cache entry: ", sig.HumanString()));
-      TF_ASSIGN_OR_RETURN(XlaSerializedCacheEntry serialized_entry,
-                          SerializeEntry(options, sig, *entry));
-      TF_RETURN_IF_ERROR(SaveSerializedEntry(std::move(serialized_entry)));
+      StatusOr<XlaSerializedCacheEntry> serialized_entry =
+          SerializeEntry(options, sig, *entry);
+      Status status = serialized_entry.status();
+      if (status.ok()) {
+        status = SaveSerializedEntry(*std::move(serialized_entry));
+      }
+      if (!status.ok()) {
+        LOG(WARNING) << "Failed to persist the XLA compilation cache entry for "
+                     << sig.HumanString() << ": " << status;
+      }
     }
   }
 
@@ -584,28 +657,27 @@ Status XlaCompilationCache::CompileStrict(
 }
 
 Status XlaCompilationCache::CompileAsynchronous(
-    const Signature& signature, Entry* entry,
+    const Signature& signature, const std::shared_ptr<Entry>& entry,
     const XlaCompiler::CompileOptions& compile_options,
     const XlaCompiler::Options& options,
     const std::vector<XlaCompiler::Argument>& args,
     const NameAttrList& function, OpKernelContext* ctx, CompileScope scope) {
   // Explicitly capture all required data by value for async compilation.
+  // The entry stays in the compiling state until the compilation is done, so
+  // that further requests for it don't queue it again.
   entry->compile_state = CompileState::kCompiling;
-  {
-    mutex_lock lock(async_compilation_state_.async_compilation_state_mu);
-    async_compilation_state_.num_ongoing_compilations++;
-  }
-  // Don't move the above code into the thread function as it synchronously
-  // updates the async compilation state!
+  const uint64 queue_time_us = Env::Default()->NowMicros();
 
   // When the ThreadPool for the compilation cache is destroyed, it waits for
-  // compilations to have finished. This means that both 'entry' and 'this' will
-  // be alive for the duration of the compilation.
+  // compilations to have finished, and the compilations that have not started
+  // are dropped. This means that 'this' will be alive for the duration of the
+  // compilation, and the lambda holds a reference to 'entry', which may be
+  // evicted in the meantime.
   // !!Pay attention when additional variables must be captured by this lambda!!
-  // All values are captured by value. Make sure that all pointer values (like
-  // entry) do not get freed until the lambda has finished,\.
+  // All values are captured by value. Make sure that all pointer values do not
+  // get freed until the lambda has finished.
   const std::string& function_name = function.name();
-  async_compilation_state_.compiler_threads->Schedule([=] {
+  auto compile = [=] {
     Entry local_entry;
     VLOG(2) << "Starting asynchronous compilation of cluster " << function_name
             << '.';
@@ -616,10 +688,9 @@ Status XlaCompilationCache::CompileAsynchronous(
                              args, function, ctx, scope);
     VLOG(2) << "Finished asynchronous compililation of cluster "
             << function_name << '.';
-    {
-      mutex_lock lock(async_compilation_state_.async_compilation_state_mu);
-      async_compilation_state_.num_ongoing_compilations--;
-    }
+    // The cluster ran as a TensorFlow function from the time it was queued.
+    metrics::UpdateXlaAsyncCompilationFallbackTime(Env::Default()->NowMicros() -
+                                                   queue_time_us);
     {  // Populate original entry with compilation result.
       mutex_lock entry_lock(entry->mu);
       if (!s.ok()) {
@@ -631,10 +702,41 @@ Status XlaCompilationCache::CompileAsynchronous(
       entry->compile_state = local_entry.compile_state;
       entry->executable = std::move(local_entry.executable);
     }
-  });
+  };
+
+  mutex_lock lock(async_compilation_state_.async_compilation_state_mu);
+  async_compilation_state_.pending_compilations.push_back(
+      {entry, std::move(compile)});
+  SchedulePendingCompilations();
   return Status::OK();
 }
 
+void XlaCompilationCache::SchedulePendingCompilations() {
+  auto& pending = async_compilation_state_.pending_compilations;
+  while (!pending.empty() &&
+         async_compilation_state_.num_ongoing_compilations <
+             async_compilation_state_.kMaxNumOngoingCompilations) {
+    auto hottest = std::max_element(
+        pending.begin(), pending.end(),
+        [](const AsyncCompilationState::PendingCompilation& a,
+           const AsyncCompilationState::PendingCompilation& b) {
+          return a.entry->request_count.load(std::memory_order_relaxed) <
+                 b.entry->request_count.load(std::memory_order_relaxed);
+        });
+    std::iter_swap(hottest, pending.end() - 1);
+    std::function<void()> compile = std::move(pending.back().compile);
+    pending.pop_back();
+    async_compilation_state_.num_ongoing_compilations++;
+    async_compilation_state_.compiler_threads->Schedule(
+        [this, compile = std::move(compile)] {
+          compile();
+          mutex_lock lock(async_compilation_state_.async_compilation_state_mu);
+          async_compilation_state_.num_ongoing_compilations--;
+          SchedulePendingCompilations();
+        });
+  }
+}
+
 bool XlaCompilationCache::ShouldCompileCluster(CompileMode compile_mode,
                                                bool is_megamorphic,
                                                bool is_first_execution,
@@ -661,21 +763,22 @@ bool XlaCompilationCache::ShouldCompileCluster(CompileMode compile_mode,
     return false;
   }
 
-  if (is_first_execution) {
-    return true;
-  }
-
   if (compile_mode == CompileMode::kAsync) {
-    // Asynchronous compilation is enabled.
+    // Asynchronous compilation is enabled. Compilations wait for a compiler
+    // thread in a bounded queue, which first executions don't bypass.
     mutex_lock lock(async_compilation_state_.async_compilation_state_mu);
-    if (async_compilation_state_.num_ongoing_compilations >=
-        async_compilation_state_.kMaxNumOngoingCompilations) {
+    if (async_compilation_state_.pending_compilations.size() >=
+        async_compilation_state_.kMaxNumPendingCompilations) {
       VLOG(2) << "Not asynchronously compiling cluster " << function.name()
-              << " because of too many ongoing compilations.";
+              << " because of too many pending compilations.";
       return false;
     }
   }
 
+  if (is_first_execution) {
+    return true;
+  }
+
   bool reached_compile_threshold = current_request_count >= *compile_threshold;
   if (!reached_compile_threshold) {
     VLOG(2) << "Not compiling cluster " << function.name()
@@ -692,7 +795,7 @@ Status XlaCompilationCache::CompileImpl(
     const std::vector<XlaCompiler::Argument>& args, OpKernelContext* ctx,
     CompileScope scope, CompileMode compile_mode,
     const XlaCompiler::CompilationResult** out_compilation_result,
-    xla::LocalExecutable** out_executable) {
+    xla::LocalExecutable** out_executable, EntryRef* out_entry_ref) {
   DCHECK_NE(out_executable, nullptr);
   VLOG(2) << "XlaCompilationCache::Compile " << DebugString();
 
@@ -706,15 +809,33 @@ Status XlaCompilationCache::CompileImpl(
 
   // The outer lock protects the existence of the cache entry. It does not
   // protect the contents of the cache entry.
-  Entry* entry;
+  std::shared_ptr<Entry> entry;
   {
-    mutex_lock lock(compile_cache_mu_);
-    // Find or create a cache entry.
-    std::unique_ptr<Entry>& e = cache_[signature];
-    if (!e) {
-      e.reset(new Entry);
+    std::vector<std::shared_ptr<Entry>> evicted;
+    {
+      mutex_lock lock(compile_cache_mu_);
+      // Find or create a cache entry.
+      std::shared_ptr<Entry>& e = cache_[signature];
+      const bool inserted = !e;
+      if (inserted) {
+        e = NewEntry();
+      }
+      entry = e;
+      if (capacity_ > 0) {
+        if (inserted) {
+          lru_.push_front(signature);
+          entry->lru_position = lru_.begin();
+        } else {
+          lru_.splice(lru_.begin(), lru_, entry->lru_position);
+        }
+        EvictEntries(&evicted);
+      }
     }
-    entry = e.get();
+    // Releases the evicted entries without holding the lock.
+    evicted.clear();
+  }
+  if (out_entry_ref) {
+    *out_entry_ref = entry;
   }
 
   // We always compile a cluster the very first time it is executed.  This is an
@@ -800,8 +921,9 @@ Status XlaCompilationCache::CompileImpl(
       return Status::OK();
     } else {
       VLOG(2) << "Instantly compiling for signature: " << human_signature;
-      TF_RETURN_IF_ERROR(CompileStrict(signature, entry, compile_options,
-                                       options, args, function, ctx, scope));
+      TF_RETURN_IF_ERROR(CompileStrict(signature, entry.get(),
+                                       compile_options, options, args,
+                                       function, ctx, scope));
     }
   } else if (state == CompileState::kCompiling) {
     VLOG(2) << "Ongoing asynchronous compilation for signature: "
@@ -817,6 +939,40 @@ Status XlaCompilationCache::CompileImpl(
   return Status::OK();
 }
 
+std::shared_ptr<XlaCompilationCache::Entry> XlaCompilationCache::NewEntry()
+    const {
+  xla::LocalClient* client = client_;
+  return std::shared_ptr<Entry>(new Entry, [client](Entry* entry) {
+    // Entries still in the cache are destroyed with it, after it has waited for
+    // all programs to complete. Waiting for the programs of an evicted entry
+    // would stall the thread that releases it, which is usually executing ops.
+    if (entry->evicted) {
+      EvictedEntryDeletionThread()->Schedule([client, entry] {
+        WaitForProgramsToComplete(client);
+        delete entry;
+      });
+    } else {
+      delete entry;
+    }
+  });
+}
+
+void XlaCompilationCache::EvictEntries(
+    std::vector<std::shared_ptr<Entry>>* evicted) {
+  // The requested entry is the most recently used one, so it is never evicted
+  // for a positive capacity.
+  while (cache_.size() > static_cast<size_t>(capacity_)) {
+    auto lru = cache_.find(lru_.back());
+    DCHECK(lru != cache_.end());
+    VLOG(2) << "Evicting compilation cache entry: "
+            << lru->first.HumanString();
+    lru->second->evicted = true;
+    evicted->push_back(std::move(lru->second));
+    cache_.erase(lru);
+    lru_.pop_back();
+  }
+}
+
 XlaSerializedCacheKey XlaCompilationCache::BuildSerializedCacheKey(
     const Signature& sig, const xla::HloModuleProto& hlo_module) const {
   XlaSerializedCacheKey serialized_cache_key;
@@ -825,6 +981,7 @@ XlaSerializedCacheKey XlaCompilationCache::BuildSerializedCacheKey(
       DeterministicProtoHash64(hlo_module));
   serialized_cache_key.set_device_type(device_type_.type_string());
   serialized_cache_key.set_prefix(persistance_prefix_);
+  serialized_cache_key.set_compiler_fingerprint(compiler_fingerprint_);
   return serialized_cache_key;
 }
 
@@ -907,7 +1064,20 @@ Status XlaCompilationCache::SaveSerializedEntry(
   TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(persistent_cache_directory_));
   const std::string file_path =
       GetFilePath(entry.key(), persistent_cache_directory_);
-  return WriteBinaryProto(env, file_path, entry);
+  // The directory may be shared by many processes compiling the same
+  // clusters, so write to a unique file and move it in place, for readers to
+  // never see a partially written entry.
+  std::string temp_file_path = file_path;
+  if (!env->CreateUniqueFileName(&temp_file_path, ".tmp")) {
+    return errors::Internal("Failed to create a temporary file name for ",
+                            file_path);
+  }
+  TF_RETURN_IF_ERROR(WriteBinaryProto(env, temp_file_path, entry));
+  Status status = env->RenameFile(temp_file_path, file_path);
+  if (!status.ok()) {
+    env->DeleteFile(temp_file_path).IgnoreError();
+  }
+  return status;
 }
 
 StatusOr<absl::optional<XlaSerializedCacheEntry>>
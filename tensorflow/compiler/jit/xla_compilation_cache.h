@@ -16,9 +16,13 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_JIT_XLA_COMPILATION_CACHE_H_
 #define TENSORFLOW_COMPILER_JIT_XLA_COMPILATION_CACHE_H_
 
+#include <atomic>
+#include <functional>
+#include <list>
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/inlined_vector.h"
@@ -48,18 +52,20 @@ namespace tensorflow {
 // Since XLA computations must have static shapes, the cache generates a new
 // XLA computation for each new set of input shapes.
 //
-// Currently no cache eviction policy is implemented and the cache grows without
-// bound.
+// By default the cache grows without bound. If it is given a capacity, the
+// least recently used entries are evicted once it holds more entries than that.
 class XlaCompilationCache : public ResourceBase {
  public:
   struct Config {
     Config() {}
     explicit Config(absl::string_view persistent_cache_directory,
                     bool disable_strict_signature_checks,
-                    absl::string_view persistance_prefix)
+                    absl::string_view persistance_prefix,
+                    int64_t capacity = 0)
         : persistent_cache_directory(persistent_cache_directory),
           disable_strict_signature_checks(disable_strict_signature_checks),
-          persistance_prefix(persistance_prefix) {}
+          persistance_prefix(persistance_prefix),
+          capacity(capacity) {}
 
     // If non-empty, JIT-compiled executables are saved to and loaded from the
     // specified file system directory path.
@@ -71,6 +77,11 @@ class XlaCompilationCache : public ResourceBase {
 
     // The cache persistence prefix to use if serializing/deserialzing entries.
     std::string persistance_prefix;
+
+    // If positive, the maximum number of entries kept in the cache. Evicted
+    // entries that are still compiling or referenced stay alive until they are
+    // no longer used.
+    int64_t capacity = 0;
   };
   XlaCompilationCache(Config config, xla::LocalClient* client,
                       DeviceType device_type);
@@ -89,6 +100,11 @@ class XlaCompilationCache : public ResourceBase {
     kFunction,
   };
 
+  // Holds a reference to a cache entry. The compilation result and executable
+  // returned for an entry stay valid while a reference to it is held, even if
+  // the entry has been evicted from the cache in the meantime.
+  using EntryRef = std::shared_ptr<const void>;
+
   // Compiles a function into a XlaCompiler::CompilationResult that can be used
   // to execute an XLA Computation. Compilation results are cached.
   // `function` is the name of a Tensorflow function to compile.
@@ -108,13 +124,18 @@ class XlaCompilationCache : public ResourceBase {
   // xla::LocalExecutable and sets `out_executable` to point to it. The
   // resulting executable pointer may be null if the computation has no
   // non-constant outputs.
+  //
+  // If `out_entry_ref` is non-null, it is set to a reference to the entry for
+  // the signature, which owns the results. Callers of a cache with a capacity
+  // must hold it for as long as they use the results.
   Status Compile(const XlaCompiler::Options& options,
                  const NameAttrList& function,
                  const std::vector<XlaCompiler::Argument>& args,
                  const XlaCompiler::CompileOptions& compile_options,
                  CompileMode compile_mode,
                  const XlaCompiler::CompilationResult** out_compilation_result,
-                 xla::LocalExecutable** out_executable);
+                 xla::LocalExecutable** out_executable,
+                 EntryRef* out_entry_ref = nullptr);
 
   // As above, but calls XlaCompiler::CompileSingleOp instead of
   // XlaCompiler::CompileFunction. If MLIR bridge is enabled through ConfigProto
@@ -125,7 +146,8 @@ class XlaCompilationCache : public ResourceBase {
       const std::vector<XlaCompiler::Argument>& args, OpKernelContext* ctx,
       const XlaCompiler::CompileOptions& compile_options,
       const XlaCompiler::CompilationResult** out_compilation_result,
-      xla::LocalExecutable** out_executable);
+      xla::LocalExecutable** out_executable,
+      EntryRef* out_entry_ref = nullptr);
 
   xla::LocalClient* client() const { return client_; }
   const DeviceType& device_type() const { return device_type_; }
@@ -168,7 +190,7 @@ class XlaCompilationCache : public ResourceBase {
       const std::vector<XlaCompiler::Argument>& args, OpKernelContext* ctx,
       CompileScope scope, CompileMode compile_mode,
       const XlaCompiler::CompilationResult** out_compilation_result,
-      xla::LocalExecutable** out_executable);
+      xla::LocalExecutable** out_executable, EntryRef* out_entry_ref);
 
   // Takes `result` which has been compiled from a Tensorflow subgraph to a
   // XLA computation already, and generates an XLA LocalExecutable `executable`.
@@ -201,6 +223,15 @@ class XlaCompilationCache : public ResourceBase {
   bool disable_strict_signature_checks_;
   std::string persistance_prefix_;
 
+  // Fingerprints the TensorFlow version, `platform_name` and the fields of
+  // `debug_options` that change the code XLA generates.
+  static uint64 CompilerFingerprint(absl::string_view platform_name,
+                                    xla::DebugOptions debug_options);
+
+  // Fingerprint of the TensorFlow version, platform and XLA flags, part of the
+  // keys of persisted entries.
+  const uint64 compiler_fingerprint_;
+
   // The value associated with a cache entry.
   struct Entry {
     mutex mu;
@@ -209,7 +240,17 @@ class XlaCompilationCache : public ResourceBase {
     CompileState compile_state = CompileState::kUncompiled;
 
     // The number of times a compilation with this signature has been requested.
-    int64_t request_count = 0;
+    // Read without holding `mu` to prioritize pending asynchronous
+    // compilations.
+    std::atomic<int64_t> request_count{0};
+
+    // The position of the entry's signature in `lru_`, if the cache has a
+    // capacity. Guarded by `compile_cache_mu_`.
+    std::list<Signature>::iterator lru_position;
+
+    // Set when the entry is evicted from the cache. Guarded by
+    // `compile_cache_mu_` until the entry is evicted.
+    bool evicted = false;
 
     // Did compilation succeed?
     Status compilation_status TF_GUARDED_BY(mu);
@@ -244,7 +285,13 @@ class XlaCompilationCache : public ResourceBase {
                        const NameAttrList& function, OpKernelContext* ctx,
                        CompileScope scope)
       TF_EXCLUSIVE_LOCKS_REQUIRED(entry->mu);
-  Status CompileAsynchronous(const Signature& sig, Entry* entry,
+  // Starts the pending asynchronous compilations with the highest priority
+  // while there are idle compiler threads.
+  void SchedulePendingCompilations() TF_EXCLUSIVE_LOCKS_REQUIRED(
+      async_compilation_state_.async_compilation_state_mu);
+
+  Status CompileAsynchronous(const Signature& sig,
+                             const std::shared_ptr<Entry>& entry,
                              const XlaCompiler::CompileOptions& compile_options,
                              const XlaCompiler::Options& options,
                              const std::vector<XlaCompiler::Argument>& args,
@@ -252,7 +299,7 @@ class XlaCompilationCache : public ResourceBase {
                              CompileScope scope);
 
   // Saves the cache entry in the file directory supplied during the
-  // construction of this class. Overwrites existing entries.
+  // construction of this class. Overwrites existing entries atomically.
   Status SaveSerializedEntry(const XlaSerializedCacheEntry& entry);
 
   // Tries to load a cache entry given a `key` by searching the file directory
@@ -261,10 +308,28 @@ class XlaCompilationCache : public ResourceBase {
   StatusOr<absl::optional<XlaSerializedCacheEntry>> TryLoadSerializedEntry(
       const XlaSerializedCacheKey& key);
 
+  // Creates an empty entry. An evicted entry is destroyed in the background,
+  // once the programs of the client have completed, so that its programs are
+  // not freed while they run.
+  std::shared_ptr<Entry> NewEntry() const;
+
+  // Evicts the least recently used entries until the cache holds at most
+  // `capacity_` entries. The evicted entries are appended to `evicted`, so that
+  // they can be released after releasing the lock.
+  void EvictEntries(std::vector<std::shared_ptr<Entry>>* evicted)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(compile_cache_mu_);
+
+  // Maximum number of entries in the cache, or 0 if unbounded.
+  const int64_t capacity_;
+
   mutex compile_cache_mu_;
-  absl::flat_hash_map<Signature, std::unique_ptr<Entry>, Signature::Hash> cache_
+  absl::flat_hash_map<Signature, std::shared_ptr<Entry>, Signature::Hash> cache_
       TF_GUARDED_BY(compile_cache_mu_);
 
+  // The signatures of the entries, from the most to the least recently used,
+  // if the cache has a capacity.
+  std::list<Signature> lru_ TF_GUARDED_BY(compile_cache_mu_);
+
   struct ClusterCompileStats {
     // Number of times the cluster has been (re-)compiled.
     int64_t compile_count = 0;
@@ -296,10 +361,26 @@ class XlaCompilationCache : public ResourceBase {
     // Maximum number of ongoing compilations.
     static constexpr int64_t kMaxNumOngoingCompilations = kNumCompilerThreads;
 
+    // Maximum number of compilations waiting for a compiler thread. Clusters
+    // requested beyond it run as TensorFlow functions, and are requested again
+    // on their next execution.
+    static constexpr int64_t kMaxNumPendingCompilations = 1000;
+
     // Number of ongoing compilations.
     int64_t num_ongoing_compilations TF_GUARDED_BY(async_compilation_state_mu) =
         0;
 
+    struct PendingCompilation {
+      // The entry to compile, whose request count is its priority.
+      std::shared_ptr<Entry> entry;
+      std::function<void()> compile;
+    };
+
+    // Compilations waiting for a compiler thread. The hottest entry, i.e. the
+    // one executed most often while waiting, is compiled first.
+    std::vector<PendingCompilation> pending_compilations
+        TF_GUARDED_BY(async_compilation_state_mu);
+
     // Pool of threads for asynchronous compilations.
     std::unique_ptr<thread::ThreadPool> compiler_threads;
 
@@ -319,6 +400,8 @@ class XlaCompilationCache : public ResourceBase {
   // specified file system directory path.
   std::string persistent_cache_directory_;
 
+  friend class XlaCompilationCacheTestPeer;
+
   TF_DISALLOW_COPY_AND_ASSIGN(XlaCompilationCache);
 };
 
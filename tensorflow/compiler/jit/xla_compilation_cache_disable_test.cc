@@ -78,5 +78,53 @@ TEST(XlaCompilationCacheTest, TestDisabledXlaCompilation) {
       absl::StrContains(status.error_message(), "XLA compilation disabled"));
 }
 
+// Uses failed compilations to fill the cache with uncompiled entries.
+TEST(XlaCompilationCacheTest, EvictsLeastRecentlyUsedEntries) {
+  NameAttrList fn;
+  fn.set_name("afunction");
+  auto args_of_size = [](int size) {
+    std::vector<XlaCompiler::Argument> args(1);
+    args[0].kind = XlaCompiler::Argument::kParameter;
+    args[0].type = DT_INT32;
+    args[0].shape = TensorShape({size});
+    return args;
+  };
+
+  DisableXlaCompilation();
+
+  xla::LocalClient* client = xla::ClientLibrary::LocalClientOrDie();
+  DeviceType device_type = DeviceType(DEVICE_CPU_XLA_JIT);
+  XlaCompilationCache::Config config;
+  config.capacity = 2;
+  auto cache = new XlaCompilationCache(config, client, device_type);
+  core::ScopedUnref cache_ref(cache);
+
+  auto compile = [&](int size) {
+    const XlaCompiler::CompilationResult* compilation_result;
+    xla::LocalExecutable* executable;
+    XlaCompilationCache::EntryRef entry_ref;
+    Status status = cache->Compile(XlaCompiler::Options{}, fn,
+                                   args_of_size(size),
+                                   XlaCompiler::CompileOptions{},
+                                   XlaCompilationCache::CompileMode::kStrict,
+                                   &compilation_result, &executable,
+                                   &entry_ref);
+    EXPECT_FALSE(status.ok());
+    return entry_ref;
+  };
+
+  XlaCompilationCache::EntryRef entry1 = compile(1);
+  XlaCompilationCache::EntryRef entry2 = compile(2);
+  // Makes the first entry more recently used than the second one.
+  EXPECT_EQ(compile(1), entry1);
+  XlaCompilationCache::EntryRef entry3 = compile(3);
+
+  // Only the evicted entry is no longer referenced by the cache.
+  EXPECT_EQ(entry1.use_count(), 2);
+  EXPECT_EQ(entry2.use_count(), 1);
+  EXPECT_EQ(entry3.use_count(), 2);
+  EXPECT_NE(compile(2), entry2);
+}
+
 }  // namespace
 }  // namespace tensorflow
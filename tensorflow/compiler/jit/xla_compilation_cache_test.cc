@@ -15,13 +15,87 @@ limitations under the License.
 
 #include "tensorflow/compiler/jit/xla_compilation_cache.h"
 
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/match.h"
 #include "tensorflow/compiler/jit/flags.h"
+#include "tensorflow/compiler/jit/xla_compilation_cache.pb.h"
 #include "tensorflow/compiler/tf2xla/shape_util.h"
 #include "tensorflow/compiler/xla/client/client_library.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 
 namespace tensorflow {
+
+// Gives the tests access to the internals of XlaCompilationCache.
+class XlaCompilationCacheTestPeer {
+ public:
+  static uint64 CompilerFingerprint(absl::string_view platform_name,
+                                    const xla::DebugOptions& debug_options) {
+    return XlaCompilationCache::CompilerFingerprint(platform_name,
+                                                    debug_options);
+  }
+
+  static Status SaveSerializedEntry(XlaCompilationCache* cache,
+                                    const XlaSerializedCacheEntry& entry) {
+    return cache->SaveSerializedEntry(entry);
+  }
+
+  static StatusOr<absl::optional<XlaSerializedCacheEntry>>
+  TryLoadSerializedEntry(XlaCompilationCache* cache,
+                         const XlaSerializedCacheKey& key) {
+    return cache->TryLoadSerializedEntry(key);
+  }
+
+  static constexpr int64_t kMaxNumOngoingCompilations =
+      XlaCompilationCache::AsyncCompilationState::kMaxNumOngoingCompilations;
+  static constexpr int64_t kMaxNumPendingCompilations =
+      XlaCompilationCache::AsyncCompilationState::kMaxNumPendingCompilations;
+
+  // Pretends that `num_ongoing_compilations` compilations are running, and
+  // starts the pending compilations for which a compiler thread is left.
+  static void SetNumOngoingCompilations(XlaCompilationCache* cache,
+                                        int64_t num_ongoing_compilations) {
+    auto& state = cache->async_compilation_state_;
+    mutex_lock lock(state.async_compilation_state_mu);
+    state.num_ongoing_compilations = num_ongoing_compilations;
+    cache->SchedulePendingCompilations();
+  }
+
+  // Queues `compile` for a new entry requested `request_count` times, and
+  // returns a reference to the entry.
+  static XlaCompilationCache::EntryRef AddPendingCompilation(
+      XlaCompilationCache* cache, int64_t request_count,
+      std::function<void()> compile) {
+    std::shared_ptr<XlaCompilationCache::Entry> entry = cache->NewEntry();
+    entry->request_count = request_count;
+    auto& state = cache->async_compilation_state_;
+    mutex_lock lock(state.async_compilation_state_mu);
+    state.pending_compilations.push_back({entry, std::move(compile)});
+    cache->SchedulePendingCompilations();
+    return entry;
+  }
+
+  // Returns whether the first execution of a cluster is compiled
+  // asynchronously.
+  static bool ShouldCompileAsynchronously(XlaCompilationCache* cache) {
+    NameAttrList function;
+    function.set_name("afunction");
+    return cache->ShouldCompileCluster(
+        XlaCompilationCache::CompileMode::kAsync, /*is_megamorphic=*/false,
+        /*is_first_execution=*/true, /*current_request_count=*/1, function);
+  }
+};
+
 namespace {
 
 using SignatureHash = XlaCompilationCache::Signature::Hash;
@@ -92,6 +166,169 @@ TEST(XlaCompilationCacheTest, SignatureUniqueness) {
   EXPECT_FALSE(s1 == s2);
 }
 
+TEST(XlaCompilationCacheTest, CompilerFingerprintIgnoresDumpFlags) {
+  xla::DebugOptions debug_options;
+  const uint64 fingerprint =
+      XlaCompilationCacheTestPeer::CompilerFingerprint("Host", debug_options);
+
+  debug_options.set_xla_dump_to("/tmp/xla_dump");
+  debug_options.set_xla_dump_hlo_as_text(true);
+  debug_options.set_xla_detailed_logging_and_dumping(true);
+  EXPECT_EQ(
+      XlaCompilationCacheTestPeer::CompilerFingerprint("Host", debug_options),
+      fingerprint);
+
+  debug_options.set_xla_backend_optimization_level(1);
+  EXPECT_NE(
+      XlaCompilationCacheTestPeer::CompilerFingerprint("Host", debug_options),
+      fingerprint);
+  EXPECT_NE(XlaCompilationCacheTestPeer::CompilerFingerprint(
+                "CUDA", xla::DebugOptions()),
+            fingerprint);
+}
+
+XlaSerializedCacheEntry SerializedEntryForTest() {
+  XlaSerializedCacheEntry entry;
+  XlaSerializedCacheKey* key = entry.mutable_key();
+  key->set_signature_fingerprint(1);
+  key->set_cluster_fingerprint(2);
+  key->set_device_type(DEVICE_CPU_XLA_JIT);
+  key->set_compiler_fingerprint(3);
+  entry.set_executable("executable");
+  return entry;
+}
+
+TEST(XlaCompilationCacheTest, CompilerFingerprintMismatchIsMiss) {
+  const std::string directory =
+      io::JoinPath(testing::TmpDir(), "compiler_fingerprint_mismatch");
+  auto cache = new XlaCompilationCache(
+      XlaCompilationCache::Config(directory,
+                                  /*disable_strict_signature_checks=*/false,
+                                  /*persistance_prefix=*/""),
+      xla::ClientLibrary::LocalClientOrDie(), DeviceType(DEVICE_CPU_XLA_JIT));
+  core::ScopedUnref cache_ref(cache);
+
+  const XlaSerializedCacheEntry entry = SerializedEntryForTest();
+  TF_ASSERT_OK(XlaCompilationCacheTestPeer::SaveSerializedEntry(cache, entry));
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      absl::optional<XlaSerializedCacheEntry> loaded,
+      XlaCompilationCacheTestPeer::TryLoadSerializedEntry(cache, entry.key()));
+  ASSERT_TRUE(loaded.has_value());
+  EXPECT_EQ(loaded->executable(), entry.executable());
+
+  XlaSerializedCacheKey key = entry.key();
+  key.set_compiler_fingerprint(key.compiler_fingerprint() + 1);
+  TF_ASSERT_OK_AND_ASSIGN(
+      loaded, XlaCompilationCacheTestPeer::TryLoadSerializedEntry(cache, key));
+  EXPECT_FALSE(loaded.has_value());
+}
+
+TEST(XlaCompilationCacheTest, SaveSerializedEntryLeavesNoPartialFile) {
+  Env* env = Env::Default();
+  const std::string directory =
+      io::JoinPath(testing::TmpDir(), "save_serialized_entry");
+  auto cache = new XlaCompilationCache(
+      XlaCompilationCache::Config(directory,
+                                  /*disable_strict_signature_checks=*/false,
+                                  /*persistance_prefix=*/""),
+      xla::ClientLibrary::LocalClientOrDie(), DeviceType(DEVICE_CPU_XLA_JIT));
+  core::ScopedUnref cache_ref(cache);
+
+  const XlaSerializedCacheEntry entry = SerializedEntryForTest();
+  TF_ASSERT_OK(XlaCompilationCacheTestPeer::SaveSerializedEntry(cache, entry));
+  // Overwriting the entry replaces the file.
+  TF_ASSERT_OK(XlaCompilationCacheTestPeer::SaveSerializedEntry(cache, entry));
+  std::vector<std::string> children;
+  TF_ASSERT_OK(env->GetChildren(directory, &children));
+  ASSERT_EQ(children.size(), 1);
+  const std::string file_name = children[0];
+  EXPECT_TRUE(absl::EndsWith(file_name, ".pb")) << file_name;
+
+  // Fails to move the written file in place of a directory, which must not
+  // leave the temporary file behind.
+  const std::string file_path = io::JoinPath(directory, file_name);
+  TF_ASSERT_OK(env->DeleteFile(file_path));
+  TF_ASSERT_OK(env->CreateDir(file_path));
+  EXPECT_FALSE(
+      XlaCompilationCacheTestPeer::SaveSerializedEntry(cache, entry).ok());
+  children.clear();
+  TF_ASSERT_OK(env->GetChildren(directory, &children));
+  EXPECT_EQ(children, std::vector<std::string>({file_name}));
+}
+
+TEST(XlaCompilationCacheTest, HottestPendingCompilationStartsFirst) {
+  auto cache = new XlaCompilationCache(XlaCompilationCache::Config(),
+                                       xla::ClientLibrary::LocalClientOrDie(),
+                                       DeviceType(DEVICE_CPU_XLA_JIT));
+  core::ScopedUnref cache_ref(cache);
+
+  // Keeps the compilations pending while they are queued.
+  XlaCompilationCacheTestPeer::SetNumOngoingCompilations(
+      cache, XlaCompilationCacheTestPeer::kMaxNumOngoingCompilations);
+  mutex mu;
+  std::vector<int64_t> started;
+  BlockingCounter done(3);
+  std::vector<XlaCompilationCache::EntryRef> entries;
+  for (int64_t request_count : {1, 3, 2}) {
+    entries.push_back(XlaCompilationCacheTestPeer::AddPendingCompilation(
+        cache, request_count, [&, request_count] {
+          {
+            mutex_lock lock(mu);
+            started.push_back(request_count);
+          }
+          done.DecrementCount();
+        }));
+  }
+
+  // Frees a single compiler thread, which runs the compilations one by one.
+  XlaCompilationCacheTestPeer::SetNumOngoingCompilations(
+      cache, XlaCompilationCacheTestPeer::kMaxNumOngoingCompilations - 1);
+  done.Wait();
+  mutex_lock lock(mu);
+  EXPECT_EQ(started, std::vector<int64_t>({3, 2, 1}));
+}
+
+TEST(XlaCompilationCacheTest, PendingCompilationsAreBounded) {
+  auto cache = new XlaCompilationCache(XlaCompilationCache::Config(),
+                                       xla::ClientLibrary::LocalClientOrDie(),
+                                       DeviceType(DEVICE_CPU_XLA_JIT));
+  core::ScopedUnref cache_ref(cache);
+
+  XlaCompilationCacheTestPeer::SetNumOngoingCompilations(
+      cache, XlaCompilationCacheTestPeer::kMaxNumOngoingCompilations);
+  for (int64_t i = 0;
+       i < XlaCompilationCacheTestPeer::kMaxNumPendingCompilations - 1; ++i) {
+    XlaCompilationCacheTestPeer::AddPendingCompilation(
+        cache, /*request_count=*/1, [] {});
+  }
+  EXPECT_TRUE(XlaCompilationCacheTestPeer::ShouldCompileAsynchronously(cache));
+
+  // First executions don't bypass a full queue either.
+  XlaCompilationCacheTestPeer::AddPendingCompilation(
+      cache, /*request_count=*/1, [] {});
+  EXPECT_FALSE(XlaCompilationCacheTestPeer::ShouldCompileAsynchronously(cache));
+}
+
+TEST(XlaCompilationCacheTest, DestructorDropsPendingCompilations) {
+  auto cache = new XlaCompilationCache(XlaCompilationCache::Config(),
+                                       xla::ClientLibrary::LocalClientOrDie(),
+                                       DeviceType(DEVICE_CPU_XLA_JIT));
+
+  XlaCompilationCacheTestPeer::SetNumOngoingCompilations(
+      cache, XlaCompilationCacheTestPeer::kMaxNumOngoingCompilations);
+  std::atomic<bool> started{false};
+  XlaCompilationCache::EntryRef entry =
+      XlaCompilationCacheTestPeer::AddPendingCompilation(
+          cache, /*request_count=*/1, [&] { started = true; });
+  EXPECT_EQ(entry.use_count(), 2);
+
+  cache->Unref();
+  EXPECT_FALSE(started);
+  // The dropped compilation released its entry.
+  EXPECT_EQ(entry.use_count(), 1);
+}
+
 void BM_BuildSignature(::testing::benchmark::State& state) {
   const int n_args = state.range(0);
 
@@ -71,7 +71,8 @@ VariableInfo::VariableInfo(VariableInfo&& other)
     : index_(other.index_),
       var_(other.var_),
       definition_stack_trace_(other.definition_stack_trace_),
-      lock_held_(other.lock_held_) {
+      lock_held_(other.lock_held_),
+      lock_elided_(other.lock_elided_) {
   other.index_ = -1;
   other.var_ = nullptr;
 }
@@ -80,6 +81,7 @@ VariableInfo& VariableInfo::operator=(VariableInfo&& other) {
   index_ = other.index_;
   var_ = other.var_;
   lock_held_ = other.lock_held_;
+  lock_elided_ = other.lock_elided_;
   definition_stack_trace_ = other.definition_stack_trace_;
 
   other.index_ = -1;
@@ -140,7 +142,12 @@ std::vector<const Tensor*> InputsFromContext(OpKernelContext* ctx) {
   return inputs;
 }
 
-Status LockVariables(absl::Span<VariableInfo*> variables) {
+namespace {
+
+// Acquires the mutexes of `variables` if `lock`, or marks their locks as
+// elided otherwise, after checking that no variable is passed twice.
+Status AcquireVariables(absl::Span<VariableInfo*> variables, bool lock)
+    TF_NO_THREAD_SAFETY_ANALYSIS {
   std::vector<int> lock_order(variables.size());
   std::iota(lock_order.begin(), lock_order.end(), 0);
 
@@ -175,23 +182,41 @@ Status LockVariables(absl::Span<VariableInfo*> variables) {
       // TODO(b/128495870) Add support for passing aliased resource variables.
       return errors::Unimplemented("Duplicate variable passed to XLA cluster");
     }
-    VLOG(4) << "Acquiring lock for variable "
-            << reinterpret_cast<void*>(variable);
-    mu->lock();
-    variables[i]->set_lock_held();
+    if (lock) {
+      VLOG(4) << "Acquiring lock for variable "
+              << reinterpret_cast<void*>(variable);
+      mu->lock();
+      variables[i]->set_lock_held();
+    } else {
+      variables[i]->set_lock_elided();
+    }
     prev = mu;
   }
   VLOG(4) << "Finished acquiring variable locks.";
   return Status::OK();
 }
 
-Status LockVariables(absl::Span<VariableInfo> variables) {
+Status AcquireVariables(absl::Span<VariableInfo> variables, bool lock) {
   std::vector<VariableInfo*> variable_ptrs;
   variable_ptrs.reserve(variables.size());
   for (auto& var : variables) {
     variable_ptrs.push_back(&var);
   }
-  return LockVariables(absl::MakeSpan(variable_ptrs));
+  return AcquireVariables(absl::MakeSpan(variable_ptrs), lock);
+}
+
+}  // namespace
+
+Status LockVariables(absl::Span<VariableInfo*> variables) {
+  return AcquireVariables(variables, /*lock=*/true);
+}
+
+Status LockVariables(absl::Span<VariableInfo> variables) {
+  return AcquireVariables(variables, /*lock=*/true);
+}
+
+Status ElideVariableLocks(absl::Span<VariableInfo> variables) {
+  return AcquireVariables(variables, /*lock=*/false);
 }
 
 Status SnapshotResourceVariables(OpKernelContext* ctx,
@@ -240,13 +265,52 @@ static void PopulateExecutionInputBuffer(xla::ExecutionInput& execution_input,
   }
 }
 
+std::vector<XlaComputationLaunchContext::InputLayout>
+XlaComputationLaunchContext::ComputeInputLayouts(
+    const XlaCompiler::CompilationResult& compilation_result,
+    const std::map<int, const Tensor*>& resource_vars,
+    const xla::HloInputOutputAliasConfig& input_output_alias) {
+  std::vector<InputLayout> input_layouts;
+  input_layouts.reserve(compilation_result.xla_input_shapes.size());
+  for (int i = 0, end = compilation_result.xla_input_shapes.size(); i < end;
+       ++i) {
+    int arg_num = compilation_result.input_mapping[i];
+    InputLayout layout;
+    layout.host_shape = xla::ShapeUtil::DeviceShapeToHostShape(
+        compilation_result.xla_input_shapes[i]);
+    layout.is_updated_resource_variable =
+        resource_vars.count(arg_num) &&
+        absl::c_any_of(compilation_result.resource_updates,
+                       [&](const XlaCompiler::ResourceUpdate& update) {
+                         // XlaCompiler records `arg_num` (instead of kernel
+                         // parameters) in `resource_updates`.
+                         return update.input_index == arg_num &&
+                                update.modified;
+                       });
+    layout.has_alias =
+        input_output_alias.ParameterHasAlias(i, xla::ShapeIndex{});
+    input_layouts.push_back(std::move(layout));
+  }
+  return input_layouts;
+}
+
 StatusOr<std::vector<xla::ExecutionInput>>
 XlaComputationLaunchContext::PopulateInputs(
     OpKernelContext* ctx,
     const XlaCompiler::CompilationResult* compilation_result,
     const std::map<int, const Tensor*>& resource_vars,
     int missing_ctx_input_prefix,
-    const xla::HloInputOutputAliasConfig& input_output_alias) {
+    const xla::HloInputOutputAliasConfig& input_output_alias,
+    absl::Span<const InputLayout> input_layouts) {
+  std::vector<InputLayout> computed_input_layouts;
+  if (input_layouts.empty()) {
+    computed_input_layouts = ComputeInputLayouts(
+        *compilation_result, resource_vars, input_output_alias);
+    input_layouts = computed_input_layouts;
+  }
+  TF_RET_CHECK(input_layouts.size() ==
+               compilation_result->xla_input_shapes.size());
+
   std::vector<xla::ExecutionInput> arguments;
   arguments.reserve(compilation_result->xla_input_shapes.size());
 
@@ -255,27 +319,18 @@ XlaComputationLaunchContext::PopulateInputs(
     int arg_num = compilation_result->input_mapping[i];
     CHECK_GE(arg_num, missing_ctx_input_prefix);
     const xla::Shape& device_shape = compilation_result->xla_input_shapes[i];
-    const xla::Shape& host_shape =
-        xla::ShapeUtil::DeviceShapeToHostShape(device_shape);
+    const xla::Shape& host_shape = input_layouts[i].host_shape;
 
     bool is_resource_variable = resource_vars.count(arg_num);
     bool is_updated_resource_variable =
-        is_resource_variable &&
-        absl::c_any_of(compilation_result->resource_updates,
-                       [&](const XlaCompiler::ResourceUpdate& update) {
-                         // XlaCompiler records `arg_num` (instead of kernel
-                         // parameters) in `resource_updates`.
-                         return update.input_index == arg_num &&
-                                update.modified;
-                       });
+        input_layouts[i].is_updated_resource_variable;
 
     const Tensor* t = is_resource_variable
                           ? resource_vars.at(arg_num)
                           : &(ctx->input(arg_num - missing_ctx_input_prefix));
     CHECK(t);
-    bool donate_buffer =
-        t->RefCountIsOne() && is_updated_resource_variable &&
-        input_output_alias.ParameterHasAlias(i, xla::ShapeIndex{});
+    bool donate_buffer = t->RefCountIsOne() && is_updated_resource_variable &&
+                         input_layouts[i].has_alias;
     VLOG(3) << "Processing input: " << i
             << "; is_resource_variable=" << is_resource_variable
             << "; is_updated_resource_variable=" << is_updated_resource_variable
@@ -633,7 +688,7 @@ XlaComputationLaunchContext::BuildXlaCompilerArguments(
 
   absl::flat_hash_map<int, const VariableInfo*> variable_info_lookup;
   for (const VariableInfo& info : variable_args) {
-    CHECK(!info.var() || info.lock_held())
+    CHECK(!info.var() || info.lock_held() || info.lock_elided())
         << "Need to hold the lock on resource variables "
            "before calling BuildXlaCompilerArguments";
     variable_info_lookup.emplace(info.index(), &info);
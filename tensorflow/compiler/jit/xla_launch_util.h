@@ -70,6 +70,12 @@ class VariableInfo {
   bool lock_held() const { return lock_held_; }
   void set_lock_held() { lock_held_ = true; }
 
+  // Returns true if the caller guarantees that no other op accesses the
+  // resource variable while this VariableInfo is alive, so that its lock does
+  // not need to be acquired.
+  bool lock_elided() const { return lock_elided_; }
+  void set_lock_elided() { lock_elided_ = true; }
+
   const absl::optional<ManagedStackTrace>& definition_stack_trace() const {
     return definition_stack_trace_;
   }
@@ -86,6 +92,7 @@ class VariableInfo {
   // thread safety analysis. Instead we use a boolean flag and release the lock
   // in the VariableInfo destructor.
   bool lock_held_ = false;
+  bool lock_elided_ = false;
 };
 
 // Creates a list of updated resource variables.
@@ -118,6 +125,11 @@ Status LockVariables(absl::Span<VariableInfo*> variables)
 Status LockVariables(absl::Span<VariableInfo> variables)
     TF_EXCLUSIVE_LOCK_FUNCTION();
 
+// Like LockVariables, but for callers that guarantee that no other op accesses
+// the variables concurrently, e.g. training loops that run one step at a time:
+// checks the variables the same way but does not acquire their mutexes.
+Status ElideVariableLocks(absl::Span<VariableInfo> variables);
+
 // Returns a vector of VariableInfo instances for the resource variable inputs,
 // given that *all* inputs are in `inputs`. The input indices for the resource
 // variable inputs are in `variable_indices`.
@@ -146,9 +158,29 @@ class XlaComputationLaunchContext {
                               int device_ordinal, bool allocate_xla_tensors,
                               bool use_multiple_streams);
 
+  // The information PopulateInputs needs about an input of a compiled
+  // computation that does not change from run to run.
+  struct InputLayout {
+    // The shape of the input on the host.
+    xla::Shape host_shape;
+    // True if the input is a resource variable updated by the computation.
+    bool is_updated_resource_variable;
+    // True if the input buffer may be aliased with an output.
+    bool has_alias;
+  };
+
+  // Returns the layouts of the inputs of `compilation_result`, in the order of
+  // its xla_input_shapes. `resource_vars` contains (at least) the TensorFlow
+  // argument numbers of the resource variable inputs.
+  static std::vector<InputLayout> ComputeInputLayouts(
+      const XlaCompiler::CompilationResult& compilation_result,
+      const std::map<int, const Tensor*>& resource_vars,
+      const xla::HloInputOutputAliasConfig& input_output_alias);
+
   // Builds a XlaCompiler::Argument vector from the arguments to an XlaLaunch
   // op.
-  // Precondition: variables in `variable_args` are locked.
+  // Precondition: variables in `variable_args` are locked, or their locks are
+  // elided.
   static StatusOr<std::vector<XlaCompiler::Argument>> BuildXlaCompilerArguments(
       absl::Span<int const> must_be_constant_idxs,
       absl::Span<const Tensor* const> inputs,
@@ -161,12 +193,17 @@ class XlaComputationLaunchContext {
   // missing and adjusts input indices accordingly.  All elements in kernel's
   // input_mapping must be greater than or equal to `missing_ctx_input_prefix`
   // (in other words, no inputs actually required by the kernel can be missing).
+  //
+  // `input_layouts`, if not empty, are the ComputeInputLayouts of
+  // `compilation_result`, which callers may cache across runs. Otherwise they
+  // are computed on each call.
   StatusOr<std::vector<xla::ExecutionInput>> PopulateInputs(
       OpKernelContext* ctx,
       const XlaCompiler::CompilationResult* compilation_result,
       const std::map<int, const Tensor*>& resource_vars,
       int missing_ctx_input_prefix,
-      const xla::HloInputOutputAliasConfig& input_output_alias);
+      const xla::HloInputOutputAliasConfig& input_output_alias,
+      absl::Span<const InputLayout> input_layouts = {});
 
   // Given the XLA output in `output`, populate all outputs of `ctx`.  Also
   // writes out the resource variable updates.
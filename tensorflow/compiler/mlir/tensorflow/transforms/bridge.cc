@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/mlir/tensorflow/transforms/passes.h"
 #include "tensorflow/compiler/mlir/tensorflow/utils/bridge_logger.h"
+#include "tensorflow/compiler/mlir/tensorflow/utils/bridge_pass_timing.h"
 #include "tensorflow/compiler/mlir/tensorflow/utils/dump_mlir_util.h"
 #include "tensorflow/compiler/mlir/tensorflow/utils/error_util.h"
 #include "tensorflow/core/framework/metrics.h"
@@ -53,6 +54,7 @@ tensorflow::Status RunTFXLABridge(
     llvm::function_ref<void(OpPassManager &pm)> pipeline_builder) {
   PassManager bridge(module.getContext());
   ::tensorflow::applyTensorflowAndCLOptions(bridge);
+  ::tensorflow::AddBridgePassTimingInstrumentation(bridge, "TfMlirBridge");
   if (enable_logging || VLOG_IS_ON(1)) {
     tensorflow::DumpMlirOpToFile("tf_xla_bridge_before", module);
     if (VLOG_IS_ON(2)) EnableDetailedLogging(&bridge);
@@ -0,0 +1,64 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/mlir/tensorflow/utils/bridge_pass_timing.h"
+
+#include <memory>
+
+#include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace tensorflow {
+
+void BridgePassTimingInstrumentation::runBeforePass(mlir::Pass* pass,
+                                                    mlir::Operation* op) {
+  const uint64 now = Env::Default()->NowMicros();
+  mutex_lock lock(mu_);
+  start_times_[{pass, op}] = now;
+}
+
+void BridgePassTimingInstrumentation::runAfterPass(mlir::Pass* pass,
+                                                   mlir::Operation* op) {
+  Report(pass, op);
+}
+
+void BridgePassTimingInstrumentation::runAfterPassFailed(mlir::Pass* pass,
+                                                         mlir::Operation* op) {
+  Report(pass, op);
+}
+
+void BridgePassTimingInstrumentation::Report(mlir::Pass* pass,
+                                             mlir::Operation* op) {
+  const uint64 now = Env::Default()->NowMicros();
+  uint64 start;
+  {
+    mutex_lock lock(mu_);
+    auto it = start_times_.find({pass, op});
+    if (it == start_times_.end()) return;
+    start = it->second;
+    start_times_.erase(it);
+  }
+  metrics::GetGraphOptimizationCounter()
+      ->GetCell(pipeline_, pass->getName().str())
+      ->IncrementBy(now - start);
+}
+
+void AddBridgePassTimingInstrumentation(mlir::PassManager& pm,
+                                        const std::string& pipeline) {
+  pm.addInstrumentation(
+      std::make_unique<BridgePassTimingInstrumentation>(pipeline));
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,68 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_MLIR_TENSORFLOW_UTILS_BRIDGE_PASS_TIMING_H_
+#define TENSORFLOW_COMPILER_MLIR_TENSORFLOW_UTILS_BRIDGE_PASS_TIMING_H_
+
+#include <string>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "mlir/IR/Operation.h"  // from @llvm-project
+#include "mlir/Pass/Pass.h"  // from @llvm-project
+#include "mlir/Pass/PassInstrumentation.h"  // from @llvm-project
+#include "mlir/Pass/PassManager.h"  // from @llvm-project
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Pass instrumentation that adds the time spent in each pass of a pipeline to
+// the /tensorflow/core/graph_optimization_usecs metric, with the pipeline as
+// the `kind` label and the pass name as the `name` label.
+//
+// Unlike mlir::PassManager::enableTiming(), this is cheap enough to be always
+// on, and it can be used while passes run on several functions in parallel, in
+// which case the time of a pass is the sum of its time on each function. The
+// time of a nested pipeline is reported under the name of its pass adaptor, in
+// addition to the time of the passes it runs.
+class BridgePassTimingInstrumentation : public mlir::PassInstrumentation {
+ public:
+  explicit BridgePassTimingInstrumentation(std::string pipeline)
+      : pipeline_(std::move(pipeline)) {}
+
+  void runBeforePass(mlir::Pass* pass, mlir::Operation* op) override;
+  void runAfterPass(mlir::Pass* pass, mlir::Operation* op) override;
+  void runAfterPassFailed(mlir::Pass* pass, mlir::Operation* op) override;
+
+ private:
+  void Report(mlir::Pass* pass, mlir::Operation* op);
+
+  const std::string pipeline_;
+  mutex mu_;
+  // Start time of the running passes, per pass and operation.
+  absl::flat_hash_map<std::pair<mlir::Pass*, mlir::Operation*>, uint64>
+      start_times_ TF_GUARDED_BY(mu_);
+};
+
+// Reports the time spent in each pass of `pm` to the graph optimization
+// metric, under `pipeline`.
+void AddBridgePassTimingInstrumentation(mlir::PassManager& pm,
+                                        const std::string& pipeline);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_MLIR_TENSORFLOW_UTILS_BRIDGE_PASS_TIMING_H_
@@ -46,6 +46,7 @@ limitations under the License.
 #include "tensorflow/compiler/mlir/tensorflow/translate/import_model.h"
 #include "tensorflow/compiler/mlir/tensorflow/translate/mlir_roundtrip_flags.h"
 #include "tensorflow/compiler/mlir/tensorflow/utils/bridge_logger.h"
+#include "tensorflow/compiler/mlir/tensorflow/utils/bridge_pass_timing.h"
 #include "tensorflow/compiler/mlir/tensorflow/utils/convert_tensor.h"
 #include "tensorflow/compiler/mlir/tensorflow/utils/convert_type.h"
 #include "tensorflow/compiler/mlir/tensorflow/utils/dump_mlir_util.h"
@@ -388,6 +389,7 @@ Status LegalizeToHlo(mlir::ModuleOp module_op, llvm::StringRef device_type,
                          custom_legalization_passes) {
   mlir::PassManager tf2xla(module_op.getContext());
   applyTensorflowAndCLOptions(tf2xla);
+  AddBridgePassTimingInstrumentation(tf2xla, "TfMlirLegalizeToHlo");
   CreateConvertMlirToXlaHloPipeline(tf2xla, device_type, prefer_tf2xla,
                                     custom_legalization_passes);
 
@@ -684,6 +686,7 @@ Status CompileGraphSetup(
 
   mlir::PassManager pm(module_op.getContext());
   applyTensorflowAndCLOptions(pm);
+  AddBridgePassTimingInstrumentation(pm, "TfMlirCompileGraphSetup");
   mlir::TF::StandardPipelineOptions tf_options;
   mlir::TF::CreateTFStandardPipeline(pm, tf_options);
 
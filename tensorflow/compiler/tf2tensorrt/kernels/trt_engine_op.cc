@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 #include <algorithm>
 #include <memory>
+#include <tuple>
+#include <unordered_set>
 #include <vector>
 
 #include "absl/memory/memory.h"
@@ -24,6 +26,7 @@ limitations under the License.
 #include "tensorflow/compiler/tf2tensorrt/convert/convert_nodes.h"
 #include "tensorflow/compiler/tf2tensorrt/convert/utils.h"
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_allocator.h"
+#include "tensorflow/compiler/tf2tensorrt/utils/trt_engine_disk_cache.h"
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_engine_utils.h"
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_logger.h"
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_lru_cache.h"
@@ -42,10 +45,12 @@ limitations under the License.
 #include "tensorflow/core/lib/core/refcount.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/core/util/env_var.h"
@@ -130,6 +135,19 @@ class AsyncHelper : public core::RefCounted {
   AsyncOpKernel::DoneCallback done_;
 };
 
+// Returns the name and compute capability of the GPU of `device`, or an empty
+// string if they are unknown.
+string GetGpuModel(const DeviceBase* device) {
+  const auto* gpu_device_info = device->tensorflow_gpu_device_info();
+  if (gpu_device_info == nullptr) return "";
+  cudaDeviceProp properties;
+  if (cudaGetDeviceProperties(&properties, gpu_device_info->gpu_id) !=
+      cudaSuccess) {
+    return "";
+  }
+  return StrCat(properties.name, " sm_", properties.major, properties.minor);
+}
+
 }  // end anonymous namespace
 
 //  This OP can construct TRTEngine on the fly and if construction of engine
@@ -190,13 +208,42 @@ class TRTEngineOp : public AsyncOpKernel {
       const std::vector<TensorShape>& input_concrete_shapes,
       OpKernelContext* ctx, TRTEngineCacheResource* cache_resource);
 
-  // Builds and returns a cuda engine for the input shapes. If building the
-  // engine fails, enters a dummy entry into the cache_resource cache so we
-  // don't continually try to build the same failing engine.
+  // Builds and returns a cuda engine for the input shapes on the device
+  // named `device_name`. If building the engine fails, the caller should enter
+  // a dummy entry into the cache_resource cache so we don't continually try to
+  // build the same failing engine.
   StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>> BuildEngine(
       const std::vector<TensorShape>& input_concrete_shapes, int batch_size,
       bool use_calibration, TRTInt8Calibrator* calibrator,
-      TRTEngineCacheResource* cache_resource, OpKernelContext* ctx);
+      TRTEngineCacheResource* cache_resource, const string& device_name);
+
+  // Schedules building an engine for the input shapes on
+  // engine_build_pool_, unless one is already being built. The engine is
+  // added to the cache of cache_res once it is built.
+  void BuildEngineInBackground(
+      const std::vector<TensorShape>& input_concrete_shapes, int batch_size,
+      OpKernelContext* ctx, TRTEngineCacheResource* cache_res)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(engine_mutex_);
+
+  // Adds a dynamic engine for the input shapes to the cache of cache_res and
+  // returns its EngineContext.
+  StatusOr<EngineContext*> AddEngineToCache(
+      const std::vector<TensorShape>& input_concrete_shapes,
+      TrtUniquePtrType<nvinfer1::ICudaEngine> engine,
+      TRTEngineCacheResource* cache_res)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(engine_mutex_);
+
+  // Loads the engine stored in the on-disk engine cache for the input shapes.
+  // Returns NotFound if there is none.
+  StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>> LoadEngineFromDiskCache(
+      const std::vector<TensorShape>& input_concrete_shapes,
+      TRTBaseAllocator* allocator);
+
+  // Stores a newly built engine in the on-disk engine cache, if it is
+  // enabled. Failures are logged and otherwise ignored.
+  void SaveEngineToDiskCache(
+      const std::vector<TensorShape>& input_concrete_shapes,
+      nvinfer1::ICudaEngine* engine);
 
   // Verify that the input shapes are consistent and can be handled by this op.
   Status VerifyInputShapes(const std::vector<TensorShape>& shapes);
@@ -268,6 +315,20 @@ class TRTEngineOp : public AsyncOpKernel {
 
   // Whether to use explicit precision (QDQ) mode.
   bool use_explicit_precision_;
+
+  // Directory and key of the engines stored on disk for this segment. The
+  // key is empty if the on-disk engine cache is not used.
+  string engine_disk_cache_dir_;
+  string engine_disk_cache_key_;
+
+  // Input shapes of the engines being built by engine_build_pool_.
+  std::unordered_set<std::vector<TensorShape>, VectorTensorShapeHasher>
+      pending_engine_shapes_ TF_GUARDED_BY(engine_mutex_);
+
+  // Builds engines for new input shapes while the native segment serves the
+  // requests, if set. Declared last so that it is destroyed, waiting for the
+  // builds in flight, before the members they use.
+  std::unique_ptr<thread::ThreadPool> engine_build_pool_;
 };
 
 #define TYPECASE(dt, X, Y)                                    \
@@ -401,6 +462,7 @@ TRTEngineOp::TRTEngineOp(OpKernelConstruction* context)
   string calibration_data;
   OP_REQUIRES_OK(context,
                  context->GetAttr("calibration_data", &calibration_data));
+  const uint64 calibration_data_fingerprint = Fingerprint64(calibration_data);
   OP_REQUIRES_OK(context, context->GetAttr("segment_func", &func_));
   OP_REQUIRES(context, !func_.name().empty(),
               errors::InvalidArgument(
@@ -516,6 +578,37 @@ TRTEngineOp::TRTEngineOp(OpKernelConstruction* context)
                 errors::InvalidArgument(
                     "Dynamic shape mode does not support calibration"));
   }
+
+  // The on-disk engine cache and background builds are only used for the
+  // engines built per input shapes in implicit batch mode. Calibration builds
+  // its own engine.
+  if (!static_engine_ && use_implicit_batch_ && !calibration_mode_) {
+    engine_disk_cache_dir_ = GetEngineDiskCacheDir();
+    const string gpu_model = GetGpuModel(context->device());
+    if (!engine_disk_cache_dir_.empty() && !gpu_model.empty()) {
+      int trt_major, trt_minor, trt_patch;
+      std::tie(trt_major, trt_minor, trt_patch) = GetLoadedTensorRTVersion();
+      engine_disk_cache_key_ = EngineDiskCacheKey(
+          segment_graph_def_,
+          StrCat(precision_string, ",", workspace_size_, ",", use_calibration_,
+                 ",", use_explicit_precision_, ",",
+                 calibration_data_fingerprint),
+          StrCat(trt_major, ".", trt_minor, ".", trt_patch), gpu_model);
+      VLOG(1) << "Engines of " << name() << " are cached in "
+              << engine_disk_cache_dir_ << " with key "
+              << engine_disk_cache_key_;
+    }
+
+    bool build_engines_in_background;
+    OP_REQUIRES_OK(context,
+                   ReadBoolFromEnvVar("TF_TRT_BUILD_ENGINES_IN_BACKGROUND",
+                                      /*default_val=*/false,
+                                      &build_engines_in_background));
+    if (build_engines_in_background && allow_build_at_runtime_) {
+      engine_build_pool_ = absl::make_unique<thread::ThreadPool>(
+          context->env(), "tf_trt_engine_build", /*num_threads=*/1);
+    }
+  }
 }
 
 // Copies input tensor ctx->input(i) (which is in device memory) to the host,
@@ -1008,9 +1101,8 @@ Status TRTEngineOp::GetEngineCacheResource(OpKernelContext* ctx,
 StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>> TRTEngineOp::BuildEngine(
     const std::vector<TensorShape>& input_concrete_shapes, int batch_size,
     bool use_calibration, TRTInt8Calibrator* calibrator,
-    TRTEngineCacheResource* cache_resource, OpKernelContext* ctx) {
+    TRTEngineCacheResource* cache_resource, const string& device_name) {
   TRT_ENSURE(cache_resource);
-  TRT_ENSURE(ctx);
   // Use concrete shapes for implicit batch mode and partial shapes for
   // explicit batch mode.
   bool use_concrete_shapes =
@@ -1026,9 +1118,8 @@ StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>> TRTEngineOp::BuildEngine(
 
   std::unordered_map<string, tensorflow::DeviceProperties> device_map;
   DeviceNameUtils::ParsedName full_parsed_name;
-  DeviceNameUtils::ParseFullName(ctx->device()->name(), &full_parsed_name);
-  device_map.emplace(ctx->device()->name(),
-                     grappler::GetDeviceInfo(full_parsed_name));
+  DeviceNameUtils::ParseFullName(device_name, &full_parsed_name);
+  device_map.emplace(device_name, grappler::GetDeviceInfo(full_parsed_name));
   tensorflow::grappler::VirtualCluster cluster(device_map);
 
   TrtUniquePtrType<nvinfer1::ICudaEngine> engine;
@@ -1042,15 +1133,112 @@ StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>> TRTEngineOp::BuildEngine(
         << "Engine creation for " << name() << " failed. "
         << "The native segment will be used instead. "
         << "Reason: " << status;
-    // Store an empty engine in the cache for these input shapes so we don't try
-    // to build the same failing engine again.
-    cache_resource->cache_.emplace(input_concrete_shapes,
-                                   absl::make_unique<EngineContext>());
     return status;
   }
   return engine;
 }
 
+void TRTEngineOp::BuildEngineInBackground(
+    const std::vector<TensorShape>& input_concrete_shapes, int batch_size,
+    OpKernelContext* ctx, TRTEngineCacheResource* cache_res) {
+  if (!pending_engine_shapes_.insert(input_concrete_shapes).second) return;
+  VLOG(1) << "Building a TensorRT engine in the background for " << name()
+          << " with input shapes: "
+          << TensorShapeUtils::ShapeListString(input_concrete_shapes);
+  const int platform_device_id =
+      ctx->device()->tensorflow_gpu_device_info()->gpu_id;
+  const string device_name = ctx->device()->name();
+  cache_res->Ref();
+  engine_build_pool_->Schedule([this, input_concrete_shapes, batch_size,
+                                platform_device_id, device_name, cache_res]() {
+    core::ScopedUnref sc(cache_res);
+    auto err = cudaSetDevice(platform_device_id);
+    if (err != cudaSuccess) {
+      LOG(ERROR) << "Couldn't set cuda device to " << platform_device_id
+                 << " in engine build thread";
+    }
+    // Up to this point, calibrator_ can never be empty, since otherwise it
+    // means calibration_mode_ is true and no builds are scheduled.
+    auto result =
+        BuildEngine(input_concrete_shapes, batch_size, use_calibration_,
+                    calibrator_.get(), cache_res, device_name);
+    if (result.ok()) {
+      SaveEngineToDiskCache(input_concrete_shapes, result.ValueOrDie().get());
+    }
+    mutex_lock lock(engine_mutex_);
+    pending_engine_shapes_.erase(input_concrete_shapes);
+    if (!result.ok()) {
+      // Store an empty engine in the cache for these input shapes so we don't
+      // try to build the same failing engine again.
+      cache_res->cache_.emplace(input_concrete_shapes,
+                                absl::make_unique<EngineContext>());
+      return;
+    }
+    Status status = AddEngineToCache(
+        input_concrete_shapes, std::move(result.ValueOrDie()), cache_res)
+                        .status();
+    if (!status.ok()) {
+      LOG_FIRST_FEW_WARNING_WITH_PREFIX
+          << "Failed to add the engine built in the background for " << name()
+          << " to the cache: " << status;
+    }
+  });
+}
+
+StatusOr<EngineContext*> TRTEngineOp::AddEngineToCache(
+    const std::vector<TensorShape>& input_concrete_shapes,
+    TrtUniquePtrType<nvinfer1::ICudaEngine> engine,
+    TRTEngineCacheResource* cache_res) {
+  std::vector<ExecutionContext> exec_contexts;
+  TF_RETURN_IF_ERROR(cache_res->profiles_.CreateExecutionContexts(
+      engine.get(), &exec_contexts));
+  auto& cache = cache_res->cache_;
+  cache.emplace(input_concrete_shapes,
+                absl::make_unique<EngineContext>(std::move(engine),
+                                                 std::move(exec_contexts)));
+  VLOG(1) << "Added new engine to cache of " << name()
+          << ". Cache size: " << cache.size();
+  return cache.at(input_concrete_shapes).get();
+}
+
+StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>>
+TRTEngineOp::LoadEngineFromDiskCache(
+    const std::vector<TensorShape>& input_concrete_shapes,
+    TRTBaseAllocator* allocator) {
+  string serialized_engine;
+  TF_RETURN_IF_ERROR(ReadEngineFromDiskCache(
+      engine_disk_cache_dir_, engine_disk_cache_key_, input_concrete_shapes,
+      &serialized_engine));
+  TrtUniquePtrType<IRuntime> infer(nvinfer1::createInferRuntime(logger));
+  infer->setGpuAllocator(allocator);
+  // Need to initialize plugins in order to deserialize engines that contain
+  // plugins.
+  MaybeInitializeTrtPlugins(&logger);
+  TrtUniquePtrType<nvinfer1::ICudaEngine> engine(infer->deserializeCudaEngine(
+      serialized_engine.data(), serialized_engine.size(), nullptr));
+  if (!engine) {
+    return errors::DataLoss("Can't deserialize the cached TensorRT engine for ",
+                            name());
+  }
+  return engine;
+}
+
+void TRTEngineOp::SaveEngineToDiskCache(
+    const std::vector<TensorShape>& input_concrete_shapes,
+    nvinfer1::ICudaEngine* engine) {
+  if (engine_disk_cache_key_.empty()) return;
+  TrtUniquePtrType<nvinfer1::IHostMemory> engine_data(engine->serialize());
+  Status status = WriteEngineToDiskCache(
+      engine_disk_cache_dir_, engine_disk_cache_key_, input_concrete_shapes,
+      absl::string_view(static_cast<const char*>(engine_data->data()),
+                        engine_data->size()));
+  if (!status.ok()) {
+    LOG_FIRST_FEW_WARNING_WITH_PREFIX
+        << "Failed to store the TensorRT engine for " << name() << " in "
+        << engine_disk_cache_dir_ << ": " << status;
+  }
+}
+
 StatusOr<std::pair<EngineContext*, int>> TRTEngineOp::GetEngine(
     const std::vector<TensorShape>& input_concrete_shapes, OpKernelContext* ctx,
     TRTEngineCacheResource* cache_res) {
@@ -1138,8 +1326,13 @@ StatusOr<std::pair<EngineContext*, int>> TRTEngineOp::GetEngine(
       }
       auto result = BuildEngine(input_concrete_shapes, batch_size,
                                 /*use_calibration=*/false,
-                                /*calibrator=*/nullptr, cache_res, ctx);
+                                /*calibrator=*/nullptr, cache_res,
+                                ctx->device()->name());
       if (!result.ok()) {
+        // Store an empty engine in the cache for these input shapes so we
+        // don't try to build the same failing engine again.
+        cache.emplace(input_concrete_shapes,
+                      absl::make_unique<EngineContext>());
         return std::pair<EngineContext*, int>(&empty_context, 0);
       }
       static_engine = std::move(result.ValueOrDie());
@@ -1188,6 +1381,31 @@ StatusOr<std::pair<EngineContext*, int>> TRTEngineOp::GetEngine(
     engine_contexts = cache_res->GetEngineContext(profile_id);
   }
 
+  // The native segment serves the request until the engine being built in
+  // the background is added to the cache.
+  if (engine_contexts == nullptr &&
+      pending_engine_shapes_.count(input_concrete_shapes)) {
+    return std::pair<EngineContext*, int>(&empty_context, 0);
+  }
+
+  // Engines built for these input shapes by earlier runs of the segment are
+  // loaded from the on-disk engine cache.
+  if (engine_contexts == nullptr && !engine_disk_cache_key_.empty()) {
+    auto result = LoadEngineFromDiskCache(input_concrete_shapes, allocator);
+    if (result.ok()) {
+      VLOG(1) << "Loaded engine for " << name() << " from "
+              << engine_disk_cache_dir_;
+      TF_ASSIGN_OR_RETURN(
+          engine_contexts,
+          AddEngineToCache(input_concrete_shapes,
+                           std::move(result.ValueOrDie()), cache_res));
+    } else if (!errors::IsNotFound(result.status())) {
+      LOG_FIRST_FEW_WARNING_WITH_PREFIX
+          << "Failed to load the cached TensorRT engine for " << name()
+          << ": " << result.status();
+    }
+  }
+
   // If cache does not have a compatible engine then create a new engine.
   if (engine_contexts == nullptr) {
     if (!allow_build_at_runtime_) {
@@ -1202,25 +1420,30 @@ StatusOr<std::pair<EngineContext*, int>> TRTEngineOp::GetEngine(
       return std::pair<EngineContext*, int>(&empty_context, 0);
     }
 
+    // Serve the request with the native segment while the engine is built,
+    // if it is allowed to run.
+    if (engine_build_pool_ && AllowEngineNativeSegmentExecution()) {
+      BuildEngineInBackground(input_concrete_shapes, batch_size, ctx,
+                              cache_res);
+      return std::pair<EngineContext*, int>(&empty_context, 0);
+    }
+
     // Up to this point, calibrator_ can never be empty, since otherwise it
     // means calibration_mode_ is true and this path won't get executed.
     auto result =
         BuildEngine(input_concrete_shapes, batch_size, use_calibration_,
-                    calibrator_.get(), cache_res, ctx);
+                    calibrator_.get(), cache_res, ctx->device()->name());
     if (!result.ok()) {
+      // Store an empty engine in the cache for these input shapes so we don't
+      // try to build the same failing engine again.
+      cache.emplace(input_concrete_shapes, absl::make_unique<EngineContext>());
       return std::pair<EngineContext*, int>(&empty_context, 0);
     }
-    TrtUniquePtrType<nvinfer1::ICudaEngine> engine =
-        std::move(result.ValueOrDie());
-    std::vector<ExecutionContext> exec_contexts;
-    TF_RETURN_IF_ERROR(cache_res->profiles_.CreateExecutionContexts(
-        engine.get(), &exec_contexts));
-    cache.emplace(input_concrete_shapes,
-                  absl::make_unique<EngineContext>(std::move(engine),
-                                                   std::move(exec_contexts)));
-    VLOG(1) << "Added new engine to cache of " << name()
-            << ". Cache size: " << cache.size();
-    engine_contexts = cache.at(input_concrete_shapes).get();
+    SaveEngineToDiskCache(input_concrete_shapes, result.ValueOrDie().get());
+    TF_ASSIGN_OR_RETURN(engine_contexts,
+                        AddEngineToCache(input_concrete_shapes,
+                                         std::move(result.ValueOrDie()),
+                                         cache_res));
     // Query which profile of the new engine matches the actual input.
     profile_id = cache_res->profiles_.GetProfileNumber(input_concrete_shapes);
   }
@@ -0,0 +1,119 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/tf2tensorrt/utils/trt_engine_disk_cache.h"
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/compiler/tf2tensorrt/utils/trt_engine_instance.pb.h"  // NOLINT
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace tensorrt {
+namespace {
+
+// Returns the name of the file that stores the engine for `key` and
+// `input_shapes`.
+string EngineFileName(const string& dir, const string& key,
+                      const std::vector<TensorShape>& input_shapes) {
+  const uint64 shapes_fingerprint =
+      Fingerprint64(TensorShapeUtils::ShapeListString(input_shapes));
+  return io::JoinPath(
+      dir, absl::StrCat(key, "_",
+                        absl::Hex(shapes_fingerprint, absl::kZeroPad16),
+                        ".trtengine"));
+}
+
+}  // namespace
+
+string GetEngineDiskCacheDir() {
+  string dir;
+  Status status = ReadStringFromEnvVar("TF_TRT_ENGINE_CACHE_DIR",
+                                       /*default_val=*/"", &dir);
+  if (!status.ok()) {
+    LOG(ERROR) << status;
+    return "";
+  }
+  return dir;
+}
+
+string EngineDiskCacheKey(const GraphDef& segment_graph_def,
+                          absl::string_view build_options,
+                          absl::string_view trt_version,
+                          absl::string_view gpu_model) {
+  string serialized_segment;
+  SerializeToStringDeterministic(segment_graph_def, &serialized_segment);
+  const uint64 fingerprint = FingerprintCat64(
+      Fingerprint64(serialized_segment),
+      Fingerprint64(absl::StrCat(build_options, ";", trt_version, ";",
+                                 gpu_model)));
+  return absl::StrCat(absl::Hex(fingerprint, absl::kZeroPad16));
+}
+
+Status ReadEngineFromDiskCache(const string& dir, const string& key,
+                               const std::vector<TensorShape>& input_shapes,
+                               string* serialized_engine) {
+  const string filename = EngineFileName(dir, key, input_shapes);
+  string contents;
+  TF_RETURN_IF_ERROR(ReadFileToString(Env::Default(), filename, &contents));
+  TRTEngineInstance engine_instance;
+  if (!engine_instance.ParseFromString(contents)) {
+    return errors::DataLoss("Can't parse the TensorRT engine in ", filename);
+  }
+  // Different shapes could map to the same file name.
+  bool same_shapes =
+      engine_instance.input_shapes_size() == input_shapes.size();
+  for (int i = 0; same_shapes && i < input_shapes.size(); ++i) {
+    same_shapes = TensorShape(engine_instance.input_shapes(i)) ==
+                  input_shapes[i];
+  }
+  if (!same_shapes) {
+    return errors::NotFound("No TensorRT engine for input shapes ",
+                            TensorShapeUtils::ShapeListString(input_shapes),
+                            " in ", filename);
+  }
+  *serialized_engine = std::move(*engine_instance.mutable_serialized_engine());
+  return Status::OK();
+}
+
+Status WriteEngineToDiskCache(const string& dir, const string& key,
+                              const std::vector<TensorShape>& input_shapes,
+                              absl::string_view serialized_engine) {
+  TRTEngineInstance engine_instance;
+  for (const TensorShape& shape : input_shapes) {
+    shape.AsProto(engine_instance.add_input_shapes());
+  }
+  engine_instance.set_serialized_engine(serialized_engine.data(),
+                                        serialized_engine.size());
+
+  Env* env = Env::Default();
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(dir));
+  const string filename = EngineFileName(dir, key, input_shapes);
+  const string tmp_filename =
+      absl::StrCat(filename, ".", absl::Hex(random::New64()), ".tmp");
+  TF_RETURN_IF_ERROR(WriteStringToFile(env, tmp_filename,
+                                       engine_instance.SerializeAsString()));
+  Status status = env->RenameFile(tmp_filename, filename);
+  if (!status.ok()) env->DeleteFile(tmp_filename).IgnoreError();
+  return status;
+}
+
+}  // namespace tensorrt
+}  // namespace tensorflow
@@ -0,0 +1,64 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_TF2TENSORRT_UTILS_TRT_ENGINE_DISK_CACHE_H_
+#define TENSORFLOW_COMPILER_TF2TENSORRT_UTILS_TRT_ENGINE_DISK_CACHE_H_
+
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace tensorrt {
+
+// Engines built at runtime by TRTEngineOp can be stored on disk, so that
+// later runs of the same model, possibly in other processes, load them
+// instead of building them again. Each engine is stored in its own file in
+// the directory named by the TF_TRT_ENGINE_CACHE_DIR environment variable.
+
+// Returns the directory of the on-disk engine cache, or an empty string if
+// the cache is disabled.
+string GetEngineDiskCacheDir();
+
+// Returns the key of the engines built for a segment. An engine can only be
+// reused by the same segment graph, built with the same `build_options`
+// (precision mode, workspace size, ...), by the same TensorRT version and
+// for the same GPU model.
+string EngineDiskCacheKey(const GraphDef& segment_graph_def,
+                          absl::string_view build_options,
+                          absl::string_view trt_version,
+                          absl::string_view gpu_model);
+
+// Reads the serialized engine stored in `dir` for `key` and `input_shapes`.
+// Returns NotFound if there is no such engine.
+Status ReadEngineFromDiskCache(const string& dir, const string& key,
+                               const std::vector<TensorShape>& input_shapes,
+                               string* serialized_engine);
+
+// Stores `serialized_engine` in `dir` for `key` and `input_shapes`. The
+// engine is written to a temporary file that is then renamed, so concurrent
+// readers never see a partially written engine.
+Status WriteEngineToDiskCache(const string& dir, const string& key,
+                              const std::vector<TensorShape>& input_shapes,
+                              absl::string_view serialized_engine);
+
+}  // namespace tensorrt
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_TF2TENSORRT_UTILS_TRT_ENGINE_DISK_CACHE_H_
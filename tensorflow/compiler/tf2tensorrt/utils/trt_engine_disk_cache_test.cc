@@ -0,0 +1,72 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/tf2tensorrt/utils/trt_engine_disk_cache.h"
+
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace tensorrt {
+namespace {
+
+GraphDef SegmentGraph(const string& op) {
+  GraphDef graph_def;
+  NodeDef* node = graph_def.add_node();
+  node->set_name("node");
+  node->set_op(op);
+  return graph_def;
+}
+
+TEST(EngineDiskCacheTest, KeyDependsOnAllComponents) {
+  const GraphDef segment = SegmentGraph("Relu");
+  const string key = EngineDiskCacheKey(segment, "FP16", "8.0.1", "V100");
+  EXPECT_EQ(key, EngineDiskCacheKey(segment, "FP16", "8.0.1", "V100"));
+  EXPECT_NE(key, EngineDiskCacheKey(SegmentGraph("Tanh"), "FP16", "8.0.1",
+                                    "V100"));
+  EXPECT_NE(key, EngineDiskCacheKey(segment, "FP32", "8.0.1", "V100"));
+  EXPECT_NE(key, EngineDiskCacheKey(segment, "FP16", "8.2.0", "V100"));
+  EXPECT_NE(key, EngineDiskCacheKey(segment, "FP16", "8.0.1", "T4"));
+}
+
+TEST(EngineDiskCacheTest, RoundTrip) {
+  const string dir = io::JoinPath(testing::TmpDir(), "trt_engine_cache");
+  const std::vector<TensorShape> shapes = {TensorShape({4, 3}),
+                                           TensorShape({4})};
+  string engine;
+  EXPECT_TRUE(
+      errors::IsNotFound(ReadEngineFromDiskCache(dir, "key", shapes, &engine)));
+
+  TF_ASSERT_OK(WriteEngineToDiskCache(dir, "key", shapes, "engine data"));
+  TF_ASSERT_OK(ReadEngineFromDiskCache(dir, "key", shapes, &engine));
+  EXPECT_EQ(engine, "engine data");
+
+  // Engines are stored per key and per input shapes.
+  EXPECT_TRUE(errors::IsNotFound(
+      ReadEngineFromDiskCache(dir, "other_key", shapes, &engine)));
+  EXPECT_TRUE(errors::IsNotFound(ReadEngineFromDiskCache(
+      dir, "key", {TensorShape({8, 3}), TensorShape({8})}, &engine)));
+
+  // Storing the engine again replaces it.
+  TF_ASSERT_OK(WriteEngineToDiskCache(dir, "key", shapes, "new engine"));
+  TF_ASSERT_OK(ReadEngineFromDiskCache(dir, "key", shapes, &engine));
+  EXPECT_EQ(engine, "new engine");
+}
+
+}  // namespace
+}  // namespace tensorrt
+}  // namespace tensorflow
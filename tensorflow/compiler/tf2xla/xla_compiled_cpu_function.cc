@@ -13,10 +13,15 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#define EIGEN_USE_THREADS
+
 #include "tensorflow/compiler/tf2xla/xla_compiled_cpu_function.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/compiler/xla/cpu_function_runtime.h"
 
 namespace tensorflow {
@@ -59,6 +64,44 @@ bool XlaCompiledCpuFunction::Run() {
   return !xla::CustomCallStatusGetMessage(&status).has_value();
 }
 
+bool XlaCompiledCpuFunction::RunMany(
+    const Eigen::ThreadPoolDevice* pool, int64_t num_runs,
+    const std::function<std::unique_ptr<XlaCompiledCpuFunction>()>& create,
+    const std::function<void(XlaCompiledCpuFunction*, int64_t)>& set_args,
+    const std::function<void(XlaCompiledCpuFunction*, int64_t)>&
+        read_results) {
+  const int64_t num_workers =
+      pool == nullptr
+          ? 1
+          : std::max<int64_t>(1, std::min<int64_t>(pool->numThreads(),
+                                                    num_runs));
+  std::atomic<int64_t> next_run(0);
+  std::atomic<bool> ok(true);
+  auto work = [&]() {
+    std::unique_ptr<XlaCompiledCpuFunction> function;
+    for (int64_t i = next_run++; i < num_runs; i = next_run++) {
+      if (function == nullptr) function = create();
+      set_args(function.get(), i);
+      if (function->Run()) {
+        read_results(function.get(), i);
+      } else {
+        ok = false;
+      }
+    }
+  };
+  // The calling thread is one of the workers.
+  Eigen::Barrier barrier(num_workers - 1);
+  for (int64_t w = 1; w < num_workers; ++w) {
+    pool->enqueueNoNotification([&work, &barrier]() {
+      work();
+      barrier.Notify();
+    });
+  }
+  work();
+  barrier.Wait();
+  return ok;
+}
+
 XlaCompiledCpuFunction::~XlaCompiledCpuFunction() {
   xla::cpu_function_runtime::FreeContiguous(alloc_buffer_table_);
   delete[] buffer_table_;
@@ -17,6 +17,8 @@ limitations under the License.
 #define TENSORFLOW_COMPILER_TF2XLA_XLA_COMPILED_CPU_FUNCTION_H_
 
 #include <cassert>
+#include <functional>
+#include <memory>
 #include <string>
 
 #include "tensorflow/compiler/xla/cpu_function_runtime.h"
@@ -135,6 +137,24 @@ class XlaCompiledCpuFunction {
   // written to result buffers. Returns true on success and false on failure.
   bool Run();
 
+  // Runs the computation once for each of `num_runs` independent sets of
+  // inputs, spreading the runs over the threads of `pool`, or running them on
+  // the calling thread if `pool` is null. Each thread creates one function
+  // with `create` and reuses its arg, result and temp buffers for all the runs
+  // it executes. For run i, `set_args(function, i)` is called before the run
+  // and `read_results(function, i)` after it if it succeeded. Both may be
+  // called concurrently for different runs. Returns true if all runs
+  // succeeded.
+  //
+  // The functions are run without an intra-op thread pool: the parallelism
+  // comes from running independent inputs at the same time.
+  static bool RunMany(
+      const Eigen::ThreadPoolDevice* pool, int64_t num_runs,
+      const std::function<std::unique_ptr<XlaCompiledCpuFunction>()>& create,
+      const std::function<void(XlaCompiledCpuFunction*, int64_t)>& set_args,
+      const std::function<void(XlaCompiledCpuFunction*, int64_t)>&
+          read_results);
+
   // Returns the error message from the previous failed Run call.
   //
   // TODO(fschneider): For now this always returns an empty string because there
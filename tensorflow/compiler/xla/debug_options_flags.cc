@@ -89,6 +89,16 @@ DebugOptions DefaultDebugOptionsIgnoringFlags() {
 
   // Set 4GB space limit for redzone scratch allocator.
   opts.set_xla_gpu_redzone_scratch_max_megabytes(1LL << 12);
+  opts.set_xla_gpu_enable_latency_hiding_scheduler(true);
+  opts.set_xla_gpu_latency_hiding_scheduler_memory_limit_bytes(0);
+  opts.set_xla_gpu_enable_cuda_graphs(false);
+  opts.set_xla_gpu_autotune_results_path("");
+  opts.set_xla_spmd_memory_budget_per_device_bytes(0);
+  opts.set_xla_cpu_partition_intra_op_threads(false);
+  opts.set_xla_gpu_enable_reduction_epilogue_fusion(true);
+  opts.set_xla_gpu_enable_gemm_grouping(true);
+  opts.set_xla_cpu_enable_hlo_sampling(false);
+  opts.set_xla_gpu_enable_host_offload(false);
   return opts;
 }
 
@@ -652,6 +662,92 @@ static void AllocateFlags() {
       flag_values->xla_gpu_force_compilation_parallelism(),
       "Overrides normal multi-threaded compilation settting to use this many "
       "threads. Setting to 0 (the default value) means no enforcement."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_cpu_force_compilation_parallelism",
+      int32_setter_for(
+          &DebugOptions::set_xla_cpu_force_compilation_parallelism),
+      flag_values->xla_cpu_force_compilation_parallelism(),
+      "Number of threads generating machine code for a module on XLA:CPU. "
+      "Setting to 0 (the default value) uses the thread pool of the compile "
+      "options if any, and 1 compiles on a single thread."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_cpu_enable_matmul_autotuning",
+      bool_setter_for(&DebugOptions::set_xla_cpu_enable_matmul_autotuning),
+      flag_values->xla_cpu_enable_matmul_autotuning(),
+      "Benchmark the runtime matmul routines on XLA:CPU at compile time and "
+      "call the fastest one."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_cpu_matmul_autotuning_database",
+      string_setter_for(&DebugOptions::set_xla_cpu_matmul_autotuning_database),
+      flag_values->xla_cpu_matmul_autotuning_database(),
+      "File storing the results of XLA:CPU matmul autotuning across "
+      "processes."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_gpu_enable_latency_hiding_scheduler",
+      bool_setter_for(
+          &DebugOptions::set_xla_gpu_enable_latency_hiding_scheduler),
+      flag_values->xla_gpu_enable_latency_hiding_scheduler(),
+      "Schedule asynchronous collectives on XLA:GPU with a latency model to "
+      "overlap them with compute."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_gpu_latency_hiding_scheduler_memory_limit_bytes",
+      int64_setter_for(
+          &DebugOptions::
+              set_xla_gpu_latency_hiding_scheduler_memory_limit_bytes),
+      flag_values->xla_gpu_latency_hiding_scheduler_memory_limit_bytes(),
+      "Maximum bytes of asynchronous collective buffers the XLA:GPU latency "
+      "hiding scheduler keeps in flight at once; 0 means no limit."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_gpu_enable_cuda_graphs",
+      bool_setter_for(&DebugOptions::set_xla_gpu_enable_cuda_graphs),
+      flag_values->xla_gpu_enable_cuda_graphs(),
+      "Capture the thunks of XLA:GPU executables into CUDA graphs and launch "
+      "them with a single call."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_gpu_autotune_results_path",
+      string_setter_for(&DebugOptions::set_xla_gpu_autotune_results_path),
+      flag_values->xla_gpu_autotune_results_path(),
+      "File of GEMM and convolution autotuning results that is loaded before "
+      "autotuning and updated with new results."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_spmd_memory_budget_per_device_bytes",
+      int64_setter_for(
+          &DebugOptions::set_xla_spmd_memory_budget_per_device_bytes),
+      flag_values->xla_spmd_memory_budget_per_device_bytes(),
+      "Upper bound on the peak memory of one device running an SPMD "
+      "partitioned module; 0 means no budget."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_cpu_partition_intra_op_threads",
+      bool_setter_for(&DebugOptions::set_xla_cpu_partition_intra_op_threads),
+      flag_values->xla_cpu_partition_intra_op_threads(),
+      "Give each host device its own NUMA-local slice of the intra-op "
+      "threads instead of sharing one pool between devices."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_gpu_enable_reduction_epilogue_fusion",
+      bool_setter_for(
+          &DebugOptions::set_xla_gpu_enable_reduction_epilogue_fusion),
+      flag_values->xla_gpu_enable_reduction_epilogue_fusion(),
+      "Emit row reductions and the elementwise ops consuming them through a "
+      "broadcast, as in softmax and layer norm, as one kernel."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_gpu_enable_gemm_grouping",
+      bool_setter_for(&DebugOptions::set_xla_gpu_enable_gemm_grouping),
+      flag_values->xla_gpu_enable_gemm_grouping(),
+      "Run small independent GEMMs of identical shape as one batched cuBLAS "
+      "call."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_cpu_enable_hlo_sampling",
+      bool_setter_for(&DebugOptions::set_xla_cpu_enable_hlo_sampling),
+      flag_values->xla_cpu_enable_hlo_sampling(),
+      "Record the HLO each CPU thread is executing so that profiler sessions "
+      "can attribute sampled CPU time to HLO instructions."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_gpu_enable_host_offload",
+      bool_setter_for(&DebugOptions::set_xla_gpu_enable_host_offload),
+      flag_values->xla_gpu_enable_host_offload(),
+      "Offload large buffers that are unused for long stretches of the "
+      "program to pinned host memory, to run models that exceed device "
+      "memory."));
   flag_objects->push_back(tensorflow::Flag(
       "xla_gpu_deterministic_ops",
       bool_setter_for(&DebugOptions::set_xla_gpu_deterministic_ops),
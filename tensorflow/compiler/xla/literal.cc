@@ -452,6 +452,99 @@ std::vector<Literal> Literal::DecomposeTuple() {
 
 namespace {
 
+// Copies `count` elements of type T from `src`, whose elements are `src_stride`
+// elements apart, to the contiguous memory at `dest`.
+template <typename T>
+void CopyStridedRow(char* dest, const char* src, int64_t src_stride,
+                    int64_t count) {
+  if (src_stride == 1) {
+    memcpy(dest, src, count * sizeof(T));
+    return;
+  }
+  for (int64_t i = 0; i < count; ++i) {
+    memcpy(dest + i * sizeof(T), src + i * src_stride * sizeof(T), sizeof(T));
+  }
+}
+
+// Fills the dense array `dest` of shape `dest_shape`, whose elements are
+// `primitive_size` bytes wide. The element at multi-dimensional index I is read
+// from `src` at element offset sum(I[d] * src_strides[d]). A zero stride
+// broadcasts the source along that dimension.
+//
+// `dest` is walked in physical order one minor-most row at a time, so the
+// source offset is updated incrementally instead of being recomputed from a
+// multi-dimensional index for every element.
+void StridedCopyToDenseArray(char* dest, const Shape& dest_shape,
+                             const char* src,
+                             absl::Span<const int64_t> src_strides,
+                             int64_t primitive_size) {
+  if (ShapeUtil::IsZeroElementArray(dest_shape)) {
+    return;
+  }
+  const int64_t rank = dest_shape.rank();
+  if (rank == 0) {
+    memcpy(dest, src, primitive_size);
+    return;
+  }
+  absl::Span<const int64_t> minor_to_major =
+      LayoutUtil::MinorToMajor(dest_shape);
+  const int64_t row_dim = minor_to_major[0];
+  const int64_t row_size = dest_shape.dimensions(row_dim);
+  const int64_t row_stride = src_strides[row_dim];
+  std::vector<int64_t> index(rank, 0);
+  int64_t src_offset = 0;
+  while (true) {
+    const char* row_src = src + src_offset * primitive_size;
+    switch (primitive_size) {
+      case 1:
+        CopyStridedRow<uint8_t>(dest, row_src, row_stride, row_size);
+        break;
+      case 2:
+        CopyStridedRow<uint16_t>(dest, row_src, row_stride, row_size);
+        break;
+      case 4:
+        CopyStridedRow<uint32_t>(dest, row_src, row_stride, row_size);
+        break;
+      case 8:
+        CopyStridedRow<uint64_t>(dest, row_src, row_stride, row_size);
+        break;
+      default:
+        for (int64_t i = 0; i < row_size; ++i) {
+          memcpy(dest + i * primitive_size,
+                 row_src + i * row_stride * primitive_size, primitive_size);
+        }
+        break;
+    }
+    dest += row_size * primitive_size;
+
+    // Advance to the next row, carrying into more major dimensions.
+    int64_t i = 1;
+    for (; i < rank; ++i) {
+      const int64_t dim = minor_to_major[i];
+      src_offset += src_strides[dim];
+      if (++index[dim] < dest_shape.dimensions(dim)) {
+        break;
+      }
+      src_offset -= src_strides[dim] * dest_shape.dimensions(dim);
+      index[dim] = 0;
+    }
+    if (i == rank) {
+      return;
+    }
+  }
+}
+
+// Returns the element stride of every dimension of the dense array `shape`.
+std::vector<int64_t> DenseArrayStrides(const Shape& shape) {
+  std::vector<int64_t> strides(shape.rank());
+  int64_t stride = 1;
+  for (int64_t dim : LayoutUtil::MinorToMajor(shape)) {
+    strides[dim] = stride;
+    stride *= shape.dimensions(dim);
+  }
+  return strides;
+}
+
 // Copies the elements in 'src' to 'dest'. The shape and layout of the data in
 // the array slices are indicated by dest_shape and src_shape respectively.
 template <typename NativeT>
@@ -459,14 +552,9 @@ void CopyElementsBetween(absl::Span<NativeT> dest,
                          absl::Span<const NativeT> src, const Shape& dest_shape,
                          const Shape& src_shape) {
   CHECK(ShapeUtil::Compatible(dest_shape, src_shape));
-  if (ShapeUtil::IsZeroElementArray(dest_shape)) {
-    return;
-  }
-  std::vector<int64_t> index(dest_shape.rank());
-  do {
-    dest[IndexUtil::MultidimensionalIndexToLinearIndex(dest_shape, index)] =
-        src[IndexUtil::MultidimensionalIndexToLinearIndex(src_shape, index)];
-  } while (IndexUtil::BumpIndices(dest_shape, absl::MakeSpan(index)));
+  StridedCopyToDenseArray(reinterpret_cast<char*>(dest.data()), dest_shape,
+                          reinterpret_cast<const char*>(src.data()),
+                          DenseArrayStrides(src_shape), sizeof(NativeT));
 }
 }  // namespace
 
@@ -819,13 +907,6 @@ StatusOr<Literal> LiteralBase::Broadcast(
 
   TF_RET_CHECK(result_shape.element_type() == shape().element_type());
   Literal result(result_shape);
-  // scratch_source_index is temporary storage space for the computed index into
-  // the input literal.  We put it here to avoid allocating an std::vector in
-  // every iteration of ShapeUtil::ForEachIndex.
-  std::vector<int64_t> scratch_source_index(shape().dimensions_size());
-
-  char* dest_data = static_cast<char*>(result.untyped_data());
-  const char* source_data = static_cast<const char*>(untyped_data());
   const int64_t primitive_size =
       ShapeUtil::ByteSizeOfPrimitiveType(shape().element_type());
   for (int64_t i = 0; i < dimensions.size(); ++i) {
@@ -833,19 +914,17 @@ StatusOr<Literal> LiteralBase::Broadcast(
     result.SetDynamicSize(dimensions[i], dynamic_size);
   }
 
-  ShapeUtil::ForEachIndex(
-      result_shape, [&](absl::Span<const int64_t> output_index) {
-        for (int64_t i = 0, end = dimensions.size(); i < end; ++i) {
-          scratch_source_index[i] = output_index[dimensions[i]];
-        }
-        int64_t dest_index = IndexUtil::MultidimensionalIndexToLinearIndex(
-            result_shape, output_index);
-        int64_t source_index = IndexUtil::MultidimensionalIndexToLinearIndex(
-            shape(), scratch_source_index);
-        memcpy(dest_data + primitive_size * dest_index,
-               source_data + primitive_size * source_index, primitive_size);
-        return true;
-      });
+  // Output dimensions that are not mapped to an operand dimension have a
+  // source stride of zero, i.e. the operand is repeated along them.
+  std::vector<int64_t> operand_strides = DenseArrayStrides(shape());
+  std::vector<int64_t> source_strides(result_shape.rank(), 0);
+  for (int64_t i = 0, end = dimensions.size(); i < end; ++i) {
+    source_strides[dimensions[i]] = operand_strides[i];
+  }
+  StridedCopyToDenseArray(static_cast<char*>(result.untyped_data()),
+                          result.shape(),
+                          static_cast<const char*>(untyped_data()),
+                          source_strides, primitive_size);
 
   return std::move(result);
 }
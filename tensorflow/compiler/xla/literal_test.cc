@@ -2087,6 +2087,31 @@ TEST_F(LiteralUtilTest, BroadcastScalarToMatrix) {
             LiteralUtil::CreateR2<int32_t>({{9, 9}, {9, 9}}));
 }
 
+TEST_F(LiteralUtilTest, BroadcastWithNonDefaultLayouts) {
+  Literal literal = LiteralUtil::CreateR2WithLayout<int32_t>(
+      {{1, 2, 3}, {4, 5, 6}}, LayoutUtil::MakeLayout({0, 1}));
+  TF_ASSERT_OK_AND_ASSIGN(
+      Literal broadcasted_literal,
+      literal.Broadcast(
+          /*result_shape=*/ShapeUtil::MakeShapeWithLayout(S32, {2, 2, 3},
+                                                          {0, 2, 1}),
+          /*dimensions=*/{0, 2}));
+  EXPECT_EQ(broadcasted_literal,
+            LiteralUtil::CreateR3<int32_t>(
+                {{{1, 2, 3}, {1, 2, 3}}, {{4, 5, 6}, {4, 5, 6}}}));
+}
+
+TEST_F(LiteralUtilTest, RelayoutTransposedLiteral) {
+  Literal literal = LiteralUtil::CreateR3<float>(
+      {{{1, 2, 3}, {4, 5, 6}}, {{7, 8, 9}, {10, 11, 12}}});
+  Literal transposed = literal.Transpose({2, 0, 1});
+  Literal relaid = transposed.Relayout(LayoutUtil::MakeLayout({2, 1, 0}));
+  EXPECT_EQ(relaid.shape().layout(), LayoutUtil::MakeLayout({2, 1, 0}));
+  EXPECT_EQ(relaid, LiteralUtil::CreateR3<float>({{{1, 4}, {7, 10}},
+                                                  {{2, 5}, {8, 11}},
+                                                  {{3, 6}, {9, 12}}}));
+}
+
 TEST_F(LiteralUtilTest, DynamicBroadcast) {
   Literal literal = LiteralUtil::CreateR1<int64_t>({1, 2});
   literal.SetDynamicSize(0, 1);
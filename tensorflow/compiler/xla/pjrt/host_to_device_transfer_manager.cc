@@ -0,0 +1,112 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/pjrt/host_to_device_transfer_manager.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "tensorflow/compiler/xla/status_macros.h"
+#include "tensorflow/compiler/xla/util.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+#include "tensorflow/stream_executor/stream.h"
+
+namespace xla {
+
+HostToDeviceTransferManager::HostToDeviceTransferManager(
+    tensorflow::Allocator* host_memory_allocator, int64_t chunk_size_bytes,
+    int num_chunks)
+    : host_memory_allocator_(host_memory_allocator),
+      chunk_size_bytes_(chunk_size_bytes),
+      num_chunks_(num_chunks) {
+  CHECK(host_memory_allocator_ != nullptr);
+  CHECK_GT(chunk_size_bytes_, 0);
+  CHECK_GT(num_chunks_, 0);
+}
+
+HostToDeviceTransferManager::~HostToDeviceTransferManager() {
+  absl::MutexLock lock(&mu_);
+  mu_.Await(absl::Condition(
+      +[](HostToDeviceTransferManager* manager)
+           ABSL_EXCLUSIVE_LOCKS_REQUIRED(manager->mu_) {
+             return manager->free_chunks_.size() == manager->chunks_.size();
+           },
+      this));
+  for (void* chunk : chunks_) {
+    host_memory_allocator_->DeallocateRaw(chunk);
+  }
+}
+
+StatusOr<void*> HostToDeviceTransferManager::AcquireChunk() {
+  absl::MutexLock lock(&mu_);
+  if (chunks_.empty()) {
+    chunks_.reserve(num_chunks_);
+    for (int i = 0; i < num_chunks_; ++i) {
+      void* chunk = host_memory_allocator_->AllocateRaw(
+          tensorflow::Allocator::kAllocatorAlignment, chunk_size_bytes_);
+      if (chunk == nullptr) {
+        for (void* allocated : chunks_) {
+          host_memory_allocator_->DeallocateRaw(allocated);
+        }
+        chunks_.clear();
+        return ResourceExhausted(
+            "Failed to allocate %d host-to-device staging buffers of %d bytes",
+            num_chunks_, chunk_size_bytes_);
+      }
+      chunks_.push_back(chunk);
+    }
+    free_chunks_ = chunks_;
+  }
+  mu_.Await(absl::Condition(
+      +[](std::vector<void*>* free_chunks) { return !free_chunks->empty(); },
+      &free_chunks_));
+  void* chunk = free_chunks_.back();
+  free_chunks_.pop_back();
+  return chunk;
+}
+
+void HostToDeviceTransferManager::ReleaseChunk(void* chunk) {
+  absl::MutexLock lock(&mu_);
+  free_chunks_.push_back(chunk);
+}
+
+Status HostToDeviceTransferManager::TransferToDevice(
+    se::Stream* stream, const void* data, int64_t size,
+    se::DeviceMemoryBase dst) {
+  tensorflow::profiler::TraceMe traceme(
+      "HostToDeviceTransferManager::TransferToDevice");
+  TF_RET_CHECK(size <= dst.size())
+      << "Transfer of " << size << " bytes into a buffer of " << dst.size()
+      << " bytes";
+  const char* src = static_cast<const char*>(data);
+  for (int64_t offset = 0; offset < size; offset += chunk_size_bytes_) {
+    const int64_t chunk_size = std::min(chunk_size_bytes_, size - offset);
+    TF_ASSIGN_OR_RETURN(void* chunk, AcquireChunk());
+    std::memcpy(chunk, src + offset, chunk_size);
+    se::DeviceMemoryBase dst_chunk(static_cast<char*>(dst.opaque()) + offset,
+                                   chunk_size);
+    stream->ThenMemcpy(&dst_chunk, chunk, chunk_size);
+    stream->ThenDoHostCallback([this, chunk]() { ReleaseChunk(chunk); });
+    if (!stream->ok()) {
+      // A stream in an error state drops enqueued work, including the
+      // callback above, so the chunk has to be returned here.
+      ReleaseChunk(chunk);
+      return InternalError("Host-to-device transfer stream failed");
+    }
+  }
+  return Status::OK();
+}
+
+}  // namespace xla
@@ -0,0 +1,86 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_PJRT_HOST_TO_DEVICE_TRANSFER_MANAGER_H_
+#define TENSORFLOW_COMPILER_XLA_PJRT_HOST_TO_DEVICE_TRANSFER_MANAGER_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+#include "tensorflow/compiler/xla/status.h"
+#include "tensorflow/compiler/xla/statusor.h"
+#include "tensorflow/compiler/xla/types.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/stream_executor.h"
+
+namespace xla {
+
+// Copies dense host data to device memory through a ring of reusable staging
+// buffers allocated on a host memory allocator. On GPU this is pinned memory,
+// so the DMAs run asynchronously without allocating a staging buffer the size
+// of the whole transfer.
+//
+// Copies larger than one staging buffer are split into chunks: the host fills
+// the staging buffer for chunk i+1 while the DMA of chunk i is in flight, and
+// a staging buffer returns to the ring once its stream passes the DMA that
+// reads it. The staging buffers are allocated on first use.
+//
+// This class is thread-safe.
+class HostToDeviceTransferManager {
+ public:
+  static constexpr int64_t kDefaultChunkSizeBytes = int64_t{4} << 20;
+  static constexpr int kDefaultNumChunks = 8;
+
+  explicit HostToDeviceTransferManager(
+      tensorflow::Allocator* host_memory_allocator,
+      int64_t chunk_size_bytes = kDefaultChunkSizeBytes,
+      int num_chunks = kDefaultNumChunks);
+
+  // Blocks until all staging buffers are back in the ring.
+  ~HostToDeviceTransferManager();
+
+  HostToDeviceTransferManager(const HostToDeviceTransferManager&) = delete;
+  HostToDeviceTransferManager& operator=(const HostToDeviceTransferManager&) =
+      delete;
+
+  // Enqueues a copy of `size` bytes from `data` to the start of `dst` on
+  // `stream`. Blocks while all staging buffers are in use. `data` is not read
+  // after this returns, so the caller may reuse it immediately.
+  Status TransferToDevice(se::Stream* stream, const void* data, int64_t size,
+                          se::DeviceMemoryBase dst);
+
+  int64_t chunk_size_bytes() const { return chunk_size_bytes_; }
+  int num_chunks() const { return num_chunks_; }
+
+ private:
+  // Returns a free staging buffer, waiting for one to be released if needed.
+  StatusOr<void*> AcquireChunk();
+  // Returns `chunk` to the ring.
+  void ReleaseChunk(void* chunk);
+
+  tensorflow::Allocator* const host_memory_allocator_;
+  const int64_t chunk_size_bytes_;
+  const int num_chunks_;
+
+  absl::Mutex mu_;
+  // All staging buffers, empty until the first transfer.
+  std::vector<void*> chunks_ ABSL_GUARDED_BY(mu_);
+  std::vector<void*> free_chunks_ ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_PJRT_HOST_TO_DEVICE_TRANSFER_MANAGER_H_
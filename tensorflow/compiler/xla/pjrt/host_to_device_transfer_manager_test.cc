@@ -0,0 +1,116 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/pjrt/host_to_device_transfer_manager.h"
+
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+#include "tensorflow/compiler/xla/client/client_library.h"
+#include "tensorflow/compiler/xla/test.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/stream_executor/device_memory_allocator.h"
+#include "tensorflow/stream_executor/stream.h"
+
+namespace xla {
+namespace {
+
+class HostToDeviceTransferManagerTest : public ::testing::Test {
+ protected:
+  HostToDeviceTransferManagerTest()
+      : client_(ClientLibrary::LocalClientOrDie()),
+        stream_(client_->backend().default_stream_executor()) {
+    stream_.Init();
+  }
+
+  se::OwningDeviceMemory Allocate(int64_t size) {
+    return client_->backend()
+        .memory_allocator()
+        ->Allocate(/*device_ordinal=*/0, size)
+        .ValueOrDie();
+  }
+
+  std::vector<uint8_t> CopyToHost(se::DeviceMemoryBase buffer) {
+    std::vector<uint8_t> result(buffer.size());
+    stream_.ThenMemcpy(result.data(), buffer, buffer.size());
+    TF_CHECK_OK(stream_.BlockHostUntilDone());
+    return result;
+  }
+
+  LocalClient* client_;
+  se::Stream stream_;
+};
+
+std::vector<uint8_t> Iota(int64_t size) {
+  std::vector<uint8_t> data(size);
+  std::iota(data.begin(), data.end(), 0);
+  return data;
+}
+
+TEST_F(HostToDeviceTransferManagerTest, TransfersInChunks) {
+  HostToDeviceTransferManager manager(tensorflow::cpu_allocator(),
+                                      /*chunk_size_bytes=*/16,
+                                      /*num_chunks=*/2);
+  // Not a multiple of the chunk size, and far larger than the ring.
+  std::vector<uint8_t> data = Iota(1001);
+  se::OwningDeviceMemory buffer = Allocate(data.size());
+  TF_ASSERT_OK(
+      manager.TransferToDevice(&stream_, data.data(), data.size(), *buffer));
+  EXPECT_EQ(CopyToHost(*buffer), data);
+}
+
+TEST_F(HostToDeviceTransferManagerTest, HostDataMayBeReusedAfterReturn) {
+  HostToDeviceTransferManager manager(tensorflow::cpu_allocator(),
+                                      /*chunk_size_bytes=*/64,
+                                      /*num_chunks=*/4);
+  std::vector<uint8_t> data = Iota(200);
+  const std::vector<uint8_t> expected = data;
+  se::OwningDeviceMemory buffer = Allocate(data.size());
+  TF_ASSERT_OK(
+      manager.TransferToDevice(&stream_, data.data(), data.size(), *buffer));
+  std::fill(data.begin(), data.end(), 0xff);
+  EXPECT_EQ(CopyToHost(*buffer), expected);
+}
+
+TEST_F(HostToDeviceTransferManagerTest, ReusesStagingBuffersAcrossTransfers) {
+  HostToDeviceTransferManager manager(tensorflow::cpu_allocator(),
+                                      /*chunk_size_bytes=*/32,
+                                      /*num_chunks=*/1);
+  std::vector<se::OwningDeviceMemory> buffers;
+  std::vector<std::vector<uint8_t>> data;
+  for (int i = 0; i < 8; ++i) {
+    data.push_back(std::vector<uint8_t>(100, static_cast<uint8_t>(i)));
+    buffers.push_back(Allocate(data.back().size()));
+    TF_ASSERT_OK(manager.TransferToDevice(&stream_, data.back().data(),
+                                          data.back().size(), *buffers.back()));
+  }
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_EQ(CopyToHost(*buffers[i]), data[i]);
+  }
+}
+
+TEST_F(HostToDeviceTransferManagerTest, RejectsTransferLargerThanDestination) {
+  HostToDeviceTransferManager manager(tensorflow::cpu_allocator());
+  std::vector<uint8_t> data = Iota(64);
+  se::OwningDeviceMemory buffer = Allocate(32);
+  EXPECT_FALSE(
+      manager.TransferToDevice(&stream_, data.data(), data.size(), *buffer)
+          .ok());
+}
+
+}  // namespace
+}  // namespace xla
@@ -85,6 +85,9 @@ class LRUCache {
   Value GetOrCreateIfAbsent(const Key& key,
                             const std::function<Value(const Key&)>& factory);
 
+  // Removes the entry for `key`, if any. Returns true if an entry was removed.
+  bool Remove(const Key& key);
+
   // Removes all entries from the cache.
   void Clear();
 
@@ -128,6 +131,20 @@ void LRUCache<Key, Value, Hash, Eq>::Clear() {
   entries_.clear();
 }
 
+template <typename Key, typename Value, typename Hash, typename Eq>
+bool LRUCache<Key, Value, Hash, Eq>::Remove(const Key& key) {
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    return false;
+  }
+  LRUListEntry* l = &it->second;
+  l->next->prev = l->prev;
+  l->prev->next = l->next;
+  --lru_list_->size_;
+  entries_.erase(it);
+  return true;
+}
+
 template <typename Key, typename Value, typename Hash, typename Eq>
 LRUCache<Key, Value, Hash, Eq>::~LRUCache() {
   Clear();
@@ -0,0 +1,184 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/pjrt/pjrt_compilation_cache.h"
+
+#include <string>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "tensorflow/compiler/xla/client/executable_build_options.h"
+#include "tensorflow/compiler/xla/util.h"
+#include "tensorflow/compiler/xla/xla.pb.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace xla {
+
+PjRtCompilationCache::PjRtCompilationCache(
+    PjRtClient* client, int capacity, std::unique_ptr<Serializer> serializer)
+    : client_(client),
+      serializer_(std::move(serializer)),
+      lru_list_(capacity),
+      cache_(&lru_list_) {
+  CHECK(client_ != nullptr);
+  CHECK_GT(capacity, 0);
+}
+
+/*static*/ StatusOr<std::string> PjRtCompilationCache::Fingerprint(
+    const XlaComputation& computation, const CompileOptions& options) {
+  if (options.multi_slice_config != nullptr) {
+    return Unimplemented(
+        "Compile options with a multi-slice config can't be fingerprinted.");
+  }
+  std::string serialized_computation;
+  if (!tensorflow::SerializeToStringDeterministic(computation.proto(),
+                                                  &serialized_computation)) {
+    return InternalError("Failed to serialize computation %s.",
+                         computation.name());
+  }
+
+  // ExecutionOptions covers the parts of ExecutableBuildOptions that affect
+  // the compiled code; the remaining fields are appended below. The device
+  // allocator and compile thread pool only affect how compilation runs.
+  TF_ASSIGN_OR_RETURN(ProgramShape program_shape,
+                      computation.GetProgramShape());
+  const ExecutableBuildOptions& build_options =
+      options.executable_build_options;
+  ExecutionOptions execution_options =
+      CreateExecutionOptions(build_options, &program_shape);
+  std::string serialized_options;
+  if (!tensorflow::SerializeToStringDeterministic(execution_options,
+                                                  &serialized_options)) {
+    return InternalError("Failed to serialize compile options.");
+  }
+  absl::StrAppend(&serialized_options, ";", build_options.device_ordinal(),
+                  ";", build_options.run_backend_only(), ";",
+                  options.parameter_is_tupled_arguments, ";",
+                  options.compile_portable_executable);
+  if (options.argument_layouts.has_value()) {
+    for (const Shape& shape : *options.argument_layouts) {
+      std::string serialized_shape;
+      if (!tensorflow::SerializeToStringDeterministic(shape.ToProto(),
+                                                      &serialized_shape)) {
+        return InternalError("Failed to serialize argument layout %s.",
+                             shape.ToString(/*print_layout=*/true));
+      }
+      absl::StrAppend(&serialized_options, ";", serialized_shape);
+    }
+  }
+
+  tensorflow::Fprint128 computation_fp =
+      tensorflow::Fingerprint128(serialized_computation);
+  tensorflow::Fprint128 options_fp =
+      tensorflow::Fingerprint128(serialized_options);
+  return absl::StrFormat("%016x%016x_%016x%016x", computation_fp.high64,
+                         computation_fp.low64, options_fp.high64,
+                         options_fp.low64);
+}
+
+StatusOr<std::shared_ptr<PjRtExecutable>> PjRtCompilationCache::GetOrCompile(
+    const XlaComputation& computation, const CompileOptions& options) {
+  if (options.multi_slice_config != nullptr) {
+    VLOG(1) << "Bypassing the compilation cache for multi-slice computation "
+            << computation.name();
+    TF_ASSIGN_OR_RETURN(std::unique_ptr<PjRtExecutable> executable,
+                        client_->Compile(computation, options));
+    return std::shared_ptr<PjRtExecutable>(std::move(executable));
+  }
+  TF_ASSIGN_OR_RETURN(std::string key, Fingerprint(computation, options));
+
+  std::shared_ptr<Entry> entry;
+  bool created = false;
+  {
+    absl::MutexLock lock(&mu_);
+    entry = cache_.GetOrCreateIfAbsent(key, [&created](const std::string&) {
+      created = true;
+      return std::make_shared<Entry>();
+    });
+  }
+
+  if (!created) {
+    entry->done.WaitForNotification();
+    return entry->executable;
+  }
+
+  // This thread owns the compilation; callers asking for the same key in the
+  // meantime block on `done` above.
+  entry->executable = LoadOrCompile(key, computation, options);
+  if (!entry->executable.ok()) {
+    absl::MutexLock lock(&mu_);
+    cache_.Remove(key);
+  }
+  entry->done.Notify();
+  return entry->executable;
+}
+
+StatusOr<std::shared_ptr<PjRtExecutable>> PjRtCompilationCache::LoadOrCompile(
+    const std::string& key, const XlaComputation& computation,
+    const CompileOptions& options) {
+  if (serializer_ != nullptr) {
+    StatusOr<absl::optional<std::string>> serialized = serializer_->Load(key);
+    if (!serialized.ok()) {
+      LOG(WARNING) << "Failed to load executable " << key
+                   << " from the compilation cache: " << serialized.status();
+    } else if (serialized->has_value()) {
+      StatusOr<std::unique_ptr<PjRtExecutable>> executable =
+          client_->DeserializeExecutable(**serialized, options);
+      if (executable.ok()) {
+        VLOG(1) << "Loaded executable " << key << " for computation "
+                << computation.name() << " from the compilation cache";
+        return std::shared_ptr<PjRtExecutable>(std::move(*executable));
+      }
+      LOG(WARNING) << "Failed to deserialize executable " << key << ": "
+                   << executable.status();
+    }
+  }
+
+  VLOG(1) << "Compiling " << computation.name() << " for cache key " << key;
+  TF_ASSIGN_OR_RETURN(std::unique_ptr<PjRtExecutable> executable,
+                      client_->Compile(computation, options));
+
+  if (serializer_ != nullptr) {
+    StatusOr<std::string> serialized =
+        client_->SerializeExecutable(*executable);
+    if (!serialized.ok()) {
+      // Not all clients can serialize executables; keep the in-memory copy.
+      VLOG(1) << "Not persisting executable " << key << ": "
+              << serialized.status();
+    } else {
+      Status status = serializer_->Store(key, *serialized);
+      if (!status.ok()) {
+        LOG(WARNING) << "Failed to store executable " << key
+                     << " in the compilation cache: " << status;
+      }
+    }
+  }
+  return std::shared_ptr<PjRtExecutable>(std::move(executable));
+}
+
+int PjRtCompilationCache::Size() const {
+  absl::MutexLock lock(&mu_);
+  return cache_.Size();
+}
+
+void PjRtCompilationCache::Clear() {
+  absl::MutexLock lock(&mu_);
+  cache_.Clear();
+}
+
+}  // namespace xla
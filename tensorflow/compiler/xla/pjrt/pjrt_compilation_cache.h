@@ -0,0 +1,112 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_PJRT_PJRT_COMPILATION_CACHE_H_
+#define TENSORFLOW_COMPILER_XLA_PJRT_PJRT_COMPILATION_CACHE_H_
+
+#include <memory>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/synchronization/notification.h"
+#include "absl/types/optional.h"
+#include "tensorflow/compiler/xla/client/xla_computation.h"
+#include "tensorflow/compiler/xla/pjrt/lru_cache.h"
+#include "tensorflow/compiler/xla/pjrt/pjrt_client.h"
+#include "tensorflow/compiler/xla/status.h"
+#include "tensorflow/compiler/xla/statusor.h"
+
+namespace xla {
+
+// A cache of executables compiled by a PjRtClient, keyed by fingerprints of
+// the computation and its CompileOptions. Intended for processes that host
+// many programs, e.g. model servers, so that frontends don't each need their
+// own cache.
+//
+// The number of resident executables is bounded by an LRU policy. Concurrent
+// requests for the same key share a single compilation. Optionally, a
+// Serializer persists executables so that they survive the process.
+//
+// This class is thread-safe.
+class PjRtCompilationCache {
+ public:
+  // Persistent storage for serialized executables, e.g. a directory or a
+  // key-value store shared by several processes.
+  class Serializer {
+   public:
+    virtual ~Serializer() = default;
+
+    // Returns the executable previously stored under `key`, or nullopt if
+    // there is none.
+    virtual StatusOr<absl::optional<std::string>> Load(
+        absl::string_view key) = 0;
+
+    // Stores `serialized_executable` under `key`.
+    virtual Status Store(absl::string_view key,
+                         absl::string_view serialized_executable) = 0;
+  };
+
+  // `client` must outlive the cache. At most `capacity` executables are kept
+  // in memory. `serializer` may be null.
+  PjRtCompilationCache(PjRtClient* client, int capacity,
+                       std::unique_ptr<Serializer> serializer = nullptr);
+
+  PjRtCompilationCache(const PjRtCompilationCache&) = delete;
+  PjRtCompilationCache& operator=(const PjRtCompilationCache&) = delete;
+
+  // Returns the executable for `computation` compiled with `options`. Looks
+  // the executable up in memory, then in the serializer, and compiles it only
+  // if both miss. Failed compilations are not cached.
+  //
+  // Options that can't be fingerprinted (a multi-slice config) bypass the
+  // cache.
+  StatusOr<std::shared_ptr<PjRtExecutable>> GetOrCompile(
+      const XlaComputation& computation, const CompileOptions& options);
+
+  // Returns the cache key for `computation` and `options`.
+  static StatusOr<std::string> Fingerprint(const XlaComputation& computation,
+                                           const CompileOptions& options);
+
+  // Number of executables currently held in memory.
+  int Size() const;
+
+  // Drops all in-memory executables. Compilations in flight are not
+  // affected.
+  void Clear();
+
+ private:
+  // A cached executable, or a compilation that is still in flight.
+  struct Entry {
+    absl::Notification done;
+    StatusOr<std::shared_ptr<PjRtExecutable>> executable;
+  };
+
+  // Loads the executable for `key` from the serializer, or compiles it.
+  StatusOr<std::shared_ptr<PjRtExecutable>> LoadOrCompile(
+      const std::string& key, const XlaComputation& computation,
+      const CompileOptions& options);
+
+  PjRtClient* const client_;
+  const std::unique_ptr<Serializer> serializer_;
+
+  mutable absl::Mutex mu_;
+  LRUCache<std::string, std::shared_ptr<Entry>>::LRUList lru_list_;
+  LRUCache<std::string, std::shared_ptr<Entry>> cache_ ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_PJRT_PJRT_COMPILATION_CACHE_H_
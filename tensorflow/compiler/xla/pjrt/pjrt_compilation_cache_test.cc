@@ -0,0 +1,190 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/pjrt/pjrt_compilation_cache.h"
+
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/memory/memory.h"
+#include "absl/synchronization/mutex.h"
+#include "tensorflow/compiler/xla/client/xla_builder.h"
+#include "tensorflow/compiler/xla/pjrt/cpu_device.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/compiler/xla/test.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace xla {
+namespace {
+
+XlaComputation AddOne() {
+  XlaBuilder builder("add_one");
+  XlaOp x = Parameter(&builder, 0, ShapeUtil::MakeShape(F32, {4}), "x");
+  Add(x, ConstantR0<float>(&builder, 1.0f));
+  return builder.Build().ValueOrDie();
+}
+
+XlaComputation MulTwo() {
+  XlaBuilder builder("mul_two");
+  XlaOp x = Parameter(&builder, 0, ShapeUtil::MakeShape(F32, {4}), "x");
+  Mul(x, ConstantR0<float>(&builder, 2.0f));
+  return builder.Build().ValueOrDie();
+}
+
+CompileOptions DefaultOptions() {
+  CompileOptions options;
+  options.executable_build_options.set_num_replicas(1);
+  options.executable_build_options.set_num_partitions(1);
+  return options;
+}
+
+// Records keys and serves stored executables from memory.
+class FakeSerializer : public PjRtCompilationCache::Serializer {
+ public:
+  StatusOr<absl::optional<std::string>> Load(absl::string_view key) override {
+    absl::MutexLock lock(&mu_);
+    ++loads_;
+    auto it = stored_.find(key);
+    if (it == stored_.end()) {
+      return absl::optional<std::string>();
+    }
+    return absl::optional<std::string>(it->second);
+  }
+
+  Status Store(absl::string_view key,
+               absl::string_view serialized_executable) override {
+    absl::MutexLock lock(&mu_);
+    stored_[key] = std::string(serialized_executable);
+    return Status::OK();
+  }
+
+  int loads() const {
+    absl::MutexLock lock(&mu_);
+    return loads_;
+  }
+
+ private:
+  mutable absl::Mutex mu_;
+  int loads_ ABSL_GUARDED_BY(mu_) = 0;
+  absl::flat_hash_map<std::string, std::string> stored_ ABSL_GUARDED_BY(mu_);
+};
+
+TEST(PjRtCompilationCacheTest, FingerprintDependsOnComputationAndOptions) {
+  CompileOptions options = DefaultOptions();
+  TF_ASSERT_OK_AND_ASSIGN(std::string add_key,
+                          PjRtCompilationCache::Fingerprint(AddOne(), options));
+  TF_ASSERT_OK_AND_ASSIGN(std::string add_key_again,
+                          PjRtCompilationCache::Fingerprint(AddOne(), options));
+  TF_ASSERT_OK_AND_ASSIGN(std::string mul_key,
+                          PjRtCompilationCache::Fingerprint(MulTwo(), options));
+  EXPECT_EQ(add_key, add_key_again);
+  EXPECT_NE(add_key, mul_key);
+
+  CompileOptions portable = DefaultOptions();
+  portable.compile_portable_executable = true;
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::string portable_key,
+      PjRtCompilationCache::Fingerprint(AddOne(), portable));
+  EXPECT_NE(add_key, portable_key);
+
+  CompileOptions fast_math = DefaultOptions();
+  fast_math.executable_build_options.mutable_debug_options()
+      ->set_xla_cpu_enable_fast_math(
+          !fast_math.executable_build_options.debug_options()
+               .xla_cpu_enable_fast_math());
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::string fast_math_key,
+      PjRtCompilationCache::Fingerprint(AddOne(), fast_math));
+  EXPECT_NE(add_key, fast_math_key);
+}
+
+TEST(PjRtCompilationCacheTest, ReturnsCachedExecutable) {
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<PjRtClient> client,
+                          GetCpuClient(/*asynchronous=*/false));
+  PjRtCompilationCache cache(client.get(), /*capacity=*/4);
+
+  TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<PjRtExecutable> first,
+                          cache.GetOrCompile(AddOne(), DefaultOptions()));
+  TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<PjRtExecutable> second,
+                          cache.GetOrCompile(AddOne(), DefaultOptions()));
+  EXPECT_EQ(first.get(), second.get());
+
+  TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<PjRtExecutable> other,
+                          cache.GetOrCompile(MulTwo(), DefaultOptions()));
+  EXPECT_NE(first.get(), other.get());
+  EXPECT_EQ(cache.Size(), 2);
+}
+
+TEST(PjRtCompilationCacheTest, EvictsLeastRecentlyUsed) {
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<PjRtClient> client,
+                          GetCpuClient(/*asynchronous=*/false));
+  PjRtCompilationCache cache(client.get(), /*capacity=*/1);
+
+  TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<PjRtExecutable> first,
+                          cache.GetOrCompile(AddOne(), DefaultOptions()));
+  TF_ASSERT_OK(cache.GetOrCompile(MulTwo(), DefaultOptions()).status());
+  EXPECT_EQ(cache.Size(), 1);
+
+  // The evicted executable stays alive for its holders, but is recompiled.
+  TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<PjRtExecutable> recompiled,
+                          cache.GetOrCompile(AddOne(), DefaultOptions()));
+  EXPECT_NE(first.get(), recompiled.get());
+}
+
+TEST(PjRtCompilationCacheTest, ConcurrentRequestsShareCompilation) {
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<PjRtClient> client,
+                          GetCpuClient(/*asynchronous=*/false));
+  FakeSerializer* serializer = new FakeSerializer;
+  PjRtCompilationCache cache(client.get(), /*capacity=*/4,
+                             absl::WrapUnique(serializer));
+
+  constexpr int kNumThreads = 8;
+  std::vector<std::shared_ptr<PjRtExecutable>> executables(kNumThreads);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.emplace_back([&, i] {
+      executables[i] =
+          cache.GetOrCompile(AddOne(), DefaultOptions()).ValueOrDie();
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  for (int i = 1; i < kNumThreads; ++i) {
+    EXPECT_EQ(executables[0].get(), executables[i].get());
+  }
+  // Only the thread that compiled consulted the serializer.
+  EXPECT_EQ(serializer->loads(), 1);
+}
+
+TEST(PjRtCompilationCacheTest, FailedCompilationIsNotCached) {
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<PjRtClient> client,
+                          GetCpuClient(/*asynchronous=*/false));
+  PjRtCompilationCache cache(client.get(), /*capacity=*/4);
+
+  // Asks for more replicas than the client has devices.
+  CompileOptions options = DefaultOptions();
+  options.executable_build_options.set_num_replicas(client->device_count() +
+                                                    1);
+  EXPECT_FALSE(cache.GetOrCompile(AddOne(), options).ok());
+  EXPECT_EQ(cache.Size(), 0);
+}
+
+}  // namespace
+}  // namespace xla
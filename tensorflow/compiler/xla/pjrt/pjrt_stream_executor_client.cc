@@ -248,6 +248,15 @@ PjRtStreamExecutorClient::PjRtStreamExecutorClient(
   for (int idx = 0; idx < addressable_devices_.size(); ++idx) {
     CHECK(addressable_devices_[idx] != nullptr) << idx;
   }
+
+  if (should_stage_host_to_device_transfers_) {
+    host_to_device_transfer_managers_.reserve(addressable_devices_.size());
+    for (int idx = 0; idx < addressable_devices_.size(); ++idx) {
+      host_to_device_transfer_managers_.push_back(
+          std::make_unique<HostToDeviceTransferManager>(
+              host_memory_allocator_.get()));
+    }
+  }
 }
 
 StatusOr<DeviceAssignment> PjRtStreamExecutorClient::GetDefaultDeviceAssignment(
@@ -769,22 +778,45 @@ PjRtStreamExecutorClient::BufferFromHostBuffer(
     }
   }
 
+  // Spread transfers from different calls over the device's host-to-device
+  // streams so that they can overlap.
+  se::Stream* h2d_stream = is_cpu_platform
+                               ? local_device->host_to_device_stream()
+                               : local_device->GetHostToDeviceStream();
   TF_ASSIGN_OR_RETURN(
       std::unique_ptr<PjRtStreamExecutorBuffer> py_buffer,
-      AllocateDestinationBuffer(compact_shape, device, local_device,
-                                local_device->host_to_device_stream(),
+      AllocateDestinationBuffer(compact_shape, device, local_device, h2d_stream,
                                 /*is_uninitialized_create=*/false, this));
 
   PjRtStreamExecutorBuffer::ScopedHold device_buffer(
       py_buffer->GetBufferWithUsageHold());
   CHECK(device_buffer.ok());
 
+  // Dense arrays that keep their host layout on the device are copied in
+  // chunks through the device's staging ring, rather than through a staging
+  // buffer allocated for the whole transfer. Data that must be copied before
+  // this call returns, or transposed, still takes the full-size staging path.
+  HostToDeviceTransferManager* staged_transfer_manager = nullptr;
+  if (host_buffer_semantics != HostBufferSemantics::kImmutableOnlyDuringCall &&
+      host_and_device_strides_equal) {
+    const Shape& on_device_shape = py_buffer->on_device_shape();
+    if (on_device_shape.IsArray() && on_device_shape.is_static() &&
+        ShapeUtil::Equal(on_device_shape,
+                         ShapeUtil::DeviceShapeToHostShape(on_device_shape)) &&
+        device_buffer->device_memory().size() == 1 &&
+        device_buffer->device_memory()[0].size() == size) {
+      staged_transfer_manager =
+          host_to_device_transfer_manager(device->local_hardware_id());
+    }
+  }
+
   // If necessary, allocate a host-side buffer for staging host-to-device
   // transfers. On GPU this is a buffer in pinned memory.
   std::shared_ptr<void> staging_buffer;
-  if (host_buffer_semantics == HostBufferSemantics::kImmutableOnlyDuringCall ||
-      should_stage_host_to_device_transfers() ||
-      !host_and_device_strides_equal) {
+  if (staged_transfer_manager == nullptr &&
+      (host_buffer_semantics == HostBufferSemantics::kImmutableOnlyDuringCall ||
+       should_stage_host_to_device_transfers() ||
+       !host_and_device_strides_equal)) {
     void* ptr = host_memory_allocator()->AllocateRaw(
         tensorflow::Allocator::kAllocatorAlignment, size);
     staging_buffer = std::shared_ptr<void>(
@@ -828,11 +860,11 @@ PjRtStreamExecutorClient::BufferFromHostBuffer(
   // TODO(misard) assess if it would be preferable to introduce a heuristic to
   // put the transfer into the calling thread for small literals.
   auto transfer_h2d =
-      [local_client = client(), transfer_manager, local_device, data, size,
-       movable_device_buffer{device_buffer.ToClosure()}, shape,
+      [local_client = client(), transfer_manager, local_device, h2d_stream,
+       data, size, movable_device_buffer{device_buffer.ToClosure()}, shape,
        py_buffer{py_buffer.get()},
        on_device_shape{py_buffer->on_device_shape()},
-       staging_buffer{std::move(staging_buffer)},
+       staging_buffer{std::move(staging_buffer)}, staged_transfer_manager,
        on_done_with_host_buffer{std::move(on_done_with_host_buffer)},
        host_buffer_semantics, transpose{std::move(transpose)}]() {
         PjRtStreamExecutorBuffer::ScopedHold device_buffer(
@@ -847,7 +879,10 @@ PjRtStreamExecutorClient::BufferFromHostBuffer(
         // If applicable on the backend, stage the transfer via host memory
         // allocated via the host_memory_allocator. On GPU, this is pinned
         // memory.
-        if (staging_buffer) {
+        if (staged_transfer_manager != nullptr) {
+          TF_CHECK_OK(staged_transfer_manager->TransferToDevice(
+              h2d_stream, data, size, device_buffer->device_memory()[0]));
+        } else if (staging_buffer) {
           // If we didn't already copy the input buffer into the staging buffer,
           // do so now.
           if (host_buffer_semantics !=
@@ -864,24 +899,23 @@ PjRtStreamExecutorClient::BufferFromHostBuffer(
               static_cast<const char*>(staging_buffer.get()),
               ShapeUtil::DeviceShapeToHostShape(on_device_shape));
           TF_CHECK_OK(transfer_manager->TransferLiteralToDeviceAsync(
-              local_device->host_to_device_stream(), literal, buffer));
+              h2d_stream, literal, buffer));
         } else {
           BorrowingLiteral literal(
               reinterpret_cast<const char*>(data),
               ShapeUtil::DeviceShapeToHostShape(on_device_shape));
           // Otherwise, just transfer the literal.
           TF_CHECK_OK(transfer_manager->TransferLiteralToDeviceAsync(
-              local_device->host_to_device_stream(), literal, buffer));
+              h2d_stream, literal, buffer));
         }
 
         std::shared_ptr<BufferSequencingEvent> event =
             device_buffer->definition_events()[0];
         TF_CHECK_OK(AddDestinationBufferSynchronization(
-            local_device, std::move(device_buffer), event,
-            local_device->host_to_device_stream()));
+            local_device, std::move(device_buffer), event, h2d_stream));
 
         local_device->ThenExecuteCallback(
-            local_device->host_to_device_stream(),
+            h2d_stream,
             [staging_buffer{std::move(staging_buffer)},
              on_done_with_host_buffer{std::move(on_done_with_host_buffer)}]() {
               if (on_done_with_host_buffer) {
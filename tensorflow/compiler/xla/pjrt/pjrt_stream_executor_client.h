@@ -35,6 +35,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/client/xla_computation.h"
 #include "tensorflow/compiler/xla/layout.h"
 #include "tensorflow/compiler/xla/literal.h"
+#include "tensorflow/compiler/xla/pjrt/host_to_device_transfer_manager.h"
 #include "tensorflow/compiler/xla/pjrt/local_device_state.h"
 #include "tensorflow/compiler/xla/pjrt/pjrt_client.h"
 #include "tensorflow/compiler/xla/pjrt/pjrt_future.h"
@@ -261,6 +262,16 @@ class PjRtStreamExecutorClient : public PjRtClient {
     return should_stage_host_to_device_transfers_;
   }
 
+  // Returns the staged host-to-device transfer manager for the device with
+  // `local_device_ordinal`, or nullptr if transfers are not staged.
+  HostToDeviceTransferManager* host_to_device_transfer_manager(
+      int local_device_ordinal) const {
+    if (local_device_ordinal >= host_to_device_transfer_managers_.size()) {
+      return nullptr;
+    }
+    return host_to_device_transfer_managers_[local_device_ordinal].get();
+  }
+
   gpu::GpuExecutableRunOptions* gpu_run_options() const {
     return gpu_run_options_.get();
   }
@@ -343,6 +354,13 @@ class PjRtStreamExecutorClient : public PjRtClient {
 
   std::unique_ptr<gpu::GpuExecutableRunOptions> gpu_run_options_;
 
+  // Staged host-to-device transfer managers, indexed by local device ordinal.
+  // Only populated if should_stage_host_to_device_transfers_ is true. Declared
+  // before thread_pool_ so that transfers scheduled on the pool finish before
+  // the managers are destroyed.
+  std::vector<std::unique_ptr<HostToDeviceTransferManager>>
+      host_to_device_transfer_managers_;
+
   tensorflow::thread::ThreadPool thread_pool_;
 
   absl::Mutex transpose_mu_;
@@ -76,8 +76,9 @@ static tfrt::AsyncValueRef<CpuEvent> GetOrCreateReadyEvent(
   return ready_event->CopyRef();
 }
 
-TfrtCpuDevice::TfrtCpuDevice(int id, bool asynchronous)
+TfrtCpuDevice::TfrtCpuDevice(int id, bool asynchronous, int numa_node)
     : id_(id),
+      numa_node_(numa_node),
       max_inflight_computations_semaphore_(/*capacity=*/asynchronous ? 32 : 1) {
 }
 
@@ -104,12 +105,29 @@ static int CpuDeviceCount() {
   return GetDebugOptionsFromFlags().xla_force_host_platform_device_count();
 }
 
+static bool PartitionIntraOpThreads() {
+  return GetDebugOptionsFromFlags().xla_cpu_partition_intra_op_threads();
+}
+
+int TfrtCpuDeviceNumaNode(int device_index, int num_devices,
+                          int num_numa_nodes) {
+  if (num_numa_nodes <= 1) return tensorflow::port::kNUMANoAffinity;
+  return device_index * num_numa_nodes / num_devices;
+}
+
 static StatusOr<std::vector<std::unique_ptr<TfrtCpuDevice>>> GetTfrtCpuDevices(
     bool asynchronous) {
+  int num_devices = CpuDeviceCount();
+  int num_numa_nodes = 1;
+  if (num_devices > 1 && PartitionIntraOpThreads() &&
+      tensorflow::port::NUMAEnabled()) {
+    num_numa_nodes = tensorflow::port::NUMANumNodes();
+  }
   std::vector<std::unique_ptr<TfrtCpuDevice>> devices;
-  for (int i = 0; i < CpuDeviceCount(); ++i) {
+  for (int i = 0; i < num_devices; ++i) {
     auto device = std::make_unique<TfrtCpuDevice>(
-        /*id=*/i, asynchronous);
+        /*id=*/i, asynchronous,
+        TfrtCpuDeviceNumaNode(i, num_devices, num_numa_nodes));
     devices.push_back(std::move(device));
   }
   return std::move(devices);
@@ -133,21 +151,18 @@ StatusOr<std::unique_ptr<PjRtClient>> GetTfrtCpuClient(bool asynchronous) {
                       GetTfrtCpuDevices(asynchronous));
 
   return std::unique_ptr<PjRtClient>(std::make_unique<TfrtCpuClient>(
-      /*process_index=*/0, std::move(devices), std::move(host_context)));
+      /*process_index=*/0, std::move(devices), std::move(host_context),
+      PartitionIntraOpThreads()));
 }
 
 TfrtCpuClient::TfrtCpuClient(
     int process_index, std::vector<std::unique_ptr<TfrtCpuDevice>> devices,
-    std::unique_ptr<tfrt::HostContext> host_ctx)
+    std::unique_ptr<tfrt::HostContext> host_ctx,
+    bool partition_intra_op_threads)
     : process_index_(process_index),
       owned_devices_(std::move(devices)),
       host_ctx_(std::move(host_ctx)),
       computation_placer_(std::make_unique<ComputationPlacer>()),
-      eigen_intraop_pool_(new tensorflow::thread::ThreadPool(
-          tensorflow::Env::Default(), "XLAEigen", DefaultThreadPoolSize())),
-      eigen_intraop_device_(
-          new Eigen::ThreadPoolDevice(eigen_intraop_pool_->AsEigenThreadPool(),
-                                      eigen_intraop_pool_->NumThreads())),
       last_collective_launch_event_(
           tfrt::MakeAvailableAsyncValueRef<CpuEvent>(host_ctx_.get())),
       transpose_cache_(1024) {
@@ -169,6 +184,33 @@ TfrtCpuClient::TfrtCpuClient(
   for (int idx = 0; idx < addressable_devices_.size(); ++idx) {
     CHECK(addressable_devices_[idx] != nullptr) << idx;
   }
+
+  // Devices get equal shares of the threads. Every device needs at least one
+  // thread, so with more devices than threads the pools oversubscribe the
+  // cores by at most one thread per device.
+  int num_threads = DefaultThreadPoolSize();
+  if (addressable_devices_.size() > 1 && partition_intra_op_threads) {
+    int threads_per_device =
+        std::max<int>(1, num_threads / addressable_devices_.size());
+    for (PjRtDevice* device : addressable_devices_) {
+      tensorflow::ThreadOptions thread_options;
+      thread_options.numa_node =
+          tensorflow::down_cast<TfrtCpuDevice*>(device)->numa_node();
+      eigen_intraop_pools_.push_back(
+          std::make_unique<tensorflow::thread::ThreadPool>(
+              tensorflow::Env::Default(), thread_options,
+              absl::StrCat("XLAEigen_", device->local_hardware_id()),
+              threads_per_device));
+    }
+  } else {
+    eigen_intraop_pools_.push_back(
+        std::make_unique<tensorflow::thread::ThreadPool>(
+            tensorflow::Env::Default(), "XLAEigen", num_threads));
+  }
+  for (const auto& pool : eigen_intraop_pools_) {
+    eigen_intraop_devices_.push_back(std::make_unique<Eigen::ThreadPoolDevice>(
+        pool->AsEigenThreadPool(), pool->NumThreads()));
+  }
   LOG(INFO) << "TfrtCpuClient created.";
 }
 
@@ -398,7 +440,8 @@ StatusOr<std::unique_ptr<TfrtCpuBuffer>> AllocateDestinationBuffer(
   if (!on_device_shape.IsTuple()) {
     size_t byte_size = ShapeUtil::ByteSizeOf(on_device_shape);
     TF_ASSIGN_OR_RETURN(auto device_buffer,
-                        MaybeOwningCpuMemory::AllocateShared(byte_size));
+                        MaybeOwningCpuMemory::AllocateShared(
+                            byte_size, device->numa_node()));
     buffers.push_back(std::move(device_buffer));
     return std::make_unique<TfrtCpuBuffer>(
         on_device_shape,
@@ -412,7 +455,8 @@ StatusOr<std::unique_ptr<TfrtCpuBuffer>> AllocateDestinationBuffer(
   for (const auto& leaf_shape : on_device_shape.tuple_shapes()) {
     size_t byte_size = ShapeUtil::ByteSizeOf(leaf_shape);
     TF_ASSIGN_OR_RETURN(auto device_buffer,
-                        MaybeOwningCpuMemory::AllocateShared(byte_size));
+                        MaybeOwningCpuMemory::AllocateShared(
+                            byte_size, device->numa_node()));
     buffers.push_back(std::move(device_buffer));
   }
   return std::make_unique<TfrtCpuBuffer>(
@@ -480,8 +524,11 @@ StatusOr<std::unique_ptr<PjRtBuffer>> TfrtCpuClient::BufferFromHostBuffer(
     buffers.push_back(std::move(device_buffer));
     on_delete_callback = std::move(on_done_with_host_buffer);
   } else {
-    TF_ASSIGN_OR_RETURN(auto device_buffer,
-                        MaybeOwningCpuMemory::AllocateShared(byte_size));
+    TF_ASSIGN_OR_RETURN(
+        auto device_buffer,
+        MaybeOwningCpuMemory::AllocateShared(
+            byte_size,
+            tensorflow::down_cast<TfrtCpuDevice*>(device)->numa_node()));
     auto dst_data_ptr = device_buffer->data();
     buffers.push_back(device_buffer);
     if (!has_default_layout) {
@@ -1142,8 +1189,11 @@ StatusOr<std::unique_ptr<PjRtBuffer>> TfrtCpuBuffer::CopyToDevice(
 
   for (int i = 0; i < num_leaf_buffers; ++i) {
     auto src_buffer = src_device_buffer->Buffers()[i];
-    TF_ASSIGN_OR_RETURN(auto dst_buffer, MaybeOwningCpuMemory::AllocateShared(
-                                             src_buffer->size()));
+    TF_ASSIGN_OR_RETURN(
+        auto dst_buffer,
+        MaybeOwningCpuMemory::AllocateShared(
+            src_buffer->size(),
+            tensorflow::down_cast<TfrtCpuDevice*>(dst_device)->numa_node()));
     src_buffers.push_back(std::move(src_buffer));
     dst_buffers.push_back(std::move(dst_buffer));
     tfrt::RCReference<tfrt::IndirectAsyncValue> definition_event =
@@ -1359,7 +1409,8 @@ Status TfrtCpuExecutable::SetUpDonation(bool tuple_inputs) {
 // and assemble the buffer pointers in order to call into CpuExecutable.
 static StatusOr<std::shared_ptr<MaybeOwningCpuMemory>> MemoryForAllocation(
     const BufferAllocation& allocation,
-    absl::Span<const std::shared_ptr<TrackedTfrtCpuDeviceBuffer>> arguments) {
+    absl::Span<const std::shared_ptr<TrackedTfrtCpuDeviceBuffer>> arguments,
+    int numa_node) {
   if (allocation.is_entry_computation_parameter()) {
     const std::shared_ptr<TrackedTfrtCpuDeviceBuffer>& arg =
         arguments[allocation.parameter_number()];
@@ -1377,8 +1428,8 @@ static StatusOr<std::shared_ptr<MaybeOwningCpuMemory>> MemoryForAllocation(
 
   // Output and temporary buffer.
   int64_t buffer_size = allocation.size();
-  TF_ASSIGN_OR_RETURN(auto out,
-                      MaybeOwningCpuMemory::AllocateShared(buffer_size));
+  TF_ASSIGN_OR_RETURN(
+      auto out, MaybeOwningCpuMemory::AllocateShared(buffer_size, numa_node));
 
   // Since the output buffer and all the temporary buffers were written into
   // by the JITed code, msan has no way of knowing their memory was
@@ -1391,13 +1442,15 @@ static StatusOr<std::shared_ptr<MaybeOwningCpuMemory>> MemoryForAllocation(
 static StatusOr<std::vector<std::shared_ptr<MaybeOwningCpuMemory>>>
 CreateBufferTable(
     const BufferAssignment& assignment,
-    absl::Span<const std::shared_ptr<TrackedTfrtCpuDeviceBuffer>> arguments) {
+    absl::Span<const std::shared_ptr<TrackedTfrtCpuDeviceBuffer>> arguments,
+    int numa_node) {
   std::vector<std::shared_ptr<MaybeOwningCpuMemory>> buffers(
       assignment.Allocations().size());
   for (BufferAllocation::Index i = 0; i < assignment.Allocations().size();
        ++i) {
     const BufferAllocation& allocation = assignment.GetAllocation(i);
-    TF_ASSIGN_OR_RETURN(buffers[i], MemoryForAllocation(allocation, arguments));
+    TF_ASSIGN_OR_RETURN(buffers[i],
+                        MemoryForAllocation(allocation, arguments, numa_node));
   }
   return std::move(buffers);
 }
@@ -1566,7 +1619,8 @@ StatusOr<PjRtExecutable::Result> TfrtCpuExecutable::ExecuteHelper(
       tensorflow::down_cast<cpu::CpuExecutable*>(cpu_executable_.get());
   TF_ASSIGN_OR_RETURN(
       std::vector<std::shared_ptr<MaybeOwningCpuMemory>> buffer_table,
-      CreateBufferTable(cpu_executable->buffer_assignment(), tracked_buffers));
+      CreateBufferTable(cpu_executable->buffer_assignment(), tracked_buffers,
+                        device->numa_node()));
   TF_ASSIGN_OR_RETURN(auto result_buffers,
                       CreateResultShapedBuffer(result_buffer_indices_,
                                                buffer_table, tracked_buffers));
@@ -1596,7 +1650,7 @@ StatusOr<PjRtExecutable::Result> TfrtCpuExecutable::ExecuteHelper(
   run_options.set_device_ordinal(device->local_hardware_id());
   // Need to keep device_assignment alive until execution completes.
   run_options.set_device_assignment(device_assignment.get());
-  run_options.set_intra_op_thread_pool(client_->eigen_intraop_device());
+  run_options.set_intra_op_thread_pool(client_->eigen_intraop_device(device));
 
   // Schedule only one collective at a time.
   bool is_a_collective_launch = !!last_collective_launch_event;
@@ -20,6 +20,7 @@ limitations under the License.
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/base/thread_annotations.h"
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
@@ -42,6 +43,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/hlo_module_util.h"
 #include "tensorflow/compiler/xla/statusor.h"
 #include "tensorflow/compiler/xla/xla_data.pb.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
 #include "tfrt/host_context/async_value_ref.h"  // from @tf_runtime
 #include "tfrt/host_context/host_context.h"  // from @tf_runtime
@@ -50,7 +52,8 @@ namespace xla {
 
 class TfrtCpuDevice final : public PjRtDevice {
  public:
-  TfrtCpuDevice(int id, bool asynchronous);
+  TfrtCpuDevice(int id, bool asynchronous,
+                int numa_node = tensorflow::port::kNUMANoAffinity);
 
   void SetClient(PjRtClient* client) {
     CHECK(client_ == nullptr);
@@ -83,8 +86,13 @@ class TfrtCpuDevice final : public PjRtDevice {
     return max_inflight_computations_semaphore_;
   }
 
+  // The NUMA node that buffers and intra-op threads of this device are placed
+  // on, or kNUMANoAffinity.
+  int numa_node() const { return numa_node_; }
+
  private:
   int id_;
+  int numa_node_;
   PjRtClient* client_ = nullptr;
 
   // TODO(zhangqiaorjc): Optimize semaphore related overhead.
@@ -97,9 +105,13 @@ class TfrtCpuExecutable;
 
 class TfrtCpuClient final : public PjRtClient {
  public:
+  // With `partition_intra_op_threads` and more than one addressable device,
+  // each device gets its own intra-op pool on its NUMA node, with an equal
+  // share of the threads. Otherwise all devices share one pool.
   TfrtCpuClient(int process_index,
                 std::vector<std::unique_ptr<TfrtCpuDevice>> devices,
-                std::unique_ptr<tfrt::HostContext> host_ctx);
+                std::unique_ptr<tfrt::HostContext> host_ctx,
+                bool partition_intra_op_threads = false);
 
   int process_index() const override { return process_index_; }
 
@@ -206,8 +218,14 @@ class TfrtCpuClient final : public PjRtClient {
 
   tfrt::HostContext* GetHostContext() const { return host_ctx_.get(); }
 
-  Eigen::ThreadPoolDevice* eigen_intraop_device() const {
-    return eigen_intraop_device_.get();
+  // Returns the Eigen device that computations on `device` use for intra-op
+  // parallelism.
+  Eigen::ThreadPoolDevice* eigen_intraop_device(
+      const TfrtCpuDevice* device) const {
+    if (eigen_intraop_devices_.size() == 1) {
+      return eigen_intraop_devices_.front().get();
+    }
+    return eigen_intraop_devices_[device->local_hardware_id()].get();
   }
 
   tfrt::AsyncValueRef<CpuEvent> GetLastCollectiveLaunchEvent() {
@@ -233,9 +251,15 @@ class TfrtCpuClient final : public PjRtClient {
   std::unique_ptr<tfrt::HostContext> host_ctx_;
   std::unique_ptr<ComputationPlacer> computation_placer_;
 
+  // Either a single pool shared by all devices, or one pool per addressable
+  // device, indexed by local_hardware_id. Per-device pools split the host's
+  // threads between devices, so concurrent executions on different devices
+  // don't oversubscribe the cores, and each pool runs on its device's NUMA
+  // node. Eigen's pools steal work between their own threads.
   // TODO(zhangqiaorjc): Use tfrt::compat::EigenHostContextThreadPool.
-  std::unique_ptr<tensorflow::thread::ThreadPool> eigen_intraop_pool_;
-  std::unique_ptr<Eigen::ThreadPoolDevice> eigen_intraop_device_;
+  std::vector<std::unique_ptr<tensorflow::thread::ThreadPool>>
+      eigen_intraop_pools_;
+  std::vector<std::unique_ptr<Eigen::ThreadPoolDevice>> eigen_intraop_devices_;
 
   // Launching collectives are prone to deadlock when we use fixed-sized
   // threadpools since ExecuteHelper will block until all replicas reach the
@@ -675,6 +699,13 @@ class TfrtCpuExecutable final : public PjRtExecutable {
   bool cheap_computation_;
 };
 
+// Returns the NUMA node of the `device_index`th of `num_devices` host devices.
+// Devices are spread over the `num_numa_nodes` nodes in contiguous blocks, so
+// that neighbouring replicas, which tend to exchange the most data, share a
+// node. Returns kNUMANoAffinity when there is a single node.
+int TfrtCpuDeviceNumaNode(int device_index, int num_devices,
+                          int num_numa_nodes);
+
 StatusOr<std::unique_ptr<PjRtClient>> GetTfrtCpuClient(bool asynchronous);
 
 }  // namespace xla
@@ -0,0 +1,111 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/pjrt/tfrt_cpu_pjrt_client.h"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/compiler/xla/pjrt/utils.h"
+#include "tensorflow/compiler/xla/test.h"
+#include "tensorflow/core/platform/casts.h"
+#include "tensorflow/core/platform/numa.h"
+#include "tfrt/host_context/concurrent_work_queue.h"  // from @tf_runtime
+#include "tfrt/host_context/host_allocator.h"  // from @tf_runtime
+#include "tfrt/host_context/host_context.h"  // from @tf_runtime
+
+namespace xla {
+namespace {
+
+// Returns a client with one device per element of `numa_nodes`, the ith one
+// on NUMA node `numa_nodes[i]`.
+std::unique_ptr<TfrtCpuClient> MakeClient(const std::vector<int>& numa_nodes,
+                                          bool partition_intra_op_threads) {
+  auto host_context = std::make_unique<tfrt::HostContext>(
+      [](const tfrt::DecodedDiagnostic& diag) {
+        LOG(ERROR) << "Encountered runtime error: " << diag.message;
+      },
+      tfrt::CreateMallocAllocator(),
+      tfrt::CreateMultiThreadedWorkQueue(
+          /*num_threads=*/std::max<int>(2, numa_nodes.size()),
+          /*num_blocking_threads=*/1));
+  std::vector<std::unique_ptr<TfrtCpuDevice>> devices;
+  for (int i = 0; i < numa_nodes.size(); ++i) {
+    devices.push_back(std::make_unique<TfrtCpuDevice>(
+        /*id=*/i, /*asynchronous=*/true, numa_nodes[i]));
+  }
+  return std::make_unique<TfrtCpuClient>(
+      /*process_index=*/0, std::move(devices), std::move(host_context),
+      partition_intra_op_threads);
+}
+
+Eigen::ThreadPoolDevice* IntraOpDevice(const TfrtCpuClient& client,
+                                       int device_index) {
+  return client.eigen_intraop_device(tensorflow::down_cast<TfrtCpuDevice*>(
+      client.addressable_devices()[device_index]));
+}
+
+TEST(TfrtCpuClientTest, DevicesShareIntraOpThreadsByDefault) {
+  std::unique_ptr<TfrtCpuClient> client =
+      MakeClient({tensorflow::port::kNUMANoAffinity,
+                  tensorflow::port::kNUMANoAffinity},
+                 /*partition_intra_op_threads=*/false);
+  EXPECT_EQ(IntraOpDevice(*client, 0), IntraOpDevice(*client, 1));
+  EXPECT_EQ(IntraOpDevice(*client, 0)->numThreads(), DefaultThreadPoolSize());
+}
+
+TEST(TfrtCpuClientTest, PartitionsIntraOpThreadsBetweenDevices) {
+  std::unique_ptr<TfrtCpuClient> client =
+      MakeClient({tensorflow::port::kNUMANoAffinity,
+                  tensorflow::port::kNUMANoAffinity},
+                 /*partition_intra_op_threads=*/true);
+  EXPECT_NE(IntraOpDevice(*client, 0), IntraOpDevice(*client, 1));
+  const int threads_per_device = std::max(1, DefaultThreadPoolSize() / 2);
+  EXPECT_EQ(IntraOpDevice(*client, 0)->numThreads(), threads_per_device);
+  EXPECT_EQ(IntraOpDevice(*client, 1)->numThreads(), threads_per_device);
+}
+
+TEST(TfrtCpuClientTest, SingleDeviceGetsAllIntraOpThreads) {
+  std::unique_ptr<TfrtCpuClient> client =
+      MakeClient({tensorflow::port::kNUMANoAffinity},
+                 /*partition_intra_op_threads=*/true);
+  EXPECT_EQ(IntraOpDevice(*client, 0)->numThreads(), DefaultThreadPoolSize());
+}
+
+TEST(TfrtCpuDeviceNumaNodeTest, SpreadsDevicesInContiguousBlocks) {
+  std::vector<int> numa_nodes;
+  for (int i = 0; i < 5; ++i) {
+    numa_nodes.push_back(TfrtCpuDeviceNumaNode(i, /*num_devices=*/5,
+                                               /*num_numa_nodes=*/2));
+  }
+  EXPECT_EQ(numa_nodes, std::vector<int>({0, 0, 0, 1, 1}));
+}
+
+TEST(TfrtCpuDeviceNumaNodeTest, MoreNodesThanDevices) {
+  EXPECT_EQ(TfrtCpuDeviceNumaNode(0, /*num_devices=*/2, /*num_numa_nodes=*/4),
+            0);
+  EXPECT_EQ(TfrtCpuDeviceNumaNode(1, /*num_devices=*/2, /*num_numa_nodes=*/4),
+            2);
+}
+
+TEST(TfrtCpuDeviceNumaNodeTest, NoAffinityWithOneNode) {
+  EXPECT_EQ(TfrtCpuDeviceNumaNode(1, /*num_devices=*/2, /*num_numa_nodes=*/1),
+            tensorflow::port::kNUMANoAffinity);
+}
+
+}  // namespace
+}  // namespace xla
@@ -27,6 +27,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/shape_util.h"
 #include "tensorflow/compiler/xla/util.h"
 #include "tensorflow/core/platform/mem.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tfrt/host_context/async_value_ref.h"  // from @tf_runtime
 
 namespace xla {
@@ -41,7 +42,7 @@ class MaybeOwningCpuMemory {
 
   // Owning.
   using OwnedDataPtr =
-      std::unique_ptr<uint8_t[], decltype(tensorflow::port::AlignedFree)*>;
+      std::unique_ptr<uint8_t[], std::function<void(uint8_t*)>>;
   explicit MaybeOwningCpuMemory(OwnedDataPtr data, size_t size)
       : buf_(data.get()), data_(std::move(data)), size_(size) {}
 
@@ -51,9 +52,26 @@ class MaybeOwningCpuMemory {
   MaybeOwningCpuMemory(const MaybeOwningCpuMemory&) = delete;
   MaybeOwningCpuMemory& operator=(const MaybeOwningCpuMemory&) = delete;
 
-  // Owning.
+  // Owning. If `numa_node` is not kNUMANoAffinity and NUMA is enabled, the
+  // memory is allocated on that node.
   static StatusOr<std::shared_ptr<MaybeOwningCpuMemory>> AllocateShared(
-      size_t size) {
+      size_t size, int numa_node = tensorflow::port::kNUMANoAffinity) {
+    if (numa_node != tensorflow::port::kNUMANoAffinity &&
+        tensorflow::port::NUMAEnabled()) {
+      uint8_t* data = static_cast<uint8_t*>(tensorflow::port::NUMAMalloc(
+          numa_node, size, cpu_function_runtime::MinAlign()));
+      if (!data) {
+        return ResourceExhausted(
+            "Out of memory allocating %d bytes on NUMA node %d.", size,
+            numa_node);
+      }
+      return std::make_shared<MaybeOwningCpuMemory>(
+          OwnedDataPtr{data,
+                       [size](uint8_t* data) {
+                         tensorflow::port::NUMAFree(data, size);
+                       }},
+          size);
+    }
     uint8_t* data = static_cast<uint8_t*>(tensorflow::port::AlignedMalloc(
         size, cpu_function_runtime::MinAlign()));
     if (!data) {
@@ -96,6 +96,11 @@ class FilteredPassManager : public llvm::legacy::PassManager {
 
 llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>> CompilerFunctor::operator()(
     llvm::Module& module) {
+  Optimize(module);
+  return EmitObject(module, target_machine_);
+}
+
+void CompilerFunctor::Optimize(llvm::Module& module) {
   FilteredPassManager module_passes(disable_expensive_passes_);
   llvm::legacy::FunctionPassManager function_passes(&module);
 
@@ -139,21 +144,24 @@ llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>> CompilerFunctor::operator()(
 
   runtime::RewriteIRRuntimeFunctions(&module, fast_math_flags_);
 
-  // Buffer for holding machine code prior to constructing the ObjectFile.
-  llvm::SmallVector<char, 0> stream_buffer;
-  llvm::raw_svector_ostream ostream(stream_buffer);
-
   VLOG(2) << "IR after optimizations";
   XLA_VLOG_LINES(2, llvm_ir::DumpModuleToString(module));
 
   if (post_optimization_hook_) {
     post_optimization_hook_(module);
   }
+}
+
+std::unique_ptr<llvm::MemoryBuffer> CompilerFunctor::EmitObject(
+    llvm::Module& module, llvm::TargetMachine* target_machine) const {
+  // Buffer for holding machine code prior to constructing the ObjectFile.
+  llvm::SmallVector<char, 0> stream_buffer;
+  llvm::raw_svector_ostream ostream(stream_buffer);
 
   // Generate code.
   llvm::MCContext* mc_context;
   llvm::legacy::PassManager codegen_passes;
-  target_machine_->addPassesToEmitMC(codegen_passes, mc_context, ostream);
+  target_machine->addPassesToEmitMC(codegen_passes, mc_context, ostream);
   codegen_passes.run(module);
 
   std::unique_ptr<llvm::MemoryBuffer> memory_buffer(
@@ -169,7 +177,7 @@ llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>> CompilerFunctor::operator()(
     }
   }
 
-  return std::move(memory_buffer);
+  return memory_buffer;
 }
 
 static std::vector<llvm::VecDesc> VectorFunctionsForTargetLibraryInfoImpl() {
@@ -54,6 +54,15 @@ class CompilerFunctor : public llvm::orc::IRCompileLayer::IRCompiler {
   llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>> operator()(
       llvm::Module& module) override;
 
+  // Runs the IR optimization pipeline and the IR hooks on `module`.
+  void Optimize(llvm::Module& module);
+
+  // Lowers an optimized `module` to an object file with `target_machine`,
+  // which must not be used by other threads at the same time. Modules in
+  // different LLVMContexts may be lowered concurrently.
+  std::unique_ptr<llvm::MemoryBuffer> EmitObject(
+      llvm::Module& module, llvm::TargetMachine* target_machine) const;
+
  private:
   // Populates the given pass manager with TargetLibraryInfo and
   // TargetTransformInfo passes.
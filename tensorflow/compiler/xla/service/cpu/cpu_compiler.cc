@@ -33,6 +33,7 @@ limitations under the License.
 #include "absl/container/flat_hash_map.h"
 #include "absl/memory/memory.h"
 #include "absl/strings/str_cat.h"
+#include "absl/types/optional.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringRef.h"
@@ -114,6 +115,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/cpu/conv_canonicalization.h"
 #include "tensorflow/compiler/xla/service/cpu/cpu_executable.h"
 #include "tensorflow/compiler/xla/service/cpu/cpu_instruction_fusion.h"
+#include "tensorflow/compiler/xla/service/cpu/cpu_multi_output_fusion.h"
 #include "tensorflow/compiler/xla/service/cpu/cpu_layout_assignment.h"
 #include "tensorflow/compiler/xla/service/cpu/cpu_options.h"
 #include "tensorflow/compiler/xla/service/cpu/dot_op_emitter.h"
@@ -134,6 +136,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/hlo_casting_utils.h"
 #include "tensorflow/compiler/xla/service/hlo_computation.h"
 #include "tensorflow/compiler/xla/service/hlo_constant_folding.h"
+#include "tensorflow/compiler/xla/service/hlo_cost_analysis.h"
 #include "tensorflow/compiler/xla/service/hlo_cse.h"
 #include "tensorflow/compiler/xla/service/hlo_dce.h"
 #include "tensorflow/compiler/xla/service/hlo_instruction.h"
@@ -145,6 +148,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/hlo_pass_fix.h"
 #include "tensorflow/compiler/xla/service/hlo_pass_pipeline.h"
 #include "tensorflow/compiler/xla/service/hlo_proto_util.h"
+#include "tensorflow/compiler/xla/service/hlo_rematerialization.h"
 #include "tensorflow/compiler/xla/service/hlo_subcomputation_unification.h"
 #include "tensorflow/compiler/xla/service/hlo_verifier.h"
 #include "tensorflow/compiler/xla/service/indexed_array_analysis.h"
@@ -182,8 +186,10 @@ limitations under the License.
 #include "tensorflow/compiler/xla/types.h"
 #include "tensorflow/compiler/xla/util.h"
 #include "tensorflow/compiler/xla/xla_data.pb.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/protobuf/error_codes.pb.h"
 
 namespace {
@@ -423,7 +429,10 @@ Status CpuCompiler::RunHloPassesThroughLayoutAssn(
 
       spmd_pipeline.AddPass<ShardingPropagation>(/*is_spmd=*/true);
       spmd_pipeline.AddPass<spmd::StatefulRngSpmdPartitioner>(
-          num_partitions, module->config().replica_count());
+          num_partitions, module->config().replica_count(),
+          module->config()
+              .debug_options()
+              .xla_spmd_memory_budget_per_device_bytes());
     } else {
       // Remove redundant sharding ops when partition_count == 1.
       spmd_pipeline.AddPass<ShardingRemover>();
@@ -576,7 +585,7 @@ Status CpuCompiler::RunHloPassesThroughLayoutAssn(
 }
 
 Status CpuCompiler::RunHloPassesAfterLayoutAssn(
-    HloModule* module, bool is_aot_compile,
+    HloModule* module, bool use_parallel_task_assignment,
     LLVMTargetMachineFeatures* target_machine_features, bool is_mlir_compile) {
   HloPassPipeline pipeline("HLO passes after layout assignment");
 
@@ -596,6 +605,7 @@ Status CpuCompiler::RunHloPassesAfterLayoutAssn(
 
   // Add a fusion pass now that layout assignment is done.
   pipeline.AddPass<CpuInstructionFusion>();
+  pipeline.AddPass<CpuMultiOutputFusion>();
 
   // The LayoutAssignment pass may leave behind kCopy instructions which are
   // duplicate or NOPs, so remove them with algebraic simplification and CSE.
@@ -622,12 +632,10 @@ Status CpuCompiler::RunHloPassesAfterLayoutAssn(
       module->config().intra_op_parallelism_threads() > 0
           ? module->config().intra_op_parallelism_threads()
           : tensorflow::port::NumSchedulableCPUs();
-  if (!is_aot_compile) {
+  if (use_parallel_task_assignment) {
     // Run ParallelTaskAssigner to assign parallel tasks to HLOs in module.
-    // Note this is not run for AOT because it would bring in thread pool
-    // and thread synchronization dependencies which would likely increase
-    // binary size (and most AOT applications are single-threaded).
-    // TODO(b/29630486) Support multi-threaded AOT.
+    // This is optional for AOT because it brings in thread pool and thread
+    // synchronization dependencies which increase binary size.
     pipeline.AddPass<ParallelTaskAssigner>(
         max_parallelism, ShapeSizeBytesFunction(), target_machine_features);
   }
@@ -644,6 +652,7 @@ Status CpuCompiler::RunHloPassesAfterLayoutAssn(
 }
 
 Status CpuCompiler::RunHloPasses(HloModule* module, bool is_aot_compile,
+                                 bool use_parallel_task_assignment,
                                  llvm::TargetMachine* target_machine,
                                  bool is_mlir_compile) {
   if (DumpingEnabledForHloModule(*module)) {
@@ -655,9 +664,54 @@ Status CpuCompiler::RunHloPasses(HloModule* module, bool is_aot_compile,
   TF_RETURN_IF_ERROR(RunHloPassesThroughLayoutAssn(module, is_aot_compile,
                                                    &target_machine_features));
 
-  return RunHloPassesAfterLayoutAssn(
-      module, is_aot_compile, &target_machine_features,
-      UseMlirHloLowering(is_mlir_compile, module));
+  TF_RETURN_IF_ERROR(RunHloPassesAfterLayoutAssn(
+      module, use_parallel_task_assignment, &target_machine_features,
+      UseMlirHloLowering(is_mlir_compile, module)));
+  return RematerializeToMemoryBudget(module);
+}
+
+Status CpuCompiler::RematerializeToMemoryBudget(HloModule* module) {
+  const DebugOptions& debug_options = module->config().debug_options();
+  const int64_t memory_budget_bytes =
+      debug_options.xla_spmd_memory_budget_per_device_bytes();
+  if (memory_budget_bytes <= 0) {
+    return Status::OK();
+  }
+  TF_ASSIGN_OR_RETURN(HloSchedule schedule,
+                      ScheduleModule(module, BufferSizeBytesFunction(),
+                                     ComputationSchedulerToModuleScheduler(
+                                         DFSMemoryScheduler)));
+  TF_RETURN_IF_ERROR(module->set_schedule(std::move(schedule)));
+
+  // Recomputes the instructions that take the least time per byte saved.
+  constexpr float kFlopsPerSecond = 1e11;
+  constexpr float kBytesPerSecond = 1e10;
+  HloCostAnalysis::Options options;
+  options.shape_size = ShapeSizeBytesFunction();
+  options.set_flops_per_second(kFlopsPerSecond);
+  options.set_transcendentals_per_second(kFlopsPerSecond);
+  options.set_bytes_per_second(kBytesPerSecond);
+  HloCostAnalysis cost_analysis(options);
+  for (HloComputation* computation : module->MakeNonfusionComputations()) {
+    TF_RETURN_IF_ERROR(computation->Accept(&cost_analysis));
+  }
+
+  HloRematerialization::RematerializationSizes sizes;
+  HloRematerialization rematerialization(
+      ShapeSizeBytesFunction(), memory_budget_bytes, &sizes,
+      HloRematerialization::RematerializationPass::kPostFusion,
+      /*block_size_limit=*/1, /*block_rematerialization_factor=*/1,
+      /*compact_shape_function=*/nullptr,
+      HloRematerialization::RematerializationMode::kRecomputeOnly,
+      /*min_remat_size=*/0,
+      [&cost_analysis](const HloInstruction& instruction) -> double {
+        return std::max(0.0f, cost_analysis.optimal_seconds(instruction));
+      });
+  TF_RETURN_IF_ERROR(rematerialization.Run(module).status());
+  VLOG(1) << "Rematerialized " << module->name() << " from "
+          << sizes.before_bytes << " to " << sizes.after_bytes
+          << " bytes, for a budget of " << memory_budget_bytes << " bytes";
+  return Status::OK();
 }
 
 namespace {
@@ -779,6 +833,7 @@ StatusOr<std::unique_ptr<HloModule>> CpuCompiler::RunHloPasses(
           CodeGenOptLevel(module->config()));
 
   TF_RETURN_IF_ERROR(RunHloPasses(module.get(), /*is_aot_compile=*/false,
+                                  /*use_parallel_task_assignment=*/true,
                                   jit_target_machine.get()));
   return std::move(module);
 }
@@ -1137,10 +1192,17 @@ StatusOr<std::unique_ptr<Executable>> CpuCompiler::RunBackend(
   // Select an order for emitting the HLO instructions for each
   // computation. Using this sequence enables tighter buffer liveness analysis
   // and reduced memory usage (as compared to using DependencyHloOrdering).
-  TF_ASSIGN_OR_RETURN(HloSchedule schedule,
-                      ScheduleModule(module.get(), BufferSizeBytesFunction(),
-                                     ComputationSchedulerToModuleScheduler(
-                                         DFSMemoryScheduler)));
+  // A module that was rematerialized keeps the schedule it was
+  // rematerialized for.
+  HloSchedule schedule(module.get());
+  if (module->has_schedule()) {
+    schedule = module->schedule();
+  } else {
+    TF_ASSIGN_OR_RETURN(schedule,
+                        ScheduleModule(module.get(), BufferSizeBytesFunction(),
+                                       ComputationSchedulerToModuleScheduler(
+                                           DFSMemoryScheduler)));
+  }
 
   // Run buffer allocation on the HLO graph.
   TF_ASSIGN_OR_RETURN(
@@ -1210,10 +1272,41 @@ StatusOr<std::unique_ptr<Executable>> CpuCompiler::RunBackend(
 
   TF_RETURN_IF_ERROR(VerifyLlvmModule(*llvm_module));
 
-  // JIT compile the LLVM IR module to in-memory machine code.
-  llvm::orc::ThreadSafeModule thread_safe_module(std::move(llvm_module),
-                                                 std::move(llvm_context));
-  cantFail((*jit)->AddModule(std::move(thread_safe_module)));
+  // JIT compile the LLVM IR module to in-memory machine code, generating the
+  // code of parts of the module in parallel if possible. Dumping writes a
+  // single object file, so it disables parallel compilation.
+  tensorflow::thread::ThreadPool* thread_pool = nullptr;
+  absl::optional<tensorflow::thread::ThreadPool> overriding_thread_pool;
+  const int parallelism =
+      module->config().debug_options().xla_cpu_force_compilation_parallelism();
+  if (parallelism == 0) {
+    thread_pool = options.thread_pool;
+  } else if (parallelism > 1) {
+    overriding_thread_pool.emplace(tensorflow::Env::Default(),
+                                   "xla_cpu_compile", parallelism);
+    thread_pool = &*overriding_thread_pool;
+  }
+  int num_functions = 0;
+  for (const llvm::Function& function : llvm_module->functions()) {
+    if (!function.isDeclaration()) ++num_functions;
+  }
+  const int num_parts =
+      thread_pool != nullptr && !DumpingEnabledForHloModule(*module)
+          ? std::min(thread_pool->NumThreads(), num_functions)
+          : 1;
+  if (num_parts > 1) {
+    VLOG(1) << "Compiling " << module->name() << " in " << num_parts
+            << " parts";
+    if (llvm::Error error = (*jit)->AddModuleInParallel(
+            std::move(llvm_module), num_parts, thread_pool)) {
+      return InternalError("Compiling %s failed: %s", module->name(),
+                           llvm::toString(std::move(error)));
+    }
+  } else {
+    llvm::orc::ThreadSafeModule thread_safe_module(std::move(llvm_module),
+                                                   std::move(llvm_context));
+    cantFail((*jit)->AddModule(std::move(thread_safe_module)));
+  }
 
   auto cpu_executable = absl::make_unique<CpuExecutable>(
       std::move(*jit), std::move(assignment), std::move(module), function_name,
@@ -1343,12 +1436,24 @@ CpuCompiler::CompileAheadOfTime(std::unique_ptr<HloModuleGroup> module_group,
     HloModule* module = modules[i].get();
     VLOG(1) << "Compiling ahead-of-time: " << module->name();
 
+    if (options.use_parallel_task_assignment() &&
+        options.max_parallelism() > 0) {
+      module->config().set_intra_op_parallelism_threads(
+          options.max_parallelism());
+    }
     TF_RETURN_IF_ERROR(
-        RunHloPasses(module, /*is_aot_compile=*/true, target_machine.get(),
+        RunHloPasses(module, /*is_aot_compile=*/true,
+                     options.use_parallel_task_assignment(),
+                     target_machine.get(),
                      /*is_mlir_compile=*/options.use_mlir_hlo_lowering()));
 
-    TF_ASSIGN_OR_RETURN(HloSchedule schedule,
-                        ScheduleModule(module, BufferSizeBytesFunction()));
+    HloSchedule schedule(module);
+    if (module->has_schedule()) {
+      schedule = module->schedule();
+    } else {
+      TF_ASSIGN_OR_RETURN(schedule,
+                          ScheduleModule(module, BufferSizeBytesFunction()));
+    }
 
     // Run buffer analysis on the HLO graph. This analysis figures out which
     // temporary buffers are required to run the computation.
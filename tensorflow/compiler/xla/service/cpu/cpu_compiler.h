@@ -72,6 +72,21 @@ class CpuAotCompilationOptions : public AotCompilationOptions {
   bool use_mlir_hlo_lowering() const { return use_mlir_hlo_lowering_; }
   void set_use_mlir_hlo_lowering(bool value) { use_mlir_hlo_lowering_ = value; }
 
+  // Whether to split large HLOs into tasks that run in parallel on the
+  // intra-op thread pool of the run options. The compiled code then needs the
+  // ParallelForkJoin runtime function.
+  bool use_parallel_task_assignment() const {
+    return use_parallel_task_assignment_;
+  }
+  void set_use_parallel_task_assignment(bool value) {
+    use_parallel_task_assignment_ = value;
+  }
+
+  // The maximum number of parallel tasks per HLO. If not positive, the number
+  // of CPUs of the compiling machine is used.
+  int64_t max_parallelism() const { return max_parallelism_; }
+  void set_max_parallelism(int64_t value) { max_parallelism_ = value; }
+
  private:
   const std::string triple_;
   const std::string cpu_name_;
@@ -79,6 +94,8 @@ class CpuAotCompilationOptions : public AotCompilationOptions {
   const std::string entry_point_name_;
   const RelocationModel relocation_model_;
   bool use_mlir_hlo_lowering_ = false;
+  bool use_parallel_task_assignment_ = false;
+  int64_t max_parallelism_ = 0;
 };
 
 class CpuAotCompilationResult : public AotCompilationResult {
@@ -159,6 +176,7 @@ class CpuCompiler : public LLVMCompiler {
   // Runs the HLO passes which are necessary for both optimizations and
   // correctness.
   Status RunHloPasses(HloModule* module, bool is_aot_compile,
+                      bool use_parallel_task_assignment,
                       llvm::TargetMachine* target_machine,
                       bool is_mlir_compile = false);
 
@@ -169,9 +187,13 @@ class CpuCompiler : public LLVMCompiler {
 
   // Runs HLO passes after layout assignment.
   Status RunHloPassesAfterLayoutAssn(
-      HloModule* module, bool is_aot_compile,
+      HloModule* module, bool use_parallel_task_assignment,
       LLVMTargetMachineFeatures* target_machine_features, bool is_mlir_compile);
 
+  // Schedules `module` and rematerializes instructions until its peak memory
+  // fits in xla_spmd_memory_budget_per_device_bytes, if that is set.
+  Status RematerializeToMemoryBudget(HloModule* module);
+
   mutable std::unique_ptr<HloProto> hlo_proto_;
 
   CpuCompiler(const CpuCompiler&) = delete;
@@ -0,0 +1,84 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/cpu/cpu_multi_output_fusion.h"
+
+#include "absl/algorithm/container.h"
+#include "tensorflow/compiler/xla/service/cpu/ir_emission_utils.h"
+#include "tensorflow/compiler/xla/service/hlo_opcode.h"
+#include "tensorflow/compiler/xla/service/llvm_ir/dynamic_update_slice_util.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+
+namespace xla {
+namespace cpu {
+
+namespace {
+
+// Operands at most this large are assumed to still be cache resident when the
+// second of two sibling loops reads them, so reading them twice is cheap.
+// This is the typical per-core L2 cache size, as also assumed by
+// ParallelTaskAssignment.
+constexpr int64_t kL2CacheSizeBytes = 256LL << 10;
+
+}  // namespace
+
+bool CpuMultiOutputFusion::ShapesCompatibleForFusion(HloInstruction* instr1,
+                                                     HloInstruction* instr2) {
+  // The outputs are written by a single loop nest, so they must all have the
+  // same dimensions and layout.
+  return ShapeUtil::Equal(GetLoopShape(*instr1), GetLoopShape(*instr2));
+}
+
+bool CpuMultiOutputFusion::IsFusible(HloInstruction* instr) {
+  if (instr->IsLoopFusion()) {
+    // In-place dynamic-update-slice fusions only write the updated elements
+    // and can't be emitted with a tuple root.
+    return !llvm_ir::MayBeImplementedAsInPlaceDynamicUpdateSlice(instr);
+  }
+  return instr->IsElementwise() && instr->operand_count() > 0 &&
+         instr->shape().IsArray() && instr->opcode() != HloOpcode::kRng;
+}
+
+int64_t CpuMultiOutputFusion::GetProfit(HloInstruction* instr1,
+                                        HloInstruction* instr2) {
+  // Fusing the siblings saves one pass over each operand they share, which
+  // only matters for operands that don't fit in the cache.
+  int64_t profit = 0;
+  for (const HloInstruction* operand : instr2->unique_operands()) {
+    if (!operand->shape().IsArray() ||
+        !absl::c_linear_search(instr1->operands(), operand)) {
+      continue;
+    }
+    const int64_t operand_bytes = ShapeUtil::ByteSizeOf(operand->shape());
+    if (operand_bytes > kL2CacheSizeBytes) {
+      profit += operand_bytes;
+    }
+  }
+  return profit >> 10;
+}
+
+bool CpuMultiOutputFusion::LegalToFuse(HloInstruction* instr1,
+                                       HloInstruction* instr2) {
+  // MultiOutputFusion::Fuse merges into an existing fusion instruction, so at
+  // least one of the siblings must already be a fusion.
+  if (instr1->opcode() != HloOpcode::kFusion &&
+      instr2->opcode() != HloOpcode::kFusion) {
+    return false;
+  }
+  return LegalToFuseMainConstraints(instr1, instr2);
+}
+
+}  // namespace cpu
+}  // namespace xla
@@ -0,0 +1,51 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_CPU_CPU_MULTI_OUTPUT_FUSION_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_CPU_CPU_MULTI_OUTPUT_FUSION_H_
+
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/service/multi_output_fusion.h"
+
+namespace xla {
+namespace cpu {
+
+// Fuses sibling loop fusions (and elementwise ops) that read a common operand
+// into a single multi-output loop fusion, so that the operand is streamed
+// through the cache once instead of once per consumer.
+//
+// This pass must run after CpuInstructionFusion, which creates the loop
+// fusions it merges, and after layout assignment, since all outputs of a
+// multi-output loop fusion are emitted from the same loop nest and must
+// therefore have the same shape and layout.
+class CpuMultiOutputFusion : public MultiOutputFusion {
+ public:
+  CpuMultiOutputFusion() = default;
+  ~CpuMultiOutputFusion() override = default;
+
+  absl::string_view name() const override { return "cpu-multi-output-fusion"; }
+
+ protected:
+  bool ShapesCompatibleForFusion(HloInstruction* instr1,
+                                 HloInstruction* instr2) override;
+  bool IsFusible(HloInstruction* instr) override;
+  int64_t GetProfit(HloInstruction* instr1, HloInstruction* instr2) override;
+  bool LegalToFuse(HloInstruction* instr1, HloInstruction* instr2) override;
+};
+
+}  // namespace cpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_CPU_CPU_MULTI_OUTPUT_FUSION_H_
@@ -0,0 +1,170 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/cpu/cpu_multi_output_fusion.h"
+
+#include "tensorflow/compiler/xla/service/hlo_matchers.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+
+namespace op = xla::testing::opcode_matchers;
+
+namespace xla {
+namespace cpu {
+namespace {
+
+using CpuMultiOutputFusionTest = HloTestBase;
+
+TEST_F(CpuMultiOutputFusionTest, SiblingLoopFusionsWithLargeOperandAreFused) {
+  const char* hlo_string = R"(
+    HloModule module
+
+    fused_computation.1 {
+      p.1 = f32[512,512]{1,0} parameter(0)
+      exp.1 = f32[512,512]{1,0} exponential(p.1)
+      ROOT add.1 = f32[512,512]{1,0} add(exp.1, p.1)
+    }
+
+    fused_computation.2 {
+      p.2 = f32[512,512]{1,0} parameter(0)
+      neg.2 = f32[512,512]{1,0} negate(p.2)
+      ROOT mul.2 = f32[512,512]{1,0} multiply(neg.2, p.2)
+    }
+
+    ENTRY entry {
+      p0 = f32[512,512]{1,0} parameter(0)
+      fusion.1 = f32[512,512]{1,0} fusion(p0), kind=kLoop,
+        calls=fused_computation.1
+      fusion.2 = f32[512,512]{1,0} fusion(p0), kind=kLoop,
+        calls=fused_computation.2
+      ROOT tuple = (f32[512,512]{1,0}, f32[512,512]{1,0})
+        tuple(fusion.1, fusion.2)
+    }
+  )";
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed,
+                          CpuMultiOutputFusion().Run(module.get()));
+  ASSERT_TRUE(changed);
+
+  const HloInstruction* root = module->entry_computation()->root_instruction();
+  EXPECT_THAT(root,
+              op::Tuple(op::GetTupleElement(op::Fusion(op::Parameter(0))),
+                        op::GetTupleElement(op::Fusion(op::Parameter(0)))));
+  const HloInstruction* fusion = root->operand(0)->operand(0);
+  EXPECT_EQ(fusion, root->operand(1)->operand(0));
+  EXPECT_TRUE(fusion->IsMultiOutputFusion());
+  EXPECT_TRUE(fusion->IsLoopFusion());
+}
+
+TEST_F(CpuMultiOutputFusionTest, ElementwiseSiblingIsFusedIntoLoopFusion) {
+  const char* hlo_string = R"(
+    HloModule module
+
+    fused_computation {
+      p = f32[512,512]{1,0} parameter(0)
+      exp = f32[512,512]{1,0} exponential(p)
+      ROOT add = f32[512,512]{1,0} add(exp, p)
+    }
+
+    ENTRY entry {
+      p0 = f32[512,512]{1,0} parameter(0)
+      fusion = f32[512,512]{1,0} fusion(p0), kind=kLoop,
+        calls=fused_computation
+      negate = f32[512,512]{1,0} negate(p0)
+      ROOT tuple = (f32[512,512]{1,0}, f32[512,512]{1,0})
+        tuple(fusion, negate)
+    }
+  )";
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed,
+                          CpuMultiOutputFusion().Run(module.get()));
+  ASSERT_TRUE(changed);
+
+  const HloInstruction* root = module->entry_computation()->root_instruction();
+  EXPECT_THAT(root, op::Tuple(op::GetTupleElement(op::Fusion()),
+                              op::GetTupleElement(op::Fusion())));
+  EXPECT_TRUE(root->operand(0)->operand(0)->IsMultiOutputFusion());
+}
+
+TEST_F(CpuMultiOutputFusionTest, CacheResidentOperandIsNotFused) {
+  // Reading a 16KiB operand a second time hits in the cache, so fusing the
+  // siblings isn't worth it.
+  const char* hlo_string = R"(
+    HloModule module
+
+    fused_computation.1 {
+      p.1 = f32[64,64]{1,0} parameter(0)
+      exp.1 = f32[64,64]{1,0} exponential(p.1)
+      ROOT add.1 = f32[64,64]{1,0} add(exp.1, p.1)
+    }
+
+    fused_computation.2 {
+      p.2 = f32[64,64]{1,0} parameter(0)
+      neg.2 = f32[64,64]{1,0} negate(p.2)
+      ROOT mul.2 = f32[64,64]{1,0} multiply(neg.2, p.2)
+    }
+
+    ENTRY entry {
+      p0 = f32[64,64]{1,0} parameter(0)
+      fusion.1 = f32[64,64]{1,0} fusion(p0), kind=kLoop,
+        calls=fused_computation.1
+      fusion.2 = f32[64,64]{1,0} fusion(p0), kind=kLoop,
+        calls=fused_computation.2
+      ROOT tuple = (f32[64,64]{1,0}, f32[64,64]{1,0}) tuple(fusion.1, fusion.2)
+    }
+  )";
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed,
+                          CpuMultiOutputFusion().Run(module.get()));
+  EXPECT_FALSE(changed);
+}
+
+TEST_F(CpuMultiOutputFusionTest, DifferentOutputLayoutsAreNotFused) {
+  const char* hlo_string = R"(
+    HloModule module
+
+    fused_computation.1 {
+      p.1 = f32[512,512]{1,0} parameter(0)
+      ROOT exp.1 = f32[512,512]{1,0} exponential(p.1)
+    }
+
+    fused_computation.2 {
+      p.2 = f32[512,512]{1,0} parameter(0)
+      neg.2 = f32[512,512]{1,0} negate(p.2)
+      ROOT copy.2 = f32[512,512]{0,1} copy(neg.2)
+    }
+
+    ENTRY entry {
+      p0 = f32[512,512]{1,0} parameter(0)
+      fusion.1 = f32[512,512]{1,0} fusion(p0), kind=kLoop,
+        calls=fused_computation.1
+      fusion.2 = f32[512,512]{0,1} fusion(p0), kind=kLoop,
+        calls=fused_computation.2
+      ROOT tuple = (f32[512,512]{1,0}, f32[512,512]{0,1})
+        tuple(fusion.1, fusion.2)
+    }
+  )";
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed,
+                          CpuMultiOutputFusion().Run(module.get()));
+  EXPECT_FALSE(changed);
+}
+
+}  // namespace
+}  // namespace cpu
+}  // namespace xla
@@ -35,6 +35,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/refcounting_hash_map.h"
 #include "tensorflow/compiler/xla/service/collective_ops_utils.h"
 #include "tensorflow/compiler/xla/service/computation_placer.h"
+#include "tensorflow/compiler/xla/service/cpu/hlo_sampler.h"
 #include "tensorflow/compiler/xla/service/hlo_parser.h"
 #include "tensorflow/compiler/xla/shape_util.h"
 #include "tensorflow/compiler/xla/statusor.h"
@@ -136,6 +137,8 @@ extern const char* const kTopKF32SymbolName = "__xla_cpu_runtime_TopKF32";
 extern const char* const kTracingStartSymbolName =
     "__xla_cpu_runtime_TracingStart";
 extern const char* const kTracingEndSymbolName = "__xla_cpu_runtime_TracingEnd";
+extern const char* const kSetCurrentHloSymbolName =
+    "__xla_cpu_runtime_SetCurrentHlo";
 extern const char* const kXlaCpuRuntimeSymbolNamePrefix = "__xla_cpu_runtime_";
 extern const char* const kAllReduceSymbolName = "__xla_cpu_runtime_AllReduce";
 extern const char* const kAllToAllSymbolName = "__xla_cpu_runtime_AllToAll";
@@ -277,6 +280,12 @@ ABSL_ATTRIBUTE_NO_SANITIZE_MEMORY void __xla_cpu_runtime_TracingEnd(
   tensorflow::profiler::TraceMe::ActivityEnd(id);
 }
 
+ABSL_ATTRIBUTE_NO_SANITIZE_MEMORY void __xla_cpu_runtime_SetCurrentHlo(
+    int64_t module_id, int64_t instruction_id) {
+  xla::cpu::SetCurrentHlo(static_cast<int>(module_id),
+                          static_cast<int>(instruction_id));
+}
+
 }  // extern "C"
 
 ABSL_ATTRIBUTE_NO_SANITIZE_MEMORY void*
@@ -85,6 +85,7 @@ extern const char* const kPartitionIdSymbolName;
 extern const char* const kReplicaIdSymbolName;
 extern const char* const kTracingStartSymbolName;
 extern const char* const kTracingEndSymbolName;
+extern const char* const kSetCurrentHloSymbolName;
 extern const char* const kAllToAllSymbolName;
 
 // All symbol names for XLA CPU runtime functions need to start with this
@@ -108,6 +109,8 @@ extern int64_t __xla_cpu_runtime_TracingStart(
     const char* name);
 extern void __xla_cpu_runtime_TracingEnd(
     const void* /* xla::ExecutableRunOptions* */ run_options_ptr, int64_t id);
+extern void __xla_cpu_runtime_SetCurrentHlo(int64_t module_id,
+                                            int64_t instruction_id);
 
 // Some things common to all of the runtime entry points below:
 //
@@ -23,6 +23,7 @@ limitations under the License.
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Value.h"
+#include "llvm/Support/Host.h"
 #include "mlir/Dialect/Arithmetic/Utils/Utils.h"  // from @llvm-project
 #include "mlir/Dialect/Func/IR/FuncOps.h"  // from @llvm-project
 #include "mlir/Dialect/Linalg/Transforms/CodegenStrategy.h"  // from @llvm-project
@@ -36,6 +37,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/cpu/cpu_options.h"
 #include "tensorflow/compiler/xla/service/cpu/cpu_runtime.h"
 #include "tensorflow/compiler/xla/service/cpu/ir_emission_utils.h"
+#include "tensorflow/compiler/xla/service/cpu/matmul_autotuning.h"
 #include "tensorflow/compiler/xla/service/cpu/mlir_emitter.h"
 #include "tensorflow/compiler/xla/service/cpu/target_machine_features.h"
 #include "tensorflow/compiler/xla/service/cpu/tiled_dot_emitter.h"
@@ -49,6 +51,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/status_macros.h"
 #include "tensorflow/compiler/xla/util.h"
 #include "tensorflow/compiler/xla/xla_data.pb.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/logging.h"
 
 namespace xla {
@@ -62,6 +65,45 @@ bool ShouldUseMultiThreadedEigen(const HloModuleConfig& config) {
   return config.debug_options().xla_cpu_multi_thread_eigen();
 }
 
+// Matrix multiplications with more multiply-adds than this aren't autotuned,
+// to bound the time spent benchmarking; the multi-threaded routines are
+// expected to be the fastest for them anyway.
+constexpr int64_t kMaxAutotunedMatMulSize = int64_t{1} << 27;
+
+// Sets `multi_threaded` and `use_mkl_dnn` to select the fastest runtime routine
+// for the column-major matrix multiplication of an m x k lhs and a k x n rhs,
+// among those the configuration allows.
+Status AutotuneMatMulRuntime(const HloModuleConfig& config, PrimitiveType type,
+                             int64_t m, int64_t n, int64_t k,
+                             bool transpose_lhs, bool transpose_rhs,
+                             bool* multi_threaded, bool* use_mkl_dnn) {
+  if (m * n * k > kMaxAutotunedMatMulSize) {
+    return Status::OK();
+  }
+  MatMulAutotuneKey key;
+  key.type = type;
+  key.m = m;
+  key.n = n;
+  key.k = k;
+  key.transpose_lhs = transpose_lhs;
+  key.transpose_rhs = transpose_rhs;
+  key.num_threads = config.intra_op_parallelism_threads() > 0
+                        ? config.intra_op_parallelism_threads()
+                        : tensorflow::port::NumSchedulableCPUs();
+  key.cpu = llvm::sys::getHostCPUName().str();
+  TF_ASSIGN_OR_RETURN(
+      MatMulRuntime runtime,
+      PickMatMulRuntime(
+          key,
+          GetMatMulRuntimeCandidates(type, *multi_threaded, *use_mkl_dnn),
+          config.debug_options().xla_cpu_matmul_autotuning_database()));
+  *multi_threaded = runtime == MatMulRuntime::kEigenMultiThreaded ||
+                    runtime == MatMulRuntime::kMklMultiThreaded;
+  *use_mkl_dnn = runtime == MatMulRuntime::kMklSingleThreaded ||
+                 runtime == MatMulRuntime::kMklMultiThreaded;
+  return Status::OK();
+}
+
 // Represents a dot operation.  We use this in lieu of an `HloInstruction`
 // because we want to be able to create this for the "inner" dot operation in a
 // batch dot, for which there is no separate HLO instruction.
@@ -762,6 +804,40 @@ Status DotOpEmitter::EmitCallToRuntime() {
   bool multi_threaded = ShouldUseMultiThreadedEigen(hlo_module_config_);
   bool use_mkl_dnn = hlo_module_config_.debug_options().xla_cpu_use_mkl_dnn();
   PrimitiveType type = target_array_.GetShape().element_type();
+
+  // The Eigen runtime function expects column-major layout. If the matrices are
+  // row major, then use the following identity to compute the product:
+  //
+  //   (A x B)^T = B^T x A^T
+  //
+  // The connection between this identity and memory layout is that the
+  // transpose operation can also be considered as an operation that changes the
+  // memory layout of a matrix from row-major to column-major or vice versa.
+  //
+  // Effectively this involves swapping the 'lhs' with 'rhs' and 'm' with 'n'.
+
+  MatMultDims mat_mult_dims = GetMatMultDims();
+
+  CHECK_EQ(mat_mult_dims.lhs_column_major, mat_mult_dims.rhs_column_major);
+
+  const llvm_ir::IrArray* lhs = &lhs_array_;
+  const llvm_ir::IrArray* rhs = &rhs_array_;
+  bool transpose_lhs = !mat_mult_dims.lhs_canonical;
+  bool transpose_rhs = !mat_mult_dims.rhs_canonical;
+
+  if (!mat_mult_dims.lhs_column_major) {
+    std::swap(mat_mult_dims.m, mat_mult_dims.n);
+    std::swap(lhs, rhs);
+    std::swap(transpose_lhs, transpose_rhs);
+  }
+
+  if (hlo_module_config_.debug_options().xla_cpu_enable_matmul_autotuning()) {
+    TF_RETURN_IF_ERROR(AutotuneMatMulRuntime(
+        hlo_module_config_, type, mat_mult_dims.m, mat_mult_dims.n,
+        mat_mult_dims.k, transpose_lhs, transpose_rhs, &multi_threaded,
+        &use_mkl_dnn));
+  }
+
   llvm::Function* function = b_->GetInsertBlock()->getParent();
   llvm::Module* module = function->getParent();
   llvm::Type* float_type;
@@ -832,32 +908,6 @@ Status DotOpEmitter::EmitCallToRuntime() {
     fn->setOnlyAccessesArgMemory();
   }
 
-  // The Eigen runtime function expects column-major layout. If the matrices are
-  // row major, then use the following identity to compute the product:
-  //
-  //   (A x B)^T = B^T x A^T
-  //
-  // The connection between this identity and memory layout is that the
-  // transpose operation can also be considered as an operation that changes the
-  // memory layout of a matrix from row-major to column-major or vice versa.
-  //
-  // Effectively this involves swapping the 'lhs' with 'rhs' and 'm' with 'n'.
-
-  MatMultDims mat_mult_dims = GetMatMultDims();
-
-  CHECK_EQ(mat_mult_dims.lhs_column_major, mat_mult_dims.rhs_column_major);
-
-  const llvm_ir::IrArray* lhs = &lhs_array_;
-  const llvm_ir::IrArray* rhs = &rhs_array_;
-  bool transpose_lhs = !mat_mult_dims.lhs_canonical;
-  bool transpose_rhs = !mat_mult_dims.rhs_canonical;
-
-  if (!mat_mult_dims.lhs_column_major) {
-    std::swap(mat_mult_dims.m, mat_mult_dims.n);
-    std::swap(lhs, rhs);
-    std::swap(transpose_lhs, transpose_rhs);
-  }
-
   b_->CreateCall(
       matmul_func,
       {b_->CreateBitCast(executable_run_options_value_, int8_ptr_type),
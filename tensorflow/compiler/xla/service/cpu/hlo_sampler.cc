@@ -0,0 +1,183 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/cpu/hlo_sampler.h"
+
+#include <atomic>
+#include <utility>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/synchronization/mutex.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+// Slot value of a thread that is not executing any HLO.
+constexpr int64_t kIdle = -1;
+
+struct ThreadSlot {
+  int64_t thread_id = 0;
+  // The module unique id in the upper 32 bits and the instruction unique id
+  // in the lower 32 bits, or kIdle.
+  std::atomic<int64_t> current{kIdle};
+};
+
+struct SlotRegistry {
+  absl::Mutex mu;
+  absl::flat_hash_set<ThreadSlot*> slots ABSL_GUARDED_BY(mu);
+};
+
+SlotRegistry& GetSlotRegistry() {
+  static auto* registry = new SlotRegistry();
+  return *registry;
+}
+
+// Registers the slot of a thread on its first SetCurrentHlo call and removes
+// it again when the thread exits.
+class ThreadSlotHolder {
+ public:
+  ThreadSlotHolder() {
+    slot_.thread_id = tensorflow::Env::Default()->GetCurrentThreadId();
+    SlotRegistry& registry = GetSlotRegistry();
+    absl::MutexLock lock(&registry.mu);
+    registry.slots.insert(&slot_);
+  }
+
+  ~ThreadSlotHolder() {
+    SlotRegistry& registry = GetSlotRegistry();
+    absl::MutexLock lock(&registry.mu);
+    registry.slots.erase(&slot_);
+  }
+
+  ThreadSlot& slot() { return slot_; }
+
+ private:
+  ThreadSlot slot_;
+};
+
+int64_t PackHlo(int module_id, int instruction_id) {
+  return static_cast<int64_t>(
+      (static_cast<uint64_t>(static_cast<uint32_t>(module_id)) << 32) |
+      static_cast<uint32_t>(instruction_id));
+}
+
+}  // namespace
+
+void SetCurrentHlo(int module_id, int instruction_id) {
+  static thread_local ThreadSlotHolder holder;
+  holder.slot().current.store(
+      instruction_id == -1 ? kIdle : PackHlo(module_id, instruction_id),
+      std::memory_order_relaxed);
+}
+
+HloSampler::HloSampler(absl::Duration period)
+    : period_ns_(absl::ToInt64Nanoseconds(period)) {
+  CHECK_GT(period_ns_, 0);
+}
+
+HloSampler::~HloSampler() {
+  if (thread_) {
+    Stop();
+  }
+}
+
+void HloSampler::Start() {
+  CHECK(!thread_) << "HloSampler already started";
+  stop_ = std::make_unique<absl::Notification>();
+  thread_.reset(tensorflow::Env::Default()->StartThread(
+      tensorflow::ThreadOptions(), "xla_cpu_hlo_sampler", [this] {
+        const absl::Duration period = absl::Nanoseconds(period_ns_);
+        while (!stop_->WaitForNotificationWithTimeout(period)) {
+          TakeSample(tensorflow::Env::Default()->NowNanos());
+        }
+      }));
+}
+
+std::vector<HloSampler::Run> HloSampler::Stop() {
+  if (thread_) {
+    stop_->Notify();
+    // Joins the sampling thread.
+    thread_.reset();
+  }
+  for (auto& open_run : open_runs_) {
+    runs_.push_back(open_run.second);
+  }
+  open_runs_.clear();
+  return std::exchange(runs_, {});
+}
+
+void HloSampler::CloseRun(int64_t thread_id) {
+  auto it = open_runs_.find(thread_id);
+  if (it != open_runs_.end()) {
+    runs_.push_back(it->second);
+    open_runs_.erase(it);
+  }
+}
+
+void HloSampler::TakeSample(uint64_t now_ns) {
+  std::vector<std::pair<int64_t, int64_t>> observed;
+  {
+    SlotRegistry& registry = GetSlotRegistry();
+    absl::MutexLock lock(&registry.mu);
+    observed.reserve(registry.slots.size());
+    for (const ThreadSlot* slot : registry.slots) {
+      observed.emplace_back(slot->thread_id,
+                            slot->current.load(std::memory_order_relaxed));
+    }
+  }
+
+  absl::flat_hash_set<int64_t> busy_threads;
+  for (const auto& sample : observed) {
+    const int64_t thread_id = sample.first;
+    const int64_t value = sample.second;
+    if (value == kIdle) {
+      continue;
+    }
+    busy_threads.insert(thread_id);
+    const int module_id = static_cast<int>(static_cast<uint64_t>(value) >> 32);
+    const int instruction_id = static_cast<int>(static_cast<uint32_t>(value));
+    auto it = open_runs_.find(thread_id);
+    if (it != open_runs_.end() && it->second.module_id == module_id &&
+        it->second.instruction_id == instruction_id) {
+      it->second.end_ns = now_ns + period_ns_;
+      ++it->second.num_samples;
+      continue;
+    }
+    CloseRun(thread_id);
+    Run& run = open_runs_[thread_id];
+    run.thread_id = thread_id;
+    run.module_id = module_id;
+    run.instruction_id = instruction_id;
+    run.start_ns = now_ns;
+    run.end_ns = now_ns + period_ns_;
+    run.num_samples = 1;
+  }
+
+  // Threads that went idle or exited since the previous sample end their run.
+  std::vector<int64_t> finished;
+  for (const auto& open_run : open_runs_) {
+    if (!busy_threads.contains(open_run.first)) {
+      finished.push_back(open_run.first);
+    }
+  }
+  for (int64_t thread_id : finished) {
+    CloseRun(thread_id);
+  }
+}
+
+}  // namespace cpu
+}  // namespace xla
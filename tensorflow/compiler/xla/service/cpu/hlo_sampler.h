@@ -0,0 +1,89 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_CPU_HLO_SAMPLER_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_CPU_HLO_SAMPLER_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/time.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace xla {
+namespace cpu {
+
+// Statistical attribution of CPU time to HLO instructions.
+//
+// XLA:CPU emits a whole computation into a single LLVM function, so program
+// counter samples cannot be mapped back to individual HLOs. Instead, when
+// xla_cpu_enable_hlo_sampling is set, the IR emitter calls
+// __xla_cpu_runtime_SetCurrentHlo before every non-trivial instruction of the
+// entry computation. That call is a single relaxed store into a per-thread
+// slot. While an HloSampler is running, a background thread reads every slot
+// once per period and merges consecutive samples of the same instruction on
+// the same thread into a Run. Without a running sampler nothing is recorded,
+// so executables compiled with the flag can be profiled on demand.
+
+// Records that the calling thread is now executing the instruction with
+// unique id `instruction_id` of the module with unique id `module_id`. An
+// `instruction_id` of -1 marks the thread as no longer executing any HLO.
+void SetCurrentHlo(int module_id, int instruction_id);
+
+class HloSampler {
+ public:
+  // A maximal span of consecutive samples that observed the same instruction
+  // on the same thread.
+  struct Run {
+    int64_t thread_id;
+    int module_id;
+    int instruction_id;
+    uint64_t start_ns;
+    uint64_t end_ns;
+    int64_t num_samples;
+  };
+
+  explicit HloSampler(absl::Duration period);
+  ~HloSampler();
+
+  // Starts the sampling thread. Must not be called while already running.
+  void Start();
+
+  // Stops the sampling thread and returns the runs recorded since Start.
+  std::vector<Run> Stop();
+
+  // Takes one sample of all threads at time `now_ns`. Exposed for tests;
+  // must not be called while the sampling thread is running.
+  void TakeSample(uint64_t now_ns);
+
+ private:
+  void CloseRun(int64_t thread_id);
+
+  const uint64_t period_ns_;
+  std::unique_ptr<tensorflow::Thread> thread_;
+  std::unique_ptr<absl::Notification> stop_;
+
+  // Only accessed by the sampling thread while it is running.
+  absl::flat_hash_map<int64_t, Run> open_runs_;
+  std::vector<Run> runs_;
+};
+
+}  // namespace cpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_CPU_HLO_SAMPLER_H_
@@ -0,0 +1,111 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/cpu/hlo_sampler.h"
+
+#include <memory>
+#include <vector>
+
+#include "absl/synchronization/notification.h"
+#include "absl/time/time.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+std::vector<HloSampler::Run> RunsOfThread(
+    const std::vector<HloSampler::Run>& runs, int64_t thread_id) {
+  std::vector<HloSampler::Run> result;
+  for (const HloSampler::Run& run : runs) {
+    if (run.thread_id == thread_id) {
+      result.push_back(run);
+    }
+  }
+  return result;
+}
+
+TEST(HloSamplerTest, MergesConsecutiveSamplesOfSameInstruction) {
+  const int64_t thread_id = tensorflow::Env::Default()->GetCurrentThreadId();
+  HloSampler sampler(absl::Nanoseconds(1000));
+
+  SetCurrentHlo(/*module_id=*/7, /*instruction_id=*/3);
+  sampler.TakeSample(1000);
+  sampler.TakeSample(2000);
+  SetCurrentHlo(/*module_id=*/7, /*instruction_id=*/4);
+  sampler.TakeSample(3000);
+  SetCurrentHlo(/*module_id=*/7, /*instruction_id=*/-1);
+  sampler.TakeSample(4000);
+  sampler.TakeSample(5000);
+
+  std::vector<HloSampler::Run> runs = RunsOfThread(sampler.Stop(), thread_id);
+  ASSERT_EQ(runs.size(), 2);
+  EXPECT_EQ(runs[0].module_id, 7);
+  EXPECT_EQ(runs[0].instruction_id, 3);
+  EXPECT_EQ(runs[0].start_ns, 1000);
+  EXPECT_EQ(runs[0].end_ns, 3000);
+  EXPECT_EQ(runs[0].num_samples, 2);
+  EXPECT_EQ(runs[1].module_id, 7);
+  EXPECT_EQ(runs[1].instruction_id, 4);
+  EXPECT_EQ(runs[1].start_ns, 3000);
+  EXPECT_EQ(runs[1].end_ns, 4000);
+  EXPECT_EQ(runs[1].num_samples, 1);
+}
+
+TEST(HloSamplerTest, ClosesRunWhenThreadExits) {
+  HloSampler sampler(absl::Nanoseconds(1000));
+  absl::Notification marked;
+  absl::Notification sampled;
+  int64_t thread_id = 0;
+  std::unique_ptr<tensorflow::Thread> thread(
+      tensorflow::Env::Default()->StartThread(
+          tensorflow::ThreadOptions(), "marked_thread", [&] {
+            thread_id = tensorflow::Env::Default()->GetCurrentThreadId();
+            SetCurrentHlo(/*module_id=*/1, /*instruction_id=*/2);
+            marked.Notify();
+            sampled.WaitForNotification();
+          }));
+  marked.WaitForNotification();
+  sampler.TakeSample(1000);
+  sampled.Notify();
+  thread.reset();
+  sampler.TakeSample(2000);
+
+  std::vector<HloSampler::Run> runs = RunsOfThread(sampler.Stop(), thread_id);
+  ASSERT_EQ(runs.size(), 1);
+  EXPECT_EQ(runs[0].instruction_id, 2);
+  EXPECT_EQ(runs[0].end_ns, 2000);
+}
+
+TEST(HloSamplerTest, SamplingThreadRecordsCurrentInstruction) {
+  const int64_t thread_id = tensorflow::Env::Default()->GetCurrentThreadId();
+  HloSampler sampler(absl::Milliseconds(1));
+
+  SetCurrentHlo(/*module_id=*/5, /*instruction_id=*/9);
+  sampler.Start();
+  tensorflow::Env::Default()->SleepForMicroseconds(50 * 1000);
+  std::vector<HloSampler::Run> runs = RunsOfThread(sampler.Stop(), thread_id);
+  SetCurrentHlo(/*module_id=*/5, /*instruction_id=*/-1);
+
+  ASSERT_FALSE(runs.empty());
+  EXPECT_EQ(runs[0].module_id, 5);
+  EXPECT_EQ(runs[0].instruction_id, 9);
+  EXPECT_GT(runs[0].num_samples, 0);
+}
+
+}  // namespace
+}  // namespace cpu
+}  // namespace xla
@@ -40,6 +40,13 @@ int64_t GetMinimumAlignmentForArray(
       allocation_size_bytes);
 }
 
+const Shape& GetLoopShape(const HloInstruction& instruction) {
+  if (instruction.IsMultiOutputFusion()) {
+    return ShapeUtil::GetSubshape(instruction.shape(), {0});
+  }
+  return instruction.shape();
+}
+
 bool PotentiallyImplementedAsEigenConvolution(
     const HloInstruction& convolution,
     const TargetMachineFeatures& target_machine_features) {
@@ -32,6 +32,11 @@ bool PotentiallyImplementedAsEigenConvolution(
 int64_t GetMinimumAlignmentForArray(
     const Shape& shape, const TargetMachineFeatures& target_machine_features);
 
+// Returns the array shape iterated over by the loop nest emitted for
+// `instruction`: the shape of its first output for multi-output loop fusions
+// (all of whose outputs have the same shape), and its own shape otherwise.
+const Shape& GetLoopShape(const HloInstruction& instruction);
+
 // Dynamic loop bounds are specified as an array of dimension index
 // [start, limit) pairs of ir values (one for each partitioned outer dimension).
 //
@@ -207,6 +207,9 @@ StatusOr<llvm::Function*> IrEmitter::EmitComputation(
   builder()->setFastMathFlags(flags);
 
   TF_RETURN_IF_ERROR(computation->AcceptOrdered(this, instruction_order));
+  if (ShouldEmitHloSamplingMarkers()) {
+    EmitSetCurrentHlo(*computation->parent(), /*instruction_id=*/-1);
+  }
   llvm::Function* ir_function = compute_function_->function();
   InsertOrDie(&emitted_functions_,
               ComputationToEmit{computation, allow_reassociation}, ir_function);
@@ -1756,8 +1759,17 @@ StatusOr<bool> IrEmitter::EmitVectorizedReduce(
       MinimumAlignmentForPrimitiveType(reduce->shape().element_type())));
 
   if (is_reduction_over_minor_dimension) {
-    // TODO(sanjoy): Implement vectorized reduction over the minor dimension.
-    *failure_reason = "reduction over minor dimension not implemented";
+    return EmitVectorizedRowReduce(reduce, arg, init_value, dimensions,
+                                   reduction_generator,
+                                   vector_register_size_in_elements,
+                                   element_alignment, failure_reason);
+  }
+
+  // The vectorized loop below strides over the most minor output dimension, so
+  // it can't be partitioned between parallel tasks.
+  if (ShouldEmitParallelLoopFor(*reduce) &&
+      num_dynamic_loop_bounds_ >= reduce->shape().dimensions_size()) {
+    *failure_reason = "partitioning the minor dimension not implemented";
     return false;
   }
 
@@ -1785,17 +1797,8 @@ StatusOr<bool> IrEmitter::EmitVectorizedReduce(
   //  }
 
   llvm_ir::ForLoopNest loop_nest(IrName(reduce), &b_);
-  std::vector<llvm::Value*> array_multi_index(
-      reduce->shape().dimensions_size());
-  for (int i = LayoutUtil::MinorToMajor(reduce->shape()).size() - 1; i > 0;
-       --i) {
-    int64_t dimension = LayoutUtil::Minor(reduce->shape().layout(), i);
-    int64_t start_index = 0;
-    int64_t end_index = reduce->shape().dimensions(dimension);
-    std::unique_ptr<llvm_ir::ForLoop> loop = loop_nest.AddLoop(
-        start_index, end_index, absl::StrFormat("dim.%d", dimension));
-    array_multi_index[dimension] = loop->GetIndVarValue();
-  }
+  std::vector<llvm::Value*> array_multi_index = EmitReduceOutputLoops(
+      *reduce, reduce->shape().dimensions_size() - 1, &loop_nest);
 
   int64_t innermost_dimension = LayoutUtil::Minor(reduce->shape().layout(), 0);
   int64_t innermost_dimension_size =
@@ -1880,6 +1883,192 @@ StatusOr<bool> IrEmitter::EmitVectorizedReduce(
   return true;
 }
 
+std::vector<llvm::Value*> IrEmitter::EmitReduceOutputLoops(
+    const HloInstruction& reduce, int64_t num_loops,
+    llvm_ir::ForLoopNest* loop_nest) {
+  const Shape& shape = reduce.shape();
+  // As in ParallelLoopEmitter, the dynamic loop bounds partition the most
+  // major dimensions.
+  std::vector<std::pair<llvm::Value*, llvm::Value*>> dynamic_loop_bounds;
+  if (ShouldEmitParallelLoopFor(reduce)) {
+    dynamic_loop_bounds = compute_function_->GetDynamicLoopBounds();
+  }
+  std::vector<llvm::Value*> multi_index(shape.dimensions_size());
+  for (int64_t i = 0; i < num_loops; ++i) {
+    int64_t dimension =
+        LayoutUtil::Minor(shape.layout(), shape.dimensions_size() - 1 - i);
+    std::unique_ptr<llvm_ir::ForLoop> loop;
+    if (i < dynamic_loop_bounds.size()) {
+      loop = loop_nest->AddLoop(absl::StrFormat("dim.%d", dimension),
+                                dynamic_loop_bounds[i].first,
+                                dynamic_loop_bounds[i].second);
+    } else {
+      loop = loop_nest->AddLoop(0, shape.dimensions(dimension),
+                                absl::StrFormat("dim.%d", dimension));
+    }
+    multi_index[dimension] = loop->GetIndVarValue();
+  }
+  return multi_index;
+}
+
+StatusOr<bool> IrEmitter::EmitVectorizedRowReduce(
+    HloInstruction* reduce, HloInstruction* arg, HloInstruction* init_value,
+    absl::Span<const int64_t> dimensions,
+    const ReductionGenerator& reduction_generator,
+    int vector_register_size_in_elements, llvm::Align element_alignment,
+    std::string* failure_reason) {
+  // The elements reduced into one output element must be contiguous, i.e. the
+  // reduced dimensions must be the most minor ones.
+  const Shape& arg_shape = arg->shape();
+  int64_t row_size = 1;
+  for (int64_t i = 0; i < dimensions.size(); ++i) {
+    int64_t dimension = LayoutUtil::Minor(arg_shape.layout(), i);
+    if (!absl::c_linear_search(dimensions, dimension)) {
+      *failure_reason =
+          "reduction over minor and major dimensions not implemented";
+      return false;
+    }
+    row_size *= arg_shape.dimensions(dimension);
+  }
+
+  // Rows are reduced one chunk at a time, a chunk being one vector register
+  // per accumulator.
+  constexpr int64_t kMaxNumAccumulators = 4;
+  const int64_t vector_size = vector_register_size_in_elements;
+  const int64_t num_accumulators =
+      std::min(kMaxNumAccumulators, row_size / vector_size);
+  if (num_accumulators == 0) {
+    *failure_reason = "reduced rows are shorter than a vector register";
+    return false;
+  }
+  const int64_t chunk_size = num_accumulators * vector_size;
+  const int64_t vectorized_row_size = row_size / chunk_size * chunk_size;
+
+  TF_RETURN_IF_ERROR(EmitTargetAddressForOp(reduce));
+
+  // We lower the reduction loop as:
+  //
+  //  1. VS is the number of elements in a vector register.
+  //  2. K is the number of accumulators.
+  //
+  //  for (d in output dimensions) {
+  //    row = &input[d, 0]
+  //    acc[k] = row[k * VS : (k + 1) * VS] for k in [0, K)
+  //    for (r in [K * VS, vectorized_row_size) with stride K * VS) {
+  //      acc[k] = elementwise_reduce(acc[k], row[r + k * VS : ...])
+  //    }
+  //    result = reduce(init, elements of reduce(acc[0], ..., acc[K - 1]))
+  //    for (r in [vectorized_row_size, row_size)) {
+  //      result = reduce(result, row[r])
+  //    }
+  //    output[d] = result
+  //  }
+  //
+  // Independent accumulators hide the latency of the reduction function.
+  // Starting them from the first chunk rather than from the init value applies
+  // the init value once, as the scalar loop does.
+  llvm_ir::ForLoopNest loop_nest(IrName(reduce), &b_);
+  std::vector<llvm::Value*> output_multi_index = EmitReduceOutputLoops(
+      *reduce, reduce->shape().dimensions_size(), &loop_nest);
+  if (llvm::BasicBlock* innermost_body_bb =
+          loop_nest.GetInnerLoopBodyBasicBlock()) {
+    SetToFirstInsertPoint(innermost_body_bb, &b_);
+  }
+  auto outermost_loop_exit_block = loop_nest.GetOuterLoopExitBasicBlock();
+
+  std::vector<llvm::Value*> row_multi_index(arg_shape.dimensions_size());
+  auto output_it = output_multi_index.begin();
+  for (int64_t i = 0; i < arg_shape.dimensions_size(); ++i) {
+    row_multi_index[i] =
+        absl::c_linear_search(dimensions, i) ? b_.getInt64(0) : *output_it++;
+  }
+  CHECK(output_multi_index.end() == output_it);
+  llvm_ir::IrArray arg_array(GetIrArrayFor(arg));
+  llvm_ir::IrArray::Index row_index(row_multi_index, arg_shape,
+                                    b_.getInt64Ty());
+  llvm::Type* element_type =
+      llvm_ir::PrimitiveTypeToIrType(reduce->shape().element_type(), module_);
+  llvm::Type* vector_type =
+      llvm::VectorType::get(element_type, vector_size, false);
+  llvm::Value* row =
+      BitCast(arg_array.EmitArrayElementAddress(row_index, &b_),
+              element_type->getPointerTo());
+
+  auto load_row_element = [&](llvm::Type* type, llvm::Value* offset) {
+    llvm::Value* address =
+        BitCast(InBoundsGEP(row, {offset}), type->getPointerTo());
+    llvm::LoadInst* load = AlignedLoad(type, address, element_alignment);
+    arg_array.AnnotateLoadStoreInstructionWithMetadata(load);
+    return load;
+  };
+
+  std::vector<llvm::Value*> accumulators;
+  accumulators.reserve(num_accumulators);
+  for (int64_t k = 0; k < num_accumulators; ++k) {
+    accumulators.push_back(llvm_ir::EmitAllocaAtFunctionEntry(
+        vector_type, "accumulator", &b_, 0));
+    AlignedStore(load_row_element(vector_type, b_.getInt64(k * vector_size)),
+                 accumulators.back(), element_alignment);
+  }
+
+  if (vectorized_row_size > chunk_size) {
+    llvm_ir::ForLoopNest chunk_loop_nest(IrName(reduce, "chunk"), &b_);
+    std::unique_ptr<llvm_ir::ForLoop> loop = chunk_loop_nest.AddLoop(
+        chunk_size, vectorized_row_size, chunk_size, "chunk");
+    SetToFirstInsertPoint(loop->GetBodyBasicBlock(), &b_);
+    for (int64_t k = 0; k < num_accumulators; ++k) {
+      llvm::Value* offset =
+          NSWAdd(loop->GetIndVarValue(), b_.getInt64(k * vector_size));
+      llvm::Value* reduced = reduction_generator(
+          &b_, AlignedLoad(vector_type, accumulators[k], element_alignment),
+          load_row_element(vector_type, offset));
+      AlignedStore(reduced, accumulators[k], element_alignment);
+    }
+    SetToFirstInsertPoint(chunk_loop_nest.GetOuterLoopExitBasicBlock(), &b_);
+  }
+
+  llvm::Value* vector_result =
+      AlignedLoad(vector_type, accumulators[0], element_alignment);
+  for (int64_t k = 1; k < num_accumulators; ++k) {
+    vector_result = reduction_generator(
+        &b_, vector_result,
+        AlignedLoad(vector_type, accumulators[k], element_alignment));
+  }
+  llvm::Value* result = Load(GetEmittedValueFor(init_value));
+  for (int64_t i = 0; i < vector_size; ++i) {
+    result = reduction_generator(
+        &b_, result, b_.CreateExtractElement(vector_result, i));
+  }
+
+  if (vectorized_row_size < row_size) {
+    llvm::Value* result_address = llvm_ir::EmitAllocaAtFunctionEntry(
+        element_type, "row_reduce_result", &b_, 0);
+    Store(result, result_address);
+    llvm_ir::ForLoopNest remainder_loop_nest(IrName(reduce, "remainder"),
+                                             &b_);
+    std::unique_ptr<llvm_ir::ForLoop> loop =
+        remainder_loop_nest.AddLoop(vectorized_row_size, row_size, "remainder");
+    SetToFirstInsertPoint(loop->GetBodyBasicBlock(), &b_);
+    Store(reduction_generator(
+              &b_, Load(element_type, result_address),
+              load_row_element(element_type, loop->GetIndVarValue())),
+          result_address);
+    SetToFirstInsertPoint(remainder_loop_nest.GetOuterLoopExitBasicBlock(),
+                          &b_);
+    result = Load(element_type, result_address);
+  }
+
+  llvm_ir::IrArray target_array = GetIrArrayFor(reduce);
+  llvm_ir::IrArray::Index output_index(output_multi_index, reduce->shape(),
+                                       b_.getInt64Ty());
+  target_array.EmitWriteArrayElement(output_index, result, &b_);
+
+  if (outermost_loop_exit_block) {
+    b_.SetInsertPoint(outermost_loop_exit_block);
+  }
+  return true;
+}
+
 Status IrEmitter::HandleReduce(HloInstruction* reduce) {
   auto arg = reduce->mutable_operand(0);
   auto init_value = reduce->mutable_operand(1);
@@ -2237,7 +2426,7 @@ Status IrEmitter::HandleCall(HloInstruction* call) {
     // each call such that it only generates one partition of the output.
     HloInstruction* root = computation->root_instruction();
     TF_RETURN_IF_ERROR(EmitCallToParallelForkJoin(
-        call_args, root->shape(), root->outer_dimension_partitions(), &b_,
+        call_args, GetLoopShape(*root), root->outer_dimension_partitions(), &b_,
         call_ir_function, computation->name()));
 
     if (ComputationTransitivelyContainsCustomCall(computation)) {
@@ -3091,6 +3280,27 @@ void IrEmitter::TracingState::EmitTracingEnd(llvm::IRBuilder<>* b,
                 {b->CreateBitCast(run_options, void_ptr_type), activity_id});
 }
 
+bool IrEmitter::ShouldEmitHloSamplingMarkers() const {
+  return is_top_level_computation_ &&
+         hlo_module_config_.debug_options().xla_cpu_enable_hlo_sampling();
+}
+
+void IrEmitter::EmitSetCurrentHlo(const HloModule& module,
+                                  int instruction_id) {
+  llvm::FunctionType* fn_type = llvm::FunctionType::get(
+      b_.getVoidTy(), {b_.getInt64Ty(), b_.getInt64Ty()}, /*isVarArg=*/false);
+  llvm::FunctionCallee set_current_hlo_func = module_->getOrInsertFunction(
+      runtime::kSetCurrentHloSymbolName, fn_type);
+  if (auto* fn =
+          llvm::dyn_cast<llvm::Function>(set_current_hlo_func.getCallee())) {
+    fn->setCallingConv(llvm::CallingConv::C);
+    fn->setDoesNotThrow();
+    fn->setOnlyAccessesInaccessibleMemory();
+  }
+  b_.CreateCall(set_current_hlo_func, {b_.getInt64(module.unique_id()),
+                                       b_.getInt64(instruction_id)});
+}
+
 namespace {
 bool IsHloVeryCheap(const HloInstruction* hlo) {
   return hlo->opcode() == HloOpcode::kBitcast ||
@@ -3111,6 +3321,9 @@ Status IrEmitter::Preprocess(HloInstruction* hlo) {
                                     GetExecutableRunOptionsArgument());
     profiling_state_.RecordCycleStart(&b_, hlo);
   }
+  if (ShouldEmitHloSamplingMarkers() && !IsHloVeryCheap(hlo)) {
+    EmitSetCurrentHlo(*hlo->GetModule(), hlo->unique_id());
+  }
   return Status::OK();
 }
 
@@ -3303,7 +3516,8 @@ Status IrEmitter::EmitTargetElementLoop(
        target_op->opcode() == HloOpcode::kReduce ||
        target_op->opcode() == HloOpcode::kReduceWindow)) {
     // For multiple outputs fusion, we need to emit each operand and the root.
-    TF_RET_CHECK(num_dynamic_loop_bounds_ == 0);
+    TF_RET_CHECK(num_dynamic_loop_bounds_ == 0 ||
+                 ShouldEmitParallelLoopFor(*target_op));
     std::vector<llvm_ir::IrArray> output_arrays;
     for (int64_t i = 0; i < ShapeUtil::TupleElementCount(target_shape); ++i) {
       TF_ASSIGN_OR_RETURN(BufferAllocation::Slice slice,
@@ -3313,9 +3527,19 @@ Status IrEmitter::EmitTargetElementLoop(
       output_arrays.push_back(
           llvm_ir::IrArray(op_target_address, element_shape));
     }
-    TF_RETURN_IF_ERROR(
-        llvm_ir::LoopEmitter(element_generator, output_arrays, &b_)
-            .EmitLoop(IrName(target_op)));
+    if (ShouldEmitParallelLoopFor(*target_op)) {
+      // All outputs of a multi-output loop fusion have the same shape, so the
+      // dynamic loop bounds of the partition apply to each of them.
+      std::vector<std::pair<llvm::Value*, llvm::Value*>> dynamic_loop_bounds =
+          compute_function_->GetDynamicLoopBounds();
+      TF_RETURN_IF_ERROR(ParallelLoopEmitter(element_generator, output_arrays,
+                                             &dynamic_loop_bounds, &b_)
+                             .EmitLoop(IrName(target_op)));
+    } else {
+      TF_RETURN_IF_ERROR(
+          llvm_ir::LoopEmitter(element_generator, output_arrays, &b_)
+              .EmitLoop(IrName(target_op)));
+    }
 
     std::vector<llvm::Value*> tuple_operand_ptrs;
     for (int64_t i = 0; i < output_arrays.size(); ++i) {
@@ -422,6 +422,25 @@ class IrEmitter : public DfsHloVisitorWithDefault,
       HloInstruction* arg, absl::Span<const int64_t> dimensions,
       llvm::Align element_alignment);
 
+  // Emits the reduction of the contiguous rows formed by the most minor
+  // dimensions of "arg", e.g. the statistics of softmax and layer
+  // normalization, using several vector accumulators per row.  Helper function
+  // for EmitVectorizedReduce.
+  StatusOr<bool> EmitVectorizedRowReduce(
+      HloInstruction* reduce, HloInstruction* arg, HloInstruction* init_value,
+      absl::Span<const int64_t> dimensions,
+      const ReductionGenerator& reduction_generator,
+      int vector_register_size_in_elements, llvm::Align element_alignment,
+      std::string* failure_reason);
+
+  // Adds loops over the "num_loops" most major dimensions of the output of
+  // "reduce" to "loop_nest", and returns the index with these dimensions set.
+  // The loops over partitioned dimensions use the dynamic loop bounds when
+  // "reduce" is emitted as a parallel loop.
+  std::vector<llvm::Value*> EmitReduceOutputLoops(
+      const HloInstruction& reduce, int64_t num_loops,
+      llvm_ir::ForLoopNest* loop_nest);
+
   // Tries to emit a fast concatenate operation using memcpy.  Returns true if
   // successful, and false on failure.  On failure, sets "failure_reason" to a
   // string describing why it could not emit a fast concatenate.
@@ -610,6 +629,16 @@ class IrEmitter : public DfsHloVisitorWithDefault,
   };
   TracingState tracing_state_;
 
+  // Returns true if the emitted code should report the HLO each thread is
+  // executing to the CPU HLO sampler. Only the top-level computation is
+  // marked: nested computations such as reducers run per element and would
+  // make the marker expensive.
+  bool ShouldEmitHloSamplingMarkers() const;
+
+  // Emits a call that records instruction `instruction_id` of `module` as the
+  // HLO executed by the current thread. An id of -1 marks the thread idle.
+  void EmitSetCurrentHlo(const HloModule& module, int instruction_id);
+
   // Given a load instruction and a shape or buffer size, annotate the load's
   // result with the alignment required by the shape or size.
   void AttachAlignmentMetadataForLoad(llvm::LoadInst* load, const Shape& shape);
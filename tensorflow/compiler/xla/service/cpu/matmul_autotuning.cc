@@ -0,0 +1,394 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#define EIGEN_USE_THREADS
+
+#include "tensorflow/compiler/xla/service/cpu/matmul_autotuning.h"
+
+#include <algorithm>
+#include <complex>
+#include <cstring>
+#include <functional>
+#include <memory>
+
+#include "absl/algorithm/container.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/str_split.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/compiler/xla/executable_run_options.h"
+#include "tensorflow/compiler/xla/primitive_util.h"
+#include "tensorflow/compiler/xla/service/cpu/runtime_matmul.h"
+#include "tensorflow/compiler/xla/service/cpu/runtime_single_threaded_matmul.h"
+#include "tensorflow/compiler/xla/status_macros.h"
+#include "tensorflow/compiler/xla/util.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mem.h"
+
+#if defined(ENABLE_MKL) && !defined(INTEL_MKL_DNN_ONLY)
+#define XLA_CPU_MATMUL_AUTOTUNING_HAS_MKL
+#include "tensorflow/compiler/xla/service/cpu/runtime_matmul_mkl.h"
+#endif
+
+namespace xla {
+namespace cpu {
+namespace {
+
+// Timed runs of each candidate, after a warm-up run. The fastest run is used,
+// as the least disturbed by the rest of the process.
+constexpr int kNumTimedRuns = 5;
+
+// Serializes benchmarks, for concurrent compilations not to skew each other's
+// measurements.
+absl::Mutex benchmark_mu(absl::kConstInit);
+
+const char* MatMulRuntimeName(MatMulRuntime runtime) {
+  switch (runtime) {
+    case MatMulRuntime::kEigenSingleThreaded:
+      return "eigen-single-threaded";
+    case MatMulRuntime::kEigenMultiThreaded:
+      return "eigen-multi-threaded";
+    case MatMulRuntime::kMklSingleThreaded:
+      return "mkl-single-threaded";
+    case MatMulRuntime::kMklMultiThreaded:
+      return "mkl-multi-threaded";
+  }
+}
+
+absl::optional<MatMulRuntime> ParseMatMulRuntime(absl::string_view name) {
+  for (MatMulRuntime runtime :
+       {MatMulRuntime::kEigenSingleThreaded, MatMulRuntime::kEigenMultiThreaded,
+        MatMulRuntime::kMklSingleThreaded, MatMulRuntime::kMklMultiThreaded}) {
+    if (name == MatMulRuntimeName(runtime)) {
+      return runtime;
+    }
+  }
+  return absl::nullopt;
+}
+
+bool IsMultiThreaded(MatMulRuntime runtime) {
+  return runtime == MatMulRuntime::kEigenMultiThreaded ||
+         runtime == MatMulRuntime::kMklMultiThreaded;
+}
+
+bool IsMkl(MatMulRuntime runtime) {
+  return runtime == MatMulRuntime::kMklSingleThreaded ||
+         runtime == MatMulRuntime::kMklMultiThreaded;
+}
+
+// Parses one line of a database file.
+StatusOr<std::pair<MatMulAutotuneKey, MatMulRuntime>> ParseResult(
+    absl::string_view line) {
+  std::vector<absl::string_view> fields =
+      absl::StrSplit(line, ' ', absl::SkipEmpty());
+  if (fields.size() != 9) {
+    return InvalidArgument("Malformed matmul autotuning result: %s", line);
+  }
+  MatMulAutotuneKey key;
+  TF_ASSIGN_OR_RETURN(key.type, primitive_util::StringToPrimitiveType(
+                                    std::string(fields[0])));
+  int transpose_lhs, transpose_rhs;
+  if (!absl::SimpleAtoi(fields[1], &key.m) ||
+      !absl::SimpleAtoi(fields[2], &key.n) ||
+      !absl::SimpleAtoi(fields[3], &key.k) ||
+      !absl::SimpleAtoi(fields[4], &transpose_lhs) ||
+      !absl::SimpleAtoi(fields[5], &transpose_rhs) ||
+      !absl::SimpleAtoi(fields[6], &key.num_threads)) {
+    return InvalidArgument("Malformed matmul autotuning result: %s", line);
+  }
+  key.transpose_lhs = transpose_lhs != 0;
+  key.transpose_rhs = transpose_rhs != 0;
+  key.cpu = std::string(fields[7]);
+  absl::optional<MatMulRuntime> runtime = ParseMatMulRuntime(fields[8]);
+  if (!runtime) {
+    return InvalidArgument("Unknown matmul runtime in autotuning result: %s",
+                           line);
+  }
+  return std::make_pair(key, *runtime);
+}
+
+// A call to a runtime matmul routine with the dimensions of a key.
+using MatMulCall = std::function<void(const ExecutableRunOptions*, void* out,
+                                      void* lhs, void* rhs)>;
+
+template <typename T>
+MatMulCall BindMatMul(void (*matmul)(const void*, T*, T*, T*, int64_t,
+                                     int64_t, int64_t, int32_t, int32_t),
+                      const MatMulAutotuneKey& key) {
+  return [matmul, key](const ExecutableRunOptions* run_options, void* out,
+                       void* lhs, void* rhs) {
+    matmul(run_options, static_cast<T*>(out), static_cast<T*>(lhs),
+           static_cast<T*>(rhs), key.m, key.n, key.k, key.transpose_lhs,
+           key.transpose_rhs);
+  };
+}
+
+StatusOr<MatMulCall> GetMatMulCall(const MatMulAutotuneKey& key,
+                                   MatMulRuntime runtime) {
+  const bool multi_threaded = IsMultiThreaded(runtime);
+  if (IsMkl(runtime)) {
+#ifdef XLA_CPU_MATMUL_AUTOTUNING_HAS_MKL
+    switch (key.type) {
+      case F32:
+        return BindMatMul(multi_threaded
+                              ? __xla_cpu_runtime_MKLMatMulF32
+                              : __xla_cpu_runtime_MKLSingleThreadedMatMulF32,
+                          key);
+      case F64:
+        return BindMatMul(multi_threaded
+                              ? __xla_cpu_runtime_MKLMatMulF64
+                              : __xla_cpu_runtime_MKLSingleThreadedMatMulF64,
+                          key);
+      default:
+        break;
+    }
+#endif  // XLA_CPU_MATMUL_AUTOTUNING_HAS_MKL
+    return Unimplemented("No MKL matmul for %s",
+                         PrimitiveType_Name(key.type));
+  }
+  switch (key.type) {
+    case F16:
+      return BindMatMul(multi_threaded
+                            ? __xla_cpu_runtime_EigenMatMulF16
+                            : __xla_cpu_runtime_EigenSingleThreadedMatMulF16,
+                        key);
+    case F32:
+      return BindMatMul(multi_threaded
+                            ? __xla_cpu_runtime_EigenMatMulF32
+                            : __xla_cpu_runtime_EigenSingleThreadedMatMulF32,
+                        key);
+    case F64:
+      return BindMatMul(multi_threaded
+                            ? __xla_cpu_runtime_EigenMatMulF64
+                            : __xla_cpu_runtime_EigenSingleThreadedMatMulF64,
+                        key);
+    case C64:
+      return BindMatMul(multi_threaded
+                            ? __xla_cpu_runtime_EigenMatMulC64
+                            : __xla_cpu_runtime_EigenSingleThreadedMatMulC64,
+                        key);
+    case C128:
+      return BindMatMul(multi_threaded
+                            ? __xla_cpu_runtime_EigenMatMulC128
+                            : __xla_cpu_runtime_EigenSingleThreadedMatMulC128,
+                        key);
+    case S32:
+      return BindMatMul(multi_threaded
+                            ? __xla_cpu_runtime_EigenMatMulS32
+                            : __xla_cpu_runtime_EigenSingleThreadedMatMulS32,
+                        key);
+    default:
+      return Unimplemented("No Eigen matmul for %s",
+                           PrimitiveType_Name(key.type));
+  }
+}
+
+// A zero-initialized scratch buffer, aligned like XLA:CPU buffers are.
+class ScratchBuffer {
+ public:
+  explicit ScratchBuffer(int64_t size)
+      : data_(tensorflow::port::AlignedMalloc(std::max<int64_t>(size, 1), 64)) {
+    std::memset(data_, 0, size);
+  }
+  ~ScratchBuffer() { tensorflow::port::AlignedFree(data_); }
+
+  ScratchBuffer(const ScratchBuffer&) = delete;
+  ScratchBuffer& operator=(const ScratchBuffer&) = delete;
+
+  void* data() const { return data_; }
+
+ private:
+  void* data_;
+};
+
+}  // namespace
+
+std::string MatMulAutotuneKey::ToString() const {
+  return absl::StrCat(primitive_util::LowercasePrimitiveTypeName(type), " ", m,
+                      " ", n, " ", k, " ", transpose_lhs ? 1 : 0, " ",
+                      transpose_rhs ? 1 : 0, " ", num_threads, " ", cpu);
+}
+
+std::vector<MatMulRuntime> GetMatMulRuntimeCandidates(
+    PrimitiveType type, bool allow_multi_threaded, bool allow_mkl) {
+  std::vector<MatMulRuntime> candidates = {MatMulRuntime::kEigenSingleThreaded};
+  if (allow_multi_threaded) {
+    candidates.push_back(MatMulRuntime::kEigenMultiThreaded);
+  }
+#ifdef XLA_CPU_MATMUL_AUTOTUNING_HAS_MKL
+  if (allow_mkl && (type == F32 || type == F64)) {
+    candidates.push_back(MatMulRuntime::kMklSingleThreaded);
+    if (allow_multi_threaded) {
+      candidates.push_back(MatMulRuntime::kMklMultiThreaded);
+    }
+  }
+#endif  // XLA_CPU_MATMUL_AUTOTUNING_HAS_MKL
+  return candidates;
+}
+
+/*static*/ MatMulAutotuneDatabase* MatMulAutotuneDatabase::Global() {
+  static auto* database = new MatMulAutotuneDatabase();
+  return database;
+}
+
+absl::optional<MatMulRuntime> MatMulAutotuneDatabase::Lookup(
+    const MatMulAutotuneKey& key) const {
+  absl::MutexLock lock(&mu_);
+  auto it = results_.find(key);
+  if (it == results_.end()) {
+    return absl::nullopt;
+  }
+  return it->second;
+}
+
+MatMulRuntime MatMulAutotuneDatabase::Insert(const MatMulAutotuneKey& key,
+                                             MatMulRuntime runtime) {
+  absl::MutexLock lock(&mu_);
+  return results_.emplace(key, runtime).first->second;
+}
+
+Status MatMulAutotuneDatabase::LoadOnce(const std::string& path) {
+  absl::MutexLock lock(&mu_);
+  if (!loaded_paths_.insert(path).second) {
+    return Status::OK();
+  }
+  return Load(path);
+}
+
+Status MatMulAutotuneDatabase::Load(const std::string& path) {
+  tensorflow::Env* env = tensorflow::Env::Default();
+  if (!env->FileExists(path).ok()) {
+    return Status::OK();
+  }
+  std::string contents;
+  TF_RETURN_IF_ERROR(tensorflow::ReadFileToString(env, path, &contents));
+  for (absl::string_view line :
+       absl::StrSplit(contents, '\n', absl::SkipWhitespace())) {
+    TF_ASSIGN_OR_RETURN(auto result, ParseResult(line));
+    // Results measured by this process take precedence.
+    results_.insert(std::move(result));
+  }
+  return Status::OK();
+}
+
+Status MatMulAutotuneDatabase::Save(const std::string& path) {
+  absl::MutexLock lock(&mu_);
+  TF_RETURN_IF_ERROR(Load(path));
+  std::vector<std::string> lines;
+  lines.reserve(results_.size());
+  for (const auto& result : results_) {
+    lines.push_back(absl::StrCat(result.first.ToString(), " ",
+                                 MatMulRuntimeName(result.second)));
+  }
+  absl::c_sort(lines);
+
+  // The file may be shared by many processes, so write to a unique file and
+  // move it in place, for readers to never see a partially written database.
+  tensorflow::Env* env = tensorflow::Env::Default();
+  std::string temp_path = path;
+  if (!env->CreateUniqueFileName(&temp_path, ".tmp")) {
+    return Internal("Failed to create a temporary file name for %s", path);
+  }
+  TF_RETURN_IF_ERROR(tensorflow::WriteStringToFile(
+      env, temp_path, absl::StrCat(absl::StrJoin(lines, "\n"), "\n")));
+  Status status = env->RenameFile(temp_path, path);
+  if (!status.ok()) {
+    env->DeleteFile(temp_path).IgnoreError();
+  }
+  return status;
+}
+
+StatusOr<MatMulRuntime> PickMatMulRuntime(
+    const MatMulAutotuneKey& key, absl::Span<const MatMulRuntime> candidates,
+    const std::string& database_path) {
+  TF_RET_CHECK(!candidates.empty());
+  TF_RET_CHECK(key.num_threads > 0);
+  if (candidates.size() == 1) {
+    return candidates[0];
+  }
+
+  MatMulAutotuneDatabase* database = MatMulAutotuneDatabase::Global();
+  if (!database_path.empty()) {
+    Status status = database->LoadOnce(database_path);
+    if (!status.ok()) {
+      LOG(WARNING) << "Ignoring matmul autotuning database " << database_path
+                   << ": " << status;
+    }
+  }
+  auto lookup = [&]() -> absl::optional<MatMulRuntime> {
+    absl::optional<MatMulRuntime> runtime = database->Lookup(key);
+    if (runtime && absl::c_linear_search(candidates, *runtime)) {
+      return runtime;
+    }
+    return absl::nullopt;
+  };
+  if (absl::optional<MatMulRuntime> runtime = lookup()) {
+    return *runtime;
+  }
+
+  absl::MutexLock lock(&benchmark_mu);
+  // Another compilation may have benchmarked the same matmul meanwhile.
+  if (absl::optional<MatMulRuntime> runtime = lookup()) {
+    return *runtime;
+  }
+
+  const int64_t element_size = primitive_util::ByteWidth(key.type);
+  ScratchBuffer lhs(key.m * key.k * element_size);
+  ScratchBuffer rhs(key.k * key.n * element_size);
+  ScratchBuffer out(key.m * key.n * element_size);
+
+  tensorflow::thread::ThreadPool pool(tensorflow::Env::Default(),
+                                      "XLAMatMulAutotuning", key.num_threads);
+  Eigen::ThreadPoolDevice device(pool.AsEigenThreadPool(), pool.NumThreads());
+  ExecutableRunOptions run_options;
+  run_options.set_intra_op_thread_pool(&device);
+
+  MatMulRuntime best = candidates[0];
+  absl::Duration best_time = absl::InfiniteDuration();
+  for (MatMulRuntime candidate : candidates) {
+    TF_ASSIGN_OR_RETURN(MatMulCall matmul, GetMatMulCall(key, candidate));
+    matmul(&run_options, out.data(), lhs.data(), rhs.data());
+    absl::Duration time = absl::InfiniteDuration();
+    for (int i = 0; i < kNumTimedRuns; ++i) {
+      const absl::Time start = absl::Now();
+      matmul(&run_options, out.data(), lhs.data(), rhs.data());
+      time = std::min(time, absl::Now() - start);
+    }
+    VLOG(2) << "Matmul " << key.ToString() << " with "
+            << MatMulRuntimeName(candidate) << ": " << time;
+    if (time < best_time) {
+      best = candidate;
+      best_time = time;
+    }
+  }
+
+  best = database->Insert(key, best);
+  if (!database_path.empty()) {
+    Status status = database->Save(database_path);
+    if (!status.ok()) {
+      LOG(WARNING) << "Failed to save matmul autotuning database "
+                   << database_path << ": " << status;
+    }
+  }
+  return best;
+}
+
+}  // namespace cpu
+}  // namespace xla
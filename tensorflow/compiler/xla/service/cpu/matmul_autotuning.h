@@ -0,0 +1,126 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_CPU_MATMUL_AUTOTUNING_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_CPU_MATMUL_AUTOTUNING_H_
+
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/optional.h"
+#include "absl/types/span.h"
+#include "tensorflow/compiler/xla/statusor.h"
+#include "tensorflow/compiler/xla/xla_data.pb.h"
+
+namespace xla {
+namespace cpu {
+
+// The runtime library routines a matrix multiplication emitted as a library
+// call can be implemented with.
+enum class MatMulRuntime {
+  kEigenSingleThreaded,
+  kEigenMultiThreaded,
+  kMklSingleThreaded,
+  kMklMultiThreaded,
+};
+
+// Identifies a matrix multiplication for autotuning, in the column-major
+// terms of the runtime routines: lhs is m x k, rhs is k x n and the result is
+// m x n. Multi-threaded routines are benchmarked with `num_threads` threads on
+// the `cpu` compiling the computation.
+struct MatMulAutotuneKey {
+  PrimitiveType type;
+  int64_t m;
+  int64_t n;
+  int64_t k;
+  bool transpose_lhs;
+  bool transpose_rhs;
+  int num_threads;
+  std::string cpu;
+
+  std::string ToString() const;
+
+  template <typename H>
+  friend H AbslHashValue(H h, const MatMulAutotuneKey& key) {
+    return H::combine(std::move(h), key.type, key.m, key.n, key.k,
+                      key.transpose_lhs, key.transpose_rhs, key.num_threads,
+                      key.cpu);
+  }
+
+  friend bool operator==(const MatMulAutotuneKey& a,
+                         const MatMulAutotuneKey& b) {
+    return std::tie(a.type, a.m, a.n, a.k, a.transpose_lhs, a.transpose_rhs,
+                    a.num_threads, a.cpu) ==
+           std::tie(b.type, b.m, b.n, b.k, b.transpose_lhs, b.transpose_rhs,
+                    b.num_threads, b.cpu);
+  }
+};
+
+// Returns the runtime routines available for a matrix multiplication of
+// `type` elements. Multi-threaded routines are only returned if
+// `allow_multi_threaded`, and MKL routines only if `allow_mkl` and XLA was
+// built with MKL.
+std::vector<MatMulRuntime> GetMatMulRuntimeCandidates(
+    PrimitiveType type, bool allow_multi_threaded, bool allow_mkl);
+
+// The autotuning results of a process, optionally persisted in files that can
+// be shared between processes like the persistent compilation cache.
+//
+// Each line of a database file holds one result, as the fields of its
+// MatMulAutotuneKey followed by the name of the fastest MatMulRuntime.
+class MatMulAutotuneDatabase {
+ public:
+  // Returns the database shared by all compilations in the process.
+  static MatMulAutotuneDatabase* Global();
+
+  absl::optional<MatMulRuntime> Lookup(const MatMulAutotuneKey& key) const;
+
+  // Records `runtime` for `key` unless a result is already known, and returns
+  // the result recorded for `key`.
+  MatMulRuntime Insert(const MatMulAutotuneKey& key, MatMulRuntime runtime);
+
+  // Reads the results stored in the file at `path`, the first time it's
+  // called with that path. A missing file holds no results.
+  Status LoadOnce(const std::string& path);
+
+  // Writes all known results, merged with those stored by other processes, to
+  // the file at `path`.
+  Status Save(const std::string& path);
+
+ private:
+  Status Load(const std::string& path) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  mutable absl::Mutex mu_;
+  absl::flat_hash_map<MatMulAutotuneKey, MatMulRuntime> results_
+      ABSL_GUARDED_BY(mu_);
+  absl::flat_hash_set<std::string> loaded_paths_ ABSL_GUARDED_BY(mu_);
+};
+
+// Returns the fastest of `candidates` for the matrix multiplication `key`.
+// The candidates are benchmarked on scratch buffers the first time a key is
+// seen, and the result is recorded in the global database, and in the file at
+// `database_path` if it is not empty.
+StatusOr<MatMulRuntime> PickMatMulRuntime(
+    const MatMulAutotuneKey& key, absl::Span<const MatMulRuntime> candidates,
+    const std::string& database_path);
+
+}  // namespace cpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_CPU_MATMUL_AUTOTUNING_H_
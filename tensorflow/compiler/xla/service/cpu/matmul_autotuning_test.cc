@@ -0,0 +1,117 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/cpu/matmul_autotuning.h"
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/compiler/xla/test.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+MatMulAutotuneKey MakeKey(int64_t m, int64_t n, int64_t k) {
+  MatMulAutotuneKey key;
+  key.type = F32;
+  key.m = m;
+  key.n = n;
+  key.k = k;
+  key.transpose_lhs = false;
+  key.transpose_rhs = true;
+  key.num_threads = 2;
+  key.cpu = "test-cpu";
+  return key;
+}
+
+TEST(MatMulAutotuningTest, CandidatesAlwaysIncludeSingleThreadedEigen) {
+  EXPECT_EQ(GetMatMulRuntimeCandidates(S32, /*allow_multi_threaded=*/false,
+                                       /*allow_mkl=*/true),
+            std::vector<MatMulRuntime>{MatMulRuntime::kEigenSingleThreaded});
+  std::vector<MatMulRuntime> candidates = GetMatMulRuntimeCandidates(
+      F32, /*allow_multi_threaded=*/true, /*allow_mkl=*/false);
+  EXPECT_EQ(candidates,
+            (std::vector<MatMulRuntime>{MatMulRuntime::kEigenSingleThreaded,
+                                        MatMulRuntime::kEigenMultiThreaded}));
+}
+
+TEST(MatMulAutotuningTest, PicksAndRemembersOneOfTheCandidates) {
+  const MatMulAutotuneKey key = MakeKey(16, 8, 32);
+  const std::vector<MatMulRuntime> candidates = {
+      MatMulRuntime::kEigenSingleThreaded, MatMulRuntime::kEigenMultiThreaded};
+  TF_ASSERT_OK_AND_ASSIGN(MatMulRuntime runtime,
+                          PickMatMulRuntime(key, candidates, ""));
+  EXPECT_THAT(candidates, ::testing::Contains(runtime));
+  EXPECT_EQ(MatMulAutotuneDatabase::Global()->Lookup(key), runtime);
+
+  TF_ASSERT_OK_AND_ASSIGN(MatMulRuntime cached,
+                          PickMatMulRuntime(key, candidates, ""));
+  EXPECT_EQ(cached, runtime);
+}
+
+TEST(MatMulAutotuningTest, SingleCandidateIsNotBenchmarked) {
+  const MatMulAutotuneKey key = MakeKey(4, 4, 4);
+  TF_ASSERT_OK_AND_ASSIGN(
+      MatMulRuntime runtime,
+      PickMatMulRuntime(key, {MatMulRuntime::kEigenSingleThreaded}, ""));
+  EXPECT_EQ(runtime, MatMulRuntime::kEigenSingleThreaded);
+  EXPECT_EQ(MatMulAutotuneDatabase::Global()->Lookup(key), absl::nullopt);
+}
+
+TEST(MatMulAutotuningTest, ResultsArePersistedInTheDatabaseFile) {
+  const std::string path = tensorflow::io::JoinPath(
+      tensorflow::testing::TmpDir(), "matmul_autotuning_database");
+  tensorflow::Env::Default()->DeleteFile(path).IgnoreError();
+
+  const MatMulAutotuneKey key = MakeKey(24, 12, 6);
+  TF_ASSERT_OK_AND_ASSIGN(
+      MatMulRuntime runtime,
+      PickMatMulRuntime(key,
+                        {MatMulRuntime::kEigenSingleThreaded,
+                         MatMulRuntime::kEigenMultiThreaded},
+                        path));
+
+  // A database in another process reads the result back.
+  MatMulAutotuneDatabase database;
+  TF_ASSERT_OK(database.LoadOnce(path));
+  EXPECT_EQ(database.Lookup(key), runtime);
+
+  // Saving merges the results of both processes.
+  const MatMulAutotuneKey other_key = MakeKey(3, 5, 7);
+  database.Insert(other_key, MatMulRuntime::kEigenMultiThreaded);
+  TF_ASSERT_OK(database.Save(path));
+  MatMulAutotuneDatabase reloaded;
+  TF_ASSERT_OK(reloaded.LoadOnce(path));
+  EXPECT_EQ(reloaded.Lookup(key), runtime);
+  EXPECT_EQ(reloaded.Lookup(other_key), MatMulRuntime::kEigenMultiThreaded);
+}
+
+TEST(MatMulAutotuningTest, MalformedDatabaseFileIsRejected) {
+  const std::string path = tensorflow::io::JoinPath(
+      tensorflow::testing::TmpDir(), "malformed_matmul_autotuning_database");
+  TF_ASSERT_OK(tensorflow::WriteStringToFile(tensorflow::Env::Default(), path,
+                                             "f32 1 2 3 eigen\n"));
+  MatMulAutotuneDatabase database;
+  EXPECT_FALSE(database.LoadOnce(path).ok());
+}
+
+}  // namespace
+}  // namespace cpu
+}  // namespace xla
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_XLA_SERVICE_CPU_PARALLEL_LOOP_EMITTER_H_
 #define TENSORFLOW_COMPILER_XLA_SERVICE_CPU_PARALLEL_LOOP_EMITTER_H_
 
+#include "absl/types/span.h"
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/Value.h"
 #include "tensorflow/compiler/xla/service/cpu/ir_emission_utils.h"
@@ -56,6 +57,15 @@ class ParallelLoopEmitter : public llvm_ir::LoopEmitter {
                       const DynamicLoopBounds* dynamic_loop_bounds,
                       llvm::IRBuilder<>* b);
 
+  // Constructs a ParallelLoopEmitter which emits one element into each of the
+  // 'target_arrays' on each iteration, for multi-output fusion. All target
+  // arrays must have the same shape, and 'target_element_generator' must
+  // produce an LLVM struct with one element per target array.
+  ParallelLoopEmitter(const llvm_ir::ElementGenerator& target_element_generator,
+                      absl::Span<const llvm_ir::IrArray> target_arrays,
+                      const DynamicLoopBounds* dynamic_loop_bounds,
+                      llvm::IRBuilder<>* b);
+
   ParallelLoopEmitter(const ParallelLoopEmitter&) = delete;
   ParallelLoopEmitter& operator=(const ParallelLoopEmitter&) = delete;
   ~ParallelLoopEmitter() override = default;
@@ -206,5 +206,34 @@ TEST_F(ParallelTaskAssignmentTest, ConstantNotParallelized) {
   EXPECT_FALSE(changed);
 }
 
+TEST_F(ParallelTaskAssignmentTest, MultiOutputLoopFusionParallelized) {
+  constexpr char hlo_string[] = R"(
+  HloModule TestTaskParallel_multi_output_fusion
+    fused_computation {
+      p = f32[1234567]{0} parameter(0)
+      exp = f32[1234567]{0} exponential(p)
+      neg = f32[1234567]{0} negate(p)
+      ROOT tuple = (f32[1234567]{0}, f32[1234567]{0}) tuple(exp, neg)
+    }
+
+    ENTRY MultiOutputFusion {
+      input = f32[1234567]{0} parameter(0)
+      ROOT fusion = (f32[1234567]{0}, f32[1234567]{0}) fusion(input),
+        kind=kLoop, calls=fused_computation
+    }
+  )";
+
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> m,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, RunParallelTaskAssigner(m.get()));
+  EXPECT_TRUE(changed);
+  const HloInstruction* call = m->entry_computation()->root_instruction();
+  ASSERT_EQ(call->opcode(), HloOpcode::kCall);
+  EXPECT_FALSE(call->to_apply()
+                   ->root_instruction()
+                   ->outer_dimension_partitions()
+                   .empty());
+}
+
 }  // namespace
 }  // namespace xla
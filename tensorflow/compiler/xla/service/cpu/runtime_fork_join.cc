@@ -73,7 +73,6 @@ ABSL_ATTRIBUTE_NO_SANITIZE_MEMORY void __xla_cpu_runtime_ParallelForkJoin(
   const xla::ExecutableRunOptions* run_options =
       static_cast<const xla::ExecutableRunOptions*>(run_options_ptr);
   CHECK_NE(run_options, nullptr);
-  CHECK_NE(run_options->intra_op_thread_pool(), nullptr);
 
   ComputeFunctionType function =
       reinterpret_cast<ComputeFunctionType>(function_ptr);
@@ -82,25 +81,34 @@ ABSL_ATTRIBUTE_NO_SANITIZE_MEMORY void __xla_cpu_runtime_ParallelForkJoin(
 
   std::vector<XlaCustomCallStatus> statuses(num_partitions);
 
-  // Dispatch 'num_partitions - 1' compute functions to run in parallel.
-  tensorflow::BlockingCounter bc(num_partitions - 1);
-  for (int32_t i = 1; i < num_partitions; ++i) {
-    const int64_t offset = i * stride;
-    run_options->intra_op_thread_pool()->enqueueNoNotification(
-        [i, function, result_ptr, run_options_ptr, buffer_table, prof_counters,
-         partitions, offset, &bc, &statuses]() {
-          function(result_ptr, run_options_ptr, nullptr, buffer_table,
-                   &statuses[i], &partitions[offset], prof_counters);
-          bc.DecrementCount();
-          VLOG(3) << "ParallelForkJoin partition " << i << " done.";
-        });
-  }
+  if (run_options->intra_op_thread_pool() == nullptr) {
+    // Ahead-of-time compiled functions may be run without a thread pool, in
+    // which case the partitions run one after the other on this thread.
+    for (int32_t i = 0; i < num_partitions; ++i) {
+      function(result_ptr, run_options_ptr, params, buffer_table, &statuses[i],
+               &partitions[i * stride], prof_counters);
+    }
+  } else {
+    // Dispatch 'num_partitions - 1' compute functions to run in parallel.
+    tensorflow::BlockingCounter bc(num_partitions - 1);
+    for (int32_t i = 1; i < num_partitions; ++i) {
+      const int64_t offset = i * stride;
+      run_options->intra_op_thread_pool()->enqueueNoNotification(
+          [i, function, result_ptr, run_options_ptr, buffer_table,
+           prof_counters, partitions, offset, &bc, &statuses]() {
+            function(result_ptr, run_options_ptr, nullptr, buffer_table,
+                     &statuses[i], &partitions[offset], prof_counters);
+            bc.DecrementCount();
+            VLOG(3) << "ParallelForkJoin partition " << i << " done.";
+          });
+    }
 
-  // Call first compute function inline.
-  function(result_ptr, run_options_ptr, params, buffer_table, &statuses[0],
-           &partitions[0], prof_counters);
-  VLOG(3) << "ParallelForkJoin partition 0 done.";
-  bc.Wait();
+    // Call first compute function inline.
+    function(result_ptr, run_options_ptr, params, buffer_table, &statuses[0],
+             &partitions[0], prof_counters);
+    VLOG(3) << "ParallelForkJoin partition 0 done.";
+    bc.Wait();
+  }
 
   // Collect all error messages (if any).
   std::vector<std::pair<int32_t, absl::string_view>> error_messages;
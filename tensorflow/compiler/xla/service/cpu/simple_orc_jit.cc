@@ -23,6 +23,9 @@ limitations under the License.
 #include <utility>
 
 #include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
 #include "llvm/ExecutionEngine/ExecutionEngine.h"
 #include "llvm/ExecutionEngine/JITSymbol.h"
 #include "llvm/ExecutionEngine/Orc/ExecutorProcessControl.h"
@@ -31,6 +34,7 @@ limitations under the License.
 #include "llvm/IR/Operator.h"
 #include "llvm/Support/CodeGen.h"
 #include "llvm/Support/Host.h"
+#include "llvm/Transforms/Utils/SplitModule.h"
 #include "tensorflow/compiler/xla/service/cpu/cpu_runtime.h"
 #include "tensorflow/compiler/xla/service/cpu/orc_jit_memory_mapper.h"
 #include "tensorflow/compiler/xla/service/cpu/runtime_conv2d.h"
@@ -52,6 +56,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/cpu/windows_compatibility.h"
 #include "tensorflow/compiler/xla/service/custom_call_target_registry.h"
 #include "tensorflow/compiler/xla/types.h"
+#include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/logging.h"
 
 namespace xla {
@@ -97,7 +102,9 @@ SimpleOrcJIT::SimpleOrcJIT(
     LLVMCompiler::ModuleHook pre_optimization_hook,
     LLVMCompiler::ModuleHook post_optimization_hook,
     std::function<void(const llvm::object::ObjectFile&)> post_codegen_hook)
-    : target_machine_(InferTargetMachineForJIT(target_options, opt_level)),
+    : target_options_(target_options),
+      opt_level_(opt_level),
+      target_machine_(InferTargetMachineForJIT(target_options, opt_level)),
       target_triple_(target_machine_->getTargetTriple()),
       data_layout_(target_machine_->createDataLayout()),
       target_process_control_(std::move(target_process_control)),
@@ -107,6 +114,10 @@ SimpleOrcJIT::SimpleOrcJIT(
                       return std::make_unique<llvm::SectionMemoryManager>(
                           orc_jit_memory_mapper::GetInstance());
                     }),
+      parallel_compiler_(target_machine_.get(), opt_level, optimize_for_size,
+                         disable_expensive_passes, fast_math_flags,
+                         pre_optimization_hook, post_optimization_hook,
+                         post_codegen_hook),
       compile_layer_(
           *execution_session_, object_layer_,
           std::make_unique<CompilerFunctor>(
@@ -227,6 +238,70 @@ llvm::Error SimpleOrcJIT::AddModule(llvm::orc::ThreadSafeModule module) {
   return compile_layer_.add(*main_jit_dylib_, std::move(module));
 }
 
+llvm::Error SimpleOrcJIT::AddModuleInParallel(
+    std::unique_ptr<llvm::Module> module, int num_parts,
+    tensorflow::thread::ThreadPool* thread_pool) {
+  parallel_compiler_.Optimize(*module);
+
+  // Code generation isn't thread-safe within an LLVMContext, so every part is
+  // serialized to bitcode here and read into its own context by the thread
+  // that lowers it. Local symbols are externalized, for functions to be
+  // spread over the parts; they are only visible within this JIT anyway.
+  std::vector<llvm::SmallVector<char, 0>> bitcodes;
+  llvm::SplitModule(
+      *module, num_parts,
+      [&](std::unique_ptr<llvm::Module> part) {
+        bitcodes.emplace_back();
+        llvm::raw_svector_ostream os(bitcodes.back());
+        llvm::WriteBitcodeToFile(*part, os);
+      },
+      /*PreserveLocals=*/false);
+  module.reset();
+
+  const int num_modules = bitcodes.size();
+  std::vector<std::unique_ptr<llvm::TargetMachine>> target_machines;
+  target_machines.reserve(num_modules);
+  for (int i = 0; i < num_modules; ++i) {
+    target_machines.push_back(
+        InferTargetMachineForJIT(target_options_, opt_level_));
+  }
+
+  std::vector<std::unique_ptr<llvm::MemoryBuffer>> objects(num_modules);
+  std::vector<std::string> errors(num_modules);
+  tensorflow::BlockingCounter counter(num_modules);
+  for (int i = 0; i < num_modules; ++i) {
+    thread_pool->Schedule([&, i] {
+      llvm::LLVMContext context;
+      llvm::Expected<std::unique_ptr<llvm::Module>> part =
+          llvm::parseBitcodeFile(
+              llvm::MemoryBufferRef(
+                  llvm::StringRef(bitcodes[i].data(), bitcodes[i].size()),
+                  absl::StrCat("__compute_module_part_", i)),
+              context);
+      if (part) {
+        objects[i] =
+            parallel_compiler_.EmitObject(**part, target_machines[i].get());
+      } else {
+        errors[i] = llvm::toString(part.takeError());
+      }
+      counter.DecrementCount();
+    });
+  }
+  counter.Wait();
+
+  for (int i = 0; i < num_modules; ++i) {
+    if (!errors[i].empty()) {
+      return llvm::make_error<llvm::StringError>(
+          errors[i], llvm::inconvertibleErrorCode());
+    }
+    if (llvm::Error error =
+            object_layer_.add(*main_jit_dylib_, std::move(objects[i]))) {
+      return error;
+    }
+  }
+  return llvm::Error::success();
+}
+
 void SimpleOrcJIT::DoneCompiling() {
   // The target machine takes a non-trivial amount of memory, so once we are
   // done compiling throw it away.
@@ -305,6 +380,7 @@ bool RegisterKnownJITSymbols() {
   REGISTER_CPU_RUNTIME_SYMBOL(TopKF32);
   REGISTER_CPU_RUNTIME_SYMBOL(TracingStart);
   REGISTER_CPU_RUNTIME_SYMBOL(TracingEnd);
+  REGISTER_CPU_RUNTIME_SYMBOL(SetCurrentHlo);
 
   registry->Register("__gnu_f2h_ieee", reinterpret_cast<void*>(__gnu_f2h_ieee),
                      "Host");
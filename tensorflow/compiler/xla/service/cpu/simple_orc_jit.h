@@ -31,6 +31,7 @@ limitations under the License.
 #include "llvm/Target/TargetMachine.h"
 #include "tensorflow/compiler/xla/service/cpu/compiler_functor.h"
 #include "tensorflow/compiler/xla/types.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace xla {
 namespace cpu {
@@ -79,6 +80,14 @@ class SimpleOrcJIT : public llvm::JITEventListener {
 
   llvm::Error AddModule(llvm::orc::ThreadSafeModule module);
 
+  // Optimizes `module` as a whole, so inlining still sees every function,
+  // then splits it into at most `num_parts` modules that are lowered to
+  // machine code in parallel on `thread_pool`, and adds the resulting objects
+  // to the JIT.
+  llvm::Error AddModuleInParallel(std::unique_ptr<llvm::Module> module,
+                                  int num_parts,
+                                  tensorflow::thread::ThreadPool* thread_pool);
+
   // Discards objects we no longer need once we are done compiling.
   void DoneCompiling();
 
@@ -108,12 +117,17 @@ class SimpleOrcJIT : public llvm::JITEventListener {
       const llvm::RuntimeDyld::LoadedObjectInfo& object_info) override;
   void notifyFreeingObject(llvm::JITEventListener::ObjectKey key) override;
 
+  const llvm::TargetOptions target_options_;
+  const llvm::CodeGenOpt::Level opt_level_;
   std::unique_ptr<llvm::TargetMachine> target_machine_;
   llvm::Triple target_triple_;
   const llvm::DataLayout data_layout_;
   std::unique_ptr<llvm::orc::ExecutorProcessControl> target_process_control_;
   std::unique_ptr<llvm::orc::ExecutionSession> execution_session_;
   ObjLayerT object_layer_;
+  // Same as the compiler of `compile_layer_`, for AddModuleInParallel to run
+  // the optimizations and the code generation separately.
+  CompilerFunctor parallel_compiler_;
   CompileLayerT compile_layer_;
   llvm::orc::JITDylib* main_jit_dylib_;
   int64_t size_of_generated_code_in_bytes_ = 0;
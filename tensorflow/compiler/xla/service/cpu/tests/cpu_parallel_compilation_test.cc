@@ -0,0 +1,84 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+class CpuParallelCompilationTest : public HloTestBase {
+ protected:
+  DebugOptions GetDebugOptionsForTest() override {
+    DebugOptions debug_options = HloTestBase::GetDebugOptionsForTest();
+    debug_options.set_xla_cpu_force_compilation_parallelism(4);
+    return debug_options;
+  }
+};
+
+TEST_F(CpuParallelCompilationTest, ModuleWithManyComputations) {
+  // The loop, the comparator and the reduction are emitted as separate
+  // functions, which end up in different parts of the split module.
+  const char* const hlo_string = R"(
+HloModule module
+
+add {
+  lhs = f32[] parameter(0)
+  rhs = f32[] parameter(1)
+  ROOT add = f32[] add(lhs, rhs)
+}
+
+compare {
+  lhs = f32[] parameter(0)
+  rhs = f32[] parameter(1)
+  ROOT lt = pred[] compare(lhs, rhs), direction=LT
+}
+
+cond {
+  state = (s32[], f32[64]) parameter(0)
+  i = s32[] get-tuple-element(state), index=0
+  limit = s32[] constant(5)
+  ROOT lt = pred[] compare(i, limit), direction=LT
+}
+
+body {
+  state = (s32[], f32[64]) parameter(0)
+  i = s32[] get-tuple-element(state), index=0
+  one = s32[] constant(1)
+  next = s32[] add(i, one)
+  x = f32[64] get-tuple-element(state), index=1
+  sorted = f32[64] sort(x), dimensions={0}, to_apply=compare
+  scaled = f32[64] add(sorted, x)
+  ROOT result = (s32[], f32[64]) tuple(next, scaled)
+}
+
+ENTRY main {
+  x = f32[64] parameter(0)
+  zero = s32[] constant(0)
+  init = (s32[], f32[64]) tuple(zero, x)
+  loop = (s32[], f32[64]) while(init), condition=cond, body=body
+  y = f32[64] get-tuple-element(loop), index=1
+  c = f32[] constant(0)
+  ROOT sum = f32[] reduce(y, c), dimensions={0}, to_apply=add
+}
+)";
+
+  EXPECT_TRUE(RunAndCompareNoHloPasses(hlo_string, ErrorSpec{1e-3, 1e-3}));
+}
+
+}  // namespace
+}  // namespace cpu
+}  // namespace xla
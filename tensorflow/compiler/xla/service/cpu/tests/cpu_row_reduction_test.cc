@@ -0,0 +1,110 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+// Reductions over the most minor dimensions, which are emitted with several
+// vector accumulators per row and partitioned between parallel tasks.
+class CpuRowReductionTest : public HloTestBase {};
+
+TEST_F(CpuRowReductionTest, SumWithRemainder) {
+  // The init value is not the identity, so it must be applied once per row.
+  const char* const hlo_string = R"(
+HloModule module
+
+add {
+  lhs = f32[] parameter(0)
+  rhs = f32[] parameter(1)
+  ROOT add = f32[] add(lhs, rhs)
+}
+
+ENTRY main {
+  x = f32[64,1001] parameter(0)
+  c = f32[] constant(1)
+  ROOT sum = f32[64] reduce(x, c), dimensions={1}, to_apply=add
+}
+)";
+
+  EXPECT_TRUE(RunAndCompare(hlo_string, ErrorSpec{1e-3, 1e-3}));
+}
+
+TEST_F(CpuRowReductionTest, MaxOverTwoMinorDimensions) {
+  const char* const hlo_string = R"(
+HloModule module
+
+max {
+  lhs = f32[] parameter(0)
+  rhs = f32[] parameter(1)
+  ROOT max = f32[] maximum(lhs, rhs)
+}
+
+ENTRY main {
+  x = f32[16,30,7] parameter(0)
+  c = f32[] constant(-inf)
+  ROOT max = f32[16] reduce(x, c), dimensions={1,2}, to_apply=max
+}
+)";
+
+  EXPECT_TRUE(RunAndCompare(hlo_string, ErrorSpec{1e-5, 1e-5}));
+}
+
+TEST_F(CpuRowReductionTest, IntegerSumToScalar) {
+  const char* const hlo_string = R"(
+HloModule module
+
+add {
+  lhs = s32[] parameter(0)
+  rhs = s32[] parameter(1)
+  ROOT add = s32[] add(lhs, rhs)
+}
+
+ENTRY main {
+  x = s32[4099] parameter(0)
+  c = s32[] constant(3)
+  ROOT sum = s32[] reduce(x, c), dimensions={0}, to_apply=add
+}
+)";
+
+  EXPECT_TRUE(RunAndCompare(hlo_string, absl::nullopt));
+}
+
+TEST_F(CpuRowReductionTest, RowsShorterThanVectors) {
+  const char* const hlo_string = R"(
+HloModule module
+
+add {
+  lhs = f32[] parameter(0)
+  rhs = f32[] parameter(1)
+  ROOT add = f32[] add(lhs, rhs)
+}
+
+ENTRY main {
+  x = f32[1000,3] parameter(0)
+  c = f32[] constant(0)
+  ROOT sum = f32[1000] reduce(x, c), dimensions={1}, to_apply=add
+}
+)";
+
+  EXPECT_TRUE(RunAndCompare(hlo_string, ErrorSpec{1e-3, 1e-3}));
+}
+
+}  // namespace
+}  // namespace cpu
+}  // namespace xla
@@ -0,0 +1,203 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/autotune_results_database.h"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_format.h"
+#include "tensorflow/compiler/xla/service/hlo_module.h"
+#include "tensorflow/compiler/xla/util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/fingerprint.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+bool IsTextProtoPath(const std::string& path) {
+  return absl::EndsWith(path, ".pbtxt");
+}
+
+// Reads the results in the file at `path` into `proto`. A missing file reads
+// as no results.
+Status ReadResults(const std::string& path, AutotuneResults* proto) {
+  tensorflow::Env* env = tensorflow::Env::Default();
+  Status exists = env->FileExists(path);
+  if (tensorflow::errors::IsNotFound(exists)) {
+    return Status::OK();
+  }
+  TF_RETURN_IF_ERROR(exists);
+  return IsTextProtoPath(path) ? tensorflow::ReadTextProto(env, path, proto)
+                               : tensorflow::ReadBinaryProto(env, path, proto);
+}
+
+// Writes `proto` to a temporary file next to `path` and renames it over
+// `path`, so that other processes never read a partially written file.
+Status WriteResults(const std::string& path, const AutotuneResults& proto) {
+  tensorflow::Env* env = tensorflow::Env::Default();
+  std::string tmp_path = path;
+  if (!env->CreateUniqueFileName(&tmp_path, ".tmp")) {
+    return InternalError("Failed to create a temporary file name for %s",
+                         path);
+  }
+  TF_RETURN_IF_ERROR(IsTextProtoPath(path)
+                         ? tensorflow::WriteTextProto(env, tmp_path, proto)
+                         : tensorflow::WriteBinaryProto(env, tmp_path, proto));
+  Status renamed = env->RenameFile(tmp_path, path);
+  if (!renamed.ok()) {
+    env->DeleteFile(tmp_path).IgnoreError();
+  }
+  return renamed;
+}
+
+}  // namespace
+
+/*static*/ StatusOr<AutotuneResultsDatabase*> AutotuneResultsDatabase::ForPath(
+    const std::string& path) {
+  static absl::Mutex mu(absl::kConstInit);
+  static auto& databases ABSL_GUARDED_BY(mu) =
+      *new absl::flat_hash_map<std::string,
+                               std::unique_ptr<AutotuneResultsDatabase>>();
+
+  absl::MutexLock lock(&mu);
+  auto it = databases.find(path);
+  if (it != databases.end()) {
+    return it->second.get();
+  }
+  auto database = std::make_unique<AutotuneResultsDatabase>(path);
+  TF_RETURN_IF_ERROR(database->Load());
+  VLOG(1) << "Loaded " << database->size() << " autotuning results from "
+          << (path.empty() ? "<none>" : path);
+  return databases.emplace(path, std::move(database)).first->second.get();
+}
+
+/*static*/ StatusOr<AutotuneResultsDatabase*>
+AutotuneResultsDatabase::ForInstruction(const HloInstruction& instr) {
+  return ForPath(instr.GetModule()
+                     ->config()
+                     .debug_options()
+                     .xla_gpu_autotune_results_path());
+}
+
+/*static*/ AutotuneResultsDatabase::Key AutotuneResultsDatabase::MakeKey(
+    const se::StreamExecutor* stream_exec, const HloInstruction& instr) {
+  auto options = HloPrintOptions::Canonical();
+  options.set_print_backend_config(true);
+  tensorflow::Fprint128 fingerprint =
+      tensorflow::Fingerprint128(instr.ToString(options));
+  const se::DeviceDescription& desc = stream_exec->GetDeviceDescription();
+  return std::make_tuple(
+      desc.name(), desc.driver_version(),
+      absl::StrFormat("%016x%016x", fingerprint.high64, fingerprint.low64));
+}
+
+absl::optional<tensorflow::AutotuneResult> AutotuneResultsDatabase::Lookup(
+    const Key& key) const {
+  absl::MutexLock lock(&mu_);
+  auto it = results_.find(key);
+  if (it == results_.end()) {
+    return absl::nullopt;
+  }
+  return it->second;
+}
+
+void AutotuneResultsDatabase::Insert(const Key& key,
+                                     const tensorflow::AutotuneResult& result) {
+  absl::MutexLock lock(&mu_);
+  results_[key] = result;
+  dirty_ = true;
+}
+
+Status AutotuneResultsDatabase::Load() {
+  if (path_.empty()) {
+    return Status::OK();
+  }
+  AutotuneResults proto;
+  TF_RETURN_IF_ERROR(ReadResults(path_, &proto));
+  MergeFromProto(proto);
+  return Status::OK();
+}
+
+Status AutotuneResultsDatabase::Save() {
+  if (path_.empty()) {
+    return Status::OK();
+  }
+  {
+    absl::MutexLock lock(&mu_);
+    if (!dirty_) {
+      return Status::OK();
+    }
+  }
+  // Picks up the results other processes saved since this database was
+  // loaded, so that saving does not drop them.
+  TF_RETURN_IF_ERROR(Load());
+  absl::MutexLock lock(&mu_);
+  AutotuneResults proto = ToProtoLocked();
+  TF_RETURN_IF_ERROR(WriteResults(path_, proto));
+  VLOG(1) << "Saved " << proto.results_size() << " autotuning results to "
+          << path_;
+  dirty_ = false;
+  return Status::OK();
+}
+
+AutotuneResults AutotuneResultsDatabase::ToProto() const {
+  absl::MutexLock lock(&mu_);
+  return ToProtoLocked();
+}
+
+AutotuneResults AutotuneResultsDatabase::ToProtoLocked() const {
+  std::vector<const std::pair<const Key, tensorflow::AutotuneResult>*> sorted;
+  sorted.reserve(results_.size());
+  for (const auto& entry : results_) {
+    sorted.push_back(&entry);
+  }
+  // Sorted, so that the serialized results do not depend on the hash map.
+  absl::c_sort(sorted, [](const auto* a, const auto* b) {
+    return a->first < b->first;
+  });
+  AutotuneResults proto;
+  for (const auto* entry : sorted) {
+    AutotuneResultsEntry* proto_entry = proto.add_results();
+    proto_entry->set_device(std::get<0>(entry->first));
+    proto_entry->set_driver_version(std::get<1>(entry->first));
+    proto_entry->set_hlo_fingerprint(std::get<2>(entry->first));
+    *proto_entry->mutable_result() = entry->second;
+  }
+  return proto;
+}
+
+void AutotuneResultsDatabase::MergeFromProto(const AutotuneResults& proto) {
+  absl::MutexLock lock(&mu_);
+  for (const AutotuneResultsEntry& entry : proto.results()) {
+    results_.emplace(std::make_tuple(entry.device(), entry.driver_version(),
+                                     entry.hlo_fingerprint()),
+                     entry.result());
+  }
+}
+
+int64_t AutotuneResultsDatabase::size() const {
+  absl::MutexLock lock(&mu_);
+  return results_.size();
+}
+
+}  // namespace gpu
+}  // namespace xla
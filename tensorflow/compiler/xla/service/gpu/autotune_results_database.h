@@ -0,0 +1,101 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_AUTOTUNE_RESULTS_DATABASE_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_AUTOTUNE_RESULTS_DATABASE_H_
+
+#include <string>
+#include <tuple>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/optional.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_autotuning.pb.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/status.h"
+#include "tensorflow/compiler/xla/statusor.h"
+#include "tensorflow/core/platform/stream_executor_no_cuda.h"
+#include "tensorflow/core/protobuf/autotuning.pb.h"
+
+namespace xla {
+namespace gpu {
+
+// Autotuning results of GEMMs and convolutions, shared by GemmAlgorithmPicker
+// and GpuConvAlgorithmPicker.
+//
+// Results are keyed by the device model, the driver version and a fingerprint
+// of the instruction, so that a database can be serialized and reused by other
+// processes running on the same kind of device. A database is backed by the
+// file at its path, if the path is not empty.
+class AutotuneResultsDatabase {
+ public:
+  // (device, driver version, HLO fingerprint).
+  using Key = std::tuple<std::string, std::string, std::string>;
+
+  explicit AutotuneResultsDatabase(std::string path) : path_(std::move(path)) {}
+
+  // Returns the process-wide database for `path`, loading the file at `path`
+  // on first use. A missing file is not an error; it is created by Save().
+  static StatusOr<AutotuneResultsDatabase*> ForPath(const std::string& path);
+
+  // Returns the database selected by the xla_gpu_autotune_results_path debug
+  // option of the module of `instr`.
+  static StatusOr<AutotuneResultsDatabase*> ForInstruction(
+      const HloInstruction& instr);
+
+  // Returns the key of the result of autotuning `instr` on `stream_exec`.
+  static Key MakeKey(const se::StreamExecutor* stream_exec,
+                     const HloInstruction& instr);
+
+  absl::optional<tensorflow::AutotuneResult> Lookup(const Key& key) const;
+
+  // Records `result` for `key`, replacing any previous result.
+  void Insert(const Key& key, const tensorflow::AutotuneResult& result);
+
+  // Merges the results in the file at the path of this database into this
+  // database. Results already in this database take precedence.
+  Status Load();
+
+  // Writes this database to its path, if it has results that are not yet in
+  // the file. Results written to the file by other processes since it was
+  // loaded are kept. The file is replaced atomically.
+  Status Save();
+
+  // Returns the results of this database, sorted by key.
+  AutotuneResults ToProto() const;
+
+  // Merges `proto` into this database. Results already in this database take
+  // precedence.
+  void MergeFromProto(const AutotuneResults& proto);
+
+  int64_t size() const;
+
+ private:
+  AutotuneResults ToProtoLocked() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const std::string path_;
+
+  mutable absl::Mutex mu_;
+  absl::flat_hash_map<Key, tensorflow::AutotuneResult> results_
+      ABSL_GUARDED_BY(mu_);
+  // Whether results_ has entries that were not loaded from or saved to path_.
+  bool dirty_ ABSL_GUARDED_BY(mu_) = false;
+};
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_AUTOTUNE_RESULTS_DATABASE_H_
@@ -0,0 +1,146 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/autotune_results_database.h"
+
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_autotuning.pb.h"
+#include "tensorflow/compiler/xla/test.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/autotuning.pb.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+tensorflow::AutotuneResult ConvResult(int64_t algorithm) {
+  tensorflow::AutotuneResult result;
+  result.mutable_conv()->set_algorithm(algorithm);
+  return result;
+}
+
+const AutotuneResultsDatabase::Key kKey{"Tesla V100", "470.57.2", "0123"};
+const AutotuneResultsDatabase::Key kOtherKey{"Tesla V100", "470.57.2", "4567"};
+
+TEST(AutotuneResultsDatabaseTest, LookupReturnsInsertedResult) {
+  AutotuneResultsDatabase database("");
+  EXPECT_FALSE(database.Lookup(kKey).has_value());
+  database.Insert(kKey, ConvResult(3));
+  absl::optional<tensorflow::AutotuneResult> result = database.Lookup(kKey);
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(result->conv().algorithm(), 3);
+  EXPECT_FALSE(database.Lookup(kOtherKey).has_value());
+}
+
+TEST(AutotuneResultsDatabaseTest, KeyIncludesDriverVersion) {
+  AutotuneResultsDatabase database("");
+  database.Insert(kKey, ConvResult(3));
+  EXPECT_FALSE(
+      database.Lookup({std::get<0>(kKey), "510.47.3", std::get<2>(kKey)})
+          .has_value());
+}
+
+TEST(AutotuneResultsDatabaseTest, MergeKeepsExistingResults) {
+  AutotuneResultsDatabase database("");
+  database.Insert(kKey, ConvResult(3));
+
+  AutotuneResults proto;
+  for (const auto& [key, algorithm] :
+       {std::make_pair(kKey, 5), std::make_pair(kOtherKey, 7)}) {
+    AutotuneResultsEntry* entry = proto.add_results();
+    entry->set_device(std::get<0>(key));
+    entry->set_driver_version(std::get<1>(key));
+    entry->set_hlo_fingerprint(std::get<2>(key));
+    *entry->mutable_result() = ConvResult(algorithm);
+  }
+  database.MergeFromProto(proto);
+
+  EXPECT_EQ(database.size(), 2);
+  EXPECT_EQ(database.Lookup(kKey)->conv().algorithm(), 3);
+  EXPECT_EQ(database.Lookup(kOtherKey)->conv().algorithm(), 7);
+}
+
+TEST(AutotuneResultsDatabaseTest, ToProtoIsSortedByKey) {
+  AutotuneResultsDatabase database("");
+  database.Insert(kOtherKey, ConvResult(7));
+  database.Insert(kKey, ConvResult(3));
+  AutotuneResults proto = database.ToProto();
+  ASSERT_EQ(proto.results_size(), 2);
+  EXPECT_EQ(proto.results(0).hlo_fingerprint(), "0123");
+  EXPECT_EQ(proto.results(1).hlo_fingerprint(), "4567");
+}
+
+class AutotuneResultsDatabaseFileTest
+    : public ::testing::TestWithParam<std::string> {
+ protected:
+  std::string Path(absl::string_view name) {
+    return tensorflow::io::JoinPath(testing::TempDir(),
+                                    absl::StrCat(name, GetParam()));
+  }
+};
+
+TEST_P(AutotuneResultsDatabaseFileTest, MissingFileLoadsAsEmpty) {
+  AutotuneResultsDatabase database(Path("missing"));
+  TF_ASSERT_OK(database.Load());
+  EXPECT_EQ(database.size(), 0);
+}
+
+TEST_P(AutotuneResultsDatabaseFileTest, SaveAndLoad) {
+  AutotuneResultsDatabase database(Path("save_and_load"));
+  database.Insert(kKey, ConvResult(3));
+  TF_ASSERT_OK(database.Save());
+
+  AutotuneResultsDatabase loaded(Path("save_and_load"));
+  TF_ASSERT_OK(loaded.Load());
+  EXPECT_EQ(loaded.size(), 1);
+  EXPECT_EQ(loaded.Lookup(kKey)->conv().algorithm(), 3);
+}
+
+TEST_P(AutotuneResultsDatabaseFileTest, SaveKeepsResultsSavedByOthers) {
+  AutotuneResultsDatabase first(Path("shared"));
+  AutotuneResultsDatabase second(Path("shared"));
+  TF_ASSERT_OK(first.Load());
+  TF_ASSERT_OK(second.Load());
+  first.Insert(kKey, ConvResult(3));
+  second.Insert(kOtherKey, ConvResult(7));
+  TF_ASSERT_OK(first.Save());
+  TF_ASSERT_OK(second.Save());
+
+  AutotuneResultsDatabase loaded(Path("shared"));
+  TF_ASSERT_OK(loaded.Load());
+  EXPECT_EQ(loaded.size(), 2);
+  EXPECT_EQ(loaded.Lookup(kKey)->conv().algorithm(), 3);
+  EXPECT_EQ(loaded.Lookup(kOtherKey)->conv().algorithm(), 7);
+}
+
+INSTANTIATE_TEST_SUITE_P(Formats, AutotuneResultsDatabaseFileTest,
+                         ::testing::Values(".pbtxt", ".pb"));
+
+TEST(AutotuneResultsDatabaseTest, ForPathReturnsSharedDatabase) {
+  TF_ASSERT_OK_AND_ASSIGN(AutotuneResultsDatabase * database,
+                          AutotuneResultsDatabase::ForPath(""));
+  TF_ASSERT_OK_AND_ASSIGN(AutotuneResultsDatabase * same_database,
+                          AutotuneResultsDatabase::ForPath(""));
+  EXPECT_EQ(database, same_database);
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
@@ -68,7 +68,8 @@ class BufferAllocations {
       const BufferAllocation::Slice& buffer_slice) const;
 
   // Tears down all buffers allocated by this object that are not in
-  // `live_addresses`.
+  // `live_addresses`. Buffers in host memory (kHostMemorySpace) are not
+  // allocated with the device allocator and are left to their owner.
   Status TearDown(const std::set<se::DeviceMemoryBase>& live_addresses,
                   absl::Span<const BufferAllocation> allocations);
 
@@ -57,6 +57,12 @@ bool IsCublasGemm(const HloInstruction& hlo);
 // A call to cuBLAS general matrix multiplication API.
 extern const char* const kGemmCallTarget;
 
+// A group of independent cuBLAS GEMMs with identical shapes and
+// GemmBackendConfig, run as one batched gemm call. The operands are the LHS of
+// every GEMM followed by the RHS of every GEMM, and the result is the tuple of
+// their outputs.
+extern const char* const kGroupedGemmCallTarget;
+
 // A call to cuBLAS for a triangular solve.
 //
 // Like cudnn convolutions, this op returns a tuple (result, scratch_memory).
@@ -18,6 +18,7 @@ limitations under the License.
 #include <limits>
 #include <string>
 
+#include "tensorflow/compiler/xla/service/gpu/autotune_results_database.h"
 #include "tensorflow/compiler/xla/service/gpu/backend_configs.pb.h"
 #include "tensorflow/compiler/xla/service/gpu/buffer_comparator.h"
 #include "tensorflow/compiler/xla/service/gpu/gemm_thunk.h"
@@ -248,6 +249,23 @@ static StatusOr<absl::optional<se::blas::AlgorithmType>> DoGemmAutotune(
   cache_misses++;
   VLOG(4) << "Autotuning cache miss";
 
+  // Results autotuned by other processes on the same kind of device.
+  TF_ASSIGN_OR_RETURN(AutotuneResultsDatabase * database,
+                      AutotuneResultsDatabase::ForInstruction(*instr));
+  AutotuneResultsDatabase::Key database_key =
+      AutotuneResultsDatabase::MakeKey(stream->parent(), *instr);
+  if (absl::optional<AutotuneResult> database_result =
+          database->Lookup(database_key)) {
+    absl::optional<se::blas::AlgorithmType> result;
+    if (database_result->has_gemm()) {
+      result = database_result->gemm().algorithm();
+    }
+    VLOG(4) << "Autotuning results database hit, using algorithm: "
+            << (result.has_value() ? absl::StrCat(*result) : "<generic>");
+    CHECK(autotune_cache.emplace(key, result).second);
+    return result;
+  }
+
   // Make sure any previous activity on this executor is done. We don't want
   // other work still running on the GPU to interfere with autotuning.
   if (!stream->parent()->SynchronizeAllActivity()) {
@@ -262,6 +280,12 @@ static StatusOr<absl::optional<se::blas::AlgorithmType>> DoGemmAutotune(
                       DoUncachedGemmAutotune(instr, stream, allocator));
 
   CHECK(autotune_cache.emplace(key, result).second);
+  // A result without a gemm algorithm records that the generic API is used.
+  AutotuneResult database_result;
+  if (result.has_value()) {
+    database_result.mutable_gemm()->set_algorithm(*result);
+  }
+  database->Insert(database_key, database_result);
   return result;
 }
 
@@ -319,6 +343,12 @@ StatusOr<bool> GemmAlgorithmPicker::Run(HloModule* module) {
         bool result, RunOnComputation(computation, stream_exec_, allocator_));
     changed |= result;
   }
+
+  TF_ASSIGN_OR_RETURN(
+      AutotuneResultsDatabase * database,
+      AutotuneResultsDatabase::ForPath(
+          module->config().debug_options().xla_gpu_autotune_results_path()));
+  TF_RETURN_IF_ERROR(database->Save());
   return changed;
 }
 
@@ -0,0 +1,223 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/gemm_grouper.h"
+
+#include <string>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
+#include "tensorflow/compiler/xla/service/gpu/backend_configs.pb.h"
+#include "tensorflow/compiler/xla/service/gpu/cublas_cudnn.h"
+#include "tensorflow/compiler/xla/service/graphcycles/graphcycles.h"
+#include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+bool IsGroupableElementType(PrimitiveType type) {
+  switch (type) {
+    case F16:
+    case F32:
+    case F64:
+    case C64:
+    case C128:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Returns the key that GEMMs must share to be grouped, or an empty string if
+// `gemm` can't be grouped.
+StatusOr<std::string> GetGroupKey(const HloInstruction& gemm,
+                                  int64_t max_size_to_group) {
+  if (!IsCublasGemm(gemm) || gemm.operand_count() != 2 ||
+      !gemm.control_predecessors().empty() ||
+      !gemm.control_successors().empty()) {
+    return std::string();
+  }
+  const Shape& lhs_shape = gemm.operand(0)->shape();
+  const Shape& rhs_shape = gemm.operand(1)->shape();
+  const Shape& output_shape = gemm.shape();
+  PrimitiveType type = output_shape.element_type();
+  if (!IsGroupableElementType(type) || lhs_shape.element_type() != type ||
+      rhs_shape.element_type() != type) {
+    return std::string();
+  }
+  if (ShapeUtil::ByteSizeOf(lhs_shape) + ShapeUtil::ByteSizeOf(rhs_shape) +
+          ShapeUtil::ByteSizeOf(output_shape) >
+      max_size_to_group) {
+    return std::string();
+  }
+
+  TF_ASSIGN_OR_RETURN(GemmBackendConfig config,
+                      gemm.backend_config<GemmBackendConfig>());
+  if (config.batch_size() != 1) {
+    return std::string();
+  }
+  config.clear_algorithm();
+  std::string serialized_config;
+  TF_RET_CHECK(
+      tensorflow::SerializeToStringDeterministic(config, &serialized_config));
+  return absl::StrCat(ShapeUtil::HumanStringWithLayout(lhs_shape), ";",
+                      ShapeUtil::HumanStringWithLayout(rhs_shape), ";",
+                      ShapeUtil::HumanStringWithLayout(output_shape), ";",
+                      serialized_config);
+}
+
+// Replaces the GEMMs of `group` with one grouped GEMM custom call.
+Status GroupGemms(HloComputation* computation,
+                  absl::Span<HloInstruction* const> group) {
+  std::vector<HloInstruction*> operands;
+  std::vector<Shape> output_shapes;
+  for (HloInstruction* gemm : group) {
+    operands.push_back(gemm->mutable_operand(0));
+    output_shapes.push_back(gemm->shape());
+  }
+  for (HloInstruction* gemm : group) {
+    operands.push_back(gemm->mutable_operand(1));
+  }
+
+  TF_ASSIGN_OR_RETURN(GemmBackendConfig config,
+                      group.front()->backend_config<GemmBackendConfig>());
+  config.clear_algorithm();
+  HloInstruction* grouped_gemm =
+      computation->AddInstruction(HloInstruction::CreateCustomCall(
+          ShapeUtil::MakeTupleShape(output_shapes), operands,
+          kGroupedGemmCallTarget));
+  grouped_gemm->set_metadata(group.front()->metadata());
+  TF_RETURN_IF_ERROR(grouped_gemm->set_backend_config(config));
+  VLOG(2) << "Grouped " << group.size()
+          << " GEMMs into: " << grouped_gemm->ToString();
+
+  for (int64_t i = 0; i < group.size(); ++i) {
+    TF_RETURN_IF_ERROR(computation->ReplaceWithNewInstruction(
+        group[i],
+        HloInstruction::CreateGetTupleElement(group[i]->shape(), grouped_gemm,
+                                              i)));
+  }
+  return Status::OK();
+}
+
+StatusOr<bool> GroupGemmsInComputation(HloComputation* computation,
+                                       int64_t max_size_to_group) {
+  // Bucket the GEMMs by key, in post order for determinism.
+  std::vector<std::vector<HloInstruction*>> classes;
+  absl::flat_hash_map<std::string, int64_t> class_index;
+  for (HloInstruction* instr : computation->MakeInstructionPostOrder()) {
+    TF_ASSIGN_OR_RETURN(std::string key,
+                        GetGroupKey(*instr, max_size_to_group));
+    if (key.empty()) {
+      continue;
+    }
+    auto it = class_index.try_emplace(key, classes.size()).first;
+    if (it->second == classes.size()) {
+      classes.emplace_back();
+    }
+    classes[it->second].push_back(instr);
+  }
+  if (absl::c_none_of(classes, [](const std::vector<HloInstruction*>& gemms) {
+        return gemms.size() > 1;
+      })) {
+    return false;
+  }
+
+  // As in DotMerger, a group is represented in the dependency graph by a new
+  // node that succeeds all of its GEMMs and precedes all of their users, so
+  // that GEMMs that would create a cycle once grouped are not grouped.
+  tensorflow::GraphCycles graph;
+  absl::flat_hash_map<const HloInstruction*, int32_t> graph_ids;
+  auto graph_id = [&](const HloInstruction* instr) {
+    auto it_and_inserted = graph_ids.try_emplace(instr, -1);
+    if (it_and_inserted.second) {
+      it_and_inserted.first->second = graph.NewNode();
+    }
+    return it_and_inserted.first->second;
+  };
+  for (HloInstruction* instr : computation->instructions()) {
+    int32_t id = graph_id(instr);
+    for (const HloInstruction* operand : instr->operands()) {
+      CHECK(graph.InsertEdge(graph_id(operand), id));
+    }
+    for (const HloInstruction* control_pred : instr->control_predecessors()) {
+      CHECK(graph.InsertEdge(graph_id(control_pred), id));
+    }
+  }
+
+  std::vector<std::vector<HloInstruction*>> groups;
+  for (std::vector<HloInstruction*>& gemms : classes) {
+    // Each pass over the class forms one group from the GEMMs that don't
+    // depend on it and leaves the others for the next pass.
+    while (gemms.size() > 1) {
+      std::vector<HloInstruction*> group = {gemms.front()};
+      std::vector<HloInstruction*> dependent;
+      int32_t group_id = graph_id(gemms.front());
+      for (int64_t i = 1; i < gemms.size(); ++i) {
+        int32_t id = graph_id(gemms[i]);
+        if (graph.IsReachableNonConst(group_id, id) ||
+            graph.IsReachableNonConst(id, group_id)) {
+          dependent.push_back(gemms[i]);
+          continue;
+        }
+        std::vector<int32_t> successors = graph.SuccessorsCopy(group_id);
+        for (int32_t successor : graph.SuccessorsCopy(id)) {
+          successors.push_back(successor);
+        }
+        int32_t merged_id = graph.NewNode();
+        CHECK(graph.InsertEdge(group_id, merged_id));
+        CHECK(graph.InsertEdge(id, merged_id));
+        for (int32_t successor : successors) {
+          CHECK(graph.InsertEdge(merged_id, successor));
+        }
+        group_id = merged_id;
+        group.push_back(gemms[i]);
+      }
+      if (group.size() > 1) {
+        groups.push_back(std::move(group));
+      }
+      gemms = std::move(dependent);
+    }
+  }
+
+  for (const std::vector<HloInstruction*>& group : groups) {
+    TF_RETURN_IF_ERROR(GroupGemms(computation, group));
+  }
+  return !groups.empty();
+}
+
+}  // namespace
+
+StatusOr<bool> GemmGrouper::Run(HloModule* module) {
+  bool changed = false;
+  for (HloComputation* computation : module->MakeNonfusionComputations()) {
+    TF_ASSIGN_OR_RETURN(
+        bool computation_changed,
+        GroupGemmsInComputation(computation, max_size_to_group_));
+    changed |= computation_changed;
+  }
+  return changed;
+}
+
+}  // namespace gpu
+}  // namespace xla
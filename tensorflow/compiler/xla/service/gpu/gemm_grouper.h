@@ -0,0 +1,67 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_GEMM_GROUPER_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_GEMM_GROUPER_H_
+
+#include "tensorflow/compiler/xla/service/hlo_module.h"
+#include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
+
+namespace xla {
+namespace gpu {
+
+// Groups independent cuBLAS GEMM custom calls with identical shapes, layouts
+// and GemmBackendConfig into one grouped GEMM custom call
+// (kGroupedGemmCallTarget), which runs them with a single batched cuBLAS call.
+// Transforms
+//
+//   x = custom-call(a, b), custom_call_target="__cublas$gemm"
+//   y = custom-call(c, d), custom_call_target="__cublas$gemm"
+//
+// into
+//
+//   z = custom-call(a, c, b, d), custom_call_target="__cublas$groupedGemm"
+//   x = get-tuple-element(z), index=0
+//   y = get-tuple-element(z), index=1
+//
+// This helps models with many small independent matmuls (e.g. the experts of a
+// mixture of experts, or per-head projections), where each GEMM alone is too
+// small to fill the device and the launch overhead dominates.
+//
+// Unlike DotMerger, the GEMMs don't have to share an operand and no operand is
+// copied, but like DotMerger the grouped GEMMs must be independent, and all of
+// their inputs and outputs are live at once. Only GEMMs whose input+output
+// bytes are at most `max_size_to_group` are grouped. GEMMs with a bias, with
+// batch dimensions or with an element type the batched cuBLAS API does not
+// support are left alone.
+//
+// Runs after GemmAlgorithmPicker; the batched call doesn't take an algorithm.
+class GemmGrouper : public HloModulePass {
+ public:
+  explicit GemmGrouper(int64_t max_size_to_group)
+      : max_size_to_group_(max_size_to_group) {}
+
+  absl::string_view name() const override { return "cublas-gemm-grouper"; }
+
+  StatusOr<bool> Run(HloModule* module) override;
+
+ private:
+  int64_t max_size_to_group_;
+};
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_GEMM_GROUPER_H_
@@ -0,0 +1,158 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/gemm_grouper.h"
+
+#include "absl/strings/str_replace.h"
+#include "tensorflow/compiler/xla/service/gpu/cublas_cudnn.h"
+#include "tensorflow/compiler/xla/service/hlo_matchers.h"
+#include "tensorflow/compiler/xla/service/hlo_parser.h"
+#include "tensorflow/compiler/xla/test.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+namespace op = xla::testing::opcode_matchers;
+
+class GemmGrouperTest : public HloTestBase {
+ protected:
+  // Substitutes the backend config of a plain 2D GEMM for $config.
+  static std::string WithGemmConfig(absl::string_view hlo) {
+    return absl::StrReplaceAll(
+        hlo,
+        {{"$config",
+          R"({\"alpha_real\":1,\"alpha_imag\":0,\"beta\":0,\"dot_dimension_numbers\":{\"lhs_contracting_dimensions\":[\"1\"],\"rhs_contracting_dimensions\":[\"0\"],\"lhs_batch_dimensions\":[],\"rhs_batch_dimensions\":[]},\"batch_size\":\"1\",\"selected_algorithm\":\"-1\"})"}});
+  }
+
+  static constexpr int64_t kMaxSizeToGroup = int64_t{4} << 20;
+};
+
+TEST_F(GemmGrouperTest, GroupsIndependentGemms) {
+  auto module = ParseAndReturnVerifiedModule(WithGemmConfig(R"(
+  HloModule test
+
+  ENTRY main {
+    a = f32[16,32]{1,0} parameter(0)
+    b = f32[32,8]{1,0} parameter(1)
+    c = f32[16,32]{1,0} parameter(2)
+    d = f32[32,8]{1,0} parameter(3)
+    x = f32[16,8]{1,0} custom-call(a, b), custom_call_target="__cublas$gemm", backend_config="$config"
+    y = f32[16,8]{1,0} custom-call(c, d), custom_call_target="__cublas$gemm", backend_config="$config"
+    ROOT tuple = (f32[16,8]{1,0}, f32[16,8]{1,0}) tuple(x, y)
+  }
+  )"))
+                    .ValueOrDie();
+  ASSERT_TRUE(GemmGrouper(kMaxSizeToGroup).Run(module.get()).ValueOrDie());
+  SCOPED_TRACE(module->ToString());
+  const HloInstruction* root = module->entry_computation()->root_instruction();
+  ASSERT_THAT(root, op::Tuple(op::GetTupleElement(op::CustomCall(), 0),
+                              op::GetTupleElement(op::CustomCall(), 1)));
+  const HloInstruction* grouped = root->operand(0)->operand(0);
+  EXPECT_EQ(grouped, root->operand(1)->operand(0));
+  EXPECT_EQ(grouped->custom_call_target(), kGroupedGemmCallTarget);
+  EXPECT_THAT(grouped->operands(),
+              ::testing::ElementsAre(op::Parameter(0), op::Parameter(2),
+                                     op::Parameter(1), op::Parameter(3)));
+}
+
+TEST_F(GemmGrouperTest, DoesNotGroupDependentGemms) {
+  auto module = ParseAndReturnVerifiedModule(WithGemmConfig(R"(
+  HloModule test
+
+  ENTRY main {
+    a = f32[16,16]{1,0} parameter(0)
+    b = f32[16,16]{1,0} parameter(1)
+    x = f32[16,16]{1,0} custom-call(a, b), custom_call_target="__cublas$gemm", backend_config="$config"
+    ROOT y = f32[16,16]{1,0} custom-call(x, b), custom_call_target="__cublas$gemm", backend_config="$config"
+  }
+  )"))
+                    .ValueOrDie();
+  EXPECT_FALSE(GemmGrouper(kMaxSizeToGroup).Run(module.get()).ValueOrDie());
+}
+
+TEST_F(GemmGrouperTest, DoesNotGroupGemmsThatWouldFormACycle) {
+  // a0 and a1 are independent, and so are b0 and b1, but b0 depends on a0 and
+  // a1 depends on b1. Only one of the two pairs can be grouped.
+  auto module = ParseAndReturnVerifiedModule(WithGemmConfig(R"(
+  HloModule test
+
+  ENTRY main {
+    p = f32[16,16]{1,0} parameter(0)
+    q = f32[16,16]{1,0} parameter(1)
+    c = f32[16,8]{1,0} parameter(2)
+    d = f32[8,16]{1,0} parameter(3)
+    a0 = f32[16,16]{1,0} custom-call(p, q), custom_call_target="__cublas$gemm", backend_config="$config"
+    s0 = f32[16,8]{1,0} slice(a0), slice={[0:16], [0:8]}
+    b0 = f32[16,16]{1,0} custom-call(s0, d), custom_call_target="__cublas$gemm", backend_config="$config"
+    b1 = f32[16,16]{1,0} custom-call(c, d), custom_call_target="__cublas$gemm", backend_config="$config"
+    a1 = f32[16,16]{1,0} custom-call(b1, q), custom_call_target="__cublas$gemm", backend_config="$config"
+    ROOT tuple = (f32[16,16]{1,0}, f32[16,16]{1,0}) tuple(b0, a1)
+  }
+  )"))
+                    .ValueOrDie();
+  ASSERT_TRUE(GemmGrouper(kMaxSizeToGroup).Run(module.get()).ValueOrDie());
+  SCOPED_TRACE(module->ToString());
+  TF_ASSERT_OK(verifier().Run(module.get()).status());
+  int64_t num_grouped = 0;
+  for (const HloInstruction* instr :
+       module->entry_computation()->instructions()) {
+    if (instr->opcode() == HloOpcode::kCustomCall &&
+        instr->custom_call_target() == kGroupedGemmCallTarget) {
+      EXPECT_EQ(instr->operand_count(), 4);
+      ++num_grouped;
+    }
+  }
+  EXPECT_EQ(num_grouped, 1);
+}
+
+TEST_F(GemmGrouperTest, DoesNotGroupGemmsOfDifferentShapes) {
+  auto module = ParseAndReturnVerifiedModule(WithGemmConfig(R"(
+  HloModule test
+
+  ENTRY main {
+    a = f32[16,32]{1,0} parameter(0)
+    b = f32[32,8]{1,0} parameter(1)
+    c = f32[8,32]{1,0} parameter(2)
+    x = f32[16,8]{1,0} custom-call(a, b), custom_call_target="__cublas$gemm", backend_config="$config"
+    y = f32[8,8]{1,0} custom-call(c, b), custom_call_target="__cublas$gemm", backend_config="$config"
+    ROOT tuple = (f32[16,8]{1,0}, f32[8,8]{1,0}) tuple(x, y)
+  }
+  )"))
+                    .ValueOrDie();
+  EXPECT_FALSE(GemmGrouper(kMaxSizeToGroup).Run(module.get()).ValueOrDie());
+}
+
+TEST_F(GemmGrouperTest, DoesNotGroupLargeGemms) {
+  auto module = ParseAndReturnVerifiedModule(WithGemmConfig(R"(
+  HloModule test
+
+  ENTRY main {
+    a = f32[1024,1024]{1,0} parameter(0)
+    b = f32[1024,1024]{1,0} parameter(1)
+    x = f32[1024,1024]{1,0} custom-call(a, b), custom_call_target="__cublas$gemm", backend_config="$config"
+    y = f32[1024,1024]{1,0} custom-call(b, a), custom_call_target="__cublas$gemm", backend_config="$config"
+    ROOT tuple = (f32[1024,1024]{1,0}, f32[1024,1024]{1,0}) tuple(x, y)
+  }
+  )"))
+                    .ValueOrDie();
+  EXPECT_FALSE(GemmGrouper(kMaxSizeToGroup).Run(module.get()).ValueOrDie());
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
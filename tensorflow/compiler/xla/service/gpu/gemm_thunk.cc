@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/gpu/backend_configs.pb.h"
 #include "tensorflow/compiler/xla/service/gpu/ir_emission_utils.h"
 #include "tensorflow/compiler/xla/service/gpu/stream_executor_util.h"
+#include "tensorflow/compiler/xla/status_macros.h"
 #include "tensorflow/compiler/xla/util.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/stream_executor/blas.h"
@@ -66,6 +67,36 @@ Status GemmThunk::ExecuteOnStream(const ExecuteParams &params) {
                  implements_whole_instruction_, profile_index());
 }
 
+GroupedGemmThunk::GroupedGemmThunk(
+    ThunkInfo thunk_info, GpuGemmConfig config,
+    std::vector<BufferAllocation::Slice> lhs_buffers,
+    std::vector<BufferAllocation::Slice> rhs_buffers,
+    std::vector<BufferAllocation::Slice> output_buffers)
+    : Thunk(Kind::kGroupedGemm, thunk_info),
+      config_(std::move(config)),
+      lhs_buffers_(std::move(lhs_buffers)),
+      rhs_buffers_(std::move(rhs_buffers)),
+      output_buffers_(std::move(output_buffers)) {}
+
+Status GroupedGemmThunk::ExecuteOnStream(const ExecuteParams &params) {
+  auto get_device_addresses =
+      [&](absl::Span<const BufferAllocation::Slice> slices) {
+        std::vector<se::DeviceMemoryBase> addresses;
+        addresses.reserve(slices.size());
+        for (const BufferAllocation::Slice &slice : slices) {
+          addresses.push_back(
+              params.buffer_allocations->GetDeviceAddress(slice));
+        }
+        return addresses;
+      };
+
+  VLOG(3) << "Running grouped GEMM thunk of " << output_buffers_.size()
+          << " GEMMs";
+  return RunGroupedGemm(config_, get_device_addresses(lhs_buffers_),
+                        get_device_addresses(rhs_buffers_),
+                        get_device_addresses(output_buffers_), params.stream);
+}
+
 // This struct contains the metadata of a matrix, e.g., its base address and
 // dimensions.
 struct MatrixDescriptor {
@@ -182,15 +213,17 @@ static Status DoGemm(int64_t batch_size, const MatrixDescriptor &lhs,
       /*leading dim of output=*/output_matrix.num_rows);
 }
 
-Status RunGemm(const GpuGemmConfig &gemm_config,
-               se::DeviceMemoryBase lhs_buffer, se::DeviceMemoryBase rhs_buffer,
-               se::DeviceMemoryBase output_buffer, se::Stream *stream,
-               bool implements_whole_instruction,
-               absl::optional<int64_t> profile_index,
-               se::blas::ProfileResult *profile_result,
-               absl::optional<se::blas::AlgorithmType> algorithm) {
-  VLOG(2) << "Executing a GemmThunk";
+// The matrices of one GEMM, in the column-major terms BLAS expects.
+struct GemmMatrices {
+  MatrixDescriptor lhs;
+  MatrixDescriptor rhs;
+  MatrixDescriptor output;
+};
 
+static GemmMatrices GetGemmMatrices(const GpuGemmConfig &gemm_config,
+                                    se::DeviceMemoryBase lhs_buffer,
+                                    se::DeviceMemoryBase rhs_buffer,
+                                    se::DeviceMemoryBase output_buffer) {
   const Shape &output_shape = gemm_config.output_shape;
   const Shape &lhs_shape = gemm_config.lhs_shape;
   const Shape &rhs_shape = gemm_config.rhs_shape;
@@ -202,7 +235,6 @@ Status RunGemm(const GpuGemmConfig &gemm_config,
           ? dim_nums.lhs_batch_dimensions()
           : dim_nums.rhs_batch_dimensions();
 
-  int64_t batch_size = backend_config.batch_size();
   int64_t output_row_dim = output_batch_dims.size();
   int64_t output_col_dim = output_row_dim + 1;
 
@@ -296,6 +328,29 @@ Status RunGemm(const GpuGemmConfig &gemm_config,
   const MatrixDescriptor output_matrix{
       output_buffer, se::blas::Transpose::kNoTranspose, output_num_rows,
       output_num_cols, output_num_rows * output_num_cols};
+  return {lhs_matrix, rhs_matrix, output_matrix};
+}
+
+Status RunGemm(const GpuGemmConfig &gemm_config,
+               se::DeviceMemoryBase lhs_buffer, se::DeviceMemoryBase rhs_buffer,
+               se::DeviceMemoryBase output_buffer, se::Stream *stream,
+               bool implements_whole_instruction,
+               absl::optional<int64_t> profile_index,
+               se::blas::ProfileResult *profile_result,
+               absl::optional<se::blas::AlgorithmType> algorithm) {
+  VLOG(2) << "Executing a GemmThunk";
+
+  const Shape &output_shape = gemm_config.output_shape;
+  const Shape &lhs_shape = gemm_config.lhs_shape;
+  const Shape &rhs_shape = gemm_config.rhs_shape;
+  const GemmBackendConfig &backend_config = gemm_config.backend_config;
+  int64_t batch_size = backend_config.batch_size();
+  GemmMatrices matrices =
+      GetGemmMatrices(gemm_config, lhs_buffer, rhs_buffer, output_buffer);
+  const MatrixDescriptor &lhs_matrix = matrices.lhs;
+  const MatrixDescriptor &rhs_matrix = matrices.rhs;
+  const MatrixDescriptor &output_matrix = matrices.output;
+
   auto best_algorithm = [&]() -> absl::optional<se::blas::AlgorithmType> {
     if (algorithm) {
       return *algorithm;
@@ -370,5 +425,88 @@ Status RunGemm(const GpuGemmConfig &gemm_config,
   }
 }
 
+// `Scalar` is the type of alpha and beta, which is float for half-precision
+// inputs.
+template <typename Input, typename Scalar>
+static Status DoGroupedGemm(absl::Span<const GemmMatrices> group, Scalar alpha,
+                            Scalar beta, se::Stream *stream) {
+  std::vector<se::DeviceMemory<Input>> lhs, rhs, output;
+  for (const GemmMatrices &matrices : group) {
+    lhs.push_back(matrices.lhs.cast<Input>());
+    rhs.push_back(matrices.rhs.cast<Input>());
+    output.push_back(matrices.output.cast<Input>());
+  }
+  auto pointers = [](std::vector<se::DeviceMemory<Input>> &memory) {
+    std::vector<se::DeviceMemory<Input> *> result;
+    for (se::DeviceMemory<Input> &m : memory) {
+      result.push_back(&m);
+    }
+    return result;
+  };
+
+  // The matrices of all GEMMs in the group have the same dimensions.
+  const GemmMatrices &first = group.front();
+  if (!stream
+           ->ThenBlasGemmBatched(
+               first.lhs.transpose, first.rhs.transpose,
+               first.output.num_rows, first.output.num_cols,
+               /*size of reduce dim=*/first.lhs.reduced_dim(), alpha,
+               pointers(lhs), /*leading dim of LHS=*/first.lhs.num_rows,
+               pointers(rhs), /*leading dim of RHS=*/first.rhs.num_rows, beta,
+               pointers(output),
+               /*leading dim of output=*/first.output.num_rows, group.size())
+           .ok()) {
+    return InternalError("Unable to launch grouped GEMM of %d GEMMs",
+                         group.size());
+  }
+  return Status::OK();
+}
+
+Status RunGroupedGemm(const GpuGemmConfig &gemm_config,
+                      absl::Span<const se::DeviceMemoryBase> lhs_buffers,
+                      absl::Span<const se::DeviceMemoryBase> rhs_buffers,
+                      absl::Span<const se::DeviceMemoryBase> output_buffers,
+                      se::Stream *stream) {
+  VLOG(2) << "Executing a GroupedGemmThunk";
+  const GemmBackendConfig &backend_config = gemm_config.backend_config;
+  TF_RET_CHECK(backend_config.batch_size() == 1);
+  TF_RET_CHECK(!output_buffers.empty());
+  TF_RET_CHECK(lhs_buffers.size() == output_buffers.size());
+  TF_RET_CHECK(rhs_buffers.size() == output_buffers.size());
+
+  std::vector<GemmMatrices> group;
+  group.reserve(output_buffers.size());
+  for (int64_t i = 0; i < output_buffers.size(); ++i) {
+    group.push_back(GetGemmMatrices(gemm_config, lhs_buffers[i],
+                                    rhs_buffers[i], output_buffers[i]));
+  }
+
+  complex128 alpha = {backend_config.alpha_real(), backend_config.alpha_imag()};
+  double beta = backend_config.beta();
+
+  switch (gemm_config.output_shape.element_type()) {
+    case F16:
+      CHECK_EQ(alpha.imag(), 0);
+      return DoGroupedGemm<Eigen::half, float>(group, alpha.real(), beta,
+                                               stream);
+    case F32:
+      CHECK_EQ(alpha.imag(), 0);
+      return DoGroupedGemm<float, float>(group, alpha.real(), beta, stream);
+    case F64:
+      CHECK_EQ(alpha.imag(), 0);
+      return DoGroupedGemm<double, double>(group, alpha.real(), beta, stream);
+    case C64:
+      return DoGroupedGemm<complex64, complex64>(
+          group, static_cast<complex64>(alpha), static_cast<complex64>(beta),
+          stream);
+    case C128:
+      return DoGroupedGemm<complex128, complex128>(
+          group, alpha, static_cast<complex128>(beta), stream);
+    default:
+      return InternalError("Unexpected grouped GEMM datatype: %s",
+                           gemm_config.output_shape.ToString());
+  }
+}
+
 }  // namespace gpu
 }  // namespace xla
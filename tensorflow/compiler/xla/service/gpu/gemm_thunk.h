@@ -16,6 +16,9 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_GEMM_THUNK_H_
 #define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_GEMM_THUNK_H_
 
+#include <vector>
+
+#include "absl/types/span.h"
 #include "tensorflow/compiler/xla/service/buffer_assignment.h"
 #include "tensorflow/compiler/xla/service/gpu/backend_configs.pb.h"
 #include "tensorflow/compiler/xla/service/gpu/buffer_allocations.h"
@@ -65,6 +68,31 @@ class GemmThunk : public Thunk {
   const bool implements_whole_instruction_;
 };
 
+// Computes a group of independent GEMMs that all match `config`, i.e.
+// "outputs[i] = (lhs[i] <dot> rhs[i]) * alpha", with one batched BLAS gemm call
+// on arrays of pointers to the operands. The GEMMs must not have batch
+// dimensions.
+//
+// This is thread-compatible.
+class GroupedGemmThunk : public Thunk {
+ public:
+  GroupedGemmThunk(ThunkInfo thunk_info, GpuGemmConfig config,
+                   std::vector<BufferAllocation::Slice> lhs_buffers,
+                   std::vector<BufferAllocation::Slice> rhs_buffers,
+                   std::vector<BufferAllocation::Slice> output_buffers);
+
+  GroupedGemmThunk(const GroupedGemmThunk&) = delete;
+  GroupedGemmThunk& operator=(const GroupedGemmThunk&) = delete;
+
+  Status ExecuteOnStream(const ExecuteParams& params) override;
+
+ private:
+  const GpuGemmConfig config_;
+  const std::vector<BufferAllocation::Slice> lhs_buffers_;
+  const std::vector<BufferAllocation::Slice> rhs_buffers_;
+  const std::vector<BufferAllocation::Slice> output_buffers_;
+};
+
 // Run the given GEMM instruction `gemm` subject to the configuration
 // in `gemm_config` and the passed buffers.
 //
@@ -82,6 +110,14 @@ Status RunGemm(
     se::blas::ProfileResult* profile_result = nullptr,
     absl::optional<se::blas::AlgorithmType> algorithm = absl::nullopt);
 
+// Runs the GEMMs of a group that all match `gemm_config` as one batched BLAS
+// gemm; see GroupedGemmThunk.
+Status RunGroupedGemm(const GpuGemmConfig& gemm_config,
+                      absl::Span<const se::DeviceMemoryBase> lhs_buffers,
+                      absl::Span<const se::DeviceMemoryBase> rhs_buffers,
+                      absl::Span<const se::DeviceMemoryBase> output_buffers,
+                      se::Stream* stream);
+
 }  // namespace gpu
 }  // namespace xla
 
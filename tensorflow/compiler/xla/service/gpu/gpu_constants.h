@@ -31,6 +31,10 @@ extern const int64_t kXlaAllocatedBufferAlignBytes;
 // Minimum alignment for constant buffers.
 extern const int64_t kConstantBufferAlignBytes;
 
+// Layout memory space, and buffer color, of buffers offloaded to pinned host
+// memory by HostOffloader.
+extern const int64_t kHostMemorySpace;
+
 }  // namespace gpu
 }  // namespace xla
 
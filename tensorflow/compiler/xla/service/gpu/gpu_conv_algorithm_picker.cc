@@ -25,6 +25,7 @@ limitations under the License.
 #include "absl/time/time.h"
 #include "absl/types/optional.h"
 #include "tensorflow/compiler/xla/literal_util.h"
+#include "tensorflow/compiler/xla/service/gpu/autotune_results_database.h"
 #include "tensorflow/compiler/xla/service/gpu/backend_configs.pb.h"
 #include "tensorflow/compiler/xla/service/gpu/convolution_thunk.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_asm_opts_util.h"
@@ -360,6 +361,19 @@ StatusOr<AutotuneResult> GpuConvAlgorithmPicker::PickBestAlgorithm(
     autotune_cache_stats.cache_misses++;
   }
 
+  // Results autotuned by other processes on the same kind of device.
+  TF_ASSIGN_OR_RETURN(AutotuneResultsDatabase * database,
+                      AutotuneResultsDatabase::ForInstruction(*instr));
+  AutotuneResultsDatabase::Key database_key =
+      AutotuneResultsDatabase::MakeKey(stream_exec_, *instr);
+  if (absl::optional<AutotuneResult> database_result =
+          database->Lookup(database_key)) {
+    VLOG(2) << "Autotuning results database hit for " << instr->name();
+    absl::MutexLock lock(&autotune_cache_lock);
+    CHECK(autotune_cache.insert({key, *database_result}).second);
+    return *database_result;
+  }
+
   // Make sure any previous activity on this executor is done. We don't want
   // other work still running on the GPU to interfere with autotuning.
   if (!stream_exec_->SynchronizeAllActivity()) {
@@ -396,6 +410,7 @@ StatusOr<AutotuneResult> GpuConvAlgorithmPicker::PickBestAlgorithm(
   if (result_or.ok()) {
     absl::MutexLock lock(&autotune_cache_lock);
     CHECK(autotune_cache.insert({key, result_or.ValueOrDie()}).second);
+    database->Insert(database_key, result_or.ValueOrDie());
   }
   return result_or;
 }
@@ -1015,6 +1030,11 @@ StatusOr<bool> GpuConvAlgorithmPicker::Run(HloModule* module) {
     autotune_cache_stats.LogStats();
   }
 
+  TF_ASSIGN_OR_RETURN(
+      AutotuneResultsDatabase * database,
+      AutotuneResultsDatabase::ForPath(
+          module->config().debug_options().xla_gpu_autotune_results_path()));
+  TF_RETURN_IF_ERROR(database->Save());
   return changed;
 }
 
@@ -22,6 +22,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/cleanup/cleanup.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/memory/memory.h"
@@ -31,6 +32,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/gpu/gpu_constants.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_executable_run_options.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_types.h"
+#include "tensorflow/compiler/xla/service/gpu/sequential_thunk.h"
 #include "tensorflow/compiler/xla/service/gpu/stream_executor_util.h"
 #include "tensorflow/compiler/xla/service/hlo_instruction.h"
 #include "tensorflow/compiler/xla/service/hlo_parser.h"
@@ -50,6 +52,10 @@ limitations under the License.
 #include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/stream_executor/platform.h"
 
+#if GOOGLE_CUDA
+#include "tensorflow/compiler/xla/service/gpu/gpu_graph.h"
+#endif  // GOOGLE_CUDA
+
 #if XLA_ENABLE_XLIR
 #include "llvm/Support/SourceMgr.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"  // from @llvm-project
@@ -78,6 +84,11 @@ limitations under the License.
 namespace xla {
 namespace gpu {
 
+#if !GOOGLE_CUDA
+// GPU graphs are only supported with CUDA, see CanExecuteInGpuGraph.
+class GpuGraphExec {};
+#endif  // !GOOGLE_CUDA
+
 bool IsBefExecutableEnabled(const HloModuleConfig& config) {
 #if XLA_ENABLE_XLIR
   return config.debug_options().xla_gpu_bef_executable();
@@ -191,12 +202,63 @@ struct GpuExecutable::BefExecutable {
 };
 #endif  // XLA_ENABLE_XLIR
 
+namespace {
+
+// Returns whether `thunk` only enqueues device operations onto the stream it
+// runs on, so that they can be captured into a GPU graph and replayed.
+bool IsCapturableInGpuGraph(const Thunk& thunk) {
+  switch (thunk.kind()) {
+    case Thunk::kCopy:
+    case Thunk::kGemm:
+    case Thunk::kKernel:
+    case Thunk::kMemset32BitValue:
+    case Thunk::kMemzero:
+      return true;
+    case Thunk::kSequential:
+      return absl::c_all_of(
+          static_cast<const SequentialThunk&>(thunk).thunks(),
+          [](const std::unique_ptr<Thunk>& nested_thunk) {
+            return IsCapturableInGpuGraph(*nested_thunk);
+          });
+    default:
+      return false;
+  }
+}
+
+bool CanExecuteInGpuGraph(const ThunkSchedule& thunk_schedule) {
+#if !GOOGLE_CUDA
+  LOG(WARNING) << "GPU graphs are only supported with CUDA";
+  return false;
+#endif  // !GOOGLE_CUDA
+  if (thunk_schedule.StreamCount() != 1) {
+    VLOG(1) << "Not using GPU graphs for thunks running on "
+            << thunk_schedule.StreamCount() << " streams";
+    return false;
+  }
+  for (const std::unique_ptr<Thunk>& thunk : thunk_schedule.TotalOrder()) {
+    if (!IsCapturableInGpuGraph(*thunk)) {
+      VLOG(1) << "Not using GPU graphs, as " << thunk->profile_annotation()
+              << " can't be captured";
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
 StatusOr<std::unique_ptr<GpuExecutable>> GpuExecutable::Create(Params params) {
   auto thunks_or_bef = std::move(params.thunks_or_bef);
   std::unique_ptr<GpuExecutable> result(new GpuExecutable(std::move(params)));
 
   if (absl::holds_alternative<OwnedThunkSchedule>(thunks_or_bef)) {
     result->thunks_ = std::move(absl::get<OwnedThunkSchedule>(thunks_or_bef));
+    result->use_gpu_graphs_ = result->has_module() &&
+                              result->module()
+                                  .config()
+                                  .debug_options()
+                                  .xla_gpu_enable_cuda_graphs() &&
+                              CanExecuteInGpuGraph(*result->thunks_);
     return result;
   }
 
@@ -490,8 +552,8 @@ StatusOr<se::DeviceMemoryBase> GpuExecutable::BufferForAllocation(
     VariantArguments arguments,
     const GpuExecutable::BufferAllocToDeviceMemoryMap* globals,
     const BufferAllocation& allocation,
-    se::DeviceMemoryAllocator* const memory_allocator, int device_ordinal,
-    int64_t arg_idx) {
+    se::DeviceMemoryAllocator* const memory_allocator,
+    se::StreamExecutor* executor, int64_t arg_idx) {
   if (allocation.is_thread_local()) {
     return se::DeviceMemoryBase{};
   } else if (allocation.is_entry_computation_parameter()) {
@@ -527,9 +589,24 @@ StatusOr<se::DeviceMemoryBase> GpuExecutable::BufferForAllocation(
     CHECK(allocation.maybe_live_out() || allocation.IsPreallocatedTempBuffer());
     const int64_t buffer_size = allocation.size();
     se::DeviceMemoryBase buffer_address;
+    if (allocation.color() == kHostMemorySpace) {
+      // Pinned host memory is mapped into the device address space under
+      // unified addressing, so copy thunks can use the pointer as is.
+      if (buffer_size > 0) {
+        void* host_buffer = executor->HostMemoryAllocate(buffer_size);
+        if (host_buffer == nullptr) {
+          return ResourceExhausted(
+              "Failed to allocate %d bytes of pinned host memory for "
+              "offloaded buffers.",
+              buffer_size);
+        }
+        buffer_address = se::DeviceMemoryBase(host_buffer, buffer_size);
+      }
+      return buffer_address;
+    }
     if (buffer_size > 0) {
       StatusOr<se::OwningDeviceMemory> buffer =
-          memory_allocator->Allocate(device_ordinal, buffer_size);
+          memory_allocator->Allocate(executor->device_ordinal(), buffer_size);
       if (!buffer.ok()) {
         return ResourceExhausted("%s\n%s\n", buffer.status().error_message(),
                                  verbose_buffer_assignment_string_dumper_());
@@ -564,7 +641,8 @@ static Status CheckAlignment(const BufferAllocation& allocation,
 StatusOr<BufferAllocations> GpuExecutable::GenerateBufferAllocations(
     VariantArguments arguments,
     const GpuExecutable::BufferAllocToDeviceMemoryMap* globals,
-    se::DeviceMemoryAllocator* const memory_allocator, int device_ordinal) {
+    se::DeviceMemoryAllocator* const memory_allocator,
+    se::StreamExecutor* executor) {
   tensorflow::profiler::TraceMe hlo_module_activity(
       [&] { return std::string("Build buffer allocations"); },
       tensorflow::profiler::TraceMeLevel::kInfo);
@@ -577,11 +655,33 @@ StatusOr<BufferAllocations> GpuExecutable::GenerateBufferAllocations(
     TF_ASSIGN_OR_RETURN(
         se::DeviceMemoryBase buffer,
         BufferForAllocation(arguments, globals, allocation, memory_allocator,
-                            device_ordinal, i));
+                            executor, i));
     buffers.push_back(buffer);
     TF_RETURN_IF_ERROR(CheckAlignment(allocation, buffer, i));
   }
-  return {{buffers, device_ordinal, memory_allocator}};
+  return {{buffers, executor->device_ordinal(), memory_allocator}};
+}
+
+void GpuExecutable::ReleaseHostBuffers(
+    se::Stream* stream, const BufferAllocations& buffer_allocations) {
+  bool stream_done = false;
+  for (const BufferAllocation& allocation : allocations_) {
+    se::DeviceMemoryBase buffer =
+        buffer_allocations.GetDeviceAddress(allocation.index());
+    if (allocation.color() != kHostMemorySpace || buffer.is_null()) {
+      continue;
+    }
+    if (!stream_done) {
+      Status status = stream->BlockHostUntilDone();
+      if (!status.ok()) {
+        // Leak the buffers rather than free memory the device may still use.
+        LOG(ERROR) << "Failed to release offloaded host buffers: " << status;
+        return;
+      }
+      stream_done = true;
+    }
+    stream->parent()->HostMemoryDeallocate(buffer.opaque());
+  }
 }
 
 StatusOr<ExecutionOutput> GpuExecutable::ExecuteAsyncOnStream(
@@ -756,8 +856,12 @@ StatusOr<ExecutionOutput> GpuExecutable::ExecuteAsyncOnStreamImpl(
   TF_ASSIGN_OR_RETURN(
       BufferAllocations buffer_allocations,
       GenerateBufferAllocations(arguments, globals, memory_allocator,
-                                device_ordinal));
+                                executor));
   VLOG(2) << buffer_allocations.ToString();
+  // Unlike device memory, host memory is not freed in stream order.
+  auto release_host_buffers = absl::MakeCleanup([&] {
+    ReleaseHostBuffers(run_options->stream(), buffer_allocations);
+  });
   std::set<se::DeviceMemoryBase> buffers_in_result;
 
   const bool is_entire_tuple_contents_aliased = [&] {
@@ -895,6 +999,10 @@ Status GpuExecutable::ExecuteThunksOrBef(
     for (const std::unique_ptr<Thunk>& thunk : thunks_->TotalOrder()) {
       TF_RETURN_IF_ERROR(thunk->Initialize(*this, executor));
     }
+    if (use_gpu_graphs_) {
+      return ExecuteThunksInGpuGraph(run_options, buffer_allocations,
+                                     block_host_until_done);
+    }
     return ExecuteThunks(module_name_, *thunks_, run_options,
                          buffer_allocations, block_host_until_done);
   }
@@ -910,6 +1018,66 @@ Status GpuExecutable::ExecuteThunksOrBef(
   return FailedPrecondition("Expected thunk or bef is not supplied.");
 }
 
+Status GpuExecutable::ExecuteThunksInGpuGraph(
+    const ServiceExecutableRunOptions* run_options,
+    const BufferAllocations& buffer_allocations, bool block_host_until_done) {
+#if GOOGLE_CUDA
+  XlaDebugInfoManager::Get()->OnModuleStart(module_name_);
+  auto cleanup = absl::MakeCleanup(
+      [&]() { XlaDebugInfoManager::Get()->OnModuleStop(module_name_); });
+
+  se::Stream* stream = run_options->stream();
+  uint64_t start_micros = tensorflow::Env::Default()->NowMicros();
+
+  tensorflow::profiler::TraceMe hlo_module_activity(
+      [&] { return absl::StrCat(module_name_, ":XLA GPU module"); },
+      tensorflow::profiler::TraceMeLevel::kInfo);
+
+  std::vector<se::DeviceMemoryBase> buffers;
+  buffers.reserve(allocations_.size());
+  for (BufferAllocation::Index i = 0; i < allocations_.size(); ++i) {
+    buffers.push_back(buffer_allocations.GetDeviceAddress(i));
+  }
+  auto same_buffers = [](absl::Span<const se::DeviceMemoryBase> a,
+                         absl::Span<const se::DeviceMemoryBase> b) {
+    return absl::c_equal(a, b, [](const se::DeviceMemoryBase& x,
+                                  const se::DeviceMemoryBase& y) {
+      return x.opaque() == y.opaque() && x.size() == y.size();
+    });
+  };
+
+  {
+    absl::MutexLock lock(&gpu_graph_mutex_);
+    GpuGraph& graph = gpu_graphs_[stream->parent()];
+    if (graph.exec == nullptr) {
+      graph.exec = absl::make_unique<GpuGraphExec>();
+    }
+    if (!graph.exec->captured() || !same_buffers(graph.buffers, buffers)) {
+      VLOG(2) << "Capturing the thunks of " << module_name_
+              << " into a GPU graph";
+      TF_RETURN_IF_ERROR(graph.exec->Capture(stream, [&]() -> Status {
+        Thunk::ExecuteParams thunk_params{*run_options, buffer_allocations,
+                                          stream,
+                                          /*async_comms_stream=*/nullptr};
+        for (const std::unique_ptr<Thunk>& thunk : thunks_->TotalOrder()) {
+          TF_RETURN_IF_ERROR(thunk->ExecuteOnStream(thunk_params));
+        }
+        return Status::OK();
+      }));
+      graph.buffers = std::move(buffers);
+    }
+
+    ScopedAnnotation annotation("GpuGraphLaunch");
+    TF_RETURN_IF_ERROR(graph.exec->Launch(stream));
+  }
+
+  return MaybeSyncAndProfile(run_options, start_micros,
+                             block_host_until_done ? stream : nullptr);
+#else   // GOOGLE_CUDA
+  return Unimplemented("GPU graphs are only supported with CUDA");
+#endif  // GOOGLE_CUDA
+}
+
 int64_t GpuExecutable::SizeOfGeneratedCodeInBytes() const {
   // Non-empty PTX but empty cubin: compilation must have failed, return
   // "unknown".
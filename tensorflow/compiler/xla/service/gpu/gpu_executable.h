@@ -55,6 +55,8 @@ inline bool IsBefEnabled(const HloModuleConfig& config) {
   return IsBefExecutableEnabled(config) || IsBefThunkEnabled(config);
 }
 
+class GpuGraphExec;
+
 // GPU-targeting implementation of the XLA Executable interface.
 //
 // Launches the given GPU kernel via the StreamExecutor.
@@ -202,6 +204,13 @@ class GpuExecutable : public Executable {
                             const BufferAllocations& buffer_allocations,
                             bool block_host_until_done);
 
+  // Executes the thunks, which all run on a single stream, by launching a GPU
+  // graph of them. The graph is captured again whenever the buffer addresses
+  // differ from those it was last captured with.
+  Status ExecuteThunksInGpuGraph(const ServiceExecutableRunOptions* run_options,
+                                 const BufferAllocations& buffer_allocations,
+                                 bool block_host_until_done);
+
   using BufferAllocToDeviceMemoryMap =
       absl::flat_hash_map<BufferAllocation::Index, se::DeviceMemoryBase>;
 
@@ -226,14 +235,20 @@ class GpuExecutable : public Executable {
   StatusOr<BufferAllocations> GenerateBufferAllocations(
       VariantArguments arguments,
       const GpuExecutable::BufferAllocToDeviceMemoryMap* globals,
-      se::DeviceMemoryAllocator* const memory_allocator, int device_ordinal);
+      se::DeviceMemoryAllocator* const memory_allocator,
+      se::StreamExecutor* executor);
 
   StatusOr<se::DeviceMemoryBase> BufferForAllocation(
       VariantArguments arguments,
       const GpuExecutable::BufferAllocToDeviceMemoryMap* globals,
       const BufferAllocation& allocation,
-      se::DeviceMemoryAllocator* const memory_allocator, int device_ordinal,
-      int64_t arg_idx);
+      se::DeviceMemoryAllocator* const memory_allocator,
+      se::StreamExecutor* executor, int64_t arg_idx);
+
+  // Releases the pinned host memory of the buffers offloaded by HostOffloader
+  // once `stream` is done with them.
+  void ReleaseHostBuffers(se::Stream* stream,
+                          const BufferAllocations& buffer_allocations);
 
   // The LLVM IR, in string format, of the unoptimized module generated for
   // this GpuExecutable. We save a string instead of an llvm::Module* because
@@ -287,6 +302,20 @@ class GpuExecutable : public Executable {
   // potentially shared with other executables.
   std::vector<std::shared_ptr<se::DeviceMemoryBase>> shared_constants_;
 
+  // Whether the thunks are executed in GPU graphs, see
+  // --xla_gpu_enable_cuda_graphs.
+  bool use_gpu_graphs_ = false;
+
+  // A GPU graph of the thunks and the buffer addresses it was captured with.
+  struct GpuGraph {
+    std::unique_ptr<GpuGraphExec> exec;
+    std::vector<se::DeviceMemoryBase> buffers;
+  };
+  absl::Mutex gpu_graph_mutex_;
+  // GPU graphs per StreamExecutor the executable runs on.
+  absl::flat_hash_map<stream_executor::StreamExecutor*, GpuGraph> gpu_graphs_
+      ABSL_GUARDED_BY(gpu_graph_mutex_);
+
   // Data for bef executable mode only, owned.
   BefExecutable* bef_executable_ = nullptr;
 
@@ -20,6 +20,8 @@ limitations under the License.
 #include <stack>
 #include <vector>
 
+#include "absl/algorithm/container.h"
+#include "tensorflow/compiler/xla/layout_util.h"
 #include "tensorflow/compiler/xla/service/gpu/ir_emission_utils.h"
 #include "tensorflow/compiler/xla/service/hlo_computation.h"
 #include "tensorflow/compiler/xla/service/hlo_instruction.h"
@@ -56,6 +58,25 @@ bool IfFusedReadsElementsMultipleTimes(const HloInstruction& instr) {
   return false;
 }
 
+// Returns whether `instr`, which has the shape of `row_shape` with the minor
+// dimension reduced, is only read through elementwise ops of the same shape and
+// broadcasts back along the reduced dimension. The emitter computes such values
+// once per row, so they must not be read at any other row's index.
+bool HasOnlyRowBroadcastUsers(const HloInstruction& instr,
+                              const Shape& row_shape) {
+  const int64_t rank = row_shape.rank();
+  std::vector<int64_t> kept_dimensions(rank - 1);
+  absl::c_iota(kept_dimensions, 0);
+  return absl::c_all_of(instr.users(), [&](const HloInstruction* user) {
+    if (user->opcode() == HloOpcode::kBroadcast) {
+      return ShapeUtil::SameDimensions(user->shape(), row_shape) &&
+             absl::c_equal(user->dimensions(), kept_dimensions);
+    }
+    return user->IsElementwise() &&
+           ShapeUtil::SameDimensions(user->shape(), instr.shape());
+  });
+}
+
 }  // namespace
 
 bool LayoutsAreReduceInputFusionFriendly(const HloInstruction& producer,
@@ -627,5 +648,65 @@ size_t GetOutputSizeOfFusible(const HloInstruction& instr) {
   return ShapeUtil::TupleElementCount(root->shape());
 }
 
+bool IsReductionEpilogueRoot(const HloInstruction& instr) {
+  const Shape& shape = instr.shape();
+  return instr.IsElementwise() && instr.operand_count() > 0 &&
+         shape.IsArray() && shape.rank() >= 1 &&
+         !ShapeUtil::IsZeroElementArray(shape) &&
+         LayoutUtil::IsMonotonicWithDim0Major(shape.layout());
+}
+
+bool IsFusibleIntoReductionEpilogue(const HloInstruction& instr,
+                                    const Shape& row_shape) {
+  const int64_t rank = row_shape.rank();
+  Shape reduced_row_shape = ShapeUtil::DeleteDimension(rank - 1, row_shape);
+  switch (instr.opcode()) {
+    case HloOpcode::kParameter:
+      return true;
+    case HloOpcode::kConstant:
+      return ShapeUtil::IsEffectiveScalar(instr.shape());
+    case HloOpcode::kBroadcast:
+      // Broadcasts of scalars, per-column vectors and reduced rows. Broadcasts
+      // of full rows would read other threads' columns.
+      if (ShapeUtil::SameDimensions(instr.shape(), reduced_row_shape)) {
+        return ShapeUtil::IsEffectiveScalar(instr.operand(0)->shape()) &&
+               HasOnlyRowBroadcastUsers(instr, row_shape);
+      }
+      return ShapeUtil::SameDimensions(instr.shape(), row_shape) &&
+             instr.operand(0)->shape().rank() < rank;
+    case HloOpcode::kReduce:
+      return !instr.shape().IsTuple() && instr.dimensions().size() == 1 &&
+             instr.dimensions(0) == rank - 1 &&
+             ShapeUtil::SameDimensions(instr.operand(0)->shape(), row_shape) &&
+             HasOnlyRowBroadcastUsers(instr, row_shape);
+    default:
+      // Elementwise ops over rows, or over reduced rows such as the mean and
+      // variance of layer norm.
+      if (!instr.IsElementwise() || instr.operand_count() == 0 ||
+          !instr.shape().IsArray()) {
+        return false;
+      }
+      if (ShapeUtil::SameDimensions(instr.shape(), reduced_row_shape)) {
+        return HasOnlyRowBroadcastUsers(instr, row_shape);
+      }
+      return ShapeUtil::SameDimensions(instr.shape(), row_shape);
+  }
+}
+
+bool IsReductionEpilogueFusion(const HloComputation& fused_computation) {
+  const HloInstruction* root = fused_computation.root_instruction();
+  if (!IsReductionEpilogueRoot(*root)) {
+    return false;
+  }
+  bool has_reduction = false;
+  for (const HloInstruction* instr : fused_computation.instructions()) {
+    if (!IsFusibleIntoReductionEpilogue(*instr, root->shape())) {
+      return false;
+    }
+    has_reduction |= instr->opcode() == HloOpcode::kReduce;
+  }
+  return has_reduction;
+}
+
 }  // namespace gpu
 }  // namespace xla
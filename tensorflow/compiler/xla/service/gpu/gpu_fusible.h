@@ -141,6 +141,24 @@ absl::InlinedVector<const HloInstruction*, 2> GetOutputsOfFusible(
 // Returns the output size of the fusible `instr`.
 size_t GetOutputSizeOfFusible(const HloInstruction& instr);
 
+// A reduction-epilogue fusion computes reductions over the minor dimension of
+// its root shape together with the elementwise consumers of their broadcast
+// results, e.g. softmax, layer norm or RMS norm. It is emitted as one kernel
+// that reduces each row in a thread block, instead of one kernel per reduction
+// and one for the epilogue.
+//
+// Returns whether `instr` can be the root of a reduction-epilogue fusion.
+bool IsReductionEpilogueRoot(const HloInstruction& instr);
+
+// Returns whether `instr` can be part of a reduction-epilogue fusion whose root
+// has shape `row_shape`. Reductions, and elementwise ops over reduced rows,
+// must only be read through a broadcast back along the reduced dimension.
+bool IsFusibleIntoReductionEpilogue(const HloInstruction& instr,
+                                    const Shape& row_shape);
+
+// Returns whether `fused_computation` is a reduction-epilogue fusion.
+bool IsReductionEpilogueFusion(const HloComputation& fused_computation);
+
 }  // namespace gpu
 }  // namespace xla
 
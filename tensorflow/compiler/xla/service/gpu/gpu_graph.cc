@@ -0,0 +1,79 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/gpu_graph.h"
+
+#include "absl/cleanup/cleanup.h"
+#include "tensorflow/compiler/xla/status_macros.h"
+#include "tensorflow/stream_executor/gpu/gpu_executor.h"
+#include "tensorflow/stream_executor/gpu/gpu_stream.h"
+
+namespace xla {
+namespace gpu {
+
+GpuGraphExec::~GpuGraphExec() {
+  if (exec_ != nullptr) {
+    se::gpu::GpuDriver::DestroyGraphExec(context_, exec_);
+  }
+}
+
+Status GpuGraphExec::Capture(se::Stream* stream,
+                             const std::function<Status()>& enqueue) {
+  se::gpu::GpuStream* gpu_stream = se::gpu::AsGpuStream(stream);
+  se::gpu::GpuContext* context = gpu_stream->parent()->gpu_context();
+  TF_RET_CHECK(exec_ == nullptr || context == context_)
+      << "A GPU graph must be captured on a single device";
+
+  TF_RETURN_IF_ERROR(se::gpu::GpuDriver::StreamBeginCapture(
+      context, gpu_stream->gpu_stream()));
+  // The capture has to end even if enqueueing failed, to leave the stream
+  // usable.
+  Status enqueue_status = enqueue();
+  se::gpu::GpuGraphHandle graph = nullptr;
+  Status end_status = se::gpu::GpuDriver::StreamEndCapture(
+      context, gpu_stream->gpu_stream(), &graph);
+  auto destroy_graph = absl::MakeCleanup([&] {
+    if (graph != nullptr) {
+      se::gpu::GpuDriver::DestroyGraph(context, graph);
+    }
+  });
+  TF_RETURN_IF_ERROR(enqueue_status);
+  TF_RETURN_IF_ERROR(end_status);
+
+  if (exec_ != nullptr) {
+    TF_ASSIGN_OR_RETURN(
+        bool updated,
+        se::gpu::GpuDriver::GraphExecUpdate(context_, exec_, graph));
+    if (updated) {
+      return Status::OK();
+    }
+    VLOG(2) << "Instantiating the GPU graph again, as its topology changed";
+    se::gpu::GpuDriver::DestroyGraphExec(context_, exec_);
+    exec_ = nullptr;
+  }
+  TF_RETURN_IF_ERROR(
+      se::gpu::GpuDriver::GraphInstantiate(context, graph, &exec_));
+  context_ = context;
+  return Status::OK();
+}
+
+Status GpuGraphExec::Launch(se::Stream* stream) {
+  TF_RET_CHECK(captured()) << "The GPU graph has not been captured";
+  return se::gpu::GpuDriver::GraphLaunch(context_, exec_,
+                                         se::gpu::AsGpuStreamValue(stream));
+}
+
+}  // namespace gpu
+}  // namespace xla
@@ -0,0 +1,64 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_GPU_GRAPH_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_GPU_GRAPH_H_
+
+#include <functional>
+
+#include "tensorflow/compiler/xla/status.h"
+#include "tensorflow/core/platform/stream_executor_no_cuda.h"
+#include "tensorflow/stream_executor/gpu/gpu_driver.h"
+#include "tensorflow/stream_executor/gpu/gpu_types.h"
+
+namespace xla {
+namespace gpu {
+
+// An executable GPU graph (a CUDA graph) of the device operations enqueued onto
+// a stream. Launching it submits all of these operations at once, instead of
+// paying the host overhead of launching each of them separately.
+//
+// The graph refers to the device buffers the operations were enqueued with, so
+// it has to be captured again whenever they change. Capturing again updates
+// the executable graph in place when only the parameters of its operations
+// changed, which is much cheaper than instantiating it again.
+class GpuGraphExec {
+ public:
+  GpuGraphExec() = default;
+  ~GpuGraphExec();
+
+  GpuGraphExec(const GpuGraphExec&) = delete;
+  GpuGraphExec& operator=(const GpuGraphExec&) = delete;
+
+  // Captures the operations `enqueue` enqueues onto `stream`, without
+  // executing them, as the ones Launch submits. `stream` must belong to the
+  // same device on every call.
+  Status Capture(se::Stream* stream, const std::function<Status()>& enqueue);
+
+  // Enqueues the operations last captured onto `stream`.
+  Status Launch(se::Stream* stream);
+
+  // Whether the operations have been captured at least once.
+  bool captured() const { return exec_ != nullptr; }
+
+ private:
+  se::gpu::GpuContext* context_ = nullptr;
+  se::gpu::GpuGraphExecHandle exec_ = nullptr;
+};
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_GPU_GRAPH_H_
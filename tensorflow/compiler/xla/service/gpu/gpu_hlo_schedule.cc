@@ -15,12 +15,17 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/gpu/gpu_hlo_schedule.h"
 
+#include <algorithm>
 #include <deque>
+#include <functional>
+#include <limits>
 #include <memory>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/memory/memory.h"
 #include "tensorflow/compiler/xla/service/buffer_value.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_hlo_cost_analysis.h"
 #include "tensorflow/compiler/xla/service/hlo_instructions.h"
 #include "tensorflow/compiler/xla/service/hlo_memory_scheduler.h"
 #include "tensorflow/compiler/xla/service/hlo_reachability.h"
@@ -187,10 +192,33 @@ void BFSLaunchOrder(const HloComputation* computation,
   }
 }
 
-bool ShouldScheduleAsEarlyAsPossible(const HloInstruction& instr) {
+bool IsAsyncCollectiveStart(const HloInstruction& instr) {
   switch (instr.opcode()) {
+    case HloOpcode::kAllGatherStart:
     case HloOpcode::kAllReduceStart:
+    case HloOpcode::kCollectivePermuteStart:
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool IsAsyncCollectiveDone(const HloInstruction& instr) {
+  switch (instr.opcode()) {
+    case HloOpcode::kAllGatherDone:
+    case HloOpcode::kAllReduceDone:
+    case HloOpcode::kCollectivePermuteDone:
       return true;
+    default:
+      return false;
+  }
+}
+
+bool ShouldScheduleAsEarlyAsPossible(const HloInstruction& instr) {
+  if (IsAsyncCollectiveStart(instr)) {
+    return true;
+  }
+  switch (instr.opcode()) {
     case HloOpcode::kCustomCall:
       return static_cast<const HloCustomCallInstruction&>(instr)
                  .custom_call_schedule() ==
@@ -209,9 +237,10 @@ bool ShouldScheduleSuccessor(
 }
 
 bool ShouldScheduleAsLateAsPossible(const HloInstruction& instr) {
+  if (IsAsyncCollectiveDone(instr)) {
+    return true;
+  }
   switch (instr.opcode()) {
-    case HloOpcode::kAllReduceDone:
-      return true;
     case HloOpcode::kCustomCall:
       return static_cast<const HloCustomCallInstruction&>(instr)
                  .custom_call_schedule() == CustomCallSchedule::SCHEDULE_LATEST;
@@ -308,6 +337,202 @@ HloInstructionSequence PostprocessorToScheduleAsEarlyOrLateAsPossible(
   return result;
 }
 
+// Rates at which the latency hiding scheduler assumes a GPU runs
+// instructions. Only the ratio of the time an instruction takes to the latency
+// of a collective matters to the schedule, so these describe a typical
+// data-center GPU rather than the one the module is compiled for.
+constexpr float kFlopsPerSecond = 1e14;
+constexpr float kBytesPerSecond = 1e12;
+
+// Latency model of a collective: a fixed cost to launch it and synchronize the
+// participants, plus the time to move its result over the interconnect.
+constexpr double kCollectiveLaunchSeconds = 1e-5;
+constexpr double kCollectiveBytesPerSecond = 1e11;
+
+// Returns the total size of the arrays in `shape`.
+int64_t ArrayBytes(const Shape& shape, int64_t pointer_size) {
+  int64_t bytes = 0;
+  ShapeUtil::ForEachSubshape(
+      shape, [&](const Shape& subshape, const ShapeIndex& /*index*/) {
+        if (subshape.IsArray()) {
+          bytes += ShapeUtil::ByteSizeOf(subshape, pointer_size);
+        }
+      });
+  return bytes;
+}
+
+// Schedules asynchronous collectives, and custom calls marked with
+// SCHEDULE_EARLIEST or SCHEDULE_LATEST, so that the wait on a collective is
+// hidden behind independent compute.
+//
+// Every -start (or SCHEDULE_EARLIEST custom call) is scheduled right after its
+// last operand, unless the buffers of the collectives already in flight would
+// then exceed `memory_limit_bytes`; it is left at its place in the input
+// sequence otherwise. Every -done is delayed until either an instruction needs
+// its result, the compute scheduled since it became ready covers the latency
+// of its collective, or waiting on it is needed to start another collective
+// within the memory limit. SCHEDULE_LATEST custom calls have no latency model,
+// so they are scheduled right before their first consumer.
+class LatencyHidingPostprocessor {
+ public:
+  // `cost_analysis` must have visited the computations to schedule, and
+  // outlive this postprocessor. A `memory_limit_bytes` of 0 means no limit.
+  LatencyHidingPostprocessor(const HloCostAnalysis* cost_analysis,
+                             int64_t pointer_size, int64_t memory_limit_bytes)
+      : cost_analysis_(cost_analysis),
+        pointer_size_(pointer_size),
+        memory_limit_bytes_(memory_limit_bytes) {}
+
+  HloInstructionSequence operator()(const HloInstructionSequence& input) const;
+
+ private:
+  // Estimated seconds `instr` keeps the GPU busy for. Asynchronous collectives
+  // are not compute that can hide the latency of another collective.
+  double ComputeSeconds(const HloInstruction& instr) const {
+    if (IsAsyncCollectiveStart(instr) || IsAsyncCollectiveDone(instr)) {
+      return 0;
+    }
+    return std::max(0.0f, cost_analysis_->optimal_seconds(instr));
+  }
+
+  // Estimated seconds between the start of the collective awaited by `done`
+  // and its completion.
+  double LatencySeconds(const HloInstruction& done) const {
+    if (!IsAsyncCollectiveDone(done)) {
+      return std::numeric_limits<double>::infinity();
+    }
+    return kCollectiveLaunchSeconds +
+           ArrayBytes(done.shape(), pointer_size_) / kCollectiveBytesPerSecond;
+  }
+
+  bool FitsInMemoryLimit(int64_t in_flight_bytes,
+                         const HloInstruction& start) const {
+    return memory_limit_bytes_ <= 0 ||
+           in_flight_bytes + ArrayBytes(start.shape(), pointer_size_) <=
+               memory_limit_bytes_;
+  }
+
+  const HloCostAnalysis* cost_analysis_;
+  int64_t pointer_size_;
+  int64_t memory_limit_bytes_;
+};
+
+HloInstructionSequence LatencyHidingPostprocessor::operator()(
+    const HloInstructionSequence& input) const {
+  // An instruction to schedule as late as possible whose operands have all
+  // been scheduled.
+  struct PendingDone {
+    HloInstruction* done;
+    // Seconds of compute left to overlap with its collective.
+    double remaining_seconds;
+  };
+  std::vector<PendingDone> pending;
+  absl::flat_hash_set<const HloInstruction*> scheduled;
+  HloInstructionSequence result;
+  // Bytes of the buffers of the asynchronous collectives in flight.
+  int64_t in_flight_bytes = 0;
+
+  auto is_scheduled = [&](const HloInstruction* instr) -> bool {
+    return scheduled.contains(instr);
+  };
+  auto is_pending = [&](const HloInstruction* instr) -> bool {
+    return absl::c_any_of(pending, [&](const PendingDone& p) {
+      return p.done == instr;
+    });
+  };
+  auto is_ready = [&](const HloInstruction& instr) -> bool {
+    return absl::c_all_of(instr.operands(), is_scheduled) &&
+           absl::c_all_of(instr.control_predecessors(), is_scheduled);
+  };
+
+  std::function<void(HloInstruction*)> schedule;
+  // Schedules the first pending done matching `predicate`, if any.
+  auto release_first = [&](const std::function<bool(const PendingDone&)>&
+                               predicate) -> bool {
+    auto it = absl::c_find_if(pending, predicate);
+    if (it == pending.end()) {
+      return false;
+    }
+    HloInstruction* done = it->done;
+    pending.erase(it);
+    schedule(done);
+    return true;
+  };
+
+  schedule = [&](HloInstruction* instr) {
+    // Wait on the collectives `instr` depends on.
+    while (release_first([&](const PendingDone& p) {
+      return absl::c_linear_search(instr->operands(), p.done) ||
+             absl::c_linear_search(instr->control_predecessors(), p.done);
+    })) {
+    }
+    if (IsAsyncCollectiveStart(*instr)) {
+      // Wait on the oldest collectives until this one fits in memory.
+      while (!FitsInMemoryLimit(in_flight_bytes, *instr) &&
+             release_first([](const PendingDone& p) {
+               return IsAsyncCollectiveDone(*p.done);
+             })) {
+      }
+      in_flight_bytes += ArrayBytes(instr->shape(), pointer_size_);
+    } else if (IsAsyncCollectiveDone(*instr)) {
+      in_flight_bytes -= ArrayBytes(instr->operand(0)->shape(), pointer_size_);
+    }
+    result.push_back(instr);
+    scheduled.insert(instr);
+
+    // Wait on the collectives whose latency is now hidden.
+    const double seconds = ComputeSeconds(*instr);
+    if (seconds > 0) {
+      for (PendingDone& p : pending) {
+        p.remaining_seconds -= seconds;
+      }
+      while (release_first(
+          [](const PendingDone& p) { return p.remaining_seconds <= 0; })) {
+      }
+    }
+
+    auto schedule_successor = [&](HloInstruction* successor) {
+      if (is_scheduled(successor) || is_pending(successor) ||
+          !is_ready(*successor)) {
+        return;
+      }
+      if (ShouldScheduleAsEarlyAsPossible(*successor)) {
+        if (!IsAsyncCollectiveStart(*successor) ||
+            FitsInMemoryLimit(in_flight_bytes, *successor)) {
+          schedule(successor);
+        }
+      } else if (ShouldScheduleAsLateAsPossible(*successor)) {
+        pending.push_back({successor, LatencySeconds(*successor)});
+      }
+    };
+    for (HloInstruction* user : instr->users()) {
+      schedule_successor(user);
+    }
+    for (HloInstruction* successor : instr->control_successors()) {
+      schedule_successor(successor);
+    }
+  };
+
+  for (HloInstruction* instr : input.instructions()) {
+    if (is_scheduled(instr) || is_pending(instr)) {
+      continue;
+    }
+    if (ShouldScheduleAsLateAsPossible(*instr)) {
+      // Instructions with operands were made pending when their last operand
+      // was scheduled.
+      if (is_ready(*instr)) {
+        pending.push_back({instr, LatencySeconds(*instr)});
+      }
+      continue;
+    }
+    schedule(instr);
+  }
+  while (release_first([](const PendingDone&) { return true; })) {
+  }
+  CHECK_EQ(result.size(), input.size());
+  return result;
+}
+
 }  // end namespace
 
 GpuHloSchedule::GpuHloSchedule() {}
@@ -321,6 +546,23 @@ StatusOr<std::unique_ptr<GpuHloSchedule>> GpuHloSchedule::Build(
   // Initialize thunk_launch_order_, the total order of thunk launches.
   HloComputation* entry_computation = module->entry_computation();
   if (stream_assignment.StreamCount() == 1) {
+    const DebugOptions& debug_options = module->config().debug_options();
+    MemorySchedulerPostprocessor postprocessor =
+        PostprocessorToScheduleAsEarlyOrLateAsPossible;
+    std::unique_ptr<GpuHloCostAnalysis> cost_analysis;
+    if (debug_options.xla_gpu_enable_latency_hiding_scheduler()) {
+      HloCostAnalysis::Options options{[pointer_size](const Shape& shape) {
+        return ShapeUtil::ByteSizeOf(shape, pointer_size);
+      }};
+      options.set_flops_per_second(kFlopsPerSecond);
+      options.set_bytes_per_second(kBytesPerSecond);
+      cost_analysis = absl::make_unique<GpuHloCostAnalysis>(options);
+      TF_RETURN_IF_ERROR(entry_computation->Accept(cost_analysis.get()));
+      postprocessor = LatencyHidingPostprocessor(
+          cost_analysis.get(), pointer_size,
+          debug_options.xla_gpu_latency_hiding_scheduler_memory_limit_bytes());
+    }
+
     // All kernels are launched on a single stream, so there's no loss of
     // concurrency by optimizing for minimal memory usage.
     TF_ASSIGN_OR_RETURN(
@@ -330,9 +572,8 @@ StatusOr<std::unique_ptr<GpuHloSchedule>> GpuHloSchedule::Build(
             [pointer_size](const BufferValue& buffer) {
               return ShapeUtil::ByteSizeOf(buffer.shape(), pointer_size);
             },
-            ComputationSchedulerToModuleScheduler(
-                DefaultMemoryScheduler,
-                PostprocessorToScheduleAsEarlyOrLateAsPossible)));
+            ComputationSchedulerToModuleScheduler(DefaultMemoryScheduler,
+                                                  postprocessor)));
     schedule->thunk_launch_order_ =
         sequences.sequence(entry_computation).instructions();
     schedule->hlo_ordering_ =
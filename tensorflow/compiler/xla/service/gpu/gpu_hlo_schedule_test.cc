@@ -52,6 +52,39 @@ class GpuHloScheduleTest : public HloTestBase {
     return absl::make_unique<HloModule>("test_module", config);
   }
 
+  static void SetLatencyHidingOptions(HloModule* module, bool enable,
+                                      int64_t memory_limit_bytes) {
+    HloModuleConfig config = module->config();
+    DebugOptions debug_options = config.debug_options();
+    debug_options.set_xla_gpu_enable_latency_hiding_scheduler(enable);
+    debug_options.set_xla_gpu_latency_hiding_scheduler_memory_limit_bytes(
+        memory_limit_bytes);
+    config.set_debug_options(debug_options);
+    module->set_config(config);
+  }
+
+  // Adds to `module` the reduction computation of an all-reduce.
+  static HloComputation* AddReductionComputation(HloModule* module) {
+    HloComputation::Builder builder("add");
+    HloInstruction* x = builder.AddInstruction(HloInstruction::CreateParameter(
+        /*parameter_number=*/0, ShapeUtil::MakeScalarShape(F32), /*name=*/"x"));
+    HloInstruction* y = builder.AddInstruction(HloInstruction::CreateParameter(
+        /*parameter_number=*/1, ShapeUtil::MakeScalarShape(F32), /*name=*/"y"));
+    HloInstruction* add = builder.AddInstruction(HloInstruction::CreateBinary(
+        ShapeUtil::MakeScalarShape(F32), HloOpcode::kAdd, x, y));
+    return module->AddEmbeddedComputation(builder.Build(add));
+  }
+
+  HloInstruction* AddAllReduceStart(HloComputation::Builder* builder,
+                                    HloInstruction* operand,
+                                    HloComputation* reduction_computation) {
+    return builder->AddInstruction(HloInstruction::CreateAllReduceStart(
+        ShapeUtil::MakeTupleShape({f32_2x2_, f32_2x2_}), {operand},
+        reduction_computation,
+        /*replica_groups=*/{}, /*constrain_layout=*/false,
+        /*channel_id=*/absl::nullopt, /*use_global_device_ids=*/true));
+  }
+
   HloVec RemoveHlo(const HloVec& input,
                    const absl::flat_hash_set<const HloInstruction*>& remove) {
     HloVec result(input);
@@ -482,5 +515,95 @@ TEST_F(GpuHloScheduleTest, AsyncAllReduce) {
   EXPECT_TRUE(order->ExecutesBefore(all_reduce_done, add4));
 }
 
+TEST_F(GpuHloScheduleTest, AsyncAllReduceDoneWaitsUntilLatencyIsHidden) {
+  std::unique_ptr<HloModule> module = CreateNewVerifiedModule();
+  HloComputation* reduction_computation =
+      AddReductionComputation(module.get());
+
+  // Each add of `big` takes longer than the all-reduce of `x`.
+  const Shape big_shape = ShapeUtil::MakeShape(F32, {2048, 2048});
+  HloComputation::Builder builder("entry_computation");
+  HloInstruction* x = builder.AddInstruction(HloInstruction::CreateParameter(
+      /*parameter_number=*/0, f32_2x2_, /*name=*/"x"));
+  HloInstruction* big = builder.AddInstruction(HloInstruction::CreateParameter(
+      /*parameter_number=*/1, big_shape, /*name=*/"big"));
+  HloInstruction* all_reduce_start =
+      AddAllReduceStart(&builder, x, reduction_computation);
+  HloInstruction* all_reduce_done =
+      builder.AddInstruction(HloInstruction::CreateUnary(
+          f32_2x2_, HloOpcode::kAllReduceDone, all_reduce_start));
+  HloInstruction* add0 = builder.AddInstruction(
+      HloInstruction::CreateBinary(big_shape, HloOpcode::kAdd, big, big));
+  HloInstruction* add1 = builder.AddInstruction(
+      HloInstruction::CreateBinary(big_shape, HloOpcode::kAdd, add0, big));
+  HloInstruction* add2 = builder.AddInstruction(
+      HloInstruction::CreateBinary(big_shape, HloOpcode::kAdd, add1, big));
+  builder.AddInstruction(
+      HloInstruction::CreateTuple({all_reduce_done, add2}));
+  TF_CHECK_OK(all_reduce_start->AddControlDependencyTo(add0));
+  module->AddEntryComputation(builder.Build());
+
+  std::unique_ptr<StreamAssignment> streams = AssignStreams(*module);
+  std::unique_ptr<HloOrdering> order =
+      BuildGpuHloSchedule(module.get(), *streams)->ConsumeHloOrdering();
+  VLOG(2) << order->ToString();
+
+  // add0 overlaps with the all-reduce, which is then waited on before its
+  // buffers need to be kept alive any longer.
+  EXPECT_TRUE(order->ExecutesBefore(add0, all_reduce_done));
+  EXPECT_TRUE(order->ExecutesBefore(all_reduce_done, add1));
+
+  // Without a latency model the all-reduce is waited on as late as possible.
+  SetLatencyHidingOptions(module.get(), /*enable=*/false,
+                          /*memory_limit_bytes=*/0);
+  order = BuildGpuHloSchedule(module.get(), *streams)->ConsumeHloOrdering();
+  VLOG(2) << order->ToString();
+  EXPECT_TRUE(order->ExecutesBefore(add2, all_reduce_done));
+}
+
+TEST_F(GpuHloScheduleTest, AsyncAllReducesInFlightAreBoundedByMemoryLimit) {
+  std::unique_ptr<HloModule> module = CreateNewVerifiedModule();
+  HloComputation* reduction_computation =
+      AddReductionComputation(module.get());
+
+  HloComputation::Builder builder("entry_computation");
+  HloInstruction* x = builder.AddInstruction(HloInstruction::CreateParameter(
+      /*parameter_number=*/0, f32_2x2_, /*name=*/"x"));
+  HloInstruction* y = builder.AddInstruction(HloInstruction::CreateParameter(
+      /*parameter_number=*/1, f32_2x2_, /*name=*/"y"));
+  HloInstruction* start0 =
+      AddAllReduceStart(&builder, x, reduction_computation);
+  HloInstruction* done0 = builder.AddInstruction(
+      HloInstruction::CreateUnary(f32_2x2_, HloOpcode::kAllReduceDone, start0));
+  HloInstruction* start1 =
+      AddAllReduceStart(&builder, y, reduction_computation);
+  HloInstruction* done1 = builder.AddInstruction(
+      HloInstruction::CreateUnary(f32_2x2_, HloOpcode::kAllReduceDone, start1));
+  builder.AddInstruction(
+      HloInstruction::CreateBinary(f32_2x2_, HloOpcode::kAdd, done0, done1));
+  module->AddEntryComputation(builder.Build());
+  std::unique_ptr<StreamAssignment> streams = AssignStreams(*module);
+
+  // Without a memory limit both all-reduces are in flight at once.
+  std::unique_ptr<HloOrdering> order =
+      BuildGpuHloSchedule(module.get(), *streams)->ConsumeHloOrdering();
+  VLOG(2) << order->ToString();
+  EXPECT_TRUE(order->ExecutesBefore(start0, done1));
+  EXPECT_TRUE(order->ExecutesBefore(start1, done0));
+
+  // The buffers of a single all-reduce start fill the limit, so the first
+  // all-reduce is waited on before the second one starts.
+  SetLatencyHidingOptions(module.get(), /*enable=*/true,
+                          /*memory_limit_bytes=*/2 *
+                              ShapeUtil::ByteSizeOf(f32_2x2_));
+  order = BuildGpuHloSchedule(module.get(), *streams)->ConsumeHloOrdering();
+  VLOG(2) << order->ToString();
+  if (order->ExecutesBefore(start0, start1)) {
+    EXPECT_TRUE(order->ExecutesBefore(done0, start1));
+  } else {
+    EXPECT_TRUE(order->ExecutesBefore(done1, start0));
+  }
+}
+
 }  // namespace gpu
 }  // namespace xla
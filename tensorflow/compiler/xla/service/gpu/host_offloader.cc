@@ -0,0 +1,206 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/host_offloader.h"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/cleanup/cleanup.h"
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_constants.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_hlo_cost_analysis.h"
+#include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/service/hlo_memory_scheduler.h"
+#include "tensorflow/compiler/xla/service/hlo_opcode.h"
+#include "tensorflow/compiler/xla/service/memory_space_assignment.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/compiler/xla/status_macros.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+// Rates at which the cost model assumes the GPU runs instructions. Like in
+// GpuHloSchedule, these describe a typical data-center GPU rather than the one
+// the module is compiled for.
+constexpr float kFlopsPerSecond = 1e14;
+constexpr float kBytesPerSecond = 1e12;
+
+// An offload of `instr` to host memory between the instructions at schedule
+// positions `gap_begin` and `gap_end`.
+struct Offload {
+  HloInstruction* instr;
+  int64_t gap_begin;
+  int64_t gap_end;
+};
+
+// Returns true if `instr` owns a buffer that could move to host memory.
+bool IsOffloadCandidate(const HloInstruction& instr, int64_t min_size_bytes,
+                        int64_t pointer_size) {
+  switch (instr.opcode()) {
+    // These don't define a buffer of their own, or one the executable owns.
+    case HloOpcode::kParameter:
+    case HloOpcode::kConstant:
+    case HloOpcode::kGetTupleElement:
+    case HloOpcode::kBitcast:
+    case HloOpcode::kTuple:
+      return false;
+    default:
+      break;
+  }
+  if (!instr.shape().IsArray() ||
+      instr.shape().layout().memory_space() != Layout::kDefaultMemorySpace) {
+    return false;
+  }
+  // Buffers that are live out, or aliased by a tuple, stay in device memory.
+  if (instr.IsRoot() ||
+      absl::c_any_of(instr.users(), [](const HloInstruction* user) {
+        return user->opcode() == HloOpcode::kTuple;
+      })) {
+    return false;
+  }
+  return ShapeUtil::ByteSizeOf(instr.shape(), pointer_size) >= min_size_bytes;
+}
+
+}  // namespace
+
+StatusOr<bool> HostOffloader::Run(HloModule* module) {
+  TF_RET_CHECK(!module->has_schedule());
+  auto shape_size = [this](const Shape& shape) {
+    return ShapeUtil::ByteSizeOf(shape, pointer_size_);
+  };
+
+  // Plan against the sequence the GPU compiler will schedule. Inserting the
+  // copies invalidates it; the GPU compiler schedules the module again.
+  TF_ASSIGN_OR_RETURN(
+      HloSchedule schedule,
+      ScheduleModule(
+          module,
+          [&](const BufferValue& buffer) { return shape_size(buffer.shape()); },
+          ComputationSchedulerToModuleScheduler(DefaultMemoryScheduler)));
+  TF_RETURN_IF_ERROR(module->set_schedule(std::move(schedule)));
+  auto clear_schedule =
+      absl::MakeCleanup([module] { module->clear_schedule(); });
+
+  HloComputation* entry = module->entry_computation();
+  HloCostAnalysis::Options cost_options{shape_size};
+  cost_options.set_flops_per_second(kFlopsPerSecond);
+  cost_options.set_bytes_per_second(kBytesPerSecond);
+  GpuHloCostAnalysis cost_analysis(cost_options);
+  TF_RETURN_IF_ERROR(entry->Accept(&cost_analysis));
+
+  memory_space_assignment::Options msa_options;
+  msa_options.async_copy_bandwidth_bytes_per_second =
+      options_.host_bandwidth_bytes_per_second;
+  TF_ASSIGN_OR_RETURN(
+      auto msa_cost_analysis,
+      memory_space_assignment::MemorySpaceAssignmentCostAnalysis::Create(
+          cost_analysis, msa_options, *module));
+
+  const std::vector<HloInstruction*> sequence =
+      module->schedule().sequence(entry).instructions();
+  absl::flat_hash_map<const HloInstruction*, int64_t> position;
+  // elapsed_before[i] is the estimated time to run sequence[0..i).
+  std::vector<double> elapsed_before(sequence.size() + 1, 0.0);
+  for (int64_t i = 0; i < sequence.size(); ++i) {
+    position[sequence[i]] = i;
+    elapsed_before[i + 1] =
+        elapsed_before[i] +
+        msa_cost_analysis->GetInstructionElapsed(*sequence[i]);
+  }
+
+  std::vector<Offload> offloads;
+  for (int64_t i = 0; i < sequence.size(); ++i) {
+    HloInstruction* instr = sequence[i];
+    if (!IsOffloadCandidate(*instr, options_.min_size_bytes, pointer_size_)) {
+      continue;
+    }
+    // The definition and uses of the buffer, in schedule order.
+    std::vector<int64_t> accesses = {i};
+    for (const HloInstruction* user : instr->users()) {
+      accesses.push_back(position.at(user));
+    }
+    absl::c_sort(accesses);
+    accesses.erase(std::unique(accesses.begin(), accesses.end()),
+                   accesses.end());
+
+    // The longest gap between two consecutive accesses.
+    Offload best{instr, 0, 0};
+    double best_idle_seconds = 0;
+    for (int64_t k = 1; k < accesses.size(); ++k) {
+      const double idle_seconds =
+          elapsed_before[accesses[k]] - elapsed_before[accesses[k - 1] + 1];
+      if (idle_seconds > best_idle_seconds) {
+        best = Offload{instr, accesses[k - 1], accesses[k]};
+        best_idle_seconds = idle_seconds;
+      }
+    }
+    const double round_trip_seconds =
+        2 * msa_cost_analysis->GetAsyncCopyElapsed(instr->shape());
+    if (best_idle_seconds > 0 &&
+        best_idle_seconds >=
+            options_.min_idle_to_copy_ratio * round_trip_seconds) {
+      offloads.push_back(best);
+    }
+  }
+
+  for (const Offload& offload : offloads) {
+    HloInstruction* instr = offload.instr;
+    VLOG(2) << "Offloading " << instr->name() << " to host memory between "
+            << sequence[offload.gap_begin]->name() << " and "
+            << sequence[offload.gap_end]->name();
+    Shape host_shape = instr->shape();
+    host_shape.mutable_layout()->set_memory_space(kHostMemorySpace);
+    HloInstruction* evict = entry->AddInstruction(
+        HloInstruction::CreateUnary(host_shape, HloOpcode::kCopy, instr));
+    HloInstruction* prefetch = entry->AddInstruction(
+        HloInstruction::CreateUnary(instr->shape(), HloOpcode::kCopy, evict));
+
+    std::vector<HloInstruction*> late_users;
+    for (HloInstruction* user : instr->users()) {
+      if (user != evict && position.at(user) >= offload.gap_end) {
+        late_users.push_back(user);
+      }
+    }
+    for (HloInstruction* user : late_users) {
+      TF_RETURN_IF_ERROR(instr->ReplaceUseWith(user, prefetch));
+    }
+
+    // Evict right after the last access before the gap, and prefetch right
+    // before the first access after it.
+    if (offload.gap_begin != position.at(instr)) {
+      TF_RETURN_IF_ERROR(
+          sequence[offload.gap_begin]->AddControlDependencyTo(evict));
+    }
+    for (int64_t j = offload.gap_begin + 1; j < offload.gap_end; ++j) {
+      if (sequence[j]->opcode() != HloOpcode::kParameter &&
+          sequence[j]->opcode() != HloOpcode::kConstant) {
+        TF_RETURN_IF_ERROR(evict->AddControlDependencyTo(sequence[j]));
+        break;
+      }
+    }
+    TF_RETURN_IF_ERROR(
+        sequence[offload.gap_end - 1]->AddControlDependencyTo(prefetch));
+  }
+  return !offloads.empty();
+}
+
+}  // namespace gpu
+}  // namespace xla
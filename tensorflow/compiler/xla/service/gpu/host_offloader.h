@@ -0,0 +1,86 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_HOST_OFFLOADER_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_HOST_OFFLOADER_H_
+
+#include "tensorflow/compiler/xla/service/hlo_module.h"
+#include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
+
+namespace xla {
+namespace gpu {
+
+struct HostOffloaderOptions {
+  // Buffers smaller than this stay in device memory.
+  int64_t min_size_bytes = int64_t{16} << 20;
+  // Minimum ratio of the estimated compute within a gap to the estimated time
+  // of evicting the buffer and prefetching it back.
+  float min_idle_to_copy_ratio = 4.0;
+  // Bandwidth of copies between device and pinned host memory.
+  float host_bandwidth_bytes_per_second = 16e9;
+};
+
+// Offloads large buffers of the entry computation that go unused for a long
+// stretch of the schedule (optimizer states, activations kept for the
+// backward pass) to pinned host memory, so that models whose working set
+// exceeds device memory can still run. Transforms
+//
+//   a = f32[...] fusion(...)
+//   b = ... use(a)
+//   ... long-running independent work ...
+//   c = ... use(a)
+//
+// into
+//
+//   a = f32[...] fusion(...)
+//   b = ... use(a)
+//   evict = f32[...]{...:S(1)} copy(a)
+//   ... long-running independent work ...
+//   prefetch = f32[...] copy(evict)
+//   c = ... use(prefetch)
+//
+// where S(1) is kHostMemorySpace. Control dependencies pin the eviction right
+// after the last use before the gap and the prefetch right before the first
+// use after it, so that the device buffer is free for the whole gap.
+//
+// This is the inverse of MemorySpaceAssignment, which moves buffers into a
+// small fast memory; it reuses MemorySpaceAssignmentCostAnalysis to estimate
+// how long a gap and a round trip over the host link take. A buffer is only
+// offloaded over the longest gap between its uses, and only if the compute in
+// that gap is at least `min_idle_to_copy_ratio` times the round trip.
+//
+// The copies run on the compute stream, so their cost is not hidden; the
+// ratio bounds the slowdown instead. Runs last, after copy insertion, on a
+// module that has no schedule yet.
+class HostOffloader : public HloModulePass {
+ public:
+  explicit HostOffloader(
+      int64_t pointer_size,
+      HostOffloaderOptions options = HostOffloaderOptions())
+      : pointer_size_(pointer_size), options_(options) {}
+
+  absl::string_view name() const override { return "host-offloader"; }
+
+  StatusOr<bool> Run(HloModule* module) override;
+
+ private:
+  int64_t pointer_size_;
+  HostOffloaderOptions options_;
+};
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_HOST_OFFLOADER_H_
@@ -0,0 +1,109 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/host_offloader.h"
+
+#include "tensorflow/compiler/xla/service/gpu/gpu_constants.h"
+#include "tensorflow/compiler/xla/service/hlo_matchers.h"
+#include "tensorflow/compiler/xla/test.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+namespace op = xla::testing::opcode_matchers;
+
+constexpr int64_t kPointerSize = 8;
+
+class HostOffloaderTest : public HloTestBase {
+ protected:
+  // `exp` is read by `sum` early and by `root` at the very end, with a chain
+  // of dots in between that doesn't depend on it.
+  static constexpr char kHloText[] = R"(
+  HloModule test
+
+  add {
+    x = f32[] parameter(0)
+    y = f32[] parameter(1)
+    ROOT add = f32[] add(x, y)
+  }
+
+  ENTRY main {
+    p0 = f32[1024,256]{1,0} parameter(0)
+    p1 = f32[256,256]{1,0} parameter(1)
+    exp = f32[1024,256]{1,0} exponential(p0)
+    zero = f32[] constant(0)
+    sum = f32[] reduce(exp, zero), dimensions={0,1}, to_apply=add
+    scale = f32[256,256]{1,0} broadcast(sum), dimensions={}
+    q = f32[256,256]{1,0} multiply(p1, scale)
+    d1 = f32[256,256]{1,0} dot(q, q), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+    d2 = f32[256,256]{1,0} dot(d1, d1), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+    d3 = f32[256,256]{1,0} dot(d2, d2), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+    m = f32[1024,256]{1,0} dot(p0, d3), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+    ROOT root = f32[1024,256]{1,0} add(exp, m)
+  }
+  )";
+};
+
+TEST_F(HostOffloaderTest, OffloadsBufferAcrossLongGap) {
+  auto module = ParseAndReturnVerifiedModule(kHloText).ValueOrDie();
+  HostOffloaderOptions options;
+  options.min_size_bytes = 1 << 20;
+  options.min_idle_to_copy_ratio = 0;
+  ASSERT_TRUE(
+      HostOffloader(kPointerSize, options).Run(module.get()).ValueOrDie());
+  EXPECT_FALSE(module->has_schedule());
+
+  const HloInstruction* root = module->entry_computation()->root_instruction();
+  EXPECT_THAT(root,
+              op::Add(op::Copy(op::Copy(op::Exp())), op::Dot()));
+  const HloInstruction* prefetch = root->operand(0);
+  const HloInstruction* evict = prefetch->operand(0);
+  EXPECT_EQ(evict->shape().layout().memory_space(), kHostMemorySpace);
+  EXPECT_EQ(prefetch->shape().layout().memory_space(),
+            Layout::kDefaultMemorySpace);
+
+  // The early use still reads the device buffer, and the copies are pinned to
+  // the ends of the gap.
+  const HloInstruction* exp = evict->operand(0);
+  EXPECT_THAT(exp->users(), ::testing::UnorderedElementsAre(
+                                 op::Reduce(), evict));
+  EXPECT_THAT(evict->control_predecessors(),
+              ::testing::ElementsAre(op::Reduce()));
+  EXPECT_EQ(evict->control_successors().size(), 1);
+  EXPECT_EQ(prefetch->control_predecessors().size(), 1);
+}
+
+TEST_F(HostOffloaderTest, KeepsBufferWhenCopiesCostMoreThanGap) {
+  auto module = ParseAndReturnVerifiedModule(kHloText).ValueOrDie();
+  HostOffloaderOptions options;
+  options.min_size_bytes = 1 << 20;
+  // A 1 MiB round trip takes ~130us at 16 GB/s, far longer than the dots.
+  EXPECT_FALSE(
+      HostOffloader(kPointerSize, options).Run(module.get()).ValueOrDie());
+}
+
+TEST_F(HostOffloaderTest, KeepsSmallBuffers) {
+  auto module = ParseAndReturnVerifiedModule(kHloText).ValueOrDie();
+  HostOffloaderOptions options;
+  options.min_idle_to_copy_ratio = 0;
+  EXPECT_FALSE(
+      HostOffloader(kPointerSize, options).Run(module.get()).ValueOrDie());
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
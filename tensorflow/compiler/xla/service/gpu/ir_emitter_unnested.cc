@@ -76,6 +76,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/gpu/for_thunk.h"
 #include "tensorflow/compiler/xla/service/gpu/gemm_thunk.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_asm_opts_util.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_fusible.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_constants.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_conv_runner.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_executable.h"
@@ -1586,6 +1587,40 @@ Status IrEmitterUnnested::EmitTriangularSolveCustomCall(mlir::Operation* op) {
   }
   return Status::OK();
 }
+
+Status IrEmitterUnnested::EmitGroupedGemmCustomCall(mlir::Operation* op) {
+  auto custom_call = mlir::cast<mlir::lmhlo::CustomCallOp>(op);
+  auto args = custom_call.args();
+  auto outputs = custom_call.output();
+  const int64_t group_size = outputs.size();
+  TF_RET_CHECK(group_size > 0 && args.size() == 2 * group_size);
+
+  std::vector<BufferAllocation::Slice> lhs_slices, rhs_slices, output_slices;
+  for (int64_t i = 0; i < group_size; ++i) {
+    TF_ASSIGN_OR_RETURN(BufferAllocation::Slice lhs,
+                        GetAllocationSlice(args[i]));
+    TF_ASSIGN_OR_RETURN(BufferAllocation::Slice rhs,
+                        GetAllocationSlice(args[group_size + i]));
+    TF_ASSIGN_OR_RETURN(BufferAllocation::Slice output,
+                        GetAllocationSlice(outputs[i]));
+    lhs_slices.push_back(lhs);
+    rhs_slices.push_back(rhs);
+    output_slices.push_back(output);
+  }
+
+  // All GEMMs of the group have the same shapes and config.
+  GpuGemmConfig config;
+  config.lhs_shape = GetShape(args[0]);
+  config.rhs_shape = GetShape(args[group_size]);
+  config.output_shape = GetShape(outputs[0]);
+  TF_RETURN_IF_ERROR(tensorflow::HumanReadableJsonToProto(
+      custom_call.backend_config().str(), &config.backend_config));
+
+  AddThunkToThunkSequence(absl::make_unique<GroupedGemmThunk>(
+      GetThunkInfo(op), std::move(config), std::move(lhs_slices),
+      std::move(rhs_slices), std::move(output_slices)));
+  return Status::OK();
+}
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
 // Convert the following form of fusion region:
@@ -1761,6 +1796,13 @@ static bool HasAnyUnnestedReductionRoot(mlir::lmhlo::FusionOp fusion) {
   });
 }
 
+// Returns whether the fusion has a reduce op at the top level of its region.
+static bool HasReduceOp(mlir::lmhlo::FusionOp fusion) {
+  return absl::c_any_of(fusion.region().front(), [](mlir::Operation& op) {
+    return mlir::isa<mlir::mhlo::ReduceOp>(op);
+  });
+}
+
 Status IrEmitterUnnested::EmitFusion(mlir::Operation* op) {
   auto fusion_op = mlir::cast<mlir::lmhlo::FusionOp>(op);
   const bool is_single_instruction = IsSingleInstructionFusion(fusion_op);
@@ -1769,6 +1811,16 @@ Status IrEmitterUnnested::EmitFusion(mlir::Operation* op) {
     return EmitUnnestedReduction(fusion_op);
   }
 
+  if (HasReduceOp(fusion_op) && fusion_op.getFusionResults().size() == 1) {
+    TF_ASSIGN_OR_RETURN(
+        const HloComputation* fused_computation,
+        GetOrCreateSubComputationFromRegion(&fusion_op.region(),
+                                            /*is_fusion=*/true));
+    if (IsReductionEpilogueFusion(*fused_computation)) {
+      return EmitReductionEpilogueFusion(fusion_op, fused_computation);
+    }
+  }
+
   llvm::SmallVector<mlir::Value, 6> fusion_results =
       fusion_op.getFusionResults();
   TF_RET_CHECK(!fusion_results.empty());
@@ -5345,6 +5397,230 @@ Status IrEmitterUnnested::EmitUnnestedReduction(mlir::lmhlo::FusionOp fusion) {
   return Status::OK();
 }
 
+Status IrEmitterUnnested::EmitReductionEpilogueFusion(
+    mlir::lmhlo::FusionOp fusion, const HloComputation* fused_computation) {
+  const HloInstruction* root = fused_computation->root_instruction();
+  const Shape& row_shape = root->shape();
+  const int64_t rank = row_shape.rank();
+  const int64_t num_cols = row_shape.dimensions(rank - 1);
+  const int64_t num_rows = ShapeUtil::ElementsIn(row_shape) / num_cols;
+  const GpuDeviceInfo& device_info = ir_emitter_context_->gpu_device_info();
+
+  // Thread `t` of a block handles the columns t, t + threads_per_block, ... of
+  // its row in every pass over the row. Blocks loop over rows if there are
+  // more rows than blocks.
+  const int64_t threads_per_block =
+      std::min<int64_t>(RoundUpTo<int64_t>(num_cols, WarpSize()),
+                        device_info.threads_per_block_limit);
+  const int64_t num_warps = threads_per_block / WarpSize();
+  const int64_t num_blocks =
+      std::min<int64_t>(num_rows, device_info.block_dim_limit_x);
+  LaunchDimensions launch_dimensions(num_blocks, threads_per_block);
+
+  std::vector<llvm_ir::IrArray> ir_arrays;
+  TF_ASSIGN_OR_RETURN(std::unique_ptr<Thunk> kernel_thunk,
+                      BuildKernelThunk(fusion, GetThunkInfo(fusion),
+                                       &ir_arrays, launch_dimensions));
+  AddThunkToThunkSequence(std::move(kernel_thunk));
+  const int num_inputs = fusion.getInputBuffers().size();
+  const IrArray& output_array = ir_arrays[num_inputs];
+
+  llvm::Type* index_ty = GetIndexTypeForKernel(
+      fusion,
+      std::max(launch_dimensions.launch_bound(),
+               ShapeUtil::ElementsIn(row_shape)),
+      &b_);
+  auto constant = [&](int64_t c) -> llvm::Constant* {
+    return llvm::ConstantInt::get(index_ty, c);
+  };
+  auto is_zero = [&](llvm::Value* value) {
+    return b_.CreateICmpEQ(value, constant(0));
+  };
+
+  GpuElementalIrEmitter elemental_emitter(hlo_module_config_, module_, &b_,
+                                          GetNestedComputer());
+  FusedIrEmitter fused_emitter(elemental_emitter);
+
+  // Per reduction: the per-warp partial results and the result for the
+  // current row.
+  struct ReductionState {
+    const HloInstruction* reduce;
+    llvm::Type* element_type;
+    llvm::GlobalVariable* warp_results;
+    llvm::GlobalVariable* result;
+  };
+  std::vector<ReductionState> reductions;
+  int64_t shared_memory_bytes = 0;
+  for (const HloInstruction* instr :
+       fused_computation->MakeInstructionPostOrder()) {
+    if (instr->opcode() != HloOpcode::kReduce) {
+      continue;
+    }
+    PrimitiveType type = instr->shape().element_type();
+    llvm::Type* element_type = llvm_ir::PrimitiveTypeToIrType(type, module_);
+    llvm::GlobalVariable* warp_results = llvm_ir::AllocateSharedMemoryTile(
+        module_, llvm::ArrayType::get(element_type, num_warps),
+        StrCat(llvm_ir::IrName(instr), "_warp_results"));
+    llvm::GlobalVariable* result = llvm_ir::AllocateSharedMemoryTile(
+        module_, llvm::ArrayType::get(element_type, 1),
+        StrCat(llvm_ir::IrName(instr), "_result"));
+    shared_memory_bytes +=
+        (num_warps + 1) * ShapeUtil::ByteSizeOfPrimitiveType(type);
+    reductions.push_back({instr, element_type, warp_results, result});
+    fused_emitter.BindGenerator(
+        *instr, [this, result](const IrArray::Index&) -> llvm::Value* {
+          return Load(InBoundsGEP(result, {b_.getInt32(0), b_.getInt32(0)}),
+                      "reduction_result");
+        });
+  }
+
+  // Row-shaped parameters are cached in shared memory while they fit. Each
+  // thread only reads back the columns it cached itself, so filling the cache
+  // needs no barrier.
+  std::vector<std::pair<int, llvm::GlobalVariable*>> row_caches;
+  for (int i = 0; i < num_inputs; ++i) {
+    const HloInstruction* parameter =
+        fused_computation->parameter_instruction(i);
+    const IrArray& array = ir_arrays[i];
+    PrimitiveType type = parameter->shape().element_type();
+    int64_t row_bytes = num_cols * ShapeUtil::ByteSizeOfPrimitiveType(type);
+    if (ShapeUtil::SameDimensions(parameter->shape(), row_shape) &&
+        shared_memory_bytes + row_bytes <=
+            device_info.shared_memory_per_block) {
+      shared_memory_bytes += row_bytes;
+      llvm::GlobalVariable* row_cache = llvm_ir::AllocateSharedMemoryTile(
+          module_,
+          llvm::ArrayType::get(llvm_ir::PrimitiveTypeToIrType(type, module_),
+                               num_cols),
+          StrCat(llvm_ir::IrName(parameter), "_row_cache"));
+      row_caches.emplace_back(i, row_cache);
+      fused_emitter.BindGenerator(
+          *parameter,
+          [this, row_cache, rank](const IrArray::Index& index) -> llvm::Value* {
+            return Load(
+                InBoundsGEP(row_cache, {index.GetConstantWithIndexType(0),
+                                        index[rank - 1]}),
+                "cached_element");
+          });
+    } else {
+      fused_emitter.BindGenerator(
+          *parameter, [this, &array, parameter](const IrArray::Index& index) {
+            return array.EmitReadArrayElement(index, &b_, parameter->name());
+          });
+    }
+  }
+
+  llvm::Value* thread_id = EmitThreadId(threads_per_block, index_ty);
+  llvm::Value* lane_id =
+      b_.CreateURem(thread_id, constant(WarpSize()), "lane_id");
+  llvm::Value* warp_id =
+      b_.CreateUDiv(thread_id, constant(WarpSize()), "warp_id");
+  llvm::Value* block_id = EmitBlockId(num_blocks, index_ty);
+  Shape rows_shape = ShapeUtil::MakeShapeWithDescendingLayout(
+      row_shape.element_type(), row_shape.dimensions().subspan(0, rank - 1));
+
+  KernelSupportLibrary ksl(&b_);
+  return ksl.ForWithStatus(
+      "row", block_id, constant(num_rows), constant(num_blocks),
+      [&](llvm::Value* row) -> Status {
+        std::vector<llvm::Value*> row_multidim;
+        if (rank > 1) {
+          row_multidim = IrArray::Index(row, rows_shape, &b_).multidim();
+        }
+        auto for_each_column =
+            [&](absl::string_view name,
+                const std::function<Status(const IrArray::Index&)>& body) {
+              return ksl.ForWithStatus(
+                  name, thread_id, constant(num_cols),
+                  constant(threads_per_block),
+                  [&](llvm::Value* col) -> Status {
+                    std::vector<llvm::Value*> multidim = row_multidim;
+                    multidim.push_back(col);
+                    return body(IrArray::Index(multidim, row_shape, index_ty));
+                  });
+            };
+
+        for (const auto& row_cache : row_caches) {
+          TF_RETURN_IF_ERROR(for_each_column(
+              "fill_row_cache", [&](const IrArray::Index& index) {
+                llvm::Value* value =
+                    ir_arrays[row_cache.first].EmitReadArrayElement(index,
+                                                                    &b_);
+                Store(value, InBoundsGEP(row_cache.second,
+                                         {index.GetConstantWithIndexType(0),
+                                          index[rank - 1]}));
+                return Status::OK();
+              }));
+        }
+
+        for (const ReductionState& state : reductions) {
+          const HloComputation* reducer = state.reduce->to_apply();
+          TF_ASSIGN_OR_RETURN(
+              llvm_ir::ElementGenerator init_gen,
+              fused_emitter.GetGenerator(*state.reduce->operand(1)));
+          TF_ASSIGN_OR_RETURN(llvm::Value * init_value,
+                              init_gen(IrArray::Index(index_ty)));
+          llvm::Value* partial_result = llvm_ir::EmitAllocaAtFunctionEntry(
+              state.element_type, "partial_reduction_result", &b_);
+          llvm::Value* input_address = llvm_ir::EmitAllocaAtFunctionEntry(
+              state.element_type, "reduction_input_address", &b_);
+          Store(init_value, partial_result);
+
+          // Each thread reduces its columns.
+          TF_ASSIGN_OR_RETURN(
+              llvm_ir::ElementGenerator input_gen,
+              fused_emitter.GetGenerator(*state.reduce->operand(0)));
+          TF_RETURN_IF_ERROR(for_each_column(
+              "reduce_columns", [&](const IrArray::Index& index) -> Status {
+                TF_ASSIGN_OR_RETURN(llvm::Value * input, input_gen(index));
+                Store(input, input_address);
+                TF_ASSIGN_OR_RETURN(std::vector<llvm::Value*> results,
+                                    ComputeNestedElementFromAddrs(
+                                        *reducer,
+                                        {partial_result, input_address}));
+                Store(results[0], partial_result);
+                return Status::OK();
+              }));
+
+          // Then each warp, then the first warp reduces the warps' results.
+          EmitFullWarpShuffleDownLoopForReduce(reducer, {partial_result},
+                                               threads_per_block);
+          ksl.If("write_warp_result", is_zero(lane_id), [&] {
+            Store(Load(partial_result),
+                  InBoundsGEP(state.warp_results, {constant(0), warp_id}));
+          });
+          EmitSyncThreads();
+          ksl.If("reduce_warp_results", is_zero(warp_id), [&] {
+            llvm::Value* initial_value_address =
+                CastSharedToGlobal(llvm_ir::EmitAllocaAtFunctionEntry(
+                    state.element_type, "initial_value_address", &b_));
+            Store(init_value, initial_value_address);
+            llvm::Value* warp_result_address = CastSharedToGlobal(
+                InBoundsGEP(state.warp_results, {constant(0), lane_id}));
+            llvm::Value* selected_address = b_.CreateSelect(
+                b_.CreateICmpULT(lane_id, constant(num_warps)),
+                warp_result_address, initial_value_address);
+            EmitFullWarpShuffleDownLoopForReduce(reducer, {selected_address},
+                                                 threads_per_block);
+            ksl.If("write_result", is_zero(thread_id), [&] {
+              Store(Load(selected_address),
+                    InBoundsGEP(state.result, {constant(0), constant(0)}));
+            });
+          });
+          EmitSyncThreads();
+        }
+
+        TF_ASSIGN_OR_RETURN(llvm_ir::ElementGenerator root_gen,
+                            fused_emitter.GetGenerator(*root));
+        return for_each_column(
+            "epilogue", [&](const IrArray::Index& index) -> Status {
+              TF_ASSIGN_OR_RETURN(llvm::Value * value, root_gen(index));
+              output_array.EmitWriteArrayElement(index, value, &b_);
+              return Status::OK();
+            });
+      });
+}
+
 // Emits code for slices based on the below structure. An if statement with
 // a guarding condition is generated for each ROOT slice.
 //
@@ -5497,6 +5773,9 @@ Status IrEmitterUnnested::EmitOp(mlir::Operation* op) {
     if (call.call_target_name() == kTriangularSolveCallTarget) {
       return EmitTriangularSolveCustomCall(op);
     }
+    if (call.call_target_name() == kGroupedGemmCallTarget) {
+      return EmitGroupedGemmCustomCall(op);
+    }
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
     return EmitCustomCallThunk(op);
@@ -191,6 +191,7 @@ class IrEmitterUnnested : public IrEmitter {
   Status EmitSort(mlir::Operation* op);
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
   Status EmitTriangularSolveCustomCall(mlir::Operation* op);
+  Status EmitGroupedGemmCustomCall(mlir::Operation* op);
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
   template <typename NcclThunkType, typename OpTy>
@@ -418,6 +419,14 @@ class IrEmitterUnnested : public IrEmitter {
   // different groups can be run in parallel.
   Status EmitUnnestedReduction(mlir::lmhlo::FusionOp fusion);
 
+  // Emits a reduction-epilogue fusion (see IsReductionEpilogueFusion) as a
+  // single kernel with one thread block per row. Each reduction is computed by
+  // the whole block and kept in shared memory for the reductions and the
+  // elementwise epilogue that follow. Row-shaped inputs are cached in shared
+  // memory when the row fits, so they are read from global memory only once.
+  Status EmitReductionEpilogueFusion(mlir::lmhlo::FusionOp fusion,
+                                     const HloComputation* fused_computation);
+
   // Computes the KernelMappingScheme for the reduce HLO and indicates whether
   // the reduction is a row reduction. For an un-fused reduce op, unnested_hlo
   // and first_reduce are the same instruction. For a kInput fusion,
@@ -33,6 +33,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/gpu/cudnn_vectorize_convolutions.h"
 #include "tensorflow/compiler/xla/service/gpu/cusolver_rewriter.h"
 #include "tensorflow/compiler/xla/service/gpu/gemm_algorithm_picker.h"
+#include "tensorflow/compiler/xla/service/gpu/gemm_grouper.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_asm_opts_util.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_conv_padding_legalization.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_conv_rewriter.h"
@@ -155,6 +156,13 @@ Status NVPTXCompiler::OptimizeHloPostLayoutAssignment(
     // memory. XLIR allocates temp memory, and so the custom-call implementation
     // for TriangularSolve is not needed.
     post_pipeline.AddPass<TriangularSolveRewriter>();
+
+    // Group small GEMMs once their algorithms are picked. XLIR doesn't know
+    // the grouped GEMM custom call.
+    if (hlo_module->config().debug_options().xla_gpu_enable_gemm_grouping()) {
+      post_pipeline.AddPass<GemmGrouper>(
+          /*max_size_to_group=*/int64_t{4} << 20);
+    }
   }
 
   TF_RETURN_IF_ERROR(post_pipeline.Run(hlo_module).status());
@@ -0,0 +1,111 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/reduction_epilogue_fusion.h"
+
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_fusible.h"
+#include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/service/hlo_opcode.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+// Returns the instructions that can be fused into a reduction-epilogue fusion
+// rooted at `root`, root first. An instruction joins once all of its users
+// have; operands are revisited whenever one of their users joins, so the
+// result doesn't depend on the visiting order.
+std::vector<HloInstruction*> GrowRegion(HloInstruction* root) {
+  std::vector<HloInstruction*> region = {root};
+  absl::flat_hash_set<const HloInstruction*> in_region = {root};
+  for (int i = 0; i < region.size(); ++i) {
+    for (HloInstruction* operand : region[i]->unique_operands()) {
+      if (in_region.contains(operand) || !operand->IsFusible() ||
+          operand->opcode() == HloOpcode::kParameter ||
+          !IsFusibleIntoReductionEpilogue(*operand, root->shape())) {
+        continue;
+      }
+      if (absl::c_all_of(operand->users(), [&](const HloInstruction* user) {
+            return in_region.contains(user);
+          })) {
+        region.push_back(operand);
+        in_region.insert(operand);
+      }
+    }
+  }
+  return region;
+}
+
+StatusOr<bool> RunOnComputation(HloComputation* computation) {
+  std::vector<HloInstruction*> post_order =
+      computation->MakeInstructionPostOrder();
+  absl::flat_hash_map<const HloInstruction*, int> post_order_index;
+  for (int i = 0; i < post_order.size(); ++i) {
+    post_order_index[post_order[i]] = i;
+  }
+
+  // Instructions that were fused, or that belong to a region without
+  // reductions. The region of any of the latter is a subset of that region,
+  // so it has no reductions either.
+  absl::flat_hash_set<const HloInstruction*> visited;
+  bool changed = false;
+  for (int i = post_order.size() - 1; i >= 0; --i) {
+    HloInstruction* root = post_order[i];
+    if (visited.contains(root) || !IsReductionEpilogueRoot(*root) ||
+        root->shape().dimensions().back() >
+            ReductionEpilogueFusion::kMaxRowLength) {
+      continue;
+    }
+    std::vector<HloInstruction*> region = GrowRegion(root);
+    visited.insert(region.begin(), region.end());
+    if (absl::c_none_of(region, [](const HloInstruction* instr) {
+          return instr->opcode() == HloOpcode::kReduce;
+        })) {
+      continue;
+    }
+    // CreateFusionInstruction wants the instructions in reverse topological
+    // order.
+    absl::c_sort(region, [&](const HloInstruction* a, const HloInstruction* b) {
+      return post_order_index.at(a) > post_order_index.at(b);
+    });
+    HloInstruction* fusion = computation->CreateFusionInstruction(
+        region, HloInstruction::FusionKind::kCustom);
+    VLOG(2) << "Created reduction epilogue fusion: " << fusion->ToString();
+    changed = true;
+  }
+  return changed;
+}
+
+}  // namespace
+
+StatusOr<bool> ReductionEpilogueFusion::Run(HloModule* module) {
+  bool changed = false;
+  for (HloComputation* computation : module->MakeNonfusionComputations()) {
+    TF_ASSIGN_OR_RETURN(bool computation_changed,
+                        RunOnComputation(computation));
+    changed |= computation_changed;
+  }
+  return changed;
+}
+
+}  // namespace gpu
+}  // namespace xla
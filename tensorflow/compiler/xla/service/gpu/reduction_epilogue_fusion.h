@@ -0,0 +1,56 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_REDUCTION_EPILOGUE_FUSION_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_REDUCTION_EPILOGUE_FUSION_H_
+
+#include "tensorflow/compiler/xla/service/hlo_module.h"
+#include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
+
+namespace xla {
+namespace gpu {
+
+// Fuses row reductions with the elementwise consumers of their broadcast
+// results, e.g.
+//
+//   max = reduce(x), dimensions={1}
+//   e = exponential(subtract(x, broadcast(max)))
+//   sum = reduce(e), dimensions={1}
+//   softmax = divide(e, broadcast(sum))
+//
+// into one kCustom fusion. GpuInstructionFusion can't fuse through a reduction
+// whose result is broadcast, so softmax or layer norm would otherwise take
+// several kernels that each read the rows from global memory. See
+// IsReductionEpilogueFusion for the supported instructions.
+//
+// Must run before GpuInstructionFusion, which would otherwise take the
+// reductions' inputs into input fusions.
+class ReductionEpilogueFusion : public HloModulePass {
+ public:
+  // Rows longer than this are left to the regular reduction emitter, which can
+  // split a row across thread blocks.
+  static constexpr int64_t kMaxRowLength = 16384;
+
+  absl::string_view name() const override {
+    return "reduction-epilogue-fusion";
+  }
+
+  StatusOr<bool> Run(HloModule* module) override;
+};
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_REDUCTION_EPILOGUE_FUSION_H_
@@ -0,0 +1,189 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/reduction_epilogue_fusion.h"
+
+#include "tensorflow/compiler/xla/service/hlo_matchers.h"
+#include "tensorflow/compiler/xla/service/hlo_parser.h"
+#include "tensorflow/compiler/xla/test.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+namespace op = xla::testing::opcode_matchers;
+
+class ReductionEpilogueFusionTest : public HloTestBase {};
+
+TEST_F(ReductionEpilogueFusionTest, FusesSoftmax) {
+  auto module = ParseAndReturnVerifiedModule(R"(
+  HloModule test
+
+  max_computation {
+    x = f32[] parameter(0)
+    y = f32[] parameter(1)
+    ROOT max = f32[] maximum(x, y)
+  }
+
+  add_computation {
+    x = f32[] parameter(0)
+    y = f32[] parameter(1)
+    ROOT add = f32[] add(x, y)
+  }
+
+  ENTRY entry_computation {
+    param_0 = f32[32,1024]{1,0} parameter(0)
+    neg_inf = f32[] constant(-inf)
+    max = f32[32]{0} reduce(param_0, neg_inf), dimensions={1}, to_apply=max_computation
+    max_broadcast = f32[32,1024]{1,0} broadcast(max), dimensions={0}
+    sub = f32[32,1024]{1,0} subtract(param_0, max_broadcast)
+    exp = f32[32,1024]{1,0} exponential(sub)
+    zero = f32[] constant(0)
+    sum = f32[32]{0} reduce(exp, zero), dimensions={1}, to_apply=add_computation
+    sum_broadcast = f32[32,1024]{1,0} broadcast(sum), dimensions={0}
+    ROOT softmax = f32[32,1024]{1,0} divide(exp, sum_broadcast)
+  }
+  )")
+                    .ValueOrDie();
+  ASSERT_TRUE(ReductionEpilogueFusion().Run(module.get()).ValueOrDie());
+  SCOPED_TRACE(module->ToString());
+  const HloInstruction* root = module->entry_computation()->root_instruction();
+  ASSERT_THAT(root, op::Fusion(op::Parameter()));
+  EXPECT_EQ(root->fusion_kind(), HloInstruction::FusionKind::kCustom);
+  EXPECT_THAT(root->fused_expression_root(),
+              op::Divide(op::Exp(), op::Broadcast(op::Reduce())));
+}
+
+TEST_F(ReductionEpilogueFusionTest, FusesLayerNormWithScaleAndBias) {
+  auto module = ParseAndReturnVerifiedModule(R"(
+  HloModule test
+
+  add_computation {
+    x = f32[] parameter(0)
+    y = f32[] parameter(1)
+    ROOT add = f32[] add(x, y)
+  }
+
+  ENTRY entry_computation {
+    param_0 = f32[8,16,768]{2,1,0} parameter(0)
+    scale = f32[768]{0} parameter(1)
+    bias = f32[768]{0} parameter(2)
+    zero = f32[] constant(0)
+    inv_n = f32[] constant(0.00130208)
+    inv_n_broadcast = f32[8,16]{1,0} broadcast(inv_n), dimensions={}
+    sum = f32[8,16]{1,0} reduce(param_0, zero), dimensions={2}, to_apply=add_computation
+    sum_broadcast = f32[8,16,768]{2,1,0} broadcast(sum), dimensions={0,1}
+    inv_n_row = f32[8,16,768]{2,1,0} broadcast(inv_n), dimensions={}
+    mean = f32[8,16,768]{2,1,0} multiply(sum_broadcast, inv_n_row)
+    centered = f32[8,16,768]{2,1,0} subtract(param_0, mean)
+    square = f32[8,16,768]{2,1,0} multiply(centered, centered)
+    square_sum = f32[8,16]{1,0} reduce(square, zero), dimensions={2}, to_apply=add_computation
+    variance = f32[8,16]{1,0} multiply(square_sum, inv_n_broadcast)
+    epsilon = f32[] constant(1e-5)
+    epsilon_broadcast = f32[8,16]{1,0} broadcast(epsilon), dimensions={}
+    variance_eps = f32[8,16]{1,0} add(variance, epsilon_broadcast)
+    rsqrt = f32[8,16]{1,0} rsqrt(variance_eps)
+    rsqrt_broadcast = f32[8,16,768]{2,1,0} broadcast(rsqrt), dimensions={0,1}
+    normalized = f32[8,16,768]{2,1,0} multiply(centered, rsqrt_broadcast)
+    scale_broadcast = f32[8,16,768]{2,1,0} broadcast(scale), dimensions={2}
+    scaled = f32[8,16,768]{2,1,0} multiply(normalized, scale_broadcast)
+    bias_broadcast = f32[8,16,768]{2,1,0} broadcast(bias), dimensions={2}
+    ROOT out = f32[8,16,768]{2,1,0} add(scaled, bias_broadcast)
+  }
+  )")
+                    .ValueOrDie();
+  ASSERT_TRUE(ReductionEpilogueFusion().Run(module.get()).ValueOrDie());
+  SCOPED_TRACE(module->ToString());
+  const HloInstruction* root = module->entry_computation()->root_instruction();
+  ASSERT_THAT(root, op::Fusion());
+  EXPECT_EQ(root->fusion_kind(), HloInstruction::FusionKind::kCustom);
+  EXPECT_EQ(root->operand_count(), 3);
+  // The mean and variance are computed on reduced rows before being broadcast,
+  // so both reductions and everything in between end up in the fusion.
+  EXPECT_THAT(root->fused_expression_root(),
+              op::Add(op::Multiply(), op::Broadcast(op::Parameter())));
+}
+
+TEST_F(ReductionEpilogueFusionTest, KeepsReductionWithOtherUsersUnfused) {
+  auto module = ParseAndReturnVerifiedModule(R"(
+  HloModule test
+
+  add_computation {
+    x = f32[] parameter(0)
+    y = f32[] parameter(1)
+    ROOT add = f32[] add(x, y)
+  }
+
+  ENTRY entry_computation {
+    param_0 = f32[32,1024]{1,0} parameter(0)
+    zero = f32[] constant(0)
+    sum = f32[32]{0} reduce(param_0, zero), dimensions={1}, to_apply=add_computation
+    sum_broadcast = f32[32,1024]{1,0} broadcast(sum), dimensions={0}
+    divide = f32[32,1024]{1,0} divide(param_0, sum_broadcast)
+    ROOT tuple = (f32[32,1024]{1,0}, f32[32]{0}) tuple(divide, sum)
+  }
+  )")
+                    .ValueOrDie();
+  EXPECT_FALSE(ReductionEpilogueFusion().Run(module.get()).ValueOrDie());
+}
+
+TEST_F(ReductionEpilogueFusionTest, DoesNotFuseColumnReduction) {
+  auto module = ParseAndReturnVerifiedModule(R"(
+  HloModule test
+
+  add_computation {
+    x = f32[] parameter(0)
+    y = f32[] parameter(1)
+    ROOT add = f32[] add(x, y)
+  }
+
+  ENTRY entry_computation {
+    param_0 = f32[1024,32]{1,0} parameter(0)
+    zero = f32[] constant(0)
+    sum = f32[32]{0} reduce(param_0, zero), dimensions={0}, to_apply=add_computation
+    sum_broadcast = f32[1024,32]{1,0} broadcast(sum), dimensions={1}
+    ROOT divide = f32[1024,32]{1,0} divide(param_0, sum_broadcast)
+  }
+  )")
+                    .ValueOrDie();
+  EXPECT_FALSE(ReductionEpilogueFusion().Run(module.get()).ValueOrDie());
+}
+
+TEST_F(ReductionEpilogueFusionTest, DoesNotFuseRowsLongerThanLimit) {
+  auto module = ParseAndReturnVerifiedModule(R"(
+  HloModule test
+
+  add_computation {
+    x = f32[] parameter(0)
+    y = f32[] parameter(1)
+    ROOT add = f32[] add(x, y)
+  }
+
+  ENTRY entry_computation {
+    param_0 = f32[4,32768]{1,0} parameter(0)
+    zero = f32[] constant(0)
+    sum = f32[4]{0} reduce(param_0, zero), dimensions={1}, to_apply=add_computation
+    sum_broadcast = f32[4,32768]{1,0} broadcast(sum), dimensions={0}
+    ROOT divide = f32[4,32768]{1,0} divide(param_0, sum_broadcast)
+  }
+  )")
+                    .ValueOrDie();
+  EXPECT_FALSE(ReductionEpilogueFusion().Run(module.get()).ValueOrDie());
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
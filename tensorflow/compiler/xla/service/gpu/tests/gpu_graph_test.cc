@@ -0,0 +1,91 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <memory>
+#include <utility>
+
+#include "tensorflow/compiler/xla/literal.h"
+#include "tensorflow/compiler/xla/literal_util.h"
+#include "tensorflow/compiler/xla/service/executable.h"
+#include "tensorflow/compiler/xla/service/gpu/tests/gpu_codegen_test.h"
+#include "tensorflow/compiler/xla/tests/literal_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace xla {
+namespace gpu {
+
+namespace {
+
+class GpuGraphTest : public GpuCodegenTest {
+  DebugOptions GetDebugOptionsForTest() override {
+    DebugOptions debug_options = GpuCodegenTest::GetDebugOptionsForTest();
+    debug_options.set_xla_gpu_enable_cuda_graphs(true);
+    return debug_options;
+  }
+};
+
+TEST_F(GpuGraphTest, GemmAndKernels) {
+  const char* hlo_text = R"(
+HloModule GemmAndKernels
+
+ENTRY main {
+  x = f32[32,64] parameter(0)
+  y = f32[64,16] parameter(1)
+  bias = f32[32,16] parameter(2)
+  dot = f32[32,16] dot(x, y), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+  sum = f32[32,16] add(dot, bias)
+  ROOT tanh = f32[32,16] tanh(sum)
+}
+)";
+  EXPECT_TRUE(RunAndCompare(hlo_text, ErrorSpec{1e-4, 1e-4}));
+}
+
+TEST_F(GpuGraphTest, ReplaysWithNewArguments) {
+  const char* hlo_text = R"(
+HloModule ReplaysWithNewArguments
+
+ENTRY main {
+  x = f32[4] parameter(0)
+  y = f32[4] parameter(1)
+  sum = f32[4] add(x, y)
+  ROOT product = f32[4] multiply(sum, x)
+}
+)";
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<VerifiedHloModule> module,
+                          ParseAndReturnVerifiedModule(hlo_text));
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<Executable> executable,
+      test_runner_.CreateExecutable(std::move(module),
+                                    /*run_hlo_passes=*/true));
+
+  // Every execution transfers the arguments to new buffers, which the graph
+  // captured on the first execution has to be updated with.
+  for (float i = 1; i <= 3; ++i) {
+    Literal x = LiteralUtil::CreateR1<float>({i, 2 * i, 3 * i, 4 * i});
+    Literal y = LiteralUtil::CreateR1<float>({1, 2, 3, 4});
+    TF_ASSERT_OK_AND_ASSIGN(
+        Literal result,
+        test_runner_.ExecuteWithExecutable(executable.get(), {&x, &y}));
+    EXPECT_TRUE(LiteralTestUtil::Equal(
+        LiteralUtil::CreateR1<float>({(i + 1) * i, (2 * i + 2) * 2 * i,
+                                      (3 * i + 3) * 3 * i,
+                                      (4 * i + 4) * 4 * i}),
+        result));
+  }
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
@@ -0,0 +1,97 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/tests/gpu_codegen_test.h"
+
+namespace xla {
+namespace gpu {
+
+namespace {
+
+class GpuReductionEpilogueTest : public GpuCodegenTest {};
+
+TEST_F(GpuReductionEpilogueTest, Softmax) {
+  const char* hlo_text = R"(
+HloModule Softmax
+
+%max_f32 {
+  %x = f32[] parameter(0)
+  %y = f32[] parameter(1)
+  ROOT %max = f32[] maximum(%x, %y)
+}
+
+%add_f32 {
+  %x = f32[] parameter(0)
+  %y = f32[] parameter(1)
+  ROOT %add = f32[] add(%x, %y)
+}
+
+ENTRY %main {
+  %param = f32[100,1000] parameter(0)
+  %neg_inf = f32[] constant(-inf)
+  %max = f32[100] reduce(%param, %neg_inf), dimensions={1}, to_apply=%max_f32
+  %max_broadcast = f32[100,1000] broadcast(%max), dimensions={0}
+  %sub = f32[100,1000] subtract(%param, %max_broadcast)
+  %exp = f32[100,1000] exponential(%sub)
+  %zero = f32[] constant(0)
+  %sum = f32[100] reduce(%exp, %zero), dimensions={1}, to_apply=%add_f32
+  %sum_broadcast = f32[100,1000] broadcast(%sum), dimensions={0}
+  ROOT %softmax = f32[100,1000] divide(%exp, %sum_broadcast)
+}
+)";
+  MatchOptimizedHlo(hlo_text, R"(
+// CHECK: fusion({{.*}}), kind=kCustom
+)");
+  EXPECT_TRUE(RunAndCompare(hlo_text, ErrorSpec{1e-5, 1e-5}));
+}
+
+TEST_F(GpuReductionEpilogueTest, RmsNormOfRowLongerThanBlock) {
+  const char* hlo_text = R"(
+HloModule RmsNorm
+
+%add_f32 {
+  %x = f32[] parameter(0)
+  %y = f32[] parameter(1)
+  ROOT %add = f32[] add(%x, %y)
+}
+
+ENTRY %main {
+  %param = f32[4,8,3000] parameter(0)
+  %scale = f32[3000] parameter(1)
+  %square = f32[4,8,3000] multiply(%param, %param)
+  %zero = f32[] constant(0)
+  %sum = f32[4,8] reduce(%square, %zero), dimensions={2}, to_apply=%add_f32
+  %inv_n = f32[] constant(0.000333333)
+  %inv_n_broadcast = f32[4,8] broadcast(%inv_n), dimensions={}
+  %mean = f32[4,8] multiply(%sum, %inv_n_broadcast)
+  %epsilon = f32[] constant(1e-6)
+  %epsilon_broadcast = f32[4,8] broadcast(%epsilon), dimensions={}
+  %mean_eps = f32[4,8] add(%mean, %epsilon_broadcast)
+  %rsqrt = f32[4,8] rsqrt(%mean_eps)
+  %rsqrt_broadcast = f32[4,8,3000] broadcast(%rsqrt), dimensions={0,1}
+  %normalized = f32[4,8,3000] multiply(%param, %rsqrt_broadcast)
+  %scale_broadcast = f32[4,8,3000] broadcast(%scale), dimensions={2}
+  ROOT %out = f32[4,8,3000] multiply(%normalized, %scale_broadcast)
+}
+)";
+  MatchOptimizedHlo(hlo_text, R"(
+// CHECK: fusion({{.*}}), kind=kCustom
+)");
+  EXPECT_TRUE(RunAndCompare(hlo_text, ErrorSpec{1e-4, 1e-4}));
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
@@ -80,6 +80,8 @@ StatusOr<GlobalDeviceId> Thunk::ExecuteParams::GetGlobalDeviceId() const {
       return "kFft";
     case Thunk::kGemm:
       return "kGemm";
+    case Thunk::kGroupedGemm:
+      return "kGroupedGemm";
     case Thunk::kInfeed:
       return "kInfeed";
     case Thunk::kKernel:
@@ -52,6 +52,7 @@ class Thunk {
     kCustomCall,
     kFft,
     kGemm,
+    kGroupedGemm,
     kInfeed,
     kKernel,
     kMemset32BitValue,
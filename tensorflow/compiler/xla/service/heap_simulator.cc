@@ -17,7 +17,6 @@ limitations under the License.
 
 #include <algorithm>
 #include <cstdint>
-#include <functional>
 #include <tuple>
 #include <vector>
 
@@ -631,50 +630,121 @@ void GlobalDecreasingSizeBestFitHeap<BufferType>::Free(const BufferType* buffer,
 
 using Chunk = HeapSimulator::Chunk;
 
+namespace {
+
+// Total order of the nodes in BufferIntervalTree.
+std::tuple<int64_t, int64_t, int64_t> IntervalKey(int64_t start, int64_t end,
+                                                   const Chunk& chunk) {
+  return std::make_tuple(start, end, chunk.offset);
+}
+
+std::tuple<int64_t, int64_t, int64_t> IntervalKey(
+    const BufferIntervalTreeNode& node) {
+  return IntervalKey(node.start, node.end, node.chunk);
+}
+
+// Recomputes the `subtree_end` of `node` from its own end and its children.
+void UpdateSubtreeEnd(BufferIntervalTreeNode* node) {
+  node->subtree_end = node->end;
+  if (node->left) {
+    node->subtree_end = std::max(node->subtree_end, node->left->subtree_end);
+  }
+  if (node->right) {
+    node->subtree_end = std::max(node->subtree_end, node->right->subtree_end);
+  }
+}
+
+}  // namespace
+
+uint64_t BufferIntervalTree::NextPriority() {
+  // SplitMix64.
+  uint64_t z = (priority_state_ += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+void BufferIntervalTree::RotateUp(BufferIntervalTreeNode* node) {
+  // Turn:
+  //        parent                node
+  //        /    \               /    \
+  //     node     c     into     a    parent
+  //     /  \                         /    \
+  //    a    b                       b      c
+  //
+  // or the mirror image if `node` is the right child of `parent`.
+  BufferIntervalTreeNode* parent = node->parent;
+  BufferIntervalTreeNode* grandparent = parent->parent;
+  if (parent->left == node) {
+    parent->left = node->right;
+    if (node->right) {
+      node->right->parent = parent;
+    }
+    node->right = parent;
+  } else {
+    parent->right = node->left;
+    if (node->left) {
+      node->left->parent = parent;
+    }
+    node->left = parent;
+  }
+  parent->parent = node;
+  node->parent = grandparent;
+  if (grandparent == nullptr) {
+    root_ = node;
+  } else if (grandparent->left == parent) {
+    grandparent->left = node;
+  } else {
+    grandparent->right = node;
+  }
+  // `parent` is now a child of `node`, so it must be fixed up first.
+  UpdateSubtreeEnd(parent);
+  UpdateSubtreeEnd(node);
+}
+
 void BufferIntervalTree::Add(int64_t start, int64_t end, const Chunk& chunk) {
   node_storage_.emplace_back(BufferIntervalTreeNode{
       start, end, end, chunk,
-      /*left=*/nullptr, /*right=*/nullptr, /*parent=*/nullptr});
+      /*left=*/nullptr, /*right=*/nullptr, /*parent=*/nullptr,
+      /*priority=*/NextPriority()});
+  BufferIntervalTreeNode* node = &node_storage_.back();
   if (root_ == nullptr) {
-    root_ = &node_storage_.back();
+    root_ = node;
     // This is root.
     return;
   }
 
+  // Insert as a leaf, as in an ordinary binary search tree.
+  const auto key = IntervalKey(*node);
   BufferIntervalTreeNode* parent = root_;
   while (true) {
     parent->subtree_end = std::max(parent->subtree_end, end);
-    if (parent->start > start) {
-      if (parent->left == nullptr) {
-        parent->left = &node_storage_.back();
-        node_storage_.back().parent = parent;
-        return;
-      }
-      parent = parent->left;
-    } else {
-      if (parent->right == nullptr) {
-        parent->right = &node_storage_.back();
-        node_storage_.back().parent = parent;
-        return;
-      }
-      parent = parent->right;
+    BufferIntervalTreeNode*& child =
+        key < IntervalKey(*parent) ? parent->left : parent->right;
+    if (child == nullptr) {
+      child = node;
+      node->parent = parent;
+      break;
     }
+    parent = child;
+  }
+
+  // Restore the heap order on priorities.
+  while (node->parent != nullptr && node->priority > node->parent->priority) {
+    RotateUp(node);
   }
 }
 
 bool BufferIntervalTree::Remove(int64_t start, int64_t end,
                                 const Chunk& chunk) {
+  const auto key = IntervalKey(start, end, chunk);
   BufferIntervalTreeNode* to_delete = root_;
   while (to_delete != nullptr) {
-    if (to_delete->start == start && to_delete->end == end &&
-        to_delete->chunk.offset == chunk.offset) {
+    const auto node_key = IntervalKey(*to_delete);
+    if (key == node_key) {
       break;
     }
-    if (start < to_delete->start) {
-      to_delete = to_delete->left;
-    } else {
-      to_delete = to_delete->right;
-    }
+    to_delete = key < node_key ? to_delete->left : to_delete->right;
   }
   if (to_delete == nullptr) {
     // Nothing to delete.
@@ -682,109 +752,32 @@ bool BufferIntervalTree::Remove(int64_t start, int64_t end,
   }
   // Found the node to be deleted, enter deletion sequence.
 
-  // Recursively traverse the parents of node and fix up the `subtree_end`
-  // invariant of a node. Recursive lambda need an explicit
-  // std::function declaration.
-  std::function<void(BufferIntervalTreeNode*)> fix_up =
-      [&](BufferIntervalTreeNode* node) {
-        if (node == nullptr) {
-          return;
-        }
-        node->subtree_end = node->end;
-        if (node->left) {
-          node->subtree_end =
-              std::max(node->subtree_end, node->left->subtree_end);
-        }
-        if (node->right) {
-          node->subtree_end =
-              std::max(node->subtree_end, node->right->subtree_end);
-        }
-        // Recursively go up.
-        fix_up(node->parent);
-      };
-
-  if (to_delete->right == nullptr) {
-    // to_delete has no right child, simply move up left child of to_delete if
-    // any.
-    //
-    // Turn:
-    //      parent
-    //       /
-    // to_delete
-    //  /      \
-    // left    nullptr
-    //
-    // Into:
-    //      parent
-    //      /
-    //    left
-    if (root_ == to_delete) {
-      // Deleting root is simply reseting root;
-      root_ = to_delete->left;
-      return true;
-    }
+  // 1. Rotate `to_delete` down until it has at most one child, always lifting
+  // the child with the higher priority so that the heap order holds.
+  while (to_delete->left != nullptr && to_delete->right != nullptr) {
+    RotateUp(to_delete->left->priority > to_delete->right->priority
+                 ? to_delete->left
+                 : to_delete->right);
+  }
 
-    if (to_delete == to_delete->parent->left) {
-      // to_delete is left child of parent.
-      to_delete->parent->left = to_delete->left;
-    }
-    if (to_delete == to_delete->parent->right) {
-      // to_delete is right child of parent.
-      to_delete->parent->right = to_delete->left;
-    }
-    // Rewire parent to the node being moved up.
-    if (to_delete->left) {
-      to_delete->left->parent = to_delete->parent;
-    }
-    // Fix up starting from subroot.
-    fix_up(to_delete);
+  // 2. Splice `to_delete` out by moving its only child (if any) up.
+  BufferIntervalTreeNode* child =
+      to_delete->left != nullptr ? to_delete->left : to_delete->right;
+  BufferIntervalTreeNode* parent = to_delete->parent;
+  if (child != nullptr) {
+    child->parent = parent;
+  }
+  if (parent == nullptr) {
+    root_ = child;
+  } else if (parent->left == to_delete) {
+    parent->left = child;
   } else {
-    // 1. Find left-most node of the right subtree, promote it to the position
-    // of to_delete.
-    BufferIntervalTreeNode* to_promote = to_delete->right;
-    while (to_promote->left != nullptr) {
-      // Go to left-most subtree.
-      to_promote = to_promote->left;
-    }
+    parent->right = child;
+  }
 
-    // 2. Copy the content of `to_promote` to `to_delete`.
-    to_delete->start = to_promote->start;
-    to_delete->end = to_promote->end;
-    // This is incorrect but we will fix this up later in the `fix_up`
-    // procedure.
-    to_delete->subtree_end = to_promote->subtree_end;
-    to_delete->chunk = to_promote->chunk;
-    auto to_promote_parent = to_promote->parent;
-    // 3. Move the right child of `to_promote` up if there is any.
-    //
-    // Turn
-    //
-    // to_delete
-    //         \
-    //        to_promote_parent
-    //         /
-    //    to_promote
-    //          \
-    //          right
-    // into
-    //
-    // to_promote
-    //         \
-    //         to_promote_parent
-    //         /
-    //      right
-    if (to_promote_parent->left == to_promote) {
-      to_promote_parent->left = to_promote->right;
-    } else {
-      to_promote_parent->right = to_promote->right;
-    }
-    if (to_promote->right) {
-      // Set correct parent.
-      to_promote->right->parent = to_promote_parent;
-    }
-    // 4. Recursive fix up the `subtree_end` starting from
-    // `to_promote_parent`.
-    fix_up(to_promote_parent);
+  // 3. Fix up the `subtree_end` invariant on the path to the root.
+  for (; parent != nullptr; parent = parent->parent) {
+    UpdateSubtreeEnd(parent);
   }
   // Don't free the entry in node_storage_ until we free the entire tree.
   return true;
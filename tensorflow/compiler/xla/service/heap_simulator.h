@@ -331,9 +331,15 @@ struct BufferIntervalTreeNode {
   BufferIntervalTreeNode* right;
   // parent
   BufferIntervalTreeNode* parent;
+  // Heap priority used to keep the tree balanced. A node's priority is never
+  // lower than the priority of its children.
+  uint64_t priority;
 };
 
-// An interval tree that can query buffers overlapping in time.
+// An interval tree that can query buffers overlapping in time. Nodes are
+// ordered by (start, end, chunk offset) and balanced as a treap, so Add and
+// Remove take O(log n) expected time and ChunksOverlappingInTime takes
+// O(log n + k) expected time for k overlapping chunks.
 class BufferIntervalTree {
  public:
   using Chunk = HeapSimulator::Chunk;
@@ -351,8 +357,17 @@ class BufferIntervalTree {
   BufferIntervalTreeNode* GetRoot() { return root_; }
 
  private:
+  // Returns the next pseudo-random node priority. The sequence is
+  // deterministic so that buffer assignment is reproducible.
+  uint64_t NextPriority();
+
+  // Rotates `node` above its parent, preserving the in-order sequence and
+  // the `subtree_end` invariant of both nodes.
+  void RotateUp(BufferIntervalTreeNode* node);
+
   BufferIntervalTreeNode* root_ = nullptr;
   std::list<BufferIntervalTreeNode> node_storage_;
+  uint64_t priority_state_ = 0;
 };
 
 // GlobalDecreasingSizeBestFitHeap collects the live intervals of all buffers,
@@ -19,6 +19,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/memory/memory.h"
 #include "tensorflow/compiler/xla/literal.h"
@@ -33,6 +34,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/tests/hlo_test_base.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 
 namespace xla {
 namespace {
@@ -1621,10 +1623,19 @@ TEST_F(IntervalTreeTest, ThreeLevelsRightLeftChunkDifferent) {
   tree.Add(25, 45, chunk2);
   tree.Add(22, 40, chunk3);
   EXPECT_TRUE(tree.Remove(25, 45, chunk2));
-  // Chunk 1 is till the root after removing chunk 2.
+  // Chunk 1 and chunk 3 remain after removing chunk 2.
   EXPECT_EQ(tree.GetRoot()->subtree_end, 40);
-  EXPECT_EQ(tree.GetRoot()->chunk.offset, 1);
-  EXPECT_EQ(tree.GetRoot()->chunk.size, 2);
+  std::vector<HeapSimulator::Chunk> overlapping =
+      tree.ChunksOverlappingInTime(0, 100);
+  ASSERT_EQ(overlapping.size(), 2);
+  absl::c_sort(overlapping, [](const HeapSimulator::Chunk& a,
+                               const HeapSimulator::Chunk& b) {
+    return a.offset < b.offset;
+  });
+  EXPECT_EQ(overlapping[0].offset, 1);
+  EXPECT_EQ(overlapping[0].size, 2);
+  EXPECT_EQ(overlapping[1].offset, 3);
+  EXPECT_EQ(overlapping[1].size, 4);
   EXPECT_TRUE(tree.Remove(20, 36, chunk1));
   // Chunk 3 becomes the root now.
   EXPECT_EQ(tree.GetRoot()->subtree_end, 40);
@@ -1634,5 +1645,108 @@ TEST_F(IntervalTreeTest, ThreeLevelsRightLeftChunkDifferent) {
   ASSERT_EQ(tree.GetRoot(), nullptr);
 }
 
+TEST_F(IntervalTreeTest, IdenticalIntervalsDifferentChunks) {
+  HeapSimulator::Chunk chunk1({0, 10});
+  HeapSimulator::Chunk chunk2({10, 10});
+  BufferIntervalTree tree;
+  tree.Add(5, 10, chunk1);
+  tree.Add(5, 10, chunk2);
+  EXPECT_TRUE(tree.Remove(5, 10, chunk2));
+  EXPECT_FALSE(tree.Remove(5, 10, chunk2));
+  std::vector<HeapSimulator::Chunk> overlapping =
+      tree.ChunksOverlappingInTime(7, 7);
+  ASSERT_EQ(overlapping.size(), 1);
+  EXPECT_EQ(overlapping[0].offset, 0);
+  EXPECT_TRUE(tree.Remove(5, 10, chunk1));
+  ASSERT_EQ(tree.GetRoot(), nullptr);
+}
+
+// Returns the height of the subtree rooted at `node` after checking that the
+// ordering, parent, priority and `subtree_end` invariants hold.
+int64_t CheckSubtree(const BufferIntervalTreeNode* node) {
+  if (node == nullptr) {
+    return 0;
+  }
+  int64_t subtree_end = node->end;
+  for (const BufferIntervalTreeNode* child : {node->left, node->right}) {
+    if (child != nullptr) {
+      EXPECT_EQ(child->parent, node);
+      EXPECT_LE(child->priority, node->priority);
+      subtree_end = std::max(subtree_end, child->subtree_end);
+    }
+  }
+  if (node->left != nullptr) {
+    EXPECT_LE(node->left->start, node->start);
+  }
+  if (node->right != nullptr) {
+    EXPECT_GE(node->right->start, node->start);
+  }
+  EXPECT_EQ(node->subtree_end, subtree_end);
+  return 1 + std::max(CheckSubtree(node->left), CheckSubtree(node->right));
+}
+
+TEST_F(IntervalTreeTest, ManyIntervalsStayBalanced) {
+  struct Interval {
+    int64_t start;
+    int64_t end;
+    HeapSimulator::Chunk chunk;
+  };
+  constexpr int64_t kNumIntervals = 4096;
+  // Insert intervals with increasing start times, which degenerates an
+  // unbalanced binary search tree into a linked list.
+  std::vector<Interval> intervals;
+  BufferIntervalTree tree;
+  for (int64_t i = 0; i < kNumIntervals; ++i) {
+    Interval interval{i, i + (i * 7919) % 64, HeapSimulator::Chunk{i, 1}};
+    tree.Add(interval.start, interval.end, interval.chunk);
+    intervals.push_back(interval);
+  }
+  EXPECT_LT(CheckSubtree(tree.GetRoot()), 64);
+
+  // Remove every other interval and compare queries against a linear scan.
+  std::vector<Interval> remaining;
+  for (int64_t i = 0; i < kNumIntervals; ++i) {
+    if (i % 2 == 0) {
+      EXPECT_TRUE(tree.Remove(intervals[i].start, intervals[i].end,
+                              intervals[i].chunk));
+    } else {
+      remaining.push_back(intervals[i]);
+    }
+  }
+  EXPECT_LT(CheckSubtree(tree.GetRoot()), 64);
+  for (int64_t start = 0; start < kNumIntervals; start += 97) {
+    const int64_t end = start + 50;
+    std::vector<int64_t> expected;
+    for (const Interval& interval : remaining) {
+      if (interval.start <= end && interval.end >= start) {
+        expected.push_back(interval.chunk.offset);
+      }
+    }
+    std::vector<int64_t> actual;
+    for (const HeapSimulator::Chunk& chunk :
+         tree.ChunksOverlappingInTime(start, end)) {
+      actual.push_back(chunk.offset);
+    }
+    absl::c_sort(actual);
+    EXPECT_EQ(actual, expected);
+  }
+}
+
+void BM_IntervalTreeAddAndQuery(::testing::benchmark::State& state) {
+  const int64_t num_intervals = state.range(0);
+  for (auto s : state) {
+    BufferIntervalTree tree;
+    int64_t num_overlapping = 0;
+    for (int64_t i = 0; i < num_intervals; ++i) {
+      const int64_t end = i + (i * 7919) % 128;
+      num_overlapping += tree.ChunksOverlappingInTime(i, end).size();
+      tree.Add(i, end, HeapSimulator::Chunk{i, 1});
+    }
+    tensorflow::testing::DoNotOptimize(num_overlapping);
+  }
+}
+
+BENCHMARK(BM_IntervalTreeAddAndQuery)->Arg(1024)->Arg(16384)->Arg(131072);
+
 }  // namespace
 }  // namespace xla
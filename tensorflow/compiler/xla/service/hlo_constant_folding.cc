@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/hlo_constant_folding.h"
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <utility>
@@ -64,6 +65,48 @@ static bool IsOrContainsIllegalInstr(const HloInstruction* instr) {
   return false;
 }
 
+// Returns a rough estimate of the number of scalar operations HloEvaluator
+// performs to evaluate `instr`, assuming its operands are already evaluated.
+static int64_t EstimateEvaluationCost(const HloInstruction* instr) {
+  if (!instr->shape().IsArray()) {
+    return 0;
+  }
+  const int64_t output_elements = ShapeUtil::ElementsIn(instr->shape());
+  switch (instr->opcode()) {
+    case HloOpcode::kDot: {
+      // Every output element is a dot product over the contracting dimensions.
+      int64_t contracting_elements = 1;
+      for (int64_t dim :
+           instr->dot_dimension_numbers().lhs_contracting_dimensions()) {
+        contracting_elements *= instr->operand(0)->shape().dimensions(dim);
+      }
+      return output_elements * contracting_elements;
+    }
+    case HloOpcode::kConvolution: {
+      // Every output element reads one kernel window over the input features
+      // of its group.
+      const Shape& kernel_shape = instr->operand(1)->shape();
+      const ConvolutionDimensionNumbers& dnums =
+          instr->convolution_dimension_numbers();
+      const int64_t output_features =
+          kernel_shape.dimensions(dnums.kernel_output_feature_dimension());
+      return output_elements * (ShapeUtil::ElementsIn(kernel_shape) /
+                                std::max<int64_t>(output_features, 1));
+    }
+    case HloOpcode::kReduce:
+      return ShapeUtil::ElementsIn(instr->operand(0)->shape());
+    case HloOpcode::kReduceWindow: {
+      int64_t window_elements = 1;
+      for (const WindowDimension& dim : instr->window().dimensions()) {
+        window_elements *= dim.size();
+      }
+      return output_elements * window_elements;
+    }
+    default:
+      return output_elements;
+  }
+}
+
 /*static*/ std::atomic<int64_t> HloConstantFolding::slow_op_counter_{0};
 
 StatusOr<bool> HloConstantFolding::Run(HloModule* module) {
@@ -166,6 +209,17 @@ StatusOr<bool> HloConstantFolding::Run(HloModule* module) {
         }
       }
 
+      // Don't spend unbounded compile time on a single fold.
+      if (max_evaluation_cost_ >= 0) {
+        const int64_t evaluation_cost = EstimateEvaluationCost(instruction);
+        if (evaluation_cost > max_evaluation_cost_) {
+          VLOG(2) << "Skipping constant folding of " << instruction->name()
+                  << ": estimated evaluation cost " << evaluation_cost
+                  << " exceeds " << max_evaluation_cost_;
+          continue;
+        }
+      }
+
       VLOG(5) << "Constant folding: " << instruction->ToString();
 
       absl::Duration slow_timeout =
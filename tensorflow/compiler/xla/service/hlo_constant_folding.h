@@ -25,6 +25,17 @@ namespace xla {
 // computation on constants.
 class HloConstantFolding : public HloModulePass {
  public:
+  // Default for `max_evaluation_cost`, roughly a few seconds of HloEvaluator
+  // time.
+  static constexpr int64_t kDefaultMaxEvaluationCost = int64_t{1} << 30;
+
+  // Instructions whose estimated evaluation cost, counted in scalar
+  // operations, exceeds `max_evaluation_cost` are left unfolded. A negative
+  // value disables the limit.
+  explicit HloConstantFolding(
+      int64_t max_evaluation_cost = kDefaultMaxEvaluationCost)
+      : max_evaluation_cost_(max_evaluation_cost) {}
+
   absl::string_view name() const override { return "constant_folding"; }
 
   // Run constant folding operations on the given module. Returns whether the
@@ -35,6 +46,8 @@ class HloConstantFolding : public HloModulePass {
   // Number of slow constant-folds we've encountered.  Used for firing
   // SlowOperationAlarms.
   static std::atomic<int64_t> slow_op_counter_;
+
+  int64_t max_evaluation_cost_;
 };
 
 }  // namespace xla
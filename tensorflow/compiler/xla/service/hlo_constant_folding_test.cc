@@ -346,5 +346,57 @@ TEST_F(HloConstantFoldingTest, FoldOpsWhereOneOperandIsBroadcast) {
                                   )));
 }
 
+TEST_F(HloConstantFoldingTest, FoldsElementwiseOpsOnTransposedConstant) {
+  const char* const kModuleStr = R"(
+  HloModule test
+
+  ENTRY entry {
+    c = f32[2,3]{1,0} constant({{1,2,3},{4,5,6}})
+    t = f32[3,2]{1,0} transpose(c), dimensions={1,0}
+    ROOT add = f32[3,2]{1,0} add(t, t)
+  })";
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(kModuleStr));
+  HloConstantFolding constant_folding;
+  TF_ASSERT_OK_AND_ASSIGN(bool result,
+                          RunHloPass(&constant_folding, module.get()));
+  EXPECT_TRUE(result);
+  HloInstruction* root = module->entry_computation()->root_instruction();
+  ASSERT_THAT(root, GmockMatch(m::Constant()));
+  EXPECT_EQ(root->literal(),
+            LiteralUtil::CreateR2<float>({{2, 8}, {4, 10}, {6, 12}}));
+}
+
+const char* const kConstantFoldLargeDot = R"(
+  HloModule ConstantFoldLargeDot
+
+  ENTRY r {
+    a = f32[64,4096] broadcast(f32[] constant(1)), dimensions={}
+    b = f32[4096,64] constant({...})
+    ROOT dot = f32[64,64] dot(a, b), lhs_contracting_dims={1},
+                                     rhs_contracting_dims={0}
+  })";
+
+TEST_F(HloConstantFoldingTest, DoesNotFoldDotAboveEvaluationCost) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(kConstantFoldLargeDot));
+  // The dot performs 64 * 64 * 4096 multiply-adds.
+  HloConstantFolding const_folder(/*max_evaluation_cost=*/64 * 64 * 4096 - 1);
+  TF_ASSERT_OK_AND_ASSIGN(bool result, const_folder.Run(module.get()));
+  EXPECT_FALSE(result);
+  EXPECT_THAT(module->entry_computation()->root_instruction(),
+              GmockMatch(m::Dot(m::Broadcast(), m::Constant())));
+}
+
+TEST_F(HloConstantFoldingTest, FoldsDotWithinEvaluationCost) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(kConstantFoldLargeDot));
+  HloConstantFolding const_folder(/*max_evaluation_cost=*/64 * 64 * 4096);
+  TF_ASSERT_OK_AND_ASSIGN(bool result, const_folder.Run(module.get()));
+  EXPECT_TRUE(result);
+  EXPECT_THAT(module->entry_computation()->root_instruction(),
+              GmockMatch(m::Constant()));
+}
+
 }  // namespace
 }  // namespace xla
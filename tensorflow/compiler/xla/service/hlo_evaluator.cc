@@ -69,6 +69,32 @@ namespace xla {
 
 namespace {
 
+// Evaluates `compare_op` on the corresponding elements of `lhs_literal` and
+// `rhs_literal`, producing a PRED literal of `shape`.
+template <typename OperandT>
+StatusOr<Literal> PopulateComparison(
+    const Shape& shape,
+    const std::function<bool(OperandT, OperandT)>& compare_op,
+    const LiteralSlice& lhs_literal, const LiteralSlice& rhs_literal) {
+  Literal result(shape);
+  if (HloEvaluator::CanEvaluateElementwiseOnFlatData(
+          result.shape(), {&lhs_literal, &rhs_literal})) {
+    absl::Span<bool> result_data = result.data<bool>();
+    absl::Span<const OperandT> lhs_data = lhs_literal.data<OperandT>();
+    absl::Span<const OperandT> rhs_data = rhs_literal.data<OperandT>();
+    for (int64_t i = 0; i < result_data.size(); ++i) {
+      result_data[i] = compare_op(lhs_data[i], rhs_data[i]);
+    }
+    return std::move(result);
+  }
+  TF_RETURN_IF_ERROR(
+      result.Populate<bool>([&](absl::Span<const int64_t> multi_index) {
+        return compare_op(lhs_literal.Get<OperandT>(multi_index),
+                          rhs_literal.Get<OperandT>(multi_index));
+      }));
+  return std::move(result);
+}
+
 template <typename OperandT>
 StatusOr<Literal> Compare(const Shape& shape, ComparisonDirection direction,
                           LiteralSlice lhs_literal, LiteralSlice rhs_literal) {
@@ -106,14 +132,8 @@ StatusOr<Literal> Compare(const Shape& shape, ComparisonDirection direction,
       break;
   }
 
-  Literal result(shape);
-  TF_RETURN_IF_ERROR(
-      result.Populate<bool>([&](absl::Span<const int64_t> multi_index) {
-        return compare_op(lhs_literal.Get<OperandT>(multi_index),
-                          rhs_literal.Get<OperandT>(multi_index));
-      }));
-
-  return std::move(result);
+  return PopulateComparison<OperandT>(shape, compare_op, lhs_literal,
+                                     rhs_literal);
 }
 
 template <>
@@ -138,14 +158,8 @@ StatusOr<Literal> Compare<complex64>(const Shape& shape,
                  << ComparisonDirectionToString(direction);
   }
 
-  Literal result(shape);
-  TF_RETURN_IF_ERROR(
-      result.Populate<bool>([&](absl::Span<const int64_t> multi_index) {
-        return compare_op(lhs_literal.Get<complex64>(multi_index),
-                          rhs_literal.Get<complex64>(multi_index));
-      }));
-
-  return std::move(result);
+  return PopulateComparison<complex64>(shape, compare_op, lhs_literal,
+                                       rhs_literal);
 }
 
 template <>
@@ -170,14 +184,8 @@ StatusOr<Literal> Compare<complex128>(const Shape& shape,
                  << ComparisonDirectionToString(direction);
   }
 
-  Literal result(shape);
-  TF_RETURN_IF_ERROR(
-      result.Populate<bool>([&](absl::Span<const int64_t> multi_index) {
-        return compare_op(lhs_literal.Get<complex128>(multi_index),
-                          rhs_literal.Get<complex128>(multi_index));
-      }));
-
-  return std::move(result);
+  return PopulateComparison<complex128>(shape, compare_op, lhs_literal,
+                                        rhs_literal);
 }
 
 // Represents an index into the while argument tuple and / or a value.
@@ -1124,6 +1132,19 @@ Status HloEvaluator::HandleInfeed(HloInstruction* infeed) {
 
 Status HloEvaluator::HandleConstant(HloInstruction*) { return Status::OK(); }
 
+/*static*/ bool HloEvaluator::CanEvaluateElementwiseOnFlatData(
+    const Shape& shape, absl::Span<const LiteralBase* const> operands) {
+  if (!LayoutUtil::IsDenseArray(shape)) {
+    return false;
+  }
+  return absl::c_all_of(operands, [&](const LiteralBase* operand) {
+    const Shape& operand_shape = operand->shape();
+    return LayoutUtil::IsDenseArray(operand_shape) &&
+           ShapeUtil::SameDimensions(shape, operand_shape) &&
+           LayoutUtil::Equal(shape.layout(), operand_shape.layout());
+  });
+}
+
 Status HloEvaluator::HandleReshape(HloInstruction* reshape) {
   TF_ASSIGN_OR_RETURN(evaluated_[reshape],
                       GetEvaluatedLiteralFor(reshape->operand(0))
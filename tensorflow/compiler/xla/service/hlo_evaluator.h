@@ -198,6 +198,12 @@ class HloEvaluator : public DfsHloVisitorWithDefault {
   // Enable the fast path for certain operations like dot or convolution.
   void set_use_fast_path(bool value) { use_fast_path_ = value; }
 
+  // Returns true if `operands` are all dense arrays laid out like `shape`. An
+  // elementwise op producing `shape` can then be evaluated over the flat data
+  // of its operands instead of computing a linear index for every element.
+  static bool CanEvaluateElementwiseOnFlatData(
+      const Shape& shape, absl::Span<const LiteralBase* const> operands);
+
   // Handles evaluation of a custom-call op.
   // Operand literals are provided in |operands| and implementations must
   // populate |output| before returning.
@@ -440,6 +446,14 @@ class HloEvaluator : public DfsHloVisitorWithDefault {
     TF_RET_CHECK(ShapeUtil::SameDimensions(shape, operand->shape()));
 
     Literal result(shape);
+    if (CanEvaluateElementwiseOnFlatData(result.shape(), {&operand_literal})) {
+      absl::Span<ReturnT> result_data = result.data<ReturnT>();
+      absl::Span<const NativeT> operand_data = operand_literal.data<NativeT>();
+      for (int64_t i = 0; i < result_data.size(); ++i) {
+        result_data[i] = unary_op(operand_data[i]);
+      }
+      return std::move(result);
+    }
     TF_RETURN_IF_ERROR(
         result.Populate<ReturnT>([&](absl::Span<const int64_t> multi_index) {
           return unary_op(operand_literal.Get<NativeT>(multi_index));
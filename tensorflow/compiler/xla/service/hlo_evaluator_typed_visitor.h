@@ -2998,12 +2998,22 @@ class HloEvaluatorTypedVisitor : public DfsHloVisitorWithDefault {
     const Literal& rhs_literal = parent_->GetEvaluatedLiteralFor(rhs);
 
     Literal result(shape);
+    const auto converted_op = ConvertBinaryFunction(binary_op);
+    if (HloEvaluator::CanEvaluateElementwiseOnFlatData(
+            result.shape(), {&lhs_literal, &rhs_literal})) {
+      absl::Span<ReturnT> result_data = result.data<ReturnT>();
+      absl::Span<const ReturnT> lhs_data = lhs_literal.data<ReturnT>();
+      absl::Span<const ReturnT> rhs_data = rhs_literal.data<ReturnT>();
+      for (int64_t i = 0; i < result_data.size(); ++i) {
+        result_data[i] = converted_op(lhs_data[i], rhs_data[i]);
+      }
+      return std::move(result);
+    }
 
     TF_RETURN_IF_ERROR(
         result.Populate<ReturnT>([&](absl::Span<const int64_t> multi_index) {
-          return ConvertBinaryFunction(binary_op)(
-              lhs_literal.Get<ReturnT>(multi_index),
-              rhs_literal.Get<ReturnT>(multi_index));
+          return converted_op(lhs_literal.Get<ReturnT>(multi_index),
+                              rhs_literal.Get<ReturnT>(multi_index));
         }));
     return std::move(result);
   }
@@ -3025,6 +3035,17 @@ class HloEvaluatorTypedVisitor : public DfsHloVisitorWithDefault {
     const Literal& ehs_literal = parent_->GetEvaluatedLiteralFor(ehs);
 
     Literal result(shape);
+    if (HloEvaluator::CanEvaluateElementwiseOnFlatData(
+            result.shape(), {&lhs_literal, &rhs_literal, &ehs_literal})) {
+      absl::Span<ReturnT> result_data = result.data<ReturnT>();
+      absl::Span<const LhsType> lhs_data = lhs_literal.data<LhsType>();
+      absl::Span<const RhsType> rhs_data = rhs_literal.data<RhsType>();
+      absl::Span<const EhsType> ehs_data = ehs_literal.data<EhsType>();
+      for (int64_t i = 0; i < result_data.size(); ++i) {
+        result_data[i] = ternary_op(lhs_data[i], rhs_data[i], ehs_data[i]);
+      }
+      return std::move(result);
+    }
 
     TF_RETURN_IF_ERROR(
         result.Populate<ReturnT>([&](absl::Span<const int64_t> multi_index) {
@@ -498,7 +498,8 @@ class MemoryUsageTracker {
       const HloRematerialization::CompactShapeFunction& compact_shape_function,
       const TuplePointsToAnalysis& points_to_analysis,
       const InstructionList& instruction_list,
-      HloRematerialization::RematerializationMode mode);
+      HloRematerialization::RematerializationMode mode,
+      HloRematerialization::ComputeCostFunction compute_cost_function);
 
   // Starts the placement of the given instruction. This adds the sizes of the
   // LogicalBuffers defined by the instruction to the current memory
@@ -508,9 +509,9 @@ class MemoryUsageTracker {
   // EndInstruction memory for dead operand(s) is freed.
   Status BeginInstruction(Item* item);
 
-  int64_t RematerializationCost(const std::vector<Item*>& items,
-                                int64_t memory_reduced,
-                                int64_t memory_limit_bytes) {
+  double RematerializationCost(const std::vector<Item*>& items,
+                               int64_t memory_reduced,
+                               int64_t memory_limit_bytes) {
     // If none of the users of any 'item' have been placed in the
     // sequence (as tracked by memory_tracker), then rematerialization of
     // 'item' is a zero-cost move of 'item->instruction' in the sequence.
@@ -529,6 +530,14 @@ class MemoryUsageTracker {
     }
 
     CHECK_GT(memory_reduced, 0);
+    if (compute_cost_function_) {
+      // Return the recompute cost per byte saved.
+      double compute_cost = 0;
+      for (auto* item : items) {
+        compute_cost += compute_cost_function_(*item->instruction);
+      }
+      return compute_cost / memory_reduced;
+    }
     // Return the inverse of the benefit of rematerialization.
     return memory_limit_bytes / memory_reduced;
   }
@@ -781,6 +790,7 @@ class MemoryUsageTracker {
   Item* in_progress_item_ = nullptr;
 
   HloRematerialization::RematerializationMode mode_;
+  HloRematerialization::ComputeCostFunction compute_cost_function_;
   // All buffers in the computation.
   std::vector<Buffer> buffers_;
 };
@@ -791,12 +801,14 @@ MemoryUsageTracker::MemoryUsageTracker(
     const HloRematerialization::CompactShapeFunction& compact_shape_function,
     const TuplePointsToAnalysis& points_to_analysis,
     const InstructionList& instruction_list,
-    HloRematerialization::RematerializationMode mode)
+    HloRematerialization::RematerializationMode mode,
+    HloRematerialization::ComputeCostFunction compute_cost_function)
     : computation_(computation),
       instruction_list_(instruction_list),
       size_function_(size_function),
       compact_shape_function_(compact_shape_function),
-      mode_(mode) {
+      mode_(mode),
+      compute_cost_function_(std::move(compute_cost_function)) {
   PointsToSet::BufferSet live_out_set =
       points_to_analysis.GetPointsToSet(computation_->root_instruction())
           .CreateFlattenedSet();
@@ -1384,7 +1396,7 @@ MemoryUsageTracker::PickRematerializationCandidates(
     absl::flat_hash_map<const HloInstruction*, bool>* rematerializable_map,
     int min_block_size, int max_block_size) {
   std::vector<Item*> best_items;
-  int64_t best_cost = 0;
+  double best_cost = 0;
   RematStrategy best_strategy;
 
   int effort = 0;
@@ -1479,7 +1491,7 @@ MemoryUsageTracker::PickRematerializationCandidates(
       const int64_t memory_reduced = MemoryReducedIfRematerialized(block);
       effort++;
       if (memory_reduced > 0) {
-        const int cost =
+        const double cost =
             RematerializationCost(block, memory_reduced, memory_limit_bytes);
 
         VLOG(5) << "Candidate block of size " << block.size()
@@ -1826,7 +1838,8 @@ StatusOr<int64_t> HloRematerialization::ComputePeakMemory(
   InstructionList instruction_list(order);
   MemoryUsageTracker tracker(computation, size_function_,
                              compact_shape_function_, *points_to_analysis_,
-                             instruction_list, mode_);
+                             instruction_list, mode_,
+                             compute_cost_function_);
   int64_t peak_memory = tracker.memory_usage();
   for (auto* item = instruction_list.first(); item != nullptr;
        item = instruction_list.next(item)) {
@@ -1870,7 +1883,7 @@ StatusOr<bool> HloRematerialization::RematerializeComputation(
   InstructionList instruction_list(schedule->sequence(computation));
   MemoryUsageTracker memory_tracker(
       computation, size_function_, compact_shape_function_,
-      *points_to_analysis_, instruction_list, mode_);
+      *points_to_analysis_, instruction_list, mode_, compute_cost_function_);
 
   instruction_list.PromoteNodesToSkip([&](Item* item) {
     return memory_tracker.AllocatedSize(item) >= min_remat_size;
@@ -2060,6 +2073,9 @@ StatusOr<bool> HloRematerialization::Run(HloModule* module) {
   net_instructions_added_ = 0;
 
   TF_RET_CHECK(module->has_schedule());
+  TF_RET_CHECK(compute_cost_function_ == nullptr ||
+               mode_ == RematerializationMode::kRecomputeOnly)
+      << "Compute costs only rank recomputations";
   TF_ASSIGN_OR_RETURN(points_to_analysis_, TuplePointsToAnalysis::Run(module));
   next_channel_id_ = hlo_query::NextChannelId(*module);
 
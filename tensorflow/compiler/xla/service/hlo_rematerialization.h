@@ -42,6 +42,10 @@ class HloRematerialization : public HloModulePass {
 
   using CompactShapeFunction = std::function<StatusOr<Shape>(const Shape&)>;
 
+  // Returns the cost, e.g. in estimated seconds, of recomputing the given
+  // instruction.
+  using ComputeCostFunction = std::function<double(const HloInstruction&)>;
+
   // Helper struct that communicates the before / after sizes for the
   // rematerialization process.
   struct RematerializationSizes {
@@ -80,13 +84,19 @@ class HloRematerialization : public HloModulePass {
   //
   //   compact_shape_function: Function which returns the compact form of a
   //   shape. If nullptr is provided, an default identity function is used.
+  //
+  //   compute_cost_function: If provided, candidates are ranked by their
+  //     recomputation cost per byte of memory saved, so that the memory limit
+  //     is met at the least recompute cost. Otherwise candidates are ranked by
+  //     the memory they save alone. Only supported in kRecomputeOnly mode.
   explicit HloRematerialization(
       const ShapeSizeFunction& size_function, int64_t memory_limit_bytes,
       RematerializationSizes* sizes, RematerializationPass pass_location,
       int block_size_limit, int block_rematerialization_factor,
       CompactShapeFunction compact_shape_function = nullptr,
       RematerializationMode mode = RematerializationMode::kRecomputeAndCompress,
-      int64_t min_remat_size = 0)
+      int64_t min_remat_size = 0,
+      ComputeCostFunction compute_cost_function = nullptr)
       : size_function_(size_function),
         memory_limit_bytes_(memory_limit_bytes),
         sizes_(sizes),
@@ -97,7 +107,8 @@ class HloRematerialization : public HloModulePass {
                                     ? DefaultCompactShapeFunction
                                     : std::move(compact_shape_function)),
         mode_(mode),
-        min_remat_size_(min_remat_size) {}
+        min_remat_size_(min_remat_size),
+        compute_cost_function_(std::move(compute_cost_function)) {}
   ~HloRematerialization() override = default;
 
   absl::string_view name() const override { return "rematerialization"; }
@@ -201,6 +212,9 @@ class HloRematerialization : public HloModulePass {
 
   int64_t min_remat_size_;
 
+  // Cost of recomputing an instruction. May be null.
+  const ComputeCostFunction compute_cost_function_;
+
   // Tracking available channel id numbers to use to apply to rematerialized
   // channel instructions
   int64_t next_channel_id_;
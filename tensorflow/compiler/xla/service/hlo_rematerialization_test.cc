@@ -57,6 +57,21 @@ class HloRematerializationTest : public RematerializationTestBase {
         min_remat_size);
     return remat.Run(module);
   }
+
+  // Rematerializes `module` in its existing schedule, recomputing only.
+  StatusOr<bool> RunRecomputeOnlyRematerialization(
+      int64_t memory_limit_bytes, HloModule* module,
+      HloRematerialization::ComputeCostFunction compute_cost_function) {
+    TF_EXPECT_OK(verifier().Run(module).status());
+    HloRematerialization remat(
+        ByteSizeOf, memory_limit_bytes,
+        /*sizes=*/nullptr,
+        HloRematerialization::RematerializationPass::kPreFusion,
+        /*block_size_limit=*/1, /*block_rematerialization_factor=*/1, nullptr,
+        HloRematerialization::RematerializationMode::kRecomputeOnly,
+        /*min_remat_size=*/0, std::move(compute_cost_function));
+    return remat.Run(module);
+  }
 };
 
 // Test rematerialization of a single computation produced by
@@ -1156,6 +1171,75 @@ ENTRY %entry {
                       op::Fusion(AllOf(op::Fusion(), ::testing::Ne(fusion0)))));
 }
 
+// Both the broadcast and the exponential are live across the peak of 44KB at
+// the negate (plus the 4KB output), and rematerializing either one meets a
+// memory limit of 46KB.
+constexpr char kBroadcastOrExponentialModule[] = R"(
+HloModule module, is_scheduled=true
+
+ENTRY entry {
+  p0 = f32[] parameter(0)
+  p1 = f32[2048] parameter(1)
+  bcast = f32[1024] broadcast(p0), dimensions={}
+  exp = f32[2048] exponential(p1)
+  concat = f32[4096] concatenate(bcast, exp, bcast), dimensions={0}
+  negate = f32[4096] negate(concat)
+  slice = f32[1024] slice(negate), slice={[0:1024]}
+  add = f32[1024] add(slice, bcast)
+  exp_slice = f32[1024] slice(exp), slice={[1024:2048]}
+  ROOT add.1 = f32[1024] add(add, exp_slice)
+}
+)";
+
+TEST_F(HloRematerializationTest, RematerializesLargestSavingWithoutCosts) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto module, ParseAndReturnVerifiedModule(kBroadcastOrExponentialModule));
+  const HloInstruction* bcast = FindInstruction(module.get(), "bcast");
+  const HloInstruction* exp = FindInstruction(module.get(), "exp");
+  TF_ASSERT_OK_AND_ASSIGN(
+      bool changed, RunRecomputeOnlyRematerialization(
+                        /*memory_limit_bytes=*/46 * 1024, module.get(),
+                        /*compute_cost_function=*/nullptr));
+  EXPECT_TRUE(changed);
+  // Recomputing the exponential saves twice as much memory.
+  EXPECT_THAT(FindInstruction(module.get(), "exp_slice"),
+              op::Slice(AllOf(op::Exp(), ::testing::Ne(exp))));
+  EXPECT_EQ(FindInstruction(module.get(), "add")->operand(1), bcast);
+}
+
+TEST_F(HloRematerializationTest, RematerializesCheapestPerByteWithCosts) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto module, ParseAndReturnVerifiedModule(kBroadcastOrExponentialModule));
+  const HloInstruction* bcast = FindInstruction(module.get(), "bcast");
+  const HloInstruction* exp = FindInstruction(module.get(), "exp");
+  TF_ASSERT_OK_AND_ASSIGN(
+      bool changed,
+      RunRecomputeOnlyRematerialization(
+          /*memory_limit_bytes=*/46 * 1024, module.get(),
+          [](const HloInstruction& instruction) {
+            return instruction.opcode() == HloOpcode::kExp ? 100.0 : 1.0;
+          }));
+  EXPECT_TRUE(changed);
+  // The broadcast saves less memory, but is much cheaper to recompute.
+  EXPECT_THAT(FindInstruction(module.get(), "add")->operand(1),
+              AllOf(op::Broadcast(), ::testing::Ne(bcast)));
+  EXPECT_EQ(FindInstruction(module.get(), "exp_slice")->operand(0), exp);
+}
+
+TEST_F(HloRematerializationTest, ComputeCostsRequireRecomputeOnlyMode) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto module, ParseAndReturnVerifiedModule(kBroadcastOrExponentialModule));
+  HloRematerialization remat(
+      ByteSizeOf, /*memory_limit_bytes=*/46 * 1024,
+      /*sizes=*/nullptr,
+      HloRematerialization::RematerializationPass::kPreFusion,
+      /*block_size_limit=*/1, /*block_rematerialization_factor=*/1, nullptr,
+      HloRematerialization::RematerializationMode::kRecomputeAndCompress,
+      /*min_remat_size=*/0,
+      [](const HloInstruction& instruction) { return 1.0; });
+  EXPECT_FALSE(remat.Run(module.get()).ok());
+}
+
 }  // namespace
 
 }  // namespace xla
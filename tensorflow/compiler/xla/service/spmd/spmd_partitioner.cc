@@ -3886,7 +3886,49 @@ std::unique_ptr<SpmdPartitioningVisitor> SpmdPartitioner::CreateVisitor(
       next_channel_id, logger, std::move(options), this);
 }
 
+SpmdPartitionerOptions MemorySavingOptions(SpmdPartitionerOptions options) {
+  options.cache_all_gather = false;
+  options.threshold_for_windowed_einsum_mib = 0;
+  options.choose_faster_windowed_einsum_over_mem = false;
+  return options;
+}
+
 StatusOr<bool> SpmdPartitioner::Run(HloModule* module) {
+  const int64_t budget = options_.memory_budget_per_device_bytes;
+  if (budget <= 0) {
+    return PartitionModule(module);
+  }
+
+  // Partitions a copy first, since the module cannot be restored once it is
+  // partitioned.
+  std::unique_ptr<HloModule> trial = module->Clone(/*suffix=*/"");
+  TF_RETURN_IF_ERROR(PartitionModule(trial.get()).status());
+  TF_ASSIGN_OR_RETURN(int64_t peak_memory, EstimatePeakMemoryPerDevice(*trial));
+  if (peak_memory <= budget) {
+    return PartitionModule(module);
+  }
+  VLOG(1) << "SPMD partitioned module " << module->name() << " needs "
+          << tensorflow::strings::HumanReadableNumBytes(peak_memory)
+          << " per device, over the budget of "
+          << tensorflow::strings::HumanReadableNumBytes(budget)
+          << "; partitioning it with memory saving options";
+  SpmdPartitionerOptions original_options = options_;
+  options_ = MemorySavingOptions(options_);
+  StatusOr<bool> changed = PartitionModule(module);
+  options_ = std::move(original_options);
+  TF_RETURN_IF_ERROR(changed.status());
+
+  TF_ASSIGN_OR_RETURN(peak_memory, EstimatePeakMemoryPerDevice(*module));
+  if (peak_memory > budget) {
+    VLOG(1) << "SPMD partitioned module " << module->name()
+            << " still needs "
+            << tensorflow::strings::HumanReadableNumBytes(peak_memory)
+            << " per device; the remainder is left to rematerialization";
+  }
+  return changed;
+}
+
+StatusOr<bool> SpmdPartitioner::PartitionModule(HloModule* module) {
   TF_RETURN_IF_ERROR(PreprocessSharding(module));
   TF_RETURN_IF_ERROR(PreprocessHlos(module));
 
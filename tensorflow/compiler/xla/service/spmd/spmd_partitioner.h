@@ -70,8 +70,19 @@ struct SpmdPartitionerOptions {
   // Whether doing bidirectional communication when decomposing independent
   // all-gathers.
   bool bidirectional_decomposed_all_gather = false;
+
+  // Upper bound on the peak memory of one device running the partitioned
+  // module, as estimated by EstimatePeakMemoryPerDevice(). If the module
+  // partitioned with these options does not fit, it is partitioned again with
+  // the options that favor memory over speed (see MemorySavingOptions()). 0
+  // means no budget.
+  int64_t memory_budget_per_device_bytes = 0;
 };
 
+// Returns `options` changed to avoid cached all-gathers and to prefer windowed
+// einsums, which keep fewer full-size tensors alive on each device.
+SpmdPartitionerOptions MemorySavingOptions(SpmdPartitionerOptions options);
+
 // Class to wrap the computation builder to capture information during SPMD
 // transformation.
 class SpmdBuilder : public HloComputation::Builder {
@@ -242,6 +253,9 @@ class SpmdPartitioner : public HloModulePass {
   const SpmdPartitionerOptions& options() { return options_; }
 
  protected:
+  // Partitions `module` with the current options_.
+  StatusOr<bool> PartitionModule(HloModule* module);
+
   virtual std::unique_ptr<SpmdPartitioningVisitor> CreateVisitor(
       HloComputation* computation, int64_t num_partitions, int64_t num_replicas,
       const SPMDCollectiveOpsCreator& collective_ops_creator,
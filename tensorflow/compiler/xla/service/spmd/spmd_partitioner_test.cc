@@ -21,6 +21,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/hlo_parser.h"
 #include "tensorflow/compiler/xla/service/hlo_pass_pipeline.h"
 #include "tensorflow/compiler/xla/service/hlo_verifier.h"
+#include "tensorflow/compiler/xla/service/spmd/spmd_partitioner_util.h"
 #include "tensorflow/compiler/xla/tests/hlo_test_base.h"
 #include "tensorflow/compiler/xla/util.h"
 #include "tensorflow/compiler/xla/xla_data.pb.h"
@@ -41,7 +42,8 @@ class SpmdPartitioningTest : public HloTestBase {
       bool conv_halo_exchange_always_on_lhs = true,
       bool choose_faster_windowed_einsum = false,
       bool unroll_windowed_einsum = false,
-      bool bidirectional_windowed_einsum = false) {
+      bool bidirectional_windowed_einsum = false,
+      int64_t memory_budget_per_device_bytes = 0) {
     // Some tests (BackpropFilter convs) set this flag false to test two
     // different paths of the implementation.
     SpmdPartitionerOptions options;
@@ -51,6 +53,7 @@ class SpmdPartitioningTest : public HloTestBase {
         choose_faster_windowed_einsum;
     options.unroll_windowed_einsum = unroll_windowed_einsum;
     options.bidirectional_windowed_einsum = bidirectional_windowed_einsum;
+    options.memory_budget_per_device_bytes = memory_budget_per_device_bytes;
     auto collective_ops_creator =
         GetDefaultCollectiveOpsCreator(num_devices, /*num_replicas=*/1);
     // Do not use all-gather for pattern-matching purpose, as the partitioner
@@ -489,6 +492,60 @@ ENTRY entry {
                                    op::Reshape(), op::Constant()))));
 }
 
+TEST_F(SpmdPartitioningTest, PeakMemoryPerDeviceShrinksWhenPartitioned) {
+  absl::string_view hlo_string = R"(
+HloModule module
+
+ENTRY entry {
+  param = f32[1024,256] parameter(0), sharding={devices=[2,1]0,1}
+  ROOT negate = f32[1024,256] negate(param), sharding={devices=[2,1]0,1}
+})";
+  TF_ASSERT_OK_AND_ASSIGN(auto unpartitioned,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  TF_ASSERT_OK_AND_ASSIGN(int64_t unpartitioned_peak,
+                          EstimatePeakMemoryPerDevice(*unpartitioned));
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          PartitionComputation(hlo_string, /*num_devices=*/2));
+  TF_ASSERT_OK_AND_ASSIGN(int64_t peak, EstimatePeakMemoryPerDevice(*module));
+  EXPECT_GT(peak, 0);
+  EXPECT_LT(peak, unpartitioned_peak);
+}
+
+TEST_F(SpmdPartitioningTest, PartitionsWithMemorySavingOptionsOverBudget) {
+  absl::string_view hlo_string = R"(
+HloModule module
+
+ENTRY entry {
+  param = f32[1024,256] parameter(0), sharding={devices=[2,1]0,1}
+  negate = f32[1024,256] negate(param), sharding={replicated}
+  ROOT exponential = f32[1024,256] exponential(negate),
+    sharding={devices=[2,1]0,1}
+})";
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto module,
+      PartitionComputation(hlo_string, /*num_devices=*/2,
+                           /*conv_halo_exchange_always_on_lhs=*/true,
+                           /*choose_faster_windowed_einsum=*/false,
+                           /*unroll_windowed_einsum=*/false,
+                           /*bidirectional_windowed_einsum=*/false,
+                           /*memory_budget_per_device_bytes=*/1));
+  VLOG(1) << module->ToString();
+  HloInstruction* root = module->entry_computation()->root_instruction();
+  EXPECT_THAT(root, AllOf(op::Shape("f32[512,256]"),
+                          op::Exp(op::DynamicSlice(op::Negate(), _, _))));
+}
+
+TEST(MemorySavingOptionsTest, FavorsMemoryOverSpeed) {
+  SpmdPartitionerOptions options;
+  options.choose_faster_windowed_einsum_over_mem = true;
+  options.report_instruction_count = 7;
+  SpmdPartitionerOptions saving = MemorySavingOptions(options);
+  EXPECT_FALSE(saving.cache_all_gather);
+  EXPECT_EQ(saving.threshold_for_windowed_einsum_mib, 0);
+  EXPECT_FALSE(saving.choose_faster_windowed_einsum_over_mem);
+  EXPECT_EQ(saving.report_instruction_count, 7);
+}
+
 TEST_F(SpmdPartitioningTest, TiledAllReduce) {
   absl::string_view hlo_string = R"(
 HloModule module
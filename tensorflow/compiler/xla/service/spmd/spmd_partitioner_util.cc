@@ -29,6 +29,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/hlo_computation.h"
 #include "tensorflow/compiler/xla/service/hlo_instruction.h"
 #include "tensorflow/compiler/xla/service/hlo_instructions.h"
+#include "tensorflow/compiler/xla/service/hlo_memory_scheduler.h"
 #include "tensorflow/compiler/xla/service/hlo_module.h"
 #include "tensorflow/compiler/xla/service/hlo_opcode.h"
 #include "tensorflow/compiler/xla/service/hlo_sharding.h"
@@ -1969,5 +1970,19 @@ absl::optional<PadWithWrapPattern> FindPadWithWrapPattern(
   return pad_pattern;
 }
 
+StatusOr<int64_t> EstimatePeakMemoryPerDevice(const HloModule& module) {
+  int64_t peak_memory = 0;
+  TF_RETURN_IF_ERROR(
+      ScheduleModule(
+          &module,
+          [](const BufferValue& buffer) {
+            return ShapeUtil::ByteSizeOf(buffer.shape(), sizeof(void*));
+          },
+          ComputationSchedulerToModuleScheduler(DFSMemoryScheduler),
+          &peak_memory)
+          .status());
+  return peak_memory;
+}
+
 }  // namespace spmd
 }  // namespace xla
@@ -418,6 +418,10 @@ absl::optional<PadWithWrapPattern> FindPadWithWrapPattern(
     const HloInstruction* concat, const HloInstruction* lhs,
     const HloInstruction* mid, const HloInstruction* rhs);
 
+// Returns the peak memory in bytes of one device running the partitioned
+// `module`, as simulated by the heap simulator on a memory-minimizing schedule.
+StatusOr<int64_t> EstimatePeakMemoryPerDevice(const HloModule& module);
+
 }  // namespace spmd
 }  // namespace xla
 
@@ -61,6 +61,19 @@ void XlaDebugInfoManager::UnregisterModule(
   }
 }
 
+std::shared_ptr<const HloModule> XlaDebugInfoManager::FindModule(
+    int module_unique_id) {
+  absl::MutexLock lock(&mutex_);
+  for (const auto& it : active_modules_) {
+    for (const XlaModuleInstance& instance : it.second.instances) {
+      if (instance.hlo_module->unique_id() == module_unique_id) {
+        return instance.hlo_module;
+      }
+    }
+  }
+  return nullptr;
+}
+
 void XlaDebugInfoManager::StartTracing() {
   absl::MutexLock lock(&mutex_);
   tracing_active_ = true;
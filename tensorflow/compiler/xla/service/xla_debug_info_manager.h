@@ -84,6 +84,11 @@ class XlaDebugInfoManager {
   void StopTracing(
       std::vector<XlaModuleDebugInfo>* module_debug_info = nullptr);
 
+  // Returns a registered module whose HloModule::unique_id() is
+  // `module_unique_id`, or nullptr if there is none. Used to symbolize
+  // profiling data that only carries HLO unique ids.
+  std::shared_ptr<const HloModule> FindModule(int module_unique_id);
+
   friend class XlaDebugInfoManagerTest;
 
  private:
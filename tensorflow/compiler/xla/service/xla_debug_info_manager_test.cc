@@ -85,6 +85,19 @@ class XlaDebugInfoManagerTest : public HloTestBase {
     return xla_debug_info_manager_.GetActiveModules();
   }
 
+  std::shared_ptr<const HloModule> FindModule(int module_unique_id) {
+    return xla_debug_info_manager_.FindModule(module_unique_id);
+  }
+
+  const HloModule& GetModule(int unique_id) {
+    for (const DebugMetadata& debug_info : external_references_) {
+      if (debug_info.unique_id == unique_id) {
+        return *debug_info.module;
+      }
+    }
+    LOG(FATAL) << "Unknown program " << unique_id;
+  }
+
   void StartTrace() { xla_debug_info_manager_.StartTracing(); }
 
   std::set<ModuleIdentifier> StopTrace() {
@@ -195,4 +208,19 @@ TEST_F(XlaDebugInfoManagerTest, UnregisterDuringTrace) {
   UnregisterProgram(program0A);
 }
 
+TEST_F(XlaDebugInfoManagerTest, FindModuleByUniqueId) {
+  auto program0 = RegisterProgram("program0");
+  auto program1 = RegisterProgram("program1");
+  const int module0_id = GetModule(program0).unique_id();
+  const int module1_id = GetModule(program1).unique_id();
+
+  EXPECT_EQ(FindModule(module0_id).get(), &GetModule(program0));
+  EXPECT_EQ(FindModule(module1_id).get(), &GetModule(program1));
+
+  UnregisterProgram(program0);
+  EXPECT_EQ(FindModule(module0_id), nullptr);
+  UnregisterProgram(program1);
+  EXPECT_EQ(FindModule(module1_id), nullptr);
+}
+
 }  // namespace xla
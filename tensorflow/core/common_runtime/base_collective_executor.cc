@@ -18,7 +18,9 @@ limitations under the License.
 #include <functional>
 #include <utility>
 
+#include "tensorflow/core/common_runtime/collective_rma_local.h"
 #include "tensorflow/core/common_runtime/copy_tensor.h"
+#include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/common_runtime/process_util.h"
@@ -37,6 +39,7 @@ limitations under the License.
 #include "tensorflow/core/platform/refcount.h"
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/profiler/lib/connected_traceme.h"
 #include "tensorflow/core/profiler/lib/scoped_memory_debug_annotation.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
@@ -50,6 +53,49 @@ bool IsCancelled(CancellationManager* cancel_mgr) {
   return cancel_mgr != nullptr &&
          (cancel_mgr->IsCancelled() || cancel_mgr->IsCancelling());
 }
+
+// Reductions of fewer bytes than this are fused with others.  The default of
+// zero disables fusion.
+int64_t FusionThresholdBytes() {
+  int64_t threshold_bytes;
+  Status status = ReadInt64FromEnvVar("TF_COLLECTIVE_REDUCE_FUSION_BYTES", 0,
+                                      &threshold_bytes);
+  if (!status.ok()) {
+    LOG(ERROR) << "Disabling collective reduction fusion: " << status;
+    return 0;
+  }
+  return threshold_bytes;
+}
+
+// How long a reduction may wait in a fusion bucket.
+int64_t FusionWindowMicros() {
+  int64_t window_micros;
+  Status status = ReadInt64FromEnvVar("TF_COLLECTIVE_REDUCE_FUSION_WINDOW_US",
+                                      1000, &window_micros);
+  if (!status.ok()) {
+    LOG(ERROR) << "Using the default collective reduction fusion window: "
+               << status;
+    return 1000;
+  }
+  return window_micros;
+}
+
+// Copies `src` into `dst`, which must have the same number of bytes, on the
+// device of `ctx`, and blocks until the copy is done.
+Status CopyOnDevice(OpKernelContext* ctx, const Tensor& src, Tensor* dst) {
+  Device* device = static_cast<Device*>(ctx->device());
+  Notification note;
+  Status status;
+  CollectiveRemoteAccessLocal::MemCpyAsync(
+      ctx->op_device_context(), ctx->op_device_context(), device, device,
+      ctx->input_alloc_attr(0), ctx->output_alloc_attr(0), &src, dst,
+      0 /*dev_to_dev_stream_index*/, [&note, &status](const Status& s) {
+        status.Update(s);
+        note.Notify();
+      });
+  note.WaitForNotification();
+  return status;
+}
 }  // namespace
 
 /*static*/
@@ -227,6 +273,18 @@ CollectiveAdapter* MakeCollectiveAdapter(Tensor* output, int num_chunks,
   }
 }
 
+BaseCollectiveExecutor::BaseCollectiveExecutor(
+    CollectiveExecutorMgrInterface* cem, CollectiveRemoteAccess* remote_access,
+    int64_t step_id, const DeviceMgr* dev_mgr,
+    std::shared_ptr<UnboundedWorkQueue> work_queue)
+    : CollectiveExecutor(cem),
+      step_id_(step_id),
+      dev_mgr_(dev_mgr),
+      remote_access_(remote_access),
+      work_queue_(std::move(work_queue)),
+      fusion_threshold_bytes_(FusionThresholdBytes()),
+      fusion_window_micros_(FusionWindowMicros()) {}
+
 BaseCollectiveExecutor::~BaseCollectiveExecutor() {}
 
 void BaseCollectiveExecutor::StartAbort(const Status& s) {
@@ -311,6 +369,14 @@ void BaseCollectiveExecutor::ExecuteAsync(OpKernelContext* ctx,
                           col_params->is_source))
                             ? &ctx->input(0)
                             : nullptr;
+  if (MaybeEnqueueForFusion(ctx, col_params, exec_key, done_safe)) return;
+  LaunchCollective(ctx, col_params, exec_key, input, output, done_safe);
+}
+
+void BaseCollectiveExecutor::LaunchCollective(
+    OpKernelContext* ctx, const CollectiveParams* col_params,
+    const string& exec_key, const Tensor* input, Tensor* output,
+    const StatusCallback& done_safe) {
   CollectiveImplementationInterface* col_impl = nullptr;
   Status status = CreateCollective(*col_params, &col_impl);
   if (!status.ok()) {
@@ -350,6 +416,240 @@ void BaseCollectiveExecutor::ExecuteAsync(OpKernelContext* ctx,
   });
 }
 
+bool BaseCollectiveExecutor::MaybeEnqueueForFusion(
+    OpKernelContext* ctx, const CollectiveParams* col_params,
+    const string& exec_key, const StatusCallback& done) {
+  // Only the reductions of groups within this task are fused, since all of
+  // their members run on this executor and can agree on which instances to
+  // fuse without further communication.  Reductions with a timeout are not
+  // fused because their context may be gone once the timeout fires.
+  if (fusion_threshold_bytes_ <= 0 ||
+      col_params->instance.type != REDUCTION_COLLECTIVE ||
+      col_params->group.num_tasks != 1 || col_params->merge_op == nullptr ||
+      !col_params->instance.impl_details.dependencies.empty() ||
+      col_params->instance.impl_details.timeout_seconds > 0) {
+    return false;
+  }
+  const Tensor& input = ctx->input(0);
+  const int64_t bytes = input.TotalBytes();
+  if (bytes == 0 || bytes >= fusion_threshold_bytes_) {
+    return false;
+  }
+  const string bucket_key = strings::StrCat(
+      col_params->group.group_key, ":",
+      DataTypeString(col_params->instance.data_type), ":",
+      col_params->instance.impl_details.collective_name, ":",
+      col_params->merge_op->type_string(), ":",
+      col_params->final_op ? col_params->final_op->type_string() : "", ":",
+      col_params->wire_encode_op
+          ? DataTypeString(col_params->wire_encode_op->output_type(0))
+          : "");
+  const int32 instance_key = col_params->instance.instance_key;
+  std::vector<PendingInstance> complete;
+  bool schedule_flush = false;
+  {
+    mutex_lock l(fusion_mu_);
+    FusionBucket& bucket = fusion_buckets_[bucket_key];
+    auto unfused_it = bucket.unfused.find(instance_key);
+    if (unfused_it != bucket.unfused.end()) {
+      // The other members of this instance already ran without fusion.
+      if (--unfused_it->second == 0) {
+        bucket.unfused.erase(unfused_it);
+        if (bucket.instances.empty() && bucket.unfused.empty()) {
+          fusion_buckets_.erase(bucket_key);
+        }
+      }
+      return false;
+    }
+    PendingInstance& instance = bucket.instances[instance_key];
+    instance.members.push_back({ctx, col_params, exec_key, done});
+    instance.bytes = bytes;
+    if (instance.members.size() == col_params->group.group_size) {
+      bucket.ready_bytes += bytes;
+    }
+    if (bucket.ready_bytes >= fusion_threshold_bytes_) {
+      TakeCompleteInstances(&bucket, &complete);
+    }
+    if (!bucket.instances.empty() && !bucket.flush_scheduled) {
+      bucket.flush_scheduled = true;
+      schedule_flush = true;
+    }
+  }
+  if (!complete.empty()) {
+    RunFusedReductions(std::move(complete));
+  }
+  if (schedule_flush) {
+    // Keep this executor alive until the flush, which may happen after all of
+    // the reductions in the bucket are done.
+    Ref();
+    SchedNonBlockingClosureAfter(fusion_window_micros_, [this, bucket_key] {
+      FlushFusionBucket(bucket_key);
+      Unref();
+    });
+  }
+  return true;
+}
+
+void BaseCollectiveExecutor::TakeCompleteInstances(
+    FusionBucket* bucket, std::vector<PendingInstance>* complete) {
+  for (auto it = bucket->instances.begin(); it != bucket->instances.end();) {
+    const CollectiveParams* col_params = it->second.members[0].col_params;
+    if (it->second.members.size() == col_params->group.group_size) {
+      bucket->ready_bytes -= it->second.bytes;
+      complete->push_back(std::move(it->second));
+      it = bucket->instances.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void BaseCollectiveExecutor::FlushFusionBucket(const string& bucket_key) {
+  std::vector<PendingInstance> complete;
+  std::vector<PendingReduction> unfused;
+  {
+    mutex_lock l(fusion_mu_);
+    auto bucket_it = fusion_buckets_.find(bucket_key);
+    if (bucket_it == fusion_buckets_.end()) return;
+    FusionBucket& bucket = bucket_it->second;
+    bucket.flush_scheduled = false;
+    TakeCompleteInstances(&bucket, &complete);
+    // The members of the remaining instances have not all arrived within the
+    // window, possibly because some of them run on another executor.  Run
+    // them, and the ones still to arrive, without fusion.
+    for (auto& instance : bucket.instances) {
+      const int group_size =
+          instance.second.members[0].col_params->group.group_size;
+      bucket.unfused[instance.first] =
+          group_size - instance.second.members.size();
+      for (PendingReduction& member : instance.second.members) {
+        unfused.push_back(std::move(member));
+      }
+    }
+    bucket.instances.clear();
+    if (bucket.unfused.empty()) {
+      fusion_buckets_.erase(bucket_it);
+    }
+  }
+  if (complete.size() == 1) {
+    // There is nothing to fuse this instance with.
+    for (PendingReduction& member : complete[0].members) {
+      unfused.push_back(std::move(member));
+    }
+  } else if (!complete.empty()) {
+    RunFusedReductions(std::move(complete));
+  }
+  for (PendingReduction& member : unfused) {
+    LaunchCollective(member.ctx, member.col_params, member.exec_key,
+                     &member.ctx->input(0), member.ctx->mutable_output(0),
+                     member.done);
+  }
+}
+
+void BaseCollectiveExecutor::RunFusedReductions(
+    std::vector<PendingInstance> instances) {
+  VLOG(1) << "Fusing " << instances.size() << " reductions starting at "
+          << "instance "
+          << instances[0].members[0].col_params->instance.instance_key;
+  const int group_size = instances[0].members[0].col_params->group.group_size;
+  std::vector<std::vector<PendingReduction>> members_by_rank(group_size);
+  for (PendingInstance& instance : instances) {
+    for (PendingReduction& member : instance.members) {
+      members_by_rank[member.col_params->default_rank].push_back(
+          std::move(member));
+    }
+  }
+  for (std::vector<PendingReduction>& members : members_by_rank) {
+    RunClosure([this, members = std::move(members)]() mutable {
+      RunFusedReduction(std::move(members));
+    });
+  }
+}
+
+void BaseCollectiveExecutor::RunFusedReduction(
+    std::vector<PendingReduction> members) {
+  profiler::TraceMe activity("BaseCollectiveExecutor::RunFusedReduction",
+                             profiler::TraceMeLevel::kInfo);
+  auto done_all = [members](const Status& s) {
+    for (const PendingReduction& member : members) {
+      member.done(s);
+    }
+  };
+  // The first member stands in for all of them in the fused reduction.
+  OpKernelContext* ctx = members[0].ctx;
+  const CollectiveParams* col_params = members[0].col_params;
+  int64_t num_elements = 0;
+  for (const PendingReduction& member : members) {
+    num_elements += member.ctx->input(0).NumElements();
+  }
+  auto fused = std::make_shared<Tensor>();
+  Status status =
+      ctx->allocate_temp(col_params->instance.data_type,
+                         TensorShape({num_elements}), fused.get(),
+                         ctx->output_alloc_attr(0));
+  int64_t offset = 0;
+  for (const PendingReduction& member : members) {
+    if (!status.ok()) break;
+    const Tensor& input = member.ctx->input(0);
+    Tensor src;
+    CHECK(src.CopyFrom(input, TensorShape({input.NumElements()})));
+    Tensor dst = fused->Slice(offset, offset + input.NumElements());
+    status = CopyOnDevice(ctx, src, &dst);
+    offset += input.NumElements();
+  }
+  CollectiveImplementationInterface* col_impl = nullptr;
+  if (status.ok()) {
+    status = CollectiveRegistry::LookupParamResolverInstance(
+        col_params->instance.impl_details.collective_name, &col_impl);
+  }
+  CollectiveParams* fused_params = new CollectiveParams();
+  fused_params->group = col_params->group;
+  fused_params->instance = col_params->instance;
+  fused_params->instance.shape = TensorShape({num_elements});
+  fused_params->instance.impl_details.subdiv_permutations.clear();
+  fused_params->name = col_params->name;
+  fused_params->default_rank = col_params->default_rank;
+  fused_params->merge_op = col_params->merge_op;
+  fused_params->final_op = col_params->final_op;
+  fused_params->wire_encode_op = col_params->wire_encode_op;
+  fused_params->wire_decode_op = col_params->wire_decode_op;
+  fused_params->run_group_initialization =
+      col_params->run_group_initialization;
+  if (status.ok()) {
+    // Let the implementation choose e.g. the subdivisions for the fused size.
+    status = col_impl->InitializeCollectiveParams(fused_params);
+  }
+  if (!status.ok()) {
+    fused_params->Unref();
+    done_all(status);
+    return;
+  }
+  LaunchCollective(
+      ctx, fused_params, members[0].exec_key, fused.get(), fused.get(),
+      [this, members, done_all, fused, fused_params](const Status& s) {
+        fused_params->Unref();
+        if (!s.ok()) {
+          done_all(s);
+          return;
+        }
+        // The callback may run on a thread that must not block, so unpack
+        // the result on the work queue.
+        RunClosure([members, done_all, fused]() {
+          Status status;
+          int64_t offset = 0;
+          for (const PendingReduction& member : members) {
+            Tensor* output = member.ctx->mutable_output(0);
+            Tensor dst;
+            CHECK(dst.CopyFrom(*output, TensorShape({output->NumElements()})));
+            Tensor src = fused->Slice(offset, offset + output->NumElements());
+            status.Update(CopyOnDevice(member.ctx, src, &dst));
+            offset += output->NumElements();
+          }
+          done_all(status);
+        });
+      });
+}
+
 void BaseCollectiveExecutor::CompleteParamsAsync(
     const DeviceAttributes& device, CollectiveParams* cp,
     CancellationManager* cancel_mgr, StatusCallback done) {
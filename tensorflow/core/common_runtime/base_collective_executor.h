@@ -15,8 +15,11 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_BASE_COLLECTIVE_EXECUTOR_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_BASE_COLLECTIVE_EXECUTOR_H_
 
+#include <map>
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "tensorflow/core/common_runtime/buf_rendezvous.h"
 #include "tensorflow/core/framework/collective.h"
@@ -98,12 +101,7 @@ class BaseCollectiveExecutor : public CollectiveExecutor {
   BaseCollectiveExecutor(CollectiveExecutorMgrInterface* cem,
                          CollectiveRemoteAccess* remote_access, int64_t step_id,
                          const DeviceMgr* dev_mgr,
-                         std::shared_ptr<UnboundedWorkQueue> work_queue)
-      : CollectiveExecutor(cem),
-        step_id_(step_id),
-        dev_mgr_(dev_mgr),
-        remote_access_(remote_access),
-        work_queue_(std::move(work_queue)) {}
+                         std::shared_ptr<UnboundedWorkQueue> work_queue);
 
   ~BaseCollectiveExecutor() override;
 
@@ -150,14 +148,73 @@ class BaseCollectiveExecutor : public CollectiveExecutor {
   Status status_ TF_GUARDED_BY(status_mu_);
 
  private:
+  // A reduction waiting in a fusion bucket.
+  struct PendingReduction {
+    OpKernelContext* ctx;
+    const CollectiveParams* col_params;
+    string exec_key;
+    StatusCallback done;
+  };
+  // The reductions of the local devices for one collective instance.
+  struct PendingInstance {
+    std::vector<PendingReduction> members;
+    int64_t bytes = 0;  // Per device.
+  };
+  // Reductions which may be fused into one, i.e. with the same group, data
+  // type, implementation and reduction ops.
+  struct FusionBucket {
+    // Instances waiting to be fused, by instance key.  Only the instances
+    // whose members on all devices of the group have arrived are fused, so
+    // every device fuses the same instances in the same order.
+    std::map<int32, PendingInstance> instances;
+    int64_t ready_bytes = 0;  // Per device, of the complete instances.
+    // Instances that are run without fusion, by instance key, and the number
+    // of their members yet to arrive.
+    std::unordered_map<int32, int> unfused;
+    bool flush_scheduled = false;
+  };
+
   Status CreateCollective(const CollectiveParams& col_params,
                           CollectiveImplementationInterface** col_impl);
+  // Creates and runs the implementation of the collective.
+  void LaunchCollective(OpKernelContext* ctx,
+                        const CollectiveParams* col_params,
+                        const string& exec_key, const Tensor* input,
+                        Tensor* output, const StatusCallback& done);
+  // Adds the reduction to a fusion bucket and returns true if the reduction
+  // can be fused with others, and returns false otherwise.
+  bool MaybeEnqueueForFusion(OpKernelContext* ctx,
+                             const CollectiveParams* col_params,
+                             const string& exec_key, const StatusCallback& done)
+      TF_LOCKS_EXCLUDED(fusion_mu_);
+  // Runs the complete instances of the bucket fused together, and the others
+  // without fusion.
+  void FlushFusionBucket(const string& bucket_key)
+      TF_LOCKS_EXCLUDED(fusion_mu_);
+  // Removes the complete instances from `bucket` and appends them to
+  // `complete`.
+  void TakeCompleteInstances(FusionBucket* bucket,
+                             std::vector<PendingInstance>* complete)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(fusion_mu_);
+  // Runs `instances` as a single reduction on every device of the group.
+  void RunFusedReductions(std::vector<PendingInstance> instances);
+  // Packs the inputs of `members`, which are all on the same device, into one
+  // tensor, reduces it and unpacks the result into their outputs.
+  void RunFusedReduction(std::vector<PendingReduction> members);
   // Check if all ops on which this collective depends on have launched.
   bool CheckDependencies(const CollectiveParams& col_params)
       TF_EXCLUSIVE_LOCKS_REQUIRED(launch_mu_);
   // Tries to return the status that is the original error. It returns the
   // aborted status if the collective executor is aborted.
   Status GetStatus(const Status& s) TF_LOCKS_EXCLUDED(status_mu_);
+
+  // Reductions of fewer bytes than this are fused.  Zero disables fusion.
+  const int64_t fusion_threshold_bytes_;
+  // How long a reduction may wait for others to be fused with.
+  const int64_t fusion_window_micros_;
+  mutex fusion_mu_;
+  std::unordered_map<string, FusionBucket> fusion_buckets_
+      TF_GUARDED_BY(fusion_mu_);
 };
 
 }  // namespace tensorflow
@@ -0,0 +1,296 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/base_collective_executor.h"
+
+#include <stdlib.h>
+
+#include <memory>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/common_runtime/collective_test_util.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/framework/cancellation.h"
+#include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/framework/device_base.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/platform/strcat.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/version.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr int kNumDevices = 3;
+// Long enough for the reductions never to be flushed by the window, unless the
+// test expects them to be.
+constexpr int64_t kLongWindowMicros = 60 * 1000 * 1000;
+constexpr int64_t kShortWindowMicros = 10 * 1000;
+constexpr int64_t kWaitMicros = 30 * 1000 * 1000;
+
+std::unique_ptr<OpKernel> GetKernel(const string& op, DataType dtype,
+                                    int num_inputs, DeviceBase* device) {
+  NodeDef node_def;
+  NodeDefBuilder builder(strings::StrCat(op, "_node"), op);
+  builder.Attr("T", dtype);
+  for (int i = 0; i < num_inputs; ++i) {
+    builder.Input(FakeInput(dtype));
+  }
+  TF_CHECK_OK(builder.Finalize(&node_def));
+  Status status;
+  std::unique_ptr<OpKernel> kernel = CreateOpKernel(
+      DEVICE_CPU, device, device->GetAllocator(AllocatorAttributes()), node_def,
+      TF_GRAPH_DEF_VERSION, &status);
+  TF_CHECK_OK(status);
+  return kernel;
+}
+
+// Returns the input of `rank` for the instance `instance_key`. The values are
+// small integers, so that the reduced values don't depend on the order of the
+// additions.
+Tensor MakeInput(int32 instance_key, int rank, int num_elements) {
+  Tensor input(DT_FLOAT, TensorShape({num_elements}));
+  for (int i = 0; i < num_elements; ++i) {
+    input.flat<float>()(i) = instance_key * 100 + rank * 10 + i;
+  }
+  return input;
+}
+
+Tensor ExpectedOutput(int32 instance_key, int num_elements) {
+  Tensor expected(DT_FLOAT, TensorShape({num_elements}));
+  for (int i = 0; i < num_elements; ++i) {
+    float sum = 0;
+    for (int rank = 0; rank < kNumDevices; ++rank) {
+      sum += instance_key * 100 + rank * 10 + i;
+    }
+    expected.flat<float>()(i) = sum / kNumDevices;
+  }
+  return expected;
+}
+
+// The part of an all-reduce instance run by one device, through
+// CollectiveExecutor::ExecuteAsync like the collective kernels do.
+class DeviceReduction {
+ public:
+  DeviceReduction(CollectiveTestEnv* test_env, int rank, int32 instance_key,
+                  int num_elements)
+      : test_env_(test_env),
+        instance_key_(instance_key),
+        input_(MakeInput(instance_key, rank, num_elements)),
+        output_(DT_FLOAT, TensorShape({num_elements})) {
+    col_params_ =
+        CreateCollectiveParams(*test_env, rank, "RingReduce",
+                               REDUCTION_COLLECTIVE, DT_FLOAT, input_.shape());
+    col_params_->instance.instance_key = instance_key;
+    const string& device_name = col_params_->group.members[rank].device.name();
+    TF_CHECK_OK(test_env->device_mgr->LookupDevice(device_name, &device_));
+    merge_op_ = GetKernel("Add", DT_FLOAT, /*num_inputs=*/2, device_);
+    final_op_ = GetKernel("Div", DT_FLOAT, /*num_inputs=*/2, device_);
+    col_params_->merge_op = merge_op_.get();
+    col_params_->final_op = final_op_.get();
+    CollectiveImplementationInterface* col_impl = nullptr;
+    TF_CHECK_OK(CollectiveRegistry::Lookup("RingReduce", &col_impl));
+    core::ScopedUnref unref(col_impl);
+    TF_CHECK_OK(col_impl->InitializeCollectiveParams(col_params_.get()));
+
+    identity_ = GetKernel("Identity", DT_FLOAT, /*num_inputs=*/1, device_);
+    device_context_ = new DeviceContext;
+    inputs_.push_back(TensorValue(&input_));
+    input_alloc_attrs_.push_back(AllocatorAttributes());
+    op_params_.step_id = 0;
+    op_params_.device = device_;
+    op_params_.op_kernel = identity_.get();
+    op_params_.cancellation_manager = &cancellation_manager_;
+    op_params_.inputs = &inputs_;
+    op_params_.input_alloc_attrs = &input_alloc_attrs_;
+    op_params_.op_device_context = device_context_;
+    op_params_.output_attr_array = &output_alloc_attr_;
+    op_params_.resource_manager = device_->resource_manager();
+    ctx_ = absl::make_unique<OpKernelContext>(&op_params_, 1);
+    ctx_->set_output(0, output_);
+  }
+
+  ~DeviceReduction() {
+    ctx_.reset();
+    device_context_->Unref();
+  }
+
+  void Start() {
+    test_env_->col_exec->ExecuteAsync(
+        ctx_.get(), col_params_.get(), strings::StrCat(instance_key_, ":0:0"),
+        [this](const Status& s) {
+          status_ = s;
+          done_.Notify();
+        });
+  }
+
+  // Waits for the reduction and checks its result.
+  void ExpectDone() {
+    ASSERT_TRUE(WaitForNotificationWithTimeout(&done_, kWaitMicros));
+    TF_EXPECT_OK(status_);
+    test::ExpectTensorEqual<float>(
+        ExpectedOutput(instance_key_, output_.NumElements()), output_);
+  }
+
+  const Tensor& output() const { return output_; }
+
+ private:
+  CollectiveTestEnv* test_env_;
+  const int32 instance_key_;
+  Tensor input_;
+  Tensor output_;
+  Device* device_ = nullptr;
+  core::RefCountPtr<CollectiveParams> col_params_;
+  std::unique_ptr<OpKernel> merge_op_;
+  std::unique_ptr<OpKernel> final_op_;
+  std::unique_ptr<OpKernel> identity_;
+  DeviceContext* device_context_ = nullptr;
+  CancellationManager cancellation_manager_;
+  gtl::InlinedVector<TensorValue, 4> inputs_;
+  gtl::InlinedVector<AllocatorAttributes, 4> input_alloc_attrs_;
+  AllocatorAttributes output_alloc_attr_;
+  OpKernelContext::Params op_params_;
+  std::unique_ptr<OpKernelContext> ctx_;
+  Status status_;
+  Notification done_;
+};
+
+class BaseCollectiveExecutorFusionTest : public ::testing::Test {
+ protected:
+  // Creates the executor, which reads the fusion settings when constructed.
+  void Init(int64_t threshold_bytes, int64_t window_micros) {
+    setenv("TF_COLLECTIVE_REDUCE_FUSION_BYTES",
+           strings::StrCat(threshold_bytes).c_str(), /*overwrite=*/1);
+    setenv("TF_COLLECTIVE_REDUCE_FUSION_WINDOW_US",
+           strings::StrCat(window_micros).c_str(), /*overwrite=*/1);
+    test_env_ = CreateCollectiveTestEnv(/*num_workers=*/1, kNumDevices,
+                                        DEVICE_CPU);
+  }
+
+  // Adds the reductions of `instance_key` on every device, without starting
+  // them.
+  std::vector<DeviceReduction*> AddInstance(int32 instance_key,
+                                            int num_elements) {
+    std::vector<DeviceReduction*> instance;
+    for (int rank = 0; rank < kNumDevices; ++rank) {
+      reductions_.push_back(absl::make_unique<DeviceReduction>(
+          test_env_.get(), rank, instance_key, num_elements));
+      instance.push_back(reductions_.back().get());
+    }
+    return instance;
+  }
+
+  void TearDown() override {
+    unsetenv("TF_COLLECTIVE_REDUCE_FUSION_BYTES");
+    unsetenv("TF_COLLECTIVE_REDUCE_FUSION_WINDOW_US");
+  }
+
+  std::unique_ptr<CollectiveTestEnv> test_env_;
+  std::vector<std::unique_ptr<DeviceReduction>> reductions_;
+};
+
+// Runs `reductions` and returns their outputs.
+std::vector<Tensor> RunReductions(
+    const std::vector<DeviceReduction*>& reductions) {
+  for (DeviceReduction* reduction : reductions) {
+    reduction->Start();
+  }
+  std::vector<Tensor> outputs;
+  for (DeviceReduction* reduction : reductions) {
+    reduction->ExpectDone();
+    outputs.push_back(reduction->output());
+  }
+  return outputs;
+}
+
+TEST_F(BaseCollectiveExecutorFusionTest, FusedReductionsMatchUnfused) {
+  const std::vector<int> num_elements = {3, 5, 7};
+  // The instances are fused once all of them arrived, long before the window
+  // expires.
+  Init(/*threshold_bytes=*/(3 + 5 + 7) * sizeof(float), kLongWindowMicros);
+  std::vector<DeviceReduction*> fused;
+  for (int i = 0; i < num_elements.size(); ++i) {
+    std::vector<DeviceReduction*> instance =
+        AddInstance(i + 1, num_elements[i]);
+    fused.insert(fused.end(), instance.begin(), instance.end());
+  }
+  const std::vector<Tensor> fused_outputs = RunReductions(fused);
+
+  reductions_.clear();
+  Init(/*threshold_bytes=*/0, kLongWindowMicros);
+  std::vector<DeviceReduction*> unfused;
+  for (int i = 0; i < num_elements.size(); ++i) {
+    std::vector<DeviceReduction*> instance =
+        AddInstance(i + 1, num_elements[i]);
+    unfused.insert(unfused.end(), instance.begin(), instance.end());
+  }
+  const std::vector<Tensor> unfused_outputs = RunReductions(unfused);
+
+  ASSERT_EQ(fused_outputs.size(), unfused_outputs.size());
+  for (int i = 0; i < fused_outputs.size(); ++i) {
+    test::ExpectTensorEqual<float>(unfused_outputs[i], fused_outputs[i]);
+  }
+}
+
+TEST_F(BaseCollectiveExecutorFusionTest, FlushesBucketAfterWindow) {
+  // The instance never reaches the threshold, so it waits for the window and
+  // then runs without fusion since there is nothing to fuse it with.
+  Init(/*threshold_bytes=*/1 << 20, kShortWindowMicros);
+  for (DeviceReduction* reduction : AddInstance(1, /*num_elements=*/4)) {
+    reduction->Start();
+  }
+  for (const auto& reduction : reductions_) {
+    reduction->ExpectDone();
+  }
+}
+
+TEST_F(BaseCollectiveExecutorFusionTest, LateMembersRunUnfused) {
+  Init(/*threshold_bytes=*/1 << 20, kShortWindowMicros);
+  std::vector<DeviceReduction*> late = AddInstance(1, /*num_elements=*/4);
+  std::vector<DeviceReduction*> complete = AddInstance(2, /*num_elements=*/4);
+  for (int rank = 0; rank < kNumDevices - 1; ++rank) {
+    late[rank]->Start();
+  }
+  for (DeviceReduction* reduction : complete) {
+    reduction->Start();
+  }
+  // The window expires before the last member of the first instance arrives,
+  // so the members that arrived run without fusion, and so does the last one.
+  Env::Default()->SleepForMicroseconds(10 * kShortWindowMicros);
+  late[kNumDevices - 1]->Start();
+  for (const auto& reduction : reductions_) {
+    reduction->ExpectDone();
+  }
+
+  // The bucket is still usable once the late instance is done.
+  for (DeviceReduction* reduction : AddInstance(3, /*num_elements=*/4)) {
+    reduction->Start();
+  }
+  for (const auto& reduction : reductions_) {
+    reduction->ExpectDone();
+  }
+}
+
+}  // namespace
+}  // namespace tensorflow
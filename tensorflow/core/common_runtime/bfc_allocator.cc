@@ -22,6 +22,8 @@ limitations under the License.
 #include "absl/strings/string_view.h"
 #include "tensorflow/core/common_runtime/allocator_retry.h"
 #include "tensorflow/core/lib/core/bits.h"
+#include "tensorflow/core/lib/monitoring/gauge.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
@@ -40,6 +42,31 @@ namespace tensorflow {
 
 constexpr BFCAllocator::ChunkHandle BFCAllocator::kInvalidChunkHandle;
 
+namespace {
+auto* bytes_in_use_gauge = monitoring::Gauge<int64_t, 1>::New(
+    "/tensorflow/core/bfc_allocator/bytes_in_use",
+    "Bytes allocated to clients, as of the last memory summary.",
+    "allocator_name");
+auto* bytes_reserved_gauge = monitoring::Gauge<int64_t, 1>::New(
+    "/tensorflow/core/bfc_allocator/region_bytes",
+    "Bytes obtained from the sub-allocator, as of the last memory summary.",
+    "allocator_name");
+auto* largest_free_chunk_gauge = monitoring::Gauge<int64_t, 1>::New(
+    "/tensorflow/core/bfc_allocator/largest_free_chunk_bytes",
+    "Size of the largest free chunk, as of the last memory summary.",
+    "allocator_name");
+auto* num_regions_gauge = monitoring::Gauge<int64_t, 1>::New(
+    "/tensorflow/core/bfc_allocator/num_regions",
+    "Number of regions, as of the last memory summary.", "allocator_name");
+auto* fragmentation_sampler = monitoring::Sampler<1>::New(
+    {"/tensorflow/core/bfc_allocator/fragmentation",
+     "Fraction of free region bytes outside the largest free chunk, sampled "
+     "at each memory summary.",
+     "allocator_name"},
+    {monitoring::Buckets::Explicit(
+        {0.1, 0.2, 0.3, 0.4, 0.5, 0.6, 0.7, 0.8, 0.9, 0.95, 0.99})});
+}  // namespace
+
 BFCAllocator::BFCAllocator(std::unique_ptr<SubAllocator> sub_allocator,
                            size_t total_memory, const string& name,
                            const Options& opts)
@@ -236,8 +263,8 @@ void* BFCAllocator::AllocateRawInternalWithRetry(
   if (allocation_attr.freed_by_func != nullptr) {
     freed_by_count = (*allocation_attr.freed_by_func)();
   }
-  void* r =
-      AllocateRawInternal(unused_alignment, num_bytes, false, freed_by_count);
+  void* r = AllocateRawInternal(unused_alignment, num_bytes, false,
+                                freed_by_count, allocation_attr.stream_id);
   if (r != nullptr) {
     return r;
   } else {
@@ -248,7 +275,8 @@ void* BFCAllocator::AllocateRawInternalWithRetry(
           if (allocation_attr.freed_by_func != nullptr) {
             freed_by_count = (*allocation_attr.freed_by_func)();
           }
-          return AllocateRawInternal(a, nb, v, freed_by_count);
+          return AllocateRawInternal(a, nb, v, freed_by_count,
+                                     allocation_attr.stream_id);
         },
         kMaxMillisToWait, unused_alignment, num_bytes);
     return r;
@@ -281,8 +309,9 @@ void* BFCAllocator::AllocateRaw(size_t unused_alignment, size_t num_bytes,
       if (allocation_attr.freed_by_func != nullptr) {
         freed_by_count = (*allocation_attr.freed_by_func)();
       }
-      void* res = AllocateRawInternal(unused_alignment, num_bytes,
-                                      dump_log_on_failure, freed_by_count);
+      void* res =
+          AllocateRawInternal(unused_alignment, num_bytes, dump_log_on_failure,
+                              freed_by_count, allocation_attr.stream_id);
       if (res == nullptr) {
         int32 counter_value = log_counter.load(std::memory_order_relaxed);
         if (counter_value < kMaxFailureLogs) {
@@ -326,25 +355,8 @@ bool BFCAllocator::DeallocateFreeRegions(size_t rounded_bytes)
 
   // Searching for free regions.
   absl::flat_hash_set<void*> free_region_ptrs;
-  size_t total_free_bytes = 0;
-  for (const AllocationRegion& region : region_manager_.regions()) {
-    ChunkHandle h = region_manager_.get_handle(region.ptr());
-    bool any_use = false;
-    while (h != kInvalidChunkHandle) {
-      const Chunk* c = ChunkFromHandle(h);
-      if (c->in_use()) {
-        any_use = true;
-        break;
-      }
-      h = c->next;
-    }
-
-    if (!any_use) {
-      VLOG(2) << "Found free region with ptr = " << region.ptr();
-      free_region_ptrs.insert(region.ptr());
-      total_free_bytes += region.memory_size();
-    }
-  }
+  size_t total_free_bytes =
+      FindFreeRegions(/*only_safe=*/false, &free_region_ptrs);
 
   if (total_free_bytes == 0) {
     return false;
@@ -373,6 +385,52 @@ bool BFCAllocator::DeallocateFreeRegions(size_t rounded_bytes)
   return true;
 }
 
+size_t BFCAllocator::FindFreeRegions(bool only_safe,
+                                     absl::flat_hash_set<void*>* region_ptrs) {
+  size_t total_free_bytes = 0;
+  for (const AllocationRegion& region : region_manager_.regions()) {
+    ChunkHandle h = region_manager_.get_handle(region.ptr());
+    bool any_use = false;
+    while (h != kInvalidChunkHandle) {
+      const Chunk* c = ChunkFromHandle(h);
+      if (c->in_use() || (only_safe && c->freed_at_count > 0)) {
+        any_use = true;
+        break;
+      }
+      h = c->next;
+    }
+
+    if (!any_use) {
+      VLOG(2) << "Found free region with ptr = " << region.ptr();
+      region_ptrs->insert(region.ptr());
+      total_free_bytes += region.memory_size();
+    }
+  }
+  return total_free_bytes;
+}
+
+size_t BFCAllocator::ReleaseFreeRegions(double min_reserved_fraction) {
+  mutex_lock l(lock_);
+  if (total_region_allocated_bytes_ < min_reserved_fraction * memory_limit_) {
+    return 0;
+  }
+  if (!timestamped_chunks_.empty()) {
+    // Chunks whose counts have become safe no longer hold their regions.
+    MergeTimestampedChunks(0);
+  }
+
+  absl::flat_hash_set<void*> free_region_ptrs;
+  const size_t free_bytes =
+      FindFreeRegions(/*only_safe=*/true, &free_region_ptrs);
+  if (free_bytes > 0) {
+    VLOG(1) << "Releasing " << free_region_ptrs.size() << " free regions ("
+            << strings::HumanReadableNumBytes(free_bytes) << ") of "
+            << Name();
+    DeallocateRegions(free_region_ptrs);
+  }
+  return free_bytes;
+}
+
 void BFCAllocator::DeallocateRegions(
     const absl::flat_hash_set<void*>& region_ptrs)
     TF_EXCLUSIVE_LOCKS_REQUIRED(lock_) {
@@ -411,7 +469,7 @@ void BFCAllocator::DeallocateRegions(
 void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
                                         size_t num_bytes,
                                         bool dump_log_on_failure,
-                                        uint64 freed_before) {
+                                        uint64 freed_before, int stream_id) {
   if (num_bytes == 0) {
     VLOG(2) << "tried to allocate 0 bytes";
     return nullptr;
@@ -429,17 +487,21 @@ void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
     // Merge timestamped chunks whose counts have become safe for general use.
     MergeTimestampedChunks(0);
   }
-  void* ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before);
+  void* ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before,
+                           stream_id);
   if (ptr != nullptr) {
     AddTraceMe("MemoryAllocation", ptr);
+    MaybeRecordMemorySummary(ptr);
     return ptr;
   }
 
   // Try to extend
   if (Extend(unused_alignment, rounded_bytes)) {
-    ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before);
+    ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before,
+                       stream_id);
     if (ptr != nullptr) {
       AddTraceMe("MemoryAllocation", ptr);
+      MaybeRecordMemorySummary(ptr);
       return ptr;
     }
   }
@@ -450,9 +512,11 @@ void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
     // timestamped chunks more aggressively until a free chunk of the necessary
     // size is formed.
     if (MergeTimestampedChunks(rounded_bytes)) {
-      ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before);
+      ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before,
+                         stream_id);
       if (ptr != nullptr) {
         AddTraceMe("MemoryAllocation", ptr);
+        MaybeRecordMemorySummary(ptr);
         return ptr;
       }
     }
@@ -464,9 +528,11 @@ void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
   // the unallocated bytes and form a larger region.
   if (DeallocateFreeRegions(rounded_bytes) &&
       Extend(unused_alignment, rounded_bytes)) {
-    ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before);
+    ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before,
+                       stream_id);
     if (ptr != nullptr) {
       AddTraceMe("MemoryAllocation", ptr);
+      MaybeRecordMemorySummary(ptr);
       return ptr;
     }
   }
@@ -509,6 +575,66 @@ double BFCAllocator::GetFragmentation() {
          bytes_available;
 }
 
+void BFCAllocator::MaybeRecordMemorySummary(const void* ptr) {
+  if (opts_.memory_summary_period <= 0 ||
+      ++allocations_since_summary_ < opts_.memory_summary_period) {
+    return;
+  }
+  allocations_since_summary_ = 0;
+
+  const int64_t largest_free_chunk = LargestFreeChunk();
+  const int64_t bytes_free =
+      total_region_allocated_bytes_ - stats_.bytes_in_use;
+  const double fragmentation =
+      bytes_free > 0
+          ? static_cast<double>(bytes_free - largest_free_chunk) / bytes_free
+          : 0;
+  bytes_in_use_gauge->GetCell(name_)->Set(stats_.bytes_in_use);
+  bytes_reserved_gauge->GetCell(name_)->Set(total_region_allocated_bytes_);
+  largest_free_chunk_gauge->GetCell(name_)->Set(largest_free_chunk);
+  num_regions_gauge->GetCell(name_)->Set(region_manager_.regions().size());
+  fragmentation_sampler->GetCell(name_)->Add(fragmentation);
+
+  const Chunk* sample = ChunkFromHandle(region_manager_.get_handle(ptr));
+  const int64_t sample_requested_bytes = sample->requested_size;
+  tensorflow::profiler::TraceMe::InstantActivity(
+      [&]() TF_NO_THREAD_SAFETY_ANALYSIS {
+        // Walking every chunk is linear in their number, so per-region
+        // summaries are only built while profiling.
+        std::string regions;
+        for (const auto& region : region_manager_.regions()) {
+          int64_t region_free = 0;
+          int64_t region_largest_free = 0;
+          for (ChunkHandle h = region_manager_.get_handle(region.ptr());
+               h != kInvalidChunkHandle; h = ChunkFromHandle(h)->next) {
+            const Chunk* c = ChunkFromHandle(h);
+            if (c->in_use()) continue;
+            region_free += c->size;
+            region_largest_free =
+                std::max<int64_t>(region_largest_free, c->size);
+          }
+          strings::StrAppend(&regions, regions.empty() ? "" : ";",
+                             reinterpret_cast<uint64>(region.ptr()), ":",
+                             region.memory_size(), ":", region_free, ":",
+                             region_largest_free);
+        }
+        const auto& annotation =
+            profiler::ScopedMemoryDebugAnnotation::CurrentAnnotation();
+        return tensorflow::profiler::TraceMeEncode(
+            "MemorySummary",
+            {{"allocator_name", name_},
+             {"bytes_allocated", stats_.bytes_in_use},
+             {"region_bytes", total_region_allocated_bytes_},
+             {"largest_free_chunk", largest_free_chunk},
+             {"fragmentation", fragmentation},
+             // Each region as "address:size:free_bytes:largest_free_chunk".
+             {"regions", regions},
+             {"sample_requested_bytes", sample_requested_bytes},
+             {"sample_tf_op", annotation.pending_op_name}});
+      },
+      /*level=*/profiler::TraceMeLevel::kInfo);
+}
+
 void BFCAllocator::AddTraceMe(absl::string_view traceme_name, const void* ptr) {
   BFCAllocator::Chunk* chunk = ChunkFromHandle(region_manager_.get_handle(ptr));
   AddTraceMe(traceme_name, chunk->ptr, chunk->requested_size, chunk->size);
@@ -544,7 +670,23 @@ void BFCAllocator::AddTraceMe(absl::string_view traceme_name,
 }
 
 void* BFCAllocator::FindChunkPtr(BinNum bin_num, size_t rounded_bytes,
-                                 size_t num_bytes, uint64 freed_before) {
+                                 size_t num_bytes, uint64 freed_before,
+                                 int stream_id) {
+  void* ptr = FindChunkPtrForStream(bin_num, rounded_bytes, num_bytes,
+                                    freed_before, stream_id,
+                                    /*cross_stream=*/false);
+  if (ptr == nullptr && stream_id >= 0) {
+    ptr = FindChunkPtrForStream(bin_num, rounded_bytes, num_bytes,
+                                freed_before, stream_id,
+                                /*cross_stream=*/true);
+  }
+  return ptr;
+}
+
+void* BFCAllocator::FindChunkPtrForStream(BinNum bin_num, size_t rounded_bytes,
+                                          size_t num_bytes,
+                                          uint64 freed_before, int stream_id,
+                                          bool cross_stream) {
   // First identify the first bin that could satisfy rounded_bytes.
   for (; bin_num < kNumBins; bin_num++) {
     // Start searching from the first bin for the smallest chunk that fits
@@ -559,6 +701,13 @@ void* BFCAllocator::FindChunkPtr(BinNum bin_num, size_t rounded_bytes,
         continue;
       }
       if (chunk->size >= rounded_bytes) {
+        // A chunk last used on another stream can only be used once this
+        // stream waits for that one.
+        if (chunk->stream_id >= 0 && chunk->stream_id != stream_id &&
+            (!cross_stream || !WaitForStream(stream_id, chunk->stream_id))) {
+          continue;
+        }
+
         // We found an existing chunk that fits us that wasn't in use, so remove
         // it from the free bin structure prior to using.
         RemoveFreeChunkIterFromBin(&b->free_chunks, citer);
@@ -582,6 +731,7 @@ void* BFCAllocator::FindChunkPtr(BinNum bin_num, size_t rounded_bytes,
         // The requested size of the returned chunk is what the user
         // has allocated.
         chunk->requested_size = num_bytes;
+        if (stream_id >= 0) chunk->stream_id = stream_id;
         // Assign a unique id and increment the id counter, marking the
         // chunk as being in use.
         chunk->allocation_id = next_allocation_id_++;
@@ -650,8 +800,9 @@ void BFCAllocator::SplitChunk(BFCAllocator::ChunkHandle h, size_t num_bytes) {
   // The new chunk is not in use.
   new_chunk->allocation_id = -1;
 
-  // It inherits the freed time.
+  // It inherits the freed time and stream.
   new_chunk->freed_at_count = c->freed_at_count;
+  new_chunk->stream_id = c->stream_id;
 
   // Maintain the pointers.
   // c <-> c_neighbor becomes
@@ -742,6 +893,10 @@ void BFCAllocator::Merge(BFCAllocator::ChunkHandle h1,
   // Pick latest free time.
   c1->freed_at_count = std::max(c1->freed_at_count, c2->freed_at_count);
 
+  // Chunks of different streams are never merged, see CanMerge().
+  DCHECK(CanMerge(c1, c2));
+  if (c1->stream_id < 0) c1->stream_id = c2->stream_id;
+
   DeleteChunk(h2);
 }
 
@@ -813,7 +968,7 @@ BFCAllocator::ChunkHandle BFCAllocator::TryToCoalesce(ChunkHandle h,
   // If the next chunk is free, merge it into c and delete it.
   if (c->next != kInvalidChunkHandle && !ChunkFromHandle(c->next)->in_use()) {
     Chunk* n = ChunkFromHandle(c->next);
-    if ((n->freed_at_count == 0) || ignore_freed_at) {
+    if (((n->freed_at_count == 0) || ignore_freed_at) && CanMerge(c, n)) {
       VLOG(4) << "Merging c->next " << n->ptr << " with c " << c->ptr;
       RemoveFreeChunkFromBin(c->next);
       Merge(h, c->next);
@@ -823,7 +978,7 @@ BFCAllocator::ChunkHandle BFCAllocator::TryToCoalesce(ChunkHandle h,
   // If the previous chunk is free, merge c into it and delete c.
   if (c->prev != kInvalidChunkHandle && !ChunkFromHandle(c->prev)->in_use()) {
     Chunk* n = ChunkFromHandle(c->prev);
-    if ((n->freed_at_count == 0) || ignore_freed_at) {
+    if (((n->freed_at_count == 0) || ignore_freed_at) && CanMerge(n, c)) {
       VLOG(4) << "Merging c " << c->ptr << " into c->prev " << n->ptr;
       coalesced_chunk = c->prev;
       RemoveFreeChunkFromBin(c->prev);
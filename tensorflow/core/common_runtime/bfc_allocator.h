@@ -66,6 +66,13 @@ class BFCAllocator : public Allocator {
     // Controls when a chunk should be split, if its size exceeds the requested
     // allocation size.
     double fragmentation_fraction = 0;
+
+    // If positive, every memory_summary_period-th allocation exports a summary
+    // of the allocator's memory (bytes in use and reserved, largest free
+    // chunk, fragmentation, and per-region free space) to lib/monitoring and,
+    // while profiling, as a "MemorySummary" TraceMe event. Unlike per-
+    // allocation TraceMes, this is cheap enough to leave on in production.
+    int64_t memory_summary_period = 0;
   };
   BFCAllocator(std::unique_ptr<SubAllocator> sub_allocator, size_t total_memory,
                const string& name, const Options& opts);
@@ -105,12 +112,35 @@ class BFCAllocator : public Allocator {
 
   MemoryDump RecordMemoryMap();
 
+  // Returns the memory of the regions without chunks in use to the
+  // SubAllocator, if the allocator has reserved at least
+  // `min_reserved_fraction` of its memory limit. This undoes the fragmentation
+  // of a long-running growing allocator, whose free memory may otherwise be
+  // split over regions too small for new allocations. Returns the number of
+  // bytes released.
+  //
+  // Only call this at a point where the device can't still be using memory
+  // that was freed, e.g. right after synchronizing it.
+  size_t ReleaseFreeRegions(double min_reserved_fraction = 0);
+
+ protected:
+  // Makes the work enqueued on stream `stream_id` from now on wait for the
+  // work already enqueued on stream `other_stream_id`, so that a free chunk
+  // last used on the latter can be used on the former. Returns false if that
+  // isn't possible, in which case the chunk isn't used for the allocation.
+  //
+  // Called with the allocator lock held, so it must not call back into the
+  // allocator. The default implementation never reuses memory across streams.
+  virtual bool WaitForStream(int stream_id, int other_stream_id) {
+    return false;
+  }
+
  private:
   struct Bin;
 
   void* AllocateRawInternal(size_t alignment, size_t num_bytes,
                             bool dump_log_on_failure,
-                            uint64 freed_before_count);
+                            uint64 freed_before_count, int stream_id);
 
   void* AllocateRawInternalWithRetry(
       size_t alignment, size_t num_bytes,
@@ -150,6 +180,11 @@ class BFCAllocator : public Allocator {
                   int64_t req_bytes, int64_t alloc_bytes)
       TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
+  // Exports a memory summary, with the allocation at `ptr` as the sample, if
+  // this is the memory_summary_period-th allocation since the last one.
+  void MaybeRecordMemorySummary(const void* ptr)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
   // A ChunkHandle is an index into the chunks_ vector in BFCAllocator
   // kInvalidChunkHandle means an invalid chunk
   typedef size_t ChunkHandle;
@@ -206,6 +241,11 @@ class BFCAllocator : public Allocator {
     // Optional count when this chunk was most recently made free.
     uint64 freed_at_count = 0;
 
+    // The stream the chunk was last allocated for, or -1. A free chunk can be
+    // used again on that stream right away, but only after WaitForStream() on
+    // any other stream.
+    int stream_id = -1;
+
     bool in_use() const { return allocation_id != -1; }
 
 #ifdef TENSORFLOW_MEM_DEBUG
@@ -459,14 +499,37 @@ class BFCAllocator : public Allocator {
   // found and freed; false otherwise.
   bool DeallocateFreeRegions(size_t rounded_bytes);
 
+  // Adds the regions without chunks in use to `region_ptrs` and returns their
+  // total size. If `only_safe` is true, regions with chunks whose
+  // freed_at_count is not yet safe are skipped as well.
+  size_t FindFreeRegions(bool only_safe,
+                         absl::flat_hash_set<void*>* region_ptrs)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
   // Helper function to deallocate regions.
   void DeallocateRegions(const absl::flat_hash_set<void*>& region_ptrs)
       TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
   // Returns a pointer to an underlying allocated chunk of size
-  // 'rounded_bytes'.
+  // 'rounded_bytes' for use on stream 'stream_id'. Chunks last used on other
+  // streams are only considered if no other chunk fits.
   void* FindChunkPtr(BinNum bin_num, size_t rounded_bytes, size_t num_bytes,
-                     uint64 freed_before) TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+                     uint64 freed_before, int stream_id)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Helper for FindChunkPtr that considers chunks last used on other streams
+  // iff 'cross_stream' is true.
+  void* FindChunkPtrForStream(BinNum bin_num, size_t rounded_bytes,
+                              size_t num_bytes, uint64 freed_before,
+                              int stream_id, bool cross_stream)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Returns whether the free chunks c1 and c2 can be merged, i.e. whether they
+  // weren't last used on different streams.
+  static bool CanMerge(const Chunk* c1, const Chunk* c2) {
+    return c1->stream_id < 0 || c2->stream_id < 0 ||
+           c1->stream_id == c2->stream_id;
+  }
 
   // Splits the chunk specified by 'h' into two chunks, one at least
   // of size 'num_bytes'.
@@ -594,6 +657,10 @@ class BFCAllocator : public Allocator {
   SharedCounter* timing_counter_ = nullptr;
   std::deque<ChunkHandle> timestamped_chunks_;
 
+  // Allocations since the last memory summary; see
+  // Options::memory_summary_period.
+  int64_t allocations_since_summary_ TF_GUARDED_BY(lock_) = 0;
+
   std::atomic<uint64> safe_frontier_ = {0};
 
   // Structures mutable after construction
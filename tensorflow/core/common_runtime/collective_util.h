@@ -46,6 +46,8 @@ class SubContext {
   std::unique_ptr<OpKernelContext> sub_ctx_;
   SubContext(OpKernelContext* ctx, OpKernelContext::Params* params,
              OpKernel* op, Tensor* output, Tensor* input);
+  SubContext(OpKernelContext* ctx, OpKernelContext::Params* params,
+             OpKernel* op, Tensor* input);
   ~SubContext() = default;
 };
 
@@ -53,6 +55,12 @@ Status ComputeBinOp(OpKernelContext* op_ctx, OpKernelContext::Params* params,
                     Device* device, OpKernel* op, Tensor* output,
                     Tensor* input);
 
+// Computes the unary `op` on `input` and sets `output` to its result, which
+// may have a different data type.
+Status ComputeUnaryOp(OpKernelContext* op_ctx,
+                      OpKernelContext::Params* params, Device* device,
+                      OpKernel* op, Tensor* input, Tensor* output);
+
 }  // namespace collective_util
 }  // namespace tensorflow
 
@@ -39,6 +39,7 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/flatset.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/denormal.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/setround.h"
 #include "tensorflow/core/public/session_options.h"
 
@@ -482,17 +483,103 @@ Graph* GetConstantGraph(
   return constant_graph;
 }
 
+// Folded values of at least this size are looked up in ConstantsByValue, so
+// that a large value ends up in the graph only once.
+constexpr int64_t kMinSharedConstantSizeInBytes = 1024;
+
+// The Const nodes of a graph that hold large values, by value.
+class ConstantsByValue {
+ public:
+  // Returns a Const node with value `value` and control dependencies
+  // `control_deps`, or nullptr if there is none.
+  Node* Find(const Tensor& value,
+             const gtl::FlatSet<Node*>& control_deps) const {
+    if (!IsShareable(value)) return nullptr;
+    auto it = entries_.find(Key(value));
+    if (it == entries_.end()) return nullptr;
+    for (const Entry& entry : it->second) {
+      if (entry.value.dtype() == value.dtype() &&
+          entry.value.shape() == value.shape() &&
+          entry.value.tensor_data() == value.tensor_data() &&
+          entry.control_deps == control_deps) {
+        return entry.node;
+      }
+    }
+    return nullptr;
+  }
+
+  // Adds `node`, a Const node with value `value` and control dependencies
+  // `control_deps`.
+  void Add(Node* node, const Tensor& value,
+           const gtl::FlatSet<Node*>& control_deps) {
+    if (!IsShareable(value)) return;
+    entries_[Key(value)].push_back({node, value, control_deps});
+  }
+
+ private:
+  struct Entry {
+    Node* node;
+    Tensor value;
+    gtl::FlatSet<Node*> control_deps;
+  };
+
+  static bool IsShareable(const Tensor& value) {
+    return DataTypeCanUseMemcpy(value.dtype()) &&
+           value.TotalBytes() >= kMinSharedConstantSizeInBytes;
+  }
+
+  static uint64 Key(const Tensor& value) {
+    return FingerprintCat64(Fingerprint64(value.tensor_data()), value.dtype());
+  }
+
+  std::unordered_map<uint64, std::vector<Entry>> entries_;
+};
+
+// Adds the Const nodes among `nodes` that are placed like the constants
+// created on `partition_device` to `constants`.
+void AddExistingConstants(
+    const std::vector<Node*>& nodes, const Device* partition_device,
+    const std::unordered_map<const Node*, gtl::FlatSet<Node*>>&
+        constant_control_deps,
+    ConstantsByValue* constants) {
+  for (Node* n : nodes) {
+    if (n->type_string() != "Const") continue;
+    if (partition_device
+            ? n->assigned_device_name() != partition_device->name()
+            : !n->assigned_device_name().empty() ||
+                  !n->requested_device().empty()) {
+      continue;
+    }
+    const TensorProto* proto;
+    Tensor value;
+    // Only parse values that are large enough to be shared.
+    if (!TryGetNodeAttr(n->attrs(), "value", &proto) ||
+        !TensorShape::IsValid(proto->tensor_shape()) ||
+        TensorShape(proto->tensor_shape()).num_elements() *
+                DataTypeSize(proto->dtype()) <
+            kMinSharedConstantSizeInBytes ||
+        !value.FromProto(*proto)) {
+      continue;
+    }
+    constants->Add(n, value, constant_control_deps.at(n));
+  }
+}
+
 // Replaces the identified Tensor in 'graph' by a 'Const' node with
 // the value supplied in 'constant'. 'partition_device', if non-null
 // is the device where the graph executes. Returns true if the
 // replacement was successful, false otherwise.
 // 'control_deps' is the set of nodes that should be control predecessors of the
-// new constant node.
+// new constant node. If 'constants' has a node with the same value and control
+// dependencies, that node is used instead of a new one. Otherwise the size of
+// the new constant is subtracted from 'remaining_bytes', and the replacement
+// fails if there are not enough remaining bytes.
 bool ReplaceTensorWithConstant(
     Graph* graph, const Device* partition_device, NodeAndOutput tensor,
     const Tensor& constant, const gtl::FlatSet<Node*>& control_deps,
     int64_t max_constant_size_in_bytes,
-    const ConstantFoldNameGenerator& generate_new_name) {
+    const ConstantFoldNameGenerator& generate_new_name,
+    ConstantsByValue* constants, int64_t* remaining_bytes) {
   // Be conservative when replacing a tensor with a constant, when not
   // running on CPU.
   // 1) Do not replace another constant.
@@ -531,10 +618,6 @@ bool ReplaceTensorWithConstant(
       }
     }
   }
-  if (constant.TotalBytes() > max_constant_size_in_bytes) {
-    return false;
-  }
-
   Node* n = tensor.first;
   std::vector<const Edge*> edges_to_remove;
   for (const Edge* out_edge : n->out_edges()) {
@@ -542,6 +625,27 @@ bool ReplaceTensorWithConstant(
       edges_to_remove.push_back(out_edge);
     }
   }
+  Node* shared_node = constants->Find(constant, control_deps);
+  if (shared_node != nullptr) {
+    VLOG(1) << "Replacing " << tensor.first->name() << " :: " << tensor.second
+            << " with the equal constant " << shared_node->name();
+    for (auto edge : edges_to_remove) {
+      graph->AddEdge(shared_node, 0, edge->dst(), edge->dst_input());
+      graph->RemoveEdge(edge);
+    }
+    return true;
+  }
+
+  if (constant.TotalBytes() > max_constant_size_in_bytes) {
+    return false;
+  }
+  if (constant.TotalBytes() > *remaining_bytes) {
+    VLOG(1) << "Not replacing " << tensor.first->name() << " :: "
+            << tensor.second << " with a constant of " << constant.TotalBytes()
+            << " bytes, which exceeds the remaining budget of "
+            << *remaining_bytes << " bytes";
+    return false;
+  }
   const string& node_name = n->name();
   Node* constant_node;
   auto builder = NodeDefBuilder(generate_new_name(graph, node_name), "Const")
@@ -579,6 +683,8 @@ bool ReplaceTensorWithConstant(
   if (partition_device) {
     constant_node->set_assigned_device_name(partition_device->name());
   }
+  *remaining_bytes -= constant.TotalBytes();
+  constants->Add(constant_node, constant, control_deps);
   return true;
 }
 
@@ -649,7 +755,8 @@ Status ConstantFold(const ConstantFoldingOptions& opts,
     tensors_to_replace.push_back(n.second);
   }
 
-  auto graph_runner = std::unique_ptr<GraphRunner>(new GraphRunner(env));
+  auto graph_runner = std::unique_ptr<GraphRunner>(
+      opts.runner ? new GraphRunner(env, opts.runner) : new GraphRunner(env));
   // Evaluate the constant foldable nodes.
   std::vector<Tensor> outputs;
   auto delete_tensors = gtl::MakeCleanup([&graph_runner, &outputs] {
@@ -669,13 +776,19 @@ Status ConstantFold(const ConstantFoldingOptions& opts,
 
   // Fetch the constant tensors and replace the corresponding tensors in the
   // original graph with those constants.
+  ConstantsByValue constants;
+  AddExistingConstants(constant_foldable_nodes, partition_device,
+                       constant_control_deps, &constants);
+  int64_t remaining_bytes = opts.max_total_constant_size_in_bytes;
   int32_t num_nodes_replaced = 0;
   for (size_t c = 0; c < outputs.size(); ++c) {
     const gtl::FlatSet<Node*>& control_deps =
         constant_control_deps[tensors_to_replace[c].first];
-    if (ReplaceTensorWithConstant(
-            graph, partition_device, tensors_to_replace[c], outputs[c],
-            control_deps, opts.max_constant_size_in_bytes, generate_new_name)) {
+    if (ReplaceTensorWithConstant(graph, partition_device,
+                                  tensors_to_replace[c], outputs[c],
+                                  control_deps, opts.max_constant_size_in_bytes,
+                                  generate_new_name, &constants,
+                                  &remaining_bytes)) {
       ++num_nodes_replaced;
     }
   }
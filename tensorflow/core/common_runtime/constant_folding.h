@@ -16,6 +16,9 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_CONSTANT_FOLDING_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_CONSTANT_FOLDING_H_
 
+#include <functional>
+#include <limits>
+
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -44,6 +47,20 @@ struct ConstantFoldingOptions {
   // The maximum size of each constant created during constant folding
   // optimization.
   int64_t max_constant_size_in_bytes = 10 * 1024 * 1024;
+  // The maximum total size of the constants created by one call to
+  // ConstantFold. Tensors are considered in a deterministic order, and those
+  // whose constant would exceed the remaining budget are not folded. Large
+  // folded values that are equal to the value of a Const node already in the
+  // graph reuse that node, and do not count towards the budget.
+  int64_t max_total_constant_size_in_bytes =
+      std::numeric_limits<int64_t>::max();
+  // If set, the constant-foldable nodes are evaluated with `runner`, so that
+  // independent nodes are evaluated in parallel. Otherwise they are evaluated
+  // one at a time on the calling thread. The calling thread blocks until the
+  // nodes are evaluated, so `runner` must not schedule its closures on a pool
+  // the caller may be running on, e.g. the intra-op pool of a device when
+  // folding from a kernel. A pool dedicated to the caller is safe.
+  std::function<void(std::function<void()>)> runner = nullptr;
 
   // A generator for the name suffix of constant folded nodes. A
   // default id generator that monotonically increases is used if nullptr is
@@ -333,6 +333,80 @@ TEST_F(ConstantFoldingTest, TestNoReplaceLargeConstant) {
   EXPECT_TRUE(was_mutated);
 }
 
+TEST_F(ConstantFoldingTest, TotalSizeBudget) {
+  Scope s = Scope::NewRootScope();
+  BuildSimpleGraph(&s);
+  Graph g(OpRegistry::Global());
+  TF_ASSERT_OK(s.ToGraph(&g));
+
+  // Each of m1 and m2 folds into a constant of 16 bytes, so only one fits.
+  ConstantFoldingOptions opts;
+  opts.max_total_constant_size_in_bytes = 16;
+  bool was_mutated;
+  TF_ASSERT_OK(
+      ConstantFold(opts, nullptr, Env::Default(), nullptr, &g, &was_mutated));
+  EXPECT_TRUE(was_mutated);
+
+  std::unordered_map<string, Node*> index = g.BuildNodeNameIndex();
+  int num_constant_inputs = 0;
+  for (const char* send : {"s1", "s2"}) {
+    if ((*index.at(send)->in_nodes().begin())->IsConstant()) {
+      ++num_constant_inputs;
+    }
+  }
+  EXPECT_EQ(num_constant_inputs, 1);
+}
+
+TEST_F(ConstantFoldingTest, SharesLargeConstant) {
+  Graph g(OpRegistry::Global());
+  {
+    Scope s = Scope::NewRootScope();
+    auto c = ops::Const<float>(s.WithOpName("c"), 1.0f, {1024});
+    auto i = ops::Identity(s.WithOpName("i"), c);
+    auto n = ops::Neg(s.WithOpName("n"), ops::Neg(s, c));
+    auto i_send = ops::_Send(s.WithOpName("i_send"), i, "i_send", "sender", 0,
+                             "receiver");
+    auto n_send = ops::_Send(s.WithOpName("n_send"), n, "n_send", "sender", 0,
+                             "receiver");
+    TF_ASSERT_OK(s.ToGraph(&g));
+  }
+
+  // No budget is needed since both values are equal to the value of `c`.
+  ConstantFoldingOptions opts;
+  opts.max_total_constant_size_in_bytes = 0;
+  bool was_mutated;
+  TF_ASSERT_OK(
+      ConstantFold(opts, nullptr, Env::Default(), nullptr, &g, &was_mutated));
+  EXPECT_TRUE(was_mutated);
+
+  std::unordered_map<string, Node*> index = g.BuildNodeNameIndex();
+  EXPECT_EQ(*index.at("i_send")->in_nodes().begin(), index.at("c"));
+  EXPECT_EQ(*index.at("n_send")->in_nodes().begin(), index.at("c"));
+}
+
+TEST_F(ConstantFoldingTest, ParallelEvaluation) {
+  Scope s = Scope::NewRootScope();
+  BuildSimpleGraph(&s);
+  Graph g(OpRegistry::Global());
+  TF_ASSERT_OK(s.ToGraph(&g));
+
+  thread::ThreadPool pool(Env::Default(), "constant_folding", 2);
+  ConstantFoldingOptions opts;
+  opts.runner = [&pool](std::function<void()> c) {
+    pool.Schedule(std::move(c));
+  };
+  bool was_mutated;
+  TF_ASSERT_OK(
+      ConstantFold(opts, nullptr, Env::Default(), nullptr, &g, &was_mutated));
+  EXPECT_TRUE(was_mutated);
+
+  std::unordered_map<string, Node*> index = g.BuildNodeNameIndex();
+  ExpectNodeClose<float>(*(index.at("s1")->in_nodes().begin()),
+                         {1.0, 2.0, 3.0, 4.0}, {2, 2});
+  ExpectNodeClose<float>(*(index.at("s2")->in_nodes().begin()),
+                         {2.0, 1.0, 4.0, 3.0}, {2, 2});
+}
+
 TEST_F(ConstantFoldingTest, TestNoReplaceFunctionCall) {
   FunctionDefLibrary flib;
   *flib.add_function() = test::function::XTimesTwo();
@@ -15,19 +15,59 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/device/device_event_mgr.h"
 
+#include <algorithm>
+
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/platform/stacktrace.h"
 #include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
 namespace {
-// The EventMgr has 1 thread for the polling loop and one to execute
-// event callback functions. Issues for reconsideration:
-//  - Is this the right number of threads?
+// The EventMgr has 1 thread for the polling loop and, by default, one to
+// execute event callback functions. The number of callback threads can be
+// raised with TF_GPU_EVENT_MGR_CALLBACK_THREADS. Issues for reconsideration:
 //  - Should EventMgrs be shared between devices on a machine with multiple
 //  devices of the same type?
-static const int kNumThreads = 2;
+static const int kDefaultNumCallbackThreads = 1;
+
+// The polling loop re-polls without sleeping this many times after it last
+// retired an event, then backs off exponentially up to
+// polling_active_delay_usecs << kMaxPollingBackoffShift.
+static const int kNumSpinPolls = 8;
+static const int kMaxPollingBackoffShift = 3;
+
+auto* event_latency_usecs_histogram = monitoring::Sampler<0>::New(
+    {"/tensorflow/core/device_event_mgr/event_latency_usecs",
+     "Microseconds between queueing an event and retiring its callback."},
+    // Power of 2 with bucket count 20 (> 1 second)
+    {monitoring::Buckets::Exponential(1, 2, 20)});
+
+int NumThreads() {
+  int64 num_callback_threads;
+  Status s = ReadInt64FromEnvVar("TF_GPU_EVENT_MGR_CALLBACK_THREADS",
+                                 kDefaultNumCallbackThreads,
+                                 &num_callback_threads);
+  if (!s.ok() || num_callback_threads < 1) {
+    LOG(ERROR) << "Invalid TF_GPU_EVENT_MGR_CALLBACK_THREADS, using "
+               << kDefaultNumCallbackThreads << ": " << s;
+    num_callback_threads = kDefaultNumCallbackThreads;
+  }
+  return 1 + num_callback_threads;
+}
+
+bool UseHostCallbacks() {
+  bool use_host_callbacks;
+  Status s = ReadBoolFromEnvVar("TF_GPU_EVENT_MGR_USE_HOST_CALLBACKS",
+                                /*default_val=*/false, &use_host_callbacks);
+  if (!s.ok()) {
+    LOG(ERROR) << s;
+    return false;
+  }
+  return use_host_callbacks;
+}
 }  // namespace
 
 namespace device_event_mgr {
@@ -95,13 +135,20 @@ EventMgr::EventMgr(se::StreamExecutor* se, const GPUOptions& gpu_options)
       polling_active_delay_usecs_(gpu_options.polling_active_delay_usecs()
                                       ? gpu_options.polling_active_delay_usecs()
                                       : 10),
-      threadpool_(Env::Default(), "Device_Event_Manager", kNumThreads) {
+      use_host_callbacks_(UseHostCallbacks()),
+      threadpool_(Env::Default(), "Device_Event_Manager", NumThreads()) {
   device_event_mgr::InitThreadpoolLabels(&threadpool_);
   StartPollingLoop();
 }
 
 EventMgr::~EventMgr() {
   StopPollingLoop();
+  {
+    mutex_lock l(mu_);
+    while (pending_host_callbacks_ > 0) {
+      host_callbacks_done_.wait(l);
+    }
+  }
 
   // Events are owned by this object.
   for (auto& e : free_events_) {
@@ -141,8 +188,13 @@ void EventMgr::StopPollingLoop() {
 //
 // While one or more events is outstanding, poll for completed events.  When no
 // events are outstanding, we sleep until one is enqueued.
+//
+// Completions tend to arrive in bursts, so after retiring an event the loop
+// re-polls immediately for a few iterations before backing off; see
+// PollingDelayUsecs().
 void EventMgr::PollLoop() {
   ToFreeVector to_free;
+  int idle_polls = 0;
   while (true) {
     bool events_still_pending;
     {
@@ -156,16 +208,78 @@ void EventMgr::PollLoop() {
       PollEvents(true, &to_free);
       events_still_pending = !used_events_.empty();
     }
+    idle_polls = to_free.empty() ? idle_polls + 1 : 0;
     FreeMemory(to_free);
     to_free.clear();
 
     if (events_still_pending) {
-      Env::Default()->SleepForMicroseconds(polling_active_delay_usecs_);
+      const int64 delay_usecs = PollingDelayUsecs(idle_polls);
+      if (delay_usecs > 0) {
+        Env::Default()->SleepForMicroseconds(delay_usecs);
+      }
+    } else {
+      idle_polls = 0;
     }
   }
   polling_stopped_->Notify();
 }
 
+int64 EventMgr::PollingDelayUsecs(int idle_polls) const {
+  if (idle_polls <= kNumSpinPolls) return 0;
+  const int shift =
+      std::min(idle_polls - kNumSpinPolls - 1, kMaxPollingBackoffShift);
+  return static_cast<int64>(polling_active_delay_usecs_) << shift;
+}
+
+void EventMgr::QueueHostCallback(se::Stream* stream,
+                                 std::function<void()> func) {
+  {
+    mutex_lock l(mu_);
+    ++pending_host_callbacks_;
+  }
+  const uint64 queued_micros = Env::Default()->NowMicros();
+  // The host callback runs on a driver thread that must not call back into
+  // the device, so it only hands func off to the callback threads.
+  stream->ThenDoHostCallback([this, queued_micros, func = std::move(func)]() {
+    event_latency_usecs_histogram->GetCell()->Add(Env::Default()->NowMicros() -
+                                                  queued_micros);
+    threadpool_.Schedule(func);
+    mutex_lock l(mu_);
+    if (--pending_host_callbacks_ == 0) host_callbacks_done_.notify_all();
+  });
+}
+
+bool EventMgr::BeginCapture(se::Stream* stream) {
+  mutex_lock l(capture_mu_);
+  if (!capturing_streams_.emplace(stream, false).second) {
+    return false;
+  }
+  num_capturing_streams_.fetch_add(1, std::memory_order_release);
+  return true;
+}
+
+bool EventMgr::EndCapture(se::Stream* stream) {
+  mutex_lock l(capture_mu_);
+  auto it = capturing_streams_.find(stream);
+  DCHECK(it != capturing_streams_.end());
+  const bool executed = it->second;
+  capturing_streams_.erase(it);
+  num_capturing_streams_.fetch_sub(1, std::memory_order_release);
+  return !executed;
+}
+
+bool EventMgr::ExecuteIfCapturing(se::Stream* stream,
+                                  std::function<void()>* func) {
+  {
+    mutex_lock l(capture_mu_);
+    auto it = capturing_streams_.find(stream);
+    if (it == capturing_streams_.end()) return false;
+    it->second = true;
+  }
+  threadpool_.Schedule(std::move(*func));
+  return true;
+}
+
 void EventMgr::QueueInUse(se::Stream* stream, InUse in_use) {
   VLOG(2) << "QueueInUse  free_events_ " << free_events_.size()
           << " used_events_ " << used_events_.size();
@@ -179,6 +293,7 @@ void EventMgr::QueueInUse(se::Stream* stream, InUse in_use) {
   free_events_.pop_back();
   stream->ThenRecordEvent(e);
   in_use.event = e;
+  in_use.queued_micros = Env::Default()->NowMicros();
   bool was_empty = used_events_.empty();
   used_events_.push_back(in_use);
   // Maybe wake up the polling thread
@@ -210,6 +325,7 @@ void EventMgr::PollEvents(bool is_dedicated_poller,
   // Sweep the remaining events in order.  If this is the dedicated
   // polling thread, check the entire set.  Otherwise, just sweep up to
   // the first non-complete record that is still pending.
+  uint64 now_micros = 0;
   for (auto& iu : used_events_) {
     if (iu.event == nullptr) continue;
     se::Event::Status s = iu.event->PollForStatus();
@@ -224,6 +340,9 @@ void EventMgr::PollEvents(bool is_dedicated_poller,
         if (!is_dedicated_poller) return;  // quit processing queue
         break;
       case se::Event::Status::kComplete:
+        if (now_micros == 0) now_micros = Env::Default()->NowMicros();
+        event_latency_usecs_histogram->GetCell()->Add(now_micros -
+                                                      iu.queued_micros);
         // Make a copy of the InUse record so we can free it after releasing
         // the lock
         to_free->push_back(iu);
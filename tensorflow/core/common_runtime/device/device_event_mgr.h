@@ -16,9 +16,11 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_DEVICE_DEVICE_EVENT_MGR_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_DEVICE_DEVICE_EVENT_MGR_H_
 
+#include <atomic>
 #include <deque>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/framework/log_memory.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/notification.h"
@@ -68,9 +70,18 @@ class EventMgr {
   virtual ~EventMgr();
 
   // Execute func when all pending stream actions have completed.
-  // func must be brief and non-blocking since it executes in the one
-  // thread used for all such callbacks and also buffer deletions.
+  // func must be brief and non-blocking since it executes on the small
+  // pool of threads used for all such callbacks and also buffer deletions.
   inline void ThenExecute(se::Stream* stream, std::function<void()> func) {
+    if (TF_PREDICT_FALSE(
+            num_capturing_streams_.load(std::memory_order_acquire) > 0) &&
+        ExecuteIfCapturing(stream, &func)) {
+      return;
+    }
+    if (use_host_callbacks_) {
+      QueueHostCallback(stream, std::move(func));
+      return;
+    }
     ToFreeVector to_free;
     {
       mutex_lock l(mu_);
@@ -80,18 +91,32 @@ class EventMgr {
     FreeMemory(to_free);
   }
 
+  // Between BeginCapture(stream) and EndCapture(stream), the work enqueued
+  // onto `stream` is captured into a graph instead of being executed, so it
+  // never completes. ThenExecute() then runs func right away, and EndCapture()
+  // returns false to tell that the captured work can't be replayed without
+  // running func after it. BeginCapture() returns false if `stream` is already
+  // being captured.
+  bool BeginCapture(se::Stream* stream);
+  bool EndCapture(se::Stream* stream);
+
  private:
   friend class TEST_EventMgr;
   friend class TEST_EventMgrHelper;
   friend class EventMgrFactory;
   se::StreamExecutor* const exec_;
   const int32 polling_active_delay_usecs_;
+  // If true, completion is signaled by a host callback enqueued on the
+  // stream instead of by polling an Event.
+  const bool use_host_callbacks_;
   mutex mu_;
   condition_variable events_pending_ TF_GUARDED_BY(mu_);
 
   struct InUse {
     se::Event* event;
     std::function<void()> func;
+    // Time in microseconds at which the record was queued.
+    uint64 queued_micros = 0;
   };
 
   typedef gtl::InlinedVector<InUse, 4> ToFreeVector;
@@ -111,11 +136,18 @@ class EventMgr {
   void QueueInUse(se::Stream* stream, InUse in_use)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Runs `*func` right away and returns true if `stream` is being captured.
+  bool ExecuteIfCapturing(se::Stream* stream, std::function<void()>* func);
+
   void QueueFunc(se::Stream* stream, std::function<void()> func)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
     QueueInUse(stream, {nullptr, std::move(func)});
   }
 
+  // Stream-enqueue a host callback that schedules func once all prior
+  // work on the stream has completed, bypassing the polling loop.
+  void QueueHostCallback(se::Stream* stream, std::function<void()> func);
+
   // This function should be called at roughly the same tempo as
   // QueueTensors() to check whether pending events have recorded,
   // and then retire them.  It appends InUse elements that need cleanup
@@ -128,6 +160,11 @@ class EventMgr {
   // straggler Events.
   void PollLoop();
 
+  // Returns how long PollLoop() sleeps after `idle_polls` consecutive
+  // polls that retired no events: zero for the first few polls, then an
+  // exponentially growing multiple of polling_active_delay_usecs_.
+  int64 PollingDelayUsecs(int idle_polls) const;
+
   // Setup/Teardown functions for the polling loop.
   void StartPollingLoop();
   void StopPollingLoop();
@@ -139,9 +176,22 @@ class EventMgr {
   std::deque<InUse> used_events_ TF_GUARDED_BY(mu_);
 
   bool stop_polling_ TF_GUARDED_BY(mu_);
+
+  // Number of host callbacks enqueued but not yet run.
+  int64 pending_host_callbacks_ TF_GUARDED_BY(mu_) = 0;
+  condition_variable host_callbacks_done_ TF_GUARDED_BY(mu_);
   std::unique_ptr<Notification> polling_stopped_;
 
-  // The main PollLoop for the event manager runs in this threadpool.
+  // The streams between BeginCapture() and EndCapture(), and whether
+  // ThenExecute() was called for them. `num_capturing_streams_` lets
+  // ThenExecute() skip `capture_mu_` when no stream is being captured.
+  mutex capture_mu_;
+  absl::flat_hash_map<se::Stream*, bool> capturing_streams_
+      TF_GUARDED_BY(capture_mu_);
+  std::atomic<int> num_capturing_streams_{0};
+
+  // The main PollLoop for the event manager runs in this threadpool, and
+  // the remaining threads execute completion callbacks.
   thread::ThreadPool threadpool_;
 };
 
@@ -138,6 +138,34 @@ TEST(EventMgr, WarnIfInCallback) {
   note.WaitForNotification();
   EXPECT_TRUE(hit);
 }
+
+// Tests that callbacks run on the EventMgr threads when completion is signaled by host callbacks instead of polling.
+TEST(EventMgr, HostCallbacks) {
+  CHECK_EQ(setenv("TF_GPU_EVENT_MGR_USE_HOST_CALLBACKS", "true", 1), 0);
+  auto stream_exec = GPUMachineManager()->ExecutorForDevice(0).ValueOrDie();
+  TEST_EventMgr em(stream_exec, GPUOptions());
+  CHECK_EQ(unsetenv("TF_GPU_EVENT_MGR_USE_HOST_CALLBACKS"), 0);
+  TEST_EventMgrHelper th(&em);
+  std::unique_ptr<se::Stream> stream(new se::Stream(stream_exec));
+  CHECK(stream);
+  stream->Init();
+  bool in_callback_thread = false;
+  Notification note;
+  for (int i = 0; i < 10; ++i) {
+    em.ThenExecute(stream.get(), [i, &in_callback_thread, &note]() {
+      if (i == 9) {
+        device_event_mgr::WarnIfInCallback(
+            [&in_callback_thread] { in_callback_thread = true; });
+        note.Notify();
+      }
+    });
+  }
+  // No Events are used, so nothing is left for the polling loop.
+  EXPECT_EQ(0, th.queue_size());
+  TF_ASSERT_OK(stream->BlockHostUntilDone());
+  note.WaitForNotification();
+  EXPECT_TRUE(in_callback_thread);
+}
 }  // namespace
 
 // Provides access to private resources of BaseGPUDevice.
@@ -17,12 +17,14 @@ limitations under the License.
 
 #include <algorithm>
 #include <atomic>
+#include <cstring>
 #include <string>
 #include <vector>
 
 #include "absl/container/flat_hash_set.h"
 #include "absl/time/time.h"
 #include "absl/types/optional.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/common_runtime/collective_executor_mgr.h"
 #include "tensorflow/core/common_runtime/collective_param_resolver_local.h"
 #include "tensorflow/core/common_runtime/constant_folding.h"
@@ -40,6 +42,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/common_runtime/rendezvous_mgr.h"
 #include "tensorflow/core/common_runtime/scoped_allocator_mgr.h"
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/graph.pb.h"
@@ -156,6 +159,34 @@ string GetRendezvousKey(const string& tensor_name,
                          frame_iter.frame_id, ":", frame_iter.iter_id);
 }
 
+// Returns an error if the work of a callable whose single partition is `graph`
+// can't be captured into a StepGraph. Later runs of the callable only copy
+// their feeds and fetches and launch the captured work, so none of its
+// kernels may have effects on the host, keep state between runs, or exchange
+// tensors with another device.
+Status CheckCapturable(const Graph& graph, const DataTypeVector& input_types,
+                       const DataTypeVector& output_types) {
+  for (const DataTypeVector* types : {&input_types, &output_types}) {
+    for (DataType dtype : *types) {
+      if (!DataTypeCanUseMemcpy(dtype) ||
+          MTypeFromDType(dtype) == HOST_MEMORY) {
+        return errors::Unimplemented("Feeds and fetches of type ",
+                                     DataTypeString(dtype),
+                                     " are not in device memory");
+      }
+    }
+  }
+  for (const Node* n : graph.op_nodes()) {
+    if (n->IsArg() || n->IsRetval()) continue;
+    if (n->IsControlFlow() || n->IsSend() || n->IsRecv() ||
+        n->IsFunctionCall() || n->op_def().is_stateful()) {
+      return errors::Unimplemented("Op ", n->name(), " of type ",
+                                   n->type_string(), " can't be captured");
+    }
+  }
+  return Status::OK();
+}
+
 }  // namespace
 
 class DirectSessionFactory : public SessionFactory {
@@ -507,7 +538,8 @@ Status DirectSession::RunInternal(
     int64_t step_id, const RunOptions& run_options,
     CallFrameInterface* call_frame, ExecutorsAndKeys* executors_and_keys,
     RunMetadata* run_metadata,
-    const thread::ThreadPoolOptions& threadpool_options) {
+    const thread::ThreadPoolOptions& threadpool_options,
+    StepGraph* capturing_graph) {
   const uint64 start_time_usecs = options_.env->NowMicros();
   const int64_t executor_step_count =
       executors_and_keys->step_count.fetch_add(1);
@@ -616,6 +648,14 @@ Status DirectSession::RunInternal(
         step_id, call_timeout,
         run_options.experimental().run_handler_pool_options());
     if (!handler) {
+      const int64_t deadline_micros = run_options.experimental()
+                                          .run_handler_pool_options()
+                                          .deadline_micros();
+      if (deadline_micros > 0 &&
+          static_cast<int64_t>(options_.env->NowMicros()) >= deadline_micros) {
+        return errors::DeadlineExceeded(
+            "Could not obtain RunHandler for request before its deadline.");
+      }
       return errors::DeadlineExceeded(
           "Could not obtain RunHandler for request after waiting for ",
           call_timeout, "ms.");
@@ -659,6 +699,12 @@ Status DirectSession::RunInternal(
   args.tensor_store = &run_state.tensor_store;
   args.step_container = &run_state.step_container;
   args.sync_on_finish = sync_on_finish_;
+  if (capturing_graph != nullptr) {
+    // Synchronizing with a device that is being captured would fail.
+    args.sync_on_finish = false;
+    args.device_step_allocator = capturing_graph->allocator();
+    args.device_context = capturing_graph->device_context();
+  }
   args.user_intra_op_threadpool = threadpool_options.intra_op_threadpool;
   args.run_all_kernels_inline = pool == nullptr;
   args.start_time_usecs = start_time_usecs;
@@ -724,12 +770,25 @@ Status DirectSession::RunInternal(
         }
       };
 
+  // Claim the step arenas of a callable that has them. A run that finds an
+  // arena in use by a concurrent run of the same callable allocates from the
+  // device as usual.
+  std::vector<StepArenaAllocator*> step_arenas(num_executors, nullptr);
+  for (size_t i = 0; i < num_executors; ++i) {
+    StepArenaAllocator* step_arena =
+        executors_and_keys->items[i].step_arena.get();
+    if (step_arena != nullptr && step_arena->BeginStep()) {
+      step_arenas[i] = step_arena;
+    }
+  }
+
   if (can_execute_synchronously) {
     PrivateIntraProcessRendezvous rendezvous(device_mgr_.get());
     args.rendezvous = &rendezvous;
 
     const auto& item = executors_and_keys->items[0];
     set_threadpool_args_for_item(item, &args);
+    args.step_allocator = step_arenas[0];
     run_status = item.executor->Run(args);
   } else {
     core::RefCountPtr<RefCountedIntraProcessRendezvous> rendezvous(
@@ -748,8 +807,10 @@ Status DirectSession::RunInternal(
                               executors_done.Notify();
                             });
 
-    for (const auto& item : executors_and_keys->items) {
+    for (size_t i = 0; i < num_executors; ++i) {
+      const auto& item = executors_and_keys->items[i];
       set_threadpool_args_for_item(item, &args);
+      args.step_allocator = step_arenas[i];
       item.executor->RunAsync(args, barrier->Get());
     }
 
@@ -761,6 +822,10 @@ Status DirectSession::RunInternal(
     }
   }
 
+  for (StepArenaAllocator* step_arena : step_arenas) {
+    if (step_arena != nullptr) step_arena->EndStep();
+  }
+
   if (step_cancellation_manager.IsCancelled()) {
     run_status.Update(errors::Cancelled("Run call was cancelled"));
   }
@@ -1363,6 +1428,24 @@ Status DirectSession::CreateExecutors(
             return Status::OK();
           }}));
 
+  const bool capture_gpu_graph =
+      callable_options.run_options().experimental().capture_gpu_graph();
+  Status capturable;
+  if (capture_gpu_graph) {
+    if (graphs.size() != 1) {
+      capturable = errors::Unimplemented(
+          "Its feeds, fetches and ops are not all on one device");
+    } else if (callable_options.run_options().trace_level() !=
+                   RunOptions::NO_TRACE ||
+               !callable_options.run_options()
+                    .debug_options()
+                    .debug_tensor_watch_opts()
+                    .empty()) {
+      capturable =
+          errors::Unimplemented("Captured runs can't be traced or debugged");
+    }
+  }
+
   GraphOptimizer optimizer(optimizer_opts);
   for (auto iter = graphs.begin(); iter != graphs.end(); ++iter) {
     const string& partition_name = iter->first;
@@ -1428,12 +1511,40 @@ Status DirectSession::CreateExecutors(
     auto executor_type = options_.config.experimental().executor_type();
     TF_RETURN_IF_ERROR(
         NewExecutor(executor_type, params, *partition_graph, &item->executor));
+    if (callable_options.step_arena_num_recorded_steps() > 0 &&
+        device->device_type() == DEVICE_CPU) {
+      item->step_arena.reset(new StepArenaAllocator(
+          device->GetAllocator(AllocatorAttributes()),
+          callable_options.step_arena_num_recorded_steps()));
+    }
+    if (capture_gpu_graph && capturable.ok()) {
+      capturable = CheckCapturable(*partition_graph, ek->input_types,
+                                   ek->output_types);
+      std::unique_ptr<StepGraph> step_graph;
+      if (capturable.ok()) {
+        step_graph = StepGraph::Create(device);
+        if (step_graph == nullptr) {
+          capturable = errors::Unimplemented("Device ", device->name(),
+                                             " can't capture graphs");
+        }
+      }
+      if (step_graph != nullptr) {
+        ek->captured_step = absl::make_unique<CapturedStep>();
+        mutex_lock l(ek->captured_step->mu);
+        ek->captured_step->graph = std::move(step_graph);
+      }
+    }
     if (!options_.config.experimental().disable_output_partition_graphs() ||
         options_.config.graph_options().build_cost_model() > 0) {
       item->graph = std::move(partition_graph);
     }
   }
 
+  if (!capturable.ok()) {
+    LOG(WARNING) << "Not capturing the GPU graph of a callable: "
+                 << capturable.error_message();
+  }
+
   // Cache the mapping from input/output names to graph elements to
   // avoid recomputing it every time.
   if (!run_state_args->is_partial_run) {
@@ -1873,11 +1984,13 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
   RunCallableCallFrame(DirectSession* session,
                        ExecutorsAndKeys* executors_and_keys,
                        const std::vector<Tensor>* feed_tensors,
-                       std::vector<Tensor>* fetch_tensors)
+                       std::vector<Tensor>* fetch_tensors,
+                       const absl::Span<Tensor>* fetch_buffers)
       : session_(session),
         executors_and_keys_(executors_and_keys),
         feed_tensors_(feed_tensors),
-        fetch_tensors_(fetch_tensors) {}
+        fetch_tensors_(fetch_tensors),
+        fetch_buffers_(fetch_buffers) {}
 
   size_t num_args() const override {
     return executors_and_keys_->input_types.size();
@@ -1903,13 +2016,119 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
     return Status::OK();
   }
 
+  const Tensor* GetPreallocatedRetval(int index) const override {
+    if (fetch_buffers_ == nullptr || index >= fetch_buffers_->size()) {
+      return nullptr;
+    }
+    return &(*fetch_buffers_)[index];
+  }
+
  private:
   DirectSession* const session_;                   // Not owned.
   ExecutorsAndKeys* const executors_and_keys_;     // Not owned.
   const std::vector<Tensor>* const feed_tensors_;  // Not owned.
   std::vector<Tensor>* const fetch_tensors_;       // Not owned.
+  const absl::Span<Tensor>* const fetch_buffers_;  // Not owned.
 };
 
+::tensorflow::Status DirectSession::RunCapturedStep(
+    int64_t step_id, ExecutorsAndKeys* executors_and_keys,
+    const std::vector<Tensor>& feed_tensors,
+    std::vector<Tensor>* fetch_tensors, RunMetadata* run_metadata,
+    const thread::ThreadPoolOptions& threadpool_options, bool* ran) {
+  CapturedStep* captured_step = executors_and_keys->captured_step.get();
+  const RunOptions& run_options =
+      executors_and_keys->callable_options.run_options();
+  Device* device = executors_and_keys->items[0].device;
+  Allocator* allocator = device->GetAllocator(AllocatorAttributes());
+  *ran = false;
+  {
+    mutex_lock l(captured_step->mu);
+    StepGraph* graph = captured_step->graph.get();
+    if (graph == nullptr) {
+      return Status::OK();
+    }
+
+    if (!captured_step->captured) {
+      // The first run initializes the kernels, e.g. by autotuning them, which
+      // synchronizes with the device, so only the second run is captured.
+      if (captured_step->num_runs++ == 0) {
+        RunCallableCallFrame call_frame(this, executors_and_keys,
+                                        &feed_tensors, fetch_tensors,
+                                        /*fetch_buffers=*/nullptr);
+        TF_RETURN_IF_ERROR(RunInternal(step_id, run_options, &call_frame,
+                                       executors_and_keys, run_metadata,
+                                       threadpool_options));
+        *ran = true;
+        return Status::OK();
+      }
+
+      // The captured run reads copies of the feeds, which later runs
+      // overwrite with their own.
+      Status s;
+      std::vector<Tensor> feeds;
+      feeds.reserve(feed_tensors.size());
+      for (const Tensor& feed : feed_tensors) {
+        feeds.emplace_back(allocator, feed.dtype(), feed.shape());
+        if (!feeds.back().IsInitialized()) {
+          s = errors::ResourceExhausted("Failed to allocate a copy of a feed");
+          break;
+        }
+        s = graph->CopyTensor(feed, &feeds.back());
+        if (!s.ok()) break;
+      }
+      std::vector<Tensor> fetches(executors_and_keys->output_types.size());
+      if (s.ok()) s = graph->BeginCapture();
+      if (s.ok()) {
+        RunCallableCallFrame call_frame(this, executors_and_keys, &feeds,
+                                        &fetches, /*fetch_buffers=*/nullptr);
+        s = RunInternal(step_id, run_options, &call_frame, executors_and_keys,
+                        run_metadata, threadpool_options, graph);
+        s.Update(graph->EndCapture());
+      }
+      if (!s.ok()) {
+        LOG(WARNING) << "Running the kernels of a callable whose GPU graph "
+                        "could not be captured: "
+                     << s;
+        captured_step->graph.reset();
+        return Status::OK();
+      }
+      captured_step->captured = true;
+      captured_step->feeds = std::move(feeds);
+      captured_step->fetches = std::move(fetches);
+    } else {
+      for (size_t i = 0; i < feed_tensors.size(); ++i) {
+        const Tensor& feed = captured_step->feeds[i];
+        if (feed_tensors[i].dtype() != feed.dtype() ||
+            feed_tensors[i].shape() != feed.shape()) {
+          VLOG(1) << "Running the kernels of a captured callable, as the "
+                     "shape of feed "
+                  << i << " changed from " << feed.shape().DebugString()
+                  << " to " << feed_tensors[i].shape().DebugString();
+          return Status::OK();
+        }
+      }
+      for (size_t i = 0; i < feed_tensors.size(); ++i) {
+        TF_RETURN_IF_ERROR(
+            graph->CopyTensor(feed_tensors[i], &captured_step->feeds[i]));
+      }
+    }
+
+    TF_RETURN_IF_ERROR(graph->Launch());
+    for (size_t i = 0; i < captured_step->fetches.size(); ++i) {
+      const Tensor& fetch = captured_step->fetches[i];
+      Tensor output(allocator, fetch.dtype(), fetch.shape());
+      if (!output.IsInitialized()) {
+        return errors::ResourceExhausted("Failed to allocate fetch ", i);
+      }
+      TF_RETURN_IF_ERROR(graph->CopyTensor(fetch, &output));
+      (*fetch_tensors)[i] = std::move(output);
+    }
+  }
+  *ran = true;
+  return sync_on_finish_ ? device->Sync() : Status::OK();
+}
+
 ::tensorflow::Status DirectSession::RunCallable(
     CallableHandle handle, const std::vector<Tensor>& feed_tensors,
     std::vector<Tensor>* fetch_tensors, RunMetadata* run_metadata) {
@@ -1921,6 +2140,56 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
     CallableHandle handle, const std::vector<Tensor>& feed_tensors,
     std::vector<Tensor>* fetch_tensors, RunMetadata* run_metadata,
     const thread::ThreadPoolOptions& threadpool_options) {
+  return RunCallableInternal(handle, feed_tensors, fetch_tensors,
+                             /*fetch_buffers=*/nullptr, run_metadata,
+                             threadpool_options);
+}
+
+::tensorflow::Status DirectSession::RunCallableWithFetchBuffers(
+    CallableHandle handle, const std::vector<Tensor>& feed_tensors,
+    absl::Span<Tensor> fetch_buffers, RunMetadata* run_metadata,
+    const thread::ThreadPoolOptions& threadpool_options) {
+  for (int i = 0; i < fetch_buffers.size(); ++i) {
+    if (!fetch_buffers[i].IsInitialized()) {
+      return errors::InvalidArgument("Fetch buffer ", i,
+                                     " is not initialized.");
+    }
+    if (!DataTypeCanUseMemcpy(fetch_buffers[i].dtype())) {
+      return errors::InvalidArgument(
+          "Fetch buffer ", i, " has unsupported type ",
+          DataTypeString(fetch_buffers[i].dtype()), ".");
+    }
+  }
+  std::vector<Tensor> fetch_tensors;
+  TF_RETURN_IF_ERROR(RunCallableInternal(handle, feed_tensors, &fetch_tensors,
+                                         &fetch_buffers, run_metadata,
+                                         threadpool_options));
+  for (int i = 0; i < fetch_buffers.size(); ++i) {
+    const Tensor& fetched = fetch_tensors[i];
+    Tensor& buffer = fetch_buffers[i];
+    if (fetched.dtype() != buffer.dtype() ||
+        fetched.shape() != buffer.shape()) {
+      return errors::InvalidArgument(
+          "Fetched value ", i, " has type ", DataTypeString(fetched.dtype()),
+          " and shape ", fetched.shape().DebugString(),
+          ", which does not match its buffer of type ",
+          DataTypeString(buffer.dtype()), " and shape ",
+          buffer.shape().DebugString(), ".");
+    }
+    // The kernel that produced the value did not write it into the buffer.
+    if (!fetched.SharesBufferWith(buffer) && fetched.TotalBytes() > 0) {
+      memcpy(const_cast<char*>(buffer.tensor_data().data()),
+             fetched.tensor_data().data(), fetched.TotalBytes());
+    }
+  }
+  return Status::OK();
+}
+
+::tensorflow::Status DirectSession::RunCallableInternal(
+    CallableHandle handle, const std::vector<Tensor>& feed_tensors,
+    std::vector<Tensor>* fetch_tensors, absl::Span<Tensor>* fetch_buffers,
+    RunMetadata* run_metadata,
+    const thread::ThreadPoolOptions& threadpool_options) {
   TF_RETURN_IF_ERROR(CheckNotClosed());
   TF_RETURN_IF_ERROR(CheckGraphCreated("RunCallable()"));
   direct_session_runs->GetCell()->IncrementBy(1);
@@ -1954,6 +2223,23 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
         "Expected ", executors_and_keys->input_types.size(),
         " feed tensors, but got ", feed_tensors.size());
   }
+  if (fetch_buffers != nullptr) {
+    if (fetch_buffers->size() != executors_and_keys->output_types.size()) {
+      return errors::InvalidArgument(
+          "Expected ", executors_and_keys->output_types.size(),
+          " fetch buffers, but got ", fetch_buffers->size());
+    }
+    for (const auto& fetch_device :
+         executors_and_keys->callable_options.fetch_devices()) {
+      DeviceNameUtils::ParsedName parsed;
+      if (!DeviceNameUtils::ParseFullName(fetch_device.second, &parsed) ||
+          parsed.type != DEVICE_CPU) {
+        return errors::InvalidArgument(
+            "Fetch buffers cannot be used with values fetched on device ",
+            fetch_device.second, ".");
+      }
+    }
+  }
   if (fetch_tensors != nullptr) {
     fetch_tensors->resize(executors_and_keys->output_types.size());
   } else if (!executors_and_keys->output_types.empty()) {
@@ -1990,18 +2276,27 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
     actual_feed_tensors = &feed_tensors;
   }
 
-  // A specialized CallFrame implementation that takes advantage of the
-  // optimized RunCallable interface.
-  RunCallableCallFrame call_frame(this, executors_and_keys.get(),
-                                  actual_feed_tensors, fetch_tensors);
-
   if (LogMemory::IsEnabled()) {
     LogMemory::RecordStep(step_id, run_state_args.handle);
   }
 
-  TF_RETURN_IF_ERROR(RunInternal(
-      step_id, executors_and_keys->callable_options.run_options(), &call_frame,
-      executors_and_keys.get(), run_metadata, threadpool_options));
+  bool ran_captured_step = false;
+  if (executors_and_keys->captured_step != nullptr) {
+    TF_RETURN_IF_ERROR(RunCapturedStep(
+        step_id, executors_and_keys.get(), *actual_feed_tensors, fetch_tensors,
+        run_metadata, threadpool_options, &ran_captured_step));
+  }
+  if (!ran_captured_step) {
+    // A specialized CallFrame implementation that takes advantage of the
+    // optimized RunCallable interface.
+    RunCallableCallFrame call_frame(this, executors_and_keys.get(),
+                                    actual_feed_tensors, fetch_tensors,
+                                    fetch_buffers);
+    TF_RETURN_IF_ERROR(RunInternal(
+        step_id, executors_and_keys->callable_options.run_options(),
+        &call_frame, executors_and_keys.get(), run_metadata,
+        threadpool_options));
+  }
 
   if (fetch_tensors != nullptr) {
     size_t output_size = 0;
@@ -32,6 +32,8 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/process_function_library_runtime.h"
 #include "tensorflow/core/common_runtime/rendezvous_mgr.h"
 #include "tensorflow/core/common_runtime/session_factory.h"
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
+#include "tensorflow/core/common_runtime/step_graph.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/collective.h"
 #include "tensorflow/core/framework/graph.pb.h"
@@ -131,6 +133,11 @@ class DirectSession : public Session {
       std::vector<Tensor>* fetch_tensors, RunMetadata* run_metadata,
       const thread::ThreadPoolOptions& threadpool_options) override;
 
+  ::tensorflow::Status RunCallableWithFetchBuffers(
+      CallableHandle handle, const std::vector<Tensor>& feed_tensors,
+      absl::Span<Tensor> fetch_buffers, RunMetadata* run_metadata,
+      const thread::ThreadPoolOptions& threadpool_options) override;
+
   ::tensorflow::Status ReleaseCallable(CallableHandle handle) override;
 
   ::tensorflow::Status Finalize() override;
@@ -148,6 +155,26 @@ class DirectSession : public Session {
     Device* device = nullptr;                // not owned.
     FunctionLibraryRuntime* flib = nullptr;  // not owned.
     std::unique_ptr<Executor> executor;
+    // Non-null if `CallableOptions.step_arena_num_recorded_steps` is set and
+    // `device` is a CPU device.
+    core::RefCountPtr<StepArenaAllocator> step_arena;
+  };
+
+  // The state of a callable that captures the work it enqueues onto its
+  // device, see `RunOptions.Experimental.capture_gpu_graph`. `mu` is held
+  // by the runs of the callable, so that only one of them is captured and the
+  // captured feeds and fetches are used by one run at a time.
+  struct CapturedStep {
+    mutex mu;
+    // The number of runs of the callable before it was captured.
+    int num_runs TF_GUARDED_BY(mu) = 0;
+    // Null once the callable failed to be captured.
+    std::unique_ptr<StepGraph> graph TF_GUARDED_BY(mu);
+    bool captured TF_GUARDED_BY(mu) = false;
+    // The feeds and fetches of the captured run, which later runs copy their
+    // feeds into and their fetches out of.
+    std::vector<Tensor> feeds TF_GUARDED_BY(mu);
+    std::vector<Tensor> fetches TF_GUARDED_BY(mu);
   };
 
   // An ExecutorsAndKeys is created for a given set of feeds/fetches.
@@ -176,6 +203,9 @@ class DirectSession : public Session {
     CallableOptions callable_options;
 
     int64_t collective_graph_key = BuildGraphOptions::kNoCollectiveGraphKey;
+
+    // Non-null if the callable captures the work of its single partition.
+    std::unique_ptr<CapturedStep> captured_step;
   };
 
   // A FunctionInfo object is created for every unique set of feeds/fetches.
@@ -263,10 +293,33 @@ class DirectSession : public Session {
       RunStateArgs* run_state_args, DataTypeVector* input_types,
       DataTypeVector* output_types, int64_t* collective_graph_key);
 
+  // If `capturing_graph` is not null, the work of the run is being captured
+  // into it: its kernels allocate device memory from its allocator and
+  // enqueue their work with its device context, and the devices are not
+  // synchronized when it finishes.
   ::tensorflow::Status RunInternal(
       int64_t step_id, const RunOptions& run_options,
       CallFrameInterface* call_frame, ExecutorsAndKeys* executors_and_keys,
       RunMetadata* run_metadata,
+      const thread::ThreadPoolOptions& threadpool_options,
+      StepGraph* capturing_graph = nullptr);
+
+  // Runs a callable with a `captured_step` by launching its captured work,
+  // after capturing it if needed. Sets `*ran` to false if the callable has to
+  // run its kernels instead, e.g. because it could not be captured or the
+  // shapes of its feeds changed.
+  ::tensorflow::Status RunCapturedStep(
+      int64_t step_id, ExecutorsAndKeys* executors_and_keys,
+      const std::vector<Tensor>& feed_tensors,
+      std::vector<Tensor>* fetch_tensors, RunMetadata* run_metadata,
+      const thread::ThreadPoolOptions& threadpool_options, bool* ran);
+
+  // Implements `RunCallable()` and `RunCallableWithFetchBuffers()`. If
+  // `fetch_buffers` is non-null, the fetched values are written into it.
+  ::tensorflow::Status RunCallableInternal(
+      CallableHandle handle, const std::vector<Tensor>& feed_tensors,
+      std::vector<Tensor>* fetch_tensors, absl::Span<Tensor>* fetch_buffers,
+      RunMetadata* run_metadata,
       const thread::ThreadPoolOptions& threadpool_options);
 
   // Returns whether inter-op execution uses a global pool or the input
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/direct_session.h"
 
+#include <cmath>
 #include <map>
 #include <memory>
 #include <random>
@@ -48,6 +49,7 @@ limitations under the License.
 #include "tensorflow/core/platform/stacktrace.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/platform/threadpool_options.h"
 #include "tensorflow/core/protobuf/error_codes.pb.h"
 #include "tensorflow/core/protobuf/rewriter_config.pb.h"
 #include "tensorflow/core/public/session.h"
@@ -199,6 +201,74 @@ TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork_Callable) {
   }
 }
 
+TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork_CallableWithStepArena) {
+  Initialize({3, 2, -1, 0});
+  auto session = CreateSession();
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  CallableOptions callable_options =
+      MakeCallableOptions({}, {y_ + ":0", z_ + ":0"}, {});
+  callable_options.set_step_arena_num_recorded_steps(2);
+  Session::CallableHandle handle;
+  TF_ASSERT_OK(session->MakeCallable(callable_options, &handle));
+
+  // Keep the fetched tensors of every run alive, to check that later runs do
+  // not reuse their memory.
+  std::vector<std::vector<Tensor>> all_outputs;
+  for (int i = 0; i < 5; ++i) {
+    std::vector<Tensor> outputs;
+    TF_ASSERT_OK(session->RunCallable(handle, {}, &outputs, nullptr));
+    ASSERT_EQ(2, outputs.size());
+    all_outputs.push_back(std::move(outputs));
+  }
+  for (const std::vector<Tensor>& outputs : all_outputs) {
+    EXPECT_FLOAT_EQ(5.0, outputs[0].matrix<float>()(0, 0));
+    EXPECT_FLOAT_EQ(-5.0, outputs[1].matrix<float>()(0, 0));
+  }
+  TF_ASSERT_OK(session->ReleaseCallable(handle));
+}
+
+TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork_CallableWithFetchBuffers) {
+  Initialize({3, 2, -1, 0});
+  auto session = CreateSession();
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  Session::CallableHandle handle;
+  TF_ASSERT_OK(session->MakeCallable(
+      MakeCallableOptions({}, {y_ + ":0", y_neg_ + ":0"}, {}), &handle));
+
+  std::vector<Tensor> buffers = {Tensor(DT_FLOAT, TensorShape({2, 1})),
+                                 Tensor(DT_FLOAT, TensorShape({2, 1}))};
+  const void* y_data = buffers[0].tensor_data().data();
+  for (int i = 0; i < 2; ++i) {
+    TF_ASSERT_OK(session->RunCallableWithFetchBuffers(
+        handle, {}, absl::MakeSpan(buffers), nullptr,
+        thread::ThreadPoolOptions()));
+    EXPECT_FLOAT_EQ(5.0, buffers[0].matrix<float>()(0, 0));
+    EXPECT_FLOAT_EQ(-5.0, buffers[1].matrix<float>()(0, 0));
+    // MatMul allocates its output, so it is written into the caller's buffer.
+    EXPECT_EQ(y_data, buffers[0].tensor_data().data());
+  }
+
+  // The number, shapes and initialization of the buffers are checked.
+  std::vector<Tensor> too_few = {Tensor(DT_FLOAT, TensorShape({2, 1}))};
+  EXPECT_TRUE(errors::IsInvalidArgument(session->RunCallableWithFetchBuffers(
+      handle, {}, absl::MakeSpan(too_few), nullptr,
+      thread::ThreadPoolOptions())));
+  std::vector<Tensor> wrong_shape = {Tensor(DT_FLOAT, TensorShape({2, 1})),
+                                     Tensor(DT_FLOAT, TensorShape({1, 2}))};
+  EXPECT_TRUE(errors::IsInvalidArgument(session->RunCallableWithFetchBuffers(
+      handle, {}, absl::MakeSpan(wrong_shape), nullptr,
+      thread::ThreadPoolOptions())));
+  std::vector<Tensor> uninitialized(2);
+  EXPECT_TRUE(errors::IsInvalidArgument(session->RunCallableWithFetchBuffers(
+      handle, {}, absl::MakeSpan(uninitialized), nullptr,
+      thread::ThreadPoolOptions())));
+  TF_ASSERT_OK(session->ReleaseCallable(handle));
+}
+
 TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork_OptimizeForStaticGraph) {
   Initialize({3, 2, -1, 0});
   SessionOptions options(DefaultSessionOptions());
@@ -2405,6 +2475,69 @@ TEST(DirectSessionTest, FeedAndFetchTensorsInDeviceMemory) {
   }
 }
 
+TEST(DirectSessionTest, CaptureGpuGraphWhileOtherCallablesRun) {
+  std::unique_ptr<Session> session(NewSession(SessionOptions()));
+  const string gpu_device_name = GPUDeviceName(session.get());
+  if (gpu_device_name.empty()) {
+    LOG(INFO) << "Skipping test since no GPU is available";
+    return;
+  }
+
+  TF_ASSERT_OK(session->Create(CreateGraphForYEqualsXSquared()));
+
+  // Each thread squares its inputs on the host into the GPU, squares them on
+  // the GPU with a callable that is captured, and squares them again from the
+  // GPU onto the host, so that the captured callables run while the others
+  // enqueue work onto the GPU.
+  CallableOptions opts;
+  opts.add_feed("x:0");
+  opts.add_fetch("y:0");
+  Session::CallableHandle to_gpu;
+  opts.mutable_fetch_devices()->insert({"y:0", gpu_device_name});
+  TF_ASSERT_OK(session->MakeCallable(opts, &to_gpu));
+  Session::CallableHandle from_gpu;
+  opts.clear_fetch_devices();
+  opts.mutable_feed_devices()->insert({"x:0", gpu_device_name});
+  TF_ASSERT_OK(session->MakeCallable(opts, &from_gpu));
+  opts.mutable_fetch_devices()->insert({"y:0", gpu_device_name});
+  opts.mutable_run_options()->mutable_experimental()->set_capture_gpu_graph(
+      true);
+  constexpr int kNumThreads = 2;
+  std::vector<Session::CallableHandle> captured(kNumThreads);
+  for (Session::CallableHandle& handle : captured) {
+    TF_ASSERT_OK(session->MakeCallable(opts, &handle));
+  }
+
+  auto fn = [&session, to_gpu, from_gpu](Session::CallableHandle handle,
+                                         int thread) {
+    for (int i = 0; i < 100; ++i) {
+      Tensor input(DT_FLOAT, {});
+      const float x = 1 + (i + thread) % 3;
+      input.scalar<float>()() = x;
+      std::vector<Tensor> outputs;
+      TF_ASSERT_OK(session->RunCallable(to_gpu, {input}, &outputs, nullptr));
+      TF_ASSERT_OK(
+          session->RunCallable(handle, {outputs[0]}, &outputs, nullptr));
+      TF_ASSERT_OK(
+          session->RunCallable(from_gpu, {outputs[0]}, &outputs, nullptr));
+      ASSERT_EQ(1, outputs.size());
+      EXPECT_EQ(std::pow(x, 8), outputs[0].scalar<float>()());
+    }
+  };
+  {
+    thread::ThreadPool tp(Env::Default(), "test", kNumThreads);
+    for (int t = 0; t < kNumThreads; ++t) {
+      tp.Schedule([&fn, &captured, t]() { fn(captured[t], t); });
+    }
+  }
+
+  for (Session::CallableHandle handle : captured) {
+    TF_ASSERT_OK(session->ReleaseCallable(handle));
+  }
+  TF_ASSERT_OK(session->ReleaseCallable(from_gpu));
+  TF_ASSERT_OK(session->ReleaseCallable(to_gpu));
+}
+
 GraphDef CreateIdentityGraphDef(DataType dtype) {
   GraphDef def;
 
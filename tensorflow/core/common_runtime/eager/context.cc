@@ -27,11 +27,14 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/common_runtime/process_function_library_runtime.h"
 #include "tensorflow/core/common_runtime/rendezvous_mgr.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
 #include "tensorflow/core/lib/core/refcount.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
 #include "tensorflow/core/nccl/collective_communicator.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mem.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/platform.h"
 // clang-format on
@@ -91,6 +94,48 @@ auto* eager_context_created =
     monitoring::Gauge<bool, 0>::New("/tensorflow/core/eager_context_created",
                                     "True if an eager context was created.");
 
+// Host tensors of at most this many bytes created through CreateTensor keep
+// their data in the same allocation as their buffer.
+constexpr size_t kMaxInlineTensorBytes = 64;
+
+// A TensorBuffer whose data directly follows it in a single aligned
+// allocation, so that creating a small tensor costs one allocation instead of
+// two. Reference counting is unchanged: the whole block is freed with the
+// last reference.
+class InlineTensorBuffer : public TensorBuffer {
+ public:
+  static InlineTensorBuffer* New(size_t size) {
+    void* ptr = port::AlignedMalloc(DataOffset() + size,
+                                    Allocator::kAllocatorAlignment);
+    return new (ptr) InlineTensorBuffer(ptr, size);
+  }
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("InlineTensorBuffer");
+  }
+
+  static void operator delete(void* ptr) { port::AlignedFree(ptr); }
+  // Some compilers require this to match the placement new above.
+  static void operator delete(void*, void*) {}
+
+ private:
+  InlineTensorBuffer(void* ptr, size_t size)
+      : TensorBuffer(static_cast<char*>(ptr) + DataOffset()), size_(size) {
+    memset(data(), 0, size);
+  }
+  ~InlineTensorBuffer() override = default;
+
+  static constexpr size_t DataOffset() {
+    return (sizeof(InlineTensorBuffer) + Allocator::kAllocatorAlignment - 1) /
+           Allocator::kAllocatorAlignment * Allocator::kAllocatorAlignment;
+  }
+
+  const size_t size_;
+};
+
 }  // namespace
 
 const int64_t EagerContext::kGlobalRendezvousId = -1;
@@ -247,7 +292,16 @@ AbstractTensorInterface* EagerContext::CreateBoolScalar(bool value) {
 
 AbstractTensorInterface* EagerContext::CreateTensor(
     DataType dtype, absl::Span<const int64_t> dim_sizes) {
-  return new TensorInterface(Tensor(dtype, TensorShape(dim_sizes)));
+  TensorShape shape(dim_sizes);
+  const size_t num_bytes = shape.num_elements() * DataTypeSize(dtype);
+  if (DataTypeCanUseMemcpy(dtype) && num_bytes > 0 &&
+      num_bytes <= kMaxInlineTensorBytes) {
+    InlineTensorBuffer* buf = InlineTensorBuffer::New(num_bytes);
+    Tensor tensor(dtype, shape, buf);
+    buf->Unref();
+    return new TensorInterface(std::move(tensor));
+  }
+  return new TensorInterface(Tensor(dtype, shape));
 }
 
 AbstractTensorInterface* EagerContext::CreateTensor(
@@ -486,6 +540,7 @@ void EagerContext::ClearCachesAndDefaultExecutor() {
   mutex_lock ml(cache_mu_);
   default_executor_.WaitForAllPendingNodes().IgnoreError();
   kernel_cache_.clear();
+  kernel_cache_generation_.fetch_add(1, std::memory_order_release);
   for (auto& entry : registered_functions_) {
     entry.second->cached_kernel_keys->clear();
   }
@@ -987,6 +1042,7 @@ Status EagerContext::RemoveFunction(const string& func) {
     for (auto& key : *registered_function->cached_kernel_keys) {
       kernel_cache_.erase(key);
     }
+    kernel_cache_generation_.fetch_add(1, std::memory_order_release);
     registered_functions_.erase(func);
   }
   registered_function->Unref();
@@ -263,6 +263,13 @@ class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
 
   void AddKernelToCache(Fprint128 cache_key, KernelAndDevice* kernel);
 
+  // Incremented whenever kernels are evicted from the kernel cache, so that
+  // kernels memoized outside of it (see EagerOperation::GetMemoizedKernel) can
+  // be revalidated without locking the cache.
+  int64_t KernelCacheGeneration() const {
+    return kernel_cache_generation_.load(std::memory_order_acquire);
+  }
+
   bool LogDevicePlacement() const { return log_device_placement_; }
   void SetLogDevicePlacement(bool enable) override {
     log_device_placement_ = enable;
@@ -716,6 +723,7 @@ class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
       kernel_cache_ TF_GUARDED_BY(cache_mu_);
   std::unordered_map<string, RegisteredFunction*> registered_functions_
       TF_GUARDED_BY(cache_mu_);
+  std::atomic<int64_t> kernel_cache_generation_{0};
 
   // Whether we should compute RunMetadata.
   std::atomic<bool> should_store_graphs_{false};
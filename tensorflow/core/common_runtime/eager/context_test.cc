@@ -399,5 +399,37 @@ TEST_F(EagerContextTest, ReuseGlobalRendezvous) {
   TestGlobalRendezvous(context(), true);
 }
 
+TEST_F(EagerContextTest, CreateTensor) {
+  InitContext(SessionOptions(), DEVICE_PLACEMENT_EXPLICIT);
+
+  // Small enough to be allocated inline.
+  AbstractTensorInterface* small =
+      context()->CreateTensor(DT_FLOAT, std::vector<int64_t>{2, 3});
+  EXPECT_EQ(small->Type(), DT_FLOAT);
+  EXPECT_EQ(small->NumDims(), 2);
+  EXPECT_EQ(small->NumElements(), 6);
+  EXPECT_EQ(small->ByteSize(), 6 * sizeof(float));
+  EXPECT_TRUE(small->IsAligned());
+  float* small_data = static_cast<float*>(small->Data());
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_EQ(small_data[i], 0.0f);
+    small_data[i] = i;
+  }
+  EXPECT_EQ(small_data[5], 5.0f);
+  small->Release();
+
+  AbstractTensorInterface* large =
+      context()->CreateTensor(DT_FLOAT, std::vector<int64_t>{64, 64});
+  EXPECT_EQ(large->NumElements(), 64 * 64);
+  EXPECT_TRUE(large->IsAligned());
+  large->Release();
+
+  AbstractTensorInterface* strings =
+      context()->CreateTensor(DT_STRING, std::vector<int64_t>{2});
+  EXPECT_EQ(strings->Type(), DT_STRING);
+  EXPECT_EQ(strings->NumElements(), 2);
+  strings->Release();
+}
+
 }  // namespace
 }  // namespace tensorflow
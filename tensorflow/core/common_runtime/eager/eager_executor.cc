@@ -120,6 +120,30 @@ Status EagerExecutor::SyncExecute(EagerNode* node) {
   return s;
 }
 
+Status EagerExecutor::ExecuteInlineIfIdle(EagerNode* node, bool* executed) {
+  DCHECK(Async());
+  DCHECK(node->AsAsync() == nullptr);
+  *executed = false;
+  uint64 id;
+  {
+    tensorflow::mutex_lock l(node_queue_mutex_);
+    if (state_ != ExecutorState::kActive || !status_.ok() ||
+        !node_queue_.empty() || !unfinished_nodes_.empty()) {
+      return Status::OK();
+    }
+    id = next_node_id_++;
+  }
+  *executed = true;
+
+  Status s = node->Prepare();
+  if (s.ok()) {
+    s = node->Run();
+  }
+  tensorflow::mutex_lock l(node_queue_mutex_);
+  NotifyWaiters(id);
+  return s;
+}
+
 Status EagerExecutor::AddOrExecute(std::unique_ptr<EagerNode> node) {
   Status status;
   core::RefCountPtr<NodeItem> item(new NodeItem);
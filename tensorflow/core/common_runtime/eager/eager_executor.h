@@ -127,6 +127,13 @@ class EagerExecutor {
   // Inline execute node if executor is in sync mode.
   Status SyncExecute(EagerNode* node);
 
+  // Async mode only. Runs the synchronous `node` on the calling thread if the
+  // executor is healthy and has no pending or unfinished nodes, so that doing
+  // so preserves execution order. Sets `*executed` to whether `node` was run;
+  // if it was not, the caller should schedule an equivalent async node.
+  // Returns the status of running `node`.
+  Status ExecuteInlineIfIdle(EagerNode* node, bool* executed);
+
   // - Async Mode: schedules `node` for execution.
   // - Sync Mode: inline execute the 'node' directly.
   // If an error occurs (e.g. EagerExecutor has already been shut down), the
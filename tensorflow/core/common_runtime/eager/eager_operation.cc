@@ -351,6 +351,24 @@ Status EagerOperation::Reset(
   return SetDeviceName(device_name);
 }
 
+core::RefCountPtr<KernelAndDevice> EagerOperation::GetMemoizedKernel(
+    Fprint128 cache_key) {
+  if (memoized_kernel_ == nullptr || !(memoized_kernel_key_ == cache_key) ||
+      memoized_kernel_generation_ != ctx_.KernelCacheGeneration()) {
+    return nullptr;
+  }
+  memoized_kernel_->Ref();
+  return core::RefCountPtr<KernelAndDevice>(memoized_kernel_.get());
+}
+
+void EagerOperation::MemoizeKernel(Fprint128 cache_key,
+                                   KernelAndDevice* kernel) {
+  kernel->Ref();
+  memoized_kernel_.reset(kernel);
+  memoized_kernel_key_ = cache_key;
+  memoized_kernel_generation_ = ctx_.KernelCacheGeneration();
+}
+
 Status EagerOperation::MaybeInferSingleInputAttrs(
     ImmediateExecutionTensorHandle* handle) {
   if (!op_def_) return Status::OK();
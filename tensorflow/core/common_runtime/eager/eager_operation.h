@@ -215,6 +215,14 @@ class EagerOperation : public ImmediateExecutionOperation {
   // Op name recorded for memory debugging purpose.
   const char* op_name() const { return op_name_; }
 
+  // Returns the kernel memoized by MemoizeKernel() if it was memoized for
+  // `cache_key` and the context has not evicted any kernels since, or nullptr.
+  // The memo survives Clear() and Reset(), so an operation that is executed
+  // repeatedly with the same attributes and device finds its kernel without
+  // going through the context's kernel cache.
+  core::RefCountPtr<KernelAndDevice> GetMemoizedKernel(Fprint128 cache_key);
+  void MemoizeKernel(Fprint128 cache_key, KernelAndDevice* kernel);
+
   // For LLVM style RTTI.
   static bool classof(const AbstractOperation* ptr) {
     return ptr->getKind() == kEager;
@@ -283,6 +291,11 @@ class EagerOperation : public ImmediateExecutionOperation {
   int inference_arg_idx_;  // arg definition index for the next input to be
                            // added
   gtl::FlatSet<std::string> inference_attrs_;  // attributes inferred so far
+
+  // See GetMemoizedKernel().
+  Fprint128 memoized_kernel_key_ = {0, 0};
+  int64_t memoized_kernel_generation_ = -1;
+  core::RefCountPtr<KernelAndDevice> memoized_kernel_;
 };
 
 inline void EagerOperation::UpdateInput(int i, TensorHandle* h) {
@@ -77,5 +77,39 @@ TEST(EagerOperationTest, EagerFunctionParamsAndStepId) {
   ctx->Unref();
 }
 
+TEST(EagerOperationTest, MemoizedKernel) {
+  StaticDeviceMgr device_mgr(DeviceFactory::NewDevice(
+      "CPU", {}, "/job:localhost/replica:0/task:0/device:CPU:0"));
+  auto ctx = new EagerContext(
+      SessionOptions(),
+      tensorflow::ContextDevicePlacementPolicy::DEVICE_PLACEMENT_SILENT, false,
+      &device_mgr, false, nullptr, nullptr);
+
+  auto op = new EagerOperation(ctx);
+  TF_ASSERT_OK(op->Reset("Identity", nullptr));
+  const Fprint128 cache_key = {1, 2};
+  EXPECT_EQ(op->GetMemoizedKernel(cache_key), nullptr);
+
+  core::RefCountPtr<KernelAndDevice> kernel(new KernelAndDeviceOp(
+      /*rendezvous=*/nullptr, /*log_memory=*/false, /*flr=*/nullptr,
+      /*runner=*/nullptr, /*collective_executor=*/nullptr,
+      /*host_cpu_device=*/nullptr));
+  op->MemoizeKernel(cache_key, kernel.get());
+  EXPECT_EQ(op->GetMemoizedKernel(cache_key).get(), kernel.get());
+  EXPECT_EQ(op->GetMemoizedKernel({2, 1}), nullptr);
+
+  // The memo survives reuse of the operation...
+  op->Clear();
+  TF_ASSERT_OK(op->Reset("Identity", nullptr));
+  EXPECT_EQ(op->GetMemoizedKernel(cache_key).get(), kernel.get());
+
+  // ... but not eviction of kernels from the context.
+  ctx->ClearCachesAndDefaultExecutor();
+  EXPECT_EQ(op->GetMemoizedKernel(cache_key), nullptr);
+
+  delete op;
+  ctx->Unref();
+}
+
 }  // namespace
 }  // namespace tensorflow
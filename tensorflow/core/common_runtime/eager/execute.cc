@@ -63,6 +63,7 @@ limitations under the License.
 #include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/core/protobuf/error_codes.pb.h"
 #include "tensorflow/core/util/device_name_utils.h"
+#include "tensorflow/core/util/env_var.h"
 #if !defined(IS_MOBILE_PLATFORM)
 #include "tensorflow/core/distributed_runtime/eager/eager_client.h"
 #include "tensorflow/core/distributed_runtime/eager/remote_copy_node.h"
@@ -952,7 +953,15 @@ Status GetOrCreateKernelAndDevice(
       GetKernelCacheKey(*op, op->MutableAttrs()->CacheKey(op->DeviceName()),
                         input_dev_ptrs,
                         input_resource_variable_dtypes_and_shapes));
-  core::RefCountPtr<KernelAndDevice> kernel = ctx.GetCachedKernel(cache_key);
+  core::RefCountPtr<KernelAndDevice> kernel = op->GetMemoizedKernel(cache_key);
+  if (kernel == nullptr) {
+    kernel = ctx.GetCachedKernel(cache_key);
+    // Functions can be redefined under the same name, so only primitive ops
+    // are memoized on the operation.
+    if (kernel != nullptr && !op->is_function()) {
+      op->MemoizeKernel(cache_key, kernel.get());
+    }
+  }
   AbstractOperationPtr wrapped_op_releaser;
   // We can eliminate some overhead by running simple functions using regular
   // CallOp kernel. However, it is tricky to figure out which functions should
@@ -1185,6 +1194,43 @@ Status CreateUnshapedOutput(
 #endif  // !IS_MOBILE_PLATFORM
 }
 
+// Returns the size limit, in bytes, of the total inputs of local CPU ops that
+// async executors run on the calling thread when idle; 0 disables this.
+int64_t InlineExecutionMaxInputBytes() {
+  static const int64_t max_input_bytes = [] {
+    int64_t value;
+    TF_CHECK_OK(ReadInt64FromEnvVar("TF_EAGER_INLINE_EXECUTION_MAX_INPUT_BYTES",
+                                    0, &value));
+    return value;
+  }();
+  return max_input_bytes;
+}
+
+// Returns true if `kernel` is cheap enough to run inline instead of allocating
+// an AsyncExecuteNode for it: a primitive op on a local CPU device whose inputs
+// are ready local tensors of at most InlineExecutionMaxInputBytes() in total.
+bool IsInlineExecutionCandidate(
+    KernelAndDevice* kernel,
+    const absl::InlinedVector<TensorHandle*, 4>& inputs) {
+  const int64_t max_input_bytes = InlineExecutionMaxInputBytes();
+  if (max_input_bytes <= 0 || kernel->IsFunction() ||
+      kernel->device() == nullptr ||
+      kernel->device()->device_type() != DEVICE_CPU) {
+    return false;
+  }
+  int64_t input_bytes = 0;
+  for (TensorHandle* input : inputs) {
+    const Tensor* tensor;
+    if (input->Type() != TensorHandle::LOCAL || !input->IsReady() ||
+        !input->Tensor(&tensor).ok()) {
+      return false;
+    }
+    input_bytes += tensor->TotalBytes();
+    if (input_bytes > max_input_bytes) return false;
+  }
+  return true;
+}
+
 Status AddOrExecuteNode(core::RefCountPtr<KernelAndDevice> kernel,
                         EagerOperation* op, TensorHandle** retvals) {
   EagerExecutor& executor = op->Executor();
@@ -1206,6 +1252,25 @@ Status AddOrExecuteNode(core::RefCountPtr<KernelAndDevice> kernel,
     eager_func_params = EagerFunctionParams{op_id, /*step_id=*/absl::nullopt};
 #endif  // !IS_MOBILE_PLATFORM
   }
+  if (executor.Async() && !kernel->IsCrossProcess()) {
+    const absl::InlinedVector<TensorHandle*, 4>* inputs;
+    TF_RETURN_IF_ERROR(op->TensorHandleInputs(&inputs));
+    if (IsInlineExecutionCandidate(kernel.get(), *inputs)) {
+      for (int i = 0, end = num_outputs; i < end; ++i) {
+        retvals[i] = nullptr;
+      }
+      ExecuteNode node(&ctx, *inputs, eager_func_params, kernel,
+                       graph_collector, op->GetCancellationManager(),
+                       {retvals, static_cast<size_t>(num_outputs)},
+                       op->GetStackTrace());
+      bool executed;
+      Status s = executor.ExecuteInlineIfIdle(&node, &executed);
+      if (executed) {
+        op->Clear();
+        return s;
+      }
+    }
+  }
   if (executor.Async()) {
     const DataTypeVector& output_dtypes = kernel->output_dtypes();
     for (int i = 0, end = num_outputs; i < end; ++i) {
@@ -1233,8 +1298,6 @@ Status AddOrExecuteNode(core::RefCountPtr<KernelAndDevice> kernel,
     op->Clear();
     // For async mode, execution order will make sure that all
     // input handles are ready before executing them.
-    // TODO(b/137118203): Consider executing "cheap" kernels inline for
-    // performance.
     return executor.AddOrExecute(std::move(node));
   } else {
     for (int i = 0, end = num_outputs; i < end; ++i) {
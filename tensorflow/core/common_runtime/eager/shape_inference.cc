@@ -18,6 +18,7 @@ limitations under the License.
 #include <vector>
 
 #include "tensorflow/core/common_runtime/eager/tensor_handle.h"
+#include "tensorflow/core/common_runtime/shape_inference_cache.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/shape_inference.h"
 #include "tensorflow/core/public/version.h"
@@ -30,7 +31,6 @@ Status RunShapeInference(const NodeDef& ndef,
                          const gtl::InlinedVector<TensorHandle*, 4>& inputs,
                          const gtl::InlinedVector<TensorHandle*, 2>& retvals) {
   const tensorflow::OpRegistrationData* op_reg_data;
-  // TODO(b/141209983): Consider adding a shape inference cache.
   // FunctionLibraryDefinition::LookUp delegates to global OpRegistry
   // if op is not a function.
   TF_RETURN_IF_ERROR(lib_def.LookUp(ndef.op(), &op_reg_data));
@@ -45,7 +45,14 @@ Status RunShapeInference(const NodeDef& ndef,
     ic.SetInput(i, shape);
   }
 
-  TF_RETURN_IF_ERROR(ic.Run(op_reg_data->shape_inference_fn));
+  ShapeInferenceCache* cache = ShapeInferenceCache::Global();
+  if (cache != nullptr) {
+    TF_RETURN_IF_ERROR(cache->Run(ndef.op(), AttrSlice(ndef),
+                                  TF_GRAPH_DEF_VERSION,
+                                  op_reg_data->shape_inference_fn, &ic));
+  } else {
+    TF_RETURN_IF_ERROR(ic.Run(op_reg_data->shape_inference_fn));
+  }
   CHECK_EQ(ic.num_outputs(), retvals.size());
   for (int i = 0; i < ic.num_outputs(); i++) {
     shape_inference::ShapeHandle shape_handle = ic.output(i);
@@ -62,8 +62,67 @@ string SafeDeviceDebugString(Device* device) {
     return device->DebugString();
   }
 }
+
+// The maximum number of freed TensorHandle blocks kept by each thread.
+constexpr int kMaxFreeTensorHandlesPerThread = 64;
+
+// A bounded stack of freed TensorHandle blocks, owned by one thread. Blocks
+// are freed on whichever thread drops the last reference, so a block may be
+// allocated on one thread and recycled on another.
+class TensorHandleFreelist {
+ public:
+  ~TensorHandleFreelist() {
+    for (int i = 0; i < size_; ++i) ::operator delete(blocks_[i]);
+    size_ = 0;
+  }
+
+  void* Pop() { return size_ > 0 ? blocks_[--size_] : nullptr; }
+
+  bool Push(void* block) {
+    if (size_ == kMaxFreeTensorHandlesPerThread) return false;
+    blocks_[size_++] = block;
+    return true;
+  }
+
+ private:
+  void* blocks_[kMaxFreeTensorHandlesPerThread];
+  int size_ = 0;
+};
+
+// Set once the calling thread's freelist has been destroyed, so that handles
+// released during thread exit go straight to the system allocator.
+thread_local bool tensor_handle_freelist_destroyed = false;
+
+TensorHandleFreelist* GetTensorHandleFreelist() {
+  if (tensor_handle_freelist_destroyed) return nullptr;
+  struct Holder {
+    ~Holder() { tensor_handle_freelist_destroyed = true; }
+    TensorHandleFreelist freelist;
+  };
+  thread_local Holder holder;
+  return &holder.freelist;
+}
 }  // namespace
 
+void* TensorHandle::operator new(size_t size) {
+  if (size == sizeof(TensorHandle)) {
+    TensorHandleFreelist* freelist = GetTensorHandleFreelist();
+    if (freelist != nullptr) {
+      void* block = freelist->Pop();
+      if (block != nullptr) return block;
+    }
+  }
+  return ::operator new(size);
+}
+
+void TensorHandle::operator delete(void* ptr, size_t size) {
+  if (size == sizeof(TensorHandle)) {
+    TensorHandleFreelist* freelist = GetTensorHandleFreelist();
+    if (freelist != nullptr && freelist->Push(ptr)) return;
+  }
+  ::operator delete(ptr);
+}
+
 TensorHandle::PackedTensorHandleData::PackedTensorHandleData(
     std::vector<TensorHandle*>&& handles, const TensorShape& shape)
     : handles_(std::move(handles)), shape_(shape) {
@@ -121,6 +121,12 @@ class TensorHandle : public ImmediateExecutionTensorHandle {
 
   void Release() override;
 
+  // Handles are created and destroyed at a high rate in eager mode, mostly on
+  // the Python thread. Their memory is recycled through a small per-thread
+  // freelist rather than returned to the system allocator every time.
+  static void* operator new(size_t size);
+  static void operator delete(void* ptr, size_t size);
+
   tensorflow::DataType DataType() const override;
   Status Shape(tensorflow::PartialTensorShape* shape) const override;
   Status NumDims(int* num_dims) const override;
@@ -260,6 +266,10 @@ class TensorHandle : public ImmediateExecutionTensorHandle {
   Status GetResourceHandleDtypesAndShapes(
       std::vector<DtypeAndPartialTensorShape>* result);
 
+  // Returns true if the handle's data is available, i.e. methods that wait for
+  // it would not block.
+  bool IsReady() const;
+
   // Returns the number of packed handles. 0 if the handle type is not PACKED.
   int NumPackedHandles() const;
   // It's called on a packed TensorHandle. Extract a handle with the given
@@ -284,7 +294,6 @@ class TensorHandle : public ImmediateExecutionTensorHandle {
   // Further, it can be in a non-ready state. It would become ready with a call
   // to either SetTensor or SetRemoteShape which replaces the underlying data
   // with a ready version of the tensor handle data.
-  bool IsReady() const;
   Status WaitReady(const char* caller) const;
 
   tensorflow::Device* device_;
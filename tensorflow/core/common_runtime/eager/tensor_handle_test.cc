@@ -464,4 +464,20 @@ TEST(TensorHandle_DeviceNameTest, OnLocalDevice) {
   ctx->Unref();
 }
 
+TEST(TensorHandle_PoolTest, ReusesReleasedHandles) {
+  TensorHandle* first =
+      TensorHandle::CreateLocalHandle(Tensor(DT_FLOAT, TensorShape({2})));
+  void* first_address = first;
+  first->Unref();
+
+  TensorHandle* second =
+      TensorHandle::CreateLocalHandle(Tensor(DT_INT32, TensorShape({3})));
+  EXPECT_EQ(static_cast<void*>(second), first_address);
+  EXPECT_EQ(second->DataType(), DT_INT32);
+  int64_t num_elements = -1;
+  TF_EXPECT_OK(second->NumElements(&num_elements));
+  EXPECT_EQ(num_elements, 3);
+  second->Unref();
+}
+
 }  // namespace tensorflow
@@ -22,6 +22,7 @@ limitations under the License.
 #include "absl/memory/memory.h"
 #include "absl/time/time.h"
 #include "absl/types/optional.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/common_runtime/costmodel_manager.h"
 #include "tensorflow/core/common_runtime/entry.h"
 #include "tensorflow/core/common_runtime/executor_factory.h"
@@ -32,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/renamed_device.h"
 #include "tensorflow/core/common_runtime/simple_propagator_state.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
+#include "tensorflow/core/common_runtime/work_stealing_queue.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/collective.h"
@@ -58,6 +60,7 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/manual_constructor.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/context.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
@@ -135,17 +138,36 @@ struct KernelTimer {
   }
 };
 
+// Returns a small integer that identifies the calling thread. Used to pick the
+// work-stealing queue that a thread pushes newly ready nodes onto.
+int CurrentThreadSlot() {
+  static std::atomic<int> next_slot{0};
+  thread_local const int slot =
+      next_slot.fetch_add(1, std::memory_order_relaxed);
+  return slot;
+}
+
 // TODO(b/152925936): Re-evaluate these constants with current usage patterns.
 typedef gtl::InlinedVector<TensorValue, 4> TensorValueVec;
 typedef gtl::InlinedVector<AllocatorAttributes, 4> AllocatorAttributeVec;
 
 class ExecutorImpl : public Executor {
  public:
-  explicit ExecutorImpl(const LocalExecutorParams& p) : immutable_state_(p) {}
+  // If `work_stealing` is true, nodes that become ready are kept on per-thread
+  // LIFO queues and idle inter-op threads steal from them, instead of every
+  // expensive node being handed to the inter-op thread pool.
+  explicit ExecutorImpl(const LocalExecutorParams& p,
+                        bool work_stealing = false)
+      : immutable_state_(p),
+        num_work_stealing_queues_(work_stealing ? port::MaxParallelism() : 0) {}
 
   Status Initialize(const Graph& graph) {
     TF_RETURN_IF_ERROR(immutable_state_.Initialize(graph));
     kernel_stats_.Initialize(immutable_state_.graph_view());
+    if (immutable_state_.params().cost_model != nullptr) {
+      kernel_stats_.SeedCostEstimates(graph,
+                                      *immutable_state_.params().cost_model);
+    }
     return Status::OK();
   }
 
@@ -168,29 +190,44 @@ class ExecutorImpl : public Executor {
         if (gview.node(i)) {
           is_expensive_[i] =
               gview.node(i)->kernel && gview.node(i)->kernel->IsExpensive();
-          cost_estimates_[i] = kInitialCostEstimateCycles;
+          cost_estimates_[i] =
+              is_expensive_[i] ? kInitialCostEstimateCycles : 0;
         }
       }
     }
 
+    // Replaces the initial cost estimates of the nodes in `graph` that
+    // `cost_model` has observed with the measured average execution time.
+    // Nodes the cost model has not observed keep their initial estimate.
+    void SeedCostEstimates(const Graph& graph, const CostModel& cost_model) {
+      const double cycles_per_micro =
+          profile_utils::CpuUtils::GetCycleCounterFrequency() / 1.0e6;
+      if (cycles_per_micro <= 0) return;
+      for (const Node* n : graph.op_nodes()) {
+        if (cost_model.TotalCount(n) <= 0) continue;
+        const double micros = cost_model.TimeEstimate(n).value();
+        cost_estimates_[n->id()].store(
+            static_cast<uint64>(micros * cycles_per_micro),
+            std::memory_order_relaxed);
+      }
+    }
+
     // Returns true iff the given node is considered "expensive". The
     // executor uses this flag to optimize graph execution, for example
     // by "inlining" inexpensive kernels.
     bool IsExpensive(const NodeItem& node) const {
-      return is_expensive_[node.node_id] &&
-             (cost_estimates_[node.node_id].load(std::memory_order_relaxed) >
-              kOpIsExpensiveThresholdCycles);
+      return CostEstimate(node) > kOpIsExpensiveThresholdCycles;
     }
 
-    // Returns the value of kernel->IsExpensive().
-    bool HasExpensiveMarker(const NodeItem& node) const {
-      return is_expensive_[node.node_id];
+    // Returns the current estimate (in CPU cycles) of the execution time of
+    // the given node.
+    uint64 CostEstimate(const NodeItem& node) const {
+      return cost_estimates_[node.node_id].load(std::memory_order_relaxed);
     }
 
     // Updates the dynamic cost estimate, which is used to determine whether the
     // given node is expensive. The new cost estimate is a weighted average of
-    // the old cost estimate and the latest cost. We only update cost estimates
-    // for kernels for which IsExpensive() return true.
+    // the old cost estimate and the latest cost.
     void UpdateCostEstimate(const NodeItem& node, uint64 elapsed_cycles) {
       // N.B. Updates to `cost_estimate` are atomic but unlocked.  Simultaneous
       // updates may result in one or more updates being ignored.  This does not
@@ -204,12 +241,18 @@ class ExecutorImpl : public Executor {
       cost_estimate.store(new_estimate, std::memory_order_relaxed);
     }
 
+    // Approximate cost (in CPU cycles) of handing a closure to the inter-op
+    // thread pool. Nodes whose estimated cost exceeds this are "expensive",
+    // and inexpensive nodes are only dispatched to another thread in batches
+    // whose total estimated cost exceeds it.
+    static constexpr uint64 kOpIsExpensiveThresholdCycles = 8000;
+
    private:
     // Initial time (in CPU cycles) we expect an operation to take.  Used to
     // determine whether an operation should be place in a threadpool.
-    // Operations start out "expensive".
+    // Operations whose kernel has the expensive marker start out "expensive";
+    // all other operations start out inexpensive until they are measured.
     static constexpr uint64 kInitialCostEstimateCycles = 100 * 1000 * 1000;
-    static constexpr uint64 kOpIsExpensiveThresholdCycles = 8000;
     static constexpr uint64 kCostDecay = 10;
 
     std::vector<bool> is_expensive_;
@@ -219,6 +262,9 @@ class ExecutorImpl : public Executor {
 
   ImmutableExecutorState immutable_state_;
   KernelStats kernel_stats_;
+  // The number of per-thread ready queues each step uses, or 0 if work
+  // stealing is disabled.
+  const int num_work_stealing_queues_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(ExecutorImpl);
 };
@@ -277,7 +323,8 @@ class ExecutorState {
  public:
   ExecutorState(const Executor::Args& args,
                 const ImmutableExecutorState& immutable_state_,
-                ExecutorImpl::KernelStats* kernel_stats_);
+                ExecutorImpl::KernelStats* kernel_stats_,
+                int num_work_stealing_queues = 0);
   ~ExecutorState();
 
   void RunAsync(Executor::DoneCallback done);
@@ -292,7 +339,16 @@ class ExecutorState {
   struct AsyncState;
 
   // Process a ready node in current thread.
-  void Process(TaggedNode node, int64_t scheduled_nsec);
+  void Process(TaggedNode node, int64_t scheduled_nsec) {
+    Process(absl::MakeConstSpan(&node, 1), scheduled_nsec);
+  }
+
+  // Process a batch of ready nodes in current thread, as if they had all been
+  // made ready by the same node: nodes that become ready while the batch is
+  // being processed are scheduled as usual by `ScheduleReady()`.
+  //
+  // REQUIRES: `!nodes.empty()`.
+  void Process(absl::Span<const TaggedNode> nodes, int64_t scheduled_nsec);
 
   Status ProcessSync(const NodeItem& item, OpKernelContext::Params* params,
                      EntryVector* outputs, NodeExecStatsInterface* stats);
@@ -322,13 +378,32 @@ class ExecutorState {
                 TaggedNodeReadyQueue* inline_ready);
 
   // Schedule all the expensive nodes in '*ready', and put all the inexpensive
-  // nodes in 'ready' into 'inline_ready'.
+  // nodes in 'ready' into 'inline_ready'. Inexpensive nodes are dispatched to
+  // the thread pool together, in batches whose total estimated cost exceeds
+  // the cost of dispatching a closure.
   //
   // This method will clear `*ready` before returning.
   //
   // REQUIRES: `!ready->empty()`.
   void ScheduleReady(TaggedNodeSeq* ready, TaggedNodeReadyQueue* inline_ready);
 
+  // If work stealing is enabled, moves one node from the work-stealing queues
+  // into `*inline_ready`. Returns false if there was no node to move.
+  bool PopStealable(TaggedNodeReadyQueue* inline_ready);
+
+  // Pushes the nodes in [begin, end) onto the calling thread's work-stealing
+  // queue, and wakes up to one idle inter-op thread per pushed node to steal
+  // them.
+  //
+  // REQUIRES: `work_stealing_queues_ != nullptr`.
+  void PushStealable(typename TaggedNodeSeq::const_iterator begin,
+                     typename TaggedNodeSeq::const_iterator end,
+                     int64_t scheduled_nsec);
+
+  // Runs on an inter-op thread woken up by `PushStealable()`. Steals one node
+  // from any work-stealing queue and processes it.
+  void StealAndProcess(int64_t scheduled_nsec);
+
   // A wrapper for runner_ to keep track of the pending queue length. Op
   // execution should dispatch work using this function instead of using runner_
   // directly.
@@ -376,18 +451,31 @@ class ExecutorState {
   CoordinationServiceAgent* coordination_service_agent_;
   absl::optional<ManagedStackTrace> stack_trace_ = absl::nullopt;
   // If not null, use this device to schedule intra-op operation
-  std::unique_ptr<DeviceBase> user_device_;
+  std::unique_ptr<Device> user_device_;
   Executor::Args::Runner runner_;
   bool sync_on_finish_;
   const bool run_all_kernels_inline_;
 
   PropagatorStateType propagator_;
 
+  // Per-thread ready queues used when work stealing is enabled. Null otherwise.
+  //
+  // Every node held in these queues is counted in `num_outstanding_ops_`.
+  std::unique_ptr<WorkStealingQueues<TaggedNode>> work_stealing_queues_;
+  // The number of `StealAndProcess()` closures that have been handed to
+  // `runner_` but have not started running yet.
+  std::atomic<int> num_pending_stealers_{0};
+
   // Invoked when the execution finishes.
   Executor::DoneCallback done_cb_;
 
   std::atomic_int_fast32_t num_outstanding_ops_;
 
+  // The number of nodes `ScheduleReady()` has run on the calling thread and
+  // dispatched to other threads, respectively. Exported in `Finish()`.
+  std::atomic<int64_t> num_inlined_nodes_{0};
+  std::atomic<int64_t> num_dispatched_nodes_{0};
+
   // Available via OpKernelContext to every OpKernel invocation.
   mutex num_deferred_ops_mu_;
   int64_t num_deferred_ops_ TF_GUARDED_BY(num_deferred_ops_mu_) = 0;
@@ -401,7 +489,7 @@ class ExecutorState {
 template <class PropagatorStateType>
 ExecutorState<PropagatorStateType>::ExecutorState(
     const Executor::Args& args, const ImmutableExecutorState& immutable_state,
-    ExecutorImpl::KernelStats* kernel_stats)
+    ExecutorImpl::KernelStats* kernel_stats, int num_work_stealing_queues)
     : vlog_(VLOG_IS_ON(1)),
       log_memory_(LogMemory::IsEnabled()),
       step_id_(args.step_id),
@@ -430,10 +518,19 @@ ExecutorState<PropagatorStateType>::ExecutorState(
       run_all_kernels_inline_(args.run_all_kernels_inline),
       propagator_(immutable_state, step_id_, vlog_),
       num_outstanding_ops_(0) {
-  if (args.user_intra_op_threadpool != nullptr) {
+  if (args.user_intra_op_threadpool != nullptr ||
+      args.step_allocator != nullptr || args.device_step_allocator != nullptr ||
+      args.device_context != nullptr) {
     Device* device = immutable_state_.params().device;
     user_device_ = RenamedDevice::NewRenamedDevice(
-        device->name(), device, false, false, args.user_intra_op_threadpool);
+        device->name(), device, false, false, args.user_intra_op_threadpool,
+        args.step_allocator, args.device_step_allocator, args.device_context);
+  }
+  // Running all kernels inline already keeps every node on one thread, so
+  // there is nothing to steal in that mode.
+  if (num_work_stealing_queues > 0 && !run_all_kernels_inline_) {
+    work_stealing_queues_ = absl::make_unique<WorkStealingQueues<TaggedNode>>(
+        num_work_stealing_queues);
   }
 }
 
@@ -474,7 +571,8 @@ void ExecutorState<PropagatorStateType>::RunAsync(Executor::DoneCallback done) {
   TaggedNodeSeq ready;
 
   // Ask the device to fill in the device context map.
-  Device* device = immutable_state_.params().device;
+  Device* device =
+      user_device_ ? user_device_.get() : immutable_state_.params().device;
   const Status get_context_status =
       device->TryGetDeviceContext(&device_context_);
   if (!get_context_status.ok()) {
@@ -582,7 +680,7 @@ Status ExecutorState<PropagatorStateType>::ProcessSync(
         },
         profiler::GetTFTraceMeLevel(is_expensive));
     device->Compute(op_kernel, &ctx);
-  } else if (kernel_stats_->HasExpensiveMarker(item)) {
+  } else {
     KernelTimer timer;
     device->Compute(op_kernel, &ctx);
     // For expensive kernels, always update the cost estimate. For inexpensive
@@ -593,8 +691,6 @@ Status ExecutorState<PropagatorStateType>::ProcessSync(
         timer.start_cycles % kKernelExecutionTrackingInvocationSkipCount == 0) {
       kernel_stats_->UpdateCostEstimate(item, timer.ElapsedCycles());
     }
-  } else {
-    device->Compute(op_kernel, &ctx);
   }
   nodestats::SetOpEnd(stats);
   if (outputs->size() < item.num_outputs) outputs->resize(item.num_outputs);
@@ -676,8 +772,10 @@ void ExecutorState<PropagatorStateType>::ProcessConstTensor(
 }
 
 template <class PropagatorStateType>
-void ExecutorState<PropagatorStateType>::Process(TaggedNode tagged_node,
-                                                 int64_t scheduled_nsec) {
+void ExecutorState<PropagatorStateType>::Process(
+    absl::Span<const TaggedNode> nodes, int64_t scheduled_nsec) {
+  DCHECK(!nodes.empty());
+  TaggedNode tagged_node = nodes.front();
   profiler::TraceMeConsumer activity(
       // From TraceMeProducer in DirectSession::RunInternal,
       // GraphMgr::ExecuteAsync, or FunctionLibraryRuntime::Run.
@@ -759,8 +857,17 @@ void ExecutorState<PropagatorStateType>::Process(TaggedNode tagged_node,
   EntryVector outputs(1);
 
   bool completed = false;
-  inline_ready.push_back(tagged_node);
-  while (!inline_ready.empty()) {
+  // When work stealing is enabled, this thread keeps processing nodes from the
+  // work-stealing queues after `inline_ready` drains. It holds an extra
+  // reference on `num_outstanding_ops_` while doing so, which keeps the
+  // queues alive until it stops looking for work.
+  if (work_stealing_queues_) {
+    num_outstanding_ops_.fetch_add(1, std::memory_order_relaxed);
+  }
+  for (const TaggedNode& node : nodes) {
+    inline_ready.push_back(node);
+  }
+  while (!inline_ready.empty() || PopStealable(&inline_ready)) {
     tagged_node = inline_ready.front();
     inline_ready.pop_front();
     const NodeItem& item = tagged_node.get_node_item();
@@ -822,6 +929,7 @@ void ExecutorState<PropagatorStateType>::Process(TaggedNode tagged_node,
       params.output_attr_array = item.output_attrs();
       params.forward_from_array = item.forward_from();
       params.outputs_required_array = item.outputs_required.get();
+      params.output_retval_array = item.output_retvals.get();
 
       if (item.kernel_is_async) {
         ProcessAsync(item, params, tagged_node, first_input, stats);
@@ -864,10 +972,65 @@ void ExecutorState<PropagatorStateType>::Process(TaggedNode tagged_node,
     }
   }  // while !inline_ready.empty()
 
+  if (work_stealing_queues_) {
+    // Release the reference taken above. All nodes have been processed if this
+    // was the last one.
+    completed = num_outstanding_ops_.fetch_sub(1) == 1;
+  }
+
   // This thread of computation is done if completed = true.
   if (completed) ScheduleFinish();
 }
 
+template <class PropagatorStateType>
+bool ExecutorState<PropagatorStateType>::PopStealable(
+    TaggedNodeReadyQueue* inline_ready) {
+  if (!work_stealing_queues_) return false;
+  TaggedNode tagged_node;
+  if (!work_stealing_queues_->PopOrSteal(CurrentThreadSlot(), &tagged_node)) {
+    return false;
+  }
+  inline_ready->push_back(tagged_node);
+  return true;
+}
+
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::PushStealable(
+    typename TaggedNodeSeq::const_iterator begin,
+    typename TaggedNodeSeq::const_iterator end, int64_t scheduled_nsec) {
+  const int slot = CurrentThreadSlot();
+  for (auto it = begin; it != end; ++it) {
+    work_stealing_queues_->Push(slot, *it);
+  }
+  // Wake up idle threads to steal the nodes that were just pushed, but bound
+  // the number of wake-ups in flight: a thread that finds work keeps stealing
+  // until the queues are empty, so additional wake-ups would only add
+  // scheduling overhead.
+  const int max_pending = work_stealing_queues_->num_queues();
+  for (auto it = begin; it != end; ++it) {
+    if (num_pending_stealers_.fetch_add(1, std::memory_order_relaxed) >=
+        max_pending) {
+      num_pending_stealers_.fetch_sub(1, std::memory_order_relaxed);
+      break;
+    }
+    // Each stealer holds a reference on `num_outstanding_ops_` so that this
+    // state remains alive even if it finds nothing to steal.
+    num_outstanding_ops_.fetch_add(1, std::memory_order_relaxed);
+    RunTask([this, scheduled_nsec]() { StealAndProcess(scheduled_nsec); });
+  }
+}
+
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::StealAndProcess(
+    int64_t scheduled_nsec) {
+  num_pending_stealers_.fetch_sub(1, std::memory_order_relaxed);
+  TaggedNode tagged_node;
+  if (work_stealing_queues_->PopOrSteal(CurrentThreadSlot(), &tagged_node)) {
+    Process(tagged_node, scheduled_nsec);
+  }
+  if (num_outstanding_ops_.fetch_sub(1) == 1) ScheduleFinish();
+}
+
 template <class PropagatorStateType>
 Status ExecutorState<PropagatorStateType>::PrepareInputs(
     const NodeItem& item, Entry* first_input, TensorValueVec* inputs,
@@ -1173,7 +1336,10 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
     scheduled_nsec = nodestats::NowInNsec();
   }
 
+  int64_t num_inlined = 0;
+  int64_t num_dispatched = 0;
   if (run_all_kernels_inline_) {
+    num_inlined = ready->size();
     if (inline_ready == nullptr) {
       // Schedule all ready kernels from a single closure. This ensure that,
       // regardless of the `runner_` implementation, all kernels will run
@@ -1189,41 +1355,109 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
         inline_ready->push_back(tagged_node);
       }
     }
+  } else if (work_stealing_queues_ && inline_ready != nullptr) {
+    // Keep the first ready node on this thread, so that it consumes the
+    // outputs its producer just wrote while they are still in cache, and make
+    // the remaining nodes available to idle threads.
+    num_inlined = 1;
+    num_dispatched = ready->size() - 1;
+    inline_ready->push_back(ready->front());
+    if (ready->size() > 1) {
+      PushStealable(ready->begin() + 1, ready->end(), scheduled_nsec);
+    }
   } else {
+    // Inexpensive nodes that are run by this thread, or that will be
+    // dispatched together once their total estimated cost is enough to pay
+    // for the dispatch.
+    TaggedNodeSeq cheap_nodes;
+    uint64 cheap_nodes_cost = 0;
+    auto dispatch_cheap_nodes = [&]() {
+      num_dispatched += cheap_nodes.size();
+      if (cheap_nodes.size() == 1) {
+        RunTask([this, tagged_node = cheap_nodes.front(), scheduled_nsec]() {
+          Process(tagged_node, scheduled_nsec);
+        });
+      } else {
+        RunTask([this, nodes = std::move(cheap_nodes), scheduled_nsec]() {
+          Process(nodes, scheduled_nsec);
+        });
+      }
+      cheap_nodes.clear();
+      cheap_nodes_cost = 0;
+    };
+
     const TaggedNode* curr_expensive_node = nullptr;
-    if (inline_ready == nullptr) {
-      // Schedule to run all the ready ops in thread pool.
-      for (auto& tagged_node : *ready) {
-        RunTask([=]() { Process(tagged_node, scheduled_nsec); });
+    // Whether this thread already has enough inexpensive work to do that
+    // further inexpensive nodes should be batched for other threads.
+    bool inline_ready_is_full = false;
+    for (auto& tagged_node : *ready) {
+      const NodeItem& item = *tagged_node.node_item;
+      const uint64 cost =
+          tagged_node.get_is_dead() ? 0 : kernel_stats_->CostEstimate(item);
+      if (cost > ExecutorImpl::KernelStats::kOpIsExpensiveThresholdCycles) {
+        if (curr_expensive_node || inline_ready == nullptr) {
+          // Dispatch to another thread since there is plenty of work to
+          // do for this thread.
+          const TaggedNode& node =
+              inline_ready == nullptr ? tagged_node : *curr_expensive_node;
+          ++num_dispatched;
+          RunTask([this, node, scheduled_nsec]() {
+            Process(node, scheduled_nsec);
+          });
+        }
+        if (inline_ready != nullptr) curr_expensive_node = &tagged_node;
+        continue;
       }
-    } else {
-      for (auto& tagged_node : *ready) {
-        const NodeItem& item = *tagged_node.node_item;
-        if (tagged_node.get_is_dead() || !kernel_stats_->IsExpensive(item)) {
-          // Inline this inexpensive node.
-          inline_ready->push_back(tagged_node);
-        } else {
-          if (curr_expensive_node) {
-            // Dispatch to another thread since there is plenty of work to
-            // do for this thread.
-            RunTask(std::bind(&ExecutorState::Process, this,
-                              *curr_expensive_node, scheduled_nsec));
+      cheap_nodes.push_back(tagged_node);
+      cheap_nodes_cost += cost;
+      if (cheap_nodes_cost >
+          ExecutorImpl::KernelStats::kOpIsExpensiveThresholdCycles) {
+        if (inline_ready != nullptr && !inline_ready_is_full) {
+          // Inline the first batch of inexpensive nodes.
+          num_inlined += cheap_nodes.size();
+          for (auto& node : cheap_nodes) {
+            inline_ready->push_back(node);
           }
-          curr_expensive_node = &tagged_node;
+          cheap_nodes.clear();
+          cheap_nodes_cost = 0;
+          inline_ready_is_full = true;
+        } else {
+          dispatch_cheap_nodes();
+        }
+      }
+    }
+    if (!cheap_nodes.empty()) {
+      if (inline_ready == nullptr) {
+        // Run all remaining inexpensive nodes from a single closure.
+        dispatch_cheap_nodes();
+      } else {
+        // The remaining nodes are not worth a dispatch, so inline them.
+        num_inlined += cheap_nodes.size();
+        for (auto& node : cheap_nodes) {
+          inline_ready->push_back(node);
         }
       }
     }
     if (curr_expensive_node) {
       if (inline_ready->empty()) {
+        ++num_inlined;
         inline_ready->push_back(*curr_expensive_node);
       } else {
         // There are inline nodes to run already. We dispatch this expensive
         // node to other thread.
-        RunTask(std::bind(&ExecutorState::Process, this, *curr_expensive_node,
-                          scheduled_nsec));
+        ++num_dispatched;
+        RunTask([this, node = *curr_expensive_node, scheduled_nsec]() {
+          Process(node, scheduled_nsec);
+        });
       }
     }
   }
+  if (num_inlined > 0) {
+    num_inlined_nodes_.fetch_add(num_inlined, std::memory_order_relaxed);
+  }
+  if (num_dispatched > 0) {
+    num_dispatched_nodes_.fetch_add(num_dispatched, std::memory_order_relaxed);
+  }
   ready->clear();
 }
 
@@ -1257,6 +1491,9 @@ void ExecutorState<PropagatorStateType>::Finish() {
   int64_t step_id = step_id_;
   CHECK(done_cb != nullptr);
   Device* device = immutable_state_.params().device;
+  metrics::RecordExecutorScheduledNodes(
+      num_inlined_nodes_.load(std::memory_order_relaxed),
+      num_dispatched_nodes_.load(std::memory_order_relaxed));
 
   if (vlog_ && !status.ok() && VLOG_IS_ON(1)) {
     // Logs verbose information about the current state of active and pending
@@ -1364,15 +1601,19 @@ void ExecutorState<PropagatorStateType>::Finish() {
 
 void ExecutorImpl::RunAsync(const Args& args, DoneCallback done) {
   if (OpOrderDeterminismRequired()) {
+    // Work stealing reorders nodes, so it is never used when a deterministic
+    // op order is required.
     (new ExecutorState<OrderedPropagatorState>(args, immutable_state_,
                                                &kernel_stats_))
         ->RunAsync(std::move(done));
   } else if (immutable_state_.requires_control_flow_support()) {
-    (new ExecutorState<PropagatorState>(args, immutable_state_, &kernel_stats_))
+    (new ExecutorState<PropagatorState>(args, immutable_state_, &kernel_stats_,
+                                        num_work_stealing_queues_))
         ->RunAsync(std::move(done));
   } else {
     (new ExecutorState<SimplePropagatorState>(args, immutable_state_,
-                                              &kernel_stats_))
+                                              &kernel_stats_,
+                                              num_work_stealing_queues_))
         ->RunAsync(std::move(done));
   }
 }
@@ -1391,6 +1632,18 @@ Status NewLocalExecutor(const LocalExecutorParams& params, const Graph& graph,
   return s;
 }
 
+Status NewWorkStealingLocalExecutor(const LocalExecutorParams& params,
+                                    const Graph& graph, Executor** executor) {
+  ExecutorImpl* impl = new ExecutorImpl(params, /*work_stealing=*/true);
+  const Status s = impl->Initialize(graph);
+  if (s.ok()) {
+    *executor = impl;
+  } else {
+    delete impl;
+  }
+  return s;
+}
+
 Status CreateNonCachedKernel(Device* device, FunctionLibraryRuntime* flib,
                              const std::shared_ptr<const NodeProperties>& props,
                              int graph_def_version, OpKernel** kernel) {
@@ -1426,6 +1679,25 @@ class DefaultExecutorRegistrar {
 };
 static DefaultExecutorRegistrar registrar;
 
+class WorkStealingExecutorRegistrar {
+ public:
+  WorkStealingExecutorRegistrar() {
+    ExecutorFactory::Register("WORK_STEALING_EXECUTOR", new Factory);
+  }
+
+ private:
+  class Factory : public ExecutorFactory {
+    Status NewExecutor(const LocalExecutorParams& params, const Graph& graph,
+                       std::unique_ptr<Executor>* out_executor) override {
+      Executor* ret = nullptr;
+      TF_RETURN_IF_ERROR(NewWorkStealingLocalExecutor(params, graph, &ret));
+      out_executor->reset(ret);
+      return Status::OK();
+    }
+  };
+};
+static WorkStealingExecutorRegistrar work_stealing_registrar;
+
 }  // namespace
 
 }  // namespace tensorflow
@@ -102,6 +102,18 @@ class Executor {
     ScopedStepContainer* step_container = nullptr;
     CollectiveExecutor* collective_executor = nullptr;
     thread::ThreadPoolInterface* user_intra_op_threadpool = nullptr;
+    // If not null, host memory allocated by kernels during this step is
+    // obtained from `step_allocator` instead of the device's allocator. Not
+    // supported by all executor implementations.
+    Allocator* step_allocator = nullptr;
+    // If not null, device memory allocated by kernels during this step is
+    // obtained from `device_step_allocator` instead of the device's
+    // allocator. Not supported by all executor implementations.
+    Allocator* device_step_allocator = nullptr;
+    // If not null, kernels run during this step use `device_context` instead
+    // of the context of the device. Not supported by all executor
+    // implementations.
+    DeviceContext* device_context = nullptr;
     CoordinationServiceAgent* coordination_service_agent = nullptr;
     int64_t start_time_usecs = 0;
     // The deadline for the kernel to complete by. Empty if unspecified.
@@ -145,6 +157,17 @@ class Executor {
 ::tensorflow::Status NewLocalExecutor(const LocalExecutorParams& params,
                                       const Graph& graph, Executor** executor);
 
+// Like `NewLocalExecutor()`, but the returned executor keeps nodes that become
+// ready on per-thread LIFO queues, so that a node is normally run by the thread
+// that finished its producer, and idle inter-op threads steal from those
+// queues. This reduces scheduling overhead for wide graphs of cheap ops.
+//
+// The same executor is available through `ExecutorFactory` under the type
+// "WORK_STEALING_EXECUTOR".
+::tensorflow::Status NewWorkStealingLocalExecutor(
+    const LocalExecutorParams& params, const Graph& graph,
+    Executor** executor);
+
 // A class to help run multiple executors in parallel and wait until
 // all of them are complete.
 //
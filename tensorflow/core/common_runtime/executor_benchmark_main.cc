@@ -0,0 +1,43 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// A main for executor benchmark tests. Like "platform/test_main.cc", it runs
+// the gtest tests in the program unless --benchmark_filter is specified, in
+// which case it runs the benchmarks and records their results through
+// `TestReporter`.
+
+#include "absl/strings/match.h"
+#include "tensorflow/core/common_runtime/executor_benchmark_util.h"
+#include "tensorflow/core/platform/stacktrace_handler.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+GTEST_API_ int main(int argc, char** argv) {
+  tensorflow::testing::InstallStacktraceHandler();
+
+  for (int i = 1; i < argc; i++) {
+    if (absl::StartsWith(argv[i], "--benchmark_filter=")) {
+      ::benchmark::Initialize(&argc, argv);
+      // Must be called after benchmark's init; see "platform/test_main.cc".
+      testing::InitGoogleTest(&argc, argv);
+      tensorflow::test::TestReporterBenchmarkReporter reporter;
+      ::benchmark::RunSpecifiedBenchmarks(&reporter);
+      return 0;
+    }
+  }
+
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
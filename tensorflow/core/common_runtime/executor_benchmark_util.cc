@@ -0,0 +1,153 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/executor_benchmark_util.h"
+
+#include "tensorflow/cc/framework/scope.h"
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/cc/ops/while_loop.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/strcat.h"
+#include "tensorflow/core/util/reporter.h"
+
+namespace tensorflow {
+namespace test {
+
+const char* const kExecutorBenchmarkInput = "input";
+const char* const kExecutorBenchmarkOutput = "output";
+
+namespace {
+
+// Squaring leaves the feed unchanged, so chains of Square have known outputs.
+constexpr float kFeedValue = 1.0;
+
+ExecutorBenchmarkGraph MakeGraph(const Scope& root, int64_t work_units,
+                                 const string& work_unit,
+                                 float expected_output) {
+  ExecutorBenchmarkGraph graph;
+  TF_CHECK_OK(root.ToGraphDef(&graph.graph_def));
+  graph.work_units = work_units;
+  graph.work_unit = work_unit;
+  graph.expected_output = expected_output;
+  return graph;
+}
+
+}  // namespace
+
+ExecutorBenchmarkGraph ChainGraph(int length) {
+  Scope root = Scope::NewRootScope().ExitOnError();
+  Output x = ops::Placeholder(root.WithOpName(kExecutorBenchmarkInput),
+                              DT_FLOAT);
+  for (int i = 0; i < length - 1; ++i) {
+    x = ops::Square(root, x);
+  }
+  ops::Square(root.WithOpName(kExecutorBenchmarkOutput), x);
+  return MakeGraph(root, length + 1, "node", kFeedValue);
+}
+
+ExecutorBenchmarkGraph FanOutGraph(int width) {
+  Scope root = Scope::NewRootScope().ExitOnError();
+  auto input =
+      ops::Placeholder(root.WithOpName(kExecutorBenchmarkInput), DT_FLOAT);
+  std::vector<Output> branches;
+  branches.reserve(width);
+  for (int i = 0; i < width; ++i) {
+    branches.push_back(ops::Square(root, input));
+  }
+  ops::AddN(root.WithOpName(kExecutorBenchmarkOutput), branches);
+  return MakeGraph(root, width + 2, "node", width * kFeedValue);
+}
+
+ExecutorBenchmarkGraph WhileLoopGraph(int iterations) {
+  Scope root = Scope::NewRootScope().ExitOnError();
+  auto input =
+      ops::Placeholder(root.WithOpName(kExecutorBenchmarkInput), DT_FLOAT);
+  const float limit = kFeedValue + iterations;
+  ops::OutputList outputs;
+  TF_CHECK_OK(ops::BuildWhileLoop(
+      root.WithOpName("while"), {input},
+      [limit](const Scope& s, const std::vector<Output>& inputs,
+              Output* output) {
+        *output = ops::Less(s, inputs[0], limit);
+        return s.status();
+      },
+      [](const Scope& s, const std::vector<Output>& inputs,
+         std::vector<Output>* outputs) {
+        outputs->push_back(ops::AddV2(s, inputs[0], 1.0f));
+        return s.status();
+      },
+      "while", &outputs));
+  ops::Identity(root.WithOpName(kExecutorBenchmarkOutput), outputs[0]);
+  return MakeGraph(root, iterations, "iteration", limit);
+}
+
+ExecutorBenchmarkGraph ConstFeedsGraph(int num_consts) {
+  Scope root = Scope::NewRootScope().ExitOnError();
+  auto input =
+      ops::Placeholder(root.WithOpName(kExecutorBenchmarkInput), DT_FLOAT);
+  std::vector<Output> sums;
+  sums.reserve(num_consts);
+  float expected_output = 0.0;
+  for (int i = 0; i < num_consts; ++i) {
+    sums.push_back(
+        ops::AddV2(root, input, ops::Const(root, static_cast<float>(i))));
+    expected_output += kFeedValue + i;
+  }
+  ops::AddN(root.WithOpName(kExecutorBenchmarkOutput), sums);
+  return MakeGraph(root, 2 * num_consts + 2, "node", expected_output);
+}
+
+Tensor ExecutorBenchmarkFeed() { return test::AsScalar<float>(kFeedValue); }
+
+void SetExecutorBenchmarkCounters(const ExecutorBenchmarkGraph& graph,
+                                  ::testing::benchmark::State& state) {
+  state.SetItemsProcessed(state.iterations() * graph.work_units);
+  // The mean time to process one work unit.
+  state.counters[strings::StrCat("ns_per_", graph.work_unit)] =
+      ::benchmark::Counter(
+          1e-9 * graph.work_units,
+          ::benchmark::Counter::kIsIterationInvariantRate |
+              ::benchmark::Counter::kInvert);
+}
+
+void TestReporterBenchmarkReporter::ReportRuns(const std::vector<Run>& runs) {
+  ::benchmark::ConsoleReporter::ReportRuns(runs);
+  for (const Run& run : runs) {
+    if (run.error_occurred || run.run_type != Run::RT_Iteration) continue;
+    TestReporter reporter(run.benchmark_name());
+    Status s = reporter.Initialize();
+    if (s.ok()) {
+      const double items_per_second =
+          run.counters.count("items_per_second")
+              ? static_cast<double>(run.counters.at("items_per_second"))
+              : 0.0;
+      s = reporter.Benchmark(run.iterations, run.cpu_accumulated_time,
+                             run.real_accumulated_time, items_per_second);
+    }
+    for (const auto& counter : run.counters) {
+      if (!s.ok()) break;
+      s = reporter.AddMetric(counter.first, counter.second);
+    }
+    if (s.ok()) s = reporter.Close();
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to record benchmark " << run.benchmark_name()
+                   << ": " << s;
+    }
+  }
+}
+
+}  // namespace test
+}  // namespace tensorflow
@@ -0,0 +1,90 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_EXECUTOR_BENCHMARK_UTIL_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_EXECUTOR_BENCHMARK_UTIL_H_
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace test {
+
+// Synthetic graphs for measuring the per-node overhead of graph executors.
+//
+// Every graph has a scalar float placeholder named `kExecutorBenchmarkInput`
+// and a node named `kExecutorBenchmarkOutput` that produces a scalar float.
+// The kernels are trivial, so the time to run a graph is dominated by the
+// executor rather than by computation, and none of the graphs can be
+// constant-folded or simplified away by graph optimizers. Element-wise nodes
+// use Square rather than Identity, which optimizers remove.
+
+extern const char* const kExecutorBenchmarkInput;
+extern const char* const kExecutorBenchmarkOutput;
+
+struct ExecutorBenchmarkGraph {
+  GraphDef graph_def;
+
+  // The amount of work one run of the graph performs, in units of
+  // `work_unit` (e.g. "node" or "iteration"). Used to normalize results.
+  int64_t work_units = 0;
+  string work_unit;
+
+  // The value of the output when the input is fed `ExecutorBenchmarkFeed()`.
+  float expected_output = 0.0;
+};
+
+// A chain of `length` Square nodes: output = input, since the feed is 1.
+ExecutorBenchmarkGraph ChainGraph(int length);
+
+// The input fanned out to `width` Square nodes, which are summed by a single
+// AddN: output = width * input, since the feed is 1.
+ExecutorBenchmarkGraph FanOutGraph(int width);
+
+// A `Switch`/`Merge` while loop that adds 1 to the input `iterations` times:
+// output = input + iterations.
+ExecutorBenchmarkGraph WhileLoopGraph(int iterations);
+
+// `num_consts` Const nodes, each added to the input, and summed by a single
+// AddN: output = num_consts * input + sum(0, ..., num_consts - 1).
+ExecutorBenchmarkGraph ConstFeedsGraph(int num_consts);
+
+// Returns the tensor to feed as `kExecutorBenchmarkInput`.
+Tensor ExecutorBenchmarkFeed();
+
+// Sets the counters of `state`, which must have finished running, to report
+// the throughput in work units of `graph`.
+void SetExecutorBenchmarkCounters(const ExecutorBenchmarkGraph& graph,
+                                  ::testing::benchmark::State& state);
+
+// A benchmark reporter that prints results like the default console reporter,
+// and also records every benchmark run through `TestReporter`, so that the
+// results are written as `BenchmarkEntries` protos when the environment
+// variable TEST_REPORT_FILE_PREFIX is set. Each user counter of a run is
+// recorded as a metric.
+class TestReporterBenchmarkReporter : public ::benchmark::ConsoleReporter {
+ public:
+  void ReportRuns(const std::vector<Run>& runs) override;
+};
+
+}  // namespace test
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_EXECUTOR_BENCHMARK_UTIL_H_
@@ -0,0 +1,210 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Benchmarks of the per-node overhead of the graph executors used by
+// `DirectSession`, and of `Rendezvous` send/recv in isolation.
+//
+// Run with --benchmark_filter=all; set TEST_REPORT_FILE_PREFIX to record the
+// results as `BenchmarkEntries` protos.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/executor_benchmark_util.h"
+#include "tensorflow/core/framework/rendezvous.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/strcat.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/core/public/session.h"
+#include "tensorflow/core/public/session_options.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr char kDefaultExecutor[] = "";
+constexpr char kSingleThreadedExecutor[] = "SINGLE_THREADED_EXECUTOR";
+
+// A session running `graph` with the given executor. Graph optimizations are
+// disabled, so that the executor runs the graph as built.
+class BenchmarkSession {
+ public:
+  BenchmarkSession(const test::ExecutorBenchmarkGraph& graph,
+                   const string& executor_type) {
+    SessionOptions options;
+    options.config.mutable_experimental()->set_executor_type(executor_type);
+    GraphOptions* graph_options = options.config.mutable_graph_options();
+    graph_options->mutable_optimizer_options()->set_opt_level(
+        OptimizerOptions::L0);
+    graph_options->mutable_rewrite_options()->set_disable_meta_optimizer(true);
+    session_.reset(NewSession(options));
+    TF_CHECK_OK(session_->Create(graph.graph_def));
+
+    CallableOptions callable_options;
+    callable_options.add_feed(test::kExecutorBenchmarkInput);
+    callable_options.add_fetch(test::kExecutorBenchmarkOutput);
+    TF_CHECK_OK(session_->MakeCallable(callable_options, &handle_));
+    feeds_.push_back(test::ExecutorBenchmarkFeed());
+  }
+
+  ~BenchmarkSession() {
+    TF_CHECK_OK(session_->ReleaseCallable(handle_));
+    TF_CHECK_OK(session_->Close());
+  }
+
+  Status Run(std::vector<Tensor>* outputs) {
+    return session_->RunCallable(handle_, feeds_, outputs, nullptr);
+  }
+
+ private:
+  std::unique_ptr<Session> session_;
+  Session::CallableHandle handle_;
+  std::vector<Tensor> feeds_;
+};
+
+void CheckGraph(const test::ExecutorBenchmarkGraph& graph,
+                const string& executor_type) {
+  BenchmarkSession session(graph, executor_type);
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(session.Run(&outputs));
+  ASSERT_EQ(1, outputs.size());
+  test::ExpectTensorEqual<float>(
+      test::AsScalar<float>(graph.expected_output), outputs[0]);
+}
+
+TEST(ExecutorOverheadBenchmarkTest, DefaultExecutor) {
+  CheckGraph(test::ChainGraph(16), kDefaultExecutor);
+  CheckGraph(test::FanOutGraph(16), kDefaultExecutor);
+  CheckGraph(test::WhileLoopGraph(16), kDefaultExecutor);
+  CheckGraph(test::ConstFeedsGraph(16), kDefaultExecutor);
+}
+
+TEST(ExecutorOverheadBenchmarkTest, SingleThreadedExecutor) {
+  CheckGraph(test::ChainGraph(16), kSingleThreadedExecutor);
+  CheckGraph(test::FanOutGraph(16), kSingleThreadedExecutor);
+  CheckGraph(test::ConstFeedsGraph(16), kSingleThreadedExecutor);
+}
+
+void RunSessionBenchmark(const test::ExecutorBenchmarkGraph& graph,
+                         const string& executor_type,
+                         ::testing::benchmark::State& state) {
+  BenchmarkSession session(graph, executor_type);
+  std::vector<Tensor> outputs;
+  // Warm up, so that one-time initialization is not measured.
+  TF_CHECK_OK(session.Run(&outputs));
+  for (auto s : state) {
+    outputs.clear();
+    TF_CHECK_OK(session.Run(&outputs));
+  }
+  test::SetExecutorBenchmarkCounters(graph, state);
+}
+
+// Benchmarks running the graph built by `BUILDER(state.range(0))` under
+// `DirectSession` with the executor named `EXECUTOR`.
+#define BM_SESSION(NAME, BUILDER, EXECUTOR)                               \
+  void BM_DirectSession_##NAME(::testing::benchmark::State& state) {      \
+    RunSessionBenchmark(test::BUILDER(state.range(0)), EXECUTOR, state); \
+  }                                                                       \
+  BENCHMARK(BM_DirectSession_##NAME)
+
+BM_SESSION(Chain, ChainGraph, kDefaultExecutor)->Arg(1)->Arg(64)->Arg(1024);
+BM_SESSION(FanOut, FanOutGraph, kDefaultExecutor)->Arg(64)->Arg(1024);
+BM_SESSION(WhileLoop, WhileLoopGraph, kDefaultExecutor)->Arg(64)->Arg(1024);
+BM_SESSION(ConstFeeds, ConstFeedsGraph, kDefaultExecutor)->Arg(64)->Arg(1024);
+
+// The single-threaded executor does not support `Switch`/`Merge` control
+// flow, so there is no while loop benchmark for it.
+BM_SESSION(SingleThreaded_Chain, ChainGraph, kSingleThreadedExecutor)
+    ->Arg(1)
+    ->Arg(64)
+    ->Arg(1024);
+BM_SESSION(SingleThreaded_FanOut, FanOutGraph, kSingleThreadedExecutor)
+    ->Arg(64)
+    ->Arg(1024);
+BM_SESSION(SingleThreaded_ConstFeeds, ConstFeedsGraph, kSingleThreadedExecutor)
+    ->Arg(64)
+    ->Arg(1024);
+
+#undef BM_SESSION
+
+std::vector<Rendezvous::ParsedKey> RendezvousKeys(int num_keys) {
+  std::vector<Rendezvous::ParsedKey> keys(num_keys);
+  for (int i = 0; i < num_keys; ++i) {
+    TF_CHECK_OK(Rendezvous::ParseKey(
+        Rendezvous::CreateKey("/job:a/replica:0/task:0/cpu:0", 1,
+                              "/job:a/replica:0/task:0/cpu:0",
+                              strings::StrCat("tensor", i), FrameAndIter(0, 0)),
+        &keys[i]));
+  }
+  return keys;
+}
+
+// Sends `state.range(0)` tensors through a local rendezvous, and then
+// receives them.
+void BM_LocalRendezvousSendRecv(::testing::benchmark::State& state) {
+  const int num_keys = state.range(0);
+  const std::vector<Rendezvous::ParsedKey> keys = RendezvousKeys(num_keys);
+  Rendezvous* rendez = NewLocalRendezvous();
+  const Tensor val = test::ExecutorBenchmarkFeed();
+  Tensor received;
+  bool is_dead = false;
+  for (auto s : state) {
+    for (const auto& key : keys) {
+      TF_CHECK_OK(rendez->Send(key, Rendezvous::Args(), val, false));
+    }
+    for (const auto& key : keys) {
+      TF_CHECK_OK(rendez->Recv(key, Rendezvous::Args(), &received, &is_dead));
+    }
+  }
+  rendez->Unref();
+  state.SetItemsProcessed(state.iterations() * num_keys);
+}
+BENCHMARK(BM_LocalRendezvousSendRecv)->Arg(1)->Arg(64);
+
+// Registers `state.range(0)` receivers with a local rendezvous, and then sends
+// the tensors they wait for.
+void BM_LocalRendezvousRecvBeforeSend(::testing::benchmark::State& state) {
+  const int num_keys = state.range(0);
+  const std::vector<Rendezvous::ParsedKey> keys = RendezvousKeys(num_keys);
+  Rendezvous* rendez = NewLocalRendezvous();
+  const Tensor val = test::ExecutorBenchmarkFeed();
+  int64_t num_received = 0;
+  for (auto s : state) {
+    for (const auto& key : keys) {
+      rendez->RecvAsync(key, Rendezvous::Args(),
+                        [&num_received](const Status& s,
+                                        const Rendezvous::Args& send_args,
+                                        const Rendezvous::Args& recv_args,
+                                        const Tensor& val, bool is_dead) {
+                          TF_CHECK_OK(s);
+                          ++num_received;
+                        });
+    }
+    for (const auto& key : keys) {
+      TF_CHECK_OK(rendez->Send(key, Rendezvous::Args(), val, false));
+    }
+  }
+  CHECK_EQ(num_received, state.iterations() * num_keys);
+  rendez->Unref();
+  state.SetItemsProcessed(state.iterations() * num_keys);
+}
+BENCHMARK(BM_LocalRendezvousRecvBeforeSend)->Arg(1)->Arg(64);
+
+}  // namespace
+}  // namespace tensorflow
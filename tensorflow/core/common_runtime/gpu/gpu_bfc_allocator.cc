@@ -15,9 +15,12 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/gpu/gpu_bfc_allocator.h"
 
+#include <algorithm>
 #include <utility>
 
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/stream_executor.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
@@ -75,6 +78,17 @@ bool GetGarbageCollectionValue() {
       << " Using the default value \"true\".";
   return true;
 }
+
+int64_t GetMemorySummaryPeriod() {
+  int64_t period = 0;
+  Status status =
+      ReadInt64FromEnvVar("TF_GPU_BFC_MEMORY_SUMMARY_PERIOD", 0, &period);
+  if (!status.ok()) {
+    LOG(ERROR) << status.error_message();
+    return 0;
+  }
+  return period;
+}
 }  // anonymous namespace
 
 GPUBFCAllocator::GPUBFCAllocator(std::unique_ptr<SubAllocator> sub_allocator,
@@ -90,7 +104,26 @@ GPUBFCAllocator::GPUBFCAllocator(std::unique_ptr<SubAllocator> sub_allocator,
           o.garbage_collection = GetGarbageCollectionValue();
         }
         o.fragmentation_fraction = opts.fragmentation_fraction;
+        o.memory_summary_period = GetMemorySummaryPeriod();
         return o;
       }()) {}
 
+void GPUBFCAllocator::SetStream(int stream_id, se::Stream* stream) {
+  CHECK_GE(stream_id, 0);
+  mutex_lock l(streams_mu_);
+  if (streams_.size() <= stream_id) streams_.resize(stream_id + 1);
+  streams_[stream_id] = stream;
+}
+
+bool GPUBFCAllocator::WaitForStream(int stream_id, int other_stream_id) {
+  mutex_lock l(streams_mu_);
+  if (std::max(stream_id, other_stream_id) >= streams_.size() ||
+      streams_[stream_id] == nullptr || streams_[other_stream_id] == nullptr) {
+    return false;
+  }
+  // Waiting for everything enqueued on the other stream so far covers the
+  // last use of any chunk freed on it.
+  return streams_[stream_id]->ThenWaitFor(streams_[other_stream_id]).ok();
+}
+
 }  // namespace tensorflow
@@ -24,10 +24,15 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/bfc_allocator.h"
 #include "tensorflow/core/common_runtime/device/device_mem_allocator.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_virtual_mem_allocator.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 
+namespace stream_executor {
+class Stream;
+}  // namespace stream_executor
+
 namespace tensorflow {
 
 // A GPU memory allocator that implements a 'best-fit with coalescing'
@@ -57,6 +62,19 @@ class GPUBFCAllocator : public BFCAllocator {
 
   ~GPUBFCAllocator() override {}
 
+  // Registers `stream` (not owned) as the stream with id `stream_id` for
+  // allocations with a non-negative AllocationAttributes::stream_id. Memory
+  // freed on a registered stream is reused on another registered stream after
+  // making the latter wait for the former.
+  void SetStream(int stream_id, se::Stream* stream);
+
+ protected:
+  bool WaitForStream(int stream_id, int other_stream_id) override;
+
+ private:
+  mutex streams_mu_;
+  std::vector<se::Stream*> streams_ TF_GUARDED_BY(streams_mu_);
+
   TF_DISALLOW_COPY_AND_ASSIGN(GPUBFCAllocator);
 };
 
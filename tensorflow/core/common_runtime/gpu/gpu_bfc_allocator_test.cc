@@ -27,8 +27,10 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/gpu/gpu_init.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_virtual_mem_allocator.h"
 #include "tensorflow/core/framework/typed_allocator.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
+#include "tensorflow/core/lib/monitoring/collection_registry.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/strcat.h"
@@ -254,6 +256,104 @@ TEST_P(GPUBFCAllocatorTest, TestCustomMemoryLimit) {
   a.DeallocateRaw(first_ptr);
 }
 
+TEST_P(GPUBFCAllocatorTest, StreamOrderedReuse) {
+  PlatformDeviceId gpu_id(0);
+  se::StreamExecutor* executor =
+      DeviceIdUtil::ExecutorForPlatformDeviceId(GPUMachineManager(), gpu_id)
+          .ValueOrDie();
+  se::Stream stream0(executor);
+  se::Stream stream1(executor);
+  stream0.Init();
+  stream1.Init();
+
+  GPUBFCAllocator::Options options;
+  options.garbage_collection = false;
+  GPUBFCAllocator a(GetParam()(1ull << 32), 1 << 20, "GPU_0_bfc", options);
+  AllocationAttributes on_stream0;
+  on_stream0.stream_id = 0;
+  AllocationAttributes on_stream1;
+  on_stream1.stream_id = 1;
+  on_stream1.retry_on_failure = false;
+
+  // Memory freed on a stream is reused on the same stream right away.
+  void* p0 = a.AllocateRaw(1, 1 << 19, on_stream0);
+  ASSERT_NE(nullptr, p0);
+  a.DeallocateRaw(p0);
+  EXPECT_EQ(p0, a.AllocateRaw(1, 1 << 19, on_stream0));
+  a.DeallocateRaw(p0);
+
+  // It can't be used on another stream that can't be made to wait.
+  EXPECT_EQ(nullptr, a.AllocateRaw(1, 1 << 19, on_stream1));
+
+  // Once the streams are known, the other stream waits for the memory.
+  a.SetStream(0, &stream0);
+  a.SetStream(1, &stream1);
+  void* p1 = a.AllocateRaw(1, 1 << 19, on_stream1);
+  EXPECT_EQ(p0, p1);
+  a.DeallocateRaw(p1);
+  TF_EXPECT_OK(stream1.BlockHostUntilDone());
+  CheckStats(&a, 3, 0, 1 << 19, 1 << 19);
+}
+
+TEST_P(GPUBFCAllocatorTest, ReleaseFreeRegions) {
+  GPUBFCAllocator::Options options;
+  options.allow_growth = true;
+  GPUBFCAllocator a(GetParam()(1ull << 32), 1 << 30, "GPU_0_bfc", options);
+  void* p1 = a.AllocateRaw(1, 1 << 20);
+  void* p2 = a.AllocateRaw(1, 64 << 20);
+  ASSERT_NE(nullptr, p1);
+  ASSERT_NE(nullptr, p2);
+
+  // Regions with allocations are never released.
+  EXPECT_EQ(0, a.ReleaseFreeRegions());
+  a.DeallocateRaw(p1);
+  a.DeallocateRaw(p2);
+
+  // Nothing is released below the reserved fraction of the memory limit.
+  EXPECT_EQ(0, a.ReleaseFreeRegions(0.5));
+  EXPECT_GE(a.ReleaseFreeRegions(), 65 << 20);
+  EXPECT_EQ(0, a.ReleaseFreeRegions());
+
+  // The allocator grows again as needed.
+  void* p3 = a.AllocateRaw(1, 64 << 20);
+  EXPECT_NE(nullptr, p3);
+  a.DeallocateRaw(p3);
+}
+
+// Returns the value of `metric` for the allocator named `name`, or -1.
+int64_t GetAllocatorGauge(const string& metric, const string& name) {
+  auto collected = monitoring::CollectionRegistry::Default()->CollectMetrics(
+      monitoring::CollectionRegistry::CollectMetricsOptions());
+  auto it = collected->point_set_map.find(metric);
+  if (it == collected->point_set_map.end()) return -1;
+  for (const auto& point : it->second->points) {
+    if (point->labels.size() == 1 && point->labels[0].value == name) {
+      return point->int64_value;
+    }
+  }
+  return -1;
+}
+
+TEST_P(GPUBFCAllocatorTest, MemorySummary) {
+  setenv("TF_GPU_BFC_MEMORY_SUMMARY_PERIOD", "2", 1);
+  GPUBFCAllocator a(GetParam()(1ull << 32), 1 << 30,
+                    "GPU_0_bfc_memory_summary", {});
+  unsetenv("TF_GPU_BFC_MEMORY_SUMMARY_PERIOD");
+  const string kBytesInUse = "/tensorflow/core/bfc_allocator/bytes_in_use";
+  void* p1 = a.AllocateRaw(1, 1 << 20);
+  EXPECT_EQ(-1, GetAllocatorGauge(kBytesInUse, a.Name()));
+  void* p2 = a.AllocateRaw(1, 1 << 20);
+  EXPECT_EQ(2 << 20, GetAllocatorGauge(kBytesInUse, a.Name()));
+  EXPECT_GT(GetAllocatorGauge(
+                "/tensorflow/core/bfc_allocator/largest_free_chunk_bytes",
+                a.Name()),
+            0);
+  EXPECT_EQ(1, GetAllocatorGauge("/tensorflow/core/bfc_allocator/num_regions",
+                                 a.Name()));
+  a.DeallocateRaw(p1);
+  a.DeallocateRaw(p2);
+}
+
 TEST_P(GPUBFCAllocatorTest, AllocationsAndDeallocationsWithGrowth) {
   GPUOptions options;
   options.set_allow_growth(true);
@@ -36,6 +36,7 @@ limitations under the License.
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_split.h"
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/common_runtime/bfc_allocator.h"
 #include "tensorflow/core/common_runtime/device/device_event_mgr.h"
 #include "tensorflow/core/common_runtime/device/device_id_utils.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
@@ -74,6 +75,7 @@ limitations under the License.
 #include "tensorflow/core/profiler/lib/scoped_annotation.h"
 #include "tensorflow/core/profiler/lib/scoped_memory_debug_annotation.h"
 #include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/util/autotune_maps/autotune_serialize.h"
 #include "tensorflow/core/util/device_name_utils.h"
 #include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/stream_executor_util.h"
@@ -540,6 +542,23 @@ Status BaseGPUDevice::Init(const SessionOptions& options) {
     }
   }
 
+  // If set, the GPU allocator returns the memory of regions that are entirely
+  // free to the device whenever the device is synchronized after a step while
+  // it has reserved at least this fraction of its memory limit. This undoes
+  // the fragmentation of long-running processes that use allow_growth.
+  TF_RETURN_IF_ERROR(ReadFloatFromEnvVar(
+      "TF_GPU_RELEASE_FREE_REGIONS_FRACTION", 0,
+      &release_free_regions_fraction_));
+  if (release_free_regions_fraction_ > 0) {
+    release_free_regions_allocator_ =
+        dynamic_cast<BFCAllocator*>(gpu_allocator_);
+    if (release_free_regions_allocator_ == nullptr) {
+      LOG(WARNING) << "Ignoring TF_GPU_RELEASE_FREE_REGIONS_FRACTION, as the "
+                   << "GPU allocator " << gpu_allocator_->Name()
+                   << " is not a BFC allocator.";
+    }
+  }
+
   TF_ASSIGN_OR_RETURN(
       node_file_writer_,
       NodeFileWriter::GetNodeFileWriterIfEnabled(name(), env()));
@@ -731,7 +750,12 @@ Status BaseGPUDevice::Sync() {
   // enqueued the operation has completed.  We do use other streams for copies
   // and collectives, but in those cases the (Async)OpKernels themselves block
   // until the queued operation has finished.
-  return stream_->compute->BlockHostUntilDone();
+  TF_RETURN_IF_ERROR(stream_->compute->BlockHostUntilDone());
+  if (release_free_regions_allocator_ != nullptr) {
+    release_free_regions_allocator_->ReleaseFreeRegions(
+        release_free_regions_fraction_);
+  }
+  return Status::OK();
 }
 
 void BaseGPUDevice::ComputeAsync(AsyncOpKernel* op_kernel,
@@ -1114,14 +1138,14 @@ Status SingleVirtualDeviceMemoryLimit(const GPUOptions& gpu_options,
 }  // namespace
 
 void BaseGPUDevice::ReinitializeDevice(OpKernelContext* context,
-                                       PerOpGpuDevice* device, int stream_id,
+                                       PerOpGpuDevice* device,
+                                       se::Stream* stream,
                                        Allocator* allocator) {
   ConcretePerOpGpuDevice* concrete_device =
       static_cast<ConcretePerOpGpuDevice*>(device);
   DCHECK(concrete_device);
-  DCHECK_EQ(stream_id, 0);
   const gpuStream_t* gpu_stream = reinterpret_cast<const gpuStream_t*>(
-      stream_->compute->implementation()->GpuStreamMemberHack());
+      stream->implementation()->GpuStreamMemberHack());
   concrete_device->Reinitialize(context, gpu_stream, tf_device_id_, allocator,
                                 scratch_);
 }
@@ -1141,9 +1165,11 @@ Status BaseGPUDevice::ReinitializeGpuDevice(OpKernelContext* context,
     VLOG(1) << "  eigen_gpu_device(" << dc << ") => stream[" << stream_id
             << "]";
     CHECK_EQ(stream_id, 0);
-    ReinitializeDevice(context, device, stream_id, allocator);
+    // The stream of `dc` is the compute stream, unless the kernel runs in a
+    // step that has a context of its own.
+    ReinitializeDevice(context, device, gpu_dc->stream(), allocator);
   } else {
-    ReinitializeDevice(context, device, 0, allocator);
+    ReinitializeDevice(context, device, stream_->compute, allocator);
   }
   return Status::OK();
 }
@@ -1223,6 +1249,30 @@ Status BaseGPUDeviceFactory::GetDeviceDetails(
   return Status::OK();
 }
 
+// Loads the autotune results persisted in TF_AUTOTUNE_MAPS_FILE, if set, and
+// starts writing new results back to it every
+// TF_AUTOTUNE_MAPS_WRITE_BACK_SECS seconds, if that is positive. Failing to
+// load is not an error: the file may not have been written yet, or may come
+// from a different GPU model or DNN library version.
+static Status MaybeLoadAutotuneMaps() {
+  string path;
+  TF_RETURN_IF_ERROR(ReadStringFromEnvVar("TF_AUTOTUNE_MAPS_FILE", "", &path));
+  if (path.empty()) return Status::OK();
+  Status s = LoadAutotuneMapsFromFile(path);
+  if (s.ok()) {
+    VLOG(1) << "Loaded autotune maps from " << path;
+  } else {
+    LOG(WARNING) << "Not using autotune maps from " << path << ": " << s;
+  }
+  int64_t write_back_secs;
+  TF_RETURN_IF_ERROR(ReadInt64FromEnvVar("TF_AUTOTUNE_MAPS_WRITE_BACK_SECS",
+                                         0, &write_back_secs));
+  if (write_back_secs > 0) {
+    StartAutotuneMapsWriteBack(path, write_back_secs);
+  }
+  return Status::OK();
+}
+
 Status BaseGPUDeviceFactory::CreateDevices(
     const SessionOptions& options, const string& name_prefix,
     std::vector<std::unique_ptr<Device>>* devices) {
@@ -1453,6 +1503,11 @@ Status BaseGPUDeviceFactory::CreateDevices(
                                        bytes, it->second, num_tf_gpus,
                                        devices));
   }
+  // Autotune results are keyed by device model, so they can only be matched
+  // once the devices have been initialized.
+  static const Status* autotune_maps_status =
+      new Status(MaybeLoadAutotuneMaps());
+  TF_RETURN_IF_ERROR(*autotune_maps_status);
   return Status::OK();
 }
 
@@ -48,6 +48,7 @@ limitations under the License.
 #include "tensorflow/core/public/session_options.h"
 
 namespace tensorflow {
+class BFCAllocator;
 class GPUKernelTracker;
 
 class BaseGPUDevice : public LocalDevice {
@@ -162,11 +163,16 @@ class BaseGPUDevice : public LocalDevice {
   bool timestamped_allocator_ = false;
   NodeFileWriter* node_file_writer_ = nullptr;  // not owned
 
+  // If not null, the free regions of this allocator are released in Sync()
+  // once it has reserved release_free_regions_fraction_ of its memory limit.
+  BFCAllocator* release_free_regions_allocator_ = nullptr;  // not owned
+  float release_free_regions_fraction_ = 0;
+
   // Initialize scratch buffers used by Eigen.
   Status InitScratchBuffers();
 
   void ReinitializeDevice(OpKernelContext* context, PerOpGpuDevice* device,
-                          int stream_id, Allocator* allocator);
+                          se::Stream* stream, Allocator* allocator);
 
   std::string ComputeOpKernelDebugString(const OpKernel& op_kernel,
                                          const int& stream_id);
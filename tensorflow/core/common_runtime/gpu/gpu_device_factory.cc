@@ -20,9 +20,11 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/gpu/gpu_device.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_id.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_managed_allocator.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_process_state.h"
 #include "tensorflow/core/common_runtime/threadpool_device.h"
 #include "tensorflow/core/platform/numa.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
@@ -39,6 +41,15 @@ class GPUDevice : public BaseGPUDevice {
       force_gpu_compatible_ =
           options.config.gpu_options().force_gpu_compatible();
     }
+    bool read_mostly;
+    Status s = ReadBoolFromEnvVar("TF_GPU_MANAGED_MEMORY_READ_MOSTLY",
+                                  /*default_val=*/false, &read_mostly);
+    if (!s.ok()) {
+      LOG(ERROR) << s;
+      read_mostly = false;
+    }
+    managed_allocator_ =
+        absl::make_unique<GpuManagedAllocator>(gpu_id(), read_mostly);
   }
 
   Allocator* GetAllocator(AllocatorAttributes attr) override {
@@ -50,6 +61,8 @@ class GPUDevice : public BaseGPUDevice {
       } else {
         return cpu_allocator_;
       }
+    } else if (attr.managed_memory()) {
+      return managed_allocator_.get();
     } else {
       return gpu_allocator_;
     }
@@ -57,6 +70,9 @@ class GPUDevice : public BaseGPUDevice {
 
  private:
   bool force_gpu_compatible_ = false;
+  // Serves allocations that request managed memory. They bypass the BFC
+  // allocator and its memory limit, since they may exceed device memory.
+  std::unique_ptr<GpuManagedAllocator> managed_allocator_;
 };
 
 class GPUDeviceFactory : public BaseGPUDeviceFactory {
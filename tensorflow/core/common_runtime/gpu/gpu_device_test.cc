@@ -21,6 +21,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/gpu/gpu_cudamallocasync_allocator.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_init.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_process_state.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_util.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
@@ -517,6 +518,53 @@ TEST_F(GPUDeviceTest, CopyTensorInSameDevice) {
   }
 }
 
+TEST_F(GPUDeviceTest, CopyGPUTensorsToCPU) {
+  SessionOptions opts = MakeSessionOptions("0");
+  std::vector<std::unique_ptr<Device>> devices;
+  TF_ASSERT_OK(DeviceFactory::GetFactory("GPU")->CreateDevices(
+      opts, kDeviceNamePrefix, &devices));
+  Device* device = devices[0].get();
+  auto* device_info = device->tensorflow_gpu_device_info();
+  CHECK(device_info);
+  DeviceContext* device_context = device_info->default_context;
+  Allocator* allocator = device->GetAllocator(AllocatorAttributes());
+
+  // Small tensors are staged through one buffer, the last one is copied
+  // directly, and the empty one is skipped.
+  const std::vector<int> num_elements = {1, 17, 0, 256, (64 << 10) / 4 + 1};
+  std::vector<Tensor> gpu_tensors;
+  std::vector<Tensor> cpu_tensors;
+  for (int i = 0; i < num_elements.size(); ++i) {
+    const TensorShape shape({num_elements[i]});
+    Tensor cpu_tensor(cpu_allocator(), DT_FLOAT, shape);
+    InitCPUTensor(&cpu_tensor, num_elements[i], i + 1);
+    gpu_tensors.emplace_back(allocator, DT_FLOAT, shape);
+    CopyCPUToGPU(&cpu_tensor, &gpu_tensors.back(), device, device_context);
+    cpu_tensors.emplace_back(cpu_allocator(), DT_FLOAT, shape);
+    InitCPUTensor(&cpu_tensors.back(), num_elements[i], 0);
+  }
+  std::vector<const Tensor*> srcs;
+  std::vector<Tensor*> dsts;
+  for (int i = 0; i < num_elements.size(); ++i) {
+    srcs.push_back(&gpu_tensors[i]);
+    dsts.push_back(&cpu_tensors[i]);
+  }
+  Notification note;
+  GPUUtil::CopyGPUTensorsToCPU(device, device_context, srcs, dsts,
+                               [&note](const Status& s) {
+                                 TF_ASSERT_OK(s);
+                                 note.Notify();
+                               });
+  note.WaitForNotification();
+
+  for (int i = 0; i < num_elements.size(); ++i) {
+    auto output = cpu_tensors[i].tensor<float, 1>();
+    for (int j = 0; j < num_elements[i]; ++j) {
+      ASSERT_EQ(i + 1, output(j)) << " for tensor " << i << " index " << j;
+    }
+  }
+}
+
 TEST_F(GPUDeviceTest, DeviceDetails) {
   DeviceFactory* factory = DeviceFactory::GetFactory("GPU");
   std::vector<string> devices;
@@ -34,6 +34,23 @@ void* GpuManagedAllocator::AllocateRaw(size_t alignment, size_t num_bytes) {
   CHECK_EQ(cuMemAllocManaged(&result, num_bytes, CU_MEM_ATTACH_GLOBAL),
            CUDA_SUCCESS);
   ptr = reinterpret_cast<void*>(result);
+  // The hints only affect performance, so failures (e.g. on devices without
+  // concurrent managed access) are logged and otherwise ignored.
+  if (device_ordinal_ >= 0) {
+    CUresult res = cuMemAdvise(result, num_bytes,
+                               CU_MEM_ADVISE_SET_PREFERRED_LOCATION,
+                               static_cast<CUdevice>(device_ordinal_));
+    if (res != CUDA_SUCCESS) {
+      VLOG(1) << "cuMemAdvise(SET_PREFERRED_LOCATION) failed: " << res;
+    }
+  }
+  if (read_mostly_) {
+    CUresult res = cuMemAdvise(result, num_bytes, CU_MEM_ADVISE_SET_READ_MOSTLY,
+                               static_cast<CUdevice>(device_ordinal_));
+    if (res != CUDA_SUCCESS) {
+      VLOG(1) << "cuMemAdvise(SET_READ_MOSTLY) failed: " << res;
+    }
+  }
 #elif TENSORFLOW_USE_ROCM
   void** result = 0;
   CHECK_EQ(hipHostMalloc(&result, num_bytes, 0), 0);
@@ -23,12 +23,25 @@ namespace tensorflow {
 // An allocator for CUDA unified memory. Memory allocated with this allocator
 // can be accessed from both host and device. CUDA transparently migrates dirty
 // pages, which can be slow. Therefore, this allocator is intended for
-// convenience in functional tests only.
+// convenience in functional tests, and for tensors that are too large for
+// device memory and only sparsely accessed, such as embedding tables.
 class GpuManagedAllocator : public Allocator {
  public:
+  GpuManagedAllocator() = default;
+
+  // Advises the driver that allocations should preferably reside on device
+  // `device_ordinal`, and if `read_mostly` is true, that they are mostly
+  // read so that pages may be duplicated rather than migrated on access.
+  GpuManagedAllocator(int device_ordinal, bool read_mostly)
+      : device_ordinal_(device_ordinal), read_mostly_(read_mostly) {}
+
   string Name() override { return "GpuManagedAllocator"; }
   void* AllocateRaw(size_t alignment, size_t num_bytes) override;
   void DeallocateRaw(void* ptr) override;
+
+ private:
+  const int device_ordinal_ = -1;
+  const bool read_mostly_ = false;
 };
 
 }  // namespace tensorflow
@@ -0,0 +1,161 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if GOOGLE_CUDA
+
+#include <memory>
+
+#include "absl/cleanup/cleanup.h"
+#include "absl/memory/memory.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device/device_event_mgr.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/common_runtime/gpu_device_context.h"
+#include "tensorflow/core/common_runtime/step_graph.h"
+#include "tensorflow/core/framework/device_base.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/stream_executor.h"
+#include "tensorflow/stream_executor/gpu/gpu_driver.h"
+#include "tensorflow/stream_executor/gpu/gpu_executor.h"
+#include "tensorflow/stream_executor/gpu/gpu_stream.h"
+
+namespace tensorflow {
+namespace {
+
+// Captures the work enqueued onto a stream of its own into a CUDA graph, which
+// it launches onto the compute stream of a GPU.
+class GpuStepGraph : public StepGraph {
+ public:
+  // `capture_stream` must be initialized.
+  GpuStepGraph(se::Stream* stream, std::unique_ptr<se::Stream> capture_stream,
+               const GPUDeviceContext& default_context, EventMgr* event_mgr,
+               Allocator* base)
+      : stream_(stream),
+        capture_stream_(std::move(capture_stream)),
+        gpu_stream_(se::gpu::AsGpuStream(stream)),
+        gpu_capture_stream_(se::gpu::AsGpuStream(capture_stream_.get())),
+        context_(gpu_stream_->parent()->gpu_context()),
+        event_mgr_(event_mgr),
+        allocator_(new RetainingAllocator(base)),
+        device_context_(new GPUDeviceContext(
+            /*stream_id=*/0, capture_stream_.get(),
+            default_context.host_to_device_stream(),
+            default_context.device_to_host_stream(),
+            {default_context.device_to_device_stream(0)},
+            default_context.host_memory_allocator())) {}
+
+  ~GpuStepGraph() override {
+    if (exec_ != nullptr) {
+      // A graph still running is destroyed once it completes.
+      se::gpu::GpuDriver::DestroyGraphExec(context_, exec_);
+    }
+    allocator_->Release();
+  }
+
+  Allocator* allocator() override { return allocator_.get(); }
+
+  DeviceContext* device_context() override { return device_context_.get(); }
+
+  Status BeginCapture() override {
+    if (!event_mgr_->BeginCapture(capture_stream_.get())) {
+      return errors::Unavailable("The step is already being captured");
+    }
+    Status s = se::gpu::GpuDriver::StreamBeginCapture(
+        context_, gpu_capture_stream_->gpu_stream());
+    if (!s.ok()) {
+      event_mgr_->EndCapture(capture_stream_.get());
+    }
+    return s;
+  }
+
+  Status EndCapture() override {
+    se::gpu::GpuGraphHandle graph = nullptr;
+    Status s = se::gpu::GpuDriver::StreamEndCapture(
+        context_, gpu_capture_stream_->gpu_stream(), &graph);
+    const bool replayable = event_mgr_->EndCapture(capture_stream_.get());
+    auto destroy_graph = absl::MakeCleanup([&] {
+      if (graph != nullptr) {
+        se::gpu::GpuDriver::DestroyGraph(context_, graph);
+      }
+    });
+    TF_RETURN_IF_ERROR(s);
+    if (!replayable) {
+      return errors::Unimplemented(
+          "A kernel waited for the completion of the work it enqueued");
+    }
+    return se::gpu::GpuDriver::GraphInstantiate(context_, graph, &exec_);
+  }
+
+  Status Launch() override {
+    if (exec_ == nullptr) {
+      return errors::FailedPrecondition("The step has not been captured");
+    }
+    return se::gpu::GpuDriver::GraphLaunch(context_, exec_,
+                                           gpu_stream_->gpu_stream());
+  }
+
+  Status CopyTensor(const Tensor& src, Tensor* dst) override {
+    DCHECK_EQ(src.TotalBytes(), dst->TotalBytes());
+    const uint64 num_bytes = src.TotalBytes();
+    if (num_bytes == 0) return Status::OK();
+    se::DeviceMemoryBase src_memory(const_cast<void*>(DMAHelper::base(&src)),
+                                    num_bytes);
+    se::DeviceMemoryBase dst_memory(DMAHelper::base(dst), num_bytes);
+    if (!stream_->ThenMemcpy(&dst_memory, src_memory, num_bytes).ok()) {
+      return errors::Internal("Failed to copy a tensor of the captured step");
+    }
+    return Status::OK();
+  }
+
+ private:
+  se::Stream* const stream_;  // Not owned.
+  const std::unique_ptr<se::Stream> capture_stream_;
+  se::gpu::GpuStream* const gpu_stream_;          // Not owned.
+  se::gpu::GpuStream* const gpu_capture_stream_;  // Not owned.
+  se::gpu::GpuContext* const context_;            // Not owned.
+  EventMgr* const event_mgr_;                     // Not owned.
+  core::RefCountPtr<RetainingAllocator> allocator_;
+  core::RefCountPtr<GPUDeviceContext> device_context_;
+  se::gpu::GpuGraphExecHandle exec_ = nullptr;
+};
+
+std::unique_ptr<StepGraph> NewGpuStepGraph(Device* device) {
+  const DeviceBase::AcceleratorDeviceInfo* info =
+      device->tensorflow_gpu_device_info();
+  if (info == nullptr || info->stream == nullptr ||
+      info->default_context == nullptr || info->event_mgr == nullptr) {
+    return nullptr;
+  }
+  auto capture_stream = absl::make_unique<se::Stream>(info->stream->parent());
+  capture_stream->Init();
+  if (!capture_stream->ok()) {
+    LOG(WARNING) << "Failed to create a stream to capture a step on "
+                 << device->name();
+    return nullptr;
+  }
+  return absl::make_unique<GpuStepGraph>(
+      info->stream, std::move(capture_stream),
+      *static_cast<const GPUDeviceContext*>(info->default_context),
+      info->event_mgr, device->GetAllocator(AllocatorAttributes()));
+}
+
+static StepGraph::Registration register_gpu_step_graph(DEVICE_GPU,
+                                                       NewGpuStepGraph);
+
+}  // namespace
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA
@@ -0,0 +1,78 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/gpu/gpu_stream_util.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace tensorflow {
+namespace gpu_stream_util {
+
+Status AssignStreams(const Graph* graph, const AssignStreamsOpts& opts,
+                     std::unordered_map<int, int>* node_to_stream_id) {
+  if (opts.max_streams < 1) {
+    return errors::InvalidArgument("max_streams must be positive, got ",
+                                   opts.max_streams);
+  }
+  node_to_stream_id->clear();
+
+  // The id of the node last assigned to each stream, and the number of nodes
+  // assigned to each stream.
+  std::vector<int> stream_tail(opts.max_streams, -1);
+  std::vector<int64_t> stream_size(opts.max_streams, 0);
+
+  std::vector<Node*> order;
+  GetReversePostOrder(*graph, &order);
+  for (const Node* node : order) {
+    if (!node->IsOp()) continue;
+    int stream_id = -1;
+    for (const Edge* edge : node->in_edges()) {
+      auto it = node_to_stream_id->find(edge->src()->id());
+      if (it != node_to_stream_id->end() &&
+          stream_tail[it->second] == edge->src()->id()) {
+        stream_id = it->second;
+        break;
+      }
+    }
+    if (stream_id < 0) {
+      stream_id = std::min_element(stream_size.begin(), stream_size.end()) -
+                  stream_size.begin();
+    }
+    (*node_to_stream_id)[node->id()] = stream_id;
+    stream_tail[stream_id] = node->id();
+    ++stream_size[stream_id];
+  }
+  return Status::OK();
+}
+
+std::vector<const Edge*> CrossStreamEdges(
+    const Graph* graph, const std::unordered_map<int, int>& node_to_stream_id) {
+  std::vector<const Edge*> edges;
+  for (const Edge* edge : graph->edges()) {
+    auto src = node_to_stream_id.find(edge->src()->id());
+    auto dst = node_to_stream_id.find(edge->dst()->id());
+    if (src != node_to_stream_id.end() && dst != node_to_stream_id.end() &&
+        src->second != dst->second) {
+      edges.push_back(edge);
+    }
+  }
+  return edges;
+}
+
+}  // namespace gpu_stream_util
+}  // namespace tensorflow
@@ -0,0 +1,53 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_STREAM_UTIL_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_STREAM_UTIL_H_
+
+#include <unordered_map>
+#include <vector>
+
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace tensorflow {
+namespace gpu_stream_util {
+
+struct AssignStreamsOpts {
+  // The number of compute streams the nodes are spread over.
+  int32 max_streams = 1;
+};
+
+// Assigns each op node of "graph" to a compute stream in
+// [0, opts.max_streams) and stores the assignment, keyed by node id, in
+// "*node_to_stream_id".
+//
+// A node stays on the stream of one of its inputs if that input is the last
+// node assigned to the stream, so chains of dependent nodes run on one stream
+// without synchronization. Nodes that start a new branch go to the stream with
+// the fewest nodes, so that independent branches can run concurrently.
+Status AssignStreams(const Graph* graph, const AssignStreamsOpts& opts,
+                     std::unordered_map<int, int>* node_to_stream_id);
+
+// Returns the edges of "graph" whose endpoints were assigned to different
+// streams by AssignStreams(). The destination of each of these edges must wait
+// on an event recorded on the stream of the source after the source ran.
+std::vector<const Edge*> CrossStreamEdges(
+    const Graph* graph, const std::unordered_map<int, int>& node_to_stream_id);
+
+}  // namespace gpu_stream_util
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_STREAM_UTIL_H_
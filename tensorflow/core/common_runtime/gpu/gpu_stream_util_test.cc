@@ -0,0 +1,122 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/gpu/gpu_stream_util.h"
+
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+Node* AddNoOp(const string& name, const std::vector<Node*>& deps, Graph* g) {
+  Node* node;
+  TF_CHECK_OK(NodeBuilder(name, "NoOp").Finalize(g, &node));
+  for (Node* dep : deps) g->AddControlEdge(dep, node);
+  return node;
+}
+
+class GpuStreamUtilTest : public ::testing::Test {
+ protected:
+  // Builds a diamond: a -> (b, c) -> d.
+  void SetUp() override {
+    a_ = AddNoOp("a", {}, &graph_);
+    b_ = AddNoOp("b", {a_}, &graph_);
+    c_ = AddNoOp("c", {a_}, &graph_);
+    d_ = AddNoOp("d", {b_, c_}, &graph_);
+    FixupSourceAndSinkEdges(&graph_);
+  }
+
+  Graph graph_{OpRegistry::Global()};
+  Node* a_;
+  Node* b_;
+  Node* c_;
+  Node* d_;
+};
+
+TEST_F(GpuStreamUtilTest, InvalidMaxStreams) {
+  gpu_stream_util::AssignStreamsOpts opts;
+  opts.max_streams = 0;
+  std::unordered_map<int, int> node_to_stream_id;
+  EXPECT_FALSE(
+      gpu_stream_util::AssignStreams(&graph_, opts, &node_to_stream_id).ok());
+}
+
+TEST_F(GpuStreamUtilTest, SingleStream) {
+  gpu_stream_util::AssignStreamsOpts opts;
+  std::unordered_map<int, int> node_to_stream_id;
+  TF_ASSERT_OK(
+      gpu_stream_util::AssignStreams(&graph_, opts, &node_to_stream_id));
+  // The source and sink nodes are not assigned.
+  EXPECT_EQ(4, node_to_stream_id.size());
+  for (const auto& it : node_to_stream_id) {
+    EXPECT_EQ(0, it.second);
+  }
+  EXPECT_TRUE(
+      gpu_stream_util::CrossStreamEdges(&graph_, node_to_stream_id).empty());
+}
+
+TEST_F(GpuStreamUtilTest, IndependentBranches) {
+  gpu_stream_util::AssignStreamsOpts opts;
+  opts.max_streams = 4;
+  std::unordered_map<int, int> node_to_stream_id;
+  TF_ASSERT_OK(
+      gpu_stream_util::AssignStreams(&graph_, opts, &node_to_stream_id));
+  EXPECT_EQ(4, node_to_stream_id.size());
+  const int a = node_to_stream_id[a_->id()];
+  const int b = node_to_stream_id[b_->id()];
+  const int c = node_to_stream_id[c_->id()];
+  const int d = node_to_stream_id[d_->id()];
+
+  // The branches run on different streams, one of them on the stream of a,
+  // and d continues one of them.
+  EXPECT_NE(b, c);
+  EXPECT_TRUE(a == b || a == c);
+  EXPECT_TRUE(d == b || d == c);
+
+  // Only the edges into and out of the other branch need an event.
+  std::vector<const Edge*> edges =
+      gpu_stream_util::CrossStreamEdges(&graph_, node_to_stream_id);
+  ASSERT_EQ(2, edges.size());
+  for (const Edge* edge : edges) {
+    EXPECT_NE(node_to_stream_id[edge->src()->id()],
+              node_to_stream_id[edge->dst()->id()]);
+  }
+}
+
+TEST_F(GpuStreamUtilTest, BalancesIndependentChains) {
+  Graph graph(OpRegistry::Global());
+  for (int i = 0; i < 8; ++i) {
+    Node* first = AddNoOp(strings::StrCat("first", i), {}, &graph);
+    AddNoOp(strings::StrCat("second", i), {first}, &graph);
+  }
+  FixupSourceAndSinkEdges(&graph);
+  gpu_stream_util::AssignStreamsOpts opts;
+  opts.max_streams = 4;
+  std::unordered_map<int, int> node_to_stream_id;
+  TF_ASSERT_OK(
+      gpu_stream_util::AssignStreams(&graph, opts, &node_to_stream_id));
+  std::vector<int> stream_size(opts.max_streams, 0);
+  for (const auto& it : node_to_stream_id) ++stream_size[it.second];
+  for (int size : stream_size) EXPECT_EQ(4, size);
+  EXPECT_TRUE(
+      gpu_stream_util::CrossStreamEdges(&graph, node_to_stream_id).empty());
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -148,7 +148,7 @@ void GPUUtil::SetProtoFromGPU(const Tensor& tensor, Device* dev,
   const int64_t total_bytes = is_dead ? 0 : tensor.TotalBytes();
   if (total_bytes > 0) {
     profiler::ScopedAnnotation annotation("SetProtoFromGPU");
-    alloc = GPUProcessState::singleton()->GetGpuHostAllocator(0);
+    alloc = GPUProcessState::singleton()->GetGpuHostAllocator(dev->NumaNode());
     buf = static_cast<char*>(
         alloc->AllocateRaw(Allocator::kAllocatorAlignment, total_bytes));
     if (LogMemory::IsEnabled()) {
@@ -307,6 +307,137 @@ void GPUUtil::CopyGPUTensorToCPU(Device* gpu_device,
       });
 }
 
+// static
+void GPUUtil::CopyGPUTensorsToCPU(Device* gpu_device,
+                                  const DeviceContext* device_context,
+                                  const std::vector<const Tensor*>& gpu_tensors,
+                                  const std::vector<Tensor*>& cpu_tensors,
+                                  StatusCallback done,
+                                  int64_t max_batched_bytes) {
+  VLOG(1) << "CopyGPUTensorsToCPU " << gpu_tensors.size();
+  if (gpu_tensors.size() != cpu_tensors.size()) {
+    done(errors::Internal("Can't copy ", gpu_tensors.size(),
+                          " tensors into ", cpu_tensors.size(), " tensors."));
+    return;
+  }
+  if (gpu_tensors.empty()) {
+    done(Status::OK());
+    return;
+  }
+  const DeviceBase::AcceleratorDeviceInfo* dev_info = nullptr;
+  se::Stream* send_stream = nullptr;
+  for (int i = 0; i < gpu_tensors.size(); ++i) {
+    Status s = PrepareCopy(gpu_device, device_context, *gpu_tensors[i],
+                           cpu_tensors[i], &dev_info, &send_stream);
+    if (!s.ok()) {
+      done(s);
+      return;
+    }
+  }
+
+  auto send_device_to_host_stream =
+      static_cast<const GPUDeviceContext*>(device_context)
+          ->device_to_host_stream();
+  if (send_device_to_host_stream == nullptr) {
+    done(errors::Internal("No send gpu copy-out-stream is available."));
+    return;
+  }
+  // Wait for the sender's main stream to make sure the data are available.
+  send_device_to_host_stream->ThenWaitFor(send_stream);
+
+  // Lay out the small tensors in the staging buffers. Offsets are aligned so
+  // that each tensor keeps the alignment of its source buffer.
+  std::vector<int> batched;
+  std::vector<int64_t> offsets;
+  int64_t staging_bytes = 0;
+  for (int i = 0; i < gpu_tensors.size(); ++i) {
+    const int64_t total_bytes = gpu_tensors[i]->TotalBytes();
+    if (total_bytes == 0 || total_bytes > max_batched_bytes) continue;
+    batched.push_back(i);
+    offsets.push_back(staging_bytes);
+    staging_bytes += (total_bytes + Allocator::kAllocatorAlignment - 1) /
+                     Allocator::kAllocatorAlignment *
+                     Allocator::kAllocatorAlignment;
+  }
+
+  // Staging only pays off when it replaces more than one transfer. If either
+  // staging buffer can't be allocated, fall back to direct copies.
+  Allocator* device_alloc = nullptr;
+  Allocator* host_alloc = nullptr;
+  char* device_buf = nullptr;
+  char* host_buf = nullptr;
+  if (batched.size() > 1) {
+    profiler::ScopedAnnotation annotation("CopyGPUTensorsToCPU");
+    device_alloc = gpu_device->GetAllocator(AllocatorAttributes());
+    device_buf = static_cast<char*>(device_alloc->AllocateRaw(
+        Allocator::kAllocatorAlignment, staging_bytes));
+    if (device_buf != nullptr) {
+      host_alloc = GPUProcessState::singleton()->GetGpuHostAllocator(
+          gpu_device->NumaNode());
+      host_buf = static_cast<char*>(host_alloc->AllocateRaw(
+          Allocator::kAllocatorAlignment, staging_bytes));
+      if (host_buf == nullptr) {
+        device_alloc->DeallocateRaw(device_buf);
+        device_buf = nullptr;
+      }
+    }
+  }
+  if (device_buf == nullptr) {
+    batched.clear();
+    offsets.clear();
+  }
+
+  std::vector<bool> is_batched(gpu_tensors.size(), false);
+  for (int j = 0; j < batched.size(); ++j) {
+    const Tensor* gpu_tensor = gpu_tensors[batched[j]];
+    const int64_t total_bytes = gpu_tensor->TotalBytes();
+    DeviceMemoryBase gpu_src_ptr(GetBase(gpu_tensor), total_bytes);
+    DeviceMemoryBase gpu_dst_ptr(device_buf + offsets[j], total_bytes);
+    send_device_to_host_stream->ThenMemcpy(&gpu_dst_ptr, gpu_src_ptr,
+                                           total_bytes);
+    is_batched[batched[j]] = true;
+  }
+  if (!batched.empty()) {
+    DeviceMemoryBase gpu_src_ptr(device_buf, staging_bytes);
+    send_device_to_host_stream->ThenMemcpy(host_buf, gpu_src_ptr,
+                                           staging_bytes);
+  }
+  std::vector<TensorReference> input_refs;
+  input_refs.reserve(gpu_tensors.size());
+  for (int i = 0; i < gpu_tensors.size(); ++i) {
+    const int64_t total_bytes = gpu_tensors[i]->TotalBytes();
+    if (total_bytes > 0 && !is_batched[i]) {
+      DeviceMemoryBase gpu_src_ptr(GetBase(gpu_tensors[i]), total_bytes);
+      send_device_to_host_stream->ThenMemcpy(GetBase(cpu_tensors[i]),
+                                             gpu_src_ptr, total_bytes);
+    }
+    // Use of the inputs may outlive stack scope, so keep refs.
+    input_refs.emplace_back(*gpu_tensors[i]);
+  }
+
+  std::vector<Tensor*> batched_dsts;
+  batched_dsts.reserve(batched.size());
+  for (int i : batched) batched_dsts.push_back(cpu_tensors[i]);
+  dev_info->event_mgr->ThenExecute(
+      send_device_to_host_stream,
+      [send_device_to_host_stream, done, input_refs, batched_dsts, offsets,
+       device_alloc, device_buf, host_alloc, host_buf]() {
+        if (!send_device_to_host_stream->ok()) {
+          LOG(FATAL) << "GPU->CPU Memcpy failed";
+        }
+        for (const TensorReference& ref : input_refs) ref.Unref();
+        if (device_buf != nullptr) {
+          for (int j = 0; j < batched_dsts.size(); ++j) {
+            memcpy(GetBase(batched_dsts[j]), host_buf + offsets[j],
+                   batched_dsts[j]->TotalBytes());
+          }
+          device_alloc->DeallocateRaw(device_buf);
+          host_alloc->DeallocateRaw(host_buf);
+        }
+        done(Status::OK());
+      });
+}
+
 /*  static */
 void GPUUtil::CopyCPUTensorToGPU(const Tensor* cpu_tensor,
                                  const DeviceContext* device_context,
@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_UTIL_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_UTIL_H_
 
+#include <vector>
+
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -49,6 +51,20 @@ class GPUUtil {
                                  const Tensor* gpu_tensor, Tensor* cpu_tensor,
                                  StatusCallback done);
 
+  // Copies the data in each of 'gpu_tensors' into the corresponding entry of
+  // 'cpu_tensors', calling 'done' once all copies have completed.
+  // Tensors of at most 'max_batched_bytes' are gathered on the device into
+  // one contiguous buffer, moved with a single copy into pinned memory on
+  // the GPU's NUMA node, and then scattered on the host. This avoids paying
+  // the per-transfer latency for each of many small tensors. Larger tensors
+  // are copied directly as in CopyGPUTensorToCPU.
+  static void CopyGPUTensorsToCPU(Device* gpu_device,
+                                  const DeviceContext* device_context,
+                                  const std::vector<const Tensor*>& gpu_tensors,
+                                  const std::vector<Tensor*>& cpu_tensors,
+                                  StatusCallback done,
+                                  int64_t max_batched_bytes = 64 << 10);
+
   // Blocks until all operations queued on the stream associated with
   // "gpu_device" at the time of the call have completed.  Returns any
   // error pending on the stream at completion.
@@ -45,9 +45,11 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/scanner.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/public/version.h"
 
 namespace tensorflow {
@@ -229,6 +231,14 @@ class GraphConstructor {
   Status IsNodeFullyMapped(const NodeDef& node_def, bool* is_node_mapped);
   Status ValidateColocationConstraints(const NodeDef& node_def);
   Status MakeNode(NodeDef&& node_def, Node** node);
+  Status MakeNode(Graph::PreparedNode&& prepared, Node** node);
+  // Adds default attributes to and validates `node_def` as requested by opts_
+  // when not importing.
+  Status AddDefaultsAndValidate(NodeDef* node_def);
+  // When not importing, node preparation does not depend on the nodes already
+  // converted, so for large graphs Convert() does it for all nodes up front on
+  // a thread pool and then only adds the prepared nodes in topological order.
+  void PrepareNodesInParallel();
   Status MakeEdge(Node* src, int output_index, Node* dst, int input_index);
   Status ValidateShape(Node* node);
   Status ModifyNodeDefForImport(NodeDef* node_def);
@@ -353,6 +363,18 @@ class GraphConstructor {
   // all nodes it outputs to.
   std::vector<gtl::InlinedVector<int, 4>> outputs_;
 
+  // The index within node_defs_ of the source of every input of every node,
+  // or -1 for inputs mapped by opts_.input_map. The inputs of the node at
+  // index n are at [input_offsets_[n], input_offsets_[n + 1]). InitFromEdges()
+  // resolves input names once, so that Convert() does not look them up again
+  // when node_defs_ are not modified, i.e. when not importing.
+  std::vector<int> input_offsets_;
+  std::vector<int> input_gdef_indices_;
+
+  // Mapping between index within node_defs_ and the converted node, or nullptr
+  // until the node is converted.
+  std::vector<Node*> converted_nodes_;
+
   // Used in the conversion from node_defs_ to g_ to represent the ith input
   // of a node.
   struct InputInfo {
@@ -387,6 +409,11 @@ class GraphConstructor {
   };
   std::vector<EdgeInfo> back_edges_;
 
+  // Indexed like node_defs_ and filled in by PrepareNodesInParallel(); empty
+  // if the nodes are prepared one by one in Convert().
+  std::vector<Graph::PreparedNode> prepared_nodes_;
+  std::vector<Status> prepare_status_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(GraphConstructor);
 };
 
@@ -687,6 +714,9 @@ Status GraphConstructor::InitFromEdges() {
   const int num_nodes = node_def_count();
   pending_count_.reserve(num_nodes);
   outputs_.resize(num_nodes);
+  input_offsets_.reserve(num_nodes + 1);
+  input_offsets_.push_back(0);
+  converted_nodes_.assign(num_nodes, nullptr);
   gtl::FlatSet<string> next_iteration_nodes;
   for (int n = 0; n < node_def_count(); ++n) {
     const NodeDef& node_def = get_node_def(n);
@@ -735,13 +765,16 @@ Status GraphConstructor::InitFromEdges() {
                                          node_def.input(i), "'");
         }
         outputs_[iter->second.gdef_index].push_back(n);
+        input_gdef_indices_.push_back(iter->second.gdef_index);
       } else {
         // This input is mapped to an existing edge. Therefore this input is
         // as good as being already processed.
         --pending_count;
         DCHECK_GE(pending_count, 0);
+        input_gdef_indices_.push_back(-1);
       }
     }
+    input_offsets_.push_back(input_gdef_indices_.size());
     if (pending_count == 0) {
       ready_.insert(n);
     }
@@ -779,6 +812,54 @@ Status GraphConstructor::MakeNode(NodeDef&& node_def, Node** node) {
   return Status::OK();
 }
 
+Status GraphConstructor::MakeNode(Graph::PreparedNode&& prepared,
+                                  Node** node) {
+  *node = g_->AddNode(std::move(prepared));
+  if (opts_.expect_device_spec) {
+    (*node)->set_assigned_device_name((*node)->def().device());
+  }
+  return Status::OK();
+}
+
+Status GraphConstructor::AddDefaultsAndValidate(NodeDef* node_def) {
+  const OpDef* op_def;
+  TF_RETURN_IF_ERROR(g_->op_registry()->LookUpOpDef(node_def->op(), &op_def));
+  if (opts_.add_default_attributes) {
+    AddDefaultsToNodeDef(*op_def, node_def);
+  }
+  if (opts_.validate_nodes) {
+    TF_RETURN_IF_ERROR(ValidateNodeDef(*node_def, *op_def));
+  }
+  return Status::OK();
+}
+
+void GraphConstructor::PrepareNodesInParallel() {
+  const int num_nodes = node_def_count();
+  // consume_node_def() is not thread-safe, so consume every node up front.
+  std::vector<NodeDef> node_defs(num_nodes);
+  for (int i = 0; i < num_nodes; ++i) {
+    node_defs[i] = consume_node_def(i);
+  }
+  prepared_nodes_.resize(num_nodes);
+  prepare_status_.resize(num_nodes);
+  // A failure only surfaces once Convert() reaches the failing node, as it
+  // would when preparing nodes one by one.
+  auto prepare = [this, &node_defs](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) {
+      Status s = AddDefaultsAndValidate(&node_defs[i]);
+      if (s.ok()) {
+        s = g_->PrepareNode(std::move(node_defs[i]), &prepared_nodes_[i]);
+      }
+      prepare_status_[i] = s;
+    }
+  };
+  thread::ThreadPool pool(Env::Default(), "graph_constructor",
+                          port::MaxParallelism());
+  // Looking up and type-checking a node is in the order of microseconds.
+  const int64_t kCostPerNode = 10000;
+  pool.ParallelFor(num_nodes, kCostPerNode, prepare);
+}
+
 Status GraphConstructor::ValidateShape(Node* node) {
   if (!opts_.importing || !opts_.validate_shape) return Status::OK();
   TF_RETURN_IF_ERROR(refiner_->AddNode(node));
@@ -1123,6 +1204,12 @@ Status GraphConstructor::Convert() {
     TF_RETURN_IF_ERROR(g_->AddFunctionLibrary(*library()));
   }
 
+  // Below this size preparing nodes takes less time than starting threads.
+  const int kMinNodesForParallelPrepare = 4096;
+  if (!opts_.importing && node_def_count() >= kMinNodesForParallelPrepare) {
+    PrepareNodesInParallel();
+  }
+
   std::vector<InputInfo> inputs;
   int processed = 0;
 
@@ -1139,16 +1226,26 @@ Status GraphConstructor::Convert() {
     inputs.clear();
     bool has_data_back_edge = false;
 
-    NodeDef node_def = consume_node_def(o);
+    NodeDef node_def;
+    Graph::PreparedNode* prepared = nullptr;
+    if (prepared_nodes_.empty()) {
+      node_def = consume_node_def(o);
+    } else {
+      TF_RETURN_IF_ERROR(prepare_status_[o]);
+      prepared = &prepared_nodes_[o];
+    }
+    // The node to convert, which is only modified through `node_def` when
+    // importing, in which case nodes are never prepared in advance.
+    const NodeDef& def = prepared != nullptr ? prepared->def() : node_def;
 
     // input_already_exists[i] is true iff the i-th input of the node we're
     // importing refers to a preexisting node in g_ (i.e. input[i] existed prior
     // to importing node_defs_).  Conversely, input_already_exists[i] is false
     // iff the input refers to a node in node_defs_.
     input_already_exists.clear();
-    input_already_exists.resize(node_def.input_size(), false);
+    input_already_exists.resize(def.input_size(), false);
 
-    std::string node_name = node_def.name();
+    std::string node_name = def.name();
 
     if (opts_.importing) {
       if (opts_.skip_mapped_nodes) {
@@ -1174,14 +1271,21 @@ Status GraphConstructor::Convert() {
       }
     }
 
-    DCHECK_EQ(node_def.input_size(), input_already_exists.size());
-    TF_RETURN_IF_ERROR(ValidateColocationConstraints(node_def));
-    for (int i = 0; i < node_def.input_size(); ++i) {
-      TensorId tensor_id = ParseTensorName(node_def.input(i));
+    DCHECK_EQ(def.input_size(), input_already_exists.size());
+    TF_RETURN_IF_ERROR(ValidateColocationConstraints(def));
+    for (int i = 0; i < def.input_size(); ++i) {
+      TensorId tensor_id = ParseTensorName(def.input(i));
       Node* src_node;
       int src_index;
 
-      if (!input_already_exists[i]) {
+      if (!opts_.importing) {
+        // The inputs are the ones resolved by InitFromEdges().
+        const int src_gdef_index = input_gdef_indices_[input_offsets_[o] + i];
+        DCHECK_GE(src_gdef_index, 0) << tensor_id.node();
+        src_node = converted_nodes_[src_gdef_index];
+        src_index = tensor_id.index();
+        if (src_node == nullptr) has_data_back_edge = true;
+      } else if (!input_already_exists[i]) {
         // Locate input in newly-imported nodes
         auto iter = gdef_nodes_.find(tensor_id.node());
         DCHECK(iter != gdef_nodes_.end()) << tensor_id.node();
@@ -1198,7 +1302,7 @@ Status GraphConstructor::Convert() {
 
       if (src_node != nullptr && src_index >= src_node->num_outputs()) {
         std::ostringstream out;
-        out << "Node '" << node_def.name() << "': Connecting to invalid output "
+        out << "Node '" << def.name() << "': Connecting to invalid output "
             << tensor_id.index() << " of source node " << tensor_id.node()
             << " which has " << src_node->num_outputs() << " outputs.";
 
@@ -1215,9 +1319,9 @@ Status GraphConstructor::Convert() {
       inputs.emplace_back(string(tensor_id.node()), src_node, src_index);
     }
 
-    if (has_data_back_edge && !IsMerge(node_def)) {
+    if (has_data_back_edge && !IsMerge(def)) {
       return errors::InvalidArgument(
-          "Node '", node_def.name(),
+          "Node '", def.name(),
           "' had a back edge, but only Merge nodes can have back edges.");
     }
 
@@ -1233,23 +1337,19 @@ Status GraphConstructor::Convert() {
       }
     }
 
-    if (opts_.importing) {
-      TF_RETURN_IF_ERROR(ModifyNodeDefForImport(&node_def));
+    if (prepared != nullptr) {
+      TF_RETURN_IF_ERROR(MakeNode(std::move(*prepared), &node));
     } else {
-      const OpDef* op_def;
-      TF_RETURN_IF_ERROR(
-          g_->op_registry()->LookUpOpDef(node_def.op(), &op_def));
-      if (opts_.add_default_attributes) {
-        AddDefaultsToNodeDef(*op_def, &node_def);
-      }
-      if (opts_.validate_nodes) {
-        TF_RETURN_IF_ERROR(ValidateNodeDef(node_def, *op_def));
+      if (opts_.importing) {
+        TF_RETURN_IF_ERROR(ModifyNodeDefForImport(&node_def));
+      } else {
+        TF_RETURN_IF_ERROR(AddDefaultsAndValidate(&node_def));
       }
+      TF_RETURN_IF_ERROR(MakeNode(std::move(node_def), &node));
     }
 
-    TF_RETURN_IF_ERROR(MakeNode(std::move(node_def), &node));
-
     gdef_nodes_[node_name].node = node;
+    converted_nodes_[o] = node;
 
     // Remove duplicate control inputs before adding edges to the graph. It
     // will allow us to skip expensive duplicates check in 'AddControlEdge'.
@@ -1284,7 +1384,16 @@ Status GraphConstructor::Convert() {
                  << " NODES IN A CYCLE";
     for (int64_t i = 0; i < node_def_count(); i++) {
       if (pending_count_[i] != 0) {
-        LOG(WARNING) << "PENDING: " << SummarizeNodeDef(get_node_def(i))
+        // Nodes prepared in advance have already been consumed.
+        string summary;
+        if (prepared_nodes_.empty()) {
+          summary = SummarizeNodeDef(get_node_def(i));
+        } else if (prepare_status_[i].ok()) {
+          summary = SummarizeNodeDef(prepared_nodes_[i].def());
+        } else {
+          summary = prepare_status_[i].ToString();
+        }
+        LOG(WARNING) << "PENDING: " << summary
                      << " WITH PENDING COUNT = " << pending_count_[i];
       }
     }
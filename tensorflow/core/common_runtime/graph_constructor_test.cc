@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/graph_constructor.h"
 
+#include <functional>
 #include <vector>
 
 #include "tensorflow/core/common_runtime/shape_refiner.h"
@@ -896,6 +897,63 @@ TEST_F(GraphConstructorTest, SimpleModel) {
   EXPECT_TRUE(HasEdge("input", 1, "t1", 1));
 }
 
+// Builds a chain of `num_nodes` nodes large enough for the nodes to be
+// prepared in parallel, where the i-th node has op `op_at(i)`.
+GraphDef MakeChainGraphDef(int num_nodes,
+                           const std::function<string(int)>& op_at) {
+  GraphDef gdef;
+  for (int i = 0; i < num_nodes; ++i) {
+    NodeDef* node = gdef.add_node();
+    node->set_name(strings::StrCat("n", i));
+    node->set_op(op_at(i));
+    if (i > 0) {
+      node->add_input(strings::StrCat("n", i - 1));
+      AddNodeAttr("T", DT_FLOAT, node);
+    }
+  }
+  return gdef;
+}
+
+TEST_F(GraphConstructorTest, LargeModel) {
+  const int kNumNodes = 5000;
+  GraphDef gdef = MakeChainGraphDef(kNumNodes, [](int i) -> string {
+    return i == 0 ? "TestParams" : "TestOneInputOneOutput";
+  });
+  GraphConstructorOptions opts;
+  TF_EXPECT_OK(ConvertGraphDefToGraph(opts, std::move(gdef), &graph_));
+  EXPECT_EQ(kNumNodes + 2, graph_.num_nodes());
+  EXPECT_TRUE(HasEdge("n0", 0, "n1", 0));
+  EXPECT_TRUE(HasEdge("n4998", 0, "n4999", 0));
+  Node* last = FindNode("n4999");
+  ASSERT_NE(last, nullptr);
+  EXPECT_EQ(DT_FLOAT, last->output_type(0));
+}
+
+TEST_F(GraphConstructorTest, LargeModelWithUnknownOp) {
+  GraphDef gdef = MakeChainGraphDef(5000, [](int i) -> string {
+    if (i == 0) return "TestParams";
+    return i == 4000 ? "UnknownOp" : "TestOneInputOneOutput";
+  });
+  GraphConstructorOptions opts;
+  Status s = ConvertGraphDefToGraph(opts, std::move(gdef), &graph_);
+  EXPECT_FALSE(s.ok());
+  EXPECT_TRUE(s.error_message().find("UnknownOp") != string::npos) << s;
+}
+
+TEST_F(GraphConstructorTest, LargeModelWithCycle) {
+  GraphDef gdef = MakeChainGraphDef(5000, [](int i) -> string {
+    if (i == 0) return "TestParams";
+    return i == 1 ? "TestMul" : "TestOneInputOneOutput";
+  });
+  // Close a cycle over all nodes but the first.
+  gdef.mutable_node(1)->add_input("n4999");
+  GraphConstructorOptions opts;
+  Status s = ConvertGraphDefToGraph(opts, std::move(gdef), &graph_);
+  EXPECT_FALSE(s.ok());
+  EXPECT_TRUE(s.error_message().find("4999 nodes in a cycle") != string::npos)
+      << s;
+}
+
 TEST_F(GraphConstructorTest, SimpleModelWithControlEdges) {
   ExpectOK(
       "node { name: 'W1' op: 'TestParams' }"
@@ -96,6 +96,11 @@ class SimpleRendezvous : public RendezvousInterface {
 GraphRunner::GraphRunner(Env* env)
     : device_deleter_(NewSingleThreadedCpuDevice(env)),
       device_(device_deleter_.get()) {}
+GraphRunner::GraphRunner(Env* env,
+                         std::function<void(std::function<void()>)> runner)
+    : device_deleter_(NewSingleThreadedCpuDevice(env)),
+      device_(device_deleter_.get()),
+      runner_(std::move(runner)) {}
 GraphRunner::GraphRunner(Device* device) : device_(device) {}
 
 GraphRunner::~GraphRunner() {}
@@ -150,9 +155,12 @@ Status GraphRunner::Run(Graph* graph, FunctionLibraryRuntime* function_library,
   // Create the local executor and the Rendezvous for fetching back the
   // constants.
 
-  // Run operators on the local thread. We should not need concurrency here; we
-  // should not be running expensive operators.
-  auto runner = [](Executor::Args::Closure c) { c(); };
+  // Unless a runner was provided, run operators on the local thread. We should
+  // not need concurrency here; we should not be running expensive operators.
+  Executor::Args::Runner runner = runner_;
+  if (!runner) {
+    runner = [](Executor::Args::Closure c) { c(); };
+  }
 
   LocalExecutorParams params;
   // The ownership of the output tensors are bound to this device's lifetime.
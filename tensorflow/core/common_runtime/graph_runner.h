@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GRAPH_RUNNER_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_GRAPH_RUNNER_H_
 
+#include <functional>
 #include <memory>
 #include <string>
 #include <vector>
@@ -43,6 +44,11 @@ class GraphRunner {
  public:
   // REQUIRES: `env` is not nullptr.
   GraphRunner(Env* env);
+  // Like `GraphRunner(env)`, but nodes are run with `runner`, so that nodes
+  // that do not depend on each other may run in parallel.
+  //
+  // REQUIRES: `env` and `runner` are not nullptr.
+  GraphRunner(Env* env, std::function<void(std::function<void()>)> runner);
   // REQUIRES: 'device' is not nullptr. Not owned.
   GraphRunner(Device* device);
   ~GraphRunner();
@@ -64,6 +70,8 @@ class GraphRunner {
  private:
   std::unique_ptr<Device> device_deleter_;
   Device* const device_;
+  // Runs the nodes of the graph. Nodes are run on the calling thread if null.
+  std::function<void(std::function<void()>)> runner_;
 };
 
 }  // namespace tensorflow
@@ -111,6 +111,10 @@ struct NodeItem {
   // is true if and only if the ith output is consumed by another node.
   std::unique_ptr<bool[]> outputs_required;
 
+  // If non-null, contains an array of num_outputs ints, where the ith int is
+  // the index of a `_Retval` node that consumes the ith output, or -1.
+  std::unique_ptr<int[]> output_retvals;
+
   gtl::MutableArraySlice<EdgeInfo> mutable_output_edges() {
     return gtl::MutableArraySlice<EdgeInfo>(output_edge_base(),
                                             num_output_edges);
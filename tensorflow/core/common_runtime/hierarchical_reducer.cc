@@ -0,0 +1,351 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/hierarchical_reducer.h"
+
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/collective_rma_local.h"
+#include "tensorflow/core/common_runtime/collective_util.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/device_base.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+
+// Set true for greater intelligibility of debug mode log messages.
+#define READABLE_KEYS false
+
+namespace tensorflow {
+
+namespace {
+
+// The phases of the algorithm, which distinguish the BufRendezvous keys of
+// their transfers.
+enum Phase {
+  kLocalReduceScatter = 0,
+  kRemoteReduceScatter = 1,
+  kRemoteAllGather = 2,
+  kLocalAllGather = 3,
+};
+
+// Key to be used for BufRendezvous by HierarchicalReducer.
+string HierarchicalReduceBufKey(const string& exec_key, int phase, int step,
+                                int chunk, int src_rank) {
+  if (READABLE_KEYS) {
+    return strings::StrCat("hierarchical_reduce(", exec_key, "):phase(",
+                           phase, "):step(", step, "):chunk(", chunk,
+                           "):srcrank(", src_rank, ")");
+  } else {
+    return strings::StrCat(exec_key, ":", phase, ":", step, ":", chunk, ":",
+                           src_rank);
+  }
+}
+
+// Returns `i` modulo `n`, in [0, n).
+int Mod(int i, int n) { return ((i % n) + n) % n; }
+
+}  // namespace
+
+HierarchicalReducer::HierarchicalReducer()
+    : col_ctx_(nullptr),
+      col_params_(nullptr),
+      num_tasks_(0),
+      num_devices_per_task_(0),
+      task_(-1),
+      local_rank_(-1) {}
+
+Status HierarchicalReducer::InitializeCollectiveParams(
+    CollectiveParams* col_params) {
+  CHECK_EQ(col_params->instance.type, REDUCTION_COLLECTIVE);
+  CHECK_EQ(col_params->instance.impl_details.collective_name,
+           "HierarchicalReduce");
+  const CollGroupParams& group = col_params->group;
+  if (!group.same_num_devices_per_task || group.num_tasks <= 0 ||
+      group.group_size % group.num_tasks != 0) {
+    return errors::InvalidArgument(
+        "HierarchicalReduce requires the same number of devices on every "
+        "task, but got group ",
+        group.ToString());
+  }
+  // The devices of each task must be adjacent in the default rank order.
+  const int num_devices_per_task = group.group_size / group.num_tasks;
+  for (int di = 0; di < group.group_size; ++di) {
+    const int task_leader = di - (di % num_devices_per_task);
+    if (group.members[di].task != group.members[task_leader].task) {
+      return errors::InvalidArgument(
+          "HierarchicalReduce requires the devices of each task to be "
+          "adjacent in rank order, but got group ",
+          group.ToString());
+    }
+  }
+  return Status::OK();
+}
+
+Status HierarchicalReducer::InitializeCollectiveContext(
+    std::shared_ptr<CollectiveContext> col_ctx) {
+  CHECK(col_ctx->dev_mgr);
+  col_ctx_ = col_ctx;
+  col_params_ = col_ctx->col_params.get();
+  return collective_util::InitializeDeviceAndLocality(
+      col_ctx->dev_mgr, col_ctx->device_name, &col_ctx->device,
+      &col_ctx->device_locality);
+}
+
+void HierarchicalReducer::Run(StatusCallback done) {
+  CHECK(col_ctx_);
+  CHECK(col_params_);
+  // Since `HierarchicalReducer` doesn't require non-overlapping collectives,
+  // unblock any collective that is blocked on this instance.
+  col_ctx_->col_exec->UnblockDependencies(*col_params_);
+
+  num_tasks_ = col_params_->group.num_tasks;
+  num_devices_per_task_ = col_params_->group.group_size / num_tasks_;
+  task_ = col_params_->default_rank / num_devices_per_task_;
+  local_rank_ = col_params_->default_rank % num_devices_per_task_;
+
+  Status s = RunPhases();
+  if (s.ok()) {
+    // Recover the output from the adaptor.
+    ca_->ConsumeFinalValue(col_ctx_->output);
+  }
+  chunks_.clear();  // Give up Refs on output tensor.
+  done(s);
+}
+
+std::vector<int> HierarchicalReducer::ShardChunks(int shard) const {
+  std::vector<int> chunks(num_tasks_);
+  for (int j = 0; j < num_tasks_; ++j) {
+    chunks[j] = shard * num_tasks_ + j;
+  }
+  return chunks;
+}
+
+Status HierarchicalReducer::SendRecv(int phase, int step, int send_to,
+                                     const std::vector<int>& send_chunks,
+                                     int recv_from,
+                                     const std::vector<int>& recv_chunks,
+                                     bool reduce) {
+  const int my_rank = col_params_->default_rank;
+  const std::vector<CollGroupMember>& members = col_params_->group.members;
+  CollectiveRemoteAccess* rma = col_ctx_->col_exec->remote_access();
+  std::vector<Tensor> tmp_chunks(recv_chunks.size());
+
+  mutex mu;
+  Status status;
+  BlockingCounter pending(send_chunks.size() + recv_chunks.size());
+  auto transfer_done = [this, &mu, &status, &pending](const Status& s) {
+    if (!s.ok()) {
+      bool abort_started = false;
+      {
+        mutex_lock l(mu);
+        abort_started = status.ok();
+        status.Update(s);
+      }
+      // Abort the other pending transfers, unless they are being cancelled
+      // already.
+      CancellationManager* cm = col_ctx_->op_ctx->cancellation_manager();
+      if (abort_started &&
+          (cm == nullptr || (!cm->IsCancelled() && !cm->IsCancelling()))) {
+        col_ctx_->col_exec->StartAbort(s);
+      }
+    }
+    pending.DecrementCount();
+  };
+
+  for (int chunk : send_chunks) {
+    rma->PostToPeer(
+        members[send_to].device.name(), members[send_to].task,
+        HierarchicalReduceBufKey(col_ctx_->exec_key, phase, step, chunk,
+                                 my_rank),
+        col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
+        col_ctx_->op_ctx->output_alloc_attr(0), &chunks_[chunk],
+        col_ctx_->device_locality, col_ctx_->op_ctx->cancellation_manager(),
+        transfer_done);
+  }
+  for (int i = 0; i < recv_chunks.size(); ++i) {
+    const int chunk = recv_chunks[i];
+    Tensor* dst_tensor = &chunks_[chunk];
+    if (reduce) {
+      tmp_chunks[i] = ca_->TempChunk(chunk);
+      dst_tensor = &tmp_chunks[i];
+    }
+    rma->RecvFromPeer(
+        members[recv_from].device.name(), members[recv_from].task,
+        members[recv_from].is_local,
+        HierarchicalReduceBufKey(col_ctx_->exec_key, phase, step, chunk,
+                                 recv_from),
+        col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
+        col_ctx_->op_ctx->output_alloc_attr(0), dst_tensor,
+        col_ctx_->device_locality, 0 /*dev_to_dev_stream_index*/,
+        col_ctx_->op_ctx->cancellation_manager(), transfer_done);
+  }
+  pending.Wait();
+  TF_RETURN_IF_ERROR(status);
+
+  if (reduce) {
+    for (int i = 0; i < recv_chunks.size(); ++i) {
+      TF_RETURN_IF_ERROR(collective_util::ComputeBinOp(
+          col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+          col_params_->merge_op, &chunks_[recv_chunks[i]], &tmp_chunks[i]));
+    }
+  }
+  return Status::OK();
+}
+
+Status HierarchicalReducer::Finalize(int chunk) {
+  if (col_params_->final_op == nullptr) return Status::OK();
+  return collective_util::ComputeBinOp(
+      col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+      col_params_->final_op, &chunks_[chunk], &group_size_tensor_);
+}
+
+Status HierarchicalReducer::RunPhases() {
+  // Start by copying input to output if they're not already the same, i.e. if
+  // we're not computing in-place on the input tensor.
+  if ((col_ctx_->input != col_ctx_->output) &&
+      (DMAHelper::base(col_ctx_->input) != DMAHelper::base(col_ctx_->output))) {
+    Notification note;
+    Status status;
+    profiler::TraceMe activity("MemCpyAsync", profiler::TraceMeLevel::kInfo);
+    CollectiveRemoteAccessLocal::MemCpyAsync(
+        col_ctx_->op_ctx->op_device_context(),
+        col_ctx_->op_ctx->op_device_context(), col_ctx_->device,
+        col_ctx_->device, col_ctx_->op_ctx->input_alloc_attr(0),
+        col_ctx_->op_ctx->output_alloc_attr(0), col_ctx_->input,
+        col_ctx_->output, 0 /*dev_to_dev_stream_index*/,
+        [&note, &status](const Status& s) {
+          status.Update(s);
+          note.Notify();
+        });
+    note.WaitForNotification();
+    TF_RETURN_IF_ERROR(status);
+  }
+
+  const int num_chunks = num_devices_per_task_ * num_tasks_;
+  AllocatorAttributes attr = col_ctx_->op_ctx->output_alloc_attr(0);
+  ca_.reset(MakeCollectiveAdapter(col_ctx_->output, num_chunks,
+                                  col_ctx_->device->GetAllocator(attr)));
+  chunks_.clear();
+  chunks_.reserve(num_chunks);
+  for (int c = 0; c < num_chunks; ++c) {
+    chunks_.push_back(ca_->ChunkAlias(c));
+  }
+
+  if (col_params_->final_op) {
+    // Create an on-device scalar value from the group size.
+    Tensor group_size_val = ca_->Scalar(col_params_->group.group_size);
+    if (col_params_->group.device_type != "CPU") {
+      group_size_tensor_ = ca_->Scalar(
+          col_ctx_->device->GetAllocator(col_ctx_->op_ctx->input_alloc_attr(0)),
+          AllocationAttributes());
+      Notification note;
+      Status status;
+      col_ctx_->op_ctx->op_device_context()->CopyCPUTensorToDevice(
+          &group_size_val, col_ctx_->device, &group_size_tensor_,
+          [&note, &status](const Status& s) {
+            status = s;
+            note.Notify();
+          });
+      note.WaitForNotification();
+      TF_RETURN_IF_ERROR(status);
+    } else {
+      group_size_tensor_ = group_size_val;
+    }
+  }
+
+  const int num_local = num_devices_per_task_;
+  const int task_base = task_ * num_local;
+  const int next_local = task_base + Mod(local_rank_ + 1, num_local);
+  const int prev_local = task_base + Mod(local_rank_ - 1, num_local);
+
+  // Phase 1: reduce-scatter the shards among the devices of this task.  At
+  // step s this device sends shard (local_rank - s) and accumulates shard
+  // (local_rank - s - 1), so that it ends up with the task-wide sum of shard
+  // (local_rank + 1).
+  {
+    profiler::TraceMe activity("LocalReduceScatter",
+                               profiler::TraceMeLevel::kInfo);
+    for (int s = 0; s < num_local - 1; ++s) {
+      TF_RETURN_IF_ERROR(SendRecv(
+          kLocalReduceScatter, s, next_local,
+          ShardChunks(Mod(local_rank_ - s, num_local)), prev_local,
+          ShardChunks(Mod(local_rank_ - s - 1, num_local)), /*reduce=*/true));
+    }
+  }
+
+  // Phase 2: all-reduce the shard of this device in a ring across the tasks,
+  // with the devices of the same local rank on the other tasks.  Each of the
+  // num_tasks chunks of the shard is reduced on one task, finalized, and then
+  // gathered by the others.
+  const int shard = Mod(local_rank_ + 1, num_local);
+  const std::vector<int> shard_chunks = ShardChunks(shard);
+  if (num_tasks_ > 1) {
+    profiler::TraceMe activity("RemoteAllReduce",
+                               profiler::TraceMeLevel::kInfo);
+    const int next_task = Mod(task_ + 1, num_tasks_) * num_local + local_rank_;
+    const int prev_task = Mod(task_ - 1, num_tasks_) * num_local + local_rank_;
+    for (int s = 0; s < num_tasks_ - 1; ++s) {
+      TF_RETURN_IF_ERROR(
+          SendRecv(kRemoteReduceScatter, s, next_task,
+                   {shard_chunks[Mod(task_ - s, num_tasks_)]}, prev_task,
+                   {shard_chunks[Mod(task_ - s - 1, num_tasks_)]},
+                   /*reduce=*/true));
+    }
+    TF_RETURN_IF_ERROR(Finalize(shard_chunks[Mod(task_ + 1, num_tasks_)]));
+    for (int s = 0; s < num_tasks_ - 1; ++s) {
+      TF_RETURN_IF_ERROR(
+          SendRecv(kRemoteAllGather, s, next_task,
+                   {shard_chunks[Mod(task_ + 1 - s, num_tasks_)]}, prev_task,
+                   {shard_chunks[Mod(task_ - s, num_tasks_)]},
+                   /*reduce=*/false));
+    }
+  } else {
+    for (int chunk : shard_chunks) {
+      TF_RETURN_IF_ERROR(Finalize(chunk));
+    }
+  }
+
+  // Phase 3: all-gather the shards among the devices of this task.  At step
+  // s this device sends shard (local_rank + 1 - s) and receives shard
+  // (local_rank - s).
+  {
+    profiler::TraceMe activity("LocalAllGather",
+                               profiler::TraceMeLevel::kInfo);
+    for (int s = 0; s < num_local - 1; ++s) {
+      TF_RETURN_IF_ERROR(SendRecv(
+          kLocalAllGather, s, next_local,
+          ShardChunks(Mod(local_rank_ + 1 - s, num_local)), prev_local,
+          ShardChunks(Mod(local_rank_ - s, num_local)), /*reduce=*/false));
+    }
+  }
+  return Status::OK();
+}
+
+namespace {
+REGISTER_COLLECTIVE(HierarchicalReduce, HierarchicalReducer);
+}  // namespace
+
+}  // namespace tensorflow
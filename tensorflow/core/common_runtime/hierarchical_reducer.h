@@ -0,0 +1,86 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_REDUCER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_REDUCER_H_
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/base_collective_executor.h"
+#include "tensorflow/core/framework/collective.h"
+
+namespace tensorflow {
+
+// Hierarchical implementation of collective all-reduce, for groups spanning
+// several tasks that each hold the same number of devices.
+//
+// The tensor is split into one shard per device of a task.  The devices of
+// each task first reduce-scatter the shards among themselves, so that each
+// device holds the task-wide sum of one shard.  The devices holding the same
+// shard on every task then all-reduce it in a ring across the tasks, and
+// finally the devices of each task all-gather the shards.  Hence only
+// 1 / (devices per task) of the tensor crosses task boundaries per device,
+// over as many parallel rings as there are devices per task.
+class HierarchicalReducer : public CollectiveImplementationInterface {
+ public:
+  HierarchicalReducer();
+  ~HierarchicalReducer() override = default;
+
+  // Checks that every task of the group holds the same number of devices,
+  // and that the devices of each task are adjacent in the default rank order.
+  Status InitializeCollectiveParams(CollectiveParams* col_params) override;
+
+  // Initializes members of CollectiveContext not yet initialized, i.e. device
+  // and device_locality.  Also saves the CollectiveContext in this object.
+  Status InitializeCollectiveContext(
+      std::shared_ptr<CollectiveContext> col_ctx) override;
+
+  // Begins execution of the hierarchical all-reduce.
+  // Must be called in a blockable thread.
+  void Run(StatusCallback done) override;
+
+ private:
+  // Sends the chunks `send_chunks` to the device at rank `send_to` and
+  // receives the chunks `recv_chunks` from the device at rank `recv_from`,
+  // reducing them into the output if `reduce` is true, and otherwise
+  // overwriting it.  Blocks until all of the transfers are done.  `phase` and
+  // `step` distinguish the transfers of successive calls.
+  Status SendRecv(int phase, int step, int send_to,
+                  const std::vector<int>& send_chunks, int recv_from,
+                  const std::vector<int>& recv_chunks, bool reduce);
+
+  // Returns the indices of the chunks of shard `shard`.
+  std::vector<int> ShardChunks(int shard) const;
+
+  // Applies the final op to chunk `chunk`.
+  Status Finalize(int chunk);
+
+  // Executes the three phases of the algorithm.
+  Status RunPhases();
+
+  std::shared_ptr<CollectiveContext> col_ctx_;
+  const CollectiveParams* col_params_;  // Not owned
+  int num_tasks_;
+  int num_devices_per_task_;
+  int task_;        // Task index of this device.
+  int local_rank_;  // Index of this device within its task.
+  std::unique_ptr<CollectiveAdapter> ca_;
+  std::vector<Tensor> chunks_;  // Aliases of the chunks of the output.
+  Tensor group_size_tensor_;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_REDUCER_H_
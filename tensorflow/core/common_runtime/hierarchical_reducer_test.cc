@@ -0,0 +1,193 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/hierarchical_reducer.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/common_runtime/collective_test_util.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/version.h"
+
+namespace tensorflow {
+namespace {
+
+std::unique_ptr<OpKernel> GetKernel(const string& op, DataType dtype,
+                                    const DeviceType& device_type,
+                                    DeviceBase* device) {
+  NodeDef node_def;
+  NodeDefBuilder builder("binary_node", op);
+  TF_CHECK_OK(builder.Attr("T", dtype)
+                  .Input(FakeInput(dtype))
+                  .Input(FakeInput(dtype))
+                  .Finalize(&node_def));
+  Status status;
+  std::unique_ptr<OpKernel> k = CreateOpKernel(
+      device_type, device, device->GetAllocator(AllocatorAttributes()),
+      node_def, TF_GRAPH_DEF_VERSION, &status);
+  TF_CHECK_OK(status);
+  return k;
+}
+
+class HierarchicalReducerTest : public ::testing::Test {
+ protected:
+  class DeviceInstance {
+   public:
+    DeviceInstance(int rank, DataType dtype, const TensorShape& shape,
+                   CollectiveTestEnv* test_env)
+        : test_env_(test_env), tensor_(dtype, shape) {
+      col_params_ =
+          CreateCollectiveParams(*test_env_, rank, "HierarchicalReduce",
+                                 REDUCTION_COLLECTIVE, dtype, shape);
+      col_params_->group.same_num_devices_per_task = true;
+      string dev_name = col_params_->group.members[rank].device.name();
+      TF_CHECK_OK(test_env_->device_mgr->LookupDevice(dev_name, &device_))
+          << "Couldn't find device " << dev_name
+          << " existing devices: " << test_env_->device_mgr->DebugString();
+      merge_op_ = GetKernel("Add", dtype, test_env_->device_type, device_);
+      final_op_ = GetKernel("Div", dtype, test_env_->device_type, device_);
+      col_params_->merge_op = merge_op_.get();
+      col_params_->final_op = final_op_.get();
+    }
+
+    void DoReduce() {
+      status_ = RunCollective(test_env_, col_params_.get(), device_, &tensor_,
+                              &tensor_);
+    }
+
+    CollectiveTestEnv* test_env_;
+    Tensor tensor_;
+    Device* device_;
+    core::RefCountPtr<CollectiveParams> col_params_;
+    std::unique_ptr<OpKernel> merge_op_;
+    std::unique_ptr<OpKernel> final_op_;
+    Status status_;
+  };
+
+  template <typename T>
+  void RunTest(DataType dtype, int num_workers, int num_devices,
+               int tensor_len, int fail_after) {
+    test_env_ = CreateCollectiveTestEnv(num_workers, num_devices, DEVICE_CPU);
+    test_env_->remote_access->set_fail_after(fail_after);
+    std::vector<T> expected(tensor_len);
+    for (int rank = 0; rank < num_workers * num_devices; ++rank) {
+      instances_.push_back(absl::make_unique<DeviceInstance>(
+          rank, dtype, TensorShape({tensor_len}), test_env_.get()));
+      Tensor* t = &instances_.back()->tensor_;
+      for (int i = 0; i < tensor_len; ++i) {
+        T value = static_cast<T>(rank * 10 + i);
+        t->flat<T>()(i) = value;
+        expected[i] += value;
+      }
+    }
+
+    std::atomic<int> done(0);
+    for (auto& instance : instances_) {
+      SchedClosure([&instance, &done] {
+        instance->DoReduce();
+        ++done;
+      });
+    }
+    while (done < static_cast<int>(instances_.size())) {
+      Env::Default()->SleepForMicroseconds(1000);
+    }
+
+    if (fail_after > 0) {
+      for (auto& instance : instances_) {
+        EXPECT_NE(instance->status_.error_message().find("Deliberate failure"),
+                  string::npos)
+            << instance->status_;
+      }
+      return;
+    }
+    for (int i = 0; i < tensor_len; ++i) {
+      expected[i] /= static_cast<T>(num_workers * num_devices);
+    }
+    for (auto& instance : instances_) {
+      TF_EXPECT_OK(instance->status_);
+      test::ExpectTensorEqual<T>(test::AsTensor<T>(expected),
+                                 instance->tensor_);
+    }
+  }
+
+  std::unique_ptr<CollectiveTestEnv> test_env_;
+  std::vector<std::unique_ptr<DeviceInstance>> instances_;
+};
+
+TEST_F(HierarchicalReducerTest, TwoTasksTwoDevices) {
+  RunTest<float>(DT_FLOAT, /*num_workers=*/2, /*num_devices=*/2,
+                 /*tensor_len=*/16, /*fail_after=*/0);
+}
+
+TEST_F(HierarchicalReducerTest, ThreeTasksTwoDevices) {
+  RunTest<float>(DT_FLOAT, /*num_workers=*/3, /*num_devices=*/2,
+                 /*tensor_len=*/1001, /*fail_after=*/0);
+}
+
+TEST_F(HierarchicalReducerTest, TwoTasksFourDevicesInt64) {
+  RunTest<int64_t>(DT_INT64, /*num_workers=*/2, /*num_devices=*/4,
+                   /*tensor_len=*/37, /*fail_after=*/0);
+}
+
+TEST_F(HierarchicalReducerTest, OneDevicePerTask) {
+  RunTest<double>(DT_DOUBLE, /*num_workers=*/4, /*num_devices=*/1,
+                  /*tensor_len=*/9, /*fail_after=*/0);
+}
+
+TEST_F(HierarchicalReducerTest, SingleTask) {
+  RunTest<float>(DT_FLOAT, /*num_workers=*/1, /*num_devices=*/4,
+                 /*tensor_len=*/100, /*fail_after=*/0);
+}
+
+TEST_F(HierarchicalReducerTest, FewerElementsThanChunks) {
+  RunTest<float>(DT_FLOAT, /*num_workers=*/2, /*num_devices=*/3,
+                 /*tensor_len=*/2, /*fail_after=*/0);
+}
+
+TEST_F(HierarchicalReducerTest, Failure) {
+  RunTest<float>(DT_FLOAT, /*num_workers=*/2, /*num_devices=*/2,
+                 /*tensor_len=*/16, /*fail_after=*/3);
+}
+
+TEST(HierarchicalReducerInitParamsTest, RejectsUnevenTasks) {
+  auto test_env = CreateCollectiveTestEnv(/*num_workers=*/2,
+                                          /*num_devices_per_worker=*/2,
+                                          DEVICE_CPU);
+  auto cp = CreateCollectiveParams(*test_env, /*rank=*/0, "HierarchicalReduce",
+                                   REDUCTION_COLLECTIVE, DT_FLOAT,
+                                   TensorShape({4}));
+  cp->group.same_num_devices_per_task = false;
+  core::RefCountPtr<HierarchicalReducer> reducer(new HierarchicalReducer());
+  EXPECT_TRUE(
+      errors::IsInvalidArgument(reducer->InitializeCollectiveParams(cp.get())));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/immutable_executor_state.h"
 
 #include "absl/memory/memory.h"
+#include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/node_def_util.h"
@@ -254,6 +255,28 @@ Status ImmutableExecutorState::Initialize(const Graph& graph) {
       NodeItem* dst_item = gview_.node(dst_id);
       e.input_slot += dst_item->input_start;
     }
+
+    // Record the outputs that are fetched through a `_Retval` node, so that
+    // they can be written directly into caller-allocated buffers (see
+    // `CallFrameInterface::GetPreallocatedRetval()`). This is only safe if
+    // every node runs at most once per step, and if the outputs live in host
+    // memory.
+    if (!requires_control_flow_ &&
+        params_.device->device_type() == DEVICE_CPU) {
+      for (const Edge* e : n->out_edges()) {
+        if (e->IsControlEdge() || !e->dst()->IsRetval()) continue;
+        int index;
+        TF_RETURN_IF_ERROR(GetNodeAttr(e->dst()->attrs(), "index", &index));
+        if (!item->output_retvals) {
+          item->output_retvals.reset(new int[n->num_outputs()]);
+          std::fill(&item->output_retvals[0],
+                    &item->output_retvals[n->num_outputs()], -1);
+        }
+        if (item->output_retvals[e->src_output()] == -1) {
+          item->output_retvals[e->src_output()] = index;
+        }
+      }
+    }
   }
 
   // Initialize PendingCounts only after pending_ids_[node.id] is initialized
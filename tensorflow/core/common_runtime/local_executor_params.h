@@ -21,6 +21,7 @@ limitations under the License.
 
 namespace tensorflow {
 
+class CostModel;
 class Device;
 class StepStatsCollector;
 class SessionMetadata;
@@ -50,6 +51,12 @@ struct LocalExecutorParams {
 
   // Whether control flow nodes are allowed to be executed synchronously.
   bool allow_control_flow_sync_execution = false;
+
+  // If not null, the per-node time estimates in this cost model (which must
+  // have been collected for the graph passed to the executor) are used to
+  // seed the executor's online cost estimates, which decide whether a ready
+  // node is run inline or dispatched to the inter-op thread pool. Not owned.
+  const CostModel* cost_model = nullptr;
 };
 
 }  // end namespace tensorflow
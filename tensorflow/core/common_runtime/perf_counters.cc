@@ -0,0 +1,136 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/perf_counters.h"
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cstring>
+#endif
+
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace {
+
+#if defined(__linux__)
+
+// The events of a group are read together, in the order they were opened.
+constexpr uint64_t kEvents[] = {
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES,
+};
+constexpr int kNumEvents = sizeof(kEvents) / sizeof(kEvents[0]);
+
+int OpenEvent(uint64_t config, int group_fd) {
+  perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.size = sizeof(attr);
+  attr.config = config;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_GROUP;
+  // Counts the calling thread on any CPU.
+  return syscall(__NR_perf_event_open, &attr, /*pid=*/0, /*cpu=*/-1, group_fd,
+                 /*flags=*/0);
+}
+
+// The counters of one thread, opened on first use.
+class ThreadCounters {
+ public:
+  ThreadCounters() {
+    for (int i = 0; i < kNumEvents; ++i) {
+      fds_[i] = OpenEvent(kEvents[i], i == 0 ? -1 : fds_[0]);
+      if (fds_[i] < 0) {
+        Close();
+        return;
+      }
+    }
+  }
+  ~ThreadCounters() { Close(); }
+
+  bool Read(PerfCounterValues* values) const {
+    if (fds_[0] < 0) return false;
+    struct {
+      uint64_t nr;
+      uint64_t values[kNumEvents];
+    } data;
+    if (read(fds_[0], &data, sizeof(data)) != sizeof(data) ||
+        data.nr != kNumEvents) {
+      return false;
+    }
+    values->cpu_cycles = data.values[0];
+    values->instructions = data.values[1];
+    values->cache_misses = data.values[2];
+    return true;
+  }
+
+ private:
+  void Close() {
+    for (int i = kNumEvents - 1; i >= 0; --i) {
+      if (fds_[i] >= 0) close(fds_[i]);
+      fds_[i] = -1;
+    }
+  }
+
+  int fds_[kNumEvents] = {-1, -1, -1};
+};
+
+bool ReadThreadCounters(PerfCounterValues* values) {
+  static thread_local ThreadCounters counters;
+  return counters.Read(values);
+}
+
+#else
+
+bool ReadThreadCounters(PerfCounterValues* values) { return false; }
+
+#endif
+
+}  // namespace
+
+bool PerfCounters::Enabled() {
+  static const bool enabled = []() {
+    bool requested;
+    Status s = ReadBoolFromEnvVar("TF_COLLECT_PERF_COUNTERS",
+                                  /*default_val=*/false, &requested);
+    if (!s.ok()) {
+      LOG(ERROR) << s;
+      return false;
+    }
+    if (!requested) return false;
+    PerfCounterValues values;
+    if (!ReadThreadCounters(&values)) {
+      LOG(WARNING) << "Not collecting CPU performance counters: they are not "
+                      "available on this platform or not permitted (see "
+                      "/proc/sys/kernel/perf_event_paranoid).";
+      return false;
+    }
+    return true;
+  }();
+  return enabled;
+}
+
+bool PerfCounters::Read(PerfCounterValues* values) {
+  return ReadThreadCounters(values);
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,49 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_PERF_COUNTERS_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_PERF_COUNTERS_H_
+
+#include <cstdint>
+
+namespace tensorflow {
+
+// Values of the CPU hardware counters of a thread.
+struct PerfCounterValues {
+  int64_t cpu_cycles = 0;
+  int64_t instructions = 0;
+  int64_t cache_misses = 0;
+};
+
+// Reads the user-space CPU hardware counters of the calling thread, through
+// perf_event_open on Linux. The counters of a thread are opened the first
+// time they are read on it and stay open for the lifetime of the thread.
+//
+// Collection is opt-in: set TF_COLLECT_PERF_COUNTERS=1 to record the counters
+// of every kernel in the step stats of traced steps.
+class PerfCounters {
+ public:
+  // Returns whether collection is requested and supported by the kernel
+  // (perf_event_paranoid may forbid it).
+  static bool Enabled();
+
+  // Reads the counters of the calling thread. Returns false if they are not
+  // available.
+  static bool Read(PerfCounterValues* values);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_PERF_COUNTERS_H_
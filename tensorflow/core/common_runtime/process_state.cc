@@ -22,6 +22,7 @@ limitations under the License.
 #include "absl/base/call_once.h"
 #include "tensorflow/core/common_runtime/bfc_allocator.h"
 #include "tensorflow/core/common_runtime/pool_allocator.h"
+#include "tensorflow/core/common_runtime/sharded_bfc_allocator.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/log_memory.h"
 #include "tensorflow/core/framework/tracking_allocator.h"
@@ -101,11 +102,27 @@ Allocator* ProcessState::GetCPUAllocator(int numa_node) {
       int64_t cpu_mem_limit = cpu_mem_limit_in_mb * (1LL << 20);
       DCHECK(sub_allocator);
 
+      // A per-thread cache for small allocations avoids contention on the
+      // allocator's lock when many threads allocate concurrently.
+      int64_t thread_cache_in_mb = 0;
+      status = ReadInt64FromEnvVar("TF_CPU_BFC_THREAD_CACHE_MB",
+                                   /*default_val=*/0, &thread_cache_in_mb);
+      if (!status.ok()) {
+        LOG(ERROR) << "GetCPUAllocator: " << status.error_message();
+      }
+
       BFCAllocator::Options allocator_opts;
       allocator_opts.allow_growth = true;
-      allocator = new BFCAllocator(
-          absl::WrapUnique(sub_allocator), cpu_mem_limit,
-          /*name=*/"bfc_cpu_allocator_for_gpu", allocator_opts);
+      if (thread_cache_in_mb > 0) {
+        allocator = new ShardedBFCAllocator(
+            absl::WrapUnique(sub_allocator), cpu_mem_limit,
+            /*name=*/"bfc_cpu_allocator_for_gpu", allocator_opts,
+            /*cache_bytes=*/thread_cache_in_mb * (1LL << 20));
+      } else {
+        allocator = new BFCAllocator(
+            absl::WrapUnique(sub_allocator), cpu_mem_limit,
+            /*name=*/"bfc_cpu_allocator_for_gpu", allocator_opts);
+      }
 
       VLOG(2) << "Using BFCAllocator with memory limit of "
               << cpu_mem_limit_in_mb << " MB for ProcessState CPU allocator";
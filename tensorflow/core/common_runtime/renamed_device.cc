@@ -27,7 +27,9 @@ namespace tensorflow {
 std::unique_ptr<Device> RenamedDevice::NewRenamedDevice(
     const string& new_base, Device* underlying, bool owns_underlying,
     bool isolate_session_state,
-    thread::ThreadPoolInterface* underlying_threadpool) {
+    thread::ThreadPoolInterface* underlying_threadpool,
+    Allocator* step_allocator, Allocator* device_step_allocator,
+    DeviceContext* device_context) {
   DeviceNameUtils::ParsedName parsed_name;
   CHECK(DeviceNameUtils::ParseFullName(new_base, &parsed_name));
   DeviceNameUtils::ParsedName underlying_parsed_name =
@@ -44,18 +46,34 @@ std::unique_ptr<Device> RenamedDevice::NewRenamedDevice(
   // Call absl::WrapUnique to access private constructor.
   return absl::WrapUnique(
       new RenamedDevice(underlying, attributes, owns_underlying,
-                        isolate_session_state, underlying_threadpool));
+                        isolate_session_state, underlying_threadpool,
+                        step_allocator, device_step_allocator,
+                        device_context));
 }
 
 RenamedDevice::RenamedDevice(Device* underlying,
                              const DeviceAttributes& attributes,
                              bool owns_underlying_device,
                              bool isolate_session_state,
-                             thread::ThreadPoolInterface* underlying_threadpool)
+                             thread::ThreadPoolInterface* underlying_threadpool,
+                             Allocator* step_allocator,
+                             Allocator* device_step_allocator,
+                             DeviceContext* device_context)
     : Device(underlying->env(), attributes),
       underlying_device_(underlying),
       owns_underlying_device_(owns_underlying_device),
-      isolate_session_state_(isolate_session_state) {
+      isolate_session_state_(isolate_session_state),
+      step_allocator_(step_allocator),
+      device_step_allocator_(device_step_allocator),
+      device_context_(device_context) {
+  const DeviceBase::AcceleratorDeviceInfo* info =
+      underlying->tensorflow_gpu_device_info();
+  if (device_context != nullptr && info != nullptr) {
+    accelerator_device_info_ =
+        absl::make_unique<DeviceBase::AcceleratorDeviceInfo>(*info);
+    accelerator_device_info_->stream = device_context->stream();
+    accelerator_device_info_->default_context = device_context;
+  }
   if (underlying_threadpool != nullptr) {
     underlying_threadpool_.reset(new thread::ThreadPool(underlying_threadpool));
     eigen_worker_threads_.workers = underlying_threadpool_.get();
@@ -27,12 +27,24 @@ namespace tensorflow {
 // This class is used to wrap local devices when using clusterspec propagation
 // where the name of a particular device may change in the context of a given
 // session.
+//
+// If `step_allocator` is not null, allocations that do not require
+// device- or NIC-compatible memory are served by `step_allocator` instead of
+// the allocator of the underlying device. If `device_step_allocator` is not
+// null, allocations of device memory are served by it.
+//
+// If `device_context` is not null, kernels use it instead of the context of
+// the underlying device, and the stream of an accelerator device is that of
+// `device_context`.
 class RenamedDevice : public Device {
  public:
   static std::unique_ptr<Device> NewRenamedDevice(
       const string& new_base, Device* underlying, bool owns_underlying,
       bool isolate_session_state,
-      thread::ThreadPoolInterface* underlying_threadpool = nullptr);
+      thread::ThreadPoolInterface* underlying_threadpool = nullptr,
+      Allocator* step_allocator = nullptr,
+      Allocator* device_step_allocator = nullptr,
+      DeviceContext* device_context = nullptr);
 
   ~RenamedDevice() override;
 
@@ -52,10 +64,20 @@ class RenamedDevice : public Device {
 
   const DeviceBase::AcceleratorDeviceInfo* tensorflow_gpu_device_info()
       const override {
+    if (device_context_ != nullptr) {
+      return accelerator_device_info_.get();
+    }
     return underlying_device_->tensorflow_gpu_device_info();
   }
 
   Allocator* GetAllocator(AllocatorAttributes attr) override {
+    if (device_step_allocator_ != nullptr && !attr.on_host()) {
+      return device_step_allocator_;
+    }
+    if (step_allocator_ != nullptr && !attr.gpu_compatible() &&
+        !attr.nic_compatible()) {
+      return step_allocator_;
+    }
     return underlying_device_->GetAllocator(attr);
   }
 
@@ -136,6 +158,11 @@ class RenamedDevice : public Device {
   }
 
   Status TryGetDeviceContext(DeviceContext** out_context) override {
+    if (device_context_ != nullptr) {
+      device_context_->Ref();
+      *out_context = device_context_;
+      return Status::OK();
+    }
     return underlying_device_->TryGetDeviceContext(out_context);
   }
 
@@ -157,10 +184,19 @@ class RenamedDevice : public Device {
  private:
   RenamedDevice(Device* underlying, const DeviceAttributes& attributes,
                 bool owns_underlying, bool isolate_session_state,
-                thread::ThreadPoolInterface* underlying_threadpool);
+                thread::ThreadPoolInterface* underlying_threadpool,
+                Allocator* step_allocator, Allocator* device_step_allocator,
+                DeviceContext* device_context);
   Device* const underlying_device_;
   const bool owns_underlying_device_;
   const bool isolate_session_state_;
+  Allocator* const step_allocator_;         // Not owned.
+  Allocator* const device_step_allocator_;  // Not owned.
+  DeviceContext* const device_context_;     // Not owned.
+  // The accelerator device info of the underlying device, with the stream and
+  // context of `device_context_`. Null if `device_context_` is null or the
+  // underlying device is not an accelerator.
+  std::unique_ptr<DeviceBase::AcceleratorDeviceInfo> accelerator_device_info_;
 
   std::unique_ptr<thread::ThreadPool> underlying_threadpool_;
   // eigen_worker_threads_ is stored here so that we can pass the pointer
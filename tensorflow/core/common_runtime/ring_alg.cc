@@ -358,6 +358,14 @@ void RingAlg::InitRingField(RingField* rf, int chunk_idx, int subdiv_idx,
       (rf->rank == ((rf->chunk_idx + (group_size_ - 1)) % group_size_));
   if (rf->do_send || rf->do_recv) {
     rf->chunk = ca_->ChunkAlias(rf->sc_idx);
+    if (col_params_->wire_encode_op != nullptr) {
+      // The device may receive in either pass, so allocate the buffer here
+      // where a GPU device synchronizes its temporary allocations.
+      rf->wire_recv_chunk = Tensor(
+          col_ctx_->device->GetAllocator(
+              col_ctx_->op_ctx->output_alloc_attr(0)),
+          col_params_->wire_encode_op->output_type(0), rf->chunk.shape());
+    }
   }
   VLOG(2) << this << " InitRingField " << rf->DebugString() << " chunk "
           << ca_->TBounds(rf->chunk);
@@ -403,11 +411,20 @@ void RingAlg::DispatchSend(RingField* rf, const StatusCallback& done) {
   int send_to_rank = (rf->rank + 1) % group_size_;
   int send_to_dev_idx = col_params_->instance.impl_details
                             .subdiv_permutations[rf->subdiv_idx][send_to_rank];
+  const Tensor* send_tensor = &rf->chunk;
+  if (col_params_->wire_encode_op != nullptr) {
+    Status s = EncodeChunk(rf);
+    if (!s.ok()) {
+      done(s);
+      return;
+    }
+    send_tensor = &rf->wire_send_chunk;
+  }
   col_ctx_->col_exec->remote_access()->PostToPeer(
       col_params_->group.members[send_to_dev_idx].device.name(),
       col_params_->group.members[send_to_dev_idx].task, send_buf_key,
       col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
-      col_ctx_->op_ctx->output_alloc_attr(0), &rf->chunk,
+      col_ctx_->op_ctx->output_alloc_attr(0), send_tensor,
       col_ctx_->device_locality, col_ctx_->op_ctx->cancellation_manager(),
       done);
 }
@@ -423,6 +440,10 @@ void RingAlg::DispatchRecv(RingField* rf, const StatusCallback& done) {
   Tensor* dst_tensor = (!rf->second_pass && (col_params_->merge_op != nullptr))
                            ? &rf->tmp_chunk
                            : &rf->chunk;
+  if (col_params_->wire_encode_op != nullptr) {
+    // The subclass decodes the received value with DecodeChunk.
+    dst_tensor = &rf->wire_recv_chunk;
+  }
   col_ctx_->col_exec->remote_access()->RecvFromPeer(
       col_params_->group.members[rf->recv_dev_idx].device.name(),
       col_params_->group.members[rf->recv_dev_idx].task,
@@ -433,6 +454,58 @@ void RingAlg::DispatchRecv(RingField* rf, const StatusCallback& done) {
       col_ctx_->op_ctx->cancellation_manager(), done);
 }
 
+Status RingAlg::EncodeChunk(RingField* rf) {
+  TF_RETURN_IF_ERROR(collective_util::ComputeUnaryOp(
+      col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+      col_params_->wire_encode_op, &rf->chunk, &rf->wire_send_chunk));
+  if (!rf->second_pass || rf->do_recv) {
+    return Status::OK();
+  }
+  // This device computed the final value of the chunk.
+  Tensor decoded;
+  TF_RETURN_IF_ERROR(collective_util::ComputeUnaryOp(
+      col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+      col_params_->wire_decode_op, &rf->wire_send_chunk, &decoded));
+  Notification note;
+  Status status;
+  CollectiveRemoteAccessLocal::MemCpyAsync(
+      col_ctx_->op_ctx->op_device_context(),
+      col_ctx_->op_ctx->op_device_context(), col_ctx_->device,
+      col_ctx_->device, col_ctx_->op_ctx->output_alloc_attr(0),
+      col_ctx_->op_ctx->output_alloc_attr(0), &decoded, &rf->chunk,
+      0 /*dev_to_dev_stream_index*/, [&note, &status](const Status& s) {
+        status.Update(s);
+        note.Notify();
+      });
+  note.WaitForNotification();
+  return status;
+}
+
+Status RingAlg::DecodeChunk(RingField* rf, Tensor* dst) {
+  Tensor decoded;
+  TF_RETURN_IF_ERROR(collective_util::ComputeUnaryOp(
+      col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+      col_params_->wire_decode_op, &rf->wire_recv_chunk, &decoded));
+  if (dst == &rf->tmp_chunk) {
+    // The temporary chunk need not keep its buffer.
+    rf->tmp_chunk = decoded;
+    return Status::OK();
+  }
+  Notification note;
+  Status status;
+  CollectiveRemoteAccessLocal::MemCpyAsync(
+      col_ctx_->op_ctx->op_device_context(),
+      col_ctx_->op_ctx->op_device_context(), col_ctx_->device,
+      col_ctx_->device, col_ctx_->op_ctx->output_alloc_attr(0),
+      col_ctx_->op_ctx->output_alloc_attr(0), &decoded, dst,
+      0 /*dev_to_dev_stream_index*/, [&note, &status](const Status& s) {
+        status.Update(s);
+        note.Notify();
+      });
+  note.WaitForNotification();
+  return status;
+}
+
 string RingAlg::FieldState() {
   string s = strings::StrCat(
       "Ring", name_, " ", strings::Hex(reinterpret_cast<uint64>(this)),
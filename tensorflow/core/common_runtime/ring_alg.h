@@ -75,6 +75,9 @@ class RingAlg : public CollectiveImplementationInterface {
     bool is_final = false;  // is the last field in the pass for this rank
     Tensor chunk;           // alias to field values
     Tensor tmp_chunk;
+    // Encoded values sent and received, if chunks are encoded on the wire.
+    Tensor wire_send_chunk;
+    Tensor wire_recv_chunk;
     Status status;
     string DebugString() const;
   };
@@ -83,6 +86,13 @@ class RingAlg : public CollectiveImplementationInterface {
   void AdvanceToSecondPass(RingField* rf);
   void DispatchSend(RingField* rf, const StatusCallback& done);
   void DispatchRecv(RingField* rf, const StatusCallback& done);
+  // Encodes rf->chunk into rf->wire_send_chunk with the wire_encode_op.  In
+  // the second pass the device that computed the final value of the chunk
+  // also replaces it by its decoded encoding, so that every device ends up
+  // with the same value.
+  Status EncodeChunk(RingField* rf);
+  // Decodes rf->wire_recv_chunk into `dst` with the wire_decode_op.
+  Status DecodeChunk(RingField* rf, Tensor* dst);
 
   // For constructing log messages for debugging.
   string FieldState();
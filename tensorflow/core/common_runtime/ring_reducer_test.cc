@@ -79,6 +79,19 @@ std::unique_ptr<OpKernel> GetDiv(DataType dtype, const DeviceType& device_type,
   return GetKernel(node_def, device_type, device);
 }
 
+std::unique_ptr<OpKernel> GetCast(DataType src_dtype, DataType dst_dtype,
+                                  const DeviceType& device_type,
+                                  DeviceBase* device) {
+  NodeDef node_def;
+  NodeDefBuilder builder("cast_node", "Cast");
+  TF_CHECK_OK(builder.Attr("SrcT", src_dtype)
+                  .Attr("DstT", dst_dtype)
+                  .Attr("Truncate", false)
+                  .Input(FakeInput(src_dtype))
+                  .Finalize(&node_def));
+  return GetKernel(node_def, device_type, device);
+}
+
 class RingReducerTest : public ::testing::Test {
  protected:
   void Init(int num_workers, int num_devices, DataType dtype,
@@ -182,6 +195,16 @@ class RingReducerTest : public ::testing::Test {
       init_f(&tensor_);
     }
 
+    void SetWireFormat(DataType wire_dtype) {
+      const DataType dtype = col_params_->instance.data_type;
+      wire_encode_op_ =
+          GetCast(dtype, wire_dtype, test_env_->device_type, device_);
+      wire_decode_op_ =
+          GetCast(wire_dtype, dtype, test_env_->device_type, device_);
+      col_params_->wire_encode_op = wire_encode_op_.get();
+      col_params_->wire_decode_op = wire_decode_op_.get();
+    }
+
     void DoReduce() {
       status_ = RunCollective(test_env_, col_params_.get(), device_, &tensor_,
                               &tensor_);
@@ -195,9 +218,42 @@ class RingReducerTest : public ::testing::Test {
     core::RefCountPtr<CollectiveParams> col_params_;
     std::unique_ptr<OpKernel> merge_op_;
     std::unique_ptr<OpKernel> final_op_;
+    std::unique_ptr<OpKernel> wire_encode_op_;
+    std::unique_ptr<OpKernel> wire_decode_op_;
     Status status_;
   };
 
+  void RunWireFormatTest(DataType wire_dtype, int num_workers, int num_devices,
+                         int num_subdivs, int tensor_len) {
+    Init(num_workers, num_devices, DT_FLOAT, TensorShape({tensor_len}),
+         DEVICE_CPU, num_subdivs, /*fail_after=*/0);
+    std::vector<float> expected(tensor_len);
+    for (int di = 0; di < static_cast<int>(instances_.size()); ++di) {
+      instances_[di]->SetWireFormat(wire_dtype);
+      instances_[di]->InitTensor([&expected, di](Tensor* t) {
+        for (size_t i = 0; i < t->NumElements(); ++i) {
+          float value = 1.0f + 0.01f * di + 0.001f * i;
+          t->flat<float>()(i) = value;
+          expected[i] += value;
+        }
+      });
+    }
+    Reduce(/*fail_after=*/0);
+    for (int i = 0; i < tensor_len; ++i) {
+      expected[i] /= static_cast<float>(num_workers * num_devices);
+    }
+    // The values lose precision on the wire, but every device ends up with
+    // the same ones.
+    const double rtol = wire_dtype == DT_BFLOAT16 ? 0.05 : 0.01;
+    for (int di = 0; di < static_cast<int>(instances_.size()); ++di) {
+      TF_EXPECT_OK(instances_[di]->status_);
+      test::ExpectClose(test::AsTensor<float>(expected),
+                        instances_[di]->tensor(), /*atol=*/0.0, rtol);
+      test::ExpectTensorEqual<float>(instances_[0]->tensor(),
+                                     instances_[di]->tensor());
+    }
+  }
+
   std::unique_ptr<CollectiveTestEnv> test_env_;
   std::vector<std::unique_ptr<DeviceInstance>> instances_;
   mutex mu_;
@@ -428,6 +484,16 @@ DEF_TEST(INT64, CPU, 2, 8, 3, 4095, 0)
 DEF_TEST(FLOAT, CPU, 2, 8, 1, 9408, 1)
 DEF_TEST(FLOAT, CPU, 2, 8, 1, 9408, 7)
 DEF_TEST(FLOAT, CPU, 2, 8, 2, 9408, 11)
+
+TEST_F(RingReducerTest, WireFormatBfloat16) {
+  RunWireFormatTest(DT_BFLOAT16, /*num_workers=*/2, /*num_devices=*/4,
+                    /*num_subdivs=*/1, /*tensor_len=*/1001);
+}
+
+TEST_F(RingReducerTest, WireFormatHalfSubdivs) {
+  RunWireFormatTest(DT_HALF, /*num_workers=*/2, /*num_devices=*/4,
+                    /*num_subdivs=*/2, /*tensor_len=*/4095);
+}
 #endif
 
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
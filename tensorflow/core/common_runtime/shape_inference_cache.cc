@@ -0,0 +1,201 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/shape_inference_cache.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/hash.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+
+using shape_inference::InferenceContext;
+using shape_inference::ShapeHandle;
+
+ShapeInferenceCache* ShapeInferenceCache::Global() {
+  static ShapeInferenceCache* cache = []() -> ShapeInferenceCache* {
+    int64_t capacity;
+    Status s =
+        ReadInt64FromEnvVar("TF_SHAPE_INFERENCE_CACHE_SIZE", 0, &capacity);
+    if (!s.ok()) {
+      LOG(ERROR) << s;
+      return nullptr;
+    }
+    if (capacity <= 0) return nullptr;
+    VLOG(1) << "Caching up to " << capacity << " shape inference results";
+    return new ShapeInferenceCache(capacity);
+  }();
+  return cache;
+}
+
+ShapeInferenceCache::ShapeInferenceCache(int64_t capacity)
+    : capacity_(capacity) {
+  DCHECK_GT(capacity_, 0);
+}
+
+Status ShapeInferenceCache::Run(const std::string& op, const AttrSlice& attrs,
+                                int graph_def_version,
+                                const OpShapeInferenceFn& shape_fn,
+                                InferenceContext* c) {
+  Key key;
+  if (!MakeKey(op, attrs, graph_def_version, c, &key)) {
+    return c->Run(shape_fn);
+  }
+
+  std::vector<TensorShape> outputs;
+  bool found = false;
+  {
+    mutex_lock l(mu_);
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+      entries_.splice(entries_.begin(), entries_, it->second);
+      outputs = it->second->second;
+      found = true;
+      ++hits_;
+    } else {
+      ++misses_;
+    }
+  }
+  if (found && outputs.size() == c->num_outputs()) {
+    for (int i = 0; i < outputs.size(); ++i) {
+      ShapeHandle shape;
+      TF_RETURN_IF_ERROR(c->MakeShapeFromTensorShape(outputs[i], &shape));
+      c->set_output(i, shape);
+    }
+    return Status::OK();
+  }
+
+  TF_RETURN_IF_ERROR(c->Run(shape_fn));
+  if (!IsCacheable(c)) return Status::OK();
+
+  outputs.clear();
+  outputs.reserve(c->num_outputs());
+  for (int i = 0; i < c->num_outputs(); ++i) {
+    TensorShape shape;
+    ShapeHandle handle = c->output(i);
+    for (int d = 0; d < c->Rank(handle); ++d) {
+      TF_RETURN_IF_ERROR(
+          shape.AddDimWithStatus(c->Value(c->Dim(handle, d))));
+    }
+    outputs.push_back(std::move(shape));
+  }
+
+  mutex_lock l(mu_);
+  auto it = index_.find(key);
+  if (it != index_.end()) {
+    it->second->second = std::move(outputs);
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return Status::OK();
+  }
+  entries_.emplace_front(key, std::move(outputs));
+  index_.emplace(std::move(key), entries_.begin());
+  while (entries_.size() > capacity_) {
+    index_.erase(entries_.back().first);
+    entries_.pop_back();
+  }
+  return Status::OK();
+}
+
+int64_t ShapeInferenceCache::size() const {
+  mutex_lock l(mu_);
+  return entries_.size();
+}
+
+int64_t ShapeInferenceCache::hits() const {
+  mutex_lock l(mu_);
+  return hits_;
+}
+
+int64_t ShapeInferenceCache::misses() const {
+  mutex_lock l(mu_);
+  return misses_;
+}
+
+bool ShapeInferenceCache::MakeKey(const std::string& op,
+                                  const AttrSlice& attrs,
+                                  int graph_def_version, InferenceContext* c,
+                                  Key* key) {
+  key->input_dims.clear();
+  for (int i = 0; i < c->num_inputs(); ++i) {
+    ShapeHandle input = c->input(i);
+    if (!c->FullyDefined(input) ||
+        c->input_handle_shapes_and_types(i) != nullptr) {
+      return false;
+    }
+    const int32_t rank = c->Rank(input);
+    key->input_dims.push_back(rank);
+    for (int d = 0; d < rank; ++d) {
+      key->input_dims.push_back(c->Value(c->Dim(input, d)));
+    }
+  }
+
+  // The attr map is unordered, so combine the per-attr hashes in an order
+  // independent way. The attrs themselves are compared on lookup, since
+  // different attrs may have the same hash.
+  key->attrs.clear();
+  uint64 attrs_hash = 0;
+  for (const auto& attr : attrs) {
+    key->attrs.emplace_back(attr.first, attr.second);
+    attrs_hash = Hash64CombineUnordered(
+        attrs_hash,
+        Hash64Combine(Hash64(attr.first), FastAttrValueHash(attr.second)));
+  }
+  std::sort(key->attrs.begin(), key->attrs.end(),
+            [](const std::pair<std::string, AttrValue>& a,
+               const std::pair<std::string, AttrValue>& b) {
+              return a.first < b.first;
+            });
+  key->op = op;
+  key->attrs_hash = attrs_hash;
+  key->graph_def_version = graph_def_version;
+  return true;
+}
+
+bool ShapeInferenceCache::Key::operator==(const Key& other) const {
+  if (attrs_hash != other.attrs_hash ||
+      graph_def_version != other.graph_def_version || op != other.op ||
+      input_dims != other.input_dims || attrs.size() != other.attrs.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < attrs.size(); ++i) {
+    if (attrs[i].first != other.attrs[i].first ||
+        !AreAttrValuesEqual(attrs[i].second, other.attrs[i].second)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool ShapeInferenceCache::IsCacheable(InferenceContext* c) {
+  for (int i = 0; i < c->num_inputs(); ++i) {
+    if (c->requested_input_tensor(i) ||
+        c->requested_input_tensor_as_partial_shape(i)) {
+      return false;
+    }
+  }
+  for (int i = 0; i < c->num_outputs(); ++i) {
+    if (!c->FullyDefined(c->output(i)) ||
+        c->output_handle_shapes_and_types(i) != nullptr) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace tensorflow
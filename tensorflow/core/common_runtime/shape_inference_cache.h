@@ -0,0 +1,116 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_SHAPE_INFERENCE_CACHE_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_SHAPE_INFERENCE_CACHE_H_
+
+#include <list>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/op_def_builder.h"
+#include "tensorflow/core/framework/shape_inference.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/lib/gtl/inlined_vector.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// A bounded LRU cache of shape function results.
+//
+// Instantiating the same function many times, or running the same eager op
+// over and over, runs the same shape functions on the same input shapes. This
+// cache memoizes the output shapes, keyed by the op, its attrs, the graph def
+// version and the input shapes.
+//
+// Only results that are fully determined by that key are cached: all inputs
+// and outputs must be fully defined and carry no handle data, and the shape
+// function must not have asked for the value of an input tensor. Anything
+// else, including shape function errors, is simply not memoized.
+class ShapeInferenceCache {
+ public:
+  // Returns the process-wide cache, or nullptr when caching is disabled. The
+  // capacity, in entries, is read once from TF_SHAPE_INFERENCE_CACHE_SIZE and
+  // defaults to 0 (disabled).
+  static ShapeInferenceCache* Global();
+
+  explicit ShapeInferenceCache(int64_t capacity);
+
+  ShapeInferenceCache(const ShapeInferenceCache&) = delete;
+  void operator=(const ShapeInferenceCache&) = delete;
+
+  // Sets the outputs of `c` to the memoized result for (`op`, `attrs`,
+  // `graph_def_version`, inputs of `c`) if there is one. Otherwise runs
+  // `shape_fn` on `c` and memoizes the outputs if they are cacheable.
+  Status Run(const std::string& op, const AttrSlice& attrs,
+             int graph_def_version, const OpShapeInferenceFn& shape_fn,
+             shape_inference::InferenceContext* c);
+
+  int64_t size() const;
+  int64_t hits() const;
+  int64_t misses() const;
+
+ private:
+  struct Key {
+    std::string op;
+    // The attrs sorted by name, and an order independent hash of them.
+    std::vector<std::pair<std::string, AttrValue>> attrs;
+    uint64 attrs_hash;
+    int graph_def_version;
+    // The rank of each input followed by its dimensions.
+    gtl::InlinedVector<int64_t, 8> input_dims;
+
+    bool operator==(const Key& other) const;
+
+    template <typename H>
+    friend H AbslHashValue(H h, const Key& key) {
+      return H::combine(std::move(h), key.op, key.attrs_hash,
+                        key.graph_def_version, key.input_dims);
+    }
+  };
+
+  using Entry = std::pair<Key, std::vector<TensorShape>>;
+
+  // Fills `key` from the op, its attrs and the inputs of `c`. Returns false if
+  // the inputs are not cacheable.
+  static bool MakeKey(const std::string& op, const AttrSlice& attrs,
+                      int graph_def_version,
+                      shape_inference::InferenceContext* c, Key* key);
+
+  // Returns true if the result of the last shape function run on `c` only
+  // depends on the input shapes.
+  static bool IsCacheable(shape_inference::InferenceContext* c);
+
+  const int64_t capacity_;
+
+  mutable mutex mu_;
+  // Most recently used entries first.
+  std::list<Entry> entries_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<Key, std::list<Entry>::iterator> index_
+      TF_GUARDED_BY(mu_);
+  int64_t hits_ TF_GUARDED_BY(mu_) = 0;
+  int64_t misses_ TF_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_SHAPE_INFERENCE_CACHE_H_
@@ -0,0 +1,137 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/shape_inference_cache.h"
+
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/op_def_builder.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+using shape_inference::InferenceContext;
+using shape_inference::ShapeHandle;
+
+constexpr int kVersion = 0;
+
+OpDef MakeOpDef() {
+  OpRegistrationData op_reg_data;
+  TF_CHECK_OK(OpDefBuilder("CacheTestOp")
+                  .Input("input: float")
+                  .Output("output: float")
+                  .Attr("scale: int")
+                  .Finalize(&op_reg_data));
+  return op_reg_data.op_def;
+}
+
+NodeDef MakeNodeDef(int scale) {
+  NodeDef def;
+  def.set_name("n");
+  def.set_op("CacheTestOp");
+  def.add_input("x");
+  (*def.mutable_attr())["scale"].set_i(scale);
+  return def;
+}
+
+class ShapeInferenceCacheTest : public ::testing::Test {
+ protected:
+  ShapeInferenceCacheTest()
+      : op_def_(MakeOpDef()),
+        // Multiplies the first dimension of the input by "scale".
+        shape_fn_([this](InferenceContext* c) {
+          ++num_runs_;
+          int64_t scale;
+          TF_RETURN_IF_ERROR(c->GetAttr("scale", &scale));
+          ShapeHandle input = c->input(0);
+          if (!c->RankKnown(input) || c->Rank(input) == 0) {
+            // Scalars are treated as values, so the result depends on them.
+            c->input_tensor(0);
+            c->set_output(0, c->UnknownShape());
+            return Status::OK();
+          }
+          shape_inference::DimensionHandle dim;
+          TF_RETURN_IF_ERROR(c->Multiply(c->Dim(input, 0), scale, &dim));
+          ShapeHandle out;
+          TF_RETURN_IF_ERROR(c->ReplaceDim(input, 0, dim, &out));
+          c->set_output(0, out);
+          return Status::OK();
+        }) {}
+
+  // Runs the shape function through `cache` and returns the output shape.
+  std::string Run(ShapeInferenceCache* cache, int scale,
+                  const PartialTensorShape& input) {
+    NodeDef def = MakeNodeDef(scale);
+    InferenceContext c(kVersion, def, op_def_, {input}, {}, {}, {});
+    TF_CHECK_OK(c.construction_status());
+    TF_CHECK_OK(cache->Run(def.op(), AttrSlice(def), kVersion, shape_fn_, &c));
+    return c.DebugString(c.output(0));
+  }
+
+  OpDef op_def_;
+  int num_runs_ = 0;
+  OpShapeInferenceFn shape_fn_;
+};
+
+TEST_F(ShapeInferenceCacheTest, MemoizesFullyDefinedShapes) {
+  ShapeInferenceCache cache(/*capacity=*/4);
+  EXPECT_EQ("[6,3]", Run(&cache, 2, PartialTensorShape({3, 3})));
+  EXPECT_EQ(1, num_runs_);
+  EXPECT_EQ("[6,3]", Run(&cache, 2, PartialTensorShape({3, 3})));
+  EXPECT_EQ(1, num_runs_);
+  EXPECT_EQ(1, cache.hits());
+
+  // Different attrs and different input shapes are different entries.
+  EXPECT_EQ("[9,3]", Run(&cache, 3, PartialTensorShape({3, 3})));
+  EXPECT_EQ("[8,3]", Run(&cache, 2, PartialTensorShape({4, 3})));
+  EXPECT_EQ(3, num_runs_);
+  EXPECT_EQ(3, cache.size());
+}
+
+TEST_F(ShapeInferenceCacheTest, SkipsPartialShapes) {
+  ShapeInferenceCache cache(/*capacity=*/4);
+  EXPECT_EQ("[?,3]", Run(&cache, 2, PartialTensorShape({-1, 3})));
+  EXPECT_EQ("[?,3]", Run(&cache, 2, PartialTensorShape({-1, 3})));
+  EXPECT_EQ(2, num_runs_);
+  EXPECT_EQ(0, cache.size());
+}
+
+TEST_F(ShapeInferenceCacheTest, SkipsShapeFnsReadingInputTensors) {
+  ShapeInferenceCache cache(/*capacity=*/4);
+  // The shape fn reads the input tensor, so its result could change once the
+  // value is known.
+  EXPECT_EQ("?", Run(&cache, 2, PartialTensorShape({})));
+  EXPECT_EQ(0, cache.size());
+}
+
+TEST_F(ShapeInferenceCacheTest, EvictsLeastRecentlyUsed) {
+  ShapeInferenceCache cache(/*capacity=*/2);
+  Run(&cache, 1, PartialTensorShape({1}));
+  Run(&cache, 1, PartialTensorShape({2}));
+  // Touch {1} so that {2} is evicted next.
+  Run(&cache, 1, PartialTensorShape({1}));
+  Run(&cache, 1, PartialTensorShape({3}));
+  EXPECT_EQ(2, cache.size());
+  EXPECT_EQ(3, num_runs_);
+
+  Run(&cache, 1, PartialTensorShape({1}));
+  EXPECT_EQ(3, num_runs_);
+  Run(&cache, 1, PartialTensorShape({2}));
+  EXPECT_EQ(4, num_runs_);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/eval_const_tensor.h"
 #include "tensorflow/core/common_runtime/function_utils.h"
 #include "tensorflow/core/common_runtime/graph_constructor.h"
+#include "tensorflow/core/common_runtime/shape_inference_cache.h"
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/common_shape_fns.h"
 #include "tensorflow/core/framework/node_def.pb.h"
@@ -712,7 +713,15 @@ Status ShapeRefiner::RunShapeFn(const Node* node,
     }
 
     if (op_reg_data->shape_inference_fn) {
-      TF_RETURN_IF_ERROR(c->Run(op_reg_data->shape_inference_fn));
+      ShapeInferenceCache* cache = ShapeInferenceCache::Global();
+      if (cache != nullptr) {
+        TF_RETURN_IF_ERROR(cache->Run(node->type_string(),
+                                      AttrSlice(node->def()),
+                                      graph_def_version_,
+                                      op_reg_data->shape_inference_fn, c));
+      } else {
+        TF_RETURN_IF_ERROR(c->Run(op_reg_data->shape_inference_fn));
+      }
     } else {
       TF_RETURN_IF_ERROR(c->Run(shape_inference::UnknownShape));
     }
@@ -0,0 +1,396 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/sharded_bfc_allocator.h"
+
+#include <algorithm>
+#include <array>
+
+#include "tensorflow/core/lib/core/bits.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+constexpr size_t ShardedBFCAllocator::kPageSize;
+constexpr size_t ShardedBFCAllocator::kMinCachedSize;
+constexpr size_t ShardedBFCAllocator::kMaxCachedSize;
+constexpr int ShardedBFCAllocator::kNumSizeClasses;
+
+namespace {
+
+constexpr int kMinCachedSizeBits = 8;
+
+size_t RoundedCacheBytes(size_t cache_bytes) {
+  return (cache_bytes + ShardedBFCAllocator::kPageSize - 1) /
+         ShardedBFCAllocator::kPageSize * ShardedBFCAllocator::kPageSize;
+}
+
+uint64 NewAllocatorId() {
+  static std::atomic<uint64> next_id(1);
+  return next_id.fetch_add(1, std::memory_order_relaxed);
+}
+
+}  // namespace
+
+// The blocks of a thread-owned cache. `free_blocks` is only accessed by the
+// thread that owns the shard, while `returned_blocks` receives the blocks
+// that other threads free.
+struct alignas(64) ShardedBFCAllocator::Shard {
+  struct FreeBlock {
+    FreeBlock* next;
+  };
+
+  Shard() {
+    for (int i = 0; i < kNumSizeClasses; ++i) {
+      free_blocks[i] = nullptr;
+      returned_blocks[i].store(nullptr, std::memory_order_relaxed);
+    }
+  }
+
+  int index = 0;
+  std::atomic<bool> owned{false};
+  FreeBlock* free_blocks[kNumSizeClasses];
+
+  // Statistics. `bytes_in_use` is also decremented by threads that free
+  // blocks to a shard they do not own; the others are only updated by the
+  // owner.
+  std::atomic<int64_t> num_allocs{0};
+  std::atomic<int64_t> bytes_in_use{0};
+  std::atomic<int64_t> peak_bytes_in_use{0};
+  std::atomic<int64_t> largest_alloc_size{0};
+
+  // Lock-free stacks of blocks freed by other threads. Blocks are pushed one at
+  // a time, and the owner pops all of them at once, so the stacks are not
+  // subject to the ABA problem.
+  alignas(64) std::atomic<FreeBlock*> returned_blocks[kNumSizeClasses];
+};
+
+// The shards of an allocator. Threads keep a weak reference to the set, so
+// that a thread that exits after the allocator was destroyed does not try to
+// release its shard.
+class ShardedBFCAllocator::ShardSet {
+ public:
+  explicit ShardSet(int num_shards)
+      : num_shards_(num_shards), shards_(new Shard[num_shards]) {
+    for (int i = 0; i < num_shards; ++i) {
+      shards_[i].index = i;
+    }
+  }
+
+  int num_shards() const { return num_shards_; }
+  Shard* shard(int i) { return &shards_[i]; }
+
+  // Claims an unowned shard, or returns nullptr if every shard is owned.
+  Shard* Claim() {
+    for (int i = 0; i < num_shards_; ++i) {
+      bool expected = false;
+      if (!shards_[i].owned.load(std::memory_order_relaxed) &&
+          shards_[i].owned.compare_exchange_strong(
+              expected, true, std::memory_order_acquire)) {
+        return &shards_[i];
+      }
+    }
+    return nullptr;
+  }
+
+  static void Release(Shard* shard) {
+    shard->owned.store(false, std::memory_order_release);
+  }
+
+ private:
+  const int num_shards_;
+  std::unique_ptr<Shard[]> shards_;
+};
+
+// The shards owned by a thread, one per allocator that the thread has used
+// recently. Shards are released when the thread exits, or when the entry is
+// evicted to make room for another allocator.
+class ShardedBFCAllocator::ThreadShards {
+ public:
+  struct Entry {
+    uint64 allocator_id = 0;
+    // Null if the thread could not claim a shard.
+    Shard* shard = nullptr;
+    std::weak_ptr<ShardSet> shard_set;
+  };
+
+  ~ThreadShards() {
+    for (Entry& entry : entries_) {
+      Release(&entry);
+    }
+  }
+
+  Entry* Find(uint64 allocator_id) {
+    for (Entry& entry : entries_) {
+      if (entry.allocator_id == allocator_id) return &entry;
+    }
+    return nullptr;
+  }
+
+  void Insert(uint64 allocator_id, std::weak_ptr<ShardSet> shard_set,
+              Shard* shard) {
+    Entry* victim = nullptr;
+    for (Entry& entry : entries_) {
+      if (entry.allocator_id == 0 || entry.shard_set.expired()) {
+        victim = &entry;
+        break;
+      }
+    }
+    if (victim == nullptr) {
+      victim = &entries_[next_victim_];
+      next_victim_ = (next_victim_ + 1) % entries_.size();
+    }
+    Release(victim);
+    victim->allocator_id = allocator_id;
+    victim->shard = shard;
+    victim->shard_set = std::move(shard_set);
+  }
+
+ private:
+  static void Release(Entry* entry) {
+    if (entry->shard != nullptr && entry->shard_set.lock() != nullptr) {
+      ShardSet::Release(entry->shard);
+    }
+    entry->allocator_id = 0;
+    entry->shard = nullptr;
+    entry->shard_set.reset();
+  }
+
+  std::array<Entry, 4> entries_;
+  int next_victim_ = 0;
+};
+
+ShardedBFCAllocator::ShardedBFCAllocator(
+    std::unique_ptr<SubAllocator> sub_allocator, size_t total_memory,
+    const string& name, const Options& opts, size_t cache_bytes,
+    int num_shards)
+    : ShardedBFCAllocator(sub_allocator.get(), std::move(sub_allocator),
+                          total_memory, name, opts, cache_bytes, num_shards) {}
+
+ShardedBFCAllocator::ShardedBFCAllocator(
+    SubAllocator* sub_allocator_ptr,
+    std::unique_ptr<SubAllocator>&& sub_allocator, size_t total_memory,
+    const string& name, const Options& opts, size_t cache_bytes,
+    int num_shards)
+    : BFCAllocator(std::move(sub_allocator),
+                   total_memory - std::min(total_memory,
+                                           RoundedCacheBytes(cache_bytes)),
+                   name, opts),
+      cache_sub_allocator_(sub_allocator_ptr),
+      id_(NewAllocatorId()) {
+  cache_bytes = RoundedCacheBytes(std::min(cache_bytes, total_memory));
+  if (num_shards <= 0) {
+    num_shards = 2 * port::MaxParallelism();
+  }
+  shards_ = std::make_shared<ShardSet>(num_shards);
+  if (cache_bytes == 0) return;
+
+  size_t bytes_received;
+  void* ptr = cache_sub_allocator_->Alloc(kMinCachedSize, cache_bytes,
+                                    &bytes_received);
+  if (ptr == nullptr) {
+    LOG(WARNING) << "Failed to allocate a thread cache of "
+                 << strings::HumanReadableNumBytes(cache_bytes) << " for "
+                 << name << "; all allocations will be served by the BFC "
+                 << "allocator.";
+    return;
+  }
+  cache_base_ = static_cast<char*>(ptr);
+  // Only whole pages of the region are used, but the region is returned to
+  // the sub-allocator with its full size.
+  cache_bytes_ = bytes_received;
+  pages_.resize(cache_bytes / kPageSize);
+  requested_sizes_.reset(new uint32[cache_bytes >> kMinCachedSizeBits]);
+  VLOG(1) << "Created thread cache of "
+          << strings::HumanReadableNumBytes(cache_bytes) << " with "
+          << num_shards << " shards for " << name;
+}
+
+ShardedBFCAllocator::~ShardedBFCAllocator() {
+  if (cache_base_ != nullptr) {
+    cache_sub_allocator_->Free(cache_base_, cache_bytes_);
+  }
+}
+
+int ShardedBFCAllocator::SizeClassFor(size_t num_bytes) {
+  return std::max(0, Log2Ceiling64(num_bytes) - kMinCachedSizeBits);
+}
+
+ShardedBFCAllocator::Shard* ShardedBFCAllocator::ShardForCurrentThread(
+    bool claim) {
+  static thread_local ThreadShards thread_shards;
+  ThreadShards::Entry* entry = thread_shards.Find(id_);
+  if (entry != nullptr) return entry->shard;
+  if (!claim) return nullptr;
+  Shard* shard = shards_->Claim();
+  thread_shards.Insert(id_, shards_, shard);
+  return shard;
+}
+
+bool ShardedBFCAllocator::AddPage(Shard* shard, int size_class) {
+  const int64_t num_pages = pages_.size();
+  if (next_page_.load(std::memory_order_relaxed) >= num_pages) {
+    return false;
+  }
+  const int64_t page = next_page_.fetch_add(1, std::memory_order_relaxed);
+  if (page >= num_pages) return false;
+  pages_[page].shard = shard->index;
+  pages_[page].size_class = size_class;
+
+  // Thread the blocks of the page onto the free list in address order.
+  const size_t block_size = SizeOfClass(size_class);
+  char* begin = cache_base_ + page * kPageSize;
+  Shard::FreeBlock* head = shard->free_blocks[size_class];
+  for (size_t offset = kPageSize; offset >= block_size; offset -= block_size) {
+    auto* block =
+        reinterpret_cast<Shard::FreeBlock*>(begin + offset - block_size);
+    block->next = head;
+    head = block;
+  }
+  shard->free_blocks[size_class] = head;
+  return true;
+}
+
+void* ShardedBFCAllocator::AllocateFromShard(Shard* shard, int size_class,
+                                             size_t num_bytes) {
+  Shard::FreeBlock*& head = shard->free_blocks[size_class];
+  if (head == nullptr) {
+    head = shard->returned_blocks[size_class].exchange(
+        nullptr, std::memory_order_acquire);
+    if (head == nullptr && !AddPage(shard, size_class)) {
+      return nullptr;
+    }
+  }
+  Shard::FreeBlock* block = head;
+  head = block->next;
+
+  const size_t offset = reinterpret_cast<char*>(block) - cache_base_;
+  requested_sizes_[offset >> kMinCachedSizeBits] = num_bytes;
+
+  const int64_t block_size = SizeOfClass(size_class);
+  shard->num_allocs.fetch_add(1, std::memory_order_relaxed);
+  const int64_t bytes_in_use =
+      shard->bytes_in_use.fetch_add(block_size, std::memory_order_relaxed) +
+      block_size;
+  if (bytes_in_use > shard->peak_bytes_in_use.load(std::memory_order_relaxed)) {
+    shard->peak_bytes_in_use.store(bytes_in_use, std::memory_order_relaxed);
+  }
+  if (block_size > shard->largest_alloc_size.load(std::memory_order_relaxed)) {
+    shard->largest_alloc_size.store(block_size, std::memory_order_relaxed);
+  }
+  return block;
+}
+
+void* ShardedBFCAllocator::AllocateRaw(
+    size_t alignment, size_t num_bytes,
+    const AllocationAttributes& allocation_attr) {
+  if (cache_base_ != nullptr && num_bytes > 0 && num_bytes <= kMaxCachedSize &&
+      alignment <= kMinCachedSize && allocation_attr.freed_by_func == nullptr) {
+    Shard* shard = ShardForCurrentThread(/*claim=*/true);
+    if (shard != nullptr) {
+      void* ptr = AllocateFromShard(shard, SizeClassFor(num_bytes), num_bytes);
+      if (ptr != nullptr) return ptr;
+    }
+  }
+  return BFCAllocator::AllocateRaw(alignment, num_bytes, allocation_attr);
+}
+
+void ShardedBFCAllocator::DeallocateToShard(void* ptr) {
+  const size_t offset = static_cast<char*>(ptr) - cache_base_;
+  const PageInfo& page = pages_[offset / kPageSize];
+  Shard* home = shards_->shard(page.shard);
+  home->bytes_in_use.fetch_sub(SizeOfClass(page.size_class),
+                               std::memory_order_relaxed);
+
+  auto* block = static_cast<Shard::FreeBlock*>(ptr);
+  if (ShardForCurrentThread(/*claim=*/false) == home) {
+    block->next = home->free_blocks[page.size_class];
+    home->free_blocks[page.size_class] = block;
+    return;
+  }
+  std::atomic<Shard::FreeBlock*>& returned =
+      home->returned_blocks[page.size_class];
+  block->next = returned.load(std::memory_order_relaxed);
+  while (!returned.compare_exchange_weak(block->next, block,
+                                         std::memory_order_release,
+                                         std::memory_order_relaxed)) {
+  }
+}
+
+void ShardedBFCAllocator::DeallocateRaw(void* ptr) {
+  if (ptr == nullptr) return;
+  if (InCache(ptr)) {
+    DeallocateToShard(ptr);
+    return;
+  }
+  BFCAllocator::DeallocateRaw(ptr);
+}
+
+size_t ShardedBFCAllocator::RequestedSize(const void* ptr) const {
+  if (InCache(ptr)) {
+    const size_t offset = static_cast<const char*>(ptr) - cache_base_;
+    return requested_sizes_[offset >> kMinCachedSizeBits];
+  }
+  return BFCAllocator::RequestedSize(ptr);
+}
+
+size_t ShardedBFCAllocator::AllocatedSize(const void* ptr) const {
+  if (InCache(ptr)) {
+    const size_t offset = static_cast<const char*>(ptr) - cache_base_;
+    return SizeOfClass(pages_[offset / kPageSize].size_class);
+  }
+  return BFCAllocator::AllocatedSize(ptr);
+}
+
+int64_t ShardedBFCAllocator::AllocationId(const void* ptr) const {
+  if (InCache(ptr)) return 0;
+  return BFCAllocator::AllocationId(ptr);
+}
+
+absl::optional<AllocatorStats> ShardedBFCAllocator::GetStats() {
+  absl::optional<AllocatorStats> stats = BFCAllocator::GetStats();
+  if (!stats.has_value() || cache_base_ == nullptr) return stats;
+  for (int i = 0; i < shards_->num_shards(); ++i) {
+    const Shard* shard = shards_->shard(i);
+    stats->num_allocs += shard->num_allocs.load(std::memory_order_relaxed);
+    stats->bytes_in_use += shard->bytes_in_use.load(std::memory_order_relaxed);
+    stats->peak_bytes_in_use +=
+        shard->peak_bytes_in_use.load(std::memory_order_relaxed);
+    stats->largest_alloc_size =
+        std::max<int64_t>(stats->largest_alloc_size,
+                          shard->largest_alloc_size.load(
+                              std::memory_order_relaxed));
+  }
+  if (stats->bytes_limit.has_value()) {
+    stats->bytes_limit = *stats->bytes_limit + cache_bytes_;
+  }
+  return stats;
+}
+
+bool ShardedBFCAllocator::ClearStats() {
+  if (!BFCAllocator::ClearStats()) return false;
+  for (int i = 0; i < shards_->num_shards(); ++i) {
+    Shard* shard = shards_->shard(i);
+    shard->num_allocs.store(0, std::memory_order_relaxed);
+    shard->peak_bytes_in_use.store(
+        shard->bytes_in_use.load(std::memory_order_relaxed),
+        std::memory_order_relaxed);
+    shard->largest_alloc_size.store(0, std::memory_order_relaxed);
+  }
+  return true;
+}
+
+}  // namespace tensorflow
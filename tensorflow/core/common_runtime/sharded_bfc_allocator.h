@@ -0,0 +1,159 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_SHARDED_BFC_ALLOCATOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_SHARDED_BFC_ALLOCATOR_H_
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/bfc_allocator.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// A BFCAllocator with a per-thread cache for small allocations.
+//
+// Allocations of up to `kMaxCachedSize` bytes are served from a separate
+// region of `cache_bytes` bytes, obtained from the sub-allocator when the
+// allocator is created. The region is divided into pages of `kPageSize`
+// bytes, and each page is carved into blocks of a single size class (a power
+// of two between 256 bytes and `kMaxCachedSize`).
+//
+// The allocator holds `num_shards` shards (by default, twice the number of
+// schedulable CPUs). The first time a thread allocates from this allocator, it
+// claims exclusive ownership of an unclaimed shard until the thread exits.
+// Pages are assigned to a shard when the shard runs out of free blocks of a
+// size class, and the blocks of a page always return to that shard:
+//
+// * Allocation pops a block from the calling thread's shard without any
+//   synchronization, and only takes a new page (with a single atomic
+//   increment) when the free list of the size class is empty.
+// * A block freed by the thread that owns its shard is pushed back on the
+//   owner's free list without any synchronization.
+// * A block freed by any other thread is pushed onto a lock-free return stack
+//   of the block's shard, which the owner drains when its free list runs dry.
+//
+// Larger allocations, allocations by threads that could not claim a shard,
+// allocations that require more than 256-byte alignment or a timestamp, and
+// allocations that do not fit once the region is exhausted are all served by
+// the underlying BFCAllocator under its lock.
+//
+// `GetStats()` reports the sum of the BFC statistics and the statistics of
+// the blocks that are in use in the cache. Because the per-shard peaks are
+// tracked independently, `peak_bytes_in_use` is an upper bound of the
+// combined peak. `RecordMemoryMap()` describes the BFC regions only, and does
+// not include the cache region.
+class ShardedBFCAllocator : public BFCAllocator {
+ public:
+  static constexpr size_t kPageSize = 64 << 10;
+  static constexpr size_t kMinCachedSize = 256;
+  static constexpr size_t kMaxCachedSize = 16 << 10;
+
+  // `total_memory` includes the `cache_bytes` reserved for the cache, which
+  // are rounded up to a multiple of `kPageSize`. If `num_shards` is 0, a
+  // default based on the number of schedulable CPUs is used.
+  ShardedBFCAllocator(std::unique_ptr<SubAllocator> sub_allocator,
+                      size_t total_memory, const string& name,
+                      const Options& opts, size_t cache_bytes,
+                      int num_shards = 0);
+
+  ~ShardedBFCAllocator() override;
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    return AllocateRaw(alignment, num_bytes, AllocationAttributes());
+  }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes,
+                    const AllocationAttributes& allocation_attr) override;
+
+  void DeallocateRaw(void* ptr) override;
+
+  size_t RequestedSize(const void* ptr) const override;
+
+  size_t AllocatedSize(const void* ptr) const override;
+
+  // Returns 0 for allocations that were served from the cache.
+  int64_t AllocationId(const void* ptr) const override;
+
+  absl::optional<AllocatorStats> GetStats() override;
+
+  bool ClearStats() override;
+
+  // Returns the size of the cache region in bytes, or 0 if the region could
+  // not be allocated.
+  size_t cache_bytes() const { return cache_bytes_; }
+
+  // Returns true if `ptr` was served from the cache region.
+  bool InCache(const void* ptr) const {
+    const char* p = static_cast<const char*>(ptr);
+    return p >= cache_base_ && p < cache_base_ + cache_bytes_;
+  }
+
+ private:
+  struct Shard;
+  class ShardSet;
+  class ThreadShards;
+
+  static constexpr int kNumSizeClasses = 7;
+
+  // The size class and owning shard of a page in the cache region.
+  struct PageInfo {
+    int shard = -1;
+    int size_class = -1;
+  };
+
+  ShardedBFCAllocator(SubAllocator* sub_allocator_ptr,
+                      std::unique_ptr<SubAllocator>&& sub_allocator,
+                      size_t total_memory, const string& name,
+                      const Options& opts, size_t cache_bytes, int num_shards);
+
+  static int SizeClassFor(size_t num_bytes);
+  static size_t SizeOfClass(int size_class) {
+    return kMinCachedSize << size_class;
+  }
+
+  // Returns the shard owned by the calling thread, claiming one if the thread
+  // has not tried to do so yet. Returns nullptr if all shards are owned.
+  Shard* ShardForCurrentThread(bool claim);
+
+  void* AllocateFromShard(Shard* shard, int size_class, size_t num_bytes);
+  void DeallocateToShard(void* ptr);
+
+  // Assigns a new page of `size_class` blocks to `shard`. Returns false if the
+  // cache region is exhausted.
+  bool AddPage(Shard* shard, int size_class);
+
+  SubAllocator* const cache_sub_allocator_;  // Owned by BFCAllocator.
+  const uint64 id_;
+  char* cache_base_ = nullptr;
+  size_t cache_bytes_ = 0;
+  std::vector<PageInfo> pages_;
+  std::atomic<int64_t> next_page_{0};
+  // The size requested for each minimum-sized granule of the cache region
+  // that starts a block.
+  std::unique_ptr<uint32[]> requested_sizes_;
+  std::shared_ptr<ShardSet> shards_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ShardedBFCAllocator);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_SHARDED_BFC_ALLOCATOR_H_
@@ -0,0 +1,225 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/sharded_bfc_allocator.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/core/common_runtime/pool_allocator.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/numa.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/platform/threadpool.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr size_t kAlignment = Allocator::kAllocatorAlignment;
+
+std::unique_ptr<ShardedBFCAllocator> NewAllocator(size_t cache_bytes,
+                                                  int num_shards = 0) {
+  BFCAllocator::Options opts;
+  opts.allow_growth = true;
+  return absl::make_unique<ShardedBFCAllocator>(
+      absl::make_unique<BasicCPUAllocator>(port::kNUMANoAffinity,
+                                           std::vector<SubAllocator::Visitor>(),
+                                           std::vector<SubAllocator::Visitor>()),
+      /*total_memory=*/1 << 30, "sharded_bfc", opts, cache_bytes, num_shards);
+}
+
+TEST(ShardedBFCAllocatorTest, SmallAllocationsAreCached) {
+  auto a = NewAllocator(1 << 20);
+  ASSERT_EQ(1 << 20, a->cache_bytes());
+
+  void* small = a->AllocateRaw(kAlignment, 100);
+  void* large = a->AllocateRaw(kAlignment, 1 << 20);
+  ASSERT_NE(nullptr, small);
+  ASSERT_NE(nullptr, large);
+  EXPECT_TRUE(a->InCache(small));
+  EXPECT_FALSE(a->InCache(large));
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(small) % 256);
+
+  EXPECT_EQ(100, a->RequestedSize(small));
+  EXPECT_EQ(256, a->AllocatedSize(small));
+  EXPECT_EQ(0, a->AllocationId(small));
+  EXPECT_EQ(1 << 20, a->RequestedSize(large));
+  EXPECT_GT(a->AllocationId(large), 0);
+
+  a->DeallocateRaw(small);
+  a->DeallocateRaw(large);
+}
+
+TEST(ShardedBFCAllocatorTest, ReusesFreedBlocks) {
+  auto a = NewAllocator(1 << 20);
+  void* p1 = a->AllocateRaw(kAlignment, 1000);
+  a->DeallocateRaw(p1);
+  void* p2 = a->AllocateRaw(kAlignment, 1024);
+  EXPECT_EQ(p1, p2);
+  // A different size class is served from a different page.
+  void* p3 = a->AllocateRaw(kAlignment, 2048);
+  EXPECT_NE(p2, p3);
+  EXPECT_EQ(2048, a->AllocatedSize(p3));
+  a->DeallocateRaw(p2);
+  a->DeallocateRaw(p3);
+}
+
+TEST(ShardedBFCAllocatorTest, LargeAlignmentIsNotCached) {
+  auto a = NewAllocator(1 << 20);
+  void* p = a->AllocateRaw(512, 256);
+  EXPECT_FALSE(a->InCache(p));
+  a->DeallocateRaw(p);
+}
+
+TEST(ShardedBFCAllocatorTest, FallsBackWhenCacheIsExhausted) {
+  auto a = NewAllocator(ShardedBFCAllocator::kPageSize);
+  const size_t block_size = ShardedBFCAllocator::kMaxCachedSize;
+  std::vector<void*> ptrs;
+  for (int i = 0; i < ShardedBFCAllocator::kPageSize / block_size; ++i) {
+    ptrs.push_back(a->AllocateRaw(kAlignment, block_size));
+    EXPECT_TRUE(a->InCache(ptrs.back()));
+  }
+  ptrs.push_back(a->AllocateRaw(kAlignment, block_size));
+  EXPECT_FALSE(a->InCache(ptrs.back()));
+  // Other size classes cannot get a page either.
+  ptrs.push_back(a->AllocateRaw(kAlignment, 256));
+  EXPECT_FALSE(a->InCache(ptrs.back()));
+  for (void* p : ptrs) a->DeallocateRaw(p);
+}
+
+TEST(ShardedBFCAllocatorTest, ThreadsWithoutShardUseBFC) {
+  auto a = NewAllocator(1 << 20, /*num_shards=*/1);
+  void* p = a->AllocateRaw(kAlignment, 256);
+  EXPECT_TRUE(a->InCache(p));
+
+  void* q = nullptr;
+  {
+    thread::ThreadPool pool(Env::Default(), "test", 1);
+    pool.Schedule([&a, &q]() { q = a->AllocateRaw(kAlignment, 256); });
+  }
+  EXPECT_FALSE(a->InCache(q));
+  a->DeallocateRaw(p);
+  a->DeallocateRaw(q);
+}
+
+TEST(ShardedBFCAllocatorTest, RemoteFreesReturnToOwner) {
+  auto a = NewAllocator(1 << 20);
+  constexpr int kNumBlocks = 1000;
+  std::vector<void*> ptrs;
+  for (int i = 0; i < kNumBlocks; ++i) {
+    ptrs.push_back(a->AllocateRaw(kAlignment, 512));
+    ASSERT_TRUE(a->InCache(ptrs.back()));
+  }
+  absl::flat_hash_set<void*> freed(ptrs.begin(), ptrs.end());
+  {
+    thread::ThreadPool pool(Env::Default(), "test", 4);
+    for (int i = 0; i < kNumBlocks; ++i) {
+      pool.Schedule([&a, &ptrs, i]() { a->DeallocateRaw(ptrs[i]); });
+    }
+  }
+  // The remotely freed blocks are reused before new pages are carved.
+  for (int i = 0; i < kNumBlocks; ++i) {
+    void* p = a->AllocateRaw(kAlignment, 512);
+    EXPECT_TRUE(freed.contains(p));
+    ptrs[i] = p;
+  }
+  for (void* p : ptrs) a->DeallocateRaw(p);
+}
+
+TEST(ShardedBFCAllocatorTest, StatsIncludeCachedAllocations) {
+  auto a = NewAllocator(1 << 20);
+  void* small = a->AllocateRaw(kAlignment, 300);
+  void* large = a->AllocateRaw(kAlignment, 1 << 20);
+  absl::optional<AllocatorStats> stats = a->GetStats();
+  ASSERT_TRUE(stats.has_value());
+  EXPECT_EQ(2, stats->num_allocs);
+  EXPECT_EQ(512 + (1 << 20), stats->bytes_in_use);
+  EXPECT_EQ(1 << 20, stats->largest_alloc_size);
+  EXPECT_EQ(1 << 30, *stats->bytes_limit);
+
+  a->DeallocateRaw(small);
+  stats = a->GetStats();
+  EXPECT_EQ(1 << 20, stats->bytes_in_use);
+  EXPECT_EQ(512 + (1 << 20), stats->peak_bytes_in_use);
+
+  EXPECT_TRUE(a->ClearStats());
+  stats = a->GetStats();
+  EXPECT_EQ(0, stats->num_allocs);
+  EXPECT_EQ(1 << 20, stats->peak_bytes_in_use);
+  a->DeallocateRaw(large);
+}
+
+TEST(ShardedBFCAllocatorTest, ConcurrentAllocateAndFree) {
+  constexpr int kNumThreads = 16;
+  constexpr int kIterations = 2000;
+  auto a = NewAllocator(4 << 20, /*num_shards=*/kNumThreads);
+  // Blocks are handed between threads through `shared`, so that many of them
+  // are freed by a thread other than the one that allocated them.
+  mutex mu;
+  std::vector<std::pair<char*, size_t>> shared;
+  {
+    thread::ThreadPool pool(Env::Default(), "test", kNumThreads);
+    BlockingCounter counter(kNumThreads);
+    for (int t = 0; t < kNumThreads; ++t) {
+      pool.Schedule([&, t]() {
+        for (int i = 0; i < kIterations; ++i) {
+          const size_t size = 256 << ((t + i) % 7);
+          char* p = static_cast<char*>(a->AllocateRaw(kAlignment, size));
+          memset(p, t, size);
+          std::pair<char*, size_t> other = {nullptr, 0};
+          {
+            mutex_lock l(mu);
+            shared.emplace_back(p, size);
+            if (shared.size() > kNumThreads) {
+              std::swap(other, shared[i % shared.size()]);
+              shared[i % shared.size()] = shared.back();
+              shared.pop_back();
+            }
+          }
+          if (other.first != nullptr) {
+            const char expected = other.first[0];
+            for (size_t j = 0; j < other.second; ++j) {
+              CHECK_EQ(expected, other.first[j]);
+            }
+            a->DeallocateRaw(other.first);
+          }
+        }
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+  }
+  for (const auto& p : shared) a->DeallocateRaw(p.first);
+  EXPECT_EQ(0, a->GetStats()->bytes_in_use);
+}
+
+void BM_AllocateAndFree(::testing::benchmark::State& state) {
+  static ShardedBFCAllocator* allocator = NewAllocator(64 << 20).release();
+  const size_t size = state.range(0);
+  for (auto s : state) {
+    void* p = allocator->AllocateRaw(kAlignment, size);
+    allocator->DeallocateRaw(p);
+  }
+}
+BENCHMARK(BM_AllocateAndFree)->Arg(256)->Arg(4096)->ThreadRange(1, 64);
+
+}  // namespace
+}  // namespace tensorflow
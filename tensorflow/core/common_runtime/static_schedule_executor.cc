@@ -0,0 +1,801 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/static_schedule_executor.h"
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/memory/memory.h"
+#include "tensorflow/core/common_runtime/entry.h"
+#include "tensorflow/core/common_runtime/executor.h"
+#include "tensorflow/core/common_runtime/executor_factory.h"
+#include "tensorflow/core/common_runtime/renamed_device.h"
+#include "tensorflow/core/common_runtime/single_threaded_executor.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/gtl/inlined_vector.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+namespace {
+
+typedef gtl::InlinedVector<TensorValue, 4> TensorValueVec;
+typedef gtl::InlinedVector<AllocatorAttributes, 4> AllocatorAttributeVec;
+
+static const string& kStaticScheduleExecutor =
+    *new string("STATIC_SCHEDULE_EXECUTOR");
+
+class StaticScheduleExecutorImpl : public Executor {
+ public:
+  explicit StaticScheduleExecutorImpl(const LocalExecutorParams& params)
+      : params_(params) {}
+
+  ~StaticScheduleExecutorImpl() override {
+    for (const KernelState& kernel_state : kernels_) {
+      params_.delete_kernel(kernel_state.kernel);
+    }
+    for (const ConstTensorKernelState& kernel_state : const_tensor_kernels_) {
+      params_.delete_kernel(kernel_state.kernel);
+    }
+  }
+
+  Status Initialize(const Graph& graph);
+
+  void RunAsync(const Args& args, DoneCallback done) override;
+
+ private:
+  class RunState;
+
+  // Computes `KernelState::work_list` and `KernelState::position` for each
+  // kernel, and fills in `work_lists_`. `nodes_with_kernels[i]` is the node
+  // corresponding to `kernels_[i]`.
+  void BuildWorkLists(const std::vector<Node*>& nodes_with_kernels,
+                      const absl::flat_hash_map<Node*, size_t>& node_to_index,
+                      int max_work_lists);
+
+  // Computes the cross-work-list dependencies of each kernel.
+  void BuildCrossWorkListDependencies(
+      const std::vector<Node*>& nodes_with_kernels,
+      const absl::flat_hash_map<Node*, size_t>& node_to_index);
+
+  const LocalExecutorParams params_;
+
+  // All following members are read-only after Initialize().
+
+  // The sum of the number of inputs for each node in the graph. This determines
+  // the length of the flat `inputs` vector, which has the same layout as in
+  // the single-threaded executor.
+  size_t total_num_inputs_ = 0;
+
+  // Represents cached graph structure state for each kernel.
+  struct KernelState {
+    // The kernel object. Not owned.
+    //
+    // This pointer is managed by `params_.create_kernel()` and
+    // `params_.delete_kernel()`.
+    OpKernel* kernel;
+    bool is_async;
+
+    // These fields determine the range of elements in `inputs` that corresponds
+    // to the inputs of `kernel`.
+    size_t input_start_index;
+    size_t num_inputs;
+
+    size_t num_outputs;
+
+    // For the `j`th output of `kernel`, `output_locations[j]` contains the
+    // locations in the flat `inputs` vector to which that output must be
+    // copied.
+    std::vector<std::vector<size_t>>
+        output_locations;  // Length = `num_outputs`.
+
+    // Memory space information for each output of `kernel`.
+    std::vector<AllocatorAttributes>
+        output_alloc_attrs;  // Length = `num_outputs`.
+
+    // The work list that executes this kernel, and the position of this kernel
+    // in that list.
+    int work_list;
+    size_t position;
+
+    // The index of this kernel's pending counter in the per-step array of
+    // counters, or -1 if all predecessors of this kernel run earlier on the
+    // same work list, in which case no counter is needed.
+    int pending_index = -1;
+
+    // The indices (in `kernels_`) of successors of this kernel that run on a
+    // different work list. A successor appears once per edge.
+    std::vector<int32> cross_work_list_successors;
+  };
+  std::vector<KernelState> kernels_;
+
+  // `work_lists_[i]` contains the indices (in `kernels_`) of the kernels that
+  // the `i`th work list executes, in execution order.
+  std::vector<std::vector<int32>> work_lists_;
+
+  // The initial value of each pending counter. A counter starts at one more
+  // than the number of edges from other work lists, so that it reaches zero
+  // only once all of those predecessors have completed *and* the kernel's own
+  // work list has reached it.
+  std::vector<int32> initial_pending_counts_;
+
+  // For the `i`th argument, `arg_output_locations_[i]` contains the locations
+  // in the flat `inputs` vector to which that argument must be copied.
+  std::vector<std::vector<size_t>>
+      arg_output_locations_;  // Length = `num_args`.
+
+  // Represents cached graph structure state for each kernel that produces
+  // a single constant-valued tensor.
+  struct ConstTensorKernelState {
+    // The kernel object. Not owned.
+    OpKernel* kernel;
+
+    // The cached value of `kernel->const_tensor()`.
+    //
+    // NOTE: We keep a `Tensor` rather than a `const Tensor*` here in order to
+    // keep the reference count on the underlying buffer above 1. Otherwise, a
+    // kernel could interpret the input as a forwardable tensor, and mutate the
+    // underlying constant tensor.
+    Tensor const_tensor;
+
+    // The locations in the flat `inputs` vector to which the single output of
+    // `kernel` must be copied.
+    std::vector<size_t> output_locations;
+  };
+  std::vector<ConstTensorKernelState> const_tensor_kernels_;
+
+  // Memory space information for each input. This information is stored in the
+  // same order as the flat `inputs` vector.
+  std::vector<AllocatorAttributes>
+      input_alloc_attrs_;  // Length = `total_num_inputs_`.
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StaticScheduleExecutorImpl);
+};
+
+Status StaticScheduleExecutorImpl::Initialize(const Graph& graph) {
+  // Topologicially sort `graph` to get a sequence of OpKernels.
+  std::vector<Node*> ordered_nodes;
+  ordered_nodes.reserve(graph.num_nodes());
+  GetReversePostOrder(graph, &ordered_nodes);
+  const int ordered_nodes_size = ordered_nodes.size();
+  if (ordered_nodes_size != graph.num_nodes()) {
+    return errors::InvalidArgument("Graph had ", graph.num_nodes(),
+                                   " but reverse post-order had ",
+                                   ordered_nodes.size());
+  }
+
+  kernels_.reserve(ordered_nodes.size());
+  std::vector<Node*> nodes_with_kernels;
+  std::vector<Node*> nodes_with_const_tensor_kernels;
+  nodes_with_kernels.reserve(ordered_nodes.size());
+
+  std::map<size_t, Node*> arg_index_to_node_map;
+  absl::flat_hash_map<Node*, size_t> node_to_index_map;
+
+  // Create the kernel and input-related structures for each node in `graph`.
+  for (Node* n : ordered_nodes) {
+    TF_RETURN_IF_ERROR(ValidateOpIsSafeForSyncExecution(
+        *n, /*allow_control_flow_sync_execution=*/false));
+    if (n->IsArg()) {
+      int32_t arg_index;
+      TF_RETURN_IF_ERROR(GetNodeAttr(n->attrs(), "index", &arg_index));
+      if (arg_index < 0) {
+        return errors::InvalidArgument("Invalid argument index ", arg_index,
+                                       " in node ", n->name());
+      }
+      arg_index_to_node_map[arg_index] = n;
+      // As in the single-threaded executor, arguments are forwarded directly
+      // to the inputs of the kernels that consume them.
+      continue;
+    }
+
+    OpKernel* kernel;
+    TF_RETURN_IF_ERROR(params_.create_kernel(n->properties(), &kernel));
+
+    const Tensor* const_tensor;
+    if (n->num_outputs() == 1 && (const_tensor = kernel->const_tensor())) {
+      // Constant values are evaluated once and forwarded to their consumers
+      // at the start of every step, so they do not need a place in any work
+      // list.
+      nodes_with_const_tensor_kernels.push_back(n);
+      const_tensor_kernels_.push_back({});
+      ConstTensorKernelState& kernel_state = const_tensor_kernels_.back();
+      kernel_state.kernel = kernel;
+      kernel_state.const_tensor = *const_tensor;
+    } else {
+      const size_t kernel_index = kernels_.size();
+      kernels_.push_back({});
+      nodes_with_kernels.push_back(n);
+      KernelState& kernel_state = kernels_[kernel_index];
+      kernel_state.kernel = kernel;
+      kernel_state.is_async = kernel->AsAsync() != nullptr;
+      kernel_state.num_inputs = n->num_inputs();
+      kernel_state.num_outputs = n->num_outputs();
+      node_to_index_map[n] = kernel_index;
+      if (kernel_index == 0) {
+        kernel_state.input_start_index = 0;
+      } else {
+        const KernelState& previous_kernel_state = kernels_[kernel_index - 1];
+        kernel_state.input_start_index =
+            previous_kernel_state.input_start_index +
+            previous_kernel_state.num_inputs;
+      }
+    }
+  }
+
+  // Build the mapping from each Arg node output to the input slot for the
+  // corresponding destination node.
+  if (!arg_index_to_node_map.empty()) {
+    const size_t num_args = arg_index_to_node_map.rbegin()->first + 1;
+    arg_output_locations_.resize(num_args);
+    for (const auto& arg_index_node_pair : arg_index_to_node_map) {
+      const size_t arg_index = arg_index_node_pair.first;
+      const Node* arg_node = arg_index_node_pair.second;
+      arg_output_locations_[arg_index].reserve(arg_node->out_edges().size());
+      for (const Edge* e : arg_node->out_edges()) {
+        if (e->src_output() == Graph::kControlSlot) {
+          continue;
+        } else if (e->src_output() != 0) {
+          return errors::Internal("Invalid output index ", e->src_output(),
+                                  " from argument node ", arg_index);
+        }
+        arg_output_locations_[arg_index].push_back(
+            kernels_[node_to_index_map[e->dst()]].input_start_index +
+            e->dst_input());
+      }
+    }
+  }
+
+  // Build the mapping from each const tensor kernel to the input slot for the
+  // corresponding destination node.
+  for (size_t i = 0; i < const_tensor_kernels_.size(); ++i) {
+    Node* n = nodes_with_const_tensor_kernels[i];
+    ConstTensorKernelState& kernel_state = const_tensor_kernels_[i];
+    for (const Edge* e : n->out_edges()) {
+      if (e->src_output() == Graph::kControlSlot) {
+        continue;
+      } else if (e->src_output() != 0) {
+        return errors::Internal("Invalid output index ", e->src_output(),
+                                " from node ", n->DebugString());
+      }
+      kernel_state.output_locations.push_back(
+          kernels_[node_to_index_map[e->dst()]].input_start_index +
+          e->dst_input());
+    }
+  }
+
+  // Build the mapping from each node output to the input slot for the
+  // corresponding destination node, and compute the allocator attributes for
+  // each output.
+  for (size_t i = 0; i < kernels_.size(); ++i) {
+    Node* n = nodes_with_kernels[i];
+    KernelState& kernel_state = kernels_[i];
+    kernel_state.output_locations.resize(kernel_state.num_outputs);
+    for (const Edge* e : n->out_edges()) {
+      if (!e->IsControlEdge()) {
+        kernel_state.output_locations[e->src_output()].push_back(
+            kernels_[node_to_index_map[e->dst()]].input_start_index +
+            e->dst_input());
+      }
+    }
+
+    kernel_state.output_alloc_attrs.resize(kernel_state.num_outputs);
+    AllocatorAttributes* attrs = kernel_state.output_alloc_attrs.data();
+    OpKernel* op_kernel = kernel_state.kernel;
+    for (int out = 0; out < n->num_outputs(); out++) {
+      DCHECK_LT(out, op_kernel->output_memory_types().size());
+      bool on_host = op_kernel->output_memory_types()[out] == HOST_MEMORY;
+      if (on_host) {
+        AllocatorAttributes h;
+        h.set_on_host(on_host);
+        attrs[out].Merge(h);
+      }
+    }
+  }
+
+  if (!kernels_.empty()) {
+    const KernelState& last_kernel_state = kernels_.back();
+    total_num_inputs_ =
+        last_kernel_state.input_start_index + last_kernel_state.num_inputs;
+    input_alloc_attrs_.resize(total_num_inputs_);
+    for (size_t i = 0; i < kernels_.size(); ++i) {
+      for (size_t j = 0; j < kernels_[i].output_locations.size(); ++j) {
+        for (size_t output_location : kernels_[i].output_locations[j]) {
+          input_alloc_attrs_[output_location] =
+              kernels_[i].output_alloc_attrs[j];
+        }
+      }
+    }
+  }
+
+  BuildWorkLists(nodes_with_kernels, node_to_index_map,
+                 std::max(1, port::MaxParallelism()));
+  BuildCrossWorkListDependencies(nodes_with_kernels, node_to_index_map);
+  return Status::OK();
+}
+
+void StaticScheduleExecutorImpl::BuildWorkLists(
+    const std::vector<Node*>& nodes_with_kernels,
+    const absl::flat_hash_map<Node*, size_t>& node_to_index,
+    int max_work_lists) {
+  // Kernels are visited in topological order, and each kernel is appended to a
+  // work list. A kernel whose predecessor is currently the last kernel on some
+  // work list continues that list (preferring data edges over control edges),
+  // which keeps chains of dependent kernels on a single thread. Otherwise the
+  // kernel starts a new work list, or when `max_work_lists` lists already
+  // exist, joins the shortest list.
+  for (size_t i = 0; i < kernels_.size(); ++i) {
+    int work_list = -1;
+    for (const Edge* e : nodes_with_kernels[i]->in_edges()) {
+      auto it = node_to_index.find(e->src());
+      if (it == node_to_index.end()) continue;
+      const KernelState& src = kernels_[it->second];
+      if (work_lists_[src.work_list].back() == it->second) {
+        work_list = src.work_list;
+        if (!e->IsControlEdge()) break;
+      }
+    }
+    if (work_list < 0) {
+      if (work_lists_.size() < max_work_lists) {
+        work_list = work_lists_.size();
+        work_lists_.emplace_back();
+      } else {
+        work_list = 0;
+        for (int j = 1; j < work_lists_.size(); ++j) {
+          if (work_lists_[j].size() < work_lists_[work_list].size()) {
+            work_list = j;
+          }
+        }
+      }
+    }
+    KernelState& kernel_state = kernels_[i];
+    kernel_state.work_list = work_list;
+    kernel_state.position = work_lists_[work_list].size();
+    work_lists_[work_list].push_back(i);
+  }
+}
+
+void StaticScheduleExecutorImpl::BuildCrossWorkListDependencies(
+    const std::vector<Node*>& nodes_with_kernels,
+    const absl::flat_hash_map<Node*, size_t>& node_to_index) {
+  for (size_t i = 0; i < kernels_.size(); ++i) {
+    KernelState& kernel_state = kernels_[i];
+    int32 num_cross_work_list_edges = 0;
+    for (const Edge* e : nodes_with_kernels[i]->in_edges()) {
+      // Edges from arguments, constants, and the source node are satisfied
+      // before any work list starts.
+      auto it = node_to_index.find(e->src());
+      if (it == node_to_index.end()) continue;
+      KernelState& src = kernels_[it->second];
+      if (src.work_list == kernel_state.work_list) {
+        // Work lists execute in topological order, so `src` has completed
+        // before this kernel starts.
+        DCHECK_LT(src.position, kernel_state.position);
+        continue;
+      }
+      src.cross_work_list_successors.push_back(i);
+      ++num_cross_work_list_edges;
+    }
+    if (num_cross_work_list_edges > 0) {
+      kernel_state.pending_index = initial_pending_counts_.size();
+      initial_pending_counts_.push_back(num_cross_work_list_edges + 1);
+    }
+  }
+}
+
+// The state associated with one invocation of
+// `StaticScheduleExecutorImpl::RunAsync()`. Deletes itself, and then invokes
+// the done callback, once every work list has run to completion.
+class StaticScheduleExecutorImpl::RunState {
+ public:
+  RunState(const StaticScheduleExecutorImpl* impl, const Args& args,
+           DoneCallback done)
+      : impl_(impl),
+        rendezvous_(args.rendezvous),
+        runner_(args.runner),
+        done_(std::move(done)),
+        inputs_(impl->total_num_inputs_),
+        pending_counts_(
+            new std::atomic<int32>[impl->initial_pending_counts_.size()]),
+        num_running_work_lists_(impl->work_lists_.size()) {
+    for (size_t i = 0; i < impl->initial_pending_counts_.size(); ++i) {
+      pending_counts_[i].store(impl->initial_pending_counts_[i],
+                               std::memory_order_relaxed);
+    }
+
+    // Override intra op thread pool if requested.
+    Device* device = impl->params_.device;
+    if (args.user_intra_op_threadpool != nullptr) {
+      user_device_ = RenamedDevice::NewRenamedDevice(
+          device->name(), device, /*owns_underlying=*/false,
+          /*isolate_session_state=*/false, args.user_intra_op_threadpool);
+      device = user_device_.get();
+    }
+    device_ = device;
+
+    // Prepare the parameters that will be the same for all kernels.
+    params_.step_id = args.step_id;
+    params_.start_time_usecs = args.start_time_usecs;
+    params_.deadline = args.deadline;
+    params_.device = device;
+    params_.log_memory = false;
+    params_.rendezvous = args.rendezvous;
+    params_.session_state = args.session_state;
+    params_.session_handle = args.session_handle;
+    params_.session_metadata = impl->params_.session_metadata;
+    params_.tensor_store = args.tensor_store;
+    params_.cancellation_manager = args.cancellation_manager;
+    params_.coordination_service_agent = args.coordination_service_agent;
+    params_.call_frame = args.call_frame;
+    params_.function_library = impl->params_.function_library;
+    params_.resource_manager = device->resource_manager();
+    params_.step_container = args.step_container;
+    params_.collective_executor = args.collective_executor;
+    params_.stack_trace = args.stack_trace;
+    params_.slice_reader_cache = nullptr;
+    params_.runner = &runner_;
+    params_.run_all_kernels_inline = args.run_all_kernels_inline;
+    params_.stats_collector = nullptr;
+    params_.executor_type = &kStaticScheduleExecutor;
+    // The graph is loopless and condless.
+    params_.frame_iter = FrameAndIter(0, 0);
+    params_.is_input_dead = false;
+    params_.forward_from_array = nullptr;
+
+    device->TryGetDeviceContext(&params_.op_device_context).IgnoreError();
+  }
+
+  ~RunState() {
+    if (params_.op_device_context != nullptr) {
+      params_.op_device_context->Unref();
+    }
+  }
+
+  // Forwards the arguments and constants to their consumers, and starts every
+  // work list. The first work list runs in the calling thread.
+  void Start(const Args& args) {
+    Status s = ForwardArgsAndConstants(args);
+    if (!s.ok() || impl_->work_lists_.empty()) {
+      auto done = std::move(done_);
+      delete this;
+      done(s);
+      return;
+    }
+    for (int i = 1; i < impl_->work_lists_.size(); ++i) {
+      runner_([this, i]() { RunWorkList(i, 0, /*first_kernel_ready=*/false); });
+    }
+    RunWorkList(0, 0, /*first_kernel_ready=*/false);
+  }
+
+ private:
+  // State kept alive for executing an asynchronous kernel.
+  struct AsyncKernelState {
+    AsyncKernelState(const OpKernelContext::Params& p, int32 kernel_index,
+                     int num_outputs)
+        : saved_inputs(*p.inputs),
+          saved_input_alloc_attrs(*p.input_alloc_attrs),
+          params(p),
+          kernel_index(kernel_index),
+          ctx(ParamsButClearingEigenGPUDevice(&params), num_outputs) {
+      params.inputs = &saved_inputs;
+      params.input_alloc_attrs = &saved_input_alloc_attrs;
+    }
+
+    TensorValueVec saved_inputs;
+    AllocatorAttributeVec saved_input_alloc_attrs;
+    OpKernelContext::Params params;
+    const int32 kernel_index;
+    OpKernelContext ctx;
+
+   private:
+    OpKernelContext::Params* ParamsButClearingEigenGPUDevice(
+        OpKernelContext::Params* p) {
+      // Ensure OpKernelContext constructor will make a new eigen GPU device if
+      // necessary.
+      p->eigen_gpu_device = nullptr;  // Force allocation
+      return p;
+    }
+  };
+
+  Status ForwardArgsAndConstants(const Args& args) {
+    const auto& arg_output_locations = impl_->arg_output_locations_;
+    const size_t received_args =
+        args.call_frame ? args.call_frame->num_args() : 0;
+    if (TF_PREDICT_FALSE(arg_output_locations.size() > received_args)) {
+      return errors::InvalidArgument("Expected ", arg_output_locations.size(),
+                                     " arguments, but only received ",
+                                     received_args, ".");
+    }
+    for (size_t i = 0; i < arg_output_locations.size(); ++i) {
+      const size_t num_destinations = arg_output_locations[i].size();
+      if (num_destinations == 0) continue;
+      const Tensor* arg;
+      TF_RETURN_IF_ERROR(args.call_frame->GetArg(i, &arg));
+      for (size_t j = 0; j < num_destinations; ++j) {
+        // NOTE: Each consuming kernel gets a shallow copy of the argument,
+        // which keeps the reference count > 1 and inhibits buffer forwarding
+        // into the caller's tensor.
+        Entry& input = inputs_[arg_output_locations[i][j]];
+        input.state = Entry::State::HAS_VALUE;
+        input.val.Init(*arg);
+      }
+    }
+
+    for (const ConstTensorKernelState& kernel_state :
+         impl_->const_tensor_kernels_) {
+      for (size_t output_location : kernel_state.output_locations) {
+        Entry& input = inputs_[output_location];
+        input.state = Entry::State::HAS_CONST_TENSOR;
+        input.const_tensor = &kernel_state.const_tensor;
+      }
+    }
+    return Status::OK();
+  }
+
+  // Runs the kernels on work list `work_list`, starting at `position`, until
+  // the list completes or reaches a kernel that cannot run yet. If
+  // `first_kernel_ready` is true, the kernel at `position` is known to have
+  // all of its inputs, and its pending counter (if any) has already reached
+  // zero.
+  void RunWorkList(int work_list, size_t position, bool first_kernel_ready) {
+    const std::vector<int32>& kernel_indices = impl_->work_lists_[work_list];
+    TensorValueVec node_inputs;
+    AllocatorAttributeVec input_alloc_attrs;
+    OpKernelContext::Params params = params_;
+    params.inputs = &node_inputs;
+    params.input_alloc_attrs = &input_alloc_attrs;
+
+    for (; position < kernel_indices.size(); ++position) {
+      const int32 kernel_index = kernel_indices[position];
+      const KernelState& kernel_state = impl_->kernels_[kernel_index];
+      if (kernel_state.pending_index >= 0 && !first_kernel_ready) {
+        // Record that this work list has reached the kernel. If a predecessor
+        // on another work list is still running, that predecessor brings the
+        // counter to zero and resumes this work list from `position`.
+        if (pending_counts_[kernel_state.pending_index].fetch_sub(
+                1, std::memory_order_acq_rel) != 1) {
+          return;
+        }
+      }
+      first_kernel_ready = false;
+
+      if (aborted_.load(std::memory_order_acquire)) {
+        // Skip the kernel, but still release its successors so that every
+        // work list runs to completion.
+        ClearInputs(kernel_state);
+        ReleaseSuccessors(kernel_state);
+        continue;
+      }
+
+      PrepareInputs(kernel_state, &node_inputs, &input_alloc_attrs);
+      params.op_kernel = kernel_state.kernel;
+      params.output_attr_array = kernel_state.output_alloc_attrs.data();
+
+      if (kernel_state.is_async) {
+        // The work list continues in the kernel's done callback.
+        AsyncKernelState* state = new AsyncKernelState(
+            params, kernel_index, kernel_state.num_outputs);
+        device_->ComputeAsync(
+            kernel_state.kernel->AsAsync(), &state->ctx,
+            [this, state, work_list, position]() {
+              KernelDone(impl_->kernels_[state->kernel_index], &state->ctx);
+              delete state;
+              RunWorkList(work_list, position + 1,
+                          /*first_kernel_ready=*/false);
+            });
+        return;
+      }
+
+      OpKernelContext ctx(&params, kernel_state.num_outputs);
+      device_->Compute(kernel_state.kernel, &ctx);
+      KernelDone(kernel_state, &ctx);
+    }
+
+    if (num_running_work_lists_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      Finish();
+    }
+  }
+
+  void PrepareInputs(const KernelState& kernel_state,
+                     TensorValueVec* node_inputs,
+                     AllocatorAttributeVec* input_alloc_attrs) {
+    const size_t input_start_index = kernel_state.input_start_index;
+    const size_t num_inputs = kernel_state.num_inputs;
+    node_inputs->clear();
+    node_inputs->resize(num_inputs);
+    input_alloc_attrs->clear();
+    input_alloc_attrs->resize(num_inputs);
+    for (size_t j = 0; j < num_inputs; ++j) {
+      Entry& input = inputs_[input_start_index + j];
+      switch (input.state) {
+        case Entry::State::HAS_CONST_TENSOR:
+          // NOTE: This `const_cast` is necessary because `TensorValue` stores
+          // a non-const `Tensor*`, and relies on the `OpKernelContext`
+          // accessors making dynamic checks that prevent using an immutable
+          // tensor as a mutable tensor.
+          (*node_inputs)[j].tensor = const_cast<Tensor*>(input.const_tensor);
+          break;
+        case Entry::State::HAS_VALUE:
+          (*node_inputs)[j].tensor = input.val.get();
+          break;
+        default:
+          DCHECK(false) << "Input did not have a valid value.";
+      }
+      (*input_alloc_attrs)[j] = impl_->input_alloc_attrs_[input_start_index + j];
+    }
+  }
+
+  void ClearInputs(const KernelState& kernel_state) {
+    for (size_t j = 0; j < kernel_state.num_inputs; ++j) {
+      inputs_[kernel_state.input_start_index + j].ClearVal();
+    }
+  }
+
+  // Frees the inputs of the kernel that just ran in `ctx`, forwards its outputs
+  // to the inputs of its consumers, and releases its successors on other work
+  // lists.
+  void KernelDone(const KernelState& kernel_state, OpKernelContext* ctx) {
+    ClearInputs(kernel_state);
+    const Status& s = ctx->status();
+    if (TF_PREDICT_FALSE(!s.ok())) {
+      // Set `aborted_` before releasing any successor, so that every kernel
+      // that depends on this one observes it.
+      Abort(s);
+    } else {
+      for (size_t j = 0; j < kernel_state.num_outputs; ++j) {
+        TensorValue val = ctx->release_output(j);
+        const std::vector<size_t>& output_locations =
+            kernel_state.output_locations[j];
+        const size_t num_destinations = output_locations.size();
+        if (num_destinations > 0) {
+          for (size_t k = 0; k < num_destinations - 1; ++k) {
+            Entry& input = inputs_[output_locations[k]];
+            input.state = Entry::State::HAS_VALUE;
+            if (val.tensor != nullptr) {
+              input.val.Init(*val.tensor);
+            } else {
+              input.val.Init(Tensor(kernel_state.kernel->output_type(j)));
+            }
+          }
+          // Move `val` to the last consumer to avoid the cost of copying it.
+          Entry& input = inputs_[output_locations[num_destinations - 1]];
+          input.state = Entry::State::HAS_VALUE;
+          if (val.tensor != nullptr) {
+            input.val.Init(std::move(*val.tensor));
+          } else {
+            input.val.Init(Tensor(kernel_state.kernel->output_type(j)));
+          }
+        }
+        delete val.tensor;
+      }
+    }
+    ReleaseSuccessors(kernel_state);
+  }
+
+  // Decrements the pending counters of the successors of `kernel_state` on
+  // other work lists, and resumes the work lists whose next kernel became
+  // ready.
+  void ReleaseSuccessors(const KernelState& kernel_state) {
+    for (int32 successor : kernel_state.cross_work_list_successors) {
+      const KernelState& successor_state = impl_->kernels_[successor];
+      if (pending_counts_[successor_state.pending_index].fetch_sub(
+              1, std::memory_order_acq_rel) == 1) {
+        const int work_list = successor_state.work_list;
+        const size_t position = successor_state.position;
+        runner_([this, work_list, position]() {
+          RunWorkList(work_list, position, /*first_kernel_ready=*/true);
+        });
+      }
+    }
+  }
+
+  void Abort(const Status& s) {
+    bool first_error = false;
+    {
+      mutex_lock l(mu_);
+      if (status_.ok()) {
+        status_ = s;
+        first_error = true;
+      }
+    }
+    aborted_.store(true, std::memory_order_release);
+    if (first_error && rendezvous_ != nullptr) {
+      // Unblock any asynchronous kernels that are waiting for a tensor that
+      // will never arrive.
+      rendezvous_->StartAbort(s);
+    }
+  }
+
+  void Finish() {
+    Status status;
+    {
+      mutex_lock l(mu_);
+      status = status_;
+    }
+    auto done = std::move(done_);
+    delete this;
+    done(status);
+  }
+
+  const StaticScheduleExecutorImpl* const impl_;
+  RendezvousInterface* const rendezvous_;
+  Args::Runner runner_;
+  DoneCallback done_;
+  std::unique_ptr<Device> user_device_;
+  Device* device_;
+  OpKernelContext::Params params_;
+
+  // The inputs to each kernel, with the same layout as in the single-threaded
+  // executor. Each element is written by exactly one producer, and read by one
+  // consumer after the edge between them has been synchronized, either by
+  // program order on one work list or by a pending counter.
+  std::vector<Entry> inputs_;
+  std::unique_ptr<std::atomic<int32>[]> pending_counts_;
+  std::atomic<int> num_running_work_lists_;
+  std::atomic<bool> aborted_{false};
+
+  mutex mu_;
+  Status status_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(RunState);
+};
+
+void StaticScheduleExecutorImpl::RunAsync(const Args& args,
+                                          DoneCallback done) {
+  (new RunState(this, args, std::move(done)))->Start(args);
+}
+
+class StaticScheduleExecutorRegistrar {
+ public:
+  StaticScheduleExecutorRegistrar() {
+    ExecutorFactory::Register(kStaticScheduleExecutor, new Factory());
+  }
+
+ private:
+  class Factory : public ExecutorFactory {
+    Status NewExecutor(const LocalExecutorParams& params, const Graph& graph,
+                       std::unique_ptr<Executor>* out_executor) override {
+      Executor* ret;
+      TF_RETURN_IF_ERROR(NewStaticScheduleExecutor(params, graph, &ret));
+      out_executor->reset(ret);
+      return Status::OK();
+    }
+  };
+};
+static StaticScheduleExecutorRegistrar registrar;
+
+}  // namespace
+
+Status NewStaticScheduleExecutor(const LocalExecutorParams& params,
+                                 const Graph& graph, Executor** executor) {
+  auto impl = absl::make_unique<StaticScheduleExecutorImpl>(params);
+  TF_RETURN_IF_ERROR(impl->Initialize(graph));
+  *executor = impl.release();
+  return Status::OK();
+}
+
+}  // namespace tensorflow
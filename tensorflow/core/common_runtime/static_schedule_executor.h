@@ -0,0 +1,49 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_SCHEDULE_EXECUTOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_SCHEDULE_EXECUTOR_H_
+
+#include "tensorflow/core/common_runtime/executor.h"
+
+namespace tensorflow {
+
+// Creates a new `Executor` that executes `graph` according to a schedule that
+// is computed once, when the executor is created.
+//
+// At construction time, the kernels in `graph` are topologically sorted and
+// partitioned into a small number of work lists (at most one per available
+// core). Chains of dependent kernels are kept on the same work list, so that
+// dependencies between kernels on the same list are satisfied by program
+// order. Only edges between different work lists are tracked at run time,
+// using a per-kernel counter whose initial value is also precomputed. Each step
+// therefore runs each work list in a single closure, and pays for
+// synchronization only on the edges that cross work lists.
+//
+// The executor is registered with `ExecutorFactory` under the type
+// "STATIC_SCHEDULE_EXECUTOR".
+//
+// The static schedule executor has the same restrictions on graphs as the
+// single-threaded executor (see "./single_threaded_executor.h"): in
+// particular, it does not support reference-typed edges or low-level control
+// flow (e.g. "Switch" and "Merge" nodes, and frames), memory logging, step
+// stats collection, or allocation forwarding. Asynchronous kernels (e.g.
+// "_Recv") are supported, and suspend their work list until they complete.
+Status NewStaticScheduleExecutor(const LocalExecutorParams& params,
+                                 const Graph& graph, Executor** executor);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_SCHEDULE_EXECUTOR_H_
@@ -0,0 +1,342 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+namespace {
+
+size_t AlignTo(size_t alignment, size_t offset) {
+  return offset % alignment == 0 ? offset
+                                 : offset + (alignment - offset % alignment);
+}
+
+}  // namespace
+
+constexpr size_t StepArenaAllocator::kNotPlanned;
+
+StepArenaAllocator::StepArenaAllocator(Allocator* base, int num_recorded_steps)
+    : base_(base), num_recorded_steps_(std::max(num_recorded_steps, 1)) {}
+
+StepArenaAllocator::~StepArenaAllocator() {
+  if (slab_ != nullptr) {
+    base_->DeallocateRaw(slab_);
+  }
+}
+
+bool StepArenaAllocator::BeginStep() {
+  bool expected = false;
+  if (!step_in_progress_.compare_exchange_strong(expected, true,
+                                                 std::memory_order_acquire)) {
+    return false;
+  }
+  switch (phase_.load(std::memory_order_acquire)) {
+    case kRecording: {
+      mutex_lock l(mu_);
+      current_step_.clear();
+      clock_ = 0;
+      break;
+    }
+    case kPlanned:
+      // If a slab allocation from an earlier step is still live, its buffer
+      // state cannot be reset, so this step is served entirely by `base_`.
+      if (num_live_buffers_.load(std::memory_order_acquire) == 0) {
+        for (size_t i = 0; i < buffers_.size(); ++i) {
+          buffer_states_[i].store(kUnused, std::memory_order_relaxed);
+        }
+        next_buffer_.store(0, std::memory_order_relaxed);
+        use_slab_.store(true, std::memory_order_release);
+      }
+      break;
+    case kDisabled:
+      break;
+  }
+  return true;
+}
+
+void StepArenaAllocator::EndStep() {
+  DCHECK(step_in_progress_.load(std::memory_order_relaxed));
+  switch (phase_.load(std::memory_order_acquire)) {
+    case kRecording: {
+      mutex_lock l(mu_);
+      EndRecordedStep();
+      break;
+    }
+    case kPlanned:
+      use_slab_.store(false, std::memory_order_release);
+      break;
+    case kDisabled:
+      break;
+  }
+  step_in_progress_.store(false, std::memory_order_release);
+}
+
+void StepArenaAllocator::EndRecordedStep() {
+  if (num_steps_recorded_ == 0) {
+    recorded_ = std::move(current_step_);
+  } else {
+    if (current_step_.size() != recorded_.size()) {
+      VLOG(1) << "Disabling step arena: recorded steps made "
+              << recorded_.size() << " and " << current_step_.size()
+              << " allocations.";
+      phase_.store(kDisabled, std::memory_order_release);
+      live_records_.clear();
+      return;
+    }
+    for (size_t i = 0; i < recorded_.size(); ++i) {
+      Record& merged = recorded_[i];
+      const Record& current = current_step_[i];
+      if (merged.num_bytes != current.num_bytes) {
+        VLOG(1) << "Disabling step arena: allocation " << i
+                << " has size " << merged.num_bytes << " and "
+                << current.num_bytes << " in different steps.";
+        phase_.store(kDisabled, std::memory_order_release);
+        live_records_.clear();
+        return;
+      }
+      merged.alignment = std::max(merged.alignment, current.alignment);
+      merged.alloc_time = std::min(merged.alloc_time, current.alloc_time);
+      if (merged.free_time < 0 || current.free_time < 0) {
+        merged.free_time = -1;
+      } else {
+        merged.free_time = std::max(merged.free_time, current.free_time);
+      }
+    }
+  }
+  current_step_.clear();
+  if (++num_steps_recorded_ == num_recorded_steps_) {
+    BuildPlan();
+  }
+}
+
+void StepArenaAllocator::BuildPlan() {
+  // Allocations that are still live after this point were made by recorded
+  // steps, and are returned directly to `base_`.
+  live_records_.clear();
+
+  std::vector<int> order;
+  buffers_.resize(recorded_.size());
+  for (size_t i = 0; i < recorded_.size(); ++i) {
+    const Record& record = recorded_[i];
+    Buffer& buffer = buffers_[i];
+    buffer.num_bytes = record.num_bytes;
+    buffer.alignment =
+        std::max(record.alignment, static_cast<size_t>(kAllocatorAlignment));
+    buffer.offset = kNotPlanned;
+    if (record.free_time >= 0 && record.num_bytes > 0) {
+      order.push_back(i);
+    }
+  }
+
+  // As in `ArenaPlanner`, place the largest allocations first, breaking ties
+  // by allocation time.
+  std::sort(order.begin(), order.end(), [this](int a, int b) {
+    if (recorded_[a].num_bytes != recorded_[b].num_bytes) {
+      return recorded_[a].num_bytes > recorded_[b].num_bytes;
+    }
+    return recorded_[a].alloc_time < recorded_[b].alloc_time;
+  });
+
+  size_t max_alignment = kAllocatorAlignment;
+  // Placed buffers, ordered by offset.
+  std::vector<int> placed;
+  placed.reserve(order.size());
+  for (int i : order) {
+    const Record& record = recorded_[i];
+    Buffer& buffer = buffers_[i];
+    size_t best_offset = kNotPlanned;
+    size_t best_offset_fit = kNotPlanned;
+    size_t current_offset = 0;
+    for (int j : placed) {
+      const Record& other = recorded_[j];
+      if (other.free_time < record.alloc_time ||
+          other.alloc_time > record.free_time) {
+        // The lifetimes do not intersect, so the memory can be shared.
+        continue;
+      }
+      const size_t aligned_offset = AlignTo(buffer.alignment, current_offset);
+      if (aligned_offset + buffer.num_bytes <= buffers_[j].offset &&
+          buffers_[j].offset - aligned_offset < best_offset_fit) {
+        best_offset = aligned_offset;
+        best_offset_fit = buffers_[j].offset - aligned_offset;
+      }
+      current_offset = std::max(current_offset,
+                                buffers_[j].offset + buffers_[j].num_bytes);
+    }
+    if (best_offset == kNotPlanned) {
+      best_offset = AlignTo(buffer.alignment, current_offset);
+    }
+    buffer.offset = best_offset;
+    slab_bytes_ = std::max(slab_bytes_, best_offset + buffer.num_bytes);
+    max_alignment = std::max(max_alignment, buffer.alignment);
+    placed.insert(std::upper_bound(placed.begin(), placed.end(), i,
+                                   [this](int a, int b) {
+                                     return buffers_[a].offset <
+                                            buffers_[b].offset;
+                                   }),
+                  i);
+  }
+
+  // Record, for each buffer, the earlier buffers whose memory it shares. Since
+  // `placed` is ordered by offset, only the buffers that start before the end
+  // of a buffer need to be compared with it.
+  for (size_t a = 0; a < placed.size(); ++a) {
+    Buffer& first = buffers_[placed[a]];
+    for (size_t b = a + 1; b < placed.size(); ++b) {
+      Buffer& second = buffers_[placed[b]];
+      if (second.offset >= first.offset + first.num_bytes) break;
+      if (placed[a] < placed[b]) {
+        second.conflicts.push_back(placed[a]);
+      } else {
+        first.conflicts.push_back(placed[b]);
+      }
+    }
+    buffers_by_offset_.emplace_back(first.offset, placed[a]);
+  }
+
+  if (slab_bytes_ > 0) {
+    slab_ = static_cast<char*>(base_->AllocateRaw(max_alignment, slab_bytes_));
+  }
+  if (slab_ == nullptr) {
+    VLOG(1) << "Disabling step arena: no allocation could be planned, or "
+            << "failed to allocate a slab of " << slab_bytes_ << " bytes.";
+    slab_bytes_ = 0;
+    phase_.store(kDisabled, std::memory_order_release);
+    return;
+  }
+  buffer_states_.reset(new std::atomic<int>[buffers_.size()]);
+  for (size_t i = 0; i < buffers_.size(); ++i) {
+    buffer_states_[i].store(kUnused, std::memory_order_relaxed);
+  }
+  recorded_.clear();
+  VLOG(1) << "Planned step arena of " << slab_bytes_ << " bytes for "
+          << placed.size() << " of " << buffers_.size() << " allocations.";
+  phase_.store(kPlanned, std::memory_order_release);
+}
+
+void* StepArenaAllocator::AllocateRaw(
+    size_t alignment, size_t num_bytes,
+    const AllocationAttributes& allocation_attr) {
+  switch (phase_.load(std::memory_order_acquire)) {
+    case kPlanned:
+      return PlannedAllocation(alignment, num_bytes, allocation_attr);
+    case kRecording:
+      return RecordAllocation(alignment, num_bytes, allocation_attr);
+    default:
+      break;
+  }
+  Ref();
+  void* ptr = base_->AllocateRaw(alignment, num_bytes, allocation_attr);
+  if (ptr == nullptr) Unref();
+  return ptr;
+}
+
+void* StepArenaAllocator::RecordAllocation(
+    size_t alignment, size_t num_bytes,
+    const AllocationAttributes& allocation_attr) {
+  Ref();
+  void* ptr = base_->AllocateRaw(alignment, num_bytes, allocation_attr);
+  if (ptr == nullptr) {
+    Unref();
+    return nullptr;
+  }
+  mutex_lock l(mu_);
+  if (phase_.load(std::memory_order_relaxed) == kRecording &&
+      step_in_progress_.load(std::memory_order_relaxed)) {
+    live_records_[ptr] = {num_steps_recorded_,
+                          static_cast<int>(current_step_.size())};
+    current_step_.push_back({num_bytes, alignment, clock_++, -1});
+  }
+  return ptr;
+}
+
+void* StepArenaAllocator::PlannedAllocation(
+    size_t alignment, size_t num_bytes,
+    const AllocationAttributes& allocation_attr) {
+  if (use_slab_.load(std::memory_order_acquire)) {
+    const int index = next_buffer_.fetch_add(1, std::memory_order_relaxed);
+    if (static_cast<size_t>(index) < buffers_.size()) {
+      const Buffer& buffer = buffers_[index];
+      std::atomic<int>& state = buffer_states_[index];
+      bool can_use_slab = buffer.offset != kNotPlanned &&
+                          buffer.num_bytes == num_bytes &&
+                          buffer.alignment >= alignment;
+      for (size_t i = 0; can_use_slab && i < buffer.conflicts.size(); ++i) {
+        const int conflict_state =
+            buffer_states_[buffer.conflicts[i]].load(std::memory_order_acquire);
+        can_use_slab = conflict_state == kFreed || conflict_state == kSkipped;
+      }
+      if (can_use_slab) {
+        num_live_buffers_.fetch_add(1, std::memory_order_relaxed);
+        state.store(kLive, std::memory_order_relaxed);
+        Ref();
+        return slab_ + buffer.offset;
+      }
+      state.store(kSkipped, std::memory_order_release);
+    }
+  }
+  Ref();
+  void* ptr = base_->AllocateRaw(alignment, num_bytes, allocation_attr);
+  if (ptr == nullptr) Unref();
+  return ptr;
+}
+
+bool StepArenaAllocator::SlabContains(const void* ptr) const {
+  const char* p = static_cast<const char*>(ptr);
+  return slab_ != nullptr && p >= slab_ && p < slab_ + slab_bytes_;
+}
+
+void StepArenaAllocator::DeallocateRaw(void* ptr) {
+  if (SlabContains(ptr)) {
+    const size_t offset = static_cast<char*>(ptr) - slab_;
+    bool found = false;
+    for (auto it = std::lower_bound(
+             buffers_by_offset_.begin(), buffers_by_offset_.end(),
+             std::make_pair(offset, std::numeric_limits<int>::min()));
+         it != buffers_by_offset_.end() && it->first == offset; ++it) {
+      int expected = kLive;
+      if (buffer_states_[it->second].compare_exchange_strong(
+              expected, kFreed, std::memory_order_acq_rel)) {
+        found = true;
+        break;
+      }
+    }
+    CHECK(found) << "Deallocating a pointer that is not live in the slab.";
+    num_live_buffers_.fetch_sub(1, std::memory_order_release);
+    Unref();
+    return;
+  }
+  if (phase_.load(std::memory_order_acquire) == kRecording) {
+    mutex_lock l(mu_);
+    auto it = live_records_.find(ptr);
+    if (it != live_records_.end()) {
+      if (it->second.first == num_steps_recorded_ &&
+          step_in_progress_.load(std::memory_order_relaxed)) {
+        current_step_[it->second.second].free_time = clock_++;
+      }
+      live_records_.erase(it);
+    }
+  }
+  base_->DeallocateRaw(ptr);
+  Unref();
+}
+
+}  // namespace tensorflow
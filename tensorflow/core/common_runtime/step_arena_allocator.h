@@ -0,0 +1,184 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// An allocator that serves the allocations of a repeatedly executed step from
+// a single, pre-planned slab of memory.
+//
+// The allocator goes through two phases:
+//
+// 1. Recording. For the first `num_recorded_steps` steps, every allocation is
+//    forwarded to the `base` allocator, and the size and lifetime of each
+//    allocation is recorded. Lifetimes are measured in terms of a logical
+//    clock that ticks on every allocation and deallocation in the step.
+//
+// 2. Planned. If all recorded steps made the same sequence of allocation
+//    sizes, the allocator assigns an offset to each allocation that was freed
+//    before the end of its step, so that allocations with overlapping
+//    lifetimes never overlap in memory. Offsets are assigned greedily, from
+//    the largest allocation to the smallest, placing each allocation in the
+//    smallest gap that fits (as in TensorFlow Lite's `ArenaPlanner`). A single
+//    slab large enough for the plan is then obtained from `base`, and the
+//    i^th allocation of each subsequent step is served from its planned
+//    offset without taking any locks.
+//
+// Since the order of allocations in a step may depend on the interleaving of
+// concurrently executing kernels, the planned phase never relies on the
+// recorded order for correctness. An allocation is only served from the slab
+// if its size matches the plan, and every earlier allocation that shares
+// memory with it according to the plan has already been freed in the current
+// step. Any other allocation falls back to `base`. Allocations that escaped
+// their step during recording (e.g. fetched tensors or persistent state) are
+// always served by `base`.
+//
+// At most one step may use the arena at a time: `BeginStep()` returns false if
+// another step is in progress, in which case the caller should not route that
+// step's allocations to this allocator.
+//
+// The allocator is reference counted. Each outstanding allocation holds a
+// reference, so that the allocator (and its slab) outlive any tensor that was
+// allocated from it, even after the owner has dropped its reference.
+class StepArenaAllocator : public Allocator, public core::RefCounted {
+ public:
+  // Does not take ownership of `base`, which must outlive this allocator.
+  StepArenaAllocator(Allocator* base, int num_recorded_steps);
+
+  std::string Name() override { return base_->Name(); }
+
+  // Marks the beginning of a step that will allocate through this allocator.
+  // Returns false, and has no effect, if another step is already in progress.
+  bool BeginStep();
+
+  // Marks the end of the step started by the last successful call to
+  // `BeginStep()`. When the last recorded step ends, the allocation plan and
+  // slab are built.
+  void EndStep();
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    return AllocateRaw(alignment, num_bytes, AllocationAttributes());
+  }
+  void* AllocateRaw(size_t alignment, size_t num_bytes,
+                    const AllocationAttributes& allocation_attr) override;
+  void DeallocateRaw(void* ptr) override;
+
+  AllocatorMemoryType GetMemoryType() const override {
+    return base_->GetMemoryType();
+  }
+
+  // Returns true if the recorded steps have been planned, and subsequent steps
+  // may be served from the slab.
+  bool is_planned() const {
+    return phase_.load(std::memory_order_acquire) == kPlanned;
+  }
+
+  // Returns the size of the slab in bytes, or 0 if no plan has been built.
+  size_t slab_bytes() const { return slab_bytes_; }
+
+  // Returns true if `ptr` points into the slab.
+  bool SlabContains(const void* ptr) const;
+
+ protected:
+  ~StepArenaAllocator() override;
+
+ private:
+  enum Phase { kRecording, kPlanned, kDisabled };
+
+  // Lifetime of one allocation in a recorded step. A `free_time` of -1 means
+  // that the allocation was still live at the end of the step.
+  struct Record {
+    size_t num_bytes;
+    size_t alignment;
+    int64_t alloc_time;
+    int64_t free_time;
+  };
+
+  // A planned allocation. `conflicts` holds the indices of the earlier
+  // planned allocations that share some memory with this one.
+  struct Buffer {
+    size_t num_bytes;
+    size_t alignment;
+    size_t offset;
+    std::vector<int> conflicts;
+  };
+
+  // The per-step state of a planned buffer. Buffers in the `kUnused` state
+  // may still be claimed by the thread that is about to allocate them.
+  enum BufferState : int { kUnused, kLive, kFreed, kSkipped };
+
+  static constexpr size_t kNotPlanned = ~static_cast<size_t>(0);
+
+  void* RecordAllocation(size_t alignment, size_t num_bytes,
+                         const AllocationAttributes& allocation_attr);
+  void* PlannedAllocation(size_t alignment, size_t num_bytes,
+                          const AllocationAttributes& allocation_attr);
+  void EndRecordedStep() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void BuildPlan() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  Allocator* const base_;  // Not owned.
+  const int num_recorded_steps_;
+
+  std::atomic<int> phase_{kRecording};
+  std::atomic<bool> step_in_progress_{false};
+
+  // Recording state.
+  mutex mu_;
+  int num_steps_recorded_ TF_GUARDED_BY(mu_) = 0;
+  int64_t clock_ TF_GUARDED_BY(mu_) = 0;
+  std::vector<Record> current_step_ TF_GUARDED_BY(mu_);
+  // The union of the lifetimes of each allocation over all recorded steps.
+  std::vector<Record> recorded_ TF_GUARDED_BY(mu_);
+  // Maps live recorded allocations to their step number and index in the
+  // step.
+  absl::flat_hash_map<const void*, std::pair<int, int>> live_records_
+      TF_GUARDED_BY(mu_);
+
+  // Planned state. Immutable once `phase_` is `kPlanned`, with the exception
+  // of the per-step state in `buffer_states_`.
+  std::vector<Buffer> buffers_;
+  // Index into `buffers_`, sorted by offset, used to map a deallocated pointer
+  // back to its buffer.
+  std::vector<std::pair<size_t, int>> buffers_by_offset_;
+  char* slab_ = nullptr;
+  size_t slab_bytes_ = 0;
+  std::unique_ptr<std::atomic<int>[]> buffer_states_;
+  std::atomic<int> next_buffer_{0};
+  std::atomic<int> num_live_buffers_{0};
+  // True if the current step may allocate from the slab.
+  std::atomic<bool> use_slab_{false};
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StepArenaAllocator);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
@@ -0,0 +1,244 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
+
+#include <cstring>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/threadpool.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr size_t kAlignment = Allocator::kAllocatorAlignment;
+
+// Runs one step that allocates buffers of 256 and 512 bytes, frees the first,
+// and then allocates another buffer of 256 bytes, which can reuse the memory
+// of the first one. Returns the three pointers in `ptrs`.
+void RunStep(StepArenaAllocator* arena, std::vector<void*>* ptrs) {
+  ASSERT_TRUE(arena->BeginStep());
+  ptrs->clear();
+  void* a = arena->AllocateRaw(kAlignment, 256);
+  void* b = arena->AllocateRaw(kAlignment, 512);
+  memset(a, 1, 256);
+  memset(b, 2, 512);
+  arena->DeallocateRaw(a);
+  void* c = arena->AllocateRaw(kAlignment, 256);
+  memset(c, 3, 256);
+  arena->DeallocateRaw(b);
+  arena->DeallocateRaw(c);
+  arena->EndStep();
+  *ptrs = {a, b, c};
+}
+
+TEST(StepArenaAllocatorTest, ServesPlannedStepsFromSlab) {
+  core::RefCountPtr<StepArenaAllocator> arena(
+      new StepArenaAllocator(cpu_allocator(), 2));
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_FALSE(arena->is_planned());
+    RunStep(arena.get(), &ptrs);
+    for (void* ptr : ptrs) {
+      EXPECT_FALSE(arena->SlabContains(ptr));
+    }
+  }
+  ASSERT_TRUE(arena->is_planned());
+  // The first and last allocations have disjoint lifetimes, and share memory.
+  EXPECT_EQ(768, arena->slab_bytes());
+
+  for (int i = 0; i < 3; ++i) {
+    RunStep(arena.get(), &ptrs);
+    for (void* ptr : ptrs) {
+      EXPECT_TRUE(arena->SlabContains(ptr));
+      EXPECT_EQ(0, reinterpret_cast<uintptr_t>(ptr) % kAlignment);
+    }
+    EXPECT_EQ(ptrs[0], ptrs[2]);
+    EXPECT_NE(ptrs[0], ptrs[1]);
+  }
+}
+
+TEST(StepArenaAllocatorTest, EscapingAllocationsAreNotPlanned) {
+  core::RefCountPtr<StepArenaAllocator> arena(
+      new StepArenaAllocator(cpu_allocator(), 1));
+  ASSERT_TRUE(arena->BeginStep());
+  void* temp = arena->AllocateRaw(kAlignment, 128);
+  void* output = arena->AllocateRaw(kAlignment, 128);
+  arena->DeallocateRaw(temp);
+  arena->EndStep();
+  arena->DeallocateRaw(output);
+  ASSERT_TRUE(arena->is_planned());
+  EXPECT_EQ(128, arena->slab_bytes());
+
+  ASSERT_TRUE(arena->BeginStep());
+  temp = arena->AllocateRaw(kAlignment, 128);
+  output = arena->AllocateRaw(kAlignment, 128);
+  EXPECT_TRUE(arena->SlabContains(temp));
+  EXPECT_FALSE(arena->SlabContains(output));
+  arena->DeallocateRaw(temp);
+  arena->EndStep();
+  arena->DeallocateRaw(output);
+}
+
+TEST(StepArenaAllocatorTest, DifferentStepsDisablePlanning) {
+  core::RefCountPtr<StepArenaAllocator> arena(
+      new StepArenaAllocator(cpu_allocator(), 2));
+  for (size_t num_bytes : {64, 128}) {
+    ASSERT_TRUE(arena->BeginStep());
+    void* ptr = arena->AllocateRaw(kAlignment, num_bytes);
+    arena->DeallocateRaw(ptr);
+    arena->EndStep();
+  }
+  EXPECT_FALSE(arena->is_planned());
+  EXPECT_EQ(0, arena->slab_bytes());
+
+  ASSERT_TRUE(arena->BeginStep());
+  void* ptr = arena->AllocateRaw(kAlignment, 64);
+  EXPECT_NE(nullptr, ptr);
+  arena->DeallocateRaw(ptr);
+  arena->EndStep();
+}
+
+TEST(StepArenaAllocatorTest, MismatchedAllocationsFallBack) {
+  core::RefCountPtr<StepArenaAllocator> arena(
+      new StepArenaAllocator(cpu_allocator(), 1));
+  std::vector<void*> ptrs;
+  RunStep(arena.get(), &ptrs);
+  ASSERT_TRUE(arena->is_planned());
+
+  ASSERT_TRUE(arena->BeginStep());
+  // The first allocation has a different size than planned.
+  void* a = arena->AllocateRaw(kAlignment, 1024);
+  void* b = arena->AllocateRaw(kAlignment, 512);
+  // The third allocation shares memory with the first one, which was not
+  // served from the slab in this step.
+  void* c = arena->AllocateRaw(kAlignment, 256);
+  // There is no fourth allocation in the plan.
+  void* d = arena->AllocateRaw(kAlignment, 256);
+  EXPECT_FALSE(arena->SlabContains(a));
+  EXPECT_TRUE(arena->SlabContains(b));
+  EXPECT_TRUE(arena->SlabContains(c));
+  EXPECT_FALSE(arena->SlabContains(d));
+  for (void* ptr : {a, b, c, d}) arena->DeallocateRaw(ptr);
+  arena->EndStep();
+
+  // Steps that match the plan are served from the slab again.
+  RunStep(arena.get(), &ptrs);
+  for (void* ptr : ptrs) {
+    EXPECT_TRUE(arena->SlabContains(ptr));
+  }
+}
+
+TEST(StepArenaAllocatorTest, OverlappingLifetimesFallBack) {
+  core::RefCountPtr<StepArenaAllocator> arena(
+      new StepArenaAllocator(cpu_allocator(), 1));
+  std::vector<void*> ptrs;
+  RunStep(arena.get(), &ptrs);
+  ASSERT_TRUE(arena->is_planned());
+
+  // The first allocation is still live when the third allocation is made, so
+  // the third allocation cannot reuse its memory.
+  ASSERT_TRUE(arena->BeginStep());
+  void* a = arena->AllocateRaw(kAlignment, 256);
+  void* b = arena->AllocateRaw(kAlignment, 512);
+  void* c = arena->AllocateRaw(kAlignment, 256);
+  EXPECT_TRUE(arena->SlabContains(a));
+  EXPECT_TRUE(arena->SlabContains(b));
+  EXPECT_FALSE(arena->SlabContains(c));
+  for (void* ptr : {a, b, c}) arena->DeallocateRaw(ptr);
+  arena->EndStep();
+}
+
+TEST(StepArenaAllocatorTest, LiveSlabAllocationDisablesNextStep) {
+  core::RefCountPtr<StepArenaAllocator> arena(
+      new StepArenaAllocator(cpu_allocator(), 1));
+  std::vector<void*> ptrs;
+  RunStep(arena.get(), &ptrs);
+
+  ASSERT_TRUE(arena->BeginStep());
+  void* a = arena->AllocateRaw(kAlignment, 256);
+  EXPECT_TRUE(arena->SlabContains(a));
+  arena->EndStep();
+
+  ASSERT_TRUE(arena->BeginStep());
+  void* b = arena->AllocateRaw(kAlignment, 256);
+  EXPECT_FALSE(arena->SlabContains(b));
+  arena->DeallocateRaw(b);
+  arena->EndStep();
+
+  arena->DeallocateRaw(a);
+  RunStep(arena.get(), &ptrs);
+  EXPECT_TRUE(arena->SlabContains(ptrs[0]));
+}
+
+TEST(StepArenaAllocatorTest, OnlyOneStepAtATime) {
+  core::RefCountPtr<StepArenaAllocator> arena(
+      new StepArenaAllocator(cpu_allocator(), 1));
+  ASSERT_TRUE(arena->BeginStep());
+  EXPECT_FALSE(arena->BeginStep());
+  arena->EndStep();
+  EXPECT_TRUE(arena->BeginStep());
+  arena->EndStep();
+}
+
+TEST(StepArenaAllocatorTest, OutlivesOwner) {
+  StepArenaAllocator* arena = new StepArenaAllocator(cpu_allocator(), 1);
+  std::vector<void*> ptrs;
+  RunStep(arena, &ptrs);
+  ASSERT_TRUE(arena->BeginStep());
+  Tensor t(arena, DT_FLOAT, TensorShape({64}));
+  arena->EndStep();
+  arena->Unref();
+  // The tensor holds the last reference to the arena.
+  t.flat<float>().setConstant(1.0f);
+}
+
+TEST(StepArenaAllocatorTest, ConcurrentAllocations) {
+  constexpr int kNumThreads = 8;
+  constexpr int kAllocationsPerThread = 16;
+  core::RefCountPtr<StepArenaAllocator> arena(
+      new StepArenaAllocator(cpu_allocator(), 2));
+  thread::ThreadPool pool(Env::Default(), "test", kNumThreads);
+  for (int step = 0; step < 10; ++step) {
+    ASSERT_TRUE(arena->BeginStep());
+    {
+      BlockingCounter counter(kNumThreads);
+      for (int t = 0; t < kNumThreads; ++t) {
+        pool.Schedule([&arena, &counter, t]() {
+          for (int i = 0; i < kAllocationsPerThread; ++i) {
+            char* ptr = static_cast<char*>(arena->AllocateRaw(kAlignment, 64));
+            memset(ptr, t, 64);
+            for (int j = 0; j < 64; ++j) {
+              CHECK_EQ(ptr[j], t);
+            }
+            arena->DeallocateRaw(ptr);
+          }
+          counter.DecrementCount();
+        });
+      }
+      counter.Wait();
+    }
+    arena->EndStep();
+  }
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,89 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/step_graph.h"
+
+#include <utility>
+
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace {
+
+struct RegistrationInfo {
+  DeviceType device_type;
+  StepGraph::Factory factory;
+};
+
+std::vector<RegistrationInfo>* MutableRegistry() {
+  static std::vector<RegistrationInfo>* registry =
+      new std::vector<RegistrationInfo>;
+  return registry;
+}
+
+}  // namespace
+
+/* static */ std::unique_ptr<StepGraph> StepGraph::Create(Device* device) {
+  const DeviceType device_type(device->device_type());
+  for (const RegistrationInfo& ri : *MutableRegistry()) {
+    if (ri.device_type == device_type) {
+      return ri.factory(device);
+    }
+  }
+  return nullptr;
+}
+
+/* static */ void StepGraph::Register(const DeviceType& device_type,
+                                      Factory factory) {
+  MutableRegistry()->push_back({device_type, std::move(factory)});
+}
+
+void* RetainingAllocator::AllocateRaw(
+    size_t alignment, size_t num_bytes,
+    const AllocationAttributes& allocation_attr) {
+  void* ptr = base_->AllocateRaw(alignment, num_bytes, allocation_attr);
+  if (ptr != nullptr) Ref();
+  return ptr;
+}
+
+void RetainingAllocator::DeallocateRaw(void* ptr) {
+  {
+    mutex_lock l(mu_);
+    if (!released_) {
+      retained_.push_back(ptr);
+      return;
+    }
+  }
+  base_->DeallocateRaw(ptr);
+  Unref();
+}
+
+void RetainingAllocator::Release() {
+  std::vector<void*> retained;
+  {
+    mutex_lock l(mu_);
+    DCHECK(!released_);
+    released_ = true;
+    retained.swap(retained_);
+  }
+  VLOG(2) << "Releasing " << retained.size() << " retained allocations";
+  for (void* ptr : retained) {
+    base_->DeallocateRaw(ptr);
+    Unref();
+  }
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,133 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_STEP_GRAPH_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_STEP_GRAPH_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/device_base.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+class Device;
+
+// A graph of the work that one run of a step enqueued onto a device (e.g. a
+// CUDA graph), which later runs of the step launch at once instead of running
+// the step's kernels.
+//
+// The work is captured from a stream that only the kernels of the captured run
+// use, so that the graph holds none of the work that other steps enqueue onto
+// the device meanwhile.
+//
+// The graph refers to the memory the captured run used. The device memory
+// the kernels allocate from `allocator()` while capturing therefore stays
+// reserved for the graph, and later runs copy their inputs into, and their
+// outputs out of, the tensors of the captured run.
+class StepGraph {
+ public:
+  // Returns nullptr if `device` can't capture graphs.
+  typedef std::function<std::unique_ptr<StepGraph>(Device* device)> Factory;
+
+  virtual ~StepGraph() = default;
+
+  // Returns a graph for capturing the work of `device`, or nullptr if its
+  // device type does not support it.
+  static std::unique_ptr<StepGraph> Create(Device* device);
+
+  // Object used to call Register() at static-initialization time.
+  class Registration {
+   public:
+    Registration(const DeviceType& device_type, Factory factory) {
+      Register(device_type, std::move(factory));
+    }
+  };
+
+  static void Register(const DeviceType& device_type, Factory factory);
+
+  // The allocator of the device memory of the captured run.
+  virtual Allocator* allocator() = 0;
+
+  // The context of the kernels of the captured run, whose stream is the one
+  // that is captured.
+  virtual DeviceContext* device_context() = 0;
+
+  // Starts capturing the work enqueued onto the stream of device_context(),
+  // without executing it.
+  virtual Status BeginCapture() = 0;
+
+  // Ends the capture started by BeginCapture(). Returns an error if the work
+  // captured can't be launched again, e.g. because a kernel synchronized with
+  // the device or waited for the completion of its work.
+  virtual Status EndCapture() = 0;
+
+  // Enqueues the work captured onto the device, ordered with the work of the
+  // other steps.
+  virtual Status Launch() = 0;
+
+  // Enqueues a copy of the device memory of `src` into that of `dst`, which
+  // must have the same size, ordered with the work Launch() enqueues.
+  virtual Status CopyTensor(const Tensor& src, Tensor* dst) = 0;
+};
+
+// An allocator that keeps the memory of its allocations reserved after they
+// are deallocated, until Release() is called, so that a captured graph can
+// keep using it.
+//
+// The allocator is reference counted. Each outstanding allocation holds a
+// reference, so that the allocator outlives any tensor allocated from it.
+class RetainingAllocator : public Allocator, public core::RefCounted {
+ public:
+  // Does not take ownership of `base`, which must outlive this allocator.
+  explicit RetainingAllocator(Allocator* base) : base_(base) {}
+
+  std::string Name() override { return base_->Name(); }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    return AllocateRaw(alignment, num_bytes, AllocationAttributes());
+  }
+  void* AllocateRaw(size_t alignment, size_t num_bytes,
+                    const AllocationAttributes& allocation_attr) override;
+  void DeallocateRaw(void* ptr) override;
+
+  AllocatorMemoryType GetMemoryType() const override {
+    return base_->GetMemoryType();
+  }
+
+  // Returns the memory of the allocations deallocated so far to `base`, and
+  // that of later ones as soon as they are deallocated.
+  void Release();
+
+ private:
+  Allocator* const base_;  // Not owned.
+
+  mutex mu_;
+  bool released_ TF_GUARDED_BY(mu_) = false;
+  std::vector<void*> retained_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_STEP_GRAPH_H_
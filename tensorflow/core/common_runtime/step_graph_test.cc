@@ -0,0 +1,81 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/step_graph.h"
+
+#include <string>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr size_t kAlignment = Allocator::kAllocatorAlignment;
+
+// Counts the allocations of the CPU allocator that are still live.
+class CountingAllocator : public Allocator {
+ public:
+  std::string Name() override { return "counting"; }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    ++num_live_;
+    return cpu_allocator()->AllocateRaw(alignment, num_bytes);
+  }
+
+  void DeallocateRaw(void* ptr) override {
+    --num_live_;
+    cpu_allocator()->DeallocateRaw(ptr);
+  }
+
+  int num_live() const { return num_live_; }
+
+ private:
+  int num_live_ = 0;
+};
+
+TEST(RetainingAllocatorTest, RetainsDeallocatedMemoryUntilReleased) {
+  CountingAllocator base;
+  core::RefCountPtr<RetainingAllocator> allocator(
+      new RetainingAllocator(&base));
+  void* a = allocator->AllocateRaw(kAlignment, 256);
+  void* b = allocator->AllocateRaw(kAlignment, 256);
+  allocator->DeallocateRaw(a);
+  EXPECT_EQ(base.num_live(), 2);
+
+  allocator->Release();
+  EXPECT_EQ(base.num_live(), 1);
+  allocator->DeallocateRaw(b);
+  EXPECT_EQ(base.num_live(), 0);
+}
+
+TEST(RetainingAllocatorTest, OutlivesItsTensors) {
+  CountingAllocator base;
+  Tensor t;
+  {
+    core::RefCountPtr<RetainingAllocator> allocator(
+        new RetainingAllocator(&base));
+    t = Tensor(allocator.get(), DT_FLOAT, TensorShape({64}));
+    allocator->Release();
+  }
+  EXPECT_EQ(base.num_live(), 1);
+  t = Tensor();
+  EXPECT_EQ(base.num_live(), 0);
+}
+
+}  // namespace
+}  // namespace tensorflow
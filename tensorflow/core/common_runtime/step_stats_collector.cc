@@ -121,6 +121,10 @@ void NodeExecStatsWrapper::RecordComputeStarted() {
   stats_->set_op_start_rel_micros(now_nanos / EnvTime::kMicrosToNanos -
                                   stats_->all_start_micros());
   stats_->set_op_start_rel_nanos(now_nanos - stats_->all_start_nanos());
+  if (TF_PREDICT_FALSE(PerfCounters::Enabled()) &&
+      PerfCounters::Read(&compute_start_counters_)) {
+    compute_start_thread_ = Env::Default()->GetCurrentThreadId();
+  }
 }
 
 void NodeExecStatsWrapper::RecordComputeEnded() {
@@ -130,6 +134,19 @@ void NodeExecStatsWrapper::RecordComputeEnded() {
   stats_->set_op_end_rel_micros(now_nanos / EnvTime::kMicrosToNanos -
                                 stats_->all_start_micros());
   stats_->set_op_end_rel_nanos(now_nanos - stats_->all_start_nanos());
+  // The counters are per thread, so they only measure the computation if it
+  // ended on the thread it started on.
+  PerfCounterValues end_counters;
+  if (TF_PREDICT_FALSE(compute_start_thread_ != -1) &&
+      compute_start_thread_ == Env::Default()->GetCurrentThreadId() &&
+      PerfCounters::Read(&end_counters)) {
+    stats_->set_op_cpu_cycles(end_counters.cpu_cycles -
+                              compute_start_counters_.cpu_cycles);
+    stats_->set_op_instructions(end_counters.instructions -
+                                compute_start_counters_.instructions);
+    stats_->set_op_cache_misses(end_counters.cache_misses -
+                                compute_start_counters_.cache_misses);
+  }
 }
 
 void NodeExecStatsWrapper::RecordExecutorEnded() {
@@ -364,6 +381,13 @@ void StepStatsCollector::BuildCostModel(
                                      .allocation_id());
         }
         cm->RecordMemoryStats(node, stats.memory_stats());
+        if (stats.op_cpu_cycles() > 0) {
+          CostModel::HardwareCounters counters;
+          counters.cpu_cycles = stats.op_cpu_cycles();
+          counters.instructions = stats.op_instructions();
+          counters.cache_misses = stats.op_cache_misses();
+          cm->RecordMaxHardwareCounters(node, counters);
+        }
         // Use hardware stats to record the execution time if they're available,
         // otherwise use the regular (less accurate) stats
         string node_name = dev_stats.regular_stats->node_stats(i).node_name();
@@ -18,6 +18,8 @@ limitations under the License.
 #include <memory>
 #include <unordered_map>
 #include <vector>
+
+#include "tensorflow/core/common_runtime/perf_counters.h"
 #include "tensorflow/core/framework/step_stats.pb.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/platform/env.h"
@@ -128,6 +130,10 @@ class NodeExecStatsWrapper : public NodeExecStatsInterface {
   std::unique_ptr<NodeExecStats> stats_;
   const NodeDef* const node_;                       // Not owned.
   StepStatsCollector* const step_stats_collector_;  // Not owned.
+  // Hardware counters at RecordComputeStarted(), and the thread they were
+  // read on (-1 if they were not read).
+  PerfCounterValues compute_start_counters_;
+  int64_t compute_start_thread_ = -1;
 };
 
 // Statistics collection interface for step execution.
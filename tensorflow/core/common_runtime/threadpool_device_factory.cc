@@ -37,16 +37,26 @@ class ThreadPoolDeviceFactory : public DeviceFactory {
 
   Status CreateDevices(const SessionOptions& options, const string& name_prefix,
                        std::vector<std::unique_ptr<Device>>* devices) override {
+    const bool use_numa_affinity =
+        options.config.experimental().use_numa_affinity();
     int num_numa_nodes = port::NUMANumNodes();
     int n = 1;
     auto iter = options.config.device_count().find("CPU");
     if (iter != options.config.device_count().end()) {
       n = iter->second;
+    } else if (use_numa_affinity) {
+      // By default, create one CPU device per NUMA node, so that the threads
+      // and memory of each device are local to a single node.
+      n = num_numa_nodes;
+    }
+    if (use_numa_affinity && port::NUMAEnabled()) {
+      // Allocate the memory of each device with `port::NUMAMalloc` on its node.
+      ProcessState::singleton()->EnableNUMA();
     }
     for (int i = 0; i < n; i++) {
       string name = strings::StrCat(name_prefix, "/device:CPU:", i);
       std::unique_ptr<ThreadPoolDevice> tpd;
-      if (options.config.experimental().use_numa_affinity()) {
+      if (use_numa_affinity) {
         int numa_node = i % num_numa_nodes;
         if (numa_node != i) {
           LOG(INFO) << "Only " << num_numa_nodes
@@ -0,0 +1,127 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_WORK_STEALING_QUEUE_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_WORK_STEALING_QUEUE_H_
+
+#include <atomic>
+#include <deque>
+#include <memory>
+
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// A fixed set of double-ended queues, one per worker slot, that supports work
+// stealing.
+//
+// The owner of a slot pushes and pops items at the back of its own queue, so
+// that the most recently produced (and most likely cache-warm) item is
+// processed first. Other workers steal from the front of a victim's queue,
+// which takes the oldest items and keeps the thief and the owner from
+// contending for the same end of the queue.
+//
+// Each queue has its own lock, so workers that operate on their own slot never
+// contend with each other. The total number of queued items is tracked
+// separately so that idle workers can skip probing every queue when there is
+// nothing to steal.
+//
+// This class is thread-safe.
+template <typename T>
+class WorkStealingQueues {
+ public:
+  explicit WorkStealingQueues(int num_queues)
+      : num_queues_(num_queues), queues_(new Queue[num_queues]) {
+    CHECK_GT(num_queues, 0);
+  }
+
+  int num_queues() const { return num_queues_; }
+
+  // Returns the number of items currently held in all queues. The value may be
+  // stale by the time it is returned.
+  int64_t size() const { return size_.load(std::memory_order_relaxed); }
+
+  // Adds `item` to the back of the queue owned by `slot`.
+  void Push(int slot, T item) {
+    Queue& q = queues_[Index(slot)];
+    {
+      mutex_lock l(q.mu);
+      q.items.push_back(std::move(item));
+    }
+    size_.fetch_add(1, std::memory_order_release);
+  }
+
+  // Pops the most recently pushed item from the queue owned by `slot`. Returns
+  // false if that queue is empty.
+  bool PopLocal(int slot, T* item) {
+    if (size_.load(std::memory_order_acquire) == 0) return false;
+    Queue& q = queues_[Index(slot)];
+    {
+      mutex_lock l(q.mu);
+      if (q.items.empty()) return false;
+      *item = std::move(q.items.back());
+      q.items.pop_back();
+    }
+    size_.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  // Steals the oldest item from the first non-empty queue other than the one
+  // owned by `thief`, probing victims in round-robin order starting after
+  // `thief`. Returns false if no item could be stolen.
+  bool Steal(int thief, T* item) {
+    const int start = Index(thief);
+    for (int i = 1; i < num_queues_; ++i) {
+      if (size_.load(std::memory_order_acquire) == 0) return false;
+      Queue& q = queues_[(start + i) % num_queues_];
+      mutex_lock l(q.mu);
+      if (q.items.empty()) continue;
+      *item = std::move(q.items.front());
+      q.items.pop_front();
+      size_.fetch_sub(1, std::memory_order_relaxed);
+      return true;
+    }
+    return false;
+  }
+
+  // Pops from the queue owned by `slot` if possible, and otherwise steals from
+  // another queue.
+  bool PopOrSteal(int slot, T* item) {
+    return PopLocal(slot, item) || Steal(slot, item);
+  }
+
+ private:
+  // Align each queue to its own cache line to avoid false sharing between
+  // workers that operate on neighbouring slots.
+  struct alignas(64) Queue {
+    mutex mu;
+    std::deque<T> items TF_GUARDED_BY(mu);
+  };
+
+  int Index(int slot) const { return slot % num_queues_; }
+
+  const int num_queues_;
+  std::unique_ptr<Queue[]> queues_;
+  std::atomic<int64_t> size_{0};
+
+  TF_DISALLOW_COPY_AND_ASSIGN(WorkStealingQueues);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_WORK_STEALING_QUEUE_H_
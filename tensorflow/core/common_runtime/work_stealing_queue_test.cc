@@ -0,0 +1,110 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/work_stealing_queue.h"
+
+#include <atomic>
+#include <vector>
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/threadpool.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(WorkStealingQueuesTest, PopLocalIsLifo) {
+  WorkStealingQueues<int> queues(2);
+  for (int i = 0; i < 4; ++i) queues.Push(0, i);
+  EXPECT_EQ(4, queues.size());
+
+  int item = -1;
+  for (int i = 3; i >= 0; --i) {
+    ASSERT_TRUE(queues.PopLocal(0, &item));
+    EXPECT_EQ(i, item);
+  }
+  EXPECT_FALSE(queues.PopLocal(0, &item));
+  EXPECT_EQ(0, queues.size());
+}
+
+TEST(WorkStealingQueuesTest, StealIsFifo) {
+  WorkStealingQueues<int> queues(3);
+  for (int i = 0; i < 4; ++i) queues.Push(2, i);
+
+  int item = -1;
+  // The thief never takes items from its own queue.
+  EXPECT_FALSE(queues.Steal(2, &item));
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_TRUE(queues.Steal(0, &item));
+    EXPECT_EQ(i, item);
+  }
+  EXPECT_FALSE(queues.Steal(0, &item));
+}
+
+TEST(WorkStealingQueuesTest, PopOrStealPrefersLocalQueue) {
+  WorkStealingQueues<int> queues(2);
+  queues.Push(0, 10);
+  queues.Push(1, 20);
+  queues.Push(1, 21);
+
+  int item = -1;
+  ASSERT_TRUE(queues.PopOrSteal(0, &item));
+  EXPECT_EQ(10, item);
+  ASSERT_TRUE(queues.PopOrSteal(0, &item));
+  EXPECT_EQ(20, item);
+  ASSERT_TRUE(queues.PopOrSteal(1, &item));
+  EXPECT_EQ(21, item);
+  EXPECT_FALSE(queues.PopOrSteal(0, &item));
+}
+
+TEST(WorkStealingQueuesTest, SlotsWrapAround) {
+  WorkStealingQueues<int> queues(2);
+  queues.Push(5, 1);
+  int item = -1;
+  ASSERT_TRUE(queues.PopLocal(1, &item));
+  EXPECT_EQ(1, item);
+}
+
+TEST(WorkStealingQueuesTest, ConcurrentPushAndSteal) {
+  constexpr int kNumThreads = 8;
+  constexpr int kItemsPerThread = 10000;
+  WorkStealingQueues<int> queues(kNumThreads);
+  std::vector<std::atomic<int>> seen(kNumThreads * kItemsPerThread);
+  for (auto& s : seen) s = 0;
+  {
+    thread::ThreadPool pool(Env::Default(), "test", kNumThreads);
+    for (int t = 0; t < kNumThreads; ++t) {
+      pool.Schedule([&queues, &seen, t]() {
+        int item;
+        for (int i = 0; i < kItemsPerThread; ++i) {
+          queues.Push(t, t * kItemsPerThread + i);
+          if (i % 2 == 0 && queues.PopOrSteal(t, &item)) {
+            seen[item].fetch_add(1);
+          }
+        }
+        while (queues.PopOrSteal(t, &item)) seen[item].fetch_add(1);
+      });
+    }
+  }
+  int item;
+  while (queues.PopOrSteal(0, &item)) seen[item].fetch_add(1);
+  for (const auto& s : seen) {
+    EXPECT_EQ(1, s.load());
+  }
+  EXPECT_EQ(0, queues.size());
+}
+
+}  // namespace
+}  // namespace tensorflow
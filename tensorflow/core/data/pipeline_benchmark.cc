@@ -0,0 +1,304 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/data/pipeline_benchmark.h"
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/str_split.h"
+#include "tensorflow/core/data/standalone.h"
+#include "tensorflow/core/framework/model.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/env_time.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/init_main.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/command_line_flags.h"
+
+namespace tensorflow {
+namespace data {
+namespace pipeline_benchmark {
+namespace {
+
+// Collects the statistics of the nodes of `model`, which must not be null.
+std::vector<NodeStats> CollectNodeStats(model::Model* model) {
+  std::vector<NodeStats> result;
+  std::shared_ptr<model::Node> output = model->output();
+  if (!output) {
+    return result;
+  }
+  model::Node::NodeValues processing_times;
+  output->TotalProcessingTime(&processing_times);
+  absl::flat_hash_map<string, std::vector<std::pair<string, double>>>
+      parameters;
+  for (const auto& pair : output->CollectTunableParameters()) {
+    const std::shared_ptr<model::SharedState>& state = pair.second->state;
+    double value = pair.second->value;
+    if (state->mu) {
+      mutex_lock l(*state->mu);
+      value = state->value;
+    }
+    parameters[pair.first].emplace_back(pair.second->name, value);
+  }
+
+  std::deque<std::shared_ptr<model::Node>> queue = {output};
+  while (!queue.empty()) {
+    std::shared_ptr<model::Node> node = queue.front();
+    queue.pop_front();
+    NodeStats stats;
+    stats.name = node->long_name();
+    stats.num_elements = node->num_elements();
+    stats.bytes_produced = node->bytes_produced();
+    stats.processing_time_per_element_ns = processing_times[stats.name];
+    auto it = parameters.find(stats.name);
+    if (it != parameters.end()) {
+      stats.tunable_parameters = std::move(it->second);
+    }
+    result.push_back(std::move(stats));
+    for (const auto& input : node->inputs()) {
+      queue.push_back(input);
+    }
+  }
+  return result;
+}
+
+// Produces up to `num_elements` elements, or elements for up to
+// `max_time_seconds` if `num_elements` is negative.
+Status Produce(standalone::Iterator* iterator, int64_t num_elements,
+               double max_time_seconds, BenchmarkResult* result) {
+  const uint64 start_us = EnvTime::NowMicros();
+  const uint64 max_time_us = max_time_seconds * EnvTime::kSecondsToMicros;
+  while (num_elements < 0 || result->num_elements < num_elements) {
+    if (EnvTime::NowMicros() - start_us >= max_time_us) {
+      break;
+    }
+    std::vector<Tensor> outputs;
+    TF_RETURN_IF_ERROR(iterator->GetNext(&outputs, &result->end_of_input));
+    if (result->end_of_input) {
+      break;
+    }
+    ++result->num_elements;
+    for (const Tensor& output : outputs) {
+      result->num_bytes += output.TotalBytes();
+    }
+  }
+  result->wall_time_seconds = static_cast<double>(EnvTime::NowMicros() -
+                                                  start_us) /
+                              EnvTime::kSecondsToMicros;
+  return Status::OK();
+}
+
+}  // namespace
+
+double BenchmarkResult::ElementsPerSecond() const {
+  return wall_time_seconds > 0 ? num_elements / wall_time_seconds : 0.0;
+}
+
+double BenchmarkResult::BytesPerSecond() const {
+  return wall_time_seconds > 0 ? num_bytes / wall_time_seconds : 0.0;
+}
+
+Status ParseSweep(const string& spec, std::vector<ParameterValues>* sweep) {
+  sweep->assign(1, ParameterValues());
+  for (absl::string_view parameter :
+       absl::StrSplit(spec, ';', absl::SkipWhitespace())) {
+    std::vector<absl::string_view> name_and_values =
+        absl::StrSplit(parameter, '=');
+    if (name_and_values.size() != 2 || name_and_values[0].empty() ||
+        name_and_values[1].empty()) {
+      return errors::InvalidArgument("Expected `name=v1,v2,...` but got `",
+                                     parameter, "` in sweep `", spec, "`");
+    }
+    std::vector<ParameterValues> combinations;
+    for (absl::string_view value_string :
+         absl::StrSplit(name_and_values[1], ',')) {
+      int64_t value;
+      if (!absl::SimpleAtoi(value_string, &value)) {
+        return errors::InvalidArgument("Invalid value `", value_string,
+                                       "` for `", name_and_values[0],
+                                       "` in sweep `", spec, "`");
+      }
+      for (const ParameterValues& values : *sweep) {
+        combinations.push_back(values);
+        combinations.back().emplace_back(string(name_and_values[0]), value);
+      }
+    }
+    *sweep = std::move(combinations);
+  }
+  return Status::OK();
+}
+
+Status SetParameterValues(const ParameterValues& values, GraphDef* graph_def) {
+  absl::flat_hash_map<string, NodeDef*> nodes;
+  for (NodeDef& node : *graph_def->mutable_node()) {
+    nodes[node.name()] = &node;
+  }
+  for (const auto& name_and_value : values) {
+    auto it = nodes.find(name_and_value.first);
+    if (it == nodes.end()) {
+      return errors::NotFound("No node named ", name_and_value.first,
+                              " in the dataset graph");
+    }
+    NodeDef* node = it->second;
+    auto value_attr = node->mutable_attr()->find("value");
+    Tensor tensor;
+    if (node->op() != "Const" || value_attr == node->mutable_attr()->end() ||
+        !tensor.FromProto(value_attr->second.tensor()) ||
+        !TensorShapeUtils::IsScalar(tensor.shape()) ||
+        (tensor.dtype() != DT_INT64 && tensor.dtype() != DT_INT32)) {
+      return errors::InvalidArgument("Node ", node->name(),
+                                     " is not a scalar integer constant");
+    }
+    if (tensor.dtype() == DT_INT64) {
+      tensor.scalar<int64_t>()() = name_and_value.second;
+    } else {
+      tensor.scalar<int32>()() = name_and_value.second;
+    }
+    tensor.AsProtoTensorContent(value_attr->second.mutable_tensor());
+  }
+  return Status::OK();
+}
+
+Status RunBenchmark(const GraphDef& graph_def, const BenchmarkOptions& options,
+                    BenchmarkResult* result) {
+  std::unique_ptr<standalone::Dataset> dataset;
+  TF_RETURN_IF_ERROR(standalone::Dataset::FromGraph({}, graph_def, &dataset));
+  std::unique_ptr<standalone::Iterator> iterator;
+  TF_RETURN_IF_ERROR(dataset->MakeIterator(&iterator));
+
+  *result = BenchmarkResult();
+  if (options.warmup_elements > 0) {
+    BenchmarkResult warmup;
+    TF_RETURN_IF_ERROR(Produce(iterator.get(), options.warmup_elements,
+                               options.max_time_seconds, &warmup));
+    if (warmup.end_of_input) {
+      return errors::InvalidArgument("The input pipeline produced only ",
+                                     warmup.num_elements,
+                                     " elements, which is fewer than the ",
+                                     options.warmup_elements,
+                                     " warmup elements");
+    }
+  }
+  TF_RETURN_IF_ERROR(Produce(iterator.get(), options.num_elements,
+                             options.max_time_seconds, result));
+  result->nodes = CollectNodeStats(iterator->model().get());
+  return Status::OK();
+}
+
+string FormatResult(const ParameterValues& values,
+                    const BenchmarkResult& result) {
+  string output = values.empty()
+                      ? "Graph values"
+                      : absl::StrJoin(values, ", ", absl::PairFormatter("="));
+  absl::StrAppendFormat(
+      &output, ": %d elements in %.3f s, %.1f elements/s, %.1f bytes/s%s\n",
+      result.num_elements, result.wall_time_seconds, result.ElementsPerSecond(),
+      result.BytesPerSecond(), result.end_of_input ? " (end of input)" : "");
+  for (const NodeStats& node : result.nodes) {
+    absl::StrAppendFormat(
+        &output, "  %s: %d elements, %d bytes, %.1f us per element",
+        node.name, node.num_elements, node.bytes_produced,
+        node.processing_time_per_element_ns / EnvTime::kMicrosToNanos);
+    for (const auto& parameter : node.tunable_parameters) {
+      absl::StrAppendFormat(&output, ", %s=%.0f", parameter.first,
+                            parameter.second);
+    }
+    absl::StrAppend(&output, "\n");
+  }
+  return output;
+}
+
+int Main(int argc, char** argv) {
+  string graph = "";
+  int64_t num_elements = -1;
+  float max_time = 10.0;
+  int64_t warmup_elements = 0;
+  string sweep_spec = "";
+  std::vector<Flag> flag_list = {
+      Flag("graph", &graph,
+           "file name of the serialized dataset graph (binary or text "
+           "GraphDef)"),
+      Flag("num_elements", &num_elements,
+           "maximum number of elements to produce, -1 for no limit"),
+      Flag("max_time", &max_time, "maximum duration of each run in seconds"),
+      Flag("warmup_elements", &warmup_elements,
+           "number of elements to produce before measuring starts"),
+      Flag("sweep", &sweep_spec,
+           "scalar integer constants of the graph to set, e.g. "
+           "\"num_parallel_calls=1,2,4;buffer_size=8,16\"; each combination "
+           "of values is run"),
+  };
+  string usage = Flags::Usage(argv[0], flag_list);
+  const bool parse_result = Flags::Parse(&argc, argv, flag_list);
+  if (!parse_result || graph.empty()) {
+    LOG(ERROR) << usage;
+    return -1;
+  }
+  ::tensorflow::port::InitMain(argv[0], &argc, &argv);
+  if (argc > 1) {
+    LOG(ERROR) << "Unknown argument " << argv[1] << "\n" << usage;
+    return -1;
+  }
+
+  GraphDef graph_def;
+  Status s = ReadBinaryProto(Env::Default(), graph, &graph_def);
+  if (!s.ok()) {
+    s = ReadTextProto(Env::Default(), graph, &graph_def);
+  }
+  if (!s.ok()) {
+    LOG(ERROR) << "Could not read " << graph << ": " << s;
+    return -1;
+  }
+  std::vector<ParameterValues> sweep;
+  s = ParseSweep(sweep_spec, &sweep);
+  if (!s.ok()) {
+    LOG(ERROR) << s;
+    return -1;
+  }
+
+  BenchmarkOptions options;
+  options.num_elements = num_elements;
+  options.max_time_seconds = max_time;
+  options.warmup_elements = warmup_elements;
+  for (const ParameterValues& values : sweep) {
+    GraphDef swept_graph_def = graph_def;
+    BenchmarkResult result;
+    s = SetParameterValues(values, &swept_graph_def);
+    if (s.ok()) {
+      s = RunBenchmark(swept_graph_def, options, &result);
+    }
+    if (!s.ok()) {
+      LOG(ERROR) << "Benchmark failed: " << s;
+      return -1;
+    }
+    LOG(INFO) << FormatResult(values, result);
+  }
+  return 0;
+}
+
+}  // namespace pipeline_benchmark
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,100 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DATA_PIPELINE_BENCHMARK_H_
+#define TENSORFLOW_CORE_DATA_PIPELINE_BENCHMARK_H_
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace data {
+namespace pipeline_benchmark {
+
+// Measures the throughput of a serialized tf.data input pipeline graph (as
+// accepted by `standalone::Dataset::FromGraph`) without a session, and reports
+// the per-iterator statistics of the tf.data performance model.
+
+struct BenchmarkOptions {
+  // Maximum number of elements to produce, or -1 to produce elements until
+  // the end of input or `max_time_seconds`.
+  int64_t num_elements = -1;
+  // Maximum duration of the measured part of the run.
+  double max_time_seconds = 10.0;
+  // Number of elements produced before measuring starts, e.g. to let
+  // autotuning converge.
+  int64_t warmup_elements = 0;
+};
+
+// Statistics of one node of the performance model.
+struct NodeStats {
+  string name;
+  int64_t num_elements = 0;
+  int64_t bytes_produced = 0;
+  // Average time spent in the node itself to produce an element.
+  double processing_time_per_element_ns = 0.0;
+  // Current values of the node's tunable parameters.
+  std::vector<std::pair<string, double>> tunable_parameters;
+};
+
+struct BenchmarkResult {
+  // Elements produced, and their total size, after the warmup.
+  int64_t num_elements = 0;
+  int64_t num_bytes = 0;
+  double wall_time_seconds = 0.0;
+  bool end_of_input = false;
+  // Nodes of the performance model in breadth-first order from the output.
+  std::vector<NodeStats> nodes;
+
+  double ElementsPerSecond() const;
+  double BytesPerSecond() const;
+};
+
+// Values of named scalar integer constants of a dataset graph, such as the
+// `num_parallel_calls` or `buffer_size` inputs of its datasets.
+using ParameterValues = std::vector<std::pair<string, int64_t>>;
+
+// Parses a sweep specification of the form "name1=v1,v2;name2=v3,v4" into all
+// combinations of the given values. An empty specification yields a single
+// empty combination.
+Status ParseSweep(const string& spec, std::vector<ParameterValues>* sweep);
+
+// Sets the value of each named constant in `graph_def`. Returns NotFound if
+// there is no node with the given name and InvalidArgument if the node is not
+// a scalar integer constant.
+Status SetParameterValues(const ParameterValues& values, GraphDef* graph_def);
+
+// Runs the input pipeline of `graph_def` with the given options.
+Status RunBenchmark(const GraphDef& graph_def, const BenchmarkOptions& options,
+                    BenchmarkResult* result);
+
+// Returns a human-readable report of `result`, obtained with `values`.
+string FormatResult(const ParameterValues& values,
+                    const BenchmarkResult& result);
+
+// Handles argument parsing and runs the benchmark for each combination of
+// the sweep.
+int Main(int argc, char** argv);
+
+}  // namespace pipeline_benchmark
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_PIPELINE_BENCHMARK_H_
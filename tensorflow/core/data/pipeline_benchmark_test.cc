@@ -0,0 +1,198 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/data/pipeline_benchmark.h"
+
+#include <vector>
+
+#include "absl/strings/match.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/protobuf.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace pipeline_benchmark {
+namespace {
+
+// range(10)
+constexpr const char* const kRangeGraphProto = R"proto(
+  node {
+    name: "Const/_0"
+    op: "Const"
+    attr {
+      key: "dtype"
+      value { type: DT_INT64 }
+    }
+    attr {
+      key: "value"
+      value {
+        tensor {
+          dtype: DT_INT64
+          tensor_shape {}
+          int64_val: 0
+        }
+      }
+    }
+  }
+  node {
+    name: "Const/_1"
+    op: "Const"
+    attr {
+      key: "dtype"
+      value { type: DT_INT64 }
+    }
+    attr {
+      key: "value"
+      value {
+        tensor {
+          dtype: DT_INT64
+          tensor_shape {}
+          int64_val: 10
+        }
+      }
+    }
+  }
+  node {
+    name: "Const/_2"
+    op: "Const"
+    attr {
+      key: "dtype"
+      value { type: DT_INT64 }
+    }
+    attr {
+      key: "value"
+      value {
+        tensor {
+          dtype: DT_INT64
+          tensor_shape {}
+          int64_val: 1
+        }
+      }
+    }
+  }
+  node {
+    name: "RangeDataset/_3"
+    op: "RangeDataset"
+    input: "Const/_0"
+    input: "Const/_1"
+    input: "Const/_2"
+    attr {
+      key: "output_shapes"
+      value { list { shape {} } }
+    }
+    attr {
+      key: "output_types"
+      value { list { type: DT_INT64 } }
+    }
+  }
+  node {
+    name: "dataset"
+    op: "_Retval"
+    input: "RangeDataset/_3"
+    attr {
+      key: "T"
+      value { type: DT_VARIANT }
+    }
+    attr {
+      key: "index"
+      value { i: 0 }
+    }
+  }
+  library {}
+  versions { producer: 96 }
+)proto";
+
+GraphDef RangeGraph() {
+  GraphDef graph_def;
+  protobuf::TextFormat::ParseFromString(kRangeGraphProto, &graph_def);
+  return graph_def;
+}
+
+TEST(PipelineBenchmarkTest, ParseSweep) {
+  std::vector<ParameterValues> sweep;
+  TF_ASSERT_OK(ParseSweep("", &sweep));
+  ASSERT_EQ(sweep.size(), 1);
+  EXPECT_TRUE(sweep[0].empty());
+
+  TF_ASSERT_OK(ParseSweep("a=1,2;b=-1,4,8", &sweep));
+  ASSERT_EQ(sweep.size(), 6);
+  EXPECT_EQ(sweep[0], (ParameterValues{{"a", 1}, {"b", -1}}));
+  EXPECT_EQ(sweep[1], (ParameterValues{{"a", 2}, {"b", -1}}));
+  EXPECT_EQ(sweep[5], (ParameterValues{{"a", 2}, {"b", 8}}));
+
+  EXPECT_TRUE(errors::IsInvalidArgument(ParseSweep("a", &sweep)));
+  EXPECT_TRUE(errors::IsInvalidArgument(ParseSweep("a=", &sweep)));
+  EXPECT_TRUE(errors::IsInvalidArgument(ParseSweep("a=1,x", &sweep)));
+}
+
+TEST(PipelineBenchmarkTest, RunToEndOfInput) {
+  BenchmarkResult result;
+  TF_ASSERT_OK(RunBenchmark(RangeGraph(), BenchmarkOptions(), &result));
+  EXPECT_EQ(result.num_elements, 10);
+  EXPECT_EQ(result.num_bytes, 80);
+  EXPECT_TRUE(result.end_of_input);
+
+  bool found_range = false;
+  for (const NodeStats& node : result.nodes) {
+    if (absl::StrContains(node.name, "Range")) {
+      found_range = true;
+      EXPECT_EQ(node.num_elements, 10);
+    }
+  }
+  EXPECT_TRUE(found_range);
+}
+
+TEST(PipelineBenchmarkTest, RunWithElementLimitAndWarmup) {
+  BenchmarkOptions options;
+  options.num_elements = 4;
+  options.warmup_elements = 3;
+  BenchmarkResult result;
+  TF_ASSERT_OK(RunBenchmark(RangeGraph(), options, &result));
+  EXPECT_EQ(result.num_elements, 4);
+  EXPECT_FALSE(result.end_of_input);
+
+  options.num_elements = -1;
+  TF_ASSERT_OK(RunBenchmark(RangeGraph(), options, &result));
+  EXPECT_EQ(result.num_elements, 7);
+  EXPECT_TRUE(result.end_of_input);
+
+  options.warmup_elements = 11;
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      RunBenchmark(RangeGraph(), options, &result)));
+}
+
+TEST(PipelineBenchmarkTest, SetParameterValues) {
+  GraphDef graph_def = RangeGraph();
+  const ParameterValues values = {{"Const/_1", 5}};
+  TF_ASSERT_OK(SetParameterValues(values, &graph_def));
+  BenchmarkResult result;
+  TF_ASSERT_OK(RunBenchmark(graph_def, BenchmarkOptions(), &result));
+  EXPECT_EQ(result.num_elements, 5);
+  EXPECT_TRUE(absl::StrContains(FormatResult(values, result),
+                                "Const/_1=5: 5 elements"));
+
+  EXPECT_TRUE(errors::IsNotFound(
+      SetParameterValues({{"missing", 1}}, &graph_def)));
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      SetParameterValues({{"RangeDataset/_3", 1}}, &graph_def)));
+}
+
+}  // namespace
+}  // namespace pipeline_benchmark
+}  // namespace data
+}  // namespace tensorflow
@@ -154,6 +154,11 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
   ~Iterator() override { cancellation_manager_->StartCancel(); }
 
   Status Initialize(IteratorContext* ctx) override {
+    // If the caller provides a model, e.g. to inspect it, the input pipeline
+    // is modeled and optimized in it instead of in a model of its own.
+    if (model_ && ctx->model()) {
+      model_ = ctx->model();
+    }
     return dataset()->input_->MakeIterator(IteratorContext(CreateParams(ctx)),
                                            this, prefix(), &input_impl_);
   }
@@ -14,8 +14,11 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/service/common.h"
 
+#include <algorithm>
 #include <string>
+#include <vector>
 
+#include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/framework/dataset_options.pb.h"
@@ -131,6 +134,22 @@ StatusOr<DeploymentMode> ParseDeploymentMode(absl::string_view s) {
                                  "COLOCATED, REMOTE, and HYBRID.");
 }
 
+int64_t LocalityDistance(absl::string_view a, absl::string_view b) {
+  const std::vector<absl::string_view> a_domains =
+      absl::StrSplit(a, '/', absl::SkipEmpty());
+  const std::vector<absl::string_view> b_domains =
+      absl::StrSplit(b, '/', absl::SkipEmpty());
+  if (a_domains.empty() || b_domains.empty()) {
+    return 0;
+  }
+  size_t common = 0;
+  while (common < a_domains.size() && common < b_domains.size() &&
+         a_domains[common] == b_domains[common]) {
+    ++common;
+  }
+  return std::max(a_domains.size(), b_domains.size()) - common;
+}
+
 bool IsPreemptedError(const Status& status) {
   return errors::IsAborted(status) || errors::IsCancelled(status) ||
          errors::IsUnavailable(status);
@@ -65,6 +65,12 @@ std::string TargetWorkersToString(TargetWorkers target_workers);
 // Returns InvalidArgument if the string is not recognized.
 StatusOr<DeploymentMode> ParseDeploymentMode(absl::string_view s);
 
+// Returns the distance between the worker localities `a` and `b`, in the format
+// of `WorkerConfig.worker_locality`: the number of topology domains of the
+// deeper locality below the domains the two have in common. Returns 0 if
+// either locality is empty.
+int64_t LocalityDistance(absl::string_view a, absl::string_view b);
+
 // Returns true if `status` is a retriable error that indicates preemption.
 bool IsPreemptedError(const Status& status);
 
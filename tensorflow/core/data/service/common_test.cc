@@ -170,6 +170,25 @@ TEST(CommonTest, ParseInvalidDeploymentMode) {
               testing::StatusIs(error::INVALID_ARGUMENT));
 }
 
+TEST(CommonTest, LocalityDistance) {
+  EXPECT_EQ(LocalityDistance("zone-a/rack-1/host-1", "zone-a/rack-1/host-1"),
+            0);
+  EXPECT_EQ(LocalityDistance("zone-a/rack-1/host-1", "zone-a/rack-1/host-2"),
+            1);
+  EXPECT_EQ(LocalityDistance("zone-a/rack-1/host-1", "zone-a/rack-2/host-1"),
+            2);
+  EXPECT_EQ(LocalityDistance("zone-a/rack-1/host-1", "zone-b/rack-1/host-1"),
+            3);
+  EXPECT_EQ(LocalityDistance("zone-a/rack-1", "zone-a/rack-1/host-1"), 1);
+  EXPECT_EQ(LocalityDistance("/zone-a/rack-1/", "zone-a/rack-1"), 0);
+}
+
+TEST(CommonTest, UnknownLocalityDistance) {
+  EXPECT_EQ(LocalityDistance("", ""), 0);
+  EXPECT_EQ(LocalityDistance("", "zone-a/rack-1/host-1"), 0);
+  EXPECT_EQ(LocalityDistance("zone-a/rack-1/host-1", ""), 0);
+}
+
 TEST(CommonTest, IsPreemptedError) {
   EXPECT_TRUE(IsPreemptedError(errors::Aborted("Aborted")));
   EXPECT_TRUE(IsPreemptedError(errors::Cancelled("Cancelled")));
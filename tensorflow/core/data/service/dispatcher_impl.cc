@@ -335,6 +335,8 @@ Status DataServiceDispatcherImpl::WorkerHeartbeat(
     *update.mutable_register_worker()->mutable_worker_tags() =
         request->worker_tags();
     update.mutable_register_worker()->set_worker_uid(request->worker_uid());
+    update.mutable_register_worker()->set_worker_locality(
+        request->worker_locality());
     TF_RETURN_IF_ERROR(Apply(update));
     TF_RETURN_IF_ERROR(CreateTasksForWorker(worker_address));
     TF_RETURN_IF_ERROR(state_.TasksForWorker(worker_address, assigned_tasks));
@@ -909,6 +911,23 @@ Status DataServiceDispatcherImpl::ClientHeartbeat(
 
   std::vector<std::shared_ptr<const Task>> tasks;
   TF_RETURN_IF_ERROR(state_.TasksForJob(job->job_id, tasks));
+  absl::flat_hash_map<int64_t, int64_t> locality_distances;
+  for (const auto& task : tasks) {
+    std::shared_ptr<const Worker> worker;
+    TF_RETURN_IF_ERROR(state_.WorkerFromAddress(task->worker_address, worker));
+    locality_distances[task->task_id] =
+        LocalityDistance(request->client_locality(), worker->locality);
+  }
+  if (!job->IsRoundRobin()) {
+    // Lists the nearest tasks first, so that the client prefers them. The
+    // order of round-robin tasks is left alone since it determines the order
+    // in which consumers read the rounds.
+    std::stable_sort(tasks.begin(), tasks.end(),
+                     [&locality_distances](const auto& a, const auto& b) {
+                       return locality_distances.at(a->task_id) <
+                              locality_distances.at(b->task_id);
+                     });
+  }
   for (const auto& task : tasks) {
     TaskInfo* task_info = response->mutable_task_info()->Add();
     task_info->set_worker_address(task->worker_address);
@@ -919,6 +938,7 @@ Status DataServiceDispatcherImpl::ClientHeartbeat(
     task_info->set_job_id(job->job_id);
     task_info->set_worker_uid(task->worker_uid);
     task_info->set_starting_round(task->starting_round);
+    task_info->set_locality_distance(locality_distances.at(task->task_id));
   }
   response->set_job_finished(job->finished);
   response->set_deployment_mode(config_.deployment_mode());
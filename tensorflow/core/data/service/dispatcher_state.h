@@ -92,12 +92,15 @@ class DispatcherState {
           transfer_address(register_worker.transfer_address()),
           tags(register_worker.worker_tags().begin(),
                register_worker.worker_tags().end()),
-          uid(register_worker.worker_uid()) {}
+          uid(register_worker.worker_uid()),
+          locality(register_worker.worker_locality()) {}
 
     const std::string address;
     const std::string transfer_address;
     const std::vector<std::string> tags;
     const int64_t uid;
+    // See `WorkerConfig.worker_locality`.
+    const std::string locality;
   };
 
   // A key for identifying a job. The key contains a job name,
@@ -218,6 +218,17 @@ TEST(DispatcherState, RegisterWorker) {
   EXPECT_EQ(worker->address, address);
 }
 
+TEST(DispatcherState, RegisterWorkerWithLocality) {
+  DispatcherState state;
+  Update update;
+  update.mutable_register_worker()->set_worker_address("test_worker_address");
+  update.mutable_register_worker()->set_worker_locality("zone-a/rack-1");
+  TF_EXPECT_OK(state.Apply(update));
+  std::shared_ptr<const Worker> worker;
+  TF_EXPECT_OK(state.WorkerFromAddress("test_worker_address", worker));
+  EXPECT_EQ(worker->locality, "zone-a/rack-1");
+}
+
 TEST(DispatcherState, RegisterWorkerInFixedWorkerSet) {
   experimental::DispatcherConfig config;
   config.add_worker_addresses("/worker/task/0");
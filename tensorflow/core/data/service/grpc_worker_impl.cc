@@ -63,5 +63,20 @@ HANDLER(GetElement);
 HANDLER(GetWorkerTasks);
 #undef HANDLER
 
+::grpc::Status GrpcWorkerImpl::GetElements(
+    ServerContext* context, const GetElementsRequest* request,
+    ::grpc::ServerWriter<GetElementResponse>* writer) {
+  return ToGrpcStatus(impl_->GetElements(
+      request, [writer, request](const GetElementResponse& response) {
+        if (!writer->Write(response)) {
+          return errors::Cancelled(
+              "Failed to stream an element of task ",
+              request->request().task_id(),
+              ". The client may have cancelled the stream.");
+        }
+        return Status::OK();
+      }));
+}
+
 }  // namespace data
 }  // namespace tensorflow
@@ -118,6 +118,14 @@ class MultiTrainerCache {
   // Returns true if the cache has been cancelled.
   bool IsCancelled() const;
 
+  // Returns the total size in bytes of the cached elements that `trainer_id`
+  // has not read yet. This is the part of the cache kept for `trainer_id` if
+  // the other trainers are ahead of it.
+  size_t GetUnreadBytes(const std::string& trainer_id) const;
+
+  // Returns the total size in bytes of the cached elements.
+  size_t GetCacheSizeBytes() const;
+
  private:
   // Returns true if element is ready for `trainer_id`. An element is ready if
   // other trainers have read the data and the data remains in the cache. If the
@@ -312,6 +320,30 @@ bool MultiTrainerCache<ElementType>::IsCancelled() const
   mutex_lock l(mu_);
   return !status_.ok();
 }
+
+template <class ElementType>
+size_t MultiTrainerCache<ElementType>::GetUnreadBytes(
+    const std::string& trainer_id) const TF_LOCKS_EXCLUDED(mu_) {
+  mutex_lock l(mu_);
+  size_t element_index = cache_start_index_;
+  auto it = trainer_to_element_index_map_.find(trainer_id);
+  if (it != trainer_to_element_index_map_.end() &&
+      it->second > cache_start_index_) {
+    element_index = it->second;
+  }
+  size_t unread_bytes = 0;
+  for (size_t i = element_index - cache_start_index_; i < cache_.size(); ++i) {
+    unread_bytes += cachable_sequence_->GetElementSizeBytes(*cache_[i]);
+  }
+  return unread_bytes;
+}
+
+template <class ElementType>
+size_t MultiTrainerCache<ElementType>::GetCacheSizeBytes() const
+    TF_LOCKS_EXCLUDED(mu_) {
+  mutex_lock l(mu_);
+  return cache_size_bytes_;
+}
 }  // namespace data
 }  // namespace tensorflow
 
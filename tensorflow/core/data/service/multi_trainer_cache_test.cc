@@ -204,6 +204,30 @@ TEST(MultiTrainerCacheTest, NewTrainersStartLate) {
   }
 }
 
+TEST(MultiTrainerCacheTest, MemoryAccounting) {
+  MultiTrainerCache<int64_t> cache(
+      /*max_cache_size_bytes=*/5 * sizeof(int64_t),
+      absl::make_unique<InfiniteRange>());
+  EXPECT_EQ(cache.GetCacheSizeBytes(), 0);
+  EXPECT_EQ(cache.GetUnreadBytes("Fast trainer"), 0);
+
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(i)));
+  }
+  EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(0)));
+  EXPECT_EQ(cache.GetCacheSizeBytes(), 3 * sizeof(int64_t));
+  EXPECT_EQ(cache.GetUnreadBytes("Fast trainer"), 0);
+  EXPECT_EQ(cache.GetUnreadBytes("Slow trainer"), 2 * sizeof(int64_t));
+  EXPECT_EQ(cache.GetUnreadBytes("New trainer"), 3 * sizeof(int64_t));
+
+  // Discarded elements are no longer charged to the slow trainer.
+  for (int i = 3; i < 10; ++i) {
+    EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(i)));
+  }
+  EXPECT_EQ(cache.GetCacheSizeBytes(), 5 * sizeof(int64_t));
+  EXPECT_EQ(cache.GetUnreadBytes("Slow trainer"), 5 * sizeof(int64_t));
+}
+
 TEST(MultiTrainerCacheTest, AlternateTrainerExtendsCache) {
   // The cache size is smaller than one int64_t.
   MultiTrainerCache<int64_t> cache(
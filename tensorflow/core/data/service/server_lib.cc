@@ -143,7 +143,9 @@ Status WorkerGrpcDataServer::StartServiceInternal() {
       /*replace_all=*/false);
   std::string transfer_address = worker_address;
   std::string transfer_protocol = config_.data_transfer_protocol();
-  if (!transfer_protocol.empty() && transfer_protocol != "grpc") {
+  // Both gRPC protocols are served by the worker's own gRPC server.
+  if (!transfer_protocol.empty() && transfer_protocol != "grpc" &&
+      transfer_protocol != "grpc_streaming") {
     TF_RETURN_IF_ERROR(DataTransferServer::Build(
         transfer_protocol, service_->get_element_getter(), &transfer_server_));
     TF_RETURN_IF_ERROR(transfer_server_->Start());
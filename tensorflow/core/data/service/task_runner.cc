@@ -15,10 +15,13 @@ limitations under the License.
 #include "tensorflow/core/data/service/task_runner.h"
 
 #include <algorithm>
+#include <functional>
 #include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 
+#include "absl/strings/str_cat.h"
 #include "tensorflow/core/data/service/common.h"
 #include "tensorflow/core/data/service/data_transfer.h"
 #include "tensorflow/core/data/service/logging_utils.h"
@@ -44,6 +47,11 @@ namespace {
 // Time to wait before skipping a round if data still isn't available.
 const int64_t kWaitBeforeSkipUs = 100 * 1000;  // 100ms.
 
+// Returns the multi-trainer cache trainer ID of `job_id` in a `CrossJobCache`.
+std::string JobTrainerId(int64_t job_id) {
+  return absl::StrCat("job_", job_id);
+}
+
 }  // namespace
 
 StandaloneTaskIterator::StandaloneTaskIterator(
@@ -189,6 +197,177 @@ void CachingTaskRunner::Cancel() {
   fcfs_task_runner_.Cancel();
 }
 
+size_t CachingTaskRunner::GetUnreadBytes(const std::string& trainer_id) const {
+  return cache_.GetUnreadBytes(trainer_id);
+}
+
+size_t CachingTaskRunner::GetCacheSizeBytes() const {
+  return cache_.GetCacheSizeBytes();
+}
+
+// The runner of one task attached to a `CrossJobCache`. It reads the shared
+// cache as the trainer of its job.
+class CrossJobCache::JobTaskRunner : public TaskRunner {
+ public:
+  JobTaskRunner(CrossJobCache& cross_job_cache, const std::string& key,
+                int64_t job_id, std::shared_ptr<CachingTaskRunner> runner)
+      : cross_job_cache_(cross_job_cache),
+        key_(key),
+        job_id_(job_id),
+        runner_(std::move(runner)) {}
+
+  ~JobTaskRunner() override { Cancel(); }
+
+  Status GetNext(const GetElementRequest& req,
+                 GetElementResult& result) override {
+    std::shared_ptr<CachingTaskRunner> runner;
+    {
+      mutex_lock l(mu_);
+      if (!runner_) {
+        return errors::Cancelled(
+            "tf.data service cross-job cache task is cancelled.");
+      }
+      runner = runner_;
+    }
+    GetElementRequest job_req = req;
+    job_req.set_trainer_id(JobTrainerId(job_id_));
+    TF_RETURN_IF_ERROR(runner->GetNext(job_req, result));
+    cross_job_cache_.RecordRead(key_, job_id_,
+                                result.EstimatedMemoryUsageBytes());
+    return Status::OK();
+  }
+
+  void Cancel() override {
+    {
+      mutex_lock l(mu_);
+      if (!runner_) {
+        return;
+      }
+      runner_.reset();
+    }
+    cross_job_cache_.Detach(key_, job_id_);
+  }
+
+ private:
+  CrossJobCache& cross_job_cache_;
+  const std::string key_;
+  const int64_t job_id_;
+
+  mutex mu_;
+  // The shared runner, or null if this task has been detached from it.
+  std::shared_ptr<CachingTaskRunner> runner_ TF_GUARDED_BY(mu_);
+};
+
+CrossJobCache::CrossJobCache(size_t max_cache_size_bytes)
+    : max_cache_size_bytes_(max_cache_size_bytes) {}
+
+CrossJobCache::~CrossJobCache() {
+  absl::flat_hash_map<std::string, SharedRunner> runners;
+  {
+    mutex_lock l(mu_);
+    runners.swap(runners_);
+  }
+  for (auto& entry : runners) {
+    entry.second.runner->Cancel();
+  }
+}
+
+Status CrossJobCache::Attach(
+    const std::string& key, int64_t job_id,
+    const std::function<StatusOr<std::unique_ptr<TaskIterator>>()>&
+        make_iterator,
+    std::unique_ptr<TaskRunner>& out) TF_LOCKS_EXCLUDED(mu_) {
+  mutex_lock l(mu_);
+  SharedRunner& shared_runner = runners_[key];
+  if (!shared_runner.runner) {
+    StatusOr<std::unique_ptr<TaskIterator>> iterator = make_iterator();
+    if (!iterator.ok()) {
+      runners_.erase(key);
+      return iterator.status();
+    }
+    shared_runner.runner = std::make_shared<CachingTaskRunner>(
+        std::move(iterator).ValueOrDie(), max_cache_size_bytes_);
+    VLOG(1) << "Created tf.data service cross-job cache for dataset " << key;
+  }
+  if (!shared_runner.bytes_read_by_job.emplace(job_id, 0).second) {
+    return errors::FailedPrecondition(
+        "Job ", job_id, " is already attached to the tf.data service "
+        "cross-job cache for dataset ", key, ".");
+  }
+  VLOG(1) << "Attached job " << job_id << " to the tf.data service cross-job "
+          << "cache for dataset " << key << ", shared by "
+          << shared_runner.bytes_read_by_job.size() << " job(s).";
+  out = absl::make_unique<JobTaskRunner>(*this, key, job_id,
+                                         shared_runner.runner);
+  return Status::OK();
+}
+
+StatusOr<CrossJobCache::JobMemoryUsage> CrossJobCache::GetJobMemoryUsage(
+    const std::string& key, int64_t job_id) const TF_LOCKS_EXCLUDED(mu_) {
+  std::shared_ptr<CachingTaskRunner> runner;
+  JobMemoryUsage usage;
+  {
+    mutex_lock l(mu_);
+    auto it = runners_.find(key);
+    if (it == runners_.end() ||
+        !it->second.bytes_read_by_job.contains(job_id)) {
+      return errors::NotFound("Job ", job_id, " is not attached to the "
+                              "tf.data service cross-job cache for dataset ",
+                              key, ".");
+    }
+    runner = it->second.runner;
+    usage.bytes_read = it->second.bytes_read_by_job.at(job_id);
+  }
+  usage.unread_bytes = runner->GetUnreadBytes(JobTrainerId(job_id));
+  usage.cache_size_bytes = runner->GetCacheSizeBytes();
+  return usage;
+}
+
+size_t CrossJobCache::NumKeys() const TF_LOCKS_EXCLUDED(mu_) {
+  mutex_lock l(mu_);
+  return runners_.size();
+}
+
+void CrossJobCache::RecordRead(const std::string& key, int64_t job_id,
+                               size_t bytes) TF_LOCKS_EXCLUDED(mu_) {
+  mutex_lock l(mu_);
+  auto it = runners_.find(key);
+  if (it == runners_.end()) {
+    return;
+  }
+  auto job_it = it->second.bytes_read_by_job.find(job_id);
+  if (job_it != it->second.bytes_read_by_job.end()) {
+    job_it->second += bytes;
+  }
+}
+
+void CrossJobCache::Detach(const std::string& key, int64_t job_id)
+    TF_LOCKS_EXCLUDED(mu_) {
+  std::shared_ptr<CachingTaskRunner> runner_to_cancel;
+  {
+    mutex_lock l(mu_);
+    auto it = runners_.find(key);
+    if (it == runners_.end()) {
+      return;
+    }
+    auto job_it = it->second.bytes_read_by_job.find(job_id);
+    if (job_it == it->second.bytes_read_by_job.end()) {
+      return;
+    }
+    VLOG(1) << "Detached job " << job_id << " from the tf.data service "
+            << "cross-job cache for dataset " << key << " after reading "
+            << FormatBytes(job_it->second) << ".";
+    it->second.bytes_read_by_job.erase(job_it);
+    if (it->second.bytes_read_by_job.empty()) {
+      runner_to_cancel = std::move(it->second.runner);
+      runners_.erase(it);
+    }
+  }
+  if (runner_to_cancel) {
+    runner_to_cancel->Cancel();
+  }
+}
+
 RoundRobinTaskRunner::RoundRobinTaskRunner(
     std::unique_ptr<TaskIterator> iterator, int64_t num_consumers,
     string worker_address)
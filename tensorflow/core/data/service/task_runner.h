@@ -15,9 +15,12 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SERVICE_TASK_RUNNER_H_
 #define TENSORFLOW_CORE_DATA_SERVICE_TASK_RUNNER_H_
 
+#include <functional>
 #include <memory>
+#include <string>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/data_transfer.h"
 #include "tensorflow/core/data/service/multi_trainer_cache.h"
@@ -136,6 +139,13 @@ class CachingTaskRunner : public TaskRunner {
   // return a Cancelled status.
   void Cancel() override;
 
+  // Returns the total size in bytes of the cached elements that `trainer_id`
+  // has not read yet.
+  size_t GetUnreadBytes(const std::string& trainer_id) const;
+
+  // Returns the total size in bytes of the cached elements.
+  size_t GetCacheSizeBytes() const;
+
  private:
   // The `GetElementResultSequence` generates a sequence of elements from the
   // `FirstComeFirstServedTaskRunner`. It is used for the `MultiTrainerCache` to
@@ -157,6 +167,84 @@ class CachingTaskRunner : public TaskRunner {
   TF_DISALLOW_COPY_AND_ASSIGN(CachingTaskRunner);
 };
 
+// Sliding-window caches shared by the tasks of different jobs which read the
+// same dataset on one worker. For example, this lets the hyperparameter tuning
+// jobs training on the same preprocessed dataset compute it once, instead of
+// once per job.
+//
+// The tasks are grouped by a key identifying the elements they produce, e.g.
+// the fingerprint of the dataset. The first task for a key creates a
+// `CachingTaskRunner` which produces the elements, and the tasks of the other
+// jobs attach to it. Each job is a trainer of the multi-trainer cache, so jobs
+// read from a sliding window through the dataset, and a job attaching after
+// the window has moved does not see the first elements. Within a job, the
+// elements are provided first-come first-served.
+//
+// The `CrossJobCache` class is thread-safe.
+class CrossJobCache {
+ public:
+  // `max_cache_size_bytes` is the memory budget of each sliding window.
+  explicit CrossJobCache(size_t max_cache_size_bytes);
+  ~CrossJobCache();
+
+  // Attaches the task of `job_id` to the runner for `key`, and stores in `out`
+  // a runner providing the elements of the task. If no task is attached to
+  // `key`, calls `make_iterator` to create the iterator producing them.
+  // Cancelling `out` detaches the task. The runner for `key` is cancelled when
+  // its last task detaches; until then, the requests of `out` which are in
+  // progress when it is cancelled finish once the runner produces their
+  // elements.
+  Status Attach(
+      const std::string& key, int64_t job_id,
+      const std::function<StatusOr<std::unique_ptr<TaskIterator>>()>&
+          make_iterator,
+      std::unique_ptr<TaskRunner>& out) TF_LOCKS_EXCLUDED(mu_);
+
+  // Memory accounting of one job reading a shared cache.
+  struct JobMemoryUsage {
+    // The total size of the elements read by the job.
+    size_t bytes_read = 0;
+    // The total size of the cached elements the job has not read yet.
+    size_t unread_bytes = 0;
+    // The total size of the cached elements, shared by all the jobs reading
+    // the same key.
+    size_t cache_size_bytes = 0;
+  };
+
+  // Returns the memory accounting of `job_id` reading `key`, or a NotFound
+  // error if the job is not attached to `key`.
+  StatusOr<JobMemoryUsage> GetJobMemoryUsage(const std::string& key,
+                                             int64_t job_id) const
+      TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns the number of keys with attached tasks.
+  size_t NumKeys() const TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  class JobTaskRunner;
+
+  struct SharedRunner {
+    std::shared_ptr<CachingTaskRunner> runner;
+    // The jobs attached to `runner`, and the bytes they have read.
+    absl::flat_hash_map<int64_t, size_t> bytes_read_by_job;
+  };
+
+  // Records that `job_id` has read `bytes` from the runner for `key`.
+  void RecordRead(const std::string& key, int64_t job_id, size_t bytes)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  // Detaches `job_id` from the runner for `key`, cancelling the runner if it
+  // was the last job attached to it.
+  void Detach(const std::string& key, int64_t job_id) TF_LOCKS_EXCLUDED(mu_);
+
+  const size_t max_cache_size_bytes_;
+
+  mutable mutex mu_;
+  absl::flat_hash_map<std::string, SharedRunner> runners_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(CrossJobCache);
+};
+
 // An element produced by a task.
 struct Element {
   explicit Element(std::vector<Tensor>&& components, int64_t index)
@@ -14,6 +14,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <string>
 #include <utility>
@@ -493,6 +494,178 @@ TEST(CachingTaskRunnerTest, Errors) {
   }
 }
 
+// Returns a `CrossJobCache::Attach` iterator factory which creates iterators
+// over `range` elements, and counts them in `num_iterators`.
+std::function<StatusOr<std::unique_ptr<TaskIterator>>()> MakeRangeIterator(
+    int64_t range, int& num_iterators) {
+  return [range, &num_iterators]() -> StatusOr<std::unique_ptr<TaskIterator>> {
+    ++num_iterators;
+    return std::unique_ptr<TaskIterator>(
+        absl::make_unique<RangeIterator>(range, /*repeat=*/false));
+  };
+}
+
+TEST(CrossJobCacheTest, JobsShareProducer) {
+  size_t range = 10;
+  size_t num_jobs = 5;
+  int num_iterators = 0;
+  CrossJobCache cache(/*max_cache_size_bytes=*/kLargeCache);
+  std::vector<std::unique_ptr<TaskRunner>> runners(num_jobs);
+  for (size_t i = 0; i < num_jobs; ++i) {
+    TF_ASSERT_OK(cache.Attach("dataset", /*job_id=*/i,
+                              MakeRangeIterator(range, num_iterators),
+                              runners[i]));
+  }
+  EXPECT_EQ(num_iterators, 1);
+  EXPECT_EQ(cache.NumKeys(), 1);
+
+  // Each job reads the whole dataset, without setting trainer IDs.
+  for (auto& runner : runners) {
+    TF_ASSERT_OK_AND_ASSIGN(
+        std::vector<int64_t> output,
+        GetTaskRunnerOutput<int64_t>(*runner, GetElementRequest()));
+    EXPECT_THAT(output, ElementsAreArray(GetRange(range)));
+  }
+}
+
+TEST(CrossJobCacheTest, ElementsAreFirstComeFirstServedWithinJob) {
+  size_t range = 10;
+  int num_iterators = 0;
+  CrossJobCache cache(/*max_cache_size_bytes=*/kLargeCache);
+  std::unique_ptr<TaskRunner> runner1, runner2;
+  TF_ASSERT_OK(cache.Attach("dataset", /*job_id=*/1,
+                            MakeRangeIterator(range, num_iterators), runner1));
+  TF_ASSERT_OK(cache.Attach("dataset", /*job_id=*/2,
+                            MakeRangeIterator(range, num_iterators), runner2));
+
+  GetElementRequest request;
+  for (int64_t i = 0; i < range; i += 2) {
+    // Two consumers of job 1 split its elements.
+    request.set_consumer_index(0);
+    EXPECT_THAT(GetNextFromTaskRunner<int64_t>(*runner1, request),
+                IsOkAndHolds(i));
+    request.set_consumer_index(1);
+    EXPECT_THAT(GetNextFromTaskRunner<int64_t>(*runner1, request),
+                IsOkAndHolds(i + 1));
+  }
+  TF_ASSERT_OK_AND_ASSIGN(std::vector<int64_t> output,
+                          GetTaskRunnerOutput<int64_t>(*runner2, request));
+  EXPECT_THAT(output, ElementsAreArray(GetRange(range)));
+}
+
+TEST(CrossJobCacheTest, DifferentKeysDoNotShare) {
+  size_t range = 10;
+  int num_iterators = 0;
+  CrossJobCache cache(/*max_cache_size_bytes=*/kLargeCache);
+  std::unique_ptr<TaskRunner> runner1, runner2;
+  TF_ASSERT_OK(cache.Attach("dataset 1", /*job_id=*/1,
+                            MakeRangeIterator(range, num_iterators), runner1));
+  TF_ASSERT_OK(cache.Attach("dataset 2", /*job_id=*/2,
+                            MakeRangeIterator(range, num_iterators), runner2));
+  EXPECT_EQ(num_iterators, 2);
+  EXPECT_EQ(cache.NumKeys(), 2);
+}
+
+TEST(CrossJobCacheTest, MemoryAccounting) {
+  size_t range = 10;
+  int num_iterators = 0;
+  CrossJobCache cache(/*max_cache_size_bytes=*/kLargeCache);
+  std::unique_ptr<TaskRunner> fast_runner, slow_runner;
+  TF_ASSERT_OK(cache.Attach("dataset", /*job_id=*/1,
+                            MakeRangeIterator(range, num_iterators),
+                            fast_runner));
+  TF_ASSERT_OK(cache.Attach("dataset", /*job_id=*/2,
+                            MakeRangeIterator(range, num_iterators),
+                            slow_runner));
+  for (int64_t i = 0; i < 5; ++i) {
+    EXPECT_THAT(GetNextFromTaskRunner<int64_t>(*fast_runner,
+                                               GetElementRequest()),
+                IsOkAndHolds(i));
+  }
+  for (int64_t i = 0; i < 2; ++i) {
+    EXPECT_THAT(GetNextFromTaskRunner<int64_t>(*slow_runner,
+                                               GetElementRequest()),
+                IsOkAndHolds(i));
+  }
+
+  TF_ASSERT_OK_AND_ASSIGN(CrossJobCache::JobMemoryUsage fast_usage,
+                          cache.GetJobMemoryUsage("dataset", /*job_id=*/1));
+  TF_ASSERT_OK_AND_ASSIGN(CrossJobCache::JobMemoryUsage slow_usage,
+                          cache.GetJobMemoryUsage("dataset", /*job_id=*/2));
+  // All the elements have the same size.
+  const size_t element_size = fast_usage.bytes_read / 5;
+  EXPECT_GT(element_size, 0);
+  EXPECT_EQ(fast_usage.bytes_read, 5 * element_size);
+  EXPECT_EQ(fast_usage.unread_bytes, 0);
+  EXPECT_EQ(fast_usage.cache_size_bytes, 5 * element_size);
+  EXPECT_EQ(slow_usage.bytes_read, 2 * element_size);
+  EXPECT_EQ(slow_usage.unread_bytes, 3 * element_size);
+  EXPECT_EQ(slow_usage.cache_size_bytes, 5 * element_size);
+
+  EXPECT_THAT(cache.GetJobMemoryUsage("dataset", /*job_id=*/3),
+              testing::StatusIs(error::NOT_FOUND));
+  EXPECT_THAT(cache.GetJobMemoryUsage("other dataset", /*job_id=*/1),
+              testing::StatusIs(error::NOT_FOUND));
+}
+
+TEST(CrossJobCacheTest, LastJobDetachingCancelsProducer) {
+  size_t range = 10;
+  int num_iterators = 0;
+  CrossJobCache cache(/*max_cache_size_bytes=*/kLargeCache);
+  std::unique_ptr<TaskRunner> runner1, runner2;
+  TF_ASSERT_OK(cache.Attach("dataset", /*job_id=*/1,
+                            MakeRangeIterator(range, num_iterators), runner1));
+  TF_ASSERT_OK(cache.Attach("dataset", /*job_id=*/2,
+                            MakeRangeIterator(range, num_iterators), runner2));
+
+  runner1->Cancel();
+  GetElementResult result;
+  EXPECT_THAT(runner1->GetNext(GetElementRequest(), result),
+              testing::StatusIs(error::CANCELLED));
+  EXPECT_THAT(cache.GetJobMemoryUsage("dataset", /*job_id=*/1),
+              testing::StatusIs(error::NOT_FOUND));
+  EXPECT_EQ(cache.NumKeys(), 1);
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::vector<int64_t> output,
+      GetTaskRunnerOutput<int64_t>(*runner2, GetElementRequest()));
+  EXPECT_THAT(output, ElementsAreArray(GetRange(range)));
+
+  runner2.reset();
+  EXPECT_EQ(cache.NumKeys(), 0);
+
+  // A new job creates a new producer.
+  TF_ASSERT_OK(cache.Attach("dataset", /*job_id=*/3,
+                            MakeRangeIterator(range, num_iterators), runner1));
+  EXPECT_EQ(num_iterators, 2);
+  TF_ASSERT_OK_AND_ASSIGN(
+      output, GetTaskRunnerOutput<int64_t>(*runner1, GetElementRequest()));
+  EXPECT_THAT(output, ElementsAreArray(GetRange(range)));
+}
+
+TEST(CrossJobCacheTest, AttachErrors) {
+  int num_iterators = 0;
+  CrossJobCache cache(/*max_cache_size_bytes=*/kLargeCache);
+  std::unique_ptr<TaskRunner> runner;
+  EXPECT_THAT(
+      cache.Attach(
+          "dataset", /*job_id=*/1,
+          []() -> StatusOr<std::unique_ptr<TaskIterator>> {
+            return errors::InvalidArgument("Invalid dataset");
+          },
+          runner),
+      testing::StatusIs(error::INVALID_ARGUMENT));
+  EXPECT_EQ(cache.NumKeys(), 0);
+
+  TF_ASSERT_OK(cache.Attach("dataset", /*job_id=*/1,
+                            MakeRangeIterator(/*range=*/10, num_iterators),
+                            runner));
+  std::unique_ptr<TaskRunner> duplicate_runner;
+  EXPECT_THAT(cache.Attach("dataset", /*job_id=*/1,
+                           MakeRangeIterator(/*range=*/10, num_iterators),
+                           duplicate_runner),
+              testing::StatusIs(error::FAILED_PRECONDITION));
+}
+
 class ConsumeParallelTest
     : public ::testing::Test,
       public ::testing::WithParamInterface<std::tuple<int64_t, int64_t>> {};
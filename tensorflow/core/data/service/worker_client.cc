@@ -24,6 +24,8 @@ limitations under the License.
 #include "grpcpp/security/credentials.h"
 #include "grpcpp/support/channel_arguments.h"
 #include "grpcpp/support/status.h"
+#include "grpcpp/impl/codegen/sync_stream.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/memory/memory.h"
 #include "absl/strings/string_view.h"
@@ -77,7 +79,8 @@ Status DataServiceWorkerClient::EnsureInitialized() {
 }
 
 std::string DataServiceWorkerClient::GetDataTransferProtocol() const {
-  if (transfer_protocol_ == kGrpcTransferProtocol &&
+  if ((transfer_protocol_ == kGrpcTransferProtocol ||
+       transfer_protocol_ == kGrpcStreamingTransferProtocol) &&
       LocalWorkers::Get(address_) != nullptr) {
     return kLocalTransferProtocol;
   }
@@ -88,8 +91,11 @@ void DataServiceWorkerClient::TryCancel() { client_->TryCancel(); }
 
 class GrpcDataTransferClient : public DataTransferClient {
  public:
+  // If `streaming` is true, the client reads the elements of each task from a
+  // `GetElements` stream, except for round-robin reads.
   GrpcDataTransferClient(std::shared_ptr<grpc::ChannelCredentials> credentials,
-                         std::string address) {
+                         std::string address, bool streaming)
+      : streaming_(streaming) {
     VLOG(2) << "Create GrpcDataTransferClient for worker " << address << ".";
     grpc::ChannelArguments args;
     args.SetMaxReceiveMessageSize(-1);
@@ -97,6 +103,15 @@ class GrpcDataTransferClient : public DataTransferClient {
     stub_ = WorkerService::NewStub(channel);
   }
 
+  ~GrpcDataTransferClient() override {
+    mutex_lock l(mu_);
+    for (auto& entry : streams_) {
+      mutex_lock stream_lock(entry.second->mu);
+      entry.second->ctx.TryCancel();
+      entry.second->reader->Finish().IgnoreError();
+    }
+  }
+
   Status GetElement(const GetElementRequest& req,
                     GetElementResult& result) override {
     VLOG(3) << "GetElement for task " << req.task_id() << " from gRPC worker "
@@ -107,6 +122,12 @@ class GrpcDataTransferClient : public DataTransferClient {
         return errors::Cancelled("Client was cancelled.");
       }
     }
+    if (streaming_ &&
+        req.optional_consumer_index_case() !=
+            GetElementRequest::kConsumerIndex &&
+        req.optional_round_index_case() != GetElementRequest::kRoundIndex) {
+      return GetElementFromStream(req, result);
+    }
     grpc::ClientContext ctx;
     {
       mutex_lock l(mu_);
@@ -114,12 +135,52 @@ class GrpcDataTransferClient : public DataTransferClient {
     }
     GetElementResponse resp;
     grpc::Status s = stub_->GetElement(&ctx, req, &resp);
+    {
+      mutex_lock l(mu_);
+      active_contexts_.erase(&ctx);
+    }
+    if (!s.ok()) {
+      return grpc_util::WrapError("Failed to get element", s);
+    }
+    return MoveResponseToResult(resp, result);
+  }
+
+  void TryCancel() override {
+    VLOG(2) << "Cancel GrpcDataTransferClient.";
+    mutex_lock l(mu_);
+    cancelled_ = true;
+    for (const auto& ctx : active_contexts_) {
+      ctx->TryCancel();
+    }
+    for (const auto& entry : streams_) {
+      entry.second->ctx.TryCancel();
+    }
+  }
+
+ private:
+  // The number of elements the worker may prepare ahead of the reads of a
+  // `GetElements` stream.
+  static constexpr int64_t kStreamWindowSize = 16;
+
+  // The `GetElements` stream of a task.
+  struct ElementStream {
+    grpc::ClientContext ctx;
+    mutex mu;
+    std::unique_ptr<grpc::ClientReader<GetElementResponse>> reader
+        TF_GUARDED_BY(mu);
+    // Whether `reader` has been finished, after which the stream is removed
+    // from `streams_`.
+    bool finished TF_GUARDED_BY(mu) = false;
+  };
+
+  static Status MoveResponseToResult(GetElementResponse& resp,
+                                     GetElementResult& result) {
     result.end_of_sequence = resp.end_of_sequence();
     result.skip = resp.skip_task();
     switch (resp.element_case()) {
       case GetElementResponse::kCompressed: {
         Tensor tensor(DT_VARIANT, TensorShape{});
-        tensor.scalar<Variant>()() = std::move(resp.compressed());
+        tensor.scalar<Variant>()() = std::move(*resp.mutable_compressed());
         result.components.push_back(tensor);
         break;
       }
@@ -134,32 +195,76 @@ class GrpcDataTransferClient : public DataTransferClient {
       case GetElementResponse::ELEMENT_NOT_SET:
         break;
     }
-    {
-      mutex_lock l(mu_);
-      active_contexts_.erase(&ctx);
-    }
-    if (!s.ok()) {
-      return grpc_util::WrapError("Failed to get element", s);
-    }
     return Status::OK();
   }
 
-  void TryCancel() override {
-    VLOG(2) << "Cancel GrpcDataTransferClient.";
+  // Returns the stream of `req.task_id()`, opening it if needed.
+  std::shared_ptr<ElementStream> GetOrOpenStream(const GetElementRequest& req)
+      TF_LOCKS_EXCLUDED(mu_) {
     mutex_lock l(mu_);
-    cancelled_ = true;
-    for (const auto& ctx : active_contexts_) {
-      ctx->TryCancel();
+    std::shared_ptr<ElementStream>& stream = streams_[req.task_id()];
+    if (!stream) {
+      VLOG(3) << "Opening a GetElements stream for task " << req.task_id();
+      stream = std::make_shared<ElementStream>();
+      GetElementsRequest stream_req;
+      *stream_req.mutable_request() = req;
+      stream_req.set_window_size(kStreamWindowSize);
+      mutex_lock stream_lock(stream->mu);
+      stream->reader = stub_->GetElements(&stream->ctx, stream_req);
     }
+    return stream;
   }
 
- private:
+  Status GetElementFromStream(const GetElementRequest& req,
+                              GetElementResult& result) {
+    while (true) {
+      std::shared_ptr<ElementStream> stream = GetOrOpenStream(req);
+      GetElementResponse resp;
+      bool read;
+      grpc::Status s;
+      {
+        mutex_lock l(stream->mu);
+        if (stream->finished) {
+          // Another read finished the stream while this one was waiting.
+          continue;
+        }
+        read = stream->reader->Read(&resp);
+        if (read && !resp.end_of_sequence()) {
+          return MoveResponseToResult(resp, result);
+        }
+        // The worker ends the stream after the end of sequence, or on errors.
+        s = stream->reader->Finish();
+        stream->finished = true;
+      }
+      {
+        mutex_lock l(mu_);
+        auto it = streams_.find(req.task_id());
+        if (it != streams_.end() && it->second == stream) {
+          streams_.erase(it);
+        }
+      }
+      if (!s.ok()) {
+        return grpc_util::WrapError("Failed to get element", s);
+      }
+      if (!read) {
+        return errors::Unavailable("The GetElements stream of task ",
+                                   req.task_id(),
+                                   " ended before the end of sequence.");
+      }
+      return MoveResponseToResult(resp, result);
+    }
+  }
+
+  const bool streaming_;
   mutex mu_;
   std::unique_ptr<WorkerService::Stub> stub_;
   // Set of all currently active clients contexts. Used to support
   // cancellation.
   absl::flat_hash_set<::grpc::ClientContext*> active_contexts_
       TF_GUARDED_BY(mu_);
+  // The open `GetElements` streams, keyed by task ID.
+  absl::flat_hash_map<int64_t, std::shared_ptr<ElementStream>> streams_
+      TF_GUARDED_BY(mu_);
   // Indicates that the client has been cancelled, so no further requests should
   // be accepted.
   bool cancelled_ TF_GUARDED_BY(mu_) = false;
@@ -168,16 +273,19 @@ class GrpcDataTransferClient : public DataTransferClient {
 class GrpcTransferClientRegistrar {
  public:
   GrpcTransferClientRegistrar() {
-    DataTransferClient::Register(
-        kGrpcTransferProtocol, [](DataTransferClient::Config config,
-                                  std::unique_ptr<DataTransferClient>* out) {
-          std::shared_ptr<grpc::ChannelCredentials> credentials;
-          TF_RETURN_IF_ERROR(CredentialsFactory::CreateClientCredentials(
-              config.protocol, &credentials));
-          *out = std::make_unique<GrpcDataTransferClient>(credentials,
-                                                          config.address);
-          return Status::OK();
-        });
+    for (bool streaming : {false, true}) {
+      DataTransferClient::Register(
+          streaming ? kGrpcStreamingTransferProtocol : kGrpcTransferProtocol,
+          [streaming](DataTransferClient::Config config,
+                      std::unique_ptr<DataTransferClient>* out) {
+            std::shared_ptr<grpc::ChannelCredentials> credentials;
+            TF_RETURN_IF_ERROR(CredentialsFactory::CreateClientCredentials(
+                config.protocol, &credentials));
+            *out = std::make_unique<GrpcDataTransferClient>(
+                credentials, config.address, streaming);
+            return Status::OK();
+          });
+    }
   }
 };
 static GrpcTransferClientRegistrar gprc_client_registrar;
@@ -31,6 +31,11 @@ namespace data {
 
 constexpr const char kLocalTransferProtocol[] = "local";
 constexpr const char kGrpcTransferProtocol[] = "grpc";
+// Like `kGrpcTransferProtocol`, but reads the elements of each task from one
+// `GetElements` stream instead of one RPC per element. The worker prepares
+// several elements ahead of the reads. Round-robin reads still use one RPC per
+// element.
+constexpr const char kGrpcStreamingTransferProtocol[] = "grpc_streaming";
 
 // Client for communicating with the tf.data service worker.
 class DataServiceWorkerClient : public DataServiceClientBase {
@@ -185,6 +185,40 @@ TEST_F(WorkerClientTest, GrpcRead) {
                        MatchesRegex("Local worker.*is no longer available.*")));
 }
 
+TEST_F(WorkerClientTest, GrpcStreamingRead) {
+  const int64_t range = 5;
+  TF_ASSERT_OK_AND_ASSIGN(const int64_t dataset_id, RegisterDataset(range));
+  TF_ASSERT_OK_AND_ASSIGN(const int64_t job_client_id, CreateJob(dataset_id));
+  TF_ASSERT_OK_AND_ASSIGN(const int64_t task_id, GetTaskToRead(job_client_id));
+  // Remove the local worker from `LocalWorkers` so the client reads through the
+  // `GetElements` stream instead of taking the local shortcut.
+  LocalWorkers::Remove(GetWorkerAddress());
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<DataServiceWorkerClient> client,
+                          GetWorkerClient(kGrpcStreamingTransferProtocol));
+  for (int64_t i = 0; i < range; ++i) {
+    TF_ASSERT_OK_AND_ASSIGN(GetElementResult result,
+                            GetElement(*client, task_id));
+    test::ExpectEqual(result.components[0], Tensor(int64_t{i * i}));
+    EXPECT_FALSE(result.end_of_sequence);
+  }
+  TF_ASSERT_OK_AND_ASSIGN(GetElementResult result,
+                          GetElement(*client, task_id));
+  EXPECT_TRUE(result.end_of_sequence);
+}
+
+TEST_F(WorkerClientTest, GrpcStreamingReadEmptyDataset) {
+  TF_ASSERT_OK_AND_ASSIGN(const int64_t dataset_id,
+                          RegisterDataset(/*range=*/0));
+  TF_ASSERT_OK_AND_ASSIGN(const int64_t job_client_id, CreateJob(dataset_id));
+  TF_ASSERT_OK_AND_ASSIGN(const int64_t task_id, GetTaskToRead(job_client_id));
+  LocalWorkers::Remove(GetWorkerAddress());
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<DataServiceWorkerClient> client,
+                          GetWorkerClient(kGrpcStreamingTransferProtocol));
+  TF_ASSERT_OK_AND_ASSIGN(GetElementResult result,
+                          GetElement(*client, task_id));
+  EXPECT_TRUE(result.end_of_sequence);
+}
+
 TEST_F(WorkerClientTest, LocalServerShutsDown) {
   TF_ASSERT_OK_AND_ASSIGN(const int64_t dataset_id,
                           RegisterDataset(/*range=*/5));
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/data/service/worker_impl.h"
 
+#include <deque>
+#include <functional>
 #include <memory>
 #include <string>
 #include <utility>
@@ -22,12 +24,14 @@ limitations under the License.
 #include "grpcpp/create_channel.h"
 #include "absl/algorithm/container.h"
 #include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
 #include "absl/strings/substitute.h"
 #include "tensorflow/c/c_api_internal.h"
 #include "tensorflow/c/tf_status_helper.h"
 #include "tensorflow/core/data/dataset.pb.h"
+#include "tensorflow/core/data/hash_utils.h"
 #include "tensorflow/core/data/service/auto_shard_rewriter.h"
 #include "tensorflow/core/data/service/common.h"
 #include "tensorflow/core/data/service/common.pb.h"
@@ -57,6 +61,7 @@ limitations under the License.
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/protobuf/service_config.pb.h"
 #include "tensorflow/core/public/session_options.h"
 
@@ -67,6 +72,10 @@ namespace {
 constexpr int64_t kRetryIntervalMicros = 5 * 1000 * 1000;        // 5 seconds.
 constexpr int64_t kDefaultHeartBeatIntervalMs = 30 * 1000;       // 30 seconds.
 constexpr int64_t kDefaultDispatcherTimeoutMs = 60 * 60 * 1000;  // 1 hour.
+constexpr int64_t kDefaultElementStreamWindowSize = 8;
+// The threads of a `GetElements` stream: one gets the elements, and the others
+// build the responses.
+constexpr int kElementStreamThreads = 4;
 
 using WorkerConfig = experimental::WorkerConfig;
 
@@ -95,6 +104,102 @@ Status MoveElementToResponse(std::vector<Tensor>&& element,
   return Status::OK();
 }
 
+// Pipelines the responses of a `GetElements` stream. One thread gets the
+// elements of the task in order, and the other threads of the pool move them
+// into responses, which `GetNext` returns in order. At most `window_size`
+// responses are in progress or waiting for `GetNext`.
+class ElementStream {
+ public:
+  using GetElementFn = std::function<Status(GetElementResult&)>;
+
+  ElementStream(int64_t window_size, GetElementFn get_element)
+      : window_size_(window_size),
+        get_element_(std::move(get_element)),
+        thread_pool_(Env::Default(), "tf_data_service_element_stream",
+                     kElementStreamThreads) {
+    thread_pool_.Schedule([this]() { GetElements(); });
+  }
+
+  // Cancels the stream. The destructor of `thread_pool_` then waits for the
+  // element in progress, if any.
+  ~ElementStream() {
+    mutex_lock l(mu_);
+    cancelled_ = true;
+    cv_.notify_all();
+  }
+
+  // Stores the next response in `response`, blocking until it is ready.
+  // REQUIRES: No previous response was an end of sequence.
+  Status GetNext(GetElementResponse& response) {
+    mutex_lock l(mu_);
+    while (responses_.empty() || !responses_.front()->ready) {
+      cv_.wait(l);
+    }
+    std::shared_ptr<PendingResponse> next = std::move(responses_.front());
+    responses_.pop_front();
+    cv_.notify_all();
+    TF_RETURN_IF_ERROR(next->status);
+    response = std::move(next->response);
+    return Status::OK();
+  }
+
+ private:
+  struct PendingResponse {
+    bool ready = false;
+    Status status;
+    GetElementResponse response;
+  };
+
+  // Gets the elements of the task until the end of sequence or an error.
+  void GetElements() TF_LOCKS_EXCLUDED(mu_) {
+    while (true) {
+      auto pending = std::make_shared<PendingResponse>();
+      {
+        mutex_lock l(mu_);
+        while (!cancelled_ && responses_.size() >= window_size_) {
+          cv_.wait(l);
+        }
+        if (cancelled_) {
+          return;
+        }
+        responses_.push_back(pending);
+      }
+      GetElementResult result;
+      Status s = get_element_(result);
+      if (!s.ok() || result.end_of_sequence) {
+        mutex_lock l(mu_);
+        pending->status = s;
+        pending->response.set_end_of_sequence(result.end_of_sequence);
+        pending->ready = true;
+        cv_.notify_all();
+        return;
+      }
+      thread_pool_.Schedule(
+          [this, pending, components = std::move(result.components)]() mutable {
+            Status s =
+                MoveElementToResponse(std::move(components), pending->response);
+            mutex_lock l(mu_);
+            pending->status = s;
+            pending->ready = true;
+            cv_.notify_all();
+          });
+    }
+  }
+
+  const int64_t window_size_;
+  const GetElementFn get_element_;
+
+  mutex mu_;
+  condition_variable cv_;
+  bool cancelled_ TF_GUARDED_BY(mu_) = false;
+  // The responses in the order of their elements.
+  std::deque<std::shared_ptr<PendingResponse>> responses_ TF_GUARDED_BY(mu_);
+
+  // Destroyed first, so that its threads finish before the other members are
+  // destroyed.
+  thread::ThreadPool thread_pool_;
+};
+
 WorkerConfig ApplyWorkerDefaults(const WorkerConfig& config) {
   WorkerConfig new_config(config);
   if (new_config.heartbeat_interval_ms() == 0) {
@@ -114,6 +219,10 @@ LocalWorkers::AddressToWorkerMap* LocalWorkers::local_workers_ =
 DataServiceWorkerImpl::DataServiceWorkerImpl(const WorkerConfig& config)
     : config_(ApplyWorkerDefaults(config)), worker_uid_(port::JobUid()) {
   metrics::RecordTFDataServiceWorkerCreated();
+  if (config_.cross_job_cache_size_bytes() > 0) {
+    cross_job_cache_ =
+        absl::make_unique<CrossJobCache>(config_.cross_job_cache_size_bytes());
+  }
 }
 
 DataServiceWorkerImpl::~DataServiceWorkerImpl() {
@@ -283,20 +392,41 @@ Status DataServiceWorkerImpl::EnsureTaskInitialized(
     return Status::OK();
   }
   TF_ASSIGN_OR_RETURN(DatasetDef dataset_def, GetDatasetDef(task.task_def));
-  TF_ASSIGN_OR_RETURN(std::unique_ptr<standalone::Dataset> dataset,
-                      MakeDataset(dataset_def, task.task_def));
-  TF_ASSIGN_OR_RETURN(std::unique_ptr<standalone::Iterator> iterator,
-                      MakeDatasetIterator(*dataset, task.task_def));
-  auto task_iterator = absl::make_unique<StandaloneTaskIterator>(
-      std::move(dataset), std::move(iterator));
-  TF_RETURN_IF_ERROR(TaskRunner::Create(
-      config_, task.task_def, std::move(task_iterator), task.task_runner));
+  auto make_iterator = [&]() -> StatusOr<std::unique_ptr<TaskIterator>> {
+    TF_ASSIGN_OR_RETURN(std::unique_ptr<standalone::Dataset> dataset,
+                        MakeDataset(dataset_def, task.task_def));
+    TF_ASSIGN_OR_RETURN(std::unique_ptr<standalone::Iterator> iterator,
+                        MakeDatasetIterator(*dataset, task.task_def));
+    return std::unique_ptr<TaskIterator>(
+        absl::make_unique<StandaloneTaskIterator>(std::move(dataset),
+                                                  std::move(iterator)));
+  };
+  if (cross_job_cache_ && IsCrossJobCacheable(task.task_def)) {
+    uint64 fingerprint;
+    TF_RETURN_IF_ERROR(HashGraph(dataset_def.graph(), &fingerprint));
+    TF_RETURN_IF_ERROR(cross_job_cache_->Attach(
+        absl::StrCat(fingerprint), task.task_def.job_id(), make_iterator,
+        task.task_runner));
+  } else {
+    TF_ASSIGN_OR_RETURN(std::unique_ptr<TaskIterator> task_iterator,
+                        make_iterator());
+    TF_RETURN_IF_ERROR(TaskRunner::Create(
+        config_, task.task_def, std::move(task_iterator), task.task_runner));
+  }
 
   task.initialized = true;
   VLOG(3) << "Created iterator for task " << task.task_def.task_id();
   return Status::OK();
 }
 
+bool DataServiceWorkerImpl::IsCrossJobCacheable(const TaskDef& task_def) const {
+  // With sharding, or with round-robin reads, the tasks of different jobs
+  // produce different elements.
+  return IsNoShard(task_def.processing_mode_def()) &&
+         task_def.optional_num_consumers_case() ==
+             TaskDef::OPTIONAL_NUM_CONSUMERS_NOT_SET;
+}
+
 StatusOr<DatasetDef> DataServiceWorkerImpl::GetDatasetDef(
     const TaskDef& task_def) const {
   switch (task_def.dataset_case()) {
@@ -390,6 +520,41 @@ Status DataServiceWorkerImpl::GetElement(const GetElementRequest* request,
   return Status::OK();
 }
 
+Status DataServiceWorkerImpl::GetElements(
+    const GetElementsRequest* request,
+    const std::function<Status(const GetElementResponse&)>& write) {
+  const GetElementRequest& element_request = request->request();
+  VLOG(3) << "Received GetElements request for task "
+          << element_request.task_id();
+  if (element_request.optional_consumer_index_case() ==
+          GetElementRequest::kConsumerIndex ||
+      element_request.optional_round_index_case() ==
+          GetElementRequest::kRoundIndex) {
+    return errors::InvalidArgument(
+        "GetElements does not support round-robin reads, but got a request "
+        "for consumer ",
+        element_request.consumer_index(), " in round ",
+        element_request.round_index(), " of task ", element_request.task_id(),
+        ".");
+  }
+  const int64_t window_size = request->window_size() > 0
+                                  ? request->window_size()
+                                  : kDefaultElementStreamWindowSize;
+  ElementStream stream(
+      window_size, [this, &element_request](struct GetElementResult& result) {
+        return GetElementResult(&element_request, &result);
+      });
+  while (true) {
+    GetElementResponse response;
+    TF_RETURN_IF_ERROR(stream.GetNext(response));
+    TF_RETURN_IF_ERROR(write(response));
+    if (response.end_of_sequence()) {
+      VLOG(3) << "Finished streaming task " << element_request.task_id();
+      return Status::OK();
+    }
+  }
+}
+
 Status DataServiceWorkerImpl::GetWorkerTasks(
     const GetWorkerTasksRequest* request, GetWorkerTasksResponse* response) {
   mutex_lock l(mu_);
@@ -492,6 +657,7 @@ Status DataServiceWorkerImpl::Heartbeat() TF_LOCKS_EXCLUDED(mu_) {
   request.set_transfer_address(transfer_address_);
   *request.mutable_worker_tags() = config_.worker_tags();
   request.set_worker_uid(worker_uid_);
+  request.set_worker_locality(config_.worker_locality());
   *request.mutable_current_tasks() = {current_tasks.begin(),
                                       current_tasks.end()};
   TF_ASSIGN_OR_RETURN(WorkerHeartbeatResponse response,
@@ -572,6 +738,16 @@ bool LocalWorkers::Empty() {
   return local_workers_->empty();
 }
 
+std::string LocalWorkers::Locality() {
+  tf_shared_lock l(mu_);
+  for (const auto& worker : *local_workers_) {
+    if (!worker.second->locality().empty()) {
+      return worker.second->locality();
+    }
+  }
+  return "";
+}
+
 void LocalWorkers::Remove(absl::string_view worker_address) {
   VLOG(1) << "Remove local worker at address " << worker_address;
   mutex_lock l(mu_);
@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SERVICE_WORKER_IMPL_H_
 #define TENSORFLOW_CORE_DATA_SERVICE_WORKER_IMPL_H_
 
+#include <functional>
 #include <memory>
 #include <string>
 #include <utility>
@@ -69,6 +70,9 @@ class DataServiceWorkerImpl {
   // method is not visible to gRPC clients.
   void DeleteLocalTask(const TaskInfo& task_info);
 
+  // Returns the locality of the worker. See `WorkerConfig.worker_locality`.
+  const std::string& locality() const { return config_.worker_locality(); }
+
   // See worker.proto for API documentation.
 
   /// Dispatcher-facing API.
@@ -78,6 +82,13 @@ class DataServiceWorkerImpl {
   /// Client-facing API.
   Status GetElement(const GetElementRequest* request,
                     GetElementResponse* response);
+  // Calls `write` with the responses of `request`, up to and including the end
+  // of sequence. The responses are prepared on a separate thread pool, up to
+  // `request->window_size()` elements ahead of `write`. Returns the first error
+  // of `write`, if any.
+  Status GetElements(
+      const GetElementsRequest* request,
+      const std::function<Status(const GetElementResponse&)>& write);
   Status GetWorkerTasks(const GetWorkerTasksRequest* request,
                         GetWorkerTasksResponse* response);
 
@@ -109,6 +120,9 @@ class DataServiceWorkerImpl {
   void HeartbeatThread() TF_LOCKS_EXCLUDED(mu_);
   // Performs a heartbeat to the dispatcher.
   Status Heartbeat() TF_LOCKS_EXCLUDED(mu_);
+  // Returns whether the task can share its elements with the tasks of other
+  // jobs reading the same dataset through `cross_job_cache_`.
+  bool IsCrossJobCacheable(const TaskDef& task_def) const;
   // Gets the DatasetDef for `task_def`.
   StatusOr<DatasetDef> GetDatasetDef(const TaskDef& task_def) const;
   // Creates a dataset from `dataset_def`.
@@ -127,6 +141,11 @@ class DataServiceWorkerImpl {
   std::string transfer_address_;
   std::unique_ptr<DataServiceDispatcherClient> dispatcher_;
 
+  // Producers shared by the tasks of different jobs which read the same
+  // dataset, or null if `config_.cross_job_cache_size_bytes()` is not positive.
+  // It outlives `tasks_`, whose runners detach from it when destroyed.
+  std::unique_ptr<CrossJobCache> cross_job_cache_;
+
   mutex mu_;
   condition_variable cv_;
   // Information about tasks, keyed by task ids. The tasks are updated based on
@@ -173,6 +192,10 @@ class LocalWorkers {
   // Returns if there are any local workers in the process.
   static bool Empty();
 
+  // Returns the locality of a local worker, which clients in the process use as
+  // their own. Returns an empty string if no local worker has a locality.
+  static std::string Locality();
+
   // Removes a worker at `worker_address`. It is no-op if a worker is not found
   // at the address.
   static void Remove(absl::string_view worker_address);
@@ -20,8 +20,12 @@ limitations under the License.
 #include <queue>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/memory/memory.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/strip.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/framework/dataset.h"
@@ -966,6 +970,28 @@ Status ReadMetadataFile(Env* env, const string& dir,
   }
 }
 
+Status DeleteUncommittedCheckpoints(Env* env, const std::string& run_directory,
+                                    uint64 num_committed_checkpoints) {
+  std::vector<std::string> checkpoint_files;
+  TF_RETURN_IF_ERROR(env->GetMatchingPaths(
+      io::JoinPath(run_directory, absl::StrCat("*", kShardDirectorySuffix),
+                   "*.snapshot"),
+      &checkpoint_files));
+  for (const std::string& checkpoint_file : checkpoint_files) {
+    absl::string_view checkpoint_id_str = io::Basename(checkpoint_file);
+    absl::ConsumeSuffix(&checkpoint_id_str, ".snapshot");
+    uint64 checkpoint_id;
+    if (!absl::SimpleAtoi(checkpoint_id_str, &checkpoint_id)) {
+      return errors::DataLoss("Unexpected snapshot checkpoint file ",
+                              checkpoint_file);
+    }
+    if (checkpoint_id >= num_committed_checkpoints) {
+      TF_RETURN_IF_ERROR(env->DeleteFile(checkpoint_file));
+    }
+  }
+  return Status::OK();
+}
+
 Status DumpDatasetGraph(Env* env, const std::string& path, uint64 hash,
                         const GraphDef* graph) {
   std::string hash_hex =
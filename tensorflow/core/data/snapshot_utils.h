@@ -320,6 +320,12 @@ Status ReadMetadataFile(Env* env, const string& dir,
                         experimental::SnapshotMetadataRecord* metadata,
                         bool* file_exists);
 
+// Deletes the checkpoint files in the shards of `run_directory` whose IDs are
+// at least `num_committed_checkpoints`. An interrupted writer may have left
+// them partially written.
+Status DeleteUncommittedCheckpoints(Env* env, const std::string& run_directory,
+                                    uint64 num_committed_checkpoints);
+
 // Writes a dataset graph to the given directory.
 Status DumpDatasetGraph(Env* env, const std::string& path, uint64 hash,
                         const GraphDef* graph);
@@ -91,6 +91,35 @@ TEST(SnapshotUtilTest, CombinationRoundTripTest) {
   SnapshotRoundTrip(io::compression::kSnappy, 2);
 }
 
+TEST(SnapshotUtilTest, DeleteUncommittedCheckpoints) {
+  Env* env = Env::Default();
+  std::string run_dir;
+  EXPECT_TRUE(env->LocalTempFilename(&run_dir));
+  std::vector<std::string> committed, uncommitted;
+  for (int64_t shard_id : {0, 1}) {
+    const std::string shard_dir = ShardDirectory(run_dir, shard_id);
+    TF_ASSERT_OK(env->RecursivelyCreateDir(shard_dir));
+    for (uint64 checkpoint_id : {0, 1, 2}) {
+      const std::string filename =
+          GetCheckpointFileName(shard_dir, checkpoint_id);
+      TF_ASSERT_OK(WriteStringToFile(env, filename, "data"));
+      (checkpoint_id < 2 ? committed : uncommitted).push_back(filename);
+    }
+  }
+
+  TF_ASSERT_OK(DeleteUncommittedCheckpoints(env, run_dir,
+                                            /*num_committed_checkpoints=*/2));
+  for (const std::string& filename : committed) {
+    TF_EXPECT_OK(env->FileExists(filename));
+  }
+  for (const std::string& filename : uncommitted) {
+    EXPECT_TRUE(errors::IsNotFound(env->FileExists(filename)));
+  }
+  int64_t undeleted_files, undeleted_dirs;
+  TF_ASSERT_OK(env->DeleteRecursively(run_dir, &undeleted_files,
+                                      &undeleted_dirs));
+}
+
 void SnapshotReaderBenchmarkLoop(::testing::benchmark::State& state,
                                  std::string compression_type, int version) {
   tensorflow::DataTypeVector dtypes;
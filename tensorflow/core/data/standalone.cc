@@ -60,6 +60,8 @@ Status Iterator::GetNext(std::vector<Tensor>* outputs, bool* end_of_input) {
   return iterator_->GetNext(ctx_.get(), outputs, end_of_input);
 }
 
+std::shared_ptr<model::Model> Iterator::model() const { return ctx_->model(); }
+
 Iterator::Iterator(IteratorBase* iterator, IteratorContext* ctx)
     : iterator_(iterator), ctx_(ctx) {}
 
@@ -137,6 +139,7 @@ Status Dataset::MakeIterator(
   IteratorContext::Params params(&op_ctx);
   params.cancellation_manager = &cancellation_manager_;
   params.function_handle_cache = function_handle_cache_.get();
+  params.model = std::make_shared<model::Model>();
   params.resource_mgr = &resource_mgr_;
   std::move(split_providers.begin(), split_providers.end(),
             std::back_inserter(params.split_providers));
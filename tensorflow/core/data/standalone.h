@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/core/data/unbounded_thread_pool.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/function_handle_cache.h"
+#include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/public/session_options.h"
 
@@ -74,6 +75,10 @@ class Iterator {
   // indication of whether the end of the input pipeline has been reached.
   Status GetNext(std::vector<Tensor>* outputs, bool* end_of_input);
 
+  // Returns the performance model of the input pipeline. Its tunable
+  // parameters are only optimized if autotuning is enabled for the dataset.
+  std::shared_ptr<model::Model> model() const;
+
  private:
   friend class Dataset;
 
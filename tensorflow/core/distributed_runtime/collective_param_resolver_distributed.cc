@@ -21,10 +21,12 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/device_resolver_distributed.h"
 #include "tensorflow/core/distributed_runtime/worker_cache.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow/core/util/device_name_utils.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace {
@@ -84,6 +86,28 @@ class CompleteInstanceCall : public CancellableCall {
   CompleteInstanceResponse resp_;
 };
 
+// Returns true if resolving the instance of `cp` needs the group leader. Only
+// broadcasts do, to learn the source rank. All other parameters of an instance,
+// including the device order, derive from its group, which is resolved once and
+// cached, so collectives with a new instance key per step, e.g.
+// CollectiveReduceV2, don't pay a round trip to the leader per key.
+bool InstanceNeedsLeader(const CollectiveParams& cp) {
+  return cp.instance.type == BROADCAST_COLLECTIVE;
+}
+
+// Returns how often a non-leader checks a cached group with the leader, from
+// TF_COLLECTIVE_GROUP_REFRESH_INTERVAL_SECS. 0 checks at every resolution.
+int64_t GroupRefreshIntervalMicros() {
+  int64_t secs;
+  Status s = ReadInt64FromEnvVar("TF_COLLECTIVE_GROUP_REFRESH_INTERVAL_SECS",
+                                 60, &secs);
+  if (!s.ok()) {
+    LOG(WARNING) << s;
+    secs = 60;
+  }
+  return secs * 1000000;
+}
+
 }  // namespace
 
 CollectiveParamResolverDistributed::CollectiveParamResolverDistributed(
@@ -96,7 +120,8 @@ CollectiveParamResolverDistributed::CollectiveParamResolverDistributed(
       worker_cache_(worker_cache),
       group_leader_(task_name == config.experimental().collective_group_leader()
                         ? ""
-                        : config.experimental().collective_group_leader()) {
+                        : config.experimental().collective_group_leader()),
+      group_refresh_interval_micros_(GroupRefreshIntervalMicros()) {
   VLOG(1) << "CompleteParamResolverDistributed ctor task={" << task_name
           << "} config.collective_group_leader={"
           << config.experimental().collective_group_leader() << "}"
@@ -212,6 +237,20 @@ CollectiveParamResolverDistributed::GetCachedGroup(int32_t group_key) {
   return it->second.get();
 }
 
+bool CollectiveParamResolverDistributed::ShouldRefreshGroup(
+    int32_t group_key) {
+  const uint64 now_micros = Env::Default()->NowMicros();
+  mutex_lock l(group_mu_);
+  uint64& refreshed_micros = group_refreshed_micros_[group_key];
+  if (refreshed_micros != 0 &&
+      now_micros - refreshed_micros <
+          static_cast<uint64>(group_refresh_interval_micros_)) {
+    return false;
+  }
+  refreshed_micros = now_micros;
+  return true;
+}
+
 Status CollectiveParamResolverDistributed::UpdateGroupCache(
     const CompleteGroupResponse& resp) {
   // Build a new record from resp.
@@ -243,8 +282,8 @@ Status CollectiveParamResolverDistributed::UpdateGroupCache(
   }
   GroupRec* previous_gr = nullptr;
   {
-    // Group membership should never change. Once a record is in group_table_
-    // it never gets removed.
+    // Once a record is in group_table_ it never gets removed. If the leader
+    // reports a different membership, the cached record is invalidated below.
     mutex_lock l(group_mu_);
     auto it = group_table_.find(resp.group_key());
     if (it == group_table_.end()) {
@@ -257,6 +296,24 @@ Status CollectiveParamResolverDistributed::UpdateGroupCache(
   }
   if (previous_gr != nullptr) {
     mutex_lock grl(previous_gr->mu);
+    if (!previous_gr->status.ok()) {
+      return previous_gr->status;
+    }
+    // Instances are resolved from the cached group without asking the leader,
+    // so a member that restarted since must fail all later collectives of the
+    // group instead of letting them run with stale devices.
+    for (const DeviceAttributes& device : resp.device_attributes()) {
+      auto it = previous_gr->incarnations_by_device_name.find(device.name());
+      if (it == previous_gr->incarnations_by_device_name.end() ||
+          it->second != device.incarnation()) {
+        previous_gr->status = errors::FailedPrecondition(
+            "UpdateGroupCache: CompleteGroupResponse for group ",
+            resp.group_key(), " has device ", device.name(),
+            " which is not a member of the cached group with the same "
+            "incarnation. This usually means a worker has restarted.");
+        return previous_gr->status;
+      }
+    }
     if (previous_gr->group.runtime_details.communicator_key !=
         resp.communicator_key()) {
       return errors::Internal(
@@ -279,8 +336,12 @@ void CollectiveParamResolverDistributed::CompleteGroupDistributed(
   if (group_leader_.empty()) {
     // This is the group leader, so resolution is local.
     return CompleteGroupLocal(device, group_params, cancel_mgr, done);
-  } else if (GetCachedGroup(group_params->group_key) == nullptr) {
-    // Need to update Group cache from the leader.
+  }
+  const bool refresh = ShouldRefreshGroup(group_params->group_key);
+  GroupRec* cached_gr = GetCachedGroup(group_params->group_key);
+  if (cached_gr == nullptr || refresh) {
+    // Need to update Group cache from the leader. A cached group is checked
+    // with the leader too, which fails the group if a member restarted.
     CompleteGroupCall* call = new CompleteGroupCall(
         *group_params, device, cancel_mgr, group_leader_, worker_cache_);
     CancellationToken abortion_token =
@@ -293,7 +354,7 @@ void CollectiveParamResolverDistributed::CompleteGroupDistributed(
       return;
     }
     call->Start([this, device, group_params, call, cancel_mgr, abortion_token,
-                 done](const Status& s) {
+                 cached_gr, done](const Status& s) {
       abortion_cancel_mgr_.DeregisterCallback(abortion_token);
       if (s.ok()) {
         Status status = UpdateGroupCache(call->resp_);
@@ -303,14 +364,20 @@ void CollectiveParamResolverDistributed::CompleteGroupDistributed(
           done(status);
         }
       } else {
+        if (cached_gr != nullptr && errors::IsFailedPrecondition(s)) {
+          // The leader fails a group once one of its members restarted.
+          mutex_lock l(cached_gr->mu);
+          if (cached_gr->status.ok()) {
+            cached_gr->status = s;
+          }
+        }
         done(s);
       }
       delete call;
     });
     return;
-  } else {
-    return CompleteGroupLocal(device, group_params, cancel_mgr, done);
   }
+  CompleteGroupLocal(device, group_params, cancel_mgr, done);
 }
 
 bool CollectiveParamResolverDistributed::InstanceIsCached(
@@ -366,7 +433,8 @@ void CollectiveParamResolverDistributed::CompleteInstanceDistributed(
   if (group_leader_.empty()) {
     // This is the group leader so resolution is local.
     return CompleteInstanceLocal(device, cp, done);
-  } else if (InstanceIsCached(cp->group.group_key, cp->instance.instance_key)) {
+  } else if (!InstanceNeedsLeader(*cp) ||
+             InstanceIsCached(cp->group.group_key, cp->instance.instance_key)) {
     return CompleteInstanceLocal(device, cp, done);
   } else {
     CompleteInstanceCall* call = new CompleteInstanceCall(
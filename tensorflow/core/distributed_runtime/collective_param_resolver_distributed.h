@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_COLLECTIVE_PARAM_RESOLVER_DISTRIBUTED_H_
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_COLLECTIVE_PARAM_RESOLVER_DISTRIBUTED_H_
 
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/common_runtime/collective_param_resolver_local.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
@@ -59,6 +60,11 @@ class CollectiveParamResolverDistributed : public CollectiveParamResolverLocal {
   Status UpdateGroupCache(const CompleteGroupResponse& resp)
       TF_LOCKS_EXCLUDED(group_mu_);
 
+  // Returns true if a group resolved from group_table_ should be checked
+  // with the leader, which is the case once per
+  // `group_refresh_interval_micros_`, and records that it is.
+  bool ShouldRefreshGroup(int32_t group_key) TF_LOCKS_EXCLUDED(group_mu_);
+
   // Finds the GroupRec that corresponds to cp->group_key and also
   // populates cp->group from that GroupRec.
   //
@@ -90,6 +96,13 @@ class CollectiveParamResolverDistributed : public CollectiveParamResolverLocal {
   WorkerCacheInterface* worker_cache_;  // Not owned
   const string group_leader_;
   CancellationManager abortion_cancel_mgr_;
+
+  // Instances of a cached group other than broadcasts are resolved without
+  // the leader, so the group is checked with the leader periodically to find
+  // out about members that restarted.
+  int64_t group_refresh_interval_micros_;
+  absl::flat_hash_map<int32_t, uint64> group_refreshed_micros_
+      TF_GUARDED_BY(group_mu_);
 };
 
 }  // namespace tensorflow
@@ -372,6 +372,92 @@ TEST_F(DeviceResDistTest, BroadcastSourceRank3) {
   ValidateCollectiveParams(num_workers, num_devices);
 }
 
+TEST_F(DeviceResDistTest, NewInstancesFromCachedGroup) {
+  const int num_workers = 2;
+  const int num_devices = 1;
+  DefineWorkers(num_workers, num_devices, "CPU", /*nccl*/ false);
+  DefineCollectiveParams(num_workers, num_devices, "CPU");
+  IssueRequests(num_workers, num_devices);
+  ValidateCollectiveParams(num_workers, num_devices);
+
+  // Once the group is cached, task 1 resolves reductions with new instance
+  // keys without the leader, but broadcasts still need it.
+  cp_resolvers_["/job:worker/replica:0/task:0"]->StartAbort(
+      errors::Cancelled("leader aborted"));
+  const string task_name = "/job:worker/replica:0/task:1";
+  const string device_name = absl::StrCat(task_name, "/device:CPU:0");
+  for (CollectiveType coll_type :
+       {REDUCTION_COLLECTIVE, GATHER_COLLECTIVE, BROADCAST_COLLECTIVE}) {
+    cp_[device_name]->Unref();
+    cp_[device_name] = CreateCollectiveParams(
+        num_workers, num_devices, "CPU", coll_type, /*is_source=*/false);
+    cp_[device_name]->instance.instance_key = 100 + coll_type;
+    Notification note;
+    Status status;
+    cp_resolvers_[task_name]->CompleteParamsAsync(
+        device_mgrs_[task_name]->ListDevices()[0]->attributes(),
+        cp_[device_name], &cm_, [&note, &status](const Status& s) {
+          status = s;
+          note.Notify();
+        });
+    note.WaitForNotification();
+    if (coll_type == BROADCAST_COLLECTIVE) {
+      EXPECT_TRUE(errors::IsCancelled(status)) << status;
+    } else {
+      TF_EXPECT_OK(status);
+      EXPECT_EQ(cp_[device_name]->default_rank, 1);
+    }
+  }
+}
+
+// Checks cached groups with the leader at every resolution.
+class DeviceResDistRefreshTest : public DeviceResDistTest {
+ protected:
+  void SetUp() override {
+    setenv("TF_COLLECTIVE_GROUP_REFRESH_INTERVAL_SECS", "0", 1);
+  }
+  void TearDown() override {
+    unsetenv("TF_COLLECTIVE_GROUP_REFRESH_INTERVAL_SECS");
+  }
+};
+
+TEST_F(DeviceResDistRefreshTest, RestartAfterGroupIsCached) {
+  const int num_workers = 3;
+  const int num_devices = 1;
+  DefineWorkers(num_workers, num_devices, "CPU", /*nccl*/ false);
+  DefineCollectiveParams(num_workers, num_devices, "CPU");
+  IssueRequests(num_workers, num_devices);
+  ValidateCollectiveParams(num_workers, num_devices);
+
+  // The leader fails the group once task 1 restarts.
+  RestartWorker(1, num_workers, num_devices, "CPU", /*nccl*/ false);
+  const string restarted_task = "/job:worker/replica:0/task:1";
+  const string restarted_device =
+      absl::StrCat(restarted_task, "/device:CPU:0");
+  IssueRequest(restarted_task, restarted_device, num_workers * num_devices);
+  EXPECT_TRUE(errors::IsFailedPrecondition(status_[restarted_device]));
+
+  // Task 2 has the group cached, but still finds out from the leader, so it
+  // fails the reductions it would otherwise resolve with the stale group.
+  const string task_name = "/job:worker/replica:0/task:2";
+  const string device_name = absl::StrCat(task_name, "/device:CPU:0");
+  cp_[device_name]->Unref();
+  cp_[device_name] = CreateCollectiveParams(
+      num_workers, num_devices, "CPU", REDUCTION_COLLECTIVE,
+      /*is_source=*/false);
+  cp_[device_name]->instance.instance_key = 100;
+  Notification note;
+  Status status;
+  cp_resolvers_[task_name]->CompleteParamsAsync(
+      device_mgrs_[task_name]->ListDevices()[0]->attributes(),
+      cp_[device_name], &cm_, [&note, &status](const Status& s) {
+        status = s;
+        note.Notify();
+      });
+  note.WaitForNotification();
+  EXPECT_TRUE(errors::IsFailedPrecondition(status)) << status;
+}
+
 TEST_F(DeviceResDistTest, Workers4Devices3) {
   const int num_workers = 4;
   const int num_devices = 3;
@@ -109,6 +109,19 @@ struct CoordinatedTaskEqual {
   }
 };
 
+// Returns the names of "tasks" in sorted order, so that the same set of tasks
+// gives the same names regardless of the order they are listed in.
+std::vector<std::string> SortedTaskNames(
+    const std::vector<CoordinatedTask>& tasks) {
+  std::vector<std::string> names;
+  names.reserve(tasks.size());
+  for (const auto& task : tasks) {
+    names.push_back(GetTaskName(task));
+  }
+  std::sort(names.begin(), names.end());
+  return names;
+}
+
 // Standalone implementation of the coordination service.
 class CoordinationServiceStandaloneImpl : public CoordinationServiceInterface {
  public:
@@ -167,6 +180,9 @@ class CoordinationServiceStandaloneImpl : public CoordinationServiceInterface {
         "Invalid barrier result.");  // Only valid if `passed` is true.
     uint64_t deadline_in_micros = 0;
     int num_pending_tasks = 0;
+    // Sorted names of the participating tasks specified by the first call, or
+    // empty if it specified none.
+    std::vector<std::string> participating_task_names;
     // Specifies which tasks have called the barrier so far.
     absl::flat_hash_map<CoordinatedTask, bool, CoordinatedTaskHash,
                         CoordinatedTaskEqual>
@@ -177,11 +193,10 @@ class CoordinationServiceStandaloneImpl : public CoordinationServiceInterface {
                    BarrierState* barrier)
       TF_EXCLUSIVE_LOCKS_REQUIRED(state_mu_);
   // Check if participating tasks are specified correctly across barrier calls.
-  bool ValidateTaskArgs(
-      const std::vector<CoordinatedTask>& tasks_args,
-      const absl::flat_hash_map<CoordinatedTask, bool, CoordinatedTaskHash,
-                                CoordinatedTaskEqual>& tasks_at_barrier,
-      int64_t cluster_size);
+  // "tasks_args_names" is SortedTaskNames(tasks_args).
+  bool ValidateTaskArgs(const std::vector<CoordinatedTask>& tasks_args,
+                        const std::vector<std::string>& tasks_args_names,
+                        const BarrierState& barrier, int64_t cluster_size);
 
   class TaskState {
    public:
@@ -617,25 +632,25 @@ Status CoordinationServiceStandaloneImpl::RecordHeartbeat(
   Status s = Status::OK();
   {
     mutex_lock l(state_mu_);
-    if (!cluster_state_.contains(task_name)) {
+    auto it = cluster_state_.find(task_name);
+    if (it == cluster_state_.end()) {
       return MakeCoordinationError(errors::InvalidArgument(
           "Unexpected task request with task_name=", task_name));
     }
-    if (!cluster_state_[task_name]->GetStatus().ok()) {
-      return cluster_state_[task_name]->GetStatus();
-    } else if (cluster_state_[task_name]->GetState() ==
-                   TaskState::State::DISCONNECTED &&
+    TaskState* task_state = it->second.get();
+    if (!task_state->GetStatus().ok()) {
+      return task_state->GetStatus();
+    } else if (task_state->GetState() == TaskState::State::DISCONNECTED &&
                // We accept heartbeats for a short grace period to account for
                // the lag time between the service recording the state change
                // and the agent stopping heartbeats.
                Env::Default()->NowMicros() >
-                   cluster_state_[task_name]
-                       ->GetDisconnectedGracePeriodMicros()) {
+                   task_state->GetDisconnectedGracePeriodMicros()) {
       return MakeCoordinationError(errors::InvalidArgument(
           "Task with task_name=", task_name,
           " must be registered before sending heartbeat messages"));
     }
-    s = cluster_state_[task_name]->RecordHeartbeat(incarnation);
+    s = task_state->RecordHeartbeat(incarnation);
   }
 
   // Set and propagate any heartbeat errors.
@@ -853,6 +868,10 @@ void CoordinationServiceStandaloneImpl::BarrierAsync(
     const CoordinatedTask& task,
     const std::vector<CoordinatedTask>& participating_tasks,
     StatusCallback done) {
+  // Computed outside of the lock, so that validating the participating tasks
+  // of each call is a single comparison of sorted names under it.
+  const std::vector<std::string> task_names =
+      SortedTaskNames(participating_tasks);
   mutex_lock l(state_mu_);
   auto pair = barriers_.try_emplace(barrier_id);
   auto it = pair.first;
@@ -887,6 +906,7 @@ void CoordinationServiceStandaloneImpl::BarrierAsync(
       }
     }
     barrier->num_pending_tasks = barrier->tasks_at_barrier.size();
+    barrier->participating_task_names = task_names;
 
     // Fail the barrier immediately if any tasks are already in error.
     for (const auto& pending_task : barrier->tasks_at_barrier) {
@@ -950,7 +970,7 @@ void CoordinationServiceStandaloneImpl::BarrierAsync(
   }
 
   // Check if task args are specified consistently across barrier calls.
-  if (!ValidateTaskArgs(participating_tasks, barrier->tasks_at_barrier,
+  if (!ValidateTaskArgs(participating_tasks, task_names, *barrier,
                         cluster_state_.size())) {
     Status error = MakeCoordinationError(errors::InvalidArgument(absl::StrCat(
         "Conflicting tasks specified for the same barrier: ", barrier_id)));
@@ -1047,15 +1067,17 @@ void CoordinationServiceStandaloneImpl::PassBarrier(
 }
 
 bool CoordinationServiceStandaloneImpl::ValidateTaskArgs(
-
     const std::vector<CoordinatedTask>& tasks_args,
-    const absl::flat_hash_map<CoordinatedTask, bool, CoordinatedTaskHash,
-                              CoordinatedTaskEqual>& tasks_at_barrier,
-    int64_t cluster_size) {
+    const std::vector<std::string>& tasks_args_names,
+    const BarrierState& barrier, int64_t cluster_size) {
+  const auto& tasks_at_barrier = barrier.tasks_at_barrier;
   if (tasks_args.empty()) {
     return tasks_at_barrier.size() == cluster_size;
   } else if (tasks_at_barrier.size() != tasks_args.size()) {
     return false;
+  } else if (!barrier.participating_task_names.empty()) {
+    // The common case: every call specifies the same tasks.
+    return tasks_args_names == barrier.participating_task_names;
   } else {
     for (const auto& task : tasks_args) {
       if (!tasks_at_barrier.contains(task)) {
@@ -632,6 +632,36 @@ TEST_F(CoordinationBarrierTest, BarrierWithSubsetOfTasks) {
   TF_EXPECT_OK(barrier_status_1);
 }
 
+TEST_F(CoordinationBarrierTest, BarrierWithTasksInDifferentOrder) {
+  const std::string barrier_id = "barrier_id";
+  absl::Duration timeout = absl::Seconds(5);
+  Status barrier_status_0;
+  Status barrier_status_2;
+  absl::Notification n_0;
+  absl::Notification n_2;
+
+  GetCoordinationService()->BarrierAsync(
+      barrier_id, timeout, GetTask(0),
+      /*participating_tasks=*/{GetTask(0), GetTask(2)},
+      [&barrier_status_0, &n_0](Status s) {
+        barrier_status_0 = s;
+        n_0.Notify();
+      });
+  GetCoordinationService()->BarrierAsync(
+      barrier_id, timeout, GetTask(2),
+      /*participating_tasks=*/{GetTask(2), GetTask(0)},
+      [&barrier_status_2, &n_2](Status s) {
+        barrier_status_2 = s;
+        n_2.Notify();
+      });
+
+  // The same tasks were listed, so the barrier passed.
+  EXPECT_TRUE(n_0.HasBeenNotified());
+  EXPECT_TRUE(n_2.HasBeenNotified());
+  TF_EXPECT_OK(barrier_status_0);
+  TF_EXPECT_OK(barrier_status_2);
+}
+
 TEST_F(CoordinationBarrierTest, BarrierWithMismatchedTasks) {
   const std::string barrier_id = "barrier_id";
   absl::Duration timeout = absl::Seconds(5);
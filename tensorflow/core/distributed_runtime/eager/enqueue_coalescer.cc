@@ -0,0 +1,123 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/eager/enqueue_coalescer.h"
+
+#include <utility>
+
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace eager {
+
+EnqueueCoalescer::EnqueueCoalescer(SendFunction send, int max_in_flight,
+                                   int max_queue_items)
+    : send_(std::move(send)),
+      max_in_flight_(max_in_flight),
+      max_queue_items_(max_queue_items) {
+  DCHECK_GT(max_in_flight_, 0);
+  DCHECK_GT(max_queue_items_, 0);
+}
+
+void EnqueueCoalescer::Enqueue(const EnqueueRequest& request,
+                               EnqueueResponse* response,
+                               StatusCallback done) {
+  {
+    mutex_lock l(mu_);
+    CoalescedRequest* coalesced = nullptr;
+    if (num_in_flight_ < max_in_flight_) {
+      DCHECK(pending_.empty());
+      ready_.push_back(std::make_unique<CoalescedRequest>());
+      ++num_in_flight_;
+      coalesced = ready_.back().get();
+    } else {
+      if (pending_.empty() || pending_.back()->request.queue_size() +
+                                      request.queue_size() >
+                                  max_queue_items_) {
+        pending_.push_back(std::make_unique<CoalescedRequest>());
+      }
+      coalesced = pending_.back().get();
+    }
+    coalesced->request.set_context_id(request.context_id());
+    coalesced->request.mutable_queue()->MergeFrom(request.queue());
+    coalesced->originals.push_back(
+        {request.queue_size(), response, std::move(done)});
+  }
+  SendReadyRequests();
+}
+
+void EnqueueCoalescer::SendReadyRequests() {
+  {
+    mutex_lock l(mu_);
+    if (sending_) return;
+    sending_ = true;
+  }
+  while (true) {
+    CoalescedRequest* coalesced;
+    {
+      mutex_lock l(mu_);
+      if (ready_.empty()) {
+        sending_ = false;
+        return;
+      }
+      coalesced = ready_.front().release();
+      ready_.pop_front();
+    }
+    VLOG(3) << "Sending " << coalesced->originals.size()
+            << " coalesced enqueue requests with "
+            << coalesced->request.queue_size() << " queue items";
+    // Keep this object alive until the response is received.
+    Ref();
+    send_(&coalesced->request, &coalesced->response,
+          [this, coalesced](const Status& status) { Done(coalesced, status); });
+  }
+}
+
+void EnqueueCoalescer::Done(CoalescedRequest* coalesced, Status status) {
+  if (status.ok() && coalesced->response.queue_response_size() !=
+                         coalesced->request.queue_size()) {
+    status = errors::Internal(
+        "Expected ", coalesced->request.queue_size(),
+        " queue responses to coalesced enqueue request, got ",
+        coalesced->response.queue_response_size());
+  }
+  int next_response = 0;
+  for (OriginalRequest& original : coalesced->originals) {
+    if (status.ok()) {
+      for (int i = 0; i < original.num_queue_items; ++i) {
+        original.response->add_queue_response()->Swap(
+            coalesced->response.mutable_queue_response(next_response++));
+      }
+    }
+    original.done(status);
+  }
+  delete coalesced;
+
+  {
+    mutex_lock l(mu_);
+    if (pending_.empty()) {
+      --num_in_flight_;
+    } else {
+      ready_.push_back(std::move(pending_.front()));
+      pending_.pop_front();
+    }
+  }
+  SendReadyRequests();
+  Unref();
+}
+
+}  // namespace eager
+}  // namespace tensorflow
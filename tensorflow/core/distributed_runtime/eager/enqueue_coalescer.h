@@ -0,0 +1,97 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_EAGER_ENQUEUE_COALESCER_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_EAGER_ENQUEUE_COALESCER_H_
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/protobuf/eager_service.pb.h"
+
+namespace tensorflow {
+namespace eager {
+
+// Coalesces consecutive EnqueueRequests of one context, bound for one target,
+// into fewer and larger requests.
+//
+// Requests are sent as they arrive until `max_in_flight` coalesced requests
+// are outstanding. Requests arriving after that are merged, in order, into
+// pending coalesced requests of at most `max_queue_items` queue items each,
+// and the oldest pending one is sent whenever an outstanding one completes.
+// When a coalesced request completes, the response of each original request
+// is filled with its share of the queue responses and its callback is run.
+//
+// Since every queue item gets one QueueResponse, and requests are sent in the
+// order in which they were enqueued, this is transparent to callers of a
+// StreamingEnqueue-style transport. An error in a coalesced request is
+// reported to all the requests merged into it.
+class EnqueueCoalescer : public core::RefCounted {
+ public:
+  // Sends `request` and fills `response`, invoking `done` when the response is
+  // received. `request` may be deleted once the function returns.
+  using SendFunction =
+      std::function<void(const EnqueueRequest* request,
+                         EnqueueResponse* response, StatusCallback done)>;
+
+  EnqueueCoalescer(SendFunction send, int max_in_flight, int max_queue_items);
+
+  // Same contract as `SendFunction`.
+  void Enqueue(const EnqueueRequest& request, EnqueueResponse* response,
+               StatusCallback done);
+
+ private:
+  struct OriginalRequest {
+    int num_queue_items;
+    EnqueueResponse* response;
+    StatusCallback done;
+  };
+
+  struct CoalescedRequest {
+    EnqueueRequest request;
+    EnqueueResponse response;
+    std::vector<OriginalRequest> originals;
+  };
+
+  // Sends the requests in `ready_` in order. Only one thread sends at a time;
+  // others return immediately, leaving their requests to that thread.
+  void SendReadyRequests();
+
+  void Done(CoalescedRequest* coalesced, Status status);
+
+  const SendFunction send_;
+  const int max_in_flight_;
+  const int max_queue_items_;
+
+  mutex mu_;
+  // Coalesced requests that may be sent.
+  std::deque<std::unique_ptr<CoalescedRequest>> ready_ TF_GUARDED_BY(mu_);
+  // Coalesced requests waiting for an outstanding one to complete.
+  std::deque<std::unique_ptr<CoalescedRequest>> pending_ TF_GUARDED_BY(mu_);
+  // The number of coalesced requests in `ready_` or outstanding.
+  int num_in_flight_ TF_GUARDED_BY(mu_) = 0;
+  bool sending_ TF_GUARDED_BY(mu_) = false;
+};
+
+}  // namespace eager
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_EAGER_ENQUEUE_COALESCER_H_
@@ -0,0 +1,132 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/eager/enqueue_coalescer.h"
+
+#include <deque>
+#include <vector>
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace eager {
+namespace {
+
+// Records sent requests, and completes them when asked to, answering every
+// queue item with a QueueResponse holding the item's operation id as device.
+class FakeTransport {
+ public:
+  EnqueueCoalescer::SendFunction send_function() {
+    return [this](const EnqueueRequest* request, EnqueueResponse* response,
+                  StatusCallback done) {
+      sent_.push_back({*request, response, std::move(done)});
+    };
+  }
+
+  int num_sent() const { return sent_.size(); }
+  const EnqueueRequest& request(int i) const { return sent_[i].request; }
+
+  void Complete(int i, const Status& status) {
+    Sent& sent = sent_[i];
+    for (const QueueItem& item : sent.request.queue()) {
+      sent.response->add_queue_response()->add_device(
+          std::to_string(item.operation().id()));
+    }
+    sent.done(status);
+  }
+
+ private:
+  struct Sent {
+    EnqueueRequest request;
+    EnqueueResponse* response;
+    StatusCallback done;
+  };
+  // A deque, so that references to elements survive sends from callbacks.
+  std::deque<Sent> sent_;
+};
+
+EnqueueRequest MakeRequest(std::vector<int> op_ids) {
+  EnqueueRequest request;
+  request.set_context_id(7);
+  for (int op_id : op_ids) {
+    request.add_queue()->mutable_operation()->set_id(op_id);
+  }
+  return request;
+}
+
+TEST(EnqueueCoalescerTest, CoalescesWhileRequestIsInFlight) {
+  FakeTransport transport;
+  core::RefCountPtr<EnqueueCoalescer> coalescer(new EnqueueCoalescer(
+      transport.send_function(), /*max_in_flight=*/1, /*max_queue_items=*/3));
+
+  std::vector<EnqueueResponse> responses(4);
+  std::vector<Status> statuses(4, errors::Unknown("Not done"));
+  auto enqueue = [&](int i, std::vector<int> op_ids) {
+    coalescer->Enqueue(MakeRequest(op_ids), &responses[i],
+                       [&statuses, i](const Status& s) { statuses[i] = s; });
+  };
+
+  // The first request is sent immediately; the others are coalesced into
+  // requests of at most three queue items while it is outstanding.
+  enqueue(0, {1});
+  enqueue(1, {2});
+  enqueue(2, {3, 4});
+  enqueue(3, {5});
+  ASSERT_EQ(transport.num_sent(), 1);
+
+  transport.Complete(0, Status::OK());
+  TF_EXPECT_OK(statuses[0]);
+  ASSERT_EQ(transport.num_sent(), 2);
+  EXPECT_EQ(transport.request(1).context_id(), 7);
+  ASSERT_EQ(transport.request(1).queue_size(), 3);
+  EXPECT_EQ(transport.request(1).queue(2).operation().id(), 4);
+
+  transport.Complete(1, Status::OK());
+  TF_EXPECT_OK(statuses[1]);
+  TF_EXPECT_OK(statuses[2]);
+  ASSERT_EQ(responses[1].queue_response_size(), 1);
+  EXPECT_EQ(responses[1].queue_response(0).device(0), "2");
+  ASSERT_EQ(responses[2].queue_response_size(), 2);
+  EXPECT_EQ(responses[2].queue_response(0).device(0), "3");
+  EXPECT_EQ(responses[2].queue_response(1).device(0), "4");
+
+  ASSERT_EQ(transport.num_sent(), 3);
+  transport.Complete(2, errors::Internal("Failed"));
+  EXPECT_EQ(statuses[3].code(), error::INTERNAL);
+  EXPECT_EQ(responses[3].queue_response_size(), 0);
+}
+
+TEST(EnqueueCoalescerTest, SendsUpToMaxInFlight) {
+  FakeTransport transport;
+  core::RefCountPtr<EnqueueCoalescer> coalescer(new EnqueueCoalescer(
+      transport.send_function(), /*max_in_flight=*/2, /*max_queue_items=*/8));
+  std::vector<EnqueueResponse> responses(3);
+  for (int i = 0; i < 3; ++i) {
+    coalescer->Enqueue(MakeRequest({i}), &responses[i],
+                       [](const Status& s) { TF_EXPECT_OK(s); });
+  }
+  EXPECT_EQ(transport.num_sent(), 2);
+  transport.Complete(1, Status::OK());
+  EXPECT_EQ(transport.num_sent(), 3);
+  transport.Complete(0, Status::OK());
+  transport.Complete(2, Status::OK());
+  EXPECT_EQ(responses[2].queue_response(0).device(0), "2");
+}
+
+}  // namespace
+}  // namespace eager
+}  // namespace tensorflow
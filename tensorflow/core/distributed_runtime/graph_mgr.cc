@@ -43,8 +43,10 @@ limitations under the License.
 #include "tensorflow/core/graph/graph_partition.h"
 #include "tensorflow/core/graph/validate.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/tracing.h"
@@ -65,10 +67,16 @@ GraphMgr::GraphMgr(const WorkerEnv* worker_env, const DeviceMgr* device_mgr)
   if (!status.ok()) {
     LOG(ERROR) << status.error_message();
   }
+  status = ReadInt64FromEnvVar("TF_GRAPH_MGR_REGISTRATION_CACHE_SIZE", 0,
+                               &registration_cache_size_);
+  if (!status.ok()) {
+    LOG(ERROR) << status.error_message();
+  }
 }
 
 GraphMgr::~GraphMgr() {
   for (const auto& p : table_) p.second->Unref();
+  for (Item* item : registration_cache_) item->Unref();
 }
 
 GraphMgr::Item::~Item() {
@@ -111,6 +119,32 @@ Status GraphMgr::DecorateAndPublishGraphForDebug(
   return Status::OK();
 }
 
+// Returns the fingerprint identifying the items built by registrations with
+// the given arguments.  Never zero.
+//
+// The session and cluster FLR the executors call back into are not part of
+// it: they belong to the worker session that owns this GraphMgr, and are the
+// same for all of its registrations.
+static uint64 RegistrationFingerprint(const string& handle,
+                                      const GraphDef& gdef,
+                                      const GraphOptions& graph_options,
+                                      const DebugOptions& debug_options,
+                                      const ConfigProto& config_proto,
+                                      int64_t collective_graph_key) {
+  string serialized;
+  SerializeToStringDeterministic(gdef, &serialized);
+  uint64 fingerprint = Fingerprint64(serialized);
+  for (const protobuf::MessageLite* options :
+       std::initializer_list<const protobuf::MessageLite*>{
+           &graph_options, &debug_options, &config_proto}) {
+    SerializeToStringDeterministic(*options, &serialized);
+    fingerprint = FingerprintCat64(fingerprint, Fingerprint64(serialized));
+  }
+  fingerprint = FingerprintCat64(fingerprint, collective_graph_key);
+  fingerprint = FingerprintCat64(fingerprint, Fingerprint64(handle));
+  return fingerprint == 0 ? 1 : fingerprint;
+}
+
 // Creates executors given a graph definition "gdef" of a "session".
 // If a node in "gdef" is shared by other graphs in "session", the
 // same op kernel is reused. E.g., typically a params node is shared
@@ -301,12 +335,40 @@ Status GraphMgr::Register(const string& handle, const GraphDef& gdef,
                           int64_t collective_graph_key, WorkerSession* session,
                           DistributedFunctionLibraryRuntime* cluster_flr,
                           string* graph_handle) {
-  Item* item = new Item;
-  Status s = InitItem(handle, gdef, graph_options, debug_options, config_proto,
-                      collective_graph_key, session, cluster_flr, item);
-  if (!s.ok()) {
-    item->Unref();
-    return s;
+  Item* item = nullptr;
+  uint64 fingerprint = 0;
+  if (registration_cache_size_ > 0) {
+    fingerprint =
+        RegistrationFingerprint(handle, gdef, graph_options, debug_options,
+                                config_proto, collective_graph_key);
+    mutex_lock l(mu_);
+    for (auto it = registration_cache_.begin();
+         it != registration_cache_.end(); ++it) {
+      // Kernels are shared with the other graphs of the session through the
+      // op segments, under its handle, so an item is only reused by the
+      // session it was built for.
+      if ((*it)->fingerprint == fingerprint && (*it)->session == handle) {
+        item = *it;
+        registration_cache_.erase(it);
+        break;
+      }
+    }
+  }
+  if (item != nullptr) {
+    // The executors and kernels of the cached item remain valid, as its
+    // kernels stay held in the op segments until it is destroyed.
+    VLOG(1) << "Reusing the executors of deregistered graph " << item->handle
+            << " for session " << handle;
+  } else {
+    item = new Item;
+    item->fingerprint = fingerprint;
+    Status s = InitItem(handle, gdef, graph_options, debug_options,
+                        config_proto, collective_graph_key, session,
+                        cluster_flr, item);
+    if (!s.ok()) {
+      item->Unref();
+      return s;
+    }
   }
 
   // Inserts one item into table_.
@@ -332,8 +394,17 @@ Status GraphMgr::Deregister(const string& handle) {
     }
     item = iter->second;
     table_.erase(iter);
+    if (item->fingerprint != 0) {
+      registration_cache_.push_front(item);
+      item = nullptr;
+      if (static_cast<int64_t>(registration_cache_.size()) >
+          registration_cache_size_) {
+        item = registration_cache_.back();
+        registration_cache_.pop_back();
+      }
+    }
   }
-  item->Unref();
+  if (item != nullptr) item->Unref();
   return Status::OK();
 }
 
@@ -346,6 +417,9 @@ Status GraphMgr::DeregisterAll() {
       items.push_back(entry.second);
     }
     table_.clear();
+    items.insert(items.end(), registration_cache_.begin(),
+                 registration_cache_.end());
+    registration_cache_.clear();
   }
   for (auto item : items) {
     item->Unref();
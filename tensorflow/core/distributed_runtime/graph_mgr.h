@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_GRAPH_MGR_H_
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_GRAPH_MGR_H_
 
+#include <list>
 #include <unordered_map>
 #include <vector>
 
@@ -145,8 +146,14 @@ class GraphMgr {
     GraphMgr* graph_mgr;
 
     int64_t collective_graph_key;
+
+    // Fingerprint of the registration request, if the item may be kept in
+    // the registration cache once deregistered.  Zero otherwise.
+    uint64 fingerprint = 0;
   };
 
+  friend class GraphMgrTest;
+
   const WorkerEnv* worker_env_;  // Not owned.
   const DeviceMgr* device_mgr_;
 
@@ -166,6 +173,15 @@ class GraphMgr {
   // mechanism to gc these graphs.
   std::unordered_map<string, Item*> table_;
 
+  // Deregistered items kept for reuse by later registrations of the same
+  // graph with the same options by the same session, e.g. when a client
+  // releases a callable and makes it again, most recently deregistered first.
+  // Holds at most "registration_cache_size_" items, set by the environment
+  // variable TF_GRAPH_MGR_REGISTRATION_CACHE_SIZE (0, the default, disables
+  // it).  The items of sessions that are gone stay until they are evicted.
+  int64_t registration_cache_size_ = 0;
+  std::list<Item*> registration_cache_ TF_GUARDED_BY(mu_);
+
   void StartParallelExecutors(
       const string& handle, int64_t step_id, Item* item, Rendezvous* rendezvous,
       CollectiveExecutor::Handle* ce_handle, StepStatsCollector* collector,
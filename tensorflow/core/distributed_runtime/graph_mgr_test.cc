@@ -0,0 +1,182 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/graph_mgr.h"
+
+#include <stdlib.h>
+
+#include <memory>
+#include <string>
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/common_runtime/build_graph_options.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/common_runtime/threadpool_device.h"
+#include "tensorflow/core/distributed_runtime/worker_env.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/core/protobuf/debug.pb.h"
+#include "tensorflow/core/public/session_options.h"
+
+namespace tensorflow {
+
+constexpr char kDeviceName[] = "/job:worker/replica:0/task:0/device:CPU:0";
+
+class GraphMgrTest : public ::testing::Test {
+ protected:
+  GraphMgrTest() {
+    device_mgr_ = absl::make_unique<StaticDeviceMgr>(
+        absl::make_unique<ThreadPoolDevice>(SessionOptions(), kDeviceName,
+                                            Bytes(256 << 20), DeviceLocality(),
+                                            cpu_allocator()));
+    compute_pool_ = absl::make_unique<thread::ThreadPool>(Env::Default(),
+                                                          "compute", 1);
+    worker_env_.env = Env::Default();
+    worker_env_.device_mgr = device_mgr_.get();
+    worker_env_.compute_pool = compute_pool_.get();
+  }
+
+  // Creates the GraphMgr, which reads the cache size when constructed.
+  void Init(int cache_size) {
+    setenv("TF_GRAPH_MGR_REGISTRATION_CACHE_SIZE",
+           strings::StrCat(cache_size).c_str(), /*overwrite=*/1);
+    graph_mgr_ = absl::make_unique<GraphMgr>(&worker_env_, device_mgr_.get());
+    unsetenv("TF_GRAPH_MGR_REGISTRATION_CACHE_SIZE");
+  }
+
+  // Returns a graph producing `value` on the device.
+  static GraphDef MakeGraph(float value) {
+    Graph graph(OpRegistry::Global());
+    test::graph::Constant(&graph, test::AsScalar<float>(value));
+    GraphDef gdef;
+    graph.ToGraphDef(&gdef);
+    for (NodeDef& node : *gdef.mutable_node()) {
+      node.set_device(kDeviceName);
+    }
+    return gdef;
+  }
+
+  Status Register(const string& session_handle, const GraphDef& gdef,
+                  string* graph_handle) {
+    return graph_mgr_->Register(
+        session_handle, gdef, GraphOptions(), DebugOptions(), ConfigProto(),
+        BuildGraphOptions::kNoCollectiveGraphKey, /*session=*/nullptr,
+        /*cluster_flr=*/nullptr, graph_handle);
+  }
+
+  // Returns a reference to the item of a registered graph, which keeps it
+  // alive for the pointers of the items to be compared.
+  core::RefCountPtr<core::RefCounted> RegisteredItem(
+      const string& graph_handle) {
+    mutex_lock l(graph_mgr_->mu_);
+    GraphMgr::Item* item = graph_mgr_->table_.at(graph_handle);
+    item->Ref();
+    return core::RefCountPtr<core::RefCounted>(item);
+  }
+
+  int CacheSize() {
+    mutex_lock l(graph_mgr_->mu_);
+    return graph_mgr_->registration_cache_.size();
+  }
+
+  std::unique_ptr<DeviceMgr> device_mgr_;
+  std::unique_ptr<thread::ThreadPool> compute_pool_;
+  WorkerEnv worker_env_;
+  std::unique_ptr<GraphMgr> graph_mgr_;
+};
+
+namespace {
+
+TEST_F(GraphMgrTest, ReusesDeregisteredGraph) {
+  Init(/*cache_size=*/1);
+  string graph_handle;
+  TF_ASSERT_OK(Register("session", MakeGraph(1.0), &graph_handle));
+  core::RefCountPtr<core::RefCounted> item = RegisteredItem(graph_handle);
+  TF_ASSERT_OK(graph_mgr_->Deregister(graph_handle));
+  EXPECT_EQ(CacheSize(), 1);
+
+  string new_graph_handle;
+  TF_ASSERT_OK(Register("session", MakeGraph(1.0), &new_graph_handle));
+  EXPECT_NE(new_graph_handle, graph_handle);
+  EXPECT_EQ(RegisteredItem(new_graph_handle).get(), item.get());
+  EXPECT_EQ(CacheSize(), 0);
+}
+
+TEST_F(GraphMgrTest, DoesNotReuseGraphOfOtherSession) {
+  Init(/*cache_size=*/1);
+  string graph_handle;
+  TF_ASSERT_OK(Register("session", MakeGraph(1.0), &graph_handle));
+  core::RefCountPtr<core::RefCounted> item = RegisteredItem(graph_handle);
+  TF_ASSERT_OK(graph_mgr_->Deregister(graph_handle));
+
+  // The kernels of the cached item are shared with the graphs of its session
+  // only, so another session builds its own.
+  string other_graph_handle;
+  TF_ASSERT_OK(Register("other_session", MakeGraph(1.0), &other_graph_handle));
+  EXPECT_NE(RegisteredItem(other_graph_handle).get(), item.get());
+  EXPECT_EQ(CacheSize(), 1);
+}
+
+TEST_F(GraphMgrTest, DoesNotReuseDifferentGraph) {
+  Init(/*cache_size=*/1);
+  string graph_handle;
+  TF_ASSERT_OK(Register("session", MakeGraph(1.0), &graph_handle));
+  core::RefCountPtr<core::RefCounted> item = RegisteredItem(graph_handle);
+  TF_ASSERT_OK(graph_mgr_->Deregister(graph_handle));
+
+  string other_graph_handle;
+  TF_ASSERT_OK(Register("session", MakeGraph(2.0), &other_graph_handle));
+  EXPECT_NE(RegisteredItem(other_graph_handle).get(), item.get());
+  EXPECT_EQ(CacheSize(), 1);
+}
+
+TEST_F(GraphMgrTest, EvictsLeastRecentlyDeregisteredGraph) {
+  Init(/*cache_size=*/1);
+  string graph_handle1, graph_handle2;
+  TF_ASSERT_OK(Register("session", MakeGraph(1.0), &graph_handle1));
+  TF_ASSERT_OK(Register("session", MakeGraph(2.0), &graph_handle2));
+  core::RefCountPtr<core::RefCounted> item1 = RegisteredItem(graph_handle1);
+  core::RefCountPtr<core::RefCounted> item2 = RegisteredItem(graph_handle2);
+  TF_ASSERT_OK(graph_mgr_->Deregister(graph_handle1));
+  TF_ASSERT_OK(graph_mgr_->Deregister(graph_handle2));
+  EXPECT_EQ(CacheSize(), 1);
+
+  // The first graph was evicted to make room for the second one.
+  TF_ASSERT_OK(Register("session", MakeGraph(1.0), &graph_handle1));
+  EXPECT_NE(RegisteredItem(graph_handle1).get(), item1.get());
+  TF_ASSERT_OK(Register("session", MakeGraph(2.0), &graph_handle2));
+  EXPECT_EQ(RegisteredItem(graph_handle2).get(), item2.get());
+  EXPECT_EQ(CacheSize(), 0);
+}
+
+TEST_F(GraphMgrTest, DisabledCacheKeepsNothing) {
+  Init(/*cache_size=*/0);
+  string graph_handle;
+  TF_ASSERT_OK(Register("session", MakeGraph(1.0), &graph_handle));
+  TF_ASSERT_OK(graph_mgr_->Deregister(graph_handle));
+  EXPECT_EQ(CacheSize(), 0);
+}
+
+}  // namespace
+}  // namespace tensorflow
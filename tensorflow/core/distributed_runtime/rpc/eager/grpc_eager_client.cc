@@ -17,6 +17,7 @@ limitations under the License.
 
 #include "grpcpp/generic/generic_stub.h"
 #include "tensorflow/core/distributed_runtime/call_options.h"
+#include "tensorflow/core/distributed_runtime/eager/enqueue_coalescer.h"
 #include "tensorflow/core/distributed_runtime/rpc/eager/grpc_eager_service.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_client_cq_tag.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_state.h"
@@ -60,6 +61,21 @@ bool EnableStreaming() {
   return result;
 }
 
+// If positive, consecutive streaming enqueue requests of a context are
+// coalesced while this many coalesced requests are outstanding.
+int64_t EnqueueCoalescingMaxInFlight() {
+  static const int64_t max_in_flight = [] {
+    int64_t value;
+    TF_CHECK_OK(ReadInt64FromEnvVar(
+        "TF_EAGER_CLIENT_ENQUEUE_COALESCING_MAX_IN_FLIGHT", 0, &value));
+    return value;
+  }();
+  return max_in_flight;
+}
+
+// The maximum number of queue items in a coalesced enqueue request.
+constexpr int kMaxCoalescedQueueItems = 256;
+
 // Ref-counted thread to handle callbacks for completed requests a GRPC
 // completion queue. The thread might be shared by multiple eager clients, and
 // each one of them should hold a reference count to ensure that the thread
@@ -166,6 +182,7 @@ class GrpcEagerClient : public EagerClient {
             << request->DebugString();
 
     mutex_lock l(mu_);
+    enqueue_coalescers_.erase(request->context_id());
     const auto& it = enqueue_dispatchers_.find(request->context_id());
     if (it != enqueue_dispatchers_.end()) {
       it->second.CancelCall();
@@ -181,20 +198,30 @@ class GrpcEagerClient : public EagerClient {
                              EnqueueResponse* response,
                              StatusCallback done) override {
     StatusCallback done_wrapped = callback_wrapper(std::move(done));
-    if (EnableStreaming()) {
-      mutex_lock l(mu_);
-      auto it = enqueue_dispatchers_.find(request->context_id());
-      if (it == enqueue_dispatchers_.end()) {
-        auto it_and_bool = enqueue_dispatchers_.emplace(
-            std::piecewise_construct,
-            std::forward_as_tuple(request->context_id()),
-            std::forward_as_tuple(
-                &stub_, cq_,
-                "/tensorflow.eager.EagerService/StreamingEnqueue"));
-        it = it_and_bool.first;
+    if (EnableStreaming() && EnqueueCoalescingMaxInFlight() > 0) {
+      core::RefCountPtr<EnqueueCoalescer> coalescer;
+      {
+        mutex_lock l(mu_);
+        const uint64 context_id = request->context_id();
+        auto& entry = enqueue_coalescers_[context_id];
+        if (entry == nullptr) {
+          // The coalescer only sends requests while the originals are
+          // pending, and they hold references to this client.
+          entry.reset(new EnqueueCoalescer(
+              [this](const EnqueueRequest* coalesced_request,
+                     EnqueueResponse* coalesced_response,
+                     StatusCallback coalesced_done) {
+                SendStreamingEnqueue(coalesced_request, coalesced_response,
+                                     std::move(coalesced_done));
+              },
+              EnqueueCoalescingMaxInFlight(), kMaxCoalescedQueueItems));
+        }
+        entry->Ref();
+        coalescer.reset(entry.get());
       }
-      // TODO(haoyuzhang): Consider supporting cancellation for streaming RPC?
-      it->second.SendNextRequest(*request, response, std::move(done_wrapped));
+      coalescer->Enqueue(*request, response, std::move(done_wrapped));
+    } else if (EnableStreaming()) {
+      SendStreamingEnqueue(request, response, std::move(done_wrapped));
     } else {
       Notification n;
       Status status;
@@ -219,6 +246,24 @@ class GrpcEagerClient : public EagerClient {
 
   std::unordered_map<uint64, StreamingRPCDispatcher<EnqueueResponse>>
       enqueue_dispatchers_ TF_GUARDED_BY(mu_);
+  std::unordered_map<uint64, core::RefCountPtr<EnqueueCoalescer>>
+      enqueue_coalescers_ TF_GUARDED_BY(mu_);
+
+  void SendStreamingEnqueue(const EnqueueRequest* request,
+                            EnqueueResponse* response, StatusCallback done) {
+    mutex_lock l(mu_);
+    auto it = enqueue_dispatchers_.find(request->context_id());
+    if (it == enqueue_dispatchers_.end()) {
+      auto it_and_bool = enqueue_dispatchers_.emplace(
+          std::piecewise_construct,
+          std::forward_as_tuple(request->context_id()),
+          std::forward_as_tuple(
+              &stub_, cq_, "/tensorflow.eager.EagerService/StreamingEnqueue"));
+      it = it_and_bool.first;
+    }
+    // TODO(haoyuzhang): Consider supporting cancellation for streaming RPC?
+    it->second.SendNextRequest(*request, response, std::move(done));
+  }
 
   StatusCallback callback_wrapper(StatusCallback done) {
     Ref();
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/grpc_remote_worker.h"
 
+#include <algorithm>
 #include <utility>
 
 #include "grpcpp/generic/generic_stub.h"
@@ -23,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/call_options.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_client_cq_tag.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_state.h"
+#include "tensorflow/core/distributed_runtime/rpc/grpc_tensor_coding.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_worker_service_impl.h"
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
@@ -33,6 +35,8 @@ limitations under the License.
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/protobuf/transport_options.pb.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
@@ -40,6 +44,60 @@ limitations under the License.
 
 namespace tensorflow {
 
+namespace {
+
+// The response of a RecvBuf call whose tensor content is decoded directly
+// into the receive buffer named by the request, instead of into
+// "response->transport_options()".
+struct InPlaceRecvBufResponse {
+  RecvBufResponse* response;  // Not owned.
+  char* buf;                  // Not owned.
+  int64_t num_bytes;
+  Status status;  // The error, if the response could not be decoded.
+};
+
+// Overload of GrpcMaybeParseProto used by RPCState<InPlaceRecvBufResponse>.
+bool GrpcMaybeParseProto(::grpc::ByteBuffer* src,
+                         InPlaceRecvBufResponse* dst) {
+  dst->status = grpc::DecodeRecvBufResponseFromByteBuffer(
+      src, dst->buf, dst->num_bytes, dst->response);
+  return dst->status.ok();
+}
+
+// The response to a RecvTensor request fetching a chunk of a tensor, whose
+// content is decoded directly into the tensor received by the request that
+// split it.
+struct InPlaceTensorChunk {
+  char* buf;  // Not owned.
+  int64_t num_bytes;
+  Status status;  // The error, if the response could not be decoded.
+};
+
+// Overload of GrpcMaybeParseProto used by RPCState<InPlaceTensorChunk>.
+bool GrpcMaybeParseProto(::grpc::ByteBuffer* src, InPlaceTensorChunk* dst) {
+  dst->status = grpc::DecodeTensorChunkFromByteBuffer(src, dst->buf,
+                                                      dst->num_bytes);
+  return dst->status.ok();
+}
+
+// The state of the chunk fetches of a tensor split by the sender.
+struct TensorChunkFetch {
+  RecvTensorRequest request;  // Template of the chunk requests.
+  char* buf;                  // The tensor content.  Not owned.
+  int64_t num_bytes;
+  int64_t chunk_bytes;
+  int64_t num_chunks;
+  CallOptions* call_opts;  // Not owned.  May be null.
+  StatusCallback done;
+
+  mutex mu;
+  int64_t next_chunk TF_GUARDED_BY(mu) = 0;
+  int64_t num_pending TF_GUARDED_BY(mu) = 0;
+  Status status TF_GUARDED_BY(mu);
+};
+
+}  // namespace
+
 class GrpcRemoteWorker : public WorkerInterface {
  public:
   explicit GrpcRemoteWorker(SharedGrpcChannelPtr channel,
@@ -67,7 +125,14 @@ class GrpcRemoteWorker : public WorkerInterface {
         getstepsequence_(Method(GrpcWorkerMethod::kGetStepSequence)),
         markrecvfinished_(Method(GrpcWorkerMethod::kMarkRecvFinished)),
         logger_(logger),
-        target_(target) {}
+        target_(target) {
+    TF_CHECK_OK(ReadInt64FromEnvVar("TF_GRPC_RECV_TENSOR_CHUNK_BYTES", 0,
+                                    &recv_tensor_chunk_bytes_));
+    TF_CHECK_OK(ReadInt64FromEnvVar("TF_GRPC_RECV_TENSOR_MAX_INFLIGHT_CHUNKS",
+                                    4, &recv_tensor_max_inflight_chunks_));
+    recv_tensor_max_inflight_chunks_ =
+        std::max<int64_t>(1, recv_tensor_max_inflight_chunks_);
+  }
 
   ~GrpcRemoteWorker() override {}
 
@@ -133,17 +198,36 @@ class GrpcRemoteWorker : public WorkerInterface {
     // Type-specialized logging for this method.
     bool logging_active = logger_->LoggingActive() || VLOG_IS_ON(2);
 
+    // If the request names a receive buffer, decode the tensor content
+    // directly into it rather than into the response.
+    InPlaceRecvBufResponse* in_place = nullptr;
+    if (request->buf_ptr() != 0) {
+      in_place = new InPlaceRecvBufResponse{
+          response, reinterpret_cast<char*>(request->buf_ptr()),
+          request->num_bytes(), Status::OK()};
+    }
+
     auto callback = [this, request, response, done, start_usec,
-                     logging_active](Status s) {
+                     logging_active, in_place](Status s) {
+      if (in_place != nullptr) {
+        if (!in_place->status.ok()) {
+          s = in_place->status;
+        }
+        delete in_place;
+      }
       if (logging_active) {
         if (logger_->LoggingActive()) {
           int64_t end_usec = Env::Default()->NowMicros();
           int64_t step_id = request->step_id();
-          RecvBufRespExtra extra;
-          response->transport_options().UnpackTo(&extra);
           int64_t num_bytes = 0;
-          for (const auto& chunk : extra.tensor_content()) {
-            num_bytes += chunk.size();
+          if (response->has_transport_options()) {
+            RecvBufRespExtra extra;
+            response->transport_options().UnpackTo(&extra);
+            for (const auto& chunk : extra.tensor_content()) {
+              num_bytes += chunk.size();
+            }
+          } else {
+            num_bytes = request->num_bytes();
           }
           int64_t send_start_usec = start_usec;
           // Prefer start time reported by the sender, if available.
@@ -170,7 +254,11 @@ class GrpcRemoteWorker : public WorkerInterface {
       done(s);
     };
 
-    IssueRequest(request, response, recvbuf_, callback, call_opts);
+    if (in_place != nullptr) {
+      IssueRequest(request, in_place, recvbuf_, callback, call_opts);
+    } else {
+      IssueRequest(request, response, recvbuf_, callback, call_opts);
+    }
   }
 
   void CompleteGroupAsync(CallOptions* call_opts,
@@ -253,6 +341,30 @@ class GrpcRemoteWorker : public WorkerInterface {
       done(s);
     };
 
+    // Let the sender split large tensors into chunks, fetched over several
+    // concurrent RPCs and decoded directly into the received tensor, which
+    // must then be parsed into host memory.
+    if (recv_tensor_chunk_bytes_ > 0 && response->on_host()) {
+      RecvTensorRequest* chunked_request = new RecvTensorRequest(*request);
+      chunked_request->set_max_chunk_bytes(recv_tensor_chunk_bytes_);
+      auto chunked_callback = [this, chunked_request, response, call_opts,
+                               callback](const Status& s) {
+        auto finish = [chunked_request, callback](const Status& s) {
+          delete chunked_request;
+          callback(s);
+        };
+        if (s.ok() && response->metadata().num_chunks() > 0) {
+          FetchTensorChunks(*chunked_request, response, call_opts,
+                            std::move(finish));
+        } else {
+          finish(s);
+        }
+      };
+      IssueRequest(chunked_request, response, recvtensor_,
+                   std::move(chunked_callback), call_opts);
+      return;
+    }
+
     IssueRequest(request, response, recvtensor_, callback, call_opts);
   }
 
@@ -287,6 +399,126 @@ class GrpcRemoteWorker : public WorkerInterface {
                                  /*fail_fast=*/true, &target_);
   }
 
+  void IssueRequest(const protobuf::Message* request,
+                    InPlaceRecvBufResponse* response,
+                    const ::grpc::string& method, StatusCallback done,
+                    CallOptions* call_opts = nullptr) {
+    new RPCState<InPlaceRecvBufResponse>(&stub_, cq_, method, *request,
+                                         response, std::move(done), call_opts,
+                                         callback_threadpool_, MaxRetries(),
+                                         /*fail_fast=*/true, &target_);
+  }
+
+  void IssueRequest(const protobuf::Message* request,
+                    InPlaceTensorChunk* response, const ::grpc::string& method,
+                    StatusCallback done, CallOptions* call_opts = nullptr) {
+    new RPCState<InPlaceTensorChunk>(&stub_, cq_, method, *request, response,
+                                     std::move(done), call_opts,
+                                     callback_threadpool_, MaxRetries(),
+                                     /*fail_fast=*/true, &target_);
+  }
+
+  // Fetches the chunks of the tensor that the sender split in response to
+  // "request", into "response->tensor()", with at most
+  // "recv_tensor_max_inflight_chunks_" fetches in flight at once.
+  void FetchTensorChunks(const RecvTensorRequest& request,
+                         TensorResponse* response, CallOptions* call_opts,
+                         StatusCallback done) {
+    const Tensor& tensor = response->tensor();
+    const int64_t num_chunks = response->metadata().num_chunks();
+    if (!DataTypeCanUseMemcpy(tensor.dtype())) {
+      done(errors::Internal("RecvTensor response for ",
+                            request.rendezvous_key(), " of type ",
+                            DataTypeString(tensor.dtype()),
+                            " cannot be split into chunks"));
+      return;
+    }
+    const int64_t element_size = DataTypeSize(tensor.dtype());
+    const int64_t chunk_elems =
+        grpc::ElementsPerTensorChunk(element_size, request.max_chunk_bytes());
+    const int64_t expected_chunks =
+        (tensor.NumElements() + chunk_elems - 1) / chunk_elems;
+    if (num_chunks != expected_chunks) {
+      done(errors::Internal("RecvTensor response for ",
+                            request.rendezvous_key(), " has ", num_chunks,
+                            " chunks, expected ", expected_chunks));
+      return;
+    }
+
+    TensorChunkFetch* fetch = new TensorChunkFetch;
+    fetch->request = request;
+    fetch->request.set_request_id(0);
+    fetch->request.set_fetch_chunk(true);
+    fetch->buf = const_cast<char*>(tensor.tensor_data().data());
+    fetch->num_bytes = tensor.TotalBytes();
+    fetch->chunk_bytes = chunk_elems * element_size;
+    fetch->num_chunks = num_chunks;
+    fetch->call_opts = call_opts;
+    fetch->done = std::move(done);
+    if (call_opts != nullptr) {
+      // Fetches in flight run to completion, but no more are issued.
+      call_opts->SetCancelCallback([fetch]() {
+        mutex_lock l(fetch->mu);
+        fetch->status.Update(errors::Cancelled("RecvTensor cancelled"));
+      });
+    }
+    int64_t num_initial;
+    {
+      mutex_lock l(fetch->mu);
+      num_initial = std::min(num_chunks, recv_tensor_max_inflight_chunks_);
+      fetch->next_chunk = num_initial;
+      fetch->num_pending = num_initial;
+    }
+    for (int64_t i = 0; i < num_initial; ++i) {
+      IssueTensorChunkRequest(fetch, i);
+    }
+  }
+
+  void IssueTensorChunkRequest(TensorChunkFetch* fetch, int64_t chunk_index) {
+    const int64_t offset = chunk_index * fetch->chunk_bytes;
+    InPlaceTensorChunk* chunk = new InPlaceTensorChunk{
+        fetch->buf + offset,
+        std::min(fetch->chunk_bytes, fetch->num_bytes - offset), Status::OK()};
+    RecvTensorRequest request = fetch->request;
+    request.set_chunk_index(chunk_index);
+    IssueRequest(&request, chunk, recvtensor_,
+                 [this, fetch, chunk](Status s) {
+                   if (!chunk->status.ok()) {
+                     s = chunk->status;
+                   }
+                   delete chunk;
+                   OnTensorChunkDone(fetch, s);
+                 });
+  }
+
+  void OnTensorChunkDone(TensorChunkFetch* fetch, const Status& s) {
+    int64_t next_chunk = -1;
+    {
+      mutex_lock l(fetch->mu);
+      fetch->status.Update(s);
+      if (fetch->status.ok() && fetch->next_chunk < fetch->num_chunks) {
+        next_chunk = fetch->next_chunk++;
+      } else if (--fetch->num_pending > 0) {
+        return;
+      }
+    }
+    if (next_chunk >= 0) {
+      IssueTensorChunkRequest(fetch, next_chunk);
+      return;
+    }
+    if (fetch->call_opts != nullptr) {
+      fetch->call_opts->ClearCancelCallback();
+    }
+    Status status;
+    {
+      mutex_lock l(fetch->mu);
+      status = fetch->status;
+    }
+    StatusCallback done = std::move(fetch->done);
+    delete fetch;
+    done(status);
+  }
+
   void IssueMarkRecvFinishedRequest(int64_t request_id) {
     VLOG(2) << "Send MarkRecvFinishedRequest for request " << request_id;
     MarkRecvFinishedRequest request;
@@ -334,6 +566,12 @@ class GrpcRemoteWorker : public WorkerInterface {
   WorkerCacheLogger* logger_;
   const string target_;
 
+  // If positive, the maximum size of the chunks into which the sender may
+  // split the tensors received by RecvTensorAsync().
+  int64_t recv_tensor_chunk_bytes_ = 0;
+  // The maximum number of chunk fetches in flight for each received tensor.
+  int64_t recv_tensor_max_inflight_chunks_ = 4;
+
   TF_DISALLOW_COPY_AND_ASSIGN(GrpcRemoteWorker);
 };
 
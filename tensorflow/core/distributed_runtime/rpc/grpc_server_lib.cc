@@ -19,12 +19,14 @@ limitations under the License.
 #include <limits>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include "grpcpp/grpcpp.h"
 #include "grpcpp/security/credentials.h"
 #include "grpcpp/server_builder.h"
+#include "absl/strings/match.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/process_util.h"
@@ -562,6 +564,72 @@ ChannelCreationFunction GrpcServer::GetChannelCreationFunction() const {
   return ConvertToChannelCreationFunction(NewHostPortGrpcChannel);
 }
 
+namespace {
+
+mutex* get_rendezvous_transport_lock() {
+  static mutex rendezvous_transport_lock(LINKER_INITIALIZED);
+  return &rendezvous_transport_lock;
+}
+
+typedef std::unordered_map<string, GrpcRendezvousTransport>
+    RendezvousTransports;
+RendezvousTransports* rendezvous_transports() {
+  static RendezvousTransports* transports = new RendezvousTransports;
+  return transports;
+}
+
+constexpr char kGrpcProtocol[] = "grpc";
+constexpr char kGrpcTransportProtocolPrefix[] = "grpc+";
+
+// Returns the transport for `protocol`, or nullptr if `protocol` is not
+// "grpc+<name>" for a registered transport.
+const GrpcRendezvousTransport* LookupRendezvousTransport(
+    const string& protocol) {
+  if (!absl::StartsWith(protocol, kGrpcTransportProtocolPrefix)) {
+    return nullptr;
+  }
+  const string name = protocol.substr(strlen(kGrpcTransportProtocolPrefix));
+  mutex_lock l(*get_rendezvous_transport_lock());
+  auto it = rendezvous_transports()->find(name);
+  return it == rendezvous_transports()->end() ? nullptr : &it->second;
+}
+
+// Configures `options` to use the transport selected by the protocol of
+// `server_def`, if any.
+Status MaybeUseRendezvousTransport(const ServerDef& server_def,
+                                   GrpcServerOptions* options) {
+  if (server_def.protocol() == kGrpcProtocol) {
+    return Status::OK();
+  }
+  const GrpcRendezvousTransport* transport =
+      LookupRendezvousTransport(server_def.protocol());
+  if (transport == nullptr) {
+    return errors::InvalidArgument(
+        "No rendezvous transport registered for protocol \"",
+        server_def.protocol(), "\"");
+  }
+  if (transport->init_func != nullptr) {
+    TF_RETURN_IF_ERROR(transport->init_func(server_def));
+  }
+  options->rendezvous_mgr_func = transport->rendezvous_mgr_func;
+  options->service_func = transport->service_func;
+  return Status::OK();
+}
+
+}  // namespace
+
+void RegisterGrpcRendezvousTransport(const string& name,
+                                     const GrpcRendezvousTransport& transport) {
+  CHECK(transport.rendezvous_mgr_func != nullptr)
+      << "The rendezvous transport " << name
+      << " has no rendezvous_mgr_func";
+  mutex_lock l(*get_rendezvous_transport_lock());
+  if (!rendezvous_transports()->insert({name, transport}).second) {
+    LOG(ERROR) << "Two rendezvous transports are being registered under "
+               << name;
+  }
+}
+
 std::unique_ptr<Master> GrpcServer::CreateMaster(MasterEnv* master_env) {
   return std::unique_ptr<Master>(new Master(master_env, 0.0));
 }
@@ -575,7 +643,10 @@ Status GrpcServer::Create(const ServerDef& server_def, Env* env,
   GrpcServerOptions options;
   options.rendezvous_mgr_func = NewRpcRendezvousMgr;
   options.local_device_mgr = local_device_mgr;
-  Status s = ret->Init(options);
+  Status s = MaybeUseRendezvousTransport(server_def, &options);
+  if (s.ok()) {
+    s = ret->Init(options);
+  }
   if (!s.ok()) {
     LOG(ERROR) << s;
     return s;
@@ -607,7 +678,8 @@ namespace {
 class GrpcServerFactory : public ServerFactory {
  public:
   bool AcceptsOptions(const ServerDef& server_def) override {
-    return server_def.protocol() == "grpc";
+    return server_def.protocol() == kGrpcProtocol ||
+           LookupRendezvousTransport(server_def.protocol()) != nullptr;
   }
 
   Status NewServer(const ServerDef& server_def, const Options& options,
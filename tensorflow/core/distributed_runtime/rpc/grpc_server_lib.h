@@ -72,6 +72,27 @@ struct GrpcServerOptions {
   DeviceMgr* local_device_mgr = nullptr;
 };
 
+// A transport for the tensors received by the remote rendezvous of a
+// GrpcServer, e.g. over RDMA.  The control messages between tasks stay on
+// gRPC.  A transport registered under "foo" is used by the servers whose
+// `ServerDef.protocol` is "grpc+foo".
+struct GrpcRendezvousTransport {
+  // Called before the server creates its devices, e.g. so that the transport
+  // can register the memory of the allocators with the network interface via
+  // `ProcessState::AddCPUAllocVisitor()` and the GPU equivalents.  Optional.
+  std::function<Status(const ServerDef&)> init_func = nullptr;
+  // Creates the RendezvousMgr of the server.  Required.
+  RendezvousMgrCreationFunction rendezvous_mgr_func = nullptr;
+  // Registers the gRPC services of the transport, e.g. to exchange the
+  // connection parameters and memory region keys of the tasks.  Optional.
+  ServiceInitFunction service_func = nullptr;
+};
+
+// Registers `transport` under `name`.  Must be called before a server with
+// protocol "grpc+<name>" is created, e.g. from a static initializer.
+void RegisterGrpcRendezvousTransport(const string& name,
+                                     const GrpcRendezvousTransport& transport);
+
 class GrpcServer : public ServerInterface {
  protected:
   GrpcServer(const ServerDef& server_def, Env* env);
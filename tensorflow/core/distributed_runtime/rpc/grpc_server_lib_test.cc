@@ -0,0 +1,107 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/rpc/grpc_server_lib.h"
+
+#include <memory>
+#include <string>
+
+#include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
+#include "tensorflow/core/distributed_runtime/server_lib.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/strcat.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/cluster.pb.h"
+#include "tensorflow/core/protobuf/tensorflow_server.pb.h"
+
+namespace tensorflow {
+namespace {
+
+ServerDef MakeServerDef(const string& protocol) {
+  ServerDef server_def;
+  JobDef* job = server_def.mutable_cluster()->add_job();
+  job->set_name("localhost");
+  (*job->mutable_tasks())[0] =
+      strings::StrCat("localhost:", testing::PickUnusedPortOrDie());
+  server_def.set_job_name("localhost");
+  server_def.set_task_index(0);
+  server_def.set_protocol(protocol);
+  return server_def;
+}
+
+// Counts the calls the server makes into a "grpc+fake" transport.
+struct FakeTransportCalls {
+  int init = 0;
+  int rendezvous_mgr = 0;
+  int service = 0;
+};
+
+FakeTransportCalls* fake_transport_calls() {
+  static FakeTransportCalls* calls = [] {
+    FakeTransportCalls* calls = new FakeTransportCalls;
+    GrpcRendezvousTransport transport;
+    transport.init_func = [calls](const ServerDef& server_def) {
+      ++calls->init;
+      return Status::OK();
+    };
+    transport.rendezvous_mgr_func = [calls](const WorkerEnv* env) {
+      ++calls->rendezvous_mgr;
+      return new RpcRendezvousMgr(env);
+    };
+    transport.service_func = [calls](const WorkerEnv* env,
+                                     ::grpc::ServerBuilder* builder) {
+      ++calls->service;
+    };
+    RegisterGrpcRendezvousTransport("fake", transport);
+    return calls;
+  }();
+  return calls;
+}
+
+TEST(GrpcServerLibTest, SelectsRegisteredTransport) {
+  FakeTransportCalls* calls = fake_transport_calls();
+  const FakeTransportCalls before = *calls;
+
+  std::unique_ptr<ServerInterface> server;
+  TF_ASSERT_OK(NewServer(MakeServerDef("grpc+fake"), &server));
+  EXPECT_EQ(calls->init, before.init + 1);
+  EXPECT_EQ(calls->rendezvous_mgr, before.rendezvous_mgr + 1);
+  EXPECT_EQ(calls->service, before.service + 1);
+}
+
+TEST(GrpcServerLibTest, PlainGrpcDoesNotUseTransport) {
+  FakeTransportCalls* calls = fake_transport_calls();
+  const FakeTransportCalls before = *calls;
+
+  std::unique_ptr<ServerInterface> server;
+  TF_ASSERT_OK(NewServer(MakeServerDef("grpc"), &server));
+  EXPECT_EQ(calls->init, before.init);
+  EXPECT_EQ(calls->rendezvous_mgr, before.rendezvous_mgr);
+  EXPECT_EQ(calls->service, before.service);
+}
+
+TEST(GrpcServerLibTest, RejectsUnregisteredTransport) {
+  fake_transport_calls();
+  const ServerDef server_def = MakeServerDef("grpc+unknown");
+
+  std::unique_ptr<ServerInterface> server;
+  EXPECT_FALSE(NewServer(server_def, &server).ok());
+  Status s = GrpcServer::Create(server_def, Env::Default(), &server);
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+}
+
+}  // namespace
+}  // namespace tensorflow
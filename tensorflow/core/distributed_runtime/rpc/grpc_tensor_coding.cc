@@ -15,6 +15,10 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/grpc_tensor_coding.h"
 
+#include <algorithm>
+#include <vector>
+
+#include "grpcpp/impl/codegen/proto_buffer_reader.h"
 #include "grpcpp/support/byte_buffer.h"
 #include "grpcpp/support/slice.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
@@ -25,6 +29,10 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/io/proto_encode_helper.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/protobuf.h"
+#include "tensorflow/core/platform/str_util.h"
+#include "tensorflow/core/protobuf/transport_options.pb.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
 
 namespace tensorflow {
@@ -249,5 +257,349 @@ void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
   }
 }
 
+// The type URL of a google.protobuf.Any holding a RecvBufRespExtra.
+constexpr char kRecvBufRespExtraTypeUrl[] =
+    "type.googleapis.com/tensorflow.RecvBufRespExtra";
+
+// We hand-encode a RecvBufResponse R into "*result" as follows:
+//
+// A:   <protocol buffer encoding of "header", i.e. R except
+//          R.transport_options()>
+// B:   <tag and varint32 length of R.transport_options()>
+// C:   <encoding of the google.protobuf.Any type URL, followed by the tag
+//          and varint32 length of its value, a RecvBufRespExtra>
+// For each chunk of the contents of "val":
+// D:   <tag and varint32 length of RecvBufRespExtra::tensor_content>
+// E:   <actual data of the chunk>
+//
+// A through C and all the D's are encoded into one grpc::Slice.  If the
+// tensor data is larger than "kLargeTensorBytes", every D and E is a
+// sub-slice of that slice or of a slice sharing the backing store of "val".
+// Otherwise everything is copied into a single grpc::Slice.
+void EncodeRecvBufResponseToByteBuffer(const RecvBufResponse& header,
+                                       const Tensor& val,
+                                       int64_t max_chunk_bytes,
+                                       ::grpc::ByteBuffer* result) {
+  const int kLargeTensorBytes = 1024;
+  const int64_t kProtoBufLimitBytes = 1LL << 31;
+  DCHECK(!header.has_transport_options());
+
+  StringPiece tdata = val.tensor_data();
+  const int64_t num_bytes = tdata.size();
+  if (num_bytes > kProtoBufLimitBytes) {
+    LOG(FATAL) << "Cannot encode a Tensor that exceeds the 2GB protobuf limit. "
+                  "Exceeded bytes: "
+               << num_bytes - kProtoBufLimitBytes;
+  }
+  const int64_t chunk_bytes =
+      max_chunk_bytes > 0 ? std::min(num_bytes, max_chunk_bytes) : num_bytes;
+
+  size_t extra_bytes = 0;
+  for (int64_t offset = 0; offset < num_bytes; offset += chunk_bytes) {
+    extra_bytes +=
+        VarLengthEncodingSize(RecvBufRespExtra::kTensorContentFieldNumber,
+                              std::min(chunk_bytes, num_bytes - offset));
+  }
+  const StringPiece type_url(kRecvBufRespExtraTypeUrl);
+  const uint32 any_bytes =
+      VarLengthEncodingSize(google::protobuf::Any::kTypeUrlFieldNumber,
+                            type_url.size()) +
+      VarLengthEncodingSize(google::protobuf::Any::kValueFieldNumber,
+                            extra_bytes);
+  string prefix;  // (A)
+  header.AppendToString(&prefix);
+  const size_t expected_size =
+      prefix.size() +
+      VarLengthEncodingSize(RecvBufResponse::kTransportOptionsFieldNumber,
+                            any_bytes);
+
+  // Encode everything but the tensor data.
+  gtl::InlinedVector<char, 1024> space(expected_size - num_bytes);
+  io::ProtoEncodeHelper e(space.data(), space.size());
+  e.WriteRawBytes(prefix);
+  // (B)
+  e.WriteVarlengthBeginning(RecvBufResponse::kTransportOptionsFieldNumber,
+                            any_bytes);
+  // (C)
+  e.WriteString(google::protobuf::Any::kTypeUrlFieldNumber, type_url);
+  e.WriteVarlengthBeginning(google::protobuf::Any::kValueFieldNumber,
+                            extra_bytes);
+  const size_t first_chunk_offset = e.size();
+  // (D)
+  for (int64_t offset = 0; offset < num_bytes; offset += chunk_bytes) {
+    e.WriteVarlengthBeginning(RecvBufRespExtra::kTensorContentFieldNumber,
+                              std::min(chunk_bytes, num_bytes - offset));
+  }
+  CHECK_EQ(e.size() + num_bytes, expected_size);
+
+  if (num_bytes <= kLargeTensorBytes) {
+    // Interleave the chunk headers and the copied tensor data.
+    ::grpc::Slice slice(expected_size);
+    char* dst = const_cast<char*>(reinterpret_cast<const char*>(slice.begin()));
+    memcpy(dst, e.data(), first_chunk_offset);
+    dst += first_chunk_offset;
+    const char* chunk_header = e.data() + first_chunk_offset;
+    for (int64_t offset = 0; offset < num_bytes; offset += chunk_bytes) {
+      const int64_t bytes = std::min(chunk_bytes, num_bytes - offset);
+      const size_t header_bytes = VarLengthEncodingSize(
+          RecvBufRespExtra::kTensorContentFieldNumber, bytes) - bytes;
+      memcpy(dst, chunk_header, header_bytes);
+      dst += header_bytes;
+      chunk_header += header_bytes;
+      memcpy(dst, tdata.data() + offset, bytes);
+      dst += bytes;
+    }
+    ::grpc::ByteBuffer tmp(&slice, 1);
+    result->Swap(&tmp);
+    return;
+  }
+
+  // (E) Share the backing store of the tensor data.  A single reference to
+  // the buffer is held by a slice of the whole tensor data, of which each
+  // chunk is a sub-slice.
+  ::grpc::Slice headers(e.data(), e.size());
+  const TensorBuffer* buf = DMAHelper::buffer(&val);
+  buf->Ref();
+  ::grpc::Slice data(
+      const_cast<void*>(static_cast<const void*>(tdata.data())), tdata.size(),
+      [](void* backing) { static_cast<TensorBuffer*>(backing)->Unref(); },
+      const_cast<TensorBuffer*>(buf));
+
+  std::vector<::grpc::Slice> slices;
+  slices.reserve(2 * ((num_bytes + chunk_bytes - 1) / chunk_bytes));
+  // The first slice of headers also holds A through C.
+  size_t header_begin = 0;
+  size_t header_end = first_chunk_offset;
+  for (int64_t offset = 0; offset < num_bytes; offset += chunk_bytes) {
+    const int64_t bytes = std::min(chunk_bytes, num_bytes - offset);
+    header_end += VarLengthEncodingSize(
+                      RecvBufRespExtra::kTensorContentFieldNumber, bytes) -
+                  bytes;
+    slices.push_back(headers.sub(header_begin, header_end));
+    slices.push_back(data.sub(offset, offset + bytes));
+    header_begin = header_end;
+  }
+  ::grpc::ByteBuffer tmp(slices.data(), slices.size());
+  result->Swap(&tmp);
+}
+
+namespace {
+
+using protobuf::internal::WireFormatLite;
+
+// Returns true if "tag" is of field "field_number" with wire type "type".
+bool IsField(uint32 tag, int field_number, WireFormatLite::WireType type) {
+  return WireFormatLite::GetTagFieldNumber(tag) == field_number &&
+         WireFormatLite::GetTagWireType(tag) == type;
+}
+
+// Decodes the RecvBufRespExtra value at "input", copying its tensor content
+// to "buf" + "*received_bytes" and advancing "*received_bytes" past it.
+Status DecodeRecvBufRespExtra(protobuf::io::CodedInputStream* input,
+                              char* buf, int64_t num_bytes,
+                              int64_t* received_bytes) {
+  int length;
+  if (!input->ReadVarintSizeAsInt(&length)) {
+    return errors::Internal("Could not parse RecvBufRespExtra");
+  }
+  const auto limit = input->PushLimit(length);
+  while (const uint32 tag = input->ReadTag()) {
+    if (!IsField(tag, RecvBufRespExtra::kTensorContentFieldNumber,
+                 WireFormatLite::WIRETYPE_LENGTH_DELIMITED)) {
+      if (!WireFormatLite::SkipField(input, tag)) {
+        return errors::Internal("Could not parse RecvBufRespExtra");
+      }
+      continue;
+    }
+    int chunk_bytes;
+    if (!input->ReadVarintSizeAsInt(&chunk_bytes)) {
+      return errors::Internal("Could not parse RecvBufRespExtra");
+    }
+    if (chunk_bytes > num_bytes - *received_bytes) {
+      return errors::Internal(
+          "Tensor Size Mismatch: RecvBufResponse returned more than ",
+          num_bytes, " bytes");
+    }
+    if (!input->ReadRaw(buf + *received_bytes, chunk_bytes)) {
+      return errors::Internal("Could not parse RecvBufRespExtra");
+    }
+    *received_bytes += chunk_bytes;
+  }
+  input->PopLimit(limit);
+  return Status::OK();
+}
+
+// Decodes the google.protobuf.Any at "input".  A RecvBufRespExtra value is
+// decoded into "buf"; any other value is stored in
+// "response->transport_options()".
+Status DecodeTransportOptions(protobuf::io::CodedInputStream* input,
+                              char* buf, int64_t num_bytes,
+                              int64_t* received_bytes,
+                              RecvBufResponse* response) {
+  int length;
+  if (!input->ReadVarintSizeAsInt(&length)) {
+    return errors::Internal("Could not parse RecvBufResponse");
+  }
+  const auto limit = input->PushLimit(length);
+  string type_url;
+  string value;
+  while (const uint32 tag = input->ReadTag()) {
+    bool ok;
+    if (IsField(tag, google::protobuf::Any::kTypeUrlFieldNumber,
+                WireFormatLite::WIRETYPE_LENGTH_DELIMITED)) {
+      ok = WireFormatLite::ReadString(input, &type_url);
+    } else if (IsField(tag, google::protobuf::Any::kValueFieldNumber,
+                       WireFormatLite::WIRETYPE_LENGTH_DELIMITED)) {
+      // Both the encoder above and the protocol buffer serializer write the
+      // type URL ahead of the value.
+      if (str_util::EndsWith(type_url, "/tensorflow.RecvBufRespExtra")) {
+        TF_RETURN_IF_ERROR(
+            DecodeRecvBufRespExtra(input, buf, num_bytes, received_bytes));
+        type_url.clear();
+        ok = true;
+      } else {
+        ok = WireFormatLite::ReadBytes(input, &value);
+      }
+    } else {
+      ok = WireFormatLite::SkipField(input, tag);
+    }
+    if (!ok) return errors::Internal("Could not parse RecvBufResponse");
+  }
+  input->PopLimit(limit);
+  if (!type_url.empty() || !value.empty()) {
+    response->mutable_transport_options()->set_type_url(type_url);
+    response->mutable_transport_options()->set_value(value);
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+Status DecodeRecvBufResponseFromByteBuffer(::grpc::ByteBuffer* src, char* buf,
+                                           int64_t num_bytes,
+                                           RecvBufResponse* response) {
+  response->Clear();
+  ::grpc::ProtoBufferReader reader(src);
+  protobuf::io::CodedInputStream input(&reader);
+  int64_t received_bytes = 0;
+  while (const uint32 tag = input.ReadTag()) {
+    bool ok;
+    switch (WireFormatLite::GetTagFieldNumber(tag)) {
+      case RecvBufResponse::kBufPtrFieldNumber: {
+        protobuf_uint64 v;
+        ok = IsField(tag, RecvBufResponse::kBufPtrFieldNumber,
+                     WireFormatLite::WIRETYPE_FIXED64) &&
+             input.ReadLittleEndian64(&v);
+        response->set_buf_ptr(v);
+        break;
+      }
+      case RecvBufResponse::kNumBytesFieldNumber: {
+        protobuf_uint64 v;
+        ok = IsField(tag, RecvBufResponse::kNumBytesFieldNumber,
+                     WireFormatLite::WIRETYPE_VARINT) &&
+             input.ReadVarint64(&v);
+        response->set_num_bytes(static_cast<int64_t>(v));
+        break;
+      }
+      case RecvBufResponse::kIsDeadFieldNumber: {
+        protobuf_uint64 v;
+        ok = IsField(tag, RecvBufResponse::kIsDeadFieldNumber,
+                     WireFormatLite::WIRETYPE_VARINT) &&
+             input.ReadVarint64(&v);
+        response->set_is_dead(v != 0);
+        break;
+      }
+      case RecvBufResponse::kTransportOptionsFieldNumber: {
+        ok = IsField(tag, RecvBufResponse::kTransportOptionsFieldNumber,
+                     WireFormatLite::WIRETYPE_LENGTH_DELIMITED);
+        if (ok) {
+          TF_RETURN_IF_ERROR(DecodeTransportOptions(
+              &input, buf, num_bytes, &received_bytes, response));
+        }
+        break;
+      }
+      case RecvBufResponse::kSendStartMicrosFieldNumber: {
+        protobuf_uint64 v;
+        ok = IsField(tag, RecvBufResponse::kSendStartMicrosFieldNumber,
+                     WireFormatLite::WIRETYPE_VARINT) &&
+             input.ReadVarint64(&v);
+        response->set_send_start_micros(static_cast<int64_t>(v));
+        break;
+      }
+      case RecvBufResponse::kRequireAckFieldNumber: {
+        protobuf_uint64 v;
+        ok = IsField(tag, RecvBufResponse::kRequireAckFieldNumber,
+                     WireFormatLite::WIRETYPE_VARINT) &&
+             input.ReadVarint64(&v);
+        response->set_require_ack(v != 0);
+        break;
+      }
+      default:
+        ok = WireFormatLite::SkipField(&input, tag);
+        break;
+    }
+    if (!ok) return errors::Internal("Could not parse RecvBufResponse");
+  }
+  if (!response->has_transport_options() && received_bytes != num_bytes) {
+    return errors::Internal("Tensor Size Mismatch: RecvBufResponse returned ",
+                            received_bytes, " bytes, expected: ", num_bytes);
+  }
+  return Status::OK();
+}
+
+int64_t ElementsPerTensorChunk(int64_t element_size, int64_t max_chunk_bytes) {
+  return std::max<int64_t>(1, max_chunk_bytes / element_size);
+}
+
+Status DecodeTensorChunkFromByteBuffer(::grpc::ByteBuffer* src, char* buf,
+                                       int64_t num_bytes) {
+  ::grpc::ProtoBufferReader reader(src);
+  protobuf::io::CodedInputStream input(&reader);
+  int64_t received_bytes = 0;
+  while (const uint32 tag = input.ReadTag()) {
+    if (!IsField(tag, RecvTensorResponse::kTensorFieldNumber,
+                 WireFormatLite::WIRETYPE_LENGTH_DELIMITED)) {
+      if (!WireFormatLite::SkipField(&input, tag)) {
+        return errors::Internal("Could not parse RecvTensorResponse");
+      }
+      continue;
+    }
+    int length;
+    if (!input.ReadVarintSizeAsInt(&length)) {
+      return errors::Internal("Could not parse RecvTensorResponse");
+    }
+    const auto limit = input.PushLimit(length);
+    while (const uint32 tensor_tag = input.ReadTag()) {
+      if (!IsField(tensor_tag, TensorProto::kTensorContentFieldNumber,
+                   WireFormatLite::WIRETYPE_LENGTH_DELIMITED)) {
+        if (!WireFormatLite::SkipField(&input, tensor_tag)) {
+          return errors::Internal("Could not parse RecvTensorResponse");
+        }
+        continue;
+      }
+      int content_bytes;
+      if (!input.ReadVarintSizeAsInt(&content_bytes)) {
+        return errors::Internal("Could not parse RecvTensorResponse");
+      }
+      if (content_bytes > num_bytes - received_bytes) {
+        return errors::Internal(
+            "Tensor Size Mismatch: RecvTensorResponse returned more than ",
+            num_bytes, " bytes");
+      }
+      if (!input.ReadRaw(buf + received_bytes, content_bytes)) {
+        return errors::Internal("Could not parse RecvTensorResponse");
+      }
+      received_bytes += content_bytes;
+    }
+    input.PopLimit(limit);
+  }
+  if (received_bytes != num_bytes) {
+    return errors::Internal(
+        "Tensor Size Mismatch: RecvTensorResponse returned ", received_bytes,
+        " bytes, expected: ", num_bytes);
+  }
+  return Status::OK();
+}
+
 }  // namespace grpc
 }  // namespace tensorflow
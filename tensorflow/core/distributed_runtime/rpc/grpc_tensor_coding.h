@@ -17,9 +17,12 @@ limitations under the License.
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_TENSOR_CODING_H_
 
 #include "grpcpp/impl/codegen/byte_buffer.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/types.h"
 
 namespace tensorflow {
 class Tensor;
+class RecvBufResponse;
 class RecvTensorResponse;
 
 // TODO(jeff,sanjay): this should not be grpc specific.  Instead of
@@ -49,6 +52,45 @@ void EncodeRecvTensorResponseToByteBuffer(const RecvTensorResponse& proto,
 void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
                               ::grpc::ByteBuffer* result);
 
+// Encode "header" and the contents of "val" into a byte buffer in a format
+// that is parseable as a RecvBufResponse protocol buffer holding "header",
+// with the contents of "val" packed into "transport_options" as a
+// RecvBufRespExtra of chunks of at most "max_chunk_bytes" bytes (or of a
+// single chunk if "max_chunk_bytes" is not positive).
+//
+// "header" must not have "transport_options" set.  Large tensors share the
+// backing store of "val" instead of copying it into the byte buffer.
+//
+// Discards original contents of *result.
+void EncodeRecvBufResponseToByteBuffer(const RecvBufResponse& header,
+                                       const Tensor& val,
+                                       int64_t max_chunk_bytes,
+                                       ::grpc::ByteBuffer* result);
+
+// Decode a RecvBufResponse protocol buffer from "src" into "*response".
+//
+// If "transport_options" holds a RecvBufRespExtra, its tensor content is
+// copied directly into the "num_bytes" bytes at "buf", which must receive
+// exactly that many bytes, and "transport_options" is left unset.  Other
+// transport options are decoded into "*response" as usual.
+Status DecodeRecvBufResponseFromByteBuffer(::grpc::ByteBuffer* src, char* buf,
+                                           int64_t num_bytes,
+                                           RecvBufResponse* response);
+
+// Returns the number of elements in each chunk (but the last) of a tensor
+// with elements of "element_size" bytes that is split into chunks of at most
+// "max_chunk_bytes" bytes.  Every chunk holds at least one element.
+int64_t ElementsPerTensorChunk(int64_t element_size, int64_t max_chunk_bytes);
+
+// Decode the tensor content of a RecvTensorResponse protocol buffer from
+// "src", copying it directly into the "num_bytes" bytes at "buf", which must
+// receive exactly that many bytes.  All other fields are ignored.
+//
+// Used for the chunks of a tensor split by the sender; see
+// "RecvTensorRequest.max_chunk_bytes".
+Status DecodeTensorChunkFromByteBuffer(::grpc::ByteBuffer* src, char* buf,
+                                       int64_t num_bytes);
+
 }  // namespace grpc
 }  // namespace tensorflow
 
@@ -15,13 +15,18 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/grpc_tensor_coding.h"
 
+#include <algorithm>
+
 #include "grpcpp/support/byte_buffer.h"
 #include "grpcpp/support/slice.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/transport_options.pb.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
 
 namespace tensorflow {
@@ -100,4 +105,130 @@ TEST_F(GrpcTensorCodingTest, Simple) {
 
 TEST_F(GrpcTensorCodingTest, StringTensor) { DoTestForStrings(DT_STRING); }
 
+TEST(GrpcRecvBufCodingTest, EncodeAndDecode) {
+  for (int64_t elems : {0, 1, 100, 1000, 10000}) {
+    Tensor t(DT_FLOAT, TensorShape({elems}));
+    for (int64_t i = 0; i < elems; ++i) {
+      t.flat<float>()(i) = i;
+    }
+    const int64_t num_bytes = t.TotalBytes();
+    for (int64_t max_chunk_bytes : {0, 3, 4096, 100000}) {
+      SCOPED_TRACE(strings::StrCat("elems ", elems, ", max_chunk_bytes ",
+                                   max_chunk_bytes));
+      RecvBufResponse header;
+      header.set_send_start_micros(1234);
+      header.set_require_ack(true);
+      ::grpc::ByteBuffer buf;
+      grpc::EncodeRecvBufResponseToByteBuffer(header, t, max_chunk_bytes,
+                                              &buf);
+
+      // The encoding is parseable as a RecvBufResponse.
+      std::vector<::grpc::Slice> slices;
+      ASSERT_TRUE(buf.Dump(&slices).ok());
+      string serialized;
+      for (const auto& s : slices) {
+        serialized.append(reinterpret_cast<const char*>(s.begin()), s.size());
+      }
+      RecvBufResponse response;
+      ASSERT_TRUE(response.ParseFromString(serialized));
+      EXPECT_EQ(response.send_start_micros(), 1234);
+      EXPECT_TRUE(response.require_ack());
+      RecvBufRespExtra extra;
+      ASSERT_TRUE(response.transport_options().UnpackTo(&extra));
+      string content;
+      for (const auto& chunk : extra.tensor_content()) {
+        if (max_chunk_bytes > 0) {
+          EXPECT_LE(chunk.size(), max_chunk_bytes);
+        }
+        content.append(chunk);
+      }
+      EXPECT_EQ(content, t.tensor_data());
+
+      // Decoding copies the tensor content into the receive buffer.
+      Tensor result(DT_FLOAT, TensorShape({elems}));
+      RecvBufResponse decoded;
+      TF_ASSERT_OK(grpc::DecodeRecvBufResponseFromByteBuffer(
+          &buf, const_cast<char*>(result.tensor_data().data()), num_bytes,
+          &decoded));
+      EXPECT_FALSE(decoded.has_transport_options());
+      EXPECT_EQ(decoded.send_start_micros(), 1234);
+      EXPECT_TRUE(decoded.require_ack());
+      test::ExpectTensorEqual<float>(t, result);
+    }
+  }
+}
+
+TEST(GrpcRecvBufCodingTest, DecodeSizeMismatch) {
+  Tensor t(DT_FLOAT, TensorShape({100}));
+  t.flat<float>().setZero();
+  ::grpc::ByteBuffer buf;
+  grpc::EncodeRecvBufResponseToByteBuffer(RecvBufResponse(), t, 64, &buf);
+  Tensor result(DT_FLOAT, TensorShape({200}));
+  RecvBufResponse decoded;
+  EXPECT_TRUE(errors::IsInternal(grpc::DecodeRecvBufResponseFromByteBuffer(
+      &buf, const_cast<char*>(result.tensor_data().data()), 200 * sizeof(float),
+      &decoded)));
+  EXPECT_TRUE(errors::IsInternal(grpc::DecodeRecvBufResponseFromByteBuffer(
+      &buf, const_cast<char*>(result.tensor_data().data()), 50 * sizeof(float),
+      &decoded)));
+}
+
+TEST(GrpcRecvBufCodingTest, DecodeOtherTransportOptions) {
+  RecvBufResponse response;
+  response.set_is_dead(true);
+  RecvTensorRequest other;
+  other.set_step_id(7);
+  response.mutable_transport_options()->PackFrom(other);
+  string serialized = response.SerializeAsString();
+  ::grpc::Slice slice(serialized.data(), serialized.size());
+  ::grpc::ByteBuffer buf(&slice, 1);
+  RecvBufResponse decoded;
+  TF_ASSERT_OK(
+      grpc::DecodeRecvBufResponseFromByteBuffer(&buf, nullptr, 0, &decoded));
+  EXPECT_TRUE(decoded.is_dead());
+  RecvTensorRequest unpacked;
+  ASSERT_TRUE(decoded.transport_options().UnpackTo(&unpacked));
+  EXPECT_EQ(unpacked.step_id(), 7);
+}
+
+TEST(GrpcTensorChunkCodingTest, EncodeAndDecode) {
+  const int64_t elems = 10000;
+  Tensor t(DT_FLOAT, TensorShape({100, elems / 100}));
+  for (int64_t i = 0; i < elems; ++i) {
+    t.flat<float>()(i) = i;
+  }
+  for (int64_t max_chunk_bytes : {3, 4096, 10000}) {
+    SCOPED_TRACE(strings::StrCat("max_chunk_bytes ", max_chunk_bytes));
+    const int64_t chunk_elems =
+        grpc::ElementsPerTensorChunk(sizeof(float), max_chunk_bytes);
+    EXPECT_GE(chunk_elems, 1);
+    Tensor flat;
+    ASSERT_TRUE(flat.CopyFrom(t, TensorShape({elems})));
+    Tensor result(DT_FLOAT, t.shape());
+    char* dst = const_cast<char*>(result.tensor_data().data());
+    for (int64_t begin = 0; begin < elems; begin += chunk_elems) {
+      const int64_t end = std::min(begin + chunk_elems, elems);
+      ::grpc::ByteBuffer buf;
+      grpc::EncodeTensorToByteBuffer(false, flat.Slice(begin, end), false,
+                                     &buf);
+      TF_ASSERT_OK(grpc::DecodeTensorChunkFromByteBuffer(
+          &buf, dst + begin * sizeof(float), (end - begin) * sizeof(float)));
+    }
+    test::ExpectTensorEqual<float>(t, result);
+  }
+}
+
+TEST(GrpcTensorChunkCodingTest, DecodeSizeMismatch) {
+  Tensor t(DT_FLOAT, TensorShape({100}));
+  t.flat<float>().setZero();
+  ::grpc::ByteBuffer buf;
+  grpc::EncodeTensorToByteBuffer(false, t, false, &buf);
+  Tensor result(DT_FLOAT, TensorShape({200}));
+  char* dst = const_cast<char*>(result.tensor_data().data());
+  EXPECT_TRUE(errors::IsInternal(
+      grpc::DecodeTensorChunkFromByteBuffer(&buf, dst, 200 * sizeof(float))));
+  EXPECT_TRUE(errors::IsInternal(
+      grpc::DecodeTensorChunkFromByteBuffer(&buf, dst, 50 * sizeof(float))));
+}
+
 }  // namespace tensorflow
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/grpc_worker_service.h"
 
+#include <algorithm>
 #include <deque>
 #include <memory>
 #include <unordered_map>
@@ -48,12 +49,15 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/profiler/lib/scoped_memory_debug_annotation.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+#include "tensorflow/core/profiler/lib/traceme_encode.h"
 #include "tensorflow/core/protobuf/transport_options.pb.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
 
@@ -61,6 +65,88 @@ namespace tensorflow {
 
 namespace {
 
+auto* worker_rpc_queue_delay_usecs = monitoring::Sampler<1>::New(
+    {"/tensorflow/core/grpc_worker_service/queue_delay_usecs",
+     "The time between the arrival of a WorkerService RPC and the start of its "
+     "handler on the compute pool, in microseconds.",
+     "method"},
+    // Power of 2 with bucket count 24 (> 16 seconds)
+    {monitoring::Buckets::Exponential(1, 2, 24)});
+
+auto* worker_rpc_handler_usecs = monitoring::Sampler<1>::New(
+    {"/tensorflow/core/grpc_worker_service/handler_usecs",
+     "The time spent handling a WorkerService RPC until its response is sent, "
+     "in microseconds.",
+     "method"},
+    // Power of 2 with bucket count 30 (> 17 minutes)
+    {monitoring::Buckets::Exponential(1, 2, 30)});
+
+auto* worker_rpc_request_bytes = monitoring::Sampler<1>::New(
+    {"/tensorflow/core/grpc_worker_service/request_bytes",
+     "The size of WorkerService RPC requests in bytes.", "method"},
+    // Power of 4 with bucket count 16 (> 1GB)
+    {monitoring::Buckets::Exponential(1, 4, 16)});
+
+auto* worker_rpc_response_bytes = monitoring::Sampler<1>::New(
+    {"/tensorflow/core/grpc_worker_service/response_bytes",
+     "The size of WorkerService RPC responses in bytes.", "method"},
+    // Power of 4 with bucket count 16 (> 1GB)
+    {monitoring::Buckets::Exponential(1, 4, 16)});
+
+// Records the queue delay, handler time and payload sizes of one
+// WorkerService RPC.  Constructed when the completion queue thread dispatches
+// the call, and copied into the closures that complete it.
+class WorkerRpcStats {
+ public:
+  explicit WorkerRpcStats(GrpcWorkerMethod method)
+      : cells_(&MethodCells(method)),
+        arrival_usecs_(Env::Default()->NowMicros()),
+        start_usecs_(arrival_usecs_) {}
+
+  // Called when the handler starts running on the compute pool.
+  void Started() {
+    start_usecs_ = Env::Default()->NowMicros();
+    cells_->queue_delay->Add(start_usecs_ - arrival_usecs_);
+  }
+
+  // Called just before the response is sent.
+  void Finished(size_t request_bytes, size_t response_bytes) const {
+    cells_->handler->Add(Env::Default()->NowMicros() - start_usecs_);
+    cells_->request_bytes->Add(request_bytes);
+    cells_->response_bytes->Add(response_bytes);
+  }
+
+ private:
+  struct Cells {
+    monitoring::SamplerCell* queue_delay;
+    monitoring::SamplerCell* handler;
+    monitoring::SamplerCell* request_bytes;
+    monitoring::SamplerCell* response_bytes;
+  };
+
+  // Looks the cells of every method up once, since GetCell() takes a lock.
+  static const Cells& MethodCells(GrpcWorkerMethod method) {
+    static const std::vector<Cells>* cells = [] {
+      auto* cells = new std::vector<Cells>;
+      cells->reserve(kGrpcNumWorkerMethods);
+      for (int i = 0; i < kGrpcNumWorkerMethods; ++i) {
+        const string name =
+            GrpcWorkerMethodName(static_cast<GrpcWorkerMethod>(i));
+        cells->push_back({worker_rpc_queue_delay_usecs->GetCell(name),
+                          worker_rpc_handler_usecs->GetCell(name),
+                          worker_rpc_request_bytes->GetCell(name),
+                          worker_rpc_response_bytes->GetCell(name)});
+      }
+      return cells;
+    }();
+    return (*cells)[static_cast<int>(method)];
+  }
+
+  const Cells* cells_;  // Not owned.
+  uint64 arrival_usecs_;
+  uint64 start_usecs_;
+};
+
 // This macro creates a new request for the given RPC method name
 // (e.g., `ENQUEUE_REQUEST(GetStatus, false);`), and enqueues it on
 // `this->cq_`.
@@ -144,7 +230,6 @@ class GrpcWorkerServiceThread {
     SETUP_FOR_REQUEST(CompleteGroup, 10, true);
     SETUP_FOR_REQUEST(CompleteInstance, 10, true);
     SETUP_FOR_REQUEST(GetStepSequence, 10, true);
-    SETUP_FOR_REQUEST(RecvBuf, 500, true);
     SETUP_FOR_REQUEST(RunGraph, 100, true);
     SETUP_FOR_REQUEST(CleanupGraph, 100, false);
     SETUP_FOR_REQUEST(MarkRecvFinished, 10, false);
@@ -158,6 +243,13 @@ class GrpcWorkerServiceThread {
          ++i) {
       EnqueueRecvTensorRequestRaw();
     }
+    for (int i = 0;
+         i < gtl::FindWithDefault(
+                 queue_depth_, static_cast<int>(GrpcWorkerMethod::kRecvBuf),
+                 500);
+         ++i) {
+      EnqueueRecvBufRequestRaw();
+    }
 
     void* tag;
     bool ok;
@@ -192,11 +284,15 @@ class GrpcWorkerServiceThread {
   // compute pool.
 #define HANDLE_CALL(method, may_block_on_compute_pool)                        \
   void method##Handler(WorkerCall<method##Request, method##Response>* call) { \
-    auto closure = [this, call]() {                                           \
+    WorkerRpcStats stats(GrpcWorkerMethod::k##method);                        \
+    auto closure = [this, call, stats]() mutable {                            \
+      stats.Started();                                                        \
       Status s = worker_->method(&call->request, &call->response);            \
       if (!s.ok()) {                                                          \
         VLOG(3) << "Bad response from " << #method << ": " << s;              \
       }                                                                       \
+      stats.Finished(call->request.ByteSizeLong(),                            \
+                     call->response.ByteSizeLong());                          \
       call->SendResponse(ToGrpcStatus(s));                                    \
     };                                                                        \
     if ((may_block_on_compute_pool)) {                                        \
@@ -221,10 +317,14 @@ class GrpcWorkerServiceThread {
 
   void GetStepSequenceHandler(
       WorkerCall<GetStepSequenceRequest, GetStepSequenceResponse>* call) {
-    Schedule([this, call]() {
+    WorkerRpcStats stats(GrpcWorkerMethod::kGetStepSequence);
+    Schedule([this, call, stats]() mutable {
+      stats.Started();
       worker_->GetStepSequenceAsync(
-          &call->request, &call->response, [call](const Status& s) {
+          &call->request, &call->response, [call, stats](const Status& s) {
             VLOG(3) << "Bad response from GetStepSequence:" << s;
+            stats.Finished(call->request.ByteSizeLong(),
+                           call->response.ByteSizeLong());
             call->SendResponse(ToGrpcStatus(s));
           });
     });
@@ -233,14 +333,19 @@ class GrpcWorkerServiceThread {
 
   void MarkRecvFinishedHandler(
       WorkerCall<MarkRecvFinishedRequest, MarkRecvFinishedResponse>* call) {
+    WorkerRpcStats stats(GrpcWorkerMethod::kMarkRecvFinished);
+    stats.Started();
     VLOG(3) << "Clean cache entry for request " << call->request.request_id();
     worker_->RemoveCacheEntryForId(call->request.request_id());
+    stats.Finished(call->request.ByteSizeLong(), call->response.ByteSizeLong());
     call->SendResponse(::grpc::Status::OK);
     ENQUEUE_REQUEST(MarkRecvFinished, false);
   }
 
   void RunGraphHandler(WorkerCall<RunGraphRequest, RunGraphResponse>* call) {
-    Schedule([this, call]() {
+    WorkerRpcStats stats(GrpcWorkerMethod::kRunGraph);
+    Schedule([this, call, stats]() mutable {
+      stats.Started();
       CallOptions* call_opts = new CallOptions;
       ProtoRunGraphRequest* wrapped_request =
           new ProtoRunGraphRequest(&call->request);
@@ -249,7 +354,7 @@ class GrpcWorkerServiceThread {
       call->SetCancelCallback([call_opts]() { call_opts->StartCancel(); });
       worker_->RunGraphAsync(call_opts, wrapped_request, wrapped_response,
                              [call, call_opts, wrapped_request,
-                              wrapped_response](const Status& s) {
+                              wrapped_response, stats](const Status& s) {
                                VLOG(3) << "RunGraph::Done";
                                if (!s.ok()) {
                                  VLOG(3) << "Bad response from RunGraph:" << s;
@@ -258,6 +363,8 @@ class GrpcWorkerServiceThread {
                                delete call_opts;
                                delete wrapped_request;
                                delete wrapped_response;
+                               stats.Finished(call->request.ByteSizeLong(),
+                                              call->response.ByteSizeLong());
                                call->SendResponse(ToGrpcStatus(s));
                              });
     });
@@ -266,54 +373,77 @@ class GrpcWorkerServiceThread {
 
   void RecvTensorHandlerRaw(
       WorkerCall<RecvTensorRequest, ::grpc::ByteBuffer>* call) {
-    Schedule([this, call]() {
+    WorkerRpcStats stats(GrpcWorkerMethod::kRecvTensor);
+    Schedule([this, call, stats]() mutable {
+      stats.Started();
+      const int64_t trace_id = profiler::TraceMe::ActivityStart([call]() {
+        return profiler::TraceMeEncode(
+            "GrpcWorkerService::RecvTensor",
+            {{"step_id", call->request.step_id()},
+             {"rendezvous_key", call->request.rendezvous_key()},
+             {"chunk", call->request.fetch_chunk()
+                           ? call->request.chunk_index()
+                           : int64_t{-1}}});
+      });
       CallOptions* call_opts = new CallOptions;
       call->SetCancelCallback([call_opts]() { call_opts->StartCancel(); });
 
       worker_->GrpcRecvTensorAsync(
           call_opts, &call->request, &call->response,
-          [call, call_opts](const Status& s) {
+          [call, call_opts, stats, trace_id](const Status& s) {
             call->ClearCancelCallback();
             delete call_opts;
             if (!s.ok()) {
               VLOG(3) << "Bad response from RecvTensor:" << s;
             }
+            stats.Finished(call->request.ByteSizeLong(),
+                           call->response.Length());
+            profiler::TraceMe::ActivityEnd(trace_id);
             call->SendResponse(ToGrpcStatus(s));
           });
     });
     EnqueueRecvTensorRequestRaw();
   }
 
-  void RecvBufHandler(WorkerCall<RecvBufRequest, RecvBufResponse>* call) {
-    Schedule([this, call]() {
+  void RecvBufHandlerRaw(WorkerCall<RecvBufRequest, ::grpc::ByteBuffer>* call) {
+    WorkerRpcStats stats(GrpcWorkerMethod::kRecvBuf);
+    Schedule([this, call, stats]() mutable {
+      stats.Started();
       CallOptions* call_opts = new CallOptions;
       call->SetCancelCallback([call_opts]() { call_opts->StartCancel(); });
-      worker_->RecvBufAsync(call_opts, &call->request, &call->response,
-                            [call, call_opts](const Status& s) {
-                              call->ClearCancelCallback();
-                              delete call_opts;
-                              if (!s.ok()) {
-                                VLOG(3) << "Bad response from RecvBuf:" << s;
-                              }
-                              call->SendResponse(ToGrpcStatus(s));
-                            });
+      worker_->GrpcRecvBufAsync(call_opts, &call->request, &call->response,
+                                [call, call_opts, stats](const Status& s) {
+                                  call->ClearCancelCallback();
+                                  delete call_opts;
+                                  if (!s.ok()) {
+                                    VLOG(3)
+                                        << "Bad response from RecvBuf:" << s;
+                                  }
+                                  stats.Finished(call->request.ByteSizeLong(),
+                                                 call->response.Length());
+                                  call->SendResponse(ToGrpcStatus(s));
+                                });
     });
-    ENQUEUE_REQUEST(RecvBuf, true);
+    EnqueueRecvBufRequestRaw();
   }
 
   void CompleteGroupHandler(
       WorkerCall<CompleteGroupRequest, CompleteGroupResponse>* call) {
-    Schedule([this, call]() {
+    WorkerRpcStats stats(GrpcWorkerMethod::kCompleteGroup);
+    Schedule([this, call, stats]() mutable {
+      stats.Started();
       CallOptions* call_opts = new CallOptions;
       call->SetCancelCallback([call_opts]() { call_opts->StartCancel(); });
       worker_->CompleteGroupAsync(
           call_opts, &call->request, &call->response,
-          [call, call_opts](const Status& s) {
+          [call, call_opts, stats](const Status& s) {
             call->ClearCancelCallback();
             delete call_opts;
             if (!s.ok()) {
               VLOG(3) << "Bad response from CompleteGroup:" << s;
             }
+            stats.Finished(call->request.ByteSizeLong(),
+                           call->response.ByteSizeLong());
             call->SendResponse(ToGrpcStatus(s));
           });
     });
@@ -322,17 +452,21 @@ class GrpcWorkerServiceThread {
 
   void CompleteInstanceHandler(
       WorkerCall<CompleteInstanceRequest, CompleteInstanceResponse>* call) {
-    Schedule([this, call]() {
+    WorkerRpcStats stats(GrpcWorkerMethod::kCompleteInstance);
+    Schedule([this, call, stats]() mutable {
+      stats.Started();
       CallOptions* call_opts = new CallOptions;
       call->SetCancelCallback([call_opts]() { call_opts->StartCancel(); });
       worker_->CompleteInstanceAsync(
           call_opts, &call->request, &call->response,
-          [call, call_opts](const Status& s) {
+          [call, call_opts, stats](const Status& s) {
             call->ClearCancelCallback();
             delete call_opts;
             if (!s.ok()) {
               VLOG(3) << "Bad response from CompleteInstance:" << s;
             }
+            stats.Finished(call->request.ByteSizeLong(),
+                           call->response.ByteSizeLong());
             call->SendResponse(ToGrpcStatus(s));
           });
     });
@@ -353,6 +487,19 @@ class GrpcWorkerServiceThread {
     }
   }
 
+  void EnqueueRecvBufRequestRaw() {
+    mutex_lock l(shutdown_mu_);
+    if (!is_shutdown_) {
+      Call<GrpcWorkerServiceThread, grpc::WorkerService::AsyncService,
+           RecvBufRequest, ::grpc::ByteBuffer>::
+          EnqueueRequestForMethod(
+              worker_service_, cq_.get(),
+              static_cast<int>(GrpcWorkerMethod::kRecvBuf),
+              &GrpcWorkerServiceThread::RecvBufHandlerRaw,
+              true /* supports cancel*/);
+    }
+  }
+
   GrpcWorker* const worker_ = nullptr;  // Not owned.
   std::unique_ptr<::grpc::ServerCompletionQueue> cq_;
   std::unique_ptr<Thread> thread_;
@@ -443,16 +590,36 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
                                      ::grpc::ByteBuffer* response,
                                      StatusCallback done) {
   VLOG(3) << "GrpcRecvTensorAsync req: " << request->DebugString();
+  if (request->fetch_chunk()) {
+    RecvTensorChunkAsync(request, response, std::move(done));
+    return;
+  }
   const int64_t request_id = request->request_id();
   const int64_t step_id = request->step_id();
 
   bool cache_enabled = (response_cache_ != nullptr && request_id != 0);
 
-  auto do_response = [response, done, cache_enabled](const Tensor& tensor,
-                                                     bool is_dead,
-                                                     const Status& status) {
+  auto do_response = [this, request, response, done, cache_enabled](
+                         const Tensor& tensor, bool is_dead,
+                         const Status& status) {
     if (status.ok()) {
-      grpc::EncodeTensorToByteBuffer(is_dead, tensor, cache_enabled, response);
+      const int64_t max_chunk_bytes = request->max_chunk_bytes();
+      if (max_chunk_bytes > 0 && !is_dead &&
+          DataTypeCanUseMemcpy(tensor.dtype()) &&
+          tensor.TotalBytes() > max_chunk_bytes) {
+        // Respond with the metadata only, and let the receiver fetch the
+        // content in chunks.
+        RecvTensorResponse header;
+        header.mutable_tensor()->set_dtype(tensor.dtype());
+        tensor.shape().AsProto(header.mutable_tensor()->mutable_tensor_shape());
+        header.set_send_start_micros(env_->env->NowMicros());
+        header.set_require_ack(cache_enabled);
+        header.set_num_chunks(StageTensorChunks(*request, tensor));
+        grpc::EncodeRecvTensorResponseToByteBuffer(header, response);
+      } else {
+        grpc::EncodeTensorToByteBuffer(is_dead, tensor, cache_enabled,
+                                       response);
+      }
     }
     done(status);
   };
@@ -560,6 +727,63 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
       });
 }
 
+int64_t GrpcWorker::StageTensorChunks(const RecvTensorRequest& request,
+                                      const Tensor& tensor) {
+  StagedTensor staged;
+  CHECK(staged.flat.CopyFrom(tensor, TensorShape({tensor.NumElements()})));
+  staged.chunk_elems = grpc::ElementsPerTensorChunk(
+      DataTypeSize(tensor.dtype()), request.max_chunk_bytes());
+  const int64_t num_chunks =
+      (tensor.NumElements() + staged.chunk_elems - 1) / staged.chunk_elems;
+  staged.fetched.resize(num_chunks, false);
+  mutex_lock l(staged_mu_);
+  // A retried request replaces the tensor staged by the original one.
+  staged_tensors_[{request.step_id(), request.rendezvous_key()}] =
+      std::move(staged);
+  return num_chunks;
+}
+
+void GrpcWorker::RecvTensorChunkAsync(const RecvTensorRequest* request,
+                                      ::grpc::ByteBuffer* response,
+                                      StatusCallback done) {
+  const int64_t chunk_index = request->chunk_index();
+  Tensor chunk;
+  {
+    mutex_lock l(staged_mu_);
+    auto it =
+        staged_tensors_.find({request->step_id(), request->rendezvous_key()});
+    if (it == staged_tensors_.end()) {
+      done(errors::FailedPrecondition(
+          "RecvTensor chunk ", chunk_index, " requested for ",
+          request->rendezvous_key(), " in step ", request->step_id(),
+          ", but no such tensor is staged"));
+      return;
+    }
+    StagedTensor& staged = it->second;
+    const int64_t num_chunks = staged.fetched.size();
+    if (chunk_index < 0 || chunk_index >= num_chunks) {
+      done(errors::InvalidArgument("RecvTensor chunk ", chunk_index,
+                                   " requested for ", request->rendezvous_key(),
+                                   ", which has ", num_chunks, " chunks"));
+      return;
+    }
+    const int64_t begin = chunk_index * staged.chunk_elems;
+    const int64_t end =
+        std::min(begin + staged.chunk_elems, staged.flat.NumElements());
+    chunk = staged.flat.Slice(begin, end);
+    if (!staged.fetched[chunk_index]) {
+      staged.fetched[chunk_index] = true;
+      if (++staged.num_fetched == num_chunks) {
+        staged_tensors_.erase(it);
+      }
+    }
+  }
+  // Large chunks share the backing store of the staged tensor.
+  grpc::EncodeTensorToByteBuffer(/*is_dead=*/false, chunk,
+                                 /*require_ack=*/false, response);
+  done(Status::OK());
+}
+
 namespace {
 // If RecvBufRespExtra.tensor_content is a single large string, then gRPC
 // can stall on the recv side when the string buffer needs to be enlarged,
@@ -590,19 +814,54 @@ void SetTensorInRecvBufResp(int64_t max_chunk_bytes, const Tensor* tensor,
 
 void GrpcWorker::RecvBufAsync(CallOptions* opts, const RecvBufRequest* request,
                               RecvBufResponse* response, StatusCallback done) {
-  const int64_t request_id = request->request_id();
-  const int64_t step_id = request->step_id();
-  bool cache_enabled = (response_cache_ != nullptr && request_id != 0);
-
-  auto do_response = [this, response, done, cache_enabled](
-                         const Tensor& tensor, bool is_dead,
-                         const Status& status) {
+  DoRecvBufAsync(request, [this, response, done](const Tensor& tensor,
+                                                 bool require_ack,
+                                                 const Status& status) {
     if (status.ok()) {
       SetTensorInRecvBufResp(recv_buf_max_chunk_, &tensor, response);
     }
     response->set_send_start_micros(env_->env->NowMicros());
-    response->set_require_ack(cache_enabled);
+    response->set_require_ack(require_ack);
+    done(status);
+  });
+}
+
+// GrpcRecvBufAsync: unlike the other Worker methods, which use protocol
+// buffers for a response object, to avoid extra protocol buffer
+// serialization overhead and copies of the tensor content we generate our
+// response directly into a ::grpc::ByteBuffer object, which shares the
+// backing store of large tensors.
+void GrpcWorker::GrpcRecvBufAsync(CallOptions* opts,
+                                  const RecvBufRequest* request,
+                                  ::grpc::ByteBuffer* response,
+                                  StatusCallback done) {
+  DoRecvBufAsync(request, [this, response, done](const Tensor& tensor,
+                                                 bool require_ack,
+                                                 const Status& status) {
+    if (status.ok()) {
+      RecvBufResponse header;
+      header.set_send_start_micros(env_->env->NowMicros());
+      header.set_require_ack(require_ack);
+      grpc::EncodeRecvBufResponseToByteBuffer(header, tensor,
+                                              recv_buf_max_chunk_, response);
+    }
     done(status);
+  });
+}
+
+void GrpcWorker::DoRecvBufAsync(
+    const RecvBufRequest* request,
+    std::function<void(const Tensor& tensor, bool require_ack,
+                       const Status& status)>
+        respond) {
+  const int64_t request_id = request->request_id();
+  const int64_t step_id = request->step_id();
+  bool cache_enabled = (response_cache_ != nullptr && request_id != 0);
+
+  auto do_response = [respond, cache_enabled](const Tensor& tensor,
+                                              bool is_dead,
+                                              const Status& status) {
+    respond(tensor, cache_enabled, status);
   };
 
   // If response cache is enabled and the response cache already contains the
@@ -741,6 +1000,14 @@ void GrpcWorker::CleanupGraphAsync(const CleanupGraphRequest* request,
     // a worker crashes before acking a request.
     response_cache_->CleanEntriesForStep(request->step_id());
   }
+  {
+    // Drop the tensors of this step whose chunks were never all fetched,
+    // e.g. because the receiver failed.
+    mutex_lock l(staged_mu_);
+    const int64_t step_id = request->step_id();
+    staged_tensors_.erase(staged_tensors_.lower_bound({step_id, ""}),
+                          staged_tensors_.lower_bound({step_id + 1, ""}));
+  }
   Worker::CleanupGraphAsync(request, response, done);
 }
 
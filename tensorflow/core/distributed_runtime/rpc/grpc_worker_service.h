@@ -16,12 +16,19 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_WORKER_SERVICE_H_
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_WORKER_SERVICE_H_
 
+#include <map>
 #include <memory>
 #include <unordered_map>
+#include <utility>
+#include <vector>
+
 #include "grpcpp/server_builder.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_response_cache.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_worker_service_impl.h"
 #include "tensorflow/core/distributed_runtime/worker.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
 
 namespace grpc {
@@ -52,6 +59,12 @@ class GrpcWorker : public Worker {
   void RecvBufAsync(CallOptions* opts, const RecvBufRequest* request,
                     RecvBufResponse* response, StatusCallback done) override;
 
+  // Specialized version of RecvBuf for gRPC, which avoids a copy.
+  virtual void GrpcRecvBufAsync(CallOptions* opts,
+                                const RecvBufRequest* request,
+                                ::grpc::ByteBuffer* response,
+                                StatusCallback done);
+
   void CleanupGraphAsync(const CleanupGraphRequest* request,
                          CleanupGraphResponse* response,
                          StatusCallback done) override;
@@ -63,8 +76,42 @@ class GrpcWorker : public Worker {
   void RemoveCacheEntryForId(int64_t request_id);
 
  private:
+  // Responds to "request" with the value produced for its rendezvous key.
+  // "respond" is called with that value and whether the receiver must
+  // acknowledge the response.
+  void DoRecvBufAsync(
+      const RecvBufRequest* request,
+      std::function<void(const Tensor& tensor, bool require_ack,
+                         const Status& status)>
+          respond);
+
+  // Splits "tensor", received for "request", into chunks of at most
+  // "request->max_chunk_bytes()" bytes and keeps it until all of its chunks
+  // have been fetched or its step is cleaned up.  Returns the number of
+  // chunks.
+  int64_t StageTensorChunks(const RecvTensorRequest& request,
+                            const Tensor& tensor);
+
+  // Responds to a RecvTensor request with "fetch_chunk" set, with a chunk of
+  // a tensor staged by StageTensorChunks().
+  void RecvTensorChunkAsync(const RecvTensorRequest* request,
+                            ::grpc::ByteBuffer* response, StatusCallback done);
+
+  // A tensor split into chunks, pending the fetches of its chunks.
+  struct StagedTensor {
+    Tensor flat;  // The tensor, flattened.
+    int64_t chunk_elems;
+    std::vector<bool> fetched;  // Whether each chunk has been fetched.
+    int64_t num_fetched = 0;
+  };
+
   std::unique_ptr<GrpcResponseCache> response_cache_;
   const int32 recv_buf_max_chunk_;
+
+  mutex staged_mu_;
+  // Keyed by step id and rendezvous key.
+  std::map<std::pair<int64_t, string>, StagedTensor> staged_tensors_
+      TF_GUARDED_BY(staged_mu_);
 };
 
 std::unique_ptr<GrpcWorker> NewGrpcWorker(WorkerEnv* worker_env,
@@ -91,6 +91,10 @@ class TensorResponse {
   // Return pointer to the device hosting the tensor.
   DeviceBase* device() const { return device_; }
 
+  // Returns true if the tensor is parsed into host memory, i.e. if the
+  // backing store of tensor() may be filled in directly.
+  bool on_host() const { return on_host_; }
+
  private:
   bool ParseTensorSubmessage(protobuf::io::CodedInputStream* input,
                              TensorProto* tensor_meta);
@@ -60,6 +60,11 @@ struct AllocationAttributes {
   // a memory chunk whose freed_at_count is at this value or earlier may be
   // returned.
   std::function<uint64()>* freed_by_func = nullptr;  // Not owned.
+  // EXPERIMENTAL: If not negative, the id of the stream the memory is going to
+  // be used on, for allocators that reuse memory in stream order. Memory last
+  // used on another stream is only returned once this stream has been made to
+  // wait for that one.
+  int stream_id = -1;
 
   TF_DISALLOW_COPY_AND_ASSIGN(AllocationAttributes);
 };
@@ -317,6 +322,11 @@ struct AllocatorAttributes {
   bool nic_compatible() const { return value & (0x1 << 1); }
   void set_gpu_compatible(bool v) { value |= (static_cast<int>(v) << 2); }
   bool gpu_compatible() const { return value & (0x1 << 2); }
+  // Requests device memory that the driver may migrate to and from the host
+  // on demand (e.g. CUDA unified memory), so that large, sparsely accessed
+  // tensors can exceed device memory. Devices without such memory ignore it.
+  void set_managed_memory(bool v) { value |= (static_cast<int>(v) << 3); }
+  bool managed_memory() const { return value & (0x1 << 3); }
   void Merge(AllocatorAttributes other) {
     value |= other.value;
     if (scope_id != other.scope_id) {
@@ -56,13 +56,17 @@ TEST(AllocatorAttributesTest, AllCombos) {
   for (bool on_host : {false, true}) {
     for (bool nic_compatible : {false, true}) {
       for (bool gpu_compatible : {false, true}) {
-        AllocatorAttributes aa;
-        aa.set_on_host(on_host);
-        aa.set_nic_compatible(nic_compatible);
-        aa.set_gpu_compatible(gpu_compatible);
-        EXPECT_EQ(on_host, aa.on_host());
-        EXPECT_EQ(nic_compatible, aa.nic_compatible());
-        EXPECT_EQ(gpu_compatible, aa.gpu_compatible());
+        for (bool managed_memory : {false, true}) {
+          AllocatorAttributes aa;
+          aa.set_on_host(on_host);
+          aa.set_nic_compatible(nic_compatible);
+          aa.set_gpu_compatible(gpu_compatible);
+          aa.set_managed_memory(managed_memory);
+          EXPECT_EQ(on_host, aa.on_host());
+          EXPECT_EQ(nic_compatible, aa.nic_compatible());
+          EXPECT_EQ(gpu_compatible, aa.gpu_compatible());
+          EXPECT_EQ(managed_memory, aa.managed_memory());
+        }
       }
     }
   }
@@ -153,6 +153,11 @@ struct CollectiveParams : public core::RefCounted {
   std::vector<int> subdiv_rank;
   OpKernel* merge_op = nullptr;  // reduction only
   OpKernel* final_op = nullptr;  // reduction only
+  // If set, ring reductions send their chunks converted by wire_encode_op,
+  // e.g. to a narrower data type, and convert them back by wire_decode_op
+  // before merging them.
+  OpKernel* wire_encode_op = nullptr;  // reduction only
+  OpKernel* wire_decode_op = nullptr;  // reduction only
   string ToString() const;
   bool run_group_initialization = true;
 };
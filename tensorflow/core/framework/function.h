@@ -307,6 +307,13 @@ class CallFrameInterface {
   virtual bool CanConsumeArg(int index) const { return false; }
 
   virtual Status SetRetval(int index, const Tensor& val) = 0;
+
+  // Returns a caller-allocated tensor into which the producer of the return
+  // value at `index` may write that value, or nullptr if there is none. The
+  // producer must still pass the value to `SetRetval()`.
+  virtual const Tensor* GetPreallocatedRetval(int index) const {
+    return nullptr;
+  }
 };
 
 // Represents a function call frame. I.e., the data structure used to
@@ -100,14 +100,17 @@ void LocalRendezvous::ItemQueue::push_back(Item* item) {
 LocalRendezvous::~LocalRendezvous() {
   // Before destroying this rendezvous instance, make sure all the done-callback
   // calls have finished and the tensors have been released from the queue.
-  {
-    mutex_lock l(mu_);
-    while (pending_callback_counter_ != 0) {
-      pending_callback_cond_var_.wait_for(l, std::chrono::milliseconds(50));
+  bool table_not_empty = false;
+  for (TableBucket& bucket : table_buckets_) {
+    mutex_lock l(bucket.mu);
+    while (bucket.pending_callback_counter != 0) {
+      bucket.pending_callback_cond_var.wait_for(l,
+                                                std::chrono::milliseconds(50));
     }
+    table_not_empty = table_not_empty || !bucket.table.empty();
   }
 
-  if (!table_.empty()) {
+  if (table_not_empty) {
     StartAbort(errors::Cancelled("LocalRendezvous deleted"));
   }
 }
@@ -132,15 +135,19 @@ Status LocalRendezvous::Send(const Rendezvous::ParsedKey& key,
         ->IncrementBy(1);
   }
 
-  mu_.lock();
-  if (!status_.ok()) {
-    // Rendezvous has been aborted.
-    Status s = status_;
-    mu_.unlock();
-    return s;
+  TableBucket& bucket = GetBucket(key_hash);
+  bucket.mu.lock();
+  {
+    tf_shared_lock l(mu_);
+    if (!status_.ok()) {
+      // Rendezvous has been aborted.
+      Status s = status_;
+      bucket.mu.unlock();
+      return s;
+    }
   }
 
-  ItemQueue* queue = &table_[key_hash];
+  ItemQueue* queue = &bucket.table[key_hash];
   if (queue->head == nullptr || queue->head->type == Item::kSend) {
     // There is no waiter for this message. Append the message
     // into the queue. The waiter will pick it up when arrives.
@@ -149,7 +156,7 @@ Status LocalRendezvous::Send(const Rendezvous::ParsedKey& key,
     // the lock.
     DVLOG(2) << "Enqueue Send Item (key:" << key.FullKey() << "). ";
     queue->push_back(new Item(send_args, val, is_dead));
-    mu_.unlock();
+    bucket.mu.unlock();
     return Status::OK();
   }
 
@@ -160,7 +167,7 @@ Status LocalRendezvous::Send(const Rendezvous::ParsedKey& key,
   // Delete the queue when the last element has been consumed.
   if (item->next == nullptr) {
     DVLOG(2) << "Clean up Send/Recv queue (key:" << key.FullKey() << "). ";
-    table_.erase(key_hash);
+    bucket.table.erase(key_hash);
   } else {
     queue->head = item->next;
   }
@@ -174,17 +181,17 @@ Status LocalRendezvous::Send(const Rendezvous::ParsedKey& key,
     rc_owner_ref.reset(rc_owner_);
     rc_owner_->Ref();
   }
-  pending_callback_counter_++;
+  bucket.pending_callback_counter++;
   // Invoke the done-callback, without holding the lock.
-  mu_.unlock();
+  bucket.mu.unlock();
   DCHECK_EQ(item->type, Item::kRecv);
   (*item->recv_state.waiter)(Status::OK(), send_args, item->args, val, is_dead);
   delete item;
   {
-    mutex_lock l(mu_);
-    pending_callback_counter_--;
-    if (pending_callback_counter_ == 0) {
-      pending_callback_cond_var_.notify_all();
+    mutex_lock l(bucket.mu);
+    bucket.pending_callback_counter--;
+    if (bucket.pending_callback_counter == 0) {
+      bucket.pending_callback_cond_var.notify_all();
     }
   }
   return Status::OK();
@@ -196,16 +203,20 @@ void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
   uint64 key_hash = KeyHash(key.FullKey());
   DVLOG(2) << "Recv " << this << " " << key_hash << " " << key.FullKey();
 
-  mu_.lock();
-  if (!status_.ok()) {
-    // Rendezvous has been aborted.
-    Status s = status_;
-    mu_.unlock();
-    done(s, Rendezvous::Args(), recv_args, Tensor(), false);
-    return;
+  TableBucket& bucket = GetBucket(key_hash);
+  bucket.mu.lock();
+  {
+    tf_shared_lock l(mu_);
+    if (!status_.ok()) {
+      // Rendezvous has been aborted.
+      Status s = status_;
+      bucket.mu.unlock();
+      done(s, Rendezvous::Args(), recv_args, Tensor(), false);
+      return;
+    }
   }
 
-  ItemQueue* queue = &table_[key_hash];
+  ItemQueue* queue = &bucket.table[key_hash];
   if (queue->head == nullptr || queue->head->type == Item::kRecv) {
     // There is no message to pick up.
     // Only recv-related fields need to be filled.
@@ -231,8 +242,9 @@ void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
       already_cancelled = !cm->RegisterCallback(token, [this, token, key_hash] {
         Item* item = nullptr;
         {
-          mutex_lock l(mu_);
-          ItemQueue* queue = &table_[key_hash];
+          TableBucket& bucket = GetBucket(key_hash);
+          mutex_lock l(bucket.mu);
+          ItemQueue* queue = &bucket.table[key_hash];
           // Find an item in the queue with a cancellation token that matches
           // `token`, and remove it.
           if (queue->head != nullptr && queue->head->type == Item::kRecv) {
@@ -243,7 +255,7 @@ void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
                 if (queue->head->next == nullptr) {
                   // We have a single-element queue, so we can erase it from
                   // the table.
-                  table_.erase(key_hash);
+                  bucket.table.erase(key_hash);
                 } else {
                   // Remove the current item from the queue.
                   if (curr == queue->head) {
@@ -275,7 +287,7 @@ void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
       });
     }
     if (already_cancelled) {
-      mu_.unlock();
+      bucket.mu.unlock();
       // Unref case (2)
       if (rc_owner_) rc_owner_->Unref();
       done(StatusGroup::MakeDerived(
@@ -312,7 +324,7 @@ void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
       queue->push_back(new Item(recv_args, std::move(done), token));
     }
 
-    mu_.unlock();
+    bucket.mu.unlock();
     return;
   }
 
@@ -324,7 +336,7 @@ void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
   // Delete the queue when the last element has been consumed.
   if (item->next == nullptr) {
     DVLOG(2) << "Clean up Send/Recv queue (key:" << key.FullKey() << "). ";
-    table_.erase(key_hash);
+    bucket.table.erase(key_hash);
   } else {
     queue->head = item->next;
   }
@@ -338,49 +350,54 @@ void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
     rc_owner_ref.reset(rc_owner_);
     rc_owner_->Ref();
   }
-  pending_callback_counter_++;
+  bucket.pending_callback_counter++;
   // Invoke the done-callback, without holding the lock.
-  mu_.unlock();
+  bucket.mu.unlock();
   DCHECK_EQ(item->type, Item::kSend);
   done(Status::OK(), item->args, recv_args, *item->send_state.value,
        item->send_state.is_dead);
   delete item;
   {
-    mutex_lock l(mu_);
-    pending_callback_counter_--;
-    if (pending_callback_counter_ == 0) {
-      pending_callback_cond_var_.notify_all();
+    mutex_lock l(bucket.mu);
+    bucket.pending_callback_counter--;
+    if (bucket.pending_callback_counter == 0) {
+      bucket.pending_callback_cond_var.notify_all();
     }
   }
 }
 
 void LocalRendezvous::StartAbort(const Status& status) {
   CHECK(!status.ok());
-  Table table;
   {
     mutex_lock l(mu_);
     status_.Update(status);
-    table_.swap(table);
   }
-  for (auto& p : table) {
-    Item* item = p.second.head;
-    while (item != nullptr) {
-      if (item->type == Item::kRecv) {
-        (*item->recv_state.waiter)(status, Rendezvous::Args(),
-                                   Rendezvous::Args(), Tensor(), false);
+  // Sends and Recvs that take a bucket lock after this point see the error,
+  // so swapping out the tables aborts every pending item.
+  for (TableBucket& bucket : table_buckets_) {
+    Table table;
+    {
+      mutex_lock l(bucket.mu);
+      bucket.table.swap(table);
+    }
+    for (auto& p : table) {
+      Item* item = p.second.head;
+      while (item != nullptr) {
+        if (item->type == Item::kRecv) {
+          (*item->recv_state.waiter)(status, Rendezvous::Args(),
+                                     Rendezvous::Args(), Tensor(), false);
+        }
+        Item* to_delete = item;
+        item = item->next;
+        delete to_delete;
       }
-      Item* to_delete = item;
-      item = item->next;
-      delete to_delete;
     }
   }
 }
 
 Status LocalRendezvous::status() {
-  mu_.lock();
-  Status s = status_;
-  mu_.unlock();
-  return s;
+  tf_shared_lock l(mu_);
+  return status_;
 }
 
 }  // namespace tensorflow
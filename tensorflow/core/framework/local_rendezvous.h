@@ -39,8 +39,7 @@ class LocalRendezvous {
   // Rendezvous), pass in its pointer in constructor so the LocalRendezvous
   // can make sure it outlives the async recv requests.
   // Pass in nullptr if the wrapping class is not refcounted.
-  explicit LocalRendezvous(Rendezvous* owner)
-      : rc_owner_(owner), pending_callback_counter_(0) {}
+  explicit LocalRendezvous(Rendezvous* owner) : rc_owner_(owner) {}
   ~LocalRendezvous();
 
   Status Send(const Rendezvous::ParsedKey& key,
@@ -68,16 +67,30 @@ class LocalRendezvous {
 
   typedef gtl::FlatMap<uint64, ItemQueue> Table;
 
+  // Keys are spread over several buckets, each with its own lock, so that
+  // Send and Recv calls for different keys rarely contend.
+  struct TableBucket {
+    mutex mu;
+    Table table TF_GUARDED_BY(mu);
+    // Track the number of pending callbacks using a counter.
+    int pending_callback_counter TF_GUARDED_BY(mu) = 0;
+    condition_variable pending_callback_cond_var TF_GUARDED_BY(mu);
+  };
+
+  // Returns the bucket that holds the queue of `key_hash`.
+  TableBucket& GetBucket(uint64 key_hash) {
+    return table_buckets_[key_hash % kNumBuckets];
+  }
+
   // Pointer to the owner class of this LocalRendezvous if it is refcounted.
   const Rendezvous* rc_owner_;
 
-  // TODO(zhifengc): shard table_.
+  static constexpr int kNumBuckets = 16;
+  TableBucket table_buckets_[kNumBuckets];
+
+  // Lock order: a bucket's `mu` is acquired before `mu_`.
   mutex mu_;
-  Table table_ TF_GUARDED_BY(mu_);
   Status status_ TF_GUARDED_BY(mu_);
-  // Track the number of pening callbacks using a counter.
-  int pending_callback_counter_ TF_GUARDED_BY(mu_);
-  condition_variable pending_callback_cond_var_ TF_GUARDED_BY(mu_);
 
   TF_DISALLOW_COPY_AND_ASSIGN(LocalRendezvous);
 };
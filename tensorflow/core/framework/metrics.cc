@@ -64,6 +64,13 @@ auto* graph_unused_outputs = monitoring::Counter<1>::New(
     "/tensorflow/core/graph_unused_outputs",
     "The number of unused outputs for ops of a given type.", "name");
 
+auto* executor_scheduled_nodes = monitoring::Counter<1>::New(
+    "/tensorflow/core/executor_scheduled_nodes",
+    "The number of ready nodes the graph executor ran on the thread that made "
+    "them ready (inline) or dispatched to another inter-op thread "
+    "(dispatched).",
+    "mode");
+
 auto* tf_data_autotune_counter = monitoring::Counter<1>::New(
     "/tensorflow/data/autotune", "tf.data autotuning", "name");
 
@@ -227,6 +234,17 @@ auto* xla_compilation_time_usecs = monitoring::Counter<0>::New(
     "/tensorflow/core/xla_compilation_time_usecs",
     "The total time spent on compiling XLA graphs in microseconds.");
 
+auto* xla_async_compilation_fallbacks = monitoring::Counter<0>::New(
+    "/tensorflow/core/xla_async_compilation_fallbacks",
+    "The number of executions of XLA clusters that ran as TensorFlow "
+    "functions because their asynchronous compilation was not done.");
+
+auto* xla_async_compilation_fallback_time_usecs = monitoring::Counter<0>::New(
+    "/tensorflow/core/xla_async_compilation_fallback_time_usecs",
+    "The total time from queueing asynchronous compilations of XLA clusters "
+    "to their completion, during which the clusters run as TensorFlow "
+    "functions, in microseconds.");
+
 auto* xla_tpu_spmd_cores_per_replica = monitoring::Counter<1>::New(
     "/tensorflow/tpu/xla_spmd_cores_per_replica",
     "The number of cores used by XLA SPMD-replicated models.", "cores");
@@ -261,6 +279,19 @@ monitoring::Counter<2>* GetGraphOptimizationCounter() {
   return graph_optimization_counter;
 }
 
+void UpdateFunctionOptimizationTime(const uint64 running_time_usecs) {
+  static auto* function_optimization_time_usecs_histogram =
+      monitoring::Sampler<0>::New(
+          {"/tensorflow/core/grappler/function_optimization_time_usecs",
+           "The time spent optimizing each function body with Grappler in "
+           "microseconds."},
+          // Power of 2 with bucket count 24 (> 16 seconds)
+          {monitoring::Buckets::Exponential(1, 2, 24)});
+  static auto* function_optimization_time_usecs_cell =
+      function_optimization_time_usecs_histogram->GetCell();
+  function_optimization_time_usecs_cell->Add(running_time_usecs);
+}
+
 void RecordTFDataAutotune(const string& name) {
   tf_data_autotune_counter->GetCell(name)->IncrementBy(1);
 }
@@ -484,6 +515,19 @@ void UpdateXlaCompilationTime(const uint64 compilation_time_usecs) {
   }
 }
 
+void RecordXlaAsyncCompilationFallback() {
+  static auto* xla_async_compilation_fallbacks_cell =
+      xla_async_compilation_fallbacks->GetCell();
+  xla_async_compilation_fallbacks_cell->IncrementBy(1);
+}
+
+void UpdateXlaAsyncCompilationFallbackTime(const uint64 fallback_time_usecs) {
+  static auto* xla_async_compilation_fallback_time_usecs_cell =
+      xla_async_compilation_fallback_time_usecs->GetCell();
+  xla_async_compilation_fallback_time_usecs_cell->IncrementBy(
+      fallback_time_usecs);
+}
+
 void UpdateBfcAllocatorDelayTime(const uint64 delay_usecs) {
   static auto* bfc_allocator_delay_cell = bfc_allocator_delay->GetCell();
   if (delay_usecs > 0) {
@@ -491,6 +535,15 @@ void UpdateBfcAllocatorDelayTime(const uint64 delay_usecs) {
   }
 }
 
+void RecordExecutorScheduledNodes(int64_t num_inlined,
+                                  int64_t num_dispatched) {
+  static auto* inlined_cell = executor_scheduled_nodes->GetCell("inline");
+  static auto* dispatched_cell =
+      executor_scheduled_nodes->GetCell("dispatched");
+  if (num_inlined > 0) inlined_cell->IncrementBy(num_inlined);
+  if (num_dispatched > 0) dispatched_cell->IncrementBy(num_dispatched);
+}
+
 void RecordUnusedOutput(const string& op_name) {
   graph_unused_outputs->GetCell(op_name)->IncrementBy(1);
 }
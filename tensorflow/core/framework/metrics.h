@@ -171,6 +171,10 @@ void RecordTPUXlaSpmdCoresPerReplica(int64_t cores_per_replica);
 void UpdateGraphExecTime(const uint64 running_time_usecs);
 void UpdateGraphPendingQueueLength(uint64 len);
 
+// Records the number of ready nodes the graph executor ran inline, on the
+// thread that made them ready, and dispatched to other inter-op threads.
+void RecordExecutorScheduledNodes(int64_t num_inlined, int64_t num_dispatched);
+
 // Records that one output of an op of type `op_name` was unused.
 void RecordUnusedOutput(const string& op_name);
 
@@ -293,12 +297,24 @@ class ScopedCounter final {
 // passes.
 monitoring::Counter<2>* GetGraphOptimizationCounter();
 
+// Records the time spent optimizing the body of one function of a graph's
+// library with Grappler, in microseconds.
+void UpdateFunctionOptimizationTime(const uint64 running_time_usecs);
+
 // Updates metrics for time to distribute variables to all TPU hosts.
 void UpdateTpuVariableDistributionTime(const uint64 distribution_time_usecs);
 
 // Updates the metrics stored about time XLA spents compiling graphs.
 void UpdateXlaCompilationTime(const uint64 compilation_time_usecs);
 
+// Records an execution of an XLA cluster as a TensorFlow function, because
+// its asynchronous compilation was not done.
+void RecordXlaAsyncCompilationFallback();
+
+// Updates the metrics stored about time XLA clusters run as TensorFlow
+// functions while waiting for their asynchronous compilation.
+void UpdateXlaAsyncCompilationFallbackTime(const uint64 fallback_time_usecs);
+
 // Updates the metrics stored about time BFC allocator spents during delay.
 void UpdateBfcAllocatorDelayTime(const uint64 delay_usecs);
 
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/framework/model.h"
 
+#include <algorithm>
+#include <limits>
 #include <memory>
 
 #include "absl/time/clock.h"
@@ -361,7 +363,10 @@ class AsyncInterleaveMany : public Node {
   // interleave "cycle" divided by `parallelism`, `consumer_time` is the
   // `input_time` specified through `input_times` divided by `num_inputs() - 1`,
   // and if the node has parallelism parameter, then `buffer_size` is derived
-  // from `parallelism`.
+  // from `parallelism`. If the node also has a buffer size parameter, which is
+  // the number of results buffered per input, then each of the `parallelism`
+  // inputs being processed can run ahead by that many results and
+  // `buffer_size` is `parallelism * per_input_buffer_size`.
   void OutputTimeLocked(const NodeValues& input_times,
                         ParameterGradients* gradients, NodeValues* output_times,
                         NodeValues* output_time_gradients) const override
@@ -390,12 +395,18 @@ class AsyncInterleaveMany : public Node {
         (*output_times)[inputs_.front()->long_name()];
     producer_time = output_time_for_inputs /
                     static_cast<double>(num_inputs() - 1) / parallelism;
+    double per_input_buffer_size = 1.0L;
+    auto* buffer_size_parameter = gtl::FindOrNull(parameters_, kBufferSize);
+    if (buffer_size_parameter) {
+      per_input_buffer_size = (*buffer_size_parameter)->value;
+    }
+    double buffer_size = parallelism * per_input_buffer_size;
 
     if (gradients) {
       double producer_time_der = 0.0L;
       double consumer_time_der = 0.0L;
       double buffer_size_der = 0.0L;
-      wait_time = ComputeWaitTime(producer_time, consumer_time, parallelism,
+      wait_time = ComputeWaitTime(producer_time, consumer_time, buffer_size,
                                   &producer_time_der, &consumer_time_der,
                                   &buffer_size_der);
       double inputs_time_der_sum =
@@ -422,10 +433,17 @@ class AsyncInterleaveMany : public Node {
       // Add derivative w.r.t. own parallelism parameter.
       if (parameter && (*parameter)->state->tunable) {
         (*gradients)[std::make_pair(long_name(), (*parameter)->name)] =
-            buffer_size_der - producer_time_der * producer_time / parallelism;
+            buffer_size_der * per_input_buffer_size -
+            producer_time_der * producer_time / parallelism;
+      }
+      // Add derivative w.r.t. own buffer size parameter.
+      if (buffer_size_parameter && (*buffer_size_parameter)->state->tunable) {
+        (*gradients)[std::make_pair(long_name(),
+                                    (*buffer_size_parameter)->name)] =
+            buffer_size_der * parallelism;
       }
     } else {
-      wait_time = ComputeWaitTime(producer_time, consumer_time, parallelism,
+      wait_time = ComputeWaitTime(producer_time, consumer_time, buffer_size,
                                   /*producer_time_derivative=*/nullptr,
                                   /*consumer_time_derivative=*/nullptr,
                                   /*buffer_size_derivative=*/nullptr);
@@ -460,6 +478,10 @@ class AsyncInterleaveMany : public Node {
     auto* parameter = gtl::FindOrNull(parameters_, kParallelism);
     if (parameter) {
       result += (*parameter)->value * AverageBufferedElementSize();
+      auto* buffer_size_parameter = gtl::FindOrNull(parameters_, kBufferSize);
+      if (buffer_size_parameter) {
+        result *= (*buffer_size_parameter)->value;
+      }
     }
     return result;
   }
@@ -1764,6 +1786,10 @@ void Model::Optimize(AutotuneAlgorithm algorithm, int64_t cpu_budget,
     case AutotuneAlgorithm::HILL_CLIMB:
       OptimizeHillClimb(snapshot, optimization_params, cancellation_manager);
       break;
+    case AutotuneAlgorithm::BUDGETED_HILL_CLIMB:
+      OptimizeBudgetedHillClimb(snapshot, optimization_params,
+                                cancellation_manager);
+      break;
     case AutotuneAlgorithm::GRADIENT_DESCENT:
       OptimizeGradientDescent(snapshot, optimization_params,
                               cancellation_manager);
@@ -2042,6 +2068,126 @@ void Model::OptimizeMaxParallelism(
                           should_stop);
 }
 
+void Model::OptimizeBudgetedHillClimb(
+    std::shared_ptr<Node> snapshot,
+    const OptimizationParams& optimization_params,
+    CancellationManager* cancellation_manager) {
+  VLOG(2) << "Starting optimization of tunable parameters with Budgeted Hill "
+             "Climb.";
+  // The per-element CPU time of the whole pipeline, aggregated from the
+  // processing time each node has recorded. It does not depend on the values
+  // of the tunable parameters.
+  const double processing_time = TotalProcessingTime(snapshot);
+  auto parameters = CollectTunableParameters(snapshot);
+  if (parameters.empty()) {
+    VLOG(2) << "There are no tunable parameters.";
+    return;
+  }
+  VLOG(2) << "Number of tunable parameters: " << parameters.size();
+
+  const double cpu_budget = optimization_params.cpu_budget();
+  const double ram_budget = optimization_params.ram_budget();
+
+  // Producing an element every `output_time` nanoseconds keeps
+  // `processing_time / output_time` cores busy.
+  auto cpu_usage = [processing_time](double output_time) {
+    if (output_time <= 0) {
+      return processing_time > 0 ? std::numeric_limits<double>::infinity()
+                                 : 0.0;
+    }
+    return processing_time / output_time;
+  };
+  // The fraction of `budget` that an increase in usage from `old_usage` to
+  // `new_usage` consumes.
+  auto budget_fraction = [](double old_usage, double new_usage,
+                            double budget) {
+    if (budget <= 0) return 0.0;
+    return std::max(new_usage - old_usage, 0.0) / budget;
+  };
+
+  // Buffer size parameter will only be incremented if the output latency
+  // improvement is greater than this constant.
+  constexpr double kBufferSizeMinDelta = 1.0L;
+  // Lower bound on the cost of a step, so that steps that consume no
+  // resources are compared by their output latency improvement alone.
+  constexpr double kMinStepCost = 1e-3;
+
+  // Initialize the parameter values to minimal before tuning.
+  for (auto& pair : parameters) {
+    pair.second->value = pair.second->min;
+  }
+  while (!cancellation_manager->IsCancelled()) {
+    if (AreAllParametersMax(parameters)) {
+      metrics::RecordTFDataAutotuneStoppingCriteria("all_max");
+      break;
+    }
+    const double output_time =
+        OutputTime(snapshot, optimization_params.model_input_time(),
+                   /*gradients=*/nullptr);
+    const double cores = cpu_usage(output_time);
+    const double buffered_bytes = TotalMaximumBufferedBytes(snapshot);
+
+    // Among the steps that keep the estimated CPU and RAM usage within their
+    // budgets, picks the one with the largest output latency improvement per
+    // unit of (budget-normalized) resources it consumes.
+    double best_score = 0.0L;
+    Parameter* best_parameter = nullptr;
+    bool cpu_budget_exceeded = false;
+    bool ram_budget_exceeded = false;
+    for (auto& pair : parameters) {
+      if (pair.second->value >= pair.second->max) {
+        continue;
+      }
+      pair.second->value++;
+      const double new_output_time =
+          OutputTime(snapshot, optimization_params.model_input_time(),
+                     /*gradients=*/nullptr);
+      const double new_cores = cpu_usage(new_output_time);
+      const double new_buffered_bytes = TotalMaximumBufferedBytes(snapshot);
+      pair.second->value--;
+
+      const double delta = output_time - new_output_time;
+      if (delta <= 0 ||
+          (delta <= kBufferSizeMinDelta && pair.second->name == kBufferSize)) {
+        continue;
+      }
+      if (new_cores > cpu_budget) {
+        cpu_budget_exceeded = true;
+        continue;
+      }
+      if (new_buffered_bytes > ram_budget) {
+        ram_budget_exceeded = true;
+        continue;
+      }
+      const double cost =
+          budget_fraction(cores, new_cores, cpu_budget) +
+          budget_fraction(buffered_bytes, new_buffered_bytes, ram_budget);
+      const double score = delta / std::max(cost, kMinStepCost);
+      if (score > best_score) {
+        best_score = score;
+        best_parameter = pair.second.get();
+      }
+    }
+    if (!best_parameter) {
+      if (cpu_budget_exceeded) {
+        metrics::RecordTFDataAutotuneStoppingCriteria("max_cpu_budget");
+      }
+      if (ram_budget_exceeded) {
+        metrics::RecordTFDataAutotuneStoppingCriteria("max_buffered_bytes");
+      }
+      if (!cpu_budget_exceeded && !ram_budget_exceeded) {
+        metrics::RecordTFDataAutotuneStoppingCriteria("output_time");
+      }
+      VLOG(2) << "Failed to find a tunable parameter that would further "
+                 "decrease the output time within the CPU and RAM budgets. "
+                 "The optimization attempt will stop now.";
+      break;
+    }
+    best_parameter->value++;
+  }
+  UpdateStateValues(&parameters);
+}
+
 double Model::OutputTime(std::shared_ptr<Node> node, double model_input_time,
                          Model::ParameterGradients* gradients) {
   // To store the input time for each node.
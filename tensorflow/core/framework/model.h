@@ -760,6 +760,18 @@ class Model {
                               const OptimizationParams& optimization_params,
                               CancellationManager* cancellation_manager);
 
+  // This optimization algorithm starts by setting all tunable parameters to
+  // the minimum value. It then repeatedly increments the parameter with the
+  // largest output time improvement per unit of CPU and RAM it consumes,
+  // considering only increments that keep the estimated CPU usage within the
+  // CPU budget and the maximum buffered bytes within the RAM budget. The CPU
+  // usage is estimated from the per-element processing time recorded by the
+  // nodes as the number of cores kept busy at the projected output time. The
+  // process stops when no such increment decreases the output time.
+  void OptimizeBudgetedHillClimb(std::shared_ptr<Node> snapshot,
+                                 const OptimizationParams& optimization_params,
+                                 CancellationManager* cancellation_manager);
+
   // Determines if we should stop the gradient descent optimization iterations
   // based on number of increasable parameters, CPU budget, RAM budget and
   // current resource usage.
@@ -781,6 +781,78 @@ TEST(AsyncInterleaveManyGradientTest, Model) {
       (new_output_time - output_time) / kParameterStep, kComparisonPrecision);
 }
 
+TEST(AsyncInterleaveManyGradientTest, BufferSize) {
+  const double input_time = 100;
+  std::shared_ptr<Parameter> parallelism_parameter =
+      model::MakeParameter("parallelism",
+                           std::make_shared<SharedState>(
+                               /*value=*/model::kAutotune, nullptr, nullptr),
+                           /*min=*/1, /*max=*/5);
+  std::shared_ptr<Parameter> buffer_size_parameter =
+      model::MakeParameter("buffer_size",
+                           std::make_shared<SharedState>(
+                               /*value=*/model::kAutotune, nullptr, nullptr),
+                           /*min=*/1, /*max=*/9);
+  std::shared_ptr<Node> async_interleave_many =
+      model::MakeAsyncInterleaveManyNode(
+          {0, "async_interleave_many", nullptr},
+          {parallelism_parameter, buffer_size_parameter});
+  std::shared_ptr<Node> meta_source =
+      model::MakeSourceNode({1, "meta_source", async_interleave_many});
+  async_interleave_many->add_input(meta_source);
+  auto cleanup_meta = gtl::MakeCleanup([async_interleave_many, meta_source]() {
+    async_interleave_many->remove_input(meta_source);
+  });
+  std::shared_ptr<Node> source1 =
+      model::MakeSourceNode({2, "source1", async_interleave_many});
+  async_interleave_many->add_input(source1);
+  auto cleanup1 = gtl::MakeCleanup([async_interleave_many, source1]() {
+    async_interleave_many->remove_input(source1);
+  });
+  std::shared_ptr<Node> source2 =
+      model::MakeSourceNode({3, "source2", async_interleave_many});
+  async_interleave_many->add_input(source2);
+  auto cleanup2 = gtl::MakeCleanup([async_interleave_many, source2]() {
+    async_interleave_many->remove_input(source2);
+  });
+  Model::NodeValues input_times;
+  input_times[kModelInputTimeKey] = input_time;
+  async_interleave_many->record_element();
+  async_interleave_many->add_processing_time(100);
+  source1->record_element();
+  source1->add_processing_time(200);
+  source2->record_element();
+  source2->add_processing_time(300);
+
+  parallelism_parameter->value = 1;
+  buffer_size_parameter->value = 2;
+
+  Model::ParameterGradients gradients;
+  double output_time =
+      async_interleave_many->OutputTime(&input_times, &gradients);
+  for (auto& parameter : {parallelism_parameter, buffer_size_parameter}) {
+    parameter->value += kParameterStep;
+    double new_output_time =
+        async_interleave_many->OutputTime(&input_times, nullptr);
+    parameter->value -= kParameterStep;
+    EXPECT_NEAR(gradients[std::make_pair(async_interleave_many->long_name(),
+                                         parameter->name)],
+                (new_output_time - output_time) / kParameterStep,
+                kComparisonPrecision);
+  }
+
+  // Larger per-input buffers reduce the wait time.
+  buffer_size_parameter->value = 8;
+  EXPECT_LT(async_interleave_many->OutputTime(&input_times, nullptr),
+            output_time);
+
+  // Each of the `parallelism` inputs buffers up to `buffer_size` elements.
+  async_interleave_many->record_buffer_event(10, 1);
+  async_interleave_many->record_bytes_produced(10);
+  parallelism_parameter->value = 3;
+  EXPECT_EQ(async_interleave_many->TotalMaximumBufferedBytes(), 240);
+}
+
 class AsyncKnownRatioGradientTest : public ::testing::TestWithParam<string> {};
 
 TEST_P(AsyncKnownRatioGradientTest, Model) {
@@ -1278,7 +1350,53 @@ TEST_P(OptimizeZeroRamBudgetTest, Model) {
 }
 
 INSTANTIATE_TEST_SUITE_P(Test, OptimizeZeroRamBudgetTest,
-                         ::testing::Values(0, 1, 2, 3));
+                         ::testing::Values(0, 1, 2, 3, 4));
+
+// Each element of the node takes 1000ns of CPU time and 100 bytes of buffer
+// space, so `parallelism` cores can be kept busy using `100 * parallelism`
+// bytes.
+std::shared_ptr<Node> MakeBudgetedNode() {
+  std::shared_ptr<Node> node = model::MakeAsyncKnownRatioNode(
+      {1, "1", nullptr}, 1,
+      {model::MakeParameter(
+          "parallelism",
+          std::make_shared<SharedState>(/*value=*/model::kAutotune,
+                                        std::make_shared<mutex>(),
+                                        std::make_shared<condition_variable>()),
+          /*min=*/1, /*max=*/16)});
+  node->record_buffer_event(100, 1);
+  node->add_processing_time(1000);
+  node->record_element();
+  return node;
+}
+
+TEST(OptimizeBudgetedHillClimbTest, RespectsCpuBudget) {
+  std::shared_ptr<Node> node = MakeBudgetedNode();
+  model::Model model;
+  model.AddNode([&node](model::Node::Args args) { return node; }, "1", nullptr,
+                &node);
+
+  CancellationManager cancellation_manager;
+  model.Optimize(model::AutotuneAlgorithm::BUDGETED_HILL_CLIMB,
+                 /*cpu_budget=*/4, /*ram_budget=*/1 << 20,
+                 /*model_input_time=*/0, &cancellation_manager);
+  EXPECT_GT(node->parameter_value("parallelism"), 1);
+  EXPECT_LE(node->parameter_value("parallelism"), 4);
+}
+
+TEST(OptimizeBudgetedHillClimbTest, RespectsRamBudget) {
+  std::shared_ptr<Node> node = MakeBudgetedNode();
+  model::Model model;
+  model.AddNode([&node](model::Node::Args args) { return node; }, "1", nullptr,
+                &node);
+
+  CancellationManager cancellation_manager;
+  model.Optimize(model::AutotuneAlgorithm::BUDGETED_HILL_CLIMB,
+                 /*cpu_budget=*/16, /*ram_budget=*/300,
+                 /*model_input_time=*/0, &cancellation_manager);
+  EXPECT_GT(node->parameter_value("parallelism"), 1);
+  EXPECT_LE(node->parameter_value("parallelism"), 3);
+}
 
 TEST(RecordTimeTest, RecordTimeTest) {
   std::shared_ptr<Node> source = model::MakeSourceNode({});
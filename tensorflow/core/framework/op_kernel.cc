@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/framework/op_kernel.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
 #include <mutex>  // NOLINT
@@ -24,12 +25,14 @@ limitations under the License.
 #include <vector>
 
 #include "absl/base/call_once.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/strings/match.h"
 #include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/attr_value_util.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
 #include "tensorflow/core/framework/device_factory.h"
+#include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/kernel_def.pb.h"
 #include "tensorflow/core/framework/kernel_def_util.h"
@@ -742,6 +745,21 @@ Status OpKernelContext::allocate_output(int index, const TensorShape& shape,
           " more than once.  Try turning off the ScopedAllocator optimizer.");
     }
   }
+  if (params_->output_retval_array != nullptr &&
+      params_->output_retval_array[index] >= 0 &&
+      params_->call_frame != nullptr && attr.scope_id == 0 &&
+      !attr.gpu_compatible() && !attr.nic_compatible()) {
+    // Write the output directly into the caller's buffer for the fetched
+    // value, if it has the right type and shape.
+    const Tensor* retval = params_->call_frame->GetPreallocatedRetval(
+        params_->output_retval_array[index]);
+    if (retval != nullptr && retval->dtype() == type &&
+        retval->shape() == shape) {
+      outputs_[index] = TensorValue(new Tensor(*retval));
+      *output = outputs_[index].tensor;
+      return Status::OK();
+    }
+  }
   profiler::ScopedMemoryDebugAnnotation op_annotation(
       op_kernel().name_view().data(), step_id(), "output", type,
       [&shape]() { return shape.DebugString(); });
@@ -1069,8 +1087,30 @@ struct KernelRegistry {
   mutex mu;
   std::unordered_multimap<string, KernelRegistration> registry
       TF_GUARDED_BY(mu);
+
+  // Memoized results of FindKernelRegistration(). A lookup only depends on
+  // the registry key and on the values of the attrs constrained by the
+  // candidate kernels, so the cache is keyed by those. Both maps are cleared
+  // whenever `registry` changes, so `mu` is always acquired first.
+  struct Lookup {
+    const KernelRegistration* reg;
+    bool was_attr_mismatch;
+  };
+  mutex lookup_mu TF_ACQUIRED_AFTER(mu);
+  // Sorted names of the attrs constrained by the kernels registered for a
+  // registry key, including the ones registered for DEVICE_DEFAULT.
+  absl::flat_hash_map<string, std::vector<string>> constraint_attrs
+      TF_GUARDED_BY(lookup_mu);
+  absl::flat_hash_map<string, Lookup> lookups TF_GUARDED_BY(lookup_mu);
 };
 
+// Must be called with `registry->mu` held exclusively.
+static void ClearKernelLookups(KernelRegistry* registry) {
+  mutex_lock l(registry->lookup_mu);
+  registry->constraint_attrs.clear();
+  registry->lookups.clear();
+}
+
 #if defined(_WIN32)
 static const char kKernelLibPattern[] = "libtfkernel*.dll";
 #elif defined(__APPLE__)
@@ -1211,6 +1251,7 @@ void SetupOrDisableJit(KernelRegistry* registry) {
   for (auto& jit_kernel : jit_kernels) {
     all_kernels.insert(std::move(jit_kernel));
   }
+  ClearKernelLookups(registry);
 }
 
 void* GlobalKernelRegistry() {
@@ -1256,6 +1297,7 @@ void OpKernelRegistrar::InitInternal(const KernelDef* kernel_def,
   global_registry->registry.emplace(
       key,
       KernelRegistration(*kernel_def, kernel_class_name, std::move(factory)));
+  ClearKernelLookups(global_registry);
   delete kernel_def;
 }
 
@@ -1284,6 +1326,39 @@ const string& GetKernelLabelAttr(const AttrSlice& node_attrs) {
     return attr_value->s();
 }
 
+// Appends the values of `attr_names` in `node_attrs` to `lookup_key`. Returns
+// false if one of them is missing, in which case the lookup fails anyway.
+bool AppendConstraintAttrs(const std::vector<string>& attr_names,
+                           AttrSlice node_attrs, string* lookup_key) {
+  for (const string& name : attr_names) {
+    const AttrValue* attr_value = node_attrs.FindByString(name);
+    if (attr_value == nullptr) return false;
+    const string value = attr_value->SerializeAsString();
+    strings::StrAppend(lookup_key, "|", value.size(), ":", value);
+  }
+  return true;
+}
+
+// Returns the sorted names of the attrs constrained by any kernel registered
+// under `key` or `default_key`.
+std::vector<string> ConstraintAttrNames(KernelRegistry* registry,
+                                        const string& key,
+                                        const string& default_key)
+    TF_SHARED_LOCKS_REQUIRED(registry->mu) {
+  std::vector<string> names;
+  for (const string* k : {&key, &default_key}) {
+    auto regs = registry->registry.equal_range(*k);
+    for (auto iter = regs.first; iter != regs.second; ++iter) {
+      for (const auto& constraint : iter->second.def.constraint()) {
+        names.push_back(constraint.name());
+      }
+    }
+  }
+  std::sort(names.begin(), names.end());
+  names.erase(std::unique(names.begin(), names.end()), names.end());
+  return names;
+}
+
 // TODO(irving): Replace with const Node& version below.
 Status FindKernelRegistration(
     const DeviceType& device_type, StringPiece node_name,
@@ -1298,6 +1373,24 @@ Status FindKernelRegistration(
 
   const string key = Key(node_op, device_type, label);
   auto typed_registry = GlobalKernelRegistryTyped();
+
+  // Most lookups in a large graph are for a handful of (op, device, attrs)
+  // combinations, so try the memoized result first.
+  string lookup_key = key;
+  {
+    tf_shared_lock lookup_lock(typed_registry->lookup_mu);
+    auto names = typed_registry->constraint_attrs.find(key);
+    if (names != typed_registry->constraint_attrs.end() &&
+        AppendConstraintAttrs(names->second, node_attrs, &lookup_key)) {
+      auto lookup = typed_registry->lookups.find(lookup_key);
+      if (lookup != typed_registry->lookups.end()) {
+        *reg = lookup->second.reg;
+        *was_attr_mismatch = lookup->second.was_attr_mismatch;
+        return Status::OK();
+      }
+    }
+  }
+
   tf_shared_lock lock(typed_registry->mu);
   auto regs = typed_registry->registry.equal_range(key);
   for (auto iter = regs.first; iter != regs.second; ++iter) {
@@ -1361,6 +1454,24 @@ Status FindKernelRegistration(
     }
   }
 
+  // Memoize the result. This happens while `mu` is still held, so no kernel
+  // can have been registered since the lookup started.
+  mutex_lock lookup_lock(typed_registry->lookup_mu);
+  auto names = typed_registry->constraint_attrs.find(key);
+  if (names == typed_registry->constraint_attrs.end()) {
+    names = typed_registry->constraint_attrs
+                .emplace(key, ConstraintAttrNames(
+                                  typed_registry, key,
+                                  Key(node_op, DEVICE_DEFAULT, label)))
+                .first;
+  }
+  lookup_key = key;
+  if (!AppendConstraintAttrs(names->second, node_attrs, &lookup_key)) {
+    return Status::OK();
+  }
+  typed_registry->lookups.emplace(
+      std::move(lookup_key),
+      KernelRegistry::Lookup{*reg, *was_attr_mismatch});
   return Status::OK();
 }
 
@@ -680,6 +680,12 @@ class OpKernelContext {
     // outputs are required.
     bool* outputs_required_array = nullptr;
 
+    // Array indexed by output number, with the index of the return value of
+    // `call_frame` that each output is fetched as, or -1. If non-null,
+    // `allocate_output()` may use the buffer returned by
+    // `call_frame->GetPreallocatedRetval()` for the output.
+    const int* output_retval_array = nullptr;
+
     // For access to distributed coordination service.
     CoordinationServiceAgent* coordination_service_agent = nullptr;
   };
@@ -901,6 +901,32 @@ TEST_F(LabelTest, Filter) {
                 error::NOT_FOUND);
 }
 
+REGISTER_OP("LateRegistration").Attr("T: type");
+REGISTER_KERNEL_BUILDER(
+    Name("LateRegistration").Device(DEVICE_CPU).TypeConstraint<float>("T"),
+    DummyKernel);
+
+TEST_F(OpKernelBuilderTest, RegistrationAfterLookup) {
+  // Repeated lookups are memoized, including the failed ones.
+  ExpectSuccess("LateRegistration", DEVICE_CPU, {"T|type|DT_FLOAT"});
+  ExpectSuccess("LateRegistration", DEVICE_CPU, {"T|type|DT_FLOAT"});
+  ExpectFailure("LateRegistration", DEVICE_CPU, {"T|type|DT_INT32"},
+                error::NOT_FOUND);
+
+  // Registering a kernel invalidates the memoized lookups.
+  kernel_factory::OpKernelRegistrar registrar(
+      KernelDefBuilder("LateRegistration")
+          .Device(DEVICE_CPU)
+          .TypeConstraint<int32>("T")
+          .Build(),
+      "DummyKernel",
+      [](OpKernelConstruction* context) -> OpKernel* {
+        return new DummyKernel(context);
+      });
+  ExpectSuccess("LateRegistration", DEVICE_CPU, {"T|type|DT_INT32"});
+  ExpectSuccess("LateRegistration", DEVICE_CPU, {"T|type|DT_FLOAT"});
+}
+
 void BM_InputRangeHelper(::testing::benchmark::State& state,
                          const NodeDef& node_def, const char* input_name,
                          int expected_start, int expected_stop) {
@@ -1001,9 +1027,27 @@ void BM_TraceString(::testing::benchmark::State& state) {
   }
 }
 
+void BM_FindKernelDef(::testing::benchmark::State& state) {
+  NodeDef node_def;
+  node_def.set_name("matmul-op");
+  node_def.set_op("MatMul");
+  AttrValue attr_T;
+  attr_T.set_type(DT_FLOAT);
+  node_def.mutable_attr()->insert({"T", attr_T});
+  for (size_t i = 0; i < 2; ++i) {
+    node_def.add_input(strings::StrCat("a:", i));
+  }
+
+  for (auto s : state) {
+    const KernelDef* kernel_def;
+    TF_CHECK_OK(FindKernelDef(DEVICE_CPU, node_def, &kernel_def, nullptr));
+  }
+}
+
 BENCHMARK(BM_ConcatInputRange);
 BENCHMARK(BM_SelectInputRange);
 BENCHMARK(BM_TraceString)->Arg(1)->Arg(0);
+BENCHMARK(BM_FindKernelDef);
 
 TEST(RegisteredKernels, CanCallGetAllRegisteredKernels) {
   auto kernel_list = GetAllRegisteredKernels();
@@ -21,6 +21,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/tensor_types.h"
 #include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
@@ -518,5 +519,42 @@ void BM_PingPong(::testing::benchmark::State& state) {
 }
 BENCHMARK(BM_PingPong)->Arg(100)->Arg(200)->Arg(300);
 
+void BM_SendRecvManyKeys(::testing::benchmark::State& state) {
+  const int num_threads = state.range(0);
+  const int messages_count = 1000;
+  thread::ThreadPool* pool =
+      new thread::ThreadPool(Env::Default(), "test", num_threads);
+  std::vector<Rendezvous::ParsedKey> keys;
+  for (int i = 0; i < num_threads; ++i) {
+    keys.push_back(MakeKey(strings::StrCat("key", i)));
+  }
+
+  // Benchmark loop
+  // In each iteration, each thread sends and receives messages_count
+  // messages under its own key, all through the same rendezvous.
+  for (auto s : state) {
+    Rendezvous* rendez = NewLocalRendezvous();
+    BlockingCounter counter(num_threads);
+    for (int i = 0; i < num_threads; ++i) {
+      pool->Schedule([rendez, &key = keys[i], &counter, messages_count]() {
+        Tensor orig = V("val");
+        Tensor val(DT_STRING, TensorShape({}));
+        bool is_dead = false;
+        Rendezvous::Args args;
+        for (int j = 0; j < messages_count; ++j) {
+          TF_CHECK_OK(rendez->Send(key, args, orig, is_dead));
+          TF_CHECK_OK(rendez->Recv(key, args, &val, &is_dead));
+        }
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+    rendez->Unref();
+  }
+  state.SetItemsProcessed(num_threads * messages_count * state.iterations());
+  delete pool;
+}
+BENCHMARK(BM_SendRecvManyKeys)->Arg(1)->Arg(4)->Arg(16);
+
 }  // namespace
 }  // namespace tensorflow
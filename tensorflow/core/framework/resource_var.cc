@@ -17,10 +17,36 @@ limitations under the License.
 
 #include "tensorflow/core/framework/resource_handle.h"
 #include "tensorflow/core/graph/graph_def_builder.h"
+#include "tensorflow/core/platform/logging.h"
 
 namespace tensorflow {
 
+void Var::SetLazyLoader(std::function<Status(Tensor*)> loader) {
+  mutex_lock l(lazy_load_mu_);
+  lazy_loader_ = std::move(loader);
+  lazy_load_status_ = Status::OK();
+  lazy_load_pending_.store(true, std::memory_order_release);
+  is_initialized = true;
+}
+
+Status Var::LoadLazily() {
+  mutex_lock l(lazy_load_mu_);
+  if (lazy_load_pending_.load(std::memory_order_relaxed)) {
+    lazy_load_status_ = lazy_loader_(&tensor_);
+    if (!lazy_load_status_.ok()) {
+      LOG(ERROR) << "Failed to lazily load variable " << DebugString() << ": "
+                 << lazy_load_status_;
+      tensor_ = Tensor(tensor_.dtype());
+    }
+    lazy_loader_ = nullptr;
+    lazy_load_pending_.store(false, std::memory_order_release);
+  }
+  return lazy_load_status_;
+}
+
 Status Var::AsGraphDef(GraphDefBuilder* builder, Node** out) const {
+  // Serializes a lazily loaded value only once it is loaded.
+  TF_RETURN_IF_ERROR(const_cast<Var*>(this)->LoadLazily());
   Node* var = ops::SourceOp(
       "VarHandleOp",
       builder->opts()
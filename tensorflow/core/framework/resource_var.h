@@ -16,9 +16,13 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_FRAMEWORK_RESOURCE_VAR_H_
 #define TENSORFLOW_CORE_FRAMEWORK_RESOURCE_VAR_H_
 
+#include <atomic>
+#include <functional>
+
 #include "tensorflow/core/framework/resource_base.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/mutex.h"
 
 // Forward declarations to avoid introducing a dependency on headers in
 // "tensorflow/core/graph/...".
@@ -44,8 +48,10 @@ namespace tensorflow {
 // When a variable is accessed sparsely it switches to copy-on-read mode. To
 // switch we need to grab an exclusive lock and might (if there are aliases)
 // need to copy the entire tensor. Once copy-on-read mode is enabled, no tensor
-// is allowed to alias the variable's internal tensor. This means dense reads
-// must return a copy of the variable, done while holding a shared lock. Dense
+// is allowed to alias the variable's internal tensor. Dense reads therefore
+// switch the variable back to copy-on-write mode, under an exclusive lock,
+// before aliasing its tensor, so that a multi-GB variable is copied only if a
+// later update finds that alias still alive, rather than on every read. Dense
 // writes do not need to check whether aliases exist, and can always write
 // directly to the buffer without making a copy, while holding an exclusive
 // lock. Sparse reads and sparse writes, on the other hand, can be done under a
@@ -57,12 +63,19 @@ namespace tensorflow {
 // shared mutex prevents them from overlapping with dense writes, which is
 // necessary as dense writes can change the shape the of the tensor.
 //
-// Transitioning a variable from copy-on-read mode to copy-on-write mode is
-// currently not supported. To upgrade a variable from copy-on-write to
-// copy-on-read use `EnsureSparseVariableAccess()`, and then grab the variable's
-// mutex as desired. To access the variable in dense mode grab the mutex either
+// To upgrade a variable from copy-on-write to copy-on-read use
+// `EnsureSparseVariableAccess()`, and then grab the variable's mutex as
+// desired. Since a dense read may switch the variable back to copy-on-write
+// mode in between, check `copy_on_read_mode` again once the mutex is held,
+// and if it was reset, call `EnsureSparseVariableAccessLocked()` under an
+// exclusive lock. To access the variable in dense mode grab the mutex either
 // directly or via `MaybeLockVariableInputMutexesInOrder` on all variables being
 // modified and then call `PrepareToUpdateVariable` on them in any order.
+//
+// A variable can also be initialized lazily with `SetLazyLoader()`, e.g. to
+// restore it from a checkpoint only when it is first used. The loader then
+// runs once, on the first access to `tensor()` or call to `LoadLazily()`, and
+// concurrent accesses block until it is done.
 class Var : public ResourceBase {
  public:
   explicit Var(DataType dtype) : tensor_(dtype) {}
@@ -71,11 +84,32 @@ class Var : public ResourceBase {
   // increasing mu() address.
   // TODO(ebrevdo): Use LockSet instead of exposing mu.
   mutex* mu() { return &mu_; }
-  Tensor* tensor() { return &tensor_; }
+  Tensor* tensor() {
+    if (TF_PREDICT_FALSE(lazy_load_pending_.load(std::memory_order_acquire))) {
+      LoadLazily().IgnoreError();
+    }
+    return &tensor_;
+  }
+
+  // Marks the variable initialized, with a value that `loader` produces into
+  // the variable's tensor when it is first accessed. `loader` must not access
+  // the variable itself. If it fails, the error is logged and returned by
+  // `LoadLazily()`, and the tensor is left empty.
+  void SetLazyLoader(std::function<Status(Tensor*)> loader);
+
+  // Runs the lazy loader, if one is set and has not run yet, and returns its
+  // status. May be called with or without holding `mu()`, as the loader does
+  // not acquire it.
+  Status LoadLazily();
 
   // Uninitializes the variable, by reverting the state of the tensor to
   // the state when the variable is first created.
   void Uninitialize() {
+    {
+      mutex_lock l(lazy_load_mu_);
+      lazy_loader_ = nullptr;
+      lazy_load_pending_.store(false, std::memory_order_release);
+    }
     // move frees the buffer of the tensor after unused goes out of scope.
     Tensor unused = std::move(tensor_);
     is_initialized = false;
@@ -97,16 +131,23 @@ class Var : public ResourceBase {
                                 // like it.
 
   // Also fake-guarded by mu_. Should be set to True whenever any sparse
-  // operation uses the variable. Once this is true no tensor is allowed to
-  // alias the memory of the variable, and we always copy the variable on
-  // reads. This allows sparse operations to happen with only a shared lock if
-  // so desired.
+  // operation uses the variable. While this is true no tensor is allowed to
+  // alias the memory of the variable, which allows sparse operations to happen
+  // with only a shared lock if so desired. Dense reads reset it to false, under
+  // an exclusive lock, before aliasing the variable.
   std::atomic<bool> copy_on_read_mode{false};
 
  private:
   mutex mu_;
   Tensor tensor_;
 
+  // Guards running the lazy loader. `lazy_load_pending_` is true from
+  // `SetLazyLoader()` until the loader has run.
+  mutex lazy_load_mu_;
+  std::function<Status(Tensor*)> lazy_loader_ TF_GUARDED_BY(lazy_load_mu_);
+  Status lazy_load_status_ TF_GUARDED_BY(lazy_load_mu_);
+  std::atomic<bool> lazy_load_pending_{false};
+
   ~Var() override {}
   TF_DISALLOW_COPY_AND_ASSIGN(Var);
 };
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/framework/resource_var.h"
 
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/test.h"
 
@@ -34,5 +36,45 @@ TEST(ResourceVarTest, Uninitialize) {
   EXPECT_FALSE(var->is_initialized);
   EXPECT_TRUE(var->tensor()->data() == nullptr);
 }
+
+TEST(ResourceVarTest, LazyLoader) {
+  RefCountPtr<Var> var{new Var(DT_INT32)};
+  int num_loads = 0;
+  var->SetLazyLoader([&num_loads](Tensor* tensor) {
+    ++num_loads;
+    *tensor = Tensor(DT_INT32, TensorShape({1}));
+    tensor->flat<int32>()(0) = 42;
+    return Status::OK();
+  });
+  EXPECT_TRUE(var->is_initialized);
+  EXPECT_EQ(0, num_loads);
+
+  EXPECT_EQ(42, var->tensor()->flat<int32>()(0));
+  TF_EXPECT_OK(var->LoadLazily());
+  EXPECT_EQ(42, var->tensor()->flat<int32>()(0));
+  EXPECT_EQ(1, num_loads);
+}
+
+TEST(ResourceVarTest, LazyLoaderError) {
+  RefCountPtr<Var> var{new Var(DT_INT32)};
+  var->SetLazyLoader(
+      [](Tensor* tensor) { return errors::DataLoss("corrupted"); });
+  EXPECT_EQ(error::DATA_LOSS, var->LoadLazily().code());
+  EXPECT_EQ(error::DATA_LOSS, var->LoadLazily().code());
+  EXPECT_EQ(DT_INT32, var->tensor()->dtype());
+  EXPECT_EQ(0, var->tensor()->NumElements());
+}
+
+TEST(ResourceVarTest, UninitializeDropsLazyLoader) {
+  RefCountPtr<Var> var{new Var(DT_INT32)};
+  var->SetLazyLoader([](Tensor* tensor) {
+    ADD_FAILURE() << "Unexpected load";
+    return Status::OK();
+  });
+  var->Uninitialize();
+  EXPECT_FALSE(var->is_initialized);
+  TF_EXPECT_OK(var->LoadLazily());
+  EXPECT_TRUE(var->tensor()->data() == nullptr);
+}
 }  // namespace core
 }  // namespace tensorflow
@@ -25,6 +25,8 @@ limitations under the License.
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/run_handler_util.h"
 #include "tensorflow/core/lib/core/threadpool_interface.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/context.h"
 #include "tensorflow/core/platform/denormal.h"
@@ -44,6 +46,36 @@ static constexpr int32_t kMaxConcurrentHandlers = 128;
 typedef typename internal::RunHandlerEnvironment::Task Task;
 typedef Eigen::RunQueue<Task, 1024> Queue;
 
+auto* run_handler_queueing_delay_usecs = monitoring::Sampler<1>::New(
+    {"/tensorflow/core/run_handler_queueing_delay_usecs",
+     "The time a request waits for a RunHandler in microseconds.", "priority"},
+    // Power of 2 with bucket count 24 (> 16 seconds)
+    {monitoring::Buckets::Exponential(1, 2, 24)});
+
+auto* run_handler_deadline_exceeded_requests = monitoring::Counter<1>::New(
+    "/tensorflow/core/run_handler_deadline_exceeded_requests",
+    "The number of requests that did not obtain a RunHandler before their "
+    "deadline.",
+    "priority");
+
+// Returns true if a work source after the first one in `thread_work_sources`
+// has a higher priority than `priority` and has inter-op work queued. The
+// work sources are only sorted by decreasing priority within each queue shard
+// (see SetThreadWorkSources), so all of them are checked.
+bool HigherPriorityBlockingWorkQueued(
+    const Eigen::MaxSizeVector<internal::ThreadWorkSource*>&
+        thread_work_sources,
+    int64_t priority) {
+  for (int i = 1; i < thread_work_sources.size(); ++i) {
+    internal::ThreadWorkSource* tws = thread_work_sources[i];
+    if (tws->GetPriority() > priority &&
+        tws->TaskQueueSize(/*is_blocking=*/true) > 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
 }  // namespace
 
 namespace internal {
@@ -131,6 +163,7 @@ ThreadWorkSource::ThreadWorkSource()
       blocking_inflight_(0),
       non_blocking_inflight_(0),
       traceme_id_(0),
+      priority_(0),
       version_(0),
       sub_thread_pool_waiter_(nullptr) {
   queue_waiters_.next = &queue_waiters_;
@@ -260,6 +293,14 @@ int64_t ThreadWorkSource::GetTracemeId() {
 
 void ThreadWorkSource::SetTracemeId(int64_t value) { traceme_id_ = value; }
 
+int64_t ThreadWorkSource::GetPriority() {
+  return priority_.load(std::memory_order_relaxed);
+}
+
+void ThreadWorkSource::SetPriority(int64_t value) {
+  priority_.store(value, std::memory_order_relaxed);
+}
+
 void ThreadWorkSource::SetWaiter(uint64 version, Waiter* waiter, mutex* mutex) {
   {
     tf_shared_lock lock(run_handler_waiter_mu_);
@@ -334,7 +375,9 @@ RunHandlerThreadPool::RunHandlerThreadPool(
           std::vector<double>({0, 0.4}))),
       sub_thread_pool_end_request_percentage_(ParamFromEnvWithDefault(
           "TF_RUN_HANDLER_SUB_THREAD_POOL_END_REQUEST_PERCENTAGE",
-          std::vector<double>({0.4, 1}))) {
+          std::vector<double>({0.4, 1}))),
+      preempt_low_priority_work_(ParamFromEnvBoolWithDefault(
+          "TF_RUN_HANDLER_PREEMPT_LOW_PRIORITY_WORK", true)) {
   thread_data_.resize(num_threads_);
   VLOG(1) << "Creating RunHandlerThreadPool " << name << " with  "
           << num_blocking_threads_ << " blocking threads and "
@@ -591,10 +634,17 @@ void RunHandlerThreadPool::WorkerLoop(int thread_id,
       // FindTask.
       for (int i = 0; i < thread_work_sources->size(); ++i) {
         tws = (*thread_work_sources)[i];
+        // The primary work source is chosen regardless of its priority, so
+        // leave its inter-op work to other threads while a request with a
+        // higher priority is waiting.
+        const bool preempted =
+            i == 0 && preempt_low_priority_work_ &&
+            HigherPriorityBlockingWorkQueued(*thread_work_sources,
+                                             tws->GetPriority());
         // We want a smallish numbers of inter threads since
         // otherwise there will be contention in PropagateOutputs.
         // This is best effort policy.
-        if (may_steal_blocking_work &&
+        if (may_steal_blocking_work && !preempted &&
             tws->GetInflightTaskCount(true) < kMaxBlockingInflight) {
           t = tws->PopBlockingTask();
           if (t.f) {
@@ -747,7 +797,14 @@ class RunHandler::Impl {
 
   internal::ThreadWorkSource* tws() { return &tws_; }
 
-  int64_t priority() { return options_.priority(); }
+  int64_t priority() const { return options_.priority(); }
+
+  // Returns the deadline of the request in microseconds since the Unix epoch,
+  // or 0 if the request has no deadline.
+  int64_t deadline_micros() const { return options_.deadline_micros(); }
+
+  // Returns true if the request should be scheduled before `other`.
+  bool RunsBefore(const Impl& other) const;
 
  private:
   class ThreadPoolInterfaceWrapper : public thread::ThreadPoolInterface {
@@ -842,6 +899,14 @@ class RunHandlerPool::Impl {
                     static_cast<int32>(ParamFromEnvWithDefault(
                         "TF_RUN_HANDLER_MAX_CONCURRENT_HANDLERS",
                         kMaxConcurrentHandlers))));
+    const int64_t start_time_us = EnvTime::NowMicros();
+    const int64_t deadline_micros = options.deadline_micros();
+    if (deadline_micros > 0 && start_time_us >= deadline_micros) {
+      run_handler_deadline_exceeded_requests
+          ->GetCell(strings::StrCat(options.priority()))
+          ->IncrementBy(1);
+      return nullptr;
+    }
     uint64 version;
     int num_active_requests;
     RunHandler::Impl* handler_impl;
@@ -858,11 +923,27 @@ class RunHandlerPool::Impl {
             strings::StrCat("RunHandlerPool::Impl::Get waiting for a handler "
                             "with timeout in millisecond",
                             timeout_in_ms));
-        if (timeout_in_ms == 0) {
+        uint64 wait_deadline_ns = 0;
+        if (timeout_in_ms > 0) {
+          wait_deadline_ns = EnvTime::NowNanos() + timeout_in_ms * 1000 * 1000;
+        }
+        if (deadline_micros > 0) {
+          const uint64 request_deadline_ns = deadline_micros * 1000;
+          if (wait_deadline_ns == 0 || request_deadline_ns < wait_deadline_ns) {
+            wait_deadline_ns = request_deadline_ns;
+          }
+        }
+        if (wait_deadline_ns == 0) {
           mu_.Await(Condition(this, &Impl::has_free_handler));
         } else if (!mu_.AwaitWithDeadline(
                        Condition(this, &Impl::has_free_handler),
-                       EnvTime::NowNanos() + timeout_in_ms * 1000 * 1000)) {
+                       wait_deadline_ns)) {
+          if (deadline_micros > 0 &&
+              static_cast<int64_t>(EnvTime::NowMicros()) >= deadline_micros) {
+            run_handler_deadline_exceeded_requests
+                ->GetCell(strings::StrCat(options.priority()))
+                ->IncrementBy(1);
+          }
           return nullptr;
         }
       }
@@ -874,12 +955,11 @@ class RunHandlerPool::Impl {
 
       num_active_requests = sorted_active_handlers_.size() + 1;
       thread_work_sources->resize(num_active_requests);
-      int priority = options.priority();
       auto it = sorted_active_handlers_.cbegin();
       bool new_handler_inserted = false;
       for (int i = 0; i < num_active_requests; ++i) {
         if (!new_handler_inserted && (it == sorted_active_handlers_.cend() ||
-                                      priority > (*it)->priority())) {
+                                      handler_impl->RunsBefore(**it))) {
           sorted_active_handlers_.insert(it, handler_impl);
           new_handler_inserted = true;
           // Point to the newly added handler.
@@ -891,6 +971,9 @@ class RunHandlerPool::Impl {
       version = ++version_;
     }
     RecomputePoolStats(num_active_requests, version, *thread_work_sources);
+    run_handler_queueing_delay_usecs
+        ->GetCell(strings::StrCat(options.priority()))
+        ->Add(handler_impl->start_time_us() - start_time_us);
     return WrapUnique<RunHandler>(new RunHandler(handler_impl));
   }
 
@@ -954,8 +1037,8 @@ class RunHandlerPool::Impl {
 
   std::unique_ptr<internal::RunHandlerThreadPool> run_handler_thread_pool_;
   // Thread compatible part used only by lock under RunHandlerPool.
-  // Handlers are sorted by start time.
-  // TODO(azaks): sort by the remaining latency budget.
+  // Handlers are sorted by priority, deadline and start time (see
+  // RunHandler::Impl::RunsBefore).
   // TODO(chaox): Consider other data structure for maintaining the sorted
   // active handlers if the searching overhead(currently O(n)) becomes the
   // bottleneck.
@@ -1063,6 +1146,14 @@ RunHandler::Impl::Impl(RunHandlerPool::Impl* pool_impl)
   Reset(0, RunOptions::Experimental::RunHandlerPoolOptions());
 }
 
+bool RunHandler::Impl::RunsBefore(const Impl& other) const {
+  if (priority() != other.priority()) return priority() > other.priority();
+  // Requests without a deadline run after the requests that have one.
+  if (deadline_micros() == 0) return false;
+  return other.deadline_micros() == 0 ||
+         deadline_micros() < other.deadline_micros();
+}
+
 void RunHandler::Impl::ScheduleInterOpClosure(std::function<void()> fn) {
   VLOG(3) << "Scheduling inter work for  " << tws()->GetTracemeId();
   pool_impl_->run_handler_thread_pool()->AddWorkToQueue(tws(), true,
@@ -1082,6 +1173,7 @@ void RunHandler::Impl::Reset(
   step_id_ = step_id;
   options_ = options;
   tws_.SetTracemeId(step_id);
+  tws_.SetPriority(options.priority());
 }
 
 RunHandlerPool::RunHandlerPool(int num_inter_op_threads)
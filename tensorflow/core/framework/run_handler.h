@@ -62,7 +62,10 @@ class RunHandlerPool {
   // and is being used by a client.  It becomes 'inactive' once more when the
   // unique_ptr is destroyed.
   //
-  // Will block unless there is an inactive handler.
+  // Will block unless there is an inactive handler. Returns nullptr if no
+  // handler becomes inactive within `timeout_in_ms` (if non-zero), or before
+  // the deadline in `options` (if set). The active handlers are ordered by
+  // decreasing priority, then by increasing deadline, then by arrival time.
   std::unique_ptr<RunHandler> Get(
       int64_t step_id = 0, int64_t timeout_in_ms = 0,
       const RunOptions::Experimental::RunHandlerPoolOptions& options =
@@ -82,7 +85,8 @@ class RunHandlerPool {
 // RunHandler can be used to schedule inter/intra-op closures to run on a global
 // pool shared across all Session::Run(s). The closures are enqueued to a
 // handler specific queue, from which the work is stolen in a priority order
-// (time of the Get() call).
+// (priority and deadline in RunHandlerPoolOptions, then time of the Get()
+// call).
 //
 // It can only be created via RunHandlerPool::Get().
 //
@@ -174,6 +178,10 @@ class ThreadWorkSource {
 
   void SetTracemeId(int64_t value);
 
+  int64_t GetPriority();
+
+  void SetPriority(int64_t value);
+
   void SetWaiter(uint64 version, Waiter* waiter, mutex* mutex);
 
   int64_t GetInflightTaskCount(bool is_blocking);
@@ -205,6 +213,7 @@ class ThreadWorkSource {
   mutex waiters_mu_;
   Waiter queue_waiters_ TF_GUARDED_BY(waiters_mu_);
   std::atomic<int64_t> traceme_id_;
+  std::atomic<int64_t> priority_;
 
   mutex run_handler_waiter_mu_;
   uint64 version_ TF_GUARDED_BY(run_handler_waiter_mu_);
@@ -301,6 +310,12 @@ class RunHandlerThreadPool {
   bool use_sub_thread_pool_;
   std::vector<int> num_threads_in_sub_thread_pool_;
 
+  // If true, a thread does not start inter-op work from its primary work
+  // source while a work source with a higher priority has inter-op work
+  // queued. Closures that are already running are never interrupted, so low
+  // priority requests are preempted at node boundaries.
+  bool preempt_low_priority_work_;
+
   // Threads in each sub thread pool will search tasks from the given
   // start_request_percentage to end_request_percentage in a round robin
   // fashion.
@@ -113,6 +113,34 @@ TEST(RunHandlerUtilTest, PrioritySchedulingTest) {
   EXPECT_EQ(sorted_active_list[3], 1);
 }
 
+TEST(RunHandlerUtilTest, RequestsPastDeadlineAreRejected) {
+  std::unique_ptr<RunHandlerPool> pool(new RunHandlerPool(1, 1));
+
+  RunOptions::Experimental::RunHandlerPoolOptions options;
+  options.set_deadline_micros(EnvTime::NowMicros() - 1);
+  EXPECT_EQ(pool->Get(/*step_id=*/1, /*timeout_in_ms=*/0, options), nullptr);
+
+  options.set_deadline_micros(EnvTime::NowMicros() + 60 * 1000 * 1000);
+  EXPECT_NE(pool->Get(/*step_id=*/2, /*timeout_in_ms=*/0, options), nullptr);
+}
+
+TEST(RunHandlerUtilTest, WaitForHandlerUntilDeadline) {
+  std::unique_ptr<RunHandlerPool> pool(new RunHandlerPool(1, 1));
+
+  std::vector<std::unique_ptr<RunHandler>> blocking_handles;
+  const int32_t kMaxConcurrentHandlers = 128;  // Copied from run_handler.cc.
+  for (int i = 0; i < kMaxConcurrentHandlers; ++i) {
+    blocking_handles.push_back(pool->Get(i));
+  }
+
+  // Without a timeout, the request waits until its deadline.
+  RunOptions::Experimental::RunHandlerPoolOptions options;
+  const uint64 deadline_micros = EnvTime::NowMicros() + 5000;
+  options.set_deadline_micros(deadline_micros);
+  EXPECT_EQ(pool->Get(/*step_id=*/128, /*timeout_in_ms=*/0, options), nullptr);
+  EXPECT_GE(EnvTime::NowMicros(), deadline_micros);
+}
+
 TEST(RunHandlerThreadPool, EnqueueTask) {
   Eigen::MaxSizeVector<mutex> waiters_mu(2);
   waiters_mu.resize(2);
@@ -583,6 +611,119 @@ TEST(RunHandlerThreadPool, MultipleSubThreadPool) {
   delete run_handler_thread_pool;
 }
 
+TEST(RunHandlerThreadPool, PreemptLowPriorityWork) {
+  setenv("TF_RUN_HANDLER_USE_SUB_THREAD_POOL", "false", true);
+
+  Eigen::MaxSizeVector<mutex> waiters_mu(1);
+  waiters_mu.resize(1);
+  Eigen::MaxSizeVector<internal::Waiter> waiters(1);
+  waiters.resize(1);
+  internal::RunHandlerThreadPool* run_handler_thread_pool =
+      new internal::RunHandlerThreadPool(
+          /*num_blocking_threads=*/1, /*num_non_blocking_threads=*/0,
+          Env::Default(), ThreadOptions(), "tf_run_handler_pool", &waiters_mu,
+          &waiters);
+  internal::ThreadWorkSource high_priority;
+  internal::ThreadWorkSource low_priority;
+  high_priority.SetPriority(2);
+  low_priority.SetPriority(1);
+  Eigen::MaxSizeVector<internal::ThreadWorkSource*> thread_work_sources(2);
+  thread_work_sources.resize(2);
+  thread_work_sources[0] = &high_priority;
+  thread_work_sources[1] = &low_priority;
+  for (internal::ThreadWorkSource* tws : thread_work_sources) {
+    tws->SetWaiter(1, &waiters[0], &waiters_mu[0]);
+  }
+
+  mutex mu;
+  std::vector<int64_t> executed_priorities;
+  BlockingCounter counter(4);
+  for (internal::ThreadWorkSource* tws : {&low_priority, &high_priority}) {
+    for (int i = 0; i < 2; ++i) {
+      const int64_t priority = tws->GetPriority();
+      run_handler_thread_pool->AddWorkToQueue(
+          tws, /*is_blocking=*/true,
+          [&mu, &executed_priorities, &counter, priority] {
+            {
+              mutex_lock l(mu);
+              executed_priorities.push_back(priority);
+            }
+            counter.DecrementCount();
+          });
+    }
+  }
+  run_handler_thread_pool->Start();
+  // The thread looks for work in the low priority request first, but the
+  // queued work of the high priority request preempts it.
+  run_handler_thread_pool->SetThreadWorkSources(
+      /*tid=*/0, /*start_request_idx=*/1, /*version=*/1, thread_work_sources);
+  counter.Wait();
+
+  mutex_lock l(mu);
+  EXPECT_EQ(executed_priorities, std::vector<int64_t>({2, 2, 1, 1}));
+
+  delete run_handler_thread_pool;
+}
+
+TEST(RunHandlerThreadPool, PreemptLowPriorityWorkAcrossShards) {
+  setenv("TF_RUN_HANDLER_USE_SUB_THREAD_POOL", "false", true);
+
+  Eigen::MaxSizeVector<mutex> waiters_mu(1);
+  waiters_mu.resize(1);
+  Eigen::MaxSizeVector<internal::Waiter> waiters(1);
+  waiters.resize(1);
+  internal::RunHandlerThreadPool* run_handler_thread_pool =
+      new internal::RunHandlerThreadPool(
+          /*num_blocking_threads=*/1, /*num_non_blocking_threads=*/0,
+          Env::Default(), ThreadOptions(), "tf_run_handler_pool", &waiters_mu,
+          &waiters);
+  internal::ThreadWorkSource other_low_priority;
+  internal::ThreadWorkSource low_priority;
+  internal::ThreadWorkSource high_priority;
+  other_low_priority.SetPriority(1);
+  low_priority.SetPriority(1);
+  high_priority.SetPriority(2);
+  // The thread looks for work in `low_priority` first, and then in the other
+  // work sources in this order. This is the order of a thread whose queue
+  // shard has `other_low_priority`, while `high_priority` is in the next
+  // shard.
+  Eigen::MaxSizeVector<internal::ThreadWorkSource*> thread_work_sources(3);
+  thread_work_sources.resize(3);
+  thread_work_sources[0] = &other_low_priority;
+  thread_work_sources[1] = &low_priority;
+  thread_work_sources[2] = &high_priority;
+  for (internal::ThreadWorkSource* tws : thread_work_sources) {
+    tws->SetWaiter(1, &waiters[0], &waiters_mu[0]);
+  }
+
+  mutex mu;
+  std::vector<int64_t> executed_priorities;
+  BlockingCounter counter(4);
+  for (internal::ThreadWorkSource* tws : {&low_priority, &high_priority}) {
+    for (int i = 0; i < 2; ++i) {
+      const int64_t priority = tws->GetPriority();
+      run_handler_thread_pool->AddWorkToQueue(
+          tws, /*is_blocking=*/true,
+          [&mu, &executed_priorities, &counter, priority] {
+            {
+              mutex_lock l(mu);
+              executed_priorities.push_back(priority);
+            }
+            counter.DecrementCount();
+          });
+    }
+  }
+  run_handler_thread_pool->Start();
+  run_handler_thread_pool->SetThreadWorkSources(
+      /*tid=*/0, /*start_request_idx=*/1, /*version=*/1, thread_work_sources);
+  counter.Wait();
+
+  mutex_lock l(mu);
+  EXPECT_EQ(executed_priorities, std::vector<int64_t>({2, 2, 1, 1}));
+
+  delete run_handler_thread_pool;
+}
+
 SessionOptions DefaultSessionOptions() {
   SessionOptions options;
   (*options.config.mutable_device_count())["CPU"] = 2;
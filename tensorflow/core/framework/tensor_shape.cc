@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/framework/tensor_shape.h"
 
+#include <algorithm>
+
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
 #include "tensorflow/core/lib/strings/str_util.h"
@@ -283,6 +285,19 @@ Status TensorShapeBase<Shape>::InitDims(gtl::ArraySlice<int64_t> dim_sizes) {
 
   set_ndims_byte(0);
   set_num_elements(1);
+
+  // If the dims fit neither REP16 nor REP32, go out of line right away rather
+  // than converting the representation, and reallocating, as dims are added.
+  int64_t max_size = 0;
+  for (auto s : dim_sizes) max_size = std::max(max_size, s);
+  const bool fits_rep16 = dim_sizes.size() <= 6 && max_size < kMaxRep16;
+  const bool fits_rep32 = dim_sizes.size() <= 3 && max_size < kMaxRep32;
+  if (!fits_rep16 && !fits_rep32) {
+    set_tag(REP_OUT_OF_LINE);
+    as64()->dims_ = new gtl::InlinedVector<int64_t, 8>();
+    as64()->dims_->reserve(dim_sizes.size());
+  }
+
   Status status = Status::OK();
   for (int64_t s : dim_sizes) {
     status.Update(AddDimWithStatus(internal::SubtleMustCopy(s)));
@@ -330,7 +345,7 @@ void TensorShapeRep::SlowCopyFrom(const TensorShapeRep& b) {
       *(as64()->dims_) = *(b.as64()->dims_);
     } else {
       set_tag(REP_OUT_OF_LINE);
-      as64()->dims_ = new gtl::InlinedVector<int64_t, 4>(*(b.as64()->dims_));
+      as64()->dims_ = new gtl::InlinedVector<int64_t, 8>(*(b.as64()->dims_));
     }
   }
 }
@@ -478,7 +493,7 @@ void TensorShapeBase<Shape>::UnsafeAddDim(int64_t size,
     } else {
       set_tag(REP_OUT_OF_LINE);
       as64()->dims_ =
-          new gtl::InlinedVector<int64_t, 4>(vals.begin(), vals.end());
+          new gtl::InlinedVector<int64_t, 8>(vals.begin(), vals.end());
     }
   }
   set_ndims_byte(nd + 1);
@@ -558,6 +573,7 @@ Status TensorShapeBase<Shape>::InsertDimWithStatus(int d, int64_t size) {
 template <class Shape>
 gtl::InlinedVector<int64_t, 4> TensorShapeBase<Shape>::dim_sizes() const {
   gtl::InlinedVector<int64_t, 4> result;
+  result.reserve(std::max(dims(), 0));
   for (auto dim : *this) {
     result.push_back(dim.size);
   }
@@ -85,7 +85,8 @@ class TensorShapeRep {
   // Rep16: Supports up to 6 dimensions where each dimension is < 2^16 - 1
   // Rep32: Supports up to 3 dimensions where each dimension is < 2^32 - 1
   // Rep64: Supports arbitrary dimensionality, 64-bit dimensions using
-  //        an out of line vector.
+  //        an out of line vector, which holds up to 8 dimensions without
+  //        a second allocation.
   // For PartialTensorShape, a dimension of static_cast<uint??>(-1) is unknown.
   // This value is not allowed in TensorShape either for format compatibility.
   struct Rep16 {
@@ -95,7 +96,7 @@ class TensorShapeRep {
     uint32 dims_[3];
   };
   struct Rep64 {
-    gtl::InlinedVector<int64_t, 4>* dims_;
+    gtl::InlinedVector<int64_t, 8>* dims_;
   };
 
   // We use the max value of uint16 or uint32 to represent unknown shapes, so
@@ -609,6 +609,36 @@ TEST(TensorShapeTest, Large) {
             1e18);
 }
 
+TEST(TensorShapeTest, OutOfLine) {
+  // Shapes that fit neither 16 nor 32 bit inline representations.
+  const std::vector<std::vector<int64_t>> dim_sizes = {
+      {8, 1, 2, 3, 4, 5, 6, 7},
+      {2, 100, 70000, 3},
+      {1, 2, 1ll << 34, 1, 1, 1, 1, 1, 1, 1},
+  };
+  for (const auto& dims : dim_sizes) {
+    TensorShape shape(dims);
+    ASSERT_EQ(shape.dims(), dims.size());
+    int64_t num_elements = 1;
+    for (int i = 0; i < dims.size(); ++i) {
+      EXPECT_EQ(shape.dim_size(i), dims[i]);
+      num_elements *= dims[i];
+    }
+    EXPECT_EQ(shape.num_elements(), num_elements);
+    EXPECT_EQ(TensorShape(shape), shape);
+
+    shape.AddDim(9);
+    EXPECT_EQ(shape.dim_size(dims.size()), 9);
+    EXPECT_EQ(shape.num_elements(), num_elements * 9);
+  }
+
+  PartialTensorShape partial({-1, 1, 2, 3, 4, 5, 6, 70000});
+  EXPECT_EQ(partial.dims(), 8);
+  EXPECT_EQ(partial.dim_size(0), -1);
+  EXPECT_EQ(partial.dim_size(7), 70000);
+  EXPECT_EQ(partial.num_elements(), -1);
+}
+
 TEST(TensorShapeTest, Overflow) {
   int64_t one = 1;
   std::vector<std::vector<int64_t>> overflows = {
@@ -703,6 +733,12 @@ static std::vector<int64_t> MakeSizes(int arg) {
     case 4:
       sizes = {1, 2, 1ll << 34, 1, 1, 1};
       break;
+    case 5:
+      sizes = {2, 100, 70000, 3};
+      break;
+    case 6:
+      sizes = {8, 1, 2, 3, 4, 5, 6, 7};
+      break;
   }
   return sizes;
 }
@@ -716,7 +752,14 @@ void BM_TensorShape_Init(::testing::benchmark::State& state) {
     tensorflow::testing::DoNotOptimize(shape.num_elements());
   }
 }
-BENCHMARK(BM_TensorShape_Init)->Arg(0)->Arg(1)->Arg(2)->Arg(3)->Arg(4);
+BENCHMARK(BM_TensorShape_Init)
+    ->Arg(0)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(3)
+    ->Arg(4)
+    ->Arg(5)
+    ->Arg(6);
 
 void BM_TensorShape_Assign(::testing::benchmark::State& state) {
   const int arg = state.range(0);
@@ -727,7 +770,14 @@ void BM_TensorShape_Assign(::testing::benchmark::State& state) {
     tensorflow::testing::DoNotOptimize(s2);
   }
 }
-BENCHMARK(BM_TensorShape_Assign)->Arg(0)->Arg(1)->Arg(2)->Arg(3)->Arg(4);
+BENCHMARK(BM_TensorShape_Assign)
+    ->Arg(0)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(3)
+    ->Arg(4)
+    ->Arg(5)
+    ->Arg(6);
 
 void BM_TensorShape_SetDim(::testing::benchmark::State& state) {
   const int arg = state.range(0);
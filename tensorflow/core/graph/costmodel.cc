@@ -132,6 +132,7 @@ void CostModel::Ensure(int id, int num_outputs) {
     time_.resize(id + 1);
     max_mem_usage_.resize(id + 1);
     max_exec_time_.resize(id + 1);
+    max_hardware_counters_.resize(id + 1);
     output_port_alloc_ids_.resize(id + 1);
   }
   if (num_outputs > 0) {
@@ -349,6 +350,25 @@ Microseconds CostModel::MaxExecutionTime(const Node* node) const {
   return max_exec_time_[id];
 }
 
+void CostModel::RecordMaxHardwareCounters(const Node* node,
+                                          const HardwareCounters& counters) {
+  const int id = Id(node);
+  if (id < 0) return;
+  Ensure(id, node->num_outputs());
+  if (counters.cpu_cycles > max_hardware_counters_[id].cpu_cycles) {
+    max_hardware_counters_[id] = counters;
+  }
+}
+
+CostModel::HardwareCounters CostModel::MaxHardwareCounters(
+    const Node* node) const {
+  const int id = Id(node);
+  if (id < 0 || static_cast<size_t>(id) >= max_hardware_counters_.size()) {
+    return HardwareCounters();
+  }
+  return max_hardware_counters_[id];
+}
+
 void CostModel::RecordAllocationId(const Node* node, int output_slot,
                                    int64_t alloc_id) {
   const int id = Id(node);
@@ -470,6 +490,7 @@ void CostModel::InitFromGraph(const Graph& g) {
   time_.reserve(num_node_ids);
   max_mem_usage_.reserve(num_node_ids);
   max_exec_time_.reserve(num_node_ids);
+  max_hardware_counters_.reserve(num_node_ids);
   output_port_alloc_ids_.reserve(num_node_ids);
 
   AddNodesToCostModel(g, this);
@@ -539,6 +560,10 @@ void CostModel::AddToCostGraphDef(const Graph* graph,
     cnode->set_persistent_memory_size(PersistentMemorySize(n).value());
 
     cnode->set_compute_cost(MaxExecutionTime(n).value());
+    const HardwareCounters counters = MaxHardwareCounters(n);
+    cnode->set_cpu_cycles(counters.cpu_cycles);
+    cnode->set_instructions(counters.instructions);
+    cnode->set_cache_misses(counters.cache_misses);
 
     // For now we treat all send nodes as final.
     // TODO(yuanbyu): Send nodes for fetches shouldn't be treated as final.
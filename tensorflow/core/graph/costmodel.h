@@ -153,6 +153,22 @@ class CostModel {
   // Returns the maximum execution time (in microseconds) of "node".
   Microseconds MaxExecutionTime(const Node* node) const;
 
+  // CPU hardware counters measured during one execution of a node.
+  struct HardwareCounters {
+    int64_t cpu_cycles = 0;
+    int64_t instructions = 0;
+    int64_t cache_misses = 0;
+  };
+
+  // Records the hardware counters of an execution of "node"; the counters of
+  // the execution with the most cycles are kept.
+  void RecordMaxHardwareCounters(const Node* node,
+                                 const HardwareCounters& counters);
+
+  // Returns the hardware counters of the most expensive execution of "node",
+  // or zeros if none were recorded.
+  HardwareCounters MaxHardwareCounters(const Node* node) const;
+
   // Record the unique id of the tensor generated by "output_slot" of "node".
   // Any other tensor sharing the same id will be an alias, i.e. it will share
   // the same underlying memory storage area.
@@ -211,6 +227,9 @@ class CostModel {
   // Maximum execution time
   std::vector<Microseconds> max_exec_time_;
 
+  // Hardware counters of the execution with the most cycles.
+  std::vector<HardwareCounters> max_hardware_counters_;
+
   // Maximum memory usage
   struct MemUsage {
     MemUsage() : temp_memory_size(0), persistent_memory_size(0) {}
@@ -100,5 +100,46 @@ TEST(CostModelTest, GlobalId) {
   }
 }
 
+TEST(CostModelTest, HardwareCounters) {
+  std::unique_ptr<Graph> graph(new Graph(OpRegistry::Global()));
+  InitGraph(
+      "node { name: 'A' op: 'Input'}"
+      "node { name: 'B' op: 'Input'}"
+      "node { name: 'C' op: 'Mul' attr { key: 'T' value { type: DT_FLOAT } }"
+      " input: ['A', 'B'] }",
+      graph.get());
+  StepStats step_stats;
+  GenerateStepStats(graph.get(), &step_stats, "DummyDevice");
+  // Two executions of C; the one with the most cycles is kept.
+  DeviceStepStats* device_stats = step_stats.mutable_dev_stats(0);
+  for (int i = 0; i < 2; ++i) {
+    NodeExecStats* node_stats = device_stats->add_node_stats();
+    node_stats->set_node_name("C");
+    node_stats->set_op_cpu_cycles(2000 - 1000 * i);
+    node_stats->set_op_instructions(4000 - 2000 * i);
+    node_stats->set_op_cache_misses(20 - 10 * i);
+  }
+  StepStatsCollector collector(&step_stats);
+  std::unordered_map<string, const Graph*> device_map;
+  device_map["DummyDevice"] = graph.get();
+  CostModelManager cost_model_manager;
+  collector.BuildCostModel(&cost_model_manager, device_map);
+  CostGraphDef cost_graph_def;
+  TF_ASSERT_OK(
+      cost_model_manager.AddToCostGraphDef(graph.get(), &cost_graph_def));
+  bool found = false;
+  for (const auto& node : cost_graph_def.node()) {
+    if (node.name() == "C") {
+      found = true;
+      EXPECT_EQ(node.cpu_cycles(), 2000);
+      EXPECT_EQ(node.instructions(), 4000);
+      EXPECT_EQ(node.cache_misses(), 20);
+    } else {
+      EXPECT_EQ(node.cpu_cycles(), 0);
+    }
+  }
+  EXPECT_TRUE(found);
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -580,17 +580,22 @@ StatusOr<Node*> Graph::AddNode(NodeDef node_def) {
 }
 
 Node* Graph::AddNode(NodeDef node_def, Status* status) {
-  const OpRegistrationData* op_reg_data;
-  status->Update(ops_.LookUp(node_def.op(), &op_reg_data));
+  PreparedNode prepared;
+  status->Update(PrepareNode(std::move(node_def), &prepared));
   if (!status->ok()) return nullptr;
+  return AddNode(std::move(prepared));
+}
+
+Status Graph::PrepareNode(NodeDef node_def, PreparedNode* prepared) const {
+  const OpRegistrationData* op_reg_data;
+  TF_RETURN_IF_ERROR(ops_.LookUp(node_def.op(), &op_reg_data));
 
   DataTypeVector inputs;
   DataTypeVector outputs;
-  status->Update(
-      InOutTypesForNode(node_def, op_reg_data->op_def, &inputs, &outputs));
-  if (!status->ok()) {
-    *status = AttachDef(*status, node_def);
-    return nullptr;
+  Status status =
+      InOutTypesForNode(node_def, op_reg_data->op_def, &inputs, &outputs);
+  if (!status.ok()) {
+    return AttachDef(status, node_def);
   }
 
   Node::NodeClass node_class = op_reg_data->is_function_op
@@ -607,21 +612,25 @@ Node* Graph::AddNode(NodeDef node_def, Status* status) {
           full_type::SpecializeType(AttrSlice(node_def), op_reg_data->op_def,
                                     *(node_def.mutable_experimental_type()));
       if (!s.ok()) {
-        *status = errors::InvalidArgument("type error: ", s.ToString());
         VLOG(3) << "AddNode: type inference failed for " << node_def.name()
                 << ": " << s;
-        return nullptr;
+        return errors::InvalidArgument("type error: ", s.ToString());
       }
     } else {
       VLOG(3) << "AddNode: no type constructor for " << node_def.name();
     }
   }
 
-  Node* node = AllocateNode(std::make_shared<NodeProperties>(
-                                &op_reg_data->op_def, std::move(node_def),
-                                inputs, outputs, op_reg_data->fwd_type_fn),
-                            nullptr, node_class);
-  return node;
+  prepared->props_ = std::make_shared<NodeProperties>(
+      &op_reg_data->op_def, std::move(node_def), inputs, outputs,
+      op_reg_data->fwd_type_fn);
+  prepared->node_class_ = node_class;
+  return Status::OK();
+}
+
+Node* Graph::AddNode(PreparedNode prepared) {
+  return AllocateNode(std::move(prepared.props_), nullptr,
+                      prepared.node_class_);
 }
 
 Node* Graph::CopyNode(const Node* node) {
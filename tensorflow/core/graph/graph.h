@@ -553,6 +553,28 @@ class Graph {
   // Same as above, but using StatusOr. This method is always preferred.
   StatusOr<Node*> AddNode(NodeDef node_def);
 
+  // A NodeDef whose Op and input/output types have been inferred by
+  // PrepareNode(), ready to be added by AddNode().
+  class PreparedNode {
+   public:
+    PreparedNode() {}
+    const NodeDef& def() const { return props_->node_def; }
+
+   private:
+    friend class Graph;
+    std::shared_ptr<NodeProperties> props_;
+    Node::NodeClass node_class_;
+  };
+
+  // Does the inference of AddNode() without modifying the graph.  Only reads
+  // the op registry of the graph, so independent nodes may be prepared
+  // concurrently, e.g. when building a large graph, and then added in order.
+  Status PrepareNode(NodeDef node_def, PreparedNode* prepared) const;
+
+  // Adds a node prepared by PrepareNode() on this graph, and returns it.
+  // *this owns the returned instance.
+  Node* AddNode(PreparedNode prepared);
+
   // Copies *node, which may belong to another graph, to a new node,
   // which is returned.  Does not copy any edges.  *this owns the
   // returned instance.
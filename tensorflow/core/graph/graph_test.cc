@@ -165,6 +165,26 @@ TEST_F(GraphTest, Constructor) {
   VerifyGraphStats();
 }
 
+TEST_F(GraphTest, PrepareNode) {
+  NodeDef node_def;
+  TF_ASSERT_OK(NodeDefBuilder("A", "OneOutput").Finalize(&node_def));
+  Graph::PreparedNode prepared;
+  TF_ASSERT_OK(graph_.PrepareNode(node_def, &prepared));
+  EXPECT_EQ("A", prepared.def().name());
+  // Preparing does not modify the graph.
+  EXPECT_EQ(2, graph_.num_nodes());
+
+  Node* node = graph_.AddNode(std::move(prepared));
+  EXPECT_EQ("A", node->name());
+  EXPECT_EQ(1, node->num_outputs());
+  EXPECT_EQ(3, graph_.num_nodes());
+  VerifyGraphStats();
+
+  node_def.set_op("UnknownOp");
+  EXPECT_FALSE(graph_.PrepareNode(node_def, &prepared).ok());
+  EXPECT_EQ(3, graph_.num_nodes());
+}
+
 TEST_F(GraphTest, RemoveThenAdd) {
   AddNodeWithName("A");
   Node* b = AddNodeWithName("B");
@@ -752,6 +772,9 @@ BENCHMARK(BM_GraphCreation)->ArgPair(1 << 6, 16);
 BENCHMARK(BM_GraphCreation)->ArgPair(1 << 9, 16);
 BENCHMARK(BM_GraphCreation)->ArgPair(1 << 12, 16);
 BENCHMARK(BM_GraphCreation)->ArgPair(1 << 15, 16);
+// Large enough for nodes to be prepared in parallel.
+BENCHMARK(BM_GraphCreation)->ArgPair(1 << 19, 2);
+BENCHMARK(BM_GraphCreation)->ArgPair(1 << 19, 8);
 
 void BM_ToGraphDef(::testing::benchmark::State& state) {
   const int num_nodes = state.range(0);
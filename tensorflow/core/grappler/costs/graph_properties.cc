@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/costs/graph_properties.h"
 
+#include "absl/strings/str_cat.h"
 #include "absl/types/optional.h"
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/common_runtime/graph_constructor.h"
@@ -941,6 +942,28 @@ class SymbolicShapeRefiner {
         /*aggressive_shape_inference=*/aggressive_shape_inference_,
         /*include_tensor_values=*/true));
 
+    // The unknown dimensions of the arguments are symbolic dimensions of the
+    // function body.  Map them back to the dimensions of the inputs, e.g. so
+    // that the batch size of the outputs is the batch size of the inputs.
+    absl::flat_hash_map<int64_t, DimensionHandle> input_dims;
+    for (int i = 0, end = grappler_function_item.inputs().size(); i < end;
+         ++i) {
+      const auto& arg_properties =
+          gp.GetOutputProperties(grappler_function_item.input(i).node_name);
+      if (arg_properties.empty() || i >= ic->num_inputs()) continue;
+      const TensorShapeProto& arg_shape = arg_properties[0].shape();
+      const ShapeHandle input = ic->input(i);
+      if (arg_shape.unknown_rank() || !ic->RankKnown(input) ||
+          ic->Rank(input) != arg_shape.dim_size()) {
+        continue;
+      }
+      for (int d = 0; d < arg_shape.dim_size(); ++d) {
+        if (arg_shape.dim(d).size() < -1) {
+          input_dims.emplace(arg_shape.dim(d).size(), ic->Dim(input, d));
+        }
+      }
+    }
+
     // Add return nodes for output shapes.
     int output = 0;
     ctx->output_tensors_as_shapes.resize(grappler_function_item.output_size());
@@ -970,6 +993,12 @@ class SymbolicShapeRefiner {
       NormalizeShapeForOutput(&shape);
       ShapeHandle out;
       TF_RETURN_IF_ERROR(ic->MakeShapeFromShapeProto(shape, &out));
+      for (int d = 0; d < shape.dim_size(); ++d) {
+        auto it = input_dims.find(outprop.shape().dim(d).size());
+        if (it != input_dims.end()) {
+          TF_RETURN_IF_ERROR(ic->ReplaceDim(out, d, it->second, &out));
+        }
+      }
       ic->set_output(output, out);
       if (outprop.has_value()) {
         // Forward tensor value to output_tensors_as_shape.
@@ -1414,6 +1443,71 @@ class SymbolicShapeRefiner {
     return dim;
   }
 
+  // Returns true and sets `dim` to the value of input `i` of `c` if it is an
+  // integer scalar whose value is known or was computed from a shape.  In the
+  // latter case `dim` may be symbolic.
+  bool InputScalarAsDim(NodeContext* c, int i, DimensionHandle* dim) {
+    InferenceContext* ic = c->inference_context.get();
+    if (!ic->RankKnown(ic->input(i)) || ic->Rank(ic->input(i)) != 0) {
+      return false;
+    }
+    const Tensor* t = ic->input_tensor(i);
+    if (t != nullptr) {
+      if (t->dtype() != DT_INT32 && t->dtype() != DT_INT64) return false;
+      const int64_t value = t->dtype() == DT_INT32 ? t->scalar<int32>()()
+                                                   : t->scalar<int64_t>()();
+      if (value < 0) return false;
+      *dim = ic->MakeDim(value);
+      return true;
+    }
+    if (c->input_tensors_as_shapes_to_propagate.size() <= i) return false;
+    const ShapeHandle& shape = c->input_tensors_as_shapes_to_propagate[i];
+    if (!ic->RankKnown(shape) || ic->Rank(shape) != 1) return false;
+    *dim = ic->Dim(shape, 0);
+    return !ic->ValueKnown(*dim) || ic->Value(*dim) != kUnknownDimFromConst;
+  }
+
+  // Sets `result` to the dimension computed by the arithmetic `node` from
+  // `lhs` and `rhs`.  An unknown result is the same symbolic dimension for
+  // all the nodes that compute the same expression, so that e.g. two reshapes
+  // to [batch * seq_len, -1] are known to have the same leading dimension.
+  Status DimArithmetic(const NodeDef& node, DimensionHandle lhs,
+                       DimensionHandle rhs, DimensionHandle* result) {
+    InferenceContext* ic = GetContext(&node);
+    string op;
+    if (IsAdd(node)) {
+      op = "add";
+      TF_RETURN_IF_ERROR(ic->Add(lhs, rhs, result));
+    } else if (IsSub(node)) {
+      op = "sub";
+      TF_RETURN_IF_ERROR(ic->Subtract(lhs, rhs, result));
+    } else if (IsMul(node)) {
+      op = "mul";
+      TF_RETURN_IF_ERROR(ic->Multiply(lhs, rhs, result));
+    } else {
+      op = "div";
+      TF_RETURN_IF_ERROR(
+          ic->Divide(lhs, rhs, /*evenly_divisible=*/false, result));
+    }
+    if (ic->ValueKnown(*result) || result->SameHandle(lhs) ||
+        result->SameHandle(rhs)) {
+      return Status::OK();
+    }
+    auto dim_key = [ic](DimensionHandle dim) {
+      return ic->ValueKnown(dim) ? absl::StrCat(ic->Value(dim))
+                                 : absl::StrCat("#", dim.Handle());
+    };
+    string lhs_key = dim_key(lhs);
+    string rhs_key = dim_key(rhs);
+    if ((op == "add" || op == "mul") && rhs_key < lhs_key) {
+      std::swap(lhs_key, rhs_key);
+    }
+    auto it = symbolic_dims_.emplace(
+        absl::StrCat(op, "(", lhs_key, ",", rhs_key, ")"), *result);
+    *result = it.first->second;
+    return Status::OK();
+  }
+
   // Returns true if all the output tensors have known values.
   bool AllOutputValuesKnown(NodeContext* c) {
     InferenceContext* ic = c->inference_context.get();
@@ -1795,9 +1889,14 @@ class SymbolicShapeRefiner {
             // possible.
             const ShapeHandle& shape_handle =
                 c->input_tensors_as_shapes_to_propagate[i];
+            DimensionHandle dim;
             if (ic->RankKnown(shape_handle) && ic->Rank(shape_handle) >= 1 &&
                 ic->ValueKnown(ic->Dim(shape_handle, 0))) {
               dims.push_back(ic->Dim(shape_handle, 0));
+            } else if (InputScalarAsDim(c, i, &dim)) {
+              // A scalar computed from a shape, e.g. the batch size, keeps
+              // its symbolic dimension.
+              dims.push_back(dim);
             } else {
               // This is not from Const, but as it shouldn'be used as symbolic
               // unknown dim for different ops, we use kUnknownDimFromConst.
@@ -1859,8 +1958,11 @@ class SymbolicShapeRefiner {
             node.attr().at("new_axis_mask").i() != 0) {
           valid = false;
         }
-        if (node.attr().count("shrink_axis_mask") > 0 &&
-            node.attr().at("shrink_axis_mask").i() != 0) {
+        int shrink_axis_mask = 0;
+        if (node.attr().count("shrink_axis_mask") > 0) {
+          shrink_axis_mask = node.attr().at("shrink_axis_mask").i();
+        }
+        if (shrink_axis_mask < 0 || shrink_axis_mask > 1) {
           valid = false;
         }
         int begin_mask = 0;
@@ -1874,7 +1976,21 @@ class SymbolicShapeRefiner {
         if (begin_mask < 0 || begin_mask > 1 || end_mask < 0 || end_mask > 1) {
           valid = false;
         }
-        if (valid) {
+        if (valid && shrink_axis_mask == 1) {
+          // Picks a single dimension out of a shape, e.g. shape[0] for the
+          // batch size.  The masks and the end are ignored, as for the op.
+          // The scalar is represented as a shape with a single dimension.
+          int64_t index = slice_begin->dtype() == DT_INT32
+                              ? slice_begin->flat<int32>()(0)
+                              : slice_begin->flat<int64_t>()(0);
+          const int64_t rank = ic->Rank(input);
+          if (index < 0) index += rank;
+          if (index >= 0 && index < rank) {
+            c->output_tensors_as_shapes.resize(1);
+            c->output_tensors_as_shapes[0] =
+                ic->MakeShape({ic->Dim(input, index)});
+          }
+        } else if (valid) {
           int64_t begin = 0;
           if (begin_mask == 0) {
             begin = slice_begin->dtype() == DT_INT32
@@ -1895,6 +2011,19 @@ class SymbolicShapeRefiner {
           c->output_tensors_as_shapes.resize(1);
           c->output_tensors_as_shapes[0] = result;
         }
+      } else if ((IsAdd(node) || IsSub(node) || IsMul(node) ||
+                  IsFloorDiv(node)) &&
+                 ic->num_inputs() == 2) {
+        // Arithmetic on scalars computed from shapes, e.g. batch * seq_len to
+        // flatten the leading dimensions of a tensor.
+        DimensionHandle lhs;
+        DimensionHandle rhs;
+        DimensionHandle result;
+        if (InputScalarAsDim(c, 0, &lhs) && InputScalarAsDim(c, 1, &rhs) &&
+            DimArithmetic(node, lhs, rhs, &result).ok()) {
+          c->output_tensors_as_shapes.resize(1);
+          c->output_tensors_as_shapes[0] = ic->MakeShape({result});
+        }
       }
     }
 
@@ -2045,6 +2174,9 @@ class SymbolicShapeRefiner {
   absl::flat_hash_map<const NodeDef*, NodeContext> node_to_context_;
   absl::flat_hash_map<ShapeId, ShapeHandle, HashShapeId> unknown_shapes_;
   absl::flat_hash_map<DimId, DimensionHandle, HashDimId> unknown_dims_;
+  // Symbolic dimensions computed by arithmetic on dimensions, keyed by the
+  // expression that computes them.
+  absl::flat_hash_map<string, DimensionHandle> symbolic_dims_;
   // Store function instantiations only for valid function. If function
   // instantiation failed it will have an `absl::nullopt`.
   absl::flat_hash_map<string, absl::optional<GrapplerFunctionItem>>
@@ -2195,15 +2195,18 @@ TEST_F(GraphPropertiesTest, StridedSliceOfShapeWithShrinkAxisMask) {
   GrapplerItem item;
   TF_ASSERT_OK(scope.ToGraphDef(&item.graph));
 
-  // Without aggressive shape inference, it cannot infer output value of
-  // StridedSlice with ShrinkAxisMask.
+  // Without aggressive shape inference, the output value of StridedSlice with
+  // ShrinkAxisMask is inferred from the sliced shape.
   {
     GraphProperties properties(item);
     TF_ASSERT_OK(properties.InferStatically(
         /*assume_valid_feeds=*/false,
         /*aggressive_shape_inference=*/false,
         /*include_tensor_values=*/true));
-    EXPECT_FALSE(properties.GetOutputProperties("slice").at(0).has_value());
+    EXPECT_TRUE(properties.GetOutputProperties("slice").at(0).has_value());
+    const auto slice_value =
+        properties.GetOutputProperties("slice").at(0).value();
+    ExpectTensorValues({5}, slice_value);
   }
 
   // InferStatically with aggressive shape inference can infer output value of
@@ -2221,6 +2224,90 @@ TEST_F(GraphPropertiesTest, StridedSliceOfShapeWithShrinkAxisMask) {
   }
 }
 
+TEST_F(GraphPropertiesTest, StridedSliceOfShapeWithUnknownBatch) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output x = ops::Placeholder(
+      s.WithOpName("x"), DT_FLOAT,
+      ops::Placeholder::Shape(PartialTensorShape({-1, 128, 768})));
+  Output shape = ops::Shape(s.WithOpName("shape"), x);
+  Output zero = ops::Const(s.WithOpName("zero"), {0}, {1});
+  Output one = ops::Const(s.WithOpName("one"), {1}, {1});
+  Output two = ops::Const(s.WithOpName("two"), {2}, {1});
+  Output batch = ops::StridedSlice(s.WithOpName("batch"), shape, zero, one,
+                                   one, ops::StridedSlice::ShrinkAxisMask(1));
+  Output seq = ops::StridedSlice(s.WithOpName("seq"), shape, one, two, one,
+                                 ops::StridedSlice::ShrinkAxisMask(1));
+  Output hidden = ops::Const(s.WithOpName("hidden"), 768, {});
+  Output new_shape =
+      ops::Stack(s.WithOpName("new_shape"), {batch, seq, hidden});
+  Output neg = ops::Neg(s.WithOpName("neg"), x);
+  Output y = ops::Reshape(s.WithOpName("y"), neg, new_shape);
+
+  GrapplerItem item;
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+  GraphProperties properties(item);
+  TF_ASSERT_OK(properties.InferStatically(
+      /*assume_valid_feeds=*/false,
+      /*aggressive_shape_inference=*/false,
+      /*include_tensor_values=*/true));
+
+  // The known dimensions of the shape are values even though the batch size is
+  // unknown, so that they can be folded.
+  EXPECT_FALSE(properties.GetOutputProperties("batch").at(0).has_value());
+  EXPECT_TRUE(properties.GetOutputProperties("seq").at(0).has_value());
+  ExpectTensorValues({128},
+                     properties.GetOutputProperties("seq").at(0).value());
+
+  // The batch size stays the same symbolic dimension through the reshape.
+  const auto shape_x = properties.GetOutputProperties("x").at(0).shape();
+  const auto shape_y = properties.GetOutputProperties("y").at(0).shape();
+  ASSERT_EQ(3, shape_y.dim_size());
+  EXPECT_LT(shape_x.dim(0).size(), -1);
+  EXPECT_EQ(shape_x.dim(0).size(), shape_y.dim(0).size());
+  EXPECT_EQ(128, shape_y.dim(1).size());
+  EXPECT_EQ(768, shape_y.dim(2).size());
+}
+
+TEST_F(GraphPropertiesTest, SymbolicDimensionArithmetic) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output x = ops::Placeholder(
+      s.WithOpName("x"), DT_FLOAT,
+      ops::Placeholder::Shape(PartialTensorShape({-1, -1, 768})));
+  Output shape = ops::Shape(s.WithOpName("shape"), x);
+  Output zero = ops::Const(s.WithOpName("zero"), {0}, {1});
+  Output one = ops::Const(s.WithOpName("one"), {1}, {1});
+  Output two = ops::Const(s.WithOpName("two"), {2}, {1});
+  Output batch = ops::StridedSlice(s.WithOpName("batch"), shape, zero, one,
+                                   one, ops::StridedSlice::ShrinkAxisMask(1));
+  Output seq = ops::StridedSlice(s.WithOpName("seq"), shape, one, two, one,
+                                 ops::StridedSlice::ShrinkAxisMask(1));
+  Output hidden = ops::Const(s.WithOpName("hidden"), 768, {});
+  // Two separate computations of batch * seq, in different orders.
+  Output tokens1 = ops::Mul(s.WithOpName("tokens1"), batch, seq);
+  Output tokens2 = ops::Mul(s.WithOpName("tokens2"), seq, batch);
+  Output shape1 = ops::Stack(s.WithOpName("shape1"), {tokens1, hidden});
+  Output y1 = ops::Reshape(s.WithOpName("y1"), x, shape1);
+  Output neg = ops::Neg(s.WithOpName("neg"), x);
+  Output shape2 = ops::Stack(s.WithOpName("shape2"), {tokens2, hidden});
+  Output y2 = ops::Reshape(s.WithOpName("y2"), neg, shape2);
+
+  GrapplerItem item;
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+  GraphProperties properties(item);
+  TF_ASSERT_OK(properties.InferStatically(false));
+
+  const auto shape_x = properties.GetOutputProperties("x").at(0).shape();
+  const auto shape_y1 = properties.GetOutputProperties("y1").at(0).shape();
+  const auto shape_y2 = properties.GetOutputProperties("y2").at(0).shape();
+  ASSERT_EQ(2, shape_y1.dim_size());
+  ASSERT_EQ(2, shape_y2.dim_size());
+  EXPECT_LT(shape_y1.dim(0).size(), -1);
+  EXPECT_EQ(shape_y1.dim(0).size(), shape_y2.dim(0).size());
+  EXPECT_NE(shape_y1.dim(0).size(), shape_x.dim(0).size());
+  EXPECT_NE(shape_y1.dim(0).size(), shape_x.dim(1).size());
+  EXPECT_EQ(768, shape_y1.dim(1).size());
+}
+
 TEST_F(GraphPropertiesTest, ValuePropagationThroughArithmeticOps) {
   tensorflow::Scope s = tensorflow::Scope::NewRootScope();
   Output a = ops::Const(s.WithOpName("a"), {5, 7}, {2});
@@ -2466,6 +2553,51 @@ TEST_F(GraphPropertiesTest, NonTrivialInputPartitionedCallOp) {
             PropToString(properties.GetOutputProperties("add_call")[0]));
 }
 
+TEST_F(GraphPropertiesTest, PartitionedCallOpKeepsSymbolicDims) {
+  auto f = FunctionDefHelper::Create(
+      // Name
+      "FunctionWhichNegates",
+      // Inputs
+      {"arg0: float"},
+      // Outputs
+      {"ret0: float"},
+      /*attr_def=*/{},
+      // Nodes
+      {{{"neg"}, "Neg", {"arg0"}, {{"T", DT_FLOAT}}}},
+      /*ret_def=*/{{"ret0", "neg:y:0"}});
+
+  FunctionDefLibrary function_lib;
+  function_lib.add_function()->Swap(&f);
+  tensorflow::Scope root = tensorflow::Scope::NewRootScope();
+  TF_ASSERT_OK(root.graph()->AddFunctionLibrary(function_lib));
+
+  Output in = ops::Placeholder(
+      root.WithOpName("in"), DT_FLOAT,
+      ops::Placeholder::Shape(PartialTensorShape({-1, 10})));
+  NameAttrList b_name_attr;
+  b_name_attr.set_name("FunctionWhichNegates");
+  ops::PartitionedCall call(root.WithOpName("neg_call"), {in}, {DT_FLOAT},
+                            b_name_attr);
+
+  GrapplerItem item;
+  TF_ASSERT_OK(root.ToGraphDef(&item.graph));
+
+  GraphProperties properties(item);
+  TF_ASSERT_OK(properties.InferStatically(
+      /*assume_valid_feeds=*/true,
+      /*aggressive_shape_inference=*/false,
+      /*include_tensor_values=*/true));
+
+  // The batch size of the output is the batch size of the input.
+  const auto shape_in = properties.GetOutputProperties("in").at(0).shape();
+  const auto shape_out =
+      properties.GetOutputProperties("neg_call").at(0).shape();
+  ASSERT_EQ(2, shape_out.dim_size());
+  EXPECT_LT(shape_in.dim(0).size(), -1);
+  EXPECT_EQ(shape_in.dim(0).size(), shape_out.dim(0).size());
+  EXPECT_EQ(10, shape_out.dim(1).size());
+}
+
 TEST_F(GraphPropertiesTest, ShapeAnnotatedFunctionOp) {
   // A function, which we cannot infer output shape statically.
   auto f = FunctionDefHelper::Create(
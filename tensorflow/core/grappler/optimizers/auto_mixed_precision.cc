@@ -24,9 +24,13 @@ limitations under the License.
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
+#include "tensorflow/core/grappler/costs/utils.h"
 #include "tensorflow/core/grappler/costs/virtual_placer.h"
 #include "tensorflow/core/grappler/devices.h"
 #include "tensorflow/core/grappler/grappler_item.h"
@@ -982,10 +986,12 @@ class AutoMixedPrecisionImpl {
   AutoMixedPrecisionImpl(Cluster* cluster,
                          const std::unordered_set<string>& nodes_to_preserve,
                          GraphDef* graph, string id,
-                         AutoMixedPrecisionMode mode)
+                         AutoMixedPrecisionMode mode,
+                         const GraphProperties* properties)
       : virtual_placer_(cluster->GetDevices()),
         nodes_to_preserve_(nodes_to_preserve),
         graph_(graph),
+        properties_(properties),
         function_library_(OpRegistry::Global(), graph->library()),
         id_(id),
         graph_view_(graph),
@@ -1010,6 +1016,10 @@ class AutoMixedPrecisionImpl {
                                                              cudnn_version_);
       case AutoMixedPrecisionMode::MKL:
         return std::make_unique<AutoMixedPrecisionListsMkl>();
+      case AutoMixedPrecisionMode::CPU_BF16:
+        // The MKL lists are a superset of the ops with bfloat16 kernels in
+        // other builds; ops without such a kernel are skipped when painting.
+        return std::make_unique<AutoMixedPrecisionListsMkl>();
       case AutoMixedPrecisionMode::CPU:
         // Note: this is not a typo here. AutoMixedPrecisionListsCuda is used
         // intentionally to make CPU and GPU have the same fp16 ops.
@@ -1055,6 +1065,8 @@ class AutoMixedPrecisionImpl {
                                   absl::flat_hash_set<int>* allow_set) const;
   Status ForceColorMatchOnRecurrentEdges(
       absl::flat_hash_set<int>* allow_set) const;
+  void RemoveUnprofitableAllowClusters(
+      absl::flat_hash_set<int>* allow_set) const;
   void MakeCastsAllowIfAllOutputsAllow(
       absl::flat_hash_set<int>* allow_set) const;
   NodeDef BuildCastNode(const MutableGraphView::OutputPort& src,
@@ -1073,6 +1085,7 @@ class AutoMixedPrecisionImpl {
   VirtualPlacer virtual_placer_;
   std::unordered_set<string> nodes_to_preserve_;
   GraphDef* graph_;
+  const GraphProperties* properties_;  // Not owned; may be null.
   FunctionLibraryDefinition function_library_;
   string id_;
   MutableGraphView graph_view_;
@@ -1318,12 +1331,13 @@ Status AutoMixedPrecisionImpl::Optimize() {
       "TF_AUTO_MIXED_PRECISION_GRAPH_REWRITE_LEVEL", "", &optimization_level));
   optimization_level = absl::AsciiStrToUpper(optimization_level);
   force_all_fp16_ = optimization_level == "UNSAFE_FORCE_ALL";
-  if (force_all_fp16_ && mode_ == AutoMixedPrecisionMode::MKL) {
+  if (force_all_fp16_ && (mode_ == AutoMixedPrecisionMode::MKL ||
+                          mode_ == AutoMixedPrecisionMode::CPU_BF16)) {
     // Many ops do not support bfloat16 on the CPU so we disallowing forcing to
     // bfloat16.
     return errors::InvalidArgument(
         "TF_AUTO_MIXED_PRECISION_GRAPH_REWRITE_LEVEL cannot be set to "
-        "UNSAFE_FORCE_ALL when MKL is used");
+        "UNSAFE_FORCE_ALL when converting to bfloat16 on CPU");
   }
 
   treat_infer_as_deny_ = optimization_level == "TREAT_INFER_AS_DENY";
@@ -1360,6 +1374,7 @@ Status AutoMixedPrecisionImpl::Optimize() {
         break;
       case AutoMixedPrecisionMode::MKL:
       case AutoMixedPrecisionMode::CPU:
+      case AutoMixedPrecisionMode::CPU_BF16:
         should_process = !MustPreserve(node) && IsOnDevice(node, DEVICE_CPU);
         break;
     }
@@ -1473,6 +1488,11 @@ Status AutoMixedPrecisionImpl::Optimize() {
   VLOG(2) << "Forcing color match on loop edges";
   TF_RETURN_IF_ERROR(ForceColorMatchOnRecurrentEdges(&allow_set));
 
+  VLOG(2) << "Beginning pass 7 to remove allow clusters that do not pay for "
+             "their casts";
+  RemoveUnprofitableAllowClusters(&allow_set);
+  VLOG(2) << "Finished pass 7";
+
   VLOG(2) << "Finding existing casts that can be made allow";
   MakeCastsAllowIfAllOutputsAllow(&allow_set);
 
@@ -1622,6 +1642,12 @@ void AutoMixedPrecisionImpl::AddAllowlistOps(
     const NodeTypeId& root = *graph_type_view_.GetNode(root_idx);
     if (!ShouldProcess(*root.node)) continue;
     bool force_allow = force_all_fp16_ && CanForceFP16(*root.node);
+    // Without MKL many allowlist ops have no bfloat16 kernel, and painting
+    // them would only surround them with casts.
+    if (mode_ == AutoMixedPrecisionMode::CPU_BF16 && IsFloat32(root) &&
+        !SupportsF16(root)) {
+      continue;
+    }
     if (f16_allowlist_.count(root.node->op()) || force_allow) {
       bool inserted = allow_set->insert(root_idx).second;
       if (VLOG_IS_ON(2) && inserted) {
@@ -1787,15 +1813,17 @@ void AutoMixedPrecisionImpl::PropagateAllowThroughClear(
 void AutoMixedPrecisionImpl::AddInferToAllowIfFollowAllow(
     const absl::flat_hash_set<int>& deny_set,
     absl::flat_hash_set<int>* allow_set) const {
-  // Currently only target for MKL
-  if (mode_ != AutoMixedPrecisionMode::MKL) {
+  // Currently only target for bfloat16 on CPU
+  if (mode_ != AutoMixedPrecisionMode::MKL &&
+      mode_ != AutoMixedPrecisionMode::CPU_BF16) {
     return;
   }
   for (int item_idx = 0; item_idx < graph_type_view_.num_nodes(); ++item_idx) {
     const NodeTypeId& item = *graph_type_view_.GetNode(item_idx);
     if (!ShouldProcess(*item.node) || deny_set.count(item_idx) ||
         allow_set->count(item_idx) || !f16_inferlist_.count(item.node->op()) ||
-        !IsFloat32(item) || !SupportsF16DataType(item)) {
+        !IsFloat32(item) || !SupportsF16DataType(item) ||
+        (mode_ == AutoMixedPrecisionMode::CPU_BF16 && !SupportsF16(item))) {
       continue;
     }
 
@@ -1902,6 +1930,163 @@ Status AutoMixedPrecisionImpl::ForceColorMatchOnRecurrentEdges(
   return Status::OK();
 }
 
+// Returns how many times faster `device` multiplies bfloat16 matrices than
+// float32 ones. Devices that do not report their bfloat16 support in the
+// "cpu_bf16" environment entry are assumed to be the host.
+double GetBf16MatrixSpeedup(const DeviceProperties& device) {
+  string isa;
+  auto it = device.environment().find("cpu_bf16");
+  if (it != device.environment().end()) {
+    isa = it->second;
+  } else if (port::TestCPUFeature(port::AMX_BF16)) {
+    isa = "amx";
+  } else if (port::TestCPUFeature(port::AVX512_BF16)) {
+    isa = "avx512_bf16";
+  }
+  if (isa == "amx") return 8.0;
+  if (isa == "avx512_bf16") return 2.0;
+  // Without bfloat16 instructions the kernels compute in float32 internally.
+  return 1.0;
+}
+
+// Removes from allow_set every connected cluster of allow nodes whose casts
+// are modeled to cost more than the bfloat16 kernels save, so that cheap ops
+// are not wrapped in a cast to bfloat16 and a cast back. A node saves half the
+// time it spends on memory, and allowlist ops also save compute time on
+// devices with bfloat16 instructions. Casts of constants are not charged since
+// they are folded. Clusters whose shapes are not all known are kept.
+void AutoMixedPrecisionImpl::RemoveUnprofitableAllowClusters(
+    absl::flat_hash_set<int>* allow_set) const {
+  if (mode_ != AutoMixedPrecisionMode::CPU_BF16 || properties_ == nullptr) {
+    return;
+  }
+  std::unordered_map<string, const NodeDef*> name_to_node;
+  for (const NodeDef& node : graph_->node()) {
+    name_to_node[node.name()] = &node;
+  }
+  const OpLevelCostEstimator estimator;
+
+  // Returns the number of elements of the outputs of `item`, or -1 if unknown.
+  auto num_output_elements = [&](const NodeTypeId& item) -> int64_t {
+    if (!properties_->HasOutputProperties(item.node->name())) return -1;
+    const std::vector<OpInfo::TensorProperties>& outputs =
+        properties_->GetOutputProperties(item.node->name());
+    int64_t num_elements = 0;
+    for (int port_id : node_type_map_.GetOutputPorts(*item.node,
+                                                     item.type_attr)) {
+      if (port_id >= outputs.size()) return -1;
+      const int64_t n = PartialTensorShape(outputs[port_id].shape())
+                            .num_elements();
+      if (n < 0) return -1;
+      num_elements += n;
+    }
+    return num_elements;
+  };
+  // Returns the time in nanoseconds that casting the outputs of `item` takes,
+  // or a negative value if their shapes are unknown.
+  auto cast_time = [&](const NodeTypeId& item) -> double {
+    const int64_t n = num_output_elements(item);
+    if (n < 0) return -1;
+    const DeviceInfo device =
+        estimator.GetDeviceInfo(virtual_placer_.get_device(*item.node));
+    // A cast reads 4 bytes and writes 2 bytes per element, or the other way.
+    return n * 6 / device.gb_per_sec + n / device.gigaops;
+  };
+  // Returns the time in nanoseconds that running `node` in bfloat16 saves, or
+  // a negative value if the shapes of `node` are unknown.
+  auto bf16_savings = [&](const NodeDef& node) -> double {
+    if (!properties_->HasInputProperties(node.name()) ||
+        !properties_->HasOutputProperties(node.name())) {
+      return -1;
+    }
+    OpContext op_context;
+    op_context.name = node.name();
+    op_context.op_info = BuildOpInfoWithoutDevice(
+        node, name_to_node, properties_->GetInputProperties(node.name()));
+    for (const auto& output : properties_->GetOutputProperties(node.name())) {
+      *op_context.op_info.add_outputs() = output;
+    }
+    *op_context.op_info.mutable_device() = virtual_placer_.get_device(node);
+    op_context.function_library = &graph_->library();
+    const Costs costs = estimator.PredictCosts(op_context);
+    if (costs.num_ops_with_unknown_shapes > 0) return -1;
+    const double speedup =
+        f16_allowlist_.count(node.op())
+            ? GetBf16MatrixSpeedup(op_context.op_info.device())
+            : 1.0;
+    return costs.compute_time.count() * (1.0 - 1.0 / speedup) +
+           costs.memory_time.count() / 2.0;
+  };
+
+  absl::flat_hash_set<int> visited;
+  for (int root_idx = 0; root_idx < graph_type_view_.num_nodes(); ++root_idx) {
+    if (!allow_set->count(root_idx) || visited.count(root_idx)) continue;
+    std::vector<int> cluster;
+    const NodeTypeId& root = *graph_type_view_.GetNode(root_idx);
+    DfsTypeTraversal(graph_type_view_, {&root},
+                     TypeTraversalDirection::kFollowInputsAndOutputs,
+                     DfsTypePredicates::Enter([&](int idx) -> bool {
+                       return allow_set->count(idx) && !visited.count(idx);
+                     }),
+                     DfsTypeCallbacks::PreOrder([&](int idx) {
+                       visited.insert(idx);
+                       cluster.push_back(idx);
+                     }));
+
+    double savings = 0;
+    double cast_cost = 0;
+    bool known = true;
+    absl::flat_hash_set<const NodeDef*> counted_nodes;
+    absl::flat_hash_set<int> cast_sources;
+    for (int idx : cluster) {
+      const NodeTypeId& item = *graph_type_view_.GetNode(idx);
+      if (counted_nodes.insert(item.node).second) {
+        const double node_savings = bf16_savings(*item.node);
+        if (node_savings < 0) known = false;
+        savings += node_savings;
+      }
+      for (int fanout : graph_type_view_.GetFanout(idx)) {
+        if (!allow_set->count(fanout) &&
+            IsFloat32(*graph_type_view_.GetNode(fanout))) {
+          cast_sources.insert(idx);
+        }
+      }
+      for (int fanin : graph_type_view_.GetFanin(idx)) {
+        const NodeTypeId& source = *graph_type_view_.GetNode(fanin);
+        if (!allow_set->count(fanin) && IsFloat32(source) &&
+            !IsConstant(*source.node)) {
+          cast_sources.insert(fanin);
+        }
+      }
+    }
+    for (int idx : cast_sources) {
+      const double time = cast_time(*graph_type_view_.GetNode(idx));
+      if (time < 0) known = false;
+      cast_cost += time;
+    }
+    if (!known) {
+      VLOG(2) << "Keeping the cluster of " << cluster.size()
+              << " allow types around node " << root.node->name()
+              << " because its shapes are unknown";
+      continue;
+    }
+    VLOG(2) << "The cluster of " << cluster.size()
+            << " allow types around node " << root.node->name() << " saves "
+            << savings << "ns for " << cast_sources.size() << " casts of "
+            << cast_cost << "ns";
+    if (cast_cost < savings) continue;
+    for (int idx : cluster) {
+      allow_set->erase(idx);
+      if (VLOG_IS_ON(2)) {
+        const NodeTypeId& item = *graph_type_view_.GetNode(idx);
+        VLOG(2) << "UnPainting type " << item.type_attr.DebugString()
+                << " of node " << item.node->name()
+                << " ALLOW because its casts cost more than it saves";
+      }
+    }
+  }
+}
+
 // Forces all of the given Tensor List nodes into the same color set.
 void AutoMixedPrecisionImpl::ForceColorMatchBetweenTensorListOps(
     const absl::flat_hash_set<const NodeDef*>& tensor_list_nodes,
@@ -2233,9 +2418,22 @@ Status AutoMixedPrecision::Optimize(Cluster* cluster, const GrapplerItem& item,
     return Status::OK();
   }
 
+  // CPU_BF16 weighs the savings of every cluster of bfloat16 nodes against
+  // its casts, which needs the shapes of the tensors.
+  std::unique_ptr<GraphProperties> properties;
+  if (mode_ == AutoMixedPrecisionMode::CPU_BF16 &&
+      !ShouldIgnorePerformance()) {
+    properties = std::make_unique<GraphProperties>(item);
+    Status s = properties->InferStatically(/*assume_valid_feeds=*/false);
+    if (!s.ok()) {
+      VLOG(1) << "Failed to infer shapes, painting by the lists alone: " << s;
+      properties.reset();
+    }
+  }
+
   // Optimize the output graph in-place.
   AutoMixedPrecisionImpl optimizer(cluster, item.NodesToPreserve(), output,
-                                   item.id, mode_);
+                                   item.id, mode_, properties.get());
   if (item.id == "tf_graph") {
     LOG(INFO) << "Running " << name() << " graph optimizer";
   } else {
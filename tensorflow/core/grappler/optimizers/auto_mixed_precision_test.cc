@@ -13,8 +13,6 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
-#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM || INTEL_MKL
-
 #include "tensorflow/core/grappler/optimizers/auto_mixed_precision.h"
 
 #include <utility>
@@ -1613,8 +1611,114 @@ TEST_F(AutoMixedPrecisionMklTest, InferFollowUpStreamDeny) {
 }
 #endif  // INTEL_MKL
 
+constexpr char kCpu[] = "/job:localhost/replica:0/task:0/device:CPU:0";
+
+class AutoMixedPrecisionCpuBf16Test : public GrapplerTest {
+ protected:
+  // Provisions a host whose bfloat16 instructions are described by `cpu_bf16`.
+  void ProvisionHost(const string& cpu_bf16) {
+    DeviceProperties device_properties;
+    device_properties.set_type("CPU");
+    device_properties.set_frequency(2000);
+    device_properties.set_num_cores(4);
+    device_properties.set_bandwidth(32000000);
+    (*device_properties.mutable_environment())["cpu_bf16"] = cpu_bf16;
+    virtual_cluster_.reset(new VirtualCluster({{kCpu, device_properties}}));
+    TF_CHECK_OK(virtual_cluster_->Provision());
+  }
+  void TearDown() override { TF_CHECK_OK(virtual_cluster_->Shutdown()); }
+
+  // A MatMul whose output is much larger than its inputs, so that its casts
+  // only pay off if the host multiplies bfloat16 faster than float32.
+  GrapplerItem MakeWideMatMulItem() {
+    tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice(kCpu);
+    Output input1 = ops::Const(s.WithOpName("input1"), 1.f / 16, {1024, 16});
+    Output input2 = ops::Const(s.WithOpName("input2"), 1.f, {16, 1024});
+    Output allow1 = ops::MatMul(s.WithOpName("allow1"), input1, input2);
+    Output clr1 = ops::Relu(s.WithOpName("clr1"), allow1);
+    Output fetch = ops::Identity(s.WithOpName("fetch"), clr1);
+
+    GrapplerItem item;
+    item.fetch = {"fetch"};
+    TF_CHECK_OK(s.ToGraphDef(&item.graph));
+    return item;
+  }
+
+  std::unique_ptr<Cluster> virtual_cluster_;
+};
+
+TEST_F(AutoMixedPrecisionCpuBf16Test, ConvertsWhenComputeSavingsPayForCasts) {
+  ProvisionHost("amx");
+  GrapplerItem item = MakeWideMatMulItem();
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch);
+
+  AutoMixedPrecision optimizer{AutoMixedPrecisionMode::CPU_BF16};
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(virtual_cluster_.get(), item, &output));
+  VLOG(1) << output.DebugString();
+
+  GraphView output_view(&output);
+  EXPECT_EQ(output.node_size(), item.graph.node_size() + 3);
+  EXPECT_EQ(output_view.GetNode("input1")->attr().at("dtype").type(),
+            DT_FLOAT);
+  EXPECT_EQ(output_view.GetNode("allow1")->attr().at("T").type(), DT_BFLOAT16);
+  EXPECT_EQ(output_view.GetNode("clr1")->attr().at("T").type(), DT_BFLOAT16);
+  EXPECT_EQ(output_view.GetNode("fetch")->attr().at("T").type(), DT_FLOAT);
+
+  auto tensors = EvaluateNodes(output, item.fetch);
+  EXPECT_EQ(tensors.size(), tensors_expected.size());
+  EXPECT_EQ(tensors.size(), item.fetch.size());
+  for (int i = 0; i < item.fetch.size(); ++i) {
+    test::ExpectClose(tensors_expected[i], tensors[i], -1, 5e-4);
+  }
+}
+
+TEST_F(AutoMixedPrecisionCpuBf16Test, KeepsFp32WhenCastsCostMore) {
+  // Without bfloat16 instructions only the memory traffic halves, which does
+  // not pay for casting the output back to float32.
+  ProvisionHost("none");
+  GrapplerItem item = MakeWideMatMulItem();
+
+  AutoMixedPrecision optimizer{AutoMixedPrecisionMode::CPU_BF16};
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(virtual_cluster_.get(), item, &output));
+  VLOG(1) << output.DebugString();
+
+  VerifyGraphsEquivalent(item.graph, output, __FUNCTION__);
+  GraphView output_view(&output);
+  EXPECT_EQ(output_view.GetNode("allow1")->attr().at("T").type(), DT_FLOAT);
+  EXPECT_EQ(output_view.GetNode("clr1")->attr().at("T").type(), DT_FLOAT);
+}
+
+#if !defined(INTEL_MKL)
+TEST_F(AutoMixedPrecisionCpuBf16Test, SkipsOpsWithoutBf16Kernel) {
+  // Conv2D has no bfloat16 CPU kernel without MKL, so the Relu after it must
+  // not be cast to bfloat16 and back either.
+  ProvisionHost("amx");
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice(kCpu);
+  Output input = ops::Const(s.WithOpName("input"), 1.f / 32, {8, 32, 32, 16});
+  Output weight = ops::Const(s.WithOpName("weight"), 2.f, {3, 3, 16, 16});
+  Output allow1 = ops::Conv2D(s.WithOpName("allow1"), input, weight,
+                              {1, 1, 1, 1}, "SAME");
+  Output clr1 = ops::Relu(s.WithOpName("clr1"), allow1);
+  Output fetch = ops::Identity(s.WithOpName("fetch"), clr1);
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  AutoMixedPrecision optimizer{AutoMixedPrecisionMode::CPU_BF16};
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(virtual_cluster_.get(), item, &output));
+  VLOG(1) << output.DebugString();
+
+  VerifyGraphsEquivalent(item.graph, output, __FUNCTION__);
+  GraphView output_view(&output);
+  EXPECT_EQ(output_view.GetNode("allow1")->attr().at("T").type(), DT_FLOAT);
+  EXPECT_EQ(output_view.GetNode("clr1")->attr().at("T").type(), DT_FLOAT);
+}
+#endif  // !INTEL_MKL
+
 }  // namespace
 }  // namespace grappler
 }  // namespace tensorflow
-
-#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM || INTEL_MKL
@@ -23,7 +23,9 @@ limitations under the License.
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/memory/memory.h"
 #include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/graph/tensor_id.h"
@@ -168,6 +170,9 @@ bool CommonSubgraphElimination::CanDedup(const NodeDef& node) const {
   if (IsAssert(node) || IsPrint(node)) {
     return true;
   }
+  if (function_library_ != nullptr) {
+    return IsFreeOfSideEffect(node, function_library_.get());
+  }
   return IsFreeOfSideEffect(node);
 }
 
@@ -280,6 +285,9 @@ Status CommonSubgraphElimination::Optimize(Cluster* /*cluster*/,
   nodes_to_preserve_ = item.NodesToPreserve();
   fetch_nodes_known_ = !item.fetch.empty();
   *optimized_graph = item.graph;
+  // The library is a stub, but it keeps the signatures of the functions.
+  function_library_ = absl::make_unique<FunctionLibraryDefinition>(
+      OpRegistry::Global(), item.graph.library());
 
   // Perform topological sort on the graph in order to help DedupComputations
   // optimize larger subgraphs starting from the roots with more inputs.
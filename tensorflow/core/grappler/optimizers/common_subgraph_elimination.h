@@ -16,8 +16,10 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_COMMON_SUBGRAPH_ELIMINATION_H_
 #define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_COMMON_SUBGRAPH_ELIMINATION_H_
 
+#include <memory>
 #include <unordered_set>
 
+#include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
@@ -62,6 +64,9 @@ class CommonSubgraphElimination : public GraphOptimizer {
 
   bool fetch_nodes_known_ = false;
   std::unordered_set<string> nodes_to_preserve_;
+  // The signatures of the functions of the graph, so that calls to stateless
+  // functions can be deduped like any other stateless op.
+  std::unique_ptr<FunctionLibraryDefinition> function_library_;
 };
 
 }  // end namespace grappler
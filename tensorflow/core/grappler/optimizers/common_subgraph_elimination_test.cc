@@ -19,6 +19,7 @@ limitations under the License.
 #include "tensorflow/cc/ops/array_ops.h"
 #include "tensorflow/cc/ops/math_ops.h"
 #include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/function_testlib.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/grappler/grappler_item.h"
@@ -174,5 +175,39 @@ TEST_F(CommonSubgraphEliminationTest, OpDedupCommutative) {
   test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-6);
 }
 
+TEST_F(CommonSubgraphEliminationTest, DedupStatelessFunctionCalls) {
+  using test::function::NDef;
+
+  GrapplerItem item;
+  item.graph = test::function::GDef(
+      {NDef("x", "Placeholder", {}, {{"dtype", DT_FLOAT}}),
+       NDef("y1", "XTimesTwo", {"x"}, {{"T", DT_FLOAT}}),
+       NDef("y2", "XTimesTwo", {"x"}, {{"T", DT_FLOAT}}),
+       NDef("r1", "RandomUniformFn", {"x"}, {{"T", DT_FLOAT}}),
+       NDef("r2", "RandomUniformFn", {"x"}, {{"T", DT_FLOAT}}),
+       NDef("y", "Add", {"y1", "y2"}, {{"T", DT_FLOAT}}),
+       NDef("r", "Add", {"r1", "r2"}, {{"T", DT_INT64}})},
+      {test::function::XTimesTwo(), test::function::RandomUniform()});
+  item.fetch = {"y", "r"};
+
+  CommonSubgraphElimination optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  // The calls of the stateful function must both run.
+  NodeMap node_map(&output);
+  EXPECT_EQ(node_map.GetNode("y2"), nullptr);
+  EXPECT_NE(node_map.GetNode("r2"), nullptr);
+  const NodeDef* y = node_map.GetNode("y");
+  ASSERT_NE(y, nullptr);
+  ASSERT_EQ(y->input_size(), 2);
+  EXPECT_EQ(y->input(0), "y1");
+  EXPECT_EQ(y->input(1), "y1");
+  const NodeDef* r = node_map.GetNode("r");
+  ASSERT_NE(r, nullptr);
+  ASSERT_EQ(r->input_size(), 2);
+  EXPECT_NE(r->input(0), r->input(1));
+}
+
 }  // namespace grappler
 }  // namespace tensorflow
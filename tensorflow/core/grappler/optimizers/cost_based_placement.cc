@@ -0,0 +1,264 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/cost_based_placement.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/memory/memory.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/grappler/costs/analytical_cost_estimator.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
+#include "tensorflow/core/grappler/costs/virtual_scheduler.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/mutable_graph_view.h"
+#include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/optimizers/pin_to_host_optimizer.h"
+#include "tensorflow/core/grappler/utils/tpu.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/gtl/flatset.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+// Groups with more nodes are not tried, as moving that much of the graph is
+// unlikely to pay off and the report would be unreadable.
+constexpr int kMaxGroupSize = 32;
+// Every trial schedules the whole graph, so bound their number.
+constexpr int kMaxTrials = 64;
+// A move must make the step at least this much faster to be kept, so that
+// rounding in the estimates does not shuffle nodes between devices.
+constexpr double kMinImprovement = 0.01;
+// Bandwidth and latency of a copy between devices, roughly those of PCIe 3.0
+// x16.
+constexpr double kTransferBytesPerNs = 12.0;
+constexpr double kTransferLatencyNs = 10000.0;
+
+// The virtual scheduler inserts a _Send and a _Recv for every tensor that
+// crosses devices, but the analytical estimator treats both as free.  Charges
+// the copy to the _Send, which runs on the channel between the two devices.
+class TransferCostEstimator : public OpLevelCostEstimator {
+ public:
+  Costs PredictCosts(const OpContext& op_context) const override {
+    Costs costs = OpLevelCostEstimator::PredictCosts(op_context);
+    if (op_context.op_info.op() != "_Send") return costs;
+    bool inaccurate = false;
+    const int64_t bytes = CalculateInputSize(op_context.op_info, &inaccurate);
+    const Costs::Duration transfer_time(kTransferLatencyNs +
+                                        bytes / kTransferBytesPerNs);
+    costs.memory_time += transfer_time;
+    costs.execution_time += transfer_time;
+    costs.inaccurate |= inaccurate;
+    return costs;
+  }
+};
+
+bool IsOnHost(const NodeDef& node) {
+  return absl::StrContains(node.device(), DEVICE_CPU);
+}
+
+// Returns true if `node` runs on a GPU and could run on the host instead.
+bool IsPlacementCandidate(const NodeDef& node) {
+  return absl::StrContains(node.device(), DEVICE_GPU) &&
+         !internal::IsDenylisted(node) && !IsSend(node) && !IsRecv(node) &&
+         IsFreeOfSideEffect(node) &&
+         FindKernelDef(DeviceType(DEVICE_CPU), node, nullptr, nullptr).ok();
+}
+
+string DescribeTime(const Costs::Duration& time) {
+  return absl::StrCat(time.asMicroSeconds().count(), "us");
+}
+
+// Writes `report` to a new file in the directory named by
+// TF_DUMP_GRAPH_PREFIX, or logs it if the variable is "-".
+void DumpReport(const string& report) {
+  const char* prefix = getenv("TF_DUMP_GRAPH_PREFIX");
+  if (prefix == nullptr) return;
+  if (strcmp(prefix, "-") == 0) {
+    LOG(INFO) << report;
+    return;
+  }
+  Env* env = Env::Default();
+  string file_name = io::JoinPath(prefix, "cost_based_placement");
+  Status s = env->RecursivelyCreateDir(prefix);
+  if (s.ok() && !env->CreateUniqueFileName(&file_name, ".txt")) {
+    s = errors::Internal("Cannot create a unique file name in ", prefix);
+  }
+  if (s.ok()) s = WriteStringToFile(env, file_name, report);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to dump the cost-based placement report: " << s;
+    return;
+  }
+  LOG(INFO) << "Dumped the cost-based placement report to " << file_name;
+}
+
+}  // namespace
+
+Status CostBasedPlacementOptimizer::Optimize(Cluster* cluster,
+                                             const GrapplerItem& item,
+                                             GraphDef* optimized_graph) {
+  *optimized_graph = item.graph;
+  report_.clear();
+
+  // Skip all TPU graphs.
+  if (IsTPUGraphDef(*optimized_graph)) {
+    return Status::OK();
+  }
+  if (cluster == nullptr) {
+    return errors::Aborted("Cost-based placement needs a cluster.");
+  }
+
+  gtl::FlatSet<string> devices;
+  for (const string& device : cluster->GetDeviceNames()) {
+    devices.insert(device);
+  }
+  const bool has_device_cpu = devices.find("/device:CPU:0") != devices.end();
+
+  // The host device that each candidate would move to.
+  absl::flat_hash_map<const NodeDef*, string> host_devices;
+  for (const NodeDef& node : optimized_graph->node()) {
+    if (!IsPlacementCandidate(node)) continue;
+    string device =
+        internal::TryFindHostDevice(devices, has_device_cpu, node.device());
+    if (!device.empty()) host_devices[&node] = std::move(device);
+  }
+
+  // Moving a group of candidates only removes copies if the group exchanges
+  // data with the host, so only those groups are tried.
+  MutableGraphView graph(optimized_graph);
+  std::vector<std::vector<NodeDef*>> groups;
+  absl::flat_hash_set<const NodeDef*> visited;
+  for (NodeDef& node : *optimized_graph->mutable_node()) {
+    if (!host_devices.contains(&node) || !visited.insert(&node).second) {
+      continue;
+    }
+    std::vector<NodeDef*> group = {&node};
+    bool exchanges_with_host = false;
+    auto visit = [&](NodeDef* neighbor) {
+      if (host_devices.contains(neighbor)) {
+        if (visited.insert(neighbor).second) group.push_back(neighbor);
+      } else if (IsOnHost(*neighbor)) {
+        exchanges_with_host = true;
+      }
+    };
+    for (int i = 0; i < group.size(); ++i) {
+      const NodeDef& member = *group[i];
+      for (const auto& fanin : graph.GetFanins(member, false)) {
+        visit(fanin.node);
+      }
+      for (const auto& fanout : graph.GetFanouts(member, false)) {
+        visit(fanout.node);
+      }
+    }
+    if (!exchanges_with_host) continue;
+    std::sort(group.begin(), group.end(),
+              [](const NodeDef* a, const NodeDef* b) {
+                return a->name() < b->name();
+              });
+    groups.push_back(std::move(group));
+  }
+  if (groups.empty()) {
+    return errors::Aborted("No GPU nodes that exchange data with the host.");
+  }
+
+  AnalyticalCostEstimator estimator(
+      cluster, absl::make_unique<TransferCostEstimator>(),
+      ReadyNodeManagerFactory("FirstReady"), /*use_static_shapes=*/true,
+      /*use_aggressive_shape_inference=*/false);
+  TF_RETURN_IF_ERROR(estimator.Initialize(item));
+  auto estimate_step_time = [&](Costs::Duration* step_time) -> Status {
+    Costs costs;
+    TF_RETURN_IF_ERROR(
+        estimator.PredictCosts(*optimized_graph, /*run_metadata=*/nullptr,
+                               &costs));
+    *step_time = costs.execution_time;
+    return Status::OK();
+  };
+
+  Costs::Duration baseline;
+  Status s = estimate_step_time(&baseline);
+  if (!s.ok()) {
+    return errors::Aborted("Cannot estimate the step time: ",
+                           s.error_message());
+  }
+
+  Costs::Duration best = baseline;
+  string decisions;
+  int num_trials = 0;
+  int num_moved = 0;
+  for (int g = 0; g < groups.size(); ++g) {
+    GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
+    const std::vector<NodeDef*>& group = groups[g];
+    const string& host_device = host_devices[group[0]];
+    absl::StrAppend(&decisions, "group ", g, ": ", group.size(),
+                    " nodes from ", group[0]->device(), " to ", host_device);
+    if (group.size() > kMaxGroupSize || num_trials >= kMaxTrials) {
+      absl::StrAppend(&decisions, ", not tried\n");
+      continue;
+    }
+    ++num_trials;
+    decisions += " [";
+    std::vector<string> original_devices;
+    for (NodeDef* node : group) {
+      absl::StrAppend(&decisions, original_devices.empty() ? "" : ", ",
+                      node->name());
+      original_devices.push_back(node->device());
+      node->set_device(host_devices[node]);
+    }
+    decisions += "]";
+
+    Costs::Duration step_time;
+    s = estimate_step_time(&step_time);
+    const bool keep =
+        s.ok() && step_time.count() < best.count() * (1 - kMinImprovement);
+    if (s.ok()) {
+      absl::StrAppend(&decisions, ": ", DescribeTime(best), " -> ",
+                      DescribeTime(step_time), keep ? ", moved\n" : ", kept\n");
+    } else {
+      absl::StrAppend(&decisions, ": cannot estimate: ", s.error_message(),
+                      ", kept\n");
+    }
+    if (keep) {
+      best = step_time;
+      ++num_moved;
+      continue;
+    }
+    for (int i = 0; i < group.size(); ++i) {
+      group[i]->set_device(original_devices[i]);
+    }
+  }
+
+  report_ = absl::StrCat("Cost-based placement of ", item.id,
+                         ": estimated step time ", DescribeTime(baseline),
+                         " -> ", DescribeTime(best), ", moved ", num_moved,
+                         " of ", groups.size(), " groups\n", decisions);
+  VLOG(1) << report_;
+  DumpReport(report_);
+  return Status::OK();
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,60 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_COST_BASED_PLACEMENT_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_COST_BASED_PLACEMENT_H_
+
+#include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
+#include "tensorflow/core/protobuf/rewriter_config.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Moves groups of GPU nodes to the host when the virtual scheduler estimates
+// that the step gets faster, typically because the copies to and from the
+// host around the group cost more than the time the GPU saves.
+//
+// The candidates are connected groups of stateless GPU nodes that have a CPU
+// kernel and exchange data with host nodes.  Each group is moved on its own,
+// the step time of the whole graph is estimated again, and the move is kept
+// only if it is a clear improvement.  The decisions are logged at VLOG(1),
+// available from report(), and written to a file in the directory named by
+// TF_DUMP_GRAPH_PREFIX if it is set.
+class CostBasedPlacementOptimizer : public GraphOptimizer {
+ public:
+  CostBasedPlacementOptimizer() {}
+  explicit CostBasedPlacementOptimizer(RewriterConfig::Toggle opt_level) {}
+
+  ~CostBasedPlacementOptimizer() override {}
+
+  string name() const override { return "cost_based_placement"; };
+
+  bool UsesFunctionLibrary() const override { return false; }
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* optimized_graph) override;
+
+  // Returns the placements tried by the last call to Optimize, with the
+  // estimated step times before and after each of them.
+  const string& report() const { return report_; }
+
+ private:
+  string report_;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_COST_BASED_PLACEMENT_H_
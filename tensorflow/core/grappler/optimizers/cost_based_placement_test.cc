@@ -0,0 +1,124 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/cost_based_placement.h"
+
+#include "absl/strings/match.h"
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/grappler/clusters/virtual_cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils/grappler_test.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kCpu[] = "/job:localhost/replica:0/task:0/device:CPU:0";
+constexpr char kGpu[] = "/job:localhost/replica:0/task:0/device:GPU:0";
+
+class CostBasedPlacementTest : public GrapplerTest {
+ protected:
+  void SetUp() override {
+    DeviceProperties cpu_device;
+    cpu_device.set_type("CPU");
+    cpu_device.set_frequency(2000);
+    cpu_device.set_num_cores(4);
+    cpu_device.set_bandwidth(32000000);
+    DeviceProperties gpu_device;
+    gpu_device.set_type("GPU");
+    gpu_device.set_frequency(1000);
+    gpu_device.set_num_cores(56);
+    gpu_device.set_bandwidth(900000000);
+    gpu_device.mutable_environment()->insert({"architecture", "7"});
+    cluster_.reset(
+        new VirtualCluster({{kCpu, cpu_device}, {kGpu, gpu_device}}));
+    TF_CHECK_OK(cluster_->Provision());
+  }
+
+  void TearDown() override { TF_CHECK_OK(cluster_->Shutdown()); }
+
+  std::unique_ptr<VirtualCluster> cluster_;
+};
+
+TEST_F(CostBasedPlacementTest, MovesCheapNodeBetweenHostNodes) {
+  // Copying x to the GPU and y back takes longer than negating x on the host.
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output x = ops::Placeholder(s.WithOpName("x").WithDevice(kCpu), DT_FLOAT,
+                              ops::Placeholder::Shape({1024, 1024}));
+  Output y = ops::Neg(s.WithOpName("y").WithDevice(kGpu), x);
+  Output z = ops::Square(s.WithOpName("z").WithDevice(kCpu), y);
+
+  GrapplerItem item;
+  item.fetch = {"z"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  CostBasedPlacementOptimizer optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(cluster_.get(), item, &output));
+
+  EXPECT_EQ(output.node_size(), 3);
+  for (const NodeDef& node : output.node()) {
+    EXPECT_EQ(node.device(), kCpu) << node.name();
+  }
+  EXPECT_TRUE(absl::StrContains(optimizer.report(), "[y]"));
+  EXPECT_TRUE(absl::StrContains(optimizer.report(), "moved 1 of 1 groups"));
+}
+
+TEST_F(CostBasedPlacementTest, KeepsExpensiveNodeOnDevice) {
+  // The copies are much cheaper than multiplying the matrices on the host.
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output x = ops::Placeholder(s.WithOpName("x").WithDevice(kCpu), DT_FLOAT,
+                              ops::Placeholder::Shape({1024, 1024}));
+  Output y = ops::MatMul(s.WithOpName("y").WithDevice(kGpu), x, x);
+  Output z = ops::Square(s.WithOpName("z").WithDevice(kCpu), y);
+
+  GrapplerItem item;
+  item.fetch = {"z"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  CostBasedPlacementOptimizer optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(cluster_.get(), item, &output));
+
+  CompareGraphs(item.graph, output);
+  EXPECT_TRUE(absl::StrContains(optimizer.report(), "[y]"));
+  EXPECT_TRUE(absl::StrContains(optimizer.report(), "moved 0 of 1 groups"));
+}
+
+TEST_F(CostBasedPlacementTest, IgnoresNodesThatOnlyTalkToTheDevice) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output x = ops::Placeholder(s.WithOpName("x").WithDevice(kGpu), DT_FLOAT,
+                              ops::Placeholder::Shape({1024, 1024}));
+  Output y = ops::Neg(s.WithOpName("y").WithDevice(kGpu), x);
+  Output z = ops::Square(s.WithOpName("z").WithDevice(kGpu), y);
+
+  GrapplerItem item;
+  item.fetch = {"z"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  CostBasedPlacementOptimizer optimizer;
+  GraphDef output;
+  Status status = optimizer.Optimize(cluster_.get(), item, &output);
+  EXPECT_TRUE(errors::IsAborted(status));
+  CompareGraphs(item.graph, output);
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
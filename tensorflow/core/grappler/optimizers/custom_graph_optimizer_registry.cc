@@ -66,7 +66,9 @@ const ConfigList& DefaultPluginConfigs() {
                       {"auto_mixed_precision", RewriterConfig::ON},
                       {"auto_mixed_precision_mkl", RewriterConfig::ON},
                       {"auto_mixed_precision_cpu", RewriterConfig::ON},
+                      {"auto_mixed_precision_cpu_bf16", RewriterConfig::ON},
                       {"pin_to_host_optimization", RewriterConfig::ON},
+                      {"cost_based_placement", RewriterConfig::ON},
                       {"layout_optimizer", RewriterConfig::ON},
                       {"remapping", RewriterConfig::ON},
                       {"loop_optimization", RewriterConfig::ON},
@@ -493,8 +493,7 @@ Status DependencyOptimizer::OptimizeDependencies() {
   if (fetch_nodes_known_) {
     VLOG(1) << "Deleted " << nodes_to_delete.size() << " out of "
             << optimized_graph_->node_size() << " nodes.";
-    EraseNodesFromGraph(nodes_to_delete, optimized_graph_);
-    node_map_.reset(new NodeMap(optimized_graph_));
+    EraseNodesFromGraph(nodes_to_delete, optimized_graph_, node_map_.get());
     BuildNodeToIdx();
   }
   return Status::OK();
@@ -761,7 +760,9 @@ Status DependencyOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
     // Perform topological sort to prepare the graph for transitive reduction.
     topo_sort_status = TopologicalSort(optimized_graph_);
     // Set up index-based graph datastructures to speed up analysis steps below.
-    node_map_.reset(new NodeMap(optimized_graph_));
+    // Sorting only permutes the nodes, and the node map is kept up to date by
+    // all the steps below, so it is only built once.
+    if (iteration == 0) node_map_.reset(new NodeMap(optimized_graph_));
     BuildNodeToIdx();
 
     if (topo_sort_status.ok()) {
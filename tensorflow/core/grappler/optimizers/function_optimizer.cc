@@ -461,6 +461,98 @@ FunctionDefLibrary PruneFunctionLibrary(const FunctionLibraryDefinition& flib,
   return pruned_flib.ToProto();
 }
 
+// Renames the functions referenced by a function attribute according to
+// `renames`.
+void RenameFunctionReferences(
+    const absl::flat_hash_map<string, string>& renames, AttrValue* attr) {
+  const auto rename_func = [&renames](NameAttrList* func) {
+    auto it = renames.find(func->name());
+    if (it != renames.end()) func->set_name(it->second);
+    for (auto& func_attr : *func->mutable_attr()) {
+      RenameFunctionReferences(renames, &func_attr.second);
+    }
+  };
+  if (attr->has_func()) rename_func(attr->mutable_func());
+  if (attr->has_list()) {
+    for (NameAttrList& func : *attr->mutable_list()->mutable_func()) {
+      rename_func(&func);
+    }
+  }
+}
+
+void RenameFunctionReferences(
+    const absl::flat_hash_map<string, string>& renames, NodeDef* node) {
+  auto it = renames.find(node->op());
+  if (it != renames.end()) node->set_op(it->second);
+  for (auto& attr : *node->mutable_attr()) {
+    RenameFunctionReferences(renames, &attr.second);
+  }
+}
+
+// Merges the functions of the graph library that are identical up to their
+// names and the names of the functions they call, and makes all the callers
+// call the first of them, so that structurally identical function bodies (and
+// specializations) are instantiated once, and the call sites can be deduped by
+// the common subgraph elimination. Functions with a gradient keep their name.
+// Returns the number of merged functions.
+int DeduplicateFunctions(GraphDef* graph) {
+  FunctionDefLibrary* library = graph->mutable_library();
+  absl::flat_hash_set<string> with_gradient;
+  for (const GradientDef& gradient : library->gradient()) {
+    with_gradient.insert(gradient.function_name());
+    with_gradient.insert(gradient.gradient_func());
+  }
+
+  // Deduping callees can make their callers identical, so this iterates to a
+  // fixed point, with the nesting depth of the library as an upper bound.
+  absl::flat_hash_map<string, string> renames;
+  bool merged = true;
+  while (merged) {
+    merged = false;
+    // The canonical bodies of the representatives, by hash, with their names.
+    absl::flat_hash_map<uint64, std::vector<std::pair<string, FunctionDef>>>
+        representatives;
+    for (const FunctionDef& func : library->function()) {
+      const string& name = func.signature().name();
+      if (renames.contains(name) || with_gradient.contains(name)) continue;
+
+      FunctionDef canonical = func;
+      canonical.mutable_signature()->clear_name();
+      for (NodeDef& node : *canonical.mutable_node_def()) {
+        RenameFunctionReferences(renames, &node);
+      }
+      auto& candidates = representatives[FunctionDefHash(canonical)];
+      auto it = absl::c_find_if(candidates, [&](const auto& candidate) {
+        return FunctionDefsEqual(candidate.second, canonical);
+      });
+      if (it == candidates.end()) {
+        candidates.emplace_back(name, std::move(canonical));
+      } else {
+        renames[name] = it->first;
+        merged = true;
+      }
+    }
+    // A representative might have been merged in an earlier iteration.
+    for (auto& rename : renames) {
+      for (auto it = renames.find(rename.second); it != renames.end();
+           it = renames.find(rename.second)) {
+        rename.second = it->second;
+      }
+    }
+  }
+  if (renames.empty()) return 0;
+
+  for (NodeDef& node : *graph->mutable_node()) {
+    RenameFunctionReferences(renames, &node);
+  }
+  for (FunctionDef& func : *library->mutable_function()) {
+    for (NodeDef& node : *func.mutable_node_def()) {
+      RenameFunctionReferences(renames, &node);
+    }
+  }
+  return renames.size();
+}
+
 // Push all constant inputs of an instantiating node into the function body.
 Status PushDownConstInputs(const NodeDef& func_node,
                            const FunctionOptimizerContext& ctx,
@@ -1509,6 +1601,16 @@ Status FunctionOptimizer::RunFunctionOptimizerPass(
   *optimized_graph->mutable_library() =
       PruneFunctionLibrary(ctx.function_library(), *optimized_graph);
 
+  // Merge identical functions, and prune the ones that are no longer called.
+  const int num_merged = DeduplicateFunctions(optimized_graph);
+  if (num_merged > 0) {
+    VLOG(2) << "Merged " << num_merged << " identical functions";
+    FunctionLibraryDefinition flib(OpRegistry::Global(),
+                                   optimized_graph->library());
+    *optimized_graph->mutable_library() =
+        PruneFunctionLibrary(flib, *optimized_graph);
+  }
+
   return Status::OK();
 }
 
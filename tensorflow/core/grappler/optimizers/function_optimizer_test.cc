@@ -2096,5 +2096,74 @@ TEST_F(FunctionOptimizerTest, PruningUselessLibraryFunctions) {
             "XTimesTwo_specialized_for_y_at_test_graph");
 }
 
+TEST_F(FunctionOptimizerTest, DeduplicateIdenticalFunctions) {
+  using test::function::NDef;
+
+  FunctionOptimizer optimizer(RewriterConfig::DEFAULT, true);
+
+  // MyMulA and MyMulB have the same body, and so do OuterA and OuterB once
+  // MyMulB is merged into MyMulA.
+  const auto make_mul = [](const string& name) {
+    FunctionDef func = FunctionDefHelper::Create(
+        name, {"x:float", "y:float"}, {"z:float"}, {},
+        {{{"output"}, "Mul", {"x", "y"}, {{"T", DT_FLOAT}}}},
+        /* Mapping between function returns and function node outputs. */
+        {{"z", "output:z:0"}});
+    (*func.mutable_attr())["_noinline"].set_b(true);
+    return func;
+  };
+  const auto make_outer = [](const string& name, const string& mul) {
+    FunctionDef func = FunctionDefHelper::Create(
+        name, {"x:float"}, {"z:float"}, {}, {{{"square"}, mul, {"x", "x"}, {}}},
+        /* Mapping between function returns and function node outputs. */
+        {{"z", "square:z:0"}});
+    (*func.mutable_attr())["_noinline"].set_b(true);
+    return func;
+  };
+  std::vector<FunctionDef> function_library = {
+      make_mul("MyMulA"), make_mul("MyMulB"), make_outer("OuterA", "MyMulA"),
+      make_outer("OuterB", "MyMulB")};
+
+  GrapplerItem item;
+  item.id = "tf_graph";
+  item.graph = test::function::GDef(
+      {NDef("x", "Placeholder", {}, {{"dtype", DT_FLOAT}}, kDevice),
+       NDef("a", "OuterA", {"x"}, {}, kDevice),
+       NDef("b", "OuterB", {"x"}, {}, kDevice),
+       NDef("c", "MyMulB", {"x", "a"}, {}, kDevice)},
+      function_library);
+  item.fetch = {"a", "b", "c"};
+
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  std::set<string> functions;
+  for (const FunctionDef& func : output.library().function()) {
+    functions.insert(func.signature().name());
+  }
+  EXPECT_EQ(functions, std::set<string>({"MyMulA", "OuterA"}));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "a" || node.name() == "b") {
+      EXPECT_EQ(node.op(), "OuterA");
+      found++;
+    } else if (node.name() == "c") {
+      EXPECT_EQ(node.op(), "MyMulA");
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 3);
+
+  item.feed.emplace_back("x", test::AsScalar<float>(3.0f));
+  auto tensors_expected = EvaluateFetchNodes(item);
+  GrapplerItem optimized = item.WithGraph(std::move(output));
+  auto tensors = EvaluateFetchNodes(optimized);
+  ASSERT_EQ(tensors.size(), tensors_expected.size());
+  for (int i = 0; i < tensors.size(); ++i) {
+    test::ExpectTensorEqual<float>(tensors_expected[i], tensors[i]);
+  }
+}
+
 }  // namespace grappler
 }  // namespace tensorflow
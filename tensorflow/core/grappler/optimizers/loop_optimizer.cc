@@ -16,19 +16,24 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/loop_optimizer.h"
 
 #include <algorithm>
+#include <cstdlib>
 #include <deque>
+#include <functional>
 #include <limits>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/string_view.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/grappler/graph_topology_view.h"
@@ -56,6 +61,32 @@ namespace {
 
 using TensorVector = gtl::InlinedVector<TensorValue, 4>;
 
+// Returns true if `node` may write to a resource or reference variable it takes
+// as input.
+bool MayWriteResource(const NodeDef& node) {
+  if (IsReadVariableOp(node) || IsFreeOfSideEffect(node)) {
+    return false;
+  }
+  if (ModifiesInputsInPlace(node)) {
+    return true;
+  }
+  const OpRegistrationData* op_reg_data = nullptr;
+  DataTypeVector input_types;
+  DataTypeVector output_types;
+  if (!OpRegistry::Global()->LookUp(node.op(), &op_reg_data).ok() ||
+      !InOutTypesForNode(node, op_reg_data->op_def, &input_types,
+                         &output_types)
+           .ok()) {
+    return true;
+  }
+  for (const DataType type : input_types) {
+    if (type == DT_RESOURCE || IsRefType(type)) {
+      return true;
+    }
+  }
+  return false;
+}
+
 class LoopInvariantNodeMotionOptimizer {
  public:
   explicit LoopInvariantNodeMotionOptimizer(GraphDef* optimized_graph)
@@ -64,7 +95,7 @@ class LoopInvariantNodeMotionOptimizer {
   Status Optimize();
 
  private:
-  Status FindInvariantNodes(NodeDef* node);
+  Status FindInvariantNodes(NodeDef* node, const int frame_id);
   Status RevertInvariantNodes();
   Status MoveInvariantNodes(const int frame_id);
   Status HandleInvariantNode(NodeDef* node, const int num_outputs,
@@ -80,6 +111,9 @@ class LoopInvariantNodeMotionOptimizer {
   std::vector<int> frame_parent_;
   std::map<int, const NodeDef*> loop_cond_;
   std::map<int, std::vector<NodeDef*>> invariant_enters_;
+  // Frames (including their nested frames) that may write to variables, in
+  // which reads of variables aren't invariant.
+  std::set<int> frames_with_resource_writes_;
   int new_enter_id_;
 };
 
@@ -330,7 +364,9 @@ Status LoopInvariantNodeMotionOptimizer::RevertInvariantNodes() {
 }
 
 Status LoopInvariantNodeMotionOptimizer::FindInvariantNodes(
-    NodeDef* start_node) {
+    NodeDef* start_node, const int frame_id) {
+  const bool reads_are_invariant =
+      !frames_with_resource_writes_.count(frame_id);
   std::vector<NodeDef*> stack;
   stack.reserve(32);
   stack.push_back(start_node);
@@ -343,6 +379,10 @@ Status LoopInvariantNodeMotionOptimizer::FindInvariantNodes(
       if (invariant_nodes_.count(consumer) || ModifiesFrameInfo(*consumer)) {
         continue;
       }
+      if (!IsFreeOfSideEffect(*consumer) &&
+          !(IsReadVariableOp(*consumer) && reads_are_invariant)) {
+        continue;
+      }
       bool is_invariant = true;
       for (const auto& input : consumer->input()) {
         if (!IsControlInput(input)) {
@@ -400,6 +440,9 @@ Status LoopInvariantNodeMotionOptimizer::Optimize() {
       frame_children_[frame_ids[0]].insert(frame_ids[1]);
       frame_parent_[frame_ids.back()] = frame_ids[frame_ids.size() - 2];
     }
+    if (MayWriteResource(node)) {
+      frames_with_resource_writes_.insert(frame_ids.begin(), frame_ids.end());
+    }
     if (!frame_ids.empty()) {
       frame_children_[frame_ids.back()] = empty_set_;
       if (node.op() == "LoopCond") {
@@ -441,7 +484,7 @@ Status LoopInvariantNodeMotionOptimizer::Optimize() {
     }
     invariant_nodes_.clear();
     for (auto* enter : invariant_enters_[frame_id]) {
-      TF_RETURN_IF_ERROR(FindInvariantNodes(enter));
+      TF_RETURN_IF_ERROR(FindInvariantNodes(enter, frame_id));
     }
 
     // revert invariant nodes that have control outputs to variant nodes
@@ -714,6 +757,944 @@ Status CheckForDeadFanout(const MutableGraphView& view,
   return Status::OK();
 }
 
+// Returns the integer value of the scalar Const `node`.
+bool GetScalarConstant(const NodeDef& node, int64_t* value) {
+  if (!IsConstant(node) || !node.attr().count("value")) {
+    return false;
+  }
+  Tensor tensor;
+  if (!tensor.FromProto(node.attr().at("value").tensor()) ||
+      tensor.NumElements() != 1) {
+    return false;
+  }
+  if (tensor.dtype() == DT_INT32) {
+    *value = tensor.flat<int32>()(0);
+  } else if (tensor.dtype() == DT_INT64) {
+    *value = tensor.flat<int64_t>()(0);
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// Returns the number of iterations of a loop whose counter starts at `start`
+// and is incremented by `delta` while it is less than (or, if `inclusive`,
+// equal to) `limit`, or -1 if the loop doesn't terminate.
+int64_t GetTripCount(int64_t start, int64_t limit, int64_t delta,
+                     bool inclusive) {
+  if (delta <= 0 || std::abs(start) > std::numeric_limits<int32>::max() ||
+      std::abs(limit) > std::numeric_limits<int32>::max()) {
+    return -1;
+  }
+  if (inclusive) {
+    ++limit;
+  }
+  if (limit <= start) {
+    return 0;
+  }
+  return (limit - start - 1) / delta + 1;
+}
+
+// Returns the node whose output `port` the graph input `input` forwards
+// through Identity nodes, or nullptr if it forwards another output.
+NodeDef* GetForwardedNode(const NodeMap& node_map, const string& input,
+                          int port) {
+  string tensor = input;
+  while (true) {
+    int tensor_port;
+    NodeDef* node = node_map.GetNode(ParseNodeName(tensor, &tensor_port));
+    if (node == nullptr || tensor_port < 0) {
+      return nullptr;
+    }
+    if (!IsIdentity(*node) || node->input_size() == 0 ||
+        IsControlInput(node->input(0))) {
+      return tensor_port == port ? node : nullptr;
+    }
+    tensor = node->input(0);
+  }
+}
+
+// Returns the value of the scalar integer constant the graph input `input`
+// evaluates to in every iteration of the loop, looking through Identity and
+// Enter nodes. Values of Enter nodes that aren't constant are only accepted
+// if `allow_variable_enter`, i.e. when `input` feeds a Merge.
+bool GetLoopConstant(const NodeMap& node_map, const string& input,
+                     bool allow_variable_enter, int64_t* value) {
+  const NodeDef* node = GetForwardedNode(node_map, input, 0);
+  if (node == nullptr) {
+    return false;
+  }
+  if (IsEnter(*node)) {
+    if (!allow_variable_enter && !node->attr().at("is_constant").b()) {
+      return false;
+    }
+    return GetLoopConstant(node_map, node->input(0), false, value);
+  }
+  return GetScalarConstant(*node, value);
+}
+
+string FormatInput(const string& name, int port) {
+  if (port < 0) {
+    return AsControlDependency(name);
+  }
+  return port == 0 ? name : StrCat(name, ":", port);
+}
+
+// A loop variable of a loop in the v1 control flow representation.
+struct LoopVariable {
+  NodeDef* merge;
+  NodeDef* switch_node;
+  NodeDef* next_iteration;
+};
+
+// Unrolls the loop whose frame holds `frame_nodes` by chaining `unroll_factor`
+// copies of its body in every iteration. The loop must be counted: its
+// condition compares a loop variable that starts at a constant and is
+// incremented by a constant in each iteration to a constant, and the trip
+// count must be a multiple of `unroll_factor`. The body must be free of side
+// effects, apart from variables reads when nothing in the loop writes to a
+// variable. The condition still runs on the Merge nodes, which now see the
+// values of every `unroll_factor`-th iteration.
+Status UnrollLoop(const std::vector<NodeDef*>& frame_nodes,
+                  const std::unordered_set<string>& nodes_to_preserve,
+                  int unroll_factor, NodeMap* node_map,
+                  GraphDef* optimized_graph) {
+  const NodeDef* loop_cond = nullptr;
+  bool has_resource_writes = false;
+  for (const NodeDef* node : frame_nodes) {
+    if (IsLoopCond(*node)) {
+      if (loop_cond != nullptr) {
+        return Status::OK();
+      }
+      loop_cond = node;
+    }
+    has_resource_writes |= MayWriteResource(*node);
+  }
+  if (loop_cond == nullptr) {
+    return Status::OK();
+  }
+
+  // Match every Merge of the frame with its Switch and NextIteration nodes.
+  std::vector<LoopVariable> variables;
+  absl::flat_hash_map<string, int> switch_to_variable;
+  for (NodeDef* node : frame_nodes) {
+    if (!IsMerge(*node)) {
+      continue;
+    }
+    if (NumNonControlInputs(*node) != 2) {
+      return Status::OK();
+    }
+    NodeDef* next_iteration = node_map->GetNode(node->input(1));
+    if (next_iteration == nullptr || !IsNextIteration(*next_iteration)) {
+      return Status::OK();
+    }
+    NodeDef* switch_node = nullptr;
+    for (NodeDef* fanout : node_map->GetOutputs(node->name())) {
+      if (IsSwitch(*fanout) && fanout->input_size() == 2 &&
+          NodeName(fanout->input(1)) == loop_cond->name()) {
+        if (switch_node != nullptr) {
+          return Status::OK();
+        }
+        switch_node = fanout;
+      }
+    }
+    if (switch_node == nullptr) {
+      return Status::OK();
+    }
+    switch_to_variable[switch_node->name()] = variables.size();
+    variables.push_back({node, switch_node, next_iteration});
+  }
+
+  // Compute the trip count from the condition `counter < limit` (or
+  // `counter <= limit`) and the increment `counter + delta` of the body.
+  const NodeDef* predicate =
+      GetForwardedNode(*node_map, loop_cond->input(0), 0);
+  if (predicate == nullptr ||
+      !(IsLess(*predicate) || IsLessEqual(*predicate)) ||
+      NumNonControlInputs(*predicate) != 2) {
+    return Status::OK();
+  }
+  const NodeDef* counter = GetForwardedNode(*node_map, predicate->input(0), 0);
+  int64_t limit;
+  if (counter == nullptr || !IsMerge(*counter) ||
+      !GetLoopConstant(*node_map, predicate->input(1), false, &limit)) {
+    return Status::OK();
+  }
+  const LoopVariable* counter_variable = nullptr;
+  for (const LoopVariable& variable : variables) {
+    if (variable.merge == counter) {
+      counter_variable = &variable;
+    }
+  }
+  int64_t start;
+  if (counter_variable == nullptr ||
+      !GetLoopConstant(*node_map, counter->input(0), true, &start)) {
+    return Status::OK();
+  }
+  const NodeDef* increment = GetForwardedNode(
+      *node_map, counter_variable->next_iteration->input(0), 0);
+  if (increment == nullptr || !IsAdd(*increment) ||
+      NumNonControlInputs(*increment) != 2) {
+    return Status::OK();
+  }
+  int64_t delta = 0;
+  for (int i = 0; i < 2; ++i) {
+    if (GetForwardedNode(*node_map, increment->input(i), 1) ==
+            counter_variable->switch_node &&
+        !GetLoopConstant(*node_map, increment->input(1 - i), false, &delta)) {
+      return Status::OK();
+    }
+  }
+  const int64_t trip_count =
+      GetTripCount(start, limit, delta, IsLessEqual(*predicate));
+  if (trip_count < unroll_factor || trip_count % unroll_factor != 0) {
+    return Status::OK();
+  }
+
+  // Everything that depends on the Merge nodes, i.e. the condition and the
+  // body, varies across iterations.
+  absl::flat_hash_set<const NodeDef*> frame(frame_nodes.begin(),
+                                            frame_nodes.end());
+  absl::flat_hash_set<const NodeDef*> variant;
+  std::deque<const NodeDef*> queue;
+  for (const LoopVariable& variable : variables) {
+    variant.insert(variable.merge);
+    queue.push_back(variable.merge);
+  }
+  while (!queue.empty()) {
+    const NodeDef* node = queue.front();
+    queue.pop_front();
+    for (const NodeDef* fanout : node_map->GetOutputs(node->name())) {
+      if (frame.contains(fanout) && !IsNextIteration(*fanout) &&
+          !IsExit(*fanout) && variant.insert(fanout).second) {
+        queue.push_back(fanout);
+      }
+    }
+  }
+
+  // The body is everything computed from the values the Switch nodes forward
+  // into the iteration.
+  absl::flat_hash_set<const NodeDef*> body;
+  std::vector<const NodeDef*> body_nodes;
+  for (const LoopVariable& variable : variables) {
+    for (NodeDef* fanout :
+         node_map->GetOutputsOrderedByNodeName(variable.switch_node->name())) {
+      for (const string& input : fanout->input()) {
+        int port;
+        if (ParseNodeName(input, &port) != variable.switch_node->name()) {
+          continue;
+        }
+        if (port == 0 && IsExit(*fanout)) {
+          continue;
+        }
+        if (port != 1) {
+          return Status::OK();
+        }
+        if (!IsNextIteration(*fanout) && body.insert(fanout).second) {
+          body_nodes.push_back(fanout);
+        }
+      }
+    }
+  }
+  for (int i = 0; i < body_nodes.size(); ++i) {
+    for (const NodeDef* fanout :
+         node_map->GetOutputsOrderedByNodeName(body_nodes[i]->name())) {
+      if (IsNextIteration(*fanout) || body.contains(fanout)) {
+        continue;
+      }
+      if (!frame.contains(fanout) || ModifiesFrameInfo(*fanout) ||
+          IsMerge(*fanout) || IsSwitch(*fanout) || IsLoopCond(*fanout)) {
+        return Status::OK();
+      }
+      body.insert(fanout);
+      body_nodes.push_back(fanout);
+    }
+  }
+
+  // Every input of the body must come either from the body of the same
+  // iteration, or from loop invariants.
+  auto is_body_input = [&](const string& input) {
+    int port;
+    const string name = ParseNodeName(input, &port);
+    const NodeDef* producer = node_map->GetNode(name);
+    if (producer == nullptr) {
+      return false;
+    }
+    if (switch_to_variable.contains(name)) {
+      return port == 1;
+    }
+    return body.contains(producer) || !variant.contains(producer);
+  };
+  for (const NodeDef* node : body_nodes) {
+    if (nodes_to_preserve.count(node->name()) ||
+        !(IsFreeOfSideEffect(*node) ||
+          (IsReadVariableOp(*node) && !has_resource_writes))) {
+      return Status::OK();
+    }
+    for (const string& input : node->input()) {
+      if (!is_body_input(input)) {
+        return Status::OK();
+      }
+    }
+  }
+  for (const LoopVariable& variable : variables) {
+    for (const string& input : variable.next_iteration->input()) {
+      if (!is_body_input(input)) {
+        return Status::OK();
+      }
+    }
+  }
+
+  auto copy_name = [](const string& name, int copy) {
+    return AddPrefixToNodeName(name, StrCat(kLoopOptimizer, "/unroll_", copy));
+  };
+  for (int copy = 1; copy < unroll_factor; ++copy) {
+    for (const NodeDef* node : body_nodes) {
+      if (node_map->NodeExists(copy_name(node->name(), copy))) {
+        return Status::OK();
+      }
+    }
+  }
+
+  // Returns the tensor `input` of the body refers to in copy `copy`, whose
+  // Switch values are the NextIteration values of copy `copy - 1`.
+  std::function<string(const string&, int)> map_input =
+      [&](const string& input, int copy) -> string {
+    if (copy == 0) {
+      return input;
+    }
+    int port;
+    const string name = ParseNodeName(input, &port);
+    auto it = switch_to_variable.find(name);
+    if (it != switch_to_variable.end()) {
+      return map_input(variables[it->second].next_iteration->input(0),
+                       copy - 1);
+    }
+    if (body.contains(node_map->GetNode(name))) {
+      return FormatInput(copy_name(name, copy), port);
+    }
+    return input;
+  };
+  for (int copy = 1; copy < unroll_factor; ++copy) {
+    for (const NodeDef* node : body_nodes) {
+      NodeDef* new_node = optimized_graph->add_node();
+      *new_node = *node;
+      new_node->set_name(copy_name(node->name(), copy));
+      for (int i = 0; i < new_node->input_size(); ++i) {
+        new_node->set_input(i, map_input(node->input(i), copy));
+        node_map->AddOutput(NodeName(new_node->input(i)), new_node->name());
+      }
+      node_map->AddNode(new_node->name(), new_node);
+    }
+  }
+  std::vector<std::vector<string>> next_iteration_inputs;
+  for (const LoopVariable& variable : variables) {
+    next_iteration_inputs.emplace_back();
+    for (const string& input : variable.next_iteration->input()) {
+      next_iteration_inputs.back().push_back(
+          map_input(input, unroll_factor - 1));
+    }
+  }
+  for (int i = 0; i < variables.size(); ++i) {
+    NodeDef* next_iteration = variables[i].next_iteration;
+    for (int j = 0; j < next_iteration->input_size(); ++j) {
+      node_map->UpdateInput(next_iteration->name(), next_iteration->input(j),
+                            next_iteration_inputs[i][j]);
+      next_iteration->set_input(j, next_iteration_inputs[i][j]);
+    }
+  }
+  VLOG(2) << "Unrolled the loop of " << loop_cond->name() << " "
+          << unroll_factor << " times, it now runs "
+          << trip_count / unroll_factor << " iterations.";
+  return Status::OK();
+}
+
+// Unrolls the innermost loops of the graph in the v1 control flow
+// representation by `unroll_factor`.
+Status UnrollLoops(const std::unordered_set<string>& nodes_to_preserve,
+                   int unroll_factor, GraphDef* optimized_graph) {
+  FrameView frame_view;
+  TF_RETURN_IF_ERROR(frame_view.InferFromGraph(*optimized_graph));
+  if (frame_view.num_frames() == 0) {
+    return Status::OK();
+  }
+  std::vector<std::vector<NodeDef*>> frame_nodes(frame_view.num_frames());
+  std::vector<bool> has_nested_frames(frame_view.num_frames(), false);
+  for (NodeDef& node : *optimized_graph->mutable_node()) {
+    const std::vector<int>& frame_ids = frame_view.Frames(node);
+    if (frame_ids.empty()) {
+      continue;
+    }
+    frame_nodes[frame_ids.back()].push_back(&node);
+    for (int i = 0; i + 1 < frame_ids.size(); ++i) {
+      has_nested_frames[frame_ids[i]] = true;
+    }
+  }
+  NodeMap node_map(optimized_graph);
+  for (int frame_id = 0; frame_id < frame_nodes.size(); ++frame_id) {
+    if (!has_nested_frames[frame_id]) {
+      TF_RETURN_IF_ERROR(UnrollLoop(frame_nodes[frame_id], nodes_to_preserve,
+                                    unroll_factor, &node_map, optimized_graph));
+    }
+  }
+  return Status::OK();
+}
+
+// The nodes of the body of a function, by name.
+using FunctionNodes = absl::flat_hash_map<string, const NodeDef*>;
+
+FunctionNodes GetFunctionNodes(const FunctionDef& function) {
+  FunctionNodes nodes;
+  for (const NodeDef& node : function.node_def()) {
+    nodes[node.name()] = &node;
+  }
+  return nodes;
+}
+
+// Returns the function input or node output `input` of a function forwards
+// through Identity nodes.
+string SkipFunctionIdentities(const FunctionNodes& nodes, string input) {
+  while (!IsControlInput(input)) {
+    auto it = nodes.find(input.substr(0, input.find(':')));
+    if (it == nodes.end() || !IsIdentity(*it->second) ||
+        it->second->input_size() == 0 ||
+        IsControlInput(it->second->input(0))) {
+      break;
+    }
+    input = it->second->input(0);
+  }
+  return input;
+}
+
+int GetFunctionArgIndex(const FunctionDef& function, const string& input) {
+  const auto& args = function.signature().input_arg();
+  for (int i = 0; i < args.size(); ++i) {
+    if (args[i].name() == input) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+const string& GetFunctionRet(const FunctionDef& function, int index) {
+  return function.ret().at(function.signature().output_arg(index).name());
+}
+
+// Returns true if the body of a While loop returns its argument `index`
+// unchanged.
+bool IsLoopInvariantArg(const FunctionDef& body, const FunctionNodes& nodes,
+                        int index) {
+  return index < body.signature().output_arg_size() &&
+         body.ret().count(body.signature().output_arg(index).name()) &&
+         SkipFunctionIdentities(nodes, GetFunctionRet(body, index)) ==
+             body.signature().input_arg(index).name();
+}
+
+// The condition and body of a functional While node.
+struct WhileLoop {
+  NodeDef* node;
+  const FunctionDef* cond;
+  const FunctionDef* body;
+  FunctionNodes cond_nodes;
+  FunctionNodes body_nodes;
+};
+
+// Returns the value of the scalar integer constant `input` of `function`, the
+// condition or the body of `loop`, evaluates to in every iteration: a Const
+// of the function, or a loop invariant argument of the loop that is a Const
+// in the graph.
+bool GetWhileLoopConstant(const WhileLoop& loop, const NodeMap& node_map,
+                          const FunctionDef& function,
+                          const FunctionNodes& nodes, const string& input,
+                          int64_t* value) {
+  const string tensor = SkipFunctionIdentities(nodes, input);
+  const size_t pos = tensor.find(':');
+  if (pos != string::npos) {
+    auto it = nodes.find(tensor.substr(0, pos));
+    return it != nodes.end() && GetScalarConstant(*it->second, value);
+  }
+  const int index = GetFunctionArgIndex(function, tensor);
+  return index >= 0 && IsLoopInvariantArg(*loop.body, loop.body_nodes, index) &&
+         GetLoopConstant(node_map, loop.node->input(index), false, value);
+}
+
+// Returns the number of iterations of `loop` if its condition compares a loop
+// variable that starts at a constant and is incremented by a constant in each
+// iteration to a constant, or -1.
+int64_t GetWhileLoopTripCount(const WhileLoop& loop, const NodeMap& node_map) {
+  const FunctionDef& cond = *loop.cond;
+  const FunctionDef& body = *loop.body;
+  if (cond.signature().output_arg_size() != 1 ||
+      !cond.ret().count(cond.signature().output_arg(0).name())) {
+    return -1;
+  }
+  const string predicate_output =
+      SkipFunctionIdentities(loop.cond_nodes, GetFunctionRet(cond, 0));
+  auto predicate_it = loop.cond_nodes.find(
+      predicate_output.substr(0, predicate_output.find(':')));
+  if (predicate_it == loop.cond_nodes.end()) {
+    return -1;
+  }
+  const NodeDef& predicate = *predicate_it->second;
+  if (!(IsLess(predicate) || IsLessEqual(predicate)) ||
+      NumNonControlInputs(predicate) != 2) {
+    return -1;
+  }
+  const int counter = GetFunctionArgIndex(
+      cond, SkipFunctionIdentities(loop.cond_nodes, predicate.input(0)));
+  int64_t limit;
+  if (counter < 0 || counter >= body.signature().output_arg_size() ||
+      !GetWhileLoopConstant(loop, node_map, cond, loop.cond_nodes,
+                            predicate.input(1), &limit)) {
+    return -1;
+  }
+  int64_t start;
+  if (!GetLoopConstant(node_map, loop.node->input(counter), false, &start) ||
+      !body.ret().count(body.signature().output_arg(counter).name())) {
+    return -1;
+  }
+  const string increment_output =
+      SkipFunctionIdentities(loop.body_nodes, GetFunctionRet(body, counter));
+  auto increment_it = loop.body_nodes.find(
+      increment_output.substr(0, increment_output.find(':')));
+  if (increment_it == loop.body_nodes.end()) {
+    return -1;
+  }
+  const NodeDef& increment = *increment_it->second;
+  if (!IsAdd(increment) || NumNonControlInputs(increment) != 2) {
+    return -1;
+  }
+  const string& counter_arg = body.signature().input_arg(counter).name();
+  int64_t delta = 0;
+  for (int i = 0; i < 2; ++i) {
+    if (SkipFunctionIdentities(loop.body_nodes, increment.input(i)) ==
+            counter_arg &&
+        !GetWhileLoopConstant(loop, node_map, body, loop.body_nodes,
+                              increment.input(1 - i), &delta)) {
+      return -1;
+    }
+  }
+  return GetTripCount(start, limit, delta, IsLessEqual(predicate));
+}
+
+// Returns true if `function` only calls ops that are free of side effects and,
+// if `allow_reads`, ReadVariableOp.
+bool IsFreeOfSideEffects(const FunctionDef& function, bool allow_reads) {
+  if (function.control_ret_size() > 0) {
+    return false;
+  }
+  for (const NodeDef& node : function.node_def()) {
+    if (!IsFreeOfSideEffect(node) && !(allow_reads && IsReadVariableOp(node))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool HasResourceWrites(const FunctionDef& function) {
+  for (const NodeDef& node : function.node_def()) {
+    if (MayWriteResource(node)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Returns a name starting with `prefix` that no function of `flib` uses.
+string GetUniqueFunctionName(const FunctionLibraryDefinition& flib,
+                             const string& prefix) {
+  string name = prefix;
+  for (int i = 1; flib.Contains(name); ++i) {
+    name = StrCat(prefix, "_", i);
+  }
+  return name;
+}
+
+// Replaces the body of `loop` by one that chains `unroll_factor` copies of it,
+// if the loop is counted, its trip count is a multiple of `unroll_factor` and
+// its body is free of side effects.
+Status UnrollWhileLoop(const WhileLoop& loop, int unroll_factor,
+                       const NodeMap& node_map,
+                       FunctionLibraryDefinition* flib,
+                       GraphDef* optimized_graph) {
+  // Reads of variables can be reordered when nothing in the loop has side
+  // effects.
+  const FunctionDef& body = *loop.body;
+  if (!IsFreeOfSideEffects(body, /*allow_reads=*/true) ||
+      !IsFreeOfSideEffects(*loop.cond, /*allow_reads=*/true)) {
+    return Status::OK();
+  }
+  const int64_t trip_count = GetWhileLoopTripCount(loop, node_map);
+  if (trip_count < unroll_factor || trip_count % unroll_factor != 0) {
+    return Status::OK();
+  }
+  for (const auto& output : body.signature().output_arg()) {
+    if (!body.ret().count(output.name())) {
+      return Status::OK();
+    }
+  }
+
+  auto copy_name = [](const string& name, int copy) {
+    return copy == 0 ? name : StrCat(name, "_unroll_", copy);
+  };
+  absl::flat_hash_set<string> names;
+  for (const auto& arg : body.signature().input_arg()) {
+    names.insert(arg.name());
+  }
+  for (const NodeDef& node : body.node_def()) {
+    names.insert(node.name());
+  }
+  for (int copy = 1; copy < unroll_factor; ++copy) {
+    for (const NodeDef& node : body.node_def()) {
+      if (names.contains(copy_name(node.name(), copy))) {
+        return Status::OK();
+      }
+    }
+  }
+
+  // Returns the tensor `input` of the body refers to in copy `copy`, whose
+  // arguments are the return values of copy `copy - 1`.
+  std::function<string(const string&, int)> map_input =
+      [&](const string& input, int copy) -> string {
+    if (copy == 0) {
+      return input;
+    }
+    if (IsControlInput(input)) {
+      return AsControlDependency(copy_name(input.substr(1), copy));
+    }
+    const size_t pos = input.find(':');
+    if (pos == string::npos) {
+      return map_input(GetFunctionRet(body, GetFunctionArgIndex(body, input)),
+                       copy - 1);
+    }
+    return StrCat(copy_name(input.substr(0, pos), copy), input.substr(pos));
+  };
+  FunctionDef unrolled_body = body;
+  unrolled_body.mutable_signature()->set_name(GetUniqueFunctionName(
+      *flib, StrCat(body.signature().name(), "_unrolled_", unroll_factor)));
+  for (int copy = 1; copy < unroll_factor; ++copy) {
+    for (const NodeDef& node : body.node_def()) {
+      NodeDef* new_node = unrolled_body.add_node_def();
+      *new_node = node;
+      new_node->set_name(copy_name(node.name(), copy));
+      for (int i = 0; i < node.input_size(); ++i) {
+        new_node->set_input(i, map_input(node.input(i), copy));
+      }
+    }
+  }
+  for (const auto& output : body.signature().output_arg()) {
+    (*unrolled_body.mutable_ret())[output.name()] =
+        map_input(body.ret().at(output.name()), unroll_factor - 1);
+  }
+
+  TF_RETURN_IF_ERROR(flib->AddFunctionDef(unrolled_body));
+  *optimized_graph->mutable_library()->add_function() = unrolled_body;
+  (*loop.node->mutable_attr())["body"].mutable_func()->set_name(
+      unrolled_body.signature().name());
+  VLOG(2) << "Unrolled the body of " << loop.node->name() << " "
+          << unroll_factor << " times, it now runs "
+          << trip_count / unroll_factor << " iterations.";
+  return Status::OK();
+}
+
+// Moves the nodes of the body of `loop` that only depend on constants and on
+// loop variables the body passes through unchanged in front of the loop, and
+// feeds the values the rest of the body uses into the loop as new loop
+// variables. Reads of variables are hoisted as well if nothing in the loop
+// writes to a variable.
+Status HoistWhileLoopInvariants(const WhileLoop& loop, NodeMap* node_map,
+                                FunctionLibraryDefinition* flib,
+                                GraphDef* optimized_graph) {
+  const FunctionDef& body = *loop.body;
+  const FunctionDef& cond = *loop.cond;
+  NodeDef* while_node = loop.node;
+  const int num_args = body.signature().input_arg_size();
+  if (NumNonControlInputs(*while_node) != num_args ||
+      body.signature().output_arg_size() != num_args ||
+      cond.signature().input_arg_size() != num_args ||
+      !while_node->attr().count("T")) {
+    return Status::OK();
+  }
+  for (const auto& output : body.signature().output_arg()) {
+    if (!body.ret().count(output.name())) {
+      return Status::OK();
+    }
+  }
+  std::vector<bool> invariant_args(num_args);
+  for (int i = 0; i < num_args; ++i) {
+    invariant_args[i] = IsLoopInvariantArg(body, loop.body_nodes, i);
+  }
+  const bool allow_reads = !HasResourceWrites(body) && !HasResourceWrites(cond);
+
+  absl::flat_hash_set<string> control_outputs;
+  for (const NodeDef& node : body.node_def()) {
+    for (const string& input : node.input()) {
+      if (IsControlInput(input)) {
+        control_outputs.insert(input.substr(1));
+      }
+    }
+  }
+  for (const auto& control_ret : body.control_ret()) {
+    control_outputs.insert(control_ret.second);
+  }
+
+  // Grow the set of invariant nodes in topological order.
+  std::vector<const NodeDef*> invariant_nodes;
+  absl::flat_hash_map<string, DataType> invariant_types;
+  auto is_invariant_input = [&](const string& input) {
+    const size_t pos = input.find(':');
+    if (pos == string::npos) {
+      const int index = GetFunctionArgIndex(body, input);
+      return index >= 0 && invariant_args[index];
+    }
+    const string name = input.substr(0, pos);
+    if (invariant_types.contains(name)) {
+      return true;
+    }
+    auto it = loop.body_nodes.find(name);
+    return it != loop.body_nodes.end() && IsConstant(*it->second) &&
+           it->second->input_size() == 0;
+  };
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (const NodeDef& node : body.node_def()) {
+      if (invariant_types.contains(node.name()) || IsConstant(node) ||
+          IsIdentity(node) || control_outputs.contains(node.name()) ||
+          !(IsFreeOfSideEffect(node) ||
+            (IsReadVariableOp(node) && allow_reads))) {
+        continue;
+      }
+      const OpDef* op_def = nullptr;
+      if (!OpRegistry::Global()->LookUpOpDef(node.op(), &op_def).ok() ||
+          op_def->output_arg_size() != 1 ||
+          !op_def->output_arg(0).number_attr().empty() ||
+          !op_def->output_arg(0).type_list_attr().empty() ||
+          op_def->output_arg(0).is_ref()) {
+        continue;
+      }
+      DataType type = op_def->output_arg(0).type();
+      if (type == DT_INVALID) {
+        auto it = node.attr().find(op_def->output_arg(0).type_attr());
+        if (it == node.attr().end()) {
+          continue;
+        }
+        type = it->second.type();
+      }
+      bool is_invariant = true;
+      for (const string& input : node.input()) {
+        if (IsControlInput(input) || !is_invariant_input(input)) {
+          is_invariant = false;
+          break;
+        }
+      }
+      if (is_invariant) {
+        invariant_types[node.name()] = type;
+        invariant_nodes.push_back(&node);
+        changed = true;
+      }
+    }
+  }
+
+  // The invariant values the rest of the body uses become loop variables.
+  std::vector<string> hoisted_outputs;
+  absl::flat_hash_set<string> seen;
+  auto use = [&](const string& input) {
+    const string name = input.substr(0, input.find(':'));
+    if (invariant_types.contains(name) && seen.insert(name).second) {
+      hoisted_outputs.push_back(name);
+    }
+  };
+  for (const NodeDef& node : body.node_def()) {
+    if (!invariant_types.contains(node.name())) {
+      for (const string& input : node.input()) {
+        use(input);
+      }
+    }
+  }
+  for (const auto& output : body.signature().output_arg()) {
+    use(body.ret().at(output.name()));
+  }
+  if (hoisted_outputs.empty()) {
+    return Status::OK();
+  }
+
+  auto outer_name = [&](const string& name) {
+    return AddPrefixToNodeName(StrCat(while_node->name(), "/", name),
+                               kLoopOptimizer);
+  };
+  for (const auto& node : loop.body_nodes) {
+    if (node_map->NodeExists(outer_name(node.first))) {
+      return Status::OK();
+    }
+  }
+  absl::flat_hash_set<string> names;
+  for (const FunctionDef* function : {&body, &cond}) {
+    for (const auto& arg : function->signature().input_arg()) {
+      names.insert(arg.name());
+    }
+    for (const auto& arg : function->signature().output_arg()) {
+      names.insert(arg.name());
+    }
+    for (const NodeDef& node : function->node_def()) {
+      names.insert(node.name());
+    }
+  }
+  absl::flat_hash_map<string, string> hoisted_args;
+  for (int i = 0; hoisted_args.size() < hoisted_outputs.size(); ++i) {
+    const string name = StrCat("loop_invariant_", i);
+    if (!names.contains(name) && !names.contains(StrCat(name, "_output"))) {
+      hoisted_args[hoisted_outputs[hoisted_args.size()]] = name;
+    }
+  }
+
+  // Clone the invariant nodes, and the constants they use, in front of the
+  // loop.
+  const string& device = while_node->device();
+  auto add_outer_node = [&](const NodeDef& node) {
+    NodeDef* new_node = optimized_graph->add_node();
+    *new_node = node;
+    new_node->set_name(outer_name(node.name()));
+    if (new_node->device().empty()) {
+      new_node->set_device(device);
+    }
+    node_map->AddNode(new_node->name(), new_node);
+    return new_node;
+  };
+  absl::flat_hash_set<string> hoisted_constants;
+  std::vector<string> new_inputs;
+  for (const NodeDef* node : invariant_nodes) {
+    NodeDef* new_node = add_outer_node(*node);
+    for (int i = 0; i < node->input_size(); ++i) {
+      const string& input = node->input(i);
+      const size_t pos = input.find(':');
+      string outer_input;
+      if (pos == string::npos) {
+        outer_input = while_node->input(GetFunctionArgIndex(body, input));
+      } else {
+        const string name = input.substr(0, pos);
+        if (!invariant_types.contains(name) &&
+            hoisted_constants.insert(name).second) {
+          add_outer_node(*loop.body_nodes.at(name));
+        }
+        outer_input = outer_name(name);
+      }
+      new_node->set_input(i, outer_input);
+      node_map->AddOutput(NodeName(outer_input), new_node->name());
+    }
+  }
+  for (const string& name : hoisted_outputs) {
+    new_inputs.push_back(outer_name(name));
+  }
+
+  // Feed the hoisted values into new loop variables, which the body passes
+  // through and the condition ignores.
+  FunctionDef new_body;
+  *new_body.mutable_signature() = body.signature();
+  new_body.mutable_signature()->set_name(GetUniqueFunctionName(
+      *flib, StrCat(body.signature().name(), "_hoisted")));
+  *new_body.mutable_attr() = body.attr();
+  *new_body.mutable_arg_attr() = body.arg_attr();
+  *new_body.mutable_resource_arg_unique_id() = body.resource_arg_unique_id();
+  *new_body.mutable_control_ret() = body.control_ret();
+  auto map_input = [&](const string& input) {
+    auto it = hoisted_args.find(input.substr(0, input.find(':')));
+    return it == hoisted_args.end() || IsControlInput(input) ? input
+                                                             : it->second;
+  };
+  for (const NodeDef& node : body.node_def()) {
+    if (invariant_types.contains(node.name())) {
+      continue;
+    }
+    NodeDef* new_node = new_body.add_node_def();
+    *new_node = node;
+    for (int i = 0; i < node.input_size(); ++i) {
+      new_node->set_input(i, map_input(node.input(i)));
+    }
+  }
+  for (const auto& ret : body.ret()) {
+    (*new_body.mutable_ret())[ret.first] = map_input(ret.second);
+  }
+  FunctionDef new_cond = cond;
+  new_cond.mutable_signature()->set_name(GetUniqueFunctionName(
+      *flib, StrCat(cond.signature().name(), "_hoisted")));
+  auto& attr = *while_node->mutable_attr();
+  for (const string& output : hoisted_outputs) {
+    const string& arg = hoisted_args[output];
+    const DataType type = invariant_types[output];
+    OpDef::ArgDef* input_arg = new_body.mutable_signature()->add_input_arg();
+    input_arg->set_name(arg);
+    input_arg->set_type(type);
+    OpDef::ArgDef* output_arg = new_body.mutable_signature()->add_output_arg();
+    output_arg->set_name(StrCat(arg, "_output"));
+    output_arg->set_type(type);
+    (*new_body.mutable_ret())[output_arg->name()] = arg;
+    *new_cond.mutable_signature()->add_input_arg() = *input_arg;
+    attr["T"].mutable_list()->add_type(type);
+    if (attr.count("output_shapes")) {
+      attr["output_shapes"].mutable_list()->add_shape()->set_unknown_rank(
+          true);
+    }
+  }
+  if (attr.count("_num_original_outputs")) {
+    attr["_num_original_outputs"].set_i(num_args + hoisted_outputs.size());
+  }
+  TF_RETURN_IF_ERROR(flib->AddFunctionDef(new_body));
+  TF_RETURN_IF_ERROR(flib->AddFunctionDef(new_cond));
+  *optimized_graph->mutable_library()->add_function() = new_body;
+  *optimized_graph->mutable_library()->add_function() = new_cond;
+  attr["body"].mutable_func()->set_name(new_body.signature().name());
+  attr["cond"].mutable_func()->set_name(new_cond.signature().name());
+
+  // The new loop variables go after the existing ones, before the control
+  // inputs.
+  std::vector<string> control_inputs(while_node->input().begin() + num_args,
+                                     while_node->input().end());
+  while_node->mutable_input()->DeleteSubrange(num_args,
+                                              control_inputs.size());
+  for (const string& input : new_inputs) {
+    while_node->add_input(input);
+    node_map->AddOutput(NodeName(input), while_node->name());
+  }
+  for (const string& input : control_inputs) {
+    while_node->add_input(input);
+  }
+  VLOG(2) << "Hoisted " << invariant_nodes.size()
+          << " nodes out of the body of " << while_node->name();
+  return Status::OK();
+}
+
+// Applies `fn` to every functional While loop of the graph outside of v1
+// control flow frames.
+template <typename Fn>
+Status ForEachWhileLoop(GraphDef* optimized_graph,
+                        FunctionLibraryDefinition* flib, Fn fn) {
+  FrameView frame_view;
+  TF_RETURN_IF_ERROR(frame_view.InferFromGraph(*optimized_graph));
+  std::vector<NodeDef*> while_nodes;
+  for (NodeDef& node : *optimized_graph->mutable_node()) {
+    if (IsWhile(node) && !frame_view.IsInFrame(node)) {
+      while_nodes.push_back(&node);
+    }
+  }
+  for (NodeDef* node : while_nodes) {
+    auto cond_it = node->attr().find("cond");
+    auto body_it = node->attr().find("body");
+    if (cond_it == node->attr().end() || body_it == node->attr().end()) {
+      continue;
+    }
+    const FunctionDef* cond = flib->Find(cond_it->second.func().name());
+    const FunctionDef* body = flib->Find(body_it->second.func().name());
+    if (cond == nullptr || body == nullptr) {
+      continue;
+    }
+    WhileLoop loop{node, cond, body, GetFunctionNodes(*cond),
+                   GetFunctionNodes(*body)};
+    TF_RETURN_IF_ERROR(fn(loop));
+  }
+  return Status::OK();
+}
+
 }  // namespace
 
 LoopOptimizer::LoopOptimizer()
@@ -722,10 +1703,11 @@ LoopOptimizer::LoopOptimizer()
       options_(LoopOptimizerOptions::Default(RewriterConfig::ON)) {}
 
 LoopOptimizer::LoopOptimizer(RewriterConfig::Toggle opt_level,
-                             DeviceBase* cpu_device)
+                             DeviceBase* cpu_device, int unroll_factor)
     : opt_level_(opt_level),
       cpu_device_(cpu_device),
-      options_(LoopOptimizerOptions::Default(RewriterConfig::ON)) {
+      options_(LoopOptimizerOptions::Default(opt_level)) {
+  options_.loop_unroll_factor = unroll_factor;
   resource_mgr_.reset(new ResourceMgr());
 }
 
@@ -733,17 +1715,41 @@ Status LoopOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
                                GraphDef* optimized_graph) {
   if (!options_.enable_loop_invariant_node_motion &&
       !options_.enable_stack_push_removal &&
-      !options_.enable_dead_branch_removal) {
+      !options_.enable_dead_branch_removal &&
+      options_.loop_unroll_factor < 2) {
     return errors::Aborted("Nothing to do.");
   }
   *optimized_graph = item.graph;
+  const std::unordered_set<string> nodes_to_preserve = item.NodesToPreserve();
+  FunctionLibraryDefinition flib(OpRegistry::Global(),
+                                 optimized_graph->library());
   // Set up helper data structures.
   if (options_.enable_loop_invariant_node_motion) {
     LoopInvariantNodeMotionOptimizer linm_optimizer(optimized_graph);
     TF_RETURN_IF_ERROR(linm_optimizer.Optimize());
+    NodeMap node_map(optimized_graph);
+    TF_RETURN_IF_ERROR(ForEachWhileLoop(
+        optimized_graph, &flib, [&](const WhileLoop& loop) {
+          if (nodes_to_preserve.count(loop.node->name())) {
+            return Status::OK();
+          }
+          return HoistWhileLoopInvariants(loop, &node_map, &flib,
+                                          optimized_graph);
+        }));
+  }
+  if (options_.loop_unroll_factor > 1) {
+    const int unroll_factor = options_.loop_unroll_factor;
+    TF_RETURN_IF_ERROR(
+        UnrollLoops(nodes_to_preserve, unroll_factor, optimized_graph));
+    NodeMap node_map(optimized_graph);
+    TF_RETURN_IF_ERROR(ForEachWhileLoop(
+        optimized_graph, &flib, [&](const WhileLoop& loop) {
+          return UnrollWhileLoop(loop, unroll_factor, node_map, &flib,
+                                 optimized_graph);
+        }));
   }
   if (options_.enable_stack_push_removal) {
-    TF_RETURN_IF_ERROR(RemoveStackOps(item.NodesToPreserve(), optimized_graph));
+    TF_RETURN_IF_ERROR(RemoveStackOps(nodes_to_preserve, optimized_graph));
   }
   if (options_.enable_dead_branch_removal) {
     NodeMap node_map(optimized_graph);
@@ -751,7 +1757,7 @@ Status LoopOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
     for (const auto& feed : item.feed) {
       feed_nodes.insert(NodeName(feed.first));
     }
-    TF_RETURN_IF_ERROR(RemoveDeadBranches(item.NodesToPreserve(), node_map,
+    TF_RETURN_IF_ERROR(RemoveDeadBranches(nodes_to_preserve, node_map,
                                           feed_nodes, optimized_graph));
   }
 
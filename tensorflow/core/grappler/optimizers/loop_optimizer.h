@@ -33,8 +33,10 @@ class LoopOptimizer : public GraphOptimizer {
  public:
   LoopOptimizer();
 
+  // `unroll_factor` > 1 unrolls the body of every loop with a constant trip
+  // count that is a multiple of it.
   explicit LoopOptimizer(RewriterConfig::Toggle opt_level,
-                         DeviceBase* cpu_device);
+                         DeviceBase* cpu_device, int unroll_factor = 0);
 
   ~LoopOptimizer() override {}
 
@@ -53,9 +55,14 @@ class LoopOptimizer : public GraphOptimizer {
     bool enable_loop_invariant_node_motion = false;
     bool enable_stack_push_removal = true;
     bool enable_dead_branch_removal = true;
+    // Number of copies of the body of a loop with a constant trip count to
+    // chain in a single iteration. Values below 2 disable unrolling.
+    int loop_unroll_factor = 0;
 
     static LoopOptimizerOptions Default(RewriterConfig::Toggle opt_level) {
       LoopOptimizerOptions options;
+      options.enable_loop_invariant_node_motion =
+          opt_level == RewriterConfig::AGGRESSIVE;
       return options;
     }
   };
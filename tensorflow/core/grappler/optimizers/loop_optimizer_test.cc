@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/loop_optimizer.h"
 
 #include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/function_testlib.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/grappler/grappler_item.h"
@@ -70,6 +71,145 @@ class LoopOptimizerTest : public GrapplerTest {
     optimizer->options_.enable_stack_push_removal = true;
   }
 
+  void EnableOnlyLoopUnrolling(LoopOptimizer* optimizer, int unroll_factor) {
+    DisableAllStages(optimizer);
+    optimizer->options_.loop_unroll_factor = unroll_factor;
+  }
+
+  // Returns a v1 loop computing `x` = 2^`limit` with a counter that runs from
+  // 0 to `limit`.
+  static GraphDef CountedLoop(int limit) {
+    using test::function::NDef;
+    using Attrs =
+        std::vector<std::pair<string, FunctionDefHelper::AttrValueWrapper>>;
+    auto enter_attrs = [](DataType type) {
+      return Attrs{{"T", type},
+                   {"frame_name", "while"},
+                   {"is_constant", false},
+                   {"parallel_iterations", 10}};
+    };
+    return test::function::GDef({
+        NDef("i0", "Const", {},
+             {{"dtype", DT_INT32}, {"value", test::AsScalar<int32>(0)}}),
+        NDef("x0", "Const", {},
+             {{"dtype", DT_FLOAT}, {"value", test::AsScalar<float>(1)}}),
+        NDef("while/Enter", "Enter", {"i0"}, enter_attrs(DT_INT32)),
+        NDef("while/Enter_1", "Enter", {"x0"}, enter_attrs(DT_FLOAT)),
+        NDef("while/Merge", "Merge", {"while/Enter", "while/NextIteration"},
+             {{"T", DT_INT32}, {"N", 2}}),
+        NDef("while/Merge_1", "Merge",
+             {"while/Enter_1", "while/NextIteration_1"},
+             {{"T", DT_FLOAT}, {"N", 2}}),
+        NDef("while/Less/y", "Const", {"^while/Merge"},
+             {{"dtype", DT_INT32}, {"value", test::AsScalar<int32>(limit)}}),
+        NDef("while/Less", "Less", {"while/Merge", "while/Less/y"},
+             {{"T", DT_INT32}}),
+        NDef("while/LoopCond", "LoopCond", {"while/Less"}, {}),
+        NDef("while/Switch", "Switch", {"while/Merge", "while/LoopCond"},
+             {{"T", DT_INT32}}),
+        NDef("while/Switch_1", "Switch", {"while/Merge_1", "while/LoopCond"},
+             {{"T", DT_FLOAT}}),
+        NDef("while/Identity", "Identity", {"while/Switch:1"},
+             {{"T", DT_INT32}}),
+        NDef("while/Identity_1", "Identity", {"while/Switch_1:1"},
+             {{"T", DT_FLOAT}}),
+        NDef("while/add/y", "Const", {"^while/Identity"},
+             {{"dtype", DT_INT32}, {"value", test::AsScalar<int32>(1)}}),
+        NDef("while/add", "AddV2", {"while/Identity", "while/add/y"},
+             {{"T", DT_INT32}}),
+        NDef("while/mul/y", "Const", {"^while/Identity"},
+             {{"dtype", DT_FLOAT}, {"value", test::AsScalar<float>(2)}}),
+        NDef("while/mul", "Mul", {"while/Identity_1", "while/mul/y"},
+             {{"T", DT_FLOAT}}),
+        NDef("while/NextIteration", "NextIteration", {"while/add"},
+             {{"T", DT_INT32}}),
+        NDef("while/NextIteration_1", "NextIteration", {"while/mul"},
+             {{"T", DT_FLOAT}}),
+        NDef("while/Exit", "Exit", {"while/Switch"}, {{"T", DT_INT32}}),
+        NDef("while/Exit_1", "Exit", {"while/Switch_1"}, {{"T", DT_FLOAT}}),
+    });
+  }
+
+  // Returns a graph with a functional While loop that runs 8 iterations of
+  // `x += w * w`, starting from `x` = 0 and `w` = 3.
+  static GraphDef FunctionalCountedLoop() {
+    using test::function::NDef;
+    const std::vector<string> args = {"i: int32", "x: float", "w: float"};
+    FunctionDef cond = FunctionDefHelper::Create(
+        "Cond", args, {"pred: bool"}, {},
+        {{{"limit"},
+          "Const",
+          {},
+          {{"dtype", DT_INT32}, {"value", test::AsScalar<int32>(8)}}},
+         {{"less"}, "Less", {"i", "limit:output:0"}, {{"T", DT_INT32}}}},
+        {{"pred", "less:z:0"}});
+    FunctionDef body = FunctionDefHelper::Create(
+        "Body", args, {"i_out: int32", "x_out: float", "w_out: float"}, {},
+        {{{"one"},
+          "Const",
+          {},
+          {{"dtype", DT_INT32}, {"value", test::AsScalar<int32>(1)}}},
+         {{"next_i"}, "AddV2", {"i", "one:output:0"}, {{"T", DT_INT32}}},
+         {{"square"}, "Square", {"w"}, {{"T", DT_FLOAT}}},
+         {{"next_x"}, "AddV2", {"x", "square:y:0"}, {{"T", DT_FLOAT}}}},
+        {{"i_out", "next_i:z:0"}, {"x_out", "next_x:z:0"}, {"w_out", "w"}});
+    return test::function::GDef(
+        {NDef("i0", "Const", {},
+              {{"dtype", DT_INT32}, {"value", test::AsScalar<int32>(0)}}),
+         NDef("x0", "Const", {},
+              {{"dtype", DT_FLOAT}, {"value", test::AsScalar<float>(0)}}),
+         NDef("w0", "Const", {},
+              {{"dtype", DT_FLOAT}, {"value", test::AsScalar<float>(3)}}),
+         NDef("while", "While", {"i0", "x0", "w0"},
+              {{"T", DataTypeSlice{DT_INT32, DT_FLOAT, DT_FLOAT}},
+               {"cond", FunctionDefHelper::FunctionRef("Cond")},
+               {"body", FunctionDefHelper::FunctionRef("Body")}}),
+         NDef("out", "Identity", {"while:1"}, {{"T", DT_FLOAT}})},
+        {cond, body});
+  }
+
+  // Returns a v1 loop that reads a variable, and writes to it if `write`.
+  static GraphDef LoopReadingVariable(bool write) {
+    using test::function::NDef;
+    GraphDef graph = test::function::GDef({
+        NDef("var", "VarHandleOp", {},
+             {{"dtype", DT_FLOAT}, {"shape", TensorShape({})}}),
+        NDef("i0", "Const", {},
+             {{"dtype", DT_INT32}, {"value", test::AsScalar<int32>(0)}}),
+        NDef("enter_var", "Enter", {"var"},
+             {{"T", DT_RESOURCE},
+              {"frame_name", "while"},
+              {"is_constant", true},
+              {"parallel_iterations", 1}}),
+        NDef("enter", "Enter", {"i0"},
+             {{"T", DT_INT32},
+              {"frame_name", "while"},
+              {"is_constant", false},
+              {"parallel_iterations", 1}}),
+        NDef("merge", "Merge", {"enter", "next"}, {{"T", DT_INT32}, {"N", 2}}),
+        NDef("limit", "Const", {"^merge"},
+             {{"dtype", DT_INT32}, {"value", test::AsScalar<int32>(8)}}),
+        NDef("less", "Less", {"merge", "limit"}, {{"T", DT_INT32}}),
+        NDef("loop_cond", "LoopCond", {"less"}, {}),
+        NDef("switch", "Switch", {"merge", "loop_cond"}, {{"T", DT_INT32}}),
+        NDef("identity", "Identity", {"switch:1"}, {{"T", DT_INT32}}),
+        NDef("read", "ReadVariableOp", {"enter_var"}, {{"dtype", DT_FLOAT}}),
+        NDef("cast", "Cast", {"identity"},
+             {{"SrcT", DT_INT32}, {"DstT", DT_FLOAT}}),
+        NDef("mul", "Mul", {"read", "cast"}, {{"T", DT_FLOAT}}),
+        NDef("one", "Const", {"^identity"},
+             {{"dtype", DT_INT32}, {"value", test::AsScalar<int32>(1)}}),
+        NDef("add", "AddV2", {"identity", "one"}, {{"T", DT_INT32}}),
+        NDef("next", "NextIteration", {"add"}, {{"T", DT_INT32}}),
+        NDef("exit", "Exit", {"switch"}, {{"T", DT_INT32}}),
+    });
+    if (write) {
+      *graph.add_node() = NDef("assign", "AssignVariableOp",
+                               {"enter_var", "mul"}, {{"dtype", DT_FLOAT}});
+    }
+    return graph;
+  }
+
  private:
   void DisableAllStages(LoopOptimizer* optimizer) {
     LoopOptimizer::LoopOptimizerOptions options;
@@ -1773,5 +1913,138 @@ versions {
   EXPECT_TRUE(found);
 }
 
+TEST_F(LoopOptimizerTest, UnrollCountedLoop) {
+  GrapplerItem item;
+  item.graph = CountedLoop(8);
+  item.fetch = {"while/Exit", "while/Exit_1"};
+
+  LoopOptimizer optimizer;
+  EnableOnlyLoopUnrolling(&optimizer, 4);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  // The Identity, Const, AddV2 and Mul nodes of the body are copied three
+  // times, and the NextIteration nodes take the values of the last copy.
+  EXPECT_EQ(output.node_size(), item.graph.node_size() + 3 * 6);
+  NodeMap node_map(&output);
+  const NodeDef* add = node_map.GetNode("LoopOptimizer/unroll_2/while/add");
+  ASSERT_NE(add, nullptr);
+  EXPECT_EQ(add->input(0), "LoopOptimizer/unroll_2/while/Identity");
+  const NodeDef* identity =
+      node_map.GetNode("LoopOptimizer/unroll_2/while/Identity");
+  ASSERT_NE(identity, nullptr);
+  EXPECT_EQ(identity->input(0), "LoopOptimizer/unroll_1/while/add");
+  EXPECT_EQ(node_map.GetNode("while/NextIteration")->input(0),
+            "LoopOptimizer/unroll_3/while/add");
+  EXPECT_EQ(node_map.GetNode("while/NextIteration_1")->input(0),
+            "LoopOptimizer/unroll_3/while/mul");
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch);
+  auto tensors = EvaluateNodes(output, item.fetch);
+  ASSERT_EQ(tensors.size(), 2);
+  test::ExpectTensorEqual<int32>(tensors[0], tensors_expected[0]);
+  test::ExpectTensorEqual<float>(tensors[1], tensors_expected[1]);
+  EXPECT_EQ(tensors[1].scalar<float>()(), 256);
+}
+
+TEST_F(LoopOptimizerTest, UnrollOnlyDivisibleTripCounts) {
+  GrapplerItem item;
+  item.graph = CountedLoop(6);
+  item.fetch = {"while/Exit", "while/Exit_1"};
+
+  LoopOptimizer optimizer;
+  EnableOnlyLoopUnrolling(&optimizer, 4);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  CompareGraphs(item.graph, output);
+}
+
+TEST_F(LoopOptimizerTest, UnrollFunctionalWhile) {
+  GrapplerItem item;
+  item.graph = FunctionalCountedLoop();
+  item.fetch = {"out"};
+
+  LoopOptimizer optimizer;
+  EnableOnlyLoopUnrolling(&optimizer, 2);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  NodeMap node_map(&output);
+  const string& body =
+      node_map.GetNode("while")->attr().at("body").func().name();
+  EXPECT_EQ(body, "Body_unrolled_2");
+  const FunctionDef* unrolled = nullptr;
+  for (const FunctionDef& function : output.library().function()) {
+    if (function.signature().name() == body) unrolled = &function;
+  }
+  ASSERT_NE(unrolled, nullptr);
+  EXPECT_EQ(unrolled->node_def_size(), 8);
+  EXPECT_EQ(unrolled->ret().at("x_out"), "next_x_unroll_1:z:0");
+
+  auto tensors = EvaluateNodes(output, item.fetch);
+  ASSERT_EQ(tensors.size(), 1);
+  EXPECT_EQ(tensors[0].scalar<float>()(), 72);
+}
+
+TEST_F(LoopOptimizerTest, HoistFunctionalWhileInvariants) {
+  GrapplerItem item;
+  item.graph = FunctionalCountedLoop();
+  item.fetch = {"out"};
+
+  LoopOptimizer optimizer;
+  EnableOnlyLoopInvariantNodeMotion(&optimizer);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  // w * w is computed once in front of the loop, and fed into it as a new loop
+  // variable.
+  NodeMap node_map(&output);
+  const NodeDef* square = node_map.GetNode("LoopOptimizer/while/square");
+  ASSERT_NE(square, nullptr);
+  EXPECT_EQ(square->input(0), "w0");
+  const NodeDef* while_node = node_map.GetNode("while");
+  ASSERT_EQ(while_node->input_size(), 4);
+  EXPECT_EQ(while_node->input(3), "LoopOptimizer/while/square");
+  EXPECT_EQ(while_node->attr().at("T").list().type_size(), 4);
+  const string& body = while_node->attr().at("body").func().name();
+  for (const FunctionDef& function : output.library().function()) {
+    if (function.signature().name() != body) continue;
+    EXPECT_EQ(function.signature().input_arg_size(), 4);
+    for (const NodeDef& node : function.node_def()) {
+      EXPECT_NE(node.op(), "Square");
+    }
+  }
+
+  auto tensors = EvaluateNodes(output, item.fetch);
+  ASSERT_EQ(tensors.size(), 1);
+  EXPECT_EQ(tensors[0].scalar<float>()(), 72);
+}
+
+TEST_F(LoopOptimizerTest, HoistReadOfUnwrittenVariable) {
+  GrapplerItem item;
+  item.graph = LoopReadingVariable(/*write=*/false);
+
+  LoopOptimizer optimizer;
+  EnableOnlyLoopInvariantNodeMotion(&optimizer);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  NodeMap node_map(&output);
+  EXPECT_EQ(node_map.GetNode("read")->input(0), "var");
+}
+
+TEST_F(LoopOptimizerTest, KeepReadOfWrittenVariableInLoop) {
+  GrapplerItem item;
+  item.graph = LoopReadingVariable(/*write=*/true);
+
+  LoopOptimizer optimizer;
+  EnableOnlyLoopInvariantNodeMotion(&optimizer);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  NodeMap node_map(&output);
+  EXPECT_EQ(node_map.GetNode("read")->input(0), "enter_var");
+}
+
 }  // namespace grappler
 }  // namespace tensorflow
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/memory_optimizer.h"
 
 #include <algorithm>
+#include <map>
 #include <queue>
 #include <set>
 #include <unordered_map>
@@ -488,7 +489,8 @@ void RecomputationRewritingPass(RewriterConfig::MemOptType optimization_level,
                   node.attr().count(kRecomputeHint) > 0);
         },
         is_target);
-  } else if (optimization_level == RewriterConfig::MANUAL) {
+  } else if (optimization_level == RewriterConfig::MANUAL ||
+             optimization_level == RewriterConfig::COST_BASED_HEURISTICS) {
     recomputed_subgraphs = GetOpGroupsToRecompute(
         graph, node_map,
         [&feeds, &is_target](const NodeDef& node) {
@@ -973,15 +975,53 @@ struct MemInfo {
   int64_t memory_used;
   std::vector<MutableGraphView::InputPort> uses_left;
   double fitness;
+  // Whether to recompute the tensor for its uses left rather than swap it, and
+  // the estimated cost of doing so in nanoseconds per byte saved.
+  bool recompute = false;
+  double cost = 0;
 
   bool operator<(const MemInfo& other) const { return fitness < other.fitness; }
 };
 
+// Returns the tensors read by `node`, as "node:output".
+static std::vector<string> InputTensors(const NodeDef& node) {
+  std::vector<string> tensors;
+  for (const string& input : node.input()) {
+    if (IsControlInput(input)) continue;
+    int position;
+    const string input_node_name = ParseNodeName(input, &position);
+    tensors.push_back(strings::StrCat(input_node_name, ":", position));
+  }
+  return tensors;
+}
+
+// Returns whether the inputs of `node` are kept in memory until `use_time`
+// anyway, so that recomputing `node` for a use at that time doesn't extend the
+// lifetime of any tensor.
+static bool InputsLiveUntil(
+    const NodeDef& node, const MutableGraphView& graph,
+    const std::unordered_map<string, Costs::Duration>& deallocation_times,
+    Costs::Duration use_time) {
+  for (const string& tensor : InputTensors(node)) {
+    const NodeDef* input_node = graph.GetNode(NodeName(tensor));
+    if (input_node != nullptr && IsPersistent(*input_node)) continue;
+    auto it = deallocation_times.find(tensor);
+    if (it == deallocation_times.end() || it->second < use_time) return false;
+  }
+  return true;
+}
+
+// Picks tensors to swap out of each GPU, and if `nodes_to_recompute` is not
+// null tensors to recompute, until the estimated peak memory usage fits in
+// `memory_budget_bytes`, or in the device memory if that is smaller or the
+// budget is 0. Tensors to recompute are added to `nodes_to_recompute` as the
+// name of their node and the names of the nodes using them after the peak.
 static bool IdentifySwappingCandidates(
     Cluster* cluster, GrapplerItem* item,
     std::unique_ptr<GraphMemory>* memory_ptr,
-    std::unordered_set<string>* skip_list,
-    std::unordered_map<NodeDef*, SwapInfo>* nodes_to_swap) {
+    std::unordered_set<string>* skip_list, int64_t memory_budget_bytes,
+    std::unordered_map<NodeDef*, SwapInfo>* nodes_to_swap,
+    std::map<string, std::set<string>>* nodes_to_recompute) {
   if ((*memory_ptr) == nullptr) {
     memory_ptr->reset(new GraphMemory(*item));
     Status s = (*memory_ptr)->InferStatically(cluster->GetDevices());
@@ -993,6 +1033,15 @@ static bool IdentifySwappingCandidates(
   }
   const GraphMemory& memory = **memory_ptr;
 
+  std::unordered_set<string> cheap_to_recompute_ops;
+  std::unordered_set<string> feeds;
+  if (nodes_to_recompute != nullptr) {
+    cheap_to_recompute_ops = GetCheapToRecomputeOps();
+    for (const auto& feed : item->feed) {
+      feeds.insert(NodeName(feed.first));
+    }
+  }
+
   bool updated_graph = false;
   for (const auto& device : cluster->GetDevices()) {
     const string& name = device.first;
@@ -1000,18 +1049,25 @@ static bool IdentifySwappingCandidates(
     if (prop.type() != "GPU") {
       continue;
     }
-    if (prop.memory_size() <= 0) {
+    int64_t memory_limit = prop.memory_size();
+    if (memory_budget_bytes > 0 &&
+        (memory_limit <= 0 || memory_budget_bytes < memory_limit)) {
+      memory_limit = memory_budget_bytes;
+    }
+    if (memory_limit <= 0) {
       VLOG(1) << "Peak memory usage unknown for device " << name;
       continue;
     }
     const GraphMemory::MemoryUsage& mem_usage = memory.GetPeakMemoryUsage(name);
 
-    if (mem_usage.used_memory <= prop.memory_size()) {
+    if (mem_usage.used_memory <= memory_limit) {
       continue;
     }
-    int64_t required_savings = mem_usage.used_memory - prop.memory_size();
+    int64_t required_savings = mem_usage.used_memory - memory_limit;
 
     std::unordered_map<string, Costs::NanoSeconds> op_completion_times;
+    std::unordered_map<string, Costs::NanoSeconds> op_start_times;
+    std::unordered_map<string, Costs::NanoSeconds> op_run_times;
     {
       VirtualCluster vcluster(cluster->GetDevices());
       if (!vcluster.Provision().ok()) {
@@ -1033,15 +1089,28 @@ static bool IdentifySwappingCandidates(
               Costs::MicroSeconds(node_stats.all_start_micros() +
                                   node_stats.op_end_rel_micros());
           op_completion_times.emplace(node_stats.node_name(), exec_time);
+          op_start_times.emplace(
+              node_stats.node_name(),
+              Costs::MicroSeconds(node_stats.all_start_micros()));
+          op_run_times.emplace(
+              node_stats.node_name(),
+              Costs::MicroSeconds(node_stats.op_end_rel_micros() -
+                                  node_stats.op_start_rel_micros()));
         }
       }
     }
 
     Costs::Duration peak_time = -1;
+    // Deallocation times of the tensors live at the peak, keyed by
+    // "node:output".
+    std::unordered_map<string, Costs::Duration> deallocation_times;
     for (const auto& live_tensor : mem_usage.live_tensors) {
       if (live_tensor.allocation_time > peak_time) {
         peak_time = live_tensor.allocation_time;
       }
+      deallocation_times[strings::StrCat(live_tensor.node, ":",
+                                         live_tensor.output_id)] =
+          live_tensor.deallocation_time;
     }
 
     std::vector<MemInfo> mem_state;
@@ -1052,19 +1121,34 @@ static bool IdentifySwappingCandidates(
         // Don't bother with small tensors.
         continue;
       }
-      if (live_tensor.deallocation_time - live_tensor.allocation_time <=
-          Costs::Duration(1e6)) {
-        // Not enough time to swap.
-        VLOG(1) << "Not enough time to swap: skipping " << live_tensor.node;
-        continue;
-      }
-
       if (skip_list->find(live_tensor.node) != skip_list->end()) {
         continue;
       }
       MutableGraphView::OutputPort port =
           graph.GetOutputPort(live_tensor.node, live_tensor.output_id);
-      if (!IsSwappable(graph, port)) {
+      if (port.node == nullptr) {
+        continue;
+      }
+      bool can_swap = true;
+      if (live_tensor.deallocation_time - live_tensor.allocation_time <=
+          Costs::Duration(1e6)) {
+        // Not enough time to swap.
+        VLOG(1) << "Not enough time to swap: skipping " << live_tensor.node;
+        can_swap = false;
+      }
+      can_swap = can_swap && IsSwappable(graph, port);
+      // Only the first output of cheap ops whose value doesn't depend on
+      // anything but their inputs is recomputed, and only if it was computed
+      // before the peak.
+      bool can_recompute =
+          nodes_to_recompute != nullptr && live_tensor.output_id == 0 &&
+          live_tensor.allocation_time < peak_time &&
+          feeds.count(live_tensor.node) == 0 &&
+          (cheap_to_recompute_ops.count(port.node->op()) > 0 ||
+           port.node->attr().count(kRecomputeHint) > 0) &&
+          !IsStateful(*port.node) &&
+          op_run_times.find(live_tensor.node) != op_run_times.end();
+      if (!can_swap && !can_recompute) {
         continue;
       }
       MemInfo mem_info;
@@ -1072,6 +1156,7 @@ static bool IdentifySwappingCandidates(
       mem_info.memory_used = live_tensor.memory_used;
       Costs::Duration allocation_time = live_tensor.allocation_time;
       Costs::Duration earliest_use(Costs::Duration::infinity());
+      Costs::Duration earliest_use_start(Costs::Duration::infinity());
       bool valid = true;
       for (MutableGraphView::InputPort input : graph.GetFanout(port)) {
         // Get execution time.
@@ -1094,7 +1179,14 @@ static bool IdentifySwappingCandidates(
           valid = false;
           break;
         }
-        if (!IsSwappable(input)) {
+        can_swap = can_swap && IsSwappable(input);
+        // The recomputation is wired to the uses that name the node itself,
+        // and only saves memory for the uses that start after the peak.
+        const Costs::Duration start_time = op_start_times[input.node->name()];
+        can_recompute = can_recompute && input.port_id >= 0 &&
+                        input.node->input(input.port_id) == port.node->name() &&
+                        start_time > peak_time;
+        if (!can_swap && !can_recompute) {
           valid = false;
           break;
         }
@@ -1102,6 +1194,7 @@ static bool IdentifySwappingCandidates(
         // Set earliest use time that's after peak.
         mem_info.uses_left.emplace_back(input);
         earliest_use = std::min(earliest_use, it->second);
+        earliest_use_start = std::min(earliest_use_start, start_time);
       }
       if (valid && !mem_info.uses_left.empty()) {
         // Compute the fitness: we need the tensor to be generated way away of
@@ -1118,23 +1211,80 @@ static bool IdentifySwappingCandidates(
                 MathUtil::IPow<double>(mem_info.uses_left.size(), 2) +
             MathUtil::IPow<double>((allocation_time - peak_time).count(), 2);
         mem_info.fitness = -mem_info.fitness;
+        if (nodes_to_recompute != nullptr) {
+          // Swapping copies the tensor out and back in over PCIe, which we
+          // assume runs at 16 GBps, while recomputing runs the op again once.
+          const double swap_cost = 2.0 * mem_info.memory_used / 16;
+          const double recompute_cost =
+              op_run_times.at(live_tensor.node).count();
+          can_recompute =
+              can_recompute &&
+              InputsLiveUntil(*port.node, graph, deallocation_times,
+                              earliest_use_start);
+          if (!can_swap && !can_recompute) {
+            continue;
+          }
+          mem_info.recompute =
+              can_recompute && (!can_swap || recompute_cost < swap_cost);
+          mem_info.cost =
+              (mem_info.recompute ? recompute_cost : swap_cost) /
+              mem_info.memory_used;
+        }
         mem_state.push_back(mem_info);
       }
     }
 
-    // Sort by fitness
-    std::sort(mem_state.begin(), mem_state.end());
+    if (nodes_to_recompute == nullptr) {
+      // Sort by fitness
+      std::sort(mem_state.begin(), mem_state.end());
+    } else {
+      // Sort by cost per byte saved.
+      std::stable_sort(mem_state.begin(), mem_state.end(),
+                       [](const MemInfo& a, const MemInfo& b) {
+                         return a.cost < b.cost;
+                       });
+    }
 
+    // Tensors that are swapped or recomputed, and tensors that a
+    // recomputation reads and must therefore stay in memory.
+    std::unordered_set<string> rewritten_tensors;
+    std::unordered_set<string> pinned_tensors;
     for (const MemInfo& mem_info : mem_state) {
-      for (const MutableGraphView::InputPort fanout_to_swap :
-           mem_info.uses_left) {
-        VLOG(1) << "Will swap fanout " << fanout_to_swap.node->name() << ":"
-                << fanout_to_swap.port_id << " of tensor "
-                << mem_info.port.node->name() << ":" << mem_info.port.port_id
-                << " of size " << mem_info.memory_used;
-
-        (*nodes_to_swap)[fanout_to_swap.node].inputs_to_swap.push_back(
-            fanout_to_swap.port_id);
+      const string tensor = strings::StrCat(mem_info.port.node->name(), ":",
+                                            mem_info.port.port_id);
+      const std::vector<string> inputs = InputTensors(*mem_info.port.node);
+      if (nodes_to_recompute != nullptr) {
+        if (pinned_tensors.count(tensor) != 0) continue;
+        if (mem_info.recompute &&
+            std::any_of(inputs.begin(), inputs.end(),
+                        [&rewritten_tensors](const string& input) {
+                          return rewritten_tensors.count(input) != 0;
+                        })) {
+          continue;
+        }
+        rewritten_tensors.insert(tensor);
+      }
+      if (mem_info.recompute) {
+        VLOG(1) << "Will recompute tensor " << tensor << " of size "
+                << mem_info.memory_used << " for "
+                << mem_info.uses_left.size() << " uses";
+        std::set<string>& targets =
+            (*nodes_to_recompute)[mem_info.port.node->name()];
+        for (const MutableGraphView::InputPort& use : mem_info.uses_left) {
+          targets.insert(use.node->name());
+        }
+        pinned_tensors.insert(inputs.begin(), inputs.end());
+      } else {
+        for (const MutableGraphView::InputPort fanout_to_swap :
+             mem_info.uses_left) {
+          VLOG(1) << "Will swap fanout " << fanout_to_swap.node->name() << ":"
+                  << fanout_to_swap.port_id << " of tensor "
+                  << mem_info.port.node->name() << ":" << mem_info.port.port_id
+                  << " of size " << mem_info.memory_used;
+
+          (*nodes_to_swap)[fanout_to_swap.node].inputs_to_swap.push_back(
+              fanout_to_swap.port_id);
+        }
       }
       required_savings -= mem_info.memory_used;
       updated_graph = true;
@@ -1146,16 +1296,68 @@ static bool IdentifySwappingCandidates(
   return updated_graph;
 }
 
+// Recomputes the nodes of `nodes_to_recompute` for the nodes they are mapped
+// to, and adds the original and recomputed nodes to `skip_list`.
+static bool RecomputeNodes(
+    const std::map<string, std::set<string>>& nodes_to_recompute,
+    GraphDef* graph, std::unordered_set<string>* skip_list) {
+  if (nodes_to_recompute.empty()) {
+    return false;
+  }
+  std::vector<const NodeDef*> topo_order;
+  if (!ComputeTopologicalOrder(*graph, &topo_order).ok()) {
+    return false;
+  }
+  // Number the nodes the way RecomputationRewritingPass does. New nodes are
+  // added to the graph as we go, which keeps the existing NodeDefs in place.
+  std::unordered_map<const NodeDef*, int> topological_numbering;
+  for (int node_number = 0; node_number < topo_order.size(); ++node_number) {
+    topological_numbering[topo_order[node_number]] =
+        topo_order.size() - node_number - 1;
+  }
+  NodeMap node_map(graph);
+  bool updated_graph = false;
+  for (const auto& recompute : nodes_to_recompute) {
+    const NodeDef* node = node_map.GetNode(recompute.first);
+    std::unordered_set<NodeDef*> target_nodes;
+    for (const string& target : recompute.second) {
+      NodeDef* target_node = node_map.GetNode(target);
+      if (target_node != nullptr) target_nodes.insert(target_node);
+    }
+    if (node == nullptr || target_nodes.empty()) {
+      continue;
+    }
+    RecomputeSubgraph({node}, target_nodes, node_map, topological_numbering,
+                      graph);
+    skip_list->insert(node->name());
+    skip_list->insert(AddPrefixToNodeName(node->name(), kRecomputedNodePrefix));
+    updated_graph = true;
+  }
+  return updated_graph;
+}
+
 bool SwappingPass(RewriterConfig::MemOptType optimization_level,
-                  Cluster* cluster, std::unique_ptr<GraphMemory>* memory,
-                  GrapplerItem* item, std::unordered_set<string>* skip_list) {
+                  int64_t memory_budget_bytes, Cluster* cluster,
+                  std::unique_ptr<GraphMemory>* memory, GrapplerItem* item,
+                  std::unordered_set<string>* skip_list) {
   std::unordered_map<NodeDef*, SwapInfo> nodes_to_swap;
+  bool updated_graph = false;
   if (optimization_level == RewriterConfig::DEFAULT_MEM_OPT ||
       optimization_level == RewriterConfig::SWAPPING_HEURISTICS ||
       optimization_level == RewriterConfig::HEURISTICS) {
     // Use heuristics to figure out what needs to be swapped;
     IdentifySwappingCandidates(cluster, item, memory, skip_list,
-                               &nodes_to_swap);
+                               memory_budget_bytes, &nodes_to_swap,
+                               /*nodes_to_recompute=*/nullptr);
+  } else if (optimization_level == RewriterConfig::COST_BASED_HEURISTICS) {
+    // Use the estimated costs to figure out what needs to be swapped or
+    // recomputed. Recomputing only adds nodes to the graph, so the nodes to
+    // swap stay valid.
+    std::map<string, std::set<string>> nodes_to_recompute;
+    IdentifySwappingCandidates(cluster, item, memory, skip_list,
+                               memory_budget_bytes, &nodes_to_swap,
+                               &nodes_to_recompute);
+    updated_graph = RecomputeNodes(nodes_to_recompute, &item->graph, skip_list);
   }
   // Look for manual annotations in the graph.
   for (auto& node : *item->graph.mutable_node()) {
@@ -1174,7 +1376,7 @@ bool SwappingPass(RewriterConfig::MemOptType optimization_level,
   }
   if (nodes_to_swap.empty()) {
     // Nothing to do.
-    return false;
+    return updated_graph;
   }
 
   // Estimate the size of the data to swap for each node.
@@ -1184,7 +1386,7 @@ bool SwappingPass(RewriterConfig::MemOptType optimization_level,
                             /*aggressive_shape_inference=*/false,
                             /*include_tensor_values=*/false)
            .ok()) {
-    return false;
+    return updated_graph;
   }
   for (auto& swap : nodes_to_swap) {
     const NodeDef* node = swap.first;
@@ -1202,7 +1404,7 @@ bool SwappingPass(RewriterConfig::MemOptType optimization_level,
 
   std::unordered_map<const NodeDef*, Costs::NanoSeconds> execution_times;
   if (!EstimateEarliestExecutionTimes(*item, cluster, &execution_times).ok()) {
-    return false;
+    return updated_graph;
   }
 
   std::unordered_map<string, const NodeDef*> name_map;
@@ -1211,8 +1413,6 @@ bool SwappingPass(RewriterConfig::MemOptType optimization_level,
   }
   MutableGraphView view(&item->graph);
 
-  bool updated_graph = false;
-
   for (auto& swap : nodes_to_swap) {
     NodeDef* node = swap.first;
     const SwapInfo& swap_info = swap.second;
@@ -1386,7 +1586,8 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
   bool run_recomputation_pass =
       (optimization_level_ == RewriterConfig::RECOMPUTATION_HEURISTICS ||
        optimization_level_ == RewriterConfig::HEURISTICS ||
-       optimization_level_ == RewriterConfig::MANUAL);
+       optimization_level_ == RewriterConfig::MANUAL ||
+       optimization_level_ == RewriterConfig::COST_BASED_HEURISTICS);
   if (!run_recomputation_pass && nodes_to_relax.empty() && item.fetch.empty()) {
     return errors::Aborted("Nothing to do.");
   }
@@ -1413,7 +1614,8 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
       updated_graph = false;
       if ((optimization_level_ == RewriterConfig::DEFAULT_MEM_OPT ||
            optimization_level_ == RewriterConfig::SCHEDULING_HEURISTICS ||
-           optimization_level_ == RewriterConfig::HEURISTICS) &&
+           optimization_level_ == RewriterConfig::HEURISTICS ||
+           optimization_level_ == RewriterConfig::COST_BASED_HEURISTICS) &&
           cluster != nullptr) {
         if (SchedulingPass(cluster, &memory, &optimized_item)) {
           // Reset the inferred memory usage since the graph changed.
@@ -1426,10 +1628,11 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
       if ((optimization_level_ == RewriterConfig::DEFAULT_MEM_OPT ||
            optimization_level_ == RewriterConfig::SWAPPING_HEURISTICS ||
            optimization_level_ == RewriterConfig::HEURISTICS ||
-           optimization_level_ == RewriterConfig::MANUAL) &&
+           optimization_level_ == RewriterConfig::MANUAL ||
+           optimization_level_ == RewriterConfig::COST_BASED_HEURISTICS) &&
           cluster != nullptr) {
-        if (SwappingPass(optimization_level_, cluster, &memory, &optimized_item,
-                         &skip_list)) {
+        if (SwappingPass(optimization_level_, memory_budget_bytes_, cluster,
+                         &memory, &optimized_item, &skip_list)) {
           // Reset the inferred memory usage since the graph changed.
           memory.reset();
           updated_graph = true;
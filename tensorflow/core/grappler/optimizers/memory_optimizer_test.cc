@@ -20,6 +20,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/strings/match.h"
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/node_def.pb.h"
@@ -393,6 +394,102 @@ TEST_F(MemoryOptimizerTest, UnswappableInputs) {
 #endif
 }
 
+// Builds a graph where the activation `a` is computed early and used again
+// only by `g`, after the peak memory usage at `d`.
+GrapplerItem MakeLateUseGraph() {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output v = ops::Variable(s.WithOpName("v").WithDevice("/gpu:0"),
+                           {128, 128, 8}, DT_FLOAT);
+  Output a = ops::Square(s.WithOpName("a").WithDevice("/gpu:0"), v);
+  Output b = ops::Sqrt(s.WithOpName("b")
+                           .WithDevice("/gpu:0")
+                           .WithControlDependencies(a.op()),
+                       v);
+  Output c = ops::Exp(s.WithOpName("c").WithDevice("/gpu:0"), b);
+  Output d = ops::Mul(s.WithOpName("d").WithDevice("/gpu:0"), b, c);
+  Output e = ops::Exp(s.WithOpName("e").WithDevice("/gpu:0"), d);
+  Output g = ops::Add(s.WithOpName("g").WithDevice("/gpu:0"), a, e);
+
+  Output constant = ops::Const(s.WithOpName("constant"), 0.5f, {128, 128, 8});
+  Output init = ops::Assign(s.WithOpName("init"), v, constant);
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"g"};
+  item.init_ops = {init.name()};
+  return item;
+}
+
+TEST_F(MemoryOptimizerTest, CostBasedRecomputation) {
+  GrapplerItem item = MakeLateUseGraph();
+
+  // A GPU with fast memory, on which the whole graph runs too quickly to swap
+  // anything but recomputing `a` is cheap.
+  DeviceProperties gpu_device;
+  gpu_device.set_type("GPU");
+  gpu_device.set_frequency(1000);
+  gpu_device.set_num_cores(24);
+  gpu_device.set_bandwidth(900 * 1000 * 1000);
+  gpu_device.set_memory_size(16LL * 1024 * 1024 * 1024);
+  gpu_device.mutable_environment()->insert({"architecture", "7"});
+  std::unordered_map<string, DeviceProperties> devices;
+  devices["/job:localhost/replica:0/task:0/gpu:0"] = gpu_device;
+  VirtualCluster cluster(devices);
+
+  // The graph fits in the device memory, but not in the budget.
+  MemoryOptimizer optimizer(RewriterConfig::COST_BASED_HEURISTICS,
+                            "gradients/", /*memory_budget_bytes=*/1 << 20);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(&cluster, item, &output));
+
+  NodeMap node_map(&output);
+  const NodeDef* g = node_map.GetNode("g");
+  ASSERT_NE(g, nullptr);
+  ASSERT_EQ(2, g->input_size());
+  EXPECT_EQ("Recomputed/a", g->input(0));
+  EXPECT_EQ("e", g->input(1));
+  const NodeDef* recomputed_a = node_map.GetNode("Recomputed/a");
+  ASSERT_NE(recomputed_a, nullptr);
+  EXPECT_EQ("Square", recomputed_a->op());
+  ASSERT_EQ(2, recomputed_a->input_size());
+  EXPECT_EQ("v", recomputed_a->input(0));
+  EXPECT_EQ("^RecomputeTrigger/a", recomputed_a->input(1));
+  const NodeDef* trigger = node_map.GetNode("RecomputeTrigger/a");
+  ASSERT_NE(trigger, nullptr);
+  ASSERT_EQ(1, trigger->input_size());
+  EXPECT_EQ("^e", trigger->input(0));
+
+  // Without a budget, there is nothing to do.
+  MemoryOptimizer unbudgeted_optimizer(RewriterConfig::COST_BASED_HEURISTICS);
+  GraphDef unbudgeted_output;
+  TF_EXPECT_OK(
+      unbudgeted_optimizer.Optimize(&cluster, item, &unbudgeted_output));
+  EXPECT_EQ(nullptr, NodeMap(&unbudgeted_output).GetNode("Recomputed/a"));
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+  auto tensors_expected = EvaluateFetchNodes(item);
+  GrapplerItem optimized = item.WithGraph(std::move(output));
+  auto tensors = EvaluateFetchNodes(optimized);
+  test::ExpectTensorEqual<float>(tensors_expected[0], tensors[0]);
+#endif
+}
+
+TEST_F(MemoryOptimizerTest, CostBasedSwappingOfExpensiveOps) {
+  GrapplerItem item = MakeLateUseGraph();
+
+  // The memory of this GPU is so slow that recomputing any op costs more than
+  // swapping its output.
+  std::unique_ptr<VirtualCluster> cluster(CreateVirtualCluster());
+
+  MemoryOptimizer optimizer(RewriterConfig::COST_BASED_HEURISTICS);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(cluster.get(), item, &output));
+
+  for (const NodeDef& node : output.node()) {
+    EXPECT_FALSE(absl::StartsWith(node.name(), "Recomputed/")) << node.name();
+  }
+}
+
 TEST_F(MemoryOptimizerTest, AccumulationRewrites) {
   tensorflow::Scope s = tensorflow::Scope::NewRootScope();
   Output a = ops::RandomNormal(s.WithOpName("a").WithDevice("/cpu:0"),
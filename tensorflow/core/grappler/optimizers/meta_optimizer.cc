@@ -32,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/auto_parallel.h"
 #include "tensorflow/core/grappler/optimizers/common_subgraph_elimination.h"
 #include "tensorflow/core/grappler/optimizers/constant_folding.h"
+#include "tensorflow/core/grappler/optimizers/cost_based_placement.h"
 #include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
 #include "tensorflow/core/grappler/optimizers/debug_stripper.h"
 #include "tensorflow/core/grappler/optimizers/dependency_optimizer.h"
@@ -53,6 +54,9 @@ limitations under the License.
 #include "tensorflow/core/grappler/verifiers/structure_verifier.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/util/dump_graph.h"
 #include "tensorflow/core/util/ptr_util.h"
 #include "tensorflow/core/util/util.h"
@@ -96,10 +100,18 @@ int NumIterations(const RewriterConfig& cfg) {
 // Check if optimizer is allowed to run only once.
 bool IsRunOnceOptimizer(const string& name) {
   return name == "layout" || name == "memory_optimizer" ||
-         name == "loop_optimizer" ||
+         name == "cost_based_placement" || name == "loop_optimizer" ||
          absl::StartsWith(name, "auto_mixed_precision");
 }
 
+// Check if optimizer mostly cleans up after other optimizers, and is among the
+// first to skip once the budget of the meta optimizer is spent.
+bool IsLowValueOptimizer(const string& name) {
+  return name == "common_subgraph_elimination" ||
+         name == "dependency_optimizer" || name == "loop_optimizer" ||
+         name == "shape_optimizer";
+}
+
 // Creates a function library stub from a real function library: copy only
 // signatures and attributes of all the function defined in fdef_lib. This stub
 // can be swapped with real function library in a graph, before passing it to
@@ -123,6 +135,11 @@ uint64 DeadlineMicroSeconds(const RewriterConfig& cfg) {
   return Env::Default()->NowMicros() + cfg.meta_optimizer_timeout_ms() * 1000;
 }
 
+uint64 BudgetMicroSeconds(const RewriterConfig& cfg) {
+  if (cfg.meta_optimizer_budget_ms() <= 0) return 0;  // no budget
+  return Env::Default()->NowMicros() + cfg.meta_optimizer_budget_ms() * 1000;
+}
+
 // A helper function to decide whether to enable the automatic mixed precision
 // optimizer.
 bool AutoMixedPrecisionEnabled(RewriterConfig::Toggle opt_level) {
@@ -227,6 +244,8 @@ std::unique_ptr<GraphOptimizer> MetaOptimizer::MakeNewOptimizer(
 #endif
   MK_OPT("auto_mixed_precision_cpu", "auto_mixed_precision_cpu",
          new AutoMixedPrecision(AutoMixedPrecisionMode::CPU));
+  MK_OPT("auto_mixed_precision_cpu_bf16", "auto_mixed_precision_cpu_bf16",
+         new AutoMixedPrecision(AutoMixedPrecisionMode::CPU_BF16));
   MK_OPT("memory", "memory_optimization",
          new MemoryOptimizer(RewriterConfig::MANUAL));
   MK_OPT("common_subgraph_elimination", "common_subgraph_elimination",
@@ -236,7 +255,8 @@ std::unique_ptr<GraphOptimizer> MetaOptimizer::MakeNewOptimizer(
   MK_OPT("autoparallel", "auto_parallel",
          new AutoParallel(cfg_.auto_parallel().num_replicas()));
   MK_OPT("loop", "loop_optimization",
-         new LoopOptimizer(cfg_.loop_optimization(), cpu_device_));
+         new LoopOptimizer(cfg_.loop_optimization(), cpu_device_,
+                           cfg_.loop_unroll_factor()));
   MK_OPT("dependency", "dependency_optimization",
          new DependencyOptimizer(cfg_.dependency_optimization()));
   MK_OPT("debug_stripper", "debug_stripper", new DebugStripper());
@@ -245,6 +265,8 @@ std::unique_ptr<GraphOptimizer> MetaOptimizer::MakeNewOptimizer(
                                       cfg_.scoped_allocator_opts()));
   MK_OPT("pin_to_host", "pin_to_host_optimization",
          new PinToHostOptimizer(cfg_.pin_to_host_optimization()));
+  MK_OPT("cost_based_placement", "cost_based_placement",
+         new CostBasedPlacementOptimizer(cfg_.cost_based_placement()));
 
   return std::unique_ptr<GraphOptimizer>();
 }
@@ -375,11 +397,19 @@ Status MetaOptimizer::InitializeOptimizers(
     optimizers->push_back(
         MakeUnique<AutoMixedPrecision>(AutoMixedPrecisionMode::CPU));
   }
+  if (AutoMixedPrecisionEnabled(cfg_.auto_mixed_precision_cpu_bf16()) &&
+      AutoMixedPrecisionEnabled(
+          plugin_configs.toggle_config["auto_mixed_precision_cpu_bf16"])) {
+    optimizers->push_back(
+        MakeUnique<AutoMixedPrecision>(AutoMixedPrecisionMode::CPU_BF16));
+  }
   if (BOTH_ARE_ON(pin_to_host_optimization))
     optimizers->push_back(MakeUnique<PinToHostOptimizer>());
   else if (BOTH_ARE_EXPERIMENTAL_MLIR(pin_to_host_optimization) ||
            BOTH_ARE_EXPERIMENTAL_BOTH(pin_to_host_optimization))
     VLOG(2) << "pin_to_host_optimization is not implemented in TFG yet";
+  if (BOTH_ARE_ON(cost_based_placement))
+    optimizers->push_back(MakeUnique<CostBasedPlacementOptimizer>());
   if (BOTH_NOT_OFF(arithmetic_optimization)) {
     if (USER_IS_EXPERIMENTAL_MLIR(arithmetic_optimization) ||
         USER_IS_EXPERIMENTAL_BOTH(arithmetic_optimization)) {
@@ -415,7 +445,8 @@ Status MetaOptimizer::InitializeOptimizers(
       VLOG(2) << "loop_optimization is not implemented in TFG yet";
     } else {
       optimizers->push_back(
-          MakeUnique<LoopOptimizer>(cfg_.loop_optimization(), cpu_device_));
+          MakeUnique<LoopOptimizer>(cfg_.loop_optimization(), cpu_device_,
+                                    cfg_.loop_unroll_factor()));
     }
   }
   if (BOTH_NOT_OFF(dependency_optimization)) {
@@ -430,15 +461,13 @@ Status MetaOptimizer::InitializeOptimizers(
   if (MemoryOptimizerEnabled(cfg_.memory_optimization(),
                              xla_auto_clustering_on_) &&
       PLUGIN_NOT_OFF(memory_optimization)) {
-    if (cfg_.memory_optimizer_target_node_name_scope().empty()) {
-      optimizers->push_back(
-          // Use the default target node name prefix "gradients/"
-          MakeUnique<MemoryOptimizer>(cfg_.memory_optimization()));
-    } else {
-      optimizers->push_back(MakeUnique<MemoryOptimizer>(
-          cfg_.memory_optimization(),
-          cfg_.memory_optimizer_target_node_name_scope()));
-    }
+    optimizers->push_back(MakeUnique<MemoryOptimizer>(
+        cfg_.memory_optimization(),
+        // Use the default target node name prefix "gradients/"
+        cfg_.memory_optimizer_target_node_name_scope().empty()
+            ? "gradients/"
+            : cfg_.memory_optimizer_target_node_name_scope(),
+        cfg_.memory_optimizer_budget_bytes()));
   }
   if (cfg_.auto_parallel().enable() && PLUGIN_IS_ON(auto_parallel)) {
     optimizers->push_back(
@@ -592,6 +621,7 @@ void MetaOptimizer::PrintUserAndPluginConfigs(
     PRINT_CFG(constant_folding)
     PRINT_CFG(shape_optimization)
     PRINT_CFG(pin_to_host_optimization)
+    PRINT_CFG(cost_based_placement)
     PRINT_CFG(layout_optimizer)
     PRINT_CFG(remapping)
     PRINT_CFG(loop_optimization)
@@ -610,6 +640,10 @@ void MetaOptimizer::PrintUserAndPluginConfigs(
         AutoMixedPrecisionEnabled(cfg_.auto_mixed_precision_cpu())
             ? RewriterConfig::ON
             : RewriterConfig::OFF;
+    user_cfg.toggle_config["auto_mixed_precision_cpu_bf16"] =
+        AutoMixedPrecisionEnabled(cfg_.auto_mixed_precision_cpu_bf16())
+            ? RewriterConfig::ON
+            : RewriterConfig::OFF;
     user_cfg.toggle_config["memory_optimization"] =
         MemoryOptimizerEnabled(cfg_.memory_optimization(),
                                config_proto_.graph_options()
@@ -638,7 +672,10 @@ void MetaOptimizer::PrintUserAndPluginConfigs(
       PRINT_CFG("auto_mixed_precision", "auto_mixed_precision")
       PRINT_CFG("auto_mixed_precision_mkl", "auto_mixed_precision_mkl")
       PRINT_CFG("auto_mixed_precision_cpu", "auto_mixed_precision_cpu")
+      PRINT_CFG("auto_mixed_precision_cpu_bf16",
+                "auto_mixed_precision_cpu_bf16")
       PRINT_CFG("pin_to_host", "pin_to_host_optimization")
+      PRINT_CFG("cost_based_placement", "cost_based_placement")
       PRINT_CFG("layout", "layout_optimizer")
       PRINT_CFG("remap", "remapping")
       PRINT_CFG("loop", "loop_optimization")
@@ -678,7 +715,9 @@ void MetaOptimizer::PrintUserAndPluginConfigs(
         pair.first == "auto_mixed_precision" ||
         pair.first == "auto_mixed_precision_mkl" ||
         pair.first == "auto_mixed_precision_cpu" ||
+        pair.first == "auto_mixed_precision_cpu_bf16" ||
         pair.first == "pin_to_host_optimization" ||
+        pair.first == "cost_based_placement" ||
         pair.first == "scoped_allocator_optimization") {
       // These optimizers are turned off by default.
       strings::StrAppend(
@@ -699,8 +738,9 @@ void MetaOptimizer::PrintUserAndPluginConfigs(
   LOG(WARNING) << logs;
 }
 
-Status MetaOptimizer::OptimizeGraph(Cluster* cluster, GrapplerItem&& item,
-                                    GraphDef* optimized_graph) {
+Status MetaOptimizer::OptimizeGraph(
+    Cluster* cluster, GrapplerItem&& item, GraphDef* optimized_graph,
+    std::vector<GraphOptimizationResult>* optimization_results) {
   int min_graph_nodes = cfg_.min_graph_nodes() == 0 ? kDefaultMinGraphNodes
                                                     : cfg_.min_graph_nodes();
   if (item.graph.node_size() < min_graph_nodes) {
@@ -761,6 +801,15 @@ Status MetaOptimizer::OptimizeGraph(Cluster* cluster, GrapplerItem&& item,
   GraphOptimizer* sa_optimizer = nullptr;
 #endif
 
+  // Once the budget is spent, no new iteration starts, and the remaining
+  // optimizers of the current one run only if they are worth it: they are not
+  // low value, and they changed the graph the last time they ran.
+  const uint64 budget_usec = BudgetMicroSeconds(cfg_);
+  auto over_budget = [budget_usec]() {
+    return budget_usec > 0 && Env::Default()->NowMicros() > budget_usec;
+  };
+  absl::flat_hash_set<string> unproductive_optimizers;
+
   // Constants in the graph are normally compressed after model_pruner.
   // Do it here if model pruner is disabled.
   if (cfg_.disable_model_pruning()) {
@@ -775,6 +824,12 @@ Status MetaOptimizer::OptimizeGraph(Cluster* cluster, GrapplerItem&& item,
               << "  < " << min_graph_nodes << ")";
       break;
     }
+    if (iteration > 0 && over_budget()) {
+      VLOG(1) << "Stopping after iteration " << iteration
+              << ", the budget of " << cfg_.meta_optimizer_budget_ms()
+              << "ms is spent";
+      break;
+    }
 
     VLOG(4) << "Starting optimization iteration " << iteration;
     if (VLOG_IS_ON(4)) {
@@ -796,8 +851,22 @@ Status MetaOptimizer::OptimizeGraph(Cluster* cluster, GrapplerItem&& item,
       }
 #endif
 
+      if (over_budget() &&
+          (IsLowValueOptimizer(optimizer->name()) ||
+           unproductive_optimizers.contains(optimizer->name()))) {
+        VLOG(1) << "Skipping " << optimizer->name()
+                << ", the budget of " << cfg_.meta_optimizer_budget_ms()
+                << "ms is spent";
+        continue;
+      }
+
       TF_RETURN_IF_ERROR(RunOptimizer(optimizer.get(), cluster, &item,
                                       optimized_graph, &optimization_result));
+      if (optimization_result.results.back().changed_graph) {
+        unproductive_optimizers.erase(optimizer->name());
+      } else {
+        unproductive_optimizers.insert(optimizer->name());
+      }
 
       if (iteration == 0 && optimizer->name() == "model_pruner") {
         CompressConstants(optimized_graph);
@@ -842,7 +911,7 @@ Status MetaOptimizer::OptimizeGraph(Cluster* cluster, GrapplerItem&& item,
                                    }) != optimization_result.results.end();
 
   // Record graph optimization result.
-  optimization_results_.push_back(optimization_result);
+  optimization_results->push_back(optimization_result);
 
   if (is_optimized) {
     TF_RETURN_IF_ERROR(TopologicalSort(optimized_graph));
@@ -885,6 +954,7 @@ Status MetaOptimizer::RunOptimizer(
   timings.ReportAndStop();
 
   string message;
+  const bool changed_graph = status.ok();
   if (!status.ok()) {
     *optimized_graph = std::move(optimized_item->graph);
     if (errors::IsAborted(status)) {
@@ -915,7 +985,8 @@ Status MetaOptimizer::RunOptimizer(
         optimized_graph_function_library.release());
   }
 
-  OptimizerResult optimizer_result{optimizer->name(), message, status};
+  OptimizerResult optimizer_result{optimizer->name(), message, status,
+                                   changed_graph};
   optimization_result->results.push_back(optimizer_result);
 
   if (!status.ok() && cfg_.fail_on_optimizer_errors()) return status;
@@ -989,6 +1060,20 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
   VLOG(1) << "Starting optimization for grappler item: " << item.id;
   optimization_results_.clear();
 
+  // Reuse the result of optimizing the same item with the same config.
+  const bool use_cache =
+      cfg_.experimental_optimized_graph_cache() == RewriterConfig::ON ||
+      !cfg_.experimental_optimized_graph_cache_dir().empty();
+  OptimizedGraphKey cache_key;
+  if (use_cache) {
+    cache_key = ComputeOptimizedGraphKey(item, config_proto_, cluster);
+    if (LookupOptimizedGraph(cache_key, optimized_graph)) {
+      VLOG(1) << "Found optimized graph for grappler item " << item.id
+              << " in the cache: " << cache_key.ToString();
+      return Status::OK();
+    }
+  }
+
   // Constructs a FunctionLibraryDefinition with functions that are reachable
   // from the nodes of the graph.
   const auto minimized_flib =
@@ -1017,7 +1102,8 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
   const auto producer = item.graph.versions().producer();
 
   // 1. Optimize main graph
-  TF_RETURN_IF_ERROR(OptimizeGraph(cluster, std::move(item), optimized_graph));
+  TF_RETURN_IF_ERROR(OptimizeGraph(cluster, std::move(item), optimized_graph,
+                                   &optimization_results_));
   VLOG(1) << "Optimized main graph.";
   GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
 
@@ -1092,11 +1178,112 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
   // Propagate `_tf_data_function` attributes from functions to their callees.
   PropagateTFDataAttrs(flib, *optimized_graph->mutable_library());
 
+  // Optimizes the body of `func` against `flib` into `func_item` and
+  // `optimized_func_graph`, appending the results of the optimizers to
+  // `optimization_results`.
+  const auto optimize_function =
+      [&](const FunctionDef& func, const FunctionLibraryDefinition& flib,
+          GrapplerFunctionItem* func_item, GraphDef* optimized_func_graph,
+          std::vector<GraphOptimizationResult>* optimization_results)
+      -> Status {
+    GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
+    const uint64 start_us = Env::Default()->NowMicros();
+    const string& func_name = func.signature().name();
+
+    // Make a GrapplerItem from a FunctionDef.
+    TF_RETURN_IF_ERROR(
+        MakeGrapplerFunctionItem(func, flib, producer, func_item));
+
+    // If we need to compute the gradient of optimized function at runtime, we
+    // can't perform non-differentiable rewrites.
+    func_item->optimization_options().allow_non_differentiable_rewrites =
+        !differentiable_functions.contains(func_name);
+
+    // Device set available to the function is defined only by the runtime,
+    // when we instantiate and execute the function. We can't use all devices
+    // available to the main graph, because after partitioning the function
+    // call node might execute on a remote worker.
+    if (!func_item->devices().empty()) {
+      return errors::Internal("GrapplerFunctionItem devices must be empty.");
+    }
+
+    // We are not allowed to prune certain types of ops from the graph
+    // instantiated by the function definition, because we must guarantee
+    // function execution semantics wrt side effects (see
+    // function_optimizer.cc).
+    func_item->optimization_options().allow_pruning_stateful_and_dataset_ops =
+        false;
+
+    // Optimize function body graph.
+    if (IsTPUGraphDef(*optimized_graph)) {
+      // Skip optimizing functions if this is a TPU graph. Currently, Grappler
+      // passes do not handle TPU functions correctly in a variety of ways
+      // (Note that due to the pre-placement TPU graph rewriting passes, the
+      // TPU-related ops are encapsulated away into functions). For example,
+      // TPU graphs contain TPUReplicateMetadata node that carries relevant
+      // TPU metadata and Grappler passes could prune that away. Grappler
+      // passes could also cause issues around shape inference. Since the
+      // desired and existing behavior is to not optimize TPU functions with
+      // Grappler, this check preserves that. The only exception is
+      // implementation selector what is required to swap in some TPU specific
+      // lowering code and is verified the work correctly on TPUs.
+      ImplementationSelector implementation_selector;
+
+      // Implementation selector needs to have access to valid function
+      // signature and attributes, and it doesn't need actual function body.
+      std::unique_ptr<FunctionDefLibrary> func_item_function_library(
+          func_item->graph.release_library());
+      *func_item->graph.mutable_library() =
+          GetFunctionDefLibraryStub(*func_item_function_library);
+
+      TF_RETURN_IF_ERROR(implementation_selector.Optimize(
+          cluster, *func_item, optimized_func_graph));
+    } else {
+      GrapplerFunctionItem func_item_copy = *func_item;
+      TF_RETURN_IF_ERROR(OptimizeGraph(cluster, std::move(func_item_copy),
+                                       optimized_func_graph,
+                                       optimization_results));
+    }
+    metrics::UpdateFunctionOptimizationTime(Env::Default()->NowMicros() -
+                                            start_us);
+    return Status::OK();
+  };
+
+  // Replaces `func_name` in `flib` with the optimized function body.
+  const auto replace_function =
+      [&](const string& func_name, FunctionLibraryDefinition* flib,
+          GrapplerFunctionItem* func_item,
+          GraphDef* optimized_func_graph) -> Status {
+    // Function body optimization might have created new specialized
+    // functions for each instantiation context. Add them to the library.
+    for (const FunctionDef& func_def :
+         optimized_func_graph->library().function()) {
+      if (flib->Find(func_def.signature().name()) == nullptr) {
+        TF_RETURN_IF_ERROR(flib->AddFunctionDef(func_def));
+      }
+    }
+
+    // Convert optimized graph back to FunctionDef.
+    FunctionDef optimized_func;
+    func_item->SwapFunctionBody(std::move(*optimized_func_graph));
+    TF_RETURN_IF_ERROR(MakeFunctionDef(*func_item, *flib, &optimized_func));
+
+    // Replace optimized function with a new FunctionDef.
+    return flib->ReplaceFunction(func_name, optimized_func);
+  };
+
+  tensorflow::metrics::ScopedCounter<2> function_timings(
+      tensorflow::metrics::GetGraphOptimizationCounter(),
+      {kGrapplerCategory, "OptimizeFunctionLibrary"});
+  const int num_threads = cfg_.experimental_function_optimization_threads();
+
   // Optimize each function only once.
   absl::flat_hash_set<string> optimized_funcs;
   while (optimize_function_library) {
     optimize_function_library = false;
 
+    // Functions of this pass to optimize concurrently, in library order.
+    std::vector<const FunctionDef*> parallel_funcs;
     int function_idx = 0;
     for (const FunctionDef& func : optimized_graph->library().function()) {
       GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
@@ -1129,78 +1316,56 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
       optimize_function_library = true;
       optimized_funcs.insert(func_name);
 
-      // Make a GrapplerItem from a FunctionDef.
-      GrapplerFunctionItem func_item;
-      TF_RETURN_IF_ERROR(
-          MakeGrapplerFunctionItem(func, flib, producer, &func_item));
-
-      // If we need to compute the gradient of optimized function at runtime, we
-      // can't perform non-differentiable rewrites.
-      func_item.optimization_options().allow_non_differentiable_rewrites =
-          !differentiable_functions.contains(func_name);
-
-      // Device set available to the function is defined only by the runtime,
-      // when we instantiate and execute the function. We can't use all devices
-      // available to the main graph, because after partitioning the function
-      // call node might execute on a remote worker.
-      if (!func_item.devices().empty()) {
-        return errors::Internal("GrapplerFunctionItem devices must be empty.");
+      if (num_threads > 0) {
+        parallel_funcs.push_back(&func);
+        continue;
       }
-
-      // We are not allowed to prune certain types of ops from the graph
-      // instantiated by the function definition, because we must guarantee
-      // function execution semantics wrt side effects (see
-      // function_optimizer.cc).
-      func_item.optimization_options().allow_pruning_stateful_and_dataset_ops =
-          false;
-
-      // Optimize function body graph.
+      GrapplerFunctionItem func_item;
       GraphDef optimized_func_graph;
-      if (IsTPUGraphDef(*optimized_graph)) {
-        // Skip optimizing functions if this is a TPU graph. Currently, Grappler
-        // passes do not handle TPU functions correctly in a variety of ways
-        // (Note that due to the pre-placement TPU graph rewriting passes, the
-        // TPU-related ops are encapsulated away into functions). For example,
-        // TPU graphs contain TPUReplicateMetadata node that carries relevant
-        // TPU metadata and Grappler passes could prune that away. Grappler
-        // passes could also cause issues around shape inference. Since the
-        // desired and existing behavior is to not optimize TPU functions with
-        // Grappler, this check preserves that. The only exception is
-        // implementation selector what is required to swap in some TPU specific
-        // lowering code and is verified the work correctly on TPUs.
-        ImplementationSelector implementation_selector;
-
-        // Implementation selector needs to have access to valid function
-        // signature and attributes, and it doesn't need actual function body.
-        std::unique_ptr<FunctionDefLibrary> func_item_function_library(
-            func_item.graph.release_library());
-        *func_item.graph.mutable_library() =
-            GetFunctionDefLibraryStub(*func_item_function_library);
-
-        TF_RETURN_IF_ERROR(implementation_selector.Optimize(
-            cluster, func_item, &optimized_func_graph));
+      TF_RETURN_IF_ERROR(optimize_function(func, flib, &func_item,
+                                           &optimized_func_graph,
+                                           &optimization_results_));
+      TF_RETURN_IF_ERROR(replace_function(func_name, &flib, &func_item,
+                                          &optimized_func_graph));
+    }
+
+    if (!parallel_funcs.empty()) {
+      // All the bodies are optimized against the library as it was at the
+      // start of the pass, and the library is only updated once they are all
+      // done, in library order.
+      const int num_funcs = parallel_funcs.size();
+      std::vector<GrapplerFunctionItem> func_items(num_funcs);
+      std::vector<GraphDef> optimized_func_graphs(num_funcs);
+      std::vector<std::vector<GraphOptimizationResult>> func_results(num_funcs);
+      std::vector<Status> func_statuses(num_funcs);
+      const auto optimize_parallel_function = [&](int i) {
+        func_statuses[i] =
+            optimize_function(*parallel_funcs[i], flib, &func_items[i],
+                              &optimized_func_graphs[i], &func_results[i]);
+      };
+      if (num_threads == 1 || num_funcs == 1) {
+        for (int i = 0; i < num_funcs; ++i) optimize_parallel_function(i);
       } else {
-        GrapplerFunctionItem func_item_copy = func_item;
-        TF_RETURN_IF_ERROR(OptimizeGraph(cluster, std::move(func_item_copy),
-                                         &optimized_func_graph));
+        thread::ThreadPool pool(Env::Default(), "grappler_function_optimizer",
+                                std::min(num_threads, num_funcs));
+        BlockingCounter counter(num_funcs);
+        for (int i = 0; i < num_funcs; ++i) {
+          pool.Schedule([&, i]() {
+            optimize_parallel_function(i);
+            counter.DecrementCount();
+          });
+        }
+        counter.Wait();
       }
-
-      // Function body optimization might have created new specialized
-      // functions for each instantiation context. Add them to the library.
-      for (const FunctionDef& func_def :
-           optimized_func_graph.library().function()) {
-        if (flib.Find(func_def.signature().name()) == nullptr) {
-          TF_RETURN_IF_ERROR(flib.AddFunctionDef(func_def));
+      for (int i = 0; i < num_funcs; ++i) {
+        TF_RETURN_IF_ERROR(func_statuses[i]);
+        for (GraphOptimizationResult& result : func_results[i]) {
+          optimization_results_.push_back(std::move(result));
         }
+        TF_RETURN_IF_ERROR(
+            replace_function(parallel_funcs[i]->signature().name(), &flib,
+                             &func_items[i], &optimized_func_graphs[i]));
       }
-
-      // Convert optimized graph back to FunctionDef.
-      FunctionDef optimized_func;
-      func_item.SwapFunctionBody(std::move(optimized_func_graph));
-      TF_RETURN_IF_ERROR(MakeFunctionDef(func_item, flib, &optimized_func));
-
-      // Replace optimized function with a new FunctionDef.
-      TF_RETURN_IF_ERROR(flib.ReplaceFunction(func_name, optimized_func));
     }
 
     // If optimized at least one function, update the graph library.
@@ -1208,9 +1373,11 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
       *optimized_graph->mutable_library() = flib.ToProto();
     }
   }
+  function_timings.ReportAndStop();
 
   VLOG(1) << "Optimized " << optimized_funcs.size()
           << " functions: " << absl::StrJoin(optimized_funcs, ", ");
+  if (use_cache) CacheOptimizedGraph(cache_key, *optimized_graph);
   VLOG(3) << "Optimized graph =\n" << optimized_graph->DebugString();
   if (VLOG_IS_ON(1)) {
     DumpGraphDefToFile(
@@ -1222,6 +1389,39 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
   return Status::OK();
 }
 
+bool MetaOptimizer::LookupOptimizedGraph(const OptimizedGraphKey& key,
+                                         GraphDef* optimized_graph) const {
+  OptimizedGraphCache* cache =
+      cfg_.experimental_optimized_graph_cache() == RewriterConfig::ON
+          ? OptimizedGraphCache::Global()
+          : nullptr;
+  if (cache != nullptr && cache->Lookup(key, optimized_graph)) return true;
+  const string& dir = cfg_.experimental_optimized_graph_cache_dir();
+  if (dir.empty()) return false;
+  Status s = ReadOptimizedGraph(dir, key, optimized_graph);
+  if (!s.ok()) {
+    if (!errors::IsNotFound(s)) {
+      LOG(WARNING) << "Ignoring the cached optimized graph: " << s;
+    }
+    return false;
+  }
+  if (cache != nullptr) cache->Insert(key, *optimized_graph);
+  return true;
+}
+
+void MetaOptimizer::CacheOptimizedGraph(const OptimizedGraphKey& key,
+                                        const GraphDef& optimized_graph) const {
+  if (cfg_.experimental_optimized_graph_cache() == RewriterConfig::ON) {
+    OptimizedGraphCache::Global()->Insert(key, optimized_graph);
+  }
+  const string& dir = cfg_.experimental_optimized_graph_cache_dir();
+  if (dir.empty()) return;
+  Status s = WriteOptimizedGraph(dir, key, optimized_graph);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to write the optimized graph to the cache: " << s;
+  }
+}
+
 string MetaOptimizer::GetResultString() const {
   std::string result_string;
   for (const GraphOptimizationResult& graph_result : optimization_results_) {
@@ -1260,9 +1460,12 @@ bool MetaOptimizerEnabled(const ConfigProto& cfg) {
          rewrite_cfg.scoped_allocator_optimization() == RewriterConfig::ON ||
 #endif
          rewrite_cfg.pin_to_host_optimization() == RewriterConfig::ON ||
+         rewrite_cfg.cost_based_placement() == RewriterConfig::ON ||
          AutoMixedPrecisionEnabled(rewrite_cfg.auto_mixed_precision()) ||
          AutoMixedPrecisionEnabled(rewrite_cfg.auto_mixed_precision_mkl()) ||
          AutoMixedPrecisionEnabled(rewrite_cfg.auto_mixed_precision_cpu()) ||
+         AutoMixedPrecisionEnabled(
+             rewrite_cfg.auto_mixed_precision_cpu_bf16()) ||
          !rewrite_cfg.optimizers().empty() ||
          !rewrite_cfg.custom_optimizers().empty();
 }
@@ -0,0 +1,251 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/meta_optimizer_cache.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_set.h"
+#include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/public/version.h"
+
+namespace tensorflow {
+namespace grappler {
+
+namespace {
+
+// Identifies the format of the cache files and the build that wrote them.
+// Files written by other versions are never read, as their keys differ.
+constexpr char kFileMagic[] = "TFOptimizedGraph1";
+
+// Appends `value` to `data`, prefixed by its length so that the
+// concatenation of fields is unambiguous.
+void AppendField(absl::string_view value, string* data) {
+  absl::StrAppend(data, value.size(), ":", value, ";");
+}
+
+void AppendProto(const protobuf::MessageLite& proto, string* data) {
+  string serialized;
+  SerializeToStringDeterministic(proto, &serialized);
+  AppendField(serialized, data);
+}
+
+void AppendSorted(std::vector<string> values, string* data) {
+  std::sort(values.begin(), values.end());
+  AppendField(absl::StrCat(values.size()), data);
+  for (const string& value : values) AppendField(value, data);
+}
+
+string CacheFileName(const string& dir, const OptimizedGraphKey& key) {
+  return io::JoinPath(dir, absl::StrCat(key.ToString(), ".graph"));
+}
+
+string FileHeader(const OptimizedGraphKey& key, absl::string_view payload) {
+  return absl::StrCat(kFileMagic, " ", TF_VERSION_STRING, "\n",
+                      key.ToString(), " ", key.size, "\n",
+                      absl::Hex(Fingerprint64(payload), absl::kZeroPad16), " ",
+                      payload.size(), "\n");
+}
+
+}  // namespace
+
+string OptimizedGraphKey::ToString() const {
+  return absl::StrCat(absl::Hex(fingerprint.high64, absl::kZeroPad16),
+                      absl::Hex(fingerprint.low64, absl::kZeroPad16));
+}
+
+OptimizedGraphKey ComputeOptimizedGraphKey(const GrapplerItem& item,
+                                           const ConfigProto& config,
+                                           const Cluster* cluster) {
+  string data;
+  AppendField(TF_VERSION_STRING, &data);
+  AppendField(absl::StrCat(TF_GRAPH_DEF_VERSION), &data);
+
+  ConfigProto uncached_config = config;
+  RewriterConfig* rewriter_config =
+      uncached_config.mutable_graph_options()->mutable_rewrite_options();
+  rewriter_config->clear_experimental_optimized_graph_cache();
+  rewriter_config->clear_experimental_optimized_graph_cache_dir();
+  AppendProto(uncached_config, &data);
+  AppendSorted(CustomGraphOptimizerRegistry::GetRegisteredOptimizers(), &data);
+
+  AppendField(item.id, &data);
+  std::vector<string> feeds;
+  for (const auto& feed : item.feed) {
+    feeds.push_back(absl::StrCat(feed.first, ":", feed.second.dtype(), ":",
+                                 feed.second.shape().DebugString()));
+  }
+  AppendSorted(std::move(feeds), &data);
+  AppendSorted(item.fetch, &data);
+  AppendSorted(item.init_ops, &data);
+  AppendSorted(item.keep_ops, &data);
+  AppendField(item.save_op, &data);
+  AppendField(item.restore_op, &data);
+  AppendField(item.save_restore_loc_tensor, &data);
+  for (const QueueRunnerDef& queue_runner : item.queue_runners) {
+    AppendProto(queue_runner, &data);
+  }
+  const GrapplerItem::OptimizationOptions& options =
+      item.optimization_options();
+  for (bool option : {options.allow_non_differentiable_rewrites,
+                      options.allow_pruning_stateful_and_dataset_ops,
+                      options.optimize_function_library,
+                      options.is_eager_mode}) {
+    AppendField(option ? "1" : "0", &data);
+  }
+  AppendSorted({item.devices().begin(), item.devices().end()}, &data);
+
+  if (cluster != nullptr) {
+    std::vector<string> devices;
+    for (const auto& device : cluster->GetDevices()) {
+      devices.push_back(absl::StrCat(
+          device.first, ":", DeterministicProtoHash64(device.second)));
+    }
+    AppendSorted(std::move(devices), &data);
+    std::vector<string> device_set;
+    if (cluster->GetDeviceSet() != nullptr) {
+      for (const Device* device : cluster->GetDeviceSet()->devices()) {
+        device_set.push_back(device->name());
+      }
+    }
+    AppendSorted(std::move(device_set), &data);
+  }
+
+  // The graph goes last, as it is usually most of the key.
+  AppendProto(item.graph, &data);
+
+  OptimizedGraphKey key;
+  key.fingerprint = Fingerprint128(data);
+  key.size = data.size();
+  return key;
+}
+
+OptimizedGraphCache* OptimizedGraphCache::Global() {
+  static OptimizedGraphCache* cache = new OptimizedGraphCache();
+  return cache;
+}
+
+bool OptimizedGraphCache::Lookup(const OptimizedGraphKey& key,
+                                 GraphDef* graph) {
+  std::shared_ptr<const GraphDef> cached;
+  {
+    mutex_lock l(mu_);
+    auto it = entries_.find(key.fingerprint);
+    if (it == entries_.end() || !(it->second->key == key)) return false;
+    lru_.splice(lru_.begin(), lru_, it->second);
+    cached = it->second->graph;
+  }
+  // Copy outside of the lock, as large graphs take a while to copy.
+  *graph = *cached;
+  return true;
+}
+
+void OptimizedGraphCache::Insert(const OptimizedGraphKey& key,
+                                 const GraphDef& graph) {
+  const int64_t bytes = graph.ByteSizeLong();
+  if (bytes > max_bytes_) return;
+  auto cached = std::make_shared<const GraphDef>(graph);
+
+  mutex_lock l(mu_);
+  auto it = entries_.find(key.fingerprint);
+  if (it != entries_.end()) {
+    size_bytes_ -= it->second->bytes;
+    lru_.erase(it->second);
+    entries_.erase(it);
+  }
+  lru_.push_front({key, std::move(cached), bytes});
+  entries_[key.fingerprint] = lru_.begin();
+  size_bytes_ += bytes;
+  while (size_bytes_ > max_bytes_) {
+    const Entry& last = lru_.back();
+    size_bytes_ -= last.bytes;
+    entries_.erase(last.key.fingerprint);
+    lru_.pop_back();
+  }
+}
+
+int OptimizedGraphCache::num_entries() const {
+  mutex_lock l(mu_);
+  return lru_.size();
+}
+
+int64_t OptimizedGraphCache::size_bytes() const {
+  mutex_lock l(mu_);
+  return size_bytes_;
+}
+
+Status ReadOptimizedGraph(const string& dir, const OptimizedGraphKey& key,
+                          GraphDef* graph) {
+  const string file_name = CacheFileName(dir, key);
+  Env* env = Env::Default();
+  if (!env->FileExists(file_name).ok()) {
+    return errors::NotFound("No optimized graph in ", file_name);
+  }
+  string contents;
+  TF_RETURN_IF_ERROR(ReadFileToString(env, file_name, &contents));
+
+  // The header is three lines: the format and version, the key, and the
+  // fingerprint and size of the serialized graph that follows.
+  size_t header_size = 0;
+  for (int line = 0; line < 3; ++line) {
+    header_size = contents.find('\n', header_size);
+    if (header_size == string::npos) {
+      return errors::DataLoss("Truncated optimized graph file ", file_name);
+    }
+    ++header_size;
+  }
+  const absl::string_view payload =
+      absl::string_view(contents).substr(header_size);
+  if (contents.compare(0, header_size, FileHeader(key, payload)) != 0) {
+    return errors::DataLoss("Corrupt optimized graph file ", file_name);
+  }
+  if (!graph->ParseFromArray(payload.data(), payload.size())) {
+    return errors::DataLoss("Cannot parse the optimized graph in ", file_name);
+  }
+  return Status::OK();
+}
+
+Status WriteOptimizedGraph(const string& dir, const OptimizedGraphKey& key,
+                           const GraphDef& graph) {
+  Env* env = Env::Default();
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(dir));
+  string payload;
+  if (!SerializeToStringDeterministic(graph, &payload)) {
+    return errors::Internal("Cannot serialize the optimized graph");
+  }
+  const string file_name = CacheFileName(dir, key);
+  string temp_name = file_name;
+  if (!env->CreateUniqueFileName(&temp_name, ".tmp")) {
+    return errors::Internal("Cannot create a temporary file name for ",
+                            file_name);
+  }
+  TF_RETURN_IF_ERROR(WriteStringToFile(
+      env, temp_name, absl::StrCat(FileHeader(key, payload), payload)));
+  Status s = env->RenameFile(temp_name, file_name);
+  if (!s.ok()) env->DeleteFile(temp_name).IgnoreError();
+  return s;
+}
+
+}  // namespace grappler
+}  // namespace tensorflow
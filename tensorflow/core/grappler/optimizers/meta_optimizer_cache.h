@@ -0,0 +1,114 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_META_OPTIMIZER_CACHE_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_META_OPTIMIZER_CACHE_H_
+
+#include <list>
+#include <memory>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Identifies the result of optimizing a grappler item with the meta
+// optimizer.
+struct OptimizedGraphKey {
+  // Fingerprint of everything the optimized graph depends on: the item, the
+  // config, the devices, the registered custom optimizers and the TensorFlow
+  // version.
+  Fprint128 fingerprint = {0, 0};
+  // Number of bytes that were fingerprinted.  Compared on hits as a cheap check
+  // against fingerprint collisions.
+  uint64 size = 0;
+
+  bool operator==(const OptimizedGraphKey& other) const {
+    return fingerprint == other.fingerprint && size == other.size;
+  }
+
+  // Returns the fingerprint in hex, e.g. to name a file after the key.
+  string ToString() const;
+};
+
+// Returns the key of optimizing `item` with `config` on `cluster`, which may
+// be null.  The caching options of `config` are not part of the key.
+OptimizedGraphKey ComputeOptimizedGraphKey(const GrapplerItem& item,
+                                           const ConfigProto& config,
+                                           const Cluster* cluster);
+
+// An in-memory cache of optimized graphs, which evicts the least recently used
+// graphs once they take more than a given number of bytes.  Thread-safe.
+class OptimizedGraphCache {
+ public:
+  static constexpr int64_t kDefaultMaxBytes = 1LL << 30;
+
+  explicit OptimizedGraphCache(int64_t max_bytes = kDefaultMaxBytes)
+      : max_bytes_(max_bytes) {}
+
+  // Returns the cache shared by all the meta optimizers of the process.
+  static OptimizedGraphCache* Global();
+
+  // Copies the graph for `key` into `graph` and returns true, or returns false
+  // if the cache has no graph for `key`.
+  bool Lookup(const OptimizedGraphKey& key, GraphDef* graph);
+
+  // Adds `graph` as the graph for `key`.
+  void Insert(const OptimizedGraphKey& key, const GraphDef& graph);
+
+  int num_entries() const;
+  int64_t size_bytes() const;
+
+ private:
+  struct Entry {
+    OptimizedGraphKey key;
+    std::shared_ptr<const GraphDef> graph;
+    int64_t bytes;
+  };
+
+  const int64_t max_bytes_;
+  mutable mutex mu_;
+  // Most recently used first.
+  std::list<Entry> lru_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<Fprint128, std::list<Entry>::iterator, Fprint128Hasher>
+      entries_ TF_GUARDED_BY(mu_);
+  int64_t size_bytes_ TF_GUARDED_BY(mu_) = 0;
+};
+
+// Reads the graph for `key` from the cache directory `dir` into `graph`.
+// Returns NotFound if `dir` has no graph for `key`, and DataLoss if the file
+// for `key` is truncated or corrupt.
+Status ReadOptimizedGraph(const string& dir, const OptimizedGraphKey& key,
+                          GraphDef* graph);
+
+// Writes `graph` as the graph for `key` to the cache directory `dir`, creating
+// it if needed.  The file is written under a temporary name and renamed, so
+// that concurrent readers, possibly in other processes, never see part of it.
+Status WriteOptimizedGraph(const string& dir, const OptimizedGraphKey& key,
+                           const GraphDef& graph);
+
+}  // namespace grappler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_META_OPTIMIZER_CACHE_H_
@@ -0,0 +1,178 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/meta_optimizer_cache.h"
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/inputs/trivial_test_graph_input_yielder.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kDevice[] = "/device:CPU:0";
+
+GrapplerItem MakeItem(int width) {
+  TrivialTestGraphInputYielder fake_input(4, width, 10, false, {kDevice});
+  GrapplerItem item;
+  CHECK(fake_input.NextItem(&item));
+  return item;
+}
+
+GraphDef MakeGraph(int num_nodes) {
+  GraphDef graph;
+  for (int i = 0; i < num_nodes; ++i) {
+    NodeDef* node = graph.add_node();
+    node->set_name(absl::StrCat("node", i));
+    node->set_op("NoOp");
+  }
+  return graph;
+}
+
+string CacheDir(const string& name) {
+  const string dir = io::JoinPath(testing::TmpDir(), name);
+  int64_t undeleted_files, undeleted_dirs;
+  Env::Default()
+      ->DeleteRecursively(dir, &undeleted_files, &undeleted_dirs)
+      .IgnoreError();
+  return dir;
+}
+
+TEST(OptimizedGraphKeyTest, DependsOnItemAndConfig) {
+  const GrapplerItem item = MakeItem(2);
+  ConfigProto config;
+  const OptimizedGraphKey key = ComputeOptimizedGraphKey(item, config, nullptr);
+  EXPECT_EQ(key, ComputeOptimizedGraphKey(item, config, nullptr));
+  EXPECT_EQ(32, key.ToString().size());
+
+  EXPECT_FALSE(key == ComputeOptimizedGraphKey(MakeItem(3), config, nullptr));
+
+  GrapplerItem other_fetch = item;
+  other_fetch.fetch.push_back("other");
+  EXPECT_FALSE(key == ComputeOptimizedGraphKey(other_fetch, config, nullptr));
+
+  GrapplerItem other_options = item;
+  other_options.optimization_options().allow_non_differentiable_rewrites =
+      false;
+  EXPECT_FALSE(key ==
+               ComputeOptimizedGraphKey(other_options, config, nullptr));
+
+  ConfigProto other_config = config;
+  other_config.mutable_graph_options()
+      ->mutable_rewrite_options()
+      ->set_constant_folding(RewriterConfig::OFF);
+  EXPECT_FALSE(key == ComputeOptimizedGraphKey(item, other_config, nullptr));
+
+  // The cache options themselves are not part of the key.
+  ConfigProto cached_config = config;
+  RewriterConfig* rewriter_config =
+      cached_config.mutable_graph_options()->mutable_rewrite_options();
+  rewriter_config->set_experimental_optimized_graph_cache(RewriterConfig::ON);
+  rewriter_config->set_experimental_optimized_graph_cache_dir("/tmp/cache");
+  EXPECT_EQ(key, ComputeOptimizedGraphKey(item, cached_config, nullptr));
+}
+
+TEST(OptimizedGraphCacheTest, LookupAndInsert) {
+  ConfigProto config;
+  const OptimizedGraphKey key1 =
+      ComputeOptimizedGraphKey(MakeItem(2), config, nullptr);
+  const OptimizedGraphKey key2 =
+      ComputeOptimizedGraphKey(MakeItem(3), config, nullptr);
+
+  OptimizedGraphCache cache;
+  GraphDef graph;
+  EXPECT_FALSE(cache.Lookup(key1, &graph));
+  cache.Insert(key1, MakeGraph(1));
+  cache.Insert(key2, MakeGraph(2));
+  ASSERT_TRUE(cache.Lookup(key1, &graph));
+  EXPECT_EQ(1, graph.node_size());
+  ASSERT_TRUE(cache.Lookup(key2, &graph));
+  EXPECT_EQ(2, graph.node_size());
+
+  // A key with the same fingerprint but a different size is a miss.
+  OptimizedGraphKey collision = key1;
+  ++collision.size;
+  EXPECT_FALSE(cache.Lookup(collision, &graph));
+}
+
+TEST(OptimizedGraphCacheTest, EvictsLeastRecentlyUsed) {
+  ConfigProto config;
+  const OptimizedGraphKey key1 =
+      ComputeOptimizedGraphKey(MakeItem(2), config, nullptr);
+  const OptimizedGraphKey key2 =
+      ComputeOptimizedGraphKey(MakeItem(3), config, nullptr);
+  const OptimizedGraphKey key3 =
+      ComputeOptimizedGraphKey(MakeItem(4), config, nullptr);
+  const GraphDef graph = MakeGraph(10);
+
+  // Room for two graphs.
+  OptimizedGraphCache cache(/*max_bytes=*/2 * graph.ByteSizeLong());
+  cache.Insert(key1, graph);
+  cache.Insert(key2, graph);
+  GraphDef found;
+  EXPECT_TRUE(cache.Lookup(key1, &found));
+  cache.Insert(key3, graph);
+  EXPECT_EQ(2, cache.num_entries());
+  EXPECT_EQ(2 * static_cast<int64_t>(graph.ByteSizeLong()), cache.size_bytes());
+  EXPECT_TRUE(cache.Lookup(key1, &found));
+  EXPECT_FALSE(cache.Lookup(key2, &found));
+  EXPECT_TRUE(cache.Lookup(key3, &found));
+}
+
+TEST(OptimizedGraphFileTest, WriteAndRead) {
+  const string dir = CacheDir("WriteAndRead");
+  const OptimizedGraphKey key =
+      ComputeOptimizedGraphKey(MakeItem(2), ConfigProto(), nullptr);
+  GraphDef graph;
+  EXPECT_TRUE(errors::IsNotFound(ReadOptimizedGraph(dir, key, &graph)));
+
+  TF_ASSERT_OK(WriteOptimizedGraph(dir, key, MakeGraph(3)));
+  TF_ASSERT_OK(ReadOptimizedGraph(dir, key, &graph));
+  EXPECT_EQ(3, graph.node_size());
+}
+
+TEST(OptimizedGraphFileTest, CorruptFile) {
+  const string dir = CacheDir("CorruptFile");
+  const OptimizedGraphKey key =
+      ComputeOptimizedGraphKey(MakeItem(2), ConfigProto(), nullptr);
+  TF_ASSERT_OK(WriteOptimizedGraph(dir, key, MakeGraph(3)));
+
+  const string file_name =
+      io::JoinPath(dir, absl::StrCat(key.ToString(), ".graph"));
+  string contents;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), file_name, &contents));
+  GraphDef graph;
+
+  // Truncated.
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), file_name,
+                                 contents.substr(0, contents.size() - 1)));
+  EXPECT_TRUE(errors::IsDataLoss(ReadOptimizedGraph(dir, key, &graph)));
+
+  // A flipped byte in the graph.
+  contents.back() ^= 1;
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), file_name, contents));
+  EXPECT_TRUE(errors::IsDataLoss(ReadOptimizedGraph(dir, key, &graph)));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
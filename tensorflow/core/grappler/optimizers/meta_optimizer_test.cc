@@ -32,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/utils/grappler_test.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/protobuf/config.pb.h"
@@ -150,6 +151,71 @@ TEST_F(MetaOptimizerTest, RunsCustomOptimizer) {
   EXPECT_TRUE(TestOptimizer::IsOptimized());
 }
 
+TEST_F(MetaOptimizerTest, CachesOptimizedGraphInMemory) {
+  TrivialTestGraphInputYielder fake_input(4, 3, 10, false, {kDevice});
+  GrapplerItem item;
+  ASSERT_TRUE(fake_input.NextItem(&item));
+
+  ConfigProto config_proto;
+  auto& rewriter_config =
+      *config_proto.mutable_graph_options()->mutable_rewrite_options();
+  rewriter_config.add_optimizers("TestOptimizer");
+  rewriter_config.set_min_graph_nodes(-1);
+  rewriter_config.set_experimental_optimized_graph_cache(RewriterConfig::ON);
+
+  TestOptimizer::SetOptimized(false);
+  GraphDef output;
+  TF_EXPECT_OK(
+      MetaOptimizer(nullptr, config_proto).Optimize(nullptr, item, &output));
+  EXPECT_TRUE(TestOptimizer::IsOptimized());
+
+  // The same item with the same config is not optimized again.
+  TestOptimizer::SetOptimized(false);
+  GraphDef cached_output;
+  TF_EXPECT_OK(MetaOptimizer(nullptr, config_proto)
+                   .Optimize(nullptr, item, &cached_output));
+  EXPECT_FALSE(TestOptimizer::IsOptimized());
+  CompareGraphs(output, cached_output);
+
+  // A different config is.
+  rewriter_config.set_meta_optimizer_iterations(RewriterConfig::ONE);
+  TF_EXPECT_OK(
+      MetaOptimizer(nullptr, config_proto).Optimize(nullptr, item, &output));
+  EXPECT_TRUE(TestOptimizer::IsOptimized());
+}
+
+TEST_F(MetaOptimizerTest, CachesOptimizedGraphOnDisk) {
+  TrivialTestGraphInputYielder fake_input(4, 2, 10, false, {kDevice});
+  GrapplerItem item;
+  ASSERT_TRUE(fake_input.NextItem(&item));
+
+  ConfigProto config_proto;
+  auto& rewriter_config =
+      *config_proto.mutable_graph_options()->mutable_rewrite_options();
+  rewriter_config.add_optimizers("TestOptimizer");
+  rewriter_config.set_min_graph_nodes(-1);
+  const string cache_dir =
+      io::JoinPath(testing::TmpDir(), "CachesOptimizedGraphOnDisk");
+  int64_t undeleted_files, undeleted_dirs;
+  Env::Default()
+      ->DeleteRecursively(cache_dir, &undeleted_files, &undeleted_dirs)
+      .IgnoreError();
+  rewriter_config.set_experimental_optimized_graph_cache_dir(cache_dir);
+
+  TestOptimizer::SetOptimized(false);
+  GraphDef output;
+  TF_EXPECT_OK(
+      MetaOptimizer(nullptr, config_proto).Optimize(nullptr, item, &output));
+  EXPECT_TRUE(TestOptimizer::IsOptimized());
+
+  TestOptimizer::SetOptimized(false);
+  GraphDef cached_output;
+  TF_EXPECT_OK(MetaOptimizer(nullptr, config_proto)
+                   .Optimize(nullptr, item, &cached_output));
+  EXPECT_FALSE(TestOptimizer::IsOptimized());
+  CompareGraphs(output, cached_output);
+}
+
 TEST_F(MetaOptimizerTest, RunsCustomOptimizerWithParams) {
   TrivialTestGraphInputYielder fake_input(4, 1, 10, false, {kDevice});
   GrapplerItem item;
@@ -420,6 +486,102 @@ TEST_F(MetaOptimizerTest, OptimizeFunctionLibrary) {
   test::ExpectTensorEqual<int>(tensors_expected[1], tensors[1]);
 }
 
+TEST_F(MetaOptimizerTest, OptimizeFunctionLibraryOnThreads) {
+  using test::function::NDef;
+
+  // Define function library:
+  //
+  //   MyMul(x, y)     = x * y
+  //  *MySquare_i(x)   = MyMul(x, x)    for i in [0, 8)
+  //
+  //  * - marked as noinline
+  std::vector<FunctionDef> funcs = {FunctionDefHelper::Create(
+      "MyMul", {"x:T", "y:T"}, {"z:T"}, {"T: {float, double}"},
+      {{{"mul"}, "Mul", {"x", "y"}, {{"T", "$T"}}}},
+      /*ret_def=*/
+      {{"z", "mul:z:0"}})};
+  std::vector<NodeDef> nodes = {
+      NDef("a", "Placeholder", {}, {{"dtype", DT_FLOAT}}, kDevice)};
+  std::vector<string> fetch;
+  for (int i = 0; i < 8; ++i) {
+    const string name = absl::StrCat("MySquare_", i);
+    FunctionDef square_func = FunctionDefHelper::Create(
+        name, {"x:T"}, {"z:T"}, {"T: {float, double}"},
+        {{{"my_mul"}, "MyMul", {"x", "x"}, {{"T", "$T"}}}},
+        /*ret_def=*/
+        {{"z", "my_mul:z:0"}});
+    (*square_func.mutable_attr())["_noinline"].set_b(true);
+    funcs.push_back(square_func);
+    nodes.push_back(NDef(absl::StrCat("square_", i), name, {"a"},
+                         {{"T", DT_FLOAT}}, kDevice));
+    nodes.push_back(NDef(absl::StrCat("out_", i), "Identity",
+                         {absl::StrCat("square_", i, ":0")}, {{"T", DT_FLOAT}},
+                         kDevice));
+    fetch.push_back(absl::StrCat("out_", i));
+  }
+
+  GrapplerItem item;
+  item.id = "tf_graph";
+  item.graph = test::function::GDef(nodes, funcs);
+  item.fetch = fetch;
+  item.feed.emplace_back("a", test::AsScalar<float>(3.0f));
+
+  const auto optimize = [&](int num_threads) {
+    ConfigProto config_proto;
+    auto& rewriter_config =
+        *config_proto.mutable_graph_options()->mutable_rewrite_options();
+    rewriter_config.set_meta_optimizer_iterations(RewriterConfig::TWO);
+    rewriter_config.set_function_optimization(RewriterConfig::ON);
+    rewriter_config.add_optimizers("function");
+    rewriter_config.set_min_graph_nodes(-1);
+    rewriter_config.set_experimental_function_optimization_threads(
+        num_threads);
+    GraphDef output;
+    TF_EXPECT_OK(
+        MetaOptimizer(nullptr, config_proto).Optimize(nullptr, item, &output));
+    return output;
+  };
+
+  // The optimized graph does not depend on the number of threads.
+  const GraphDef output = optimize(1);
+  FunctionLibraryDefinition optimized_flib(OpRegistry::Global(),
+                                           output.library());
+  for (int num_threads : {2, 4, 16}) {
+    const GraphDef threads_output = optimize(num_threads);
+    CompareGraphs(output, threads_output);
+    ASSERT_EQ(output.library().function_size(),
+              threads_output.library().function_size());
+    for (const FunctionDef& func : threads_output.library().function()) {
+      const FunctionDef* expected_func =
+          optimized_flib.Find(func.signature().name());
+      ASSERT_NE(expected_func, nullptr);
+      CompareFunctions(*expected_func, func);
+    }
+  }
+
+  // MyMul is inlined into all the specializations of MySquare.
+  EXPECT_EQ(9, optimized_flib.num_functions());
+  for (const NodeDef& node : output.node()) {
+    if (!absl::StartsWith(node.name(), "square_")) continue;
+    const FunctionDef* optimized_func = optimized_flib.Find(node.op());
+    ASSERT_NE(optimized_func, nullptr);
+    int count = 0;
+    for (const NodeDef& func_node : optimized_func->node_def()) {
+      if (func_node.op() == "Mul") ++count;
+      EXPECT_NE("MyMul", func_node.op());
+    }
+    EXPECT_EQ(1, count);
+  }
+
+  auto tensors_expected = EvaluateFetchNodes(item);
+  GrapplerItem optimized = item.WithGraph(GraphDef(output));
+  auto tensors = EvaluateFetchNodes(optimized);
+  ASSERT_EQ(tensors_expected.size(), tensors.size());
+  for (int i = 0; i < tensors.size(); ++i) {
+    test::ExpectTensorEqual<float>(tensors_expected[i], tensors[i]);
+  }
+}
+
 TEST_F(MetaOptimizerTest, OptimizeFunctionLibraryPruneUnusedOutputs) {
   using test::function::NDef;
 
@@ -792,6 +954,28 @@ TEST_F(MetaOptimizerTest, OptimizerDoesNotTimeOut) {
   EXPECT_EQ(original_node_size + 2, output.node_size());
 }
 
+TEST_F(MetaOptimizerTest, MetaOptimizerStopsWhenBudgetIsSpent) {
+  TrivialTestGraphInputYielder fake_input(4, 1, 10, false, {kDevice});
+  GrapplerItem item;
+  ASSERT_TRUE(fake_input.NextItem(&item));
+
+  ConfigProto config;
+  RewriterConfig& rewriter_config =
+      *config.mutable_graph_options()->mutable_rewrite_options();
+  rewriter_config.add_optimizers("SleepingOptimizer");
+  rewriter_config.set_min_graph_nodes(-1);
+  rewriter_config.set_meta_optimizer_budget_ms(500);
+  rewriter_config.set_meta_optimizer_iterations(RewriterConfig::TWO);
+  GraphDef output;
+  const int original_node_size = item.graph.node_size();
+  const Status status =
+      RunMetaOptimizer(std::move(item), config, nullptr, nullptr, &output);
+  // Running over the budget is not an error, but the second iteration is
+  // skipped.
+  TF_EXPECT_OK(status);
+  EXPECT_EQ(original_node_size + 1, output.node_size());
+}
+
 TEST_F(MetaOptimizerTest, RunPostOptimizationVerifiersOnValidGraph) {
   TrivialTestGraphInputYielder fake_input(4, 1, 10, false, {kDevice});
   GrapplerItem item;
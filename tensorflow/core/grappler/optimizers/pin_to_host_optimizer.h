@@ -25,6 +25,9 @@ limitations under the License.
 namespace tensorflow {
 namespace grappler {
 namespace internal {
+// Returns true if `node` should never be moved to another device.
+bool IsDenylisted(const NodeDef& node);
+
 // Try and find an appropriate Host device in `devices` given `device`.
 string TryFindHostDevice(const gtl::FlatSet<string>& devices,
                          bool has_device_cpu, const string& device);
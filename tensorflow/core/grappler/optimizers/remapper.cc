@@ -15,7 +15,12 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/remapper.h"
 
+#include <algorithm>
+
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_join.h"
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/grappler/costs/graph_properties.h"
 #include "tensorflow/core/grappler/graph_view.h"
@@ -59,6 +64,18 @@ namespace grappler {
 //
 // Sigmoid + Mul -> _MklSwish  // This fusion only works on Intel CPU.
 //
+// Chain of element-wise ops on CPU -> _FusedElementwise
+//   (1) [Cast] + <Unary or Binary Op> + ... + <Unary or Binary Op>
+//
+// LayerNorm on CPU -> _FusedLayerNorm
+//   (1) Mean + SquaredDifference + Mean + Rsqrt + Mul + Sub + Add
+//
+// Attention on CPU -> _FusedAttention
+//   (1) BatchMatMul + [Mul] + [Add] + Softmax + BatchMatMul
+//
+// MatMul + BiasAdd + Gelu -> _FusedMatMul
+//   (1) The erf (GeluExact) and tanh (GeluApproximate) forms of Gelu
+//
 //
 // In all cases, the supported activation functions are Relu, Relu6, and Elu.
 //
@@ -73,9 +90,13 @@ constexpr char kFusedDepthwiseConv2dNative[] = "_FusedDepthwiseConv2dNative";
 constexpr char kFusedBatchNormEx[] = "_FusedBatchNormEx";
 constexpr char kFusedBatchNormGradEx[] = "_FusedBatchNormGradEx";
 constexpr char kTensorToHashBucket[] = "_TensorToHashBucketFast";
+constexpr char kFusedElementwise[] = "_FusedElementwise";
+constexpr char kFusedLayerNorm[] = "_FusedLayerNorm";
+constexpr char kFusedAttention[] = "_FusedAttention";
 
 constexpr char kDataFormat[] = "data_format";
 constexpr char kIsTraining[] = "is_training";
+constexpr char kRhsIsConstant[] = "_rhs_is_constant";
 
 constexpr char kWidth[] = "width";
 constexpr char kFill[] = "fill";
@@ -143,6 +164,57 @@ struct TensorToHashBucket {
   int string_to_hash_bucket = kMissingIndex;
 };
 
+// Chain of element-wise ops, where each op consumes the output of the previous
+// one, optionally starting with a Cast.
+struct FusedElementwiseChain {
+  // Nodes of the chain from the last to the first one.
+  std::vector<int> nodes;
+  int cast = kMissingIndex;
+  // The input of the first op (or of the Cast) of the chain.
+  string input;
+  std::vector<string> fused_ops;
+  // The second inputs of the binary ops of the chain.
+  std::vector<string> args;
+};
+
+// SparseSegment{Sum,Mean,SqrtN} reducing the rows gathered at the unique ids,
+// which can read the rows at the original ids instead.
+struct UniqueGatherSparseSegment {
+  int unique = kMissingIndex;
+  int gather = kMissingIndex;
+  int sparse_segment = kMissingIndex;
+};
+
+// Layer normalization over the innermost dimension, as built by tf.nn.moments
+// and tf.nn.batch_normalization:
+//   mean = Mean(x), variance = Mean(SquaredDifference(x, mean)),
+//   inv = Rsqrt(variance + epsilon) * scale,
+//   output = x * inv + (offset - mean * inv).
+struct LayerNorm {
+  int output = kMissingIndex;
+  string input;
+  string scale;
+  string offset;
+  float epsilon = 0.0;
+  // All the matched nodes but the output.
+  std::vector<int> fused_nodes;
+};
+
+// Scaled dot-product attention:
+//   output = BatchMatMul(Softmax(BatchMatMul(query, key^T) * scale + mask),
+//                        value).
+struct Attention {
+  int output = kMissingIndex;
+  string query;
+  string key;
+  string value;
+  // Empty if the scores are not masked.
+  string mask;
+  float scale = 1.0;
+  // All the matched nodes but the output.
+  std::vector<int> fused_nodes;
+};
+
 // Pad followed by Conv3D/FusedConv3D
 struct PadWithConv3D {
   PadWithConv3D() = default;
@@ -1005,9 +1077,6 @@ bool FindMatMulBiasAddAndGelu(RemapperContext* ctx, int node_index,
                               std::map<string, int>* matched_nodes_map,
                               std::set<int>* remove_node_indices,
                               bool* is_gelu_approximate) {
-  // Gelu fusion is enabled only with oneDNN library.
-  if (!IsMKLEnabled()) return false;
-
   using utils::MatchingDirection;
   using utils::NodeStatus;
   // clang-format off
@@ -1141,6 +1210,11 @@ bool FindMatMulBiasAddAndGelu(RemapperContext* ctx, int node_index,
     // Check if _FusedMatMul contains only BiasAdd
     NodeDef* matmul_node =
         ctx->graph_view.GetNode(matched_nodes_map->at("matmul"))->node();
+    // The stock CPU kernel evaluates GeluApproximate for float only.
+    if (!NodeIsOnCpu(matmul_node) ||
+        (!IsMKLEnabled() && !HasDataType(matmul_node, DT_FLOAT))) {
+      return false;
+    }
     auto fused_ops = matmul_node->attr().at("fused_ops").list().s();
     if (fused_ops.size() == 1) {
       if (fused_ops.at(0) != "BiasAdd") return false;
@@ -1728,6 +1802,658 @@ bool FindTensorToHashBucket(const RemapperContext& ctx, int node_index,
   return true;
 }
 
+bool FindUniqueGatherSparseSegment(const RemapperContext& ctx, int node_index,
+                                   UniqueGatherSparseSegment* matched) {
+  // Root of the pattern must be a SparseSegment{Sum,Mean,SqrtN} on CPU.
+  const auto* node_view = ctx.graph_view.GetNode(node_index);
+  const auto* node_def = node_view->node();
+  if (!IsAnySparseSegmentReduction(*node_def) || !NodeIsOnCpu(node_def) ||
+      HasControlFaninOrFanout(*node_view) ||
+      node_view->NumRegularFanins() < 3) {
+    return false;
+  }
+
+  // Its data must be gathered along the first axis of the params.
+  const auto& data_fanin = node_view->GetRegularFanin(0);
+  const auto* gather_node_view = data_fanin.node_view();
+  const auto* gather_node_def = gather_node_view->node();
+  if (data_fanin.index() != 0 ||
+      (gather_node_def->op() != "Gather" &&
+       gather_node_def->op() != "GatherV2") ||
+      HasControlFaninOrFanout(*gather_node_view) ||
+      !HasAtMostOneFanoutAtPort0(*gather_node_view) ||
+      IsInPreserveSet(ctx, gather_node_def)) {
+    return false;
+  }
+  if (gather_node_def->op() == "GatherV2") {
+    int batch_dims = 0;
+    if (TryGetNodeAttr(*gather_node_def, "batch_dims", &batch_dims) &&
+        batch_dims != 0) {
+      return false;
+    }
+    if (gather_node_view->NumRegularFanins() < 3) return false;
+    const auto* axis_node_def =
+        gather_node_view->GetRegularFanin(2).node_view()->node();
+    Tensor axis;
+    if (!IsConstant(*axis_node_def) ||
+        !axis.FromProto(axis_node_def->attr().at("value").tensor()) ||
+        axis.NumElements() != 1) {
+      return false;
+    }
+    const int64_t axis_value = axis.dtype() == DT_INT32
+                                   ? axis.flat<int32>()(0)
+                                   : axis.flat<int64_t>()(0);
+    if (axis_value != 0) return false;
+  }
+
+  // The gathered ids must be the unique ids, and the indices of the segment
+  // reduction must map the ids to them.
+  const auto& ids_fanin = gather_node_view->GetRegularFanin(1);
+  const auto& idx_fanin = node_view->GetRegularFanin(1);
+  const auto* unique_node_view = ids_fanin.node_view();
+  const auto* unique_node_def = unique_node_view->node();
+  if (ids_fanin.index() != 0 || idx_fanin.index() != 1 ||
+      idx_fanin.node_view() != unique_node_view ||
+      unique_node_def->op() != "Unique" ||
+      HasControlFaninOrFanout(*unique_node_view) ||
+      unique_node_view->GetRegularFanout(0).size() != 1 ||
+      unique_node_view->GetRegularFanout(1).size() != 1 ||
+      IsInPreserveSet(ctx, unique_node_def) ||
+      unique_node_view->NumRegularFanins() < 1) {
+    return false;
+  }
+
+  // The ids become the indices of the segment reduction.
+  DataType ids_dtype = GetDataTypeFromAttr(*unique_node_def, "T");
+  if (ids_dtype != DT_INT32 && ids_dtype != DT_INT64) return false;
+
+  matched->unique = unique_node_view->node_index();
+  matched->gather = gather_node_view->node_index();
+  matched->sparse_segment = node_index;
+  return true;
+}
+
+bool IsFusedElementwiseUnaryOp(const NodeDef& node) {
+  static const auto* const kOps = new absl::flat_hash_set<string>(
+      {"Abs", "Exp", "Log", "Neg", "Relu", "Relu6", "Rsqrt", "Sigmoid", "Sqrt",
+       "Square", "Tanh"});
+  return kOps->contains(node.op());
+}
+
+bool IsFusedElementwiseBinaryOp(const NodeDef& node, bool* is_commutative) {
+  static const auto* const kCommutativeOps = new absl::flat_hash_set<string>(
+      {"Add", "AddV2", "Maximum", "Minimum", "Mul"});
+  *is_commutative = kCommutativeOps->contains(node.op());
+  return *is_commutative || IsSub(node) || IsRealDiv(node);
+}
+
+// Appends the ops of a _UnaryOpsComposition to `fused_ops` (in reverse order)
+// if they can all be evaluated by a _FusedElementwise.
+bool AppendUnaryOpsComposition(const NodeDef& node,
+                               std::vector<string>* fused_ops) {
+  std::vector<string> op_names;
+  if (!TryGetNodeAttr(node, "op_names", &op_names) || op_names.empty()) {
+    return false;
+  }
+  NodeDef unary_op;
+  for (const string& op_name : op_names) {
+    unary_op.set_op(op_name);
+    if (!IsFusedElementwiseUnaryOp(unary_op)) return false;
+  }
+  fused_ops->insert(fused_ops->end(), op_names.rbegin(), op_names.rend());
+  return true;
+}
+
+bool IsFusedElementwiseDataType(DataType dtype) {
+  return dtype == DT_FLOAT || dtype == DT_DOUBLE;
+}
+
+bool FindFusedElementwiseChain(const RemapperContext& ctx, int node_index,
+                               FusedElementwiseChain* matched) {
+  // XLA clusters element-wise ops on its own.
+  if (ctx.xla_auto_clustering_on) return false;
+
+  const auto* root_view = ctx.graph_view.GetNode(node_index);
+  const auto* root_def = root_view->node();
+  const DataType dtype = GetDataTypeFromAttr(*root_def, "T");
+  if (!NodeIsOnCpu(root_def) || !IsFusedElementwiseDataType(dtype) ||
+      root_view->NumControllingFanins() > 0) {
+    return false;
+  }
+
+  // All the ops of the chain must produce a tensor of the shape of the root,
+  // which binary ops guarantee as long as they do not broadcast.
+  const TensorShapeProto* shape = nullptr;
+  if (ctx.inferred_graph_properties) {
+    const auto& props =
+        ctx.graph_properties.GetOutputProperties(root_def->name());
+    if (!props.empty()) shape = &props[0].shape();
+  }
+
+  // Returns true if `node_view` can be fused into the chain, and sets the
+  // input port that continues the chain. The ops that consume the output of a
+  // contraction, BiasAdd or FusedBatchNorm are left to the patterns above.
+  const auto is_fusible = [&](const utils::MutableNodeView& node_view,
+                              int* chain_port) -> bool {
+    const NodeDef* node_def = node_view.node();
+    if (node_def->device() != root_def->device() ||
+        GetDataTypeFromAttr(*node_def, "T") != dtype) {
+      return false;
+    }
+    for (const auto& fanin : node_view.GetRegularFanins()) {
+      const NodeDef* fanin_def = fanin.node_view()->node();
+      if (IsConvOrMatMul(*fanin_def) || IsBiasAdd(*fanin_def) ||
+          IsFusedBatchNorm(*fanin_def) ||
+          absl::StartsWith(fanin_def->op(), "_Fused")) {
+        return false;
+      }
+    }
+    if (IsFusedElementwiseUnaryOp(*node_def) ||
+        node_def->op() == "_UnaryOpsComposition") {
+      *chain_port = 0;
+      return node_view.NumRegularFanins() == 1;
+    }
+    bool is_commutative = false;
+    if (!IsFusedElementwiseBinaryOp(*node_def, &is_commutative) ||
+        node_view.NumRegularFanins() != 2 || shape == nullptr) {
+      return false;
+    }
+    const auto& props =
+        ctx.graph_properties.GetInputProperties(node_def->name());
+    if (props.size() != 2) return false;
+    const auto is_chain_port = [&](int port) {
+      const TensorShapeProto& arg_shape = props[1 - port].shape();
+      return ShapesSymbolicallyEqual(props[port].shape(), *shape) &&
+             (Rank(arg_shape) == 0 ||
+              ShapesSymbolicallyEqual(arg_shape, *shape));
+    };
+    // Prefer the port that lets the chain grow further.
+    const int num_ports = is_commutative ? 2 : 1;
+    for (int port = 0; port < num_ports; ++port) {
+      const auto* fanin_def =
+          node_view.GetRegularFanin(port).node_view()->node();
+      bool unused;
+      if (is_chain_port(port) &&
+          (IsFusedElementwiseUnaryOp(*fanin_def) || IsCast(*fanin_def) ||
+           IsFusedElementwiseBinaryOp(*fanin_def, &unused) ||
+           fanin_def->op() == "_UnaryOpsComposition")) {
+        *chain_port = port;
+        return true;
+      }
+    }
+    for (int port = 0; port < num_ports; ++port) {
+      if (is_chain_port(port)) {
+        *chain_port = port;
+        return true;
+      }
+    }
+    return false;
+  };
+
+  FusedElementwiseChain chain;
+  const utils::MutableNodeView* node_view = root_view;
+  int chain_port;
+  if (!is_fusible(*node_view, &chain_port)) return false;
+  while (true) {
+    const NodeDef* node_def = node_view->node();
+    chain.nodes.push_back(node_view->node_index());
+    if (node_def->op() == "_UnaryOpsComposition") {
+      if (!AppendUnaryOpsComposition(*node_def, &chain.fused_ops)) return false;
+    } else {
+      chain.fused_ops.push_back(node_def->op());
+    }
+    if (node_view->NumRegularFanins() == 2) {
+      chain.args.push_back(node_def->input(1 - chain_port));
+    }
+    chain.input = node_def->input(chain_port);
+
+    const auto& fanin = node_view->GetRegularFanin(chain_port);
+    const auto* fanin_view = fanin.node_view();
+    const auto* fanin_def = fanin_view->node();
+    if (fanin.index() != 0 || HasControlFaninOrFanout(*fanin_view) ||
+        !HasAtMostOneFanoutAtPort0(*fanin_view) ||
+        IsInPreserveSet(ctx, fanin_def)) {
+      break;
+    }
+
+    // A Cast to T can only start the chain.
+    bool truncate = false;
+    if (IsCast(*fanin_def)) {
+      TryGetNodeAttr(*fanin_def, "Truncate", &truncate);
+    }
+    if (IsCast(*fanin_def) && fanin_def->device() == root_def->device() &&
+        GetDataTypeFromAttr(*fanin_def, "DstT") == dtype && !truncate) {
+      const DataType src_dtype = GetDataTypeFromAttr(*fanin_def, "SrcT");
+      if (src_dtype == DT_HALF || src_dtype == DT_BFLOAT16 ||
+          src_dtype == DT_FLOAT || src_dtype == DT_DOUBLE ||
+          src_dtype == DT_INT32 || src_dtype == DT_INT64) {
+        chain.cast = fanin_view->node_index();
+        chain.input = fanin_def->input(0);
+      }
+      break;
+    }
+
+    if (!is_fusible(*fanin_view, &chain_port)) break;
+    node_view = fanin_view;
+  }
+
+  // A single op (or _UnaryOpsComposition) gains nothing from the fusion.
+  const int num_nodes = chain.nodes.size() + (chain.cast != kMissingIndex);
+  if (num_nodes < 2) return false;
+
+  // Leave the Tanh form of Gelu to FindMatMulBiasAddAndGelu, which can only
+  // match it once MatMul and BiasAdd were fused into a _FusedMatMul.
+  const auto* input_view = ctx.graph_view.GetNode(NodeName(chain.input));
+  if (input_view != nullptr && IsAdd(*input_view->node()) &&
+      absl::c_linear_search(chain.fused_ops, "Tanh")) {
+    for (const auto& fanin : input_view->GetRegularFanins()) {
+      const NodeDef* fanin_def = fanin.node_view()->node();
+      if (IsMatMul(*fanin_def) || IsBiasAdd(*fanin_def) ||
+          fanin_def->op() == kFusedMatMul) {
+        return false;
+      }
+    }
+  }
+
+  std::reverse(chain.fused_ops.begin(), chain.fused_ops.end());
+  std::reverse(chain.args.begin(), chain.args.end());
+  *matched = std::move(chain);
+  return true;
+}
+
+// Returns true if the node is a float MatMul on CPU whose weights are a Const
+// or a resource variable that the graph only reads, which the kernel can then
+// pack once and reuse across steps.
+bool FindMatMulWithConstantRhs(const RemapperContext& ctx, int node_index) {
+  if (IsMKLEnabled()) return false;
+
+  const auto* node_view = ctx.graph_view.GetNode(node_index);
+  const auto* node_def = node_view->node();
+  if (!IsMatMul(*node_def) || !NodeIsOnCpu(node_def) ||
+      !HasDataType(node_def, DT_FLOAT) || node_view->NumRegularFanins() < 2 ||
+      node_def->attr().count(kRhsIsConstant) > 0) {
+    return false;
+  }
+  bool transpose_a = false;
+  if (!TryGetNodeAttr(*node_def, "transpose_a", &transpose_a) || transpose_a) {
+    return false;
+  }
+
+  const auto* rhs_view = node_view->GetRegularFanin(1).node_view();
+  const auto* rhs_def = rhs_view->node();
+  if (IsConstant(*rhs_def)) return true;
+  if (!IsReadVariableOp(*rhs_def) || rhs_view->NumRegularFanins() < 1) {
+    return false;
+  }
+  const auto* handle_view = rhs_view->GetRegularFanin(0).node_view();
+  if (handle_view->node()->op() != "VarHandleOp") return false;
+  for (const auto& fanout : handle_view->GetRegularFanout(0)) {
+    if (!IsReadVariableOp(*fanout.node_view()->node())) return false;
+  }
+  return true;
+}
+
+// Returns the value of a scalar float Const in `value`.
+bool GetScalarFloatConstant(const NodeDef& node_def, float* value) {
+  Tensor tensor;
+  if (!IsConstant(node_def) ||
+      !tensor.FromProto(node_def.attr().at("value").tensor()) ||
+      tensor.dtype() != DT_FLOAT || tensor.NumElements() != 1) {
+    return false;
+  }
+  *value = tensor.flat<float>()(0);
+  return true;
+}
+
+// Returns true if the node is a Mean of its input over the innermost of `rank`
+// dimensions that keeps the reduced dimension.
+bool IsInnermostMean(const utils::MutableNodeView& node_view, int rank) {
+  const auto* node_def = node_view.node();
+  bool keep_dims = false;
+  if (!IsMean(*node_def) || node_view.NumRegularFanins() != 2 ||
+      !TryGetNodeAttr(*node_def, "keep_dims", &keep_dims) || !keep_dims) {
+    return false;
+  }
+  const auto* axes_def = node_view.GetRegularFanin(1).node_view()->node();
+  Tensor axes;
+  if (!IsConstant(*axes_def) ||
+      !axes.FromProto(axes_def->attr().at("value").tensor()) ||
+      axes.NumElements() != 1) {
+    return false;
+  }
+  const int64_t axis = axes.dtype() == DT_INT32 ? axes.flat<int32>()(0)
+                                                : axes.flat<int64_t>()(0);
+  return axis == -1 || axis == rank - 1;
+}
+
+// Returns true if all the regular fanouts of the `nodes` are either in `nodes`
+// or the `root`, so that the fused node can replace all of them.
+bool AllFanoutsInSubgraph(const RemapperContext& ctx,
+                          const std::vector<int>& nodes, int root) {
+  const absl::flat_hash_set<int> subgraph(nodes.begin(), nodes.end());
+  for (int node_index : nodes) {
+    const auto* node_view = ctx.graph_view.GetNode(node_index);
+    for (const auto& fanouts : node_view->GetRegularFanouts()) {
+      for (const auto& fanout : fanouts) {
+        if (fanout.node_index() != root &&
+            !subgraph.contains(fanout.node_index())) {
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+bool FindLayerNorm(const RemapperContext& ctx, int node_index,
+                   LayerNorm* matched) {
+  // The depth of the scale and offset must be known to match the input.
+  if (!ctx.inferred_graph_properties) return false;
+
+  const auto* root_view = ctx.graph_view.GetNode(node_index);
+  const auto* root_def = root_view->node();
+  if (!IsAdd(*root_def) || !NodeIsOnCpu(root_def) ||
+      !HasDataType(root_def, DT_FLOAT) || HasControlFaninOrFanout(*root_view) ||
+      root_view->NumRegularFanins() != 2) {
+    return false;
+  }
+
+  using utils::MutableNodeView;
+  const auto fanin = [](const MutableNodeView& node_view, int port) {
+    return node_view.GetRegularFanin(port).node_view();
+  };
+  // Returns true if the node can be removed once the root is fused.
+  const auto is_fusible = [&](const MutableNodeView& node_view,
+                              int num_fanins) {
+    const auto* node_def = node_view.node();
+    return node_def->device() == root_def->device() &&
+           HasDataType(node_def, DT_FLOAT) &&
+           node_view.NumRegularFanins() == num_fanins &&
+           !HasControlFaninOrFanout(node_view) &&
+           !IsInPreserveSet(ctx, node_def);
+  };
+  // Returns the port of a commutative binary op whose input satisfies `pred`.
+  const auto find_port = [&](const MutableNodeView& node_view,
+                             const auto& pred) -> int {
+    for (int port = 0; port < 2; ++port) {
+      if (pred(*fanin(node_view, port))) return port;
+    }
+    return kMissingIndex;
+  };
+  const auto is_rsqrt = [&](const MutableNodeView& node_view) {
+    return IsRsqrt(*node_view.node()) && is_fusible(node_view, 1);
+  };
+  const auto is_inv = [&](const MutableNodeView& node_view) {
+    return IsMul(*node_view.node()) && is_fusible(node_view, 2) &&
+           find_port(node_view, is_rsqrt) != kMissingIndex;
+  };
+  const auto is_x_times_inv = [&](const MutableNodeView& node_view) {
+    return IsMul(*node_view.node()) && is_fusible(node_view, 2) &&
+           find_port(node_view, is_inv) != kMissingIndex;
+  };
+
+  // output = x * inv + (offset - mean * inv)
+  const int x_times_inv_port = find_port(*root_view, is_x_times_inv);
+  if (x_times_inv_port == kMissingIndex) return false;
+  const auto* x_times_inv = fanin(*root_view, x_times_inv_port);
+  const auto* offset_minus = fanin(*root_view, 1 - x_times_inv_port);
+  if (!IsSub(*offset_minus->node()) || !is_fusible(*offset_minus, 2)) {
+    return false;
+  }
+  const int inv_port = find_port(*x_times_inv, is_inv);
+  const auto* inv = fanin(*x_times_inv, inv_port);
+  const auto& x = x_times_inv->GetRegularFanin(1 - inv_port);
+
+  // inv = Rsqrt(variance + epsilon) * scale
+  const int rsqrt_port = find_port(*inv, is_rsqrt);
+  const auto* rsqrt = fanin(*inv, rsqrt_port);
+  const auto* variance_plus_epsilon = fanin(*rsqrt, 0);
+  if (!IsAdd(*variance_plus_epsilon->node()) ||
+      !is_fusible(*variance_plus_epsilon, 2)) {
+    return false;
+  }
+  float epsilon;
+  const int epsilon_port =
+      find_port(*variance_plus_epsilon, [&](const MutableNodeView& node_view) {
+        return GetScalarFloatConstant(*node_view.node(), &epsilon);
+      });
+  if (epsilon_port == kMissingIndex) return false;
+
+  // The statistics must be reduced over the innermost dimension of `x`.
+  const auto& x_props =
+      ctx.graph_properties.GetInputProperties(x_times_inv->node()->name());
+  if (x_props.size() != 2) return false;
+  const TensorShapeProto& x_shape = x_props[1 - inv_port].shape();
+  const int rank = Rank(x_shape);
+  if (rank < 1) return false;
+
+  // variance = Mean(SquaredDifference(x, mean))
+  const auto* variance = fanin(*variance_plus_epsilon, 1 - epsilon_port);
+  if (!IsInnermostMean(*variance, rank) || !is_fusible(*variance, 2)) {
+    return false;
+  }
+  const auto* squared_difference = fanin(*variance, 0);
+  if (!IsSquaredDifference(*squared_difference->node()) ||
+      !is_fusible(*squared_difference, 2)) {
+    return false;
+  }
+
+  // offset - mean * inv, with mean = Mean(x)
+  const auto* mean_times_inv = fanin(*offset_minus, 1);
+  if (!IsMul(*mean_times_inv->node()) || !is_fusible(*mean_times_inv, 2)) {
+    return false;
+  }
+  const int inv_port_of_mean =
+      find_port(*mean_times_inv, [&](const MutableNodeView& node_view) {
+        return node_view.node_index() == inv->node_index();
+      });
+  if (inv_port_of_mean == kMissingIndex) return false;
+  const auto* mean = fanin(*mean_times_inv, 1 - inv_port_of_mean);
+  if (!IsInnermostMean(*mean, rank) || !is_fusible(*mean, 2) ||
+      !(mean->GetRegularFanin(0) == x)) {
+    return false;
+  }
+
+  std::vector<int> fused_nodes = {x_times_inv->node_index(),
+                                  offset_minus->node_index(),
+                                  inv->node_index(),
+                                  rsqrt->node_index(),
+                                  variance_plus_epsilon->node_index(),
+                                  variance->node_index(),
+                                  squared_difference->node_index(),
+                                  mean_times_inv->node_index(),
+                                  mean->node_index()};
+
+  // tf.nn.moments stops the gradient of the mean in the variance.
+  int x_port = kMissingIndex;
+  for (int port = 0; port < 2; ++port) {
+    if (squared_difference->GetRegularFanin(port) == x) x_port = port;
+  }
+  if (x_port == kMissingIndex) return false;
+  const auto* squared_mean = fanin(*squared_difference, 1 - x_port);
+  if (squared_mean->node_index() != mean->node_index()) {
+    if (!(IsStopGradient(*squared_mean->node()) ||
+          IsIdentity(*squared_mean->node())) ||
+        !is_fusible(*squared_mean, 1) ||
+        fanin(*squared_mean, 0)->node_index() != mean->node_index()) {
+      return false;
+    }
+    fused_nodes.push_back(squared_mean->node_index());
+  }
+  if (!AllFanoutsInSubgraph(ctx, fused_nodes, node_index)) return false;
+
+  // The scale and offset must be vectors of the depth of `x`, so that the
+  // output does not broadcast beyond the shape of `x`.
+  const int64_t depth = x_shape.dim(rank - 1).size();
+  if (depth == -1) return false;
+  const auto is_vector_of_depth = [depth](const TensorShapeProto& shape) {
+    return Rank(shape) == 1 && shape.dim(0).size() == depth;
+  };
+  const auto& inv_props =
+      ctx.graph_properties.GetInputProperties(inv->node()->name());
+  const auto& offset_props =
+      ctx.graph_properties.GetInputProperties(offset_minus->node()->name());
+  if (inv_props.size() != 2 || offset_props.size() != 2 ||
+      !is_vector_of_depth(inv_props[1 - rsqrt_port].shape()) ||
+      !is_vector_of_depth(offset_props[0].shape())) {
+    return false;
+  }
+
+  matched->output = node_index;
+  matched->input = x_times_inv->node()->input(1 - inv_port);
+  matched->scale = inv->node()->input(1 - rsqrt_port);
+  matched->offset = offset_minus->node()->input(0);
+  matched->epsilon = epsilon;
+  matched->fused_nodes = std::move(fused_nodes);
+  return true;
+}
+
+bool FindAttention(const RemapperContext& ctx, int node_index,
+                   Attention* matched) {
+  // The batch dimensions must be known not to broadcast.
+  if (!ctx.inferred_graph_properties) return false;
+
+  const auto* root_view = ctx.graph_view.GetNode(node_index);
+  const auto* root_def = root_view->node();
+  bool adj_x = false;
+  bool adj_y = false;
+  if (!IsAnyBatchMatMul(*root_def) || !NodeIsOnCpu(root_def) ||
+      !HasDataType(root_def, DT_FLOAT) || HasControlFaninOrFanout(*root_view) ||
+      root_view->NumRegularFanins() != 2 ||
+      !TryGetNodeAttr(*root_def, "adj_x", &adj_x) ||
+      !TryGetNodeAttr(*root_def, "adj_y", &adj_y) || adj_x || adj_y) {
+    return false;
+  }
+
+  using utils::MutableNodeView;
+  const auto fanin = [](const MutableNodeView& node_view, int port) {
+    return node_view.GetRegularFanin(port).node_view();
+  };
+  // Returns true if the node only feeds the next node of the pattern.
+  const auto is_fusible = [&](const MutableNodeView& node_view,
+                              int num_fanins) {
+    const auto* node_def = node_view.node();
+    return node_def->device() == root_def->device() &&
+           HasDataType(node_def, DT_FLOAT) &&
+           node_view.NumRegularFanins() == num_fanins &&
+           HasAtMostOneFanoutAtPort0(node_view) &&
+           !HasControlFaninOrFanout(node_view) &&
+           !IsInPreserveSet(ctx, node_def);
+  };
+
+  std::vector<int> fused_nodes;
+  const auto* softmax = fanin(*root_view, 0);
+  if (!IsSoftmax(*softmax->node()) || !is_fusible(*softmax, 1)) return false;
+  fused_nodes.push_back(softmax->node_index());
+
+  // Returns the BatchMatMul(query, key^T) of the scaled scores, and sets the
+  // scale and the node that applies it.
+  float scale = 1.0;
+  int scale_node = kMissingIndex;
+  const auto find_scores = [&](const MutableNodeView* node_view)
+      -> const MutableNodeView* {
+    scale = 1.0;
+    scale_node = kMissingIndex;
+    const auto* node_def = node_view->node();
+    if ((IsMul(*node_def) || IsRealDiv(*node_def)) &&
+        is_fusible(*node_view, 2)) {
+      const int num_ports = IsMul(*node_def) ? 2 : 1;
+      for (int port = 0; port < num_ports; ++port) {
+        float value;
+        if (!GetScalarFloatConstant(*fanin(*node_view, 1 - port)->node(),
+                                    &value) ||
+            (IsRealDiv(*node_def) && value == 0)) {
+          continue;
+        }
+        scale = IsRealDiv(*node_def) ? 1 / value : value;
+        scale_node = node_view->node_index();
+        return fanin(*node_view, port);
+      }
+      return nullptr;
+    }
+    return node_view;
+  };
+
+  // The mask is added to the scaled scores.
+  const auto* scores = fanin(*softmax, 0);
+  const MutableNodeView* mask_add = nullptr;
+  int mask_port = kMissingIndex;
+  if (IsAdd(*scores->node()) && is_fusible(*scores, 2)) {
+    mask_add = scores;
+    scores = nullptr;
+    for (int port = 0; port < 2 && scores == nullptr; ++port) {
+      const auto* candidate = find_scores(fanin(*mask_add, 1 - port));
+      if (candidate != nullptr && IsAnyBatchMatMul(*candidate->node())) {
+        scores = candidate;
+        mask_port = port;
+      }
+    }
+    if (scores == nullptr) return false;
+    fused_nodes.push_back(mask_add->node_index());
+  } else {
+    scores = find_scores(scores);
+    if (scores == nullptr) return false;
+  }
+  if (!IsAnyBatchMatMul(*scores->node()) || !is_fusible(*scores, 2) ||
+      !TryGetNodeAttr(*scores->node(), "adj_x", &adj_x) ||
+      !TryGetNodeAttr(*scores->node(), "adj_y", &adj_y) || adj_x || !adj_y) {
+    return false;
+  }
+  fused_nodes.push_back(scores->node_index());
+  if (scale_node != kMissingIndex) fused_nodes.push_back(scale_node);
+
+  // BatchMatMulV2 broadcasts the batch dimensions, which the fused kernel does
+  // not, and the mask may only broadcast to the scores.
+  const auto& scores_props =
+      ctx.graph_properties.GetInputProperties(scores->node()->name());
+  const auto& root_props =
+      ctx.graph_properties.GetInputProperties(root_def->name());
+  const auto& probs_props =
+      ctx.graph_properties.GetOutputProperties(softmax->node()->name());
+  if (scores_props.size() != 2 || root_props.size() != 2 ||
+      probs_props.size() != 1) {
+    return false;
+  }
+  const TensorShapeProto& query_shape = scores_props[0].shape();
+  const TensorShapeProto& key_shape = scores_props[1].shape();
+  const TensorShapeProto& value_shape = root_props[1].shape();
+  const TensorShapeProto& probs_shape = probs_props[0].shape();
+  const int rank = Rank(query_shape);
+  if (rank < 3 || Rank(key_shape) != rank || Rank(value_shape) != rank ||
+      Rank(probs_shape) != rank) {
+    return false;
+  }
+  for (int i = 0; i < rank - 2; ++i) {
+    const int64_t dim = query_shape.dim(i).size();
+    if (dim == -1 || key_shape.dim(i).size() != dim ||
+        value_shape.dim(i).size() != dim) {
+      return false;
+    }
+  }
+  if (mask_add != nullptr) {
+    const auto& mask_props =
+        ctx.graph_properties.GetInputProperties(mask_add->node()->name());
+    if (mask_props.size() != 2) return false;
+    const TensorShapeProto& mask_shape = mask_props[mask_port].shape();
+    if (Rank(mask_shape) != rank) return false;
+    for (int i = 0; i < rank; ++i) {
+      const int64_t dim = mask_shape.dim(i).size();
+      if (dim != 1 && (dim == -1 || dim != probs_shape.dim(i).size())) {
+        return false;
+      }
+    }
+  }
+
+  matched->output = node_index;
+  matched->query = scores->node()->input(0);
+  matched->key = scores->node()->input(1);
+  matched->value = root_def->input(1);
+  if (mask_add != nullptr) matched->mask = mask_add->node()->input(mask_port);
+  matched->scale = scale;
+  matched->fused_nodes = std::move(fused_nodes);
+  return true;
+}
+
 bool FindFusedBatchMatMul(RemapperContext* ctx, int node_index,
                           std::map<string, int>* matched_nodes_map,
                           std::set<int>* remove_node_indices) {
@@ -2841,6 +3567,175 @@ Status AddTensorToHashBucketNode(RemapperContext* ctx,
   return Status::OK();
 }
 
+Status AddSparseSegmentOnIdsNode(RemapperContext* ctx,
+                                 const UniqueGatherSparseSegment& matched,
+                                 std::vector<bool>* invalidated_nodes,
+                                 std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& unique = graph->node(matched.unique);
+  const NodeDef& gather = graph->node(matched.gather);
+  const NodeDef& sparse_segment = graph->node(matched.sparse_segment);
+  VLOG(2) << "Fuse Unique and " << gather.op() << " into "
+          << sparse_segment.op() << ": unique=" << unique.name()
+          << " gather=" << gather.name()
+          << " sparse_segment=" << sparse_segment.name();
+
+  NodeDef fused_op;
+  fused_op.set_name(sparse_segment.name());
+  fused_op.set_op(sparse_segment.op());
+  fused_op.set_device(sparse_segment.device());
+  fused_op.add_input(gather.input(0));  // 0: params
+  fused_op.add_input(unique.input(0));  // 1: ids
+  for (int i = 2; i < sparse_segment.input_size(); ++i) {
+    fused_op.add_input(sparse_segment.input(i));  // segment_ids, num_segments
+  }
+  *fused_op.mutable_attr() = sparse_segment.attr();
+  (*fused_op.mutable_attr())["Tidx"] = unique.attr().at("T");
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.sparse_segment] = true;
+  (*nodes_to_delete)[matched.gather] = true;
+  (*nodes_to_delete)[matched.unique] = true;
+
+  return Status::OK();
+}
+
+Status AddFusedElementwiseNode(RemapperContext* ctx,
+                               const FusedElementwiseChain& matched,
+                               std::vector<bool>* invalidated_nodes,
+                               std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& root = graph->node(matched.nodes.front());
+  VLOG(2) << "Fuse element-wise chain: ["
+          << absl::StrJoin(matched.fused_ops, ", ")
+          << "] cast=" << (matched.cast != kMissingIndex)
+          << " root=" << root.name() << " on device=" << root.device();
+
+  NodeDef fused_op;
+  fused_op.set_name(root.name());
+  fused_op.set_op(kFusedElementwise);
+  fused_op.set_device(root.device());
+  fused_op.add_input(matched.input);  // 0: x
+  for (const string& arg : matched.args) fused_op.add_input(arg);
+
+  auto* attr = fused_op.mutable_attr();
+  const auto& dtype = root.attr().at("T");
+  (*attr)["T"] = dtype;
+  if (matched.cast != kMissingIndex) {
+    (*attr)["Tx"] = graph->node(matched.cast).attr().at("SrcT");
+  } else {
+    (*attr)["Tx"] = dtype;
+  }
+  SetAttrValue(static_cast<int>(matched.args.size()), &(*attr)["num_args"]);
+  SetAttrValue(matched.fused_ops, &(*attr)["fused_ops"]);
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.nodes.front()] = true;
+  for (int i = 1; i < matched.nodes.size(); ++i) {
+    (*nodes_to_delete)[matched.nodes[i]] = true;
+  }
+  if (matched.cast != kMissingIndex) {
+    (*nodes_to_delete)[matched.cast] = true;
+  }
+
+  return Status::OK();
+}
+
+Status AddFusedLayerNormNode(RemapperContext* ctx, const LayerNorm& matched,
+                             std::vector<bool>* invalidated_nodes,
+                             std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& output = graph->node(matched.output);
+  VLOG(2) << "Fuse layer normalization: output=" << output.name()
+          << " input=" << matched.input << " epsilon=" << matched.epsilon
+          << " on device=" << output.device();
+
+  NodeDef fused_op;
+  fused_op.set_name(output.name());
+  fused_op.set_op(kFusedLayerNorm);
+  fused_op.set_device(output.device());
+  fused_op.add_input(matched.input);   // 0: x
+  fused_op.add_input(matched.scale);   // 1: scale
+  fused_op.add_input(matched.offset);  // 2: offset
+
+  auto* attr = fused_op.mutable_attr();
+  (*attr)["T"] = output.attr().at("T");
+  SetAttrValue(matched.epsilon, &(*attr)["epsilon"]);
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.output] = true;
+  for (int node_index : matched.fused_nodes) {
+    (*nodes_to_delete)[node_index] = true;
+  }
+
+  return Status::OK();
+}
+
+Status AddFusedAttentionNode(RemapperContext* ctx, const Attention& matched,
+                             std::vector<bool>* invalidated_nodes,
+                             std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& output = graph->node(matched.output);
+  VLOG(2) << "Fuse attention: output=" << output.name()
+          << " scale=" << matched.scale
+          << " masked=" << !matched.mask.empty()
+          << " on device=" << output.device();
+
+  NodeDef fused_op;
+  fused_op.set_name(output.name());
+  fused_op.set_op(kFusedAttention);
+  fused_op.set_device(output.device());
+  fused_op.add_input(matched.query);  // 0: query
+  fused_op.add_input(matched.key);    // 1: key
+  fused_op.add_input(matched.value);  // 2: value
+  if (!matched.mask.empty()) fused_op.add_input(matched.mask);
+
+  auto* attr = fused_op.mutable_attr();
+  (*attr)["T"] = output.attr().at("T");
+  SetAttrValue(matched.scale, &(*attr)["scale"]);
+  SetAttrValue(matched.mask.empty() ? 0 : 1, &(*attr)["num_args"]);
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.output] = true;
+  for (int node_index : matched.fused_nodes) {
+    (*nodes_to_delete)[node_index] = true;
+  }
+
+  return Status::OK();
+}
+
+Status AddRhsIsConstantAttr(RemapperContext* ctx, int node_index) {
+  auto* node_view = ctx->graph_view.GetNode(node_index);
+  VLOG(2) << "Mark the weights of MatMul as constant: "
+          << node_view->node()->name();
+
+  AttrValue attr;
+  attr.set_b(true);
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  mutation->AddOrUpdateNodeAttr(node_view, kRhsIsConstant, attr);
+  return mutation->Apply();
+}
+
 Status AddFusedBatchMatMul(RemapperContext* ctx,
                            const std::map<string, int>& matched_nodes_map,
                            const std::set<int>& remove_node_indices,
@@ -3046,6 +3941,8 @@ Status ReplaceSoftplusTanhAndMulWithMish(
 //   (3) Fusing Conv2D biasadd and relu on GPU
 //   (4) INTEL_MKL specific: Conv2D -> Add or Conv2D -> BiasAdd -> Add.
 //   (5) Fusing side output and/or activation into FusedBatchNormGrad.
+//   (6) Fusing chains of element-wise ops into _FusedElementwise.
+//   (7) Fusing LayerNorm and attention blocks on CPU.
 bool RequiresInferredShapes(const RemapperContext& ctx, int node_index) {
   // Candidate for a FusedBatchNorm splitting.
   const auto* node_view = ctx.graph_view.GetNode(node_index);
@@ -3118,6 +4015,15 @@ bool RequiresInferredShapes(const RemapperContext& ctx, int node_index) {
     return false;
   };
 
+  // Candidate for an element-wise chain with binary ops.
+  const auto is_fused_elementwise_candidate = [&]() -> bool {
+    if (ctx.xla_auto_clustering_on || !NodeIsOnCpu(node_def)) return false;
+    bool is_commutative;
+    return IsFusedElementwiseDataType(GetDataTypeFromAttr(*node_def, "T")) &&
+           (IsFusedElementwiseUnaryOp(*node_def) ||
+            IsFusedElementwiseBinaryOp(*node_def, &is_commutative));
+  };
+
   // Candidate for a FusedBatchNormGrad fusion.
   const auto is_batch_norm_grad_fusion_candidate = [&]() -> bool {
     if (!IsFusedBatchNormGrad(*node_def)) return false;
@@ -3135,13 +4041,37 @@ bool RequiresInferredShapes(const RemapperContext& ctx, int node_index) {
     return false;
   };
 
+  // Candidate for a LayerNorm fusion: x * inv + (offset - mean * inv).
+  const auto is_layer_norm_candidate = [&]() -> bool {
+    if (!IsAdd(*node_def) || !NodeIsOnCpu(node_def) ||
+        !HasDataType(node_def, DT_FLOAT)) {
+      return false;
+    }
+    for (const auto& fanin : node_view->GetRegularFanins()) {
+      if (IsSub(*fanin.node_view()->node())) return true;
+    }
+    return false;
+  };
+
+  // Candidate for an attention fusion: BatchMatMul(Softmax(...), value).
+  const auto is_attention_candidate = [&]() -> bool {
+    if (!IsAnyBatchMatMul(*node_def) || !NodeIsOnCpu(node_def) ||
+        !HasDataType(node_def, DT_FLOAT) || node_view->NumRegularFanins() < 1) {
+      return false;
+    }
+    return IsSoftmax(*node_view->GetRegularFanin(0).node_view()->node());
+  };
+
   if (IsMKLEnabled())
     return is_batch_norm_candidate() || is_batch_norm_fusion_candidate() ||
-           IsContractionWithAdd(ctx, node_index);
+           IsContractionWithAdd(ctx, node_index) ||
+           is_layer_norm_candidate() || is_attention_candidate();
 
   return is_relu_biasadd_conv_candidate() || is_batch_norm_candidate() ||
          is_batch_norm_fusion_candidate() ||
-         is_batch_norm_grad_fusion_candidate();
+         is_batch_norm_grad_fusion_candidate() ||
+         is_fused_elementwise_candidate() || is_layer_norm_candidate() ||
+         is_attention_candidate();
 }
 }  // namespace
 
@@ -3369,6 +4299,19 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
       continue;
     }
 
+    // Remap Unique+Gather+SparseSegment{Sum,Mean,SqrtN} on CPU into a single
+    // SparseSegment{Sum,Mean,SqrtN} reading the rows of the params at the
+    // original ids, so that the gathered rows are never materialized.  The
+    // gradient would change from an IndexedSlices to a dense one.
+    UniqueGatherSparseSegment unique_gather_sparse_segment;
+    if (allow_non_differentiable_rewrites &&
+        FindUniqueGatherSparseSegment(ctx, i, &unique_gather_sparse_segment)) {
+      TF_RETURN_IF_ERROR(AddSparseSegmentOnIdsNode(
+          &ctx, unique_gather_sparse_segment, &invalidated_nodes,
+          &nodes_to_delete));
+      continue;
+    }
+
     // During inference, most of the inputs to FusedBatchNorm are constant, and
     // we can therefore replace the op with a much cheaper set of primitives.
     FusedBatchNorm fused_batch_norm;
@@ -3376,6 +4319,62 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
       TF_RETURN_IF_ERROR(AddBatchNormNodes(&ctx, fused_batch_norm));
       continue;
     }
+
+    // Remap MatMul+BiasAdd+Gelu into the _FusedMatMul. With oneDNN this is
+    // done above.
+    if (!IsMKLEnabled() && allow_non_differentiable_rewrites) {
+      std::map<string, int> matched_nodes_map;
+      std::set<int> remove_node_indices;
+      bool is_gelu_approximate = false;
+      if (FindMatMulBiasAddAndGelu(&ctx, i, &matched_nodes_map,
+                                   &remove_node_indices,
+                                   &is_gelu_approximate)) {
+        TF_RETURN_IF_ERROR(AddFusedMatMulBiasAddAndGelu(
+            &ctx, matched_nodes_map, remove_node_indices, &invalidated_nodes,
+            &nodes_to_delete, is_gelu_approximate));
+        continue;
+      }
+    }
+
+    // Remap the ops of tf.nn.moments and tf.nn.batch_normalization over the
+    // innermost dimension on CPU into the _FusedLayerNorm.
+    LayerNorm layer_norm;
+    if (allow_non_differentiable_rewrites &&
+        FindLayerNorm(ctx, i, &layer_norm)) {
+      TF_RETURN_IF_ERROR(AddFusedLayerNormNode(&ctx, layer_norm,
+                                               &invalidated_nodes,
+                                               &nodes_to_delete));
+      continue;
+    }
+
+    // Remap BatchMatMul+Mul+Add+Softmax+BatchMatMul on CPU into the
+    // _FusedAttention, which never materializes the scores.
+    Attention attention;
+    if (allow_non_differentiable_rewrites &&
+        FindAttention(ctx, i, &attention)) {
+      TF_RETURN_IF_ERROR(AddFusedAttentionNode(&ctx, attention,
+                                               &invalidated_nodes,
+                                               &nodes_to_delete));
+      continue;
+    }
+
+    // Remap chains of element-wise ops on CPU into the _FusedElementwise, so
+    // that the intermediate results are neither allocated nor scheduled.
+    FusedElementwiseChain fused_elementwise_chain;
+    if (allow_non_differentiable_rewrites &&
+        FindFusedElementwiseChain(ctx, i, &fused_elementwise_chain)) {
+      TF_RETURN_IF_ERROR(AddFusedElementwiseNode(&ctx, fused_elementwise_chain,
+                                                 &invalidated_nodes,
+                                                 &nodes_to_delete));
+      continue;
+    }
+
+    // Let the CPU MatMul kernel cache the packed form of weights that do not
+    // change between steps.
+    if (FindMatMulWithConstantRhs(ctx, i)) {
+      TF_RETURN_IF_ERROR(AddRhsIsConstantAttr(&ctx, i));
+      continue;
+    }
   }
 
   // Remove invalidated nodes.
@@ -1350,6 +1350,597 @@ TEST_F(RemapperTensorToHashBucketTest, I32) { RunTest<DT_INT32>(); }
 
 TEST_F(RemapperTensorToHashBucketTest, I64) { RunTest<DT_INT64>(); }
 
+TEST_F(RemapperTest, FuseElementwiseChain) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto input_shape = ops::Placeholder::Shape({8, 32});
+  auto input = Placeholder(s.WithOpName("input"), DT_INT32, input_shape);
+  auto bias = Placeholder(s.WithOpName("bias"), DT_FLOAT, input_shape);
+  auto scale = ops::Const(s.WithOpName("scale"), 0.5f, {});
+
+  auto cast = ops::Cast(s.WithOpName("cast"), input, DT_FLOAT);
+  auto mul = ops::Mul(s.WithOpName("mul"), scale, cast);
+  auto add = ops::AddV2(s.WithOpName("add"), mul, bias);
+  auto relu = ops::Relu(s.WithOpName("relu"), add);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), relu);
+
+  auto input_t = GenerateRandomTensor<DT_INT32>({8, 32});
+  auto bias_t = GenerateRandomTensor<DT_FLOAT>({8, 32});
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  item.feed = {{"input", input_t}, {"bias", bias_t}};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.name(), "cast");
+    EXPECT_NE(node.name(), "mul");
+    EXPECT_NE(node.name(), "add");
+    if (node.name() == "relu") {
+      EXPECT_EQ(node.op(), "_FusedElementwise");
+      ASSERT_EQ(node.input_size(), 3);
+      EXPECT_EQ(node.input(0), "input");
+      EXPECT_EQ(node.input(1), "scale");
+      EXPECT_EQ(node.input(2), "bias");
+
+      const auto& attr = node.attr();
+      EXPECT_EQ(attr.at("T").type(), DT_FLOAT);
+      EXPECT_EQ(attr.at("Tx").type(), DT_INT32);
+      EXPECT_EQ(attr.at("num_args").i(), 2);
+      const auto& fused_ops = attr.at("fused_ops").list().s();
+      ASSERT_EQ(fused_ops.size(), 3);
+      EXPECT_EQ(fused_ops[0], "Mul");
+      EXPECT_EQ(fused_ops[1], "AddV2");
+      EXPECT_EQ(fused_ops[2], "Relu");
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 1);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors_expected.size(), 1);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-6);
+}
+
+TEST_F(RemapperTest, FuseElementwiseChainStopsAtSharedOrBroadcastingOps) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto input = Placeholder(s.WithOpName("input"), DT_FLOAT,
+                           ops::Placeholder::Shape({8, 32}));
+  auto row = Placeholder(s.WithOpName("row"), DT_FLOAT,
+                         ops::Placeholder::Shape({32}));
+
+  // `bcast` broadcasts its second input, and `exp` has two consumers.
+  auto bcast = ops::Sub(s.WithOpName("bcast"), input, row);
+  auto tanh = ops::Tanh(s.WithOpName("tanh"), bcast);
+  auto exp = ops::Exp(s.WithOpName("exp"), tanh);
+  auto neg = ops::Neg(s.WithOpName("neg"), exp);
+  auto sqrt = ops::Sqrt(s.WithOpName("sqrt"), exp);
+  auto fetch0 = ops::Identity(s.WithOpName("fetch0"), neg);
+  auto fetch1 = ops::Identity(s.WithOpName("fetch1"), sqrt);
+
+  GrapplerItem item;
+  item.fetch = {"fetch0", "fetch1"};
+  item.feed = {{"input", GenerateRandomTensor<DT_FLOAT>({8, 32})},
+               {"row", GenerateRandomTensor<DT_FLOAT>({32})}};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "bcast") {
+      EXPECT_EQ(node.op(), "Sub");
+      found++;
+    } else if (node.name() == "exp") {
+      EXPECT_EQ(node.op(), "_FusedElementwise");
+      ASSERT_EQ(node.input_size(), 1);
+      EXPECT_EQ(node.input(0), "bcast");
+      const auto& fused_ops = node.attr().at("fused_ops").list().s();
+      ASSERT_EQ(fused_ops.size(), 2);
+      EXPECT_EQ(fused_ops[0], "Tanh");
+      EXPECT_EQ(fused_ops[1], "Exp");
+      found++;
+    } else if (node.name() == "neg" || node.name() == "sqrt") {
+      EXPECT_NE(node.op(), "_FusedElementwise");
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 4);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors_expected.size(), 2);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(tensors.size(), 2);
+  test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-6);
+  test::ExpectTensorNear<float>(tensors[1], tensors_expected[1], 1e-6);
+}
+
+TEST_F(RemapperTest, MarkMatMulWithConstantWeights) {
+  if (IsMKLEnabled()) GTEST_SKIP() << "MatMul is rewritten by oneDNN.";
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto input = Placeholder(s.WithOpName("input"), DT_FLOAT,
+                           ops::Placeholder::Shape({4, 16}));
+  auto fed_weights = Placeholder(s.WithOpName("fed_weights"), DT_FLOAT,
+                                 ops::Placeholder::Shape({16, 24}));
+  auto weights_t = GenerateRandomTensor<DT_FLOAT>({16, 24});
+  auto weights = ops::Const(s.WithOpName("weights"), weights_t);
+
+  auto const_matmul = ops::MatMul(s.WithOpName("const_matmul"), input, weights);
+  auto fed_matmul = ops::MatMul(s.WithOpName("fed_matmul"), input, fed_weights);
+  auto fetch0 = ops::Identity(s.WithOpName("fetch0"), const_matmul);
+  auto fetch1 = ops::Identity(s.WithOpName("fetch1"), fed_matmul);
+
+  GrapplerItem item;
+  item.fetch = {"fetch0", "fetch1"};
+  item.feed = {{"input", GenerateRandomTensor<DT_FLOAT>({4, 16})},
+               {"fed_weights", weights_t}};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "const_matmul") {
+      EXPECT_EQ(node.op(), "MatMul");
+      ASSERT_EQ(node.attr().count("_rhs_is_constant"), 1);
+      EXPECT_TRUE(node.attr().at("_rhs_is_constant").b());
+      found++;
+    } else if (node.name() == "fed_matmul") {
+      EXPECT_EQ(node.attr().count("_rhs_is_constant"), 0);
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 2);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors_expected.size(), 2);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(tensors.size(), 2);
+  test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-5);
+  test::ExpectTensorNear<float>(tensors[1], tensors_expected[1], 1e-5);
+}
+
+TEST_F(RemapperTest, FuseUniqueGatherSparseSegmentMean) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto params = Placeholder(s.WithOpName("params"), DT_FLOAT,
+                            ops::Placeholder::Shape({16, 8}));
+  auto ids = Placeholder(s.WithOpName("ids"), DT_INT64,
+                         ops::Placeholder::Shape({6}));
+  auto segment_ids = ops::Const(s.WithOpName("segment_ids"),
+                                {0, 0, 1, 3, 3, 3}, {6});
+  auto axis = ops::Const(s.WithOpName("axis"), 0, {});
+
+  auto unique = ops::Unique(s.WithOpName("unique"), ids);
+  auto gather = ops::GatherV2(s.WithOpName("gather"), params, unique.y, axis);
+  auto mean = ops::SparseSegmentMean(s.WithOpName("mean"), gather, unique.idx,
+                                     segment_ids);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), mean);
+
+  auto params_t = GenerateRandomTensor<DT_FLOAT>({16, 8});
+  auto ids_t = test::AsTensor<int64_t>({3, 7, 3, 15, 0, 7});
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  item.feed = {{"params", params_t}, {"ids", ids_t}};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.name(), "unique");
+    EXPECT_NE(node.name(), "gather");
+    if (node.name() == "mean") {
+      EXPECT_EQ(node.op(), "SparseSegmentMean");
+      ASSERT_EQ(node.input_size(), 3);
+      EXPECT_EQ(node.input(0), "params");
+      EXPECT_EQ(node.input(1), "ids");
+      EXPECT_EQ(node.input(2), "segment_ids");
+      EXPECT_EQ(node.attr().at("Tidx").type(), DT_INT64);
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 1);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors_expected.size(), 1);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-6);
+}
+
+TEST_F(RemapperTest, FuseLayerNorm) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  // The ops of tf.nn.moments and tf.nn.batch_normalization.
+  auto x = Placeholder(s.WithOpName("x"), DT_FLOAT,
+                       ops::Placeholder::Shape({4, 6, 16}));
+  auto scale = Placeholder(s.WithOpName("scale"), DT_FLOAT,
+                           ops::Placeholder::Shape({16}));
+  auto offset = Placeholder(s.WithOpName("offset"), DT_FLOAT,
+                            ops::Placeholder::Shape({16}));
+  auto axes = ops::Const(s.WithOpName("axes"), {-1}, {1});
+  auto epsilon = ops::Const(s.WithOpName("epsilon"), 0.001f, {});
+
+  auto mean = ops::Mean(s.WithOpName("mean"), x, axes,
+                        ops::Mean::KeepDims(true));
+  auto stop_gradient = ops::StopGradient(s.WithOpName("stop_gradient"), mean);
+  auto squared_difference = ops::SquaredDifference(
+      s.WithOpName("squared_difference"), x, stop_gradient);
+  auto variance = ops::Mean(s.WithOpName("variance"), squared_difference,
+                            axes, ops::Mean::KeepDims(true));
+  auto variance_plus_epsilon =
+      ops::AddV2(s.WithOpName("variance_plus_epsilon"), variance, epsilon);
+  auto rsqrt = ops::Rsqrt(s.WithOpName("rsqrt"), variance_plus_epsilon);
+  auto inv = ops::Mul(s.WithOpName("inv"), rsqrt, scale);
+  auto x_times_inv = ops::Mul(s.WithOpName("x_times_inv"), x, inv);
+  auto mean_times_inv = ops::Mul(s.WithOpName("mean_times_inv"), mean, inv);
+  auto offset_minus =
+      ops::Sub(s.WithOpName("offset_minus"), offset, mean_times_inv);
+  auto output = ops::AddV2(s.WithOpName("output"), x_times_inv, offset_minus);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), output);
+
+  auto x_t = GenerateRandomTensor<DT_FLOAT>({4, 6, 16});
+  auto scale_t = GenerateRandomTensor<DT_FLOAT>({16});
+  auto offset_t = GenerateRandomTensor<DT_FLOAT>({16});
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  item.feed = {{"x", x_t}, {"scale", scale_t}, {"offset", offset_t}};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output_graph;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output_graph));
+
+  int found = 0;
+  for (const NodeDef& node : output_graph.node()) {
+    EXPECT_NE(node.name(), "mean");
+    EXPECT_NE(node.name(), "stop_gradient");
+    EXPECT_NE(node.name(), "rsqrt");
+    EXPECT_NE(node.name(), "offset_minus");
+    if (node.name() == "output") {
+      EXPECT_EQ(node.op(), "_FusedLayerNorm");
+      ASSERT_EQ(node.input_size(), 3);
+      EXPECT_EQ(node.input(0), "x");
+      EXPECT_EQ(node.input(1), "scale");
+      EXPECT_EQ(node.input(2), "offset");
+      EXPECT_FLOAT_EQ(node.attr().at("epsilon").f(), 0.001f);
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 1);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors_expected.size(), 1);
+  auto tensors = EvaluateNodes(output_graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-5);
+}
+
+TEST_F(RemapperTest, FuseLayerNormRequiresPrivateStatistics) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto x = Placeholder(s.WithOpName("x"), DT_FLOAT,
+                       ops::Placeholder::Shape({4, 16}));
+  auto scale = Placeholder(s.WithOpName("scale"), DT_FLOAT,
+                           ops::Placeholder::Shape({16}));
+  auto offset = Placeholder(s.WithOpName("offset"), DT_FLOAT,
+                            ops::Placeholder::Shape({16}));
+  auto axes = ops::Const(s.WithOpName("axes"), {1}, {1});
+  auto epsilon = ops::Const(s.WithOpName("epsilon"), 0.001f, {});
+
+  auto mean = ops::Mean(s.WithOpName("mean"), x, axes,
+                        ops::Mean::KeepDims(true));
+  auto squared_difference =
+      ops::SquaredDifference(s.WithOpName("squared_difference"), x, mean);
+  auto variance = ops::Mean(s.WithOpName("variance"), squared_difference,
+                            axes, ops::Mean::KeepDims(true));
+  auto variance_plus_epsilon =
+      ops::AddV2(s.WithOpName("variance_plus_epsilon"), variance, epsilon);
+  auto rsqrt = ops::Rsqrt(s.WithOpName("rsqrt"), variance_plus_epsilon);
+  auto inv = ops::Mul(s.WithOpName("inv"), rsqrt, scale);
+  auto x_times_inv = ops::Mul(s.WithOpName("x_times_inv"), x, inv);
+  auto mean_times_inv = ops::Mul(s.WithOpName("mean_times_inv"), mean, inv);
+  auto offset_minus =
+      ops::Sub(s.WithOpName("offset_minus"), offset, mean_times_inv);
+  auto output = ops::AddV2(s.WithOpName("output"), x_times_inv, offset_minus);
+  // The variance is also fetched, so it cannot be fused away.
+  auto fetch = ops::Identity(s.WithOpName("fetch"), output);
+  auto fetch_variance =
+      ops::Identity(s.WithOpName("fetch_variance"), variance);
+
+  GrapplerItem item;
+  item.fetch = {"fetch", "fetch_variance"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output_graph;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output_graph));
+
+  for (const NodeDef& node : output_graph.node()) {
+    EXPECT_NE(node.op(), "_FusedLayerNorm");
+  }
+}
+
+TEST_F(RemapperTest, FuseAttention) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto query = Placeholder(s.WithOpName("query"), DT_FLOAT,
+                           ops::Placeholder::Shape({2, 4, 10, 8}));
+  auto key = Placeholder(s.WithOpName("key"), DT_FLOAT,
+                         ops::Placeholder::Shape({2, 4, 12, 8}));
+  auto value = Placeholder(s.WithOpName("value"), DT_FLOAT,
+                           ops::Placeholder::Shape({2, 4, 12, 6}));
+  auto mask = Placeholder(s.WithOpName("mask"), DT_FLOAT,
+                          ops::Placeholder::Shape({2, 1, 1, 12}));
+  auto scale = ops::Const(s.WithOpName("scale"), 0.35f, {});
+
+  auto scores = ops::BatchMatMulV2(s.WithOpName("scores"), query, key,
+                                   ops::BatchMatMulV2::AdjY(true));
+  auto scaled = ops::Mul(s.WithOpName("scaled"), scores, scale);
+  auto masked = ops::AddV2(s.WithOpName("masked"), scaled, mask);
+  auto probs = ops::Softmax(s.WithOpName("probs"), masked);
+  auto attention = ops::BatchMatMulV2(s.WithOpName("attention"), probs, value);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), attention);
+
+  auto query_t = GenerateRandomTensor<DT_FLOAT>({2, 4, 10, 8});
+  auto key_t = GenerateRandomTensor<DT_FLOAT>({2, 4, 12, 8});
+  auto value_t = GenerateRandomTensor<DT_FLOAT>({2, 4, 12, 6});
+  auto mask_t = GenerateRandomTensor<DT_FLOAT>({2, 1, 1, 12});
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  item.feed = {{"query", query_t},
+               {"key", key_t},
+               {"value", value_t},
+               {"mask", mask_t}};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.name(), "scores");
+    EXPECT_NE(node.name(), "scaled");
+    EXPECT_NE(node.name(), "masked");
+    EXPECT_NE(node.name(), "probs");
+    if (node.name() == "attention") {
+      EXPECT_EQ(node.op(), "_FusedAttention");
+      ASSERT_EQ(node.input_size(), 4);
+      EXPECT_EQ(node.input(0), "query");
+      EXPECT_EQ(node.input(1), "key");
+      EXPECT_EQ(node.input(2), "value");
+      EXPECT_EQ(node.input(3), "mask");
+      EXPECT_FLOAT_EQ(node.attr().at("scale").f(), 0.35f);
+      EXPECT_EQ(node.attr().at("num_args").i(), 1);
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 1);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors_expected.size(), 1);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-5);
+}
+
+TEST_F(RemapperTest, FuseAttentionRequiresMatchingBatchDimensions) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  // The key and value are broadcast over the heads of the query.
+  auto query = Placeholder(s.WithOpName("query"), DT_FLOAT,
+                           ops::Placeholder::Shape({2, 4, 10, 8}));
+  auto key = Placeholder(s.WithOpName("key"), DT_FLOAT,
+                         ops::Placeholder::Shape({2, 1, 12, 8}));
+  auto value = Placeholder(s.WithOpName("value"), DT_FLOAT,
+                           ops::Placeholder::Shape({2, 1, 12, 6}));
+
+  auto scores = ops::BatchMatMulV2(s.WithOpName("scores"), query, key,
+                                   ops::BatchMatMulV2::AdjY(true));
+  auto probs = ops::Softmax(s.WithOpName("probs"), scores);
+  auto attention = ops::BatchMatMulV2(s.WithOpName("attention"), probs, value);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), attention);
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.op(), "_FusedAttention");
+  }
+}
+
+class RemapperFuseMatMulWithBiasAndGeluTest : public RemapperTest {
+ protected:
+  // Builds MatMul + BiasAdd followed by the erf or the tanh form of Gelu.
+  void BuildGraph(bool approximate, GrapplerItem* item) {
+    using ::tensorflow::ops::Placeholder;
+
+    tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+    auto lhs = Placeholder(s.WithOpName("lhs"), DT_FLOAT,
+                           ops::Placeholder::Shape({8, 32}));
+    auto rhs = Placeholder(s.WithOpName("rhs"), DT_FLOAT,
+                           ops::Placeholder::Shape({32, 64}));
+    auto bias = Placeholder(s.WithOpName("bias"), DT_FLOAT,
+                            ops::Placeholder::Shape({64}));
+    auto one = ops::Const(s.WithOpName("one"), 1.0f, {});
+    auto one_half = ops::Const(s.WithOpName("one_half"), 0.5f, {});
+
+    auto matmul = ops::MatMul(s.WithOpName("matmul"), lhs, rhs);
+    auto bias_add = ops::BiasAdd(s.WithOpName("bias_add"), matmul, bias);
+
+    Output gelu_inner;
+    if (approximate) {
+      // The arithmetic optimizer rewrites Pow(x, 3) into Mul(x, Square(x)).
+      auto empirical_const =
+          ops::Const(s.WithOpName("empirical_const"), 0.044715f, {});
+      auto square_root_two_over_pi =
+          ops::Const(s.WithOpName("square_root_two_over_pi"), 0.7978845f, {});
+      auto empirical_const_times_x = ops::Mul(
+          s.WithOpName("empirical_const_times_x"), empirical_const, bias_add);
+      auto square = ops::Square(s.WithOpName("square"), bias_add);
+      auto cube = ops::Mul(s.WithOpName("cube"), empirical_const_times_x,
+                           square);
+      auto x_plus_cube = ops::AddV2(s.WithOpName("x_plus_cube"), bias_add,
+                                    cube);
+      auto tanh_input = ops::Mul(s.WithOpName("tanh_input"), x_plus_cube,
+                                 square_root_two_over_pi);
+      gelu_inner = ops::Tanh(s.WithOpName("tanh"), tanh_input);
+    } else {
+      auto square_root_one_half =
+          ops::Const(s.WithOpName("square_root_one_half"), 0.707106f, {});
+      auto erf_input = ops::Mul(s.WithOpName("erf_input"), bias_add,
+                                square_root_one_half);
+      gelu_inner = ops::Erf(s.WithOpName("erf"), erf_input);
+    }
+    auto plus_one = ops::AddV2(s.WithOpName("plus_one"), gelu_inner, one);
+    auto times_one_half =
+        ops::Mul(s.WithOpName("times_one_half"), plus_one, one_half);
+    auto gelu = ops::Mul(s.WithOpName("gelu"), times_one_half, bias_add);
+    auto fetch = ops::Identity(s.WithOpName("fetch"), gelu);
+
+    item->fetch = {"fetch"};
+    item->feed = {{"lhs", GenerateRandomTensor<DT_FLOAT>({8, 32})},
+                  {"rhs", GenerateRandomTensor<DT_FLOAT>({32, 64})},
+                  {"bias", GenerateRandomTensor<DT_FLOAT>({64})}};
+    TF_ASSERT_OK(s.ToGraphDef(&item->graph));
+
+    for (int i = 0; i < item->graph.node_size(); ++i) {
+      item->graph.mutable_node(i)->set_device("/device:CPU:0");
+    }
+  }
+
+  void VerifyFused(const GrapplerItem& item, const GraphDef& output,
+                   const string& gelu_type) {
+    int found = 0;
+    for (const NodeDef& node : output.node()) {
+      EXPECT_NE(node.name(), "plus_one");
+      EXPECT_NE(node.name(), "times_one_half");
+      if (node.name() == "gelu") {
+        EXPECT_EQ(node.op(), "_FusedMatMul");
+        ASSERT_EQ(node.input_size(), 3);
+        EXPECT_EQ(node.input(0), "lhs");
+        EXPECT_EQ(node.input(1), "rhs");
+        EXPECT_EQ(node.input(2), "bias");
+        const auto& fused_ops = node.attr().at("fused_ops").list().s();
+        ASSERT_EQ(fused_ops.size(), 2);
+        EXPECT_EQ(fused_ops[0], "BiasAdd");
+        EXPECT_EQ(fused_ops[1], gelu_type);
+        found++;
+      }
+    }
+    EXPECT_EQ(found, 1);
+
+    auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+    ASSERT_EQ(tensors_expected.size(), 1);
+    auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+    ASSERT_EQ(tensors.size(), 1);
+    test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-5);
+  }
+};
+
+TEST_F(RemapperFuseMatMulWithBiasAndGeluTest, GeluExact) {
+  GrapplerItem item;
+  BuildGraph(/*approximate=*/false, &item);
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  VerifyFused(item, output, "GeluExact");
+}
+
+TEST_F(RemapperFuseMatMulWithBiasAndGeluTest, GeluApproximate) {
+  GrapplerItem item;
+  BuildGraph(/*approximate=*/true, &item);
+
+  // The first pass fuses MatMul + BiasAdd, and leaves the Tanh to the second
+  // one, as the meta optimizer does.
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef first_pass;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &first_pass));
+  for (const NodeDef& node : first_pass.node()) {
+    EXPECT_NE(node.op(), "_FusedElementwise");
+  }
+
+  GrapplerItem first_pass_item = item.WithGraph(std::move(first_pass));
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, first_pass_item, &output));
+  VerifyFused(item, output, "GeluApproximate");
+}
+
 class RemapperFuseMatMulWithBiasTest : public RemapperTest {
  public:
   template <DataType DTYPE>
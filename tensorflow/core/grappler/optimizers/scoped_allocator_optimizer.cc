@@ -521,7 +521,8 @@ class UnaryElementwiseRewriter : public ScopedAllocatorOptimizer::Rewriter {
     sa_builder.Attr("id", sa_id);
     sa_builder.Attr("shapes", input_shapes);
     sa_builder.Attr("shape", sa_shape);
-    sa_builder.Attr("expected_call_count", static_cast<int64_t>(ops.size()));
+    sa_builder.Attr("expected_call_count",
+                    static_cast<int64_t>(inputs.size()));
     NodeDef* sa_node = graph->add_node();
     LOG_WARNING_AND_RETURN_IF_ERROR(sa_builder.Finalize(sa_node));
     node_map->AddNode(sa_name, sa_node);
@@ -886,12 +887,209 @@ class UnaryElementwiseRewriter : public ScopedAllocatorOptimizer::Rewriter {
   }
 };
 
+// Rewrites a ConcatV2 whose producers can allocate their outputs directly in
+// its output, which turns the concat into a _ScopedAllocatorConcat that only
+// checks that its inputs lie within the backing tensor:
+/*
+        a    b               ScopedAllocator
+         \  /                  ^a  ^b  |
+       ConcatV2       ->        a   b  |
+          |                      \  |  /
+          c                _ScopedAllocatorConcat
+                                    |
+                                    c
+*/
+// The _ScopedAllocatorConcat keeps the name of the ConcatV2, so its consumers
+// and fetches are unchanged.  Fields of a ScopedAllocator are aligned to
+// Allocator::kAllocatorAlignment, so the inputs are only contiguous in the
+// backing tensor, i.e. concatenated along the outermost dimension, when the
+// size of each of them is a multiple of the alignment.  Each ConcatV2 is
+// rewritten independently; one that does not qualify is left unchanged.
+class ConcatRewriter : public UnaryElementwiseRewriter {
+ public:
+  ~ConcatRewriter() override {}
+
+  bool RewritesIndividualNodes() const override { return true; }
+
+  Status Rewrite(ScopedAllocatorOptimizer* sa_opti, int64_t invocation_count,
+                 GraphDef* graph, const string& op_name,
+                 const std::vector<NodeDef*>& ops, bool* applied) override {
+    NodeMap* node_map = sa_opti->node_map();
+    for (NodeDef* concat : ops) {
+      DataType dtype;
+      std::vector<TensorShape> input_shapes;
+      TensorShape output_shape;
+      std::vector<InputDesc> inputs;
+      NodeDef* axis_node;
+      Status s = AnalyzeConcat(node_map, concat, &dtype, &input_shapes,
+                               &output_shape, &inputs, &axis_node);
+      if (errors::IsAborted(s)) {
+        VLOG(1) << "Not rewriting " << concat->name() << ": " << s;
+        continue;
+      }
+      TF_RETURN_IF_ERROR(s);
+
+      const int sa_id = sa_opti->NewScopedAllocatorId(input_shapes.size());
+      const string sa_name =
+          strings::StrCat("scoped_allocator_", sa_id, "_", invocation_count);
+      const string device_name = concat->device();
+      TF_RETURN_IF_ERROR(ConstructScopedAllocatorNode(
+          sa_opti, graph, node_map, {concat}, device_name, dtype, sa_id,
+          sa_name, input_shapes, inputs,
+          TensorShape({output_shape.num_elements()})));
+
+      NodeDefBuilder sac_builder(concat->name(), "_ScopedAllocatorConcat");
+      sac_builder.Device(device_name);
+      sac_builder.Attr("sa_name", sa_name);
+      sac_builder.Attr("id", sa_id);
+      sac_builder.Attr("T", dtype);
+      sac_builder.Attr("shape", output_shape);
+      sac_builder.Attr("reshape", true);
+      sac_builder.Attr("N", static_cast<int>(inputs.size()));
+      sac_builder.Input(NodeDefBuilder::NodeOut(sa_name, 0, dtype));
+      std::vector<NodeDefBuilder::NodeOut> sac_inputs;
+      for (const InputDesc& input : inputs) {
+        sac_inputs.emplace_back(input.from_node_def->name(), input.output_slot,
+                                dtype);
+      }
+      sac_builder.Input(sac_inputs);
+      NodeDef sac_node;
+      LOG_WARNING_AND_RETURN_IF_ERROR(sac_builder.Finalize(&sac_node));
+      for (const string& input_name : concat->input()) {
+        if (IsControlInput(input_name)) {
+          sac_node.add_input(input_name);
+        }
+      }
+      node_map->RemoveOutput(axis_node->name(), concat->name());
+      node_map->AddOutput(sa_name, concat->name());
+      *concat = std::move(sac_node);
+      VLOG(1) << "Rewrote " << concat->name() << " to allocate its "
+              << inputs.size() << " inputs from " << sa_name;
+      *applied = true;
+    }
+    return Status::OK();
+  }
+
+ private:
+  // Returns Aborted, without changing the graph, if `concat` can't be
+  // rewritten.  Otherwise returns the type, shapes and producers of the
+  // concatenated inputs, the shape of the output and the node of the axis.
+  Status AnalyzeConcat(NodeMap* node_map, const NodeDef* concat,
+                       DataType* dtype, std::vector<TensorShape>* input_shapes,
+                       TensorShape* output_shape,
+                       std::vector<InputDesc>* inputs, NodeDef** axis_node) {
+    int num_inputs;
+    TF_RETURN_IF_ERROR(GetNodeAttr(*concat, "N", &num_inputs));
+    TF_RETURN_IF_ERROR(GetNodeAttr(*concat, "T", dtype));
+    if (num_inputs < 2) {
+      return errors::Aborted("Fewer than 2 inputs");
+    }
+    if (concat->device().empty()) {
+      return errors::Aborted("No assigned device");
+    }
+    if (!DataTypeCanUseMemcpy(*dtype) ||
+        Allocator::kAllocatorAlignment % DataTypeSize(*dtype) != 0) {
+      return errors::Aborted("Unsupported type ", DataTypeString(*dtype));
+    }
+    if (!graph_properties_->HasInputProperties(concat->name())) {
+      return errors::Aborted("No input properties");
+    }
+    const std::vector<OpInfo::TensorProperties>& input_props =
+        graph_properties_->GetInputProperties(concat->name());
+    if (input_props.size() != num_inputs + 1) {
+      return errors::Aborted("Unexpected number of input properties");
+    }
+
+    *axis_node = node_map->GetNode(concat->input(num_inputs));
+    Tensor axis_tensor;
+    if (*axis_node == nullptr || !IsConstant(**axis_node) ||
+        !GetNodeAttr(**axis_node, "value", &axis_tensor).ok() ||
+        axis_tensor.NumElements() != 1) {
+      return errors::Aborted("Axis is not a constant");
+    }
+    int64_t axis = axis_tensor.dtype() == DT_INT32
+                       ? axis_tensor.flat<int32>()(0)
+                       : axis_tensor.flat<int64_t>()(0);
+
+    absl::flat_hash_set<string> input_tensors;
+    for (int i = 0; i < num_inputs; ++i) {
+      const TensorShapeProto& shape = input_props[i].shape();
+      if (!TensorShape::IsValid(shape) || shape.unknown_rank()) {
+        return errors::Aborted("Complete shape not known for input ", i);
+      }
+      input_shapes->emplace_back(shape);
+      const TensorShape& input_shape = input_shapes->back();
+      if (i == 0) {
+        if (axis < 0) axis += input_shape.dims();
+        if (axis < 0 || axis >= input_shape.dims()) {
+          return errors::Aborted("Invalid axis ", axis);
+        }
+        *output_shape = input_shape;
+      } else {
+        output_shape->set_dim(axis,
+                              output_shape->dim_size(axis) +
+                                  input_shape.dim_size(axis));
+      }
+      // The inputs are concatenated in memory only if all the dimensions
+      // before the axis are 1.
+      for (int d = 0; d < axis; ++d) {
+        if (input_shape.dim_size(d) != 1) {
+          return errors::Aborted("Not concatenating along the outermost ",
+                                 "non-trivial dimension");
+        }
+      }
+      if (input_shape.num_elements() * DataTypeSize(*dtype) %
+              Allocator::kAllocatorAlignment !=
+          0) {
+        return errors::Aborted("Size of input ", i, " is not a multiple of ",
+                               Allocator::kAllocatorAlignment, " bytes");
+      }
+
+      int output_slot;
+      const string producer_name =
+          ParseNodeName(concat->input(i), &output_slot);
+      NodeDef* producer = node_map->GetNode(producer_name);
+      if (producer == nullptr) {
+        return errors::Internal("Did not find node ", producer_name);
+      }
+      if (!input_tensors.insert(strings::StrCat(producer_name, ":",
+                                                output_slot))
+               .second) {
+        return errors::Aborted("Input ", concat->input(i), " is repeated");
+      }
+      // Consts and _Args don't use the AllocatorAttributes set by the
+      // executor, and frame boundaries can't get a control edge from the
+      // ScopedAllocator.  Other consumers of a producer could modify its
+      // output in place before it is concatenated.
+      if (IsConstant(*producer) || IsArg(*producer) ||
+          ModifiesFrameInfo(*producer) || IsSwitch(*producer) ||
+          IsMerge(*producer)) {
+        return errors::Aborted("Unsupported producer ", producer->name(),
+                               " of type ", producer->op());
+      }
+      if (producer->device() != concat->device()) {
+        return errors::Aborted("Producer ", producer->name(),
+                               " is on another device");
+      }
+      if (node_map->GetOutputs(producer_name).size() != 1) {
+        return errors::Aborted("Producer ", producer->name(),
+                               " has other consumers");
+      }
+      inputs->emplace_back(producer, output_slot,
+                           const_cast<NodeDef*>(concat));
+    }
+    return CheckExistingScopedAllocator(*inputs);
+  }
+};
+
 ScopedAllocatorOptimizer::ScopedAllocatorOptimizer(
     RewriterConfig::Toggle opt_level, const ScopedAllocatorOptions& opts)
     : opt_level_(opt_level) {
   VLOG(1) << "ScopedAllocatorOptimizer::ScopedAllocatorOptimizer";
   Rewriter* r = new UnaryElementwiseRewriter();
   to_delete_.push_back(r);
+  Rewriter* concat_rewriter = new ConcatRewriter();
+  to_delete_.push_back(concat_rewriter);
   if (opts.enable_op_size() == 0) {
     // Opts handled by default:
     for (const auto& op_name : {"CollectiveReduce"}) {
@@ -901,7 +1099,7 @@ ScopedAllocatorOptimizer::ScopedAllocatorOptimizer(
   } else {
     for (const auto& op_name : opts.enable_op()) {
       op_name_set_.insert(op_name);
-      rewriters_[op_name] = r;
+      rewriters_[op_name] = op_name == "ConcatV2" ? concat_rewriter : r;
     }
   }
 }
@@ -1107,6 +1305,15 @@ Status ScopedAllocatorOptimizer::ProcessGraphDef(
           continue;
         }
         rewriter->SetGraphProperties(graph_properties);
+        if (rewriter->RewritesIndividualNodes()) {
+          bool applied = false;
+          status = rewriter->Rewrite(this, invocation_count, graph, op_name,
+                                     it.second, &applied);
+          if (!status.ok()) {
+            break;
+          }
+          continue;
+        }
         std::unique_ptr<Tree> root(ComputeScopeTree(it.first, it.second));
         // Record outputs that are inputs to multiple Tree nodes.
         absl::flat_hash_set<string> seen_outputs;
@@ -93,6 +93,11 @@ class ScopedAllocatorOptimizer : public GraphOptimizer {
                            const std::vector<NodeDef*>& nodes,
                            bool* applied) = 0;
 
+    // Returns true if Rewrite() is called once with all the nodes of op_name
+    // on a device and rewrites each of them on its own, rather than being
+    // called for each group of logically parallel nodes.
+    virtual bool RewritesIndividualNodes() const { return false; }
+
     void SetGraphProperties(const GraphProperties& graph_properties) {
       graph_properties_ = &graph_properties;
       CHECK(graph_properties_);
@@ -267,6 +267,36 @@ class ScopedAllocatorOptimizerTest : public ::testing::Test {
     TF_CHECK_OK(s.ToGraphDef(graph_def));
   }
 
+  // Constructs the following graph, where a, b, and c are Consts of shape
+  // `shape`, s1 and s2 are Add ops and concat is a ConcatV2 along dimension 0.
+  //
+  // The intended optimization is to have s1 and s2 allocate from a new
+  // ScopedAllocator and to replace concat with a _ScopedAllocatorConcat.
+  /*
+        a    b    c
+         \  / \  /
+          s1   s2
+           \   /
+          concat
+  */
+  void BuildConcatGraph(GraphDef* graph_def, const TensorShape& shape) {
+    Scope s = Scope::NewRootScope();
+    s = s.WithDevice("/job:localhost/replica:0/task:0/device:CPU:0");
+
+    Tensor a(DT_FLOAT, shape);
+    test::FillIota<float>(&a, 0.0);
+    Tensor b(DT_FLOAT, shape);
+    test::FillIota<float>(&b, 100.0);
+    Tensor c(DT_FLOAT, shape);
+    test::FillIota<float>(&c, -100.0);
+    Output s1 = ops::Add(s.WithOpName("s1"), ops::Const(s.WithOpName("a"), a),
+                         ops::Const(s.WithOpName("b"), b));
+    Output s2 = ops::Add(s.WithOpName("s2"), ops::Const(s.WithOpName("b2"), b),
+                         ops::Const(s.WithOpName("c"), c));
+    ops::Concat(s.WithOpName("concat"), {s1, s2}, 0);
+    TF_CHECK_OK(s.ToGraphDef(graph_def));
+  }
+
   void SetShapes(GraphDef* graph_def) {
     TensorShapeProto shape_proto;
     shape_proto.add_dim()->set_size(2);
@@ -283,7 +313,8 @@ class ScopedAllocatorOptimizerTest : public ::testing::Test {
   // returns the outputs specified by `output_names` in `outputs`.
   void ExecuteGraph(const GraphDef& graph_def,
                     const std::vector<string>& output_names,
-                    std::vector<Tensor>* outputs) {
+                    std::vector<Tensor>* outputs,
+                    const string& enable_op = "Abs") {
     // Turn off all optimization except the ScopedAllocatorOptimizer
     // to avoid anything that would alter the expected graph input/output,
     // e.g. by constant folding away all calculations.
@@ -297,7 +328,7 @@ class ScopedAllocatorOptimizerTest : public ::testing::Test {
     RewriterConfig* rwcfg = gopt->mutable_rewrite_options();
     rwcfg->clear_optimizers();
     (*rwcfg->add_optimizers()) = "scoped_allocator";
-    rwcfg->mutable_scoped_allocator_opts()->add_enable_op("Abs");
+    rwcfg->mutable_scoped_allocator_opts()->add_enable_op(enable_op);
     std::unique_ptr<Session> session(CreateSession(graph_def, config));
 
     std::vector<std::pair<string, Tensor>> inputs;
@@ -596,6 +627,67 @@ TEST_F(ScopedAllocatorOptimizerTest, ConstInput) {
   }
   EXPECT_EQ(num_identity_ops, 2);
 }
+
+TEST_F(ScopedAllocatorOptimizerTest, ConcatRewriteOnly) {
+  GrapplerItem item;
+  BuildConcatGraph(&item.graph, TensorShape({4, 4}));
+
+  ScopedAllocatorOptions opts;
+  opts.add_enable_op("ConcatV2");
+  ScopedAllocatorOptimizer sao(RewriterConfig::ON, opts);
+  GraphDef optimized_graph;
+  TF_ASSERT_OK(sao.Optimize(nullptr /*cluster*/, item, &optimized_graph));
+
+  NodeMap node_map(&optimized_graph);
+  NodeDef* concat = nullptr;
+  GetNode(&node_map, "concat", &concat);
+  EXPECT_EQ(concat->op(), "_ScopedAllocatorConcat");
+  ASSERT_EQ(concat->input_size(), 3);
+  EXPECT_EQ(concat->input(1), "s1");
+  EXPECT_EQ(concat->input(2), "s2");
+  NodeDef* sa_node = ValidateSAControlInput(&optimized_graph, &node_map, "s1");
+  ASSERT_NE(sa_node, nullptr);
+  EXPECT_EQ(ValidateSAControlInput(&optimized_graph, &node_map, "s2"),
+            sa_node);
+  EXPECT_EQ(concat->input(0), sa_node->name());
+  TensorShape shape;
+  TF_ASSERT_OK(GetNodeAttr(*concat, "shape", &shape));
+  EXPECT_EQ(shape, TensorShape({8, 4}));
+}
+
+TEST_F(ScopedAllocatorOptimizerTest, ConcatUnalignedInputs) {
+  // 2x2 floats are smaller than Allocator::kAllocatorAlignment, so the inputs
+  // would not be contiguous in the backing tensor.
+  GrapplerItem item;
+  BuildConcatGraph(&item.graph, TensorShape({2, 2}));
+
+  ScopedAllocatorOptions opts;
+  opts.add_enable_op("ConcatV2");
+  ScopedAllocatorOptimizer sao(RewriterConfig::ON, opts);
+  GraphDef optimized_graph;
+  TF_ASSERT_OK(sao.Optimize(nullptr /*cluster*/, item, &optimized_graph));
+
+  for (const NodeDef& node : optimized_graph.node()) {
+    EXPECT_NE(node.op(), "_ScopedAllocator");
+    if (node.name() == "concat") {
+      EXPECT_EQ(node.op(), "ConcatV2");
+    }
+  }
+}
+
+TEST_F(ScopedAllocatorOptimizerTest, ConcatExecute) {
+  GraphDef graph_def;
+  BuildConcatGraph(&graph_def, TensorShape({4, 4}));
+  std::vector<Tensor> outputs;
+  ExecuteGraph(graph_def, /*output_names=*/{"concat:0"}, &outputs,
+               /*enable_op=*/"ConcatV2");
+  // s1 is 100, 102, ..., 130 and s2 is 0, 2, ..., 30.
+  std::vector<float> expected;
+  for (int i = 0; i < 16; ++i) expected.push_back(100 + 2 * i);
+  for (int i = 0; i < 16; ++i) expected.push_back(2 * i);
+  ValidateValues(outputs, {expected});
+  EXPECT_EQ(outputs[0].shape(), TensorShape({8, 4}));
+}
 #endif  // ENABLE_MKL
 
 }  // namespace
@@ -406,6 +406,22 @@ void EraseNodesFromGraph(const std::set<string>& nodes_to_delete,
   EraseNodesFromGraphImpl(nodes_idx_to_delete, graph);
 }
 
+void EraseNodesFromGraph(const std::set<int>& nodes_to_delete, GraphDef* graph,
+                         NodeMap* node_map) {
+  // Erasing swaps the repeated field elements, so the NodeDef pointers of the
+  // remaining nodes stay valid and only the erased nodes must be unmapped.
+  for (int index : nodes_to_delete) {
+    const NodeDef& node = graph->node(index);
+    for (const string& input : node.input()) {
+      node_map->RemoveOutput(NodeName(input), node.name());
+    }
+  }
+  for (int index : nodes_to_delete) {
+    node_map->RemoveNode(graph->node(index).name());
+  }
+  EraseNodesFromGraphImpl(nodes_to_delete, graph);
+}
+
 #define HANDLE_DOUBLE_CASE(DTYPE)                                     \
   case DTYPE:                                                         \
     if (!SafeSetDoubleScalarTensorValue<EnumToDataType<DTYPE>::Type>( \
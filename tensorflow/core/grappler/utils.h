@@ -418,6 +418,11 @@ void EraseNodesFromGraph(std::vector<int>&& nodes_to_delete, GraphDef* graph);
 void EraseNodesFromGraph(const std::set<string>& nodes_to_delete,
                          GraphDef* graph);
 
+// Same as above, but also removes the nodes from `node_map`, which remains
+// valid for the nodes left in the graph and doesn't need to be rebuilt.
+void EraseNodesFromGraph(const std::set<int>& nodes_to_delete, GraphDef* graph,
+                         NodeMap* node_map);
+
 // Erase all attributes without leading underscore. Returns the number of
 // attributes erased.
 int EraseRegularNodeAttributes(NodeDef* node);
@@ -448,6 +448,34 @@ TEST_F(UtilsTest, DeleteNodes) {
   // TODO(rmlarsen): write forgotten test.
 }
 
+TEST_F(UtilsTest, DeleteNodesUpdatesNodeMap) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output c = ops::Const(s.WithOpName("c"), {1.0f, 2.0f}, {1, 2});
+  Output neg0 = ops::Neg(s.WithOpName("neg0"), c);
+  Output neg1 = ops::Neg(s.WithOpName("neg1"), neg0);
+  Output id = ops::Identity(s.WithOpName("id"), c);
+  GraphDef graph;
+  TF_CHECK_OK(s.ToGraphDef(&graph));
+  ASSERT_EQ(graph.node_size(), 4);
+  ASSERT_EQ(graph.node(1).name(), "neg0");
+  ASSERT_EQ(graph.node(2).name(), "neg1");
+
+  NodeMap node_map(&graph);
+  const NodeDef* c_node = node_map.GetNode("c");
+  EraseNodesFromGraph({1, 2}, &graph, &node_map);
+
+  ASSERT_EQ(graph.node_size(), 2);
+  EXPECT_EQ(node_map.GetNode("neg0"), nullptr);
+  EXPECT_EQ(node_map.GetNode("neg1"), nullptr);
+  EXPECT_EQ(node_map.GetNode("c"), c_node);
+  EXPECT_EQ(c_node->name(), "c");
+  const NodeDef* id_node = node_map.GetNode("id");
+  ASSERT_NE(id_node, nullptr);
+  EXPECT_EQ(id_node->name(), "id");
+  ASSERT_EQ(node_map.GetOutputs("c").size(), 1);
+  EXPECT_EQ(*node_map.GetOutputs("c").begin(), id_node);
+}
+
 TEST(IsKernelRegisteredForNode, All) {
   NodeDef node;
   node.set_name("foo");
@@ -0,0 +1,75 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/async_checkpoint_writer.h"
+
+#include <string>
+#include <utility>
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace checkpoint {
+
+const absl::string_view kAsyncCheckpointWriterResourceName =
+    "async_checkpoint_writer";
+
+Status AsyncCheckpointWriter::Schedule(absl::string_view checkpoint_id,
+                                       std::function<Status()> write) {
+  {
+    mutex_lock l(mu_);
+    // Backpressure: wait for the previous checkpoint to be fully written.
+    while (num_in_flight_writes_ > 0 &&
+           in_flight_checkpoint_id_ != checkpoint_id) {
+      cv_.wait(l);
+    }
+    if (!status_.ok()) {
+      Status previous_status = status_;
+      status_ = Status::OK();
+      return previous_status;
+    }
+    in_flight_checkpoint_id_ = std::string(checkpoint_id);
+    ++num_in_flight_writes_;
+  }
+
+  // Released by the background write.
+  Ref();
+  env_->SchedClosure([this, write = std::move(write)]() {
+    Status s = write();
+    if (!s.ok()) {
+      LOG(ERROR) << "Asynchronous checkpoint write failed: " << s;
+    }
+    {
+      mutex_lock l(mu_);
+      status_.Update(s);
+      --num_in_flight_writes_;
+    }
+    cv_.notify_all();
+    Unref();
+  });
+  return Status::OK();
+}
+
+Status AsyncCheckpointWriter::WaitForCompletion() {
+  mutex_lock l(mu_);
+  while (num_in_flight_writes_ > 0) {
+    cv_.wait(l);
+  }
+  Status s = status_;
+  status_ = Status::OK();
+  return s;
+}
+
+}  // namespace checkpoint
+}  // namespace tensorflow
@@ -0,0 +1,82 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_ASYNC_CHECKPOINT_WRITER_H_
+#define TENSORFLOW_CORE_KERNELS_ASYNC_CHECKPOINT_WRITER_H_
+
+#include <functional>
+#include <string>
+
+#include "absl/base/attributes.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/framework/resource_base.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+namespace checkpoint {
+
+ABSL_CONST_INIT extern const absl::string_view
+    kAsyncCheckpointWriterResourceName;
+
+// A class to write checkpoints in the background, used by SaveV2 with
+// `async_save` set.
+//
+// Writes belonging to the same checkpoint (e.g. the shards of a sharded save)
+// run concurrently.  At most one checkpoint is in flight: scheduling a write
+// for a different checkpoint blocks until all the writes of the previous one
+// have completed, which bounds the host memory used for staging to a single
+// checkpoint.  Ops that read checkpoints should call WaitForCompletion() first.
+class AsyncCheckpointWriter : public ResourceBase {
+ public:
+  explicit AsyncCheckpointWriter(Env* env = Env::Default()) : env_(env) {}
+
+  // Not copyable or movable
+  AsyncCheckpointWriter(const AsyncCheckpointWriter&) = delete;
+  AsyncCheckpointWriter& operator=(const AsyncCheckpointWriter&) = delete;
+
+  std::string DebugString() const override { return "AsyncCheckpointWriter"; }
+
+  // Runs "write" on a background thread as a part of the checkpoint identified
+  // by "checkpoint_id".  The resource is kept alive until "write" returns.
+  //
+  // If a write scheduled earlier failed, returns its error without scheduling
+  // "write", so that failures are reported by the next save.
+  Status Schedule(absl::string_view checkpoint_id,
+                  std::function<Status()> write);
+
+  // Blocks until all the scheduled writes have completed.  Returns the first
+  // error of those writes since the last call to Schedule() or
+  // WaitForCompletion(), which is then cleared.
+  Status WaitForCompletion();
+
+ private:
+  Env* const env_;  // Not owned.
+
+  mutex mu_;
+  condition_variable cv_;
+
+  // Id of the checkpoint being written, and the number of its pending writes.
+  std::string in_flight_checkpoint_id_ TF_GUARDED_BY(mu_);
+  int num_in_flight_writes_ TF_GUARDED_BY(mu_) = 0;
+
+  // First error of the writes since it was last reported.
+  Status status_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace checkpoint
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_ASYNC_CHECKPOINT_WRITER_H_
@@ -0,0 +1,120 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/async_checkpoint_writer.h"
+
+#include <atomic>
+#include <memory>
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/notification.h"
+#include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace checkpoint {
+namespace {
+
+class AsyncCheckpointWriterTest : public ::testing::Test {
+ protected:
+  void SetUp() override { writer_ = new AsyncCheckpointWriter(); }
+  void TearDown() override { writer_->Unref(); }
+
+  AsyncCheckpointWriter* writer_;
+};
+
+TEST_F(AsyncCheckpointWriterTest, WritesInBackground) {
+  Notification start_write;
+  std::atomic<bool> written(false);
+  TF_ASSERT_OK(writer_->Schedule("ckpt-1", [&]() {
+    start_write.WaitForNotification();
+    written = true;
+    return Status::OK();
+  }));
+  EXPECT_FALSE(written);
+  start_write.Notify();
+  TF_EXPECT_OK(writer_->WaitForCompletion());
+  EXPECT_TRUE(written);
+}
+
+TEST_F(AsyncCheckpointWriterTest, WritesOfOneCheckpointRunConcurrently) {
+  // Both writes can only complete if they run at the same time.
+  Notification first_started, second_started;
+  TF_ASSERT_OK(writer_->Schedule("ckpt-1", [&]() {
+    first_started.Notify();
+    second_started.WaitForNotification();
+    return Status::OK();
+  }));
+  TF_ASSERT_OK(writer_->Schedule("ckpt-1", [&]() {
+    second_started.Notify();
+    first_started.WaitForNotification();
+    return Status::OK();
+  }));
+  TF_EXPECT_OK(writer_->WaitForCompletion());
+}
+
+TEST_F(AsyncCheckpointWriterTest, OneCheckpointInFlight) {
+  Notification finish_first;
+  std::atomic<bool> first_done(false);
+  TF_ASSERT_OK(writer_->Schedule("ckpt-1", [&]() {
+    finish_first.WaitForNotification();
+    first_done = true;
+    return Status::OK();
+  }));
+
+  // Scheduling the next checkpoint blocks until the first one is written.
+  Notification second_scheduled;
+  std::atomic<bool> first_done_before_second(false);
+  std::unique_ptr<Thread> thread(Env::Default()->StartThread(
+      ThreadOptions(), "schedule", [&]() {
+        TF_EXPECT_OK(writer_->Schedule("ckpt-2", [&]() {
+          first_done_before_second = first_done.load();
+          return Status::OK();
+        }));
+        second_scheduled.Notify();
+      }));
+  Env::Default()->SleepForMicroseconds(10000);
+  EXPECT_FALSE(second_scheduled.HasBeenNotified());
+  finish_first.Notify();
+  second_scheduled.WaitForNotification();
+  thread.reset();
+  TF_EXPECT_OK(writer_->WaitForCompletion());
+  EXPECT_TRUE(first_done_before_second);
+}
+
+TEST_F(AsyncCheckpointWriterTest, ReportsErrors) {
+  TF_ASSERT_OK(writer_->Schedule(
+      "ckpt-1", []() { return errors::DataLoss("disk full"); }));
+  EXPECT_EQ(error::DATA_LOSS, writer_->WaitForCompletion().code());
+  // The error is reported once.
+  TF_EXPECT_OK(writer_->WaitForCompletion());
+
+  TF_ASSERT_OK(writer_->Schedule(
+      "ckpt-2", []() { return errors::DataLoss("disk full"); }));
+  // The next save reports the error, and does not run.
+  bool ran = false;
+  EXPECT_EQ(error::DATA_LOSS, writer_->Schedule("ckpt-3", [&]() {
+                                       ran = true;
+                                       return Status::OK();
+                                     })
+                                  .code());
+  TF_EXPECT_OK(writer_->WaitForCompletion());
+  EXPECT_FALSE(ran);
+}
+
+}  // namespace
+}  // namespace checkpoint
+}  // namespace tensorflow
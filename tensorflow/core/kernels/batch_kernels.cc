@@ -47,6 +47,15 @@ constexpr char kMinInflightBatchesAttr[] = "_min_inflight_batches";
 constexpr char kInitialInflightBatchesAttr[] = "_initial_inflight_batches";
 constexpr char kMaxInflightBatchesAttr[] = "_max_inflight_batches";
 constexpr char kBatchesToAverageOverAttr[] = "_batches_to_average_over";
+constexpr char kDeadlineAwareSchedulingAttr[] =
+    "_enable_deadline_aware_scheduling";
+constexpr char kLengthBucketingDimAttr[] = "_length_bucketing_dim";
+constexpr char kLengthBucketBoundariesAttr[] = "_length_bucket_boundaries";
+constexpr char kLengthBucketTimeoutMicrosAttr[] =
+    "_length_bucket_timeout_micros";
+constexpr char kLengthBucketingMaxPaddingFractionAttr[] =
+    "_length_bucketing_max_padding_fraction";
+constexpr char kLowPriorityAttr[] = "_low_priority";
 
 // Default thread count in the per-process batching thread pool.
 constexpr int64_t kBatchThreadPoolSize = 128;
@@ -263,6 +272,13 @@ BatchFunctionKernel::BatchFunctionKernel(OpKernelConstruction* c)
   if (!c->status().ok()) {
     return;
   }
+  SetLengthBucketingOptions(c);
+  if (!c->status().ok()) {
+    return;
+  }
+  if (c->HasAttr(kLowPriorityAttr)) {
+    OP_REQUIRES_OK(c, c->GetAttr(kLowPriorityAttr, &low_priority_));
+  }
 
   if (enable_adaptive_batch_threads_) {
     // One scheduler instance contains a couple of queue instances,
@@ -326,12 +342,17 @@ void BatchFunctionKernel::ComputeAsync(OpKernelContext* c, DoneCallback done) {
           adaptive_batch_scheduler_options_->initial_in_flight_batches_limit;
       adaptive_shared_batch_scheduler_options.batches_to_average_over =
           adaptive_batch_scheduler_options_->batches_to_average_over;
-      adaptive_shared_batch_scheduler_options.fifo_scheduling = true;
+      // Deadline-aware scheduling replaces FIFO order with deadline order.
+      adaptive_shared_batch_scheduler_options.deadline_aware_scheduling =
+          adaptive_batch_scheduler_options_->deadline_aware_scheduling;
+      adaptive_shared_batch_scheduler_options.fifo_scheduling =
+          !adaptive_batch_scheduler_options_->deadline_aware_scheduling;
       std::unique_ptr<BatchResource> new_resource;
       TF_RETURN_IF_ERROR(BatchResource::Create(
           adaptive_shared_batch_scheduler_options, max_batch_size_,
           batch_timeout_micros_, max_enqueued_batches_, allowed_batch_sizes_,
           handle, flib_, &new_resource));
+      new_resource->set_length_bucketing_options(length_bucketing_options_);
       *r = new_resource.release();
       return Status::OK();
     };
@@ -342,6 +363,7 @@ void BatchFunctionKernel::ComputeAsync(OpKernelContext* c, DoneCallback done) {
           num_batch_threads_, max_batch_size_, batch_timeout_micros_,
           max_enqueued_batches_, allowed_batch_sizes_, handle, flib_,
           enable_large_batch_splitting_, &new_resource));
+      new_resource->set_length_bucketing_options(length_bucketing_options_);
       *r = new_resource.release();
       return Status::OK();
     };
@@ -352,8 +374,8 @@ void BatchFunctionKernel::ComputeAsync(OpKernelContext* c, DoneCallback done) {
                        c->resource_manager()->LookupOrCreate(
                            container_, shared_name_, &br, creator),
                        done);
-  const Status status =
-      br->RegisterInput(random::New64(), c, batcher_queue_, done);
+  const Status status = br->RegisterInput(random::New64(), c, batcher_queue_,
+                                          done, low_priority_);
   br->Unref();
   OP_REQUIRES_OK_ASYNC(c, status, done);
   // Assume br calls done, so nothing to do here.
@@ -505,6 +527,11 @@ void BatchFunctionKernel::SetAdaptiveBatchSchedulerOptions(
                                  &options.max_in_flight_batches_limit));
   }
 
+  if (c->HasAttr(kDeadlineAwareSchedulingAttr)) {
+    OP_REQUIRES_OK(c, c->GetAttr(kDeadlineAwareSchedulingAttr,
+                                 &options.deadline_aware_scheduling));
+  }
+
   // At this point, the batch kernel is configured to use adaptive scheduling.
   // To validate or return error at kernel construction time, invokes
   // `GetOrCreateBatchThreadsPool` and validates returned `thread_pool` is
@@ -518,6 +545,29 @@ void BatchFunctionKernel::SetAdaptiveBatchSchedulerOptions(
 
   adaptive_batch_scheduler_options_ = options;
 }
+
+void BatchFunctionKernel::SetLengthBucketingOptions(OpKernelConstruction* c) {
+  if (!c->HasAttr(kLengthBucketingDimAttr)) {
+    return;
+  }
+  serving::BatchResourceBase::LengthBucketingOptions options;
+  OP_REQUIRES_OK(c, c->GetAttr(kLengthBucketingDimAttr, &options.length_dim));
+  if (c->HasAttr(kLengthBucketBoundariesAttr)) {
+    OP_REQUIRES_OK(c, c->GetAttr(kLengthBucketBoundariesAttr,
+                                 &options.bucket_boundaries));
+  }
+  if (c->HasAttr(kLengthBucketTimeoutMicrosAttr)) {
+    OP_REQUIRES_OK(c, c->GetAttr(kLengthBucketTimeoutMicrosAttr,
+                                 &options.bucket_timeout_micros));
+  }
+  if (c->HasAttr(kLengthBucketingMaxPaddingFractionAttr)) {
+    OP_REQUIRES_OK(c, c->GetAttr(kLengthBucketingMaxPaddingFractionAttr,
+                                 &options.max_padding_fraction));
+  }
+  OP_REQUIRES_OK(
+      c, serving::BatchResourceBase::ValidateLengthBucketingOptions(options));
+  length_bucketing_options_ = std::move(options);
+}
 REGISTER_KERNEL_BUILDER(Name("BatchFunction").Device(DEVICE_CPU),
                         BatchFunctionKernel);
 // Currently all inputs and outputs are on the host.
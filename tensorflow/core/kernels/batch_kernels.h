@@ -19,6 +19,7 @@ limitations under the License.
 #include "absl/types/optional.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/kernels/batching_util/batch_resource_base.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/status.h"
 
@@ -81,6 +82,10 @@ class BatchFunctionKernel : public AsyncOpKernel {
   //   Read from corresponding attributes as long as they are set.
   void SetAdaptiveBatchSchedulerOptions(OpKernelConstruction* c,
                                         int32_t num_batch_threads);
+
+  // Initializes 'length_bucketing_options_' from the length bucketing
+  // attributes, if set, and validates them.
+  void SetLengthBucketingOptions(OpKernelConstruction* c);
   string container_;
   string shared_name_;
   string batcher_queue_;
@@ -95,6 +100,9 @@ class BatchFunctionKernel : public AsyncOpKernel {
   bool enable_large_batch_splitting_;
   bool has_attribute_enable_large_batch_splitting_;
   bool enable_adaptive_batch_threads_ = false;
+  // Whether inputs of this op only fill batches formed from other ops sharing
+  // the queue. Ignored by the adaptive batch scheduler.
+  bool low_priority_ = false;
 
   mutex mu_;
 
@@ -106,9 +114,13 @@ class BatchFunctionKernel : public AsyncOpKernel {
     int32 initial_in_flight_batches_limit = kInitialInflightBatches;
     int32 max_in_flight_batches_limit = kMaxInflightBatches;
     int32 batches_to_average_over = kBatchesToAverageOver;
+    // Form and order batches against step deadlines instead of FIFO.
+    bool deadline_aware_scheduling = false;
   };
   absl::optional<AdaptiveBatchSchedulerOptions>
       adaptive_batch_scheduler_options_ = absl::nullopt;
+
+  serving::BatchResourceBase::LengthBucketingOptions length_bucketing_options_;
 };
 
 }  // namespace tensorflow
@@ -15,7 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/batch_kernels.h"
 
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/kernels/batch_kernel_test_util.h"
+#include "tensorflow/core/kernels/batching_util/batch_resource_base.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/test.h"
 
@@ -33,4 +35,46 @@ TEST_P(BatchFunctionKernelTest, EnableAdaptiveScheduler) {
 
 INSTANTIATE_TEST_SUITE_P(Params, BatchFunctionKernelTest, ::testing::Bool());
 
+// Returns a float tensor of shape {rows, cols} holding 0, 1, 2, ...
+Tensor IotaMatrix(int64_t rows, int64_t cols) {
+  Tensor tensor(DT_FLOAT, TensorShape({rows, cols}));
+  test::FillIota<float>(&tensor, 0.0f);
+  return tensor;
+}
+
+TEST(SplitOutputTensorTest, AlignedSlicesShareBuffer) {
+  // Rows of 64 bytes keep every slice aligned.
+  const Tensor output = IotaMatrix(/*rows=*/8, /*cols=*/16);
+  // The last two rows are padding.
+  std::vector<Tensor> splits =
+      serving::BatchResourceBase::SplitOutputTensor(output, {1, 2, 3});
+  ASSERT_EQ(splits.size(), 3);
+  int64_t offset = 0;
+  for (const Tensor& split : splits) {
+    EXPECT_TRUE(split.SharesBufferWith(output));
+    test::ExpectTensorEqual<float>(
+        split, output.Slice(offset, offset + split.dim_size(0)));
+    offset += split.dim_size(0);
+  }
+  EXPECT_EQ(offset, 6);
+}
+
+TEST(SplitOutputTensorTest, MisalignedSlicesAreCopied) {
+  // Rows of 12 bytes leave the slice starting at row 1 misaligned.
+  const Tensor output = IotaMatrix(/*rows=*/4, /*cols=*/3);
+  std::vector<Tensor> splits =
+      serving::BatchResourceBase::SplitOutputTensor(output, {1, 3});
+  ASSERT_EQ(splits.size(), 2);
+  EXPECT_TRUE(splits[0].SharesBufferWith(output));
+  test::ExpectTensorEqual<float>(
+      splits[0], test::AsTensor<float>({0, 1, 2}, TensorShape({1, 3})));
+#if EIGEN_MAX_ALIGN_BYTES > 0
+  EXPECT_FALSE(splits[1].SharesBufferWith(output));
+#endif
+  EXPECT_TRUE(splits[1].IsAligned());
+  test::ExpectTensorEqual<float>(
+      splits[1], test::AsTensor<float>({3, 4, 5, 6, 7, 8, 9, 10, 11},
+                                       TensorShape({3, 3})));
+}
+
 }  // namespace tensorflow
@@ -19,6 +19,7 @@ limitations under the License.
 #include <algorithm>
 #include <atomic>
 #include <functional>
+#include <limits>
 #include <memory>
 #include <random>
 #include <unordered_map>
@@ -34,6 +35,7 @@ limitations under the License.
 #include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/platform/threadpool_interface.h"
 #include "tensorflow/core/platform/types.h"
@@ -47,6 +49,8 @@ class ASBSBatch;
 
 template <typename TaskType>
 class ASBSQueue;
+
+class BatchLatencyModel;
 }  // namespace internal
 
 // Shared batch scheduler designed to minimize latency. The scheduler keeps
@@ -132,6 +136,20 @@ class AdaptiveSharedBatchScheduler
     // full_batch_scheduling_boost_micros==zero) for backward compatibility of
     // API.
     bool fifo_scheduling = false;
+
+    // If true, batches are formed and released against the deadlines of their
+    // tasks (see BatchTask::deadline_micros()), using an online model of each
+    // queue's batch processing latency by batch size:
+    // 1) a batch stops accepting tasks once the predicted latency of the
+    //    larger batch would miss the deadline of a task in it, so each batch
+    //    is the largest one that still meets its tasks' deadlines;
+    // 2) a batch becomes schedulable before its timeout once waiting any
+    //    longer would miss one of its tasks' deadlines;
+    // 3) schedulable batches run by the latest time they can start, i.e.
+    //    earliest deadline first.
+    // Tasks without a deadline are batched as usual.
+    // Requires that `fifo_scheduling` is false.
+    bool deadline_aware_scheduling = false;
   };
 
   // Ownership is shared between the caller of Create() and any queues created
@@ -211,6 +229,14 @@ class AdaptiveSharedBatchScheduler
 
   void MaybeAdjustInflightLimit() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Re-evaluates which batch to schedule at 'time_micros', when a batch's
+  // latest start time moved earlier than its schedulable time.
+  void MaybeScheduleNextBatchAt(int64_t time_micros);
+
+  // Returns the time from which 'batch' may be scheduled.
+  int64_t SchedulableTimeMicros(
+      const internal::ASBSBatch<TaskType>* batch) const;
+
   // Notifies scheduler of non-empty batch which is eligible for processing.
   void AddBatch(const internal::ASBSBatch<TaskType>* batch);
 
@@ -288,6 +314,61 @@ class AdaptiveSharedBatchScheduler
 // Implementation details follow. API users need not read.
 
 namespace internal {
+// Online model of one queue's batch processing latency as a function of batch
+// size. Keeps an exponentially weighted moving average of the latency observed
+// for each power-of-two range of batch sizes. Thread-safe.
+class BatchLatencyModel {
+ public:
+  // Records that a batch of 'batch_size' took 'latency_micros' to process.
+  void Record(size_t batch_size, int64_t latency_micros) {
+    const int bucket = Bucket(batch_size);
+    mutex_lock l(mu_);
+    if (latency_micros_[bucket] < 0) {
+      latency_micros_[bucket] = latency_micros;
+    } else {
+      latency_micros_[bucket] +=
+          kNewSampleWeight * (latency_micros - latency_micros_[bucket]);
+    }
+  }
+
+  // Returns the predicted processing latency of a batch of 'batch_size'.
+  // Sizes without samples of their own are predicted from the closest
+  // smaller size with samples, scaled linearly with size, or else from the
+  // closest larger one. Returns 0 before any batch was recorded.
+  int64_t PredictMicros(size_t batch_size) const {
+    const int bucket = Bucket(batch_size);
+    mutex_lock l(mu_);
+    for (int b = bucket; b >= 0; --b) {
+      if (latency_micros_[b] >= 0) {
+        return latency_micros_[b] * (int64_t{1} << (bucket - b));
+      }
+    }
+    for (int b = bucket + 1; b < kNumBuckets; ++b) {
+      if (latency_micros_[b] >= 0) return latency_micros_[b];
+    }
+    return 0;
+  }
+
+ private:
+  static constexpr int kNumBuckets = 32;
+  static constexpr double kNewSampleWeight = 0.1;
+
+  // Returns ceil(log2(batch_size)), capped to the last bucket.
+  static int Bucket(size_t batch_size) {
+    int bucket = 0;
+    while (bucket < kNumBuckets - 1 && (size_t{1} << bucket) < batch_size) {
+      ++bucket;
+    }
+    return bucket;
+  }
+
+  mutable mutex mu_;
+  // Negative for buckets without samples.
+  double latency_micros_[kNumBuckets] TF_GUARDED_BY(mu_) = {
+      -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+      -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1};
+};
+
 // Consolidates tasks into batches, passing them off to the
 // AdaptiveSharedBatchScheduler for processing.
 template <typename TaskType>
@@ -328,8 +409,14 @@ class ASBSQueue : public BatchScheduler<TaskType> {
 
   std::shared_ptr<AdaptiveSharedBatchScheduler<TaskType>> scheduler_;
   const QueueOptions options_;
+  // Set if the scheduler uses deadline-aware scheduling; shared with batches,
+  // which may outlive the queue.
+  const std::shared_ptr<BatchLatencyModel> latency_model_;
   // Owned by scheduler_.
   ASBSBatch<TaskType>* current_batch_ TF_GUARDED_BY(mu_) = nullptr;
+  // Earliest deadline of the tasks in current_batch_.
+  int64_t current_batch_deadline_micros_ TF_GUARDED_BY(mu_) =
+      std::numeric_limits<int64_t>::max();
   int64_t num_enqueued_batches_ TF_GUARDED_BY(mu_) = 0;
   int64_t num_enqueued_tasks_ TF_GUARDED_BY(mu_) = 0;
   mutable mutex mu_;
@@ -341,11 +428,13 @@ template <typename TaskType>
 class ASBSBatch : public Batch<TaskType> {
  public:
   ASBSBatch(ASBSQueue<TaskType>* queue, int64_t creation_time_micros,
-            int64_t batch_timeout_micros, uint64 traceme_context_id)
+            int64_t batch_timeout_micros, uint64 traceme_context_id,
+            std::shared_ptr<BatchLatencyModel> latency_model = nullptr)
       : queue_(queue),
         creation_time_micros_(creation_time_micros),
         schedulable_time_micros_(creation_time_micros + batch_timeout_micros),
-        traceme_context_id_(traceme_context_id) {}
+        traceme_context_id_(traceme_context_id),
+        latency_model_(std::move(latency_model)) {}
 
   ~ASBSBatch() override {}
 
@@ -357,11 +446,29 @@ class ASBSBatch : public Batch<TaskType> {
 
   uint64 traceme_context_id() const { return traceme_context_id_; }
 
+  // The latest time processing can start for the tasks' deadlines to be met;
+  // the maximum int64 value if no task has a deadline.
+  int64_t latest_start_time_micros() const {
+    return latest_start_time_micros_.load(std::memory_order_relaxed);
+  }
+
+  void set_latest_start_time_micros(int64_t time_micros) {
+    latest_start_time_micros_.store(time_micros, std::memory_order_relaxed);
+  }
+
+  // Null unless the scheduler uses deadline-aware scheduling.
+  const std::shared_ptr<BatchLatencyModel>& latency_model() const {
+    return latency_model_;
+  }
+
  private:
   ASBSQueue<TaskType>* queue_;
   const int64_t creation_time_micros_;
   const int64_t schedulable_time_micros_;
   const uint64 traceme_context_id_;
+  const std::shared_ptr<BatchLatencyModel> latency_model_;
+  std::atomic<int64_t> latest_start_time_micros_{
+      std::numeric_limits<int64_t>::max()};
   TF_DISALLOW_COPY_AND_ASSIGN(ASBSBatch);
 };
 }  // namespace internal
@@ -417,6 +524,10 @@ Status AdaptiveSharedBatchScheduler<TaskType>::Create(
         "greater than or equal to 1; was ",
         options.batches_to_average_over);
   }
+  if (options.deadline_aware_scheduling && options.fifo_scheduling) {
+    return errors::InvalidArgument(
+        "deadline_aware_scheduling and fifo_scheduling can't both be set");
+  }
   scheduler->reset(new AdaptiveSharedBatchScheduler<TaskType>(options));
   return Status::OK();
 }
@@ -478,8 +589,7 @@ void AdaptiveSharedBatchScheduler<TaskType>::AddBatch(
   } else {
     batches_.push_back(batch);
   }
-  int64_t delay_micros =
-      batch->schedulable_time_micros() - GetEnv()->NowMicros();
+  int64_t delay_micros = SchedulableTimeMicros(batch) - GetEnv()->NowMicros();
   if (delay_micros <= 0) {
     MaybeScheduleNextBatch();
     return;
@@ -496,6 +606,29 @@ void AdaptiveSharedBatchScheduler<TaskType>::AddBatch(
       });
 }
 
+template <typename TaskType>
+void AdaptiveSharedBatchScheduler<TaskType>::MaybeScheduleNextBatchAt(
+    int64_t time_micros) {
+  const int64_t delay_micros = time_micros - GetEnv()->NowMicros();
+  if (delay_micros <= 0) {
+    mutex_lock l(mu_);
+    MaybeScheduleNextBatch();
+    return;
+  }
+  GetEnv()->SchedClosureAfter(
+      delay_micros, [this, lifetime_preserver = this->shared_from_this()] {
+        mutex_lock l(mu_);
+        MaybeScheduleNextBatch();
+      });
+}
+
+template <typename TaskType>
+int64_t AdaptiveSharedBatchScheduler<TaskType>::SchedulableTimeMicros(
+    const internal::ASBSBatch<TaskType>* batch) const {
+  return std::min(batch->schedulable_time_micros(),
+                  batch->latest_start_time_micros());
+}
+
 template <typename TaskType>
 void AdaptiveSharedBatchScheduler<TaskType>::RemoveQueue(
     const internal::ASBSQueue<TaskType>* queue) {
@@ -563,9 +696,16 @@ void AdaptiveSharedBatchScheduler<TaskType>::MaybeScheduleNextBatch() {
   double best_score = (std::numeric_limits<double>::max)();
   int64_t now_micros = GetEnv()->NowMicros();
   for (auto it = batches_.begin(); it != batches_.end(); it++) {
-    if ((*it)->schedulable_time_micros() > now_micros) continue;
+    if (SchedulableTimeMicros(*it) > now_micros) continue;
+    // With deadline-aware scheduling, batches with deadlines are ordered by
+    // the latest time they can start rather than by age.
+    const int64_t start_by_micros =
+        options_.deadline_aware_scheduling
+            ? std::min((*it)->creation_time_micros(),
+                       (*it)->latest_start_time_micros())
+            : (*it)->creation_time_micros();
     const double score =
-        (*it)->creation_time_micros() -
+        start_by_micros -
         options_.full_batch_scheduling_boost_micros * (*it)->size() /
             static_cast<double>((*it)->queue()->max_task_size());
     if (best_it == batches_.end() || score < best_score) {
@@ -633,9 +773,17 @@ void AdaptiveSharedBatchScheduler<TaskType>::CallbackWrapper(
       profiler::ContextType::kAdaptiveSharedBatchScheduler,
       batch->traceme_context_id());
   const int64_t start_time = batch->creation_time_micros();
+  const int64_t processing_start_time = GetEnv()->NowMicros();
+  const size_t batch_size = batch->size();
+  // The batch is destroyed by the callback; keep its latency model alive.
+  std::shared_ptr<internal::BatchLatencyModel> latency_model =
+      batch->latency_model();
   callback(std::unique_ptr<Batch<TaskType>>(
       const_cast<internal::ASBSBatch<TaskType>*>(batch)));
   int64_t end_time = GetEnv()->NowMicros();
+  if (latency_model != nullptr) {
+    latency_model->Record(batch_size, end_time - processing_start_time);
+  }
   mutex_lock l(mu_);
   if (is_express) {
     in_flight_express_batches_--;
@@ -701,7 +849,11 @@ template <typename TaskType>
 ASBSQueue<TaskType>::ASBSQueue(
     std::shared_ptr<AdaptiveSharedBatchScheduler<TaskType>> scheduler,
     const QueueOptions& options)
-    : scheduler_(scheduler), options_(options) {}
+    : scheduler_(scheduler),
+      options_(options),
+      latency_model_(scheduler->options_.deadline_aware_scheduling
+                         ? std::make_shared<BatchLatencyModel>()
+                         : nullptr) {}
 
 template <typename TaskType>
 ASBSQueue<TaskType>::~ASBSQueue() {
@@ -738,6 +890,7 @@ Status ASBSQueue<TaskType>::Schedule(std::unique_ptr<TaskType>* task) {
   std::vector<std::unique_ptr<TaskType>> tasks_to_schedule;
   std::vector<ASBSBatch<TaskType>*> new_batches;
   bool closed_batch = false;
+  int64_t latest_start_time_micros = std::numeric_limits<int64_t>::max();
   {
     mutex_lock l(mu_);
     if (size > SchedulingCapacityLocked()) {
@@ -769,6 +922,29 @@ Status ASBSQueue<TaskType>::Schedule(std::unique_ptr<TaskType>* task) {
         closed_batch = true;
         current_batch_ = nullptr;
       }
+      int64_t deadline_micros = std::numeric_limits<int64_t>::max();
+      if (latency_model_ != nullptr) {
+        if (task->deadline_micros() >= 0) {
+          deadline_micros = task->deadline_micros();
+        }
+        // Close the current batch if growing it would miss a deadline.
+        if (current_batch_ != nullptr) {
+          deadline_micros =
+              std::min(deadline_micros, current_batch_deadline_micros_);
+          if (deadline_micros != std::numeric_limits<int64_t>::max() &&
+              scheduler_->GetEnv()->NowMicros() +
+                      latency_model_->PredictMicros(current_batch_->size() +
+                                                    task->size()) >
+                  deadline_micros) {
+            current_batch_->Close();
+            closed_batch = true;
+            current_batch_ = nullptr;
+            deadline_micros = task->deadline_micros() >= 0
+                                  ? task->deadline_micros()
+                                  : std::numeric_limits<int64_t>::max();
+          }
+        }
+      }
       if (!current_batch_) {
         num_enqueued_batches_++;
         // batch.traceme_context_id connects TraceMeProducer and
@@ -777,8 +953,19 @@ Status ASBSQueue<TaskType>::Schedule(std::unique_ptr<TaskType>* task) {
         // are processed in the same batch and should share traceme_context_id.
         current_batch_ = new ASBSBatch<TaskType>(
             this, scheduler_->GetEnv()->NowMicros(),
-            options_.batch_timeout_micros, NewTraceMeContextIdForBatch());
+            options_.batch_timeout_micros, NewTraceMeContextIdForBatch(),
+            latency_model_);
         new_batches.push_back(current_batch_);
+        current_batch_deadline_micros_ = std::numeric_limits<int64_t>::max();
+      }
+      if (deadline_micros != std::numeric_limits<int64_t>::max()) {
+        current_batch_deadline_micros_ = deadline_micros;
+        current_batch_->set_latest_start_time_micros(
+            deadline_micros - latency_model_->PredictMicros(
+                                  current_batch_->size() + task->size()));
+        latest_start_time_micros =
+            std::min(latest_start_time_micros,
+                     current_batch_->latest_start_time_micros());
       }
 
       // Annotate each task (corresponds to one call of schedule) with a
@@ -813,6 +1000,9 @@ Status ASBSQueue<TaskType>::Schedule(std::unique_ptr<TaskType>* task) {
   if (closed_batch) {
     scheduler_->MaybeScheduleClosedBatches();
   }
+  if (latest_start_time_micros != std::numeric_limits<int64_t>::max()) {
+    scheduler_->MaybeScheduleNextBatchAt(latest_start_time_micros);
+  }
   return Status::OK();
 }
 
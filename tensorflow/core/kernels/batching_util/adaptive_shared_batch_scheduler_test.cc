@@ -36,8 +36,15 @@ class FakeTask : public BatchTask {
 
   void set_size(size_t size) { size_ = size; }
 
+  int64_t deadline_micros() const override { return deadline_micros_; }
+
+  void set_deadline_micros(int64_t deadline_micros) {
+    deadline_micros_ = deadline_micros;
+  }
+
  private:
   size_t size_;
+  int64_t deadline_micros_ = -1;
 
   TF_DISALLOW_COPY_AND_ASSIGN(FakeTask);
 };
@@ -95,6 +102,50 @@ TEST(AdaptiveSharedBatchSchedulerTest, BadOptions) {
   options.min_in_flight_batches_limit = 2;
   options.num_batch_threads = 3;
   EXPECT_FALSE(Scheduler::Create(options, &scheduler).ok());
+  options = Scheduler::Options();
+  options.fifo_scheduling = true;
+  options.deadline_aware_scheduling = true;
+  EXPECT_FALSE(Scheduler::Create(options, &scheduler).ok());
+}
+
+TEST(AdaptiveSharedBatchSchedulerTest, BatchLatencyModel) {
+  internal::BatchLatencyModel model;
+  EXPECT_EQ(0, model.PredictMicros(8));
+  model.Record(8, 1000);
+  EXPECT_EQ(1000, model.PredictMicros(8));
+  EXPECT_EQ(1000, model.PredictMicros(5));
+  // Smaller sizes are bounded by the closest larger sample; larger ones are
+  // extrapolated linearly per power of two.
+  EXPECT_EQ(1000, model.PredictMicros(1));
+  EXPECT_EQ(2000, model.PredictMicros(16));
+  EXPECT_EQ(4000, model.PredictMicros(32));
+  model.Record(16, 1500);
+  EXPECT_EQ(1500, model.PredictMicros(16));
+  model.Record(8, 2000);
+  EXPECT_EQ(1100, model.PredictMicros(8));
+}
+
+TEST(AdaptiveSharedBatchSchedulerTest, DeadlineAwareScheduling) {
+  AdaptiveSharedBatchScheduler<FakeTask>::Options options;
+  options.deadline_aware_scheduling = true;
+  Notification processed;
+  auto queue_callback = [&processed](std::unique_ptr<Batch<FakeTask>> batch) {
+    EXPECT_EQ(1, batch->num_tasks());
+    processed.Notify();
+  };
+  std::shared_ptr<AdaptiveSharedBatchScheduler<FakeTask>> scheduler;
+  TF_ASSERT_OK(
+      AdaptiveSharedBatchScheduler<FakeTask>::Create(options, &scheduler));
+  AdaptiveSharedBatchScheduler<FakeTask>::QueueOptions queue_options;
+  queue_options.batch_timeout_micros = 60 * 1000 * 1000;
+  std::unique_ptr<BatchScheduler<FakeTask>> queue;
+  TF_ASSERT_OK(scheduler->AddQueue(queue_options, queue_callback, &queue));
+
+  // The batch is released by its task's deadline long before its timeout.
+  std::unique_ptr<FakeTask> task(new FakeTask(10));
+  task->set_deadline_micros(Env::Default()->NowMicros() + 10 * 1000);
+  TF_ASSERT_OK(queue->Schedule(&task));
+  EXPECT_TRUE(WaitForNotificationWithTimeout(&processed, 10 * 1000 * 1000));
 }
 
 TEST(AdaptiveSharedBatchSchedulerTest, InFlightBatchesLimit) {
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/batching_util/batch_resource_base.h"
 
+#include <algorithm>
+
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "absl/time/time.h"
@@ -198,6 +200,63 @@ void RecordBatchParamAllowedBatchSizes(const string& allowed_batch_sizes,
   cell->GetCell(model_name, op_name)->Set(allowed_batch_sizes);
 }
 
+// Record the number of tasks whose step deadline passed by the time their batch
+// finished processing.
+void RecordBatchDeadlineMisses(int64_t num_missed, const string& model_name,
+                               const string& op_name) {
+  static auto* cell = monitoring::Counter<2>::New(
+      "/tensorflow/serving/batching/deadline_miss_count",
+      "Tracks the number of batched inputs that missed their deadline by "
+      "model_name (if available).",
+      "model_name", "op_name");
+  cell->GetCell(model_name, op_name)->IncrementBy(num_missed);
+}
+
+// Record the fraction of the batch's sequence positions that are padding added
+// by length bucketing.
+void RecordLengthPaddingFraction(double padding_fraction,
+                                 const string& model_name,
+                                 const string& op_name) {
+  static auto* cell = tensorflow::monitoring::Sampler<2>::New(
+      {"/tensorflow/serving/batching/length_padding_fraction",
+       "Tracks the fraction of sequence positions padded by length bucketing "
+       "on batches by model_name (if available).",
+       "model_name", "op_name"},
+      monitoring::Buckets::Explicit(
+          {0.05, 0.1, 0.2, 0.3, 0.4, 0.5, 0.6, 0.7, 0.8, 0.9}));
+  cell->GetCell(model_name, op_name)->Add(padding_fraction);
+}
+
+// Zero-pads 'input' along dimension 'dim' to 'length' into '*output'.
+Status PadToLength(OpKernelContext* context, const Tensor& input, int dim,
+                   int64_t length, Tensor* output) {
+  if (!DataTypeCanUseMemcpy(input.dtype())) {
+    return errors::Unimplemented(
+        "Length bucketing cannot pad tensors of type ",
+        DataTypeString(input.dtype()));
+  }
+  TensorShape padded_shape(input.shape());
+  padded_shape.set_dim(dim, length);
+  TF_RETURN_IF_ERROR(
+      context->allocate_temp(input.dtype(), padded_shape, output));
+  int64_t num_rows = 1;
+  for (int d = 0; d < dim; ++d) num_rows *= input.dim_size(d);
+  if (num_rows == 0) {
+    return Status::OK();
+  }
+  const int64_t src_row_bytes = input.TotalBytes() / num_rows;
+  const int64_t dst_row_bytes = output->TotalBytes() / num_rows;
+  const char* src = input.tensor_data().data();
+  char* dst = const_cast<char*>(output->tensor_data().data());
+  for (int64_t row = 0; row < num_rows; ++row) {
+    memcpy(dst, src, src_row_bytes);
+    memset(dst + src_row_bytes, 0, dst_row_bytes - src_row_bytes);
+    src += src_row_bytes;
+    dst += dst_row_bytes;
+  }
+  return Status::OK();
+}
+
 const string& GetModelName(OpKernelContext* ctx) {
   static string* kModelNameUnset = new string("model_name_unset");
   if (!ctx->session_metadata()) return *kModelNameUnset;
@@ -223,6 +282,8 @@ BatchResourceBase::BatchTask::CreateSplitTask(
   task->status = this->status;
   task->is_partial = true;
   task->start_time = this->start_time;
+  task->deadline = this->deadline;
+  task->low_priority = this->low_priority;
   task->request_cost = this->request_cost;
 
   return task;
@@ -234,15 +295,18 @@ using TensorMatrix = std::vector<std::vector<Tensor>>;
 
 Status BatchResourceBase::RegisterInput(
     int64_t guid, OpKernelContext* context, const string& batcher_queue_name,
-    AsyncOpKernel::DoneCallback done_callback) {
+    AsyncOpKernel::DoneCallback done_callback, bool low_priority) {
   std::unique_ptr<BatchTask> batch_components;
   TF_RETURN_IF_ERROR(CreateBatchTask(context, &batch_components));
   batch_components->start_time = EnvTime::NowNanos();
+  batch_components->deadline = context->deadline();
+  batch_components->low_priority = low_priority;
   batch_components->guid = guid;
   batch_components->propagated_context = Context(ContextKind::kThread);
   OpInputList tensors;
   TF_RETURN_IF_ERROR(context->input_list("in_tensors", &tensors));
   batch_components->inputs.reserve(tensors.size());
+  const int length_dim = length_bucketing_options_.length_dim;
   for (const Tensor& tensor : tensors) {
     if (tensor.shape().dims() == 0) {
       return errors::InvalidArgument(
@@ -254,6 +318,15 @@ Status BatchResourceBase::RegisterInput(
           "Batching input tensors supplied in a given op invocation must "
           "have equal 0th-dimension size");
     }
+    if (length_dim >= 0 &&
+        (tensor.shape().dims() <= length_dim ||
+         tensor.shape().dim_size(length_dim) !=
+             tensors[0].shape().dim_size(length_dim))) {
+      return errors::InvalidArgument(
+          "With length bucketing, batching input tensors supplied in a given "
+          "op invocation must have equal size in dimension ",
+          length_dim, "; got shape ", tensor.shape().DebugString());
+    }
     batch_components->inputs.push_back(tensor);
   }
   RecordInputBatchSize(tensors[0].shape().dim_size(0), GetModelName(context),
@@ -306,9 +379,21 @@ Status BatchResourceBase::RegisterInput(
     batch_components->request_cost = request_cost_accessor->GetRequestCost();
   }
 
+  string queue_name = batcher_queue_name;
+  int64_t batch_timeout_micros = -1;
+  if (length_dim >= 0) {
+    const int bucket = ChooseLengthBucket(
+        batcher_queue_name, tensors[0].shape().dim_size(length_dim));
+    queue_name = LengthBucketQueueName(batcher_queue_name, bucket);
+    if (!length_bucketing_options_.bucket_timeout_micros.empty()) {
+      batch_timeout_micros =
+          length_bucketing_options_.bucket_timeout_micros[bucket];
+    }
+  }
+
   BatcherQueueT* batcher_queue;
-  TF_RETURN_IF_ERROR(
-      LookupOrCreateBatcherQueue(batcher_queue_name, &batcher_queue));
+  TF_RETURN_IF_ERROR(LookupOrCreateBatcherQueue(
+      queue_name, batch_timeout_micros, &batcher_queue));
   return batcher_queue->Schedule(&batch_components);
 }
 
@@ -324,6 +409,11 @@ BatchResourceBase::GetBatcherQueueOptions(
   batcher_queue_options.batch_timeout_micros = batch_timeout_micros;
   batcher_queue_options.enable_large_batch_splitting =
       enable_large_batch_splitting;
+  // Only low priority tasks use the second lane, so this is a no-op unless some
+  // op registers input with 'low_priority'.
+  batcher_queue_options.enable_priority_lanes = true;
+  batcher_queue_options.low_priority_batch_timeout_micros =
+      batch_timeout_micros;
   if (enable_large_batch_splitting) {
     batcher_queue_options.split_input_task_func =
         [](std::unique_ptr<BatchTask>* input_task,
@@ -373,6 +463,91 @@ BatchResourceBase::GetAdaptiveBatcherQueueOptions(
   return batcher_queue_options;
 }
 
+/*static*/ Status BatchResourceBase::ValidateLengthBucketingOptions(
+    const LengthBucketingOptions& options) {
+  if (options.length_dim < 0) {
+    return Status::OK();
+  }
+  if (options.length_dim == 0) {
+    return errors::InvalidArgument(
+        "Length bucketing cannot use the batch dimension as length dimension");
+  }
+  for (int i = 0; i < options.bucket_boundaries.size(); ++i) {
+    if (options.bucket_boundaries[i] <= 0 ||
+        (i > 0 &&
+         options.bucket_boundaries[i] <= options.bucket_boundaries[i - 1])) {
+      return errors::InvalidArgument(
+          "Length bucket boundaries must be positive and strictly increasing; "
+          "got [",
+          absl::StrJoin(options.bucket_boundaries, ","), "]");
+    }
+  }
+  if (!options.bucket_timeout_micros.empty() &&
+      options.bucket_timeout_micros.size() !=
+          options.bucket_boundaries.size() + 1) {
+    return errors::InvalidArgument(
+        "Expected one length bucket timeout per bucket (",
+        options.bucket_boundaries.size() + 1, "); got ",
+        options.bucket_timeout_micros.size());
+  }
+  for (int64_t timeout : options.bucket_timeout_micros) {
+    if (timeout < 0) {
+      return errors::InvalidArgument(
+          "Length bucket timeouts must be non-negative; got ", timeout);
+    }
+  }
+  if (options.max_padding_fraction < 0 || options.max_padding_fraction >= 1) {
+    return errors::InvalidArgument(
+        "Length bucketing max_padding_fraction must be in [0, 1); got ",
+        options.max_padding_fraction);
+  }
+  return Status::OK();
+}
+
+/*static*/ int BatchResourceBase::LengthBucket(
+    const LengthBucketingOptions& options, int64_t length) {
+  return std::lower_bound(options.bucket_boundaries.begin(),
+                          options.bucket_boundaries.end(), length) -
+         options.bucket_boundaries.begin();
+}
+
+int BatchResourceBase::ChooseLengthBucket(const string& queue_name,
+                                          int64_t length) const {
+  const LengthBucketingOptions& options = length_bucketing_options_;
+  const int bucket = LengthBucket(options, length);
+  if (options.max_padding_fraction <= 0) {
+    return bucket;
+  }
+
+  mutex_lock l(batcher_queues_mu_);
+  auto num_enqueued_tasks = [&](int b) -> size_t {
+    auto it = batcher_queues_.find(LengthBucketQueueName(queue_name, b));
+    return it == batcher_queues_.end() ? 0 : it->second->NumEnqueuedTasks();
+  };
+  if (num_enqueued_tasks(bucket) > 0) {
+    return bucket;
+  }
+  // Joining a pending batch amortizes its cost over one more task; take the
+  // nearest such bucket whose bound keeps padding within the budget. The
+  // final bucket is unbounded, so its padding can't be bounded either.
+  for (int b = bucket + 1; b < options.bucket_boundaries.size(); ++b) {
+    const double padding_fraction =
+        1.0 - static_cast<double>(length) / options.bucket_boundaries[b];
+    if (padding_fraction > options.max_padding_fraction) {
+      break;
+    }
+    if (num_enqueued_tasks(b) > 0) {
+      return b;
+    }
+  }
+  return bucket;
+}
+
+/*static*/ string BatchResourceBase::LengthBucketQueueName(
+    const string& queue_name, int bucket) {
+  return absl::StrCat(queue_name, "/length_bucket_", bucket);
+}
+
 /*static*/ Status BatchResourceBase::ValidateBatch(const BatchT& batch) {
   for (int task_idx = 0; task_idx < batch.num_tasks(); ++task_idx) {
     const BatchResourceBase::BatchTask& task = batch.task(task_idx);
@@ -429,6 +604,26 @@ Status BatchResourceBase::ConcatInputTensors(
   RecordBatchSize(batch.size(), GetModelName(context),
                   string(context->op_kernel().name_view()));
 
+  // With length bucketing, tasks in a batch may differ in length; they are
+  // all padded to the longest one.
+  const int length_dim = length_bucketing_options_.length_dim;
+  int64_t batch_length = 0;
+  if (length_dim >= 0) {
+    int64_t total_length = 0;
+    for (int task_idx = 0; task_idx < batch.num_tasks(); ++task_idx) {
+      const BatchTask& task = batch.task(task_idx);
+      const int64_t length = task.inputs[0].dim_size(length_dim);
+      batch_length = std::max(batch_length, length);
+      total_length += length * task.size();
+    }
+    if (batch_length > 0) {
+      RecordLengthPaddingFraction(
+          1.0 - static_cast<double>(total_length) /
+                    (batch_length * batch.size()),
+          GetModelName(context), string(context->op_kernel().name_view()));
+    }
+  }
+
   // All tasks should have the same number of input edges.
   const int num_inputs = batch.task(0).inputs.size();
   concatenated_tensors->reserve(num_inputs);
@@ -439,13 +634,21 @@ Status BatchResourceBase::ConcatInputTensors(
     std::vector<Tensor> to_concatenate;
     to_concatenate.reserve(batch.num_tasks());
     for (int task_idx = 0; task_idx < batch.num_tasks(); ++task_idx) {
-      to_concatenate.push_back(batch.task(task_idx).inputs.at(i));
+      const Tensor& input = batch.task(task_idx).inputs.at(i);
+      if (length_dim >= 0 && input.dim_size(length_dim) != batch_length) {
+        Tensor padded;
+        TF_RETURN_IF_ERROR(
+            PadToLength(context, input, length_dim, batch_length, &padded));
+        to_concatenate.push_back(std::move(padded));
+      } else {
+        to_concatenate.push_back(input);
+      }
     }
 
     // Add padding as needed. Use the first row of the first task's tensor as
     // the data for padding.
     if (padding_amount > 0) {
-      const Tensor& padding_source = batch.task(0).inputs.at(i);
+      const Tensor padding_source = to_concatenate[0];
       Tensor padding;
       if (padding_source.shape().dim_size(0) == 0) {
         return errors::InvalidArgument(
@@ -463,6 +666,12 @@ Status BatchResourceBase::ConcatInputTensors(
       }
     }
 
+    // A lone task needs no assembly; pass its input through without a copy.
+    if (to_concatenate.size() == 1) {
+      concatenated_tensors->push_back(std::move(to_concatenate[0]));
+      continue;
+    }
+
     Tensor concatenated_tensor;
     Status concat_status =
         Concat(context, to_concatenate, &concatenated_tensor);
@@ -500,10 +709,14 @@ Status BatchResourceBase::ConcatInputTensors(
           for (int j = 0; j < output->size(); ++j) {
             to_concatenate.push_back(std::move((*output)[j][i]));
           }
-          const auto concat_status =
-              Concat(op_kernel_context, to_concatenate, &output_tensor);
-          if (!concat_status.ok()) {
-            status->Update(concat_status);
+          if (to_concatenate.size() == 1) {
+            output_tensor = std::move(to_concatenate[0]);
+          } else {
+            const auto concat_status =
+                Concat(op_kernel_context, to_concatenate, &output_tensor);
+            if (!concat_status.ok()) {
+              status->Update(concat_status);
+            }
           }
 
           op_kernel_context->set_output(i, std::move(output_tensor));
@@ -567,6 +780,24 @@ Status BatchResourceBase::ConcatInputTensors(
   return Status::OK();
 }
 
+std::vector<Tensor> BatchResourceBase::SplitOutputTensor(
+    const Tensor& batched_output, absl::Span<const int64_t> task_sizes) {
+  // Hand each task a slice sharing the batched output's buffer rather than a
+  // copy, unless the slice would be misaligned.
+  std::vector<Tensor> split_tensors;
+  split_tensors.reserve(task_sizes.size());
+  int64_t offset = 0;
+  for (int64_t task_size : task_sizes) {
+    Tensor split_tensor = batched_output.Slice(offset, offset + task_size);
+    if (!split_tensor.IsAligned()) {
+      split_tensor = tensor::DeepCopy(split_tensor);
+    }
+    split_tensors.push_back(std::move(split_tensor));
+    offset += task_size;
+  }
+  return split_tensors;
+}
+
 Status BatchResourceBase::SplitOutputTensors(
     const std::vector<Tensor>& combined_outputs, BatchT* batch) const {
   DCHECK_GE(batch->num_tasks(), 1);
@@ -575,19 +806,8 @@ Status BatchResourceBase::SplitOutputTensors(
                             batch->num_tasks());
   }
 
-  std::vector<int64_t> task_sizes_plus_optional_padding;
-  task_sizes_plus_optional_padding.reserve(batch->num_tasks());
-  for (int i = 0; i < batch->num_tasks(); ++i) {
-    task_sizes_plus_optional_padding.push_back(batch->task(i).size());
-  }
   const int padding_size =
       RoundToLowestAllowedBatchSize(batch->size()) - batch->size();
-  if (padding_size > 0) {
-    task_sizes_plus_optional_padding.push_back(padding_size);
-  }
-
-  // For each output tensor name, a divided-up tensor with one entry per task.
-  std::map<string, std::vector<Tensor>> split_tensors;
 
   DCHECK_EQ(batch->task(0).context->num_outputs(), combined_outputs.size());
   int combined_outputs_size = combined_outputs.size();
@@ -595,7 +815,13 @@ Status BatchResourceBase::SplitOutputTensors(
     return errors::Internal("Wrong number of batched output tensors");
   }
 
-  // Generate 'split_tensors' and populate the context outputs.
+  std::vector<int64_t> task_sizes;
+  task_sizes.reserve(batch->num_tasks());
+  for (int j = 0; j < batch->num_tasks(); ++j) {
+    task_sizes.push_back(batch->task(j).size());
+  }
+
+  // Split each batched output among the tasks and populate their outputs.
   for (int i = 0, iter_limit = combined_outputs.size(); i < iter_limit; ++i) {
     const Tensor& output_tensor = combined_outputs[i];
     if (output_tensor.shape().dims() == 0) {
@@ -609,30 +835,16 @@ Status BatchResourceBase::SplitOutputTensors(
           "the 0th dimension sizes of the input tensors");
     }
 
-    std::vector<Tensor> split_tensor;
-    const Status split_status = tensor::Split(
-        output_tensor, task_sizes_plus_optional_padding, &split_tensor);
-    DCHECK(split_status.ok()) << split_status.ToString();
-    if (!split_status.ok()) {
-      return errors::Internal("Tensor split operation failed: ",
-                              split_status.error_message());
-    }
-    DCHECK_EQ(split_tensor.size(), task_sizes_plus_optional_padding.size());
-    if (split_tensor.size() != task_sizes_plus_optional_padding.size()) {
-      return errors::Internal(
-          "Tensor split operation did not work as expected; got ",
-          split_tensor.size(), " splits; expected ",
-          task_sizes_plus_optional_padding.size());
-    }
-
-    // Ignore a possible final split_tensors entry containing the padding.
+    std::vector<Tensor> split_tensors =
+        SplitOutputTensor(output_tensor, task_sizes);
     for (int j = 0; j < batch->num_tasks(); ++j) {
       BatchTask& task = *(batch->mutable_task(j));
+      Tensor& split_tensor = split_tensors[j];
       if (task.is_partial) {
         std::vector<Tensor>& tensor_vector = (*task.output)[task.split_index];
-        tensor_vector[i] = std::move(split_tensor[j]);
+        tensor_vector[i] = std::move(split_tensor);
       } else {
-        task.context->set_output(i, split_tensor[j]);
+        task.context->set_output(i, std::move(split_tensor));
       }
     }
   }
@@ -674,6 +886,7 @@ void BatchResourceBase::ProcessFuncBatch(std::unique_ptr<BatchT> batch) const {
     // Clear the measurements before unblocking the batch task, as measurements
     // are associated with the task's thread context.
     batch_cost_measurements.clear();
+    RecordDeadlineMisses(*batch);
     for (int i = 0; i < batch->num_tasks(); ++i) {
       WithContext wc(batch->task(i).propagated_context);
       if (batch->task(i).is_partial) {
@@ -819,6 +1032,7 @@ void BatchResourceBase::ProcessBatch(std::unique_ptr<BatchT> batch) const {
       EmitIndexTensor(last_task_context, *batch, num_input_edges),
       last_task_callback);
 
+  RecordDeadlineMisses(*batch);
   // Signal done for each element of the batch. (At this point, the contexts
   // are no longer guaranteed to remain live.)
   for (int task_idx = 0; task_idx < batch->num_tasks(); ++task_idx) {
@@ -826,6 +1040,20 @@ void BatchResourceBase::ProcessBatch(std::unique_ptr<BatchT> batch) const {
   }
 }
 
+/*static*/ void BatchResourceBase::RecordDeadlineMisses(const BatchT& batch) {
+  const absl::Time now = absl::Now();
+  int64_t num_missed = 0;
+  for (int i = 0; i < batch.num_tasks(); ++i) {
+    const absl::optional<absl::Time>& deadline = batch.task(i).deadline;
+    if (deadline.has_value() && *deadline < now) ++num_missed;
+  }
+  if (num_missed > 0) {
+    OpKernelContext* context = batch.task(batch.num_tasks() - 1).context;
+    RecordBatchDeadlineMisses(num_missed, GetModelName(context),
+                              string(context->op_kernel().name_view()));
+  }
+}
+
 /*static*/ Status BatchResourceBase::EmitIndexTensor(OpKernelContext* context,
                                                      const BatchT& batch,
                                                      int output_index) {
@@ -847,8 +1075,9 @@ void BatchResourceBase::ProcessBatch(std::unique_ptr<BatchT> batch) const {
 
 // Looks up the batcher queue for 'queue_name'. If it did't previously exist,
 // creates it.
-Status BatchResourceBase::LookupOrCreateBatcherQueue(const string& queue_name,
-                                                     BatcherQueueT** queue) {
+Status BatchResourceBase::LookupOrCreateBatcherQueue(
+    const string& queue_name, int64_t batch_timeout_micros,
+    BatcherQueueT** queue) {
   mutex_lock l(batcher_queues_mu_);
 
   auto it = batcher_queues_.find(queue_name);
@@ -866,11 +1095,20 @@ Status BatchResourceBase::LookupOrCreateBatcherQueue(const string& queue_name,
     }
   };
   if (batcher_) {
-    TF_RETURN_IF_ERROR(batcher_->AddQueue(batcher_queue_options_,
-                                          process_batch_callback, &new_queue));
+    BatcherT::QueueOptions queue_options = batcher_queue_options_;
+    if (batch_timeout_micros >= 0) {
+      queue_options.batch_timeout_micros = batch_timeout_micros;
+    }
+    TF_RETURN_IF_ERROR(
+        batcher_->AddQueue(queue_options, process_batch_callback, &new_queue));
   } else if (adaptive_batcher_) {
+    AdaptiveBatcherT::QueueOptions queue_options =
+        adaptive_batcher_queue_options_;
+    if (batch_timeout_micros >= 0) {
+      queue_options.batch_timeout_micros = batch_timeout_micros;
+    }
     TF_RETURN_IF_ERROR(adaptive_batcher_->AddQueue(
-        adaptive_batcher_queue_options_, process_batch_callback, &new_queue));
+        queue_options, process_batch_callback, &new_queue));
   } else {
     return errors::Internal("No batcher defined.");
   }
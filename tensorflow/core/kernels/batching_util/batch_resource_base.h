@@ -19,6 +19,9 @@ limitations under the License.
 #include <map>
 
 #include "absl/strings/str_join.h"
+#include "absl/time/time.h"
+#include "absl/types/optional.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/common_runtime/cost_measurement_registry.h"
 #include "tensorflow/core/common_runtime/request_cost.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -47,10 +50,13 @@ class BatchResourceBase : public ResourceBase {
   typedef std::vector<std::vector<Tensor>> TensorMatrix;
 
   // Ingests data from one invocation of the batch op. The data is enqueued to
-  // be combined with others into a batch, asynchronously.
+  // be combined with others into a batch, asynchronously. If 'low_priority' is
+  // true, the data is only used to fill batches with room to spare; see
+  // SharedBatchScheduler::QueueOptions::enable_priority_lanes.
   Status RegisterInput(int64_t guid, OpKernelContext* context,
                        const string& batcher_queue_name,
-                       AsyncOpKernel::DoneCallback done_callback);
+                       AsyncOpKernel::DoneCallback done_callback,
+                       bool low_priority = false);
 
  public:
   // One task to be batched, corresponds to a `slice` of input from one batch-op
@@ -93,8 +99,21 @@ class BatchResourceBase : public ResourceBase {
 
     uint64 start_time;
 
+    // The deadline of the step that invoked the op, if any; see
+    // OpKernelContext::deadline().
+    absl::optional<absl::Time> deadline;
+
+    // Whether the task was registered by a low priority op.
+    bool low_priority = false;
+
     size_t size() const override { return inputs[0].shape().dim_size(0); }
 
+    int64_t deadline_micros() const override {
+      return deadline.has_value() ? absl::ToUnixMicros(*deadline) : -1;
+    }
+
+    bool is_low_priority() const override { return low_priority; }
+
     // Create a split task from this one. The caller needs to setup the inputs
     // of the new task
     std::unique_ptr<BatchTask> CreateSplitTask(
@@ -126,6 +145,43 @@ class BatchResourceBase : public ResourceBase {
   using BatcherQueueT = BatchScheduler<BatchResourceBase::BatchTask>;
   using BatchT = Batch<BatchResourceBase::BatchTask>;
 
+  // Options for grouping tasks by sequence length before batching. Each task
+  // is routed to the batcher queue of its length bucket, so a batch only mixes
+  // tasks of similar length, and inputs are zero-padded along `length_dim` to
+  // the longest task in the batch rather than to the longest task overall.
+  struct LengthBucketingOptions {
+    // Dimension (>= 1) of each input tensor holding the sequence length. A
+    // negative value disables length bucketing.
+    int length_dim = -1;
+
+    // Strictly increasing, inclusive upper bounds on the length of each
+    // bucket. Lengths above the last bound go to a final, unbounded bucket.
+    std::vector<int64_t> bucket_boundaries;
+
+    // Batch timeout for each of the `bucket_boundaries.size() + 1` buckets.
+    // If empty, all buckets use the queue's `batch_timeout_micros`.
+    std::vector<int64_t> bucket_timeout_micros;
+
+    // Cost trade-off between batch size and padding waste. A task whose own
+    // bucket has nothing enqueued may instead join the nearest larger bucket
+    // that does, if padding the task to that bucket's bound wastes at most
+    // this fraction of its padded size. Zero never moves tasks.
+    float max_padding_fraction = 0;
+  };
+
+  // Returns an error if `options` enables bucketing with invalid settings.
+  static Status ValidateLengthBucketingOptions(
+      const LengthBucketingOptions& options);
+
+  // Returns the index of the bucket in `options` holding tasks of `length`.
+  static int LengthBucket(const LengthBucketingOptions& options,
+                          int64_t length);
+
+  // Enables length bucketing. Must be called before the first RegisterInput.
+  void set_length_bucketing_options(LengthBucketingOptions options) {
+    length_bucketing_options_ = std::move(options);
+  }
+
   BatchResourceBase(bool has_process_batch_function,
                     std::shared_ptr<BatcherT> batcher,
                     const BatcherT::QueueOptions& batcher_queue_options,
@@ -196,6 +252,13 @@ class BatchResourceBase : public ResourceBase {
       std::vector<std::unique_ptr<CostMeasurement>>& batch_cost_measurements,
       const int64_t processed_size, BatchT& batch);
 
+  // Splits `batched_output` along its 0th dimension into consecutive pieces of
+  // `task_sizes` rows. Each piece shares the buffer of `batched_output` unless
+  // it would be misaligned for Eigen, in which case it is a copy. Rows past the
+  // sum of `task_sizes`, e.g. padding, are not referenced.
+  static std::vector<Tensor> SplitOutputTensor(
+      const Tensor& batched_output, absl::Span<const int64_t> task_sizes);
+
  private:
   // Implementation of calling the process batch function.
   virtual void ProcessFuncBatchImpl(
@@ -228,6 +291,9 @@ class BatchResourceBase : public ResourceBase {
   // Processes a batch of one or more BatchTask entries.
   void ProcessBatch(std::unique_ptr<BatchT> batch) const;
 
+  // Records the tasks in 'batch' whose deadline has passed.
+  static void RecordDeadlineMisses(const BatchT& batch);
+
   // Emits an index tensor, which the Unbatch op will use to un-concatenate
   // the tensor and attribute the pieces to the right batch keys. The index
   // tensor contains, for each input: [batch_key, start_offset, end_offset]
@@ -239,10 +305,19 @@ class BatchResourceBase : public ResourceBase {
                                 int output_index);
 
   // Looks up the batcher queue for 'queue_name'. If it did't previously exist,
-  // creates it.
+  // creates it, with 'batch_timeout_micros' overriding the queue options'
+  // timeout if non-negative.
   Status LookupOrCreateBatcherQueue(const string& queue_name,
+                                    int64_t batch_timeout_micros,
                                     BatcherQueueT** queue);
 
+  // Returns the bucket that a task of 'length', batched under 'queue_name',
+  // should be enqueued to; see LengthBucketingOptions.
+  int ChooseLengthBucket(const string& queue_name, int64_t length) const;
+
+  // Returns the name of the batcher queue for 'bucket' of 'queue_name'.
+  static string LengthBucketQueueName(const string& queue_name, int bucket);
+
   // True if user specified a batch processing function for this resource.
   const bool has_process_batch_function_;
   // A batch scheduler, and options for creating queues.
@@ -261,6 +336,7 @@ class BatchResourceBase : public ResourceBase {
       TF_GUARDED_BY(batcher_queues_mu_);
 
   std::vector<int32> allowed_batch_sizes_;
+  LengthBucketingOptions length_bucketing_options_;
   // A concatenated string of <allowed_batch_sizes_>, separated by ",". This is
   // used to record batching parameter.
   string allowed_batch_sizes_str_;
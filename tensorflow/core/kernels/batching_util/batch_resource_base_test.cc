@@ -19,6 +19,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/cost_measurement.h"
 #include "tensorflow/core/common_runtime/cost_measurement_registry.h"
 #include "tensorflow/core/common_runtime/no_op_cost_measurement.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/test.h"
 
 namespace tensorflow {
@@ -164,6 +165,39 @@ TEST(SplitBatchCostTest, SplitMultiCostTypes) {
                            Pair("test_gcu_no_smear", absl::Milliseconds(90))));
 }
 
+TEST(LengthBucketingTest, LengthBucket) {
+  BatchResourceBase::LengthBucketingOptions options;
+  options.length_dim = 1;
+  options.bucket_boundaries = {16, 64, 256};
+  EXPECT_EQ(0, BatchResourceBase::LengthBucket(options, 1));
+  EXPECT_EQ(0, BatchResourceBase::LengthBucket(options, 16));
+  EXPECT_EQ(1, BatchResourceBase::LengthBucket(options, 17));
+  EXPECT_EQ(2, BatchResourceBase::LengthBucket(options, 256));
+  EXPECT_EQ(3, BatchResourceBase::LengthBucket(options, 257));
+}
+
+TEST(LengthBucketingTest, ValidateOptions) {
+  BatchResourceBase::LengthBucketingOptions options;
+  TF_EXPECT_OK(BatchResourceBase::ValidateLengthBucketingOptions(options));
+
+  options.length_dim = 0;
+  EXPECT_FALSE(BatchResourceBase::ValidateLengthBucketingOptions(options).ok());
+
+  options.length_dim = 1;
+  options.bucket_boundaries = {16, 16};
+  EXPECT_FALSE(BatchResourceBase::ValidateLengthBucketingOptions(options).ok());
+
+  options.bucket_boundaries = {16, 64};
+  options.bucket_timeout_micros = {100, 1000};
+  EXPECT_FALSE(BatchResourceBase::ValidateLengthBucketingOptions(options).ok());
+
+  options.bucket_timeout_micros = {100, 1000, 5000};
+  TF_EXPECT_OK(BatchResourceBase::ValidateLengthBucketingOptions(options));
+
+  options.max_padding_fraction = 1;
+  EXPECT_FALSE(BatchResourceBase::ValidateLengthBucketingOptions(options).ok());
+}
+
 }  // namespace
 }  // namespace serving
 }  // namespace tensorflow
@@ -64,6 +64,16 @@ class BatchTask {
   // Returns the size of the task, in terms of how much it contributes to the
   // size of a batch. (A batch's size is the sum of its task sizes.)
   virtual size_t size() const = 0;
+
+  // Returns the time, in Env::NowMicros() microseconds, by which the task
+  // should complete, or a negative value if it has no deadline. Only used by
+  // deadline-aware schedulers.
+  virtual int64_t deadline_micros() const { return -1; }
+
+  // Returns true if the task may be deferred in favor of other tasks, and used
+  // to fill batches formed from those. Only used by schedulers with priority
+  // lanes.
+  virtual bool is_low_priority() const { return false; }
 };
 
 // A thread-safe collection of BatchTasks, to be executed together in some
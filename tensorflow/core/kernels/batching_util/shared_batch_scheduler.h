@@ -218,6 +218,25 @@ class SharedBatchScheduler
     // submit batches whose size is in a small set of allowed sizes, that can be
     // done by adding padding in the process-batch callback.
     size_t max_execution_batch_size = 1000;
+
+    // If true, tasks for which `BatchTask::is_low_priority()` returns true are
+    // kept in a separate lane. They never start or delay a batch; instead,
+    // whenever a batch is scheduled its remaining capacity (up to
+    // `max_execution_batch_size`) is filled from the low-priority lane,
+    // splitting the task at the head of the lane if
+    // `enable_large_batch_splitting` is true. Batches consisting solely of
+    // low-priority tasks are only formed when there is no other work in the
+    // queue, and either a full batch of them is waiting or the oldest of them
+    // has waited for `low_priority_batch_timeout_micros`.
+    //
+    // The low-priority lane holds at most `max_enqueued_batches` times
+    // `max_execution_batch_size` worth of tasks.
+    //
+    // Must be false if `enable_lazy_split` is true.
+    bool enable_priority_lanes = false;
+
+    // See `enable_priority_lanes`.
+    int64_t low_priority_batch_timeout_micros = 0;
   };
   Status AddQueue(const QueueOptions& options,
                   std::function<void(std::unique_ptr<Batch<TaskType>>)>
@@ -322,6 +341,10 @@ class Queue {
   // processed by `Queue<TaskType>::ProcessBatch`
   Status ScheduleWithoutOrEagerSplit(std::unique_ptr<TaskType>* task);
 
+  // Enqueue `task` in the low-priority lane. Used iff
+  // `QueueOptions.enable_priority_lanes` is true and the task is low priority.
+  Status ScheduleLowPriority(std::unique_ptr<TaskType>* task);
+
   // Enqueue `task` along with the batch queue metadata.
   // Batches are formed by the time `ScheduleWithLazySplit` returns; and each
   // batch in the deque could evaluate to a batch to be processed after it's
@@ -421,6 +444,14 @@ class Queue {
   // Returns the number of enqueued batches.
   int64 num_enqueued_batches() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Moves tasks from the head of `low_priority_tasks_` into `batch` until it
+  // reaches `max_execution_batch_size()`. `batch` must be open.
+  void FillFromLowPriorityTasks(Batch<TaskType>* batch)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Determines whether a batch of only low-priority tasks may be formed now.
+  bool IsLowPriorityBatchSchedulable() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   const typename SharedBatchScheduler<TaskType>::QueueOptions options_;
 
   // The environment to use.
@@ -462,6 +493,16 @@ class Queue {
   std::deque<std::unique_ptr<Batch<BatchInputTaskHandle<TaskType>>>>
       task_handle_batches_ TF_GUARDED_BY(mu_);
 
+  // Low-priority tasks, with the time at which each was enqueued, in the order
+  // in which they were scheduled.
+  //
+  // Used iff `QueueOptions.enable_priority_lanes` is true.
+  std::deque<std::pair<uint64, std::unique_ptr<TaskType>>> low_priority_tasks_
+      TF_GUARDED_BY(mu_);
+
+  // The sum of the sizes of the tasks in `low_priority_tasks_`.
+  size_t low_priority_tasks_size_ TF_GUARDED_BY(mu_) = 0;
+
   // The counter of the TraceMe context ids.
   uint64 traceme_context_id_counter_ TF_GUARDED_BY(mu_) = 0;
 
@@ -603,6 +644,16 @@ Status SharedBatchScheduler<TaskType>::AddQueueAfterRewritingOptions(
         "enable_large_batch_splitting is enabled.");
   }
 
+  if (options.enable_priority_lanes && options.enable_lazy_split) {
+    return errors::InvalidArgument(
+        "enable_priority_lanes is not supported with enable_lazy_split.");
+  }
+  if (options.low_priority_batch_timeout_micros < 0) {
+    return errors::InvalidArgument(
+        "low_priority_batch_timeout_micros must be non-negative; was ",
+        options.low_priority_batch_timeout_micros);
+  }
+
   if (options.enable_large_batch_splitting &&
       (options.input_batch_size_limit < options.max_execution_batch_size)) {
     return errors::InvalidArgument(
@@ -800,9 +851,35 @@ Status Queue<TaskType>::Schedule(std::unique_ptr<TaskType>* task) {
   if (options_.enable_lazy_split) {
     return ScheduleWithLazySplit(std::move(task));
   }
+  if (options_.enable_priority_lanes && (*task)->is_low_priority()) {
+    return ScheduleLowPriority(task);
+  }
   return ScheduleWithoutOrEagerSplit(std::move(task));
 }
 
+template <typename TaskType>
+Status Queue<TaskType>::ScheduleLowPriority(std::unique_ptr<TaskType>* task) {
+  profiler::TraceMe trace_me([task] {
+    return profiler::TraceMeEncode(
+        "ScheduleLowPriority", {{"batching_input_task_size", (*task)->size()}});
+  });
+  mutex_lock l(mu_);
+
+  DCHECK(!closed_);
+
+  if (low_priority_tasks_size_ + (*task)->size() >
+      options_.max_enqueued_batches * max_execution_batch_size()) {
+    return errors::Unavailable(
+        "The low priority lane of the batch scheduling queue to which this "
+        "task was submitted is full");
+  }
+  low_priority_tasks_size_ += (*task)->size();
+  low_priority_tasks_.emplace_back(env_->NowMicros(), std::move(*task));
+  // Batch threads poll the queue, so there is no need to notify them of a
+  // low-priority batch that may become schedulable.
+  return Status::OK();
+}
+
 template <typename TaskType>
 Status Queue<TaskType>::ScheduleWithLazySplit(std::unique_ptr<TaskType>* task) {
   profiler::TraceMe trace_me([task] {
@@ -961,7 +1038,7 @@ size_t Queue<TaskType>::NumEnqueuedTasks() const {
   for (const auto& batch : batches_) {
     num_enqueued_tasks += batch->num_tasks();
   }
-  return num_enqueued_tasks;
+  return num_enqueued_tasks + low_priority_tasks_.size();
 }
 
 template <typename TaskType>
@@ -1034,11 +1111,88 @@ Queue<TaskType>::ScheduleBatchWithEagerSplit() {
     } else {
       schedulable_batch_ = false;
     }
+
+    if (options_.enable_priority_lanes && !low_priority_tasks_.empty()) {
+      if (batch_to_schedule != nullptr) {
+        // Closed batches are immutable, so move the tasks into a fresh batch
+        // that can be topped up.
+        if (batch_to_schedule->size() < max_execution_batch_size()) {
+          auto filled_batch = std::make_unique<Batch<TaskType>>(
+              batch_to_schedule->traceme_context_id());
+          for (auto& task : batch_to_schedule->RemoveAllTasks()) {
+            filled_batch->AddTask(std::move(task));
+          }
+          FillFromLowPriorityTasks(filled_batch.get());
+          filled_batch->Close();
+          batch_to_schedule = std::move(filled_batch);
+        }
+      } else if (batches_.back()->empty() && IsLowPriorityBatchSchedulable()) {
+        ++num_batches_being_processed_;
+        batch_to_schedule =
+            std::make_unique<Batch<TaskType>>(++traceme_context_id_counter_);
+        FillFromLowPriorityTasks(batch_to_schedule.get());
+        batch_to_schedule->Close();
+      }
+    }
   }
 
   return batch_to_schedule;
 }
 
+template <typename TaskType>
+void Queue<TaskType>::FillFromLowPriorityTasks(Batch<TaskType>* batch) {
+  while (!low_priority_tasks_.empty()) {
+    const int64_t remaining_slot = max_execution_batch_size() - batch->size();
+    if (remaining_slot <= 0) {
+      break;
+    }
+    const uint64 enqueue_time_micros = low_priority_tasks_.front().first;
+    std::unique_ptr<TaskType> task =
+        std::move(low_priority_tasks_.front().second);
+    low_priority_tasks_.pop_front();
+    low_priority_tasks_size_ -= task->size();
+
+    if (task->size() > remaining_slot) {
+      if (!options_.enable_large_batch_splitting) {
+        low_priority_tasks_size_ += task->size();
+        low_priority_tasks_.emplace_front(enqueue_time_micros, std::move(task));
+        break;
+      }
+      std::vector<std::unique_ptr<TaskType>> output_tasks;
+      Status status = options_.split_input_task_func(
+          &task, remaining_slot, max_execution_batch_size(), &output_tasks);
+      if (!status.ok() || output_tasks.empty()) {
+        LOG(ERROR) << "Failed to split low priority task: " << status;
+        if (task != nullptr) {
+          low_priority_tasks_size_ += task->size();
+          low_priority_tasks_.emplace_front(enqueue_time_micros,
+                                            std::move(task));
+        }
+        break;
+      }
+      // Return all but the first output task to the head of the lane, keeping
+      // their order and the original enqueue time.
+      for (int i = output_tasks.size() - 1; i > 0; --i) {
+        low_priority_tasks_size_ += output_tasks[i]->size();
+        low_priority_tasks_.emplace_front(enqueue_time_micros,
+                                          std::move(output_tasks[i]));
+      }
+      task = std::move(output_tasks[0]);
+    }
+    batch->AddTask(std::move(task));
+  }
+}
+
+template <typename TaskType>
+bool Queue<TaskType>::IsLowPriorityBatchSchedulable() const {
+  if (low_priority_tasks_.empty()) {
+    return false;
+  }
+  return closed_ || low_priority_tasks_size_ >= max_execution_batch_size() ||
+         env_->NowMicros() >= low_priority_tasks_.front().first +
+                                  options_.low_priority_batch_timeout_micros;
+}
+
 template <typename TaskType>
 typename SharedBatchScheduler<TaskType>::BatchUniquePtr
 Queue<TaskType>::ScheduleBatch() {
@@ -1122,7 +1276,7 @@ bool Queue<TaskType>::IsEmptyInternal() const {
            task_handle_batches_.back()->empty();
   }
   return num_batches_being_processed_ == 0 && batches_.size() == 1 &&
-         batches_.back()->empty();
+         batches_.back()->empty() && low_priority_tasks_.empty();
 }
 
 template <typename TaskType>
@@ -42,14 +42,18 @@ namespace {
 
 class FakeTask : public BatchTask {
  public:
-  explicit FakeTask(size_t size) : size_(size) {}
+  explicit FakeTask(size_t size, bool low_priority = false)
+      : size_(size), low_priority_(low_priority) {}
 
   ~FakeTask() override = default;
 
   size_t size() const override { return size_; }
 
+  bool is_low_priority() const override { return low_priority_; }
+
  private:
   const size_t size_;
+  const bool low_priority_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(FakeTask);
 };
@@ -64,8 +68,9 @@ using SplitFunc =
 
 // Creates a FakeTask of size 'task_size', and calls 'scheduler->Schedule()' on
 // that task. Returns the resulting status.
-Status ScheduleTask(size_t task_size, BatchScheduler<FakeTask>* scheduler) {
-  std::unique_ptr<FakeTask> task(new FakeTask(task_size));
+Status ScheduleTask(size_t task_size, BatchScheduler<FakeTask>* scheduler,
+                    bool low_priority = false) {
+  std::unique_ptr<FakeTask> task(new FakeTask(task_size, low_priority));
   Status status = scheduler->Schedule(&task);
   // Schedule() should have consumed 'task' iff it returned Status::OK.
   CHECK_EQ(status.ok(), task == nullptr);
@@ -791,6 +796,96 @@ TEST_P(SharedBatchSchedulerTest, ZeroQueueRewrittenToOneQueue) {
   }
 }
 
+// Tests that low priority tasks top up batches of other tasks without delaying
+// them, and are batched on their own only after their timeout.
+TEST_P(SharedBatchSchedulerTest, PriorityLanes) {
+  if (enable_lazy_split()) {
+    auto scheduler = CreateSharedBatchScheduler(1);
+    QueueOptions options = CreateQueueOptions(4, 4, 10, 2);
+    options.enable_priority_lanes = true;
+    std::unique_ptr<Queue> queue;
+    EXPECT_THAT(
+        scheduler->AddQueue(
+            options, [](std::unique_ptr<Batch<FakeTask>> batch) {}, &queue),
+        testing::StatusIs(
+            error::INVALID_ARGUMENT,
+            "enable_priority_lanes is not supported with enable_lazy_split."));
+    return;
+  }
+
+  // Set up a fake clock, which only advances when we explicitly tell it to.
+  test_util::FakeClockEnv env(Env::Default());
+  Notification start_teardown, stop_teardown;
+  std::unique_ptr<Thread> teardown_thread =
+      CreateFakeClockAdvancerThread(&env, &start_teardown, &stop_teardown);
+
+  {
+    mutex mu;
+    // The (total size, low priority size) of each processed batch.
+    std::vector<std::pair<int, int>> batches;
+    Notification first_batch_processed, second_batch_processed;
+    auto callback = [&](std::unique_ptr<Batch<FakeTask>> batch) {
+      ASSERT_TRUE(batch->IsClosed());
+      int low_priority_size = 0;
+      for (int i = 0; i < batch->num_tasks(); ++i) {
+        if (batch->task(i).is_low_priority()) {
+          low_priority_size += batch->task(i).size();
+        }
+      }
+      mutex_lock l(mu);
+      batches.emplace_back(batch->size(), low_priority_size);
+      if (batches.size() == 1) {
+        first_batch_processed.Notify();
+      } else if (batches.size() == 2) {
+        second_batch_processed.Notify();
+      }
+    };
+
+    auto scheduler = CreateSharedBatchScheduler(1, &env);
+    QueueOptions options = CreateQueueOptions(
+        4 /* max_execution_batch_size */, 4 /* input_batch_size_limit */,
+        10 /* batch_timeout_micros */, 2 /* max_enqueued_batches */);
+    options.enable_priority_lanes = true;
+    options.low_priority_batch_timeout_micros = 100;
+    auto queue = CreateQueue(scheduler, options, callback);
+
+    TF_ASSERT_OK(ScheduleTask(3, queue.get(), /*low_priority=*/true));
+    TF_ASSERT_OK(ScheduleTask(2, queue.get()));
+    EXPECT_EQ(queue->NumEnqueuedTasks(), 2);
+
+    // The batch of the high priority task is scheduled at its own timeout, and
+    // filled with as much of the low priority task as fits.
+    env.AdvanceByMicroseconds(10);
+    first_batch_processed.WaitForNotification();
+    {
+      mutex_lock l(mu);
+      if (enable_input_batch_split()) {
+        EXPECT_EQ(batches[0], std::make_pair(4, 2));
+      } else {
+        EXPECT_EQ(batches[0], std::make_pair(2, 0));
+      }
+    }
+
+    // The rest of the low priority task waits for its own timeout.
+    env.AdvanceByMicroseconds(80);
+    Env::Default()->SleepForMicroseconds(10 * 1000 /* 10 milliseconds */);
+    EXPECT_FALSE(second_batch_processed.HasBeenNotified());
+    env.AdvanceByMicroseconds(10);
+    second_batch_processed.WaitForNotification();
+    {
+      mutex_lock l(mu);
+      if (enable_input_batch_split()) {
+        EXPECT_EQ(batches[1], std::make_pair(1, 1));
+      } else {
+        EXPECT_EQ(batches[1], std::make_pair(3, 3));
+      }
+    }
+
+    start_teardown.Notify();
+  }
+  stop_teardown.Notify();
+}
+
 // TODO(b/161857471):
 // Add test coverage when input-split and no-split returns differently.
 INSTANTIATE_TEST_SUITE_P(
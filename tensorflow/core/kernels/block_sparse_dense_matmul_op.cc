@@ -0,0 +1,186 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/sparse_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+
+#include "third_party/eigen3/Eigen/Core"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+// Multiplies a matrix A stored in block compressed sparse row (BSR) format by
+// a dense matrix B.
+//
+// Block rows of the output are independent, so they are sharded over the
+// intra-op pool.  Within a block row, every stored R x C block of A is
+// multiplied by the matching C rows of B with Eigen's dense GEMM, and the
+// products accumulate into the same R rows of the output, which stay in cache.
+template <typename T, typename Tindices>
+class BlockSparseDenseMatMulOp : public OpKernel {
+ public:
+  explicit BlockSparseDenseMatMulOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor& row_splits_t = ctx->input(0);
+    const Tensor& col_indices_t = ctx->input(1);
+    const Tensor& values_t = ctx->input(2);
+    const Tensor& a_shape_t = ctx->input(3);
+    const Tensor& b_t = ctx->input(4);
+
+    OP_REQUIRES(ctx, TensorShapeUtils::IsVector(row_splits_t.shape()),
+                errors::InvalidArgument(
+                    "Tensor 'a_block_row_splits' is not a vector"));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsVector(col_indices_t.shape()),
+                errors::InvalidArgument(
+                    "Tensor 'a_block_col_indices' is not a vector"));
+    OP_REQUIRES(ctx, values_t.dims() == 3,
+                errors::InvalidArgument(
+                    "Tensor 'a_block_values' must have rank 3, got shape ",
+                    values_t.shape().DebugString()));
+    OP_REQUIRES(
+        ctx,
+        TensorShapeUtils::IsVector(a_shape_t.shape()) &&
+            a_shape_t.NumElements() == 2,
+        errors::InvalidArgument("Tensor 'a_shape' must have 2 elements"));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsMatrix(b_t.shape()),
+                errors::InvalidArgument("Tensor 'b' is not a matrix"));
+
+    const int64_t num_blocks = col_indices_t.NumElements();
+    OP_REQUIRES(ctx, values_t.dim_size(0) == num_blocks,
+                errors::InvalidArgument(
+                    "Number of blocks in a_block_values (",
+                    values_t.dim_size(0),
+                    ") does not match number of entries in "
+                    "a_block_col_indices (",
+                    num_blocks, ")"));
+    const int64_t block_rows = values_t.dim_size(1);
+    const int64_t block_cols = values_t.dim_size(2);
+    OP_REQUIRES(ctx, block_rows > 0 && block_cols > 0,
+                errors::InvalidArgument("Block size must be positive, got ",
+                                        block_rows, "x", block_cols));
+
+    const int64_t m = a_shape_t.vec<int64_t>()(0);
+    const int64_t k = a_shape_t.vec<int64_t>()(1);
+    const int64_t n = b_t.dim_size(1);
+    OP_REQUIRES(ctx, m >= 0 && k >= 0,
+                errors::InvalidArgument("Invalid a_shape: [", m, ", ", k,
+                                        "]"));
+    OP_REQUIRES(
+        ctx, k == b_t.dim_size(0),
+        errors::InvalidArgument(
+            "Cannot multiply A and B because inner dimension does not match: ",
+            k, " vs. ", b_t.dim_size(0)));
+
+    const int64_t num_block_rows = (m + block_rows - 1) / block_rows;
+    const int64_t num_block_cols = (k + block_cols - 1) / block_cols;
+    OP_REQUIRES(ctx, row_splits_t.NumElements() == num_block_rows + 1,
+                errors::InvalidArgument(
+                    "a_block_row_splits must have ", num_block_rows + 1,
+                    " entries for ", num_block_rows, " block rows, got ",
+                    row_splits_t.NumElements()));
+    auto row_splits = row_splits_t.vec<Tindices>();
+    auto col_indices = col_indices_t.vec<Tindices>();
+    OP_REQUIRES(ctx,
+                row_splits(0) == 0 && row_splits(num_block_rows) == num_blocks,
+                errors::InvalidArgument(
+                    "a_block_row_splits must start at 0 and end at the number "
+                    "of blocks (",
+                    num_blocks, ")"));
+    for (int64_t i = 0; i < num_block_rows; ++i) {
+      OP_REQUIRES(ctx, row_splits(i) <= row_splits(i + 1),
+                  errors::InvalidArgument(
+                      "a_block_row_splits must be non-decreasing, but entry ",
+                      i + 1, " (", row_splits(i + 1),
+                      ") is less than entry ", i, " (", row_splits(i), ")"));
+    }
+    for (int64_t j = 0; j < num_blocks; ++j) {
+      const Tindices col = col_indices(j);
+      OP_REQUIRES(ctx, col >= 0 && col < num_block_cols,
+                  errors::InvalidArgument("a_block_col_indices[", j, "] = ",
+                                          col, " is out of bounds [0, ",
+                                          num_block_cols, ")"));
+    }
+
+    Tensor* out_t = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({m, n}), &out_t));
+    if (out_t->NumElements() == 0) return;
+    T* out = out_t->flat<T>().data();
+    std::fill_n(out, out_t->NumElements(), T(0));
+    if (num_blocks == 0 || k == 0) return;
+
+    using RowMajorMatrix =
+        Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+    using ConstMatrixMap = Eigen::Map<const RowMajorMatrix>;
+    using MatrixMap = Eigen::Map<RowMajorMatrix>;
+    const T* values = values_t.flat<T>().data();
+    const T* b = b_t.flat<T>().data();
+    const int64_t block_size = block_rows * block_cols;
+
+    auto work = [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; ++i) {
+        const int64_t row = i * block_rows;
+        const int64_t rows = std::min(block_rows, m - row);
+        MatrixMap out_rows(out + row * n, rows, n);
+        for (int64_t j = row_splits(i); j < row_splits(i + 1); ++j) {
+          const int64_t col = col_indices(j) * block_cols;
+          const int64_t cols = std::min(block_cols, k - col);
+          ConstMatrixMap block(values + j * block_size, block_rows,
+                               block_cols);
+          ConstMatrixMap b_rows(b + col * n, cols, n);
+          out_rows.noalias() += block.topLeftCorner(rows, cols) * b_rows;
+        }
+      }
+    };
+
+    // Each block costs a multiply-add per element of its product.
+    const int64_t cost_per_block_row =
+        std::max<int64_t>(1, num_blocks / num_block_rows) * block_size * n * 2;
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *ctx->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, num_block_rows,
+          cost_per_block_row, work);
+  }
+};
+
+#define REGISTER_CPU(TypeT, TypeIndex)           \
+  REGISTER_KERNEL_BUILDER(                       \
+      Name("BlockSparseDenseMatMul")             \
+          .Device(DEVICE_CPU)                    \
+          .TypeConstraint<TypeT>("T")            \
+          .TypeConstraint<TypeIndex>("Tindices") \
+          .HostMemory("a_shape"),                \
+      BlockSparseDenseMatMulOp<TypeT, TypeIndex>);
+
+#define REGISTER_KERNELS_CPU(T) \
+  REGISTER_CPU(T, int64_t);     \
+  REGISTER_CPU(T, int32)
+
+REGISTER_KERNELS_CPU(float);
+REGISTER_KERNELS_CPU(double);
+
+#undef REGISTER_KERNELS_CPU
+#undef REGISTER_CPU
+
+}  // namespace tensorflow
@@ -0,0 +1,225 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <random>
+#include <vector>
+
+#include "absl/strings/match.h"
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+// A block-sparse matrix in BSR format, with its dense equivalent.
+struct BlockSparseMatrix {
+  int64_t m, k, block_rows, block_cols;
+  std::vector<int64_t> row_splits;
+  std::vector<int64_t> col_indices;
+  std::vector<float> values;
+  std::vector<float> dense;  // Row-major [m, k].
+};
+
+// Keeps each block of an m x k matrix with probability `density`, visiting the
+// block columns of each block row in reverse order.
+BlockSparseMatrix RandomBlockSparseMatrix(int64_t m, int64_t k,
+                                          int64_t block_rows,
+                                          int64_t block_cols, float density,
+                                          std::mt19937* gen) {
+  std::uniform_real_distribution<float> value_dist(-1.0f, 1.0f);
+  std::bernoulli_distribution keep(density);
+  BlockSparseMatrix a{m, k, block_rows, block_cols};
+  a.dense.assign(m * k, 0.0f);
+  const int64_t num_block_rows = (m + block_rows - 1) / block_rows;
+  const int64_t num_block_cols = (k + block_cols - 1) / block_cols;
+  a.row_splits.push_back(0);
+  for (int64_t i = 0; i < num_block_rows; ++i) {
+    for (int64_t j = num_block_cols - 1; j >= 0; --j) {
+      if (!keep(*gen)) continue;
+      a.col_indices.push_back(j);
+      for (int64_t r = 0; r < block_rows; ++r) {
+        for (int64_t c = 0; c < block_cols; ++c) {
+          const float v = value_dist(*gen);
+          a.values.push_back(v);
+          const int64_t row = i * block_rows + r;
+          const int64_t col = j * block_cols + c;
+          // Values in the padding of edge blocks must be ignored.
+          if (row < m && col < k) a.dense[row * k + col] = v;
+        }
+      }
+    }
+    a.row_splits.push_back(a.col_indices.size());
+  }
+  return a;
+}
+
+class BlockSparseDenseMatMulOpTest : public OpsTestBase {
+ protected:
+  void MakeOp() {
+    TF_ASSERT_OK(NodeDefBuilder("bsr_matmul", "BlockSparseDenseMatMul")
+                     .Input(FakeInput(DT_INT64))
+                     .Input(FakeInput(DT_INT64))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_INT64))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+
+  void AddBlockSparseInputs(const BlockSparseMatrix& a) {
+    const int64_t num_blocks = a.col_indices.size();
+    AddInputFromArray<int64_t>(
+        TensorShape({static_cast<int64_t>(a.row_splits.size())}),
+        a.row_splits);
+    AddInputFromArray<int64_t>(TensorShape({num_blocks}), a.col_indices);
+    AddInputFromArray<float>(
+        TensorShape({num_blocks, a.block_rows, a.block_cols}), a.values);
+    AddInputFromArray<int64_t>(TensorShape({2}), {a.m, a.k});
+  }
+
+  void RunAndCheck(int64_t m, int64_t k, int64_t n, int64_t block_rows,
+                   int64_t block_cols, float density) {
+    std::mt19937 gen(m * 1000003 + k * 1009 + n);
+    const BlockSparseMatrix a =
+        RandomBlockSparseMatrix(m, k, block_rows, block_cols, density, &gen);
+    std::uniform_real_distribution<float> value_dist(-1.0f, 1.0f);
+    std::vector<float> b(k * n);
+    for (float& v : b) v = value_dist(gen);
+
+    MakeOp();
+    AddBlockSparseInputs(a);
+    AddInputFromArray<float>(TensorShape({k, n}), b);
+    TF_ASSERT_OK(RunOpKernel());
+
+    Tensor expected(allocator(), DT_FLOAT, TensorShape({m, n}));
+    auto expected_t = expected.matrix<float>();
+    for (int64_t i = 0; i < m; ++i) {
+      for (int64_t j = 0; j < n; ++j) {
+        float sum = 0;
+        for (int64_t p = 0; p < k; ++p) {
+          sum += a.dense[i * k + p] * b[p * n + j];
+        }
+        expected_t(i, j) = sum;
+      }
+    }
+    test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-4);
+  }
+};
+
+TEST_F(BlockSparseDenseMatMulOpTest, EvenBlocks) {
+  RunAndCheck(/*m=*/8, /*k=*/12, /*n=*/5, /*block_rows=*/4, /*block_cols=*/4,
+              /*density=*/0.5f);
+}
+
+TEST_F(BlockSparseDenseMatMulOpTest, TruncatedEdgeBlocks) {
+  RunAndCheck(/*m=*/7, /*k=*/10, /*n=*/3, /*block_rows=*/4, /*block_cols=*/3,
+              /*density=*/0.7f);
+}
+
+TEST_F(BlockSparseDenseMatMulOpTest, ManyBlockRows) {
+  RunAndCheck(/*m=*/512, /*k=*/256, /*n=*/64, /*block_rows=*/16,
+              /*block_cols=*/16, /*density=*/0.1f);
+}
+
+TEST_F(BlockSparseDenseMatMulOpTest, EmptyBlockRows) {
+  RunAndCheck(/*m=*/32, /*k=*/32, /*n=*/8, /*block_rows=*/8, /*block_cols=*/8,
+              /*density=*/0.0f);
+}
+
+TEST_F(BlockSparseDenseMatMulOpTest, BlockColumnOutOfBounds) {
+  MakeOp();
+  // A is 4 x 4 with 2 x 2 blocks, so block columns must be in [0, 2).
+  AddInputFromArray<int64_t>(TensorShape({3}), {0, 1, 1});
+  AddInputFromArray<int64_t>(TensorShape({1}), {2});
+  AddInputFromArray<float>(TensorShape({1, 2, 2}), {1, 2, 3, 4});
+  AddInputFromArray<int64_t>(TensorShape({2}), {4, 4});
+  AddInputFromArray<float>(TensorShape({4, 1}), {1, 1, 1, 1});
+  Status s = RunOpKernel();
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+  EXPECT_TRUE(absl::StrContains(s.error_message(), "out of bounds")) << s;
+}
+
+TEST_F(BlockSparseDenseMatMulOpTest, BadRowSplits) {
+  MakeOp();
+  AddInputFromArray<int64_t>(TensorShape({3}), {0, 2, 1});
+  AddInputFromArray<int64_t>(TensorShape({1}), {0});
+  AddInputFromArray<float>(TensorShape({1, 2, 2}), {1, 2, 3, 4});
+  AddInputFromArray<int64_t>(TensorShape({2}), {4, 4});
+  AddInputFromArray<float>(TensorShape({4, 1}), {1, 1, 1, 1});
+  Status s = RunOpKernel();
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+}
+
+static Graph* BlockSparseDenseMatMul(int m, int k, int n, int block_size,
+                                     float density) {
+  std::mt19937 gen(0);
+  const BlockSparseMatrix a =
+      RandomBlockSparseMatrix(m, k, block_size, block_size, density, &gen);
+  const int64_t num_blocks = a.col_indices.size();
+  Tensor row_splits(DT_INT64,
+                    TensorShape({static_cast<int64_t>(a.row_splits.size())}));
+  std::copy(a.row_splits.begin(), a.row_splits.end(),
+            row_splits.flat<int64_t>().data());
+  Tensor col_indices(DT_INT64, TensorShape({num_blocks}));
+  std::copy(a.col_indices.begin(), a.col_indices.end(),
+            col_indices.flat<int64_t>().data());
+  Tensor values(DT_FLOAT, TensorShape({num_blocks, block_size, block_size}));
+  std::copy(a.values.begin(), a.values.end(), values.flat<float>().data());
+  Tensor a_shape = test::AsTensor<int64_t>({m, k});
+  Tensor b(DT_FLOAT, TensorShape({k, n}));
+  b.flat<float>().setRandom();
+
+  Graph* g = new Graph(OpRegistry::Global());
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "BlockSparseDenseMatMul")
+                  .Input(test::graph::Constant(g, row_splits))
+                  .Input(test::graph::Constant(g, col_indices))
+                  .Input(test::graph::Constant(g, values))
+                  .Input(test::graph::HostConstant(g, a_shape))
+                  .Input(test::graph::Constant(g, b))
+                  .Attr("T", DT_FLOAT)
+                  .Finalize(g, nullptr));
+  return g;
+}
+
+// DENSITY is the percentage of blocks kept.
+#define BM_BlockSparseDenseMatMul(M, K, N, BS, DENSITY)                      \
+  static void BM_BlockSparseDenseMatMul_##M##_##K##_##N##_##BS##_##DENSITY( \
+      ::testing::benchmark::State& state) {                                 \
+    test::Benchmark("cpu",                                                  \
+                    BlockSparseDenseMatMul(M, K, N, BS, DENSITY / 100.0f),  \
+                    /*old_benchmark_api*/ false)                            \
+        .Run(state);                                                        \
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(M) * \
+                            K * N * DENSITY / 100);                         \
+  }                                                                         \
+  BENCHMARK(BM_BlockSparseDenseMatMul_##M##_##K##_##N##_##BS##_##DENSITY)   \
+      ->UseRealTime();
+
+BM_BlockSparseDenseMatMul(4096, 4096, 128, 16, 5);
+BM_BlockSparseDenseMatMul(4096, 4096, 128, 16, 20);
+BM_BlockSparseDenseMatMul(4096, 4096, 128, 32, 5);
+BM_BlockSparseDenseMatMul(4096, 4096, 128, 32, 20);
+BM_BlockSparseDenseMatMul(1024, 1024, 1024, 16, 10);
+
+}  // namespace
+}  // namespace tensorflow
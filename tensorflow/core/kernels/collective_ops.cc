@@ -702,6 +702,28 @@ class CollectiveReduceV2OpKernel : public CollectiveOpV2Kernel {
     SetAttrValue(data_type_, &(*sub_node.mutable_attr())["T"]);
     merge_op_ = BuildOpKernel(c, merge_op_name, &sub_node);
     final_op_ = BuildOpKernel(c, final_op_name, &sub_node);
+    // Prepare OpKernels for converting the chunks to and from their wire
+    // format, if it differs from the native one.
+    string wire_format;
+    OP_REQUIRES_OK(c, c->GetAttr("wire_format", &wire_format));
+    if (wire_format != "native") {
+      DataType wire_dtype = wire_format == "bfloat16" ? DT_BFLOAT16 : DT_HALF;
+      OP_REQUIRES(c, data_type_ == DT_FLOAT || data_type_ == DT_DOUBLE,
+                  errors::InvalidArgument(
+                      "wire_format ", wire_format,
+                      " requires a float32 or float64 input, but got ",
+                      DataTypeString(data_type_)));
+      NodeDef cast_node;
+      cast_node.add_input(c->def().input(0));
+      cast_node.set_device(c->def().device());
+      SetAttrValue(false, &(*cast_node.mutable_attr())["Truncate"]);
+      SetAttrValue(data_type_, &(*cast_node.mutable_attr())["SrcT"]);
+      SetAttrValue(wire_dtype, &(*cast_node.mutable_attr())["DstT"]);
+      wire_encode_op_ = BuildOpKernel(c, "Cast", &cast_node);
+      SetAttrValue(wire_dtype, &(*cast_node.mutable_attr())["SrcT"]);
+      SetAttrValue(data_type_, &(*cast_node.mutable_attr())["DstT"]);
+      wire_decode_op_ = BuildOpKernel(c, "Cast", &cast_node);
+    }
     name_ = strings::StrCat(c->def().name(), ": ReduceV2(", merge_op_name, ",",
                             final_op_name, ")");
     VLOG(2) << "CollectiveReduceV2 " << this << " name " << name_
@@ -723,6 +745,8 @@ class CollectiveReduceV2OpKernel : public CollectiveOpV2Kernel {
     col_params->instance.shape = c->input(0).shape();
     col_params->merge_op = merge_op_.get();
     col_params->final_op = final_op_.get();
+    col_params->wire_encode_op = wire_encode_op_.get();
+    col_params->wire_decode_op = wire_decode_op_.get();
     VLOG(1) << "CollectiveReduceV2 group_size " << col_params->group.group_size
             << " group_key " << col_params->group.group_key << " instance_key "
             << col_params->instance.instance_key;
@@ -739,6 +763,8 @@ class CollectiveReduceV2OpKernel : public CollectiveOpV2Kernel {
   int max_subdivs_per_device_;
   std::unique_ptr<OpKernel> merge_op_;
   std::unique_ptr<OpKernel> final_op_;
+  std::unique_ptr<OpKernel> wire_encode_op_;
+  std::unique_ptr<OpKernel> wire_decode_op_;
 };
 
 REGISTER_KERNEL_BUILDER(Name("CollectiveReduceV2").Device(DEVICE_CPU),
@@ -42,12 +42,16 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_slice.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/conv_2d.h"
+#include "tensorflow/core/kernels/conv_ops_cpu_autotune.h"
 #include "tensorflow/core/kernels/deep_conv2d.h"
+#include "tensorflow/core/kernels/direct_conv2d.h"
 #include "tensorflow/core/kernels/ops_util.h"
+#include "tensorflow/core/kernels/winograd_transform.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/gtl/array_slice.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/profiler/lib/scoped_annotation.h"
@@ -414,6 +418,124 @@ class LaunchDeepConvOp<CPUDevice, float> {
   }
 };
 
+template <typename Device, typename T>
+class LaunchAutotunedConvOp {
+ public:
+  static bool Run(OpKernelContext* ctx, const Tensor& input,
+                  const Tensor& filter, const Conv2DDimensions& dimensions,
+                  const Padding& padding, Tensor* output,
+                  TensorFormat data_format) {
+    return false;
+  }
+};
+
+// Launches the fastest CPU algorithm for the convolution if autotuning is
+// enabled, timing each supported algorithm the first time a convolution is
+// run. Returns false if the default launcher should run instead.
+template <>
+class LaunchAutotunedConvOp<CPUDevice, float> {
+ public:
+  static bool Run(OpKernelContext* ctx, const Tensor& input,
+                  const Tensor& filter, const Conv2DDimensions& dimensions,
+                  const Padding& padding, Tensor* output,
+                  TensorFormat data_format) {
+    if (!CpuConv2DAutotuneEnabled() || data_format != FORMAT_NHWC ||
+        dimensions.dilation_rows != 1 || dimensions.dilation_cols != 1 ||
+        dimensions.in_depth != dimensions.patch_depth) {
+      return false;
+    }
+
+    Conv2DArgs args;
+    args.batch = dimensions.batch;
+    args.in_rows = dimensions.input_rows;
+    args.in_cols = dimensions.input_cols;
+    args.in_depth = dimensions.in_depth;
+    args.filter_rows = dimensions.filter_rows;
+    args.filter_cols = dimensions.filter_cols;
+    args.pad_rows = dimensions.pad_rows_before;
+    args.pad_cols = dimensions.pad_cols_before;
+    args.stride_rows = dimensions.stride_rows;
+    args.stride_cols = dimensions.stride_cols;
+    args.out_rows = dimensions.out_rows;
+    args.out_cols = dimensions.out_cols;
+    args.out_depth = dimensions.out_depth;
+
+    const std::vector<CpuConv2DAlgorithm> algorithms =
+        GetCpuConv2DAlgorithms(args);
+    if (algorithms.size() == 1) {
+      return false;
+    }
+
+    const int num_threads =
+        ctx->device()->tensorflow_cpu_worker_threads()->num_threads;
+    CpuConv2DAutotuneMap* autotune_map = CpuConv2DAutotuneMap::GetInstance();
+    CpuConv2DAlgorithm best_algorithm;
+    if (autotune_map->Find(args, num_threads, &best_algorithm)) {
+      if (best_algorithm == CpuConv2DAlgorithm::kDefault) {
+        return false;
+      }
+      Launch(ctx, input, filter, args, padding, best_algorithm, output);
+      return true;
+    }
+
+    // Like the GPU autotuning, runs each algorithm once.
+    Env* env = Env::Default();
+    uint64 best_micros = std::numeric_limits<uint64>::max();
+    for (CpuConv2DAlgorithm algorithm : algorithms) {
+      const uint64 start_micros = env->NowMicros();
+      Launch(ctx, input, filter, args, padding, algorithm, output);
+      if (!ctx->status().ok()) {
+        return true;
+      }
+      const uint64 micros = env->NowMicros() - start_micros;
+      VLOG(1) << "Conv2D algorithm " << CpuConv2DAlgorithmName(algorithm)
+              << " took " << micros << " us";
+      if (micros < best_micros) {
+        best_algorithm = algorithm;
+        best_micros = micros;
+      }
+    }
+    autotune_map->Insert(args, num_threads, best_algorithm);
+    if (best_algorithm != algorithms.back()) {
+      // The output is the one of the last algorithm, which may differ from
+      // the best one in rounding.
+      Launch(ctx, input, filter, args, padding, best_algorithm, output);
+    }
+    return true;
+  }
+
+ private:
+  static void Launch(OpKernelContext* ctx, const Tensor& input,
+                     const Tensor& filter, const Conv2DArgs& args,
+                     const Padding& padding, CpuConv2DAlgorithm algorithm,
+                     Tensor* output) {
+    const float* input_ptr = input.flat<float>().data();
+    const float* filter_ptr = filter.flat<float>().data();
+    float* output_ptr = output->flat<float>().data();
+    switch (algorithm) {
+      case CpuConv2DAlgorithm::kDefault:
+        LaunchGeneric<CPUDevice, float>()(
+            ctx, input, filter, args.stride_rows, args.stride_cols,
+            /*row_dilation=*/1, /*col_dilation=*/1, padding,
+            /*explicit_paddings=*/{}, output, FORMAT_NHWC);
+        break;
+      case CpuConv2DAlgorithm::kWinograd2x2:
+        functor::DeepConv2D<CPUDevice, float>()(ctx, args, input_ptr,
+                                                filter_ptr, output_ptr);
+        break;
+      case CpuConv2DAlgorithm::kWinograd4x4:
+        functor::DeepConv2D<CPUDevice, float>()(
+            ctx, args, Winograd4x4Transform<float>(), input_ptr, filter_ptr,
+            output_ptr);
+        break;
+      case CpuConv2DAlgorithm::kDirect:
+        functor::DirectConv2D<CPUDevice, float>()(ctx, args, input_ptr,
+                                                  filter_ptr, output_ptr);
+        break;
+    }
+  }
+};
+
 #ifdef TENSORFLOW_USE_LIBXSMM_CONVOLUTIONS
 template <typename Device, typename T>
 class LaunchXsmmConvOp {
@@ -714,6 +836,13 @@ class Conv2DOp : public BinaryOp<T> {
     }
 #endif
 
+    if (params_.padding != EXPLICIT &&
+        LaunchAutotunedConvOp<Device, T>::Run(context, input, filter,
+                                              dimensions, params_.padding,
+                                              output, params_.data_format)) {
+      return;
+    }
+
     if (params_.padding != EXPLICIT &&
         LaunchDeepConvOp<Device, T>::Run(
             context, input, filter, dimensions.batch, dimensions.input_rows,
@@ -0,0 +1,90 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/conv_ops_cpu_autotune.h"
+
+#include <stdlib.h>
+
+#include "tensorflow/core/kernels/direct_conv2d.h"
+#include "tensorflow/core/platform/stringpiece.h"
+
+namespace tensorflow {
+
+const char* CpuConv2DAlgorithmName(CpuConv2DAlgorithm algorithm) {
+  switch (algorithm) {
+    case CpuConv2DAlgorithm::kDefault:
+      return "default";
+    case CpuConv2DAlgorithm::kWinograd2x2:
+      return "winograd_2x2";
+    case CpuConv2DAlgorithm::kWinograd4x4:
+      return "winograd_4x4";
+    case CpuConv2DAlgorithm::kDirect:
+      return "direct";
+  }
+  return "unknown";
+}
+
+// Like TF_USE_DEEP_CONV2D, the variable is read on every call so that tests
+// can toggle it.
+bool CpuConv2DAutotuneEnabled() {
+  const char* value = getenv("TF_CPU_CONV2D_AUTOTUNE");
+  return value != nullptr && StringPiece(value) != "0";
+}
+
+std::vector<CpuConv2DAlgorithm> GetCpuConv2DAlgorithms(const Conv2DArgs& args) {
+  std::vector<CpuConv2DAlgorithm> algorithms = {CpuConv2DAlgorithm::kDefault};
+  // Filter shards of larger filters assume 2x2 output tiles, so only 3x3
+  // filters get the 4x4 tiles.
+  if (args.stride_rows == 1 && args.stride_cols == 1 &&
+      args.filter_rows == 3 && args.filter_cols == 3) {
+    algorithms.push_back(CpuConv2DAlgorithm::kWinograd2x2);
+    algorithms.push_back(CpuConv2DAlgorithm::kWinograd4x4);
+  }
+  if (CanUseDirectConv2D(args)) {
+    algorithms.push_back(CpuConv2DAlgorithm::kDirect);
+  }
+  return algorithms;
+}
+
+CpuConv2DAutotuneMap* CpuConv2DAutotuneMap::GetInstance() {
+  static CpuConv2DAutotuneMap* instance = new CpuConv2DAutotuneMap;
+  return instance;
+}
+
+bool CpuConv2DAutotuneMap::Find(const Conv2DArgs& args, int num_threads,
+                                CpuConv2DAlgorithm* algorithm) const {
+  mutex_lock l(mu_);
+  auto it = algorithms_.find(MakeKey(args, num_threads));
+  if (it == algorithms_.end()) return false;
+  *algorithm = it->second;
+  return true;
+}
+
+void CpuConv2DAutotuneMap::Insert(const Conv2DArgs& args, int num_threads,
+                                  CpuConv2DAlgorithm algorithm) {
+  mutex_lock l(mu_);
+  algorithms_[MakeKey(args, num_threads)] = algorithm;
+}
+
+CpuConv2DAutotuneMap::Key CpuConv2DAutotuneMap::MakeKey(const Conv2DArgs& args,
+                                                        int num_threads) {
+  return {args.batch,       args.in_rows,     args.in_cols,
+          args.in_depth,    args.filter_rows, args.filter_cols,
+          args.pad_rows,    args.pad_cols,    args.stride_rows,
+          args.stride_cols, args.out_rows,    args.out_cols,
+          args.out_depth,   num_threads};
+}
+
+}  // namespace tensorflow
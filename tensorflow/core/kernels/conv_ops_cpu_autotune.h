@@ -0,0 +1,76 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_CONV_OPS_CPU_AUTOTUNE_H_
+#define TENSORFLOW_CORE_KERNELS_CONV_OPS_CPU_AUTOTUNE_H_
+
+#include <array>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/kernels/deep_conv2d.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// Implementations of float Conv2D on CPU.
+enum class CpuConv2DAlgorithm {
+  // SpatialConvolution or MatMul, see LaunchGeneric in conv_ops.cc.
+  kDefault,
+  // DeepConv2D with WinogradTransform, i.e. F(2x2, 3x3).
+  kWinograd2x2,
+  // DeepConv2D with Winograd4x4Transform, i.e. F(4x4, 3x3).
+  kWinograd4x4,
+  // DirectConv2D.
+  kDirect,
+};
+
+const char* CpuConv2DAlgorithmName(CpuConv2DAlgorithm algorithm);
+
+// Returns true if Conv2D on CPU should pick the fastest of its algorithms for
+// each convolution by timing them the first time it is run. Enabled by
+// setting TF_CPU_CONV2D_AUTOTUNE to a value other than "0".
+// NOTE: If this environment variable name changes, update conv_ops_test.cc.
+bool CpuConv2DAutotuneEnabled();
+
+// Returns the algorithms that support the convolution specified by 'args',
+// always starting with kDefault.
+std::vector<CpuConv2DAlgorithm> GetCpuConv2DAlgorithms(const Conv2DArgs& args);
+
+// Process wide map from convolution parameters and number of threads to the
+// fastest algorithm measured for them, the CPU counterpart of ConvAutotuneMap.
+class CpuConv2DAutotuneMap {
+ public:
+  static CpuConv2DAutotuneMap* GetInstance();
+
+  // Returns true and sets 'algorithm' if an algorithm was recorded for 'args'.
+  bool Find(const Conv2DArgs& args, int num_threads,
+            CpuConv2DAlgorithm* algorithm) const;
+
+  void Insert(const Conv2DArgs& args, int num_threads,
+              CpuConv2DAlgorithm algorithm);
+
+ private:
+  using Key = std::array<int, 14>;
+  static Key MakeKey(const Conv2DArgs& args, int num_threads);
+
+  mutable mutex mu_;
+  absl::flat_hash_map<Key, CpuConv2DAlgorithm> algorithms_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_CONV_OPS_CPU_AUTOTUNE_H_
@@ -297,6 +297,11 @@ struct LaunchFusedConv2DOp<CPUDevice, T> {
                                            fused_batch_norm_args),
                context, input, filter, output);
         break;
+      case FusedComputationType::kBiasAddWithGeluExact:
+      case FusedComputationType::kBiasAddWithGeluApproximate:
+        OP_REQUIRES_OK(context,
+                       errors::Internal("Fusion type is not supported"));
+        break;
     }
   }
 };
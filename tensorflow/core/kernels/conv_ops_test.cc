@@ -27,6 +27,7 @@ limitations under the License.
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/kernels/conv_ops_cpu_autotune.h"
 #include "tensorflow/core/kernels/conv_ops_gpu.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/kernels/ops_util.h"
@@ -473,6 +474,115 @@ TEST_F(ConvOpTest, HandwrittenConv) { HandwrittenConv(); }
 
 TEST_F(ConvOpTest, AnisotropicStride) { AnisotropicStrides(); }
 
+// Checks the result of each CPU Conv2D algorithm, forced through the
+// autotuning map, against a naive convolution.
+class CpuConv2DAlgorithmTest
+    : public OpsTestBase,
+      public ::testing::WithParamInterface<CpuConv2DAlgorithm> {
+ protected:
+  void TearDown() override { unsetenv("TF_CPU_CONV2D_AUTOTUNE"); }
+
+  void RunTest(int batch, int rows, int cols, int in_depth, int filter_size,
+               int out_depth, int stride, const string& padding) {
+    TF_ASSERT_OK(NodeDefBuilder("conv_op", "Conv2D")
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Attr("T", DT_FLOAT)
+                     .Attr("strides", {1, stride, stride, 1})
+                     .Attr("padding", padding)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+
+    Conv2DArgs args;
+    args.batch = batch;
+    args.in_rows = rows;
+    args.in_cols = cols;
+    args.in_depth = in_depth;
+    args.filter_rows = filter_size;
+    args.filter_cols = filter_size;
+    args.stride_rows = stride;
+    args.stride_cols = stride;
+    args.out_depth = out_depth;
+    if (padding == "VALID") {
+      args.out_rows = (rows - filter_size) / stride + 1;
+      args.out_cols = (cols - filter_size) / stride + 1;
+    } else {
+      args.out_rows = (rows + stride - 1) / stride;
+      args.out_cols = (cols + stride - 1) / stride;
+      args.pad_rows =
+          std::max((args.out_rows - 1) * stride + filter_size - rows, 0) / 2;
+      args.pad_cols =
+          std::max((args.out_cols - 1) * stride + filter_size - cols, 0) / 2;
+    }
+    if (!absl::c_linear_search(GetCpuConv2DAlgorithms(args), GetParam())) {
+      GTEST_SKIP() << CpuConv2DAlgorithmName(GetParam())
+                   << " does not support the convolution";
+    }
+
+    Tensor image(DT_FLOAT, {batch, rows, cols, in_depth});
+    image.flat<float>().setRandom();
+    Tensor filter(DT_FLOAT, {filter_size, filter_size, in_depth, out_depth});
+    filter.flat<float>().setRandom();
+
+    Tensor expected(DT_FLOAT,
+                    {batch, args.out_rows, args.out_cols, out_depth});
+    auto in = image.tensor<float, 4>();
+    auto f = filter.tensor<float, 4>();
+    auto out = expected.tensor<float, 4>();
+    out.setZero();
+    for (int b = 0; b < batch; ++b) {
+      for (int r = 0; r < args.out_rows; ++r) {
+        for (int c = 0; c < args.out_cols; ++c) {
+          for (int f_r = 0; f_r < filter_size; ++f_r) {
+            for (int f_c = 0; f_c < filter_size; ++f_c) {
+              const int in_r = r * stride - args.pad_rows + f_r;
+              const int in_c = c * stride - args.pad_cols + f_c;
+              if (in_r < 0 || in_r >= rows || in_c < 0 || in_c >= cols) {
+                continue;
+              }
+              for (int d = 0; d < in_depth; ++d) {
+                for (int od = 0; od < out_depth; ++od) {
+                  out(b, r, c, od) += in(b, in_r, in_c, d) * f(f_r, f_c, d, od);
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+
+    setenv("TF_CPU_CONV2D_AUTOTUNE", "1", 1);
+    CpuConv2DAutotuneMap::GetInstance()->Insert(
+        args, device_->tensorflow_cpu_worker_threads()->num_threads,
+        GetParam());
+    AddInputFromArray<float>(image.shape(), image.flat<float>());
+    AddInputFromArray<float>(filter.shape(), filter.flat<float>());
+    TF_ASSERT_OK(RunOpKernel());
+    test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-3);
+  }
+};
+
+TEST_P(CpuConv2DAlgorithmTest, Same3x3) {
+  RunTest(/*batch=*/2, /*rows=*/9, /*cols=*/11, /*in_depth=*/3,
+          /*filter_size=*/3, /*out_depth=*/16, /*stride=*/1, "SAME");
+}
+
+TEST_P(CpuConv2DAlgorithmTest, Valid3x3) {
+  RunTest(/*batch=*/1, /*rows=*/10, /*cols=*/7, /*in_depth=*/8,
+          /*filter_size=*/3, /*out_depth=*/5, /*stride=*/1, "VALID");
+}
+
+TEST_P(CpuConv2DAlgorithmTest, Strided5x5) {
+  RunTest(/*batch=*/1, /*rows=*/13, /*cols=*/12, /*in_depth=*/2,
+          /*filter_size=*/5, /*out_depth=*/11, /*stride=*/2, "SAME");
+}
+
+INSTANTIATE_TEST_SUITE_P(All, CpuConv2DAlgorithmTest,
+                         ::testing::Values(CpuConv2DAlgorithm::kDefault,
+                                           CpuConv2DAlgorithm::kWinograd2x2,
+                                           CpuConv2DAlgorithm::kWinograd4x4,
+                                           CpuConv2DAlgorithm::kDirect));
+
 template <typename T>
 class FusedConv2DOpTest : public OpsTestBase {
  protected:
@@ -19,6 +19,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/serialization_utils.h"
 #include "tensorflow/core/framework/dataset.h"
@@ -27,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/data/cache_ops.h"
+#include "tensorflow/core/kernels/data/columnar_cache.h"
 #include "tensorflow/core/kernels/data/iterator_ops.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
@@ -64,6 +66,9 @@ constexpr char kCacheCompleted[] = "cache_completed";
 constexpr char kIndex[] = "index";
 constexpr char kImpl[] = "Impl";
 constexpr char kCacheDataset[] = "CacheDataset";
+// When enabled, file caches of elements with fixed-shape, memcpy-able
+// components are rewritten in the columnar format once they are complete.
+constexpr char kColumnarFileCacheExperiment[] = "columnar_file_cache";
 constexpr char kIncompleteCacheErrorMessage[] =
     "The calling iterator did not fully read the dataset being cached. In "
     "order to avoid unexpected truncation of the dataset, the partially cached "
@@ -144,7 +149,11 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
         item_index_padding_size_(StringPaddingSize(kMaxItems)),
         tensor_format_string_(strings::Printf(kKeyStrFormat,
                                               item_index_padding_size_,
-                                              tensor_index_padding_size_)) {
+                                              tensor_index_padding_size_)),
+        use_columnar_cache_(
+            IsColumnarCacheCompatible(input->output_dtypes(),
+                                      input->output_shapes()) &&
+            GetExperiments().contains(kColumnarFileCacheExperiment)) {
     input_->Ref();
     DCHECK_EQ(item_index_padding_size_, 7);
   }
@@ -184,11 +193,54 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
     return input_->CheckExternalState();
   }
 
+  // Random access is supported once the cache has been written in the
+  // columnar format.
+  Status Get(OpKernelContext* ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    std::shared_ptr<const ColumnarCacheReader> reader;
+    TF_RETURN_IF_ERROR(GetColumnarCacheReader(&reader));
+    if (!reader) {
+      return DatasetBase::Get(ctx, index, out_tensors);
+    }
+    return reader->Get(ctx->get_allocator({}), index, out_tensors);
+  }
+
  protected:
   const DatasetBase* const input_;
   const tstring filename_;
 
  private:
+  // Returns whether the cache has been completely written, in either format.
+  bool CacheExists() const {
+    return env_->FileExists(MetaFilename(filename_)).ok() || HasColumnarCache();
+  }
+
+  // Returns whether the cache has been written in the columnar format.
+  bool HasColumnarCache() const {
+    return env_->FileExists(ColumnarCacheFilename(filename_)).ok();
+  }
+
+  // Sets `reader` to a reader of the columnar cache, or to `nullptr` if the
+  // cache has not been written in the columnar format.
+  Status GetColumnarCacheReader(
+      std::shared_ptr<const ColumnarCacheReader>* reader) const
+      TF_LOCKS_EXCLUDED(columnar_reader_mu_) {
+    mutex_lock l(columnar_reader_mu_);
+    if (!columnar_reader_) {
+      if (!HasColumnarCache()) {
+        *reader = nullptr;
+        return Status::OK();
+      }
+      std::unique_ptr<ColumnarCacheReader> new_reader;
+      TF_RETURN_IF_ERROR(ColumnarCacheReader::Open(
+          env_, ColumnarCacheFilename(filename_), output_dtypes(),
+          output_shapes(), &new_reader));
+      columnar_reader_ = std::move(new_reader);
+    }
+    *reader = columnar_reader_;
+    return Status::OK();
+  }
+
   static size_t StringPaddingSize(size_t num_tensors) {
     return strings::Printf(kPaddingSizeStrFormat, num_tensors - 1).size();
   }
@@ -202,9 +254,7 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
    public:
     explicit FileIterator(const Params& params)
         : DatasetIterator<FileDatasetBase>(params) {
-      if (params.dataset->env_
-              ->FileExists(MetaFilename(params.dataset->filename_))
-              .ok()) {
+      if (params.dataset->CacheExists()) {
         mode_ = Mode::read;
       } else {
         mode_ = Mode::write;
@@ -244,10 +294,7 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
         TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kMode), &temp));
         mode_ = static_cast<Mode>(temp);
       }
-      if (mode_ == Mode::write &&
-          dataset()
-              ->env_->FileExists(MetaFilename(dataset()->filename_))
-              .ok()) {
+      if (mode_ == Mode::write && dataset()->CacheExists()) {
         // This could happen if the cache was completely written after the
         // checkpoint was saved.
         LOG(WARNING)
@@ -278,7 +325,9 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
     // checkpoint the input pipeline. On each call to `SaveInternal` the
     // partial cache gets flushed to disk in files with prefix
     // <filename>_<shard_id> where shard_id is unique for each checkpoint.
-    // When all elements have been produced, these shards get coalesced.
+    // When all elements have been produced, these shards get coalesced. If
+    // the columnar cache is enabled, the coalesced bundle is then rewritten as
+    // a columnar cache, see columnar_cache.h.
     class FileWriterIterator : public DatasetIterator<FileDatasetBase> {
      public:
       explicit FileWriterIterator(const Params& params)
@@ -526,6 +575,9 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
           TF_RETURN_IF_ERROR(
               MergeBundles(dataset()->env_, prefixes, dataset()->filename_));
         }
+        if (dataset()->use_columnar_cache_) {
+          TF_RETURN_IF_ERROR(ConvertToColumnarCache());
+        }
         // Delete all lockfiles.
         for (size_t i = 0; i <= shard_id_; ++i) {
           TF_RETURN_IF_ERROR(dataset()->env_->DeleteFile(
@@ -534,6 +586,43 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
         return Status::OK();
       }
 
+      // Rewrites the coalesced bundle as a columnar cache, and deletes the
+      // bundle once the columnar cache is in place.
+      Status ConvertToColumnarCache() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        Env* env = dataset()->env_;
+        const string& prefix = dataset()->filename_;
+        {
+          BundleReader reader(env, prefix);
+          TF_RETURN_IF_ERROR(reader.status());
+          ColumnarCacheWriter writer(env, ColumnarCacheFilename(prefix),
+                                     dataset()->output_dtypes(),
+                                     dataset()->output_shapes());
+          std::vector<Tensor> element(dataset()->num_tensors_);
+          reader.Next();  // The first entry in the table is a header.
+          while (reader.Valid()) {
+            for (size_t i = 0; i < dataset()->num_tensors_; ++i) {
+              if (!reader.Valid()) {
+                return errors::DataLoss("The cache ", prefix,
+                                        " ends in the middle of an element.");
+              }
+              TF_RETURN_IF_ERROR(reader.ReadCurrent(&element[i]));
+              reader.Next();
+            }
+            TF_RETURN_IF_ERROR(writer.Add(element));
+          }
+          TF_RETURN_IF_ERROR(reader.status());
+          TF_RETURN_IF_ERROR(writer.Finish());
+        }
+        std::vector<string> bundle_files;
+        TF_RETURN_IF_ERROR(env->GetMatchingPaths(
+            strings::StrCat(prefix, ".data-*"), &bundle_files));
+        bundle_files.push_back(MetaFilename(prefix));
+        for (const string& path : bundle_files) {
+          TF_RETURN_IF_ERROR(env->DeleteFile(path));
+        }
+        return Status::OK();
+      }
+
       mutex mu_;
       size_t cur_index_ TF_GUARDED_BY(mu_);
       // Index of the current shard. This gets incremented whenever a new
@@ -638,6 +727,74 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
       bool iterator_restored_ TF_GUARDED_BY(mu_);
     };  // FileReaderIterator
 
+    // Reads the elements of a cache written in the columnar format. Each
+    // element is read from the memory-mapped cache file at an offset computed
+    // from its index, so restoring the iterator does not need to seek.
+    class ColumnarFileReaderIterator
+        : public DatasetIterator<FileDatasetBase> {
+     public:
+      explicit ColumnarFileReaderIterator(const Params& params)
+          : DatasetIterator<FileDatasetBase>(params), cur_index_(0) {}
+
+      Status Initialize(IteratorContext* ctx) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(dataset()->GetColumnarCacheReader(&reader_));
+        if (!reader_) {
+          return errors::NotFound("Columnar cache file ",
+                                  ColumnarCacheFilename(dataset()->filename_),
+                                  " not found.");
+        }
+        return Status::OK();
+      }
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        if (cur_index_ >= reader_->num_elements()) {
+          *end_of_sequence = true;
+          return Status::OK();
+        }
+        *end_of_sequence = false;
+        TF_RETURN_IF_ERROR(
+            reader_->Get(ctx->allocator({}), cur_index_, out_tensors));
+        cur_index_++;
+        return Status::OK();
+      }
+
+     protected:
+      std::shared_ptr<model::Node> CreateNode(
+          IteratorContext* ctx, model::Node::Args args) const override {
+        return model::MakeKnownRatioNode(std::move(args),
+                                         /*ratio=*/1);
+      }
+
+      Status SaveInternal(SerializationContext* ctx,
+                          IteratorStateWriter* writer) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(
+            writer->WriteScalar(full_name(kCurIndex), cur_index_));
+        return Status::OK();
+      }
+
+      Status RestoreInternal(IteratorContext* ctx,
+                             IteratorStateReader* reader) override {
+        mutex_lock l(mu_);
+        int64_t temp;
+        TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kCurIndex), &temp));
+        if (temp < 0 || temp > reader_->num_elements()) {
+          return errors::Internal("Invalid value for cur_index ", temp);
+        }
+        cur_index_ = temp;
+        return Status::OK();
+      }
+
+     private:
+      mutex mu_;
+      int64_t cur_index_ TF_GUARDED_BY(mu_);
+      std::shared_ptr<const ColumnarCacheReader> reader_ TF_GUARDED_BY(mu_);
+    };  // ColumnarFileReaderIterator
+
     Status InitializeIterator(IteratorContext* ctx)
         TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       // We intentionally use the same prefix for both `FileReaderIterator` and
@@ -650,9 +807,15 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
       // `cur_index`.
       switch (mode_) {
         case Mode::read:
-          iterator_ =
-              absl::make_unique<FileReaderIterator>(FileReaderIterator::Params{
-                  dataset(), strings::StrCat(prefix(), kImpl)});
+          if (dataset()->HasColumnarCache()) {
+            iterator_ = absl::make_unique<ColumnarFileReaderIterator>(
+                ColumnarFileReaderIterator::Params{
+                    dataset(), strings::StrCat(prefix(), kImpl)});
+          } else {
+            iterator_ = absl::make_unique<FileReaderIterator>(
+                FileReaderIterator::Params{dataset(),
+                                           strings::StrCat(prefix(), kImpl)});
+          }
           break;
         case Mode::write:
           iterator_ =
@@ -675,6 +838,11 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
   static constexpr size_t kMaxItems = 10000000;  // 10 million
   const size_t item_index_padding_size_;
   const string tensor_format_string_;
+  // Whether to rewrite the cache in the columnar format once it is complete.
+  const bool use_columnar_cache_;
+  mutable mutex columnar_reader_mu_;
+  mutable std::shared_ptr<const ColumnarCacheReader> columnar_reader_
+      TF_GUARDED_BY(columnar_reader_mu_);
 };  // FileDatasetBase
 
 class CacheDatasetOp::FileDataset : public CacheDatasetOp::FileDatasetBase {
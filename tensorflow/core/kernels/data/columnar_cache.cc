@@ -0,0 +1,379 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/columnar_cache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/match.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/platform/coding.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/raw_coding.h"
+#include "tensorflow/core/platform/strcat.h"
+#include "tensorflow/core/util/overflow.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr char kColumnarCacheSuffix[] = ".columnar";
+constexpr char kTempStateSuffix[] = ".tempstate";
+
+// The size of the chunks in which column files are copied into the cache file.
+constexpr size_t kCopyChunkSize = 8 << 20;  // 8MB
+
+uint64 RoundUpToAlignment(uint64 offset) {
+  return (offset + kColumnarCacheAlignment - 1) / kColumnarCacheAlignment *
+         kColumnarCacheAlignment;
+}
+
+// Returns the size of the header for components of the given ranks.
+uint64 HeaderSize(const std::vector<int>& ranks) {
+  uint64 size = kColumnarCacheMagicSize + 2 * sizeof(uint64);
+  for (int rank : ranks) {
+    size += (3 + rank) * sizeof(uint64);
+  }
+  return size;
+}
+
+uint64 ElementSize(DataType dtype, const TensorShape& shape) {
+  return shape.num_elements() * DataTypeSize(dtype);
+}
+
+// Appends the contents of the file `src` to `dst`.
+Status AppendFile(Env* env, const std::string& src, WritableFile* dst) {
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(env->NewRandomAccessFile(src, &file));
+  uint64 size;
+  TF_RETURN_IF_ERROR(env->GetFileSize(src, &size));
+  std::unique_ptr<char[]> scratch(new char[std::min<uint64>(
+      std::max<uint64>(size, 1), kCopyChunkSize)]);
+  for (uint64 offset = 0; offset < size;) {
+    const size_t n = std::min<uint64>(size - offset, kCopyChunkSize);
+    StringPiece chunk;
+    TF_RETURN_IF_ERROR(file->Read(offset, n, &chunk, scratch.get()));
+    if (chunk.size() != n) {
+      return errors::DataLoss("Unexpected end of file ", src, " at offset ",
+                              offset + chunk.size(), "; expected ", size,
+                              " bytes.");
+    }
+    TF_RETURN_IF_ERROR(dst->Append(chunk));
+    offset += n;
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+std::string ColumnarCacheFilename(StringPiece prefix) {
+  return strings::StrCat(prefix, kColumnarCacheSuffix);
+}
+
+bool IsColumnarCacheCompatible(const DataTypeVector& dtypes,
+                               const std::vector<PartialTensorShape>& shapes) {
+  if (dtypes.empty() || dtypes.size() != shapes.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < dtypes.size(); ++i) {
+    if (!DataTypeCanUseMemcpy(dtypes[i]) || !shapes[i].IsFullyDefined()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+ColumnarCacheWriter::ColumnarCacheWriter(
+    Env* env, StringPiece filename, const DataTypeVector& dtypes,
+    const std::vector<PartialTensorShape>& shapes)
+    : env_(env), filename_(filename), dtypes_(dtypes) {
+  DCHECK(IsColumnarCacheCompatible(dtypes, shapes));
+  const uint64 random = random::New64();
+  for (size_t i = 0; i < dtypes_.size(); ++i) {
+    TensorShape shape;
+    if (status_.ok() && !shapes[i].AsTensorShape(&shape)) {
+      status_ = errors::InvalidArgument("Shape ", shapes[i].DebugString(),
+                                        " is not fully defined.");
+    }
+    shapes_.push_back(shape);
+    column_filenames_.push_back(
+        strings::StrCat(filename_, ".column", i, kTempStateSuffix, random));
+    std::unique_ptr<WritableFile> file;
+    if (status_.ok()) {
+      status_ = env_->NewWritableFile(column_filenames_.back(), &file);
+    }
+    column_files_.push_back(std::move(file));
+  }
+}
+
+ColumnarCacheWriter::~ColumnarCacheWriter() {
+  if (!finished_) {
+    column_files_.clear();
+    DeleteColumnFiles();
+  }
+}
+
+Status ColumnarCacheWriter::Add(const std::vector<Tensor>& components) {
+  TF_RETURN_IF_ERROR(status_);
+  if (finished_) {
+    return errors::FailedPrecondition("Columnar cache writer for ", filename_,
+                                      " is already finished.");
+  }
+  if (components.size() != dtypes_.size()) {
+    return errors::InvalidArgument("Expected ", dtypes_.size(),
+                                   " components, got ", components.size(),
+                                   ".");
+  }
+  for (size_t i = 0; i < components.size(); ++i) {
+    const Tensor& t = components[i];
+    if (t.dtype() != dtypes_[i] || t.shape() != shapes_[i]) {
+      return errors::InvalidArgument(
+          "Component ", i, " of the element has type ",
+          DataTypeString(t.dtype()), " and shape ", t.shape().DebugString(),
+          ", but the columnar cache expects type ",
+          DataTypeString(dtypes_[i]), " and shape ",
+          shapes_[i].DebugString(), ".");
+    }
+  }
+  for (size_t i = 0; i < components.size(); ++i) {
+    status_ = column_files_[i]->Append(components[i].tensor_data());
+    TF_RETURN_IF_ERROR(status_);
+  }
+  ++num_elements_;
+  return Status::OK();
+}
+
+Status ColumnarCacheWriter::Finish() {
+  TF_RETURN_IF_ERROR(status_);
+  if (finished_) {
+    return errors::FailedPrecondition("Columnar cache writer for ", filename_,
+                                      " is already finished.");
+  }
+  finished_ = true;
+  auto cleanup = [this](Status s) {
+    DeleteColumnFiles();
+    status_ = s;
+    return s;
+  };
+  for (auto& file : column_files_) {
+    Status s = file->Close();
+    if (!s.ok()) return cleanup(s);
+  }
+  column_files_.clear();
+
+  std::vector<int> ranks;
+  for (const TensorShape& shape : shapes_) {
+    ranks.push_back(shape.dims());
+  }
+  string header(kColumnarCacheMagic, kColumnarCacheMagicSize);
+  core::PutFixed64(&header, num_elements_);
+  core::PutFixed64(&header, dtypes_.size());
+  std::vector<uint64> offsets;
+  uint64 offset = RoundUpToAlignment(HeaderSize(ranks));
+  for (size_t i = 0; i < dtypes_.size(); ++i) {
+    core::PutFixed64(&header, dtypes_[i]);
+    core::PutFixed64(&header, shapes_[i].dims());
+    for (int64_t dim : shapes_[i].dim_sizes()) {
+      core::PutFixed64(&header, dim);
+    }
+    core::PutFixed64(&header, offset);
+    offsets.push_back(offset);
+    offset = RoundUpToAlignment(
+        offset + num_elements_ * ElementSize(dtypes_[i], shapes_[i]));
+  }
+  DCHECK_EQ(header.size(), HeaderSize(ranks));
+
+  const string temp_filename =
+      strings::StrCat(filename_, kTempStateSuffix, random::New64());
+  std::unique_ptr<WritableFile> file;
+  Status s = env_->NewWritableFile(temp_filename, &file);
+  if (!s.ok()) return cleanup(s);
+  s = file->Append(header);
+  uint64 written = header.size();
+  for (size_t i = 0; s.ok() && i < dtypes_.size(); ++i) {
+    s = file->Append(string(offsets[i] - written, '\0'));
+    if (s.ok()) s = AppendFile(env_, column_filenames_[i], file.get());
+    written = offsets[i] + num_elements_ * ElementSize(dtypes_[i], shapes_[i]);
+  }
+  if (s.ok()) s = file->Close();
+  if (s.ok()) s = env_->RenameFile(temp_filename, filename_);
+  if (!s.ok()) {
+    env_->DeleteFile(temp_filename).IgnoreError();
+  }
+  return cleanup(s);
+}
+
+void ColumnarCacheWriter::DeleteColumnFiles() {
+  for (const string& filename : column_filenames_) {
+    Status s = env_->DeleteFile(filename);
+    if (!s.ok() && !errors::IsNotFound(s)) {
+      LOG(WARNING) << "Failed to delete " << filename << ": " << s;
+    }
+  }
+}
+
+Status ColumnarCacheReader::Open(
+    Env* env, StringPiece filename, const DataTypeVector& dtypes,
+    const std::vector<PartialTensorShape>& shapes,
+    std::unique_ptr<ColumnarCacheReader>* reader) {
+  if (!IsColumnarCacheCompatible(dtypes, shapes)) {
+    return errors::InvalidArgument(
+        "Elements with types ", DataTypeVectorString(dtypes),
+        " cannot be read from a columnar cache.");
+  }
+  std::unique_ptr<ColumnarCacheReader> r(new ColumnarCacheReader());
+  r->filename_ = string(filename);
+  uint64 file_size;
+  TF_RETURN_IF_ERROR(env->GetFileSize(r->filename_, &file_size));
+  Status s = env->NewReadOnlyMemoryRegionFromFile(r->filename_, &r->region_);
+  if (!s.ok() || !r->region_) {
+    VLOG(2) << "Failed to memory-map " << r->filename_
+            << ", reading it with positioned reads instead: " << s;
+    r->region_.reset();
+    TF_RETURN_IF_ERROR(env->NewRandomAccessFile(r->filename_, &r->file_));
+  }
+
+  std::vector<int> ranks;
+  for (const PartialTensorShape& shape : shapes) {
+    ranks.push_back(shape.dims());
+  }
+  const uint64 header_size = HeaderSize(ranks);
+  if (file_size < header_size) {
+    return errors::DataLoss("Columnar cache file ", r->filename_, " has ",
+                            file_size, " bytes, which is less than the ",
+                            header_size, " bytes of its header.");
+  }
+  string header(header_size, '\0');
+  TF_RETURN_IF_ERROR(r->ReadBytes(0, header_size, &header[0]));
+  TF_RETURN_IF_ERROR(r->ParseHeader(header, file_size, dtypes, shapes));
+  *reader = std::move(r);
+  return Status::OK();
+}
+
+Status ColumnarCacheReader::ParseHeader(
+    StringPiece header, uint64 file_size, const DataTypeVector& dtypes,
+    const std::vector<PartialTensorShape>& shapes) {
+  if (!absl::StartsWith(header, StringPiece(kColumnarCacheMagic,
+                                            kColumnarCacheMagicSize))) {
+    return errors::DataLoss(filename_, " is not a columnar cache file.");
+  }
+  const char* p = header.data() + kColumnarCacheMagicSize;
+  auto next = [&p]() {
+    const uint64 value = core::DecodeFixed64(p);
+    p += sizeof(uint64);
+    return value;
+  };
+  num_elements_ = next();
+  const uint64 num_components = next();
+  if (num_components != dtypes.size()) {
+    return errors::InvalidArgument("Columnar cache file ", filename_, " has ",
+                                   num_components,
+                                   " components per element, expected ",
+                                   dtypes.size(), ".");
+  }
+  for (size_t i = 0; i < num_components; ++i) {
+    Column column;
+    column.dtype = static_cast<DataType>(next());
+    const uint64 rank = next();
+    if (rank != static_cast<uint64>(shapes[i].dims())) {
+      return errors::InvalidArgument(
+          "Component ", i, " in columnar cache file ", filename_, " has rank ",
+          rank, ", expected ", shapes[i].dims(), ".");
+    }
+    for (uint64 d = 0; d < rank; ++d) {
+      Status s = column.shape.AddDimWithStatus(static_cast<int64_t>(next()));
+      if (!s.ok()) {
+        return errors::DataLoss("Component ", i, " in columnar cache file ",
+                                filename_, " has an invalid shape: ",
+                                s.error_message());
+      }
+    }
+    column.offset = next();
+    if (column.dtype != dtypes[i] || !shapes[i].IsIdenticalTo(column.shape)) {
+      return errors::InvalidArgument(
+          "Component ", i, " in columnar cache file ", filename_,
+          " has type ", DataTypeString(column.dtype), " and shape ",
+          column.shape.DebugString(), ", expected type ",
+          DataTypeString(dtypes[i]), " and shape ", shapes[i].DebugString(),
+          ".");
+    }
+    const int64_t element_size = MultiplyWithoutOverflow(
+        column.shape.num_elements(), DataTypeSize(column.dtype));
+    if (element_size < 0) {
+      return errors::DataLoss("Component ", i, " in columnar cache file ",
+                              filename_, " has shape ",
+                              column.shape.DebugString(),
+                              " whose size in bytes overflows.");
+    }
+    column.element_size = element_size;
+    // Equivalent to `offset + num_elements_ * element_size > file_size`,
+    // without overflowing for corrupt headers.
+    if (column.offset > file_size ||
+        (column.element_size > 0 &&
+         num_elements_ > (file_size - column.offset) / column.element_size)) {
+      return errors::DataLoss("Columnar cache file ", filename_,
+                              " is truncated: component ", i, " ends past ",
+                              "the end of the file.");
+    }
+    columns_.push_back(std::move(column));
+  }
+  return Status::OK();
+}
+
+Status ColumnarCacheReader::ReadBytes(uint64 offset, size_t n,
+                                      char* dst) const {
+  if (region_) {
+    std::memcpy(dst, static_cast<const char*>(region_->data()) + offset, n);
+    return Status::OK();
+  }
+  StringPiece result;
+  TF_RETURN_IF_ERROR(file_->Read(offset, n, &result, dst));
+  if (result.size() != n) {
+    return errors::DataLoss("Unexpected end of columnar cache file ",
+                            filename_, " at offset ", offset + result.size(),
+                            ".");
+  }
+  if (result.data() != dst) {
+    std::memcpy(dst, result.data(), n);
+  }
+  return Status::OK();
+}
+
+Status ColumnarCacheReader::Get(Allocator* allocator, int64_t index,
+                                std::vector<Tensor>* out_tensors) const {
+  if (index < 0 || index >= num_elements_) {
+    return errors::OutOfRange("Index out of range [0, ", num_elements_,
+                              "): ", index);
+  }
+  out_tensors->clear();
+  out_tensors->reserve(columns_.size());
+  for (const Column& column : columns_) {
+    out_tensors->emplace_back(allocator, column.dtype, column.shape);
+    if (column.element_size == 0) continue;
+    TF_RETURN_IF_ERROR(
+        ReadBytes(column.offset + index * column.element_size,
+                  column.element_size,
+                  static_cast<char*>(out_tensors->back().data())));
+  }
+  return Status::OK();
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,166 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_DATA_COLUMNAR_CACHE_H_
+#define TENSORFLOW_CORE_KERNELS_DATA_COLUMNAR_CACHE_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/stringpiece.h"
+
+namespace tensorflow {
+namespace data {
+
+// A file format for caches of dataset elements whose components all have a
+// fixed shape and a type that can be copied with `memcpy`.
+//
+// The file starts with a header describing the components, followed by one
+// contiguous block ("column") per component. The column of a component holds
+// the data of that component for all elements, in element order, so the data
+// of component `c` of element `i` is at `column_offset(c) + i * size(c)`. The
+// header format is:
+//
+//   magic            : 8 bytes, `kColumnarCacheMagic`
+//   num_elements     : fixed64
+//   num_components   : fixed64
+//   for each component:
+//     dtype          : fixed64
+//     rank           : fixed64
+//     dims           : `rank` x fixed64
+//     column_offset  : fixed64
+//
+// All integers are little-endian, and columns start at multiples of
+// `kColumnarCacheAlignment` bytes.
+//
+// Reading an element does not parse anything, so the reader can memory-map the
+// file and serve elements in any order.
+
+constexpr char kColumnarCacheMagic[] = "TFDCOLv1";
+constexpr size_t kColumnarCacheMagicSize = 8;
+constexpr size_t kColumnarCacheAlignment = 64;
+
+// Returns the name of the columnar cache file for the cache with the given
+// prefix.
+std::string ColumnarCacheFilename(StringPiece prefix);
+
+// Returns whether elements with the given component types and shapes can be
+// stored in a columnar cache.
+bool IsColumnarCacheCompatible(const DataTypeVector& dtypes,
+                               const std::vector<PartialTensorShape>& shapes);
+
+// Writes a columnar cache file.
+//
+// The data of each component is first appended to a temporary file, and the
+// temporary files are concatenated into `filename` by `Finish()`. The cache
+// file is renamed into place only once it is complete, so readers never
+// observe a partially written cache.
+//
+// Not thread-safe.
+class ColumnarCacheWriter {
+ public:
+  // REQUIRES: `IsColumnarCacheCompatible(dtypes, shapes)`.
+  ColumnarCacheWriter(Env* env, StringPiece filename,
+                      const DataTypeVector& dtypes,
+                      const std::vector<PartialTensorShape>& shapes);
+  ~ColumnarCacheWriter();
+
+  // Appends an element, whose components must have the types and shapes the
+  // writer was created with.
+  Status Add(const std::vector<Tensor>& components);
+
+  // Writes the cache file. Must be called exactly once, after which the
+  // writer can no longer be used.
+  Status Finish();
+
+  // Returns the first error encountered.
+  Status status() const { return status_; }
+
+ private:
+  // Deletes the temporary per-component files.
+  void DeleteColumnFiles();
+
+  Env* const env_;  // Not owned.
+  const std::string filename_;
+  const DataTypeVector dtypes_;
+  std::vector<TensorShape> shapes_;
+  std::vector<std::string> column_filenames_;
+  std::vector<std::unique_ptr<WritableFile>> column_files_;
+  int64_t num_elements_ = 0;
+  bool finished_ = false;
+  Status status_;
+};
+
+// Reads elements from a columnar cache file written by `ColumnarCacheWriter`.
+//
+// The file is memory-mapped when the file system supports it, and read with
+// positioned reads otherwise.
+//
+// Thread-safe.
+class ColumnarCacheReader {
+ public:
+  // Opens the cache file `filename`, which must hold elements with the given
+  // component types and shapes.
+  static Status Open(Env* env, StringPiece filename,
+                     const DataTypeVector& dtypes,
+                     const std::vector<PartialTensorShape>& shapes,
+                     std::unique_ptr<ColumnarCacheReader>* reader);
+
+  // Returns the number of elements in the cache.
+  int64_t num_elements() const { return num_elements_; }
+
+  // Reads the element at `index` into `out_tensors`, allocating the component
+  // tensors with `allocator`.
+  Status Get(Allocator* allocator, int64_t index,
+             std::vector<Tensor>* out_tensors) const;
+
+ private:
+  struct Column {
+    DataType dtype;
+    TensorShape shape;
+    uint64 offset;
+    uint64 element_size;
+  };
+
+  ColumnarCacheReader() = default;
+
+  // Reads `n` bytes at `offset` of the cache file into `dst`.
+  Status ReadBytes(uint64 offset, size_t n, char* dst) const;
+
+  // Parses and validates the header, which is stored in `header`.
+  Status ParseHeader(StringPiece header, uint64 file_size,
+                     const DataTypeVector& dtypes,
+                     const std::vector<PartialTensorShape>& shapes);
+
+  std::string filename_;
+  // Exactly one of `region_` and `file_` is set.
+  std::unique_ptr<ReadOnlyMemoryRegion> region_;
+  std::unique_ptr<RandomAccessFile> file_;
+  int64_t num_elements_ = 0;
+  std::vector<Column> columns_;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_DATA_COLUMNAR_CACHE_H_
@@ -0,0 +1,188 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/columnar_cache.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/coding.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+class ColumnarCacheTest : public ::testing::Test {
+ protected:
+  ColumnarCacheTest()
+      : dtypes_({DT_INT64, DT_FLOAT}),
+        shapes_({PartialTensorShape({}), PartialTensorShape({2, 3})}) {}
+
+  std::string Filename(const std::string& name) {
+    return ColumnarCacheFilename(io::JoinPath(testing::TmpDir(), name));
+  }
+
+  std::vector<Tensor> Element(int64_t i) {
+    std::vector<float> values;
+    for (int j = 0; j < 6; ++j) {
+      values.push_back(i * 10 + j);
+    }
+    return {test::AsScalar<int64_t>(i),
+            test::AsTensor<float>(values, TensorShape({2, 3}))};
+  }
+
+  Status Write(const std::string& filename, int64_t num_elements) {
+    ColumnarCacheWriter writer(Env::Default(), filename, dtypes_, shapes_);
+    for (int64_t i = 0; i < num_elements; ++i) {
+      TF_RETURN_IF_ERROR(writer.Add(Element(i)));
+    }
+    return writer.Finish();
+  }
+
+  void ExpectElement(const ColumnarCacheReader& reader, int64_t i) {
+    std::vector<Tensor> element;
+    TF_ASSERT_OK(reader.Get(cpu_allocator(), i, &element));
+    std::vector<Tensor> expected = Element(i);
+    ASSERT_EQ(element.size(), expected.size());
+    test::ExpectTensorEqual<int64_t>(element[0], expected[0]);
+    test::ExpectTensorEqual<float>(element[1], expected[1]);
+  }
+
+  const DataTypeVector dtypes_;
+  const std::vector<PartialTensorShape> shapes_;
+};
+
+TEST_F(ColumnarCacheTest, Compatibility) {
+  EXPECT_TRUE(IsColumnarCacheCompatible(dtypes_, shapes_));
+  EXPECT_FALSE(IsColumnarCacheCompatible({}, {}));
+  EXPECT_FALSE(
+      IsColumnarCacheCompatible({DT_STRING}, {PartialTensorShape({})}));
+  EXPECT_FALSE(
+      IsColumnarCacheCompatible({DT_INT32}, {PartialTensorShape({-1})}));
+}
+
+TEST_F(ColumnarCacheTest, SequentialAndRandomAccess) {
+  const std::string filename = Filename("sequential_and_random_access");
+  constexpr int64_t kNumElements = 100;
+  TF_ASSERT_OK(Write(filename, kNumElements));
+
+  std::unique_ptr<ColumnarCacheReader> reader;
+  TF_ASSERT_OK(ColumnarCacheReader::Open(Env::Default(), filename, dtypes_,
+                                         shapes_, &reader));
+  EXPECT_EQ(reader->num_elements(), kNumElements);
+  for (int64_t i = 0; i < kNumElements; ++i) {
+    ExpectElement(*reader, i);
+  }
+  for (int64_t i : {57, 3, 99, 0, 42}) {
+    ExpectElement(*reader, i);
+  }
+  std::vector<Tensor> element;
+  EXPECT_TRUE(errors::IsOutOfRange(
+      reader->Get(cpu_allocator(), kNumElements, &element)));
+  EXPECT_TRUE(
+      errors::IsOutOfRange(reader->Get(cpu_allocator(), -1, &element)));
+}
+
+TEST_F(ColumnarCacheTest, Empty) {
+  const std::string filename = Filename("empty");
+  TF_ASSERT_OK(Write(filename, 0));
+
+  std::unique_ptr<ColumnarCacheReader> reader;
+  TF_ASSERT_OK(ColumnarCacheReader::Open(Env::Default(), filename, dtypes_,
+                                         shapes_, &reader));
+  EXPECT_EQ(reader->num_elements(), 0);
+}
+
+TEST_F(ColumnarCacheTest, AddRejectsMismatchedElement) {
+  ColumnarCacheWriter writer(Env::Default(), Filename("mismatched_element"),
+                             dtypes_, shapes_);
+  Status s = writer.Add({test::AsScalar<int64_t>(0),
+                         test::AsTensor<float>({1.0, 2.0}, {2})});
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+  s = writer.Add({test::AsScalar<int64_t>(0)});
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+}
+
+TEST_F(ColumnarCacheTest, OpenRejectsMismatchedSpec) {
+  const std::string filename = Filename("mismatched_spec");
+  TF_ASSERT_OK(Write(filename, 10));
+
+  std::unique_ptr<ColumnarCacheReader> reader;
+  Status s = ColumnarCacheReader::Open(
+      Env::Default(), filename, {DT_INT64, DT_DOUBLE}, shapes_, &reader);
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+  s = ColumnarCacheReader::Open(
+      Env::Default(), filename, dtypes_,
+      {PartialTensorShape({}), PartialTensorShape({3, 2})}, &reader);
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+}
+
+TEST_F(ColumnarCacheTest, OpenRejectsTruncatedFile) {
+  const std::string filename = Filename("truncated");
+  TF_ASSERT_OK(Write(filename, 10));
+  std::string contents;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), filename, &contents));
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), filename,
+                                 contents.substr(0, contents.size() - 1)));
+
+  std::unique_ptr<ColumnarCacheReader> reader;
+  Status s = ColumnarCacheReader::Open(Env::Default(), filename, dtypes_,
+                                       shapes_, &reader);
+  EXPECT_TRUE(errors::IsDataLoss(s)) << s;
+}
+
+TEST_F(ColumnarCacheTest, OpenRejectsCorruptHeader) {
+  const std::string filename = Filename("corrupt_header");
+  TF_ASSERT_OK(Write(filename, 10));
+  std::string contents;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), filename, &contents));
+  // The header is the magic, the number of elements and of components, and
+  // for each component its type, rank, dimensions and offset.
+  constexpr size_t kNumElementsOffset = kColumnarCacheMagicSize;
+  constexpr size_t kFirstDimOffset = kColumnarCacheMagicSize + 7 * 8;
+  auto corrupt = [&](size_t offset, uint64 value) {
+    std::string corrupted = contents;
+    core::EncodeFixed64(&corrupted[offset], value);
+    TF_CHECK_OK(WriteStringToFile(Env::Default(), filename, corrupted));
+    std::unique_ptr<ColumnarCacheReader> reader;
+    return ColumnarCacheReader::Open(Env::Default(), filename, dtypes_,
+                                     shapes_, &reader);
+  };
+
+  Status s = corrupt(kFirstDimOffset, static_cast<uint64>(-2));
+  EXPECT_TRUE(errors::IsDataLoss(s)) << s;
+  s = corrupt(kNumElementsOffset, ~uint64{0} / 4);
+  EXPECT_TRUE(errors::IsDataLoss(s)) << s;
+}
+
+TEST_F(ColumnarCacheTest, OpenRejectsOtherFiles) {
+  const std::string filename = Filename("other");
+  TF_ASSERT_OK(
+      WriteStringToFile(Env::Default(), filename, std::string(1024, 'x')));
+
+  std::unique_ptr<ColumnarCacheReader> reader;
+  Status s = ColumnarCacheReader::Open(Env::Default(), filename, dtypes_,
+                                       shapes_, &reader);
+  EXPECT_TRUE(errors::IsDataLoss(s)) << s;
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -12,6 +12,9 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
+#include <array>
+#include <cstring>
+
 #include "tensorflow/core/framework/common_shape_fns.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/op.h"
@@ -184,7 +187,15 @@ class CSVDatasetOp : public DatasetOpKernel {
           op_version_(op_version),
           use_compression_(!compression_type.empty()),
           compression_type_(std::move(compression_type)),
-          options_(options) {}
+          options_(options) {
+      unquoted_field_stops_.fill(false);
+      for (unsigned char c : {static_cast<unsigned char>(delim_),
+                              static_cast<unsigned char>('\n'),
+                              static_cast<unsigned char>('\r')}) {
+        unquoted_field_stops_[c] = true;
+      }
+      if (use_quote_delim_) unquoted_field_stops_['"'] = true;
+    }
 
     std::unique_ptr<IteratorBase> MakeIteratorInternal(
         const string& prefix) const override {
@@ -508,7 +519,7 @@ class CSVDatasetOp : public DatasetOpKernel {
         pos_++;  // Starting quotation mark
 
         Status parse_result;
-        while (true) {  // Each iter reads 1 char, filling buffer if necessary
+        while (true) {  // Each iter skips to a quote, refilling the buffer
           if (pos_ >= buffer_.size()) {
             Status s = SaveAndFillBuffer(&earlier_pieces, &start, include);
             if (errors::IsOutOfRange(s)) {
@@ -520,49 +531,52 @@ class CSVDatasetOp : public DatasetOpKernel {
             }
           }
 
-          char ch = buffer_[pos_];
-          if (ch == '"') {
-            // When we encounter a quote, we look ahead to the next character to
-            // decide what to do
-            pos_++;
-            if (pos_ >= buffer_.size()) {
-              Status s = SaveAndFillBuffer(&earlier_pieces, &start, include);
-              if (errors::IsOutOfRange(s)) {
-                // This was the last field. We are done
-                *end_of_record = true;
-                parse_result.Update(QuotedFieldToOutput(
-                    ctx, StringPiece(), out_tensors, earlier_pieces, include));
-                return parse_result;
-              } else if (!s.ok()) {
-                return s;
-              }
-            }
-
-            char next = buffer_[pos_];
-            pos_++;
-            if (next == dataset()->delim_) {
-              parse_result.Update(QuotedFieldToOutput(
-                  ctx, StringPiece(&buffer_[start], pos_ - 1 - start),
-                  out_tensors, earlier_pieces, include));
-              return parse_result;
+          // Only quotes can end a quoted field, so skip to the next one.
+          const char* quote = static_cast<const char*>(
+              memchr(buffer_.data() + pos_, '"', buffer_.size() - pos_));
+          if (quote == nullptr) {
+            pos_ = buffer_.size();
+            continue;
+          }
+          pos_ = quote - buffer_.data();
 
-            } else if (next == '\n' || next == '\r') {
+          // When we encounter a quote, we look ahead to the next character to
+          // decide what to do
+          pos_++;
+          if (pos_ >= buffer_.size()) {
+            Status s = SaveAndFillBuffer(&earlier_pieces, &start, include);
+            if (errors::IsOutOfRange(s)) {
+              // This was the last field. We are done
               *end_of_record = true;
               parse_result.Update(QuotedFieldToOutput(
-                  ctx, StringPiece(&buffer_[start], pos_ - 1 - start),
-                  out_tensors, earlier_pieces, include));
-              if (next == '\r') SkipNewLineIfNecessary();
+                  ctx, StringPiece(), out_tensors, earlier_pieces, include));
               return parse_result;
-            } else if (next != '"') {
-              // Take note of the error, but keep going to end of field.
-              include = false;  // So we don't get funky errors when trying to
-                                // unescape the quotes.
-              parse_result.Update(errors::InvalidArgument(
-                  "Quote inside a string has to be escaped by another quote"));
+            } else if (!s.ok()) {
+              return s;
             }
+          }
 
-          } else {
-            pos_++;
+          char next = buffer_[pos_];
+          pos_++;
+          if (next == dataset()->delim_) {
+            parse_result.Update(QuotedFieldToOutput(
+                ctx, StringPiece(&buffer_[start], pos_ - 1 - start),
+                out_tensors, earlier_pieces, include));
+            return parse_result;
+
+          } else if (next == '\n' || next == '\r') {
+            *end_of_record = true;
+            parse_result.Update(QuotedFieldToOutput(
+                ctx, StringPiece(&buffer_[start], pos_ - 1 - start),
+                out_tensors, earlier_pieces, include));
+            if (next == '\r') SkipNewLineIfNecessary();
+            return parse_result;
+          } else if (next != '"') {
+            // Take note of the error, but keep going to end of field.
+            include = false;  // So we don't get funky errors when trying to
+                              // unescape the quotes.
+            parse_result.Update(errors::InvalidArgument(
+                "Quote inside a string has to be escaped by another quote"));
           }
         }
       }
@@ -641,7 +655,8 @@ class CSVDatasetOp : public DatasetOpKernel {
         size_t start = pos_;
         Status parse_result;
 
-        while (true) {  // Each iter reads 1 char, filling buffer if necessary
+        // Each iter reads to a special char, filling buffer if necessary.
+        while (true) {
           if (pos_ >= buffer_.size()) {
             Status s = SaveAndFillBuffer(&earlier_pieces, &start, include);
             // Handle errors
@@ -657,6 +672,8 @@ class CSVDatasetOp : public DatasetOpKernel {
             }
           }
 
+          pos_ = FindUnquotedFieldStop(pos_);
+          if (pos_ >= buffer_.size()) continue;
           char ch = buffer_[pos_];
 
           if (ch == dataset()->delim_) {
@@ -687,6 +704,19 @@ class CSVDatasetOp : public DatasetOpKernel {
         }
       }
 
+      // Returns the position of the first character at or after `pos` in
+      // buffer_ that ends an unquoted field or is invalid in it, or
+      // buffer_.size() if there is none.
+      size_t FindUnquotedFieldStop(size_t pos) const
+          TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        const std::array<bool, 256>& stops = dataset()->unquoted_field_stops_;
+        const size_t size = buffer_.size();
+        const unsigned char* data =
+            reinterpret_cast<const unsigned char*>(buffer_.data());
+        while (pos < size && !stops[data[pos]]) ++pos;
+        return pos;
+      }
+
       Status FillBuffer(tstring* result) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
         result->clear();
         ++num_buffer_reads_;
@@ -920,6 +950,9 @@ class CSVDatasetOp : public DatasetOpKernel {
     const bool use_compression_;
     const tstring compression_type_;
     const io::ZlibCompressionOptions options_;
+    // Characters that end an unquoted field or are invalid in it. Other
+    // characters are skipped without looking at them one by one.
+    std::array<bool, 256> unquoted_field_stops_;
   };  // class Dataset
 
   const int op_version_;
@@ -719,6 +719,7 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
     void Heartbeat() TF_LOCKS_EXCLUDED(mu_) {
       ClientHeartbeatRequest req;
       req.set_job_client_id(job_client_id_);
+      req.set_client_locality(LocalWorkers::Locality());
       if (StrictRoundRobin()) {
         mutex_lock l(mu_);
         req.set_current_round(current_round_);
@@ -962,6 +963,7 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
         return nullptr;
       }
 
+      const int64_t min_locality_distance = MinLocalityDistance();
       for (int i = 0; i < tasks_.size(); ++i) {
         std::shared_ptr<Task>& task = tasks_[next_task_index_];
         if (StrictRoundRobin() &&
@@ -985,6 +987,14 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
           AdvanceTaskIndex();
           continue;
         }
+        if (ShouldDeferFartherTask(*task, min_locality_distance)) {
+          VLOG(4) << "Deferring task " << task->info.task_id()
+                  << " at locality distance "
+                  << task->info.locality_distance() << " in favor of tasks at "
+                  << "distance " << min_locality_distance;
+          AdvanceTaskIndex();
+          continue;
+        }
         task->round = current_round_;
         AdvanceTaskIndex();
         return task;
@@ -992,6 +1002,41 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
       return nullptr;
     }
 
+    // Returns the smallest locality distance of the tasks left to read.
+    int64_t MinLocalityDistance() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      int64_t min_distance = std::numeric_limits<int64_t>::max();
+      for (const std::shared_ptr<Task>& task : tasks_) {
+        if (!task->end_of_sequence && !task->removed) {
+          min_distance =
+              std::min(min_distance, task->info.locality_distance());
+        }
+      }
+      return min_distance;
+    }
+
+    // Returns whether to skip `task` in favor of the nearest tasks, at
+    // `min_locality_distance`. With `TARGET_WORKERS_AUTO`, tasks are read
+    // nearest-first: a task one domain farther is only read while at most half
+    // of `max_outstanding_requests_` results are buffered, i.e. while the
+    // nearer tasks fall behind the consumer, a task two domains farther while
+    // at most a quarter are, and so on.
+    bool ShouldDeferFartherTask(const Task& task,
+                                int64_t min_locality_distance) const
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (StrictRoundRobin() ||
+          dataset()->target_workers_ != TARGET_WORKERS_AUTO) {
+        return false;
+      }
+      const int64_t excess_distance =
+          task.info.locality_distance() - min_locality_distance;
+      if (excess_distance <= 0) {
+        return false;
+      }
+      const int64_t max_buffered_results =
+          max_outstanding_requests_ >> std::min<int64_t>(excess_distance, 62);
+      return static_cast<int64_t>(results_.size()) > max_buffered_results;
+    }
+
     // Increments the next task index, starting over if all tasks have been
     // processed.
     void AdvanceTaskIndex() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
@@ -384,6 +384,12 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
         if (num_parallel_calls_->value == model::kAutotune) {
           num_parallel_calls_->value = GetAutotuneDefaultParallelism(ctx);
         }
+        // Batches are split across the private thread pool of the dataset,
+        // if it has one, and across the device thread pool otherwise.
+        if (ctx->thread_pool()) {
+          thread_pool_ = ctx->CreateThreadPool("tf_data_parse_example",
+                                               ctx->runner_threadpool_size());
+        }
         TF_RETURN_IF_ERROR(RegisterCancellationCallback(
             ctx->cancellation_manager(),
             [this]() { CancelThreads(/*wait=*/false); }, &deregister_fn_));
@@ -648,15 +654,29 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
 
       Status ParseExample(IteratorContext* ctx, std::vector<Tensor> input,
                           std::vector<Tensor>* output) {
-        thread::ThreadPool* device_threadpool =
-            ctx->flr()->device()->tensorflow_cpu_worker_threads()->workers;
+        thread::ThreadPool* thread_pool = thread_pool_.get();
+        if (thread_pool == nullptr) {
+          thread_pool =
+              ctx->flr()->device()->tensorflow_cpu_worker_threads()->workers;
+        }
+        // The whole batch is parsed by a single `FastParseExample` call, which
+        // splits it into minibatches across `thread_pool` and writes the dense
+        // features straight into batch-shaped outputs. The serialized examples
+        // are parsed in place when they come in a single tensor, and are only
+        // gathered otherwise.
+        gtl::ArraySlice<tstring> serialized;
         std::vector<tstring> slice_vec;
-        for (const Tensor& t : input) {
-          auto serialized_t = t.flat<tstring>();
-          gtl::ArraySlice<tstring> slice(serialized_t.data(),
-                                         serialized_t.size());
-          for (auto it = slice.begin(); it != slice.end(); it++)
-            slice_vec.push_back(*it);
+        if (input.size() == 1) {
+          auto serialized_t = input[0].flat<tstring>();
+          serialized = gtl::ArraySlice<tstring>(serialized_t.data(),
+                                                serialized_t.size());
+        } else {
+          for (const Tensor& t : input) {
+            auto serialized_t = t.flat<tstring>();
+            slice_vec.insert(slice_vec.end(), serialized_t.data(),
+                             serialized_t.data() + serialized_t.size());
+          }
+          serialized = slice_vec;
         }
         example::FastParseExampleConfig config = dataset()->config_;
         // local copy of config_ for modification.
@@ -665,8 +685,8 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
           config.collect_feature_stats = true;
         }
         example::Result example_result;
-        TF_RETURN_IF_ERROR(FastParseExample(
-            config, slice_vec, {}, device_threadpool, &example_result));
+        TF_RETURN_IF_ERROR(FastParseExample(config, serialized, {}, thread_pool,
+                                            &example_result));
         (*output).resize(dataset()->key_to_output_index_.size());
         for (int d = 0; d < dataset()->dense_keys_.size(); ++d) {
           int output_index =
@@ -904,6 +924,8 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
       // Counts the number of outstanding calls.
       int64_t num_calls_ TF_GUARDED_BY(*mu_) = 0;
       std::unique_ptr<IteratorBase> input_impl_;
+      // Wraps the private thread pool of the dataset, if any.
+      std::unique_ptr<thread::ThreadPool> thread_pool_;
       // Buffer for storing the invocation results.
       std::deque<std::shared_ptr<InvocationResult>> invocation_results_
           TF_GUARDED_BY(*mu_);
@@ -14,9 +14,13 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/experimental/snapshot_dataset_op.h"
 
+#include <algorithm>
 #include <random>
+#include <utility>
 
+#include "absl/strings/numbers.h"
 #include "absl/time/clock.h"
+#include "absl/types/optional.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/hash_utils.h"
@@ -58,6 +62,8 @@ limitations under the License.
 #include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/core/protobuf/snapshot.pb.h"
 #include "tensorflow/core/util/batch_util.h"
+#include "tensorflow/core/util/determinism.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/ptr_util.h"
 
 namespace tensorflow {
@@ -85,6 +91,56 @@ namespace experimental {
     SnapshotDatasetV2Op::kShardFuncTarguments;
 /* static */ constexpr const int SnapshotDatasetV2Op::kFileFormatVersion;
 
+namespace {
+
+// Returns how often the writer closes its checkpoint files and records its
+// progress in the metadata file, so that a restarted job can resume the run.
+// Defaults to a minute, and can be set with TF_SNAPSHOT_COMMIT_INTERVAL_SECS.
+int64_t CommitIntervalMicros() {
+  int64_t interval_secs;
+  Status s = ReadInt64FromEnvVar("TF_SNAPSHOT_COMMIT_INTERVAL_SECS",
+                                 /*default_val=*/60, &interval_secs);
+  if (!s.ok()) {
+    LOG(WARNING) << s;
+    interval_secs = 60;
+  }
+  return interval_secs * EnvTime::kSecondsToMicros;
+}
+
+// Returns whether a writer should resume the unfinalized run of `metadata`
+// rather than start a new one. A run whose progress has not been committed for
+// three commit intervals is assumed to have been interrupted. Runs committed
+// more recently may still be written by another job, so a new run is started.
+bool ShouldResumeRun(const experimental::SnapshotMetadataRecord& metadata,
+                     int64_t version) {
+  return !metadata.finalized() && metadata.version() == version &&
+         metadata.num_committed_elements() > 0 &&
+         static_cast<int64_t>(EnvTime::NowMicros()) -
+                 metadata.commit_timestamp() >=
+             3 * CommitIntervalMicros();
+}
+
+// Returns an error if a run of `input` can not be resumed. A resumed run skips
+// the elements committed before it was interrupted, so the rest of the
+// snapshot is only consistent with them if the input produces the same
+// elements in the same order every time it is iterated.
+Status CheckResumable(const DatasetBase& input, const Options& options) {
+  if (!OpDeterminismRequired() &&
+      options.optional_deterministic_case() == Options::kDeterministic &&
+      !options.deterministic()) {
+    return errors::FailedPrecondition(
+        "the input is not required to be deterministic");
+  }
+  Status s = input.CheckExternalState();
+  if (!s.ok()) {
+    return errors::FailedPrecondition(
+        "the input depends on external state: ", s.error_message());
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
 // ==== Snapshot Implementation ====
 
 /* The current snapshot on-disk layout is as follows:
@@ -94,7 +150,8 @@ namespace experimental {
  *       - run1/
  *         - 00000000.shard/  // shard index
  *           // new checkpoint files are created on all threads at once, either
- *           // when a file gets too big, or when a TF checkpoint happens.
+ *           // when a file gets too big, when a TF checkpoint happens, or when
+ *           // the writer commits its progress to the metadata file.
  *           - 00000000.snapshot  // checkpoint file 0
  *           - 00000001.snapshot  // checkpoint file 1
  *           - ...
@@ -349,9 +406,21 @@ class SnapshotDatasetV2Op::Dataset : public DatasetBase {
     static constexpr const char* const kRunId = "run_id";
     static constexpr const char* const kCurrentCheckpointId =
         "current_checkpoint_id";
-
-    explicit Writer(const Params& params)
+    static constexpr const char* const kNumElements = "num_elements";
+    static constexpr const char* const kNumResumedElements =
+        "num_resumed_elements";
+
+    // If `resume_from` is set, the writer resumes its unfinalized run: it
+    // passes through the committed elements without writing them again, and
+    // writes the rest of the input to new checkpoint files. If another writer
+    // claims the run first, a new run is started instead.
+    explicit Writer(
+        const Params& params,
+        absl::optional<experimental::SnapshotMetadataRecord> resume_from =
+            absl::nullopt)
         : DatasetIterator<Dataset>(params),
+          commit_interval_micros_(CommitIntervalMicros()),
+          resume_from_(std::move(resume_from)),
           writers_closed_(false),
           run_id_(0),
           current_checkpoint_id_(0) {}
@@ -387,15 +456,21 @@ class SnapshotDatasetV2Op::Dataset : public DatasetBase {
         // overwrite an existing metadata file or not before `RestoreInternal`
         // is potentially called.
         if (run_dir_.empty()) {
-          run_id_ = random::New64();
-
-          // Creates the run directory.
-          run_dir_ = snapshot_util::RunDirectory(
-              snapshot_util::HashDirectory(
-                  io::JoinPath(dataset()->writer_prefix_, dataset()->path_),
-                  dataset()->hash_),
-              run_id_);
-          TF_RETURN_IF_ERROR(ctx->env()->RecursivelyCreateDir(run_dir_));
+          bool resumed = false;
+          if (resume_from_.has_value()) {
+            TF_RETURN_IF_ERROR(ResumeRun(ctx->env(), &resumed));
+          }
+          if (!resumed) {
+            run_id_ = random::New64();
+
+            // Creates the run directory.
+            run_dir_ = snapshot_util::RunDirectory(
+                snapshot_util::HashDirectory(
+                    io::JoinPath(dataset()->writer_prefix_, dataset()->path_),
+                    dataset()->hash_),
+                run_id_);
+            TF_RETURN_IF_ERROR(ctx->env()->RecursivelyCreateDir(run_dir_));
+          }
           TF_RETURN_IF_ERROR(
               WriteMetadataFile(ctx->env(), /*finalized=*/false));
         }
@@ -409,6 +484,11 @@ class SnapshotDatasetV2Op::Dataset : public DatasetBase {
           }
         }
 
+        if (static_cast<int64_t>(EnvTime::NowMicros()) - last_commit_micros_ >=
+            commit_interval_micros_) {
+          TF_RETURN_IF_ERROR(Commit(ctx->env()));
+        }
+
         TF_RETURN_IF_ERROR(
             input_impl_->GetNext(ctx, out_tensors, end_of_sequence));
 
@@ -419,9 +499,15 @@ class SnapshotDatasetV2Op::Dataset : public DatasetBase {
             mutex_lock wsl(writer_status_mu_);
             TF_RETURN_IF_ERROR(writer_status_);
           }
+          num_committed_elements_ = num_elements_;
           return WriteMetadataFile(ctx->env(), /*finalized=*/true);
         }
 
+        if (num_elements_++ < num_resumed_elements_) {
+          // The element is in a committed checkpoint file of the resumed run.
+          return Status::OK();
+        }
+
         int64_t shard_index = 0;
         TF_RETURN_IF_ERROR(GetShardIndex(ctx, *out_tensors, &shard_index));
 
@@ -442,9 +528,10 @@ class SnapshotDatasetV2Op::Dataset : public DatasetBase {
           writers_.insert({shard_index, std::move(writer)});
         }
         current_writer = writers_[shard_index].get();
+        // Writes under `mu_`, so that a commit does not close the writer
+        // before the element is handed to it.
+        current_writer->Write(*out_tensors);
       }
-
-      current_writer->Write(*out_tensors);
       return Status::OK();
     }
 
@@ -457,6 +544,10 @@ class SnapshotDatasetV2Op::Dataset : public DatasetBase {
       TF_RETURN_IF_ERROR(
           writer->WriteScalar(full_name(kCurrentCheckpointId),
                               static_cast<int64_t>(current_checkpoint_id_)));
+      TF_RETURN_IF_ERROR(
+          writer->WriteScalar(full_name(kNumElements), num_elements_));
+      TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kNumResumedElements),
+                                             num_resumed_elements_));
       SignalEOF(/*mark_closed=*/false);
       writers_.clear();
       current_checkpoint_id_++;
@@ -480,6 +571,14 @@ class SnapshotDatasetV2Op::Dataset : public DatasetBase {
               dataset()->hash_),
           run_id_);
       current_checkpoint_id_ = static_cast<uint64>(current_checkpoint_id);
+      // Checkpoints written before runs could be resumed do not have the
+      // element counts.
+      if (reader->Contains(full_name(kNumElements))) {
+        TF_RETURN_IF_ERROR(
+            reader->ReadScalar(full_name(kNumElements), &num_elements_));
+        TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kNumResumedElements),
+                                              &num_resumed_elements_));
+      }
 
       return RestoreInput(ctx, reader, input_impl_);
     }
@@ -507,6 +606,60 @@ class SnapshotDatasetV2Op::Dataset : public DatasetBase {
       return Status::OK();
     }
 
+    // Resumes the run of `resume_from_` from its last commit. Sets `resumed`
+    // to false if the run was claimed by another writer.
+    //
+    // Writers that find the same interrupted run race to claim it by renaming
+    // its directory to a run ID of their own, which only one of them can do.
+    // This relies on the file system renaming directories atomically, which
+    // local file systems and HDFS do but object stores such as GCS do not.
+    Status ResumeRun(Env* env, bool* resumed) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      const experimental::SnapshotMetadataRecord& metadata = *resume_from_;
+      uint64 interrupted_run_id;
+      if (!absl::SimpleAtoi(metadata.run_id(), &interrupted_run_id)) {
+        return errors::DataLoss("Invalid snapshot run ID: ", metadata.run_id());
+      }
+      const std::string hash_dir = snapshot_util::HashDirectory(
+          io::JoinPath(dataset()->writer_prefix_, dataset()->path_),
+          dataset()->hash_);
+      const std::string interrupted_run_dir =
+          snapshot_util::RunDirectory(hash_dir, interrupted_run_id);
+      const uint64 run_id = random::New64();
+      const std::string run_dir = snapshot_util::RunDirectory(hash_dir, run_id);
+      Status s = env->RenameFile(interrupted_run_dir, run_dir);
+      if (!s.ok()) {
+        LOG(INFO) << "Not resuming snapshot run " << interrupted_run_dir
+                  << ", which could not be claimed: " << s;
+        *resumed = false;
+        return Status::OK();
+      }
+      *resumed = true;
+      run_id_ = run_id;
+      run_dir_ = run_dir;
+      current_checkpoint_id_ = metadata.num_committed_checkpoints();
+      num_resumed_elements_ = metadata.num_committed_elements();
+      num_committed_elements_ = num_resumed_elements_;
+      LOG(INFO) << "Resuming snapshot run " << interrupted_run_dir << " as "
+                << run_dir_ << " after " << num_resumed_elements_
+                << " committed elements.";
+      return snapshot_util::DeleteUncommittedCheckpoints(
+          env, run_dir_, current_checkpoint_id_);
+    }
+
+    // Closes the checkpoint files being written, waiting for them to be
+    // flushed, and records in the metadata file that the elements read so far
+    // are committed.
+    Status Commit(Env* env) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      SignalEOF(/*mark_closed=*/false);
+      {
+        mutex_lock wsl(writer_status_mu_);
+        TF_RETURN_IF_ERROR(writer_status_);
+      }
+      current_checkpoint_id_++;
+      num_committed_elements_ = std::max(num_elements_, num_resumed_elements_);
+      return WriteMetadataFile(env, /*finalized=*/false);
+    }
+
     Status WriteMetadataFile(Env* env, bool finalized)
         TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       DCHECK(!run_dir_.empty());
@@ -520,6 +673,13 @@ class SnapshotDatasetV2Op::Dataset : public DatasetBase {
         metadata.add_dtype(output_dtype);
       }
       metadata.set_finalized(finalized);
+      if (finalized) {
+        metadata.set_num_elements(num_committed_elements_);
+      }
+      metadata.set_num_committed_elements(num_committed_elements_);
+      metadata.set_num_committed_checkpoints(current_checkpoint_id_);
+      last_commit_micros_ = EnvTime::NowMicros();
+      metadata.set_commit_timestamp(last_commit_micros_);
       tstring hash_directory = io::JoinPath(
           dataset()->writer_prefix_,
           snapshot_util::HashDirectory(dataset()->path_, dataset()->hash_));
@@ -540,6 +700,8 @@ class SnapshotDatasetV2Op::Dataset : public DatasetBase {
       }
     }
 
+    const int64_t commit_interval_micros_;
+
     mutex mu_;
     mutex writer_status_mu_;
     std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
@@ -556,6 +718,18 @@ class SnapshotDatasetV2Op::Dataset : public DatasetBase {
     // top of this file for the directory layout.
     uint64 current_checkpoint_id_ TF_GUARDED_BY(mu_);
 
+    // The run to resume, if any. See the constructor.
+    absl::optional<experimental::SnapshotMetadataRecord> resume_from_
+        TF_GUARDED_BY(mu_);
+    // The number of input elements read by the run, including those of the
+    // resumed run that are passed through.
+    int64_t num_elements_ TF_GUARDED_BY(mu_) = 0;
+    // The number of elements committed by the run before it was resumed.
+    int64_t num_resumed_elements_ TF_GUARDED_BY(mu_) = 0;
+    // The number of elements in complete checkpoint files.
+    int64_t num_committed_elements_ TF_GUARDED_BY(mu_) = 0;
+    int64_t last_commit_micros_ TF_GUARDED_BY(mu_) = 0;
+
     std::unique_ptr<InstantiatedCapturedFunction> instantiated_shard_func_
         TF_GUARDED_BY(mu_);
   };
@@ -653,6 +827,7 @@ class SnapshotDatasetV2Op::Dataset : public DatasetBase {
    private:
     Status InitializeIterator(IteratorContext* ctx, IteratorStateReader* reader)
         TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      absl::optional<experimental::SnapshotMetadataRecord> resume_from;
       if (reader != nullptr) {
         // Check whether the computed hash directory is the same.
         tstring hash_dir;
@@ -698,6 +873,16 @@ class SnapshotDatasetV2Op::Dataset : public DatasetBase {
         TF_RETURN_IF_ERROR(snapshot_util::DetermineOpState(
             /*mode_string=*/"", file_exists, &metadata,
             /*pending_snapshot_expiry_seconds=*/0, &mode_));
+        if (mode_ == snapshot_util::WRITER && file_exists &&
+            ShouldResumeRun(metadata, kFileFormatVersion)) {
+          Status s = CheckResumable(*dataset()->input_, dataset()->options());
+          if (s.ok()) {
+            resume_from = metadata;
+          } else {
+            LOG(INFO) << "Not resuming snapshot run " << metadata.run_id()
+                      << " because " << s.error_message();
+          }
+        }
       }
 
       switch (mode_) {
@@ -708,8 +893,10 @@ class SnapshotDatasetV2Op::Dataset : public DatasetBase {
               index_);
           break;
         case snapshot_util::WRITER:
-          iterator_ = absl::make_unique<Writer>(Writer::Params{
-              dataset(), absl::StrCat(prefix(), Writer::kIteratorName)});
+          iterator_ = absl::make_unique<Writer>(
+              Writer::Params{dataset(),
+                             absl::StrCat(prefix(), Writer::kIteratorName)},
+              std::move(resume_from));
           break;
         case snapshot_util::PASSTHROUGH:
           iterator_ = absl::make_unique<Passthrough>(Passthrough::Params{
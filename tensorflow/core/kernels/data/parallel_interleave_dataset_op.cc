@@ -116,6 +116,11 @@ constexpr double kDefaultCyclePrefetchFactor = 2.0L;
 // match the behavior of the original implementation.
 constexpr double kDefaultPerIteratorPrefetchFactor = 2.0L;
 
+// When `buffer_output_elements` is autotuned, the number of per-iterator
+// results is tuned between 1 and `kMaxPerIteratorPrefetchFactor *
+// block_length + 1`, subject to the RAM budget of the model.
+constexpr double kMaxPerIteratorPrefetchFactor = 8.0L;
+
 // Period between reporting dataset statistics.
 constexpr int kStatsReportingPeriodMillis = 1000;
 
@@ -131,6 +136,14 @@ int64_t ComputeBufferOutputElements(int64_t configured_buffer_output_elements,
   return kDefaultPerIteratorPrefetchFactor * block_length + 1;
 }
 
+int64_t MaxBufferOutputElements(int64_t configured_buffer_output_elements,
+                                int64_t block_length) {
+  if (configured_buffer_output_elements != model::kAutotune) {
+    return configured_buffer_output_elements;
+  }
+  return kMaxPerIteratorPrefetchFactor * block_length + 1;
+}
+
 int64_t ComputePrefetchInputElements(int64_t configured_prefetch_input_elements,
                                      int64_t cycle_length) {
   if (configured_prefetch_input_elements != model::kAutotune) {
@@ -170,8 +183,7 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         captured_func_(std::move(captured_func)),
         cycle_length_(cycle_length),
         block_length_(block_length),
-        buffer_output_elements_(
-            ComputeBufferOutputElements(buffer_output_elements, block_length)),
+        buffer_output_elements_(buffer_output_elements),
         prefetch_input_elements_(ComputePrefetchInputElements(
             prefetch_input_elements, cycle_length)),
         num_parallel_calls_(num_parallel_calls),
@@ -315,6 +327,11 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
           num_parallel_calls_(std::make_shared<model::SharedState>(
               params.dataset->num_parallel_calls_, mu_,
               num_parallel_calls_cond_var_)),
+          buffer_output_elements_cond_var_(
+              std::make_shared<condition_variable>()),
+          buffer_output_elements_(std::make_shared<model::SharedState>(
+              params.dataset->buffer_output_elements_, mu_,
+              buffer_output_elements_cond_var_)),
           deterministic_(deterministic),
           current_elements_(params.dataset->cycle_length_) {}
 
@@ -347,6 +364,10 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         num_parallel_calls_->value = std::min(
             GetAutotuneDefaultParallelism(ctx), dataset()->cycle_length_);
       }
+      if (buffer_output_elements_->value == model::kAutotune) {
+        buffer_output_elements_->value = ComputeBufferOutputElements(
+            model::kAutotune, dataset()->block_length_);
+      }
       ctx_ = std::make_unique<IteratorContext>(*ctx);
       cancellation_manager_ = absl::make_unique<CancellationManager>();
       IteratorContext::Params params(ctx);
@@ -412,10 +433,18 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
                     static_cast<double>(dataset()->cycle_length_),
                     std::ceil(std::pow(27 * dataset()->cycle_length_, 0.5)))
               : 1;
+      // The cycle length is not tuned because it determines the order in
+      // which elements are produced. The per-iterator buffers are, and their
+      // memory is accounted for by the model's RAM budget.
+      const double max_buffer_output_elements = MaxBufferOutputElements(
+          dataset()->buffer_output_elements_, dataset()->block_length_);
       return model::MakeAsyncInterleaveManyNode(
           std::move(args),
           {model::MakeParameter(kParallelism, num_parallel_calls_, /*min=*/min,
-                                /*max=*/dataset()->cycle_length_)});
+                                /*max=*/dataset()->cycle_length_),
+           model::MakeParameter(model::kBufferSize, buffer_output_elements_,
+                                /*min=*/1,
+                                /*max=*/max_buffer_output_elements)});
     }
 
     // TODO(aaudibert): Refactor the implementations to avoid the need for
@@ -1007,7 +1036,7 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         mutex_lock l(*mu_);
         element->results.push_back(std::move(result));
         NotifyElementUpdate(element);
-        if (element->results.size() == dataset()->buffer_output_elements_) {
+        if (element->results.size() >= buffer_output_elements_->value) {
           break;
         }
       }
@@ -1109,7 +1138,7 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         return true;
       }
       return element->iterator &&
-             element->results.size() < dataset()->buffer_output_elements_;
+             element->results.size() < buffer_output_elements_->value;
     }
 
     inline void IncrementCurrentWorkers() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
@@ -1541,6 +1570,14 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
     // Identifies the maximum number of parallel calls.
     const std::shared_ptr<model::SharedState> num_parallel_calls_;
 
+    // Notified by autotuning when buffer_output_elements_ changes. Nothing
+    // waits on it: a larger buffer is filled as soon as the consumer takes a
+    // result from an element, and a smaller one once the workers check it.
+    std::shared_ptr<condition_variable> buffer_output_elements_cond_var_;
+
+    // Identifies the maximum number of results buffered per element.
+    const std::shared_ptr<model::SharedState> buffer_output_elements_;
+
     // The number of current workers currently alive or scheduled to be started.
     // This includes current workers which are blocked waiting for work.
     int num_current_workers_ TF_GUARDED_BY(mu_) = 0;
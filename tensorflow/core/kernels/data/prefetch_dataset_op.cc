@@ -47,6 +47,7 @@ namespace data {
 /* static */ constexpr const char* const PrefetchDatasetOp::kSlackPeriod;
 /* static */ constexpr const char* const PrefetchDatasetOp::kLegacyAutotune;
 /* static */ constexpr const char* const PrefetchDatasetOp::kBufferSizeMin;
+/* static */ constexpr const char* const PrefetchDatasetOp::kUsePinnedMemory;
 
 namespace {
 
@@ -63,13 +64,15 @@ constexpr char kErrorMessageSuffix[] = ".error_message";
 class PrefetchDatasetOp::Dataset : public DatasetBase {
  public:
   Dataset(OpKernelContext* ctx, const DatasetBase* input, int64_t buffer_size,
-          int64_t slack_period, bool legacy_autotune, int64_t buffer_size_min)
+          int64_t slack_period, bool legacy_autotune, int64_t buffer_size_min,
+          bool use_pinned_memory)
       : DatasetBase(DatasetContext(ctx)),
         input_(input),
         buffer_size_(buffer_size),
         slack_period_(slack_period),
         legacy_autotune_(legacy_autotune),
-        buffer_size_min_(buffer_size_min) {
+        buffer_size_min_(buffer_size_min),
+        use_pinned_memory_(use_pinned_memory) {
     input_->Ref();
   }
 
@@ -128,13 +131,16 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
     b->BuildAttrValue(legacy_autotune_, &legacy_autotune_attr);
     AttrValue buffer_size_min_attr;
     b->BuildAttrValue(buffer_size_min_, &buffer_size_min_attr);
-
-    TF_RETURN_IF_ERROR(
-        b->AddDataset(this, {input_graph_node, buffer_size},
-                      {std::make_pair(kSlackPeriod, slack_period_attr),
-                       std::make_pair(kLegacyAutotune, legacy_autotune_attr),
-                       std::make_pair(kBufferSizeMin, buffer_size_min_attr)},
-                      output));
+    AttrValue use_pinned_memory_attr;
+    b->BuildAttrValue(use_pinned_memory_, &use_pinned_memory_attr);
+
+    TF_RETURN_IF_ERROR(b->AddDataset(
+        this, {input_graph_node, buffer_size},
+        {std::make_pair(kSlackPeriod, slack_period_attr),
+         std::make_pair(kLegacyAutotune, legacy_autotune_attr),
+         std::make_pair(kBufferSizeMin, buffer_size_min_attr),
+         std::make_pair(kUsePinnedMemory, use_pinned_memory_attr)},
+        output));
     return Status::OK();
   }
 
@@ -173,7 +179,7 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
       TF_RETURN_IF_ERROR(RegisterCancellationCallback(
           ctx->cancellation_manager(), [this]() { CancelThreads(); },
           &deregister_fn_));
-      IteratorContext::Params params(ctx);
+      IteratorContext::Params params = InputContextParams(ctx);
       params.cancellation_manager = cancellation_manager_.get();
       return dataset()->input_->MakeIterator(IteratorContext(params), this,
                                              prefix(), &input_impl_);
@@ -235,6 +241,10 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
         }
         // Release mu_
       }
+      if (dataset()->use_pinned_memory_) {
+        IteratorContext input_ctx(InputContextParams(ctx));
+        return input_impl_->GetNext(&input_ctx, out_tensors, end_of_sequence);
+      }
       return input_impl_->GetNext(ctx, out_tensors, end_of_sequence);
     }
 
@@ -454,13 +464,34 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
         TF_EXCLUSIVE_LOCKS_REQUIRED(*mu_) {
       if (!prefetch_thread_) {
         std::shared_ptr<IteratorContext> new_ctx =
-            std::make_shared<IteratorContext>(*ctx);
+            std::make_shared<IteratorContext>(InputContextParams(ctx));
         prefetch_thread_ = ctx->StartThread(
             "tf_data_prefetch", [this, new_ctx]() { PrefetchThread(new_ctx); });
       }
       return Status::OK();
     }
 
+    // Returns the parameters of the context with which to read from the input
+    // iterator.
+    IteratorContext::Params InputContextParams(IteratorContext* ctx) const {
+      IteratorContext::Params params(ctx);
+      if (dataset()->use_pinned_memory_) {
+        // Allocate the elements the input produces in host memory that GPUs
+        // can access directly (e.g. `GpuProcessState::GetGpuHostAllocator`),
+        // so that copying a buffered element to a GPU can use DMA without
+        // first staging it in another host buffer. Devices without such
+        // memory ignore the attributes.
+        params.allocator_getter =
+            [allocator_getter = std::move(params.allocator_getter)](
+                AllocatorAttributes attrs) {
+              attrs.set_on_host(true);
+              attrs.set_gpu_compatible(true);
+              return allocator_getter(attrs);
+            };
+      }
+      return params;
+    }
+
     // Prefetches elements of the input, storing results in an internal buffer.
     //
     // It owns the iterator context passed to it.
@@ -620,6 +651,10 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
   // parameter.
   const int64_t buffer_size_min_ = 0;
 
+  // Determines whether the elements of the input are allocated in host memory
+  // that GPUs can access directly.
+  const bool use_pinned_memory_ = false;
+
   TraceMeMetadata traceme_metadata_;
 };
 
@@ -634,6 +669,9 @@ PrefetchDatasetOp::PrefetchDatasetOp(OpKernelConstruction* ctx)
   if (ctx->HasAttr(kBufferSizeMin)) {
     OP_REQUIRES_OK(ctx, ctx->GetAttr(kBufferSizeMin, &buffer_size_min_));
   }
+  if (ctx->HasAttr(kUsePinnedMemory)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kUsePinnedMemory, &use_pinned_memory_));
+  }
 }
 
 void PrefetchDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
@@ -651,7 +689,7 @@ void PrefetchDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
   }
 
   *output = new Dataset(ctx, input, buffer_size, slack_period_,
-                        legacy_autotune_, buffer_size_min_);
+                        legacy_autotune_, buffer_size_min_, use_pinned_memory_);
 }
 
 namespace {
@@ -29,13 +29,15 @@ class PrefetchDatasetParams : public DatasetParams {
                         DataTypeVector output_dtypes,
                         std::vector<PartialTensorShape> output_shapes,
                         int64_t slack_period, bool legacy_autotune,
-                        int64_t buffer_size_min, string node_name)
+                        int64_t buffer_size_min, string node_name,
+                        bool use_pinned_memory = false)
       : DatasetParams(std::move(output_dtypes), std::move(output_shapes),
                       std::move(node_name)),
         buffer_size_(buffer_size),
         slack_period_(slack_period),
         legacy_autotune_(legacy_autotune),
-        buffer_size_min_(buffer_size_min) {
+        buffer_size_min_(buffer_size_min),
+        use_pinned_memory_(use_pinned_memory) {
     input_dataset_params_.push_back(absl::make_unique<T>(input_dataset_params));
     iterator_prefix_ =
         name_utils::IteratorPrefix(input_dataset_params.dataset_type(),
@@ -60,6 +62,7 @@ class PrefetchDatasetParams : public DatasetParams {
     attr_vector->emplace_back("slack_period", slack_period_);
     attr_vector->emplace_back("legacy_autotune", legacy_autotune_);
     attr_vector->emplace_back("buffer_size_min", buffer_size_min_);
+    attr_vector->emplace_back("use_pinned_memory", use_pinned_memory_);
     attr_vector->emplace_back("metadata", "");
     return Status::OK();
   }
@@ -73,6 +76,7 @@ class PrefetchDatasetParams : public DatasetParams {
   int64_t slack_period_;
   bool legacy_autotune_;
   int64_t buffer_size_min_;
+  bool use_pinned_memory_;
 };
 
 // Test case 1: positive buffer size.
@@ -177,6 +181,24 @@ PrefetchDatasetParams PrefetchDatasetParams6() {
       /*node_name=*/kNodeName);
 }
 
+// Test case 7: use_pinned_memory = true.
+PrefetchDatasetParams PrefetchDatasetParams7() {
+  auto tensor_slice_dataset_params = TensorSliceDatasetParams(
+      /*components=*/{CreateTensor<int64_t>(TensorShape{10, 1},
+                                            {0, 1, 2, 3, 4, 5, 6, 7, 8, 9})},
+      /*node_name=*/"tensor_slice");
+  return PrefetchDatasetParams(
+      /*input_dataset_params=*/tensor_slice_dataset_params,
+      /*buffer_size=*/5,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({1})},
+      /*slack_period=*/0,
+      /*legacy_autotune=*/true,
+      /*buffer_size_min=*/0,
+      /*node_name=*/kNodeName,
+      /*use_pinned_memory=*/true);
+}
+
 PrefetchDatasetParams InvalidBufferSizePrefetchDatasetParams() {
   auto tensor_slice_dataset_params = TensorSliceDatasetParams(
       /*components=*/{CreateTensor<int64_t>(TensorShape{10, 1},
@@ -221,6 +243,11 @@ std::vector<GetNextTestCase<PrefetchDatasetParams>> GetNextTestCases() {
       {/*dataset_params=*/
        PrefetchDatasetParams6(),
        /*expected_outputs=*/
+       CreateTensors<int64_t>(
+           TensorShape{1}, {{0}, {1}, {2}, {3}, {4}, {5}, {6}, {7}, {8}, {9}})},
+      {/*dataset_params=*/
+       PrefetchDatasetParams7(),
+       /*expected_outputs=*/
        CreateTensors<int64_t>(
            TensorShape{1},
            {{0}, {1}, {2}, {3}, {4}, {5}, {6}, {7}, {8}, {9}})}};
@@ -318,6 +345,12 @@ IteratorSaveAndRestoreTestCases() {
        PrefetchDatasetParams5(),
        /*breakpoints=*/{0, 4, 11},
        /*expected_outputs=*/
+       CreateTensors<int64_t>(
+           TensorShape{1}, {{0}, {1}, {2}, {3}, {4}, {5}, {6}, {7}, {8}, {9}})},
+      {/*dataset_params=*/
+       PrefetchDatasetParams7(),
+       /*breakpoints=*/{0, 4, 11},
+       /*expected_outputs=*/
        CreateTensors<int64_t>(
            TensorShape{1},
            {{0}, {1}, {2}, {3}, {4}, {5}, {6}, {7}, {8}, {9}})}};
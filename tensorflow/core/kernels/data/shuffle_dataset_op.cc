@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/shuffle_dataset_op.h"
 
+#include <array>
 #include <cstdint>
 #include <deque>
 #include <string>
@@ -29,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/data/random_seed_ops.h"
+#include "tensorflow/core/kernels/random_index_shuffle.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/random/philox_random.h"
 #include "tensorflow/core/lib/random/random.h"
@@ -141,16 +143,18 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
   Status Get(OpKernelContext* ctx, int64 index,
              std::vector<Tensor>* out_tensors) const override {
     TF_RETURN_IF_ERROR(CheckRandomAccessCompatible(index));
-    {
-      mutex_lock l(mu_);
-      if (shuffled_indices_.empty()) {
-        InitializeRandomAccessIndices();
-      }
-    }
-    int64 shuffled_index;
-    {
-      tf_shared_lock l(mu_);
-      shuffled_index = shuffled_indices_[index];
+    // Each epoch of the input is permuted with its own key. The permutation
+    // is computed on demand, so random access uses constant memory however
+    // large the input is.
+    CardinalityOptions options;
+    options.set_compute_level(CardinalityOptions::CARDINALITY_COMPUTE_MODERATE);
+    const int64_t input_cardinality = input_->Cardinality(options);
+    const int64_t epoch = index / input_cardinality;
+    const int64_t epoch_index = index % input_cardinality;
+    int64_t shuffled_index = 0;
+    if (input_cardinality > 1) {
+      shuffled_index = random::index_shuffle(
+          epoch_index, RandomAccessKey(epoch), input_cardinality - 1);
     }
     TF_RETURN_IF_ERROR(input_->Get(ctx, shuffled_index, out_tensors));
     return Status::OK();
@@ -170,22 +174,14 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
         seed_generator_.get());
   }
 
-  void InitializeRandomAccessIndices() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-    const int64 cardinality = Cardinality();
-    shuffled_indices_ = std::vector<std::int64_t>(cardinality);
-    std::iota(shuffled_indices_.begin(), shuffled_indices_.end(), 0);
-    int64_t shuffled_index = 0;
-    random::PhiloxRandom parent_generator =
-        random::PhiloxRandom(seed_generator_->seed(), seed_generator_->seed2());
-    random::SingleSampleAdapter<random::PhiloxRandom> generator =
-        random::SingleSampleAdapter<random::PhiloxRandom>(&parent_generator);
-
-    while (shuffled_index < cardinality) {
-      int64_t offset = generator() % (cardinality - shuffled_index);
-      std::swap(shuffled_indices_[shuffled_index + offset],
-                shuffled_indices_[shuffled_index]);
-      shuffled_index += 1;
-    }
+  // Returns the key of the permutation of the `epoch`-th epoch of the input
+  // used by random access.
+  std::array<uint32_t, 3> RandomAccessKey(int64_t epoch) const {
+    const uint64_t seed = seed_generator_->seed();
+    const uint64_t seed2 = seed_generator_->seed2();
+    return {static_cast<uint32_t>(seed ^ (seed >> 32)),
+            static_cast<uint32_t>(seed2 ^ (seed2 >> 32)),
+            static_cast<uint32_t>(epoch)};
   }
 
  protected:
@@ -508,8 +504,6 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
   // responsible for repeating as well.
   const int64_t count_;
   const TraceMeMetadata traceme_metadata_;
-  mutable mutex mu_;
-  mutable std::vector<std::int64_t> shuffled_indices_ TF_GUARDED_BY(mu_);
 };  // ShuffleDatasetBase
 
 // This version of memory dataset has an exclusive ownership of the seed
@@ -14,17 +14,28 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/tf_record_dataset_op.h"
 
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <vector>
+
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/utils.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/hash/crc32c.h"
 #include "tensorflow/core/lib/io/buffered_inputstream.h"
 #include "tensorflow/core/lib/io/inputbuffer.h"
+#include "tensorflow/core/lib/io/inputstream_interface.h"
 #include "tensorflow/core/lib/io/random_inputstream.h"
 #include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/lib/io/snappy/snappy_inputstream.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
+#include "tensorflow/core/platform/notification.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 namespace data {
@@ -36,13 +47,29 @@ namespace data {
 /* static */ constexpr const char* const TFRecordDatasetOp::kFileNames;
 /* static */ constexpr const char* const TFRecordDatasetOp::kCompressionType;
 /* static */ constexpr const char* const TFRecordDatasetOp::kBufferSize;
+/* static */ constexpr const char* const TFRecordDatasetOp::kReadaheadBlocks;
+/* static */ constexpr const char* const TFRecordDatasetOp::kDeterministic;
 
 constexpr char kCurrentFileIndex[] = "current_file_index";
 constexpr char kOffset[] = "offset";
+constexpr char kChunk[] = "chunk";
+constexpr char kNumChunks[] = "num_chunks";
+constexpr char kFileIndex[] = "file_index";
+constexpr char kNumRecords[] = "num_records";
+constexpr char kRecord[] = "record";
+constexpr char kErrorCode[] = "error_code";
+constexpr char kErrorMessage[] = "error_message";
 constexpr char kGcsFsPrefix[] = "gs://";
 constexpr char kS3FsPrefix[] = "s3://";
 constexpr int64_t kCloudTpuBlockSize = 127LL << 20;  // 127MB.
 constexpr int64_t kS3BlockSize = kCloudTpuBlockSize;
+// The size of the reads issued when `readahead_blocks` is positive. The
+// `buffer_size` is used instead when it is set, up to
+// `kMaxReadaheadBlockSize`, since up to `readahead_blocks` blocks are buffered.
+constexpr int64_t kDefaultReadaheadBlockSize = 256 << 10;  // 256KB.
+constexpr int64_t kMaxReadaheadBlockSize = 16 << 20;       // 16MB.
+// Each block is read by its own thread, so `readahead_blocks` is bounded.
+constexpr int64_t kMaxReadaheadBlocks = 256;
 
 bool is_cloud_tpu_gcs_fs() {
 #if (defined(PLATFORM_CLOUD_TPU) && defined(TPU_GCS_FS)) || \
@@ -52,22 +79,177 @@ bool is_cloud_tpu_gcs_fs() {
   return false;
 }
 
+namespace {
+
+// An input stream over a `RandomAccessFile` that keeps reads of the
+// `num_blocks` blocks of `block_size` bytes following the current position in
+// flight on `thread_pool`, so that the latency of the reads is overlapped with
+// the consumption of the stream.
+//
+// Not thread-safe.
+class ReadaheadInputStream : public io::InputStreamInterface {
+ public:
+  // Does not take ownership of `file` or `thread_pool`, which must outlive the
+  // stream.
+  ReadaheadInputStream(RandomAccessFile* file, int64_t block_size,
+                       int64_t num_blocks, thread::ThreadPool* thread_pool)
+      : file_(file),
+        block_size_(block_size),
+        num_blocks_(num_blocks),
+        thread_pool_(thread_pool) {}
+
+  ~ReadaheadInputStream() override { DiscardBlocks(); }
+
+  Status ReadNBytes(int64_t bytes_to_read, tstring* result) override {
+    if (bytes_to_read < 0) {
+      return errors::InvalidArgument("Can't read a negative number of bytes: ",
+                                     bytes_to_read);
+    }
+    result->clear();
+    result->reserve(bytes_to_read);
+    return Consume(bytes_to_read, result);
+  }
+
+  Status SkipNBytes(int64_t bytes_to_skip) override {
+    if (bytes_to_skip < 0) {
+      return errors::InvalidArgument("Can't skip a negative number of bytes: ",
+                                     bytes_to_skip);
+    }
+    return Consume(bytes_to_skip, /*result=*/nullptr);
+  }
+
+  int64_t Tell() const override { return position_; }
+
+  Status Reset() override {
+    DiscardBlocks();
+    position_ = 0;
+    return Status::OK();
+  }
+
+ private:
+  struct Block {
+    int64_t offset;
+    Notification done;
+    Status status;
+    std::string data;
+  };
+
+  // Consumes `n` bytes, which are appended to `result` unless it is null.
+  Status Consume(int64_t n, tstring* result) {
+    while (n > 0) {
+      if (blocks_.empty()) {
+        if (end_of_file_) {
+          return errors::OutOfRange("reached end of file");
+        }
+        if (result == nullptr) {
+          // Skipping past the buffered blocks does not need any reads.
+          position_ += n;
+          return Status::OK();
+        }
+        ScheduleReads();
+      }
+      Block* block = blocks_.front().get();
+      block->done.WaitForNotification();
+      TF_RETURN_IF_ERROR(block->status);
+      const int64_t start = position_ - block->offset;
+      const int64_t available =
+          static_cast<int64_t>(block->data.size()) - start;
+      if (available <= 0) {
+        if (static_cast<int64_t>(block->data.size()) < block_size_) {
+          end_of_file_ = true;
+          return errors::OutOfRange("reached end of file");
+        }
+        blocks_.pop_front();
+        ScheduleReads();
+        continue;
+      }
+      const int64_t bytes = std::min(n, available);
+      if (result != nullptr) {
+        result->append(block->data.data() + start, bytes);
+      }
+      position_ += bytes;
+      n -= bytes;
+    }
+    return Status::OK();
+  }
+
+  // Schedules reads of the blocks following the last buffered block, or the
+  // current position if there is none, until `num_blocks_` are buffered.
+  void ScheduleReads() {
+    while (blocks_.size() < size_t(num_blocks_) && !end_of_file_) {
+      auto block = std::make_shared<Block>();
+      block->offset =
+          blocks_.empty() ? position_ : blocks_.back()->offset + block_size_;
+      blocks_.push_back(block);
+      RandomAccessFile* file = file_;
+      const int64_t block_size = block_size_;
+      thread_pool_->Schedule([file, block_size, block]() {
+        block->data.resize(block_size);
+        StringPiece data;
+        block->status =
+            file->Read(block->offset, block_size, &data, &block->data[0]);
+        if (data.data() != block->data.data()) {
+          memmove(&block->data[0], data.data(), data.size());
+        }
+        block->data.resize(data.size());
+        // A short block marks the end of the file.
+        if (errors::IsOutOfRange(block->status)) {
+          block->status = Status::OK();
+        }
+        block->done.Notify();
+      });
+    }
+  }
+
+  // Waits for the in-flight reads and discards all buffered blocks.
+  void DiscardBlocks() {
+    for (const auto& block : blocks_) {
+      block->done.WaitForNotification();
+    }
+    blocks_.clear();
+    end_of_file_ = false;
+  }
+
+  RandomAccessFile* const file_;  // Not owned.
+  const int64_t block_size_;
+  const int64_t num_blocks_;
+  thread::ThreadPool* const thread_pool_;  // Not owned.
+  int64_t position_ = 0;
+  bool end_of_file_ = false;
+  // The blocks at and after `position_`, in file order. The first block
+  // contains `position_`, unless it is the last block of the file.
+  std::deque<std::shared_ptr<Block>> blocks_;
+};
+
+}  // namespace
+
 class TFRecordDatasetOp::Dataset : public DatasetBase {
  public:
   explicit Dataset(OpKernelContext* ctx, std::vector<string> filenames,
-                   const string& compression_type, int64_t buffer_size)
+                   const string& compression_type, int64_t buffer_size,
+                   int64_t readahead_blocks,
+                   const DeterminismPolicy& deterministic)
       : DatasetBase(DatasetContext(ctx)),
         filenames_(std::move(filenames)),
         compression_type_(compression_type),
         options_(io::RecordReaderOptions::CreateRecordReaderOptions(
-            compression_type)) {
+            compression_type)),
+        readahead_blocks_(readahead_blocks),
+        deterministic_(deterministic) {
     if (buffer_size > 0) {
       options_.buffer_size = buffer_size;
     }
+    readahead_block_size_ =
+        buffer_size > 0 ? std::min(buffer_size, kMaxReadaheadBlockSize)
+                        : kDefaultReadaheadBlockSize;
   }
 
   std::unique_ptr<IteratorBase> MakeIteratorInternal(
       const string& prefix) const override {
+    if (readahead_blocks_ > 0) {
+      return absl::make_unique<ReadaheadIterator>(ReadaheadIterator::Params{
+          this, name_utils::IteratorPrefix(kDatasetType, prefix)});
+    }
     return absl::make_unique<Iterator>(Iterator::Params{
         this, name_utils::IteratorPrefix(kDatasetType, prefix)});
   }
@@ -103,8 +285,15 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     TF_RETURN_IF_ERROR(b->AddScalar(compression_type_, &compression_type));
     Node* buffer_size = nullptr;
     TF_RETURN_IF_ERROR(b->AddScalar(options_.buffer_size, &buffer_size));
-    TF_RETURN_IF_ERROR(b->AddDataset(
-        this, {filenames, compression_type, buffer_size}, output));
+    AttrValue readahead_blocks;
+    b->BuildAttrValue(readahead_blocks_, &readahead_blocks);
+    AttrValue deterministic;
+    b->BuildAttrValue(deterministic_.String(), &deterministic);
+    TF_RETURN_IF_ERROR(
+        b->AddDataset(this, {filenames, compression_type, buffer_size},
+                      {{kReadaheadBlocks, readahead_blocks},
+                       {kDeterministic, deterministic}},
+                      output));
     return Status::OK();
   }
 
@@ -270,13 +459,478 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     std::unique_ptr<io::SequentialRecordReader> reader_ TF_GUARDED_BY(mu_);
   };
 
+  // Reads the files with up to `readahead_blocks_` reads of
+  // `readahead_block_size_` bytes in flight ahead of the record being read.
+  //
+  // A background thread frames the records and groups them into chunks of
+  // about `readahead_block_size_` bytes, whose checksums are then verified on
+  // the thread pool that also issues the reads. Up to `readahead_blocks_`
+  // chunks are buffered. When the iterator is deterministic, records are
+  // produced in file order; otherwise, the records of a chunk whose checksums
+  // have been verified are produced before those of earlier chunks that are
+  // still being verified.
+  class ReadaheadIterator : public DatasetIterator<Dataset> {
+   public:
+    explicit ReadaheadIterator(const Params& params)
+        : DatasetIterator<Dataset>(params),
+          deterministic_(params.dataset->deterministic_.IsDeterministic() ||
+                         params.dataset->deterministic_.IsDefault()) {}
+
+    ~ReadaheadIterator() override { StopFramingThread(); }
+
+    Status Initialize(IteratorContext* ctx) override {
+      thread_pool_ =
+          ctx->CreateThreadPool("tf_record_readahead",
+                                static_cast<int>(dataset()->readahead_blocks_));
+      return Status::OK();
+    }
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      mutex_lock l(mu_);
+      EnsureFramingThreadStartedLocked(ctx);
+      while (true) {
+        std::shared_ptr<Chunk> chunk = NextChunkLocked();
+        if (chunk && chunk->next_record < chunk->records.size()) {
+          out_tensors->emplace_back(ctx->allocator({}), DT_STRING,
+                                    TensorShape({}));
+          tstring& record = out_tensors->back().scalar<tstring>()();
+          record = std::move(chunk->records[chunk->next_record++]);
+          static monitoring::CounterCell* bytes_counter =
+              metrics::GetTFDataBytesReadCounter(kDatasetType);
+          bytes_counter->IncrementBy(record.size());
+          if (chunk->next_record == chunk->records.size() &&
+              chunk->status.ok()) {
+            RemoveChunkLocked(chunk);
+          }
+          *end_of_sequence = false;
+          return Status::OK();
+        }
+        if (chunk) {
+          RemoveChunkLocked(chunk);
+          // As in the sequential iterator, an error skips the rest of the
+          // file, so that the dataset works with `ignore_errors`.
+          DropFileLocked(chunk->file_index);
+          return chunk->status;
+        }
+        if (chunks_.empty() && end_of_input_) {
+          *end_of_sequence = true;
+          return Status::OK();
+        }
+        cond_var_.wait(l);
+      }
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeSourceNode(std::move(args));
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      mutex_lock l(mu_);
+      // Wait for the framing thread and the verifications to settle, so that
+      // the buffered chunks and the position of the framing thread agree.
+      while (framing_ || num_pending_verifications_ > 0) {
+        cond_var_.wait(l);
+      }
+      // The rest of a file being skipped is not read after restoring.
+      const size_t file_index = skip_file_ ? file_index_ + 1 : file_index_;
+      const int64_t offset = skip_file_ ? 0 : offset_;
+      TF_RETURN_IF_ERROR(
+          writer->WriteScalar(full_name(kCurrentFileIndex), file_index));
+      if (offset > 0) {
+        TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kOffset), offset));
+      }
+      TF_RETURN_IF_ERROR(writer->WriteScalar(
+          full_name(kNumChunks), static_cast<int64_t>(chunks_.size())));
+      for (size_t i = 0; i < chunks_.size(); ++i) {
+        const Chunk& chunk = *chunks_[i];
+        const std::string key = absl::StrCat(prefix(), "::", kChunk, "::", i);
+        TF_RETURN_IF_ERROR(writer->WriteScalar(
+            key, kFileIndex, static_cast<int64_t>(chunk.file_index)));
+        const int64_t num_records = chunk.records.size() - chunk.next_record;
+        TF_RETURN_IF_ERROR(writer->WriteScalar(key, kNumRecords, num_records));
+        for (int64_t j = 0; j < num_records; ++j) {
+          TF_RETURN_IF_ERROR(
+              writer->WriteScalar(key, absl::StrCat(kRecord, "::", j),
+                                  chunk.records[chunk.next_record + j]));
+        }
+        TF_RETURN_IF_ERROR(WriteStatusLocked(writer, key, chunk.status));
+      }
+      return Status::OK();
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      StopFramingThread();
+      mutex_lock l(mu_);
+      cancelled_ = false;
+      end_of_input_ = false;
+      skip_file_ = false;
+      chunks_.clear();
+      stream_.reset();
+      file_.reset();
+      int64_t file_index;
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(full_name(kCurrentFileIndex), &file_index));
+      file_index_ = size_t(file_index);
+      offset_ = 0;
+      if (reader->Contains(full_name(kOffset))) {
+        TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kOffset), &offset_));
+      }
+      // Checkpoints of the sequential iterator have no buffered chunks.
+      if (!reader->Contains(full_name(kNumChunks))) {
+        return Status::OK();
+      }
+      int64_t num_chunks;
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(full_name(kNumChunks), &num_chunks));
+      for (int64_t i = 0; i < num_chunks; ++i) {
+        auto chunk = std::make_shared<Chunk>();
+        const std::string key = absl::StrCat(prefix(), "::", kChunk, "::", i);
+        int64_t chunk_file_index;
+        TF_RETURN_IF_ERROR(
+            reader->ReadScalar(key, kFileIndex, &chunk_file_index));
+        chunk->file_index = size_t(chunk_file_index);
+        int64_t num_records;
+        TF_RETURN_IF_ERROR(reader->ReadScalar(key, kNumRecords, &num_records));
+        chunk->records.resize(num_records);
+        for (int64_t j = 0; j < num_records; ++j) {
+          TF_RETURN_IF_ERROR(reader->ReadScalar(
+              key, absl::StrCat(kRecord, "::", j), &chunk->records[j]));
+        }
+        TF_RETURN_IF_ERROR(ReadStatusLocked(reader, key, &chunk->status));
+        chunk->verified = true;
+        chunks_.push_back(std::move(chunk));
+      }
+      return Status::OK();
+    }
+
+   private:
+    // The records framed from a contiguous range of a file.
+    struct Chunk {
+      size_t file_index = 0;
+      // Until the chunk is verified, each record is followed by its masked
+      // checksum.
+      std::vector<tstring> records;
+      // The offset of each record in the file, for error messages.
+      std::vector<int64_t> offsets;
+      // The index of the next record to produce.
+      size_t next_record = 0;
+      // The error, if any, that ended the chunk after its records.
+      Status status;
+      bool verified = false;
+    };
+
+    // Returns the chunk to produce the next record of, or null if there is
+    // none yet.
+    std::shared_ptr<Chunk> NextChunkLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      for (const auto& chunk : chunks_) {
+        if (chunk->verified) {
+          return chunk;
+        }
+        if (deterministic_) {
+          break;
+        }
+      }
+      return nullptr;
+    }
+
+    void RemoveChunkLocked(const std::shared_ptr<Chunk>& chunk)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      chunks_.erase(std::find(chunks_.begin(), chunks_.end(), chunk));
+      cond_var_.notify_all();
+    }
+
+    // Discards the buffered chunks of the file at `file_index`, and makes the
+    // framing thread skip the rest of the file if it is still reading it.
+    void DropFileLocked(size_t file_index) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      chunks_.erase(std::remove_if(chunks_.begin(), chunks_.end(),
+                                   [file_index](const auto& chunk) {
+                                     return chunk->file_index == file_index;
+                                   }),
+                    chunks_.end());
+      if (file_index_ == file_index) {
+        skip_file_ = true;
+      }
+      cond_var_.notify_all();
+    }
+
+    void EnsureFramingThreadStartedLocked(IteratorContext* ctx)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (!framing_thread_) {
+        auto ctx_copy = std::make_shared<IteratorContext>(*ctx);
+        framing_thread_ =
+            ctx->StartThread("tf_record_framing",
+                             [this, ctx_copy]() { FramingThread(ctx_copy); });
+      }
+    }
+
+    // Stops the framing thread and waits for the pending verifications.
+    void StopFramingThread() TF_LOCKS_EXCLUDED(mu_) {
+      {
+        mutex_lock l(mu_);
+        cancelled_ = true;
+        cond_var_.notify_all();
+      }
+      framing_thread_.reset();
+      mutex_lock l(mu_);
+      while (num_pending_verifications_ > 0) {
+        cond_var_.wait(l);
+      }
+    }
+
+    void FramingThread(const std::shared_ptr<IteratorContext>& ctx) {
+      while (true) {
+        size_t file_index;
+        int64_t offset;
+        {
+          mutex_lock l(mu_);
+          while (!cancelled_ &&
+                 chunks_.size() >= size_t(dataset()->readahead_blocks_)) {
+            cond_var_.wait(l);
+          }
+          if (cancelled_) {
+            return;
+          }
+          if (skip_file_) {
+            NextFileLocked();
+          }
+          if (file_index_ >= dataset()->filenames_.size()) {
+            end_of_input_ = true;
+            cond_var_.notify_all();
+            return;
+          }
+          file_index = file_index_;
+          offset = offset_;
+          framing_ = true;
+        }
+        auto chunk = std::make_shared<Chunk>();
+        chunk->file_index = file_index;
+        bool end_of_file = false;
+        Status s = SetupStream(ctx->env(), file_index, offset);
+        if (s.ok()) {
+          s = ReadChunk(&offset, chunk.get(), &end_of_file);
+        }
+        mutex_lock l(mu_);
+        framing_ = false;
+        cond_var_.notify_all();
+        if (cancelled_) {
+          return;
+        }
+        if (skip_file_) {
+          continue;
+        }
+        if (!s.ok() || end_of_file) {
+          NextFileLocked();
+        } else {
+          offset_ = offset;
+        }
+        chunk->status = s;
+        if (chunk->records.empty()) {
+          if (!s.ok()) {
+            chunk->verified = true;
+            chunks_.push_back(std::move(chunk));
+          }
+          continue;
+        }
+        chunks_.push_back(chunk);
+        ++num_pending_verifications_;
+        thread_pool_->Schedule([this, chunk]() {
+          Status s = VerifyChunk(chunk.get());
+          mutex_lock l(mu_);
+          // A corrupted record also ends the chunk, before any later error.
+          if (!s.ok()) {
+            chunk->status = s;
+          }
+          chunk->verified = true;
+          --num_pending_verifications_;
+          cond_var_.notify_all();
+        });
+      }
+    }
+
+    // Moves the framing thread on to the next file.
+    void NextFileLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      stream_.reset();
+      file_.reset();
+      ++file_index_;
+      offset_ = 0;
+      skip_file_ = false;
+    }
+
+    // Opens the stream over the file at `file_index` positioned at `offset`,
+    // unless it is already open. Only called by the framing thread.
+    Status SetupStream(Env* env, size_t file_index, int64_t offset) {
+      if (stream_) {
+        return Status::OK();
+      }
+      TF_RETURN_IF_ERROR(env->NewRandomAccessFile(
+          TranslateFileName(dataset()->filenames_[file_index]), &file_));
+      stream_ = absl::make_unique<ReadaheadInputStream>(
+          file_.get(), dataset()->readahead_block_size_,
+          dataset()->readahead_blocks_, thread_pool_.get());
+      const io::RecordReaderOptions& options = dataset()->options_;
+#if defined(IS_SLIM_BUILD)
+      if (options.compression_type != io::RecordReaderOptions::NONE) {
+        return errors::Unimplemented(
+            "Compression is unsupported on mobile platforms.");
+      }
+#else
+      // Decompression is sequential, but overlaps with the reads.
+      if (options.compression_type ==
+          io::RecordReaderOptions::ZLIB_COMPRESSION) {
+        stream_ = absl::make_unique<io::ZlibInputStream>(
+            stream_.release(), options.zlib_options.input_buffer_size,
+            options.zlib_options.output_buffer_size, options.zlib_options,
+            /*owns_input_stream=*/true);
+      } else if (options.compression_type ==
+                 io::RecordReaderOptions::SNAPPY_COMPRESSION) {
+        stream_ = absl::make_unique<io::SnappyInputStream>(
+            stream_.release(), options.snappy_options.output_buffer_size,
+            /*owns_input_stream=*/true);
+      }
+#endif  // IS_SLIM_BUILD
+      // Offsets are positions in the uncompressed stream.
+      if (offset > 0) {
+        TF_RETURN_IF_ERROR(stream_->SkipNBytes(offset));
+      }
+      return Status::OK();
+    }
+
+    // Frames records from `stream_`, starting at `*offset`, into `chunk` until
+    // the chunk holds `readahead_block_size_` bytes or the end of the file is
+    // reached. Only the checksums of the record headers are verified. Only
+    // called by the framing thread.
+    Status ReadChunk(int64_t* offset, Chunk* chunk, bool* end_of_file) {
+      int64_t chunk_size = 0;
+      while (chunk_size < dataset()->readahead_block_size_) {
+        tstring header;
+        Status s = stream_->ReadNBytes(io::RecordReader::kHeaderSize, &header);
+        if (errors::IsOutOfRange(s)) {
+          *end_of_file = true;
+          return Status::OK();
+        }
+        TF_RETURN_IF_ERROR(s);
+        const uint32 masked_crc =
+            core::DecodeFixed32(header.data() + sizeof(uint64));
+        if (crc32c::Unmask(masked_crc) !=
+            crc32c::Value(header.data(), sizeof(uint64))) {
+          return errors::DataLoss("corrupted record at ", *offset);
+        }
+        const uint64 length = core::DecodeFixed64(header.data());
+        if (length >= SIZE_MAX - io::RecordReader::kFooterSize) {
+          return errors::DataLoss("record size too large");
+        }
+        tstring record;
+        s = stream_->ReadNBytes(length + io::RecordReader::kFooterSize,
+                                &record);
+        if (errors::IsOutOfRange(s)) {
+          return errors::DataLoss("truncated record at ", *offset,
+                                  "' failed with ", s.error_message());
+        }
+        TF_RETURN_IF_ERROR(s);
+        chunk->records.push_back(std::move(record));
+        chunk->offsets.push_back(*offset);
+        const int64_t record_size = io::RecordReader::kHeaderSize + length +
+                                    io::RecordReader::kFooterSize;
+        *offset += record_size;
+        chunk_size += record_size;
+      }
+      return Status::OK();
+    }
+
+    // Verifies the checksums of the records of `chunk` and strips them. On a
+    // mismatch, the records from the corrupted one on are discarded.
+    static Status VerifyChunk(Chunk* chunk) {
+      for (size_t i = 0; i < chunk->records.size(); ++i) {
+        tstring& record = chunk->records[i];
+        const size_t length = record.size() - io::RecordReader::kFooterSize;
+        const uint32 masked_crc = core::DecodeFixed32(record.data() + length);
+        if (crc32c::Unmask(masked_crc) !=
+            crc32c::Value(record.data(), length)) {
+          const int64_t offset = chunk->offsets[i];
+          chunk->records.resize(i);
+          return errors::DataLoss("corrupted record at ", offset);
+        }
+        record.resize(length);
+      }
+      return Status::OK();
+    }
+
+    Status WriteStatusLocked(IteratorStateWriter* writer,
+                             const std::string& key, const Status& status)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      TF_RETURN_IF_ERROR(writer->WriteScalar(
+          key, kErrorCode, static_cast<int64_t>(status.code())));
+      if (!status.ok()) {
+        TF_RETURN_IF_ERROR(
+            writer->WriteScalar(key, kErrorMessage, status.error_message()));
+      }
+      return Status::OK();
+    }
+
+    Status ReadStatusLocked(IteratorStateReader* reader, const std::string& key,
+                            Status* status) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      int64_t code_int;
+      TF_RETURN_IF_ERROR(reader->ReadScalar(key, kErrorCode, &code_int));
+      error::Code code = static_cast<error::Code>(code_int);
+      if (code != error::Code::OK) {
+        tstring error_message;
+        TF_RETURN_IF_ERROR(
+            reader->ReadScalar(key, kErrorMessage, &error_message));
+        *status = Status(code, error_message);
+      } else {
+        *status = Status::OK();
+      }
+      return Status::OK();
+    }
+
+    const bool deterministic_;
+
+    mutex mu_;
+    condition_variable cond_var_;
+    std::deque<std::shared_ptr<Chunk>> chunks_ TF_GUARDED_BY(mu_);
+    // The position of the framing thread.
+    size_t file_index_ TF_GUARDED_BY(mu_) = 0;
+    int64_t offset_ TF_GUARDED_BY(mu_) = 0;
+    // Whether the framing thread should skip the rest of the current file.
+    bool skip_file_ TF_GUARDED_BY(mu_) = false;
+    // Whether the framing thread is reading a chunk.
+    bool framing_ TF_GUARDED_BY(mu_) = false;
+    int64_t num_pending_verifications_ TF_GUARDED_BY(mu_) = 0;
+    bool end_of_input_ TF_GUARDED_BY(mu_) = false;
+    bool cancelled_ TF_GUARDED_BY(mu_) = false;
+
+    // Issues the reads and verifies the chunks. Destroyed after `stream_`,
+    // which waits for its reads.
+    std::unique_ptr<thread::ThreadPool> thread_pool_;
+    // Only used by the framing thread, or while it is not running. `stream_`
+    // borrows `file_`, so it must be destroyed first.
+    std::unique_ptr<RandomAccessFile> file_;
+    std::unique_ptr<io::InputStreamInterface> stream_;
+    std::unique_ptr<Thread> framing_thread_;
+  };
+
   const std::vector<string> filenames_;
   const tstring compression_type_;
   io::RecordReaderOptions options_;
+  const int64_t readahead_blocks_;
+  const DeterminismPolicy deterministic_;
+  int64_t readahead_block_size_;
 };
 
 TFRecordDatasetOp::TFRecordDatasetOp(OpKernelConstruction* ctx)
-    : DatasetOpKernel(ctx) {}
+    : DatasetOpKernel(ctx) {
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kReadaheadBlocks, &readahead_blocks_));
+  std::string deterministic;
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kDeterministic, &deterministic));
+  OP_REQUIRES_OK(ctx,
+                 DeterminismPolicy::FromString(deterministic, &deterministic_));
+}
 
 void TFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
                                     DatasetBase** output) {
@@ -309,6 +963,11 @@ void TFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
               errors::InvalidArgument(
                   "`buffer_size` must be >= 0 (0 == no buffering)"));
 
+  OP_REQUIRES(ctx, readahead_blocks_ <= kMaxReadaheadBlocks,
+              errors::InvalidArgument("`readahead_blocks` must be <= ",
+                                      kMaxReadaheadBlocks, ", but got ",
+                                      readahead_blocks_));
+
   if (is_gcs_fs && is_cloud_tpu_gcs_fs() && buffer_size < kCloudTpuBlockSize) {
     VLOG(2) << "User buffer size is too small for reading Cloud TPU "
             << "TFRecords stored in GCS. Overriding " << buffer_size
@@ -324,8 +983,8 @@ void TFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
     buffer_size = kS3BlockSize;
   }
 
-  *output =
-      new Dataset(ctx, std::move(filenames), compression_type, buffer_size);
+  *output = new Dataset(ctx, std::move(filenames), compression_type,
+                        buffer_size, readahead_blocks_, deterministic_);
 }
 
 namespace {
@@ -23,12 +23,16 @@ class TFRecordDatasetParams : public DatasetParams {
  public:
   TFRecordDatasetParams(std::vector<tstring> filenames,
                         CompressionType compression_type, int64_t buffer_size,
-                        string node_name)
+                        string node_name, int64_t readahead_blocks = 0,
+                        const std::string& deterministic =
+                            DeterminismPolicy::kDeterministic)
       : DatasetParams({DT_STRING}, {PartialTensorShape({})},
                       std::move(node_name)),
         filenames_(std::move(filenames)),
         compression_type_(compression_type),
-        buffer_size_(buffer_size) {}
+        buffer_size_(buffer_size),
+        readahead_blocks_(readahead_blocks),
+        deterministic_(deterministic) {}
 
   std::vector<Tensor> GetInputTensors() const override {
     int num_files = filenames_.size();
@@ -50,6 +54,10 @@ class TFRecordDatasetParams : public DatasetParams {
 
   Status GetAttributes(AttributeVector* attr_vector) const override {
     attr_vector->clear();
+    attr_vector->emplace_back(TFRecordDatasetOp::kReadaheadBlocks,
+                              readahead_blocks_);
+    attr_vector->emplace_back(TFRecordDatasetOp::kDeterministic,
+                              deterministic_);
     attr_vector->emplace_back("metadata", "");
     return Status::OK();
   }
@@ -62,6 +70,8 @@ class TFRecordDatasetParams : public DatasetParams {
   std::vector<tstring> filenames_;
   CompressionType compression_type_;
   int64_t buffer_size_;
+  int64_t readahead_blocks_;
+  std::string deterministic_;
 };
 
 class TFRecordDatasetOpTest : public DatasetOpsTestBase {};
@@ -138,6 +148,66 @@ TFRecordDatasetParams TFRecordDatasetParams3() {
                                /*node_name=*/kNodeName);
 }
 
+// Test case 4: multiple text files with ZLIB compression, read ahead.
+TFRecordDatasetParams TFRecordDatasetParams4() {
+  std::vector<tstring> filenames = {
+      absl::StrCat(testing::TmpDir(), "/tf_record_readahead_ZLIB_1"),
+      absl::StrCat(testing::TmpDir(), "/tf_record_readahead_ZLIB_2")};
+  std::vector<std::vector<string>> contents = {{"1", "22", "333"},
+                                               {"a", "bb", "ccc"}};
+  CompressionType compression_type = CompressionType::ZLIB;
+  if (!CreateTestFiles(filenames, contents, compression_type).ok()) {
+    VLOG(WARNING) << "Failed to create the test files: "
+                  << absl::StrJoin(filenames, ", ");
+  }
+  return TFRecordDatasetParams(filenames,
+                               /*compression_type=*/compression_type,
+                               /*buffer_size=*/10,
+                               /*node_name=*/kNodeName,
+                               /*readahead_blocks=*/2);
+}
+
+// Test case 5: multiple text files without compression, read ahead.
+TFRecordDatasetParams TFRecordDatasetParams5() {
+  std::vector<tstring> filenames = {
+      absl::StrCat(testing::TmpDir(), "/tf_record_readahead_UNCOMPRESSED_1"),
+      absl::StrCat(testing::TmpDir(), "/tf_record_readahead_UNCOMPRESSED_2")};
+  std::vector<std::vector<string>> contents = {{"1", "22", "333"},
+                                               {"a", "bb", "ccc"}};
+  CompressionType compression_type = CompressionType::UNCOMPRESSED;
+  if (!CreateTestFiles(filenames, contents, compression_type).ok()) {
+    VLOG(WARNING) << "Failed to create the test files: "
+                  << absl::StrJoin(filenames, ", ");
+  }
+  return TFRecordDatasetParams(filenames,
+                               /*compression_type=*/compression_type,
+                               /*buffer_size=*/10,
+                               /*node_name=*/kNodeName,
+                               /*readahead_blocks=*/3);
+}
+
+// Test case 6: multiple text files without compression, read ahead without
+// preserving the order of the records.
+TFRecordDatasetParams TFRecordDatasetParams6() {
+  std::vector<tstring> filenames = {
+      absl::StrCat(testing::TmpDir(), "/tf_record_nondeterministic_1"),
+      absl::StrCat(testing::TmpDir(), "/tf_record_nondeterministic_2")};
+  std::vector<std::vector<string>> contents = {{"1", "22", "333"},
+                                               {"a", "bb", "ccc"}};
+  CompressionType compression_type = CompressionType::UNCOMPRESSED;
+  if (!CreateTestFiles(filenames, contents, compression_type).ok()) {
+    VLOG(WARNING) << "Failed to create the test files: "
+                  << absl::StrJoin(filenames, ", ");
+  }
+  return TFRecordDatasetParams(filenames,
+                               /*compression_type=*/compression_type,
+                               /*buffer_size=*/10,
+                               /*node_name=*/kNodeName,
+                               /*readahead_blocks=*/4,
+                               /*deterministic=*/
+                               DeterminismPolicy::kNondeterministic);
+}
+
 std::vector<GetNextTestCase<TFRecordDatasetParams>> GetNextTestCases() {
   return {
       {/*dataset_params=*/TFRecordDatasetParams1(),
@@ -149,7 +219,17 @@ std::vector<GetNextTestCase<TFRecordDatasetParams>> GetNextTestCases() {
            TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})},
       {/*dataset_params=*/TFRecordDatasetParams3(),
        CreateTensors<tstring>(
-           TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})}};
+           TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})},
+      {/*dataset_params=*/TFRecordDatasetParams4(),
+       CreateTensors<tstring>(
+           TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})},
+      {/*dataset_params=*/TFRecordDatasetParams5(),
+       CreateTensors<tstring>(
+           TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})},
+      {/*dataset_params=*/TFRecordDatasetParams6(),
+       CreateTensors<tstring>(
+           TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}}),
+       /*compare_order=*/false}};
 }
 
 ITERATOR_GET_NEXT_TEST_P(TFRecordDatasetOpTest, TFRecordDatasetParams,
@@ -187,6 +267,17 @@ std::vector<SkipTestCase<TFRecordDatasetParams>> SkipTestCases() {
            /*expected_outputs=*/
            CreateTensors<tstring>(TensorShape({}), {{"bb"}})},
           {/*dataset_params=*/TFRecordDatasetParams3(),
+           /*num_to_skip*/ 7, /*expected_num_skipped*/ 6},
+
+          {/*dataset_params=*/TFRecordDatasetParams4(),
+           /*num_to_skip*/ 4, /*expected_num_skipped*/ 4, /*get_next*/ true,
+           /*expected_outputs=*/
+           CreateTensors<tstring>(TensorShape({}), {{"bb"}})},
+          {/*dataset_params=*/TFRecordDatasetParams5(),
+           /*num_to_skip*/ 4, /*expected_num_skipped*/ 4, /*get_next*/ true,
+           /*expected_outputs=*/
+           CreateTensors<tstring>(TensorShape({}), {{"bb"}})},
+          {/*dataset_params=*/TFRecordDatasetParams5(),
            /*num_to_skip*/ 7, /*expected_num_skipped*/ 6}};
 }
 
@@ -258,12 +349,74 @@ IteratorSaveAndRestoreTestCases() {
       {/*dataset_params=*/TFRecordDatasetParams3(),
        /*breakpoints=*/{0, 2, 7},
        CreateTensors<tstring>(
-           TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})}};
+           TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})},
+      {/*dataset_params=*/TFRecordDatasetParams4(),
+       /*breakpoints=*/{0, 2, 7},
+       CreateTensors<tstring>(
+           TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})},
+      {/*dataset_params=*/TFRecordDatasetParams5(),
+       /*breakpoints=*/{0, 2, 7},
+       CreateTensors<tstring>(
+           TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})},
+      {/*dataset_params=*/TFRecordDatasetParams6(),
+       /*breakpoints=*/{0, 2, 7},
+       CreateTensors<tstring>(
+           TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}}),
+       /*compare_order=*/false}};
 }
 
 ITERATOR_SAVE_AND_RESTORE_TEST_P(TFRecordDatasetOpTest, TFRecordDatasetParams,
                                  IteratorSaveAndRestoreTestCases())
 
+TEST_F(TFRecordDatasetOpTest, ReadaheadSkipsRestOfCorruptedFile) {
+  std::vector<tstring> filenames = {
+      absl::StrCat(testing::TmpDir(), "/tf_record_readahead_corrupted_1"),
+      absl::StrCat(testing::TmpDir(), "/tf_record_readahead_corrupted_2")};
+  TF_ASSERT_OK(CreateTestFiles(filenames, {{"1", "22", "333"}, {"a"}},
+                               CompressionType::UNCOMPRESSED));
+  // Corrupt the data of the second record, which follows the first record
+  // (16 bytes of framing and 1 byte of data) and its own 12-byte header.
+  std::string contents;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), filenames[0], &contents));
+  contents[17 + 12] ^= 1;
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), filenames[0], contents));
+
+  auto dataset_params = TFRecordDatasetParams(
+      filenames, CompressionType::UNCOMPRESSED, /*buffer_size=*/10,
+      /*node_name=*/kNodeName, /*readahead_blocks=*/2);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  std::vector<Tensor> out_tensors;
+  bool end_of_sequence = false;
+  TF_ASSERT_OK(iterator_->GetNext(iterator_ctx_.get(), &out_tensors,
+                                  &end_of_sequence));
+  TF_EXPECT_OK(ExpectEqual(out_tensors[0],
+                           CreateTensor<tstring>(TensorShape({}), {"1"})));
+  out_tensors.clear();
+  Status s = iterator_->GetNext(iterator_ctx_.get(), &out_tensors,
+                                &end_of_sequence);
+  EXPECT_TRUE(errors::IsDataLoss(s)) << s;
+  TF_ASSERT_OK(iterator_->GetNext(iterator_ctx_.get(), &out_tensors,
+                                  &end_of_sequence));
+  TF_EXPECT_OK(ExpectEqual(out_tensors[0],
+                           CreateTensor<tstring>(TensorShape({}), {"a"})));
+  out_tensors.clear();
+  TF_ASSERT_OK(iterator_->GetNext(iterator_ctx_.get(), &out_tensors,
+                                  &end_of_sequence));
+  EXPECT_TRUE(end_of_sequence);
+}
+
+TEST_F(TFRecordDatasetOpTest, InvalidReadaheadBlocks) {
+  std::vector<tstring> filenames = {
+      absl::StrCat(testing::TmpDir(), "/tf_record_readahead_invalid")};
+  TF_ASSERT_OK(
+      CreateTestFiles(filenames, {{"1"}}, CompressionType::UNCOMPRESSED));
+  auto dataset_params = TFRecordDatasetParams(
+      filenames, CompressionType::UNCOMPRESSED, /*buffer_size=*/10,
+      /*node_name=*/kNodeName, /*readahead_blocks=*/1 << 20);
+  EXPECT_EQ(Initialize(dataset_params).code(),
+            tensorflow::error::INVALID_ARGUMENT);
+}
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
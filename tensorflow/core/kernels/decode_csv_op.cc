@@ -14,19 +14,25 @@ limitations under the License.
 ==============================================================================*/
 
 // See docs in ../ops/parsing_ops.cc.
+#include <algorithm>
 #include <vector>
+
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/byte_scan.h"
 #include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
 class DecodeCSVOp : public OpKernel {
  public:
-  explicit DecodeCSVOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
+  explicit DecodeCSVOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx), unquoted_stops_("") {
     string delim;
 
     OP_REQUIRES_OK(ctx, ctx->GetAttr("OUT_TYPE", &out_type_));
@@ -51,6 +57,12 @@ class DecodeCSVOp : public OpKernel {
                 errors::InvalidArgument("field_delim should be only 1 char"));
     delim_ = delim[0];
     OP_REQUIRES_OK(ctx, ctx->GetAttr("na_value", &na_value_));
+
+    // The bytes that end the body of an unquoted field.  Anything but the
+    // delimiter is an error.
+    string stops = {delim_, '\n', '\r'};
+    if (use_quote_delim_) stops += '"';
+    unquoted_stops_ = strings::ByteSet(stops);
   }
 
   void Compute(OpKernelContext* ctx) override {
@@ -76,144 +88,166 @@ class DecodeCSVOp : public OpKernel {
     OpOutputList output;
     OP_REQUIRES_OK(ctx, ctx->output_list("output", &output));
 
+    std::vector<Tensor*> outputs(out_type_.size());
     for (int i = 0; i < static_cast<int>(out_type_.size()); ++i) {
-      Tensor* out = nullptr;
-      OP_REQUIRES_OK(ctx, output.allocate(i, records->shape(), &out));
+      OP_REQUIRES_OK(ctx, output.allocate(i, records->shape(), &outputs[i]));
     }
 
-    for (int64_t i = 0; i < records_size; ++i) {
-      const StringPiece record(records_t(i));
-      std::vector<string> fields;
-      ExtractFields(ctx, record, &fields);
-      OP_REQUIRES(ctx, fields.size() == out_type_.size(),
-                  errors::InvalidArgument("Expect ", out_type_.size(),
-                                          " fields but have ", fields.size(),
-                                          " in record ", i));
-
-      // Check each field in the record
-      for (int f = 0; f < static_cast<int>(out_type_.size()); ++f) {
-        const DataType& dtype = out_type_[f];
-        switch (dtype) {
-          case DT_INT32: {
-            // If this field is empty or NA value, check if default is given:
-            // If yes, use default value; Otherwise report error.
-            if (fields[f].empty() || fields[f] == na_value_) {
-              OP_REQUIRES(ctx, record_defaults[f].NumElements() == 1,
-                          errors::InvalidArgument(
-                              "Field ", f,
-                              " is required but missing in record ", i, "!"));
-
-              output[f]->flat<int32>()(i) = record_defaults[f].flat<int32>()(0);
-            } else {
-              int32_t value;
-              OP_REQUIRES(ctx, strings::safe_strto32(fields[f], &value),
-                          errors::InvalidArgument(
-                              "Field ", f, " in record ", i,
-                              " is not a valid int32: ", fields[f]));
-              output[f]->flat<int32>()(i) = value;
-            }
-            break;
+    // Records are parsed independently, so they are sharded over the intra-op
+    // pool.  Each shard stops at its first bad record; the error reported is
+    // the one for the lowest record index, as a sequential parse would have
+    // found.
+    mutex mu;
+    int64_t first_error_record = records_size;
+    Status first_error;
+    auto work = [&](int64_t start, int64_t limit) {
+      for (int64_t i = start; i < limit; ++i) {
+        Status s = ParseRecord(i, records_t(i), record_defaults, outputs);
+        if (!s.ok()) {
+          mutex_lock l(mu);
+          if (i < first_error_record) {
+            first_error_record = i;
+            first_error = s;
           }
-          case DT_INT64: {
-            // If this field is empty or NA value, check if default is given:
-            // If yes, use default value; Otherwise report error.
-            if (fields[f].empty() || fields[f] == na_value_) {
-              OP_REQUIRES(ctx, record_defaults[f].NumElements() == 1,
-                          errors::InvalidArgument(
-                              "Field ", f,
-                              " is required but missing in record ", i, "!"));
-
-              output[f]->flat<int64_t>()(i) =
-                  record_defaults[f].flat<int64_t>()(0);
-            } else {
-              int64_t value;
-              OP_REQUIRES(ctx, strings::safe_strto64(fields[f], &value),
-                          errors::InvalidArgument(
-                              "Field ", f, " in record ", i,
-                              " is not a valid int64: ", fields[f]));
-              output[f]->flat<int64_t>()(i) = value;
+          return;
+        }
+      }
+    };
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *ctx->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, records_size,
+          kCostPerField * std::max<int64_t>(out_type_.size(), 1), work);
+    OP_REQUIRES_OK(ctx, first_error);
+  }
+
+ private:
+  // Rough cost, in cycles, of extracting and converting one field.
+  static constexpr int64_t kCostPerField = 200;
+
+  std::vector<DataType> out_type_;
+  std::vector<int64_t> select_cols_;
+  char delim_;
+  bool use_quote_delim_;
+  bool select_all_cols_;
+  string na_value_;
+  strings::ByteSet unquoted_stops_;
+
+  // Parses record `i` and writes its fields to element `i` of `outputs`.
+  Status ParseRecord(int64_t i, StringPiece record,
+                     const OpInputList& record_defaults,
+                     const std::vector<Tensor*>& outputs) const {
+    std::vector<string> fields;
+    TF_RETURN_IF_ERROR(ExtractFields(record, &fields));
+    if (fields.size() != out_type_.size()) {
+      return errors::InvalidArgument("Expect ", out_type_.size(),
+                                     " fields but have ", fields.size(),
+                                     " in record ", i);
+    }
+
+    // Check each field in the record
+    for (int f = 0; f < static_cast<int>(out_type_.size()); ++f) {
+      const DataType& dtype = out_type_[f];
+      // If this field is empty or NA value, check if default is given:
+      // If yes, use default value; Otherwise report error.
+      const bool use_default = fields[f].empty() || fields[f] == na_value_;
+      switch (dtype) {
+        case DT_INT32: {
+          if (use_default) {
+            TF_RETURN_IF_ERROR(CheckHasDefault(record_defaults, f, i));
+            outputs[f]->flat<int32>()(i) = record_defaults[f].flat<int32>()(0);
+          } else {
+            int32_t value;
+            if (!strings::safe_strto32(fields[f], &value)) {
+              return errors::InvalidArgument("Field ", f, " in record ", i,
+                                             " is not a valid int32: ",
+                                             fields[f]);
             }
-            break;
+            outputs[f]->flat<int32>()(i) = value;
           }
-          case DT_FLOAT: {
-            // If this field is empty or NA value, check if default is given:
-            // If yes, use default value; Otherwise report error.
-            if (fields[f].empty() || fields[f] == na_value_) {
-              OP_REQUIRES(ctx, record_defaults[f].NumElements() == 1,
-                          errors::InvalidArgument(
-                              "Field ", f,
-                              " is required but missing in record ", i, "!"));
-              output[f]->flat<float>()(i) = record_defaults[f].flat<float>()(0);
-            } else {
-              float value;
-              OP_REQUIRES(ctx, strings::safe_strtof(fields[f], &value),
-                          errors::InvalidArgument(
-                              "Field ", f, " in record ", i,
-                              " is not a valid float: ", fields[f]));
-              output[f]->flat<float>()(i) = value;
+          break;
+        }
+        case DT_INT64: {
+          if (use_default) {
+            TF_RETURN_IF_ERROR(CheckHasDefault(record_defaults, f, i));
+            outputs[f]->flat<int64_t>()(i) =
+                record_defaults[f].flat<int64_t>()(0);
+          } else {
+            int64_t value;
+            if (!strings::safe_strto64(fields[f], &value)) {
+              return errors::InvalidArgument("Field ", f, " in record ", i,
+                                             " is not a valid int64: ",
+                                             fields[f]);
             }
-            break;
+            outputs[f]->flat<int64_t>()(i) = value;
           }
-          case DT_DOUBLE: {
-            // If this field is empty or NA value, check if default is given:
-            // If yes, use default value; Otherwise report error.
-            if (fields[f].empty() || fields[f] == na_value_) {
-              OP_REQUIRES(ctx, record_defaults[f].NumElements() == 1,
-                          errors::InvalidArgument(
-                              "Field ", f,
-                              " is required but missing in record ", i, "!"));
-              output[f]->flat<double>()(i) =
-                  record_defaults[f].flat<double>()(0);
-            } else {
-              double value;
-              OP_REQUIRES(ctx, strings::safe_strtod(fields[f], &value),
-                          errors::InvalidArgument(
-                              "Field ", f, " in record ", i,
-                              " is not a valid double: ", fields[f]));
-              output[f]->flat<double>()(i) = value;
+          break;
+        }
+        case DT_FLOAT: {
+          if (use_default) {
+            TF_RETURN_IF_ERROR(CheckHasDefault(record_defaults, f, i));
+            outputs[f]->flat<float>()(i) = record_defaults[f].flat<float>()(0);
+          } else {
+            float value;
+            if (!strings::safe_strtof(fields[f], &value)) {
+              return errors::InvalidArgument("Field ", f, " in record ", i,
+                                             " is not a valid float: ",
+                                             fields[f]);
             }
-            break;
+            outputs[f]->flat<float>()(i) = value;
           }
-          case DT_STRING: {
-            // If this field is empty or NA value, check if default is given:
-            // If yes, use default value; Otherwise report error.
-            if (fields[f].empty() || fields[f] == na_value_) {
-              OP_REQUIRES(ctx, record_defaults[f].NumElements() == 1,
-                          errors::InvalidArgument(
-                              "Field ", f,
-                              " is required but missing in record ", i, "!"));
-              output[f]->flat<tstring>()(i) =
-                  record_defaults[f].flat<tstring>()(0);
-            } else {
-              output[f]->flat<tstring>()(i) = std::move(fields[f]);
+          break;
+        }
+        case DT_DOUBLE: {
+          if (use_default) {
+            TF_RETURN_IF_ERROR(CheckHasDefault(record_defaults, f, i));
+            outputs[f]->flat<double>()(i) =
+                record_defaults[f].flat<double>()(0);
+          } else {
+            double value;
+            if (!strings::safe_strtod(fields[f], &value)) {
+              return errors::InvalidArgument("Field ", f, " in record ", i,
+                                             " is not a valid double: ",
+                                             fields[f]);
             }
-            break;
+            outputs[f]->flat<double>()(i) = value;
+          }
+          break;
+        }
+        case DT_STRING: {
+          if (use_default) {
+            TF_RETURN_IF_ERROR(CheckHasDefault(record_defaults, f, i));
+            outputs[f]->flat<tstring>()(i) =
+                record_defaults[f].flat<tstring>()(0);
+          } else {
+            outputs[f]->flat<tstring>()(i) = std::move(fields[f]);
           }
-          default:
-            OP_REQUIRES(ctx, false,
-                        errors::InvalidArgument("csv: data type ", dtype,
-                                                " not supported in field ", f));
+          break;
         }
+        default:
+          return errors::InvalidArgument("csv: data type ", dtype,
+                                         " not supported in field ", f);
       }
     }
+    return Status::OK();
   }
 
- private:
-  std::vector<DataType> out_type_;
-  std::vector<int64_t> select_cols_;
-  char delim_;
-  bool use_quote_delim_;
-  bool select_all_cols_;
-  string na_value_;
+  // Returns an error if field `f` of record `i` is missing and has no default.
+  static Status CheckHasDefault(const OpInputList& record_defaults, int f,
+                                int64_t i) {
+    if (record_defaults[f].NumElements() != 1) {
+      return errors::InvalidArgument(
+          "Field ", f, " is required but missing in record ", i, "!");
+    }
+    return Status::OK();
+  }
 
-  void ExtractFields(OpKernelContext* ctx, StringPiece input,
-                     std::vector<string>* result) {
-    int64_t current_idx = 0;
+  Status ExtractFields(StringPiece input, std::vector<string>* result) const {
+    size_t current_idx = 0;
     int64_t num_fields_parsed = 0;
     int64_t selector_idx = 0;  // Keep track of index into select_cols
 
     if (!input.empty()) {
-      while (static_cast<size_t>(current_idx) < input.size()) {
+      while (current_idx < input.size()) {
         if (input[current_idx] == '\n' || input[current_idx] == '\r') {
           current_idx++;
           continue;
@@ -232,55 +266,55 @@ class DecodeCSVOp : public OpKernel {
         // This is the body of the field;
         string field;
         if (!quoted) {
-          while (static_cast<size_t>(current_idx) < input.size() &&
-                 input[current_idx] != delim_) {
-            OP_REQUIRES(ctx,
-                        (!use_quote_delim_ || input[current_idx] != '"') &&
-                            input[current_idx] != '\n' &&
-                            input[current_idx] != '\r',
-                        errors::InvalidArgument(
-                            "Unquoted fields cannot have quotes/CRLFs inside"));
-            if (include) field += input[current_idx];
-            current_idx++;
+          // The body runs up to the next delimiter or the end; quotes and
+          // CRLFs before that are errors.
+          size_t stop = unquoted_stops_.FindFirstIn(input, current_idx);
+          if (stop != StringPiece::npos && input[stop] != delim_) {
+            return errors::InvalidArgument(
+                "Unquoted fields cannot have quotes/CRLFs inside");
           }
+          if (stop == StringPiece::npos) stop = input.size();
+          if (include) field.assign(input.data() + current_idx,
+                                    stop - current_idx);
 
           // Go to next field or the end
-          current_idx++;
+          current_idx = stop + 1;
         } else if (use_quote_delim_) {
-          // Quoted field needs to be ended with '"' and delim or end
-          while (
-              (static_cast<size_t>(current_idx) < input.size() - 1) &&
-              (input[current_idx] != '"' || input[current_idx + 1] != delim_)) {
-            if (input[current_idx] != '"') {
-              if (include) field += input[current_idx];
-              current_idx++;
-            } else {
-              OP_REQUIRES(
-                  ctx, input[current_idx + 1] == '"',
-                  errors::InvalidArgument("Quote inside a string has to be "
-                                          "escaped by another quote"));
-              if (include) field += '"';
-              current_idx += 2;
+          // Quoted field needs to be ended with '"' and delim or end.  Copy
+          // the runs between quotes at once; the last byte is only checked
+          // below.
+          const size_t last = input.size() - 1;
+          while (current_idx < last) {
+            const size_t stop =
+                std::min(input.find('"', current_idx), last);
+            if (include) field.append(input.data() + current_idx,
+                                      stop - current_idx);
+            current_idx = stop;
+            if (current_idx == last || input[current_idx + 1] == delim_) {
+              break;
             }
+            if (input[current_idx + 1] != '"') {
+              return errors::InvalidArgument(
+                  "Quote inside a string has to be escaped by another quote");
+            }
+            if (include) field += '"';
+            current_idx += 2;
           }
 
-          OP_REQUIRES(
-              ctx,
-              (static_cast<size_t>(current_idx) < input.size() &&
-               input[current_idx] == '"' &&
-               (static_cast<size_t>(current_idx) == input.size() - 1 ||
-                input[current_idx + 1] == delim_)),
-              errors::InvalidArgument("Quoted field has to end with quote "
-                                      "followed by delim or end"));
+          if (!(current_idx < input.size() && input[current_idx] == '"' &&
+                (current_idx == last || input[current_idx + 1] == delim_))) {
+            return errors::InvalidArgument(
+                "Quoted field has to end with quote followed by delim or end");
+          }
 
           current_idx += 2;
         }
 
         num_fields_parsed++;
         if (include) {
-          result->push_back(field);
+          result->push_back(std::move(field));
           selector_idx++;
-          if (selector_idx == select_cols_.size()) return;
+          if (selector_idx == select_cols_.size()) return Status::OK();
         }
       }
 
@@ -291,6 +325,7 @@ class DecodeCSVOp : public OpKernel {
       if (include && input[input.size() - 1] == delim_)
         result->push_back(string());
     }
+    return Status::OK();
   }
 };
 
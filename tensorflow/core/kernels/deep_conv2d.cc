@@ -951,8 +951,14 @@ template <typename T>
 struct DeepConv2D<CPUDevice, T> {
   void operator()(OpKernelContext* ctx, const Conv2DArgs& args, const T* input,
                   const T* filter, T* output) {
-    // TODO(andydavis) Add function to select transform based on conv params.
-    std::unique_ptr<DeepConv2DTransform<T>> transform(new WinogradTransform<T>);
+    WinogradTransform<T> transform;
+    (*this)(ctx, args, transform, input, filter, output);
+  }
+
+  void operator()(OpKernelContext* ctx, const Conv2DArgs& args,
+                  const DeepConv2DTransform<T>& transform_ref, const T* input,
+                  const T* filter, T* output) {
+    const DeepConv2DTransform<T>* transform = &transform_ref;
 
     const int64_t in_depth = args.in_depth;
     const int64_t out_depth = args.out_depth;
@@ -986,7 +992,7 @@ struct DeepConv2D<CPUDevice, T> {
     T* filter_transform_data = filter_transform.template flat<T>().data();
 
     // Transform filters.
-    TransformFilters<T>()(ctx, args, transform.get(), filter_shards_row,
+    TransformFilters<T>()(ctx, args, transform, filter_shards_row,
                           filter_shards_col, filter, filter_transform_data);
 
     // Pack filters.
@@ -1147,7 +1153,7 @@ struct DeepConv2D<CPUDevice, T> {
           for (int64_t tile_c = 0; tile_c < unroll_col_limit;
                tile_c += num_tiles) {
             const int64_t in_c = tile_c * tile_stride_cols - col_pad;
-            ComputeConv2D<T>()(args, transform.get(), conv_state, in_r, in_c,
+            ComputeConv2D<T>()(args, transform, conv_state, in_r, in_c,
                                num_tiles, packed_filters, input + in_base,
                                output + out_base);
           }
@@ -1155,7 +1161,7 @@ struct DeepConv2D<CPUDevice, T> {
           if (unroll_col_limit < col_tiles) {
             const int64_t rem_tiles = col_tiles - unroll_col_limit;
             const int64_t in_c = unroll_col_limit * tile_stride_cols - col_pad;
-            ComputeConv2D<T>()(args, transform.get(), conv_state, in_r, in_c,
+            ComputeConv2D<T>()(args, transform, conv_state, in_r, in_c,
                                rem_tiles, packed_filters, input + in_base,
                                output + out_base);
           }
@@ -74,6 +74,9 @@ struct Conv2DArgs {
   int filter_cols;
   int pad_rows;
   int pad_cols;
+  // Only used by DirectConv2D; DeepConv2D requires unit strides.
+  int stride_rows;
+  int stride_cols;
 
   // Output layer dimensions
   int out_rows;
@@ -89,6 +92,8 @@ struct Conv2DArgs {
         filter_cols(0),
         pad_rows(0),
         pad_cols(0),
+        stride_rows(1),
+        stride_cols(1),
         out_rows(0),
         out_cols(0),
         out_depth(0) {}
@@ -106,8 +111,14 @@ namespace functor {
 // Calls DeepConv2D implementation (see deep_conv2d.cc for details).
 template <typename Device, typename T>
 struct DeepConv2D {
+  // Uses the F(2x2, 3x3) WinogradTransform.
   void operator()(OpKernelContext* ctx, const Conv2DArgs& args, const T* input,
                   const T* filter, T* output);
+
+  // Uses 'transform', e.g. a Winograd4x4Transform for 3x3 filters.
+  void operator()(OpKernelContext* ctx, const Conv2DArgs& args,
+                  const DeepConv2DTransform<T>& transform, const T* input,
+                  const T* filter, T* output);
 };
 
 }  // namespace functor
@@ -155,5 +155,55 @@ TEST(DeepConv2DTransformTest, WingradOutputTransformMatrix) {
   }
 }
 
+TEST(DeepConv2DTransformTest, Winograd4x4TransformComputesCorrelation) {
+  // Checks that y = C[Ad * Bg] is the 4x4 correlation of a 6x6 tile 'd' with
+  // a 3x3 filter 'g'.
+  Winograd4x4Transform<float> t;
+  const int tile_size = 36;
+  const int filter_size = 9;
+  const int out_size = 16;
+
+  float filter_transform[tile_size * filter_size];
+  float input_transform[tile_size * tile_size];
+  float output_transform[out_size * tile_size];
+  t.GetFilterTransformMatrix(tile_size, filter_size, filter_transform);
+  t.GetInputTransformMatrix(tile_size, tile_size, input_transform);
+  t.GetOutputTransformMatrix(out_size, tile_size, output_transform);
+
+  float d[tile_size];
+  for (int i = 0; i < tile_size; ++i) d[i] = (i % 7) - 3;
+  float g[filter_size];
+  for (int i = 0; i < filter_size; ++i) g[i] = (i % 4) - 1.5f;
+
+  float product[tile_size];
+  for (int i = 0; i < tile_size; ++i) {
+    float ad = 0;
+    for (int j = 0; j < tile_size; ++j) {
+      ad += input_transform[i * tile_size + j] * d[j];
+    }
+    float bg = 0;
+    for (int j = 0; j < filter_size; ++j) {
+      bg += filter_transform[i * filter_size + j] * g[j];
+    }
+    product[i] = ad * bg;
+  }
+
+  for (int r = 0; r < 4; ++r) {
+    for (int c = 0; c < 4; ++c) {
+      float y = 0;
+      for (int j = 0; j < tile_size; ++j) {
+        y += output_transform[(r * 4 + c) * tile_size + j] * product[j];
+      }
+      float expected = 0;
+      for (int f_r = 0; f_r < 3; ++f_r) {
+        for (int f_c = 0; f_c < 3; ++f_c) {
+          expected += d[(r + f_r) * 6 + c + f_c] * g[f_r * 3 + f_c];
+        }
+      }
+      EXPECT_NEAR(y, expected, 1e-4) << r << "," << c;
+    }
+  }
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -0,0 +1,196 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#define EIGEN_USE_THREADS
+
+#include "tensorflow/core/kernels/direct_conv2d.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+// DirectConv2D computes each output from the input and filter directly,
+// without an im2col copy of the input:
+//
+// *) Filters are packed into blocks of 'kDepthBlock' output channels, i.e.
+//    from [filter_rows, filter_cols, in_depth, out_depth] to
+//    [out_depth_blocks, filter_rows, filter_cols, in_depth, kDepthBlock], the
+//    filter half of the NCHWc layout used by direct convolution libraries.
+// *) Each task computes 'kTileCols' outputs of one output row, for one block
+//    of output channels, in registers. Every input value is broadcast and
+//    multiplied with a block of filter values, so that the innermost loop is
+//    a 'kDepthBlock' wide vector multiply-add.
+// *) The NHWC input is read in place: with few input channels it is already
+//    the input half of the NCHWc layout, with a single channel block.
+
+namespace {
+
+// Number of output channels computed together, one AVX register of floats.
+constexpr int64_t kDepthBlock = 8;
+// Number of output columns computed together.
+constexpr int64_t kTileCols = 4;
+// Above this, the patches are large enough for the contraction to win.
+constexpr int kMaxInDepth = 32;
+
+// Packs 'filter' into 'packed' as described above, zero padding the last
+// block of output channels.
+//
+// filter:
+//   [filter_rows, filter_cols, in_depth, out_depth]
+// packed:
+//   [out_depth_blocks, filter_rows, filter_cols, in_depth, kDepthBlock]
+template <typename T>
+void PackFilter(const Conv2DArgs& args, const T* filter, T* packed) {
+  const int64_t num_blocks = (args.out_depth + kDepthBlock - 1) / kDepthBlock;
+  const int64_t patch_size =
+      static_cast<int64_t>(args.filter_rows) * args.filter_cols * args.in_depth;
+  for (int64_t block = 0; block < num_blocks; ++block) {
+    const int64_t od_start = block * kDepthBlock;
+    const int64_t od_size =
+        std::min<int64_t>(kDepthBlock, args.out_depth - od_start);
+    T* out = packed + block * patch_size * kDepthBlock;
+    for (int64_t i = 0; i < patch_size; ++i) {
+      const T* in = filter + i * args.out_depth + od_start;
+      for (int64_t o = 0; o < kDepthBlock; ++o) {
+        out[i * kDepthBlock + o] = o < od_size ? in[o] : T(0);
+      }
+    }
+  }
+}
+
+// Computes outputs [out_c, out_c + num_cols) of row 'out_r' for the block
+// 'block' of output channels, with 'num_cols' <= kTileCols.
+//
+// input:
+//   [in_rows, in_cols, in_depth]
+// output:
+//   [out_rows, out_cols, out_depth]
+template <typename T>
+void ComputeTile(const Conv2DArgs& args, const T* input, const T* packed,
+                 const int64_t block, const int64_t out_r, const int64_t out_c,
+                 const int64_t num_cols, T* output) {
+  const int64_t in_depth = args.in_depth;
+  const T* block_filter =
+      packed + block * args.filter_rows * args.filter_cols * in_depth *
+                   kDepthBlock;
+
+  T acc[kTileCols][kDepthBlock] = {};
+  for (int64_t f_r = 0; f_r < args.filter_rows; ++f_r) {
+    const int64_t in_r = out_r * args.stride_rows - args.pad_rows + f_r;
+    if (in_r < 0 || in_r >= args.in_rows) continue;
+    const T* input_row = input + in_r * args.in_cols * in_depth;
+
+    for (int64_t f_c = 0; f_c < args.filter_cols; ++f_c) {
+      const T* filter_tap = block_filter + (f_r * args.filter_cols + f_c) *
+                                               in_depth * kDepthBlock;
+      // Columns past 'num_cols' are computed when their inputs exist, and
+      // dropped below; this keeps the loop bounds constant.
+      for (int64_t t = 0; t < kTileCols; ++t) {
+        const int64_t in_c =
+            (out_c + t) * args.stride_cols - args.pad_cols + f_c;
+        if (in_c < 0 || in_c >= args.in_cols) continue;
+        const T* in = input_row + in_c * in_depth;
+        for (int64_t d = 0; d < in_depth; ++d) {
+          const T x = in[d];
+          const T* f = filter_tap + d * kDepthBlock;
+          for (int64_t o = 0; o < kDepthBlock; ++o) {
+            acc[t][o] += x * f[o];
+          }
+        }
+      }
+    }
+  }
+
+  const int64_t od_start = block * kDepthBlock;
+  const int64_t od_size =
+      std::min<int64_t>(kDepthBlock, args.out_depth - od_start);
+  for (int64_t t = 0; t < num_cols; ++t) {
+    T* out = output + ((out_r * args.out_cols) + out_c + t) * args.out_depth +
+             od_start;
+    memcpy(out, acc[t], od_size * sizeof(T));
+  }
+}
+
+}  // namespace
+
+bool CanUseDirectConv2D(const Conv2DArgs& args) {
+  return args.in_depth <= kMaxInDepth && args.stride_rows >= 1 &&
+         args.stride_cols >= 1;
+}
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+
+namespace functor {
+
+// Conv2D operation specialized for convolutions with few input channels.
+// Details:
+// *) Packs the filters into blocks of output channels.
+// *) Computes Conv2D parallelized across images, output rows and blocks of
+//    output channels.
+template <typename T>
+struct DirectConv2D<CPUDevice, T> {
+  void operator()(OpKernelContext* ctx, const Conv2DArgs& args, const T* input,
+                  const T* filter, T* output) {
+    const int64_t num_blocks = (args.out_depth + kDepthBlock - 1) / kDepthBlock;
+    const int64_t patch_size = static_cast<int64_t>(args.filter_rows) *
+                               args.filter_cols * args.in_depth;
+
+    Tensor packed_tensor;
+    OP_REQUIRES_OK(ctx, ctx->allocate_temp(
+                            DataTypeToEnum<T>::value,
+                            TensorShape({num_blocks, patch_size, kDepthBlock}),
+                            &packed_tensor));
+    T* packed = packed_tensor.template flat<T>().data();
+    PackFilter<T>(args, filter, packed);
+
+    const int64_t input_image_size =
+        static_cast<int64_t>(args.in_rows) * args.in_cols * args.in_depth;
+    const int64_t output_image_size =
+        static_cast<int64_t>(args.out_rows) * args.out_cols * args.out_depth;
+
+    // Each unit of work is one output row of one image for one block.
+    auto shard = [&args, input, packed, output, num_blocks, input_image_size,
+                  output_image_size](int64_t start, int64_t limit) {
+      for (int64_t i = start; i < limit; ++i) {
+        const int64_t block = i % num_blocks;
+        const int64_t out_r = (i / num_blocks) % args.out_rows;
+        const int64_t b = i / (num_blocks * args.out_rows);
+        for (int64_t out_c = 0; out_c < args.out_cols; out_c += kTileCols) {
+          const int64_t num_cols =
+              std::min<int64_t>(kTileCols, args.out_cols - out_c);
+          ComputeTile<T>(args, input + b * input_image_size, packed, block,
+                         out_r, out_c, num_cols,
+                         output + b * output_image_size);
+        }
+      }
+    };
+    auto worker_threads = *(ctx->device()->tensorflow_cpu_worker_threads());
+    const int64_t shard_cost = args.out_cols * patch_size * kDepthBlock;
+    Shard(worker_threads.num_threads, worker_threads.workers,
+          args.batch * args.out_rows * num_blocks, shard_cost, shard);
+  }
+};
+
+}  // namespace functor
+
+template struct functor::DirectConv2D<CPUDevice, float>;
+
+}  // namespace tensorflow
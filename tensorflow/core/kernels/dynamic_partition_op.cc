@@ -15,19 +15,27 @@ limitations under the License.
 
 // See docs in ../ops/data_flow_ops.cc.
 
+#include <algorithm>
+#include <cstring>
 #include <vector>
+
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/types.h"
-#include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/util/util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
 // Shared code that is not dependent on the type of T.  We do this to reduce
 // code size by not duplicating all this for all T (float, double, int32, etc.)
+//
+// The partitioning is a stable two-pass counting sort: the rows are split into
+// contiguous shards, each shard counts its rows per partition, an exclusive
+// prefix sum over (partition, shard) gives every shard its own output range in
+// each partition, and the shards then scatter their rows independently.
 class DynamicPartitionOp_Shared : public OpKernel {
  public:
   explicit DynamicPartitionOp_Shared(OpKernelConstruction* c) : OpKernel(c) {
@@ -39,8 +47,13 @@ class DynamicPartitionOp_Shared : public OpKernel {
     //   in the graph?
   }
 
+  // Validates the inputs, picks the number of shards and allocates the
+  // outputs. On return, (*offsets)[s * num_partitions_ + p] is the first row
+  // of outputs[p] written by shard s.
   void ValidateAndAllocateOutputs(OpKernelContext* c, const Tensor** data,
                                   const Tensor** partitions,
+                                  int64_t* num_shards,
+                                  std::vector<int64_t>* offsets,
                                   OpOutputList* Tout) {
     OP_REQUIRES_OK(c, c->input("data", data));
     OP_REQUIRES_OK(c, c->input("partitions", partitions));
@@ -52,24 +65,49 @@ class DynamicPartitionOp_Shared : public OpKernel {
             "got data.shape = ", (*data)->shape().DebugString(),
             ", partitions.shape = ", (*partitions)->shape().DebugString()));
 
-    // Count how many occurrences of each partition id we have in partitions
-    gtl::InlinedVector<int, 32> partition_count(num_partitions_);
     auto e_partitions = (*partitions)->flat<int32>();
     const int64_t N = e_partitions.dimension(0);
-    for (int64_t i = 0; i < N; i++) {
-      const int32_t p = internal::SubtleMustCopy(e_partitions(i));
-      OP_REQUIRES(c, FastBoundsCheck(p, num_partitions_),
+    *num_shards = NumShards(c, N, (*data)->TotalBytes());
+
+    // Count how many occurrences of each partition id each shard has, and
+    // remember the first invalid id of each shard.
+    offsets->assign(*num_shards * num_partitions_, 0);
+    std::vector<int64_t> first_invalid(*num_shards, -1);
+    auto count = [&](int64_t shard) {
+      int64_t* shard_count = offsets->data() + shard * num_partitions_;
+      const int64_t limit = ShardLimit(shard + 1, *num_shards, N);
+      for (int64_t i = ShardLimit(shard, *num_shards, N); i < limit; i++) {
+        const int32_t p = internal::SubtleMustCopy(e_partitions(i));
+        if (!FastBoundsCheck(p, num_partitions_)) {
+          first_invalid[shard] = i;
+          return;
+        }
+        shard_count[p]++;
+      }
+    };
+    ForEachShard(c, *num_shards, (*data)->TotalBytes(), count);
+    for (int64_t shard = 0; shard < *num_shards; shard++) {
+      const int64_t i = first_invalid[shard];
+      OP_REQUIRES(c, i < 0,
                   errors::InvalidArgument(
                       "partitions", SliceDebugString((*partitions)->shape(), i),
-                      " = ", p, " is not in [0, ", num_partitions_, ")"));
-      partition_count[p]++;
+                      " = ", e_partitions(i), " is not in [0, ",
+                      num_partitions_, ")"));
     }
 
-    // Allocate output tensors of the right size
+    // Turn the counts into offsets, and allocate output tensors of the right
+    // size.
     OP_REQUIRES_OK(c, c->output_list("outputs", Tout));
     for (int p = 0; p < num_partitions_; p++) {
+      int64_t partition_count = 0;
+      for (int64_t shard = 0; shard < *num_shards; shard++) {
+        int64_t& offset = (*offsets)[shard * num_partitions_ + p];
+        const int64_t shard_count = offset;
+        offset = partition_count;
+        partition_count += shard_count;
+      }
       TensorShape shape;
-      shape.AddDim(partition_count[p]);
+      shape.AddDim(partition_count);
       for (int i = (*partitions)->dims(); i < (*data)->dims(); i++) {
         shape.AddDim((*data)->dim_size(i));
       }
@@ -79,7 +117,41 @@ class DynamicPartitionOp_Shared : public OpKernel {
   }
 
  protected:
+  // Returns the first row of `shard`, or N for `shard` == `num_shards`.
+  static int64_t ShardLimit(int64_t shard, int64_t num_shards, int64_t N) {
+    return N / num_shards * shard + std::min(shard, N % num_shards);
+  }
+
+  // Runs `fn(shard)` for every shard on the intra-op thread pool; `bytes` is
+  // the total amount of data the shards move.
+  template <typename Fn>
+  static void ForEachShard(OpKernelContext* c, int64_t num_shards,
+                           int64_t bytes, const Fn& fn) {
+    if (num_shards == 1) {
+      fn(0);
+      return;
+    }
+    const auto& worker_threads = *c->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, num_shards,
+          /*cost_per_unit=*/bytes / num_shards,
+          [&fn](int64_t begin, int64_t end) {
+            for (int64_t shard = begin; shard < end; shard++) fn(shard);
+          });
+  }
+
   int num_partitions_;
+
+ private:
+  // Each shard moves at least kMinBytesPerShard bytes of data, so that small
+  // inputs are partitioned by the calling thread alone.
+  static constexpr int64_t kMinBytesPerShard = 1 << 17;
+
+  static int64_t NumShards(OpKernelContext* c, int64_t N, int64_t bytes) {
+    const int64_t num_threads =
+        c->device()->tensorflow_cpu_worker_threads()->num_threads;
+    return std::max<int64_t>(
+        1, std::min({num_threads, N, bytes / kMinBytesPerShard}));
+  }
 };
 
 template <class T>
@@ -90,70 +162,58 @@ class DynamicPartitionOp : public DynamicPartitionOp_Shared {
   void Compute(OpKernelContext* c) override {
     const Tensor* data;
     const Tensor* partitions;
+    int64_t num_shards;
+    std::vector<int64_t> offsets;
     OpOutputList outputs;
-    ValidateAndAllocateOutputs(c, &data, &partitions, &outputs);
+    ValidateAndAllocateOutputs(c, &data, &partitions, &num_shards, &offsets,
+                               &outputs);
     if (!c->status().ok()) return;
     if (num_partitions_ == 0 || data->NumElements() == 0) return;
 
     auto e_partitions = partitions->flat<int32>();
     const int64_t N = e_partitions.dimension(0);
-    gtl::InlinedVector<int, 32> output_index(num_partitions_);
-
-    if (partitions->dims() == data->dims()) {
-      // Walk through data and copy the data to the appropriate output tensor
-      const auto data_flat = data->flat<T>();
-      std::vector<Eigen::TensorMap<Eigen::Tensor<T, 1, Eigen::RowMajor>,
-                                   Eigen::Aligned> >
-          out_vec;
-      out_vec.reserve(num_partitions_);
-      for (int p = 0; p < num_partitions_; p++) {
-        out_vec.push_back(outputs[p]->vec<T>());
-      }
-      for (int64_t i = 0; i < N; i++) {
-        const int32_t p = internal::SubtleMustCopy(e_partitions(i));
-        OP_REQUIRES(
-            c, FastBoundsCheck(p, num_partitions_),
-            errors::InvalidArgument("indices[", i, "] is out of range"));
-        auto oi = output_index[p];
-        OP_REQUIRES(c, FastBoundsCheck(oi, out_vec[p].size()),
-                    errors::InvalidArgument(
-                        "out_vec[", p, "] size: ", out_vec[p].size(),
-                        " is not LTE output_index[", p, "] : ", oi));
-        out_vec[p](oi) = data_flat(i);
-        output_index[p]++;
-      }
-    } else {
-      // If data has extra dimensions, use Eigen slices
-      std::vector<Eigen::TensorMap<Eigen::Tensor<T, 2, Eigen::RowMajor>,
-                                   Eigen::Aligned> >
-          out_flat;
-      out_flat.reserve(num_partitions_);
-      for (int p = 0; p < num_partitions_; p++) {
-        out_flat.push_back(outputs[p]->flat_outer_dims<T>());
-      }
+    const int64_t slice_size = data->NumElements() / N;
+    const T* data_base = data->flat<T>().data();
+    std::vector<T*> out_base(num_partitions_);
+    std::vector<int64_t> out_rows(num_partitions_);
+    for (int p = 0; p < num_partitions_; p++) {
+      out_base[p] = outputs[p]->flat<T>().data();
+      out_rows[p] = outputs[p]->dim_size(0);
+    }
 
-      // Walk through data and copy the data to the appropriate output tensor
-      const int64_t slice_size = data->NumElements() / N;
-      const auto data_flat = data->shaped<T, 2>({N, slice_size});
-      Eigen::DSizes<Eigen::DenseIndex, 2> sizes(1, slice_size);
-      for (int64_t i = 0; i < N; i++) {
-        // outputs[p][output_index[p]++] = data[i]
+    // Walk through the rows of each shard and copy them to the appropriate
+    // output tensor. The partitions were validated above, but are checked
+    // again in case they have been overwritten asynchronously.
+    std::vector<char> overwritten(num_shards, false);
+    auto scatter = [&](int64_t shard) {
+      std::vector<int64_t> output_index(
+          offsets.begin() + shard * num_partitions_,
+          offsets.begin() + (shard + 1) * num_partitions_);
+      const int64_t limit = ShardLimit(shard + 1, num_shards, N);
+      for (int64_t i = ShardLimit(shard, num_shards, N); i < limit; i++) {
         const int32_t p = internal::SubtleMustCopy(e_partitions(i));
-        OP_REQUIRES(
-            c, FastBoundsCheck(p, num_partitions_),
-            errors::InvalidArgument("indices[", i,
-                                    "] has been asynchronously overwritten and "
-                                    "is no longer in range!"));
-        auto oi = output_index[p];
-        OP_REQUIRES(c, FastBoundsCheck(oi, out_flat[p].dimension(0)),
-                    errors::InvalidArgument("Size of output_index: ", oi,
-                                            " is no longer in range."));
-        Eigen::DSizes<Eigen::DenseIndex, 2> out_indices(oi, 0);
-        Eigen::DSizes<Eigen::DenseIndex, 2> data_indices(i, 0);
-        out_flat[p].slice(out_indices, sizes) =
-            data_flat.slice(data_indices, sizes);
+        if (!FastBoundsCheck(p, num_partitions_) ||
+            !FastBoundsCheck(output_index[p], out_rows[p])) {
+          overwritten[shard] = true;
+          return;
+        }
+        // outputs[p][output_index[p]++] = data[i]
+        const T* in = data_base + i * slice_size;
+        T* out = out_base[p] + output_index[p] * slice_size;
+        if (DataTypeCanUseMemcpy(DataTypeToEnum<T>::v())) {
+          memcpy(out, in, slice_size * sizeof(T));
+        } else {
+          std::copy_n(in, slice_size, out);
+        }
         output_index[p]++;
       }
+    };
+    ForEachShard(c, num_shards, data->TotalBytes(), scatter);
+    for (int64_t shard = 0; shard < num_shards; shard++) {
+      OP_REQUIRES(c, !overwritten[shard],
+                  errors::InvalidArgument(
+                      "partitions have been asynchronously overwritten and "
+                      "are no longer in range!"));
     }
   }
 };
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include <functional>
 #include <memory>
+#include <vector>
 
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
 #include "tensorflow/core/framework/allocator.h"
@@ -159,6 +160,53 @@ TEST_F(DynamicPartitionOpTest, Error_IndexOutOfRange) {
       << s;
 }
 
+TEST_F(DynamicPartitionOpTest, Large_OrderPreserved) {
+  MakeOp();
+
+  // Large enough for the rows to be partitioned by several shards.
+  const int kRows = 1 << 16;
+  const int kCols = 4;
+  std::vector<float> data(kRows * kCols);
+  std::vector<int32> partitions(kRows);
+  for (int i = 0; i < kRows; i++) {
+    partitions[i] = (i * 7 + i / 3) % 4;
+    for (int j = 0; j < kCols; j++) data[i * kCols + j] = i * kCols + j;
+  }
+  AddInputFromArray<float>(TensorShape({kRows, kCols}), data);
+  AddInputFromArray<int32>(TensorShape({kRows}), partitions);
+  TF_ASSERT_OK(RunOpKernel());
+
+  for (int p = 0; p < 4; p++) {
+    std::vector<float> expected;
+    for (int i = 0; i < kRows; i++) {
+      if (partitions[i] != p) continue;
+      expected.insert(expected.end(), data.begin() + i * kCols,
+                      data.begin() + (i + 1) * kCols);
+    }
+    const int64_t rows = expected.size() / kCols;
+    Tensor expected_tensor(allocator(), DT_FLOAT, TensorShape({rows, kCols}));
+    test::FillValues<float>(&expected_tensor, expected);
+    test::ExpectTensorEqual<float>(expected_tensor, *GetOutput(p));
+  }
+}
+
+TEST_F(DynamicPartitionOpTest, Large_Error_IndexOutOfRange) {
+  MakeOp();
+
+  const int kRows = 1 << 16;
+  const int kCols = 4;
+  std::vector<int32> partitions(kRows, 1);
+  partitions[40000] = -1;
+  partitions[50000] = 7;
+  AddInputFromArray<float>(TensorShape({kRows, kCols}),
+                           std::vector<float>(kRows * kCols));
+  AddInputFromArray<int32>(TensorShape({kRows}), partitions);
+  Status s = RunOpKernel();
+  EXPECT_TRUE(absl::StrContains(s.ToString(),
+                                "partitions[40000] = -1 is not in [0, 4)"))
+      << s;
+}
+
 Node* DynamicPartitionNode(Graph* g, Node* in0, Node* in1, int num_partitions) {
   Node* ret;
   TF_CHECK_OK(NodeBuilder(g->NewName("n"), "DynamicPartition")
@@ -15,11 +15,16 @@ limitations under the License.
 
 // See docs in ../ops/data_flow_ops.cc.
 
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 #include "tensorflow/core/kernels/gpu_device_array.h"
@@ -237,9 +242,11 @@ class DynamicStitchOpImplCPU : public DynamicStitchOpImplBase<T> {
     OpInputList indices_inputs;
     OpInputList data_inputs;
     int first_dim_size;
+    int data_elements_size;
     Tensor* merged = nullptr;
     this->CheckArgsAndAllocateResult(c, &indices_inputs, &data_inputs,
-                                     &first_dim_size, nullptr, &merged);
+                                     &first_dim_size, &data_elements_size,
+                                     &merged);
     if (!c->status().ok()) {
       // Avoid segmentation faults if merged cannot be allocated and an error is
       // passed back in the context.
@@ -286,25 +293,40 @@ class DynamicStitchOpImplCPU : public DynamicStitchOpImplBase<T> {
           }
         }
       };
-      if (Parallel &&
-          c->device()->tensorflow_cpu_worker_threads()->num_threads > 1) {
-        auto thread_pool =
-            c->device()->tensorflow_cpu_worker_threads()->workers;
-        size_t total_indices_size = 0;
+      const auto& worker_threads =
+          *c->device()->tensorflow_cpu_worker_threads();
+      if (worker_threads.num_threads > 1 &&
+          data_elements_size * slice_bytes >= kMinParallelBytes) {
+        // Find the last slice written to each row of merged, then copy the
+        // rows in parallel chunks. This keeps the in-order semantics of
+        // DynamicStitch no matter how the inputs are sized.
+        std::vector<const T*> sources(first_dim_size, nullptr);
         for (int input_num = 0; input_num < indices_inputs.size();
-             ++input_num) {
-          total_indices_size += indices_inputs[input_num].NumElements();
+             input_num++) {
+          auto indices_vec = indices_inputs[input_num].flat<int32>();
+          const T* data_base = data_inputs[input_num].template flat<T>().data();
+          for (int i = 0; i < indices_vec.size(); i++) {
+            int32_t index = internal::SubtleMustCopy(indices_vec(i));
+            OP_REQUIRES(
+                c, FastBoundsCheck(index, first_dim_size),
+                errors::InvalidArgument("indices[", i, "] is out of range"));
+            sources[index] = data_base + i * slice_size;
+          }
         }
-        const double avg_indices_size =
-            static_cast<double>(total_indices_size) / indices_inputs.size();
-        auto bytes_processed = slice_bytes * avg_indices_size;
-        auto LoopBody = [&](int first, int last) {
-          for (int input_num = first; input_num < last; ++input_num) {
-            OnInputNumber(input_num);
+        T* merged_base = merged_flat.data();
+        auto CopyRows = [&](int64_t first, int64_t last) {
+          for (int64_t row = first; row < last; ++row) {
+            const T* source = sources[row];
+            if (source == nullptr) continue;
+            if (DataTypeCanUseMemcpy(DataTypeToEnum<T>::v())) {
+              memcpy(merged_base + row * slice_size, source, slice_bytes);
+            } else {
+              std::copy_n(source, slice_size, merged_base + row * slice_size);
+            }
           }
         };
-        thread_pool->ParallelFor(indices_inputs.size(), bytes_processed,
-                                 LoopBody);
+        Shard(worker_threads.num_threads, worker_threads.workers,
+              first_dim_size, slice_bytes, CopyRows);
       } else {
         for (int input_num = 0; input_num < indices_inputs.size();
              input_num++) {
@@ -313,6 +335,10 @@ class DynamicStitchOpImplCPU : public DynamicStitchOpImplBase<T> {
       }
     }
   }
+
+ private:
+  // Stitches that copy less than this many bytes run on the calling thread.
+  static constexpr int64_t kMinParallelBytes = 1 << 18;
 };
 
 // Using inheritance rather than a typedef so that these classes might have more
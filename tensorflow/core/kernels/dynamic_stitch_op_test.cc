@@ -15,6 +15,7 @@ limitations under the License.
 
 #include <functional>
 #include <memory>
+#include <vector>
 
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/fake_input.h"
@@ -80,6 +81,47 @@ TEST_F(DynamicStitchOpTest, Simple_TwoD) {
   test::ExpectTensorEqual<float>(expected, *GetOutput(0));
 }
 
+TEST_F(DynamicStitchOpTest, Large_DuplicateIndicesMergedInOrder) {
+  MakeOp(2, DT_FLOAT);
+
+  // Large enough for the rows to be copied in parallel. Every row of the
+  // second input overwrites a row of the first one.
+  const int kRows = 1 << 15;
+  const int kCols = 8;
+  std::vector<int32> indices0(kRows);
+  std::vector<int32> indices1(kRows / 2);
+  std::vector<float> data0(kRows * kCols);
+  std::vector<float> data1(kRows / 2 * kCols);
+  for (int i = 0; i < kRows; i++) {
+    indices0[(i * 5) % kRows] = i;
+    for (int j = 0; j < kCols; j++) data0[i * kCols + j] = i;
+  }
+  for (int i = 0; i < kRows / 2; i++) {
+    indices1[i] = 2 * i;
+    for (int j = 0; j < kCols; j++) data1[i * kCols + j] = -i;
+  }
+  AddInputFromArray<int32>(TensorShape({kRows}), indices0);
+  AddInputFromArray<int32>(TensorShape({kRows / 2}), indices1);
+  AddInputFromArray<float>(TensorShape({kRows, kCols}), data0);
+  AddInputFromArray<float>(TensorShape({kRows / 2, kCols}), data1);
+  TF_ASSERT_OK(RunOpKernel());
+
+  std::vector<float> expected(kRows * kCols);
+  for (int i = 0; i < kRows; i++) {
+    for (int j = 0; j < kCols; j++) {
+      expected[indices0[i] * kCols + j] = data0[i * kCols + j];
+    }
+  }
+  for (int i = 0; i < kRows / 2; i++) {
+    for (int j = 0; j < kCols; j++) {
+      expected[indices1[i] * kCols + j] = data1[i * kCols + j];
+    }
+  }
+  Tensor expected_tensor(allocator(), DT_FLOAT, TensorShape({kRows, kCols}));
+  test::FillValues<float>(&expected_tensor, expected);
+  test::ExpectTensorEqual<float>(expected_tensor, *GetOutput(0));
+}
+
 TEST_F(DynamicStitchOpTest, Error_IndicesMultiDimensional) {
   MakeOp(2, DT_FLOAT);
 
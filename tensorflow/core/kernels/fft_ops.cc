@@ -18,12 +18,19 @@ limitations under the License.
 
 // See docs in ../ops/fft_ops.cc.
 
+#include <algorithm>
+#include <complex>
+#include <limits>
+#include <set>
+
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "third_party/eigen3/unsupported/Eigen/FFT"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/bits.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/types.h"
@@ -146,6 +153,72 @@ class FFTBase : public OpKernel {
 
 typedef Eigen::ThreadPoolDevice CPUDevice;
 
+namespace {
+
+// Returns true if rank 1 FFTs of length `n` should use Eigen::FFT. Its kissfft
+// backend has butterflies specialized for factors 2, 3, 4 and 5 and falls back
+// to a quadratic generic butterfly for other factors, so lengths with large
+// prime factors are left to TensorFFT, which uses Bluestein's algorithm.
+// kissfft does not support transforms of length 1.
+bool UseEigenFFT(uint64 n) {
+  if (n < 2 || n > std::numeric_limits<int>::max()) return false;
+  for (uint64 factor : {2, 3, 5, 7}) {
+    while (n % factor == 0) n /= factor;
+  }
+  return n == 1;
+}
+
+// Eigen::FFT caches the plan, i.e. the twiddle factors, for every length it
+// is used with, but also keeps scratch buffers, so each thread uses its own.
+// The plans are dropped if more than kMaxCachedFFTLengths lengths are used.
+constexpr int kMaxCachedFFTLengths = 32;
+
+template <typename RealT>
+Eigen::FFT<RealT>* GetCachedFFT(uint64 fft_length) {
+  struct Cache {
+    Cache() { fft.SetFlag(Eigen::FFT<RealT>::HalfSpectrum); }
+    Eigen::FFT<RealT> fft;
+    std::set<uint64> lengths;
+  };
+  static thread_local Cache cache;
+  if (cache.lengths.insert(fft_length).second &&
+      cache.lengths.size() > kMaxCachedFFTLengths) {
+    cache.fft.impl().clear();
+    cache.lengths = {fft_length};
+  }
+  return &cache.fft;
+}
+
+// Overloads of a rank 1 transform, by the input and output types. The
+// inverse transforms are scaled by 1 / fft_length.
+template <typename RealT>
+void TransformRow(Eigen::FFT<RealT>* fft, bool forward, uint64 fft_length,
+                  const std::complex<RealT>* in, std::complex<RealT>* out) {
+  if (forward) {
+    fft->fwd(out, in, fft_length);
+  } else {
+    fft->inv(out, in, fft_length);
+  }
+}
+
+template <typename RealT>
+void TransformRow(Eigen::FFT<RealT>* fft, bool forward, uint64 fft_length,
+                  const RealT* in, std::complex<RealT>* out) {
+  DCHECK(forward);
+  // Writes the fft_length / 2 + 1 non-negative frequencies.
+  fft->fwd(out, in, fft_length);
+}
+
+template <typename RealT>
+void TransformRow(Eigen::FFT<RealT>* fft, bool forward, uint64 fft_length,
+                  const std::complex<RealT>* in, RealT* out) {
+  DCHECK(!forward);
+  // Reads the fft_length / 2 + 1 non-negative frequencies.
+  fft->inv(out, in, fft_length);
+}
+
+}  // namespace
+
 template <bool Forward, bool _Real, int FFTRank>
 class FFTCPU : public FFTBase {
  public:
@@ -158,6 +231,31 @@ class FFTCPU : public FFTBase {
 
   void DoFFT(OpKernelContext* ctx, const Tensor& in, uint64* fft_shape,
              Tensor* out) override {
+    if (FFTRank == 1 && UseEigenFFT(fft_shape[0])) {
+      const bool is_double =
+          in.dtype() == DT_DOUBLE || out->dtype() == DT_DOUBLE;
+      if (!IsReal()) {
+        if (in.dtype() == DT_COMPLEX128) {
+          DoRowFFT<double, complex128, complex128>(ctx, fft_shape[0], in, out);
+        } else {
+          DoRowFFT<float, complex64, complex64>(ctx, fft_shape[0], in, out);
+        }
+      } else if (IsForward()) {
+        if (is_double) {
+          DoRowFFT<double, double, complex128>(ctx, fft_shape[0], in, out);
+        } else {
+          DoRowFFT<float, float, complex64>(ctx, fft_shape[0], in, out);
+        }
+      } else {
+        if (is_double) {
+          DoRowFFT<double, complex128, double>(ctx, fft_shape[0], in, out);
+        } else {
+          DoRowFFT<float, complex64, float>(ctx, fft_shape[0], in, out);
+        }
+      }
+      return;
+    }
+
     // Create the axes (which are always trailing).
     const auto axes = Eigen::ArrayXi::LinSpaced(FFTRank, 1, FFTRank);
     auto device = ctx->eigen_device<CPUDevice>();
@@ -209,6 +307,36 @@ class FFTCPU : public FFTBase {
     }
   }
 
+  // Computes the rank 1 FFT of each row of `in` with Eigen::FFT, sharding the
+  // rows over the intra-op thread pool and reusing the plans of previous
+  // calls. TensorFFT instead runs on a single thread and computes its twiddle
+  // factors on every call. Rows of real FFT inputs may be longer than the
+  // transform reads, and are then truncated as the other paths do.
+  template <typename RealT, typename InT, typename OutT>
+  void DoRowFFT(OpKernelContext* ctx, uint64 fft_length, const Tensor& in,
+                Tensor* out) {
+    const auto input = in.flat_inner_dims<InT>();
+    auto output = out->flat_inner_dims<OutT>();
+    const int64_t num_rows = output.dimension(0);
+    const int64_t in_row_size = input.dimension(1);
+    const int64_t out_row_size = output.dimension(1);
+    const InT* in_data = input.data();
+    OutT* out_data = output.data();
+    auto work = [&](int64_t start, int64_t limit) {
+      Eigen::FFT<RealT>* fft = GetCachedFFT<RealT>(fft_length);
+      for (int64_t row = start; row < limit; ++row) {
+        TransformRow<RealT>(fft, Forward, fft_length,
+                            in_data + row * in_row_size,
+                            out_data + row * out_row_size);
+      }
+    };
+    const int64_t cost_per_row =
+        5 * fft_length * std::max(1, Log2Ceiling64(fft_length));
+    auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, num_rows,
+          cost_per_row, work);
+  }
+
   template <typename RealT, typename ComplexT>
   void DoRealForwardFFT(OpKernelContext* ctx, uint64* fft_shape,
                         const Tensor& in, Tensor* out) {
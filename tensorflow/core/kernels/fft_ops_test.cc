@@ -0,0 +1,142 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cmath>
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// The DFT of each row of `rows`, each of length `n`.
+std::vector<complex128> NaiveDFT(const std::vector<complex128>& rows, int n,
+                                 bool forward) {
+  std::vector<complex128> result(rows.size());
+  const double sign = forward ? -1 : 1;
+  for (int offset = 0; offset < rows.size(); offset += n) {
+    for (int k = 0; k < n; ++k) {
+      complex128 sum = 0;
+      for (int j = 0; j < n; ++j) {
+        const double angle = sign * 2 * M_PI * ((j * k) % n) / n;
+        sum += rows[offset + j] * std::polar(1.0, angle);
+      }
+      result[offset + k] = forward ? sum : sum / static_cast<double>(n);
+    }
+  }
+  return result;
+}
+
+std::vector<complex128> TestSignal(int size) {
+  std::vector<complex128> signal(size);
+  for (int i = 0; i < size; ++i) {
+    signal[i] = complex128(std::sin(1.3 * i) + i % 3, std::cos(0.7 * i));
+  }
+  return signal;
+}
+
+class FFTOpTest : public OpsTestBase {
+ protected:
+  void MakeOp(const string& op, DataType input_type, bool real) {
+    NodeDefBuilder builder("fft", op);
+    builder.Input(FakeInput(input_type));
+    if (real) builder.Input(FakeInput(DT_INT32));
+    TF_ASSERT_OK(builder.Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+};
+
+// Lengths that use Eigen::FFT (including an odd one) and TensorFFT.
+class FFTOpLengthTest : public FFTOpTest,
+                        public ::testing::WithParamInterface<int> {};
+
+TEST_P(FFTOpLengthTest, ComplexMatchesDFT) {
+  const int n = GetParam();
+  const int batch = 7;
+  for (bool forward : {true, false}) {
+    inputs_.clear();
+    MakeOp(forward ? "FFT" : "IFFT", DT_COMPLEX128, /*real=*/false);
+    const std::vector<complex128> signal = TestSignal(batch * n);
+    AddInputFromArray<complex128>(TensorShape({batch, n}), signal);
+    TF_ASSERT_OK(RunOpKernel());
+    test::ExpectTensorNear<complex128>(
+        *GetOutput(0),
+        test::AsTensor<complex128>(NaiveDFT(signal, n, forward),
+                                   TensorShape({batch, n})),
+        1e-6);
+  }
+}
+
+TEST_P(FFTOpLengthTest, RealRoundTrip) {
+  const int n = GetParam();
+  const int batch = 5;
+  // Rows longer than the FFT length are truncated.
+  const int row_size = n + 2;
+  std::vector<float> signal(batch * row_size);
+  std::vector<complex128> truncated;
+  for (int i = 0; i < signal.size(); ++i) {
+    signal[i] = std::sin(0.9 * i) + i % 4;
+    if (i % row_size < n) truncated.push_back(signal[i]);
+  }
+
+  MakeOp("RFFT", DT_FLOAT, /*real=*/true);
+  AddInputFromArray<float>(TensorShape({batch, row_size}), signal);
+  AddInputFromArray<int32>(TensorShape({1}), {n});
+  TF_ASSERT_OK(RunOpKernel());
+  const Tensor spectrum = *GetOutput(0);
+  const int num_bins = n / 2 + 1;
+  ASSERT_EQ(spectrum.shape(), TensorShape({batch, num_bins}));
+  const std::vector<complex128> expected = NaiveDFT(truncated, n, true);
+  const auto bins = spectrum.matrix<complex64>();
+  // The error of a float FFT grows with the sum of the magnitudes of the
+  // signal, which is at most 4 per element.
+  const double tolerance = 1e-5 * n;
+  for (int b = 0; b < batch; ++b) {
+    for (int k = 0; k < num_bins; ++k) {
+      const complex128 value = expected[b * n + k];
+      EXPECT_NEAR(bins(b, k).real(), value.real(), tolerance) << b << " " << k;
+      EXPECT_NEAR(bins(b, k).imag(), value.imag(), tolerance) << b << " " << k;
+    }
+  }
+
+  inputs_.clear();
+  MakeOp("IRFFT", DT_COMPLEX64, /*real=*/true);
+  AddInputFromArray<complex64>(
+      TensorShape({batch, num_bins}),
+      gtl::ArraySlice<complex64>(spectrum.flat<complex64>().data(),
+                                 spectrum.NumElements()));
+  AddInputFromArray<int32>(TensorShape({1}), {n});
+  TF_ASSERT_OK(RunOpKernel());
+  const auto output = GetOutput(0)->matrix<float>();
+  ASSERT_EQ(GetOutput(0)->shape(), TensorShape({batch, n}));
+  for (int b = 0; b < batch; ++b) {
+    for (int i = 0; i < n; ++i) {
+      EXPECT_NEAR(output(b, i), signal[b * row_size + i], 1e-3)
+          << b << " " << i;
+    }
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(Lengths, FFTOpLengthTest,
+                         ::testing::Values(2, 12, 15, 64, 400, 1021));
+
+}  // namespace
+}  // namespace tensorflow
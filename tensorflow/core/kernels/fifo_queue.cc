@@ -19,6 +19,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <deque>
+#include <memory>
 #include <vector>
 
 #include "tensorflow/core/framework/node_def.pb.h"
@@ -48,8 +49,55 @@ void FIFOQueue::DequeueLocked(OpKernelContext* ctx, Tuple* tuple) {
   }
 }
 
+bool FIFOQueue::TryEnqueueWithoutWaiting(const std::vector<Tuple>& elements,
+                                         OpKernelContext* ctx) {
+  if (ctx->cancellation_manager()->IsCancelled()) return false;
+  bool wake_dequeuers;
+  {
+    mutex_lock l(mu_);
+    if (closed_ || !enqueue_attempts_.empty() ||
+        queues_[0].size() + elements.size() > static_cast<size_t>(capacity_)) {
+      return false;
+    }
+    for (const Tuple& element : elements) {
+      for (int i = 0; i < num_components(); ++i) {
+        queues_[i].push_back(element[i]);
+      }
+    }
+    wake_dequeuers = !dequeue_attempts_.empty();
+  }
+  if (wake_dequeuers) FlushUnlocked();
+  return true;
+}
+
+bool FIFOQueue::TryDequeueWithoutWaiting(int64_t num_elements,
+                                         OpKernelContext* ctx,
+                                         std::vector<Tuple>* elements) {
+  if (ctx->cancellation_manager()->IsCancelled()) return false;
+  bool wake_enqueuers;
+  {
+    mutex_lock l(mu_);
+    if (!dequeue_attempts_.empty() ||
+        queues_[0].size() < static_cast<size_t>(num_elements)) {
+      return false;
+    }
+    elements->resize(num_elements);
+    for (Tuple& element : *elements) {
+      DequeueLocked(ctx, &element);
+    }
+    wake_enqueuers = !enqueue_attempts_.empty();
+  }
+  if (wake_enqueuers) FlushUnlocked();
+  return true;
+}
+
 void FIFOQueue::TryEnqueue(const Tuple& tuple, OpKernelContext* ctx,
                            DoneCallback callback) {
+  if (TryEnqueueWithoutWaiting({tuple}, ctx)) {
+    callback();
+    return;
+  }
+
   CancellationManager* cm = ctx->cancellation_manager();
   CancellationToken token = cm->get_cancellation_token();
   bool already_cancelled;
@@ -107,6 +155,31 @@ void FIFOQueue::TryEnqueueMany(const Tuple& tuple, OpKernelContext* ctx,
     return;
   }
 
+  // Splits a batch that fits in the queue before taking mu_, so that neither
+  // path copies elements while holding it. Larger batches are split as room
+  // becomes available, to bound the memory held by a blocked enqueue.
+  std::shared_ptr<std::vector<Tuple>> elements;
+  if (batch_size <= capacity_) {
+    elements = std::make_shared<std::vector<Tuple>>(batch_size);
+    for (int64_t index = 0; index < batch_size; ++index) {
+      Tuple& element = (*elements)[index];
+      element.resize(num_components());
+      for (int i = 0; i < num_components(); ++i) {
+        Status s =
+            GetElementComponentFromBatch(tuple, index, i, ctx, &element[i]);
+        if (!s.ok()) {
+          ctx->SetStatus(s);
+          callback();
+          return;
+        }
+      }
+    }
+    if (TryEnqueueWithoutWaiting(*elements, ctx)) {
+      callback();
+      return;
+    }
+  }
+
   CancellationManager* cm = ctx->cancellation_manager();
   CancellationToken token = cm->get_cancellation_token();
   bool already_cancelled;
@@ -117,7 +190,8 @@ void FIFOQueue::TryEnqueueMany(const Tuple& tuple, OpKernelContext* ctx,
     if (!already_cancelled) {
       enqueue_attempts_.emplace_back(
           batch_size, callback, ctx, cm, token,
-          [tuple, this](Attempt* attempt) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+          [tuple, elements,
+           this](Attempt* attempt) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
             if (closed_) {
               attempt->context->SetStatus(
                   errors::Cancelled("FIFOQueue '", name_, "' is closed."));
@@ -129,6 +203,10 @@ void FIFOQueue::TryEnqueueMany(const Tuple& tuple, OpKernelContext* ctx,
               const int64_t index =
                   tuple[0].dim_size(0) - attempt->elements_requested;
               for (int i = 0; i < num_components(); ++i) {
+                if (elements != nullptr) {
+                  queues_[i].push_back((*elements)[index][i]);
+                  continue;
+                }
                 Tensor element;
                 attempt->context->SetStatus(GetElementComponentFromBatch(
                     tuple, index, i, attempt->context, &element));
@@ -153,6 +231,12 @@ void FIFOQueue::TryEnqueueMany(const Tuple& tuple, OpKernelContext* ctx,
 }
 
 void FIFOQueue::TryDequeue(OpKernelContext* ctx, CallbackWithTuple callback) {
+  std::vector<Tuple> elements;
+  if (TryDequeueWithoutWaiting(1, ctx, &elements)) {
+    callback(elements[0]);
+    return;
+  }
+
   CancellationManager* cm = ctx->cancellation_manager();
   CancellationToken token = cm->get_cancellation_token();
   bool already_cancelled;
@@ -244,6 +328,31 @@ void FIFOQueue::TryDequeueMany(int num_elements, OpKernelContext* ctx,
     return;
   }
 
+  // The batch is assembled after releasing mu_. As on the waiting path below,
+  // elements dequeued before an allocation or copy fails are lost.
+  std::vector<Tuple> elements;
+  if (TryDequeueWithoutWaiting(num_elements, ctx, &elements)) {
+    Tuple tuple;
+    tuple.reserve(num_components());
+    for (int i = 0; i < num_components(); ++i) {
+      Tensor batch;
+      Status s = ctx->allocate_temp(component_dtypes_[i],
+                                    ManyOutShape(i, num_elements), &batch);
+      for (int64_t index = 0; s.ok() && index < num_elements; ++index) {
+        s = batch_util::CopyElementToSlice(std::move(elements[index][i]),
+                                           &batch, index);
+      }
+      if (!s.ok()) {
+        ctx->SetStatus(s);
+        callback(Tuple());
+        return;
+      }
+      tuple.push_back(std::move(batch));
+    }
+    callback(tuple);
+    return;
+  }
+
   CancellationManager* cm = ctx->cancellation_manager();
   CancellationToken token = cm->get_cancellation_token();
   bool already_cancelled;
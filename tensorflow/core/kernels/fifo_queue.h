@@ -61,6 +61,20 @@ class FIFOQueue : public TypedQueue<std::deque<Tensor> > {
   void DequeueLocked(OpKernelContext* ctx, Tuple* tuple)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Fast paths that complete an operation under a single acquisition of mu_,
+  // without registering a cancellation callback or creating an Attempt. They
+  // apply only when no other attempt of the same kind is pending, so that
+  // attempts still complete in order, and when `ctx` is not cancelled.
+  //
+  // Enqueues all of `elements` if the queue is open and has room for them.
+  // Returns false, without enqueuing anything, otherwise.
+  bool TryEnqueueWithoutWaiting(const std::vector<Tuple>& elements,
+                                OpKernelContext* ctx);
+  // Dequeues `num_elements` elements into `elements` if the queue holds at
+  // least that many. Returns false, without dequeuing anything, otherwise.
+  bool TryDequeueWithoutWaiting(int64_t num_elements, OpKernelContext* ctx,
+                                std::vector<Tuple>* elements);
+
   static Status GetElementComponentFromBatch(const Tuple& tuple, int64_t index,
                                              int component,
                                              OpKernelContext* ctx,
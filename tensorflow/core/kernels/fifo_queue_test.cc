@@ -0,0 +1,313 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/fifo_queue.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/framework/cancellation.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/notification.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/threadpool.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr int kCapacity = 2;
+
+class FIFOQueueTest : public OpsTestBase {
+ protected:
+  // The context of one queue operation, which can be cancelled through
+  // `cancellation_manager`.
+  struct Context {
+    CancellationManager cancellation_manager;
+    OpKernelContext::Params params;
+    std::unique_ptr<OpKernelContext> ctx;
+  };
+
+  // The result of a dequeue, set when its callback runs.
+  struct Dequeued {
+    bool done = false;
+    QueueInterface::Tuple tuple;
+  };
+
+  void SetUp() override {
+    // The queue operations only use the kernel and the device of their
+    // context to allocate temporary tensors.
+    TF_ASSERT_OK(NodeDefBuilder("op", "NoOp").Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+    queue_ = new FIFOQueue(kCapacity, {DT_INT32}, {TensorShape({})}, "queue");
+    TF_ASSERT_OK(queue_->Initialize());
+  }
+
+  void TearDown() override { queue_->Unref(); }
+
+  std::unique_ptr<Context> NewContext() {
+    auto context = absl::make_unique<Context>();
+    context->params.device = device_;
+    context->params.op_kernel = kernel_.get();
+    context->params.cancellation_manager = &context->cancellation_manager;
+    context->ctx = absl::make_unique<OpKernelContext>(&context->params,
+                                                      /*num_outputs=*/0);
+    return context;
+  }
+
+  // Starts enqueuing `value`. Sets `done` when the enqueue completes.
+  void StartEnqueue(int32_t value, Context* context, bool* done) {
+    queue_->TryEnqueue({test::AsScalar<int32>(value)}, context->ctx.get(),
+                       [done]() { *done = true; });
+  }
+
+  // Starts dequeuing an element into `dequeued`.
+  void StartDequeue(Context* context, Dequeued* dequeued) {
+    queue_->TryDequeue(context->ctx.get(),
+                       [dequeued](const QueueInterface::Tuple& tuple) {
+                         dequeued->tuple = tuple;
+                         dequeued->done = true;
+                       });
+  }
+
+  // Enqueues `value`, which must complete without waiting.
+  Status Enqueue(int32_t value) {
+    std::unique_ptr<Context> context = NewContext();
+    bool done = false;
+    StartEnqueue(value, context.get(), &done);
+    EXPECT_TRUE(done);
+    return context->ctx->status();
+  }
+
+  // Dequeues an element into `value`, which must complete without waiting.
+  Status Dequeue(int32_t* value) {
+    std::unique_ptr<Context> context = NewContext();
+    Dequeued dequeued;
+    StartDequeue(context.get(), &dequeued);
+    EXPECT_TRUE(dequeued.done);
+    TF_RETURN_IF_ERROR(context->ctx->status());
+    *value = dequeued.tuple[0].scalar<int32>()();
+    return Status::OK();
+  }
+
+  void Close() {
+    std::unique_ptr<Context> context = NewContext();
+    bool done = false;
+    queue_->Close(context->ctx.get(), /*cancel_pending_enqueues=*/false,
+                  [&done]() { done = true; });
+    EXPECT_TRUE(done);
+    TF_EXPECT_OK(context->ctx->status());
+  }
+
+  FIFOQueue* queue_ = nullptr;
+};
+
+TEST_F(FIFOQueueTest, EnqueueAndDequeueWithoutWaiting) {
+  TF_ASSERT_OK(Enqueue(1));
+  TF_ASSERT_OK(Enqueue(2));
+  EXPECT_EQ(queue_->size(), 2);
+  int32_t value;
+  TF_ASSERT_OK(Dequeue(&value));
+  EXPECT_EQ(value, 1);
+  TF_ASSERT_OK(Dequeue(&value));
+  EXPECT_EQ(value, 2);
+  EXPECT_EQ(queue_->size(), 0);
+}
+
+TEST_F(FIFOQueueTest, EnqueueManyAndDequeueManyWithoutWaiting) {
+  std::unique_ptr<Context> enqueue = NewContext();
+  bool enqueued = false;
+  queue_->TryEnqueueMany({test::AsTensor<int32>({1, 2})}, enqueue->ctx.get(),
+                         [&enqueued]() { enqueued = true; });
+  ASSERT_TRUE(enqueued);
+  TF_ASSERT_OK(enqueue->ctx->status());
+  EXPECT_EQ(queue_->size(), 2);
+
+  std::unique_ptr<Context> dequeue = NewContext();
+  Dequeued dequeued;
+  queue_->TryDequeueMany(2, dequeue->ctx.get(), /*allow_small_batch=*/false,
+                         [&dequeued](const QueueInterface::Tuple& tuple) {
+                           dequeued.tuple = tuple;
+                           dequeued.done = true;
+                         });
+  ASSERT_TRUE(dequeued.done);
+  TF_ASSERT_OK(dequeue->ctx->status());
+  test::ExpectTensorEqual<int32>(dequeued.tuple[0],
+                                 test::AsTensor<int32>({1, 2}));
+  EXPECT_EQ(queue_->size(), 0);
+}
+
+TEST_F(FIFOQueueTest, EnqueueCompletesBlockedDequeue) {
+  std::unique_ptr<Context> blocked = NewContext();
+  Dequeued dequeued;
+  StartDequeue(blocked.get(), &dequeued);
+  EXPECT_FALSE(dequeued.done);
+
+  // The enqueue completes without waiting, and hands its element to the
+  // blocked dequeue.
+  TF_ASSERT_OK(Enqueue(1));
+  ASSERT_TRUE(dequeued.done);
+  TF_ASSERT_OK(blocked->ctx->status());
+  EXPECT_EQ(dequeued.tuple[0].scalar<int32>()(), 1);
+  EXPECT_EQ(queue_->size(), 0);
+}
+
+TEST_F(FIFOQueueTest, DequeueDoesNotOvertakeBlockedDequeue) {
+  std::unique_ptr<Context> first = NewContext();
+  Dequeued first_dequeued;
+  StartDequeue(first.get(), &first_dequeued);
+  std::unique_ptr<Context> second = NewContext();
+  Dequeued second_dequeued;
+  StartDequeue(second.get(), &second_dequeued);
+  EXPECT_FALSE(first_dequeued.done);
+  EXPECT_FALSE(second_dequeued.done);
+
+  TF_ASSERT_OK(Enqueue(1));
+  ASSERT_TRUE(first_dequeued.done);
+  EXPECT_FALSE(second_dequeued.done);
+  TF_ASSERT_OK(Enqueue(2));
+  ASSERT_TRUE(second_dequeued.done);
+  EXPECT_EQ(first_dequeued.tuple[0].scalar<int32>()(), 1);
+  EXPECT_EQ(second_dequeued.tuple[0].scalar<int32>()(), 2);
+}
+
+TEST_F(FIFOQueueTest, EnqueueAfterCloseFails) {
+  TF_ASSERT_OK(Enqueue(1));
+  Close();
+  EXPECT_TRUE(errors::IsCancelled(Enqueue(2)));
+
+  // The elements enqueued before closing can still be dequeued.
+  int32_t value;
+  TF_ASSERT_OK(Dequeue(&value));
+  EXPECT_EQ(value, 1);
+  EXPECT_TRUE(errors::IsOutOfRange(Dequeue(&value)));
+}
+
+TEST_F(FIFOQueueTest, EnqueueDoesNotOvertakePendingClose) {
+  TF_ASSERT_OK(Enqueue(1));
+  TF_ASSERT_OK(Enqueue(2));
+  // The queue is full, so this enqueue blocks, and the close waits for it.
+  std::unique_ptr<Context> blocked = NewContext();
+  bool blocked_done = false;
+  StartEnqueue(3, blocked.get(), &blocked_done);
+  std::unique_ptr<Context> close = NewContext();
+  bool closed = false;
+  queue_->Close(close->ctx.get(), /*cancel_pending_enqueues=*/false,
+                [&closed]() { closed = true; });
+  EXPECT_FALSE(blocked_done);
+  EXPECT_FALSE(closed);
+
+  // Once there is room, this enqueue is behind the close, so it fails.
+  int32_t value;
+  TF_ASSERT_OK(Dequeue(&value));
+  EXPECT_EQ(value, 1);
+  EXPECT_TRUE(blocked_done);
+  TF_EXPECT_OK(blocked->ctx->status());
+  EXPECT_TRUE(closed);
+  TF_ASSERT_OK(Dequeue(&value));
+  EXPECT_EQ(value, 2);
+  EXPECT_TRUE(errors::IsCancelled(Enqueue(4)));
+  TF_ASSERT_OK(Dequeue(&value));
+  EXPECT_EQ(value, 3);
+}
+
+TEST_F(FIFOQueueTest, CancelledOperationsFail) {
+  TF_ASSERT_OK(Enqueue(1));
+
+  std::unique_ptr<Context> dequeue = NewContext();
+  dequeue->cancellation_manager.StartCancel();
+  Dequeued dequeued;
+  StartDequeue(dequeue.get(), &dequeued);
+  ASSERT_TRUE(dequeued.done);
+  EXPECT_TRUE(errors::IsCancelled(dequeue->ctx->status()));
+
+  std::unique_ptr<Context> enqueue = NewContext();
+  enqueue->cancellation_manager.StartCancel();
+  bool enqueued = false;
+  StartEnqueue(2, enqueue.get(), &enqueued);
+  ASSERT_TRUE(enqueued);
+  EXPECT_TRUE(errors::IsCancelled(enqueue->ctx->status()));
+
+  // Neither operation changed the queue.
+  EXPECT_EQ(queue_->size(), 1);
+  int32_t value;
+  TF_ASSERT_OK(Dequeue(&value));
+  EXPECT_EQ(value, 1);
+}
+
+TEST_F(FIFOQueueTest, CancelledBlockedDequeueDoesNotTakeElements) {
+  std::unique_ptr<Context> blocked = NewContext();
+  Dequeued dequeued;
+  StartDequeue(blocked.get(), &dequeued);
+  EXPECT_FALSE(dequeued.done);
+  blocked->cancellation_manager.StartCancel();
+  ASSERT_TRUE(dequeued.done);
+  EXPECT_TRUE(errors::IsCancelled(blocked->ctx->status()));
+
+  // With no dequeue pending anymore, the next ones complete without waiting.
+  TF_ASSERT_OK(Enqueue(1));
+  EXPECT_EQ(queue_->size(), 1);
+  int32_t value;
+  TF_ASSERT_OK(Dequeue(&value));
+  EXPECT_EQ(value, 1);
+}
+
+TEST_F(FIFOQueueTest, ConcurrentEnqueuesAndDequeues) {
+  constexpr int kNumThreads = 4;
+  constexpr int kNumElementsPerThread = 100;
+  std::atomic<int64_t> sum(0);
+  {
+    thread::ThreadPool pool(Env::Default(), "test", 2 * kNumThreads);
+    for (int t = 0; t < kNumThreads; ++t) {
+      pool.Schedule([this]() {
+        for (int i = 1; i <= kNumElementsPerThread; ++i) {
+          std::unique_ptr<Context> context = NewContext();
+          Notification done;
+          queue_->TryEnqueue({test::AsScalar<int32>(i)}, context->ctx.get(),
+                             [&done]() { done.Notify(); });
+          done.WaitForNotification();
+          TF_EXPECT_OK(context->ctx->status());
+        }
+      });
+      pool.Schedule([this, &sum]() {
+        for (int i = 0; i < kNumElementsPerThread; ++i) {
+          std::unique_ptr<Context> context = NewContext();
+          Notification done;
+          queue_->TryDequeue(context->ctx.get(),
+                             [&done, &sum](const QueueInterface::Tuple& tuple) {
+                               if (!tuple.empty()) {
+                                 sum += tuple[0].scalar<int32>()();
+                               }
+                               done.Notify();
+                             });
+          done.WaitForNotification();
+          TF_EXPECT_OK(context->ctx->status());
+        }
+      });
+    }
+  }
+  EXPECT_EQ(sum, kNumThreads * kNumElementsPerThread *
+                     (kNumElementsPerThread + 1) / 2);
+  EXPECT_EQ(queue_->size(), 0);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,213 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/nn_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+#include <vector>
+
+#include "third_party/eigen3/Eigen/Core"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+// Computes Softmax(query * key^T * scale + mask) * value for blocks of
+// kBlockRows rows of the query at a time, so that the scores of a block stay
+// in cache between the two products and the [..., Lq, Lk] tensors of scores
+// and probabilities are never materialized.
+template <typename T>
+class FusedAttentionOp : public OpKernel {
+ public:
+  explicit FusedAttentionOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    float scale;
+    OP_REQUIRES_OK(context, context->GetAttr("scale", &scale));
+    scale_ = scale;
+    int num_args;
+    OP_REQUIRES_OK(context, context->GetAttr("num_args", &num_args));
+    OP_REQUIRES(context, num_args <= 1,
+                errors::InvalidArgument(
+                    "_FusedAttention takes at most one extra argument: mask."));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor& query = ctx->input(0);
+    const Tensor& key = ctx->input(1);
+    const Tensor& value = ctx->input(2);
+    const int rank = query.dims();
+
+    OP_REQUIRES(ctx, rank >= 3,
+                errors::InvalidArgument("query must be at least 3-dimensional",
+                                        query.shape().DebugString()));
+    OP_REQUIRES(ctx, key.dims() == rank && value.dims() == rank,
+                errors::InvalidArgument(
+                    "query, key and value must have the same rank: ",
+                    query.shape().DebugString(), ", ",
+                    key.shape().DebugString(), ", ",
+                    value.shape().DebugString()));
+    int64_t batch = 1;
+    for (int i = 0; i < rank - 2; ++i) {
+      OP_REQUIRES(ctx,
+                  key.dim_size(i) == query.dim_size(i) &&
+                      value.dim_size(i) == query.dim_size(i),
+                  errors::InvalidArgument(
+                      "query, key and value must have the same batch "
+                      "dimensions: ",
+                      query.shape().DebugString(), ", ",
+                      key.shape().DebugString(), ", ",
+                      value.shape().DebugString()));
+      batch *= query.dim_size(i);
+    }
+    const int64_t num_queries = query.dim_size(rank - 2);
+    const int64_t depth = query.dim_size(rank - 1);
+    const int64_t num_keys = key.dim_size(rank - 2);
+    const int64_t value_depth = value.dim_size(rank - 1);
+    OP_REQUIRES(ctx, key.dim_size(rank - 1) == depth,
+                errors::InvalidArgument(
+                    "query and key must have the same depth: ",
+                    query.shape().DebugString(), ", ",
+                    key.shape().DebugString()));
+    OP_REQUIRES(ctx, value.dim_size(rank - 2) == num_keys,
+                errors::InvalidArgument(
+                    "key and value must have the same number of rows: ",
+                    key.shape().DebugString(), ", ",
+                    value.shape().DebugString()));
+
+    // The offsets of the mask of every batch, and the strides of its rows and
+    // columns, which are zero along broadcast dimensions.
+    const T* mask_data = nullptr;
+    std::vector<int64_t> mask_offsets;
+    int64_t mask_row_stride = 0;
+    int64_t mask_col_stride = 0;
+    if (ctx->num_inputs() > 3) {
+      const Tensor& mask = ctx->input(3);
+      OP_REQUIRES(ctx, mask.dims() == rank,
+                  errors::InvalidArgument("mask must have rank ", rank, ": ",
+                                          mask.shape().DebugString()));
+      TensorShape scores_shape = query.shape();
+      scores_shape.set_dim(rank - 1, num_keys);
+      std::vector<int64_t> strides(rank);
+      int64_t stride = 1;
+      for (int i = rank - 1; i >= 0; --i) {
+        const int64_t dim = mask.dim_size(i);
+        OP_REQUIRES(ctx, dim == 1 || dim == scores_shape.dim_size(i),
+                    errors::InvalidArgument(
+                        "mask ", mask.shape().DebugString(),
+                        " does not broadcast to the scores ",
+                        scores_shape.DebugString()));
+        strides[i] = dim == 1 ? 0 : stride;
+        stride *= dim;
+      }
+      mask_data = mask.flat<T>().data();
+      mask_row_stride = strides[rank - 2];
+      mask_col_stride = strides[rank - 1];
+      mask_offsets.resize(batch);
+      for (int64_t b = 0; b < batch; ++b) {
+        int64_t offset = 0;
+        int64_t index = b;
+        for (int i = rank - 3; i >= 0; --i) {
+          offset += (index % query.dim_size(i)) * strides[i];
+          index /= query.dim_size(i);
+        }
+        mask_offsets[b] = offset;
+      }
+    }
+
+    TensorShape output_shape = query.shape();
+    output_shape.set_dim(rank - 1, value_depth);
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, output_shape, &output));
+    if (output->NumElements() == 0) return;
+
+    using Matrix =
+        Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+    using ConstMatrixMap = Eigen::Map<const Matrix>;
+    using MatrixMap = Eigen::Map<Matrix>;
+
+    const T* query_data = query.flat<T>().data();
+    const T* key_data = key.flat<T>().data();
+    const T* value_data = value.flat<T>().data();
+    T* output_data = output->flat<T>().data();
+    const T scale = scale_;
+    const int64_t blocks_per_batch =
+        (num_queries + kBlockRows - 1) / kBlockRows;
+
+    auto compute_fn = [&](int64_t begin, int64_t end) {
+      Matrix scores;
+      Eigen::Array<T, Eigen::Dynamic, 1> row_stats;
+      for (int64_t block = begin; block < end; ++block) {
+        const int64_t b = block / blocks_per_batch;
+        const int64_t row_begin = (block % blocks_per_batch) * kBlockRows;
+        const int64_t rows = std::min(kBlockRows, num_queries - row_begin);
+
+        const ConstMatrixMap q(
+            query_data + (b * num_queries + row_begin) * depth, rows, depth);
+        const ConstMatrixMap k(key_data + b * num_keys * depth, num_keys,
+                               depth);
+        const ConstMatrixMap v(value_data + b * num_keys * value_depth,
+                               num_keys, value_depth);
+        MatrixMap out(output_data + (b * num_queries + row_begin) * value_depth,
+                      rows, value_depth);
+
+        scores.noalias() = (q * k.transpose()) * scale;
+        if (mask_data != nullptr) {
+          const T* mask_block =
+              mask_data + mask_offsets[b] + row_begin * mask_row_stride;
+          for (int64_t r = 0; r < rows; ++r) {
+            const T* mask_row = mask_block + r * mask_row_stride;
+            for (int64_t c = 0; c < num_keys; ++c) {
+              scores(r, c) += mask_row[c * mask_col_stride];
+            }
+          }
+        }
+        auto probs = scores.array();
+        row_stats = probs.rowwise().maxCoeff();
+        probs.colwise() -= row_stats;
+        probs = probs.exp();
+        row_stats = probs.rowwise().sum();
+        probs.colwise() /= row_stats;
+        out.noalias() = scores * v;
+      }
+    };
+
+    const int64_t cost_per_block =
+        kBlockRows * num_keys * (2 * depth + 2 * value_depth + 20);
+    auto worker_threads = *(ctx->device()->tensorflow_cpu_worker_threads());
+    Shard(worker_threads.num_threads, worker_threads.workers,
+          batch * blocks_per_batch, cost_per_block, compute_fn);
+  }
+
+ private:
+  static constexpr int64_t kBlockRows = 32;
+
+  T scale_;
+};
+
+#define REGISTER_CPU_KERNEL(T)                                              \
+  REGISTER_KERNEL_BUILDER(                                                  \
+      Name("_FusedAttention").Device(DEVICE_CPU).TypeConstraint<T>("T"), \
+      FusedAttentionOp<T>);
+
+TF_CALL_float(REGISTER_CPU_KERNEL);
+
+#undef REGISTER_CPU_KERNEL
+
+}  // namespace tensorflow
@@ -0,0 +1,172 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class FusedAttentionOpTest : public OpsTestBase {
+ protected:
+  Status MakeOp(float scale, int num_args) {
+    TF_RETURN_IF_ERROR(NodeDefBuilder("fused_attention", "_FusedAttention")
+                           .Input(FakeInput(DT_FLOAT))
+                           .Input(FakeInput(DT_FLOAT))
+                           .Input(FakeInput(DT_FLOAT))
+                           .Input(FakeInput(num_args, DT_FLOAT))
+                           .Attr("T", DT_FLOAT)
+                           .Attr("scale", scale)
+                           .Attr("num_args", num_args)
+                           .Finalize(node_def()));
+    return InitOp();
+  }
+
+  static std::vector<float> Iota(int size, int modulo) {
+    std::vector<float> values(size);
+    for (int i = 0; i < size; ++i) {
+      values[i] = static_cast<float>((i * 7) % modulo) / modulo - 0.5f;
+    }
+    return values;
+  }
+
+  // Computes the attention of `batch` independent heads, with a mask of shape
+  // [batch, 1, num_keys] if `mask` is not empty.
+  static std::vector<float> Reference(int batch, int num_queries, int num_keys,
+                                      int depth, int value_depth, float scale,
+                                      const std::vector<float>& query,
+                                      const std::vector<float>& key,
+                                      const std::vector<float>& value,
+                                      const std::vector<float>& mask) {
+    std::vector<float> output(batch * num_queries * value_depth);
+    std::vector<float> probs(num_keys);
+    for (int b = 0; b < batch; ++b) {
+      for (int i = 0; i < num_queries; ++i) {
+        float max_score = -INFINITY;
+        for (int j = 0; j < num_keys; ++j) {
+          float score = 0;
+          for (int d = 0; d < depth; ++d) {
+            score += query[(b * num_queries + i) * depth + d] *
+                     key[(b * num_keys + j) * depth + d];
+          }
+          probs[j] = score * scale;
+          if (!mask.empty()) probs[j] += mask[b * num_keys + j];
+          max_score = std::max(max_score, probs[j]);
+        }
+        float sum = 0;
+        for (float& p : probs) {
+          p = std::exp(p - max_score);
+          sum += p;
+        }
+        for (int d = 0; d < value_depth; ++d) {
+          float out = 0;
+          for (int j = 0; j < num_keys; ++j) {
+            out += probs[j] / sum * value[(b * num_keys + j) * value_depth + d];
+          }
+          output[(b * num_queries + i) * value_depth + d] = out;
+        }
+      }
+    }
+    return output;
+  }
+};
+
+TEST_F(FusedAttentionOpTest, WithoutMask) {
+  TF_ASSERT_OK(MakeOp(0.5, 0));
+  const std::vector<float> query = Iota(2 * 3 * 4, 13);
+  const std::vector<float> key = Iota(2 * 5 * 4, 11);
+  const std::vector<float> value = Iota(2 * 5 * 2, 17);
+  AddInputFromArray<float>(TensorShape({1, 2, 3, 4}), query);
+  AddInputFromArray<float>(TensorShape({1, 2, 5, 4}), key);
+  AddInputFromArray<float>(TensorShape({1, 2, 5, 2}), value);
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({1, 2, 3, 2}));
+  test::FillValues<float>(
+      &expected, Reference(2, 3, 5, 4, 2, 0.5, query, key, value, {}));
+  test::ExpectClose(expected, *GetOutput(0));
+}
+
+TEST_F(FusedAttentionOpTest, WithBroadcastMask) {
+  // The number of queries spans several blocks of rows.
+  constexpr int kBatch = 2;
+  constexpr int kHeads = 3;
+  constexpr int kQueries = 70;
+  constexpr int kKeys = 9;
+  constexpr int kDepth = 8;
+  TF_ASSERT_OK(MakeOp(0.125, 1));
+  const std::vector<float> query =
+      Iota(kBatch * kHeads * kQueries * kDepth, 29);
+  const std::vector<float> key = Iota(kBatch * kHeads * kKeys * kDepth, 31);
+  const std::vector<float> value = Iota(kBatch * kHeads * kKeys * kDepth, 23);
+  // Masks out every third key, differently in each batch.
+  std::vector<float> mask(kBatch * kKeys);
+  for (int i = 0; i < mask.size(); ++i) {
+    mask[i] = i % 3 == i / kKeys ? -10000.0f : 0.0f;
+  }
+  AddInputFromArray<float>(TensorShape({kBatch, kHeads, kQueries, kDepth}),
+                           query);
+  AddInputFromArray<float>(TensorShape({kBatch, kHeads, kKeys, kDepth}), key);
+  AddInputFromArray<float>(TensorShape({kBatch, kHeads, kKeys, kDepth}),
+                           value);
+  AddInputFromArray<float>(TensorShape({kBatch, 1, 1, kKeys}), mask);
+  TF_ASSERT_OK(RunOpKernel());
+
+  // Expands the mask to one row per head.
+  std::vector<float> head_mask;
+  for (int b = 0; b < kBatch; ++b) {
+    for (int h = 0; h < kHeads; ++h) {
+      head_mask.insert(head_mask.end(), mask.begin() + b * kKeys,
+                       mask.begin() + (b + 1) * kKeys);
+    }
+  }
+  Tensor expected(allocator(), DT_FLOAT,
+                  TensorShape({kBatch, kHeads, kQueries, kDepth}));
+  test::FillValues<float>(
+      &expected, Reference(kBatch * kHeads, kQueries, kKeys, kDepth, kDepth,
+                           0.125, query, key, value, head_mask));
+  test::ExpectClose(expected, *GetOutput(0));
+}
+
+TEST_F(FusedAttentionOpTest, MaskMustBroadcastToScores) {
+  TF_ASSERT_OK(MakeOp(1.0, 1));
+  AddInputFromArray<float>(TensorShape({1, 2, 2}), {1.0, 2.0, 3.0, 4.0});
+  AddInputFromArray<float>(TensorShape({1, 3, 2}), Iota(6, 5));
+  AddInputFromArray<float>(TensorShape({1, 3, 2}), Iota(6, 7));
+  AddInputFromArray<float>(TensorShape({1, 1, 2}), {0.0, 0.0});
+  Status s = RunOpKernel();
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+}
+
+TEST_F(FusedAttentionOpTest, BatchDimensionsMustMatch) {
+  TF_ASSERT_OK(MakeOp(1.0, 0));
+  AddInputFromArray<float>(TensorShape({2, 1, 2}), {1.0, 2.0, 3.0, 4.0});
+  AddInputFromArray<float>(TensorShape({1, 3, 2}), Iota(6, 5));
+  AddInputFromArray<float>(TensorShape({1, 3, 2}), Iota(6, 7));
+  Status s = RunOpKernel();
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -61,7 +61,10 @@ Status InitializeFusedComputation(
       *fused_computation == FusedComputationType::kBiasAddWithRelu ||
       *fused_computation == FusedComputationType::kBiasAddWithRelu6 ||
       *fused_computation == FusedComputationType::kBiasAddWithElu ||
-      *fused_computation == FusedComputationType::kBiasAddWithLeakyRelu) {
+      *fused_computation == FusedComputationType::kBiasAddWithLeakyRelu ||
+      *fused_computation == FusedComputationType::kBiasAddWithGeluExact ||
+      *fused_computation ==
+          FusedComputationType::kBiasAddWithGeluApproximate) {
     if (num_args != 1) {
       return errors::InvalidArgument(
           "Fused ", kernel_name,
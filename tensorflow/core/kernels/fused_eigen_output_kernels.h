@@ -21,7 +21,7 @@ limitations under the License.
 //   (1) {Conv2D/MatMul} + BiasAdd + <Activation>
 //   (2) {Conv2D/MatMul} + FusedBatchNorm + <Activation>
 //
-// Activation: Relu, Relu6, Elu, etc...
+// Activation: Relu, Relu6, Elu, Gelu, etc...
 
 #ifndef TENSORFLOW_CORE_KERNELS_FUSED_EIGEN_OUTPUT_KERNELS_H_
 #define TENSORFLOW_CORE_KERNELS_FUSED_EIGEN_OUTPUT_KERNELS_H_
@@ -40,6 +40,8 @@ enum class FusedComputationType {
   kBiasAddWithRelu6,
   kBiasAddWithElu,
   kBiasAddWithLeakyRelu,
+  kBiasAddWithGeluExact,
+  kBiasAddWithGeluApproximate,
   kFusedBatchNorm,
   kFusedBatchNormWithRelu,
   kFusedBatchNormWithRelu6,
@@ -129,6 +131,36 @@ struct LeakyRelu {
   };
 };
 
+// Applies `Gelu` to the passed input expression:
+//   0.5 * x * (1 + erf(x / sqrt(2)))
+struct GeluExact {
+  template <typename XprType>
+  static auto apply(XprType expr) {
+    using Scalar = typename XprType::Scalar;
+    const auto half = expr.constant(static_cast<Scalar>(0.5));
+    const auto one = expr.constant(static_cast<Scalar>(1));
+    const auto x_over_sqrt2 =
+        expr * expr.constant(static_cast<Scalar>(M_SQRT1_2));
+    return half * expr * (x_over_sqrt2.erf() + one);
+  };
+};
+
+// Applies the tanh approximation of `Gelu` to the passed input expression:
+//   0.5 * x * (1 + tanh(sqrt(2 / pi) * (x + 0.044715 * x^3)))
+struct GeluApproximate {
+  template <typename XprType>
+  static auto apply(XprType expr) {
+    using Scalar = typename XprType::Scalar;
+    const auto half = expr.constant(static_cast<Scalar>(0.5));
+    const auto one = expr.constant(static_cast<Scalar>(1));
+    const auto cube = expr * expr * expr;
+    const auto inner =
+        (expr + cube * cube.constant(static_cast<Scalar>(0.044715))) *
+        expr.constant(static_cast<Scalar>(0.7978845608028654));
+    return half * expr * (inner.tanh() + one);
+  };
+};
+
 template <typename T>
 struct BiasAddArgs {
   const T* bias_add_data = nullptr;
@@ -139,7 +171,9 @@ struct BiasAddArgs {
            fusion == FusedComputationType::kBiasAddWithRelu ||
            fusion == FusedComputationType::kBiasAddWithRelu6 ||
            fusion == FusedComputationType::kBiasAddWithElu ||
-           fusion == FusedComputationType::kBiasAddWithLeakyRelu;
+           fusion == FusedComputationType::kBiasAddWithLeakyRelu ||
+           fusion == FusedComputationType::kBiasAddWithGeluExact ||
+           fusion == FusedComputationType::kBiasAddWithGeluApproximate;
   }
 };
 
@@ -356,6 +390,10 @@ using WithBiasAddAndElu = BiasAddOutputKernel<T, Elu>;
 template <typename T>
 using WithBiasAddAndLeakyRelu = BiasAddOutputKernel<T, LeakyRelu>;
 template <typename T>
+using WithBiasAddAndGeluExact = BiasAddOutputKernel<T, GeluExact>;
+template <typename T>
+using WithBiasAddAndGeluApproximate = BiasAddOutputKernel<T, GeluApproximate>;
+template <typename T>
 using WithFusedBatchNorm = FusedBatchNormOutputKernel<T>;
 template <typename T>
 using WithFusedBatchNormAndRelu = FusedBatchNormOutputKernel<T, Relu>;
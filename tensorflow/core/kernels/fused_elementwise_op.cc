@@ -0,0 +1,343 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/math_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+#include "absl/strings/str_join.h"
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/kernels/cwise_ops.h"
+#include "tensorflow/core/kernels/relu_op_functor.h"
+
+namespace tensorflow {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+
+#define REGISTER_UNARY_FN(name, functor)        \
+  RegisterUnaryFn(#name, ComputeUnary<functor>, \
+                  functor_traits<typename functor::func>::Cost)
+
+#define REGISTER_BINARY_FN(name, functor)          \
+  RegisterBinaryFn(#name, ComputeBinary<functor>,  \
+                   ComputeBinaryScalar<functor>,   \
+                   functor_traits<typename functor::func>::Cost)
+
+// The compute functions of the ops that can be fused into a
+// _FusedElementwise kernel. Unary ops read `in` and write `out`; binary ops
+// additionally read `arg`, which is either a slice of the same size as `in`,
+// or a single scalar value.
+template <typename T>
+struct FusedElementwiseSupport {
+  using InputBuffer = typename TTypes<T>::ConstFlat;
+  using OutputBuffer = typename TTypes<T>::Flat;
+
+  using UnaryFn = void (*)(const InputBuffer& in, OutputBuffer* out);
+  using BinaryFn = void (*)(const InputBuffer& in, const InputBuffer& arg,
+                            OutputBuffer* out);
+  using BinaryScalarFn = void (*)(const InputBuffer& in, const T* arg,
+                                  OutputBuffer* out);
+
+  struct Step {
+    UnaryFn unary = nullptr;
+    BinaryFn binary = nullptr;
+    BinaryScalarFn binary_scalar = nullptr;
+    // The index into `args` of the second input of a binary op.
+    int arg_index = -1;
+  };
+
+  FusedElementwiseSupport() {
+    REGISTER_UNARY_FN(Abs, functor::abs<T>);
+    REGISTER_UNARY_FN(Exp, functor::exp<T>);
+    REGISTER_UNARY_FN(Log, functor::log<T>);
+    REGISTER_UNARY_FN(Neg, functor::neg<T>);
+    REGISTER_UNARY_FN(Rsqrt, functor::rsqrt<T>);
+    REGISTER_UNARY_FN(Sigmoid, functor::sigmoid<T>);
+    REGISTER_UNARY_FN(Sqrt, functor::sqrt<T>);
+    REGISTER_UNARY_FN(Square, functor::square<T>);
+    REGISTER_UNARY_FN(Tanh, functor::tanh<T>);
+
+    // Additional compute functions not defined via UnaryOp functors.
+    const int max_cost =
+        functor_traits<Eigen::internal::scalar_max_op<T>>::Cost;
+    const int min_cost =
+        functor_traits<Eigen::internal::scalar_min_op<T>>::Cost;
+    RegisterUnaryFn("Relu", ComputeRelu, max_cost);
+    RegisterUnaryFn("Relu6", ComputeRelu6, max_cost + min_cost);
+
+    REGISTER_BINARY_FN(Add, functor::add<T>);
+    REGISTER_BINARY_FN(AddV2, functor::add<T>);
+    REGISTER_BINARY_FN(Maximum, functor::maximum<T>);
+    REGISTER_BINARY_FN(Minimum, functor::minimum<T>);
+    REGISTER_BINARY_FN(Mul, functor::mul<T>);
+    REGISTER_BINARY_FN(RealDiv, functor::div<T>);
+    REGISTER_BINARY_FN(Sub, functor::sub<T>);
+  }
+
+  // Resolves `op_names` into the steps of the fused computation, and returns
+  // the number of `args` consumed by binary ops in `num_args`.
+  Status ExportSteps(const std::vector<string>& op_names,
+                     std::vector<Step>* steps, int* num_args, int* cost) const {
+    *num_args = 0;
+    for (const string& op_name : op_names) {
+      Step step;
+      auto unary = unary_fns_.find(op_name);
+      auto binary = binary_fns_.find(op_name);
+      if (unary != unary_fns_.end()) {
+        step.unary = unary->second.fn;
+        *cost += unary->second.cost;
+      } else if (binary != binary_fns_.end()) {
+        step.binary = binary->second.fn;
+        step.binary_scalar = binary->second.scalar_fn;
+        step.arg_index = (*num_args)++;
+        *cost += binary->second.cost;
+      } else {
+        return errors::InvalidArgument(
+            "Do not have a compute function registered for op: ", op_name);
+      }
+      steps->push_back(step);
+    }
+    return Status::OK();
+  }
+
+ private:
+  template <typename F>
+  using functor_traits = Eigen::internal::functor_traits<F>;
+
+  struct UnaryFnRegistration {
+    UnaryFn fn;
+    int cost;
+  };
+
+  struct BinaryFnRegistration {
+    BinaryFn fn;
+    BinaryScalarFn scalar_fn;
+    int cost;
+  };
+
+  void RegisterUnaryFn(const string& name, UnaryFn fn, int cost) {
+    unary_fns_[name] = {fn, cost};
+  }
+
+  void RegisterBinaryFn(const string& name, BinaryFn fn,
+                        BinaryScalarFn scalar_fn, int cost) {
+    binary_fns_[name] = {fn, scalar_fn, cost};
+  }
+
+  template <typename Functor>
+  static void ComputeUnary(const InputBuffer& in, OutputBuffer* out) {
+    *out = in.unaryExpr(typename Functor::func());
+  }
+
+  template <typename Functor>
+  static void ComputeBinary(const InputBuffer& in, const InputBuffer& arg,
+                            OutputBuffer* out) {
+    *out = in.binaryExpr(arg, typename Functor::func());
+  }
+
+  template <typename Functor>
+  static void ComputeBinaryScalar(const InputBuffer& in, const T* arg,
+                                  OutputBuffer* out) {
+    using Right = typename Eigen::internal::scalar_right<
+        T, T, typename Functor::func, /*is_scalar_in_host_memory=*/true>;
+    *out = in.unaryExpr(Right(arg));
+  }
+
+  static void ComputeRelu(const InputBuffer& in, OutputBuffer* out) {
+    functor::Relu<Eigen::DefaultDevice, T>()(Eigen::DefaultDevice(), in, *out);
+  }
+
+  static void ComputeRelu6(const InputBuffer& in, OutputBuffer* out) {
+    functor::Relu6<Eigen::DefaultDevice, T>()(Eigen::DefaultDevice(), in,
+                                              *out);
+  }
+
+  std::unordered_map<string, UnaryFnRegistration> unary_fns_;
+  std::unordered_map<string, BinaryFnRegistration> binary_fns_;
+};
+
+#undef REGISTER_UNARY_FN
+#undef REGISTER_BINARY_FN
+
+// Evaluates the `fused_ops` chain on `x` (converted from Tx to T). The shards
+// of the input are processed in blocks that fit in the L1 cache, and every op
+// of the chain is applied to a block before moving on to the next one, so the
+// intermediate values are never written back to memory.
+template <typename T, typename Tx>
+class FusedElementwiseOp : public OpKernel {
+ public:
+  using Support = FusedElementwiseSupport<T>;
+  using InputBuffer = typename Support::InputBuffer;
+  using OutputBuffer = typename Support::OutputBuffer;
+  using Step = typename Support::Step;
+
+  using Packet = typename Eigen::internal::packet_traits<T>::type;
+
+  explicit FusedElementwiseOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("fused_ops", &fused_ops_));
+    OP_REQUIRES(context, !fused_ops_.empty(),
+                errors::InvalidArgument(
+                    "Fused elementwise op must have at least one op"));
+
+    int num_args;
+    OP_REQUIRES_OK(context, context->GetAttr("num_args", &num_args));
+
+    int num_binary_ops = 0;
+    OP_REQUIRES_OK(context, Support().ExportSteps(fused_ops_, &steps_,
+                                                  &num_binary_ops, &cost_));
+    OP_REQUIRES(context, num_args == num_binary_ops,
+                errors::InvalidArgument(
+                    "Fused elementwise op expected ", num_binary_ops,
+                    " args for its binary ops, but got num_args=", num_args));
+
+    VLOG(2) << "Fused elementwise op: [" << absl::StrJoin(fused_ops_, ", ")
+            << "]; cost=" << cost_;
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor& x = ctx->input(0);
+    const int num_args = ctx->num_inputs() - 1;
+
+    std::vector<const T*> arg_data(num_args);
+    std::vector<bool> arg_is_scalar(num_args);
+    for (int i = 0; i < num_args; ++i) {
+      const Tensor& arg = ctx->input(i + 1);
+      OP_REQUIRES(
+          ctx,
+          arg.shape() == x.shape() || TensorShapeUtils::IsScalar(arg.shape()),
+          errors::InvalidArgument(
+              "Fused elementwise op args must be scalars or have the shape of "
+              "the input ",
+              x.shape().DebugString(), ", but arg ", i, " has shape ",
+              arg.shape().DebugString()));
+      arg_data[i] = arg.flat<T>().data();
+      arg_is_scalar[i] = TensorShapeUtils::IsScalar(arg.shape());
+    }
+
+    Tensor* out = nullptr;
+    if (std::is_same<T, Tx>::value) {
+      OP_REQUIRES_OK(
+          ctx, ctx->forward_input_or_allocate_output({0}, 0, x.shape(), &out));
+    } else {
+      OP_REQUIRES_OK(ctx, ctx->allocate_output(0, x.shape(), &out));
+    }
+    if (x.NumElements() == 0) return;
+
+    const Tx* x_data = x.flat<Tx>().data();
+    T* out_data = out->flat<T>().data();
+
+    auto compute_fn = [&](int64_t begin, int64_t end) {
+      for (int64_t block_begin = begin; block_begin < end;
+           block_begin += kBlockSize) {
+        const int64_t len = std::min(kBlockSize, end - block_begin);
+        OutputBuffer out_slice(out_data + block_begin, len);
+        const InputBuffer scratch_slice(out_data + block_begin, len);
+
+        int first_step = 0;
+        if (std::is_same<T, Tx>::value) {
+          // The first op reads the input directly.
+          const InputBuffer in_slice(
+              reinterpret_cast<const T*>(x_data) + block_begin, len);
+          ApplyStep(steps_[0], in_slice, block_begin, len, arg_data,
+                    arg_is_scalar, &out_slice);
+          first_step = 1;
+        } else {
+          const typename TTypes<Tx>::ConstFlat in_slice(x_data + block_begin,
+                                                        len);
+          out_slice = in_slice.template cast<T>();
+        }
+        for (int i = first_step; i < steps_.size(); ++i) {
+          ApplyStep(steps_[i], scratch_slice, block_begin, len, arg_data,
+                    arg_is_scalar, &out_slice);
+        }
+      }
+    };
+
+    const CPUDevice& device = ctx->eigen_device<CPUDevice>();
+    const int kOverheadCycles = static_cast<int>(steps_.size()) * 10;
+    Eigen::TensorOpCost cost(
+        /*bytes_loaded=*/sizeof(Tx) + sizeof(T) * num_args,
+        /*bytes_stored=*/sizeof(T), kOverheadCycles + cost_);
+    device.parallelFor(x.NumElements(), cost, AlignBlockSize,
+                       std::move(compute_fn));
+  }
+
+ private:
+  static constexpr int kPacketSize =
+      Eigen::internal::unpacket_traits<Packet>::size;
+
+  // The number of elements of the output that are updated by all the steps
+  // before moving on to the next elements (16KB).
+  static constexpr int64_t kBlockSize = (16 << 10) / sizeof(T);
+
+  static inline int64_t AlignBlockSize(int64_t block_size) {
+    // Align block size to packet size and account for unrolling in run above.
+    if (block_size >= 16 * kPacketSize) {
+      return (block_size + 4 * kPacketSize - 1) & ~(4 * kPacketSize - 1);
+    }
+    // Aligning to 4 * PacketSize would increase block size by more than 25%.
+    return (block_size + kPacketSize - 1) & ~(kPacketSize - 1);
+  }
+
+  static inline void ApplyStep(const Step& step, const InputBuffer& in,
+                               int64_t begin, int64_t len,
+                               const std::vector<const T*>& arg_data,
+                               const std::vector<bool>& arg_is_scalar,
+                               OutputBuffer* out) {
+    if (step.unary != nullptr) {
+      step.unary(in, out);
+    } else if (arg_is_scalar[step.arg_index]) {
+      step.binary_scalar(in, arg_data[step.arg_index], out);
+    } else {
+      const InputBuffer arg(arg_data[step.arg_index] + begin, len);
+      step.binary(in, arg, out);
+    }
+  }
+
+  std::vector<string> fused_ops_;
+  std::vector<Step> steps_;
+  int cost_ = 0;
+};
+
+#define REGISTER_CPU_KERNEL(T, Tx)                                         \
+  REGISTER_KERNEL_BUILDER(Name("_FusedElementwise")                        \
+                              .Device(DEVICE_CPU)                          \
+                              .TypeConstraint<T>("T")                      \
+                              .TypeConstraint<Tx>("Tx"),                   \
+                          FusedElementwiseOp<T, Tx>);
+
+#define REGISTER_CPU(T)                 \
+  REGISTER_CPU_KERNEL(T, Eigen::half);  \
+  REGISTER_CPU_KERNEL(T, bfloat16);     \
+  REGISTER_CPU_KERNEL(T, float);        \
+  REGISTER_CPU_KERNEL(T, double);       \
+  REGISTER_CPU_KERNEL(T, int32);        \
+  REGISTER_CPU_KERNEL(T, int64_t);
+
+REGISTER_CPU(float);
+REGISTER_CPU(double);
+
+#undef REGISTER_CPU
+#undef REGISTER_CPU_KERNEL
+
+}  // namespace tensorflow
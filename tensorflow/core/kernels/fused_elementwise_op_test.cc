@@ -0,0 +1,192 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+class FusedElementwiseOpTest : public OpsTestBase {
+ protected:
+  Status MakeOp(DataType dtype, DataType x_dtype,
+                const std::vector<string>& fused_ops, int num_args) {
+    TF_RETURN_IF_ERROR(NodeDefBuilder("fused_elementwise", "_FusedElementwise")
+                           .Input(FakeInput(x_dtype))
+                           .Input(FakeInput(num_args, dtype))
+                           .Attr("T", dtype)
+                           .Attr("Tx", x_dtype)
+                           .Attr("num_args", num_args)
+                           .Attr("fused_ops", fused_ops)
+                           .Finalize(node_def()));
+    return InitOp();
+  }
+};
+
+TEST_F(FusedElementwiseOpTest, UnaryOps) {
+  TF_ASSERT_OK(MakeOp(DT_FLOAT, DT_FLOAT, {"Sqrt", "Neg", "Relu6"}, 0));
+  AddInputFromArray<float>(TensorShape({3}), {4.0, 81.0, 0.0});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({3}));
+  test::FillValues<float>(&expected, {0.0, 0.0, 0.0});
+  test::ExpectClose(expected, *GetOutput(0));
+}
+
+TEST_F(FusedElementwiseOpTest, BinaryOpsWithTensorAndScalarArgs) {
+  TF_ASSERT_OK(MakeOp(DT_DOUBLE, DT_DOUBLE, {"Mul", "Sub", "Relu"}, 2));
+  AddInputFromArray<double>(TensorShape({2, 2}), {1.0, 2.0, 3.0, 4.0});
+  AddInputFromArray<double>(TensorShape({}), {2.0});
+  AddInputFromArray<double>(TensorShape({2, 2}), {1.0, 5.0, 1.0, 5.0});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_DOUBLE, TensorShape({2, 2}));
+  test::FillValues<double>(&expected, {1.0, 0.0, 5.0, 3.0});
+  test::ExpectClose(expected, *GetOutput(0));
+}
+
+TEST_F(FusedElementwiseOpTest, CastMulAddRelu) {
+  TF_ASSERT_OK(MakeOp(DT_FLOAT, DT_INT32, {"Mul", "AddV2", "Relu"}, 2));
+  AddInputFromArray<int32>(TensorShape({4}), {-2, -1, 1, 2});
+  AddInputFromArray<float>(TensorShape({}), {0.5});
+  AddInputFromArray<float>(TensorShape({4}), {0.25, 0.75, 0.25, -1.5});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({4}));
+  test::FillValues<float>(&expected, {0.0, 0.25, 0.75, 0.0});
+  test::ExpectClose(expected, *GetOutput(0));
+}
+
+TEST_F(FusedElementwiseOpTest, LargeInputSpansManyBlocks) {
+  constexpr int kSize = 100003;
+  TF_ASSERT_OK(MakeOp(DT_FLOAT, DT_FLOAT, {"Tanh", "Maximum", "RealDiv"}, 2));
+
+  std::vector<float> x(kSize), y(kSize), expected_values(kSize);
+  for (int i = 0; i < kSize; ++i) {
+    x[i] = static_cast<float>(i % 101 - 50) / 25.0f;
+    y[i] = static_cast<float>(i % 7 - 3) / 4.0f;
+    expected_values[i] = std::max(std::tanh(x[i]), y[i]) / 3.0f;
+  }
+  AddInputFromArray<float>(TensorShape({kSize}), x);
+  AddInputFromArray<float>(TensorShape({kSize}), y);
+  AddInputFromArray<float>(TensorShape({}), {3.0});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({kSize}));
+  test::FillValues<float>(&expected, expected_values);
+  test::ExpectClose(expected, *GetOutput(0));
+}
+
+TEST_F(FusedElementwiseOpTest, EmptyInput) {
+  TF_ASSERT_OK(MakeOp(DT_FLOAT, DT_FLOAT, {"Exp", "Add"}, 1));
+  AddInputFromArray<float>(TensorShape({0, 3}), {});
+  AddInputFromArray<float>(TensorShape({}), {1.0});
+  TF_ASSERT_OK(RunOpKernel());
+  EXPECT_EQ(TensorShape({0, 3}), GetOutput(0)->shape());
+}
+
+TEST_F(FusedElementwiseOpTest, ArgsMustMatchInputShape) {
+  TF_ASSERT_OK(MakeOp(DT_FLOAT, DT_FLOAT, {"Mul"}, 1));
+  AddInputFromArray<float>(TensorShape({2}), {1.0, 2.0});
+  AddInputFromArray<float>(TensorShape({1, 2}), {1.0, 2.0});
+  Status s = RunOpKernel();
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+}
+
+TEST_F(FusedElementwiseOpTest, NumArgsMustMatchBinaryOps) {
+  Status s = MakeOp(DT_FLOAT, DT_FLOAT, {"Mul", "Add"}, 1);
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+}
+
+TEST_F(FusedElementwiseOpTest, UnsupportedOp) {
+  Status s = MakeOp(DT_FLOAT, DT_FLOAT, {"Relu", "Pow"}, 1);
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+}
+
+// Performance benchmarks below.
+
+// Cast -> Mul -> AddV2 -> Relu, as separate graph nodes or fused together.
+static Graph* CastMulAddRelu(int tensor_size, int repeat_graph, bool fused) {
+  Graph* g = new Graph(OpRegistry::Global());
+
+  Tensor x(DT_INT32, TensorShape({tensor_size}));
+  x.flat<int32>() = x.flat<int32>().setRandom();
+  Tensor scale(DT_FLOAT, TensorShape({}));
+  scale.scalar<float>()() = 0.5f;
+  Tensor bias(DT_FLOAT, TensorShape({tensor_size}));
+  bias.flat<float>() = bias.flat<float>().setRandom();
+
+  for (int i = 0; i < repeat_graph; ++i) {
+    Node* x_node = test::graph::Constant(g, x);
+    Node* scale_node = test::graph::Constant(g, scale);
+    Node* bias_node = test::graph::Constant(g, bias);
+    Node* node;
+    if (fused) {
+      TF_CHECK_OK(NodeBuilder(g->NewName("n"), "_FusedElementwise")
+                      .Input(x_node)
+                      .Input({scale_node, bias_node})
+                      .Attr("T", DT_FLOAT)
+                      .Attr("Tx", DT_INT32)
+                      .Attr("num_args", 2)
+                      .Attr("fused_ops", {"Mul", "AddV2", "Relu"})
+                      .Finalize(g, &node));
+    } else {
+      node = test::graph::Cast(g, x_node, DT_FLOAT);
+      node = test::graph::Binary(g, "Mul", node, scale_node);
+      node = test::graph::Binary(g, "AddV2", node, bias_node);
+      node = test::graph::Unary(g, "Relu", node);
+    }
+  }
+
+  return g;
+}
+
+#define BM_CastMulAddRelu(N, R, FUSED, type)                                 \
+  static void BM_CastMulAddRelu##_##type##_##N##_##R##_##FUSED(              \
+      ::testing::benchmark::State& state) {                                  \
+    test::Benchmark(#type, CastMulAddRelu(N, R, FUSED),                      \
+                    /*old_benchmark_api*/ false)                             \
+        .Run(state);                                                         \
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * N *   \
+                            R);                                              \
+  }                                                                          \
+  BENCHMARK(BM_CastMulAddRelu##_##type##_##N##_##R##_##FUSED);
+
+// BenchmarkName(tensor_size, repeat_graph, fused, type)
+
+BM_CastMulAddRelu(64, 25, false, cpu);
+BM_CastMulAddRelu(64, 25, true, cpu);
+
+BM_CastMulAddRelu(1000, 25, false, cpu);
+BM_CastMulAddRelu(1000, 25, true, cpu);
+
+BM_CastMulAddRelu(100000, 25, false, cpu);
+BM_CastMulAddRelu(100000, 25, true, cpu);
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,107 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/nn_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include "third_party/eigen3/Eigen/Core"
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace tensorflow {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+
+// Normalizes every row of the innermost dimension in a single pass over the
+// input, instead of the Mean, SquaredDifference, Mean, Rsqrt and five
+// element-wise ops that tf.nn.moments and tf.nn.batch_normalization build,
+// each of which reads or writes a tensor of the size of the input.
+template <typename T>
+class FusedLayerNormOp : public OpKernel {
+ public:
+  explicit FusedLayerNormOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    float epsilon;
+    OP_REQUIRES_OK(context, context->GetAttr("epsilon", &epsilon));
+    epsilon_ = epsilon;
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor& x = ctx->input(0);
+    const Tensor& scale = ctx->input(1);
+    const Tensor& offset = ctx->input(2);
+
+    OP_REQUIRES(ctx, x.dims() >= 1,
+                errors::InvalidArgument("x must be at least 1-dimensional: ",
+                                        x.shape().DebugString()));
+    const int64_t depth = x.dim_size(x.dims() - 1);
+    OP_REQUIRES(ctx, scale.dims() == 1 && scale.dim_size(0) == depth,
+                errors::InvalidArgument("scale must have shape [", depth,
+                                        "]: ", scale.shape().DebugString()));
+    OP_REQUIRES(ctx, offset.dims() == 1 && offset.dim_size(0) == depth,
+                errors::InvalidArgument("offset must have shape [", depth,
+                                        "]: ", offset.shape().DebugString()));
+
+    Tensor* y = nullptr;
+    OP_REQUIRES_OK(
+        ctx, ctx->forward_input_or_allocate_output({0}, 0, x.shape(), &y));
+    if (x.NumElements() == 0) return;
+
+    using Row = Eigen::Array<T, Eigen::Dynamic, 1>;
+    const Eigen::Map<const Row> scale_row(scale.flat<T>().data(), depth);
+    const Eigen::Map<const Row> offset_row(offset.flat<T>().data(), depth);
+    const T* x_data = x.flat<T>().data();
+    T* y_data = y->flat<T>().data();
+    const T epsilon = epsilon_;
+
+    // With a forwarded input `x_data` and `y_data` alias, so every row must be
+    // read in full before any of it is written.
+    auto compute_fn = [&](int64_t begin, int64_t end) {
+      for (int64_t row = begin; row < end; ++row) {
+        const Eigen::Map<const Row> x_row(x_data + row * depth, depth);
+        Eigen::Map<Row> y_row(y_data + row * depth, depth);
+        const T mean = x_row.mean();
+        const T variance = (x_row - mean).square().mean();
+        const T inv_stddev = T(1) / Eigen::numext::sqrt(variance + epsilon);
+        y_row = (x_row - mean) * (scale_row * inv_stddev) + offset_row;
+      }
+    };
+
+    const CPUDevice& device = ctx->eigen_device<CPUDevice>();
+    const int64_t num_rows = x.NumElements() / depth;
+    Eigen::TensorOpCost cost(/*bytes_loaded=*/depth * sizeof(T) * 3,
+                             /*bytes_stored=*/depth * sizeof(T),
+                             /*compute_cycles=*/depth * 8);
+    device.parallelFor(num_rows, cost, std::move(compute_fn));
+  }
+
+ private:
+  T epsilon_;
+};
+
+#define REGISTER_CPU_KERNEL(T)                                              \
+  REGISTER_KERNEL_BUILDER(                                                  \
+      Name("_FusedLayerNorm").Device(DEVICE_CPU).TypeConstraint<T>("T"), \
+      FusedLayerNormOp<T>);
+
+TF_CALL_float(REGISTER_CPU_KERNEL);
+
+#undef REGISTER_CPU_KERNEL
+
+}  // namespace tensorflow
@@ -0,0 +1,116 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cmath>
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class FusedLayerNormOpTest : public OpsTestBase {
+ protected:
+  Status MakeOp(float epsilon) {
+    TF_RETURN_IF_ERROR(NodeDefBuilder("fused_layer_norm", "_FusedLayerNorm")
+                           .Input(FakeInput(DT_FLOAT))
+                           .Input(FakeInput(DT_FLOAT))
+                           .Input(FakeInput(DT_FLOAT))
+                           .Attr("T", DT_FLOAT)
+                           .Attr("epsilon", epsilon)
+                           .Finalize(node_def()));
+    return InitOp();
+  }
+};
+
+TEST_F(FusedLayerNormOpTest, NormalizesInnermostDimension) {
+  TF_ASSERT_OK(MakeOp(0.001));
+  AddInputFromArray<float>(TensorShape({2, 1, 4}),
+                           {1.0, 2.0, 3.0, 4.0, -3.0, 1.0, 1.0, 1.0});
+  AddInputFromArray<float>(TensorShape({4}), {1.0, 2.0, 0.5, -1.0});
+  AddInputFromArray<float>(TensorShape({4}), {0.0, 1.0, 0.0, 0.5});
+  TF_ASSERT_OK(RunOpKernel());
+
+  // The first row has mean 2.5 and variance 1.25, the second mean 0 and
+  // variance 3.
+  const float inv1 = 1.0 / std::sqrt(1.25 + 0.001);
+  const float inv2 = 1.0 / std::sqrt(3.0 + 0.001);
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({2, 1, 4}));
+  test::FillValues<float>(
+      &expected, {-1.5f * inv1, -1.0f * inv1 + 1.0f, 0.25f * inv1,
+                  -1.5f * inv1 + 0.5f, -3.0f * inv2, 2.0f * inv2 + 1.0f,
+                  0.5f * inv2, -1.0f * inv2 + 0.5f});
+  test::ExpectClose(expected, *GetOutput(0));
+}
+
+TEST_F(FusedLayerNormOpTest, ManyRows) {
+  constexpr int kRows = 1000;
+  constexpr int kDepth = 16;
+  TF_ASSERT_OK(MakeOp(0.0));
+  std::vector<float> x(kRows * kDepth), expected_values(kRows * kDepth);
+  for (int row = 0; row < kRows; ++row) {
+    float mean = 0;
+    for (int i = 0; i < kDepth; ++i) {
+      x[row * kDepth + i] = static_cast<float>((row * 7 + i * 3) % 11) - 5;
+      mean += x[row * kDepth + i] / kDepth;
+    }
+    float variance = 0;
+    for (int i = 0; i < kDepth; ++i) {
+      const float diff = x[row * kDepth + i] - mean;
+      variance += diff * diff / kDepth;
+    }
+    for (int i = 0; i < kDepth; ++i) {
+      expected_values[row * kDepth + i] =
+          (x[row * kDepth + i] - mean) / std::sqrt(variance);
+    }
+  }
+  AddInputFromArray<float>(TensorShape({kRows, kDepth}), x);
+  AddInputFromArray<float>(TensorShape({kDepth}),
+                           std::vector<float>(kDepth, 1.0));
+  AddInputFromArray<float>(TensorShape({kDepth}),
+                           std::vector<float>(kDepth, 0.0));
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({kRows, kDepth}));
+  test::FillValues<float>(&expected, expected_values);
+  test::ExpectClose(expected, *GetOutput(0));
+}
+
+TEST_F(FusedLayerNormOpTest, EmptyInput) {
+  TF_ASSERT_OK(MakeOp(0.001));
+  AddInputFromArray<float>(TensorShape({0, 3}), {});
+  AddInputFromArray<float>(TensorShape({3}), {1.0, 1.0, 1.0});
+  AddInputFromArray<float>(TensorShape({3}), {0.0, 0.0, 0.0});
+  TF_ASSERT_OK(RunOpKernel());
+  EXPECT_EQ(TensorShape({0, 3}), GetOutput(0)->shape());
+}
+
+TEST_F(FusedLayerNormOpTest, ScaleMustMatchDepth) {
+  TF_ASSERT_OK(MakeOp(0.001));
+  AddInputFromArray<float>(TensorShape({1, 2}), {1.0, 2.0});
+  AddInputFromArray<float>(TensorShape({3}), {1.0, 1.0, 1.0});
+  AddInputFromArray<float>(TensorShape({2}), {0.0, 0.0});
+  Status s = RunOpKernel();
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_GATHER_FUNCTOR_H_
 #define TENSORFLOW_CORE_KERNELS_GATHER_FUNCTOR_H_
 
+#include <algorithm>
+
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 
 #include "tensorflow/core/framework/bounds_check.h"
@@ -23,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_types.h"
 #include "tensorflow/core/framework/type_traits.h"
 #include "tensorflow/core/framework/variant.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/prefetch.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/work_sharder.h"
@@ -33,6 +36,116 @@ typedef Eigen::GpuDevice GPUDevice;
 
 namespace functor {
 
+// Gathers whole rows of a [num_rows, row_bytes] table of simple types, as used
+// for embedding lookups.
+//
+// The copies are specialized on the common row widths, so that each row is
+// moved with a few vector loads and stores, and the rows of the lookups a few
+// positions ahead are prefetched, which keeps several DRAM accesses in flight
+// for tables that are much larger than the caches.
+template <typename Index>
+class RowGatherer {
+ public:
+  // Rows are this many positions ahead of the row being copied when they are
+  // prefetched.
+  static constexpr int kPrefetchDistance = 16;
+  // Prefetches cover at most this many bytes of a row; the hardware
+  // prefetcher follows longer rows on its own.
+  static constexpr int64_t kMaxPrefetchBytes = 128;
+
+  RowGatherer(const void* params, int64_t num_rows, int64_t row_bytes,
+              const Index* indices, int64_t num_indices, void* out)
+      : params_(static_cast<const char*>(params)),
+        num_rows_(num_rows),
+        row_bytes_(row_bytes),
+        indices_(indices),
+        num_indices_(num_indices),
+        out_(static_cast<char*>(out)) {}
+
+  // Copies the rows of the lookups [begin, end).  Returns the position of an
+  // index that is out of range, or -1 if all of them are valid.
+  int64_t Copy(int64_t begin, int64_t end) const {
+    switch (row_bytes_) {
+      case 4:
+        return CopyRange<4>(begin, end);
+      case 8:
+        return CopyRange<8>(begin, end);
+      case 16:
+        return CopyRange<16>(begin, end);
+      case 32:
+        return CopyRange<32>(begin, end);
+      case 64:
+        return CopyRange<64>(begin, end);
+      case 128:
+        return CopyRange<128>(begin, end);
+      case 256:
+        return CopyRange<256>(begin, end);
+      case 512:
+        return CopyRange<512>(begin, end);
+      default:
+        return CopyRange<0>(begin, end);
+    }
+  }
+
+  // Copies all the rows, sharded over `worker_threads`.  Returns the position
+  // of an index that is out of range, or -1 if all of them are valid.
+  int64_t CopyAll(const DeviceBase::CpuWorkerThreads& worker_threads) const {
+    mutex mu;
+    int64_t result = -1;
+    auto work = [&](int64_t begin, int64_t end) {
+      const int64_t bad_i = Copy(begin, end);
+      if (bad_i >= 0) {
+        mutex_lock l(mu);
+        result = bad_i;
+      }
+    };
+    Shard(worker_threads.num_threads, worker_threads.workers, num_indices_,
+          std::max<int64_t>(1, row_bytes_), work);
+    return result;
+  }
+
+  int64_t num_indices() const { return num_indices_; }
+  int64_t row_bytes() const { return row_bytes_; }
+
+ private:
+  // kRowBytes is 0 if the row width is only known at run time.
+  template <int64_t kRowBytes>
+  int64_t CopyRange(int64_t begin, int64_t end) const {
+    // Locals, since the stores through `out` could otherwise alias the
+    // members and force them to be reloaded for every row.
+    const int64_t row_bytes = kRowBytes > 0 ? kRowBytes : row_bytes_;
+    const int64_t prefetch_bytes = std::min(row_bytes, kMaxPrefetchBytes);
+    const char* params = params_;
+    const int64_t num_rows = num_rows_;
+    const Index* indices = indices_;
+    char* out = out_;
+    for (int64_t i = begin; i < end; ++i) {
+      if (i + kPrefetchDistance < end) {
+        const Index next = indices[i + kPrefetchDistance];
+        if (FastBoundsCheck(next, num_rows)) {
+          const char* row = params + next * row_bytes;
+          // One prefetch per 64-byte cache line.
+          for (int64_t offset = 0; offset < prefetch_bytes; offset += 64) {
+            port::prefetch<port::PREFETCH_HINT_T0>(row + offset);
+          }
+        }
+      }
+      const Index index = internal::SubtleMustCopy(indices[i]);
+      if (!FastBoundsCheck(index, num_rows)) return i;
+      // A memcpy of a constant size compiles to plain vector moves.
+      memcpy(out + i * row_bytes, params + index * row_bytes, row_bytes);
+    }
+    return -1;
+  }
+
+  const char* params_;
+  int64_t num_rows_;
+  int64_t row_bytes_;
+  const Index* indices_;
+  int64_t num_indices_;
+  char* out_;
+};
+
 // Helper method to copy using memcpy.
 template <typename T, typename Index, typename SliceIndex,
           SliceIndex static_slice_elems>
@@ -122,6 +235,15 @@ struct GatherFunctorCPU {
 
     const int64_t batch_size = params.dimension(0);
 
+    // Plain lookups of rows, e.g. into an embedding table, copy the rows as
+    // bytes.
+    if (is_simple_type<T>::value && batch_size == 1) {
+      RowGatherer<Index> gatherer(params.data(), params.dimension(1),
+                                  slice_size * sizeof(T), indices.data(),
+                                  indices_size, out.data());
+      return gatherer.CopyAll(*ctx->device()->tensorflow_cpu_worker_threads());
+    }
+
     bool use_large = (slice_size > std::numeric_limits<int32>::max() ||
                       params.size() > std::numeric_limits<int32>::max() ||
                       indices_size > std::numeric_limits<int32>::max() ||
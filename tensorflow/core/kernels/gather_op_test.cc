@@ -163,6 +163,33 @@ TEST_F(GatherOpTest, HighRank) {
   test::ExpectTensorEqual<float>(expected, *GetOutput(0));
 }
 
+TEST_F(GatherOpTest, RowWidths) {
+  // Rows of 4 to 512 bytes are copied by specialized loops, the others by a
+  // generic one.
+  for (int64_t width : {1, 2, 3, 4, 8, 16, 32, 64, 128, 129}) {
+    SCOPED_TRACE(width);
+    inputs_.clear();
+    MakeOp(DT_FLOAT, DT_INT32);
+
+    std::vector<float> params(5 * width);
+    for (int64_t i = 0; i < params.size(); ++i) params[i] = i;
+    AddInputFromArray<float>(TensorShape({5, width}), params);
+    const std::vector<int32> indices = {4, 0, 3, 3, 1};
+    AddInputFromArray<int32>(TensorShape({5}), indices);
+    AddInputFromArray<int32>(TensorShape({}), {0});
+    TF_ASSERT_OK(RunOpKernel());
+
+    Tensor expected(allocator(), DT_FLOAT, TensorShape({5, width}));
+    auto expected_t = expected.matrix<float>();
+    for (int64_t i = 0; i < indices.size(); ++i) {
+      for (int64_t j = 0; j < width; ++j) {
+        expected_t(i, j) = params[indices[i] * width + j];
+      }
+    }
+    test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+  }
+}
+
 TEST_F(GatherOpTest, Error_IndexOutOfRange) {
   MakeOp(DT_FLOAT, DT_INT32);
 
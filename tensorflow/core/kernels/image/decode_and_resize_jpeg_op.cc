@@ -0,0 +1,264 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/image_ops.cc
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/jpeg/jpeg_mem.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+namespace {
+
+// Source coordinates and weights of one output row or column for bilinear
+// interpolation with half pixel centers.
+struct Interpolation {
+  int64_t lower;
+  int64_t upper;
+  float lerp;
+};
+
+// Computes the interpolation of `out_size` outputs covering the source range
+// [`start`, `start` + `size`) of the original image. The decoded image was
+// downscaled by `ratio` and begins at `decoded_start` in the downscaled image,
+// and has `decoded_size` pixels in this dimension.
+std::vector<Interpolation> ComputeInterpolation(int64_t out_size,
+                                                int64_t start, int64_t size,
+                                                int ratio,
+                                                int64_t decoded_start,
+                                                int64_t decoded_size) {
+  std::vector<Interpolation> result(out_size);
+  const float scale = static_cast<float>(size) / out_size;
+  for (int64_t i = 0; i < out_size; ++i) {
+    const float original = start + (i + 0.5f) * scale;
+    const float in = std::min<float>(
+        std::max<float>(original / ratio - decoded_start - 0.5f, 0.0f),
+        decoded_size - 1);
+    const int64_t lower = static_cast<int64_t>(std::floor(in));
+    result[i].lower = lower;
+    result[i].upper = std::min(lower + 1, decoded_size - 1);
+    result[i].lerp = in - lower;
+  }
+  return result;
+}
+
+// Picks the largest libjpeg scaling denominator that keeps the decoded crop
+// at least as large as the output, so that the resize only ever downsamples
+// the data it is given.
+int PickRatio(int64_t crop_height, int64_t crop_width, int64_t out_height,
+              int64_t out_width) {
+  for (int ratio : {8, 4, 2}) {
+    if (crop_height >= out_height * ratio && crop_width >= out_width * ratio) {
+      return ratio;
+    }
+  }
+  return 1;
+}
+
+int64_t CeilDiv(int64_t a, int64_t b) { return (a + b - 1) / b; }
+
+// Decodes the crop window of a JPEG image at the smallest sufficient DCT
+// scale and bilinearly resizes it, without materializing the full image.
+class DecodeAndResizeJpegOp : public OpKernel {
+ public:
+  explicit DecodeAndResizeJpegOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("channels", &channels_));
+    OP_REQUIRES(context,
+                channels_ == 0 || channels_ == 1 || channels_ == 3,
+                errors::InvalidArgument("channels must be 0, 1, or 3, got ",
+                                        channels_));
+    OP_REQUIRES_OK(context, context->GetAttr("fancy_upscaling",
+                                             &flags_.fancy_upscaling));
+    OP_REQUIRES_OK(context,
+                   context->GetAttr("try_recover_truncated",
+                                    &flags_.try_recover_truncated_jpeg));
+    OP_REQUIRES_OK(context,
+                   context->GetAttr("acceptable_fraction",
+                                    &flags_.min_acceptable_fraction));
+    string dct_method;
+    OP_REQUIRES_OK(context, context->GetAttr("dct_method", &dct_method));
+    OP_REQUIRES(
+        context,
+        (dct_method.empty() || dct_method == "INTEGER_FAST" ||
+         dct_method == "INTEGER_ACCURATE"),
+        errors::InvalidArgument("dct_method must be one of "
+                                "{'', 'INTEGER_FAST', 'INTEGER_ACCURATE'}"));
+    if (dct_method == "INTEGER_ACCURATE") {
+      flags_.dct_method = JDCT_ISLOW;
+    } else {
+      flags_.dct_method = JDCT_IFAST;
+    }
+    flags_.components = channels_;
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& contents = context->input(0);
+    OP_REQUIRES(context, TensorShapeUtils::IsScalar(contents.shape()),
+                errors::InvalidArgument("contents must be scalar, got shape ",
+                                        contents.shape().DebugString()));
+    const StringPiece input = contents.scalar<tstring>()();
+    OP_REQUIRES(context, input.size() <= std::numeric_limits<int>::max(),
+                errors::InvalidArgument("JPEG contents are too large for int: ",
+                                        input.size()));
+
+    const Tensor& crop_window = context->input(1);
+    OP_REQUIRES(context,
+                crop_window.dims() == 1 && crop_window.dim_size(0) == 4,
+                errors::InvalidArgument("crop_window must have shape [4], got ",
+                                        crop_window.shape().DebugString()));
+    const Tensor& size = context->input(2);
+    OP_REQUIRES(context, size.dims() == 1 && size.dim_size(0) == 2,
+                errors::InvalidArgument("size must have shape [2], got ",
+                                        size.shape().DebugString()));
+    auto crop_vec = crop_window.vec<int32>();
+    const int64_t crop_y = crop_vec(0);
+    const int64_t crop_x = crop_vec(1);
+    const int64_t crop_height = crop_vec(2);
+    const int64_t crop_width = crop_vec(3);
+    const int64_t out_height = size.vec<int32>()(0);
+    const int64_t out_width = size.vec<int32>()(1);
+    OP_REQUIRES(context, out_height > 0 && out_width > 0,
+                errors::InvalidArgument("size must be positive, got ",
+                                        out_height, "x", out_width));
+
+    int width;
+    int height;
+    OP_REQUIRES(context,
+                jpeg::GetImageInfo(input.data(), input.size(), &width, &height,
+                                   nullptr),
+                errors::InvalidArgument("Invalid JPEG data, size ",
+                                        input.size()));
+    OP_REQUIRES(
+        context,
+        crop_y >= 0 && crop_x >= 0 && crop_height > 0 && crop_width > 0 &&
+            crop_y + crop_height <= height && crop_x + crop_width <= width,
+        errors::InvalidArgument("Invalid crop window: y=", crop_y, " x=",
+                                crop_x, " height=", crop_height, " width=",
+                                crop_width, " for image of ", height, "x",
+                                width));
+
+    // Decodes only the part of the downscaled image that covers the crop.
+    jpeg::UncompressFlags flags = flags_;
+    flags.ratio = PickRatio(crop_height, crop_width, out_height, out_width);
+    const int64_t scaled_y0 = crop_y / flags.ratio;
+    const int64_t scaled_x0 = crop_x / flags.ratio;
+    const int64_t scaled_y1 = std::min(CeilDiv(crop_y + crop_height,
+                                               flags.ratio),
+                                       CeilDiv(height, flags.ratio));
+    const int64_t scaled_x1 = std::min(CeilDiv(crop_x + crop_width,
+                                               flags.ratio),
+                                       CeilDiv(width, flags.ratio));
+    flags.crop = true;
+    flags.crop_y = scaled_y0;
+    flags.crop_x = scaled_x0;
+    flags.crop_height = scaled_y1 - scaled_y0;
+    flags.crop_width = scaled_x1 - scaled_x0;
+
+    Tensor decoded;
+    uint8* buffer = jpeg::Uncompress(
+        input.data(), input.size(), flags, nullptr /* nwarn */,
+        [&](int w, int h, int c) -> uint8* {
+          Status status = context->allocate_temp(
+              DT_UINT8, TensorShape({h, w, c}), &decoded);
+          if (!status.ok()) {
+            VLOG(1) << status;
+            context->SetStatus(status);
+            return nullptr;
+          }
+          return decoded.flat<uint8>().data();
+        });
+    OP_REQUIRES(context, buffer,
+                errors::InvalidArgument(
+                    "jpeg::Uncompress failed. Invalid JPEG data or crop "
+                    "window."));
+
+    const int64_t decoded_height = decoded.dim_size(0);
+    const int64_t decoded_width = decoded.dim_size(1);
+    const int64_t channels = decoded.dim_size(2);
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(
+                       0, TensorShape({out_height, out_width, channels}),
+                       &output));
+
+    const std::vector<Interpolation> ys =
+        ComputeInterpolation(out_height, crop_y, crop_height, flags.ratio,
+                             scaled_y0, decoded_height);
+    // Column offsets are premultiplied by the number of channels so that the
+    // inner loop is a plain gather-and-blend the compiler can vectorize.
+    std::vector<Interpolation> xs =
+        ComputeInterpolation(out_width, crop_x, crop_width, flags.ratio,
+                             scaled_x0, decoded_width);
+    for (Interpolation& x : xs) {
+      x.lower *= channels;
+      x.upper *= channels;
+    }
+
+    const uint8* in = buffer;
+    float* out = output->flat<float>().data();
+    const int64_t in_row_size = decoded_width * channels;
+    const int64_t out_row_size = out_width * channels;
+    auto resize_rows = [&](int64_t begin, int64_t end) {
+      std::vector<float> top(out_row_size);
+      std::vector<float> bottom(out_row_size);
+      for (int64_t y = begin; y < end; ++y) {
+        const uint8* top_row = in + ys[y].lower * in_row_size;
+        const uint8* bottom_row = in + ys[y].upper * in_row_size;
+        for (int64_t x = 0; x < out_width; ++x) {
+          const Interpolation& xi = xs[x];
+          for (int64_t c = 0; c < channels; ++c) {
+            const float top_left = top_row[xi.lower + c];
+            const float bottom_left = bottom_row[xi.lower + c];
+            top[x * channels + c] =
+                top_left + (top_row[xi.upper + c] - top_left) * xi.lerp;
+            bottom[x * channels + c] =
+                bottom_left + (bottom_row[xi.upper + c] - bottom_left) *
+                                  xi.lerp;
+          }
+        }
+        const float y_lerp = ys[y].lerp;
+        float* out_row = out + y * out_row_size;
+        for (int64_t i = 0; i < out_row_size; ++i) {
+          out_row[i] = top[i] + (bottom[i] - top[i]) * y_lerp;
+        }
+      }
+    };
+    const auto& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, out_height,
+          /*cost_per_unit=*/out_row_size * 10, resize_rows);
+  }
+
+ private:
+  int channels_;
+  jpeg::UncompressFlags flags_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("DecodeAndResizeJpeg").Device(DEVICE_CPU),
+                        DecodeAndResizeJpegOp);
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,134 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/jpeg/jpeg_mem.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr int kWidth = 128;
+constexpr int kHeight = 64;
+
+// Encodes an RGB image whose red channel is 2 * x, green channel is 4 * y and
+// blue channel is constant.
+tstring MakeGradientJpeg() {
+  std::vector<uint8> pixels(kWidth * kHeight * 3);
+  for (int y = 0; y < kHeight; ++y) {
+    for (int x = 0; x < kWidth; ++x) {
+      uint8* pixel = &pixels[(y * kWidth + x) * 3];
+      pixel[0] = 2 * x;
+      pixel[1] = 4 * y;
+      pixel[2] = 100;
+    }
+  }
+  jpeg::CompressFlags flags;
+  flags.format = jpeg::FORMAT_RGB;
+  flags.quality = 100;
+  flags.chroma_downsampling = false;
+  tstring output;
+  CHECK(jpeg::Compress(pixels.data(), kWidth, kHeight, flags, &output));
+  return output;
+}
+
+class DecodeAndResizeJpegOpTest : public OpsTestBase {
+ protected:
+  void MakeOp(int channels) {
+    TF_ASSERT_OK(NodeDefBuilder("decode_op", "DecodeAndResizeJpeg")
+                     .Input(FakeInput(DT_STRING))
+                     .Input(FakeInput(DT_INT32))
+                     .Input(FakeInput(DT_INT32))
+                     .Attr("channels", channels)
+                     .Attr("dct_method", "INTEGER_ACCURATE")
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+
+  Status Run(const std::vector<int32>& crop_window,
+             const std::vector<int32>& size) {
+    AddInputFromArray<tstring>(TensorShape({}), {MakeGradientJpeg()});
+    AddInputFromArray<int32>(TensorShape({4}), crop_window);
+    AddInputFromArray<int32>(TensorShape({2}), size);
+    return RunOpKernel();
+  }
+};
+
+// Checks that the output samples the source gradient at the centers of the
+// output pixels, for crops decoded at different DCT scales.
+void ExpectGradient(const Tensor& image, int crop_y, int crop_x,
+                    int crop_height, int crop_width) {
+  const int out_height = image.dim_size(0);
+  const int out_width = image.dim_size(1);
+  auto pixels = image.tensor<float, 3>();
+  for (int y = 0; y < out_height; ++y) {
+    for (int x = 0; x < out_width; ++x) {
+      const float source_x =
+          crop_x + (x + 0.5f) * crop_width / out_width - 0.5f;
+      const float source_y =
+          crop_y + (y + 0.5f) * crop_height / out_height - 0.5f;
+      EXPECT_NEAR(pixels(y, x, 0), 2 * source_x, 6) << y << "," << x;
+      EXPECT_NEAR(pixels(y, x, 1), 4 * source_y, 6) << y << "," << x;
+      EXPECT_NEAR(pixels(y, x, 2), 100, 6) << y << "," << x;
+    }
+  }
+}
+
+TEST_F(DecodeAndResizeJpegOpTest, FullImage) {
+  MakeOp(0);
+  TF_ASSERT_OK(Run({0, 0, kHeight, kWidth}, {48, 96}));
+  const Tensor& image = *GetOutput(0);
+  ASSERT_EQ(image.shape(), TensorShape({48, 96, 3}));
+  ExpectGradient(image, 0, 0, kHeight, kWidth);
+}
+
+TEST_F(DecodeAndResizeJpegOpTest, DownscaledCrop) {
+  MakeOp(3);
+  // The crop is 4x larger than the output, so it is decoded at 1/4 scale.
+  TF_ASSERT_OK(Run({8, 20, 48, 96}, {12, 24}));
+  const Tensor& image = *GetOutput(0);
+  ASSERT_EQ(image.shape(), TensorShape({12, 24, 3}));
+  ExpectGradient(image, 8, 20, 48, 96);
+}
+
+TEST_F(DecodeAndResizeJpegOpTest, UpscaledCrop) {
+  MakeOp(3);
+  TF_ASSERT_OK(Run({10, 30, 16, 16}, {32, 32}));
+  const Tensor& image = *GetOutput(0);
+  ASSERT_EQ(image.shape(), TensorShape({32, 32, 3}));
+  ExpectGradient(image, 10, 30, 16, 16);
+}
+
+TEST_F(DecodeAndResizeJpegOpTest, Grayscale) {
+  MakeOp(1);
+  TF_ASSERT_OK(Run({0, 0, kHeight, kWidth}, {8, 16}));
+  EXPECT_EQ(GetOutput(0)->shape(), TensorShape({8, 16, 1}));
+}
+
+TEST_F(DecodeAndResizeJpegOpTest, InvalidCropWindow) {
+  MakeOp(3);
+  Status status = Run({0, 100, kHeight, kWidth}, {8, 8});
+  EXPECT_TRUE(errors::IsInvalidArgument(status)) << status;
+}
+
+}  // namespace
+}  // namespace tensorflow
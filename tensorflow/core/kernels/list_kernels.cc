@@ -92,6 +92,16 @@ Status ForwardInputOrCreateNewList(OpKernelContext* c, int32_t input_index,
                                    int32_t output_index,
                                    const TensorList& input_list,
                                    TensorList** output_list) {
+  const size_t num_elements = input_list.tensors().size();
+  return ForwardInputOrCreateNewList(c, input_index, output_index, input_list,
+                                     num_elements, num_elements, output_list);
+}
+
+Status ForwardInputOrCreateNewList(OpKernelContext* c, int32_t input_index,
+                                   int32_t output_index,
+                                   const TensorList& input_list,
+                                   size_t num_elements, size_t capacity,
+                                   TensorList** output_list) {
   // Attempt to forward the input tensor to the output if possible.
   std::unique_ptr<Tensor> maybe_output = c->forward_input(
       input_index, output_index, DT_VARIANT, TensorShape{},
@@ -109,6 +119,9 @@ Status ForwardInputOrCreateNewList(OpKernelContext* c, int32_t input_index,
     if (tmp_out->RefCountIsOne()) {
       // Woohoo, forwarding succeeded!
       c->set_output(output_index, *output_tensor);
+      if (num_elements < tmp_out->tensors().size()) {
+        tmp_out->tensors().resize(num_elements);
+      }
       *output_list = tmp_out;
       return Status::OK();
     }
@@ -120,7 +133,7 @@ Status ForwardInputOrCreateNewList(OpKernelContext* c, int32_t input_index,
   attr.set_on_host(true);
   TF_RETURN_IF_ERROR(
       c->allocate_output(output_index, {}, &output_tensor, attr));
-  output_tensor->scalar<Variant>()() = input_list.Copy();
+  output_tensor->scalar<Variant>()() = input_list.Copy(num_elements, capacity);
 
   *output_list = output_tensor->scalar<Variant>()().get<TensorList>();
   return Status::OK();
@@ -213,8 +226,12 @@ class TensorListPushBack : public OpKernel {
                                   " max_num_elements: ", l->max_num_elements));
     }
 
+    // Leave room for the new element in case the list has to be copied.
+    const size_t num_elements = l->tensors().size();
     TensorList* output_list = nullptr;
-    OP_REQUIRES_OK(c, ForwardInputOrCreateNewList(c, 0, 0, *l, &output_list));
+    OP_REQUIRES_OK(c, ForwardInputOrCreateNewList(c, 0, 0, *l, num_elements,
+                                                  num_elements + 1,
+                                                  &output_list));
     output_list->tensors().push_back(input);
   }
 
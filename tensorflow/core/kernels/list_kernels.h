@@ -67,6 +67,16 @@ Status ForwardInputOrCreateNewList(OpKernelContext* c, int32_t input_index,
                                    const TensorList& input_list,
                                    TensorList** output_list);
 
+// Same as above, but `output_list` only holds the first `num_elements` tensors
+// of `input_list`. If the input can't be forwarded, only those are copied,
+// into a list with room for `capacity` tensors. This keeps kernels that shrink
+// or grow the list from copying more than they need.
+Status ForwardInputOrCreateNewList(OpKernelContext* c, int32_t input_index,
+                                   int32_t output_index,
+                                   const TensorList& input_list,
+                                   size_t num_elements, size_t capacity,
+                                   TensorList** output_list);
+
 // TODO(penporn): Move this to a proper place.
 inline bool IsPluggableDevice(OpKernelContext* c) {
   return c->op_device_context() && c->op_device_context()->IsPluggableDevice();
@@ -369,9 +379,10 @@ class TensorListPopBack : public OpKernel {
       SetZero<Device, T>(c, *result);
     }
 
+    const size_t num_elements = l->tensors().size() - 1;
     TensorList* output_list = nullptr;
-    OP_REQUIRES_OK(c, ForwardInputOrCreateNewList(c, 0, 0, *l, &output_list));
-    output_list->tensors().pop_back();
+    OP_REQUIRES_OK(c, ForwardInputOrCreateNewList(c, 0, 0, *l, num_elements,
+                                                  num_elements, &output_list));
   }
 
  private:
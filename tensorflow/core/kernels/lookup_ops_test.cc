@@ -15,16 +15,22 @@ limitations under the License.
 
 // Tests kernels of lookup ops.
 
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
 #include "tensorflow/core/framework/fake_input.h"
 #include "tensorflow/core/framework/lookup_interface.h"
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/shape_inference_testutil.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/graph/testlib.h"
 #include "tensorflow/core/kernels/lookup_table_op.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 
 namespace tensorflow {
 namespace {
@@ -100,5 +106,133 @@ TEST_F(LookupOpsTest, AnonymousHashTable_RefCounting) {
   EXPECT_FALSE(alive);
 }
 
+TEST_F(LookupOpsTest, MutableHashTable_InsertFindRemoveImport) {
+  TF_ASSERT_OK(
+      NodeDefBuilder("mutable_hash_table", "AnonymousMutableHashTable")
+          .Attr("key_dtype", DT_INT64)
+          .Attr("value_dtype", DT_FLOAT)
+          .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  TF_ASSERT_OK(RunOpKernel());
+  ResourceHandle& handle = GetOutput(0)->scalar<ResourceHandle>()();
+  auto table_or = handle.GetResource<lookup::LookupInterface>();
+  TF_ASSERT_OK(table_or.status());
+  lookup::LookupInterface* table = table_or.ValueOrDie();
+
+  // Enough keys to populate every shard, with a duplicate key whose last
+  // value must win.
+  const int kNumKeys = 1000;
+  Tensor keys(DT_INT64, TensorShape({kNumKeys + 1}));
+  Tensor values(DT_FLOAT, TensorShape({kNumKeys + 1}));
+  for (int i = 0; i < kNumKeys; ++i) {
+    keys.vec<int64_t>()(i) = i * 16;
+    values.vec<float>()(i) = i;
+  }
+  keys.vec<int64_t>()(kNumKeys) = 0;
+  values.vec<float>()(kNumKeys) = -1;
+  TF_ASSERT_OK(table->Insert(nullptr, keys, values));
+  EXPECT_EQ(table->size(), kNumKeys);
+
+  Tensor lookup_keys = test::AsTensor<int64_t>({0, 16, 1, 15984});
+  Tensor found(DT_FLOAT, TensorShape({4}));
+  Tensor default_value = test::AsTensor<float>({-2});
+  TF_ASSERT_OK(table->Find(nullptr, lookup_keys, &found, default_value));
+  test::ExpectTensorEqual<float>(found,
+                                 test::AsTensor<float>({-1, 1, -2, 999}));
+
+  TF_ASSERT_OK(table->Remove(nullptr, test::AsTensor<int64_t>({16, 1})));
+  EXPECT_EQ(table->size(), kNumKeys - 1);
+  TF_ASSERT_OK(table->Find(nullptr, lookup_keys, &found, default_value));
+  test::ExpectTensorEqual<float>(found,
+                                 test::AsTensor<float>({-1, -2, -2, 999}));
+
+  // Importing replaces the whole contents of the table.
+  TF_ASSERT_OK(table->ImportValues(nullptr, test::AsTensor<int64_t>({1, 16}),
+                                   test::AsTensor<float>({3, 4})));
+  EXPECT_EQ(table->size(), 2);
+  TF_ASSERT_OK(table->Find(nullptr, lookup_keys, &found, default_value));
+  test::ExpectTensorEqual<float>(found, test::AsTensor<float>({-2, 4, 3, -2}));
+}
+
+TEST_F(LookupOpsTest, MappedVocabTable_Find) {
+  const string filename =
+      io::JoinPath(testing::TmpDir(), "mapped_vocab_table.vocab");
+  TF_ASSERT_OK(lookup::WriteMappedVocab(
+      Env::Default(), filename, test::AsTensor<tstring>({"b", "a", "c"}),
+      test::AsTensor<int64_t>({2, 1, 3})));
+  TF_ASSERT_OK(NodeDefBuilder("mapped_vocab_table", "MappedVocabTable")
+                   .Attr("filename", filename)
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  TF_ASSERT_OK(RunOpKernel());
+  lookup::LookupInterface* table;
+  TF_ASSERT_OK(LookupResource(context_.get(),
+                              GetOutput(0)->scalar<ResourceHandle>()(),
+                              &table));
+  core::ScopedUnref unref(table);
+  EXPECT_EQ(table->size(), 3);
+
+  Tensor found(DT_INT64, TensorShape({4}));
+  TF_ASSERT_OK(table->Find(nullptr,
+                           test::AsTensor<tstring>({"c", "d", "a", ""}),
+                           &found, test::AsTensor<int64_t>({-1})));
+  test::ExpectTensorEqual<int64_t>(found,
+                                   test::AsTensor<int64_t>({3, -1, 1, -1}));
+  Status s = table->Insert(nullptr, test::AsTensor<tstring>({"d"}),
+                           test::AsTensor<int64_t>({4}));
+  EXPECT_TRUE(errors::IsUnimplemented(s)) << s;
+}
+
+// Runs `num_finds` concurrent lookups of `num_keys` keys on one table, next to
+// an insert of the same keys.
+static void BM_MutableHashTableFind(::testing::benchmark::State& state) {
+  const int num_keys = state.range(0);
+  const int num_finds = state.range(1);
+
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor keys(DT_INT64, TensorShape({num_keys}));
+  Tensor values(DT_INT64, TensorShape({num_keys}));
+  for (int i = 0; i < num_keys; ++i) {
+    keys.vec<int64_t>()(i) = i * 7;
+    values.vec<int64_t>()(i) = i;
+  }
+  Tensor default_value(DT_INT64, TensorShape({}));
+  default_value.scalar<int64_t>()() = -1;
+
+  Node* table;
+  TF_CHECK_OK(NodeBuilder(g->NewName("table"), "MutableHashTableV2")
+                  .Attr("shared_name", "bm_mutable_hash_table")
+                  .Attr("key_dtype", DT_INT64)
+                  .Attr("value_dtype", DT_INT64)
+                  .Finalize(g, &table));
+  Node* keys_node = test::graph::Constant(g, keys);
+  Node* insert;
+  TF_CHECK_OK(NodeBuilder(g->NewName("insert"), "LookupTableInsertV2")
+                  .Input(table)
+                  .Input(keys_node)
+                  .Input(test::graph::Constant(g, values))
+                  .Finalize(g, &insert));
+  Node* default_node = test::graph::Constant(g, default_value);
+  for (int i = 0; i < num_finds; ++i) {
+    Node* find;
+    TF_CHECK_OK(NodeBuilder(g->NewName("find"), "LookupTableFindV2")
+                    .Input(table)
+                    .Input(keys_node)
+                    .Input(default_node)
+                    .Finalize(g, &find));
+  }
+
+  test::Benchmark("cpu", g, /*old_benchmark_api*/ false).Run(state);
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          num_keys * num_finds);
+}
+
+BENCHMARK(BM_MutableHashTableFind)
+    ->UseRealTime()
+    ->ArgPair(1000, 1)
+    ->ArgPair(1000, 16)
+    ->ArgPair(100000, 1)
+    ->ArgPair(100000, 16);
+
 }  // namespace
 }  // namespace tensorflow
@@ -16,9 +16,11 @@ limitations under the License.
 #include "tensorflow/core/kernels/lookup_table_op.h"
 #define EIGEN_USE_THREADS
 
+#include <array>
 #include <string>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/types.h"
@@ -36,6 +38,185 @@ std::string UniqueNodeName(const std::string& base) {
   return strings::StrCat(base, "/", counter.fetch_add(1), "/", random::New64());
 }
 
+MappedVocabTable::MappedVocabTable(OpKernelContext* ctx, OpKernel* kernel) {
+  string filename;
+  OP_REQUIRES_OK(ctx, GetNodeAttr(kernel->def(), "filename", &filename));
+  OP_REQUIRES_OK(ctx, Init(ctx->env(), filename));
+}
+
+Status MappedVocabTable::Init(Env* env, const string& filename) {
+  filename_ = filename;
+  return vocab_.Load(env, filename);
+}
+
+Status MappedVocabTable::AsGraphDef(GraphDefBuilder* builder,
+                                    Node** out) const {
+  // The table is recreated from its file, like a HashTable is recreated by its
+  // initializer.
+  *out = ops::SourceOp(
+      "MappedVocabTable",
+      builder->opts()
+          .WithName(UniqueNodeName("MappedVocabTableFromGraphDef"))
+          .WithAttr("filename", filename_)
+          .WithAttr("use_node_name_sharing", true));
+  return Status::OK();
+}
+
+Status MappedVocabTable::Find(OpKernelContext* ctx, const Tensor& keys,
+                              Tensor* values, const Tensor& default_value) {
+  const int64_t default_val = default_value.flat<int64_t>()(0);
+  const auto key_values = keys.flat<tstring>();
+  auto value_values = values->flat<int64_t>();
+  for (int64_t i = 0; i < key_values.size(); ++i) {
+    const tstring& key = key_values(i);
+    int64_t value;
+    value_values(i) = vocab_.Find(StringPiece(key.data(), key.size()), &value)
+                          ? value
+                          : default_val;
+  }
+  return Status::OK();
+}
+
+Status MappedVocabTable::ExportValues(OpKernelContext* ctx) {
+  const int64_t size = vocab_.size();
+  Tensor* keys;
+  Tensor* values;
+  TF_RETURN_IF_ERROR(
+      ctx->allocate_output("keys", TensorShape({size}), &keys));
+  TF_RETURN_IF_ERROR(
+      ctx->allocate_output("values", TensorShape({size}), &values));
+  auto keys_data = keys->flat<tstring>();
+  auto values_data = values->flat<int64_t>();
+  for (int64_t i = 0; i < size; ++i) {
+    keys_data(i) = string(vocab_.key(i));
+    values_data(i) = vocab_.value(i);
+  }
+  return Status::OK();
+}
+
+// Hash map split into shards that each have their own mutex.  Operations on
+// a batch of keys group the keys by shard and take the locks of all the shards
+// they touch, in shard order, before accessing any of them.  Batches therefore
+// stay atomic with respect to each other, as with a single mutex, while
+// concurrent lookups mostly acquire distinct mutexes and an insert only blocks
+// the lookups that touch the same shards.
+template <class K, class V>
+class ShardedHashMap {
+ public:
+  using Map = std::unordered_map<K, V>;
+
+  size_t size() const {
+    size_t size = 0;
+    for (const Shard& shard : shards_) {
+      tf_shared_lock l(shard.mu);
+      size += shard.map.size();
+    }
+    return size;
+  }
+
+  // Calls `fn(map, i)` for every position `i` of `keys`, where `map` is the
+  // shard holding keys(i), with the locks of all shards touched by `keys` held
+  // in shared mode.
+  template <typename Fn>
+  void ForEachKey(const typename TTypes<K>::ConstFlat& keys,
+                  Fn fn) const TF_NO_THREAD_SAFETY_ANALYSIS {
+    std::vector<int64_t> offsets, positions;
+    GroupByShard(keys, &offsets, &positions);
+    std::vector<tf_shared_lock> locks;
+    locks.reserve(kNumShards);
+    for (int s = 0; s < kNumShards; ++s) {
+      if (offsets[s] != offsets[s + 1]) locks.emplace_back(shards_[s].mu);
+    }
+    for (int s = 0; s < kNumShards; ++s) {
+      const Shard& shard = shards_[s];
+      for (int64_t p = offsets[s]; p < offsets[s + 1]; ++p) {
+        fn(shard.map, positions[p]);
+      }
+    }
+  }
+
+  // Calls `fn(&map, i)` for every position `i` of `keys`, in order for the
+  // positions of equal keys, with the locks of all shards touched by `keys`
+  // held exclusively, so that readers see either none or all of the update.
+  // If `clear` is true, all shards are locked and cleared first.
+  template <typename Fn>
+  void MutateEachKey(bool clear, const typename TTypes<K>::ConstFlat& keys,
+                     Fn fn) TF_NO_THREAD_SAFETY_ANALYSIS {
+    std::vector<int64_t> offsets, positions;
+    GroupByShard(keys, &offsets, &positions);
+    std::vector<mutex_lock> locks;
+    locks.reserve(kNumShards);
+    for (int s = 0; s < kNumShards; ++s) {
+      if (clear || offsets[s] != offsets[s + 1]) {
+        locks.emplace_back(shards_[s].mu);
+        if (clear) shards_[s].map.clear();
+      }
+    }
+    for (int s = 0; s < kNumShards; ++s) {
+      Shard& shard = shards_[s];
+      for (int64_t p = offsets[s]; p < offsets[s + 1]; ++p) {
+        fn(&shard.map, positions[p]);
+      }
+    }
+  }
+
+  // Calls `fn(maps)` with the locks of all shards held in shared mode, so that
+  // `maps` is a consistent snapshot of the table.
+  template <typename Fn>
+  auto WithAllShards(Fn fn) const TF_NO_THREAD_SAFETY_ANALYSIS {
+    std::vector<tf_shared_lock> locks;
+    locks.reserve(kNumShards);
+    std::vector<const Map*> maps;
+    maps.reserve(kNumShards);
+    for (const Shard& shard : shards_) {
+      locks.emplace_back(shard.mu);
+      maps.push_back(&shard.map);
+    }
+    return fn(maps);
+  }
+
+ private:
+  static constexpr int kShardBits = 4;
+  static constexpr int kNumShards = 1 << kShardBits;
+
+  struct Shard {
+    mutable mutex mu;
+    Map map TF_GUARDED_BY(mu);
+  };
+
+  static int ShardOf(const K& key) {
+    // Fibonacci hashing spreads the low-entropy std::hash of integer keys.
+    const uint64 hash =
+        static_cast<uint64>(std::hash<K>()(key)) * 0x9E3779B97F4A7C15ull;
+    return static_cast<int>(hash >> (64 - kShardBits));
+  }
+
+  // Counting-sorts the positions of `keys` by shard: the positions of the
+  // keys of shard s are (*positions)[(*offsets)[s], (*offsets)[s + 1]), in
+  // increasing order.
+  static void GroupByShard(const typename TTypes<K>::ConstFlat& keys,
+                           std::vector<int64_t>* offsets,
+                           std::vector<int64_t>* positions) {
+    const int64_t num_keys = keys.size();
+    std::vector<uint8> shard_of(num_keys);
+    offsets->assign(kNumShards + 1, 0);
+    for (int64_t i = 0; i < num_keys; ++i) {
+      shard_of[i] = ShardOf(SubtleMustCopyIfIntegral(keys(i)));
+      ++(*offsets)[shard_of[i] + 1];
+    }
+    for (int s = 0; s < kNumShards; ++s) {
+      (*offsets)[s + 1] += (*offsets)[s];
+    }
+    std::vector<int64_t> next(offsets->begin(), offsets->end() - 1);
+    positions->resize(num_keys);
+    for (int64_t i = 0; i < num_keys; ++i) {
+      (*positions)[next[shard_of[i]]++] = i;
+    }
+  }
+
+  std::array<Shard, kNumShards> shards_;
+};
+
 // Lookup table that wraps an unordered_map, where the key and value data type
 // is specified. Each individual value must be a scalar. If vector values are
 // required, use MutableHashTableOfTensors.
@@ -55,10 +236,7 @@ class MutableHashTableOfScalars final : public LookupInterface {
  public:
   MutableHashTableOfScalars(OpKernelContext* ctx, OpKernel* kernel) {}
 
-  size_t size() const override {
-    tf_shared_lock l(mu_);
-    return table_.size();
-  }
+  size_t size() const override { return table_.size(); }
 
   Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
               const Tensor& default_value) override {
@@ -70,8 +248,7 @@ class MutableHashTableOfScalars final : public LookupInterface {
     int64_t default_total = default_flat.size();
     bool is_full_size_default = (total == default_total);
 
-    tf_shared_lock l(mu_);
-    for (int64_t i = 0; i < key_values.size(); ++i) {
+    table_.ForEachKey(key_values, [&](const Map& table, int64_t i) {
       // is_full_size_default is true:
       //   Each key has an independent default value, key_values(i)
       //   corresponding uses default_flat(i) as its default value.
@@ -79,9 +256,9 @@ class MutableHashTableOfScalars final : public LookupInterface {
       // is_full_size_default is false:
       //   All keys will share the default_flat(0) as default value.
       value_values(i) = gtl::FindWithDefault(
-          table_, SubtleMustCopyIfIntegral(key_values(i)),
+          table, SubtleMustCopyIfIntegral(key_values(i)),
           is_full_size_default ? default_flat(i) : default_flat(0));
-    }
+    });
 
     return Status::OK();
   }
@@ -90,14 +267,10 @@ class MutableHashTableOfScalars final : public LookupInterface {
     const auto key_values = keys.flat<K>();
     const auto value_values = values.flat<V>();
 
-    mutex_lock l(mu_);
-    if (clear) {
-      table_.clear();
-    }
-    for (int64_t i = 0; i < key_values.size(); ++i) {
-      gtl::InsertOrUpdate(&table_, SubtleMustCopyIfIntegral(key_values(i)),
+    table_.MutateEachKey(clear, key_values, [&](Map* table, int64_t i) {
+      gtl::InsertOrUpdate(table, SubtleMustCopyIfIntegral(key_values(i)),
                           SubtleMustCopyIfIntegral(value_values(i)));
-    }
+    });
     return Status::OK();
   }
 
@@ -109,10 +282,10 @@ class MutableHashTableOfScalars final : public LookupInterface {
   Status Remove(OpKernelContext* ctx, const Tensor& keys) override {
     const auto key_values = keys.flat<K>();
 
-    mutex_lock l(mu_);
-    for (int64_t i = 0; i < key_values.size(); ++i) {
-      table_.erase(SubtleMustCopyIfIntegral(key_values(i)));
-    }
+    table_.MutateEachKey(
+        /*clear=*/false, key_values, [&](Map* table, int64_t i) {
+          table->erase(SubtleMustCopyIfIntegral(key_values(i)));
+        });
     return Status::OK();
   }
 
@@ -122,17 +295,18 @@ class MutableHashTableOfScalars final : public LookupInterface {
   }
 
   Status ExportValues(OpKernelContext* ctx) override {
-    tf_shared_lock l(mu_);
-    int64_t size = table_.size();
-
-    Tensor* keys;
-    Tensor* values;
-    TF_RETURN_IF_ERROR(
-        ctx->allocate_output("keys", TensorShape({size}), &keys));
-    TF_RETURN_IF_ERROR(
-        ctx->allocate_output("values", TensorShape({size}), &values));
-    ExportKeysAndValues(keys, values);
-    return Status::OK();
+    return table_.WithAllShards([&](const std::vector<const Map*>& tables) {
+      int64_t size = TotalSize(tables);
+
+      Tensor* keys;
+      Tensor* values;
+      TF_RETURN_IF_ERROR(
+          ctx->allocate_output("keys", TensorShape({size}), &keys));
+      TF_RETURN_IF_ERROR(
+          ctx->allocate_output("values", TensorShape({size}), &values));
+      ExportKeysAndValues(tables, keys, values);
+      return Status::OK();
+    });
   }
 
   DataType key_dtype() const override { return DataTypeToEnum<K>::v(); }
@@ -145,24 +319,29 @@ class MutableHashTableOfScalars final : public LookupInterface {
 
   int64_t MemoryUsed() const override {
     int64_t ret = 0;
-    tf_shared_lock l(mu_);
-    for (unsigned i = 0; i < table_.bucket_count(); ++i) {
-      size_t bucket_size = table_.bucket_size(i);
-      if (bucket_size == 0) {
-        ret++;
-      } else {
-        ret += bucket_size;
+    table_.WithAllShards([&](const std::vector<const Map*>& tables) {
+      for (const Map* table : tables) {
+        for (unsigned i = 0; i < table->bucket_count(); ++i) {
+          size_t bucket_size = table->bucket_size(i);
+          if (bucket_size == 0) {
+            ret++;
+          } else {
+            ret += bucket_size;
+          }
+        }
       }
-    }
+    });
     return sizeof(MutableHashTableOfScalars) + ret;
   }
 
   Status AsGraphDef(GraphDefBuilder* builder, Node** out) const override {
-    tf_shared_lock l(mu_);
-    int64_t size = table_.size();
-    Tensor keys(key_dtype(), TensorShape({size}));
-    Tensor values(value_dtype(), TensorShape({size}));
-    ExportKeysAndValues(&keys, &values);
+    Tensor keys, values;
+    table_.WithAllShards([&](const std::vector<const Map*>& tables) {
+      int64_t size = TotalSize(tables);
+      keys = Tensor(key_dtype(), TensorShape({size}));
+      values = Tensor(value_dtype(), TensorShape({size}));
+      ExportKeysAndValues(tables, &keys, &values);
+    });
 
     // We set use_node_name_sharing with a unique node name so that the resource
     // can outlive the MutableHashTableV2 kernel. This means that the lifetime
@@ -195,21 +374,30 @@ class MutableHashTableOfScalars final : public LookupInterface {
   }
 
  private:
-  // Writes all keys and values into `keys` and `values`. `keys` and `values`
-  // must point to tensors of size `table_.size()`.
-  void ExportKeysAndValues(Tensor* keys, Tensor* values) const
-      TF_SHARED_LOCKS_REQUIRED(mu_) {
+  using Map = typename ShardedHashMap<K, V>::Map;
+
+  static int64_t TotalSize(const std::vector<const Map*>& tables) {
+    int64_t size = 0;
+    for (const Map* table : tables) size += table->size();
+    return size;
+  }
+
+  // Writes all keys and values of `tables` into `keys` and `values`. `keys`
+  // and `values` must point to tensors of size `TotalSize(tables)`.
+  void ExportKeysAndValues(const std::vector<const Map*>& tables, Tensor* keys,
+                           Tensor* values) const {
     auto keys_data = keys->flat<K>();
     auto values_data = values->flat<V>();
     int64_t i = 0;
-    for (auto it = table_.begin(); it != table_.end(); ++it, ++i) {
-      keys_data(i) = it->first;
-      values_data(i) = it->second;
+    for (const Map* table : tables) {
+      for (auto it = table->begin(); it != table->end(); ++it, ++i) {
+        keys_data(i) = it->first;
+        values_data(i) = it->second;
+      }
     }
   }
 
-  mutable mutex mu_;
-  std::unordered_map<K, V> table_ TF_GUARDED_BY(mu_);
+  ShardedHashMap<K, V> table_;
 };
 
 // Lookup table that wraps an unordered_map. Behaves identical to
@@ -226,10 +414,7 @@ class MutableHashTableOfTensors final : public LookupInterface {
                                 value_shape_.DebugString()));
   }
 
-  size_t size() const override {
-    tf_shared_lock l(mu_);
-    return table_.size();
-  }
+  size_t size() const override { return table_.size(); }
 
   Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
               const Tensor& default_value) override {
@@ -242,10 +427,9 @@ class MutableHashTableOfTensors final : public LookupInterface {
     int64_t default_total = default_flat.size();
     bool is_full_size_default = (total == default_total);
 
-    tf_shared_lock l(mu_);
-    for (int64_t i = 0; i < key_values.size(); ++i) {
-      ValueArray* value_vec =
-          gtl::FindOrNull(table_, SubtleMustCopyIfIntegral(key_values(i)));
+    table_.ForEachKey(key_values, [&](const Map& table, int64_t i) {
+      const ValueArray* value_vec =
+          gtl::FindOrNull(table, SubtleMustCopyIfIntegral(key_values(i)));
       if (value_vec != nullptr) {
         for (int64_t j = 0; j < value_dim; j++) {
           value_values(i, j) = value_vec->at(j);
@@ -262,7 +446,7 @@ class MutableHashTableOfTensors final : public LookupInterface {
               is_full_size_default ? default_flat(i, j) : default_flat(0, j);
         }
       }
-    }
+    });
 
     return Status::OK();
   }
@@ -272,19 +456,15 @@ class MutableHashTableOfTensors final : public LookupInterface {
     const auto value_values = values.flat_inner_dims<V, 2>();
     int64_t value_dim = value_shape_.dim_size(0);
 
-    mutex_lock l(mu_);
-    if (clear) {
-      table_.clear();
-    }
-    for (int64_t i = 0; i < key_values.size(); ++i) {
+    table_.MutateEachKey(clear, key_values, [&](Map* table, int64_t i) {
       ValueArray value_vec;
       for (int64_t j = 0; j < value_dim; j++) {
         V value = value_values(i, j);
         value_vec.push_back(value);
       }
-      gtl::InsertOrUpdate(&table_, SubtleMustCopyIfIntegral(key_values(i)),
+      gtl::InsertOrUpdate(table, SubtleMustCopyIfIntegral(key_values(i)),
                           value_vec);
-    }
+    });
     return Status::OK();
   }
 
@@ -296,10 +476,10 @@ class MutableHashTableOfTensors final : public LookupInterface {
   Status Remove(OpKernelContext* ctx, const Tensor& keys) override {
     const auto key_values = keys.flat<K>();
 
-    mutex_lock l(mu_);
-    for (int64_t i = 0; i < key_values.size(); ++i) {
-      table_.erase(SubtleMustCopyIfIntegral(key_values(i)));
-    }
+    table_.MutateEachKey(
+        /*clear=*/false, key_values, [&](Map* table, int64_t i) {
+          table->erase(SubtleMustCopyIfIntegral(key_values(i)));
+        });
     return Status::OK();
   }
 
@@ -309,18 +489,19 @@ class MutableHashTableOfTensors final : public LookupInterface {
   }
 
   Status ExportValues(OpKernelContext* ctx) override {
-    tf_shared_lock l(mu_);
-    int64_t size = table_.size();
-    int64_t value_dim = value_shape_.dim_size(0);
-
-    Tensor* keys;
-    Tensor* values;
-    TF_RETURN_IF_ERROR(
-        ctx->allocate_output("keys", TensorShape({size}), &keys));
-    TF_RETURN_IF_ERROR(ctx->allocate_output(
-        "values", TensorShape({size, value_dim}), &values));
-    ExportKeysAndValues(keys, values);
-    return Status::OK();
+    return table_.WithAllShards([&](const std::vector<const Map*>& tables) {
+      int64_t size = TotalSize(tables);
+      int64_t value_dim = value_shape_.dim_size(0);
+
+      Tensor* keys;
+      Tensor* values;
+      TF_RETURN_IF_ERROR(
+          ctx->allocate_output("keys", TensorShape({size}), &keys));
+      TF_RETURN_IF_ERROR(ctx->allocate_output(
+          "values", TensorShape({size, value_dim}), &values));
+      ExportKeysAndValues(tables, keys, values);
+      return Status::OK();
+    });
   }
 
   DataType key_dtype() const override { return DataTypeToEnum<K>::v(); }
@@ -333,24 +514,30 @@ class MutableHashTableOfTensors final : public LookupInterface {
 
   int64_t MemoryUsed() const override {
     int64_t ret = 0;
-    tf_shared_lock l(mu_);
-    for (unsigned i = 0; i < table_.bucket_count(); ++i) {
-      size_t bucket_size = table_.bucket_size(i);
-      if (bucket_size == 0) {
-        ret++;
-      } else {
-        ret += bucket_size;
+    table_.WithAllShards([&](const std::vector<const Map*>& tables) {
+      for (const Map* table : tables) {
+        for (unsigned i = 0; i < table->bucket_count(); ++i) {
+          size_t bucket_size = table->bucket_size(i);
+          if (bucket_size == 0) {
+            ret++;
+          } else {
+            ret += bucket_size;
+          }
+        }
       }
-    }
+    });
     return sizeof(MutableHashTableOfTensors) + ret;
   }
 
   Status AsGraphDef(GraphDefBuilder* builder, Node** out) const override {
-    tf_shared_lock l(mu_);
-    int64_t size = table_.size();
-    Tensor keys(key_dtype(), TensorShape({size}));
-    Tensor values(value_dtype(), TensorShape({size, value_shape_.dim_size(0)}));
-    ExportKeysAndValues(&keys, &values);
+    Tensor keys, values;
+    table_.WithAllShards([&](const std::vector<const Map*>& tables) {
+      int64_t size = TotalSize(tables);
+      keys = Tensor(key_dtype(), TensorShape({size}));
+      values =
+          Tensor(value_dtype(), TensorShape({size, value_shape_.dim_size(0)}));
+      ExportKeysAndValues(tables, &keys, &values);
+    });
 
     // We set use_node_name_sharing with a unique node name so that the resource
     // can outlive the MutableHashTableOfTensorsV2 kernel. This means that the
@@ -384,28 +571,36 @@ class MutableHashTableOfTensors final : public LookupInterface {
   }
 
  private:
-  // Writes all keys and values into `keys` and `values`. `keys` and `values`
-  // must point to tensors of size `table_.size()`.
-  void ExportKeysAndValues(Tensor* keys, Tensor* values) const
-      TF_SHARED_LOCKS_REQUIRED(mu_) {
+  typedef gtl::InlinedVector<V, 4> ValueArray;
+  using Map = typename ShardedHashMap<K, ValueArray>::Map;
+
+  static int64_t TotalSize(const std::vector<const Map*>& tables) {
+    int64_t size = 0;
+    for (const Map* table : tables) size += table->size();
+    return size;
+  }
+
+  // Writes all keys and values of `tables` into `keys` and `values`. `keys`
+  // and `values` must point to tensors of size `TotalSize(tables)`.
+  void ExportKeysAndValues(const std::vector<const Map*>& tables, Tensor* keys,
+                           Tensor* values) const {
     int64_t value_dim = value_shape_.dim_size(0);
     auto keys_data = keys->flat<K>();
     auto values_data = values->matrix<V>();
     int64_t i = 0;
-    for (auto it = table_.begin(); it != table_.end(); ++it, ++i) {
-      K key = it->first;
-      ValueArray value = it->second;
-      keys_data(i) = key;
-      for (int64_t j = 0; j < value_dim; j++) {
-        values_data(i, j) = value[j];
+    for (const Map* table : tables) {
+      for (auto it = table->begin(); it != table->end(); ++it, ++i) {
+        keys_data(i) = it->first;
+        const ValueArray& value = it->second;
+        for (int64_t j = 0; j < value_dim; j++) {
+          values_data(i, j) = value[j];
+        }
       }
     }
   }
 
   TensorShape value_shape_;
-  mutable mutex mu_;
-  typedef gtl::InlinedVector<V, 4> ValueArray;
-  std::unordered_map<K, ValueArray> table_ TF_GUARDED_BY(mu_);
+  ShardedHashMap<K, ValueArray> table_;
 };
 
 namespace {
@@ -1118,6 +1313,36 @@ REGISTER_KERNEL(tstring, tstring);
 
 #undef REGISTER_KERNEL
 
+REGISTER_KERNEL_BUILDER(
+    Name("MappedVocabTable").Device(DEVICE_CPU),
+    LookupTableOp<lookup::MappedVocabTable, tstring, int64_t>);
+
+// Op that writes a vocabulary file for MappedVocabTable.
+class WriteMappedVocabOp : public OpKernel {
+ public:
+  explicit WriteMappedVocabOp(OpKernelConstruction* ctx) : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor& filename = ctx->input(0);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(filename.shape()),
+                errors::InvalidArgument("filename must be a scalar, got shape ",
+                                        filename.shape().DebugString()));
+    const Tensor& keys = ctx->input(1);
+    const Tensor& values = ctx->input(2);
+    OP_REQUIRES(ctx, keys.shape() == values.shape(),
+                errors::InvalidArgument(
+                    "keys and values must have the same shape, got ",
+                    keys.shape().DebugString(), " and ",
+                    values.shape().DebugString()));
+    OP_REQUIRES_OK(ctx, lookup::WriteMappedVocab(
+                            ctx->env(), filename.scalar<tstring>()(), keys,
+                            values));
+  }
+};
+
+REGISTER_KERNEL_BUILDER(Name("WriteMappedVocab").Device(DEVICE_CPU),
+                        WriteMappedVocabOp);
+
 // Register the MutableHashTable op.
 #define REGISTER_KERNEL(key_dtype, value_dtype)                                \
   REGISTER_KERNEL_BUILDER(                                                     \
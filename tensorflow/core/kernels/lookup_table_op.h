@@ -25,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/graph/graph_def_builder.h"
 #include "tensorflow/core/kernels/lookup_util.h"
+#include "tensorflow/core/kernels/mapped_vocab.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
@@ -343,6 +344,55 @@ class HashTable : public InitializableLookupTable {
   absl::flat_hash_map<K, V> table_;
 };
 
+// Read-only string -> int64 table backed by a MappedVocab file, which is named
+// by the "filename" attr of the kernel that creates the table. Unlike
+// HashTable, it is ready as soon as it is created, and its entries stay in
+// the memory-mapped file instead of a hash map.
+class MappedVocabTable : public LookupInterface {
+ public:
+  MappedVocabTable(OpKernelContext* ctx, OpKernel* kernel);
+
+  // Maps `filename`. Only called once, by the constructor or by tests.
+  Status Init(Env* env, const string& filename);
+
+  Status AsGraphDef(GraphDefBuilder* builder, Node** out) const override;
+
+  size_t size() const override { return vocab_.size(); }
+
+  Status Find(OpKernelContext* ctx, const Tensor& keys, Tensor* values,
+              const Tensor& default_value) override;
+
+  Status Insert(OpKernelContext* ctx, const Tensor& keys,
+                const Tensor& values) override {
+    return errors::Unimplemented("MappedVocabTable is read-only.");
+  }
+
+  Status Remove(OpKernelContext* ctx, const Tensor& keys) override {
+    return errors::Unimplemented("MappedVocabTable is read-only.");
+  }
+
+  Status ExportValues(OpKernelContext* ctx) override;
+
+  Status ImportValues(OpKernelContext* ctx, const Tensor& keys,
+                      const Tensor& values) override {
+    return errors::Unimplemented("MappedVocabTable is read-only.");
+  }
+
+  DataType key_dtype() const override { return DT_STRING; }
+
+  DataType value_dtype() const override { return DT_INT64; }
+
+  TensorShape key_shape() const override { return TensorShape(); }
+
+  TensorShape value_shape() const override { return TensorShape(); }
+
+  int64_t MemoryUsed() const override { return vocab_.MemoryUsed(); }
+
+ private:
+  string filename_;
+  MappedVocab vocab_;
+};
+
 }  // namespace lookup
 
 }  // namespace tensorflow
@@ -15,6 +15,10 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/lookup_util.h"
 
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
 #include "tensorflow/core/framework/function_handle_cache.h"
 #include "tensorflow/core/framework/lookup_interface.h"
 #include "tensorflow/core/framework/op_requires.h"
@@ -23,7 +27,9 @@ limitations under the License.
 #include "tensorflow/core/graph/graph_def_builder.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/io/inputbuffer.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 namespace lookup {
@@ -35,6 +41,10 @@ using InitializerSerializer =
 static const int kInputBufferSize = 1 * 1024 * 1024; /* bytes */
 static const int kLineNumber = -1;
 static const int kWholeLine = -2;
+// Text files of at least kParallelLoadMinBytes bytes are read and parsed in
+// chunks of kParallelLoadChunkBytes bytes by several threads.
+static const int64_t kParallelLoadMinBytes = 16 * 1024 * 1024;
+static const int64_t kParallelLoadChunkBytes = 1 * 1024 * 1024;
 
 Status GetNumLinesInTextFile(Env* env, const string& vocab_file,
                              int64_t* num_lines) {
@@ -56,6 +66,61 @@ Status GetNumLinesInTextFile(Env* env, const string& vocab_file,
   return Status::OK();
 }
 
+// Sets element `position` of `tensor` from `line` or `tokens`, the fields of
+// line number `line_number`, depending on `index`. The value is transformed to
+// the data type of `tensor`.
+Status SetValueFromLine(const string& line, const std::vector<string>& tokens,
+                        int64_t index, int64_t line_number, int64_t offset,
+                        int64_t position, Tensor* tensor) {
+  if (index == kLineNumber) {
+    tensor->flat<int64_t>()(position) = line_number + offset;
+    return Status::OK();
+  }
+  const string& token = (index == kWholeLine) ? line : tokens[index];
+  const DataType& dtype = tensor->dtype();
+  switch (dtype) {
+    case DT_INT32: {
+      int32_t value;
+      if (!strings::safe_strto32(token.c_str(), &value)) {
+        return errors::InvalidArgument("Field ", token, " in line ",
+                                       line_number, " is not a valid int32.");
+      }
+      tensor->flat<int32>()(position) = value + offset;
+    } break;
+    case DT_INT64: {
+      int64_t value;
+      if (!strings::safe_strto64(token.c_str(), &value)) {
+        return errors::InvalidArgument("Field ", token, " in line ",
+                                       line_number, " is not a valid int64.");
+      }
+      tensor->flat<int64_t>()(position) = value;
+    } break;
+    case DT_FLOAT: {
+      float value;
+      if (!strings::safe_strtof(token.c_str(), &value)) {
+        return errors::InvalidArgument("Field ", token, " in line ",
+                                       line_number, " is not a valid float.");
+      }
+      tensor->flat<float>()(position) = value;
+    } break;
+    case DT_DOUBLE: {
+      double value;
+      if (!strings::safe_strtod(token.c_str(), &value)) {
+        return errors::InvalidArgument("Field ", token, " in line ",
+                                       line_number, " is not a valid double.");
+      }
+      tensor->flat<double>()(position) = value;
+    } break;
+    case DT_STRING:
+      tensor->flat<tstring>()(position) = token;
+      break;
+    default:
+      return errors::InvalidArgument("Data type ", DataTypeString(dtype),
+                                     " not supported.");
+  }
+  return Status::OK();
+}
+
 // Iterator that reads a text file. Each iteration process one line, it parses
 // the line and populates the keys and values tensors used for initialization
 // with a single key and corresponding value.
@@ -207,63 +272,171 @@ class TextFileLineIterator
   // tensor 't'. The value is transformed to the given data type 'dtype'.
   Status SetValue(const string& line, const std::vector<string>& tokens,
                   int64_t index, Tensor* tensor) {
-    if (index == kLineNumber) {
-      tensor->flat<int64_t>()(0) = next_id_ + offset_;
-      return Status::OK();
-    }
-    const string& token = (index == kWholeLine) ? line : tokens[index];
-    const DataType& dtype = tensor->dtype();
-    switch (dtype) {
-      case DT_INT32: {
-        int32_t value;
-        if (!strings::safe_strto32(token.c_str(), &value)) {
-          valid_ = false;
-          return errors::InvalidArgument("Field ", token, " in line ", next_id_,
-                                         " is not a valid int32.");
-        }
-        tensor->flat<int32>()(0) = value + offset_;
-      } break;
-      case DT_INT64: {
-        int64_t value;
-        if (!strings::safe_strto64(token.c_str(), &value)) {
-          valid_ = false;
-          return errors::InvalidArgument("Field ", token, " in line ", next_id_,
-                                         " is not a valid int64.");
-        }
-        tensor->flat<int64_t>()(0) = value;
-      } break;
-      case DT_FLOAT: {
-        float value;
-        if (!strings::safe_strtof(token.c_str(), &value)) {
-          valid_ = false;
-          return errors::InvalidArgument("Field ", token, " in line ", next_id_,
-                                         " is not a valid float.");
-        }
-        tensor->flat<float>()(0) = value;
-      } break;
-      case DT_DOUBLE: {
-        double value;
-        if (!strings::safe_strtod(token.c_str(), &value)) {
-          valid_ = false;
-          return errors::InvalidArgument("Field ", token, " in line ", next_id_,
-                                         " is not a valid double.");
-        }
-        tensor->flat<double>()(0) = value;
-      } break;
-      case DT_STRING:
-        tensor->flat<tstring>()(0) = token;
-        break;
-      default:
-        valid_ = false;
-        return errors::InvalidArgument("Data type ", DataTypeString(dtype),
-                                       " not supported.");
-    }
-    return Status::OK();
+    return SetValueFromLine(line, tokens, index, next_id_, offset_,
+                            /*position=*/0, tensor);
   }
 
   TF_DISALLOW_COPY_AND_ASSIGN(TextFileLineIterator);
 };
 
+// Reads `filename` into `contents` using `pool`, one chunk per task.
+Status ReadFileInParallel(const string& filename, uint64 file_size, Env* env,
+                          thread::ThreadPool* pool, string* contents) {
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &file));
+  contents->resize(file_size);
+  const int64_t num_chunks =
+      (file_size + kParallelLoadChunkBytes - 1) / kParallelLoadChunkBytes;
+  std::vector<Status> statuses(num_chunks);
+  pool->ParallelFor(
+      num_chunks, kParallelLoadChunkBytes, [&](int64_t first, int64_t last) {
+        for (int64_t chunk = first; chunk < last; ++chunk) {
+          const uint64 begin = chunk * kParallelLoadChunkBytes;
+          const uint64 end =
+              std::min<uint64>(begin + kParallelLoadChunkBytes, file_size);
+          char* scratch = &(*contents)[begin];
+          StringPiece result;
+          Status s = file->Read(begin, end - begin, &result, scratch);
+          if (result.size() == end - begin) {
+            s = Status::OK();
+          } else if (s.ok() || errors::IsOutOfRange(s)) {
+            s = errors::DataLoss("Unexpected end of ", filename,
+                                 " at offset ", begin + result.size());
+          }
+          if (s.ok() && result.data() != scratch) {
+            memmove(scratch, result.data(), result.size());
+          }
+          statuses[chunk] = s;
+        }
+      });
+  for (const Status& s : statuses) TF_RETURN_IF_ERROR(s);
+  return Status::OK();
+}
+
+// Parses the lines of a text file the same way as TextFileLineIterator, but
+// splits the file into chunks whose lines are counted and then parsed by
+// several threads, and returns all the keys and values at once so that they
+// can be inserted into the table in a single batch.
+//
+// A line belongs to the chunk its first byte is in.
+Status ParseTextFileInParallel(const string& filename, int64_t vocab_size,
+                               char delimiter, DataType key_dtype,
+                               int64_t key_index, DataType value_dtype,
+                               int64_t value_index, int64_t offset,
+                               uint64 file_size, Env* env, Tensor* keys,
+                               Tensor* values) {
+  thread::ThreadPool pool(env, "InitializeTableFromTextFile",
+                          port::MaxParallelism());
+  string contents;
+  TF_RETURN_IF_ERROR(
+      ReadFileInParallel(filename, file_size, env, &pool, &contents));
+
+  // Calls `fn(line, end)` for each line of `chunk` until it returns false,
+  // where `end` is the position just past the line and its newline. Like
+  // InputBuffer::ReadLine, a trailing '\r' is dropped and so is a last line
+  // without a newline if it ends up empty.
+  const char* data = contents.data();
+  auto for_each_line = [&](int64_t chunk, const auto& fn) {
+    const uint64 chunk_begin = chunk * kParallelLoadChunkBytes;
+    const uint64 chunk_end =
+        std::min<uint64>(chunk_begin + kParallelLoadChunkBytes, file_size);
+    uint64 begin = chunk_begin;
+    if (begin > 0 && data[begin - 1] != '\n') {
+      const void* newline = memchr(data + begin, '\n', chunk_end - begin);
+      if (newline == nullptr) return;
+      begin = static_cast<const char*>(newline) - data + 1;
+    }
+    while (begin < chunk_end) {
+      const void* newline = memchr(data + begin, '\n', file_size - begin);
+      const uint64 line_end =
+          newline ? static_cast<const char*>(newline) - data : file_size;
+      uint64 size = line_end - begin;
+      if (size > 0 && data[line_end - 1] == '\r') --size;
+      if (newline == nullptr && size == 0) return;
+      const uint64 end = newline ? line_end + 1 : file_size;
+      if (!fn(StringPiece(data + begin, size), end)) return;
+      begin = end;
+    }
+  };
+
+  const int64_t num_chunks =
+      (file_size + kParallelLoadChunkBytes - 1) / kParallelLoadChunkBytes;
+  std::vector<int64_t> first_line(num_chunks + 1, 0);
+  pool.ParallelFor(num_chunks, kParallelLoadChunkBytes,
+                   [&](int64_t first, int64_t last) {
+                     for (int64_t chunk = first; chunk < last; ++chunk) {
+                       for_each_line(chunk, [&](StringPiece, uint64) {
+                         ++first_line[chunk + 1];
+                         return true;
+                       });
+                     }
+                   });
+  for (int64_t chunk = 0; chunk < num_chunks; ++chunk) {
+    first_line[chunk + 1] += first_line[chunk];
+  }
+  const int64_t num_lines = first_line[num_chunks];
+  int64_t num_entries = num_lines;
+  if (vocab_size != -1 && num_lines > vocab_size) {
+    LOG(WARNING) << "Truncated " << filename << " before its end at "
+                 << vocab_size << " records.";
+    num_entries = vocab_size;
+  }
+  *keys = Tensor(key_dtype, TensorShape({num_entries}));
+  *values = Tensor(value_dtype, TensorShape({num_entries}));
+
+  const bool ignore_split = std::max(key_index, value_index) < 0;
+  const auto expected_size =
+      static_cast<size_t>(std::max(key_index, value_index) + 1);
+  std::vector<Status> statuses(num_chunks);
+  auto parse_chunk = [&](int64_t chunk) {
+    int64_t line_number = first_line[chunk];
+    Status& status = statuses[chunk];
+    for_each_line(chunk, [&](StringPiece line_piece, uint64 end) {
+      if (line_number >= num_entries) return false;
+      if (line_piece.empty()) {
+        status = errors::InvalidArgument("Invalid content in ", filename,
+                                         ": empty line found at position ",
+                                         end, ".");
+        return false;
+      }
+      const string line(line_piece);
+      std::vector<string> tokens;
+      if (!ignore_split) {
+        tokens = str_util::Split(line, delimiter);
+        if (tokens.size() < expected_size) {
+          status = errors::InvalidArgument(
+              "Invalid number of columns in ", filename, " line ", line_number,
+              " (", line, ") : expected at least ", expected_size, " got ",
+              tokens.size());
+          return false;
+        }
+      }
+      status = SetValueFromLine(line, tokens, key_index, line_number, offset,
+                                line_number, keys);
+      if (status.ok()) {
+        status = SetValueFromLine(line, tokens, value_index, line_number,
+                                  offset, line_number, values);
+      }
+      ++line_number;
+      return status.ok();
+    });
+  };
+  pool.ParallelFor(num_chunks, kParallelLoadChunkBytes * 10,
+                   [&](int64_t first, int64_t last) {
+                     for (int64_t chunk = first; chunk < last; ++chunk) {
+                       parse_chunk(chunk);
+                     }
+                   });
+  // Report the error of the earliest line, as the sequential reader would.
+  for (const Status& s : statuses) TF_RETURN_IF_ERROR(s);
+  if (vocab_size != -1 && num_lines < vocab_size) {
+    return errors::InvalidArgument("Invalid vocab_size in ", filename,
+                                   ": expected ", vocab_size, " but got ",
+                                   num_lines);
+  }
+  return Status::OK();
+}
+
 Status GetTableHandle(StringPiece input_name, OpKernelContext* ctx,
                       string* container, string* table_handle) {
   {
@@ -399,21 +572,44 @@ Status InitializeTableFromTextFile(
         DataTypeString(table->value_dtype()));
   }
 
-  TextFileLineIterator iter;
-  TF_RETURN_IF_ERROR(iter.Init(filename, vocab_size, delimiter, key_dtype,
-                               key_index, value_dtype, value_index, offset,
-                               env));
   // For initialization from files, ignore if the table is already
   // initialized. The table shared name should contain the filename to
   // avoid trying to initialize the same table from the same file at the same
   // time.
-  Status s = table->Initialize(iter, std::move(serializer));
-  if (errors::IsFailedPrecondition(s) && table->is_initialized()) {
-    LOG(INFO) << "Table trying to initialize from file " << filename
-              << " is already initialized.";
-    return Status::OK();
+  auto initialize = [&](InitializableLookupTable::InitTableIterator& iter) {
+    Status s = table->Initialize(iter, std::move(serializer));
+    if (errors::IsFailedPrecondition(s) && table->is_initialized()) {
+      LOG(INFO) << "Table trying to initialize from file " << filename
+                << " is already initialized.";
+      return Status::OK();
+    }
+    return s;
+  };
+
+  // Large vocabularies are parsed in parallel and inserted in one batch, which
+  // also lets the table reserve space for all the entries up front. An already
+  // initialized table only compares its size, so it reads the file
+  // sequentially.
+  uint64 file_size = 0;
+  if (!table->is_initialized() && vocab_size != 0 &&
+      env->GetFileSize(filename, &file_size).ok() &&
+      file_size >= kParallelLoadMinBytes) {
+    Tensor keys;
+    Tensor values;
+    TF_RETURN_IF_ERROR(ParseTextFileInParallel(
+        filename, vocab_size, delimiter, key_dtype, key_index, value_dtype,
+        value_index, offset, file_size, env, &keys, &values));
+    if (keys.NumElements() > 0) {
+      KeyValueTensorIterator iter(&keys, &values);
+      return initialize(iter);
+    }
   }
-  return s;
+
+  TextFileLineIterator iter;
+  TF_RETURN_IF_ERROR(iter.Init(filename, vocab_size, delimiter, key_dtype,
+                               key_index, value_dtype, value_index, offset,
+                               env));
+  return initialize(iter);
 }
 
 }  // namespace lookup
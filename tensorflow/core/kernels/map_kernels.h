@@ -37,11 +37,12 @@ Status GetInputMap(OpKernelContext* ctx, int index, const TensorMap** ret_map) {
   return Status::OK();
 }
 
+// If the input can't be forwarded, the copy has room for `capacity` elements.
 // TODO(kattian): change into templated function
 Status ForwardInputOrCreateNewMap(OpKernelContext* ctx, int32_t input_index,
                                   int32_t output_index,
                                   const TensorMap& input_map,
-                                  TensorMap** output_map) {
+                                  size_t capacity, TensorMap** output_map) {
   // Attempt to forward the input tensor to the output if possible.
   std::unique_ptr<Tensor> maybe_output = ctx->forward_input(
       input_index, output_index, DT_VARIANT, TensorShape{},
@@ -70,7 +71,7 @@ Status ForwardInputOrCreateNewMap(OpKernelContext* ctx, int32_t input_index,
   attr.set_on_host(true);
   TF_RETURN_IF_ERROR(
       ctx->allocate_output(output_index, {}, &output_tensor, attr));
-  output_tensor->scalar<Variant>()() = input_map.Copy();
+  output_tensor->scalar<Variant>()() = input_map.Copy(capacity);
 
   *output_map = output_tensor->scalar<Variant>()().get<TensorMap>();
   return Status::OK();
@@ -136,8 +137,9 @@ class TensorMapInsert : public OpKernel {
     OP_REQUIRES_OK(ctx, GetInputMap(ctx, 0, &map));
 
     TensorMap* output_map = nullptr;
-    OP_REQUIRES_OK(ctx,
-                   ForwardInputOrCreateNewMap(ctx, 0, 0, *map, &output_map));
+    OP_REQUIRES_OK(ctx, ForwardInputOrCreateNewMap(ctx, 0, 0, *map,
+                                                   map->size() + 1,
+                                                   &output_map));
     output_map->replace(key, value);
   }
 };
@@ -158,8 +160,8 @@ class TensorMapErase : public OpKernel {
                                 key.SummarizeValue(100) + "\"."));
 
     TensorMap* output_map = nullptr;
-    OP_REQUIRES_OK(ctx,
-                   ForwardInputOrCreateNewMap(ctx, 0, 0, *map, &output_map));
+    OP_REQUIRES_OK(ctx, ForwardInputOrCreateNewMap(ctx, 0, 0, *map,
+                                                   map->size(), &output_map));
     output_map->tensors().erase(key);
   }
 };
@@ -0,0 +1,289 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/mapped_vocab.h"
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <vector>
+
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/byte_order.h"
+#include "tensorflow/core/platform/hash.h"
+
+namespace tensorflow {
+namespace lookup {
+namespace {
+
+constexpr char kMagic[8] = {'T', 'F', 'V', 'O', 'C', 'A', 'B', '1'};
+constexpr uint64 kBucketSeed = 0x9ae16a3b2f90404fULL;
+constexpr uint32 kEmptySlot = 0xffffffff;
+// The average number of keys per bucket, and the number of seeds tried for a
+// bucket before giving up. With 1/8 of the slots left empty, buckets need a
+// few dozen trials on average and the last ones a few thousand.
+constexpr int64_t kKeysPerBucket = 4;
+constexpr uint32 kMaxSeedTrials = 1 << 24;
+
+struct Header {
+  char magic[8];
+  uint64 num_entries;
+  uint64 num_buckets;
+  uint64 num_slots;
+  uint64 key_bytes;
+};
+
+uint64 RoundUpTo8(uint64 n) { return (n + 7) & ~uint64{7}; }
+
+uint64 Bucket(StringPiece key, uint64 num_buckets) {
+  return Hash64(key.data(), key.size(), kBucketSeed) % num_buckets;
+}
+
+uint64 Slot(StringPiece key, uint32 seed, uint64 num_slots) {
+  return Hash64(key.data(), key.size(), seed) % num_slots;
+}
+
+Status AppendPadded(WritableFile* file, const void* data, uint64 size) {
+  TF_RETURN_IF_ERROR(
+      file->Append(StringPiece(static_cast<const char*>(data), size)));
+  const char padding[8] = {};
+  return file->Append(StringPiece(padding, RoundUpTo8(size) - size));
+}
+
+}  // namespace
+
+Status MappedVocab::Load(Env* env, const string& filename) {
+  Status s = env->NewReadOnlyMemoryRegionFromFile(filename, &region_);
+  if (s.ok()) {
+    return Parse(static_cast<const char*>(region_->data()), region_->length(),
+                 filename);
+  }
+  if (!errors::IsUnimplemented(s)) return s;
+  TF_RETURN_IF_ERROR(ReadFileToString(env, filename, &buffer_));
+  return Parse(buffer_.data(), buffer_.size(), filename);
+}
+
+Status MappedVocab::Parse(const char* data, uint64 length,
+                          const string& filename) {
+  auto corrupt = [&filename](StringPiece reason) {
+    return errors::DataLoss("Invalid vocabulary file ", filename, ": ",
+                            reason);
+  };
+  if (!port::kLittleEndian) {
+    return errors::Unimplemented(
+        "Vocabulary files can only be read on little-endian hosts.");
+  }
+  if (reinterpret_cast<uintptr_t>(data) % 8 != 0) {
+    return errors::Internal("Vocabulary file ", filename,
+                            " is not 8-byte aligned in memory.");
+  }
+  Header header;
+  if (length < sizeof(header)) return corrupt("truncated header");
+  memcpy(&header, data, sizeof(header));
+  if (memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+    return corrupt("bad magic number");
+  }
+  // Bounding the counts by the file length keeps the size computation below
+  // from overflowing.
+  if (header.num_entries >= kEmptySlot || header.num_buckets > length / 4 ||
+      header.num_slots > length / 4 || header.key_bytes > length ||
+      header.num_slots < header.num_entries ||
+      (header.num_entries > 0 && header.num_buckets == 0)) {
+    return corrupt("bad header");
+  }
+  const uint64 seeds_offset = sizeof(header);
+  const uint64 slots_offset = seeds_offset + RoundUpTo8(header.num_buckets * 4);
+  const uint64 values_offset = slots_offset + RoundUpTo8(header.num_slots * 4);
+  const uint64 key_offsets_offset = values_offset + header.num_entries * 8;
+  const uint64 key_data_offset =
+      key_offsets_offset + (header.num_entries + 1) * 8;
+  if (key_data_offset + header.key_bytes != length) {
+    return corrupt("unexpected file size");
+  }
+
+  num_entries_ = header.num_entries;
+  num_buckets_ = header.num_buckets;
+  num_slots_ = header.num_slots;
+  seeds_ = reinterpret_cast<const uint32*>(data + seeds_offset);
+  slots_ = reinterpret_cast<const uint32*>(data + slots_offset);
+  values_ = reinterpret_cast<const int64_t*>(data + values_offset);
+  key_offsets_ = reinterpret_cast<const uint64*>(data + key_offsets_offset);
+  key_data_ = data + key_data_offset;
+
+  // Lookups trust the index, so validate it once.
+  if (key_offsets_[0] != 0 || key_offsets_[num_entries_] != header.key_bytes) {
+    return corrupt("bad key offsets");
+  }
+  for (int64_t i = 0; i < num_entries_; ++i) {
+    if (key_offsets_[i + 1] < key_offsets_[i]) {
+      return corrupt("bad key offsets");
+    }
+  }
+  for (uint64 i = 0; i < num_slots_; ++i) {
+    if (slots_[i] != kEmptySlot && slots_[i] >= num_entries_) {
+      return corrupt("bad slot");
+    }
+  }
+  return Status::OK();
+}
+
+bool MappedVocab::Find(StringPiece key, int64_t* value) const {
+  if (num_entries_ == 0) return false;
+  const uint32 seed = seeds_[Bucket(key, num_buckets_)];
+  const uint32 entry = slots_[Slot(key, seed, num_slots_)];
+  if (entry == kEmptySlot || this->key(entry) != key) return false;
+  *value = values_[entry];
+  return true;
+}
+
+Status WriteMappedVocab(Env* env, const string& filename, const Tensor& keys,
+                        const Tensor& values) {
+  if (!port::kLittleEndian) {
+    return errors::Unimplemented(
+        "Vocabulary files can only be written on little-endian hosts.");
+  }
+  if (keys.dtype() != DT_STRING || values.dtype() != DT_INT64 ||
+      keys.NumElements() != values.NumElements()) {
+    return errors::InvalidArgument(
+        "Expected as many string keys as int64 values, got keys of type ",
+        DataTypeString(keys.dtype()), " and shape ",
+        keys.shape().DebugString(), " and values of type ",
+        DataTypeString(values.dtype()), " and shape ",
+        values.shape().DebugString());
+  }
+  const auto key_values = keys.flat<tstring>();
+  const auto value_values = values.flat<int64_t>();
+  auto key_at = [&key_values](int64_t i) {
+    return StringPiece(key_values(i).data(), key_values(i).size());
+  };
+
+  // Sort the keys and drop duplicates.
+  std::vector<int64_t> order(key_values.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](int64_t a, int64_t b) {
+    return key_at(a) < key_at(b);
+  });
+  std::vector<int64_t> entries;
+  entries.reserve(order.size());
+  for (int64_t i : order) {
+    if (!entries.empty() && key_at(entries.back()) == key_at(i)) {
+      if (value_values(entries.back()) != value_values(i)) {
+        return errors::InvalidArgument(
+            "Key ", key_at(i), " has values ", value_values(entries.back()),
+            " and ", value_values(i));
+      }
+      continue;
+    }
+    entries.push_back(i);
+  }
+  const int64_t num_entries = entries.size();
+  if (num_entries >= kEmptySlot) {
+    return errors::InvalidArgument("Too many keys: ", num_entries);
+  }
+
+  Header header;
+  memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.num_entries = num_entries;
+  header.num_buckets = (num_entries + kKeysPerBucket - 1) / kKeysPerBucket;
+  header.num_slots = num_entries == 0 ? 0 : num_entries + num_entries / 8 + 1;
+  std::vector<uint32> seeds(header.num_buckets, 0);
+  std::vector<uint32> slots(header.num_slots, kEmptySlot);
+
+  if (num_entries > 0) {
+    // Group the entries by bucket, and place the largest buckets first while
+    // most slots are still free.
+    std::vector<uint64> bucket_start(header.num_buckets + 1, 0);
+    std::vector<uint64> bucket_of(num_entries);
+    for (int64_t e = 0; e < num_entries; ++e) {
+      bucket_of[e] = Bucket(key_at(entries[e]), header.num_buckets);
+      ++bucket_start[bucket_of[e] + 1];
+    }
+    std::partial_sum(bucket_start.begin(), bucket_start.end(),
+                     bucket_start.begin());
+    std::vector<uint32> members(num_entries);
+    {
+      std::vector<uint64> next(bucket_start.begin(), bucket_start.end() - 1);
+      for (int64_t e = 0; e < num_entries; ++e) {
+        members[next[bucket_of[e]]++] = e;
+      }
+    }
+    std::vector<uint32> buckets(header.num_buckets);
+    std::iota(buckets.begin(), buckets.end(), 0);
+    auto bucket_size = [&](uint32 b) {
+      return bucket_start[b + 1] - bucket_start[b];
+    };
+    std::stable_sort(buckets.begin(), buckets.end(), [&](uint32 a, uint32 b) {
+      return bucket_size(a) > bucket_size(b);
+    });
+
+    std::vector<uint64> candidates;
+    for (uint32 b : buckets) {
+      if (bucket_size(b) == 0) break;
+      bool placed = false;
+      for (uint32 seed = 1; seed <= kMaxSeedTrials && !placed; ++seed) {
+        candidates.clear();
+        placed = true;
+        for (uint64 m = bucket_start[b]; m < bucket_start[b + 1]; ++m) {
+          const uint64 slot =
+              Slot(key_at(entries[members[m]]), seed, header.num_slots);
+          if (slots[slot] != kEmptySlot ||
+              std::find(candidates.begin(), candidates.end(), slot) !=
+                  candidates.end()) {
+            placed = false;
+            break;
+          }
+          candidates.push_back(slot);
+        }
+        if (placed) {
+          seeds[b] = seed;
+          for (uint64 m = bucket_start[b]; m < bucket_start[b + 1]; ++m) {
+            slots[candidates[m - bucket_start[b]]] = members[m];
+          }
+        }
+      }
+      if (!placed) {
+        return errors::Internal("Failed to build the hash index of ",
+                                filename);
+      }
+    }
+  }
+
+  std::vector<int64_t> sorted_values(num_entries);
+  std::vector<uint64> key_offsets(num_entries + 1, 0);
+  for (int64_t e = 0; e < num_entries; ++e) {
+    sorted_values[e] = value_values(entries[e]);
+    key_offsets[e + 1] = key_offsets[e] + key_at(entries[e]).size();
+  }
+  header.key_bytes = key_offsets[num_entries];
+
+  std::unique_ptr<WritableFile> file;
+  TF_RETURN_IF_ERROR(env->NewWritableFile(filename, &file));
+  TF_RETURN_IF_ERROR(AppendPadded(file.get(), &header, sizeof(header)));
+  TF_RETURN_IF_ERROR(
+      AppendPadded(file.get(), seeds.data(), seeds.size() * sizeof(uint32)));
+  TF_RETURN_IF_ERROR(
+      AppendPadded(file.get(), slots.data(), slots.size() * sizeof(uint32)));
+  TF_RETURN_IF_ERROR(AppendPadded(file.get(), sorted_values.data(),
+                                  sorted_values.size() * sizeof(int64_t)));
+  TF_RETURN_IF_ERROR(AppendPadded(file.get(), key_offsets.data(),
+                                  key_offsets.size() * sizeof(uint64)));
+  for (int64_t e : entries) {
+    TF_RETURN_IF_ERROR(file->Append(key_at(e)));
+  }
+  return file->Close();
+}
+
+}  // namespace lookup
+}  // namespace tensorflow
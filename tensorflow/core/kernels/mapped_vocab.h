@@ -0,0 +1,101 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_MAPPED_VOCAB_H_
+#define TENSORFLOW_CORE_KERNELS_MAPPED_VOCAB_H_
+
+#include <memory>
+#include <string>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/stringpiece.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace lookup {
+
+// A precompiled string -> int64 vocabulary that is used in place, without
+// parsing or inserting the entries into a hash map.
+//
+// The file holds the keys in sorted order, their values and a perfect hash
+// index: a key is hashed to a bucket, and the per-bucket seed stored in the
+// file hashes every key of the bucket to a distinct slot that holds the entry
+// number of the key. A lookup reads a single entry and compares its key.
+//
+// All integers are little-endian and every array starts at a multiple of 8
+// bytes:
+//
+//   Header                                (magic, sizes)
+//   uint32 seeds[num_buckets]
+//   uint32 slots[num_slots]               (entry number, or 0xffffffff)
+//   int64 values[num_entries]
+//   uint64 key_offsets[num_entries + 1]   (into key_data)
+//   char key_data[key_bytes]
+class MappedVocab {
+ public:
+  MappedVocab() = default;
+
+  // Memory-maps `filename`, or reads it into memory if its file system does
+  // not support memory mapping, and checks that it is well formed.
+  Status Load(Env* env, const string& filename);
+
+  // Looks up `key`, returning false if it is not in the vocabulary.
+  bool Find(StringPiece key, int64_t* value) const;
+
+  // The number of entries, and the key and value of entry `i` in sorted key
+  // order.
+  int64_t size() const { return num_entries_; }
+  StringPiece key(int64_t i) const {
+    return StringPiece(key_data_ + key_offsets_[i],
+                       key_offsets_[i + 1] - key_offsets_[i]);
+  }
+  int64_t value(int64_t i) const { return values_[i]; }
+
+  // The number of bytes held in memory, which is zero when the file is
+  // memory-mapped.
+  int64_t MemoryUsed() const { return buffer_.size(); }
+
+ private:
+  Status Parse(const char* data, uint64 length, const string& filename);
+
+  std::unique_ptr<ReadOnlyMemoryRegion> region_;
+  string buffer_;  // The file contents if it could not be mapped.
+
+  int64_t num_entries_ = 0;
+  uint64 num_buckets_ = 0;
+  uint64 num_slots_ = 0;
+  const uint32* seeds_ = nullptr;
+  const uint32* slots_ = nullptr;
+  const int64_t* values_ = nullptr;
+  const uint64* key_offsets_ = nullptr;
+  const char* key_data_ = nullptr;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(MappedVocab);
+};
+
+// Writes the mapping from the strings `keys` to the int64 `values` to
+// `filename` in the format read by MappedVocab. A key may appear several times
+// with the same value.
+Status WriteMappedVocab(Env* env, const string& filename, const Tensor& keys,
+                        const Tensor& values);
+
+}  // namespace lookup
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_MAPPED_VOCAB_H_
@@ -0,0 +1,118 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/mapped_vocab.h"
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace lookup {
+namespace {
+
+string TestFile(const string& name) {
+  return io::JoinPath(testing::TmpDir(), name);
+}
+
+TEST(MappedVocabTest, WriteAndLoad) {
+  const int kNumKeys = 10000;
+  Tensor keys(DT_STRING, TensorShape({kNumKeys}));
+  Tensor values(DT_INT64, TensorShape({kNumKeys}));
+  for (int i = 0; i < kNumKeys; ++i) {
+    keys.vec<tstring>()(i) = strings::StrCat("word", i);
+    values.vec<int64_t>()(i) = 3 * i;
+  }
+  const string filename = TestFile("write_and_load.vocab");
+  TF_ASSERT_OK(WriteMappedVocab(Env::Default(), filename, keys, values));
+
+  MappedVocab vocab;
+  TF_ASSERT_OK(vocab.Load(Env::Default(), filename));
+  ASSERT_EQ(vocab.size(), kNumKeys);
+  for (int i = 0; i < kNumKeys; ++i) {
+    int64_t value = -1;
+    ASSERT_TRUE(vocab.Find(strings::StrCat("word", i), &value)) << i;
+    EXPECT_EQ(value, 3 * i);
+  }
+  int64_t value;
+  EXPECT_FALSE(vocab.Find("word", &value));
+  EXPECT_FALSE(vocab.Find("word10000", &value));
+  EXPECT_FALSE(vocab.Find("", &value));
+  for (int i = 1; i < kNumKeys; ++i) {
+    EXPECT_LT(vocab.key(i - 1), vocab.key(i));
+  }
+}
+
+TEST(MappedVocabTest, DuplicateKeys) {
+  const string filename = TestFile("duplicate_keys.vocab");
+  TF_ASSERT_OK(WriteMappedVocab(Env::Default(), filename,
+                                test::AsTensor<tstring>({"b", "a", "b"}),
+                                test::AsTensor<int64_t>({1, 2, 1})));
+  MappedVocab vocab;
+  TF_ASSERT_OK(vocab.Load(Env::Default(), filename));
+  ASSERT_EQ(vocab.size(), 2);
+  EXPECT_EQ(vocab.key(0), "a");
+  EXPECT_EQ(vocab.value(0), 2);
+  EXPECT_EQ(vocab.key(1), "b");
+  EXPECT_EQ(vocab.value(1), 1);
+
+  Status s = WriteMappedVocab(Env::Default(), filename,
+                              test::AsTensor<tstring>({"b", "a", "b"}),
+                              test::AsTensor<int64_t>({1, 2, 3}));
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+}
+
+TEST(MappedVocabTest, Empty) {
+  const string filename = TestFile("empty.vocab");
+  TF_ASSERT_OK(WriteMappedVocab(Env::Default(), filename,
+                                Tensor(DT_STRING, TensorShape({0})),
+                                Tensor(DT_INT64, TensorShape({0}))));
+  MappedVocab vocab;
+  TF_ASSERT_OK(vocab.Load(Env::Default(), filename));
+  EXPECT_EQ(vocab.size(), 0);
+  int64_t value;
+  EXPECT_FALSE(vocab.Find("a", &value));
+}
+
+TEST(MappedVocabTest, CorruptFile) {
+  const string filename = TestFile("corrupt.vocab");
+  TF_ASSERT_OK(WriteMappedVocab(Env::Default(), filename,
+                                test::AsTensor<tstring>({"a", "b", "c"}),
+                                test::AsTensor<int64_t>({1, 2, 3})));
+  string contents;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), filename, &contents));
+
+  const string truncated = TestFile("truncated.vocab");
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), truncated,
+                                 contents.substr(0, contents.size() - 1)));
+  MappedVocab vocab;
+  Status s = vocab.Load(Env::Default(), truncated);
+  EXPECT_TRUE(errors::IsDataLoss(s)) << s;
+
+  const string bad_magic = TestFile("bad_magic.vocab");
+  string changed = contents;
+  changed[0] = 'X';
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), bad_magic, changed));
+  MappedVocab other_vocab;
+  s = other_vocab.Load(Env::Default(), bad_magic);
+  EXPECT_TRUE(errors::IsDataLoss(s)) << s;
+}
+
+}  // namespace
+}  // namespace lookup
+}  // namespace tensorflow
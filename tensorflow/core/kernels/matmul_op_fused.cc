@@ -18,7 +18,7 @@ limitations under the License.
 //  - MatMul + BiasAdd + <Activation>
 //  - MatMul + FusedBatchNorm + <Activation>
 //
-// Activation: Relu, Relu6, Elu, etc...
+// Activation: Relu, Relu6, Elu, GeluExact, GeluApproximate, etc...
 //
 // Currently supported only on CPU device.
 
@@ -110,6 +110,13 @@ struct LaunchFusedMatMulOp<CPUDevice, T> {
       case FusedComputationType::kBiasAddWithLeakyRelu:
         executeWithOutputKernel(WithBiasAddAndLeakyRelu<T>(bias_add_args));
         break;
+      case FusedComputationType::kBiasAddWithGeluExact:
+        executeWithOutputKernel(WithBiasAddAndGeluExact<T>(bias_add_args));
+        break;
+      case FusedComputationType::kBiasAddWithGeluApproximate:
+        executeWithOutputKernel(
+            WithBiasAddAndGeluApproximate<T>(bias_add_args));
+        break;
       case FusedComputationType::kUndefined:
         OP_REQUIRES_OK(context, errors::Internal("Fusion type is undefined"));
         break;
@@ -162,6 +169,8 @@ class FusedMatMulOp : public OpKernel {
           {FCT::kBiasAddWithRelu6, {"BiasAdd", "Relu6"}},
           {FCT::kBiasAddWithElu, {"BiasAdd", "Elu"}},
           {FCT::kBiasAddWithLeakyRelu, {"BiasAdd", "LeakyRelu"}},
+          {FCT::kBiasAddWithGeluExact, {"BiasAdd", "GeluExact"}},
+          {FCT::kBiasAddWithGeluApproximate, {"BiasAdd", "GeluApproximate"}},
       };
     }
 
@@ -20,6 +20,7 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <memory>
 #include <vector>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
@@ -31,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/framework/type_traits.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/fill_functor.h"
+#include "tensorflow/core/kernels/packed_matmul.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/platform/logging.h"
@@ -623,6 +625,17 @@ class BaseBatchMatMulOp : public OpKernel {
       OP_REQUIRES_OK(context, context->GetAttr("transpose_b", &trans_y_));
       adj_x_ = false;
       adj_y_ = false;
+      // Grappler marks MatMuls whose weights are a constant or a variable
+      // that is only read, whose packed form can then be reused across steps.
+      bool rhs_is_constant = false;
+      if (std::is_same<Device, CPUDevice>::value &&
+          std::is_same<Ta, float>::value && std::is_same<Tb, float>::value &&
+          std::is_same<Tout, float>::value &&
+          TryGetNodeAttr(context->def(), "_rhs_is_constant",
+                         &rhs_is_constant) &&
+          rhs_is_constant) {
+        packed_rhs_cache_ = std::make_unique<internal::PackedRhsCache>();
+      }
     } else {
       OP_REQUIRES_OK(context, context->GetAttr("adj_x", &adj_x_));
       OP_REQUIRES_OK(context, context->GetAttr("adj_y", &adj_y_));
@@ -687,6 +700,12 @@ class BaseBatchMatMulOp : public OpKernel {
       f(ctx->eigen_device<Device>(), out->flat<Tout>());
       return;
     }
+    if (packed_rhs_cache_ != nullptr && !trans_x_ &&
+        d0 <= internal::PackedRhsMatrix::kMaxLhsRows) {
+      internal::PackedMatMul(ctx, in0, in1, trans_y_, packed_rhs_cache_.get(),
+                             out);
+      return;
+    }
     Tensor out_reshaped;
     OP_REQUIRES(ctx,
                 out_reshaped.CopyFrom(*out, TensorShape({batch_size, d0, d3})),
@@ -744,6 +763,9 @@ class BaseBatchMatMulOp : public OpKernel {
   bool trans_x_ = false;
   bool trans_y_ = false;
 
+  // Set for CPU float MatMuls whose right-hand side is constant.
+  std::unique_ptr<internal::PackedRhsCache> packed_rhs_cache_;
+
   // Cast `t` from `SrcT` to `DstT`.
   template <typename SrcT, typename DstT>
   Tensor CastTensor(const Tensor& t) {
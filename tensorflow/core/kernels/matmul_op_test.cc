@@ -140,6 +140,19 @@ class FusedMatMulOpTest : public OpsTestBase {
       ops::Elu(root.WithOpName("with_activation"), with_bias);
     } else if (activation_type == "LeakyRelu") {
       ops::internal::LeakyRelu(root.WithOpName("with_activation"), with_bias);
+    } else if (activation_type == "GeluExact") {
+      // 0.5 * x * (1 + erf(x / sqrt(2)))
+      auto erf = ops::Erf(root, ops::Mul(root, with_bias, 0.70710678f));
+      ops::Mul(root.WithOpName("with_activation"),
+               ops::Mul(root, with_bias, 0.5f), ops::AddV2(root, erf, 1.0f));
+    } else if (activation_type == "GeluApproximate") {
+      // 0.5 * x * (1 + tanh(sqrt(2 / pi) * (x + 0.044715 * x^3)))
+      auto cube = ops::Mul(root, with_bias, ops::Square(root, with_bias));
+      auto inner =
+          ops::AddV2(root, with_bias, ops::Mul(root, cube, 0.044715f));
+      auto tanh = ops::Tanh(root, ops::Mul(root, inner, 0.7978845608f));
+      ops::Mul(root.WithOpName("with_activation"),
+               ops::Mul(root, with_bias, 0.5f), ops::AddV2(root, tanh, 1.0f));
     } else {
       ops::Identity(root.WithOpName("with_activation"), with_bias);
     }
@@ -306,6 +319,17 @@ TYPED_TEST_P(FusedMatMulWithBiasOpTest, MatMul256x256x256WithActivation) {
   }
 }
 
+TYPED_TEST_P(FusedMatMulWithBiasOpTest, MatMul256x256x256WithGelu) {
+  for (const string& activation : {"GeluExact", "GeluApproximate"}) {
+    this->VerifyConv2DWithBiasAndActivation(256, 256, 256, false, false,
+                                            activation);
+    this->VerifyConv2DWithBiasAndActivation(256, 256, 256, true, true,
+                                            activation);
+    this->VerifyConv2DWithBiasAndActivation(1, 256, 256, false, false,
+                                            activation);
+  }
+}
+
 TYPED_TEST_P(FusedMatMulWithBiasOpTest, MatMul1x256x256WithActivation) {
   for (const string& activation : {"Relu", "Relu6", "Elu", "LeakyRelu"}) {
     this->VerifyConv2DWithBiasAndActivation(1, 256, 256, false, false,
@@ -333,6 +357,7 @@ REGISTER_TYPED_TEST_SUITE_P(FusedMatMulWithBiasOpTest,        //
                             MatMul256x256x1,                  //
                             MatMul1x256x1,                    //
                             MatMul256x256x256WithActivation,  //
+                            MatMul256x256x256WithGelu,        //
                             MatMul1x256x256WithActivation,    //
                             MatMul256x256x1WithActivation,    //
                             MatMul1x256x1WithActivation);
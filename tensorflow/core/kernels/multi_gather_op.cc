@@ -0,0 +1,146 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/array_ops.cc.
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include "tensorflow/core/framework/bounds_check.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/kernels/gather_functor.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/util/util.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+// Gathers rows from several tables at once.  The lookups of all the tables are
+// sharded together, so that a model with dozens of small embedding lookups
+// pays for one kernel and one round trip through the thread pool.
+template <typename T, typename Index>
+class MultiGatherOp : public OpKernel {
+ public:
+  explicit MultiGatherOp(OpKernelConstruction* c) : OpKernel(c) {}
+
+  void Compute(OpKernelContext* c) override {
+    OpInputList params;
+    OP_REQUIRES_OK(c, c->input_list("params", &params));
+    OpInputList indices;
+    OP_REQUIRES_OK(c, c->input_list("indices", &indices));
+    OpOutputList outputs;
+    OP_REQUIRES_OK(c, c->output_list("output", &outputs));
+
+    const int num_tables = params.size();
+    std::vector<functor::RowGatherer<Index>> gatherers;
+    gatherers.reserve(num_tables);
+    // Lookups [offsets[i], offsets[i + 1]) of the combined range belong to
+    // table i.
+    std::vector<int64_t> offsets = {0};
+    offsets.reserve(num_tables + 1);
+    int64_t total_bytes = 0;
+    for (int i = 0; i < num_tables; ++i) {
+      const Tensor& table = params[i];
+      OP_REQUIRES(c, TensorShapeUtils::IsVectorOrHigher(table.shape()),
+                  errors::InvalidArgument("params[", i,
+                                          "] must be at least 1 dimensional"));
+      const int64_t num_rows = table.dim_size(0);
+      OP_REQUIRES(
+          c, FastBoundsCheck(num_rows, std::numeric_limits<Index>::max()),
+          errors::InvalidArgument("params[", i, "].shape[0] too large for ",
+                                  DataTypeString(DataTypeToEnum<Index>::v()),
+                                  " indexing: ", num_rows, " > ",
+                                  std::numeric_limits<Index>::max()));
+
+      TensorShape out_shape = indices[i].shape();
+      int64_t row_elems = 1;
+      for (int d = 1; d < table.dims(); ++d) {
+        out_shape.AddDim(table.dim_size(d));
+        row_elems *= table.dim_size(d);
+      }
+      Tensor* out = nullptr;
+      OP_REQUIRES_OK(c, outputs.allocate(i, out_shape, &out));
+
+      const int64_t num_indices = indices[i].NumElements();
+      const int64_t row_bytes = row_elems * sizeof(T);
+      gatherers.emplace_back(table.flat<T>().data(), num_rows, row_bytes,
+                             indices[i].flat<Index>().data(), num_indices,
+                             out->flat<T>().data());
+      offsets.push_back(offsets.back() + num_indices);
+      total_bytes += num_indices * row_bytes;
+    }
+
+    const int64_t total = offsets.back();
+    if (total == 0) return;
+
+    mutex mu;
+    // The table and position of an index that is out of range.
+    int bad_table = -1;
+    int64_t bad_i = -1;
+    auto work = [&](int64_t begin, int64_t end) {
+      int i = std::upper_bound(offsets.begin(), offsets.end(), begin) -
+              offsets.begin() - 1;
+      while (begin < end) {
+        const int64_t table_end = std::min(end, offsets[i + 1]);
+        const int64_t bad = gatherers[i].Copy(begin - offsets[i],
+                                              table_end - offsets[i]);
+        if (bad >= 0) {
+          mutex_lock l(mu);
+          bad_table = i;
+          bad_i = bad;
+          return;
+        }
+        begin = table_end;
+        ++i;
+      }
+    };
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *c->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, total,
+          /*cost_per_unit=*/std::max<int64_t>(1, total_bytes / total), work);
+
+    if (bad_table >= 0) {
+      const Tensor& bad_indices = indices[bad_table];
+      c->SetStatus(errors::InvalidArgument(
+          "indices[", bad_table, "]",
+          SliceDebugString(bad_indices.shape(), bad_i), " = ",
+          bad_indices.flat<Index>()(bad_i), " is not in [0, ",
+          params[bad_table].dim_size(0), ")"));
+    }
+  }
+};
+
+#define REGISTER_MULTI_GATHER(type, index_type)                        \
+  REGISTER_KERNEL_BUILDER(Name("MultiGather")                          \
+                              .Device(DEVICE_CPU)                      \
+                              .TypeConstraint<type>("T")               \
+                              .TypeConstraint<index_type>("Tindices"), \
+                          MultiGatherOp<type, index_type>)
+
+#define REGISTER_MULTI_GATHER_ALL_INDICES(type) \
+  REGISTER_MULTI_GATHER(type, int32);           \
+  REGISTER_MULTI_GATHER(type, int64_t)
+
+TF_CALL_POD_TYPES(REGISTER_MULTI_GATHER_ALL_INDICES);
+TF_CALL_QUANTIZED_TYPES(REGISTER_MULTI_GATHER_ALL_INDICES);
+
+#undef REGISTER_MULTI_GATHER_ALL_INDICES
+#undef REGISTER_MULTI_GATHER
+
+}  // namespace tensorflow
@@ -0,0 +1,87 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "absl/strings/match.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class MultiGatherOpTest : public OpsTestBase {
+ protected:
+  void MakeOp(int num_tables, DataType data_type, DataType index_type) {
+    TF_ASSERT_OK(NodeDefBuilder("myop", "MultiGather")
+                     .Input(FakeInput(num_tables, data_type))
+                     .Input(FakeInput(num_tables, index_type))
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+};
+
+TEST_F(MultiGatherOpTest, TablesOfDifferentWidths) {
+  MakeOp(2, DT_FLOAT, DT_INT32);
+
+  AddInputFromArray<float>(TensorShape({3, 2}), {0, 1, 10, 11, 20, 21});
+  AddInputFromArray<float>(TensorShape({4}), {0, 1, 2, 3});
+  AddInputFromArray<int32>(TensorShape({3}), {2, 0, 2});
+  AddInputFromArray<int32>(TensorShape({2, 2}), {3, 1, 0, 3});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected0(allocator(), DT_FLOAT, TensorShape({3, 2}));
+  test::FillValues<float>(&expected0, {20, 21, 0, 1, 20, 21});
+  test::ExpectTensorEqual<float>(expected0, *GetOutput(0));
+  Tensor expected1(allocator(), DT_FLOAT, TensorShape({2, 2}));
+  test::FillValues<float>(&expected1, {3, 1, 0, 3});
+  test::ExpectTensorEqual<float>(expected1, *GetOutput(1));
+}
+
+TEST_F(MultiGatherOpTest, EmptyIndices) {
+  MakeOp(2, DT_INT64, DT_INT64);
+
+  AddInputFromArray<int64_t>(TensorShape({2, 3}), {0, 1, 2, 3, 4, 5});
+  AddInputFromArray<int64_t>(TensorShape({2}), {7, 8});
+  AddInputFromArray<int64_t>(TensorShape({0}), {});
+  AddInputFromArray<int64_t>(TensorShape({1}), {1});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected0(allocator(), DT_INT64, TensorShape({0, 3}));
+  test::ExpectTensorEqual<int64_t>(expected0, *GetOutput(0));
+  Tensor expected1(allocator(), DT_INT64, TensorShape({1}));
+  test::FillValues<int64_t>(&expected1, {8});
+  test::ExpectTensorEqual<int64_t>(expected1, *GetOutput(1));
+}
+
+TEST_F(MultiGatherOpTest, IndexOutOfRange) {
+  MakeOp(2, DT_FLOAT, DT_INT32);
+
+  AddInputFromArray<float>(TensorShape({2}), {0, 1});
+  AddInputFromArray<float>(TensorShape({3}), {0, 1, 2});
+  AddInputFromArray<int32>(TensorShape({2}), {1, 0});
+  AddInputFromArray<int32>(TensorShape({2}), {2, 3});
+  Status s = RunOpKernel();
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+  EXPECT_TRUE(absl::StrContains(s.error_message(),
+                                "indices[1][1] = 3 is not in [0, 3)"))
+      << s;
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -1481,6 +1481,13 @@ BM_TopKCPU(16, 35000, 35000, 16, "topk_nmt_r_16_c_35000_k_35000_th_16");
 BM_TopKCPU(16, 70000, 70000, 16, "topk_nmt_r_16_c_70000_k_70000_th_16");
 BM_TopKCPU(16, 175000, 175000, 16, "topk_nmt_r_16_c_175000_k_175000_th_16");
 BM_TopKCPU(16, 350000, 350000, 16, "topk_nmt_r_16_c_350000_k_350000_th_16");
+
+// Retrieval serving: a few queries against a large vocabulary of candidates.
+BM_TopKCPU(1, 1000000, 100, 16, "topk_retrieval_r_1_c_1000000_k_100_th_16");
+BM_TopKCPU(1, 1000000, 1000, 16, "topk_retrieval_r_1_c_1000000_k_1000_th_16");
+BM_TopKCPU(8, 1000000, 100, 16, "topk_retrieval_r_8_c_1000000_k_100_th_16");
+BM_TopKCPU(32, 1000000, 100, 16, "topk_retrieval_r_32_c_1000000_k_100_th_16");
+BM_TopKCPU(1, 5000000, 100, 16, "topk_retrieval_r_1_c_5000000_k_100_th_16");
 BM_TopKCPU(128, 10000, 10000, 16, "topk_nmt_r_128_c_10000_k_10000_th_16");
 BM_TopKCPU(128, 20000, 20000, 16, "topk_nmt_r_128_c_20000_k_20000_th_16");
 BM_TopKCPU(128, 50000, 50000, 16, "topk_nmt_r_128_c_50000_k_50000_th_16");
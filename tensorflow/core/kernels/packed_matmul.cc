@@ -0,0 +1,215 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/packed_matmul.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "third_party/eigen3/Eigen/Core"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+namespace internal {
+namespace {
+
+using Packet = Eigen::internal::packet_traits<float>::type;
+constexpr int kPacketSize = Eigen::internal::unpacket_traits<Packet>::size;
+
+// Panels are two packets wide, and the output block of up to four rows by one
+// panel is accumulated in eight registers across the whole depth, leaving
+// room for the panel row and the broadcast left-hand side value even with
+// the sixteen registers of SSE and AVX.  The accumulators are spelled out
+// rather than kept in arrays, which compilers do not reliably keep in
+// registers.
+constexpr int kPanelWidth = 2 * kPacketSize;
+constexpr int kRowBlock = 4;
+
+// Computes a kRows x kPanelWidth block of the output, whose rows are
+// `out_stride` floats apart.
+template <int kRows>
+void MultiplyPanel(const float* lhs, int64_t k, const float* panel, float* out,
+                   int64_t out_stride) {
+  using Eigen::internal::ploadu;
+  using Eigen::internal::pmadd;
+  using Eigen::internal::pset1;
+  using Eigen::internal::pstoreu;
+  const Packet zero = pset1<Packet>(0.0f);
+  Packet c00 = zero, c01 = zero, c10 = zero, c11 = zero;
+  Packet c20 = zero, c21 = zero, c30 = zero, c31 = zero;
+  int64_t p = 0;
+  if (kRows == 1) {
+    // A single row would only have two chains of dependent multiply-adds, so
+    // even and odd depths are accumulated separately.
+    for (; p + 1 < k; p += 2) {
+      const float* b = panel + p * kPanelWidth;
+      const Packet a0 = pset1<Packet>(lhs[p]);
+      const Packet a1 = pset1<Packet>(lhs[p + 1]);
+      c00 = pmadd(a0, ploadu<Packet>(b), c00);
+      c01 = pmadd(a0, ploadu<Packet>(b + kPacketSize), c01);
+      c10 = pmadd(a1, ploadu<Packet>(b + kPanelWidth), c10);
+      c11 = pmadd(a1, ploadu<Packet>(b + kPanelWidth + kPacketSize), c11);
+    }
+  }
+  for (; p < k; ++p) {
+    const float* b = panel + p * kPanelWidth;
+    const Packet b0 = ploadu<Packet>(b);
+    const Packet b1 = ploadu<Packet>(b + kPacketSize);
+    Packet a = pset1<Packet>(lhs[p]);
+    c00 = pmadd(a, b0, c00);
+    c01 = pmadd(a, b1, c01);
+    if (kRows > 1) {
+      a = pset1<Packet>(lhs[k + p]);
+      c10 = pmadd(a, b0, c10);
+      c11 = pmadd(a, b1, c11);
+    }
+    if (kRows > 2) {
+      a = pset1<Packet>(lhs[2 * k + p]);
+      c20 = pmadd(a, b0, c20);
+      c21 = pmadd(a, b1, c21);
+    }
+    if (kRows > 3) {
+      a = pset1<Packet>(lhs[3 * k + p]);
+      c30 = pmadd(a, b0, c30);
+      c31 = pmadd(a, b1, c31);
+    }
+  }
+  if (kRows == 1) {
+    c00 = Eigen::internal::padd(c00, c10);
+    c01 = Eigen::internal::padd(c01, c11);
+  }
+  pstoreu(out, c00);
+  pstoreu(out + kPacketSize, c01);
+  if (kRows > 1) {
+    pstoreu(out + out_stride, c10);
+    pstoreu(out + out_stride + kPacketSize, c11);
+  }
+  if (kRows > 2) {
+    pstoreu(out + 2 * out_stride, c20);
+    pstoreu(out + 2 * out_stride + kPacketSize, c21);
+  }
+  if (kRows > 3) {
+    pstoreu(out + 3 * out_stride, c30);
+    pstoreu(out + 3 * out_stride + kPacketSize, c31);
+  }
+}
+
+void MultiplyRows(const float* lhs, int64_t rows, int64_t k,
+                  const float* panel, float* out, int64_t out_stride) {
+  switch (rows) {
+    case 1:
+      MultiplyPanel<1>(lhs, k, panel, out, out_stride);
+      break;
+    case 2:
+      MultiplyPanel<2>(lhs, k, panel, out, out_stride);
+      break;
+    case 3:
+      MultiplyPanel<3>(lhs, k, panel, out, out_stride);
+      break;
+    default:
+      DCHECK_EQ(rows, kRowBlock);
+      MultiplyPanel<kRowBlock>(lhs, k, panel, out, out_stride);
+      break;
+  }
+}
+
+}  // namespace
+
+PackedRhsMatrix::PackedRhsMatrix(const float* rhs, int64_t k, int64_t n,
+                                 bool transpose)
+    : k_(k),
+      n_(n),
+      num_panels_((n + kPanelWidth - 1) / kPanelWidth),
+      data_(num_panels_ * k * kPanelWidth, 0.0f) {
+  for (int64_t panel = 0; panel < num_panels_; ++panel) {
+    const int64_t col_begin = panel * kPanelWidth;
+    const int64_t cols = std::min<int64_t>(kPanelWidth, n - col_begin);
+    float* dst = data_.data() + panel * k * kPanelWidth;
+    for (int64_t p = 0; p < k; ++p) {
+      if (transpose) {
+        for (int64_t c = 0; c < cols; ++c) {
+          dst[p * kPanelWidth + c] = rhs[(col_begin + c) * k + p];
+        }
+      } else {
+        std::memcpy(dst + p * kPanelWidth, rhs + p * n + col_begin,
+                    cols * sizeof(float));
+      }
+    }
+  }
+}
+
+void PackedRhsMatrix::Multiply(
+    const DeviceBase::CpuWorkerThreads& worker_threads, const float* lhs,
+    int64_t m, float* out) const {
+  const int64_t k = k_;
+  const int64_t n = n_;
+  auto multiply_panels = [&](int64_t begin, int64_t end) {
+    // The last panel may be narrower than the output rows it writes, so its
+    // blocks go through a buffer first.
+    float partial[kRowBlock * kPanelWidth];
+    for (int64_t panel = begin; panel < end; ++panel) {
+      const float* panel_data = data_.data() + panel * k * kPanelWidth;
+      const int64_t col_begin = panel * kPanelWidth;
+      const int64_t cols = std::min<int64_t>(kPanelWidth, n - col_begin);
+      for (int64_t i = 0; i < m; i += kRowBlock) {
+        const int64_t rows = std::min<int64_t>(kRowBlock, m - i);
+        if (cols == kPanelWidth) {
+          MultiplyRows(lhs + i * k, rows, k, panel_data,
+                       out + i * n + col_begin, n);
+          continue;
+        }
+        MultiplyRows(lhs + i * k, rows, k, panel_data, partial, kPanelWidth);
+        for (int64_t r = 0; r < rows; ++r) {
+          std::memcpy(out + (i + r) * n + col_begin, partial + r * kPanelWidth,
+                      cols * sizeof(float));
+        }
+      }
+    }
+  };
+  Shard(worker_threads.num_threads, worker_threads.workers, num_panels_,
+        /*cost_per_unit=*/std::max<int64_t>(1, m * k * kPanelWidth),
+        multiply_panels);
+}
+
+std::shared_ptr<const PackedRhsMatrix> PackedRhsCache::Get(const Tensor& rhs,
+                                                           bool transpose) {
+  mutex_lock l(mu_);
+  if (packed_ != nullptr && transpose_ == transpose &&
+      source_.SharesBufferWith(rhs) &&
+      source_.tensor_data().data() == rhs.tensor_data().data() &&
+      source_.shape() == rhs.shape()) {
+    return packed_;
+  }
+  const int64_t k = rhs.dim_size(transpose ? 1 : 0);
+  const int64_t n = rhs.dim_size(transpose ? 0 : 1);
+  packed_ = std::make_shared<const PackedRhsMatrix>(rhs.flat<float>().data(),
+                                                    k, n, transpose);
+  source_ = rhs;
+  transpose_ = transpose;
+  return packed_;
+}
+
+void PackedMatMul(OpKernelContext* ctx, const Tensor& lhs, const Tensor& rhs,
+                  bool transpose_rhs, PackedRhsCache* cache, Tensor* out) {
+  std::shared_ptr<const PackedRhsMatrix> packed =
+      cache->Get(rhs, transpose_rhs);
+  packed->Multiply(*ctx->device()->tensorflow_cpu_worker_threads(),
+                   lhs.flat<float>().data(), lhs.dim_size(0),
+                   out->flat<float>().data());
+}
+
+}  // namespace internal
+}  // namespace tensorflow
@@ -0,0 +1,91 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_PACKED_MATMUL_H_
+#define TENSORFLOW_CORE_KERNELS_PACKED_MATMUL_H_
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace internal {
+
+// A float [k, n] right-hand side matrix, packed once into the layout read by
+// the multiplication kernel: panels of two SIMD registers' worth of columns,
+// each stored as k contiguous rows and zero padded to the full width.
+//
+// Eigen's tensor contraction packs both operands on every call, which for a
+// constant weight matrix and a handful of left-hand side rows is a large part
+// of the cost of the product.  Multiplying by a packed matrix only streams the
+// panels once per shard of rows.
+class PackedRhsMatrix {
+ public:
+  // Products with more left-hand side rows than this are left to Eigen, whose
+  // blocking amortizes packing over the rows.
+  static constexpr int64_t kMaxLhsRows = 32;
+
+  // Packs `rhs`, a row-major [k, n] matrix, or [n, k] if `transpose`.
+  PackedRhsMatrix(const float* rhs, int64_t k, int64_t n, bool transpose);
+
+  // Computes out = lhs * rhs, where `lhs` is a row-major [m, k] matrix and
+  // `out` a row-major [m, n] one.  Shards the panels over `worker_threads`.
+  void Multiply(const DeviceBase::CpuWorkerThreads& worker_threads,
+                const float* lhs, int64_t m, float* out) const;
+
+  int64_t k() const { return k_; }
+  int64_t n() const { return n_; }
+
+ private:
+  int64_t k_;
+  int64_t n_;
+  int64_t num_panels_;
+  std::vector<float> data_;
+};
+
+// Caches the packed form of the right-hand side of one MatMul kernel whose
+// weights are a constant or a variable that is only read.
+//
+// The cache keeps a reference to the tensor it packed, and reuses the packed
+// matrix as long as it is given the same buffer with the same shape.  Holding
+// the reference keeps the buffer from being freed and reused by another
+// tensor, and makes the variable ops copy the buffer rather than update it in
+// place, so that a hit always sees the packed values.
+class PackedRhsCache {
+ public:
+  // Returns `rhs`, a [k, n] matrix or [n, k] if `transpose`, packed.
+  std::shared_ptr<const PackedRhsMatrix> Get(const Tensor& rhs, bool transpose);
+
+ private:
+  mutex mu_;
+  Tensor source_ TF_GUARDED_BY(mu_);
+  bool transpose_ TF_GUARDED_BY(mu_) = false;
+  std::shared_ptr<const PackedRhsMatrix> packed_ TF_GUARDED_BY(mu_);
+};
+
+// Computes out = lhs * rhs for float matrices, with `rhs` transposed if
+// `transpose_rhs`, fetching the packed `rhs` from `cache`.
+void PackedMatMul(OpKernelContext* ctx, const Tensor& lhs, const Tensor& rhs,
+                  bool transpose_rhs, PackedRhsCache* cache, Tensor* out);
+
+}  // namespace internal
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_PACKED_MATMUL_H_
@@ -0,0 +1,129 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/packed_matmul.h"
+
+#include <random>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/threadpool.h"
+
+namespace tensorflow {
+namespace internal {
+namespace {
+
+class PackedRhsMatrixTest : public ::testing::Test {
+ protected:
+  PackedRhsMatrixTest() : pool_(Env::Default(), "packed_matmul_test", 4) {
+    worker_threads_.num_threads = 4;
+    worker_threads_.workers = &pool_;
+  }
+
+  // Checks the product of random matrices against a naive one.
+  void CheckMultiply(int64_t m, int64_t k, int64_t n, bool transpose) {
+    std::mt19937 gen(m * 10007 + k * 101 + n);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    std::vector<float> lhs(m * k);
+    for (float& v : lhs) v = dist(gen);
+    std::vector<float> rhs(k * n);
+    for (float& v : rhs) v = dist(gen);
+
+    std::vector<float> expected(m * n, 0.0f);
+    for (int64_t i = 0; i < m; ++i) {
+      for (int64_t j = 0; j < n; ++j) {
+        double sum = 0;
+        for (int64_t p = 0; p < k; ++p) {
+          sum += lhs[i * k + p] * (transpose ? rhs[j * k + p] : rhs[p * n + j]);
+        }
+        expected[i * n + j] = sum;
+      }
+    }
+
+    PackedRhsMatrix packed(rhs.data(), k, n, transpose);
+    EXPECT_EQ(k, packed.k());
+    EXPECT_EQ(n, packed.n());
+    std::vector<float> out(m * n, -1.0f);
+    packed.Multiply(worker_threads_, lhs.data(), m, out.data());
+    for (int64_t i = 0; i < m * n; ++i) {
+      EXPECT_NEAR(expected[i], out[i], 1e-4)
+          << "m=" << m << " k=" << k << " n=" << n << " at " << i;
+    }
+  }
+
+  DeviceBase::CpuWorkerThreads worker_threads_;
+
+ private:
+  thread::ThreadPool pool_;
+};
+
+TEST_F(PackedRhsMatrixTest, FullPanels) {
+  CheckMultiply(/*m=*/1, /*k=*/64, /*n=*/32, /*transpose=*/false);
+  CheckMultiply(/*m=*/4, /*k=*/17, /*n=*/16, /*transpose=*/false);
+  CheckMultiply(/*m=*/32, /*k=*/128, /*n=*/256, /*transpose=*/false);
+}
+
+TEST_F(PackedRhsMatrixTest, PartialPanelsAndRowBlocks) {
+  for (int64_t m : {1, 2, 3, 5, 7, 30}) {
+    CheckMultiply(m, /*k=*/9, /*n=*/1, /*transpose=*/false);
+    CheckMultiply(m, /*k=*/33, /*n=*/45, /*transpose=*/false);
+  }
+}
+
+TEST_F(PackedRhsMatrixTest, TransposedRhs) {
+  CheckMultiply(/*m=*/1, /*k=*/100, /*n=*/10, /*transpose=*/true);
+  CheckMultiply(/*m=*/6, /*k=*/31, /*n=*/70, /*transpose=*/true);
+}
+
+TEST(PackedRhsCacheTest, ReusesPackedMatrix) {
+  Tensor rhs(DT_FLOAT, TensorShape({8, 24}));
+  rhs.flat<float>().setRandom();
+  PackedRhsCache cache;
+  auto packed = cache.Get(rhs, /*transpose=*/false);
+  EXPECT_EQ(packed, cache.Get(rhs, /*transpose=*/false));
+
+  // A tensor sharing the buffer hits the cache as well.
+  Tensor alias = rhs;
+  EXPECT_EQ(packed, cache.Get(alias, /*transpose=*/false));
+
+  // The same buffer read as the transpose is packed again.
+  auto transposed = cache.Get(rhs, /*transpose=*/true);
+  EXPECT_NE(packed, transposed);
+  EXPECT_EQ(24, transposed->k());
+  EXPECT_EQ(8, transposed->n());
+}
+
+TEST(PackedRhsCacheTest, RepacksNewBuffer) {
+  Tensor rhs(DT_FLOAT, TensorShape({8, 24}));
+  rhs.flat<float>().setRandom();
+  PackedRhsCache cache;
+  auto packed = cache.Get(rhs, /*transpose=*/false);
+
+  // A copy has the same values but may be updated independently.
+  Tensor copy(DT_FLOAT, rhs.shape());
+  copy.flat<float>() = rhs.flat<float>();
+  EXPECT_NE(packed, cache.Get(copy, /*transpose=*/false));
+
+  // The cache holds on to the buffer it packed, so the buffer is not
+  // exclusively owned by the tensor anymore.
+  EXPECT_FALSE(copy.RefCountIsOne());
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace tensorflow
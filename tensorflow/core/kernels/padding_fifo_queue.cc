@@ -86,6 +86,20 @@ void PaddingFIFOQueue::TryDequeueMany(int num_elements, OpKernelContext* ctx,
     return;
   }
 
+  // As in FIFOQueue, the batch is padded and copied after releasing mu_.
+  std::vector<Tuple> tuples;
+  if (TryDequeueWithoutWaiting(num_elements, ctx, &tuples)) {
+    Tuple tuple;
+    Status s = AssembleBatch(ctx, &tuples, &tuple);
+    if (!s.ok()) {
+      ctx->SetStatus(s);
+      callback(Tuple());
+      return;
+    }
+    callback(tuple);
+    return;
+  }
+
   CancellationManager* cm = ctx->cancellation_manager();
   CancellationToken token = cm->get_cancellation_token();
   bool already_cancelled;
@@ -156,63 +170,9 @@ void PaddingFIFOQueue::TryDequeueMany(int num_elements, OpKernelContext* ctx,
               if (attempt->elements_requested == 0) {
                 // Finished.  Allocate attempt->tuple and
                 // copy from attempt->tuples to attempt->tuple.
-                attempt->tuple.reserve(num_components());
-                std::vector<Tuple>& tuples = attempt->tuples;
-
-                std::vector<bool> dynamic_shape;
-                const int64_t batch_size = tuples.size();
-
-                for (int i = 0; i < num_components(); ++i) {
-                  const PartialTensorShape partial_shape =
-                      PartialTensorShape({batch_size})
-                          .Concatenate(partial_shapes_[i]);
-                  TensorShape shape({batch_size});
-
-                  for (int j = 0; j < partial_shape.dims() - 1; ++j) {
-                    if (partial_shape.dim_size(j + 1) > -1) {
-                      shape.AddDim(partial_shape.dim_size(j + 1));
-                    } else {
-                      // Expand sizes to match.
-                      int64_t max_val = 0;
-                      for (const Tuple& t : tuples) {
-                        max_val = std::max(max_val, t[i].shape().dim_size(j));
-                      }
-                      shape.AddDim(max_val);
-                    }
-                  }
-
-                  Tensor element;
-                  attempt->context->SetStatus(attempt->context->allocate_temp(
-                      component_dtypes_[i], shape, &element));
-                  if (!attempt->context->status().ok()) return kComplete;
-
-                  bool has_dynamic_shape = !partial_shape.IsFullyDefined();
-                  if (has_dynamic_shape) {
-                    // Set all values to zero because not all values
-                    // will get written over.
-                    attempt->context->SetStatus(SetElementZero(&element));
-                    if (!attempt->context->status().ok()) return kComplete;
-                  }
-
-                  dynamic_shape.push_back(has_dynamic_shape);
-                  attempt->tuple.emplace_back(element);
-                }
-
-                for (size_t index = 0; index < tuples.size(); ++index) {
-                  for (int i = 0; i < num_components(); ++i) {
-                    if (dynamic_shape[i]) {
-                      // Slightly slower copy operation
-                      attempt->context->SetStatus(CopyElementToLargerSlice(
-                          tuples[index][i], &attempt->tuple[i], index));
-                    } else {
-                      attempt->context->SetStatus(
-                          batch_util::CopyElementToSlice(
-                              std::move(tuples[index][i]), &attempt->tuple[i],
-                              index));
-                    }
-                    if (!attempt->context->status().ok()) return kComplete;
-                  }
-                }
+                attempt->context->SetStatus(AssembleBatch(
+                    attempt->context, &attempt->tuples, &attempt->tuple));
+                if (!attempt->context->status().ok()) return kComplete;
                 tuple = attempt->tuple;
                 attempt->tuples.clear();
                 attempt->done_callback = [callback, tuple]() {
@@ -233,6 +193,61 @@ void PaddingFIFOQueue::TryDequeueMany(int num_elements, OpKernelContext* ctx,
   }
 }
 
+Status PaddingFIFOQueue::AssembleBatch(OpKernelContext* ctx,
+                                       std::vector<Tuple>* tuples,
+                                       Tuple* batch) {
+  batch->reserve(num_components());
+  std::vector<bool> dynamic_shape;
+  const int64_t batch_size = tuples->size();
+
+  for (int i = 0; i < num_components(); ++i) {
+    const PartialTensorShape partial_shape =
+        PartialTensorShape({batch_size}).Concatenate(partial_shapes_[i]);
+    TensorShape shape({batch_size});
+
+    for (int j = 0; j < partial_shape.dims() - 1; ++j) {
+      if (partial_shape.dim_size(j + 1) > -1) {
+        shape.AddDim(partial_shape.dim_size(j + 1));
+      } else {
+        // Expand sizes to match.
+        int64_t max_val = 0;
+        for (const Tuple& t : *tuples) {
+          max_val = std::max(max_val, t[i].shape().dim_size(j));
+        }
+        shape.AddDim(max_val);
+      }
+    }
+
+    Tensor element;
+    TF_RETURN_IF_ERROR(
+        ctx->allocate_temp(component_dtypes_[i], shape, &element));
+
+    bool has_dynamic_shape = !partial_shape.IsFullyDefined();
+    if (has_dynamic_shape) {
+      // Set all values to zero because not all values
+      // will get written over.
+      TF_RETURN_IF_ERROR(SetElementZero(&element));
+    }
+
+    dynamic_shape.push_back(has_dynamic_shape);
+    batch->emplace_back(element);
+  }
+
+  for (size_t index = 0; index < tuples->size(); ++index) {
+    for (int i = 0; i < num_components(); ++i) {
+      if (dynamic_shape[i]) {
+        // Slightly slower copy operation
+        TF_RETURN_IF_ERROR(
+            CopyElementToLargerSlice((*tuples)[index][i], &(*batch)[i], index));
+      } else {
+        TF_RETURN_IF_ERROR(batch_util::CopyElementToSlice(
+            std::move((*tuples)[index][i]), &(*batch)[i], index));
+      }
+    }
+  }
+  return Status::OK();
+}
+
 Status PaddingFIFOQueue::ValidateTuple(const Tuple& tuple) {
   TF_RETURN_IF_ERROR(ValidateTupleCommon(tuple));
   for (size_t i = 0; i < tuple.size(); ++i) {
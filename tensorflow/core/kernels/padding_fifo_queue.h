@@ -69,6 +69,11 @@ class PaddingFIFOQueue : public FIFOQueue {
   static Status CopyElementToLargerSlice(const Tensor& element, Tensor* parent,
                                          int index);
 
+  // Pads and copies the dequeued `tuples` into a batch, one component per
+  // tensor. Consumes the elements of `tuples`.
+  Status AssembleBatch(OpKernelContext* ctx, std::vector<Tuple>* tuples,
+                       Tuple* batch);
+
   std::vector<PartialTensorShape> partial_shapes_;
 
  private:
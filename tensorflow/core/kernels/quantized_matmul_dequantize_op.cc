@@ -0,0 +1,249 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Implements QuantizedMatMulWithBiasAndDequantize on CPU with ruy, the GEMM
+// library behind TF Lite's cpu_backend_gemm.  ruy picks the best int8 kernel
+// for the host at run time (e.g. AVX-512 on x86 and dot-product
+// instructions on Arm).  MKL builds register their own kernel for this op.
+
+#ifndef INTEL_MKL
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "ruy/ruy.h"  // from @ruy
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Every intra-op thread keeps a single-threaded ruy context, so that ruy's
+// buffers are reused across steps while the parallelism comes from Shard.
+ruy::Context* GetThreadLocalRuyContext() {
+  static thread_local std::unique_ptr<ruy::Context> context;
+  if (context == nullptr) {
+    context = std::make_unique<ruy::Context>();
+    context->set_max_num_threads(1);
+  }
+  return context.get();
+}
+
+// The real value of an activation with int8 bits `q` (with quint8 inputs
+// shifted down by 128) is `offset + scale * (q + shift)`.
+struct ActivationRange {
+  float offset;
+  float scale;
+  int32 shift;
+};
+
+template <typename T1>
+ActivationRange GetActivationRange(float min_a, float max_a, bool min_first) {
+  constexpr bool kIsUnsigned = std::is_same<T1, quint8>::value;
+  if (min_first) {
+    // MIN_FIRST maps the lowest quantized value to min_a for both types.
+    return {min_a, (max_a - min_a) / 255.0f, 128};
+  }
+  const float max_abs = std::max(std::abs(min_a), std::abs(max_a));
+  if (kIsUnsigned) return {0.0f, max_abs / 255.0f, 128};
+  return {0.0f, max_abs / 127.0f, 0};
+}
+
+}  // namespace
+
+// Computes dequantize(a) x dequantize(b) + bias in float, where `b` holds
+// symmetric qint8 weights with one scalar range or one range per output
+// channel.  The int32 accumulators of a shard of rows are dequantized and
+// biased while they are still in cache.
+template <typename T1>
+class QuantizedMatMulWithBiasAndDequantizeOp : public OpKernel {
+ public:
+  explicit QuantizedMatMulWithBiasAndDequantizeOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("transpose_a", &transpose_a_));
+    OP_REQUIRES_OK(context, context->GetAttr("transpose_b", &transpose_b_));
+    string input_quant_mode;
+    OP_REQUIRES_OK(context,
+                   context->GetAttr("input_quant_mode", &input_quant_mode));
+    min_first_ = input_quant_mode == "MIN_FIRST";
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& a = context->input(0);
+    const Tensor& b = context->input(1);
+    const Tensor& bias = context->input(2);
+    const Tensor& min_b = context->input(5);
+    const Tensor& max_b = context->input(6);
+
+    OP_REQUIRES(context, TensorShapeUtils::IsMatrix(a.shape()),
+                errors::InvalidArgument("In[0] is not a matrix"));
+    OP_REQUIRES(context, TensorShapeUtils::IsMatrix(b.shape()),
+                errors::InvalidArgument("In[1] is not a matrix"));
+    const int64_t m = a.dim_size(transpose_a_ ? 1 : 0);
+    const int64_t k = a.dim_size(transpose_a_ ? 0 : 1);
+    const int64_t n = b.dim_size(transpose_b_ ? 0 : 1);
+    OP_REQUIRES(context, k == b.dim_size(transpose_b_ ? 1 : 0),
+                errors::InvalidArgument("Matrix size-incompatible: In[0]: ",
+                                        a.shape().DebugString(),
+                                        ", In[1]: ", b.shape().DebugString()));
+    OP_REQUIRES(context,
+                std::max({m, k, n}) <= std::numeric_limits<int>::max(),
+                errors::InvalidArgument("Matrix dimensions are too large: ",
+                                        "In[0]: ", a.shape().DebugString(),
+                                        ", In[1]: ", b.shape().DebugString()));
+    OP_REQUIRES(context,
+                TensorShapeUtils::IsVector(bias.shape()) &&
+                    bias.NumElements() == n,
+                errors::InvalidArgument("bias must be a vector of size ", n,
+                                        ", got ", bias.shape().DebugString()));
+    for (int i = 3; i <= 4; ++i) {
+      OP_REQUIRES(context, context->input(i).NumElements() == 1,
+                  errors::InvalidArgument("Input ", i, " must be a scalar"));
+    }
+    OP_REQUIRES(context,
+                min_b.NumElements() == max_b.NumElements() &&
+                    (min_b.NumElements() == 1 || min_b.NumElements() == n),
+                errors::InvalidArgument(
+                    "min_b and max_b must both be scalars or vectors of size ",
+                    n, ", got ", min_b.shape().DebugString(), " and ",
+                    max_b.shape().DebugString()));
+    const float min_a = context->input(3).flat<float>()(0);
+    const float max_a = context->input(4).flat<float>()(0);
+    OP_REQUIRES(context, max_a > min_a,
+                errors::InvalidArgument("max_a must be larger than min_a."));
+
+    Tensor* out = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(0, {m, n}, &out));
+    if (out->NumElements() == 0) return;
+
+    const ActivationRange range =
+        GetActivationRange<T1>(min_a, max_a, min_first_);
+
+    // Per-channel weight scales, and the column sums of the weights, which
+    // account for the activation offset and shift.
+    const bool per_channel = min_b.NumElements() > 1;
+    std::vector<float> b_scales(n);
+    for (int64_t j = 0; j < n; ++j) {
+      const int64_t c = per_channel ? j : 0;
+      b_scales[j] = std::max(std::abs(min_b.flat<float>()(c)),
+                             std::abs(max_b.flat<float>()(c))) /
+                    127.0f;
+    }
+    const int8* b_data = reinterpret_cast<const int8*>(b.flat<qint8>().data());
+    std::vector<int32> b_col_sums(n, 0);
+    if (transpose_b_) {
+      for (int64_t j = 0; j < n; ++j) {
+        for (int64_t p = 0; p < k; ++p) b_col_sums[j] += b_data[j * k + p];
+      }
+    } else {
+      for (int64_t p = 0; p < k; ++p) {
+        for (int64_t j = 0; j < n; ++j) b_col_sums[j] += b_data[p * n + j];
+      }
+    }
+
+    ruy::Matrix<std::int8_t> rhs;
+    ruy::MakeSimpleLayout(k, n,
+                          transpose_b_ ? ruy::Order::kColMajor
+                                       : ruy::Order::kRowMajor,
+                          rhs.mutable_layout());
+    rhs.set_data(b_data);
+
+    const int8* a_data = reinterpret_cast<const int8*>(a.tensor_data().data());
+    const float* bias_data = bias.flat<float>().data();
+    float* out_data = out->flat<float>().data();
+    const bool convert_a = transpose_a_ || std::is_same<T1, quint8>::value;
+
+    auto work = [&](int64_t begin, int64_t end) {
+      const int64_t rows = end - begin;
+      // Activations are handed to ruy as row-major int8; quint8 values are
+      // shifted down by 128 by flipping their sign bit.
+      std::vector<int8> a_rows;
+      const int8* lhs_data = a_data + begin * k;
+      if (convert_a) {
+        a_rows.resize(rows * k);
+        const uint8 flip = std::is_same<T1, quint8>::value ? 0x80 : 0;
+        for (int64_t i = 0; i < rows; ++i) {
+          for (int64_t p = 0; p < k; ++p) {
+            const int8 q = transpose_a_ ? a_data[p * m + begin + i]
+                                        : a_data[(begin + i) * k + p];
+            a_rows[i * k + p] = static_cast<int8>(static_cast<uint8>(q) ^ flip);
+          }
+        }
+        lhs_data = a_rows.data();
+      }
+      ruy::Matrix<std::int8_t> lhs;
+      ruy::MakeSimpleLayout(rows, k, ruy::Order::kRowMajor,
+                            lhs.mutable_layout());
+      lhs.set_data(lhs_data);
+
+      std::vector<int32> acc(rows * n);
+      ruy::Matrix<std::int32_t> dst;
+      ruy::MakeSimpleLayout(rows, n, ruy::Order::kRowMajor,
+                            dst.mutable_layout());
+      dst.set_data(acc.data());
+      ruy::MulParams<std::int32_t, std::int32_t> mul_params;
+      ruy::Mul(lhs, rhs, mul_params, GetThreadLocalRuyContext(), &dst);
+
+      for (int64_t i = 0; i < rows; ++i) {
+        float* out_row = out_data + (begin + i) * n;
+        const int32* acc_row = acc.data() + i * n;
+        for (int64_t j = 0; j < n; ++j) {
+          const float sum =
+              range.scale * (acc_row[j] + range.shift * b_col_sums[j]) +
+              range.offset * b_col_sums[j];
+          out_row[j] = b_scales[j] * sum + bias_data[j];
+        }
+      }
+    };
+
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, m,
+          /*cost_per_unit=*/std::max<int64_t>(1, k * n), work);
+  }
+
+ private:
+  bool transpose_a_;
+  bool transpose_b_;
+  bool min_first_;
+};
+
+#define REGISTER_CPU(T1)                                               \
+  REGISTER_KERNEL_BUILDER(Name("QuantizedMatMulWithBiasAndDequantize") \
+                              .Device(DEVICE_CPU)                      \
+                              .TypeConstraint<T1>("T1")                \
+                              .TypeConstraint<qint8>("T2")             \
+                              .TypeConstraint<float>("Tbias")          \
+                              .TypeConstraint<float>("Toutput"),       \
+                          QuantizedMatMulWithBiasAndDequantizeOp<T1>);
+
+REGISTER_CPU(quint8);
+REGISTER_CPU(qint8);
+
+#undef REGISTER_CPU
+
+}  // namespace tensorflow
+
+#endif  // INTEL_MKL
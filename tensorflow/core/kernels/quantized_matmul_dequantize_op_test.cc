@@ -0,0 +1,175 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef INTEL_MKL
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+
+class QuantizedMatMulWithBiasAndDequantizeTest : public OpsTestBase {
+ protected:
+  void MakeOp(DataType a_type, bool transpose_a, bool transpose_b,
+              const string& input_quant_mode) {
+    TF_ASSERT_OK(NodeDefBuilder("quantized_mat_mul_op",
+                                "QuantizedMatMulWithBiasAndDequantize")
+                     .Input(FakeInput(a_type))
+                     .Input(FakeInput(DT_QINT8))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Attr("Toutput", DT_FLOAT)
+                     .Attr("transpose_a", transpose_a)
+                     .Attr("transpose_b", transpose_b)
+                     .Attr("input_quant_mode", input_quant_mode)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+
+  // Multiplies random [m, k] activations by random [k, n] weights and checks
+  // the result against the product of their dequantized values.
+  template <typename T1>
+  void RunAndCheck(int64_t m, int64_t k, int64_t n, bool transpose_a,
+                   bool transpose_b, bool min_first, bool per_channel) {
+    std::mt19937 gen(m * 10007 + k * 101 + n);
+    const float min_a = min_first ? -1.5f : -2.0f;
+    const float max_a = min_first ? 4.5f : 2.0f;
+    constexpr bool kIsUnsigned = std::is_same<T1, quint8>::value;
+    std::vector<T1> a(m * k);
+    std::vector<float> a_real(m * k);
+    std::uniform_int_distribution<int> a_dist(kIsUnsigned ? 0 : -128,
+                                              kIsUnsigned ? 255 : 127);
+    for (int64_t i = 0; i < m; ++i) {
+      for (int64_t p = 0; p < k; ++p) {
+        const int q = a_dist(gen);
+        a[transpose_a ? p * m + i : i * k + p] = q;
+        a_real[i * k + p] =
+            min_first ? min_a + (q - (kIsUnsigned ? 0 : -128)) *
+                                    (max_a - min_a) / 255.0f
+                      : q * max_a / (kIsUnsigned ? 255.0f : 127.0f);
+      }
+    }
+
+    std::vector<float> min_b(per_channel ? n : 1);
+    std::vector<float> max_b(min_b.size());
+    std::uniform_real_distribution<float> range_dist(0.5f, 3.0f);
+    for (size_t c = 0; c < min_b.size(); ++c) {
+      max_b[c] = range_dist(gen);
+      min_b[c] = -max_b[c];
+    }
+    std::vector<qint8> b(k * n);
+    std::vector<float> b_real(k * n);
+    std::uniform_int_distribution<int> b_dist(-127, 127);
+    for (int64_t p = 0; p < k; ++p) {
+      for (int64_t j = 0; j < n; ++j) {
+        const int q = b_dist(gen);
+        b[transpose_b ? j * k + p : p * n + j] = q;
+        b_real[p * n + j] = q * max_b[per_channel ? j : 0] / 127.0f;
+      }
+    }
+    std::vector<float> bias(n);
+    for (float& v : bias) v = range_dist(gen);
+
+    MakeOp(DataTypeToEnum<T1>::v(), transpose_a, transpose_b,
+           min_first ? "MIN_FIRST" : "SCALED");
+    AddInputFromArray<T1>(
+        transpose_a ? TensorShape({k, m}) : TensorShape({m, k}), a);
+    AddInputFromArray<qint8>(
+        transpose_b ? TensorShape({n, k}) : TensorShape({k, n}), b);
+    AddInputFromArray<float>(TensorShape({n}), bias);
+    AddInputFromArray<float>(TensorShape({}), {min_a});
+    AddInputFromArray<float>(TensorShape({}), {max_a});
+    const TensorShape b_range_shape =
+        per_channel ? TensorShape({n}) : TensorShape({});
+    AddInputFromArray<float>(b_range_shape, min_b);
+    AddInputFromArray<float>(b_range_shape, max_b);
+    AddInputFromArray<float>(TensorShape({}), {0.0f});
+    AddInputFromArray<float>(TensorShape({}), {0.0f});
+    TF_ASSERT_OK(RunOpKernel());
+
+    Tensor expected(DT_FLOAT, TensorShape({m, n}));
+    auto expected_t = expected.matrix<float>();
+    for (int64_t i = 0; i < m; ++i) {
+      for (int64_t j = 0; j < n; ++j) {
+        double sum = bias[j];
+        for (int64_t p = 0; p < k; ++p) {
+          sum += static_cast<double>(a_real[i * k + p]) * b_real[p * n + j];
+        }
+        expected_t(i, j) = sum;
+      }
+    }
+    test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-2);
+  }
+};
+
+TEST_F(QuantizedMatMulWithBiasAndDequantizeTest, Quint8MinFirst) {
+  RunAndCheck<quint8>(/*m=*/7, /*k=*/33, /*n=*/5, /*transpose_a=*/false,
+                      /*transpose_b=*/false, /*min_first=*/true,
+                      /*per_channel=*/false);
+}
+
+TEST_F(QuantizedMatMulWithBiasAndDequantizeTest, Quint8ScaledPerChannel) {
+  RunAndCheck<quint8>(/*m=*/16, /*k=*/64, /*n=*/24, /*transpose_a=*/false,
+                      /*transpose_b=*/true, /*min_first=*/false,
+                      /*per_channel=*/true);
+}
+
+TEST_F(QuantizedMatMulWithBiasAndDequantizeTest, Qint8ScaledTransposed) {
+  RunAndCheck<qint8>(/*m=*/9, /*k=*/17, /*n=*/11, /*transpose_a=*/true,
+                     /*transpose_b=*/true, /*min_first=*/false,
+                     /*per_channel=*/true);
+}
+
+TEST_F(QuantizedMatMulWithBiasAndDequantizeTest, Qint8MinFirstLarge) {
+  RunAndCheck<qint8>(/*m=*/256, /*k=*/128, /*n=*/64, /*transpose_a=*/false,
+                     /*transpose_b=*/false, /*min_first=*/true,
+                     /*per_channel=*/false);
+}
+
+TEST_F(QuantizedMatMulWithBiasAndDequantizeTest, BadWeightRange) {
+  MakeOp(DT_QUINT8, /*transpose_a=*/false, /*transpose_b=*/false, "SCALED");
+  AddInputFromArray<quint8>(TensorShape({1, 2}), {1, 2});
+  AddInputFromArray<qint8>(TensorShape({2, 3}), {1, 2, 3, 4, 5, 6});
+  AddInputFromArray<float>(TensorShape({3}), {0, 0, 0});
+  AddInputFromArray<float>(TensorShape({}), {0.0f});
+  AddInputFromArray<float>(TensorShape({}), {1.0f});
+  // Two ranges for three output channels.
+  AddInputFromArray<float>(TensorShape({2}), {-1.0f, -1.0f});
+  AddInputFromArray<float>(TensorShape({2}), {1.0f, 1.0f});
+  AddInputFromArray<float>(TensorShape({}), {0.0f});
+  AddInputFromArray<float>(TensorShape({}), {0.0f});
+  Status s = RunOpKernel();
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+}
+
+}  // namespace tensorflow
+
+#endif  // INTEL_MKL
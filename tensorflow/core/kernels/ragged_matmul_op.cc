@@ -0,0 +1,148 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/ragged_math_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+namespace {
+
+// Multiplies the rows of each batch element of a ragged [B, (N), K] tensor
+// by that element's [K, M] matrix. Work is split on rows rather than on batch
+// elements, so that a few long rows do not serialize the op: a block of rows
+// is multiplied one batch element at a time, with a single matrix product
+// per element it overlaps.
+template <typename T, typename SPLITS_TYPE>
+class RaggedMatMulOp : public OpKernel {
+ public:
+  using OpKernel::OpKernel;
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& values = context->input(0);
+    const Tensor& row_splits_in = context->input(1);
+    const Tensor& weights = context->input(2);
+    OP_REQUIRES(context, values.dims() == 2,
+                errors::InvalidArgument("values must be a matrix, got ",
+                                        values.shape().DebugString()));
+    OP_REQUIRES(context, row_splits_in.dims() == 1,
+                errors::InvalidArgument("row_splits must be a vector, got ",
+                                        row_splits_in.shape().DebugString()));
+    OP_REQUIRES(context, weights.dims() == 3,
+                errors::InvalidArgument("weights must have rank 3, got ",
+                                        weights.shape().DebugString()));
+    const int64_t batch_size = weights.dim_size(0);
+    const int64_t depth = weights.dim_size(1);
+    const int64_t out_depth = weights.dim_size(2);
+    OP_REQUIRES(context, row_splits_in.NumElements() == batch_size + 1,
+                errors::InvalidArgument(
+                    "row_splits must have one more element than the ",
+                    batch_size, " matrices of weights, got ",
+                    row_splits_in.NumElements()));
+    OP_REQUIRES(context, values.dim_size(1) == depth,
+                errors::InvalidArgument(
+                    "values and weights have incompatible shapes ",
+                    values.shape().DebugString(), " and ",
+                    weights.shape().DebugString()));
+    const auto row_splits = row_splits_in.vec<SPLITS_TYPE>();
+    OP_REQUIRES(context, row_splits(0) == 0,
+                errors::InvalidArgument("row_splits must start with 0, got ",
+                                        row_splits(0)));
+    for (int64_t i = 0; i < batch_size; ++i) {
+      OP_REQUIRES(context, row_splits(i) <= row_splits(i + 1),
+                  errors::InvalidArgument("row_splits must be sorted, got ",
+                                          row_splits(i), " before ",
+                                          row_splits(i + 1)));
+    }
+    const int64_t num_rows = values.dim_size(0);
+    OP_REQUIRES(context, row_splits(batch_size) == num_rows,
+                errors::InvalidArgument(
+                    "row_splits must end with the number of values, got ",
+                    row_splits(batch_size), " for ", num_rows, " values"));
+
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(
+                       0, TensorShape({num_rows, out_depth}), &output));
+    if (output->NumElements() == 0) return;
+    if (depth == 0) {
+      output->flat<T>().setZero();
+      return;
+    }
+
+    const T* in = values.flat<T>().data();
+    const T* w = weights.flat<T>().data();
+    T* out = output->flat<T>().data();
+    // Blocks of rows start anywhere in the tensors, so none of the maps are
+    // aligned.
+    using ConstMatrix =
+        Eigen::TensorMap<Eigen::Tensor<const T, 2, Eigen::RowMajor>,
+                         Eigen::Unaligned>;
+    using Matrix = Eigen::TensorMap<Eigen::Tensor<T, 2, Eigen::RowMajor>,
+                                    Eigen::Unaligned>;
+    const Eigen::array<Eigen::IndexPair<Eigen::DenseIndex>, 1> contract_dims = {
+        Eigen::IndexPair<Eigen::DenseIndex>(1, 0)};
+    auto multiply_rows = [&](int64_t begin, int64_t end) {
+      // The batch element of row `begin`: the last one that starts at or
+      // before it.
+      int64_t b = std::upper_bound(row_splits.data(),
+                                   row_splits.data() + batch_size + 1, begin) -
+                  row_splits.data() - 1;
+      for (int64_t row = begin; row < end; ++b) {
+        const int64_t limit = std::min<int64_t>(end, row_splits(b + 1));
+        if (limit == row) continue;
+        Matrix(out + row * out_depth, limit - row, out_depth) =
+            ConstMatrix(in + row * depth, limit - row, depth)
+                .contract(ConstMatrix(w + b * depth * out_depth, depth,
+                                      out_depth),
+                          contract_dims);
+        row = limit;
+      }
+    };
+    const auto& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
+          /*cost_per_unit=*/2 * depth * out_depth, multiply_rows);
+  }
+};
+
+#define REGISTER_CPU_KERNEL_WITH_SPLITS(value_type, splits_type)       \
+  REGISTER_KERNEL_BUILDER(Name("RaggedMatMul")                         \
+                              .Device(DEVICE_CPU)                      \
+                              .TypeConstraint<value_type>("T")         \
+                              .TypeConstraint<splits_type>("Tsplits"), \
+                          RaggedMatMulOp<value_type, splits_type>);
+#define REGISTER_CPU_KERNEL(value_type)              \
+  REGISTER_CPU_KERNEL_WITH_SPLITS(value_type, int32) \
+  REGISTER_CPU_KERNEL_WITH_SPLITS(value_type, int64_t)
+TF_CALL_half(REGISTER_CPU_KERNEL);
+TF_CALL_bfloat16(REGISTER_CPU_KERNEL);
+TF_CALL_float(REGISTER_CPU_KERNEL);
+TF_CALL_double(REGISTER_CPU_KERNEL);
+#undef REGISTER_CPU_KERNEL
+#undef REGISTER_CPU_KERNEL_WITH_SPLITS
+
+}  // namespace
+}  // namespace tensorflow
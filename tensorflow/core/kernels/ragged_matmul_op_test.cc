@@ -0,0 +1,113 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/shape_inference_testutil.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class RaggedMatMulOpTest : public ::tensorflow::OpsTestBase {
+ protected:
+  // Builds the tensorflow test graph for the RaggedMatMul op.
+  void BuildRaggedMatMulGraph() {
+    TF_ASSERT_OK(NodeDefBuilder("tested_op", "RaggedMatMul")
+                     .Input(FakeInput(DT_FLOAT))  // values
+                     .Input(FakeInput(DT_INT64))  // row_splits
+                     .Input(FakeInput(DT_FLOAT))  // weights
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+};
+
+TEST_F(RaggedMatMulOpTest, Small) {
+  // rt = [[[1, 2], [3, 4]], [], [[5, 6]]]
+  BuildRaggedMatMulGraph();
+  AddInputFromArray<float>(TensorShape({3, 2}), {1, 2, 3, 4, 5, 6});
+  AddInputFromArray<int64_t>(TensorShape({4}), {0, 2, 2, 3});
+  AddInputFromArray<float>(TensorShape({3, 2, 1}), {1, 10, 7, 7, 2, -1});
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorNear<float>(
+      *GetOutput(0), test::AsTensor<float>({21, 43, 4}, TensorShape({3, 1})),
+      1e-5);
+}
+
+TEST_F(RaggedMatMulOpTest, MatchesPerRowProducts) {
+  // Uneven batch elements, including empty ones, with enough rows to be
+  // split across threads in blocks that straddle batch elements.
+  const int kBatchSize = 50;
+  const int kDepth = 8;
+  const int kOutDepth = 5;
+  std::vector<int64_t> row_splits = {0};
+  for (int b = 0; b < kBatchSize; ++b) {
+    row_splits.push_back(row_splits.back() + (b * 37) % 101);
+  }
+  const int64_t num_rows = row_splits.back();
+  std::vector<float> values(num_rows * kDepth);
+  for (int64_t i = 0; i < values.size(); ++i) values[i] = (i % 13) - 6;
+  std::vector<float> weights(kBatchSize * kDepth * kOutDepth);
+  for (int64_t i = 0; i < weights.size(); ++i) weights[i] = (i % 7) - 3;
+
+  BuildRaggedMatMulGraph();
+  AddInputFromArray<float>(TensorShape({num_rows, kDepth}), values);
+  AddInputFromArray<int64_t>(TensorShape({kBatchSize + 1}), row_splits);
+  AddInputFromArray<float>(TensorShape({kBatchSize, kDepth, kOutDepth}),
+                           weights);
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(DT_FLOAT, TensorShape({num_rows, kOutDepth}));
+  auto expected_matrix = expected.matrix<float>();
+  for (int b = 0; b < kBatchSize; ++b) {
+    for (int64_t row = row_splits[b]; row < row_splits[b + 1]; ++row) {
+      for (int m = 0; m < kOutDepth; ++m) {
+        float sum = 0;
+        for (int k = 0; k < kDepth; ++k) {
+          sum += values[row * kDepth + k] *
+                 weights[(b * kDepth + k) * kOutDepth + m];
+        }
+        expected_matrix(row, m) = sum;
+      }
+    }
+  }
+  test::ExpectTensorNear<float>(*GetOutput(0), expected, 1e-4);
+}
+
+TEST_F(RaggedMatMulOpTest, WrongNumberOfMatrices) {
+  BuildRaggedMatMulGraph();
+  AddInputFromArray<float>(TensorShape({2, 1}), {1, 2});
+  AddInputFromArray<int64_t>(TensorShape({3}), {0, 1, 2});
+  AddInputFromArray<float>(TensorShape({1, 1, 1}), {1});
+  EXPECT_TRUE(errors::IsInvalidArgument(RunOpKernel()));
+}
+
+TEST_F(RaggedMatMulOpTest, ShapeFn) {
+  ShapeInferenceTestOp op("RaggedMatMul");
+  INFER_OK(op, "[?,3];[5];[?,3,7]", "[d0_0,d2_2]");
+  INFER_OK(op, "?;?;?", "[?,?]");
+  INFER_ERROR("Dimensions must be equal", op, "[?,3];[5];[?,4,7]");
+  INFER_ERROR("Dimensions must be equal", op, "[?,3];[5];[3,3,7]");
+}
+
+}  // namespace
+}  // namespace tensorflow
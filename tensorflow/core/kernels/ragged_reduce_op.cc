@@ -0,0 +1,220 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/ragged_math_ops.cc.
+
+#include <algorithm>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+namespace {
+
+// Values are accumulated in float for the 16-bit floating point types.
+template <typename T>
+using AccumType =
+    typename std::conditional<std::is_same<T, Eigen::half>::value ||
+                                  std::is_same<T, bfloat16>::value,
+                              float, T>::type;
+
+template <typename T>
+struct SumReducer {
+  using A = AccumType<T>;
+  static A Identity() { return A(0); }
+  static A Combine(A a, A b) { return a + b; }
+};
+
+template <typename T>
+struct ProdReducer {
+  using A = AccumType<T>;
+  static A Identity() { return A(1); }
+  static A Combine(A a, A b) { return a * b; }
+};
+
+// The identities of max and min match those of UnsortedSegmentMax and
+// UnsortedSegmentMin, which the segment-based reductions produce for empty
+// rows.
+template <typename T>
+struct MaxReducer {
+  using A = AccumType<T>;
+  static A Identity() { return static_cast<A>(Eigen::NumTraits<T>::lowest()); }
+  static A Combine(A a, A b) { return a < b ? b : a; }
+};
+
+template <typename T>
+struct MinReducer {
+  using A = AccumType<T>;
+  static A Identity() {
+    return static_cast<A>(Eigen::NumTraits<T>::highest());
+  }
+  static A Combine(A a, A b) { return b < a ? b : a; }
+};
+
+enum class Reduction { kSum, kMean, kMax, kMin, kProd };
+
+// Reduces each row of a ragged tensor with one ragged dimension in place,
+// instead of computing segment ids and running a segment reduction.
+template <typename T, typename SPLITS_TYPE>
+class RaggedReduceOp : public OpKernel {
+ public:
+  explicit RaggedReduceOp(OpKernelConstruction* context) : OpKernel(context) {
+    string reduction;
+    OP_REQUIRES_OK(context, context->GetAttr("reduction", &reduction));
+    if (reduction == "sum") {
+      reduction_ = Reduction::kSum;
+    } else if (reduction == "mean") {
+      reduction_ = Reduction::kMean;
+    } else if (reduction == "max") {
+      reduction_ = Reduction::kMax;
+    } else if (reduction == "min") {
+      reduction_ = Reduction::kMin;
+    } else {
+      OP_REQUIRES(context, reduction == "prod",
+                  errors::InvalidArgument("Unknown reduction: ", reduction));
+      reduction_ = Reduction::kProd;
+    }
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& values = context->input(0);
+    const Tensor& row_splits_in = context->input(1);
+    OP_REQUIRES(context, values.dims() >= 1,
+                errors::InvalidArgument("values must have rank at least 1"));
+    OP_REQUIRES(context, row_splits_in.dims() == 1,
+                errors::InvalidArgument("row_splits must be a vector, got ",
+                                        row_splits_in.shape().DebugString()));
+    OP_REQUIRES(context, row_splits_in.NumElements() > 0,
+                errors::InvalidArgument("row_splits must not be empty"));
+    const auto row_splits = row_splits_in.vec<SPLITS_TYPE>();
+    const int64_t num_rows = row_splits.size() - 1;
+    OP_REQUIRES(context, row_splits(0) == 0,
+                errors::InvalidArgument("row_splits must start with 0, got ",
+                                        row_splits(0)));
+    for (int64_t i = 0; i < num_rows; ++i) {
+      OP_REQUIRES(context, row_splits(i) <= row_splits(i + 1),
+                  errors::InvalidArgument("row_splits must be sorted, got ",
+                                          row_splits(i), " before ",
+                                          row_splits(i + 1)));
+    }
+    OP_REQUIRES(context, row_splits(num_rows) == values.dim_size(0),
+                errors::InvalidArgument(
+                    "row_splits must end with the number of values, got ",
+                    row_splits(num_rows), " for ", values.dim_size(0),
+                    " values"));
+
+    TensorShape output_shape = values.shape();
+    output_shape.set_dim(0, num_rows);
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(0, output_shape, &output));
+    if (output->NumElements() == 0) return;
+
+    switch (reduction_) {
+      case Reduction::kSum:
+        ReduceRows<SumReducer<T>>(context, values, row_splits, false, output);
+        break;
+      case Reduction::kMean:
+        ReduceRows<SumReducer<T>>(context, values, row_splits, true, output);
+        break;
+      case Reduction::kMax:
+        ReduceRows<MaxReducer<T>>(context, values, row_splits, false, output);
+        break;
+      case Reduction::kMin:
+        ReduceRows<MinReducer<T>>(context, values, row_splits, false, output);
+        break;
+      case Reduction::kProd:
+        ReduceRows<ProdReducer<T>>(context, values, row_splits, false, output);
+        break;
+    }
+  }
+
+ private:
+  // Reduces rows in blocks, keeping the running result of one row in a
+  // buffer of the inner size so that the inner loop is contiguous.
+  template <typename Reducer>
+  static void ReduceRows(OpKernelContext* context, const Tensor& values,
+                         typename TTypes<SPLITS_TYPE>::ConstVec row_splits,
+                         bool mean, Tensor* output) {
+    using A = typename Reducer::A;
+    const int64_t num_rows = row_splits.size() - 1;
+    const int64_t inner_size = output->NumElements() / num_rows;
+    const T* in = values.flat<T>().data();
+    T* out = output->flat<T>().data();
+    auto reduce = [&](int64_t begin, int64_t end) {
+      std::vector<A> accum(inner_size);
+      for (int64_t row = begin; row < end; ++row) {
+        std::fill(accum.begin(), accum.end(), Reducer::Identity());
+        const int64_t start = row_splits(row);
+        const int64_t limit = row_splits(row + 1);
+        for (int64_t i = start; i < limit; ++i) {
+          const T* value = in + i * inner_size;
+          for (int64_t j = 0; j < inner_size; ++j) {
+            accum[j] = Reducer::Combine(accum[j], static_cast<A>(value[j]));
+          }
+        }
+        T* out_row = out + row * inner_size;
+        if (mean && std::is_integral<A>::value && start == limit) {
+          // Integer means of empty rows are 0 rather than a division by zero.
+          std::fill(out_row, out_row + inner_size, T(0));
+        } else if (mean) {
+          const A count = static_cast<A>(limit - start);
+          for (int64_t j = 0; j < inner_size; ++j) {
+            out_row[j] = static_cast<T>(accum[j] / count);
+          }
+        } else {
+          for (int64_t j = 0; j < inner_size; ++j) {
+            out_row[j] = static_cast<T>(accum[j]);
+          }
+        }
+      }
+    };
+    const int64_t cost_per_row =
+        (values.dim_size(0) / num_rows + 1) * inner_size;
+    const auto& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
+          cost_per_row, reduce);
+  }
+
+  Reduction reduction_;
+};
+
+#define REGISTER_CPU_KERNEL_WITH_SPLITS(value_type, splits_type)       \
+  REGISTER_KERNEL_BUILDER(Name("RaggedReduce")                         \
+                              .Device(DEVICE_CPU)                      \
+                              .TypeConstraint<value_type>("T")         \
+                              .TypeConstraint<splits_type>("Tsplits"), \
+                          RaggedReduceOp<value_type, splits_type>);
+#define REGISTER_CPU_KERNEL(value_type)              \
+  REGISTER_CPU_KERNEL_WITH_SPLITS(value_type, int32) \
+  REGISTER_CPU_KERNEL_WITH_SPLITS(value_type, int64_t)
+TF_CALL_half(REGISTER_CPU_KERNEL);
+TF_CALL_bfloat16(REGISTER_CPU_KERNEL);
+TF_CALL_float(REGISTER_CPU_KERNEL);
+TF_CALL_double(REGISTER_CPU_KERNEL);
+TF_CALL_int32(REGISTER_CPU_KERNEL);
+TF_CALL_int64(REGISTER_CPU_KERNEL);
+#undef REGISTER_CPU_KERNEL
+#undef REGISTER_CPU_KERNEL_WITH_SPLITS
+
+}  // namespace
+}  // namespace tensorflow
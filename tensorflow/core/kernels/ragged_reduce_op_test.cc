@@ -0,0 +1,149 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cmath>
+#include <limits>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/shape_inference_testutil.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class RaggedReduceOpTest : public ::tensorflow::OpsTestBase {
+ protected:
+  // Builds the tensorflow test graph for the RaggedReduce op.
+  template <typename T>
+  void BuildRaggedReduceGraph(const string& reduction) {
+    const auto& dtype = DataTypeToEnum<T>::v();
+    TF_ASSERT_OK(NodeDefBuilder("tested_op", "RaggedReduce")
+                     .Input(FakeInput(dtype))     // values
+                     .Input(FakeInput(DT_INT64))  // row_splits
+                     .Attr("reduction", reduction)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+};
+
+TEST_F(RaggedReduceOpTest, Sum) {
+  BuildRaggedReduceGraph<int>("sum");
+  AddInputFromArray<int>(TensorShape({5}), {1, 2, 3, 4, 5});
+  AddInputFromArray<int64_t>(TensorShape({4}), {0, 2, 2, 5});
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorEqual<int>(*GetOutput(0), test::AsTensor<int>({3, 0, 12}));
+}
+
+TEST_F(RaggedReduceOpTest, MaxAndMinOfInnerDimensions) {
+  // rt = [[[1, 8], [3, 2]], [], [[5, 6]]]
+  BuildRaggedReduceGraph<float>("max");
+  AddInputFromArray<float>(TensorShape({3, 2}), {1, 8, 3, 2, 5, 6});
+  AddInputFromArray<int64_t>(TensorShape({4}), {0, 2, 2, 3});
+  TF_ASSERT_OK(RunOpKernel());
+  const float lowest = std::numeric_limits<float>::lowest();
+  test::ExpectTensorEqual<float>(
+      *GetOutput(0), test::AsTensor<float>({3, 8, lowest, lowest, 5, 6},
+                                           TensorShape({3, 2})));
+}
+
+TEST_F(RaggedReduceOpTest, Min) {
+  BuildRaggedReduceGraph<int64_t>("min");
+  AddInputFromArray<int64_t>(TensorShape({4}), {4, -2, 7, 3});
+  AddInputFromArray<int64_t>(TensorShape({3}), {0, 0, 4});
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorEqual<int64_t>(
+      *GetOutput(0),
+      test::AsTensor<int64_t>({std::numeric_limits<int64_t>::max(), -2}));
+}
+
+TEST_F(RaggedReduceOpTest, Mean) {
+  BuildRaggedReduceGraph<float>("mean");
+  AddInputFromArray<float>(TensorShape({5}), {1, 2, 3, 4, 5});
+  AddInputFromArray<int64_t>(TensorShape({4}), {0, 2, 2, 5});
+  TF_ASSERT_OK(RunOpKernel());
+  const auto output = GetOutput(0)->vec<float>();
+  ASSERT_EQ(output.size(), 3);
+  EXPECT_FLOAT_EQ(output(0), 1.5);
+  EXPECT_TRUE(std::isnan(output(1)));
+  EXPECT_FLOAT_EQ(output(2), 4);
+}
+
+TEST_F(RaggedReduceOpTest, IntegerMeanOfEmptyRow) {
+  BuildRaggedReduceGraph<int>("mean");
+  AddInputFromArray<int>(TensorShape({2}), {3, 5});
+  AddInputFromArray<int64_t>(TensorShape({3}), {0, 0, 2});
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorEqual<int>(*GetOutput(0), test::AsTensor<int>({0, 4}));
+}
+
+TEST_F(RaggedReduceOpTest, Prod) {
+  BuildRaggedReduceGraph<double>("prod");
+  AddInputFromArray<double>(TensorShape({4}), {2, 3, 4, 5});
+  AddInputFromArray<int64_t>(TensorShape({4}), {0, 3, 3, 4});
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorEqual<double>(*GetOutput(0),
+                                  test::AsTensor<double>({24, 1, 5}));
+}
+
+TEST_F(RaggedReduceOpTest, ManyRows) {
+  // Enough rows to be split across threads.
+  const int kNumRows = 10000;
+  BuildRaggedReduceGraph<float>("sum");
+  std::vector<float> values;
+  std::vector<int64_t> row_splits = {0};
+  for (int i = 0; i < kNumRows; ++i) {
+    for (int j = 0; j < i % 7; ++j) values.push_back(i);
+    row_splits.push_back(values.size());
+  }
+  AddInputFromArray<float>(TensorShape({static_cast<int64_t>(values.size())}),
+                           values);
+  AddInputFromArray<int64_t>(TensorShape({kNumRows + 1}), row_splits);
+  TF_ASSERT_OK(RunOpKernel());
+  const auto output = GetOutput(0)->vec<float>();
+  for (int i = 0; i < kNumRows; ++i) {
+    ASSERT_EQ(output(i), static_cast<float>(i) * (i % 7)) << i;
+  }
+}
+
+TEST_F(RaggedReduceOpTest, InvalidRowSplits) {
+  BuildRaggedReduceGraph<float>("sum");
+  AddInputFromArray<float>(TensorShape({3}), {1, 2, 3});
+  AddInputFromArray<int64_t>(TensorShape({3}), {0, 2, 1});
+  EXPECT_TRUE(errors::IsInvalidArgument(RunOpKernel()));
+}
+
+TEST_F(RaggedReduceOpTest, RowSplitsDoNotCoverValues) {
+  BuildRaggedReduceGraph<float>("sum");
+  AddInputFromArray<float>(TensorShape({3}), {1, 2, 3});
+  AddInputFromArray<int64_t>(TensorShape({2}), {0, 2});
+  EXPECT_TRUE(errors::IsInvalidArgument(RunOpKernel()));
+}
+
+TEST_F(RaggedReduceOpTest, ShapeFn) {
+  ShapeInferenceTestOp op("RaggedReduce");
+  INFER_OK(op, "[?,2,3];[5]", "[4,d0_1,d0_2]");
+  INFER_OK(op, "[?];[?]", "[?]");
+  INFER_ERROR("must be at least rank 1", op, "[];[?]");
+  INFER_ERROR("must be rank 1", op, "[?];[?,?]");
+}
+
+}  // namespace
+}  // namespace tensorflow
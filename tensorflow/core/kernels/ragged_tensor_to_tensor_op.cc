@@ -40,6 +40,7 @@ limitations under the License.
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/bcast.h"
 #include "tensorflow/core/util/ragged_to_dense_util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -397,6 +398,18 @@ class RaggedTensorToTensorBaseOp : public OpKernel {
                    context->allocate_output(0, output_shape, &output_tensor));
     const INDEX_TYPE full_size = multiplier[0] * output_size[0];
     if (full_size > 0) {
+      // A single level of row splits is written one output row at a time,
+      // without computing the output index of every value first. Malformed
+      // splits take the general path below, which reports the error.
+      if (ragged_rank_ == 1 &&
+          row_partition_types_[0] == RowPartitionType::ROW_SPLITS &&
+          IsValidRowSplits(first_partition_tensor.flat<INDEX_TYPE>(),
+                           context->input(kValueInputIndex))) {
+        SetOutputFromRowSplits(context,
+                               first_partition_tensor.flat<INDEX_TYPE>(),
+                               output_tensor);
+        return;
+      }
       vector<INDEX_TYPE> output_index, new_output_index;
       int nvals = context->input(kValueInputIndex).shape().dim_size(0);
       output_index.reserve(nvals);
@@ -419,6 +432,23 @@ class RaggedTensorToTensorBaseOp : public OpKernel {
                          const vector<INDEX_TYPE>& output_index,
                          Tensor* output_tensor) = 0;
 
+  // Writes the output of a ragged tensor with a single level of
+  // `row_splits`, which have been checked by IsValidRowSplits.
+  virtual void SetOutputFromRowSplits(OpKernelContext* context,
+                                      const RowPartitionTensor& row_splits,
+                                      Tensor* output_tensor) = 0;
+
+  static bool IsValidRowSplits(const RowPartitionTensor& row_splits,
+                               const Tensor& values) {
+    if (values.dims() == 0 || row_splits.size() == 0 || row_splits(0) != 0) {
+      return false;
+    }
+    for (int64_t i = 1; i < row_splits.size(); ++i) {
+      if (row_splits(i) < row_splits(i - 1)) return false;
+    }
+    return row_splits(row_splits.size() - 1) == values.dim_size(0);
+  }
+
  private:
   vector<RowPartitionType> row_partition_types_;
   int ragged_rank_;
@@ -488,30 +518,10 @@ class RaggedTensorToTensorOp : public RaggedTensorToTensorBaseOp<INDEX_TYPE> {
     int value_element_size = element_shape.num_elements();
     size_t output_index_size = output_index.size();
 
-    // Broadcast the default value to value_element_size.  (We can skip this
-    // if default_value_tensor.NumElements() == 1, since we use std::fill
-    // when that's true.)
-    const VALUE_TYPE* default_value =
-        default_value_tensor.flat<VALUE_TYPE>().data();
+    const VALUE_TYPE* default_value;
     Tensor bcast_default;  // Temporary tensor for result of broadcast
-    if (default_value_tensor.NumElements() != value_element_size &&
-        default_value_tensor.NumElements() != 1) {
-      const auto& src_shape = default_value_tensor.shape();
-      BCast bcast(BCast::FromShape(src_shape), BCast::FromShape(element_shape),
-                  /*fewer_dims_optimization=*/true);
-      // Note: bcast should always be valid, since we rejected any incompatible
-      // shapes when we called ValidateDefaultValueShape().
-      OP_REQUIRES(context, bcast.IsValid(),
-                  errors::InvalidArgument("Error broadcasting default_value"));
-      OP_REQUIRES_OK(context,
-                     context->allocate_temp(default_value_tensor.dtype(),
-                                            element_shape, &bcast_default));
-      const CPUDevice& device = context->eigen_device<CPUDevice>();
-      functor::BroadcastTo<CPUDevice, VALUE_TYPE>()(
-          device, context, bcast_default, element_shape, default_value_tensor,
-          src_shape, bcast);
-      default_value = bcast_default.flat<VALUE_TYPE>().data();
-    }
+    OP_REQUIRES_OK(context, GetDefaultValue(context, element_shape,
+                                            &bcast_default, &default_value));
 
     // Loop through the output_index vector, finding contiguous regions that
     // should be copied.  Once we find the end of a contiguous region, copy it
@@ -576,6 +586,92 @@ class RaggedTensorToTensorOp : public RaggedTensorToTensorBaseOp<INDEX_TYPE> {
       }
     }
   }
+
+  void SetOutputFromRowSplits(
+      OpKernelContext* context,
+      const typename RaggedTensorToTensorBaseOp<INDEX_TYPE>::RowPartitionTensor&
+          row_splits,
+      Tensor* output_tensor) override {
+    if (output_tensor->NumElements() == 0) return;
+
+    const auto& values_tensor = context->input(kValueInputIndex);
+    const VALUE_TYPE* values_base = values_tensor.flat<VALUE_TYPE>().data();
+    VALUE_TYPE* output_base = output_tensor->flat<VALUE_TYPE>().data();
+    TensorShape element_shape = output_tensor->shape();
+    element_shape.RemoveDimRange(0, 2);
+    const int64_t value_element_size = element_shape.num_elements();
+    const int64_t num_rows = output_tensor->dim_size(0);
+    const int64_t row_size = output_tensor->dim_size(1) * value_element_size;
+    const int64_t num_input_rows = row_splits.size() - 1;
+
+    const VALUE_TYPE* default_value;
+    Tensor bcast_default;
+    OP_REQUIRES_OK(context, GetDefaultValue(context, element_shape,
+                                            &bcast_default, &default_value));
+    const bool scalar_default =
+        context->input(kDefaultValueInputIndex).NumElements() == 1;
+
+    // Each output row is a copy of the (possibly truncated) input row followed
+    // by padding, so blocks of rows are independent.
+    auto write_rows = [&](int64_t begin, int64_t end) {
+      for (int64_t row = begin; row < end; ++row) {
+        VALUE_TYPE* dst = output_base + row * row_size;
+        int64_t copied = 0;
+        if (row < num_input_rows) {
+          const int64_t start = row_splits(row);
+          copied = std::min<int64_t>(
+              (row_splits(row + 1) - start) * value_element_size, row_size);
+          copy_array<VALUE_TYPE, INDEX_TYPE>(
+              dst, values_base + start * value_element_size, copied);
+        }
+        if (scalar_default) {
+          std::fill(dst + copied, dst + row_size, *default_value);
+        } else {
+          for (; copied < row_size; copied += value_element_size) {
+            copy_array<VALUE_TYPE, INDEX_TYPE>(dst + copied, default_value,
+                                               value_element_size);
+          }
+        }
+      }
+    };
+    const auto& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
+          /*cost_per_unit=*/row_size, write_rows);
+  }
+
+ private:
+  // Returns in `default_value` the default value broadcast to
+  // `element_shape`, using `bcast_default` as storage if needed. (The
+  // broadcast is skipped if the default value is a scalar, since callers use
+  // std::fill in that case.)
+  Status GetDefaultValue(OpKernelContext* context,
+                         const TensorShape& element_shape,
+                         Tensor* bcast_default,
+                         const VALUE_TYPE** default_value) {
+    const auto& default_value_tensor = context->input(kDefaultValueInputIndex);
+    *default_value = default_value_tensor.flat<VALUE_TYPE>().data();
+    if (default_value_tensor.NumElements() == element_shape.num_elements() ||
+        default_value_tensor.NumElements() == 1) {
+      return Status::OK();
+    }
+    const auto& src_shape = default_value_tensor.shape();
+    BCast bcast(BCast::FromShape(src_shape), BCast::FromShape(element_shape),
+                /*fewer_dims_optimization=*/true);
+    // Note: bcast should always be valid, since we rejected any incompatible
+    // shapes when we called ValidateDefaultValueShape().
+    if (!bcast.IsValid()) {
+      return errors::InvalidArgument("Error broadcasting default_value");
+    }
+    TF_RETURN_IF_ERROR(context->allocate_temp(default_value_tensor.dtype(),
+                                              element_shape, bcast_default));
+    const CPUDevice& device = context->eigen_device<CPUDevice>();
+    functor::BroadcastTo<CPUDevice, VALUE_TYPE>()(
+        device, context, *bcast_default, element_shape, default_value_tensor,
+        src_shape, bcast);
+    *default_value = bcast_default->flat<VALUE_TYPE>().data();
+    return Status::OK();
+  }
 };
 
 #define REGISTER_CPU_KERNEL_INDEX_TYPE(value_type, index_type)       \
@@ -409,6 +409,71 @@ TEST_F(RaggedTensorToTensorOpTest, RaggedTensorToTensorConstrained) {
                                 0.01);
 }
 
+TEST_F(RaggedTensorToTensorOpTest, RaggedTensorToTensorRowSplitsConstrained) {
+  // params = [[.1, .2, .3],
+  //           [],
+  //           [.4, .5, .6, .7],
+  //           [.8, .9]]
+  // constrained to (3, 3)
+  BuildRaggedTensorToTensorGraph<float, int32>(
+      TensorShape({3, 3}),  // shape
+      {"ROW_SPLITS"},       // row_partition_types
+      createVector<float>({.1, .2, .3, .4, .5, .6, .7, .8, .9}),  // values
+      createScalar<float>(1.5),               // default_value
+      {createVector<int32>({0, 3, 3, 7, 9})}  // row_partition_tensors
+  );
+
+  TF_ASSERT_OK(RunOpKernel());
+
+  test::ExpectTensorNear<float>(*GetOutput(0),
+                                test::AsTensor<float>(
+                                    {
+                                        //
+                                        .1, .2, .3,     //
+                                        1.5, 1.5, 1.5,  //
+                                        .4, .5, .6      //
+                                    },
+                                    TensorShape({3, 3})),
+                                0.01);
+}
+
+TEST_F(RaggedTensorToTensorOpTest, RaggedTensorToTensorRowSplitsManyRows) {
+  // Enough rows to be written by several threads, with one more output row
+  // than input rows and a default value that is broadcast to each element.
+  const int kNumRows = 5000;
+  const int kWidth = 6;
+  std::vector<int64_t> values;
+  std::vector<int64_t> row_splits = {0};
+  for (int i = 0; i < kNumRows; ++i) {
+    for (int j = 0; j < i % 9; ++j) {
+      values.push_back(i);
+      values.push_back(-j);
+    }
+    row_splits.push_back(values.size() / 2);
+  }
+  const int64_t num_values = values.size() / 2;
+  BuildRaggedTensorToTensorGraph<int64_t, int64_t>(
+      TensorShape({kNumRows + 1, kWidth, 2}),  // shape
+      {"ROW_SPLITS"},                          // row_partition_types
+      {TensorShape({num_values, 2}), values},  // values
+      {TensorShape({2}), {7, 8}},              // default_value
+      {createVector<int64_t>(row_splits)}      // row_partition_tensors
+  );
+
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(DT_INT64, TensorShape({kNumRows + 1, kWidth, 2}));
+  auto expected_values = expected.tensor<int64_t, 3>();
+  for (int i = 0; i <= kNumRows; ++i) {
+    for (int j = 0; j < kWidth; ++j) {
+      const bool present = i < kNumRows && j < i % 9;
+      expected_values(i, j, 0) = present ? i : 7;
+      expected_values(i, j, 1) = present ? -j : 8;
+    }
+  }
+  test::ExpectTensorEqual<int64_t>(*GetOutput(0), expected);
+}
+
 TEST_F(RaggedTensorToTensorOpTest, RaggedTensorToTensor_3DParamsConstrained) {
   // params = [
   //           [[]],
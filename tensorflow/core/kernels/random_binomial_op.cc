@@ -419,7 +419,7 @@ class RandomBinomialOp : public OpKernel {
                     PHILOX_MIN_STATE_SIZE, "; got ", var_tensor_flat.size()));
 
     OP_REQUIRES_OK(ctx, PrepareToUpdateVariable<Device, StateElementType>(
-                            ctx, var_tensor, var->copy_on_read_mode.load()));
+                            ctx, var_tensor));
     auto var_data = var_tensor_flat.data();
     auto philox = GetPhiloxRandomFromMem(var_data);
     UpdateMemWithPhiloxRandom(
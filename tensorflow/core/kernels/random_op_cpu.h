@@ -21,6 +21,7 @@ limitations under the License.
 #include <algorithm>
 #include <cmath>
 #include <memory>
+#include <type_traits>
 
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
@@ -72,6 +73,48 @@ struct FillPhiloxRandom {
   }
 };
 
+// A generator that returns the same stream as the PhiloxRandom it is built
+// from, but computes the blocks kBatchSize at a time with
+// PhiloxRandom::Generate, which vectorizes across blocks.
+class BatchedPhiloxRandom {
+ public:
+  using ResultType = PhiloxRandom::ResultType;
+  using ResultElementType = PhiloxRandom::ResultElementType;
+  static constexpr int kResultElementCount = PhiloxRandom::kResultElementCount;
+  static constexpr int kElementCost = PhiloxRandom::kElementCost;
+  static constexpr int kBatchSize = 16;
+
+  explicit BatchedPhiloxRandom(PhiloxRandom gen) : gen_(gen) {}
+
+  ResultType operator()() {
+    if (next_ == kBatchSize) {
+      gen_.Generate<kBatchSize>(batch_);
+      next_ = 0;
+    }
+    return batch_[next_++];
+  }
+
+ private:
+  PhiloxRandom gen_;
+  ResultType batch_[kBatchSize];
+  int next_ = kBatchSize;
+};
+
+// Rebinds a distribution over PhiloxRandom to BatchedPhiloxRandom. This is
+// only possible for distributions without state, since the rebound
+// distribution is default constructed.
+template <class Distribution>
+struct BatchedDistribution {
+  static constexpr bool kEnabled = false;
+};
+
+template <template <class, typename> class Distribution, typename T>
+struct BatchedDistribution<Distribution<PhiloxRandom, T>> {
+  static constexpr bool kEnabled =
+      std::is_empty<Distribution<PhiloxRandom, T>>::value;
+  using type = Distribution<BatchedPhiloxRandom, T>;
+};
+
 // A class to fill a specified range of random groups
 template <class Distribution, bool VariableSamplesPerOutput>
 struct FillPhiloxRandomTask;
@@ -83,15 +126,40 @@ struct FillPhiloxRandomTask<Distribution, false> {
   typedef typename Distribution::ResultElementType T;
   static void Run(random::PhiloxRandom gen, T* data, int64_t size,
                   int64_t start_group, int64_t limit_group, Distribution dist) {
-    const int kGroupSize = Distribution::kResultElementCount;
-
     gen.Skip(start_group);
+    Run(gen, data, size, start_group, limit_group, dist,
+        std::integral_constant<bool,
+                               BatchedDistribution<Distribution>::kEnabled>());
+  }
+
+ private:
+  static void Run(random::PhiloxRandom gen, T* data, int64_t size,
+                  int64_t start_group, int64_t limit_group, Distribution dist,
+                  std::false_type /* batched */) {
+    FillGroups(&gen, data, size, start_group, limit_group, dist);
+  }
+
+  // Each group takes one block from the generator, so the groups are the same
+  // whether the blocks are computed one or many at a time.
+  static void Run(random::PhiloxRandom gen, T* data, int64_t size,
+                  int64_t start_group, int64_t limit_group, Distribution dist,
+                  std::true_type /* batched */) {
+    BatchedPhiloxRandom batched_gen(gen);
+    FillGroups(&batched_gen, data, size, start_group, limit_group,
+               typename BatchedDistribution<Distribution>::type());
+  }
+
+  template <class Generator, class GeneratorDistribution>
+  static void FillGroups(Generator* gen, T* data, int64_t size,
+                         int64_t start_group, int64_t limit_group,
+                         GeneratorDistribution dist) {
+    const int kGroupSize = Distribution::kResultElementCount;
     int64_t offset = start_group * kGroupSize;
 
     // First fill all the full-size groups
     int64_t limit_group_full = std::min(limit_group, size / kGroupSize);
     for (int64_t index = start_group; index < limit_group_full; ++index) {
-      auto samples = dist(&gen);
+      auto samples = dist(gen);
       std::copy(&samples[0], &samples[0] + kGroupSize, data + offset);
       offset += kGroupSize;
     }
@@ -99,7 +167,7 @@ struct FillPhiloxRandomTask<Distribution, false> {
     // If there are any remaining elements that need to be filled, process them
     if (limit_group_full < limit_group) {
       int64_t remaining_size = size - limit_group_full * kGroupSize;
-      auto samples = dist(&gen);
+      auto samples = dist(gen);
       std::copy(&samples[0], &samples[0] + remaining_size, data + offset);
     }
   }
@@ -23,9 +23,33 @@ limitations under the License.
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/util/ptr_util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
+namespace {
+
+// Rough cost, in cycles, of matching one string against a pattern.
+constexpr int64_t kFullMatchCostPerElement = 1000;
+
+// Sets each element of `output` to whether the corresponding element of
+// `input` fully matches `regex`, sharding the work over the intra-op pool.
+// RE2 is thread-safe, so all shards share `regex`.
+void FullMatchAll(OpKernelContext* ctx, const RE2& regex,
+                  TTypes<tstring>::ConstFlat input,
+                  TTypes<bool>::Flat output) {
+  const DeviceBase::CpuWorkerThreads& worker_threads =
+      *ctx->device()->tensorflow_cpu_worker_threads();
+  Shard(worker_threads.num_threads, worker_threads.workers, input.size(),
+        kFullMatchCostPerElement, [&](int64_t start, int64_t limit) {
+          for (int64_t i = start; i < limit; ++i) {
+            output(i) = RE2::FullMatch(input(i), regex);
+          }
+        });
+}
+
+}  // namespace
+
 class RegexFullMatchOp : public OpKernel {
  public:
   explicit RegexFullMatchOp(OpKernelConstruction* ctx) : OpKernel(ctx) {}
@@ -51,10 +75,7 @@ class RegexFullMatchOp : public OpKernel {
     Tensor* output_tensor = nullptr;
     OP_REQUIRES_OK(ctx, ctx->allocate_output("output", input_tensor->shape(),
                                              &output_tensor));
-    auto output_flat = output_tensor->flat<bool>();
-    for (size_t i = 0; i < input_flat.size(); ++i) {
-      output_flat(i) = RE2::FullMatch(input_flat(i), *regex);
-    }
+    FullMatchAll(ctx, *regex, input_flat, output_tensor->flat<bool>());
   }
 
  private:
@@ -104,10 +125,7 @@ class StaticRegexFullMatchOp : public OpKernel {
     Tensor* output_tensor = nullptr;
     OP_REQUIRES_OK(ctx, ctx->allocate_output("output", input_tensor->shape(),
                                              &output_tensor));
-    auto output_flat = output_tensor->flat<bool>();
-    for (size_t i = 0; i < input_flat.size(); ++i) {
-      output_flat(i) = RE2::FullMatch(input_flat(i), *re_);
-    }
+    FullMatchAll(ctx, *re_, input_flat, output_tensor->flat<bool>());
   }
 
  private:
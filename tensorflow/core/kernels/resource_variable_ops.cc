@@ -93,42 +93,22 @@ ReadVariableOp::ReadVariableOp(OpKernelConstruction* c) : OpKernel(c) {
 
 namespace {
 
-Status CopyVariable(int output_idx, OpKernelContext* ctx, const Tensor* t) {
-  Tensor* output;
-  Notification n;
-  Status status;
-  AllocatorAttributes attr;
-  if (t->dtype() == DT_VARIANT) {
-    attr.set_on_host(true);
-  }
-  TF_RETURN_IF_ERROR(
-      ctx->allocate_output(output_idx, t->shape(), &output, attr));
-  if (t->dtype() == DT_VARIANT) {
-    output->flat<Variant>() = t->flat<Variant>();
-  } else if (ctx->op_device_context() != nullptr) {
-    // TODO(apassos): remove the down_cast by just returning Device* from
-    // OpKernelContext
-    Device* device = down_cast<Device*>(ctx->device());
-    ctx->op_device_context()->CopyTensorInSameDevice(
-        t, device, output, [&n, &status](const Status& s) {
-          status = s;
-          n.Notify();
-        });
-    n.WaitForNotification();
-    return status;
-  } else {
-    switch (t->dtype()) {
-#define HANDLER(type)                       \
-  case DataTypeToEnum<type>::value:         \
-    output->flat<type>() = t->flat<type>(); \
-    break;
-      TF_CALL_ALL_TYPES(HANDLER);
-#undef HANDLER
-      default:
-        return errors::Internal("Unsupported dtype", t->dtype());
-    }
+// Returns the value of `variable` for a dense read, sharing its buffer. Sparse
+// operations on a variable in copy-on-read mode may update it in place while
+// holding only a shared lock, so such a variable is switched back to
+// copy-on-write mode under an exclusive lock first. Its buffer is then copied
+// by the next sparse or dense update only if the value read is still alive.
+Tensor ReadVariableWithoutCopy(Var* variable) {
+  {
+    // We're acquiring a reference to the underlying buffer while
+    // holding a shared lock to guarantee ordering of reads and
+    // writes.
+    tf_shared_lock ml(*variable->mu());
+    if (!variable->copy_on_read_mode.load()) return *variable->tensor();
   }
-  return Status::OK();
+  mutex_lock ml(*variable->mu());
+  variable->copy_on_read_mode.store(false);
+  return *variable->tensor();
 }
 
 }  // namespace
@@ -144,22 +124,15 @@ void ReadVariableOp::Compute(OpKernelContext* ctx) {
                   "In TF1, it can also mean the variable is uninitialized. ",
                   "Debug info: container=", handle.container(),
                   ", status error message=", status.error_message()));
-
-  tf_shared_lock ml(*variable->mu());
-  // We're acquiring a reference to the underlying buffer while
-  // holding a shared lock to guarantee ordering of reads and
-  // writes when in copy-on-write mode.
-  const Tensor* t = variable->tensor();
-  if (!variable->copy_on_read_mode.load()) {
-    OP_REQUIRES(
-        ctx, dtype_ == t->dtype(),
-        errors::InvalidArgument(
-            "Trying to read variable with wrong dtype. Expected ",
-            DataTypeString(dtype_), " got ", DataTypeString(t->dtype())));
-    ctx->set_output(0, *t);
-  } else {
-    OP_REQUIRES_OK(ctx, CopyVariable(0, ctx, t));
-  }
+  OP_REQUIRES_OK(ctx, variable->LoadLazily());
+
+  const Tensor t = ReadVariableWithoutCopy(variable.get());
+  OP_REQUIRES(
+      ctx, dtype_ == t.dtype(),
+      errors::InvalidArgument(
+          "Trying to read variable with wrong dtype. Expected ",
+          DataTypeString(dtype_), " got ", DataTypeString(t.dtype())));
+  ctx->set_output(0, t);
 }
 
 ReadVariablesOp::ReadVariablesOp(OpKernelConstruction* c) : OpKernel(c) {
@@ -195,22 +168,15 @@ void ReadVariablesOp::Compute(OpKernelContext* ctx) {
                   absl::StrJoin(uninitialized_vars, ", ")));
 
   for (size_t i = 0; i < dtypes_.size(); ++i) {
-    // We're acquiring a reference to the underlying buffer while
-    // holding a shared lock to guarantee ordering of reads and
-    // writes.
-    tf_shared_lock ml(*variables[i]->mu());
-    OP_REQUIRES(ctx, dtypes_[i] == variables[i]->tensor()->dtype(),
+    OP_REQUIRES_OK(ctx, variables[i]->LoadLazily());
+    const Tensor t = ReadVariableWithoutCopy(variables[i].get());
+    OP_REQUIRES(ctx, dtypes_[i] == t.dtype(),
                 errors::InvalidArgument(
                     "Trying to read variable ", handles[i]->name(),
                     " from Container: ", handles[i]->container(),
                     " with wrong dtype. Expected ", DataTypeString(dtypes_[i]),
-                    " got ", DataTypeString(variables[i]->tensor()->dtype())));
-    if (variables[i]->copy_on_read_mode.load()) {
-      OP_REQUIRES_OK(ctx, CopyVariable(i, ctx, variables[i]->tensor()));
-    } else {
-      const Tensor& t = *variables[i]->tensor();
-      ctx->set_output(i, t);
-    }
+                    " got ", DataTypeString(t.dtype())));
+    ctx->set_output(i, t);
   }
 }
 
@@ -372,6 +338,11 @@ class AssignVariableOp : public OpKernel {
     if (c->HasAttr("validate_shape")) {
       OP_REQUIRES_OK(c, c->GetAttr("validate_shape", &validate_shape_));
     }
+    // Places the variable in managed memory on devices that support it, so
+    // that e.g. large embedding tables can exceed device memory.
+    if (!c->GetAttr("_use_managed_memory", &use_managed_memory_).ok()) {
+      use_managed_memory_ = false;
+    }
   }
 
   void Compute(OpKernelContext* context) override {
@@ -425,10 +396,11 @@ class AssignVariableOp : public OpKernel {
               variable->tensor()->shape().DebugString(), " got ",
               value.shape().DebugString()));
     }
-    if (variable->copy_on_read_mode.load()) {
+    if (variable->copy_on_read_mode.load() || use_managed_memory_) {
       AllocatorAttributes attr;
       attr.set_gpu_compatible(true);
       attr.set_nic_compatible(true);
+      attr.set_managed_memory(use_managed_memory_);
       OP_REQUIRES_OK(context,
                      context->allocate_temp(value.dtype(), value.shape(),
                                             variable->tensor(), attr));
@@ -445,6 +417,7 @@ class AssignVariableOp : public OpKernel {
   DataType dtype_;
   bool relax_constraints_;
   bool validate_shape_ = false;
+  bool use_managed_memory_ = false;
 };
 
 template <typename Device>
@@ -569,9 +542,8 @@ class AssignUpdateVariableOp : public OpKernel {
     Tensor* var_tensor = variable->tensor();
     OP_REQUIRES_OK(context, ValidateAssignUpdateVariableOpShapes(
                                 var_tensor->shape(), value.shape()));
-    OP_REQUIRES_OK(
-        context, PrepareToUpdateVariable<Device, T>(
-                     context, var_tensor, variable->copy_on_read_mode.load()));
+    OP_REQUIRES_OK(context,
+                   PrepareToUpdateVariable<Device, T>(context, var_tensor));
     functor::DenseUpdate<Device, T, Op> update_functor;
     update_functor(context->eigen_device<Device>(), var_tensor->flat<T>(),
                    value.flat<T>());
@@ -650,7 +622,10 @@ class ResourceGatherOp : public OpKernel {
   void Compute(OpKernelContext* c) override {
     core::RefCountPtr<Var> v;
     OP_REQUIRES_OK(c, LookupResource(c, HandleFromInput(c, 0), &v));
-    OP_REQUIRES_OK(c, EnsureSparseVariableAccess<Device, T>(c, v.get()));
+    // Gathers only read the variable, so unlike sparse updates they don't
+    // switch it to copy-on-read mode, which would copy it if a dense read
+    // still shares its buffer.
+    OP_REQUIRES_OK(c, v->LoadLazily());
     // NOTE: We hold the lock for the whole gather operation instead
     // of increasing the reference count of v->tensor() to avoid a
     // situation where a write to the same variable will see a
@@ -828,7 +803,10 @@ class ResourceGatherNdOp : public OpKernel {
   void Compute(OpKernelContext* c) override {
     core::RefCountPtr<Var> v;
     OP_REQUIRES_OK(c, LookupResource(c, HandleFromInput(c, 0), &v));
-    OP_REQUIRES_OK(c, EnsureSparseVariableAccess<Device, T>(c, v.get()));
+    // Gathers only read the variable, so unlike sparse updates they don't
+    // switch it to copy-on-read mode, which would copy it if a dense read
+    // still shares its buffer.
+    OP_REQUIRES_OK(c, v->LoadLazily());
     // NOTE: We hold the lock for the whole gather operation instead
     // of increasing the reference count of v->tensor() to avoid a
     // situation where a write to the same variable will see a
@@ -905,7 +883,7 @@ template <typename Device, typename T, typename Index, scatter_op::UpdateOp op>
 Status DoScatter(OpKernelContext* c, Tensor* params, const Tensor& indices,
                  const Tensor& updates, Index num_indices);
 
-#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+#if (GOOGLE_CUDA || TENSORFLOW_USE_ROCM) && defined(PLATFORM_WINDOWS)
 
 template <typename T>
 Status CopyTensorToHost(OpKernelContext* c, const Tensor& device_tensor,
@@ -929,8 +907,8 @@ Status CopyTensorToHost(OpKernelContext* c, const Tensor& device_tensor,
 
 // Copies inputs to the CPU, runs DoScatter on the CPU, then copies output
 // back to GPU. This is useful because the CPU implementation is deterministic
-// and the GPU implementation is not. Tensor inputs to this function must be on
-// the GPU.
+// and the sort-based deterministic GPU implementation is not available on
+// Windows. Tensor inputs to this function must be on the GPU.
 template <typename T, typename Index, scatter_op::UpdateOp Op>
 Status DoScatterOnCpu(OpKernelContext* c, Tensor* params, const Tensor& indices,
                       const Tensor& updates, Index num_indices) {
@@ -963,12 +941,14 @@ Status DoScatterOnCpu(OpKernelContext* c, Tensor* params, const Tensor& indices,
   return Status::OK();
 }
 
-#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+#endif  // (GOOGLE_CUDA || TENSORFLOW_USE_ROCM) && defined(PLATFORM_WINDOWS)
 
 template <typename Device, typename T, typename Index, scatter_op::UpdateOp op>
 Status DoScatter(OpKernelContext* c, Tensor* params, const Tensor& indices,
                  const Tensor& updates, Index num_indices) {
-#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+  // When op determinism is required, the GPU ScatterFunctor sorts the indices
+  // and applies the updates of each row without atomics, except on Windows.
+#if (GOOGLE_CUDA || TENSORFLOW_USE_ROCM) && defined(PLATFORM_WINDOWS)
   if (std::is_same<Device, GPUDevice>::value &&
       tensorflow::OpDeterminismRequired()) {
     if (!DataTypeCanUseMemcpy(params->dtype())) {
@@ -979,7 +959,7 @@ Status DoScatter(OpKernelContext* c, Tensor* params, const Tensor& indices,
     return DoScatterOnCpu<T, Index, op>(c, params, indices, updates,
                                         num_indices);
   }
-#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+#endif  // (GOOGLE_CUDA || TENSORFLOW_USE_ROCM) && defined(PLATFORM_WINDOWS)
   auto indices_flat = indices.flat<Index>();
   auto params_flat = params->flat_outer_dims<T>();
   int64_t num_updates = updates.NumElements();
@@ -1017,14 +997,19 @@ class ResourceScatterUpdateOp : public OpKernel {
     const bool is_non_pod_dtype = c->input_dtype(0) == DT_RESOURCE ||
                                   c->input_dtype(0) == DT_STRING ||
                                   c->input_dtype(0) == DT_VARIANT;
-    if (is_non_pod_dtype || use_exclusive_lock_) {
-      mutex_lock ml(*v->mu());
-      DoCompute(c);
-    } else {
-      // For POD dtypes, we can safely run the update without the mutex.
+    if (!is_non_pod_dtype && !use_exclusive_lock_) {
+      // For POD dtypes, we can safely run the update without the mutex, as
+      // long as no dense read switched the variable back to copy-on-write
+      // mode since it was ensured above.
       tf_shared_lock ml(*v->mu());
-      DoCompute(c);
+      if (v->copy_on_read_mode.load()) {
+        DoCompute(c);
+        return;
+      }
     }
+    mutex_lock ml(*v->mu());
+    OP_REQUIRES_OK(c, EnsureSparseVariableAccessLocked<Device, T>(c, v.get()));
+    DoCompute(c);
   }
 
  private:
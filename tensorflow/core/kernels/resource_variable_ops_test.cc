@@ -0,0 +1,179 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/resource_var.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/util/determinism.h"
+
+namespace tensorflow {
+namespace {
+
+class ResourceVariableOpsTest : public OpsTestBase {
+ protected:
+  Var* AddVariable(const Tensor& value, bool copy_on_read_mode) {
+    Var* var = new Var(value.dtype());
+    *var->tensor() = value;
+    var->is_initialized = true;
+    var->copy_on_read_mode.store(copy_on_read_mode);
+    AddResourceInput("", "var", var);
+    return var;
+  }
+
+  void MakeReadVariableOp() {
+    TF_ASSERT_OK(NodeDefBuilder("read", "ReadVariableOp")
+                     .Input(FakeInput(DT_RESOURCE))
+                     .Attr("dtype", DT_FLOAT)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+
+  void MakeScatterAddOp() {
+    TF_ASSERT_OK(NodeDefBuilder("scatter_add", "ResourceScatterAdd")
+                     .Input(FakeInput(DT_RESOURCE))
+                     .Input(FakeInput(DT_INT32))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+};
+
+TEST_F(ResourceVariableOpsTest, ReadSharesBufferInCopyOnWriteMode) {
+  MakeReadVariableOp();
+  Var* var = AddVariable(test::AsTensor<float>({1, 2, 3}),
+                         /*copy_on_read_mode=*/false);
+  TF_ASSERT_OK(RunOpKernel());
+  EXPECT_EQ(GetOutput(0)->flat<float>().data(),
+            var->tensor()->flat<float>().data());
+  EXPECT_FALSE(var->copy_on_read_mode.load());
+}
+
+TEST_F(ResourceVariableOpsTest, ReadSharesBufferInCopyOnReadMode) {
+  MakeReadVariableOp();
+  Var* var = AddVariable(test::AsTensor<float>({1, 2, 3}),
+                         /*copy_on_read_mode=*/true);
+  TF_ASSERT_OK(RunOpKernel());
+  EXPECT_EQ(GetOutput(0)->flat<float>().data(),
+            var->tensor()->flat<float>().data());
+  // The next sparse access will copy the buffer if the read is still alive.
+  EXPECT_FALSE(var->copy_on_read_mode.load());
+  test::ExpectTensorEqual<float>(*GetOutput(0),
+                                 test::AsTensor<float>({1, 2, 3}));
+}
+
+TEST_F(ResourceVariableOpsTest, SparseUpdateCopiesBufferStillRead) {
+  MakeScatterAddOp();
+  Var* var = AddVariable(test::AsTensor<float>({1, 2, 3}),
+                         /*copy_on_read_mode=*/false);
+  const Tensor read = *var->tensor();
+  AddInputFromArray<int32>(TensorShape({1}), {1});
+  AddInputFromArray<float>(TensorShape({1}), {10});
+  TF_ASSERT_OK(RunOpKernel());
+  EXPECT_TRUE(var->copy_on_read_mode.load());
+  EXPECT_NE(read.flat<float>().data(), var->tensor()->flat<float>().data());
+  test::ExpectTensorEqual<float>(read, test::AsTensor<float>({1, 2, 3}));
+  test::ExpectTensorEqual<float>(*var->tensor(),
+                                 test::AsTensor<float>({1, 12, 3}));
+}
+
+TEST_F(ResourceVariableOpsTest, SparseUpdateWritesUnsharedBufferInPlace) {
+  MakeScatterAddOp();
+  Var* var = AddVariable(test::AsTensor<float>({1, 2, 3}),
+                         /*copy_on_read_mode=*/false);
+  const float* data = var->tensor()->flat<float>().data();
+  AddInputFromArray<int32>(TensorShape({1}), {2});
+  AddInputFromArray<float>(TensorShape({1}), {10});
+  TF_ASSERT_OK(RunOpKernel());
+  EXPECT_TRUE(var->copy_on_read_mode.load());
+  EXPECT_EQ(data, var->tensor()->flat<float>().data());
+  test::ExpectTensorEqual<float>(*var->tensor(),
+                                 test::AsTensor<float>({1, 2, 13}));
+}
+
+// Returns a handle to the variable named "var" with `num_rows` rows of
+// `embedding_size` floats.
+Node* VarHandle(Graph* g, int num_rows, int embedding_size) {
+  Node* var;
+  TF_CHECK_OK(NodeBuilder(g->NewName("var"), "VarHandleOp")
+                  .Attr("dtype", DT_FLOAT)
+                  .Attr("shape", TensorShape({num_rows, embedding_size}))
+                  .Attr("shared_name", "var")
+                  .Finalize(g, &var));
+  return var;
+}
+
+// Adds `num_updates` rows to random rows of the variable. Many rows are
+// updated more than once, which the deterministic implementation has to
+// reduce before applying the updates.
+void BM_ResourceScatterAdd(::testing::benchmark::State& state) {
+  const int num_rows = state.range(0);
+  const int embedding_size = state.range(1);
+  const bool deterministic = state.range(2);
+  const int num_updates = num_rows;
+
+  Graph* init = new Graph(OpRegistry::Global());
+  Tensor value(DT_FLOAT, TensorShape({num_rows, embedding_size}));
+  value.flat<float>().setZero();
+  Node* assign;
+  TF_CHECK_OK(NodeBuilder(init->NewName("assign"), "AssignVariableOp")
+                  .Input(VarHandle(init, num_rows, embedding_size))
+                  .Input(test::graph::Constant(init, value))
+                  .Attr("dtype", DT_FLOAT)
+                  .Finalize(init, &assign));
+
+  random::PhiloxRandom philox(301, 17);
+  random::SimplePhilox rnd(&philox);
+  Tensor indices(DT_INT32, TensorShape({num_updates}));
+  test::FillFn<int32>(&indices, [&](int) { return rnd.Uniform(num_rows); });
+  Tensor updates(DT_FLOAT, TensorShape({num_updates, embedding_size}));
+  updates.flat<float>().setRandom();
+  Graph* g = new Graph(OpRegistry::Global());
+  Node* scatter_add;
+  TF_CHECK_OK(NodeBuilder(g->NewName("scatter_add"), "ResourceScatterAdd")
+                  .Input(VarHandle(g, num_rows, embedding_size))
+                  .Input(test::graph::Constant(g, indices))
+                  .Input(test::graph::Constant(g, updates))
+                  .Attr("dtype", DT_FLOAT)
+                  .Finalize(g, &scatter_add));
+
+  EnableOpDeterminism(deterministic);
+  test::Benchmark("gpu", g, /*options=*/nullptr, init).Run(state);
+  EnableOpDeterminism(false);
+  state.SetItemsProcessed(static_cast<int64_t>(num_updates) * embedding_size *
+                          state.iterations());
+}
+
+// Compares the atomic implementation with the deterministic one.
+BENCHMARK(BM_ResourceScatterAdd)
+    ->UseRealTime()
+    ->Args({1 << 20, 1, 0})
+    ->Args({1 << 20, 1, 1})
+    ->Args({1 << 16, 64, 0})
+    ->Args({1 << 16, 64, 1})
+    ->Args({1 << 12, 1024, 0})
+    ->Args({1 << 12, 1024, 1});
+
+}  // namespace
+}  // namespace tensorflow
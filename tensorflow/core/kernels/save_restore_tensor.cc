@@ -33,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 #include "tensorflow/core/util/tensor_slice_reader.h"
 #include "tensorflow/core/util/tensor_slice_reader_cache.h"
@@ -250,6 +251,9 @@ namespace {
 // Tensors larger than this threshold will be restored from a thread-pool.
 const int64_t kLargeShapeThreshold = 16 << 20;  // 16M
 
+// Number of threads reading large or batched tensors.
+const int kRestoreThreads = 8;
+
 // A restore operation for a single tensor.  Small tensors may be restored
 // directly from the op thread to improve read locality.  Large tensors can be
 // restored from a thread pool: this requires creating a separate BundleReader
@@ -377,7 +381,12 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
                            shape_and_slices_flat(i), prefix_string, dtypes[i]});
   }
 
-  BundleReader default_reader(Env::Default(), prefix_string);
+  // Serving jobs that never update the restored tensors in place can alias
+  // them to the memory mapped checkpoint instead of holding private copies.
+  BundleReader::Options reader_options;
+  TF_RETURN_IF_ERROR(ReadBoolFromEnvVar("TF_RESTORE_MEMMAP_DATA_FILES", false,
+                                        &reader_options.memmap_data_files));
+  BundleReader default_reader(Env::Default(), prefix_string, reader_options);
   TF_RETURN_IF_ERROR(default_reader.status());
 
   TF_RETURN_IF_ERROR(default_reader.SortForSequentialAccess<RestoreOp>(
@@ -402,10 +411,24 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
     return errors::InvalidArgument(error_msg);
   }
 
+  // Full tensors of memcpy-able dtypes are read together, with coalesced
+  // reads issued from the thread pool.
+  std::vector<string> batched_names;
+  std::vector<Tensor*> batched_tensors;
   std::vector<RestoreOp*> pool_restore_ops;
   std::vector<RestoreOp*> direct_restore_ops;
   for (RestoreOp& restore_op : restore_ops) {
-    if (restore_op.should_run_in_pool(&default_reader)) {
+    if (restore_op.shape_and_slice.empty() &&
+        DataTypeCanUseMemcpy(restore_op.dtype)) {
+      TensorShape restored_full_shape;
+      TF_RETURN_IF_ERROR(default_reader.LookupTensorShape(
+          restore_op.tensor_name, &restored_full_shape));
+      Tensor* restored_tensor;
+      TF_RETURN_IF_ERROR(context->allocate_output(
+          restore_op.idx, restored_full_shape, &restored_tensor));
+      batched_names.push_back(restore_op.tensor_name);
+      batched_tensors.push_back(restored_tensor);
+    } else if (restore_op.should_run_in_pool(&default_reader)) {
       pool_restore_ops.push_back(&restore_op);
     } else {
       direct_restore_ops.push_back(&restore_op);
@@ -417,13 +440,19 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
     // we don't have any expensive operations.
     std::unique_ptr<thread::ThreadPool> reader_pool;
     if (!pool_restore_ops.empty()) {
-      reader_pool.reset(
-          new thread::ThreadPool(Env::Default(), "restore_tensors", 8));
+      reader_pool.reset(new thread::ThreadPool(
+          Env::Default(), "restore_tensors", kRestoreThreads));
       for (auto* op : pool_restore_ops) {
         reader_pool->Schedule([op]() { op->run_with_new_reader(); });
       }
     }
 
+    if (!batched_names.empty()) {
+      VLOG(1) << "Restoring " << batched_names.size() << " full tensors";
+      TF_RETURN_IF_ERROR(default_reader.LookupMany(
+          batched_names, batched_tensors, kRestoreThreads));
+    }
+
     // Read small tensors from the op thread
     for (auto* op : direct_restore_ops) {
       TF_RETURN_IF_ERROR(op->run(&default_reader));
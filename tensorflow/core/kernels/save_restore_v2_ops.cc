@@ -15,7 +15,9 @@ limitations under the License.
 
 // See docs in ../ops/io_ops.cc.
 
+#include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "tensorflow/core/framework/bounds_check.h"
@@ -23,7 +25,9 @@ limitations under the License.
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/kernels/async_checkpoint_writer.h"
 #include "tensorflow/core/kernels/checkpoint_callback_manager.h"
 #include "tensorflow/core/kernels/save_restore_tensor.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -87,12 +91,101 @@ void ValidateInputs(bool is_save_op, OpKernelContext* context,
   }
 }
 
+// A tensor to save, along with the slice spec parsed from shape_and_slices.
+struct TensorToSave {
+  string name;
+  Tensor tensor;
+  bool is_slice = false;
+  TensorShape shape;
+  TensorSlice slice;
+};
+
+// Writes "tensors" into a tensor bundle under "prefix".
+Status WriteTensorBundle(const string& prefix,
+                         const std::vector<TensorToSave>& tensors) {
+  BundleWriter writer(Env::Default(), prefix);
+  TF_RETURN_IF_ERROR(writer.status());
+  VLOG(1) << "BundleWriter, prefix_string: " << prefix;
+
+  for (const TensorToSave& to_save : tensors) {
+    const Tensor& tensor = to_save.tensor;
+    VLOG(2) << "Starting save of " << to_save.name;
+    if (to_save.is_slice) {
+      TF_RETURN_IF_ERROR(
+          writer.AddSlice(to_save.name, to_save.shape, to_save.slice, tensor));
+    } else {
+      TF_RETURN_IF_ERROR(writer.Add(to_save.name, tensor));
+    }
+
+    if (VLOG_IS_ON(5)) {
+      if (tensor.dtype() == DT_FLOAT) {
+        const float* t_data = tensor.flat<float>().data();
+        float min = std::numeric_limits<float>::infinity();
+        float max = -std::numeric_limits<float>::infinity();
+        double avg = 0.0;
+        for (int i = 0; i < tensor.NumElements(); ++i) {
+          if (t_data[i] < min) min = t_data[i];
+          if (t_data[i] > max) max = t_data[i];
+          avg += t_data[i];
+        }
+        VLOG(5) << " min " << min << " max " << max << " avg "
+                << avg / tensor.NumElements() << " total elts "
+                << tensor.NumElements();
+      }
+    }
+
+    VLOG(2) << "Done save of " << to_save.name;
+  }
+  TF_RETURN_IF_ERROR(writer.Finish());
+  VLOG(1) << "Done BundleWriter, prefix_string: " << prefix;
+  return Status::OK();
+}
+
+// Looks up the checkpoint callback manager of "context", creating it if needed.
+// Sets "*checkpoint_callback_manager" to nullptr if "context" has no resource
+// manager.
+Status LookupCheckpointCallbackManager(
+    OpKernelContext* context,
+    checkpoint::CheckpointCallbackManager** checkpoint_callback_manager) {
+  *checkpoint_callback_manager = nullptr;
+  ResourceMgr* resource_manager = context->resource_manager();
+  if (resource_manager == nullptr) return Status::OK();
+  return resource_manager
+      ->LookupOrCreate<checkpoint::CheckpointCallbackManager>(
+          resource_manager->default_container(),
+          std::string(checkpoint::kCheckpointCallbackManagerResourceName),
+          checkpoint_callback_manager,
+          [](checkpoint::CheckpointCallbackManager** out) {
+            *out = new checkpoint::CheckpointCallbackManager();
+            return Status::OK();
+          });
+}
+
+// Waits for the checkpoints written asynchronously by SaveV2, if any, so that
+// they can be read.
+Status WaitForAsyncCheckpointWrites(OpKernelContext* context) {
+  ResourceMgr* resource_manager = context->resource_manager();
+  if (resource_manager == nullptr) return Status::OK();
+  checkpoint::AsyncCheckpointWriter* async_writer;
+  Status s = resource_manager->Lookup<checkpoint::AsyncCheckpointWriter>(
+      resource_manager->default_container(),
+      std::string(checkpoint::kAsyncCheckpointWriterResourceName),
+      &async_writer);
+  // No asynchronous save has ever been run.
+  if (errors::IsNotFound(s)) return Status::OK();
+  TF_RETURN_IF_ERROR(s);
+  core::ScopedUnref unref(async_writer);
+  return async_writer->WaitForCompletion();
+}
+
 }  // namespace
 
 // Saves a list of named tensors using the tensor bundle library.
 class SaveV2 : public OpKernel {
  public:
-  explicit SaveV2(OpKernelConstruction* context) : OpKernel(context) {}
+  explicit SaveV2(OpKernelConstruction* context) : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("async_save", &async_save_));
+  }
 
   void Compute(OpKernelContext* context) override {
     const Tensor& prefix = context->input(0);
@@ -108,77 +201,91 @@ class SaveV2 : public OpKernel {
     const auto& tensor_names_flat = tensor_names.flat<tstring>();
     const auto& shape_and_slices_flat = shape_and_slices.flat<tstring>();
 
-    BundleWriter writer(Env::Default(), prefix_string);
-    OP_REQUIRES_OK(context, writer.status());
-    VLOG(1) << "BundleWriter, prefix_string: " << prefix_string;
-
+    std::vector<TensorToSave> tensors(num_tensors);
     for (int i = 0; i < num_tensors; ++i) {
-      const string& tensor_name = tensor_names_flat(i);
+      TensorToSave& to_save = tensors[i];
+      to_save.name = tensor_names_flat(i);
       const Tensor& tensor = context->input(i + kFixedInputs);
-      VLOG(2) << "Starting save of " << tensor_name;
+      // Stages a copy of the tensor in host memory when writing in the
+      // background, as the values may be updated by the next training steps.
+      to_save.tensor = async_save_ ? tensor::DeepCopy(tensor) : tensor;
 
       if (!shape_and_slices_flat(i).empty()) {
         const string& shape_spec = shape_and_slices_flat(i);
-        TensorShape shape;
         TensorSlice slice(tensor.dims());
         TensorShape slice_shape;
 
-        OP_REQUIRES_OK(context, checkpoint::ParseShapeAndSlice(
-                                    shape_spec, &shape, &slice, &slice_shape));
+        OP_REQUIRES_OK(context,
+                       checkpoint::ParseShapeAndSlice(
+                           shape_spec, &to_save.shape, &slice, &slice_shape));
         OP_REQUIRES(context, slice_shape.IsSameSize(tensor.shape()),
                     errors::InvalidArgument("Slice in shape_and_slice "
                                             "specification does not match the "
                                             "shape of the tensor to  save: ",
                                             shape_spec, ", tensor: ",
                                             tensor.shape().DebugString()));
-
-        OP_REQUIRES_OK(context,
-                       writer.AddSlice(tensor_name, shape, slice, tensor));
-      } else {
-        OP_REQUIRES_OK(context, writer.Add(tensor_name, tensor));
+        to_save.is_slice = true;
+        to_save.slice = slice;
       }
+    }
 
-      if (VLOG_IS_ON(5)) {
-        if (tensor.dtype() == DT_FLOAT) {
-          const float* t_data = tensor.flat<float>().data();
-          float min = std::numeric_limits<float>::infinity();
-          float max = -std::numeric_limits<float>::infinity();
-          double avg = 0.0;
-          for (int i = 0; i < tensor.NumElements(); ++i) {
-            if (t_data[i] < min) min = t_data[i];
-            if (t_data[i] > max) max = t_data[i];
-            avg += t_data[i];
-          }
-          VLOG(5) << " min " << min << " max " << max << " avg "
-                  << avg / tensor.NumElements() << " total elts "
-                  << tensor.NumElements();
-        }
+    checkpoint::CheckpointCallbackManager* manager;
+    OP_REQUIRES_OK(context, LookupCheckpointCallbackManager(context, &manager));
+    // Shared with the background write in async mode.
+    std::shared_ptr<checkpoint::CheckpointCallbackManager>
+        checkpoint_callback_manager(
+            manager, [](checkpoint::CheckpointCallbackManager* m) {
+              if (m != nullptr) m->Unref();
+            });
+    if (!async_save_) {
+      OP_REQUIRES_OK(context, WriteTensorBundle(prefix_string, tensors));
+      if (checkpoint_callback_manager != nullptr) {
+        checkpoint_callback_manager->Save(prefix_string);
       }
-
-      VLOG(2) << "Done save of " << tensor_name;
+      return;
     }
-    OP_REQUIRES_OK(context, writer.Finish());
-    VLOG(1) << "Done BundleWriter, prefix_string: " << prefix_string;
 
+    // Writes the staged tensors in the background.
     ResourceMgr* resource_manager = context->resource_manager();
-    if (resource_manager != nullptr) {
-      checkpoint::CheckpointCallbackManager* checkpoint_callback_manager;
-      OP_REQUIRES_OK(
-          context,
-          resource_manager
-              ->LookupOrCreate<checkpoint::CheckpointCallbackManager>(
-                  resource_manager->default_container(),
-                  std::string(
-                      checkpoint::kCheckpointCallbackManagerResourceName),
-                  &checkpoint_callback_manager,
-                  [](checkpoint::CheckpointCallbackManager** out) {
-                    *out = new checkpoint::CheckpointCallbackManager();
-                    return Status::OK();
-                  }));
-      checkpoint_callback_manager->Save(prefix_string);
-      checkpoint_callback_manager->Unref();
-    }
+    OP_REQUIRES(context, resource_manager != nullptr,
+                errors::Internal("async_save requires a resource manager"));
+    checkpoint::AsyncCheckpointWriter* async_writer;
+    OP_REQUIRES_OK(
+        context,
+        resource_manager->LookupOrCreate<checkpoint::AsyncCheckpointWriter>(
+            resource_manager->default_container(),
+            std::string(checkpoint::kAsyncCheckpointWriterResourceName),
+            &async_writer, [](checkpoint::AsyncCheckpointWriter** out) {
+              *out = new checkpoint::AsyncCheckpointWriter();
+              return Status::OK();
+            }));
+    core::ScopedUnref unref(async_writer);
+    // Backpressure is applied per checkpoint, so that the shards of a sharded
+    // save are written concurrently.
+    auto checkpoint_id_and_dir =
+        checkpoint::CheckpointCallbackManager::GetCheckpointIdAndPathFromPrefix(
+            prefix_string);
+    const std::string checkpoint_id = checkpoint_id_and_dir.ok()
+                                          ? checkpoint_id_and_dir->first
+                                          : prefix_string;
+    OP_REQUIRES_OK(
+        context,
+        async_writer->Schedule(
+            checkpoint_id,
+            [prefix_string, tensors = std::move(tensors),
+             checkpoint_callback_manager]() {
+              TF_RETURN_IF_ERROR(WriteTensorBundle(prefix_string, tensors));
+              if (checkpoint_callback_manager != nullptr) {
+                checkpoint_callback_manager->Save(prefix_string);
+              }
+              return Status::OK();
+            }));
   }
+
+ private:
+  // Whether to return once the tensors are staged, and write them in the
+  // background.
+  bool async_save_;
 };
 REGISTER_KERNEL_BUILDER(Name("SaveV2").Device(DEVICE_CPU), SaveV2);
 
@@ -202,6 +309,7 @@ class RestoreV2 : public OpKernel {
     if (!context->status().ok()) return;
 
     const string& prefix_string = prefix.scalar<tstring>()();
+    OP_REQUIRES_OK(context, WaitForAsyncCheckpointWrites(context));
 
     // Intention: we plan to use the RestoreV2 op as a backward-compatible
     // reader as we upgrade to the V2 format.  This allows transparent upgrade.
@@ -279,6 +387,8 @@ class MergeV2Checkpoints : public OpKernel {
         gtl::ArraySlice<tstring>(checkpoint_prefixes.flat<tstring>());
     Env* env = Env::Default();
     const string& merged_prefix = destination_prefix.scalar<tstring>()();
+    // The shards may still be written by asynchronous saves.
+    OP_REQUIRES_OK(context, WaitForAsyncCheckpointWrites(context));
     OP_REQUIRES_OK(
         context, tensorflow::MergeBundles(env, input_prefixes, merged_prefix));
 
@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/kernels/async_checkpoint_writer.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
@@ -340,5 +341,73 @@ TEST_F(SaveV2OpTest, Simple) {
   }
 }
 
+class AsyncSaveV2OpTest : public OpsTestBase {
+ protected:
+  void MakeOp() {
+    TF_ASSERT_OK(NodeDefBuilder("myop", "SaveV2")
+                     .Input(FakeInput())  // prefix
+                     .Input(FakeInput())  // tensor_names
+                     .Input(FakeInput())  // shape_and_slices
+                     .Input(FakeInput({DT_FLOAT, DT_INT32}))
+                     .Attr("async_save", true)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+
+  Status WaitForCompletion() {
+    ResourceMgr* rm = device_->resource_manager();
+    checkpoint::AsyncCheckpointWriter* async_writer;
+    TF_RETURN_IF_ERROR(rm->Lookup<checkpoint::AsyncCheckpointWriter>(
+        rm->default_container(),
+        std::string(checkpoint::kAsyncCheckpointWriterResourceName),
+        &async_writer));
+    core::ScopedUnref unref(async_writer);
+    return async_writer->WaitForCompletion();
+  }
+};
+
+TEST_F(AsyncSaveV2OpTest, Simple) {
+  const string prefix = io::JoinPath(testing::TmpDir(), "tensor_async");
+  MakeOp();
+  AddInputFromArray<tstring>(TensorShape({}), {prefix});
+  AddInputFromArray<tstring>(TensorShape({2}),
+                             {"tensor_float", "tensor_sliced"});
+  AddInputFromArray<tstring>(TensorShape({2}), {"", "4 0,2"});
+  AddInput<float>(TensorShape({2, 4}),
+                  [](int x) -> float { return static_cast<float>(x) / 10; });
+  AddInputFromArray<int32>(TensorShape({2}), {7, 8});
+  TF_ASSERT_OK(RunOpKernel());
+
+  // The op saves a copy of its inputs, so updating them does not affect the
+  // checkpoint being written.
+  mutable_input(3).tensor->flat<float>().setZero();
+  mutable_input(4).tensor->flat<int32>().setZero();
+  TF_ASSERT_OK(WaitForCompletion());
+
+  BundleReader reader(Env::Default(), prefix);
+  TF_ASSERT_OK(reader.status());
+  Tensor val;
+  TF_EXPECT_OK(reader.Lookup("tensor_float", &val));
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_EQ(static_cast<float>(i) / 10, val.flat<float>()(i));
+  }
+  Tensor slice(DT_INT32, TensorShape({2}));
+  TF_EXPECT_OK(reader.LookupSlice("tensor_sliced",
+                                  TensorSlice::ParseOrDie("0,2"), &slice));
+  EXPECT_EQ(7, slice.flat<int32>()(0));
+  EXPECT_EQ(8, slice.flat<int32>()(1));
+}
+
+TEST_F(AsyncSaveV2OpTest, InvalidSliceIsReportedSynchronously) {
+  const string prefix = io::JoinPath(testing::TmpDir(), "tensor_async_bad");
+  MakeOp();
+  AddInputFromArray<tstring>(TensorShape({}), {prefix});
+  AddInputFromArray<tstring>(TensorShape({2}), {"a", "b"});
+  AddInputFromArray<tstring>(TensorShape({2}), {"", "4 0,3"});
+  AddInputFromArray<float>(TensorShape({1}), {1});
+  AddInputFromArray<int32>(TensorShape({2}), {7, 8});
+  EXPECT_FALSE(RunOpKernel().ok());
+}
+
 }  // namespace
 }  // namespace tensorflow
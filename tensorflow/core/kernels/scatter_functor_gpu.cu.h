@@ -21,8 +21,12 @@ limitations under the License.
 #define EIGEN_USE_GPU
 
 #include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/kernels/gpu_prim.h"
+#include "tensorflow/core/kernels/gpu_prim_helpers.h"
 #include "tensorflow/core/kernels/scatter_functor.h"
+#include "tensorflow/core/kernels/segment_reduction_ops_gpu.cu.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/determinism.h"
 #include "tensorflow/core/util/gpu_kernel_helper.h"
 
 namespace tensorflow {
@@ -124,6 +128,271 @@ __global__ void ScatterScalarOpCustomKernel(T* __restrict__ params,
   }
 }
 
+// Non-atomic versions of ScatterOpKernelBody, used when each element of params
+// is updated by a single thread.
+template <typename T, scatter_op::UpdateOp op>
+struct SortedScatterOpKernelBody;
+
+template <typename T>
+struct SortedScatterOpKernelBody<T, scatter_op::UpdateOp::ADD> {
+  __device__ void operator()(T* __restrict__ dest, T src) const {
+    *dest += src;
+  }
+};
+
+template <typename T>
+struct SortedScatterOpKernelBody<T, scatter_op::UpdateOp::SUB> {
+  __device__ void operator()(T* __restrict__ dest, T src) const {
+    *dest -= src;
+  }
+};
+
+template <typename T>
+struct SortedScatterOpKernelBody<T, scatter_op::UpdateOp::MUL> {
+  __device__ void operator()(T* __restrict__ dest, T src) const {
+    *dest *= src;
+  }
+};
+
+template <typename T>
+struct SortedScatterOpKernelBody<T, scatter_op::UpdateOp::DIV> {
+  __device__ void operator()(T* __restrict__ dest, T src) const {
+    *dest /= src;
+  }
+};
+
+template <typename T>
+struct SortedScatterOpKernelBody<T, scatter_op::UpdateOp::MIN> {
+  __device__ void operator()(T* __restrict__ dest, T src) const {
+    *dest = min(*dest, src);
+  }
+};
+
+template <typename T>
+struct SortedScatterOpKernelBody<T, scatter_op::UpdateOp::MAX> {
+  __device__ void operator()(T* __restrict__ dest, T src) const {
+    *dest = max(*dest, src);
+  }
+};
+
+// The reduction that combines all the updates of one row of params before
+// they are applied, and its initial value.
+template <typename T, scatter_op::UpdateOp op>
+struct SortedScatterReduction;
+
+template <typename T>
+struct SortedScatterReduction<T, scatter_op::UpdateOp::ADD> {
+  using ReduceOp = functor::Sum;
+  using InitialValueF = functor::Zero<T>;
+};
+
+template <typename T>
+struct SortedScatterReduction<T, scatter_op::UpdateOp::SUB> {
+  using ReduceOp = functor::Sum;
+  using InitialValueF = functor::Zero<T>;
+};
+
+template <typename T>
+struct SortedScatterReduction<T, scatter_op::UpdateOp::MUL> {
+  using ReduceOp = functor::Prod;
+  using InitialValueF = functor::One<T>;
+};
+
+template <typename T>
+struct SortedScatterReduction<T, scatter_op::UpdateOp::DIV> {
+  using ReduceOp = functor::Prod;
+  using InitialValueF = functor::One<T>;
+};
+
+template <typename T>
+struct SortedScatterReduction<T, scatter_op::UpdateOp::MIN> {
+  using ReduceOp = functor::Min;
+  using InitialValueF = functor::Highest<T>;
+};
+
+template <typename T>
+struct SortedScatterReduction<T, scatter_op::UpdateOp::MAX> {
+  using ReduceOp = functor::Max;
+  using InitialValueF = functor::Lowest<T>;
+};
+
+// Returns 1 iff position i of sorted_indices starts a new row, so that the
+// inclusive prefix sum over all positions assigns each row a contiguous id
+// starting at 0.
+template <typename Index>
+struct RowStartFunctor {
+  const Index* __restrict__ sorted_indices;
+  __device__ Index operator()(const Index& i) const {
+    return i > 0 && sorted_indices[i] != sorted_indices[i - 1] ? 1 : 0;
+  }
+};
+
+// Applies the reduced updates of each row of params. The first position of
+// each row in sorted_indices owns the row, so no atomics are needed.
+template <typename T, typename Index, scatter_op::UpdateOp op>
+__global__ void SortedScatterOpCustomKernel(
+    T* __restrict__ params, const T* __restrict__ reduced,
+    const Index* __restrict__ sorted_indices,
+    const Index* __restrict__ row_ids, Index first_dim_size,
+    Index indices_size, Index update_block) {
+  SortedScatterOpKernelBody<T, op> body;
+  GPU_1D_KERNEL_LOOP(i, indices_size * update_block) {
+    const Index sorted_i = i / update_block;
+    const Index param_first_index = sorted_indices[sorted_i];
+    if (sorted_i > 0 && sorted_indices[sorted_i - 1] == param_first_index) {
+      continue;
+    }
+    if (!(param_first_index >= 0 && param_first_index < first_dim_size)) {
+      // Ignore indices that are out of range.
+      continue;
+    }
+    const Index column = i % update_block;
+    const int64 params_i =
+        static_cast<int64>(param_first_index) * update_block + column;
+    const int64 reduced_i =
+        static_cast<int64>(ldg(row_ids + sorted_i)) * update_block + column;
+    body(&params[params_i], ldg(reduced + reduced_i));
+  }
+}
+
+// Writes the last update of each row of params. The sort is stable, so the
+// last position of each row in sorted_indices holds the update that comes
+// last in indices.
+template <typename T, typename Index>
+__global__ void SortedScatterAssignCustomKernel(
+    T* __restrict__ params, const T* __restrict__ updates,
+    const Index* __restrict__ sorted_indices,
+    const Index* __restrict__ permutation, Index first_dim_size,
+    Index indices_size, Index update_block) {
+  GPU_1D_KERNEL_LOOP(i, indices_size * update_block) {
+    const Index sorted_i = i / update_block;
+    const Index param_first_index = sorted_indices[sorted_i];
+    if (sorted_i + 1 < indices_size &&
+        sorted_indices[sorted_i + 1] == param_first_index) {
+      continue;
+    }
+    if (!(param_first_index >= 0 && param_first_index < first_dim_size)) {
+      // Ignore indices that are out of range.
+      continue;
+    }
+    const Index column = i % update_block;
+    const int64 params_i =
+        static_cast<int64>(param_first_index) * update_block + column;
+    const int64 updates_i =
+        static_cast<int64>(ldg(permutation + sorted_i)) * update_block + column;
+    params[params_i] = ldg(updates + updates_i);
+  }
+}
+
+// Sorts indices, keeping the positions of equal indices in their original
+// order.
+template <typename Index>
+Status SortScatterIndices(OpKernelContext* c,
+                          typename TTypes<Index>::ConstFlat indices,
+                          Tensor* sorted_indices, Tensor* permutation) {
+  const int64_t indices_size = indices.size();
+  TF_RETURN_IF_ERROR(c->allocate_temp(DataTypeToEnum<Index>::value,
+                                      TensorShape({indices_size}),
+                                      sorted_indices));
+  TF_RETURN_IF_ERROR(c->allocate_temp(DataTypeToEnum<Index>::value,
+                                      TensorShape({indices_size}),
+                                      permutation));
+  // All bits are sorted because out-of-range indices may be negative.
+  return GpuRadixSort(c, indices_size, /*keys_in=*/indices.data(),
+                      /*keys_out=*/sorted_indices->flat<Index>().data(),
+                      /*indices_in=*/static_cast<const Index*>(nullptr),
+                      /*indices_out=*/permutation->flat<Index>().data());
+}
+
+// Applies the updates without atomics, so that the result does not depend on
+// the order in which GPU threads run: the indices are sorted, the updates of
+// each row are combined with a deterministic segment reduction, and the
+// result is applied by a single thread per element of params.
+template <typename T, typename Index, scatter_op::UpdateOp op>
+struct DeterministicScatter {
+  Status operator()(OpKernelContext* c, const GPUDevice& d,
+                    typename TTypes<T>::Matrix params,
+                    typename TTypes<T>::ConstMatrix updates,
+                    typename TTypes<Index>::ConstFlat indices) {
+    const Index first_dim_size = params.dimension(0);
+    const Index indices_size = indices.size();
+    const Index update_block = updates.dimension(1);
+    if (indices_size == 0 || update_block == 0) return Status::OK();
+    Tensor sorted_indices;
+    Tensor permutation;
+    TF_RETURN_IF_ERROR(
+        SortScatterIndices<Index>(c, indices, &sorted_indices, &permutation));
+    const Index* sorted_indices_ptr = sorted_indices.flat<Index>().data();
+
+    Tensor row_ids;
+    TF_RETURN_IF_ERROR(c->allocate_temp(DataTypeToEnum<Index>::value,
+                                        TensorShape({indices_size}),
+                                        &row_ids));
+    Index* row_ids_ptr = row_ids.flat<Index>().data();
+    gpuprim::CountingInputIterator<Index> counting_iter(0);
+    gpuprim::TransformInputIterator<Index, RowStartFunctor<Index>,
+                                    gpuprim::CountingInputIterator<Index>>
+        row_start_iter(counting_iter, {sorted_indices_ptr});
+    TF_RETURN_IF_ERROR(GpuInclusivePrefixSum(c, indices_size, row_start_iter,
+                                             row_ids_ptr));
+
+    // There are at most indices_size rows; the reductions of the missing rows
+    // are left at the initial value and never read.
+    using Reduction = SortedScatterReduction<T, op>;
+    using ReduceOp = typename Reduction::ReduceOp;
+    using Treduce = typename ReduceType<ReduceOp, T>::type;
+    Tensor reduced;
+    TF_RETURN_IF_ERROR(c->allocate_temp(DataTypeToEnum<T>::value,
+                                        TensorShape({indices_size,
+                                                     update_block}),
+                                        &reduced));
+    const T initial_value = typename Reduction::InitialValueF()();
+    TF_RETURN_IF_ERROR(SegmentReduceGPU<Treduce>(
+        c, /*nouter=*/indices_size, /*ninner=*/update_block,
+        /*nsegments=*/indices_size, ReduceOp(), initial_value,
+        /*empty_segment_value=*/initial_value, /*is_mean=*/false,
+        /*is_sqrtn=*/false, /*input=*/updates.data(),
+        /*segment_ids=*/static_cast<const Index*>(row_ids_ptr),
+        /*indices=*/
+        static_cast<const Index*>(permutation.flat<Index>().data()),
+        /*weights=*/static_cast<T*>(nullptr),
+        /*output=*/reduced.flat<T>().data()));
+
+    GpuLaunchConfig config = GetGpuLaunchConfig(updates.size(), d);
+    return GpuLaunchKernel(SortedScatterOpCustomKernel<T, Index, op>,
+                           config.block_count, config.thread_per_block, 0,
+                           d.stream(), params.data(),
+                           static_cast<const T*>(reduced.flat<T>().data()),
+                           sorted_indices_ptr,
+                           static_cast<const Index*>(row_ids_ptr),
+                           first_dim_size, indices_size, update_block);
+  }
+};
+
+template <typename T, typename Index>
+struct DeterministicScatter<T, Index, scatter_op::UpdateOp::ASSIGN> {
+  Status operator()(OpKernelContext* c, const GPUDevice& d,
+                    typename TTypes<T>::Matrix params,
+                    typename TTypes<T>::ConstMatrix updates,
+                    typename TTypes<Index>::ConstFlat indices) {
+    const Index first_dim_size = params.dimension(0);
+    const Index indices_size = indices.size();
+    const Index update_block = updates.dimension(1);
+    if (indices_size == 0 || update_block == 0) return Status::OK();
+    Tensor sorted_indices;
+    Tensor permutation;
+    TF_RETURN_IF_ERROR(
+        SortScatterIndices<Index>(c, indices, &sorted_indices, &permutation));
+    GpuLaunchConfig config = GetGpuLaunchConfig(updates.size(), d);
+    return GpuLaunchKernel(
+        SortedScatterAssignCustomKernel<T, Index>, config.block_count,
+        config.thread_per_block, 0, d.stream(), params.data(), updates.data(),
+        static_cast<const Index*>(sorted_indices.flat<Index>().data()),
+        static_cast<const Index*>(permutation.flat<Index>().data()),
+        first_dim_size, indices_size, update_block);
+  }
+};
+
 }  // namespace scatter_op_gpu
 
 namespace functor {
@@ -137,6 +406,16 @@ struct ScatterFunctor<GPUDevice, T, Index, op> {
     // TODO(b/31801742): Implement indices range check. The hardest part is
     // with returning a value after the range check, as we do not want to do
     // device to host memcpy during a stream.
+#if !defined(PLATFORM_WINDOWS)
+    // See segment_reduction_ops_gpu_0.cu.cc regarding the Windows CI build
+    // error of the sort-based implementation.
+    if (OpDeterminismRequired()) {
+      Status s = scatter_op_gpu::DeterministicScatter<T, Index, op>()(
+          c, d, params, updates, indices);
+      if (!s.ok()) c->SetStatus(s);
+      return -1;
+    }
+#endif  // !defined(PLATFORM_WINDOWS)
     const Index first_dim_size = params.dimension(0);
     const Index indices_size = indices.size();
     const Index updates_size = updates.size();
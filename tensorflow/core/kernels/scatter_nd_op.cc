@@ -256,6 +256,8 @@ class ScatterNdUpdateOp : public OpKernel {
       OP_REQUIRES_OK(c, LookupResource(c, HandleFromInput(c, 0), &v));
       OP_REQUIRES_OK(c, EnsureSparseVariableAccess<Device, T>(c, v.get()));
       mutex_lock m(*v->mu());
+      OP_REQUIRES_OK(c,
+                     EnsureSparseVariableAccessLocked<Device, T>(c, v.get()));
       DoCompute(c);
     } else if (use_exclusive_lock_) {
       // If we're here, it means the input type is a ref.
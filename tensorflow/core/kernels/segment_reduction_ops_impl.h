@@ -18,7 +18,9 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_SEGMENT_REDUCTION_OPS_IMPL_H_
 #define TENSORFLOW_CORE_KERNELS_SEGMENT_REDUCTION_OPS_IMPL_H_
 
+#include <algorithm>
 #include <cstdint>
+#include <vector>
 
 #include "tensorflow/core/framework/op_requires.h"
 #include "tensorflow/core/platform/types.h"
@@ -40,8 +42,11 @@ limitations under the License.
 #include "tensorflow/core/kernels/segment_reduction_ops.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/prefetch.h"
 #include "tensorflow/core/util/determinism.h"
 #include "tensorflow/core/util/util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 #include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
@@ -601,61 +606,74 @@ class SparseSegmentReductionOpBase : public OpKernel {
     }
     auto temp_flat = temp.flat_outer_dims<float>();
 
-    int64_t start = 0, end = 1;
-    // Index from which the output is not initialized.
-    SegmentId uninitialized_index = 0;
-    SegmentId out_index = internal::SubtleMustCopy(segment_vec(start));
-
-    while (true) {
-      // We initialize next_index to 0 to avoid "warning: 'next_index' may be
-      // used uninitialized in this function" in the Mac build (since the
-      // compiler isn't smart enough to realize the code is safe).
-      SegmentId next_index = 0;
-      if (end < num_indices) {
-        next_index = internal::SubtleMustCopy(segment_vec(end));
-        if (out_index == next_index) {
-          ++end;
-          continue;
-        }
-        // We have a new segment here.  Verify that the segment ids are growing.
-        OP_REQUIRES(context, out_index < next_index,
+    // Collect the range of indices of every segment, verifying that the
+    // segment ids are increasing and within range, so that the segments can
+    // then be reduced in parallel.
+    std::vector<int64_t> segment_starts;
+    std::vector<SegmentId> segment_out_ids;
+    for (int64_t i = 0; i < num_indices; ++i) {
+      const SegmentId out_index = internal::SubtleMustCopy(segment_vec(i));
+      if (!segment_out_ids.empty()) {
+        if (out_index == segment_out_ids.back()) continue;
+        OP_REQUIRES(context, segment_out_ids.back() < out_index,
                     errors::InvalidArgument("segment ids are not increasing"));
       }
-
       OP_REQUIRES(
           context, FastBoundsCheck(out_index, output_rows),
           errors::InvalidArgument(
               "Segment id ", out_index, " out of range [0, ", output_rows,
               "), possibly because 'segment_ids' input is not sorted."));
+      segment_starts.push_back(i);
+      segment_out_ids.push_back(out_index);
+    }
+    const int64_t num_segments = segment_out_ids.size();
+    segment_starts.push_back(num_indices);
+
+    // The smallest position in `indices` holding an out-of-range index.
+    mutex bad_mu;
+    int64_t bad_index = num_indices;
+    auto reduce_segments = [&](int64_t begin, int64_t end) {
+      for (int64_t k = begin; k < end; ++k) {
+        const SegmentId out_index = segment_out_ids[k];
+        // If there is a gap between two segments, we need to set that gap to
+        // the default value.
+        const SegmentId uninitialized_index =
+            k == 0 ? 0 : segment_out_ids[k - 1] + 1;
+        if (out_index > uninitialized_index) {
+          Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
+              out_index - uninitialized_index, num_col);
+          Eigen::TensorMap<Eigen::Tensor<T, 2, Eigen::RowMajor>,
+                           Eigen::Unaligned>
+              gap_slice(&output_flat(uninitialized_index, 0), gap_slice_shape);
+          gap_slice.setConstant(default_value_);
+        }
 
-      // If there is a gap between two indices, we need to set that gap to the
-      // default value.
-      if (out_index > uninitialized_index) {
-        Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
-            out_index - uninitialized_index, num_col);
-        Eigen::TensorMap<Eigen::Tensor<T, 2, Eigen::RowMajor>, Eigen::Unaligned>
-            gap_slice(&output_flat(uninitialized_index, 0), gap_slice_shape);
-        gap_slice.setConstant(default_value_);
+        auto out = output_flat.template chip<0>(out_index);
+        auto temp = temp_flat.template chip<0>(out_index);
+        const int64_t start = segment_starts[k];
+        const int64_t bad_offset =
+            Reduce<T, Index>(input_flat, indices_vec, start,
+                             segment_starts[k + 1] - start, out, temp);
+        if (bad_offset >= 0) {
+          mutex_lock l(bad_mu);
+          bad_index = std::min(bad_index, start + bad_offset);
+        }
       }
-
-      auto out = output_flat.template chip<0>(out_index);
-      auto temp = temp_flat.template chip<0>(out_index);
-      const int bad_offset = Reduce<T, Index>(input_flat, indices_vec, start,
-                                              end - start, out, temp);
-      OP_REQUIRES(context, bad_offset < 0,
-                  errors::InvalidArgument(
-                      "Bad: indices[", start + bad_offset,
-                      "] == ", indices_vec(start + bad_offset),
-                      " out of range [0, ", input_flat.dimension(0), ")"));
-
-      start = end;
-      ++end;
-      uninitialized_index = out_index + 1;
-      out_index = next_index;
-      if (end > num_indices) break;
-    }
+    };
+    const int64_t cost_per_segment =
+        (num_indices / num_segments + 1) * num_col *
+        Eigen::TensorOpCost::AddCost<T>();
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, num_segments,
+          cost_per_segment, reduce_segments);
+    OP_REQUIRES(context, bad_index == num_indices,
+                errors::InvalidArgument(
+                    "Bad: indices[", bad_index, "] == ", indices_vec(bad_index),
+                    " out of range [0, ", input_flat.dimension(0), ")"));
 
     // Fill the gap at the end with the default value.
+    const SegmentId uninitialized_index = segment_out_ids.back() + 1;
     if (uninitialized_index < output_rows) {
       Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
           output_rows - uninitialized_index, num_col);
@@ -690,6 +708,32 @@ class SparseSegmentReductionOpBase : public OpKernel {
     return input_flat.template chip<0>(index).template cast<float>();
   }
 
+  // Number of indices that rows are prefetched ahead of the reduction.
+  static constexpr int64_t kPrefetchDistance = 8;
+  // Only the leading bytes of long rows are prefetched; the hardware
+  // prefetcher picks up the sequential accesses to the rest of the row.
+  static constexpr int64_t kMaxPrefetchBytesPerRow = 512;
+
+  // Prefetches the rows of `input_flat` referenced by the indices at positions
+  // [begin, min(end, the number of indices)).
+  template <typename Tin, typename Tindex>
+  EIGEN_ALWAYS_INLINE void PrefetchRows(
+      const typename TTypes<Tin>::ConstMatrix& input_flat,
+      const typename TTypes<Tindex>::ConstVec& indices_vec, int64_t begin,
+      int64_t end) {
+    end = std::min<int64_t>(end, indices_vec.dimension(0));
+    const int64_t row_bytes = std::min<int64_t>(
+        input_flat.dimension(1) * sizeof(Tin), kMaxPrefetchBytesPerRow);
+    for (int64_t i = begin; i < end; ++i) {
+      const Tindex index = indices_vec(i);
+      if (!FastBoundsCheck(index, input_flat.dimension(0))) continue;
+      const char* row = reinterpret_cast<const char*>(&input_flat(index, 0));
+      for (int64_t offset = 0; offset < row_bytes; offset += 64) {
+        port::prefetch<port::PREFETCH_HINT_T0>(row + offset);
+      }
+    }
+  }
+
   template <typename Tout>
   EIGEN_ALWAYS_INLINE Tout get_scaling_factor(int64_t num) {
     Tout m(1);
@@ -743,6 +787,11 @@ class SparseSegmentReductionOpBase : public OpKernel {
       out = L(0);
     } else {
       int64_t r = num & 7;
+      // The head of the segment is reduced below while the rows of the first
+      // full block are being fetched.
+      const int64_t head = r < 2 ? r + 8 : r;
+      PrefetchRows<Tin, Tindex>(input_flat, indices_vec, start + head,
+                                start + head + kPrefetchDistance);
       switch (r) {
         case 2: {
           INDEX(0, 0);
@@ -827,6 +876,11 @@ class SparseSegmentReductionOpBase : public OpKernel {
         }
       }
       for (; r < num; r += 8) {
+        // Rows past the end of the segment belong to the next segments, which
+        // this thread is likely to reduce next.
+        PrefetchRows<Tin, Tindex>(input_flat, indices_vec,
+                                  start + r + kPrefetchDistance,
+                                  start + r + 2 * kPrefetchDistance);
         INDEX(0, r);
         INDEX(1, r + 1);
         INDEX(2, r + 2);
@@ -0,0 +1,172 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/data_flow_ops.cc.
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "tensorflow/core/framework/bounds_check.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/util/util.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+namespace {
+
+// Fuses the DynamicPartition -> Gather -> DynamicStitch sequence that
+// embedding_lookup emits for sharded tables: the shard and row of every id
+// are computed on the fly and the row is copied straight to the output.
+template <typename T, typename Index>
+class ShardedGatherOp : public OpKernel {
+ public:
+  explicit ShardedGatherOp(OpKernelConstruction* c) : OpKernel(c) {
+    string partition_strategy;
+    OP_REQUIRES_OK(c, c->GetAttr("partition_strategy", &partition_strategy));
+    OP_REQUIRES(c, partition_strategy == "mod" || partition_strategy == "div",
+                errors::InvalidArgument(
+                    "partition_strategy must be 'mod' or 'div', got '",
+                    partition_strategy, "'"));
+    mod_ = partition_strategy == "mod";
+  }
+
+  void Compute(OpKernelContext* c) override {
+    OpInputList params;
+    OP_REQUIRES_OK(c, c->input_list("params", &params));
+    const Tensor& ids = c->input(params.size());
+    const Tensor& params0 = params[0];
+    OP_REQUIRES(c, params0.dims() >= 1,
+                errors::InvalidArgument("params[0] must be at least 1-D, got ",
+                                        params0.shape().DebugString()));
+
+    const int num_shards = params.size();
+    std::vector<const T*> shard_base(num_shards);
+    std::vector<int64_t> shard_rows(num_shards);
+    int64_t total_rows = 0;
+    for (int s = 0; s < num_shards; ++s) {
+      const Tensor& shard = params[s];
+      OP_REQUIRES(
+          c, SameRowShape(shard, params0),
+          errors::InvalidArgument(
+              "params[", s, "].shape = ", shard.shape().DebugString(),
+              " does not match params[0].shape = ",
+              params0.shape().DebugString(), " after the first dimension"));
+      shard_base[s] = shard.flat<T>().data();
+      shard_rows[s] = shard.dim_size(0);
+      total_rows += shard_rows[s];
+    }
+
+    TensorShape result_shape = ids.shape();
+    for (int d = 1; d < params0.dims(); ++d) {
+      result_shape.AddDim(params0.dim_size(d));
+    }
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(c, c->allocate_output(0, result_shape, &output));
+    const int64_t num_ids = ids.NumElements();
+    if (num_ids == 0 || output->NumElements() == 0) return;
+
+    // With "div", the first `extras` shards hold `rows_per_shard + 1` ids each
+    // and the others `rows_per_shard`.
+    const int64_t rows_per_shard = total_rows / num_shards;
+    const int64_t extras = total_rows % num_shards;
+    const int64_t extras_limit = extras * (rows_per_shard + 1);
+
+    auto ids_flat = ids.flat<Index>();
+    const int64_t slice_size = output->NumElements() / num_ids;
+    const size_t slice_bytes = slice_size * sizeof(T);
+    T* out_base = output->flat<T>().data();
+    mutex mu;
+    // The position of an invalid id, for printing error information.
+    int64_t bad_i = -1;
+    auto work = [&](int64_t start, int64_t end) {
+      for (int64_t i = start; i < end; ++i) {
+        const int64_t id = internal::SubtleMustCopy(ids_flat(i));
+        int64_t shard;
+        int64_t row;
+        if (mod_) {
+          shard = id % num_shards;
+          row = id / num_shards;
+        } else if (id < extras_limit) {
+          shard = id / (rows_per_shard + 1);
+          row = id % (rows_per_shard + 1);
+        } else {
+          // rows_per_shard > 0 whenever the id is valid.
+          shard = rows_per_shard > 0
+                      ? extras + (id - extras_limit) / rows_per_shard
+                      : num_shards;
+          row = rows_per_shard > 0 ? (id - extras_limit) % rows_per_shard : 0;
+        }
+        if (id < 0 || !FastBoundsCheck(shard, num_shards) ||
+            !FastBoundsCheck(row, shard_rows[shard])) {
+          mutex_lock l(mu);
+          bad_i = i;
+          return;
+        }
+        const T* in = shard_base[shard] + row * slice_size;
+        T* out = out_base + i * slice_size;
+        if (DataTypeCanUseMemcpy(DataTypeToEnum<T>::v())) {
+          memcpy(out, in, slice_bytes);
+        } else {
+          std::copy_n(in, slice_size, out);
+        }
+      }
+    };
+    const auto& worker_threads = *c->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, num_ids,
+          /*cost_per_unit=*/slice_bytes + 32, work);
+    OP_REQUIRES(c, bad_i < 0,
+                errors::InvalidArgument(
+                    "ids", SliceDebugString(ids.shape(), bad_i), " = ",
+                    ids_flat(bad_i), " is not a row of the ", total_rows,
+                    " rows of params with partition_strategy '",
+                    mod_ ? "mod" : "div", "'"));
+  }
+
+ private:
+  // Checks if shard0.shape[1:] == shard1.shape[1:].
+  static bool SameRowShape(const Tensor& shard0, const Tensor& shard1) {
+    if (shard0.dims() != shard1.dims()) return false;
+    for (int d = 1; d < shard0.dims(); ++d) {
+      if (shard0.dim_size(d) != shard1.dim_size(d)) return false;
+    }
+    return true;
+  }
+
+  bool mod_;
+};
+
+#define REGISTER_SHARDED_GATHER_FULL(type, index_type)                 \
+  REGISTER_KERNEL_BUILDER(Name("ShardedGather")                        \
+                              .Device(DEVICE_CPU)                      \
+                              .TypeConstraint<type>("Tparams")         \
+                              .TypeConstraint<index_type>("Tindices"), \
+                          ShardedGatherOp<type, index_type>)
+
+#define REGISTER_SHARDED_GATHER(type)        \
+  REGISTER_SHARDED_GATHER_FULL(type, int32); \
+  REGISTER_SHARDED_GATHER_FULL(type, int64)
+
+TF_CALL_ALL_TYPES(REGISTER_SHARDED_GATHER);
+TF_CALL_QUANTIZED_TYPES(REGISTER_SHARDED_GATHER);
+#undef REGISTER_SHARDED_GATHER
+#undef REGISTER_SHARDED_GATHER_FULL
+
+}  // namespace
+}  // namespace tensorflow
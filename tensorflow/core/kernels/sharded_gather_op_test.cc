@@ -0,0 +1,102 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class ShardedGatherOpTest : public OpsTestBase {
+ protected:
+  void MakeOp(int num_shards, DataType index_type,
+              const string& partition_strategy) {
+    TF_ASSERT_OK(NodeDefBuilder("myop", "ShardedGather")
+                     .Input(FakeInput(num_shards, DT_FLOAT))
+                     .Input(FakeInput(index_type))
+                     .Attr("partition_strategy", partition_strategy)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+
+  // Adds a table of 7 rows [10 * i, 10 * i + 1] split across 3 shards.
+  void AddShards(bool mod) {
+    if (mod) {
+      AddInputFromArray<float>(TensorShape({3, 2}), {0, 1, 30, 31, 60, 61});
+      AddInputFromArray<float>(TensorShape({2, 2}), {10, 11, 40, 41});
+      AddInputFromArray<float>(TensorShape({2, 2}), {20, 21, 50, 51});
+    } else {
+      AddInputFromArray<float>(TensorShape({3, 2}), {0, 1, 10, 11, 20, 21});
+      AddInputFromArray<float>(TensorShape({2, 2}), {30, 31, 40, 41});
+      AddInputFromArray<float>(TensorShape({2, 2}), {50, 51, 60, 61});
+    }
+  }
+};
+
+TEST_F(ShardedGatherOpTest, Mod) {
+  MakeOp(3, DT_INT32, "mod");
+  AddShards(/*mod=*/true);
+  AddInputFromArray<int32>(TensorShape({2, 3}), {6, 0, 4, 4, 1, 5});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({2, 3, 2}));
+  test::FillValues<float>(&expected,
+                          {60, 61, 0, 1, 40, 41, 40, 41, 10, 11, 50, 51});
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
+TEST_F(ShardedGatherOpTest, Div) {
+  MakeOp(3, DT_INT64, "div");
+  AddShards(/*mod=*/false);
+  AddInputFromArray<int64_t>(TensorShape({5}), {2, 3, 6, 0, 5});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({5, 2}));
+  test::FillValues<float>(&expected,
+                          {20, 21, 30, 31, 60, 61, 0, 1, 50, 51});
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
+TEST_F(ShardedGatherOpTest, Error_IdOutOfRange) {
+  MakeOp(3, DT_INT32, "div");
+  AddShards(/*mod=*/false);
+  AddInputFromArray<int32>(TensorShape({3}), {1, 7, 2});
+  Status s = RunOpKernel();
+  EXPECT_TRUE(absl::StrContains(
+      s.ToString(),
+      "ids[1] = 7 is not a row of the 7 rows of params with "
+      "partition_strategy 'div'"))
+      << s;
+}
+
+TEST_F(ShardedGatherOpTest, Error_ShardShapeMismatch) {
+  MakeOp(2, DT_INT32, "mod");
+  AddInputFromArray<float>(TensorShape({2, 2}), {0, 1, 2, 3});
+  AddInputFromArray<float>(TensorShape({1, 3}), {4, 5, 6});
+  AddInputFromArray<int32>(TensorShape({1}), {0});
+  Status s = RunOpKernel();
+  EXPECT_TRUE(absl::StrContains(
+      s.ToString(), "params[1].shape = [1,3] does not match params[0].shape"))
+      << s;
+}
+
+}  // namespace
+}  // namespace tensorflow
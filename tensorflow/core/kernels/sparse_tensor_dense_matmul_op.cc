@@ -19,11 +19,15 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/sparse_tensor_dense_matmul_op.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/kernels/fill_functor.h"
 #include "tensorflow/core/platform/bfloat16.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -250,76 +254,120 @@ Status MOutOfBoundsError(int64_t m, std::size_t i, int lhs_index_a,
                                  "] out of bounds (>=", out_dim0, ")");
 }
 
+// Checks the indices of every entry of A, then calls `fn(i, m, k)` for each
+// entry i, where m is its row in the output and k its row in B.
+//
+// Small products run in input order on the calling thread.  Larger ones group
+// the entries by output row with a stable counting sort and shard ranges of
+// rows over `worker_threads`, so that each row of the output is accumulated by
+// a single thread, without atomics, and in the same order as the sequential
+// loop.  `cost_per_entry` is the cost of one call to `fn`, in cycles.
+template <typename Tindices, bool ADJ_A, typename Fn>
+Status ForEachEntryByRow(const DeviceBase::CpuWorkerThreads& worker_threads,
+                         typename TTypes<Tindices>::ConstMatrix a_indices,
+                         std::size_t lhs_right, int64_t out_rows,
+                         int64_t cost_per_entry, Fn fn) {
+  // Below this much work, sorting and sharding cost more than they save.
+  static constexpr int64_t kMinParallelCost = 1 << 16;
+
+  const std::size_t nnz = a_indices.dimension(0);
+  const int lhs_index_a = ADJ_A ? 1 : 0;
+  const int rhs_index_a = ADJ_A ? 0 : 1;
+  std::vector<Tindices> rows(nnz);
+  std::vector<Tindices> cols(nnz);
+  for (std::size_t i = 0; i < nnz; ++i) {
+    const Tindices m = internal::SubtleMustCopy(a_indices(i, lhs_index_a));
+    const Tindices k = internal::SubtleMustCopy(a_indices(i, rhs_index_a));
+    if (!FastBoundsCheck(k, lhs_right)) {
+      return KOutOfBoundsError(k, i, rhs_index_a, lhs_right);
+    }
+    if (!FastBoundsCheck(m, out_rows)) {
+      return MOutOfBoundsError(m, i, lhs_index_a, out_rows);
+    }
+    rows[i] = m;
+    cols[i] = k;
+  }
+
+  if (worker_threads.num_threads <= 1 ||
+      static_cast<int64_t>(nnz) * cost_per_entry < kMinParallelCost) {
+    for (std::size_t i = 0; i < nnz; ++i) fn(i, rows[i], cols[i]);
+    return Status::OK();
+  }
+
+  std::vector<int64_t> row_starts(out_rows + 1, 0);
+  for (std::size_t i = 0; i < nnz; ++i) ++row_starts[rows[i] + 1];
+  for (int64_t m = 0; m < out_rows; ++m) row_starts[m + 1] += row_starts[m];
+  std::vector<int64_t> order(nnz);
+  {
+    std::vector<int64_t> next(row_starts.begin(), row_starts.end() - 1);
+    for (std::size_t i = 0; i < nnz; ++i) order[next[rows[i]]++] = i;
+  }
+
+  const int64_t cost_per_row =
+      std::max<int64_t>(1, nnz / out_rows) * cost_per_entry;
+  Shard(worker_threads.num_threads, worker_threads.workers, out_rows,
+        cost_per_row, [&](int64_t begin, int64_t end) {
+          for (int64_t p = row_starts[begin]; p < row_starts[end]; ++p) {
+            const int64_t i = order[p];
+            fn(i, rows[i], cols[i]);
+          }
+        });
+  return Status::OK();
+}
+
 template <typename T, typename Tsum, typename Tindices, bool ADJ_A, bool ADJ_B>
 Status SparseTensorDenseMatMulImpl(
+    const DeviceBase::CpuWorkerThreads& worker_threads,
     typename TTypes<Tsum>::Matrix out,
     typename TTypes<Tindices>::ConstMatrix a_indices,
     typename TTypes<T>::ConstVec a_values, typename TTypes<T>::ConstMatrix b) {
   // Vectorize certain operations above this size.
   static constexpr std::size_t kNumVectorize = 32;
 
-  const std::size_t nnz = a_values.size();
   const std::size_t rhs_right = (ADJ_B ? b.dimension(0) : b.dimension(1));
   const std::size_t lhs_right = (ADJ_B ? b.dimension(1) : b.dimension(0));
-  const int lhs_index_a = ADJ_A ? 1 : 0;
-  const int rhs_index_a = ADJ_A ? 0 : 1;
-
-  // TODO(ebrevdo): After many failed experiments, can't find a multi-threaded
-  // approach that achieves the performance of the single threaded
-  // one.  Perhaps Eigen threadpool implementation is just too slow?
+  const int64_t out_rows = out.dimension(0);
+  // Each entry of A costs one multiply-add per column of the output.
+  const int64_t cost_per_entry = 2 * rhs_right;
 
   if (rhs_right < kNumVectorize) {
     // Disable vectorization if the RHS of output is too small
     auto maybe_adjoint_b = MaybeAdjoint<decltype(b), ADJ_B>(b);
 
-    for (std::size_t i = 0; i < nnz; ++i) {
-      const Tindices m = internal::SubtleMustCopy(a_indices(i, lhs_index_a));
-      const Tindices k = internal::SubtleMustCopy(a_indices(i, rhs_index_a));
-      if (!FastBoundsCheck(k, lhs_right)) {
-        return KOutOfBoundsError(k, i, rhs_index_a, lhs_right);
-      }
-      if (!FastBoundsCheck(m, out.dimension(0))) {
-        return MOutOfBoundsError(m, i, lhs_index_a, out.dimension(0));
-      }
-      const T a_value = ADJ_A ? MaybeConj(a_values(i)) : a_values(i);
-      for (std::size_t n = 0; n < rhs_right; ++n) {
-        const T b_value = maybe_adjoint_b(k, n);
-        out(m, n) += static_cast<Tsum>(a_value) * static_cast<Tsum>(b_value);
-      }
-    }
-  } else {
-    // Vectorization via Eigen.
-    const int b_chip_index = ADJ_B ? 1 : 0;
-
-#define LOOP_NNZ(b_passed)                                                  \
-  for (std::size_t i = 0; i < nnz; ++i) {                                   \
-    const Tindices m = internal::SubtleMustCopy(a_indices(i, lhs_index_a)); \
-    const Tindices k = internal::SubtleMustCopy(a_indices(i, rhs_index_a)); \
-    const T a_value = (ADJ_A) ? MaybeConj(a_values(i)) : a_values(i);       \
-    if (!FastBoundsCheck(k, lhs_right)) {                                   \
-      return KOutOfBoundsError(k, i, rhs_index_a, lhs_right);               \
-    }                                                                       \
-    if (!FastBoundsCheck(m, out.dimension(0))) {                            \
-      return MOutOfBoundsError(m, i, lhs_index_a, out.dimension(0));        \
-    }                                                                       \
-    out.template chip<0>(m) +=                                              \
-        b_passed.template chip<b_chip_index>(k).template cast<Tsum>() *     \
-        static_cast<Tsum>(a_value);                                         \
+    return ForEachEntryByRow<Tindices, ADJ_A>(
+        worker_threads, a_indices, lhs_right, out_rows, cost_per_entry,
+        [&](std::size_t i, Tindices m, Tindices k) {
+          const T a_value = ADJ_A ? MaybeConj(a_values(i)) : a_values(i);
+          for (std::size_t n = 0; n < rhs_right; ++n) {
+            const T b_value = maybe_adjoint_b(k, n);
+            out(m, n) +=
+                static_cast<Tsum>(a_value) * static_cast<Tsum>(b_value);
+          }
+        });
   }
 
-    if (ADJ_B) {
-      // Perform transpose and conjugation on B once, since we chip out B's
-      // columns in the nnz loop.
-      Eigen::array<int, 2> shuffle(1, 0);  // preserve dimension order
-      Eigen::Tensor<T, 2, Eigen::ColMajor> col_major_conj_b =
-          b.swap_layout().shuffle(shuffle).conjugate();
-      LOOP_NNZ(col_major_conj_b);
-    } else {
-      LOOP_NNZ(b);
-    }
-#undef LOOP_NNZ
+  // Vectorization via Eigen.
+  const int b_chip_index = ADJ_B ? 1 : 0;
+  auto accumulate_rows = [&](const auto& b_passed) {
+    return ForEachEntryByRow<Tindices, ADJ_A>(
+        worker_threads, a_indices, lhs_right, out_rows, cost_per_entry,
+        [&](std::size_t i, Tindices m, Tindices k) {
+          const T a_value = (ADJ_A) ? MaybeConj(a_values(i)) : a_values(i);
+          out.template chip<0>(m) +=
+              b_passed.template chip<b_chip_index>(k).template cast<Tsum>() *
+              static_cast<Tsum>(a_value);
+        });
+  };
+
+  if (ADJ_B) {
+    // Perform transpose and conjugation on B once, since we chip out B's
+    // columns in the nnz loop.
+    Eigen::array<int, 2> shuffle(1, 0);  // preserve dimension order
+    Eigen::Tensor<T, 2, Eigen::ColMajor> col_major_conj_b =
+        b.swap_layout().shuffle(shuffle).conjugate();
+    return accumulate_rows(col_major_conj_b);
   }
-  return Status::OK();
+  return accumulate_rows(b);
 }
 }  // namespace
 
@@ -330,6 +378,8 @@ struct SparseTensorDenseMatMulFunctor<CPUDevice, T, Tindices, ADJ_A, ADJ_B> {
                         typename TTypes<T>::ConstVec a_values,
                         typename TTypes<T>::ConstMatrix b) {
     using Tsum = typename SumType<T>::type;
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *ctx->device()->tensorflow_cpu_worker_threads();
     Tensor temp_out_t;
     if (!std::is_same<T, Tsum>::value) {
       TF_RETURN_IF_ERROR(ctx->allocate_temp(
@@ -339,7 +389,7 @@ struct SparseTensorDenseMatMulFunctor<CPUDevice, T, Tindices, ADJ_A, ADJ_B> {
       temp_out.setZero();
       TF_RETURN_IF_ERROR(
           SparseTensorDenseMatMulImpl<T, Tsum, Tindices, ADJ_A, ADJ_B>(
-              temp_out, a_indices, a_values, b));
+              worker_threads, temp_out, a_indices, a_values, b));
       out = temp_out.template cast<T>();
     } else {
       out.setZero();
@@ -349,7 +399,7 @@ struct SparseTensorDenseMatMulFunctor<CPUDevice, T, Tindices, ADJ_A, ADJ_B> {
           *reinterpret_cast<typename TTypes<Tsum>::Matrix*>(&out);
       TF_RETURN_IF_ERROR(
           SparseTensorDenseMatMulImpl<T, Tsum, Tindices, ADJ_A, ADJ_B>(
-              out_workaround, a_indices, a_values, b));
+              worker_threads, out_workaround, a_indices, a_values, b));
     }
     return Status::OK();
   }
@@ -14,15 +14,126 @@ limitations under the License.
 ==============================================================================*/
 
 #include <random>
+#include <vector>
 
+#include "absl/strings/match.h"
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 
 namespace tensorflow {
 
+class SparseTensorDenseMatMulOpTest : public OpsTestBase {
+ protected:
+  // Multiplies a random, unsorted m x k SparseTensor with `nnz` entries (with
+  // duplicates) by a random k x n matrix and compares against a dense product.
+  void RunAndCheck(int nnz, int m, int k, int n, bool adjoint_a,
+                   bool adjoint_b) {
+    TF_ASSERT_OK(NodeDefBuilder("matmul", "SparseTensorDenseMatMul")
+                     .Input(FakeInput(DT_INT64))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_INT64))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Attr("adjoint_a", adjoint_a)
+                     .Attr("adjoint_b", adjoint_b)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+
+    std::mt19937 gen(nnz + m + k + n);
+    std::uniform_int_distribution<int64_t> row_dist(0, m - 1);
+    std::uniform_int_distribution<int64_t> col_dist(0, k - 1);
+    std::uniform_real_distribution<float> value_dist(-1.0f, 1.0f);
+    std::vector<int64_t> indices;
+    std::vector<float> values;
+    std::vector<float> dense_a(m * k, 0.0f);
+    for (int i = 0; i < nnz; ++i) {
+      const int64_t row = row_dist(gen);
+      const int64_t col = col_dist(gen);
+      const float value = value_dist(gen);
+      indices.push_back(adjoint_a ? col : row);
+      indices.push_back(adjoint_a ? row : col);
+      values.push_back(value);
+      dense_a[row * k + col] += value;
+    }
+    std::vector<float> b(k * n);
+    for (float& v : b) v = value_dist(gen);
+    std::vector<float> b_input(b);
+    if (adjoint_b) {
+      for (int p = 0; p < k; ++p) {
+        for (int j = 0; j < n; ++j) b_input[j * k + p] = b[p * n + j];
+      }
+    }
+
+    AddInputFromArray<int64_t>(TensorShape({nnz, 2}), indices);
+    AddInputFromArray<float>(TensorShape({nnz}), values);
+    AddInputFromArray<int64_t>(TensorShape({2}), {adjoint_a ? k : m,
+                                                  adjoint_a ? m : k});
+    AddInputFromArray<float>(
+        adjoint_b ? TensorShape({n, k}) : TensorShape({k, n}), b_input);
+    TF_ASSERT_OK(RunOpKernel());
+
+    Tensor expected(allocator(), DT_FLOAT, TensorShape({m, n}));
+    auto expected_t = expected.matrix<float>();
+    for (int i = 0; i < m; ++i) {
+      for (int j = 0; j < n; ++j) {
+        float sum = 0;
+        for (int p = 0; p < k; ++p) sum += dense_a[i * k + p] * b[p * n + j];
+        expected_t(i, j) = sum;
+      }
+    }
+    test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-4);
+  }
+};
+
+TEST_F(SparseTensorDenseMatMulOpTest, Small) {
+  RunAndCheck(/*nnz=*/20, /*m=*/7, /*k=*/9, /*n=*/3, false, false);
+}
+
+TEST_F(SparseTensorDenseMatMulOpTest, ShardedNarrowOutput) {
+  RunAndCheck(/*nnz=*/8000, /*m=*/300, /*k=*/200, /*n=*/16, false, false);
+}
+
+TEST_F(SparseTensorDenseMatMulOpTest, ShardedNarrowOutputAdjoint) {
+  RunAndCheck(/*nnz=*/8000, /*m=*/300, /*k=*/200, /*n=*/16, true, true);
+}
+
+TEST_F(SparseTensorDenseMatMulOpTest, ShardedWideOutput) {
+  RunAndCheck(/*nnz=*/4000, /*m=*/100, /*k=*/300, /*n=*/64, false, false);
+}
+
+TEST_F(SparseTensorDenseMatMulOpTest, ShardedWideOutputAdjointA) {
+  RunAndCheck(/*nnz=*/4000, /*m=*/100, /*k=*/300, /*n=*/64, true, false);
+}
+
+TEST_F(SparseTensorDenseMatMulOpTest, ShardedWideOutputAdjointB) {
+  RunAndCheck(/*nnz=*/4000, /*m=*/100, /*k=*/300, /*n=*/64, false, true);
+}
+
+TEST_F(SparseTensorDenseMatMulOpTest, IndexOutOfBounds) {
+  TF_ASSERT_OK(NodeDefBuilder("matmul", "SparseTensorDenseMatMul")
+                   .Input(FakeInput(DT_INT64))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_INT64))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  AddInputFromArray<int64_t>(TensorShape({2, 2}), {0, 0, 5, 1});
+  AddInputFromArray<float>(TensorShape({2}), {1, 2});
+  AddInputFromArray<int64_t>(TensorShape({2}), {2, 2});
+  AddInputFromArray<float>(TensorShape({2, 1}), {1, 1});
+  Status s = RunOpKernel();
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+  EXPECT_TRUE(absl::StrContains(s.error_message(), "m (5) from index[1,0]"))
+      << s;
+}
+
 Node* SparseTensorDenseMatMulNode(Graph* g, Node* a_indices, Node* a_values,
                                   Node* a_shape, Node* b, bool adjoint_a,
                                   bool adjoint_b) {
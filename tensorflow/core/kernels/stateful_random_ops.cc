@@ -107,8 +107,8 @@ Status UpdateVariableAndFill(
   }
   if (alg == RNG_ALG_PHILOX) {
     TF_RETURN_IF_ERROR(CheckPhiloxState(*var_tensor, alg_tag_skip));
-    TF_RETURN_IF_ERROR(PrepareToUpdateVariable<Device, StateElementType>(
-        ctx, var_tensor, var->copy_on_read_mode.load()));
+    TF_RETURN_IF_ERROR(
+        PrepareToUpdateVariable<Device, StateElementType>(ctx, var_tensor));
 
     UpdateVariableAndFill_Philox_Arg arg;
     arg.output_size = output_size;
@@ -280,8 +280,7 @@ class RngSkipOp : public OpKernel {
     Tensor* var_tensor = var->tensor();
     OP_REQUIRES_OK(ctx, CheckState(*var_tensor));
     using T = StateElementType;
-    OP_REQUIRES_OK(ctx, PrepareToUpdateVariable<Device, T>(
-                            ctx, var_tensor, var->copy_on_read_mode.load()));
+    OP_REQUIRES_OK(ctx, PrepareToUpdateVariable<Device, T>(ctx, var_tensor));
     if (read_old_value) {
       Tensor* output;
       OP_REQUIRES_OK(
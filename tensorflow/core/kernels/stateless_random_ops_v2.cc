@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/kernels/random_op.h"
+#include "tensorflow/core/kernels/random_op_cpu.h"
 #include "tensorflow/core/kernels/random_ops_util.h"
 #include "tensorflow/core/kernels/random_poisson_op.h"
 #include "tensorflow/core/kernels/stateless_random_ops.h"
@@ -265,6 +266,103 @@ class GetAlgOp : public OpKernel {
   }
 };
 
+// Computes tf.nn.dropout(x, rate) with the uniform samples of
+// StatelessRandomUniformV2 for the same key and counter, without
+// materializing the samples or the mask. The result is bit-for-bit the one of
+//   x / (1 - rate) * cast(uniform >= rate)
+// so the gradient is the same op applied to the incoming gradient.
+template <typename T>
+class StatelessDropoutOp : public OpKernel {
+ public:
+  explicit StatelessDropoutOp(OpKernelConstruction* ctx) : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor& x_t = ctx->input(0);
+    const Tensor& rate_t = ctx->input(1);
+    const Tensor& key_t = ctx->input(2);
+    const Tensor& counter_t = ctx->input(3);
+    const int alg_input_idx = 4;
+    const Tensor& alg_t = ctx->input(alg_input_idx);
+
+    T rate;
+    OP_REQUIRES_OK(ctx, GetScalar(rate_t, 1, &rate));
+    OP_REQUIRES(ctx, rate >= T(0) && rate < T(1),
+                errors::InvalidArgument("rate must be in [0, 1), got ",
+                                        static_cast<double>(rate)));
+    int alg_id;
+    OP_REQUIRES_OK(ctx, GetScalar(alg_t, alg_input_idx, &alg_id));
+    Algorithm alg = Algorithm(alg_id);
+    if (alg == RNG_ALG_AUTO_SELECT) {
+      alg = RNG_ALG_PHILOX;
+    }
+    OP_REQUIRES(ctx, alg == RNG_ALG_PHILOX,
+                errors::InvalidArgument("Unsupported algorithm id: ", alg));
+    OP_REQUIRES_OK(ctx,
+                   CheckKeyCounterShape(alg, key_t.shape(), counter_t.shape()));
+
+    Tensor* y_t;
+    OP_REQUIRES_OK(ctx, ctx->forward_input_or_allocate_output(
+                            {0}, 0, x_t.shape(), &y_t));
+    const int64_t size = x_t.NumElements();
+    if (size == 0) {
+      return;
+    }
+
+    const random::PhiloxRandom gen = GetPhiloxRandomFromCounterKeyMem(
+        counter_t.flat<uint64>().data(), key_t.flat<uint64>().data());
+    const T* x = x_t.flat<T>().data();
+    T* y = y_t->flat<T>().data();
+    const T scale_divisor = T(1) - rate;
+
+    // Each group of samples takes one Philox block, as in FillPhiloxRandom.
+    const int kGroupSize = Distribution::kResultElementCount;
+    auto work = [&](int64_t start_group, int64_t limit_group) {
+      random::PhiloxRandom shard_gen = gen;
+      shard_gen.Skip(start_group);
+      functor::BatchedPhiloxRandom batched_gen(shard_gen);
+      BatchedDistribution dist;
+      const int64_t limit = std::min(limit_group * kGroupSize, size);
+      for (int64_t offset = start_group * kGroupSize; offset < limit;
+           offset += kGroupSize) {
+        const auto samples = dist(&batched_gen);
+        const int n = std::min<int64_t>(kGroupSize, limit - offset);
+        for (int i = 0; i < n; ++i) {
+          const T keep = samples[i] >= rate ? T(1) : T(0);
+          y[offset + i] = (x[offset + i] / scale_divisor) * keep;
+        }
+      }
+    };
+    const int64_t num_groups = (size + kGroupSize - 1) / kGroupSize;
+    const auto& worker_threads =
+        *ctx->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, num_groups,
+          /*cost_per_unit=*/(random::PhiloxRandom::kElementCost + 5) *
+              kGroupSize,
+          work);
+  }
+
+ private:
+  using Distribution = random::UniformDistribution<random::PhiloxRandom, T>;
+  using BatchedDistribution =
+      random::UniformDistribution<functor::BatchedPhiloxRandom, T>;
+};
+
+#define REGISTER_DROPOUT(TYPE)                                     \
+  REGISTER_KERNEL_BUILDER(Name("StatelessDropout")                 \
+                              .Device(DEVICE_CPU)                  \
+                              .HostMemory("key")                   \
+                              .HostMemory("counter")               \
+                              .HostMemory("alg")                   \
+                              .TypeConstraint<TYPE>("T"),          \
+                          StatelessDropoutOp<TYPE>)
+
+TF_CALL_half(REGISTER_DROPOUT);
+TF_CALL_bfloat16(REGISTER_DROPOUT);
+TF_CALL_float(REGISTER_DROPOUT);
+TF_CALL_double(REGISTER_DROPOUT);
+
+#undef REGISTER_DROPOUT
+
 #define REGISTER(DEVICE, TYPE)                                              \
   REGISTER_KERNEL_BUILDER(                                                  \
       Name("StatelessRandomUniformV2")                                      \
@@ -23,7 +23,9 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/lib/strings/byte_scan.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace {
@@ -59,19 +61,20 @@ std::vector<StringPiece> SplitOnChar(const tstring& str, const char delim,
 // Based on str_util::Split.
 template <typename Predicate>
 std::vector<StringPiece> SplitOnCharSet(const tstring& str,
-                                        const tstring& delim_set, Predicate p) {
+                                        const strings::ByteSet& delims,
+                                        Predicate p) {
   std::vector<StringPiece> result;
   StringPiece text(str);
-  StringPiece delims(delim_set);
   size_t token_start = 0;
-  for (size_t i = 0; i < text.size() + 1; i++) {
-    if ((i == text.size()) || (delims.find(text[i]) != StringPiece::npos)) {
-      StringPiece token(text.data() + token_start, i - token_start);
-      if (p(token)) {
-        result.emplace_back(token);
-      }
-      token_start = i + 1;
+  while (true) {
+    const size_t i = delims.FindFirstIn(text, token_start);
+    const size_t token_end = i == StringPiece::npos ? text.size() : i;
+    StringPiece token(text.data() + token_start, token_end - token_start);
+    if (p(token)) {
+      result.emplace_back(token);
     }
+    if (i == StringPiece::npos) break;
+    token_start = i + 1;
   }
   return result;
 }
@@ -81,6 +84,7 @@ std::vector<StringPiece> SplitOnCharSet(const tstring& str,
 // is valid.
 template <typename Predicate>
 std::vector<StringPiece> Split(const tstring& str, const tstring& delimiter,
+                               const strings::ByteSet& delim_set,
                                Predicate predicate) {
   if (str.empty()) {
     return std::vector<StringPiece>();
@@ -96,7 +100,7 @@ std::vector<StringPiece> Split(const tstring& str, const tstring& delimiter,
   if (delimiter.size() == 1) {
     return SplitOnChar(str, delimiter[0], predicate);
   }
-  return SplitOnCharSet(str, delimiter, predicate);
+  return SplitOnCharSet(str, delim_set, predicate);
 }
 
 std::vector<StringPiece> SplitV2(const tstring& str, StringPiece sep,
@@ -157,6 +161,63 @@ std::vector<StringPiece> SplitV2(const tstring& str, StringPiece sep,
   return result;
 }
 
+// Splits every element of `input_vec` with `split_fn`, sharding the batch over
+// the intra-op pool, and writes the tokens as the SparseTensor outputs
+// (indices, values, shape) of `ctx`.
+template <typename SplitFn>
+void SplitToSparse(OpKernelContext* ctx, TTypes<tstring>::ConstVec input_vec,
+                   const SplitFn& split_fn) {
+  // Rough cost, in cycles, of splitting one element or copying out its tokens.
+  static constexpr int64_t kCostPerElement = 200;
+  const int64_t batch_size = input_vec.dimension(0);
+  const DeviceBase::CpuWorkerThreads& worker_threads =
+      *ctx->device()->tensorflow_cpu_worker_threads();
+
+  std::vector<std::vector<StringPiece>> parts(batch_size);
+  Shard(worker_threads.num_threads, worker_threads.workers, batch_size,
+        kCostPerElement, [&](int64_t start, int64_t limit) {
+          for (int64_t i = start; i < limit; ++i) {
+            parts[i] = split_fn(input_vec(i));
+          }
+        });
+
+  std::vector<int64_t> row_starts(batch_size + 1, 0);
+  int64_t max_num_entries = 0;
+  for (int64_t i = 0; i < batch_size; ++i) {
+    const int64_t n_entries = parts[i].size();
+    row_starts[i + 1] = row_starts[i] + n_entries;
+    max_num_entries = std::max(max_num_entries, n_entries);
+  }
+  const int64_t output_size = row_starts[batch_size];
+
+  Tensor* sp_indices_t;
+  OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({output_size, 2}),
+                                           &sp_indices_t));
+  Tensor* sp_tokens_t;
+  OP_REQUIRES_OK(
+      ctx, ctx->allocate_output(1, TensorShape({output_size}), &sp_tokens_t));
+  Tensor* sp_shape_t;
+  OP_REQUIRES_OK(ctx, ctx->allocate_output(2, TensorShape({2}), &sp_shape_t));
+
+  auto sp_indices = sp_indices_t->matrix<int64_t>();
+  auto sp_tokens = sp_tokens_t->vec<tstring>();
+  auto sp_shape = sp_shape_t->vec<int64_t>();
+  sp_shape(0) = batch_size;
+  sp_shape(1) = max_num_entries;
+  Shard(worker_threads.num_threads, worker_threads.workers, batch_size,
+        kCostPerElement, [&](int64_t start, int64_t limit) {
+          for (int64_t i = start; i < limit; ++i) {
+            int64_t c = row_starts[i];
+            for (int64_t j = 0; j < static_cast<int64_t>(parts[i].size());
+                 ++j, ++c) {
+              sp_indices(c, 0) = i;
+              sp_indices(c, 1) = j;
+              sp_tokens(c).assign(parts[i][j].data(), parts[i][j].size());
+            }
+          }
+        });
+}
+
 }  // namespace
 
 class StringSplitOp : public OpKernel {
@@ -179,7 +240,6 @@ class StringSplitOp : public OpKernel {
                                         input_tensor->shape().DebugString()));
 
     const auto input_vec = input_tensor->vec<tstring>();
-    const int64_t batch_size = input_vec.dimension(0);
 
     const Tensor* delimiter_tensor;
     OP_REQUIRES_OK(ctx, ctx->input("delimiter", &delimiter_tensor));
@@ -190,48 +250,15 @@ class StringSplitOp : public OpKernel {
     const auto delimiter_vec = delimiter_tensor->flat<tstring>();
     const tstring& delimiter = delimiter_vec(0);
     // Empty delimiter means split the input character by character.
-    std::vector<StringPiece> tokens;
-    // Guess that we'll be unpacking a handful of tokens per example.
-    static constexpr int kReserveSize = 4;
-    tokens.reserve(batch_size * kReserveSize);
-
-    int64_t output_size = 0;
-    int64_t max_num_entries = 0;
-    std::vector<int64_t> num_indices(batch_size);
-    for (int64_t i = 0; i < batch_size; ++i) {
-      std::vector<StringPiece> parts =
-          skip_empty_ ? Split(input_vec(i), delimiter, str_util::SkipEmpty())
-                      : Split(input_vec(i), delimiter, str_util::AllowEmpty());
-      int64_t n_entries = parts.size();
-      num_indices[i] = n_entries;
-      output_size += n_entries;
-      max_num_entries = std::max(max_num_entries, n_entries);
-      tokens.insert(tokens.end(), std::make_move_iterator(parts.begin()),
-                    std::make_move_iterator(parts.end()));
-    }
-
-    Tensor* sp_indices_t;
-    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({output_size, 2}),
-                                             &sp_indices_t));
-    Tensor* sp_tokens_t;
-    OP_REQUIRES_OK(
-        ctx, ctx->allocate_output(1, TensorShape({output_size}), &sp_tokens_t));
-    Tensor* sp_shape_t;
-    OP_REQUIRES_OK(ctx, ctx->allocate_output(2, TensorShape({2}), &sp_shape_t));
-
-    auto sp_indices = sp_indices_t->matrix<int64_t>();
-    auto sp_tokens = sp_tokens_t->vec<tstring>();
-    auto sp_shape = sp_shape_t->vec<int64_t>();
-    sp_shape(0) = batch_size;
-    sp_shape(1) = max_num_entries;
-    size_t c = 0;
-    for (size_t i = 0; i < batch_size; ++i) {
-      for (size_t j = 0; j < num_indices[i]; ++j) {
-        sp_indices(c, 0) = i;
-        sp_indices(c, 1) = j;
-        sp_tokens(c).assign(tokens[c].data(), tokens[c].size());
-        ++c;
-      }
+    const strings::ByteSet delim_set(delimiter);
+    if (skip_empty_) {
+      SplitToSparse(ctx, input_vec, [&](const tstring& str) {
+        return Split(str, delimiter, delim_set, str_util::SkipEmpty());
+      });
+    } else {
+      SplitToSparse(ctx, input_vec, [&](const tstring& str) {
+        return Split(str, delimiter, delim_set, str_util::AllowEmpty());
+      });
     }
   }
 
@@ -254,7 +281,6 @@ class StringSplitV2Op : public OpKernel {
                                         input_tensor->shape().DebugString()));
 
     const auto input_vec = input_tensor->vec<tstring>();
-    const int64_t batch_size = input_vec.dimension(0);
 
     const Tensor* sep_tensor;
     OP_REQUIRES_OK(ctx, ctx->input("sep", &sep_tensor));
@@ -263,46 +289,9 @@ class StringSplitV2Op : public OpKernel {
                                         sep_tensor->shape().DebugString()));
     const auto sep_vec = sep_tensor->flat<tstring>();
     StringPiece sep(sep_vec(0));
-    std::vector<StringPiece> tokens;
-    // Guess that we'll be unpacking a handful of tokens per example.
-    static constexpr int kReserveSize = 4;
-    tokens.reserve(batch_size * kReserveSize);
-
-    int64_t output_size = 0;
-    int64_t max_num_entries = 0;
-    std::vector<int64_t> num_indices(batch_size);
-    for (int64_t i = 0; i < batch_size; ++i) {
-      std::vector<StringPiece> parts = SplitV2(input_vec(i), sep, maxsplit_);
-      int64_t n_entries = parts.size();
-      num_indices[i] = n_entries;
-      output_size += n_entries;
-      max_num_entries = std::max(max_num_entries, n_entries);
-      tokens.insert(tokens.end(), parts.begin(), parts.end());
-    }
-
-    Tensor* sp_indices_t;
-    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({output_size, 2}),
-                                             &sp_indices_t));
-    Tensor* sp_tokens_t;
-    OP_REQUIRES_OK(
-        ctx, ctx->allocate_output(1, TensorShape({output_size}), &sp_tokens_t));
-    Tensor* sp_shape_t;
-    OP_REQUIRES_OK(ctx, ctx->allocate_output(2, TensorShape({2}), &sp_shape_t));
-
-    auto sp_indices = sp_indices_t->matrix<int64_t>();
-    auto sp_tokens = sp_tokens_t->vec<tstring>();
-    auto sp_shape = sp_shape_t->vec<int64_t>();
-    sp_shape(0) = batch_size;
-    sp_shape(1) = max_num_entries;
-    size_t c = 0;
-    for (size_t i = 0; i < batch_size; ++i) {
-      for (size_t j = 0; j < num_indices[i]; ++j) {
-        sp_indices(c, 0) = i;
-        sp_indices(c, 1) = j;
-        sp_tokens(c).assign(tokens[c].data(), tokens[c].size());
-        ++c;
-      }
-    }
+    SplitToSparse(ctx, input_vec, [&](const tstring& str) {
+      return SplitV2(str, sep, maxsplit_);
+    });
   }
 
  private:
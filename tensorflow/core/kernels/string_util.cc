@@ -15,6 +15,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/string_util.h"
 
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/byte_scan.h"
 
 namespace tensorflow {
 
@@ -50,15 +51,7 @@ Status ParseCharUnit(const string& str, CharUnit* unit) {
 // Return the number of Unicode characters in a UTF-8 string.
 // Result may be incorrect if the input string is not valid UTF-8.
 int32 UTF8StrLen(const string& str) {
-  const int32_t byte_size = str.size();
-  const char* const end = str.data() + byte_size;
-  const char* ptr = str.data();
-  int32_t skipped_count = 0;
-  while (ptr < end) {
-    skipped_count += IsTrailByte(*ptr++) ? 1 : 0;
-  }
-  const int32_t result = byte_size - skipped_count;
-  return result;
+  return static_cast<int32>(strings::CountUTF8Chars(str));
 }
 
 }  // namespace tensorflow
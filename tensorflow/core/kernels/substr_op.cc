@@ -29,8 +29,10 @@ limitations under the License.
 #include "tensorflow/core/kernels/string_util.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/bcast.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -71,61 +73,36 @@ class SubstrOp : public OpKernel {
                      context->allocate_output("output", input_tensor.shape(),
                                               &output_tensor));
       auto output = output_tensor->flat<tstring>();
-      if (is_scalar) {
-        // Perform Op with scalar pos/len
-        const T pos =
-            tensorflow::internal::SubtleMustCopy(pos_tensor.scalar<T>()());
-        const T len =
-            tensorflow::internal::SubtleMustCopy(len_tensor.scalar<T>()());
-        for (size_t i = 0; i < input_tensor.NumElements(); ++i) {
-          StringPiece in(input(i));
-          T byte_pos = pos;
-          T byte_len = len;
-          switch (unit_) {
-            case CharUnit::UTF8_CHAR:
-              OP_REQUIRES(
-                  context, UpdatePosAndLenForUtf8(in, &byte_pos, &byte_len),
-                  errors::InvalidArgument("pos ", pos, " out of range for ",
-                                          "string at index ", i));
-              break;
-            case CharUnit::BYTE:
-              byte_pos = AdjustedPosIndex(byte_pos, in);
-              OP_REQUIRES(
-                  context, FastBoundsCheck(byte_pos, in.size() + 1),
-                  errors::InvalidArgument("pos ", pos, " out of range for ",
-                                          "string b'", in, "' at index ", i));
-          }
-          StringPiece sub_in = in.substr(byte_pos, byte_len);
-          output(i).assign(sub_in.data(), sub_in.size());
-        }
-      } else {
-        // Perform Op element-wise with tensor pos/len
-        auto pos_flat = pos_tensor.flat<T>();
-        auto len_flat = len_tensor.flat<T>();
-        for (size_t i = 0; i < input_tensor.NumElements(); ++i) {
-          StringPiece in(input(i));
-          const T pos = tensorflow::internal::SubtleMustCopy(pos_flat(i));
-          const T len = tensorflow::internal::SubtleMustCopy(len_flat(i));
-          T byte_pos = pos;
-          T byte_len = len;
-          switch (unit_) {
-            case CharUnit::UTF8_CHAR:
-              OP_REQUIRES(
-                  context, UpdatePosAndLenForUtf8(in, &byte_pos, &byte_len),
-                  errors::InvalidArgument("pos ", pos, " out of range for ",
-                                          "string at index ", i));
-              break;
-            case CharUnit::BYTE:
-              byte_pos = AdjustedPosIndex(byte_pos, in);
-              OP_REQUIRES(
-                  context, FastBoundsCheck(byte_pos, in.size() + 1),
-                  errors::InvalidArgument("pos ", pos, " out of range for ",
-                                          "string b'", in, "' at index ", i));
+      auto pos_flat = pos_tensor.flat<T>();
+      auto len_flat = len_tensor.flat<T>();
+      const int64_t num_elements = input_tensor.NumElements();
+      // Each shard stops at its first bad element; the error reported is the
+      // one at the lowest index, as a sequential scan would have found.
+      mutex mu;
+      int64_t first_error_index = num_elements;
+      Status first_error;
+      auto work = [&](int64_t start, int64_t limit) {
+        for (int64_t i = start; i < limit; ++i) {
+          const T pos = tensorflow::internal::SubtleMustCopy(
+              is_scalar ? pos_flat(0) : pos_flat(i));
+          const T len = tensorflow::internal::SubtleMustCopy(
+              is_scalar ? len_flat(0) : len_flat(i));
+          Status s = SubstrElement(input(i), pos, len, i, &output(i));
+          if (!s.ok()) {
+            mutex_lock l(mu);
+            if (i < first_error_index) {
+              first_error_index = i;
+              first_error = s;
+            }
+            return;
           }
-          StringPiece sub_in = in.substr(byte_pos, byte_len);
-          output(i).assign(sub_in.data(), sub_in.size());
         }
-      }
+      };
+      const DeviceBase::CpuWorkerThreads& worker_threads =
+          *context->device()->tensorflow_cpu_worker_threads();
+      Shard(worker_threads.num_threads, worker_threads.workers, num_elements,
+            kCostPerElement, work);
+      OP_REQUIRES_OK(context, first_error);
     } else {
       // Perform op with broadcasting
       // TODO: Use ternary broadcasting for once available in Eigen. Current
@@ -267,6 +244,36 @@ class SubstrOp : public OpKernel {
  private:
   // This adjusts the requested position. Note it does not perform any bound
   // checks.
+  // Rough cost, in cycles, of extracting one substring.
+  static constexpr int64_t kCostPerElement = 100;
+
+  // Writes the substring of `in` selected by `pos` and `len` to `out`, or
+  // returns an error if `pos` is out of range.  `index` is the position of
+  // `in` in the input, used for error messages.
+  Status SubstrElement(StringPiece in, const T pos, const T len,
+                       int64_t index, tstring* out) const {
+    T byte_pos = pos;
+    T byte_len = len;
+    switch (unit_) {
+      case CharUnit::UTF8_CHAR:
+        if (!UpdatePosAndLenForUtf8(in, &byte_pos, &byte_len)) {
+          return errors::InvalidArgument("pos ", pos, " out of range for ",
+                                         "string at index ", index);
+        }
+        break;
+      case CharUnit::BYTE:
+        byte_pos = AdjustedPosIndex(byte_pos, in);
+        if (!FastBoundsCheck(byte_pos, in.size() + 1)) {
+          return errors::InvalidArgument("pos ", pos, " out of range for ",
+                                         "string b'", in, "' at index ",
+                                         index);
+        }
+    }
+    StringPiece sub_in = in.substr(byte_pos, byte_len);
+    out->assign(sub_in.data(), sub_in.size());
+    return Status::OK();
+  }
+
   static inline T AdjustedPosIndex(const T pos_requested, const StringPiece s) {
     if (pos_requested < 0) {
       return s.size() + pos_requested;
@@ -23,9 +23,38 @@ limitations under the License.
 #include "tensorflow/core/summary/schema.h"
 #include "tensorflow/core/summary/summary_db_writer.h"
 #include "tensorflow/core/summary/summary_file_writer.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/event.pb.h"
 
 namespace tensorflow {
+namespace {
+
+// Options of the asynchronous summary file writer, which file writers use when
+// TF_SUMMARY_WRITER_MAX_PENDING is positive.
+struct AsyncWriterOptions {
+  int64_t max_pending = 0;
+  bool drop_when_full = false;
+};
+
+const AsyncWriterOptions& GetAsyncWriterOptions() {
+  static const AsyncWriterOptions* options = []() {
+    auto* options = new AsyncWriterOptions;
+    Status s = ReadInt64FromEnvVar("TF_SUMMARY_WRITER_MAX_PENDING", 0,
+                                   &options->max_pending);
+    if (s.ok()) {
+      s = ReadBoolFromEnvVar("TF_SUMMARY_WRITER_DROP_WHEN_FULL", false,
+                             &options->drop_when_full);
+    }
+    if (!s.ok()) {
+      LOG(ERROR) << "Writing summaries synchronously: " << s;
+      *options = AsyncWriterOptions();
+    }
+    return options;
+  }();
+  return *options;
+}
+
+}  // namespace
 
 REGISTER_KERNEL_BUILDER(Name("SummaryWriter").Device(DEVICE_CPU),
                         ResourceHandleOp<SummaryWriterInterface>);
@@ -59,6 +88,15 @@ class CreateSummaryFileWriterOp : public OpKernel {
                             ctx, HandleFromInput(ctx, 0), &s,
                             [max_queue, flush_millis, logdir, filename_suffix,
                              ctx](SummaryWriterInterface** s) {
+                              const AsyncWriterOptions& async_options =
+                                  GetAsyncWriterOptions();
+                              if (async_options.max_pending > 0) {
+                                return CreateAsyncSummaryFileWriter(
+                                    max_queue, flush_millis,
+                                    async_options.max_pending,
+                                    async_options.drop_when_full, logdir,
+                                    filename_suffix, ctx->env(), s);
+                              }
                               return CreateSummaryFileWriter(
                                   max_queue, flush_millis, logdir,
                                   filename_suffix, ctx->env(), s);
@@ -15,12 +15,14 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_TENSOR_LIST_H_
 #define TENSORFLOW_CORE_KERNELS_TENSOR_LIST_H_
 
+#include <algorithm>
 #include <utility>
 
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/variant.h"
 #include "tensorflow/core/framework/variant_tensor_data.h"
 #include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/platform/logging.h"
 
 namespace tensorflow {
 
@@ -137,6 +139,21 @@ class TensorList {
     return out;
   }
 
+  // Like Copy(), but only copies the first `num_elements` tensors and reserves
+  // room for `capacity` of them, so that kernels growing the copy don't
+  // reallocate it right away.
+  TensorList Copy(size_t num_elements, size_t capacity) const {
+    DCHECK_LE(num_elements, tensors_->values_.size());
+    TensorList out;
+    out.element_shape = element_shape;
+    out.element_dtype = element_dtype;
+    out.max_num_elements = max_num_elements;
+    out.tensors_->values_.reserve(std::max(num_elements, capacity));
+    out.tensors_->values_.assign(tensors_->values_.begin(),
+                                 tensors_->values_.begin() + num_elements);
+    return out;
+  }
+
   // Is this TensorList the only one with a reference to the underlying
   // container?
   bool RefCountIsOne() const { return tensors_->RefCountIsOne(); }
@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_TENSOR_MAP_H_
 #define TENSORFLOW_CORE_KERNELS_TENSOR_MAP_H_
 
+#include <algorithm>
 #include <utility>
 
 #include "absl/container/flat_hash_map.h"
@@ -119,6 +120,16 @@ class TensorMap {
     return out;
   }
 
+  // Like Copy(), but reserves room for `capacity` elements so that inserting
+  // into the copy doesn't rehash it right away.
+  TensorMap Copy(size_t capacity) const {
+    TensorMap out;
+    out.tensors_->values_.reserve(std::max(capacity, size()));
+    out.tensors_->values_.insert(tensors_->values_.begin(),
+                                 tensors_->values_.end());
+    return out;
+  }
+
   // Insert key and value if the key does not already exist.
   // Returns true if the insertion happens.
   bool insert(const TensorKey& key, const Tensor& value) {
@@ -156,6 +156,23 @@ TEST(TensorMapTest, Copy) {
   test::ExpectTensorEqual<int32>(tm.find(k)->second, tmc.find(k)->second);
 }
 
+TEST(TensorMapTest, CopyWithCapacity) {
+  TensorMap tm;
+  TensorKey k = Tensor(11);
+  Tensor v = Tensor(22);
+  tm.insert(k, v);
+  TensorMap tmc = tm.Copy(/*capacity=*/16);
+  EXPECT_EQ(tm.size(), tmc.size());
+  EXPECT_GE(tmc.tensors().capacity(), 16);
+  test::ExpectTensorEqual<int32>(tm.find(k)->second, tmc.find(k)->second);
+
+  // The copy doesn't share its container with the original.
+  TensorKey k2 = Tensor(33);
+  tmc.insert(k2, v);
+  EXPECT_EQ(tm.size(), 1);
+  EXPECT_EQ(tmc.size(), 2);
+}
+
 TEST(TensorMapTest, EncodeDecode) {
   TensorMap tm;
   TensorKey k = Tensor(11);
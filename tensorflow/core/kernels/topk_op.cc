@@ -21,7 +21,9 @@ limitations under the License.
 
 #include <algorithm>
 #include <numeric>
+#include <type_traits>
 #include <vector>
+
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
@@ -108,6 +110,84 @@ class TopK : public OpKernel {
 };
 
 namespace functor {
+namespace {
+
+// Once the heap of a row holds k columns, only the columns whose value is
+// greater than that of its bottom column can enter it.  Columns are compared
+// against that threshold a block at a time, and a block is only pushed into
+// the heap if one of its columns may enter it, which for large rows is rare
+// after the first few blocks.
+constexpr int64_t kFilterBlockSize = 64;
+
+// Rows of fewer columns than this are not split across threads.
+constexpr int64_t kMinColsPerShard = 1 << 15;
+
+// Returns whether any of the `n` values in `data` is not <= `threshold`,
+// i.e. is greater than it or NaN.
+template <typename T, typename Enable = void>
+struct ThresholdFilter {
+  static bool AnyCandidate(const T* data, int64_t n, T threshold) {
+    bool any = false;
+    for (int64_t i = 0; i < n; ++i) any |= !(data[i] <= threshold);
+    return any;
+  }
+};
+
+template <typename T>
+struct ThresholdFilter<
+    T, typename std::enable_if<
+           std::is_floating_point<T>::value &&
+           Eigen::internal::packet_traits<T>::Vectorizable>::type> {
+  using Packet = typename Eigen::internal::packet_traits<T>::type;
+  static constexpr int kPacketSize =
+      Eigen::internal::unpacket_traits<Packet>::size;
+
+  static bool AnyCandidate(const T* data, int64_t n, T threshold) {
+    using Eigen::internal::pcmp_lt_or_nan;
+    using Eigen::internal::ploadu;
+    using Eigen::internal::por;
+    const Packet t = Eigen::internal::pset1<Packet>(threshold);
+    Packet any = Eigen::internal::pzero(t);
+    int64_t i = 0;
+    for (; i + kPacketSize <= n; i += kPacketSize) {
+      any = por(any, pcmp_lt_or_nan(t, ploadu<Packet>(data + i)));
+    }
+    if (Eigen::internal::predux_any(any)) return true;
+    for (; i < n; ++i) {
+      if (!(data[i] <= threshold)) return true;
+    }
+    return false;
+  }
+};
+
+// Pushes the columns [begin, end) of `row` into `filter`, in increasing order.
+// Columns that `filter` would reject are skipped without being pushed: as they
+// come after the columns already in `filter`, those are the columns whose
+// value is <= that of the bottom column.
+template <typename T, typename Cmp>
+void PushColumns(const T* row, int64_t begin, int64_t end,
+                 gtl::TopN<int32, Cmp>* filter) {
+  int64_t c = begin;
+  for (; c < end && filter->size() < filter->limit(); ++c) {
+    filter->push(c);
+  }
+  if (c == end) return;
+  T threshold = row[filter->peek_bottom()];
+  while (c < end) {
+    const int64_t block_end = std::min(end, c + kFilterBlockSize);
+    if (ThresholdFilter<T>::AnyCandidate(row + c, block_end - c, threshold)) {
+      for (; c < block_end; ++c) {
+        if (!(row[c] <= threshold)) {
+          filter->push(c);
+          threshold = row[filter->peek_bottom()];
+        }
+      }
+    }
+    c = block_end;
+  }
+}
+
+}  // namespace
 
 template <typename T>
 struct TopKFunctor<CPUDevice, T> {
@@ -141,27 +221,47 @@ struct TopKFunctor<CPUDevice, T> {
       return Status::OK();
     }
 
+    // Orders columns by decreasing value, and equal values by increasing
+    // column.
+    const auto StableComp = [&input](int64_t row) {
+      const T* input_data = &input(row, 0);
+      return [input_data](const int32_t a, const int32_t b) {
+        if (input_data[b] < input_data[a]) {
+          return true;
+        } else if (input_data[b] > input_data[a]) {
+          return false;
+        } else {
+          return a < b;
+        }
+      };
+    };
+    using Filter = gtl::TopN<int32, decltype(StableComp(0))>;
+
+    // Writes the columns in `filter` and their values to row b of the output.
+    auto WriteRow = [&](int64_t b, Filter* filter) {
+      int32_t i = 0;
+      if (sorted) {
+        std::unique_ptr<std::vector<int32>> top_k(filter->Extract());
+        for (auto top_k_it = top_k->begin(); top_k_it != top_k->end();
+             ++top_k_it, ++i) {
+          indices(b, i) = *top_k_it;
+        }
+      } else {
+        for (auto top_k_it = filter->unsorted_begin();
+             top_k_it != filter->unsorted_end(); ++top_k_it, ++i) {
+          indices(b, i) = *top_k_it;
+        }
+      }
+      std::transform(&indices(b, 0), &indices(b, k), &values(b, 0),
+                     [b, &input](const int32_t loc) { return input(b, loc); });
+    };
+
     auto SortIndices = [&](int64_t start_batch, int64_t limit_batch) {
       for (int32_t b = start_batch; b < limit_batch; ++b) {
         const T* input_data = &input(b, 0);
-        const auto stable_comp = [input_data](const int32_t a,
-                                              const int32_t b) {
-          if (input_data[b] < input_data[a]) {
-            return true;
-          } else if (input_data[b] > input_data[a]) {
-            return false;
-          } else {
-            return a < b;
-          }
-        };
         const auto comp = [input_data](const int32_t a, const int32_t b) {
           return input_data[b] < input_data[a];
         };
-        // TODO(ebrevdo): For large k < num_cols, instead of using
-        // TopN, it may be faster to create a temporary vector of
-        // values 0..num_cols - 1 and then use std::partial_sort_copy
-        // of this into indices. Choosing the appropriate minimum k or
-        // ratio of k/num_cols will require some experimentation.
         if (k == num_cols) {
           auto* begin = &indices(b, 0);
           auto* end = &indices(b, k);
@@ -184,33 +284,23 @@ struct TopKFunctor<CPUDevice, T> {
             }
             run_begin = run_end;
           }
+          // Now that the indices are sorted, copy the values over in
+          // sorted order.
+          std::transform(
+              begin, end, &values(b, 0),
+              [b, &input](const int32_t loc) { return input(b, loc); });
         } else {
+          // TODO(ebrevdo): For large k < num_cols, instead of using
+          // TopN, it may be faster to create a temporary vector of
+          // values 0..num_cols - 1 and then use std::partial_sort_copy
+          // of this into indices. Choosing the appropriate minimum k or
+          // ratio of k/num_cols will require some experimentation.
           // Use the TopN heap object to sort.
-          gtl::TopN<int32, decltype(stable_comp)> filter(k, stable_comp);
+          Filter filter(k, StableComp(b));
           filter.reserve(num_cols);
-          for (int32_t c = 0; c < num_cols; ++c) {
-            filter.push(c);
-          }
-
-          int32_t i = 0;
-          if (sorted) {
-            std::unique_ptr<std::vector<int32>> top_k(filter.Extract());
-            for (auto top_k_it = top_k->begin(); top_k_it != top_k->end();
-                 ++top_k_it, ++i) {
-              indices(b, i) = *top_k_it;
-            }
-          } else {
-            for (auto top_k_it = filter.unsorted_begin();
-                 top_k_it != filter.unsorted_end(); ++top_k_it, ++i) {
-              indices(b, i) = *top_k_it;
-            }
-          }
+          PushColumns(input_data, 0, num_cols, &filter);
+          WriteRow(b, &filter);
         }
-        // Now that the indices are sorted, copy the values over in
-        // sorted order.
-        std::transform(
-            &indices(b, 0), &indices(b, k), &values(b, 0),
-            [b, &input](const int32_t loc) { return input(b, loc); });
       }  // for (int32 b = ...
     };
 
@@ -229,8 +319,59 @@ struct TopKFunctor<CPUDevice, T> {
                                    ? kint64max
                                    : static_cast<int64_t>(total_cost);
     auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+
+    // With fewer rows than threads, e.g. when retrieving the top k of a large
+    // vocabulary for a few queries, each row is split into shards whose top k
+    // are selected in parallel and then merged.
+    const int64_t min_cols_per_shard =
+        std::max<int64_t>(kMinColsPerShard, 8 * static_cast<int64_t>(k));
+    const int64_t shards_per_row =
+        k == num_cols
+            ? 1
+            : std::min<int64_t>(
+                  (worker_threads.num_threads + num_rows - 1) / num_rows,
+                  num_cols / min_cols_per_shard);
+    if (shards_per_row <= 1) {
+      Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
+            final_cost, SortIndices);
+      return Status::OK();
+    }
+
+    // The top k of shard s of row b are candidates[(b * shards_per_row + s) *
+    // k, ...), in no particular order.  Each shard has more than k columns.
+    std::vector<int32> candidates(num_rows * shards_per_row * k);
+    auto SelectShards = [&](int64_t start, int64_t limit) {
+      for (int64_t i = start; i < limit; ++i) {
+        const int64_t b = i / shards_per_row;
+        const int64_t s = i % shards_per_row;
+        Filter filter(k, StableComp(b));
+        filter.reserve(num_cols);
+        PushColumns(&input(b, 0), s * num_cols / shards_per_row,
+                    (s + 1) * num_cols / shards_per_row, &filter);
+        std::copy(filter.unsorted_begin(), filter.unsorted_end(),
+                  candidates.begin() + i * k);
+      }
+    };
+    Shard(worker_threads.num_threads, worker_threads.workers,
+          num_rows * shards_per_row, final_cost / shards_per_row,
+          SelectShards);
+
+    auto MergeShards = [&](int64_t start_batch, int64_t limit_batch) {
+      for (int64_t b = start_batch; b < limit_batch; ++b) {
+        Filter filter(k, StableComp(b));
+        filter.reserve(shards_per_row * k);
+        const auto row_begin = candidates.begin() + b * shards_per_row * k;
+        std::for_each(row_begin, row_begin + shards_per_row * k,
+                      [&filter](const int32_t c) { filter.push(c); });
+        WriteRow(b, &filter);
+      }
+    };
+    const double merge_cost =
+        4 * cmp_cost * shards_per_row * k *
+            Eigen::numext::log2(static_cast<float>(k + 1)) +
+        copy_cost;
     Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
-          final_cost, SortIndices);
+          static_cast<int64_t>(merge_cost), MergeShards);
 
     return Status::OK();
   }
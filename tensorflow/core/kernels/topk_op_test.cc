@@ -0,0 +1,116 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class TopKOpTest : public OpsTestBase {
+ protected:
+  // Runs TopKV2 on a [rows, cols] input and checks the result against a
+  // stable sort of each row.  `levels` > 0 draws the values from that many
+  // distinct levels, so that the order of ties is checked as well.
+  void RunAndCheck(int64_t rows, int64_t cols, int k, bool sorted,
+                   int levels) {
+    TF_ASSERT_OK(NodeDefBuilder("myop", "TopKV2")
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_INT32))
+                     .Attr("sorted", sorted)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+
+    std::mt19937 gen(rows * 10007 + cols + k);
+    std::vector<float> input(rows * cols);
+    if (levels > 0) {
+      std::uniform_int_distribution<int> dist(0, levels - 1);
+      for (float& v : input) v = dist(gen);
+    } else {
+      std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+      for (float& v : input) v = dist(gen);
+    }
+    AddInputFromArray<float>(TensorShape({rows, cols}), input);
+    AddInputFromArray<int32>(TensorShape({}), {k});
+    TF_ASSERT_OK(RunOpKernel());
+
+    auto values = GetOutput(0)->matrix<float>();
+    auto indices = GetOutput(1)->matrix<int32>();
+    for (int64_t b = 0; b < rows; ++b) {
+      const float* row = input.data() + b * cols;
+      std::vector<int32> expected(cols);
+      std::iota(expected.begin(), expected.end(), 0);
+      std::stable_sort(expected.begin(), expected.end(),
+                       [row](int32 x, int32 y) { return row[y] < row[x]; });
+      expected.resize(k);
+      std::vector<int32> actual(&indices(b, 0), &indices(b, 0) + k);
+      if (!sorted) {
+        std::sort(expected.begin(), expected.end());
+        std::sort(actual.begin(), actual.end());
+      }
+      ASSERT_EQ(expected, actual) << "row " << b;
+      for (int i = 0; i < k; ++i) {
+        EXPECT_EQ(row[indices(b, i)], values(b, i));
+      }
+    }
+  }
+};
+
+TEST_F(TopKOpTest, SmallRows) {
+  RunAndCheck(/*rows=*/3, /*cols=*/37, /*k=*/5, /*sorted=*/true,
+              /*levels=*/0);
+  RunAndCheck(/*rows=*/2, /*cols=*/200, /*k=*/64, /*sorted=*/true,
+              /*levels=*/0);
+}
+
+TEST_F(TopKOpTest, Ties) {
+  RunAndCheck(/*rows=*/4, /*cols=*/1000, /*k=*/20, /*sorted=*/true,
+              /*levels=*/10);
+}
+
+TEST_F(TopKOpTest, Unsorted) {
+  RunAndCheck(/*rows=*/4, /*cols=*/1000, /*k=*/20, /*sorted=*/false,
+              /*levels=*/0);
+}
+
+// Rows this large are split across threads when there are fewer rows than
+// threads.
+TEST_F(TopKOpTest, LargeRow) {
+  RunAndCheck(/*rows=*/1, /*cols=*/300000, /*k=*/100, /*sorted=*/true,
+              /*levels=*/0);
+}
+
+TEST_F(TopKOpTest, LargeRowTies) {
+  RunAndCheck(/*rows=*/2, /*cols=*/300000, /*k=*/100, /*sorted=*/true,
+              /*levels=*/1000);
+}
+
+TEST_F(TopKOpTest, LargeRowUnsorted) {
+  RunAndCheck(/*rows=*/1, /*cols=*/300000, /*k=*/1000, /*sorted=*/false,
+              /*levels=*/0);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -25,15 +25,13 @@ limitations under the License.
 
 namespace tensorflow {
 
-// Must be called before performing a sparse operation on a variable. Ensures
-// that no concurrent dense operations can happen while holding the variable's
-// lock.
+// Same as `EnsureSparseVariableAccess()`, for callers that already hold
+// `var->mu()` exclusively.
 template <typename Device, typename T>
-Status EnsureSparseVariableAccess(OpKernelContext* ctx, Var* var) {
+Status EnsureSparseVariableAccessLocked(OpKernelContext* ctx, Var* var) {
   if (var->copy_on_read_mode.load()) {
     return Status::OK();
   }
-  mutex_lock ml(*var->mu());
   // Once copy-on-read mode is True the refcount is guaranteed to be 1. This can
   // also happen if there are no concurrent reads of the variable and
   // copy-on-read mode is false.
@@ -68,6 +66,22 @@ Status EnsureSparseVariableAccess(OpKernelContext* ctx, Var* var) {
   return Status::OK();
 }
 
+// Must be called before performing a sparse operation on a variable. Ensures
+// that no concurrent dense operations can happen while holding the variable's
+// lock. A dense read may switch the variable back to copy-on-write mode while
+// its lock is not held, so sparse updates must check `copy_on_read_mode` again
+// once they hold it, and update under an exclusive lock, after calling
+// `EnsureSparseVariableAccessLocked()`, if it was reset.
+template <typename Device, typename T>
+Status EnsureSparseVariableAccess(OpKernelContext* ctx, Var* var) {
+  TF_RETURN_IF_ERROR(var->LoadLazily());
+  if (var->copy_on_read_mode.load()) {
+    return Status::OK();
+  }
+  mutex_lock ml(*var->mu());
+  return EnsureSparseVariableAccessLocked<Device, T>(ctx, var);
+}
+
 // Utility structure that releases a sequence of borrowed mutexes when it is
 // deleted.
 struct VariableInputLockHolder {
@@ -133,9 +147,10 @@ mutex* GetTrainingVariableMutex(OpKernelContext* ctx, int input, bool sparse,
 // variable gets switched to copy-on-read mode before trying to acquire the
 // locks. If do_lock is false, returns immediately for reference variables. For
 // resource variables in copy-on-read-mode it will grab a shared lock if do_lock
-// is false, exclusive lock otherwise.  Note that this silently doesn't lock
-// mutexes for invalid variable references; in all usages this is followed by
-// GetInputTensor which will signal a failure.
+// is false, exclusive lock otherwise, or if a dense read switched one of the
+// variables back to copy-on-write mode in the meantime. Note that this
+// silently doesn't lock mutexes for invalid variable references; in all usages
+// this is followed by GetInputTensor which will signal a failure.
 template <typename Device, typename T>
 VariableInputLockHolder MaybeLockVariableInputMutexesInOrder(
     OpKernelContext* ctx, bool do_lock, bool sparse,
@@ -152,27 +167,23 @@ VariableInputLockHolder MaybeLockVariableInputMutexesInOrder(
   }
   std::vector<Var*> vars;
   std::vector<mutex*> mutexes;
-  std::vector<int> acquire_order;
   for (auto input : input_ids) {
     Var* var;
     mutex* mutex =
         GetTrainingVariableMutex<Device, T>(ctx, input, sparse, &var);
     if (var) vars.push_back(var);
-    // Only lock each mutex once if duplicates exist (n^2 but n is 2 or 3).
-    if (std::find(mutexes.begin(), mutexes.end(), mutex) == mutexes.end()) {
-      acquire_order.push_back(mutexes.size());
-      mutexes.push_back(mutex);
-    }
+    mutexes.push_back(mutex);
   }
-  std::sort(acquire_order.begin(), acquire_order.end(),
-            [&mutexes](int a, int b) { return mutexes[a] < mutexes[b]; });
+  // Only lock each mutex once if duplicates exist. Sorting rather than
+  // searching keeps this cheap for the multi-variable apply ops.
+  std::sort(mutexes.begin(), mutexes.end());
+  mutexes.erase(std::unique(mutexes.begin(), mutexes.end()), mutexes.end());
 
   auto locks = absl::make_unique<std::vector<mutex_lock>>();
   auto shared_locks = absl::make_unique<std::vector<tf_shared_lock>>();
-  locks->reserve(acquire_order.size());
+  locks->reserve(mutexes.size());
 
-  for (auto acquire : acquire_order) {
-    mutex* mu = mutexes[acquire];
+  for (mutex* mu : mutexes) {
     if (mu != nullptr) {
       if (!sparse || do_lock) {
         locks->emplace_back(*mu);
@@ -181,6 +192,24 @@ VariableInputLockHolder MaybeLockVariableInputMutexesInOrder(
       }
     }
   }
+  // A dense read may have switched a variable back to copy-on-write mode
+  // before its shared lock was acquired, in which case the variables are
+  // locked exclusively instead and switched to copy-on-read mode again.
+  if (sparse && !do_lock &&
+      !std::all_of(vars.begin(), vars.end(), [](Var* var) {
+        return var->copy_on_read_mode.load();
+      })) {
+    shared_locks->clear();
+    for (mutex* mu : mutexes) {
+      if (mu != nullptr) locks->emplace_back(*mu);
+    }
+  }
+  if (sparse && !locks->empty()) {
+    for (Var* var : vars) {
+      Status s = EnsureSparseVariableAccessLocked<Device, T>(ctx, var);
+      if (!s.ok()) ctx->CtxFailureWithWarning(s);
+    }
+  }
   return VariableInputLockHolder(std::move(vars), std::move(locks),
                                  std::move(shared_locks));
 }
@@ -189,12 +218,14 @@ void MaybeForwardRefInputToRefOutput(OpKernelContext* ctx, int input,
                                      int output);
 
 // This is for use with ResourceVariables to ensure *tensor has a
-// reference count of 1 before you update it.
-// REQUIRES: If you pass in variable->tensor(), *variable->mu() must be held.
+// reference count of 1 before you update it. A variable in copy-on-read mode
+// is never aliased, so this only copies it if some other tensor currently
+// shares its buffer.
+// REQUIRES: If you pass in variable->tensor(), *variable->mu() must be held
+// exclusively.
 template <typename Device, typename T>
-Status PrepareToUpdateVariable(OpKernelContext* ctx, Tensor* tensor,
-                               bool copy_on_read_mode) {
-  if (copy_on_read_mode || !tensor->RefCountIsOne()) {
+Status PrepareToUpdateVariable(OpKernelContext* ctx, Tensor* tensor) {
+  if (!tensor->RefCountIsOne()) {
     // Tensor's buffer is in use by some read, so we need to copy before
     // updating.
     Tensor tmp;
@@ -229,8 +260,9 @@ Status PrepareToUpdateVariable(OpKernelContext* ctx, Tensor* tensor,
 // reference and resource variables. For reference variables we can just grab
 // the tensor, grabbing the lock if lock_held is False.
 //
-// For resource variables we, if sparse is true, ensure it's in copy-on-read
-// mode, and then, regardless of the value of sparse, ensure its refcount is 1
+// For resource variables we, if sparse is true, check that it's in
+// copy-on-read mode, which `MaybeLockVariableInputMutexesInOrder()` ensures
+// while the variable's lock is held, and otherwise ensure its refcount is 1
 // (by potentially copying its contents). In this case lock_held is ignored.
 template <typename Device, typename T>
 Status GetInputTensorFromVariable(OpKernelContext* ctx, int input,
@@ -239,12 +271,15 @@ Status GetInputTensorFromVariable(OpKernelContext* ctx, int input,
     core::RefCountPtr<Var> var;
     TF_RETURN_IF_ERROR(LookupResource(ctx, HandleFromInput(ctx, input), &var));
     if (sparse) {
-      TF_RETURN_IF_ERROR(EnsureSparseVariableAccess<Device, T>(ctx, var.get()));
+      if (!var->copy_on_read_mode.load()) {
+        return errors::FailedPrecondition(
+            "Sparse update of variable ", HandleFromInput(ctx, input).name(),
+            " without holding its lock in copy-on-read mode");
+      }
       *out = *var->tensor();
       return Status::OK();
     }
-    TF_RETURN_IF_ERROR(PrepareToUpdateVariable<Device, T>(
-        ctx, var->tensor(), var->copy_on_read_mode.load()));
+    TF_RETURN_IF_ERROR(PrepareToUpdateVariable<Device, T>(ctx, var->tensor()));
     *out = *var->tensor();
     return Status::OK();
   }
@@ -17,6 +17,8 @@ limitations under the License.
 #include "tensorflow/core/kernels/training_ops.h"
 
 #include <algorithm>  // NOLINT
+#include <numeric>
+#include <vector>
 
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -4689,4 +4691,388 @@ REGISTER_KERNELS(GPU, double);
 #undef REGISTER_CPU_KERNELS
 #undef REGISTER_KERNELS
 
+// Multi-tensor apply ops update a list of N variables in one kernel. The
+// inputs are `num_slots` lists of N variables (the variables and their
+// optimizer slots), followed by the scalar hyperparameters and the list of N
+// gradients. All variables are locked at once, and the elements of all of them
+// are split into chunks that are updated in parallel, so that models with many
+// small variables are not dominated by per-variable kernel overhead.
+namespace {
+
+// The number of elements updated by one unit of work.
+constexpr int64_t kMultiApplyChunkSize = 16 << 10;
+
+struct MultiApplyChunk {
+  int tensor;
+  int64_t begin;
+  int64_t end;
+};
+
+std::vector<int> MultiApplyVariableInputs(int num_vars, int num_slots) {
+  std::vector<int> inputs(num_vars * num_slots);
+  std::iota(inputs.begin(), inputs.end(), 0);
+  return inputs;
+}
+
+// Gets the `num_slots` * `num_vars` variables, slot-major, and checks that they
+// and the gradient inputs starting at `grad_start` have the same shapes.
+// REQUIRES: The variable locks are held.
+template <typename T>
+Status GetMultiApplyVariables(OpKernelContext* ctx, int num_vars,
+                              int num_slots, int grad_start,
+                              bool use_exclusive_lock,
+                              std::vector<Tensor>* variables) {
+  variables->resize(num_vars * num_slots);
+  for (int i = 0; i < num_vars * num_slots; ++i) {
+    TF_RETURN_IF_ERROR(GetInputTensorFromVariable<CPUDevice, T>(
+        ctx, i, use_exclusive_lock, /*sparse=*/false, &(*variables)[i]));
+    if (!(*variables)[i].IsInitialized()) {
+      return errors::FailedPrecondition(
+          "Attempting to use uninitialized variables: ",
+          ctx->op_kernel().requested_input(i));
+    }
+  }
+  // The chunks of a variable passed twice would be updated concurrently.
+  std::vector<const void*> buffers;
+  buffers.reserve(variables->size());
+  for (const Tensor& t : *variables) {
+    if (t.NumElements() > 0) buffers.push_back(t.tensor_data().data());
+  }
+  std::sort(buffers.begin(), buffers.end());
+  if (std::adjacent_find(buffers.begin(), buffers.end()) != buffers.end()) {
+    return errors::InvalidArgument(
+        "Each variable and slot may only be passed once");
+  }
+  for (int i = 0; i < num_vars; ++i) {
+    const TensorShape& shape = (*variables)[i].shape();
+    for (int slot = 1; slot < num_slots; ++slot) {
+      const Tensor& t = (*variables)[slot * num_vars + i];
+      if (!shape.IsSameSize(t.shape())) {
+        return errors::InvalidArgument(
+            "var and slot ", slot, " of variable ", i,
+            " do not have the same shape", shape.DebugString(), " ",
+            t.shape().DebugString());
+      }
+    }
+    const Tensor& grad = ctx->input(grad_start + i);
+    if (!shape.IsSameSize(grad.shape())) {
+      return errors::InvalidArgument("var and grad ", i,
+                                     " do not have the same shape",
+                                     shape.DebugString(), " ",
+                                     grad.shape().DebugString());
+    }
+  }
+  return Status::OK();
+}
+
+template <typename T>
+Status GetMultiApplyScalar(OpKernelContext* ctx, int input, const char* name,
+                           T* value) {
+  const Tensor& t = ctx->input(input);
+  if (!TensorShapeUtils::IsScalar(t.shape())) {
+    return errors::InvalidArgument(name, " is not a scalar: ",
+                                   t.shape().DebugString());
+  }
+  *value = t.scalar<T>()();
+  return Status::OK();
+}
+
+// Splits the first `num_vars` tensors of `variables` into chunks of at most
+// kMultiApplyChunkSize elements.
+std::vector<MultiApplyChunk> MakeMultiApplyChunks(
+    const std::vector<Tensor>& variables, int num_vars) {
+  std::vector<MultiApplyChunk> chunks;
+  for (int i = 0; i < num_vars; ++i) {
+    const int64_t size = variables[i].NumElements();
+    for (int64_t begin = 0; begin < size; begin += kMultiApplyChunkSize) {
+      chunks.push_back(
+          {i, begin, std::min(begin + kMultiApplyChunkSize, size)});
+    }
+  }
+  return chunks;
+}
+
+// Calls `fn(chunk)` for all `chunks` in parallel on the intra-op thread pool.
+// `bytes_per_element` and `cycles_per_element` estimate the cost of updating
+// one element.
+template <typename Fn>
+void ParallelForMultiApplyChunks(OpKernelContext* ctx,
+                                 const std::vector<MultiApplyChunk>& chunks,
+                                 int bytes_per_element,
+                                 double cycles_per_element, const Fn& fn) {
+  const Eigen::TensorOpCost cost(bytes_per_element * kMultiApplyChunkSize, 0,
+                                 cycles_per_element * kMultiApplyChunkSize);
+  ctx->eigen_device<CPUDevice>().parallelFor(
+      chunks.size(), cost, [&chunks, &fn](Index begin, Index end) {
+        for (Index i = begin; i < end; ++i) fn(chunks[i]);
+      });
+}
+
+template <typename T>
+typename TTypes<T>::UnalignedTensor ChunkOf(Tensor* t,
+                                            const MultiApplyChunk& chunk) {
+  return typename TTypes<T>::UnalignedTensor(
+      t->flat<T>().data() + chunk.begin, chunk.end - chunk.begin);
+}
+
+template <typename T>
+typename TTypes<T>::UnalignedConstTensor ConstChunkOf(
+    const Tensor& t, const MultiApplyChunk& chunk) {
+  return typename TTypes<T>::UnalignedConstTensor(
+      t.flat<T>().data() + chunk.begin, chunk.end - chunk.begin);
+}
+
+}  // namespace
+
+template <typename T>
+class MultiApplyAdamOp : public OpKernel {
+ public:
+  explicit MultiApplyAdamOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("N", &num_vars_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("use_locking", &use_exclusive_lock_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("use_nesterov", &use_nesterov_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const int n = num_vars_;
+    auto locks = MaybeLockVariableInputMutexesInOrder<CPUDevice, T>(
+        ctx, use_exclusive_lock_, /*sparse=*/false,
+        MultiApplyVariableInputs(n, 3));
+    std::vector<Tensor> vars;
+    OP_REQUIRES_OK(ctx, GetMultiApplyVariables<T>(ctx, n, 3, 3 * n + 6,
+                                                  use_exclusive_lock_, &vars));
+    T beta1_power, beta2_power, lr, beta1, beta2, epsilon;
+    OP_REQUIRES_OK(ctx, GetMultiApplyScalar(ctx, 3 * n, "beta1_power",
+                                            &beta1_power));
+    OP_REQUIRES_OK(ctx, GetMultiApplyScalar(ctx, 3 * n + 1, "beta2_power",
+                                            &beta2_power));
+    OP_REQUIRES_OK(ctx, GetMultiApplyScalar(ctx, 3 * n + 2, "lr", &lr));
+    OP_REQUIRES_OK(ctx, GetMultiApplyScalar(ctx, 3 * n + 3, "beta1", &beta1));
+    OP_REQUIRES_OK(ctx, GetMultiApplyScalar(ctx, 3 * n + 4, "beta2", &beta2));
+    OP_REQUIRES_OK(ctx,
+                   GetMultiApplyScalar(ctx, 3 * n + 5, "epsilon", &epsilon));
+
+    const T alpha = lr * Eigen::numext::sqrt(T(1) - beta2_power) /
+                    (T(1) - beta1_power);
+    const bool use_nesterov = use_nesterov_;
+    auto update = [&](const MultiApplyChunk& chunk) {
+      auto var = ChunkOf<T>(&vars[chunk.tensor], chunk);
+      auto m = ChunkOf<T>(&vars[n + chunk.tensor], chunk);
+      auto v = ChunkOf<T>(&vars[2 * n + chunk.tensor], chunk);
+      auto g = ConstChunkOf<T>(ctx->input(3 * n + 6 + chunk.tensor), chunk);
+      m += (g - m) * (T(1) - beta1);
+      v += (g.square() - v) * (T(1) - beta2);
+      if (use_nesterov) {
+        var -= ((g * (T(1) - beta1) + m * beta1) * alpha) /
+               (v.sqrt() + epsilon);
+      } else {
+        var -= (m * alpha) / (v.sqrt() + epsilon);
+      }
+    };
+    ParallelForMultiApplyChunks(ctx, MakeMultiApplyChunks(vars, n),
+                                sizeof(T) * 7, 20, update);
+  }
+
+ private:
+  int num_vars_;
+  bool use_exclusive_lock_;
+  bool use_nesterov_;
+};
+
+template <typename T>
+class MultiApplyAdagradOp : public OpKernel {
+ public:
+  explicit MultiApplyAdagradOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("N", &num_vars_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("use_locking", &use_exclusive_lock_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("update_slots", &update_slots_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const int n = num_vars_;
+    auto locks = MaybeLockVariableInputMutexesInOrder<CPUDevice, T>(
+        ctx, use_exclusive_lock_, /*sparse=*/false,
+        MultiApplyVariableInputs(n, 2));
+    std::vector<Tensor> vars;
+    OP_REQUIRES_OK(ctx, GetMultiApplyVariables<T>(ctx, n, 2, 2 * n + 2,
+                                                  use_exclusive_lock_, &vars));
+    T lr, epsilon;
+    OP_REQUIRES_OK(ctx, GetMultiApplyScalar(ctx, 2 * n, "lr", &lr));
+    OP_REQUIRES_OK(ctx,
+                   GetMultiApplyScalar(ctx, 2 * n + 1, "epsilon", &epsilon));
+
+    const bool update_slots = update_slots_;
+    auto update = [&](const MultiApplyChunk& chunk) {
+      auto var = ChunkOf<T>(&vars[chunk.tensor], chunk);
+      auto accum = ChunkOf<T>(&vars[n + chunk.tensor], chunk);
+      auto g = ConstChunkOf<T>(ctx->input(2 * n + 2 + chunk.tensor), chunk);
+      if (update_slots) {
+        accum += g.square();
+      }
+      var -= g * lr / (accum.sqrt() + epsilon);
+    };
+    ParallelForMultiApplyChunks(ctx, MakeMultiApplyChunks(vars, n),
+                                sizeof(T) * 5, 10, update);
+  }
+
+ private:
+  int num_vars_;
+  bool use_exclusive_lock_;
+  bool update_slots_;
+};
+
+template <typename T>
+class MultiApplyMomentumOp : public OpKernel {
+ public:
+  explicit MultiApplyMomentumOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("N", &num_vars_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("use_locking", &use_exclusive_lock_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("use_nesterov", &use_nesterov_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const int n = num_vars_;
+    auto locks = MaybeLockVariableInputMutexesInOrder<CPUDevice, T>(
+        ctx, use_exclusive_lock_, /*sparse=*/false,
+        MultiApplyVariableInputs(n, 2));
+    std::vector<Tensor> vars;
+    OP_REQUIRES_OK(ctx, GetMultiApplyVariables<T>(ctx, n, 2, 2 * n + 2,
+                                                  use_exclusive_lock_, &vars));
+    T lr, momentum;
+    OP_REQUIRES_OK(ctx, GetMultiApplyScalar(ctx, 2 * n, "lr", &lr));
+    OP_REQUIRES_OK(ctx,
+                   GetMultiApplyScalar(ctx, 2 * n + 1, "momentum", &momentum));
+
+    const bool use_nesterov = use_nesterov_;
+    auto update = [&](const MultiApplyChunk& chunk) {
+      auto var = ChunkOf<T>(&vars[chunk.tensor], chunk);
+      auto accum = ChunkOf<T>(&vars[n + chunk.tensor], chunk);
+      auto g = ConstChunkOf<T>(ctx->input(2 * n + 2 + chunk.tensor), chunk);
+      accum = accum * momentum + g;
+      if (use_nesterov) {
+        var -= g * lr + accum * momentum * lr;
+      } else {
+        var -= accum * lr;
+      }
+    };
+    ParallelForMultiApplyChunks(ctx, MakeMultiApplyChunks(vars, n),
+                                sizeof(T) * 5, 6, update);
+  }
+
+ private:
+  int num_vars_;
+  bool use_exclusive_lock_;
+  bool use_nesterov_;
+};
+
+// LAMB (https://arxiv.org/abs/1904.00962) scales the Adam update of each
+// variable by the ratio of the norm of the variable to the norm of the update.
+// The first pass updates the slots and accumulates both norms per chunk; the
+// second pass recomputes the update from the new slots and applies it.
+template <typename T>
+class MultiApplyLambOp : public OpKernel {
+ public:
+  explicit MultiApplyLambOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("N", &num_vars_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("use_locking", &use_exclusive_lock_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const int n = num_vars_;
+    auto locks = MaybeLockVariableInputMutexesInOrder<CPUDevice, T>(
+        ctx, use_exclusive_lock_, /*sparse=*/false,
+        MultiApplyVariableInputs(n, 3));
+    std::vector<Tensor> vars;
+    OP_REQUIRES_OK(ctx, GetMultiApplyVariables<T>(ctx, n, 3, 3 * n + 7,
+                                                  use_exclusive_lock_, &vars));
+    T beta1_power, beta2_power, lr, beta1, beta2, epsilon, weight_decay;
+    OP_REQUIRES_OK(ctx, GetMultiApplyScalar(ctx, 3 * n, "beta1_power",
+                                            &beta1_power));
+    OP_REQUIRES_OK(ctx, GetMultiApplyScalar(ctx, 3 * n + 1, "beta2_power",
+                                            &beta2_power));
+    OP_REQUIRES_OK(ctx, GetMultiApplyScalar(ctx, 3 * n + 2, "lr", &lr));
+    OP_REQUIRES_OK(ctx, GetMultiApplyScalar(ctx, 3 * n + 3, "beta1", &beta1));
+    OP_REQUIRES_OK(ctx, GetMultiApplyScalar(ctx, 3 * n + 4, "beta2", &beta2));
+    OP_REQUIRES_OK(ctx,
+                   GetMultiApplyScalar(ctx, 3 * n + 5, "epsilon", &epsilon));
+    OP_REQUIRES_OK(ctx, GetMultiApplyScalar(ctx, 3 * n + 6, "weight_decay",
+                                            &weight_decay));
+
+    const T m_scale = T(1) / (T(1) - beta1_power);
+    const T v_scale = T(1) / (T(1) - beta2_power);
+    const std::vector<MultiApplyChunk> chunks = MakeMultiApplyChunks(vars, n);
+    std::vector<T> var_square_norms(chunks.size());
+    std::vector<T> update_square_norms(chunks.size());
+    auto update_slots = [&](const MultiApplyChunk& chunk) {
+      auto var = ChunkOf<T>(&vars[chunk.tensor], chunk);
+      auto m = ChunkOf<T>(&vars[n + chunk.tensor], chunk);
+      auto v = ChunkOf<T>(&vars[2 * n + chunk.tensor], chunk);
+      auto g = ConstChunkOf<T>(ctx->input(3 * n + 7 + chunk.tensor), chunk);
+      m += (g - m) * (T(1) - beta1);
+      v += (g.square() - v) * (T(1) - beta2);
+      const Eigen::Tensor<T, 0, Eigen::RowMajor> var_norm = var.square().sum();
+      const Eigen::Tensor<T, 0, Eigen::RowMajor> update_norm =
+          (m * m_scale / ((v * v_scale).sqrt() + epsilon) + var * weight_decay)
+              .square()
+              .sum();
+      const int64_t i = &chunk - chunks.data();
+      var_square_norms[i] = var_norm();
+      update_square_norms[i] = update_norm();
+    };
+    ParallelForMultiApplyChunks(ctx, chunks, sizeof(T) * 6, 20, update_slots);
+
+    std::vector<T> var_norms(n, T(0));
+    std::vector<T> update_norms(n, T(0));
+    for (int i = 0; i < chunks.size(); ++i) {
+      var_norms[chunks[i].tensor] += var_square_norms[i];
+      update_norms[chunks[i].tensor] += update_square_norms[i];
+    }
+    std::vector<T> trust_ratios(n);
+    for (int i = 0; i < n; ++i) {
+      const T var_norm = Eigen::numext::sqrt(var_norms[i]);
+      const T update_norm = Eigen::numext::sqrt(update_norms[i]);
+      trust_ratios[i] = var_norm > T(0) && update_norm > T(0)
+                            ? var_norm / update_norm
+                            : T(1);
+    }
+
+    auto apply = [&](const MultiApplyChunk& chunk) {
+      auto var = ChunkOf<T>(&vars[chunk.tensor], chunk);
+      auto m = ChunkOf<T>(&vars[n + chunk.tensor], chunk);
+      auto v = ChunkOf<T>(&vars[2 * n + chunk.tensor], chunk);
+      const T step = lr * trust_ratios[chunk.tensor];
+      var -= (m * m_scale / ((v * v_scale).sqrt() + epsilon) +
+              var * weight_decay) *
+             step;
+    };
+    ParallelForMultiApplyChunks(ctx, chunks, sizeof(T) * 4, 12, apply);
+  }
+
+ private:
+  int num_vars_;
+  bool use_exclusive_lock_;
+};
+
+#define REGISTER_CPU_KERNELS(T)                              \
+  REGISTER_KERNEL_BUILDER(Name("ResourceMultiApplyAdam")     \
+                              .Device(DEVICE_CPU)            \
+                              .TypeConstraint<T>("T"),       \
+                          MultiApplyAdamOp<T>);              \
+  REGISTER_KERNEL_BUILDER(Name("ResourceMultiApplyAdagrad")  \
+                              .Device(DEVICE_CPU)            \
+                              .TypeConstraint<T>("T"),       \
+                          MultiApplyAdagradOp<T>);           \
+  REGISTER_KERNEL_BUILDER(Name("ResourceMultiApplyMomentum") \
+                              .Device(DEVICE_CPU)            \
+                              .TypeConstraint<T>("T"),       \
+                          MultiApplyMomentumOp<T>);          \
+  REGISTER_KERNEL_BUILDER(Name("ResourceMultiApplyLamb")     \
+                              .Device(DEVICE_CPU)            \
+                              .TypeConstraint<T>("T"),       \
+                          MultiApplyLambOp<T>);
+
+TF_CALL_float(REGISTER_CPU_KERNELS);
+TF_CALL_double(REGISTER_CPU_KERNELS);
+#undef REGISTER_CPU_KERNELS
+
 }  // namespace tensorflow
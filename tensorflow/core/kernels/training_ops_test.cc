@@ -13,9 +13,17 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <cmath>
+#include <vector>
+
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/kernels/ops_util.h"
+#include "tensorflow/core/kernels/variable_ops.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/public/session_options.h"
@@ -420,4 +428,170 @@ static void BM_PowerSign(::testing::benchmark::State& state) {
 }
 BENCHMARK(BM_PowerSign)->Arg(128 << 10)->Arg(256 << 10);
 
+// The Var() graph builders above hide the resource variable class.
+using ResourceVar = class Var;
+
+class MultiApplyOpTest : public OpsTestBase {
+ protected:
+  // Adds a list of resource variable inputs named `prefix`0, `prefix`1, ...
+  std::vector<ResourceVar*> AddVariables(
+      const std::string& prefix,
+      const std::vector<std::vector<float>>& values) {
+    std::vector<ResourceVar*> vars;
+    for (int i = 0; i < values.size(); ++i) {
+      ResourceVar* var = new ResourceVar(DT_FLOAT);
+      *var->tensor() = test::AsTensor<float>(values[i]);
+      var->is_initialized = true;
+      AddResourceInput("", strings::StrCat(prefix, i), var);
+      vars.push_back(var);
+    }
+    return vars;
+  }
+
+  void AddScalar(float value) {
+    AddInputFromArray<float>(TensorShape({}), {value});
+  }
+
+  void AddGradients(const std::vector<std::vector<float>>& values) {
+    for (const std::vector<float>& grad : values) {
+      AddInputFromArray<float>(TensorShape({static_cast<int64_t>(grad.size())}),
+                               grad);
+    }
+  }
+};
+
+TEST_F(MultiApplyOpTest, Adam) {
+  TF_ASSERT_OK(NodeDefBuilder("adam", "ResourceMultiApplyAdam")
+                   .Input(FakeInput(2, DT_RESOURCE))
+                   .Input(FakeInput(2, DT_RESOURCE))
+                   .Input(FakeInput(2, DT_RESOURCE))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(2, DT_FLOAT))
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  const std::vector<std::vector<float>> init = {{1, 2, 3}, {-1, 4}};
+  const std::vector<std::vector<float>> grads = {{0.5, -1, 2}, {1, 0}};
+  std::vector<ResourceVar*> vars = AddVariables("var", init);
+  std::vector<ResourceVar*> ms = AddVariables("m", {{0.1, 0.2, 0.3}, {0, 0}});
+  std::vector<ResourceVar*> vs = AddVariables("v", {{1, 1, 1}, {0.5, 0.5}});
+  const float beta1_power = 0.9, beta2_power = 0.99, lr = 0.01;
+  const float beta1 = 0.9, beta2 = 0.99, epsilon = 1e-8;
+  for (float value : {beta1_power, beta2_power, lr, beta1, beta2, epsilon}) {
+    AddScalar(value);
+  }
+  AddGradients(grads);
+  TF_ASSERT_OK(RunOpKernel());
+
+  const float alpha = lr * std::sqrt(1 - beta2_power) / (1 - beta1_power);
+  for (int i = 0; i < init.size(); ++i) {
+    auto var = vars[i]->tensor()->flat<float>();
+    auto m = ms[i]->tensor()->flat<float>();
+    auto v = vs[i]->tensor()->flat<float>();
+    for (int j = 0; j < init[i].size(); ++j) {
+      const float g = grads[i][j];
+      const float old_m = i == 0 ? 0.1f * (j + 1) : 0.0f;
+      const float old_v = i == 0 ? 1.0f : 0.5f;
+      const float new_m = old_m + (g - old_m) * (1 - beta1);
+      const float new_v = old_v + (g * g - old_v) * (1 - beta2);
+      EXPECT_NEAR(m(j), new_m, 1e-6);
+      EXPECT_NEAR(v(j), new_v, 1e-6);
+      EXPECT_NEAR(var(j),
+                  init[i][j] - new_m * alpha / (std::sqrt(new_v) + epsilon),
+                  1e-6);
+    }
+  }
+}
+
+TEST_F(MultiApplyOpTest, MomentumAcrossChunks) {
+  TF_ASSERT_OK(NodeDefBuilder("momentum", "ResourceMultiApplyMomentum")
+                   .Input(FakeInput(2, DT_RESOURCE))
+                   .Input(FakeInput(2, DT_RESOURCE))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(2, DT_FLOAT))
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  // The first variable spans several chunks.
+  const int large = 40000;
+  std::vector<float> large_init(large);
+  std::vector<float> large_grad(large);
+  for (int i = 0; i < large; ++i) {
+    large_init[i] = i;
+    large_grad[i] = i % 7;
+  }
+  std::vector<ResourceVar*> vars = AddVariables("var", {large_init, {1}});
+  std::vector<ResourceVar*> accums = AddVariables("accum", {large_init, {2}});
+  AddScalar(0.5);  // lr
+  AddScalar(0.9);  // momentum
+  AddGradients({large_grad, {3}});
+  TF_ASSERT_OK(RunOpKernel());
+
+  auto var = vars[0]->tensor()->flat<float>();
+  auto accum = accums[0]->tensor()->flat<float>();
+  for (int i = 0; i < large; ++i) {
+    const float new_accum = i * 0.9f + i % 7;
+    ASSERT_NEAR(accum(i), new_accum, 1e-2) << i;
+    ASSERT_NEAR(var(i), i - 0.5f * new_accum, 1e-2) << i;
+  }
+  EXPECT_NEAR(accums[1]->tensor()->flat<float>()(0), 4.8, 1e-6);
+  EXPECT_NEAR(vars[1]->tensor()->flat<float>()(0), 1 - 2.4, 1e-6);
+}
+
+TEST_F(MultiApplyOpTest, LambScalesByTrustRatio) {
+  TF_ASSERT_OK(NodeDefBuilder("lamb", "ResourceMultiApplyLamb")
+                   .Input(FakeInput(1, DT_RESOURCE))
+                   .Input(FakeInput(1, DT_RESOURCE))
+                   .Input(FakeInput(1, DT_RESOURCE))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(1, DT_FLOAT))
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  std::vector<ResourceVar*> vars = AddVariables("var", {{3, 4}});
+  AddVariables("m", {{0, 0}});
+  AddVariables("v", {{0, 0}});
+  // beta1 = beta2 = 0 makes the update sign(grad), whose norm is sqrt(2).
+  for (float value : {0.0f, 0.0f, 0.1f, 0.0f, 0.0f, 0.0f, 0.0f}) {
+    AddScalar(value);
+  }
+  AddGradients({{2, -8}});
+  TF_ASSERT_OK(RunOpKernel());
+
+  // The trust ratio is |var| / |update| = 5 / sqrt(2).
+  const float step = 0.1f * 5 / std::sqrt(2.0f);
+  auto var = vars[0]->tensor()->flat<float>();
+  EXPECT_NEAR(var(0), 3 - step, 1e-5);
+  EXPECT_NEAR(var(1), 4 + step, 1e-5);
+}
+
+TEST_F(MultiApplyOpTest, RejectsDuplicateVariables) {
+  TF_ASSERT_OK(NodeDefBuilder("adagrad", "ResourceMultiApplyAdagrad")
+                   .Input(FakeInput(2, DT_RESOURCE))
+                   .Input(FakeInput(2, DT_RESOURCE))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(2, DT_FLOAT))
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  AddVariables("var", {{1}});
+  // Passes var0 a second time.
+  AddResourceInputInternal(device_->resource_manager()->default_container(),
+                           "var0", TypeIndex::Make<ResourceVar>());
+  AddVariables("accum", {{1}, {1}});
+  AddScalar(0.1);
+  AddScalar(1e-7);
+  AddGradients({{1}, {1}});
+  EXPECT_TRUE(errors::IsInvalidArgument(RunOpKernel()));
+}
+
 }  // end namespace tensorflow
@@ -16,12 +16,14 @@ limitations under the License.
 #define EIGEN_USE_THREADS
 
 #include <complex>
+#include <type_traits>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/ops_util.h"
 #include "tensorflow/core/kernels/transpose_functor.h"
+#include "tensorflow/core/kernels/transpose_plan.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/array_slice.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
@@ -68,12 +70,29 @@ void TransposeSimple(const CPUDevice& device, const Tensor& in,
   device.parallelFor(in.NumElements(), cost, std::move(transpose_fn));
 }
 
+// Transposes with a tiled plan from the global cache, which handles any rank
+// and is much faster than an Eigen shuffle when the innermost dimension moves.
+void TransposeUsingPlan(const CPUDevice& device, const Tensor& in,
+                        const gtl::ArraySlice<int32> perm, int64_t elem_size,
+                        Tensor* out) {
+  std::shared_ptr<const internal::TransposePlan> plan =
+      internal::TransposePlanCache::Global()->GetOrCreate(
+          elem_size, in.shape().dim_sizes(), perm);
+  plan->Execute(device, in.tensor_data().data(),
+                const_cast<char*>(out->tensor_data().data()));
+}
+
 }  // namespace
 
 template <typename T, bool conjugate>
 struct Transpose<CPUDevice, T, conjugate> {
   static void run(const CPUDevice& d, const Tensor& in,
                   const gtl::ArraySlice<int32> perm, Tensor* out) {
+    // Elements that need conjugating or a non-trivial copy go through Eigen.
+    if (!conjugate && std::is_trivially_copyable<T>::value) {
+      TransposeUsingPlan(d, in, perm, sizeof(T), out);
+      return;
+    }
     switch (in.dims()) {
       case 2:
         internal::TransposeUsingEigen<CPUDevice, T, 2>(d, in, perm, conjugate,
@@ -0,0 +1,292 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#define EIGEN_USE_THREADS
+
+#include "tensorflow/core/kernels/transpose_plan.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace internal {
+namespace {
+
+// Rows of up to this many bytes are moved as single elements.
+constexpr int64_t kMaxFoldedElemSize = 16;
+
+// Tiles are about this many bytes on a side, so that a tile of the input and
+// a tile of the output fit in L1 together.
+constexpr int64_t kTileBytes = 256;
+
+// Walks a set of dimensions in row-major order, keeping track of the input and
+// output offsets of the current index.
+class Odometer {
+ public:
+  Odometer(const gtl::InlinedVector<int64_t, 8>& dims,
+           const gtl::InlinedVector<int64_t, 8>& in_strides,
+           const gtl::InlinedVector<int64_t, 8>& out_strides, int64_t start)
+      : dims_(dims),
+        in_strides_(in_strides),
+        out_strides_(out_strides),
+        index_(dims.size()) {
+    for (int i = dims.size() - 1; i >= 0; --i) {
+      index_[i] = start % dims[i];
+      start /= dims[i];
+      in_offset_ += index_[i] * in_strides[i];
+      out_offset_ += index_[i] * out_strides[i];
+    }
+  }
+
+  void Next() {
+    for (int i = dims_.size() - 1; i >= 0; --i) {
+      in_offset_ += in_strides_[i];
+      out_offset_ += out_strides_[i];
+      if (++index_[i] < dims_[i]) return;
+      in_offset_ -= in_strides_[i] * dims_[i];
+      out_offset_ -= out_strides_[i] * dims_[i];
+      index_[i] = 0;
+    }
+  }
+
+  int64_t in_offset() const { return in_offset_; }
+  int64_t out_offset() const { return out_offset_; }
+
+ private:
+  const gtl::InlinedVector<int64_t, 8>& dims_;
+  const gtl::InlinedVector<int64_t, 8>& in_strides_;
+  const gtl::InlinedVector<int64_t, 8>& out_strides_;
+  gtl::InlinedVector<int64_t, 8> index_;
+  int64_t in_offset_ = 0;
+  int64_t out_offset_ = 0;
+};
+
+// Transposes a `rows` x `cols` tile, where rows are contiguous in the output
+// and columns are contiguous in the input.  Strides are in elements.  The
+// fixed-size memcpy compiles to a single load and store, and tolerates
+// buffers that are not aligned to the element size.
+template <int kElemSize>
+void TransposeTile(const char* in, int64_t in_row_stride, char* out,
+                   int64_t out_col_stride, int64_t rows, int64_t cols,
+                   int64_t elem_size) {
+  const int64_t size = kElemSize > 0 ? kElemSize : elem_size;
+  for (int64_t c = 0; c < cols; ++c) {
+    const char* src = in + c * size;
+    char* dst = out + c * out_col_stride * size;
+    for (int64_t r = 0; r < rows; ++r) {
+      std::memcpy(dst + r * size, src + r * in_row_stride * size, size);
+    }
+  }
+}
+
+}  // namespace
+
+TransposePlan::TransposePlan(int64_t elem_size, gtl::ArraySlice<int64_t> dims,
+                             gtl::ArraySlice<int32> perm)
+    : elem_size_(elem_size) {
+  CHECK_EQ(dims.size(), perm.size());
+  const int ndims = dims.size();
+  gtl::InlinedVector<int64_t, 8> strides(ndims);
+  int64_t num_elements = 1;
+  for (int i = ndims - 1; i >= 0; --i) {
+    strides[i] = num_elements;
+    num_elements *= dims[i];
+  }
+  num_elements_ = num_elements;
+  if (num_elements_ == 0) return;
+
+  // Walk the output dimensions, dropping singletons and merging a dimension
+  // into the previous one when the two are also adjacent in the input.
+  for (int i = 0; i < ndims; ++i) {
+    const int64_t size = dims[perm[i]];
+    if (size == 1) continue;
+    const int64_t in_stride = strides[perm[i]];
+    if (!dims_.empty() && in_strides_.back() == in_stride * size) {
+      dims_.back() *= size;
+      in_strides_.back() = in_stride;
+    } else {
+      dims_.push_back(size);
+      in_strides_.push_back(in_stride);
+    }
+  }
+
+  // If the innermost dimension is unchanged and its rows are short, move each
+  // row as one element; every other input stride is a multiple of the row.
+  int rank = dims_.size();
+  if (rank >= 2 && in_strides_[rank - 1] == 1) {
+    const int64_t row = dims_[rank - 1];
+    const int64_t row_bytes = row * elem_size_;
+    if (row_bytes <= kMaxFoldedElemSize && (row_bytes & (row_bytes - 1)) == 0) {
+      elem_size_ = row_bytes;
+      num_elements_ /= row;
+      dims_.pop_back();
+      in_strides_.pop_back();
+      for (int64_t& stride : in_strides_) stride /= row;
+      --rank;
+    }
+  }
+
+  out_strides_.resize(rank);
+  int64_t out_stride = 1;
+  for (int i = rank - 1; i >= 0; --i) {
+    out_strides_[i] = out_stride;
+    out_stride *= dims_[i];
+  }
+
+  if (rank >= 2 && in_strides_[rank - 1] != 1) {
+    for (int i = 0; i < rank; ++i) {
+      if (in_strides_[i] == 1) tiled_dim_ = i;
+    }
+    DCHECK_GE(tiled_dim_, 0);
+    tile_size_ =
+        std::min<int64_t>(64, std::max<int64_t>(8, kTileBytes / elem_size_));
+  }
+  for (int i = 0; i < rank - 1; ++i) {
+    if (i == tiled_dim_) continue;
+    outer_dims_.push_back(dims_[i]);
+    outer_in_strides_.push_back(in_strides_[i]);
+    outer_out_strides_.push_back(out_strides_[i]);
+  }
+}
+
+void TransposePlan::Execute(const Eigen::ThreadPoolDevice& device,
+                            const void* in, void* out) const {
+  if (num_elements_ == 0) return;
+  const char* src = static_cast<const char*>(in);
+  char* dst = static_cast<char*>(out);
+  if (!is_tiled()) {
+    ExecuteRows(device, src, dst);
+    return;
+  }
+  switch (elem_size_) {
+    case 1:
+      ExecuteTiled<1>(device, src, dst);
+      break;
+    case 2:
+      ExecuteTiled<2>(device, src, dst);
+      break;
+    case 4:
+      ExecuteTiled<4>(device, src, dst);
+      break;
+    case 8:
+      ExecuteTiled<8>(device, src, dst);
+      break;
+    case 16:
+      ExecuteTiled<16>(device, src, dst);
+      break;
+    default:
+      ExecuteTiled<0>(device, src, dst);
+      break;
+  }
+}
+
+void TransposePlan::ExecuteRows(const Eigen::ThreadPoolDevice& device,
+                                const char* in, char* out) const {
+  // A rank 0 plan is a single element.
+  const int64_t row = dims_.empty() ? 1 : dims_.back();
+  const int64_t row_bytes = row * elem_size_;
+  const int64_t num_rows = num_elements_ / row;
+  auto copy_rows = [&](int64_t begin, int64_t end) {
+    Odometer index(outer_dims_, outer_in_strides_, outer_out_strides_, begin);
+    for (int64_t i = begin; i < end; ++i) {
+      std::memcpy(out + i * row_bytes, in + index.in_offset() * elem_size_,
+                  row_bytes);
+      index.Next();
+    }
+  };
+  device.parallelFor(num_rows,
+                     Eigen::TensorOpCost(/*bytes_loaded=*/row_bytes,
+                                         /*bytes_stored=*/row_bytes,
+                                         /*compute_cycles=*/0),
+                     std::move(copy_rows));
+}
+
+template <int kElemSize>
+void TransposePlan::ExecuteTiled(const Eigen::ThreadPoolDevice& device,
+                                 const char* in, char* out) const {
+  // Rows of a tile run along the innermost output dimension, and columns
+  // along the innermost input dimension.
+  const int rank = dims_.size();
+  const int64_t rows = dims_[rank - 1];
+  const int64_t cols = dims_[tiled_dim_];
+  const int64_t in_row_stride = in_strides_[rank - 1];
+  const int64_t out_col_stride = out_strides_[tiled_dim_];
+  const int64_t row_tiles = (rows + tile_size_ - 1) / tile_size_;
+  const int64_t col_tiles = (cols + tile_size_ - 1) / tile_size_;
+  const int64_t tiles_per_outer = row_tiles * col_tiles;
+  const int64_t num_tiles = num_elements_ / (rows * cols) * tiles_per_outer;
+  const int64_t elem_size = elem_size_;
+  const int64_t tile_size = tile_size_;
+
+  // Consecutive tiles of a shard are adjacent in the output, so each shard
+  // writes one contiguous span.
+  auto transpose_tiles = [&](int64_t begin, int64_t end) {
+    Odometer index(outer_dims_, outer_in_strides_, outer_out_strides_,
+                   begin / tiles_per_outer);
+    int64_t tile = begin % tiles_per_outer;
+    for (int64_t i = begin; i < end; ++i) {
+      const int64_t r = (tile % row_tiles) * tile_size;
+      const int64_t c = (tile / row_tiles) * tile_size;
+      const int64_t in_offset = index.in_offset() + r * in_row_stride + c;
+      const int64_t out_offset = index.out_offset() + c * out_col_stride + r;
+      TransposeTile<kElemSize>(in + in_offset * elem_size, in_row_stride,
+                               out + out_offset * elem_size, out_col_stride,
+                               std::min(tile_size, rows - r),
+                               std::min(tile_size, cols - c), elem_size);
+      if (++tile == tiles_per_outer) {
+        tile = 0;
+        index.Next();
+      }
+    }
+  };
+  const int64_t tile_bytes = tile_size * tile_size * elem_size;
+  device.parallelFor(num_tiles,
+                     Eigen::TensorOpCost(/*bytes_loaded=*/tile_bytes,
+                                         /*bytes_stored=*/tile_bytes,
+                                         /*compute_cycles=*/tile_size *
+                                             tile_size),
+                     std::move(transpose_tiles));
+}
+
+std::shared_ptr<const TransposePlan> TransposePlanCache::GetOrCreate(
+    int64_t elem_size, gtl::ArraySlice<int64_t> dims,
+    gtl::ArraySlice<int32> perm) {
+  mutex_lock l(mu_);
+  for (auto it = lru_.begin(); it != lru_.end(); ++it) {
+    const Key& key = it->first;
+    if (key.elem_size == elem_size &&
+        gtl::ArraySlice<int64_t>(key.dims) == dims &&
+        gtl::ArraySlice<int32>(key.perm) == perm) {
+      lru_.splice(lru_.begin(), lru_, it);
+      return lru_.front().second;
+    }
+  }
+  auto plan = std::make_shared<const TransposePlan>(elem_size, dims, perm);
+  Key key{elem_size, {dims.begin(), dims.end()}, {perm.begin(), perm.end()}};
+  lru_.emplace_front(std::move(key), plan);
+  if (static_cast<int>(lru_.size()) > capacity_) lru_.pop_back();
+  return plan;
+}
+
+TransposePlanCache* TransposePlanCache::Global() {
+  static TransposePlanCache* cache = new TransposePlanCache(/*capacity=*/64);
+  return cache;
+}
+
+}  // namespace internal
+}  // namespace tensorflow
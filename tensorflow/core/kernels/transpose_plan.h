@@ -0,0 +1,131 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_TRANSPOSE_PLAN_H_
+#define TENSORFLOW_CORE_KERNELS_TRANSPOSE_PLAN_H_
+
+#include <list>
+#include <memory>
+#include <utility>
+
+#include "tensorflow/core/lib/gtl/array_slice.h"
+#include "tensorflow/core/lib/gtl/inlined_vector.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace Eigen {
+struct ThreadPoolDevice;
+}  // end namespace Eigen
+
+namespace tensorflow {
+namespace internal {
+
+// A precomputed strategy for permuting the dimensions of a dense row-major
+// array of trivially copyable elements.
+//
+// Building a plan drops singleton dimensions and merges dimensions that stay
+// adjacent, so e.g. an NHWC -> NCHW transpose becomes a batch of [HW, C] ->
+// [C, HW] matrix transposes.  If the innermost input dimension stays innermost,
+// each output row is a contiguous copy; short rows are instead treated as
+// single wider elements so that they are tiled like any other transpose.
+// Otherwise the two dimensions that are innermost in the input and in the
+// output are cut into square tiles that fit in L1, which keeps both the reads
+// and the writes of a tile within a few cache lines.  The rows or tiles are
+// sharded over the device's thread pool.
+class TransposePlan {
+ public:
+  // Output dimension `i` is input dimension `perm[i]`.
+  //
+  // REQUIRES: perm is a permutation of [0, dims.size()).
+  TransposePlan(int64_t elem_size, gtl::ArraySlice<int64_t> dims,
+                gtl::ArraySlice<int32> perm);
+
+  // Writes the transpose of `in` to `out`, which must not alias.
+  void Execute(const Eigen::ThreadPoolDevice& device, const void* in,
+               void* out) const;
+
+  // Size in bytes of the elements moved by Execute.  May be larger than the
+  // element size passed to the constructor if rows are moved as a whole.
+  int64_t elem_size() const { return elem_size_; }
+
+  // Rank of the transpose after simplification.
+  int rank() const { return dims_.size(); }
+
+  // Whether Execute moves 2-D tiles rather than contiguous rows.
+  bool is_tiled() const { return tiled_dim_ >= 0; }
+
+ private:
+  // kElemSize is 0 if the element size is only known at run time.
+  template <int kElemSize>
+  void ExecuteTiled(const Eigen::ThreadPoolDevice& device, const char* in,
+                    char* out) const;
+  void ExecuteRows(const Eigen::ThreadPoolDevice& device, const char* in,
+                   char* out) const;
+
+  int64_t elem_size_;
+  int64_t num_elements_ = 0;
+
+  // Simplified dimensions in output order, with the input and output stride
+  // of each, in elements.
+  gtl::InlinedVector<int64_t, 8> dims_;
+  gtl::InlinedVector<int64_t, 8> in_strides_;
+  gtl::InlinedVector<int64_t, 8> out_strides_;
+
+  // For a tiled plan, the output dimension that is innermost in the input;
+  // the innermost output dimension is the other tiled dimension.  -1 if the
+  // plan copies rows.
+  int tiled_dim_ = -1;
+  int64_t tile_size_ = 0;
+
+  // The dimensions that are neither tiled nor copied as a row, which Execute
+  // walks in output order.
+  gtl::InlinedVector<int64_t, 8> outer_dims_;
+  gtl::InlinedVector<int64_t, 8> outer_in_strides_;
+  gtl::InlinedVector<int64_t, 8> outer_out_strides_;
+};
+
+// A small thread-safe LRU cache of plans, keyed by element size, shape and
+// permutation, so that the same transpose in every step of a model skips
+// planning.
+class TransposePlanCache {
+ public:
+  explicit TransposePlanCache(int capacity) : capacity_(capacity) {}
+
+  std::shared_ptr<const TransposePlan> GetOrCreate(
+      int64_t elem_size, gtl::ArraySlice<int64_t> dims,
+      gtl::ArraySlice<int32> perm);
+
+  // Returns the process-wide cache used by the CPU transpose functor.
+  static TransposePlanCache* Global();
+
+ private:
+  struct Key {
+    int64_t elem_size;
+    gtl::InlinedVector<int64_t, 8> dims;
+    gtl::InlinedVector<int32, 8> perm;
+  };
+
+  const int capacity_;
+  mutex mu_;
+  // Most recently used first.
+  std::list<std::pair<Key, std::shared_ptr<const TransposePlan>>> lru_
+      TF_GUARDED_BY(mu_);
+};
+
+}  // namespace internal
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_TRANSPOSE_PLAN_H_
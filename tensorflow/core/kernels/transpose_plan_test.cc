@@ -0,0 +1,147 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#define EIGEN_USE_THREADS
+
+#include "tensorflow/core/kernels/transpose_plan.h"
+
+#include <cstring>
+#include <vector>
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace internal {
+namespace {
+
+class TransposePlanTest : public ::testing::Test {
+ protected:
+  TransposePlanTest() : pool_(4), device_(&pool_, 4) {}
+
+  // Checks the plan against an element-by-element transpose, with element
+  // bytes numbered so that every byte of the output is distinguishable.
+  void CheckTranspose(int64_t elem_size, const std::vector<int64_t>& dims,
+                      const std::vector<int32>& perm) {
+    const int ndims = dims.size();
+    std::vector<int64_t> in_strides(ndims);
+    int64_t num_elements = 1;
+    for (int i = ndims - 1; i >= 0; --i) {
+      in_strides[i] = num_elements;
+      num_elements *= dims[i];
+    }
+    std::vector<int64_t> out_dims(ndims);
+    for (int i = 0; i < ndims; ++i) out_dims[i] = dims[perm[i]];
+
+    std::vector<uint8> in(num_elements * elem_size);
+    for (size_t i = 0; i < in.size(); ++i) in[i] = i * 7 + i / 251;
+    std::vector<uint8> expected(in.size());
+    std::vector<int64_t> index(ndims, 0);
+    for (int64_t o = 0; o < num_elements; ++o) {
+      int64_t i = 0;
+      for (int d = 0; d < ndims; ++d) i += index[d] * in_strides[perm[d]];
+      std::memcpy(&expected[o * elem_size], &in[i * elem_size], elem_size);
+      for (int d = ndims - 1; d >= 0 && ++index[d] == out_dims[d]; --d) {
+        index[d] = 0;
+      }
+    }
+
+    TransposePlan plan(elem_size, dims, perm);
+    std::vector<uint8> out(in.size());
+    plan.Execute(device_, in.data(), out.data());
+    EXPECT_EQ(expected, out) << "elem_size=" << elem_size
+                             << " rank=" << plan.rank();
+  }
+
+ private:
+  Eigen::ThreadPool pool_;
+  Eigen::ThreadPoolDevice device_;
+};
+
+TEST_F(TransposePlanTest, MatrixTranspose) {
+  for (int64_t elem_size : {1, 2, 4, 8, 16, 3}) {
+    CheckTranspose(elem_size, {1, 1}, {1, 0});
+    CheckTranspose(elem_size, {5, 7}, {1, 0});
+    CheckTranspose(elem_size, {64, 64}, {1, 0});
+    CheckTranspose(elem_size, {130, 67}, {1, 0});
+  }
+}
+
+TEST_F(TransposePlanTest, LayoutConversions) {
+  for (int64_t elem_size : {1, 2, 4, 8}) {
+    // NHWC -> NCHW and back.
+    CheckTranspose(elem_size, {2, 9, 11, 3}, {0, 3, 1, 2});
+    CheckTranspose(elem_size, {2, 3, 9, 11}, {0, 2, 3, 1});
+    CheckTranspose(elem_size, {3, 20, 20, 70}, {0, 3, 1, 2});
+    // NDHWC -> NCDHW.
+    CheckTranspose(elem_size, {2, 4, 5, 6, 7}, {0, 4, 1, 2, 3});
+  }
+}
+
+TEST_F(TransposePlanTest, InnermostDimensionKept) {
+  for (int64_t elem_size : {1, 4, 8}) {
+    // Short rows are moved as single wide elements.
+    CheckTranspose(elem_size, {3, 5, 2}, {1, 0, 2});
+    CheckTranspose(elem_size, {6, 4, 5, 2}, {2, 1, 0, 3});
+    // Rows that are too long or not a power of two bytes are copied.
+    CheckTranspose(elem_size, {3, 5, 3}, {1, 0, 2});
+    CheckTranspose(elem_size, {4, 6, 40}, {1, 0, 2});
+  }
+}
+
+TEST_F(TransposePlanTest, HighRank) {
+  CheckTranspose(4, {2, 3, 2, 3, 2, 3, 2, 3, 2}, {8, 0, 7, 1, 6, 2, 5, 3, 4});
+  CheckTranspose(2, {3, 1, 4, 1, 5, 1, 2, 6, 1, 2},
+                 {9, 7, 5, 3, 1, 0, 2, 4, 6, 8});
+}
+
+TEST_F(TransposePlanTest, EmptyAndScalar) {
+  CheckTranspose(4, {}, {});
+  CheckTranspose(4, {1, 1, 1}, {2, 0, 1});
+  CheckTranspose(4, {3, 0, 5}, {2, 0, 1});
+}
+
+TEST_F(TransposePlanTest, Simplification) {
+  // [HW, C] -> [C, HW] after merging H and W.
+  TransposePlan nchw(4, {8, 16, 16, 32}, {0, 3, 1, 2});
+  EXPECT_EQ(3, nchw.rank());
+  EXPECT_TRUE(nchw.is_tiled());
+  EXPECT_EQ(4, nchw.elem_size());
+
+  // Singleton dimensions are dropped, leaving a plain copy.
+  TransposePlan copy(4, {1, 16, 1, 32}, {2, 1, 0, 3});
+  EXPECT_EQ(1, copy.rank());
+  EXPECT_FALSE(copy.is_tiled());
+
+  // Rows of two floats are moved as 8-byte elements.
+  TransposePlan folded(4, {10, 20, 2}, {1, 0, 2});
+  EXPECT_EQ(2, folded.rank());
+  EXPECT_TRUE(folded.is_tiled());
+  EXPECT_EQ(8, folded.elem_size());
+}
+
+TEST(TransposePlanCacheTest, ReusesPlans) {
+  TransposePlanCache cache(/*capacity=*/2);
+  auto a = cache.GetOrCreate(4, {2, 3}, {1, 0});
+  EXPECT_EQ(a, cache.GetOrCreate(4, {2, 3}, {1, 0}));
+  EXPECT_NE(a, cache.GetOrCreate(8, {2, 3}, {1, 0}));
+  EXPECT_NE(a, cache.GetOrCreate(4, {3, 2}, {1, 0}));
+  // The first plan was evicted by the two plans after it.
+  EXPECT_NE(a, cache.GetOrCreate(4, {2, 3}, {1, 0}));
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace tensorflow
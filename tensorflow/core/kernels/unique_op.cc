@@ -13,9 +13,11 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
 #include <functional>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/framework/bounds_check.h"
@@ -26,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/bfloat16.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace {
@@ -143,7 +146,13 @@ class UniqueOp : public OpKernel {
     auto idx_vec = idx->template vec<TIndex>();
 
     int64_t uniq_size;
-    if (new_sizes[0] == 1 && new_sizes[2] == 1) {
+    const int num_threads =
+        context->device()->tensorflow_cpu_worker_threads()->num_threads;
+    if (new_sizes[0] == 1 && new_sizes[2] == 1 &&
+        input.NumElements() >= kParallelMinElements && num_threads > 1) {
+      ComputeParallel(context, input, axis, idx_vec, &uniq_size);
+      if (!context->status().ok()) return;
+    } else if (new_sizes[0] == 1 && new_sizes[2] == 1) {
       // Specialized and faster implementation when unique is run over single
       // elements. Here we put T directly into the map rather than ints pointing
       // to them as in the general case.
@@ -237,6 +246,146 @@ class UniqueOp : public OpKernel {
       }
     }
   }
+
+ private:
+  // Inputs of at least this many single elements are uniquified in parallel.
+  static constexpr int64_t kParallelMinElements = 64 * 1024;
+  // Estimated cost of hashing an element, in cycles.
+  static constexpr int64_t kHashCost = 50;
+
+  // Parallel implementation of unique over single elements, on the intra-op
+  // pool.  The positions of the input are partitioned by the hash of their
+  // element into buckets, which are deduplicated independently, recording the
+  // position of the first occurrence of every element.  The first occurrences
+  // are then numbered in order with a prefix sum, so that the outputs are the
+  // same as those of the serial implementation.
+  void ComputeParallel(OpKernelContext* context, const Tensor& input,
+                       int64_t axis, typename TTypes<TIndex>::Vec idx_vec,
+                       int64_t* uniq_size) {
+    // Positions fit in an int32 since the input size is checked above.
+    using Map = typename UniqueOpHashMap<T, int32>::map_type;
+    auto Tin = input.flat<T>();
+    const int64_t N = static_cast<int64_t>(Tin.size());
+
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    auto run = [&worker_threads](int64_t total, int64_t cost_per_unit,
+                                 std::function<void(int64_t, int64_t)> work) {
+      Shard(worker_threads.num_threads, worker_threads.workers, total,
+            cost_per_unit, std::move(work));
+    };
+
+    // There are as many contiguous blocks of input as buckets, and at least as
+    // many buckets as threads.
+    int bucket_bits = 1;
+    while ((1 << bucket_bits) < worker_threads.num_threads && bucket_bits < 8) {
+      ++bucket_bits;
+    }
+    const int num_buckets = 1 << bucket_bits;
+    const int64_t num_blocks = num_buckets;
+    const int64_t block_size = (N + num_blocks - 1) / num_blocks;
+    auto block_limit = [&](int64_t block) {
+      return std::min(N, (block + 1) * block_size);
+    };
+
+    // Count the elements of every block that fall in every bucket.
+    const typename Map::hasher hasher;
+    std::vector<uint8> bucket_of(N);
+    std::vector<int64_t> block_counts(num_blocks * num_buckets, 0);
+    run(num_blocks, block_size * kHashCost, [&](int64_t begin, int64_t end) {
+      for (int64_t k = begin; k < end; ++k) {
+        int64_t* counts = &block_counts[k * num_buckets];
+        for (int64_t i = k * block_size; i < block_limit(k); ++i) {
+          // Fibonacci hashing takes the bucket from the high bits, which the
+          // hash maps of the buckets do not depend on alone.
+          const uint64 h =
+              static_cast<uint64>(hasher(typename Map::key_type(Tin(i)))) *
+              0x9E3779B97F4A7C15ull;
+          bucket_of[i] = static_cast<uint8>(h >> (64 - bucket_bits));
+          ++counts[bucket_of[i]];
+        }
+      }
+    });
+
+    // Scatter the positions into their buckets, in increasing order within
+    // every bucket.
+    std::vector<int64_t> starts(num_buckets * num_blocks + 1);
+    int64_t total = 0;
+    for (int b = 0; b < num_buckets; ++b) {
+      for (int64_t k = 0; k < num_blocks; ++k) {
+        starts[b * num_blocks + k] = total;
+        total += block_counts[k * num_buckets + b];
+      }
+    }
+    starts.back() = total;
+    std::vector<int32> positions(N);
+    run(num_blocks, block_size, [&](int64_t begin, int64_t end) {
+      std::vector<int64_t> next(num_buckets);
+      for (int64_t k = begin; k < end; ++k) {
+        for (int b = 0; b < num_buckets; ++b) {
+          next[b] = starts[b * num_blocks + k];
+        }
+        for (int64_t i = k * block_size; i < block_limit(k); ++i) {
+          positions[next[bucket_of[i]]++] = static_cast<int32>(i);
+        }
+      }
+    });
+
+    // Deduplicate every bucket, setting idx_vec(i) to the position of the
+    // first occurrence of Tin(i).
+    run(num_buckets, N / num_buckets * kHashCost,
+        [&](int64_t begin, int64_t end) {
+          for (int64_t b = begin; b < end; ++b) {
+            const int64_t bucket_start = starts[b * num_blocks];
+            const int64_t bucket_end = starts[(b + 1) * num_blocks];
+            Map uniq;
+            uniq.reserve(2 * (bucket_end - bucket_start));
+            for (int64_t p = bucket_start; p < bucket_end; ++p) {
+              const int32 i = positions[p];
+              idx_vec(i) = uniq.emplace(Tin(i), i).first->second;
+            }
+          }
+        });
+
+    // Number the first occurrences in order of their positions.
+    std::vector<int64_t> block_uniques(num_blocks + 1, 0);
+    run(num_blocks, block_size, [&](int64_t begin, int64_t end) {
+      for (int64_t k = begin; k < end; ++k) {
+        for (int64_t i = k * block_size; i < block_limit(k); ++i) {
+          if (idx_vec(i) == i) ++block_uniques[k + 1];
+        }
+      }
+    });
+    for (int64_t k = 0; k < num_blocks; ++k) {
+      block_uniques[k + 1] += block_uniques[k];
+    }
+    *uniq_size = block_uniques[num_blocks];
+
+    TensorShape output_shape(input.shape());
+    output_shape.set_dim(axis, *uniq_size);
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(0, output_shape, &output));
+    auto Tout = output->flat<T>();
+
+    // The positions are no longer needed, so `positions` now maps the
+    // position of every first occurrence to its index in the output.
+    run(num_blocks, block_size, [&](int64_t begin, int64_t end) {
+      for (int64_t k = begin; k < end; ++k) {
+        int64_t next = block_uniques[k];
+        for (int64_t i = k * block_size; i < block_limit(k); ++i) {
+          if (idx_vec(i) == i) {
+            positions[i] = static_cast<int32>(next);
+            Tout(next++) = Tin(i);
+          }
+        }
+      }
+    });
+    run(num_blocks, block_size, [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin * block_size; i < block_limit(end - 1); ++i) {
+        idx_vec(i) = positions[idx_vec(i)];
+      }
+    });
+  }
 };
 
 #define REGISTER_UNIQUE(type)                                      \
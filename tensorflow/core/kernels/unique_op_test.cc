@@ -15,11 +15,16 @@ limitations under the License.
 
 #include <functional>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/graph/algorithm.h"
@@ -64,6 +69,50 @@ TensorProto GetRandomInt32TensorProtoWithRepeat(int dim, int repeat,
   return tensor_proto;
 }
 
+class UniqueOpTest : public OpsTestBase {};
+
+// Large enough for the parallel implementation, which must produce the
+// unique elements in order of first occurrence like the serial one.
+TEST_F(UniqueOpTest, LargeInputWithCounts) {
+  TF_ASSERT_OK(NodeDefBuilder("unique", "UniqueWithCounts")
+                   .Input(FakeInput(DT_INT64))
+                   .Attr("out_idx", DT_INT32)
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+
+  const int kNumElements = 256 * 1024;
+  std::vector<int64_t> input(kNumElements);
+  for (int i = 0; i < kNumElements; ++i) {
+    input[i] = (static_cast<int64_t>(i) * 7919) % 10007 - 5000;
+  }
+  AddInputFromArray<int64_t>(TensorShape({kNumElements}), input);
+  TF_ASSERT_OK(RunOpKernel());
+
+  std::unordered_map<int64_t, int32> first_index;
+  std::vector<int64_t> expected_y;
+  std::vector<int32> expected_idx;
+  std::vector<int32> expected_count;
+  for (int64_t x : input) {
+    auto it = first_index.emplace(x, expected_y.size());
+    if (it.second) {
+      expected_y.push_back(x);
+      expected_count.push_back(0);
+    }
+    expected_idx.push_back(it.first->second);
+    ++expected_count[it.first->second];
+  }
+  const int64_t num_unique = expected_y.size();
+  test::ExpectTensorEqual<int64_t>(
+      *GetOutput(0),
+      test::AsTensor<int64_t>(expected_y, TensorShape({num_unique})));
+  test::ExpectTensorEqual<int32>(
+      *GetOutput(1),
+      test::AsTensor<int32>(expected_idx, TensorShape({kNumElements})));
+  test::ExpectTensorEqual<int32>(
+      *GetOutput(2),
+      test::AsTensor<int32>(expected_count, TensorShape({num_unique})));
+}
+
 void BM_Unique_INT32(::testing::benchmark::State& state) {
   const int dim = state.range(0);
   const int max_int = state.range(1);
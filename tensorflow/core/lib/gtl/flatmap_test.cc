@@ -16,11 +16,15 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/flatmap.h"
 
 #include <algorithm>
+#include <random>
 #include <string>
 #include <unordered_map>
 #include <vector>
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/platform/strcat.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/platform/types.h"
 
 namespace tensorflow {
@@ -702,6 +706,88 @@ TEST(FlatMap, UniqueMapIter) {
   EXPECT_EQ(val_sum, key_sum + (kCount * kValueDelta));
 }
 
+// Benchmarks of FlatMap and absl::flat_hash_map with their default hash
+// functions, for integer keys and for keys that look like node names.
+int64_t IntKey(int i) {
+  return static_cast<int64_t>(i * uint64_t{0x9E3779B97F4A7C15});
+}
+string StringKey(int i) { return strings::StrCat("model/layer_", i, "/w"); }
+
+template <typename Map, typename KeyFn>
+void BM_Find(::testing::benchmark::State& state, KeyFn key_fn) {
+  const int size = state.range(0);
+  const bool hit = state.range(1);
+  Map map;
+  std::vector<typename Map::key_type> keys;
+  for (int i = 0; i < size; i++) {
+    map.emplace(key_fn(i), i);
+    keys.push_back(key_fn(hit ? i : size + i));
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(0));
+  int i = 0;
+  int64_t found = 0;
+  for (auto s : state) {
+    found += map.find(keys[i]) != map.end();
+    if (++i == size) i = 0;
+  }
+  CHECK_EQ(found, hit ? state.iterations() : 0);
+}
+
+template <typename Map, typename KeyFn>
+void BM_InsertErase(::testing::benchmark::State& state, KeyFn key_fn) {
+  const int size = state.range(0);
+  std::vector<typename Map::key_type> keys;
+  for (int i = 0; i < 2 * size; i++) keys.push_back(key_fn(i));
+  Map map;
+  for (int i = 0; i < size; i++) map.emplace(keys[i], i);
+  // Each iteration replaces the oldest key with a new one, so the map keeps
+  // its size.
+  int i = 0;
+  for (auto s : state) {
+    map.erase(keys[i]);
+    map.emplace(keys[(i + size) % keys.size()], i);
+    if (++i == keys.size()) i = 0;
+  }
+}
+
+void BM_FlatMapFindInt(::testing::benchmark::State& state) {
+  BM_Find<FlatMap<int64_t, int>>(state, IntKey);
+}
+void BM_AbslFindInt(::testing::benchmark::State& state) {
+  BM_Find<absl::flat_hash_map<int64_t, int>>(state, IntKey);
+}
+void BM_FlatMapFindString(::testing::benchmark::State& state) {
+  BM_Find<FlatMap<string, int>>(state, StringKey);
+}
+void BM_AbslFindString(::testing::benchmark::State& state) {
+  BM_Find<absl::flat_hash_map<string, int>>(state, StringKey);
+}
+void BM_FlatMapInsertEraseInt(::testing::benchmark::State& state) {
+  BM_InsertErase<FlatMap<int64_t, int>>(state, IntKey);
+}
+void BM_AbslInsertEraseInt(::testing::benchmark::State& state) {
+  BM_InsertErase<absl::flat_hash_map<int64_t, int>>(state, IntKey);
+}
+void BM_FlatMapInsertEraseString(::testing::benchmark::State& state) {
+  BM_InsertErase<FlatMap<string, int>>(state, StringKey);
+}
+void BM_AbslInsertEraseString(::testing::benchmark::State& state) {
+  BM_InsertErase<absl::flat_hash_map<string, int>>(state, StringKey);
+}
+
+// {size, whether the keys are in the map}
+#define BM_FIND_ARGS \
+  ArgPair(64, 1)->ArgPair(64, 0)->ArgPair(1 << 16, 1)->ArgPair(1 << 16, 0)
+BENCHMARK(BM_FlatMapFindInt)->BM_FIND_ARGS;
+BENCHMARK(BM_AbslFindInt)->BM_FIND_ARGS;
+BENCHMARK(BM_FlatMapFindString)->BM_FIND_ARGS;
+BENCHMARK(BM_AbslFindString)->BM_FIND_ARGS;
+#undef BM_FIND_ARGS
+BENCHMARK(BM_FlatMapInsertEraseInt)->Arg(64)->Arg(1 << 16);
+BENCHMARK(BM_AbslInsertEraseInt)->Arg(64)->Arg(1 << 16);
+BENCHMARK(BM_FlatMapInsertEraseString)->Arg(64)->Arg(1 << 16);
+BENCHMARK(BM_AbslInsertEraseString)->Arg(64)->Arg(1 << 16);
+
 }  // namespace
 }  // namespace gtl
 }  // namespace tensorflow
@@ -21,6 +21,12 @@ limitations under the License.
 #include "tensorflow/core/platform/prefetch.h"
 #include "tensorflow/core/platform/types.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 namespace tensorflow {
 namespace gtl {
 namespace internal {
@@ -39,6 +45,11 @@ namespace internal {
 //      These hash bits can be used to avoid potentially expensive
 //      key comparisons.
 //
+// Probing visits whole buckets: the markers of a bucket are compared with
+// the marker of the key at once (with SSE2 or NEON when available), and the
+// key is only compared with the entries whose marker matches.  A lookup
+// stops at the first bucket that has an empty entry.
+//
 // FlatMap passes in a bucket that contains keys and values, FlatSet
 // passes in a bucket that does not contain values.
 template <typename Key, typename Bucket, class Hash, class Eq>
@@ -136,25 +147,27 @@ class FlatRep {
 
   // Hash value is partitioned as follows:
   // 1. Bottom 8 bits are stored in bucket to help speed up comparisons.
-  // 2. Next 3 bits give index inside bucket.
-  // 3. Remaining bits give bucket number.
+  // 2. Next 3 bits are unused.
+  // 3. Remaining bits give the first bucket to probe.
 
   // Find bucket/index for key k.
   SearchResult Find(const Key& k) const {
     size_t h = hash_(k);
     const uint32 marker = Marker(h & 0xff);
-    size_t index = (h >> 8) & mask_;  // Holds bucket num and index-in-bucket
-    uint32 num_probes = 1;            // Needed for quadratic probing
+    size_t bucket = FirstBucket(h);
+    uint32 num_probes = 1;  // Needed for quadratic probing
     while (true) {
-      uint32 bi = index & (kWidth - 1);
-      Bucket* b = &array_[index >> kBase];
-      const uint32 x = b->marker[bi];
-      if (x == marker && equal_(b->key(bi), k)) {
-        return {true, b, bi};
-      } else if (x == kEmpty) {
+      Bucket* b = &array_[bucket];
+      for (uint32 m = MatchMarkers(b, marker); m != 0; m &= m - 1) {
+        const uint32 bi = FirstEntry(m);
+        if (equal_(b->key(bi), k)) {
+          return {true, b, bi};
+        }
+      }
+      if (MatchMarkers(b, kEmpty) != 0) {
         return {false, nullptr, 0};
       }
-      index = NextIndex(index, num_probes);
+      bucket = NextBucket(bucket, num_probes);
       num_probes++;
     }
   }
@@ -168,52 +181,67 @@ class FlatRep {
   SearchResult FindOrInsert(KeyType&& k) {
     size_t h = hash_(k);
     const uint32 marker = Marker(h & 0xff);
-    size_t index = (h >> 8) & mask_;  // Holds bucket num and index-in-bucket
-    uint32 num_probes = 1;            // Needed for quadratic probing
-    Bucket* del = nullptr;            // First encountered deletion for kInsert
+    size_t bucket = FirstBucket(h);
+    uint32 num_probes = 1;  // Needed for quadratic probing
+    Bucket* del = nullptr;  // First encountered deletion for kInsert
     uint32 di = 0;
     while (true) {
-      uint32 bi = index & (kWidth - 1);
-      Bucket* b = &array_[index >> kBase];
-      const uint32 x = b->marker[bi];
-      if (x == marker && equal_(b->key(bi), k)) {
-        return {true, b, bi};
-      } else if (!del && x == kDeleted) {
-        // Remember deleted index to use for insertion.
-        del = b;
-        di = bi;
-      } else if (x == kEmpty) {
+      Bucket* b = &array_[bucket];
+      for (uint32 m = MatchMarkers(b, marker); m != 0; m &= m - 1) {
+        const uint32 bi = FirstEntry(m);
+        if (equal_(b->key(bi), k)) {
+          return {true, b, bi};
+        }
+      }
+      if (!del) {
+        const uint32 deleted = MatchMarkers(b, kDeleted);
+        if (deleted != 0) {
+          // Remember deleted index to use for insertion.
+          del = b;
+          di = FirstEntry(deleted);
+        }
+      }
+      const uint32 empty = MatchMarkers(b, kEmpty);
+      if (empty != 0) {
+        uint32 bi;
         if (del) {
           // Store in the first deleted slot we encountered
           b = del;
           bi = di;
           deleted_--;  // not_empty_ does not change
         } else {
+          bi = FirstEntry(empty);
           not_empty_++;
         }
         b->marker[bi] = marker;
         new (&b->key(bi)) Key(std::forward<KeyType>(k));
         return {false, b, bi};
       }
-      index = NextIndex(index, num_probes);
+      bucket = NextBucket(bucket, num_probes);
       num_probes++;
     }
   }
 
   void Erase(Bucket* b, uint32 i) {
     b->Destroy(i);
-    b->marker[i] = kDeleted;
-    deleted_++;
+    if (MatchMarkers(b, kEmpty) != 0) {
+      // A bucket with an empty entry has never been full since the table was
+      // built, so no probe sequence goes past it and the entry can be reused
+      // as if it had never been filled.
+      b->marker[i] = kEmpty;
+      not_empty_--;
+    } else {
+      b->marker[i] = kDeleted;
+      deleted_++;
+    }
     grow_ = 0;  // Consider shrinking on next insert
   }
 
   void Prefetch(const Key& k) const {
     size_t h = hash_(k);
-    size_t index = (h >> 8) & mask_;  // Holds bucket num and index-in-bucket
-    uint32 bi = index & (kWidth - 1);
-    Bucket* b = &array_[index >> kBase];
-    port::prefetch<port::PREFETCH_HINT_T0>(&b->marker[bi]);
-    port::prefetch<port::PREFETCH_HINT_T0>(&b->storage.key[bi]);
+    Bucket* b = &array_[FirstBucket(h)];
+    port::prefetch<port::PREFETCH_HINT_T0>(&b->marker[0]);
+    port::prefetch<port::PREFETCH_HINT_T0>(&b->storage.key[0]);
   }
 
   inline void MaybeResize() {
@@ -257,6 +285,43 @@ class FlatRep {
   // store in Bucket::marker[].
   static uint32 Marker(uint32 hb) { return hb + (hb < 2 ? 2 : 0); }
 
+  // Returns a mask with bit i set iff b->marker[i] == marker.
+  static uint32 MatchMarkers(const Bucket* b, uint32 marker) {
+    static_assert(kWidth == 8, "Markers are matched 8 at a time");
+#if defined(__SSE2__)
+    const __m128i markers =
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(b->marker));
+    const __m128i match =
+        _mm_cmpeq_epi8(markers, _mm_set1_epi8(static_cast<char>(marker)));
+    return _mm_movemask_epi8(match) & 0xff;
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+    static const uint8 kBits[8] = {1, 2, 4, 8, 16, 32, 64, 128};
+    const uint8x8_t match =
+        vceq_u8(vld1_u8(b->marker), vdup_n_u8(static_cast<uint8>(marker)));
+    return vaddv_u8(vand_u8(match, vld1_u8(kBits)));
+#else
+    uint32 mask = 0;
+    for (uint32 i = 0; i < kWidth; i++) {
+      mask |= static_cast<uint32>(b->marker[i] == marker) << i;
+    }
+    return mask;
+#endif
+  }
+
+  // Returns the index of the lowest bit set in the non-zero `mask`.
+  static uint32 FirstEntry(uint32 mask) {
+#if defined(__GNUC__)
+    return __builtin_ctz(mask);
+#else
+    uint32 i = 0;
+    while ((mask & 1) == 0) {
+      mask >>= 1;
+      i++;
+    }
+    return i;
+#endif
+  }
+
   void Init(size_t N) {
     // Make enough room for N elements.
     size_t lg = 0;  // Smallest table is just one bucket.
@@ -320,26 +385,30 @@ class FlatRep {
   void FreshInsert(Bucket* src, uint32 src_index, Copier copier) {
     size_t h = hash_(src->key(src_index));
     const uint32 marker = Marker(h & 0xff);
-    size_t index = (h >> 8) & mask_;  // Holds bucket num and index-in-bucket
-    uint32 num_probes = 1;            // Needed for quadratic probing
+    size_t bucket = FirstBucket(h);
+    uint32 num_probes = 1;  // Needed for quadratic probing
     while (true) {
-      uint32 bi = index & (kWidth - 1);
-      Bucket* b = &array_[index >> kBase];
-      const uint32 x = b->marker[bi];
-      if (x == 0) {
+      Bucket* b = &array_[bucket];
+      const uint32 empty = MatchMarkers(b, kEmpty);
+      if (empty != 0) {
+        const uint32 bi = FirstEntry(empty);
         b->marker[bi] = marker;
         not_empty_++;
         copier(b, bi, src, src_index);
         return;
       }
-      index = NextIndex(index, num_probes);
+      bucket = NextBucket(bucket, num_probes);
       num_probes++;
     }
   }
 
-  inline size_t NextIndex(size_t i, uint32 num_probes) const {
+  inline size_t FirstBucket(size_t h) const {
+    return ((h >> 8) & mask_) >> kBase;
+  }
+
+  inline size_t NextBucket(size_t b, uint32 num_probes) const {
     // Quadratic probing.
-    return (i + num_probes) & mask_;
+    return (b + num_probes) & (mask_ >> kBase);
   }
 };
 
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/lib/io/buffered_inputstream.h"
 
+#include <cstring>
+
 #include "tensorflow/core/lib/io/random_inputstream.h"
 
 namespace tensorflow {
@@ -55,37 +57,53 @@ Status BufferedInputStream::FillBuffer() {
   return s;
 }
 
+namespace {
+
+// Appends the `len` bytes at `data` to `result`, except '\r' characters.
+template <typename StringType>
+void AppendWithoutCarriageReturns(const char* data, size_t len,
+                                  StringType* result) {
+  const char* end = data + len;
+  while (data < end) {
+    const char* cr = static_cast<const char*>(memchr(data, '\r', end - data));
+    if (cr == nullptr) {
+      result->append(data, end - data);
+      return;
+    }
+    result->append(data, cr - data);
+    data = cr + 1;
+  }
+}
+
+}  // namespace
+
 template <typename StringType>
 Status BufferedInputStream::ReadLineHelper(StringType* result,
                                            bool include_eol) {
   result->clear();
   Status s;
-  size_t start_pos = pos_;
   while (true) {
     if (pos_ == limit_) {
-      result->append(buf_.data() + start_pos, pos_ - start_pos);
       // Get more data into buffer
       s = FillBuffer();
       if (limit_ == 0) {
         break;
       }
-      start_pos = pos_;
     }
-    char c = buf_[pos_];
-    if (c == '\n') {
-      result->append(buf_.data() + start_pos, pos_ - start_pos);
+    const char* start = buf_.data() + pos_;
+    const size_t available = limit_ - pos_;
+    const char* newline =
+        static_cast<const char*>(memchr(start, '\n', available));
+    const size_t len = newline != nullptr ? newline - start : available;
+    AppendWithoutCarriageReturns(start, len, result);
+    if (newline != nullptr) {
       if (include_eol) {
-        result->append(1, c);
+        result->append(1, '\n');
       }
-      pos_++;
+      pos_ += len + 1;
       return Status::OK();
     }
-    // We don't append '\r' to *result
-    if (c == '\r') {
-      result->append(buf_.data() + start_pos, pos_ - start_pos);
-      start_pos = pos_ + 1;
-    }
-    pos_++;
+    pos_ = limit_;
   }
   if (errors::IsOutOfRange(s) && !result->empty()) {
     return Status::OK();
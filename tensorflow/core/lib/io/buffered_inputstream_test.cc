@@ -189,6 +189,28 @@ TEST(BufferedInputStream, ReadLine_CRLF) {
   }
 }
 
+TEST(BufferedInputStream, ReadLine_CarriageReturnInLine) {
+  Env* env = Env::Default();
+  string fname;
+  ASSERT_TRUE(env->LocalTempFilename(&fname));
+  TF_ASSERT_OK(WriteStringToFile(env, fname, "a\rb\r\rc\r\nd\r"));
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file));
+
+  for (auto buf_size : BufferSizes()) {
+    std::unique_ptr<RandomAccessInputStream> input_stream(
+        new RandomAccessInputStream(file.get()));
+    BufferedInputStream in(input_stream.get(), buf_size);
+    string line;
+    // Carriage returns are dropped wherever they are in the line.
+    TF_ASSERT_OK(in.ReadLine(&line));
+    EXPECT_EQ(line, "abc");
+    TF_ASSERT_OK(in.ReadLine(&line));
+    EXPECT_EQ(line, "d");
+    EXPECT_TRUE(errors::IsOutOfRange(in.ReadLine(&line)));
+  }
+}
+
 TEST(BufferedInputStream, SkipLine1) {
   Env* env = Env::Default();
   string fname;
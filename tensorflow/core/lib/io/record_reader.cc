@@ -17,6 +17,9 @@ limitations under the License.
 
 #include <limits.h>
 
+#include <algorithm>
+#include <utility>
+
 #include "tensorflow/core/lib/core/coding.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/hash/crc32c.h"
@@ -74,9 +77,9 @@ RecordReader::RecordReader(RandomAccessFile* file,
         options.zlib_options.output_buffer_size, options.zlib_options, true));
   } else if (options.compression_type ==
              RecordReaderOptions::SNAPPY_COMPRESSION) {
-    input_stream_.reset(
-        new SnappyInputStream(input_stream_.release(),
-                              options.snappy_options.output_buffer_size, true));
+    input_stream_.reset(new SnappyInputStream(
+        input_stream_.release(), options.snappy_options.output_buffer_size,
+        true, options.snappy_options.num_decompression_threads));
   } else if (options.compression_type == RecordReaderOptions::NONE) {
     // Nothing to do.
   } else {
@@ -168,6 +171,7 @@ Status RecordReader::GetMetadata(Metadata* md) {
 }
 
 Status RecordReader::PositionInputStream(uint64 offset) {
+  batch_leftover_.clear();
   int64_t curr_pos = input_stream_->Tell();
   int64_t desired_pos = static_cast<int64_t>(offset);
   if (curr_pos > desired_pos || curr_pos < 0 /* EOF */ ||
@@ -209,6 +213,108 @@ Status RecordReader::ReadRecord(uint64* offset, tstring* record) {
   return Status::OK();
 }
 
+Status RecordReader::ReadRecordBatch(uint64* offset, size_t max_bytes,
+                                     RecordBatch* batch) {
+  batch->buffer.reset();
+  batch->records.clear();
+
+  auto buffer = std::make_shared<tstring>();
+  if (!batch_leftover_.empty() && !last_read_failed_ &&
+      batch_leftover_offset_ == *offset &&
+      input_stream_->Tell() == *offset + batch_leftover_.size()) {
+    std::swap(*buffer, batch_leftover_);
+  } else {
+    TF_RETURN_IF_ERROR(PositionInputStream(*offset));
+  }
+
+  // Reads from the input stream until *buffer holds at least `size` bytes or
+  // the end of the stream is reached.
+  bool eof = false;
+  auto fill_buffer = [&](size_t size) -> Status {
+    if (eof || buffer->size() >= size) return Status::OK();
+    const size_t bytes_to_read = size - buffer->size();
+    Status s;
+    if (buffer->empty()) {
+      s = input_stream_->ReadNBytes(bytes_to_read, buffer.get());
+    } else {
+      tstring chunk;
+      s = input_stream_->ReadNBytes(bytes_to_read, &chunk);
+      buffer->append(chunk.data(), chunk.size());
+    }
+    if (errors::IsOutOfRange(s)) {
+      eof = true;
+      return Status::OK();
+    }
+    return s;
+  };
+
+  // The (position, length) of the records in *buffer, which may grow and move
+  // until all of them are parsed.
+  std::vector<std::pair<size_t, size_t>> records;
+  size_t pos = 0;
+  Status s = fill_buffer(std::max(max_bytes, kHeaderSize));
+  while (s.ok()) {
+    const uint64 record_offset = *offset + pos;
+    if (buffer->size() - pos < kHeaderSize) {
+      if (!records.empty()) break;
+      s = fill_buffer(pos + kHeaderSize);
+      if (!s.ok()) break;
+      if (buffer->size() - pos < kHeaderSize) {
+        s = buffer->size() == pos
+                ? errors::OutOfRange("eof")
+                : errors::DataLoss("truncated record at ", record_offset);
+        break;
+      }
+    }
+
+    const char* header = buffer->data() + pos;
+    if (crc32c::Unmask(core::DecodeFixed32(header + sizeof(uint64))) !=
+        crc32c::Value(header, sizeof(uint64))) {
+      s = errors::DataLoss("corrupted record at ", record_offset);
+      break;
+    }
+    const uint64 length = core::DecodeFixed64(header);
+    if (length >= SIZE_MAX - pos - kHeaderSize - kFooterSize) {
+      s = errors::DataLoss("record size too large");
+      break;
+    }
+    const size_t record_end = pos + kHeaderSize + length + kFooterSize;
+    if (buffer->size() < record_end) {
+      if (!records.empty()) break;
+      s = fill_buffer(record_end);
+      if (!s.ok()) break;
+      if (buffer->size() < record_end) {
+        s = errors::DataLoss("truncated record at ", record_offset);
+        break;
+      }
+    }
+
+    const char* data = buffer->data() + pos + kHeaderSize;
+    if (crc32c::Unmask(core::DecodeFixed32(data + length)) !=
+        crc32c::Value(data, length)) {
+      s = errors::DataLoss("corrupted record at ", record_offset);
+      break;
+    }
+    records.emplace_back(pos + kHeaderSize, length);
+    pos = record_end;
+  }
+  // A corrupted record that follows good ones is reported by the next call.
+  if (!s.ok() && records.empty()) {
+    last_read_failed_ = true;
+    return s;
+  }
+
+  batch_leftover_.assign(buffer->data() + pos, buffer->size() - pos);
+  batch_leftover_offset_ = *offset + pos;
+  *offset += pos;
+  batch->records.reserve(records.size());
+  for (const auto& record : records) {
+    batch->records.emplace_back(buffer->data() + record.first, record.second);
+  }
+  batch->buffer = std::move(buffer);
+  return Status::OK();
+}
+
 Status RecordReader::SkipRecords(uint64* offset, int num_to_skip,
                                  int* num_skipped) {
   TF_RETURN_IF_ERROR(PositionInputStream(*offset));
@@ -16,6 +16,9 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_LIB_IO_RECORD_READER_H_
 #define TENSORFLOW_CORE_LIB_IO_RECORD_READER_H_
 
+#include <memory>
+#include <vector>
+
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/lib/io/inputstream_interface.h"
@@ -84,6 +87,14 @@ class RecordReader {
     Stats stats;
   };
 
+  // Records parsed out of a single buffer by ReadRecordBatch(). The records
+  // point into "buffer", which is shared by all copies of the batch, so they
+  // remain valid for as long as any copy is alive.
+  struct RecordBatch {
+    std::shared_ptr<const tstring> buffer;
+    std::vector<StringPiece> records;
+  };
+
   // Create a reader that will return log records from "*file".
   // "*file" must remain live while this Reader is in use.
   explicit RecordReader(
@@ -97,6 +108,17 @@ class RecordReader {
   // OUT_OF_RANGE for end of file, or something else for an error.
   Status ReadRecord(uint64* offset, tstring* record);
 
+  // Read the whole records that start at "*offset" and fit in about
+  // "max_bytes" of the file (at least one record) into *batch, and update
+  // *offset to point to the offset of the next record.  The records are not
+  // copied out of the buffer they are read into.  Returns OK on success,
+  // OUT_OF_RANGE for end of file, or something else for an error.
+  //
+  // Reading the batches of a file in order reads every byte of it once; the
+  // tail of a record that didn't fit in the previous batch is kept for the
+  // next call.
+  Status ReadRecordBatch(uint64* offset, size_t max_bytes, RecordBatch* batch);
+
   // Skip num_to_skip record starting at "*offset" and update *offset
   // to point to the offset of the next num_to_skip + 1 record.
   // Return OK on success, OUT_OF_RANGE for end of file, or something
@@ -123,6 +145,11 @@ class RecordReader {
   std::unique_ptr<InputStreamInterface> input_stream_;
   bool last_read_failed_;
 
+  // The bytes read past the last record returned by ReadRecordBatch(), and
+  // the offset of the first of them.
+  tstring batch_leftover_;
+  uint64 batch_leftover_offset_ = 0;
+
   std::unique_ptr<Metadata> cached_metadata_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(RecordReader);
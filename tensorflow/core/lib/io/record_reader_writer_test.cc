@@ -158,6 +158,95 @@ TEST(RecordReaderWriterTest, TestBasics) {
   }
 }
 
+TEST(RecordReaderWriterTest, TestReadRecordBatch) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_batch_test";
+  std::vector<string> records;
+  for (int i = 0; i < 100; ++i) {
+    records.push_back(string(i % 17, 'a' + i % 26));
+  }
+
+  for (const string& compression_type : {"", "ZLIB"}) {
+    {
+      std::unique_ptr<WritableFile> file;
+      TF_CHECK_OK(env->NewWritableFile(fname, &file));
+      io::RecordWriter writer(
+          file.get(),
+          io::RecordWriterOptions::CreateRecordWriterOptions(compression_type));
+      for (const string& record : records) {
+        TF_EXPECT_OK(writer.WriteRecord(record));
+      }
+      TF_CHECK_OK(writer.Close());
+    }
+
+    for (size_t max_bytes : {1, 20, 100, 65536}) {
+      std::unique_ptr<RandomAccessFile> read_file;
+      TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+      io::RecordReader reader(
+          read_file.get(),
+          io::RecordReaderOptions::CreateRecordReaderOptions(compression_type));
+      uint64 offset = 0;
+      uint64 expected_offset = 0;
+      size_t num_records = 0;
+      io::RecordReader::RecordBatch batch;
+      Status s;
+      while ((s = reader.ReadRecordBatch(&offset, max_bytes, &batch)).ok()) {
+        ASSERT_FALSE(batch.records.empty());
+        for (StringPiece record : batch.records) {
+          ASSERT_LT(num_records, records.size());
+          EXPECT_EQ(records[num_records], record);
+          expected_offset += records[num_records].size() +
+                             io::RecordReader::kHeaderSize +
+                             io::RecordReader::kFooterSize;
+          ++num_records;
+        }
+        EXPECT_EQ(expected_offset, offset);
+      }
+      EXPECT_EQ(error::OUT_OF_RANGE, s.code());
+      EXPECT_EQ(records.size(), num_records);
+
+      // The batch read can be mixed with single record reads.
+      offset = 0;
+      TF_ASSERT_OK(reader.ReadRecordBatch(&offset, max_bytes, &batch));
+      if (batch.records.size() < records.size()) {
+        tstring record;
+        TF_ASSERT_OK(reader.ReadRecord(&offset, &record));
+        EXPECT_EQ(records[batch.records.size()], record);
+      }
+    }
+  }
+}
+
+TEST(RecordReaderWriterTest, TestReadRecordBatchTruncated) {
+  Env* env = Env::Default();
+  string fname =
+      testing::TmpDir() + "/record_reader_writer_batch_truncated_test";
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+    io::RecordWriter writer(file.get());
+    TF_EXPECT_OK(writer.WriteRecord("abc"));
+    TF_EXPECT_OK(writer.WriteRecord("defg"));
+    TF_CHECK_OK(writer.Close());
+  }
+  string contents;
+  TF_CHECK_OK(ReadFileToString(env, fname, &contents));
+  TF_CHECK_OK(WriteStringToFile(env, fname,
+                                contents.substr(0, contents.size() - 2)));
+
+  std::unique_ptr<RandomAccessFile> read_file;
+  TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+  io::RecordReader reader(read_file.get());
+  uint64 offset = 0;
+  io::RecordReader::RecordBatch batch;
+  TF_ASSERT_OK(reader.ReadRecordBatch(&offset, 65536, &batch));
+  ASSERT_EQ(1, batch.records.size());
+  EXPECT_EQ("abc", batch.records[0]);
+  Status s = reader.ReadRecordBatch(&offset, 65536, &batch);
+  EXPECT_EQ(error::DATA_LOSS, s.code());
+  EXPECT_TRUE(absl::StrContains(s.error_message(), "truncated record"));
+}
+
 TEST(RecordReaderWriterTest, TestSkipBasic) {
   Env* env = Env::Default();
   string fname = testing::TmpDir() + "/record_reader_writer_skip_basic_test";
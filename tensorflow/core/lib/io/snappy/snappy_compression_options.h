@@ -28,6 +28,10 @@ struct SnappyCompressionOptions {
   // Size of the sink buffer where the compressed/decompressed data produced by
   // snappy is cached.
   int64_t output_buffer_size = 256 << 10;
+
+  // Number of threads used to decompress consecutive blocks of a stream in
+  // parallel. Only used for reading.
+  int num_decompression_threads = 1;
 };
 
 }  // namespace io
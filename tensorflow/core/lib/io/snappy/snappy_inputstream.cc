@@ -15,7 +15,12 @@ limitations under the License.
 
 #include "tensorflow/core/lib/io/snappy/snappy_inputstream.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "absl/memory/memory.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/snappy.h"
 
@@ -24,14 +29,22 @@ namespace io {
 
 SnappyInputStream::SnappyInputStream(InputStreamInterface* input_stream,
                                      size_t output_buffer_bytes,
-                                     bool owns_input_stream)
+                                     bool owns_input_stream,
+                                     int num_decompression_threads)
     : input_stream_(input_stream),
       output_buffer_bytes_(output_buffer_bytes),
       owns_input_stream_(owns_input_stream),
+      num_decompression_threads_(std::max(num_decompression_threads, 1)),
       bytes_read_(0),
-      output_buffer_(new char[output_buffer_bytes]),
+      output_buffer_(
+          new char[output_buffer_bytes * num_decompression_threads_]),
       next_out_(nullptr),
-      avail_out_(0) {}
+      avail_out_(0) {
+  if (num_decompression_threads_ > 1) {
+    thread_pool_ = absl::make_unique<thread::ThreadPool>(
+        Env::Default(), "snappy_decompression", num_decompression_threads_);
+  }
+}
 
 SnappyInputStream::SnappyInputStream(InputStreamInterface* input_stream,
                                      size_t output_buffer_bytes)
@@ -80,9 +93,10 @@ Status SnappyInputStream::ReadNBytes(int64_t bytes_to_read,
 }
 #endif
 
-Status SnappyInputStream::Inflate() {
+Status SnappyInputStream::ReadCompressedBlock(tstring* block,
+                                              size_t* uncompressed_length) {
   tstring compressed_block_length_ts;
-  uint32 compressed_block_length;
+  uint32 compressed_block_length = 0;
 
   TF_RETURN_IF_ERROR(
       input_stream_->ReadNBytes(sizeof(uint32), &compressed_block_length_ts));
@@ -92,40 +106,78 @@ Status SnappyInputStream::Inflate() {
         static_cast<unsigned char>(compressed_block_length_ts.data()[i]);
   }
 
-  tstring compressed_block;
-  compressed_block.resize_uninitialized(compressed_block_length);
-
-  Status s =
-      input_stream_->ReadNBytes(compressed_block_length, &compressed_block);
+  Status s = input_stream_->ReadNBytes(compressed_block_length, block);
   if (errors::IsOutOfRange(s)) {
     return errors::DataLoss("Failed to read ", compressed_block_length,
                             " bytes from file. Possible data corruption.");
   }
   TF_RETURN_IF_ERROR(s);
 
-  size_t uncompressed_length;
-  if (!port::Snappy_GetUncompressedLength(compressed_block.data(),
-                                          compressed_block_length,
-                                          &uncompressed_length)) {
+  if (!port::Snappy_GetUncompressedLength(block->data(), block->size(),
+                                          uncompressed_length)) {
     return errors::DataLoss("Parsing error in Snappy_GetUncompressedLength");
   }
-
-  DCHECK_EQ(avail_out_, 0);
-  if (output_buffer_bytes_ < uncompressed_length) {
+  if (output_buffer_bytes_ < *uncompressed_length) {
     return errors::ResourceExhausted(
         "Output buffer(size: ", output_buffer_bytes_,
         " bytes"
         ") too small. Should be larger than ",
-        uncompressed_length, " bytes.");
+        *uncompressed_length, " bytes.");
   }
+  return Status::OK();
+}
 
+Status SnappyInputStream::Inflate() {
+  DCHECK_EQ(avail_out_, 0);
   next_out_ = output_buffer_.get();
-  if (!port::Snappy_Uncompress(compressed_block.data(), compressed_block_length,
-                               output_buffer_.get())) {
-    return errors::DataLoss("Snappy_Uncompress failed.");
+
+  if (num_decompression_threads_ == 1) {
+    tstring compressed_block;
+    size_t uncompressed_length;
+    TF_RETURN_IF_ERROR(
+        ReadCompressedBlock(&compressed_block, &uncompressed_length));
+    if (!port::Snappy_Uncompress(compressed_block.data(),
+                                 compressed_block.size(),
+                                 output_buffer_.get())) {
+      return errors::DataLoss("Snappy_Uncompress failed.");
+    }
+    avail_out_ += uncompressed_length;
+    return Status::OK();
   }
-  avail_out_ += uncompressed_length;
 
+  // Read up to num_decompression_threads_ blocks and decompress them next to
+  // each other in output_buffer_. Reaching the end of the stream after the
+  // first block only ends the batch; the next call reports it.
+  std::vector<tstring> compressed_blocks(num_decompression_threads_);
+  std::vector<size_t> output_offsets;
+  size_t total_uncompressed_length = 0;
+  for (tstring& compressed_block : compressed_blocks) {
+    size_t uncompressed_length;
+    Status s = ReadCompressedBlock(&compressed_block, &uncompressed_length);
+    if (errors::IsOutOfRange(s) && !output_offsets.empty()) break;
+    TF_RETURN_IF_ERROR(s);
+    output_offsets.push_back(total_uncompressed_length);
+    total_uncompressed_length += uncompressed_length;
+  }
+
+  const int num_blocks = output_offsets.size();
+  // Not a vector<bool>, whose elements can't be written concurrently.
+  std::vector<char> uncompressed(num_blocks);
+  BlockingCounter counter(num_blocks);
+  for (int i = 0; i < num_blocks; ++i) {
+    thread_pool_->Schedule([&, i]() {
+      uncompressed[i] = port::Snappy_Uncompress(
+          compressed_blocks[i].data(), compressed_blocks[i].size(),
+          output_buffer_.get() + output_offsets[i]);
+      counter.DecrementCount();
+    });
+  }
+  counter.Wait();
+  if (std::find(uncompressed.begin(), uncompressed.end(), 0) !=
+      uncompressed.end()) {
+    return errors::DataLoss("Snappy_Uncompress failed.");
+  }
+  avail_out_ += total_uncompressed_length;
   return Status::OK();
 }
 
@@ -16,7 +16,10 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_LIB_IO_SNAPPY_SNAPPY_INPUTSTREAM_H_
 #define TENSORFLOW_CORE_LIB_IO_SNAPPY_SNAPPY_INPUTSTREAM_H_
 
+#include <memory>
+
 #include "tensorflow/core/lib/io/inputstream_interface.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 namespace io {
@@ -26,8 +29,13 @@ class SnappyInputStream : public InputStreamInterface {
   // Creates a SnappyInputStream for `input_stream`.
   //
   // Takes ownership  of `input_stream` iff `owns_input_stream` is true.
+  //
+  // If `num_decompression_threads` is greater than 1, up to that many
+  // consecutive blocks are read at a time and decompressed in parallel, which
+  // needs that many times `output_buffer_bytes` of memory.
   SnappyInputStream(InputStreamInterface* input_stream,
-                    size_t output_buffer_bytes, bool owns_input_stream);
+                    size_t output_buffer_bytes, bool owns_input_stream,
+                    int num_decompression_threads = 1);
 
   // Equivalent to the previous constructor with owns_input_stream = false.
   explicit SnappyInputStream(InputStreamInterface* input_stream,
@@ -58,6 +66,10 @@ class SnappyInputStream : public InputStreamInterface {
   // Decompress the next chunk of data and place the data into the cache.
   Status Inflate();
 
+  // Reads the next compressed block from `input_stream_` into `*block` and
+  // stores its uncompressed length in `*uncompressed_length`.
+  Status ReadCompressedBlock(tstring* block, size_t* uncompressed_length);
+
   // Attempt to read `bytes_to_read` from the decompressed data cache. Returns
   // the actual number of bytes read.
   size_t ReadBytesFromCache(size_t bytes_to_read, char* result);
@@ -65,6 +77,10 @@ class SnappyInputStream : public InputStreamInterface {
   InputStreamInterface* input_stream_;
   const size_t output_buffer_bytes_;
   const bool owns_input_stream_;
+  const int num_decompression_threads_;
+
+  // Decompresses blocks in parallel if num_decompression_threads_ > 1.
+  std::unique_ptr<thread::ThreadPool> thread_pool_;
 
   // Specifies the number of decompressed bytes currently read.
   int64_t bytes_read_;
@@ -162,7 +162,7 @@ Status TestMultipleWritesInputStream(
     size_t compress_input_buf_size, size_t compress_output_buf_size,
     size_t uncompress_input_buf_size, size_t uncompress_output_buf_size,
     int num_writes = 1, bool with_flush = false, int num_copies = 1,
-    bool corrupt_compressed_file = false) {
+    bool corrupt_compressed_file = false, int num_decompression_threads = 1) {
   Env* env = Env::Default();
 
   string expected_result;
@@ -176,8 +176,9 @@ Status TestMultipleWritesInputStream(
   std::unique_ptr<RandomAccessFile> file_reader;
   TF_RETURN_IF_ERROR(env->NewRandomAccessFile(fname, &file_reader));
   io::RandomAccessInputStream random_input_stream(file_reader.get(), false);
-  io::SnappyInputStream snappy_input_stream(&random_input_stream,
-                                            uncompress_output_buf_size);
+  io::SnappyInputStream snappy_input_stream(
+      &random_input_stream, uncompress_output_buf_size,
+      /*owns_input_stream=*/false, num_decompression_threads);
 
   for (int attempt = 0; attempt < 2; ++attempt) {
     string actual_result;
@@ -313,6 +314,18 @@ TEST(SnappyBuffers, MultipleWriteCallsWithFlush) {
       TestMultipleWritesInputStream(10000, 10000, 10000, 10000, 2, true));
 }
 
+TEST(SnappyBuffers, ParallelDecompressionInputStream) {
+  if (!SnappyCompressionSupported()) {
+    fprintf(stderr, "skipping compression tests\n");
+    return;
+  }
+  // Every flushed write is a separate block.
+  for (int num_threads : {2, 4, 16}) {
+    TF_CHECK_OK(TestMultipleWritesInputStream(10000, 10000, 10000, 10000, 10,
+                                              true, 1, false, num_threads));
+  }
+}
+
 TEST(SnappyBuffers, SmallUncompressInputBuffer) {
   if (!SnappyCompressionSupported()) {
     fprintf(stderr, "skipping compression tests\n");
@@ -382,6 +395,18 @@ TEST(SnappyBuffers, CorruptBlockLargeInputStream) {
                     " bytes from file. Possible data corruption.");
 }
 
+TEST(SnappyBuffers, CorruptBlockParallelDecompressionInputStream) {
+  if (!SnappyCompressionSupported()) {
+    fprintf(stderr, "skipping compression tests\n");
+    return;
+  }
+  Status status = TestMultipleWritesInputStream(10000, 10000, 2000, 10000, 2,
+                                                true, 1, true, 4);
+  CHECK_EQ(status.code(), error::Code::DATA_LOSS);
+  CheckPrefixSuffix(status.error_message(), "Failed to read ",
+                    " bytes from file. Possible data corruption.");
+}
+
 TEST(SnappyBuffers, Tell) {
   if (!SnappyCompressionSupported()) {
     fprintf(stderr, "skipping compression tests\n");
@@ -196,10 +196,14 @@ class Counter {
 
 inline void CounterCell::IncrementBy(const int64_t step) {
   DCHECK_LE(0, step) << "Must not decrement cumulative metrics.";
-  value_ += step;
+  // The value is not used to synchronize other memory, so the increment does
+  // not need to be ordered with respect to anything else.
+  value_.fetch_add(step, std::memory_order_relaxed);
 }
 
-inline int64_t CounterCell::value() const { return value_; }
+inline int64_t CounterCell::value() const {
+  return value_.load(std::memory_order_relaxed);
+}
 
 template <int NumLabels>
 template <typename... MetricDefArgs>
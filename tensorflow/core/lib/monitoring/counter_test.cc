@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/lib/monitoring/counter.h"
 
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 
 namespace tensorflow {
 namespace monitoring {
@@ -86,6 +87,16 @@ TEST(UnlabeledCounterDeathTest, DiesOnDecrement) {
       "decrement");
 }
 
+void BM_CounterIncrement(::testing::benchmark::State& state) {
+  static auto* counter = Counter<1>::New("/tensorflow/test/counter_benchmark",
+                                         "Counter for benchmarks.", "MyLabel");
+  CounterCell* cell = counter->GetCell("Cached");
+  for (auto s : state) {
+    cell->IncrementBy(1);
+  }
+}
+BENCHMARK(BM_CounterIncrement)->Threads(1)->Threads(8)->Threads(16);
+
 TEST(LabeledCounterTest, SameName) {
   auto* same_counter = Counter<1>::New("/tensorflow/test/counter_with_labels",
                                        "Counter with one label.", "MyLabel");
@@ -26,6 +26,11 @@ limitations under the License.
 // Do nothing.
 #else
 
+#include <algorithm>
+#include <atomic>
+
+#include "tensorflow/core/platform/logging.h"
+
 namespace tensorflow {
 namespace monitoring {
 namespace {
@@ -96,6 +101,50 @@ class ExponentialBuckets : public Buckets {
 
 }  // namespace
 
+SamplerCell::SamplerCell(const std::vector<double>& bucket_limits) {
+  shards_.reserve(kNumShards);
+  for (int i = 0; i < kNumShards; ++i) {
+    shards_.emplace_back(new Shard(bucket_limits));
+  }
+}
+
+// static
+int SamplerCell::ThreadShard() {
+  static std::atomic<int> next_shard{0};
+  static thread_local const int shard =
+      next_shard.fetch_add(1, std::memory_order_relaxed) % kNumShards;
+  return shard;
+}
+
+HistogramProto SamplerCell::value() const {
+  HistogramProto pb;
+  {
+    mutex_lock l(shards_[0]->mu);
+    shards_[0]->histogram.EncodeToProto(&pb, true /* preserve_zero_buckets */);
+  }
+  HistogramProto shard_pb;
+  for (int i = 1; i < kNumShards; ++i) {
+    {
+      mutex_lock l(shards_[i]->mu);
+      shards_[i]->histogram.EncodeToProto(&shard_pb,
+                                          true /* preserve_zero_buckets */);
+    }
+    if (shard_pb.num() == 0) continue;
+    // All shards have the same bucket limits and keep their empty buckets, so
+    // the buckets line up.
+    DCHECK_EQ(pb.bucket_size(), shard_pb.bucket_size());
+    pb.set_min(std::min(pb.min(), shard_pb.min()));
+    pb.set_max(std::max(pb.max(), shard_pb.max()));
+    pb.set_num(pb.num() + shard_pb.num());
+    pb.set_sum(pb.sum() + shard_pb.sum());
+    pb.set_sum_squares(pb.sum_squares() + shard_pb.sum_squares());
+    for (int b = 0; b < pb.bucket_size(); ++b) {
+      pb.set_bucket(b, pb.bucket(b) + shard_pb.bucket(b));
+    }
+  }
+  return pb;
+}
+
 // static
 std::unique_ptr<Buckets> Buckets::Explicit(std::vector<double> bucket_limits) {
   return std::unique_ptr<Buckets>(
@@ -113,6 +113,8 @@ class Sampler {
 #include <float.h>
 
 #include <map>
+#include <memory>
+#include <vector>
 
 #include "tensorflow/core/framework/summary.pb.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -135,10 +137,13 @@ namespace monitoring {
 // associated locking are both avoided).
 //
 // This class is thread-safe.
+//
+// Samples are added to one of several histograms picked by the calling
+// thread, so that threads adding to the same cell rarely contend on a lock or
+// a cache line. The histograms are merged when the value is read.
 class SamplerCell {
  public:
-  SamplerCell(const std::vector<double>& bucket_limits)
-      : histogram_(bucket_limits) {}
+  SamplerCell(const std::vector<double>& bucket_limits);
 
   ~SamplerCell() {}
 
@@ -149,7 +154,21 @@ class SamplerCell {
   HistogramProto value() const;
 
  private:
-  histogram::ThreadSafeHistogram histogram_;
+  static constexpr int kNumShards = 8;
+
+  struct Shard {
+    explicit Shard(const std::vector<double>& bucket_limits)
+        : histogram(bucket_limits) {}
+
+    mutable mutex mu;
+    histogram::Histogram histogram TF_GUARDED_BY(mu);
+  };
+
+  // Returns the shard of the calling thread.
+  static int ThreadShard();
+
+  // Each shard is allocated separately to keep them on different cache lines.
+  std::vector<std::unique_ptr<Shard>> shards_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(SamplerCell);
 };
@@ -277,12 +296,10 @@ class Sampler {
 //  Implementation details follow. API readers may skip.
 ////
 
-inline void SamplerCell::Add(const double sample) { histogram_.Add(sample); }
-
-inline HistogramProto SamplerCell::value() const {
-  HistogramProto pb;
-  histogram_.EncodeToProto(&pb, true /* preserve_zero_buckets */);
-  return pb;
+inline void SamplerCell::Add(const double sample) {
+  Shard& shard = *shards_[ThreadShard()];
+  mutex_lock l(shard.mu);
+  shard.histogram.Add(sample);
 }
 
 template <int NumLabels>
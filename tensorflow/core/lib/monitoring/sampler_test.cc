@@ -15,7 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/lib/monitoring/sampler.h"
 
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 
 namespace tensorflow {
 namespace monitoring {
@@ -112,6 +114,41 @@ TEST(ExponentialSamplerTest, ExponentialBucketBoundaries) {
   EqHistograms(expected, cell->value());
 }
 
+auto* sampler_with_threads =
+    Sampler<0>::New({"/tensorflow/test/sampler_with_threads",
+                     "Sampler added to from several threads."},
+                    Buckets::Explicit({1.0, 2.0}));
+
+TEST(UnlabeledSamplerTest, MergesThreads) {
+  constexpr int kNumThreads = 16;
+  auto* cell = sampler_with_threads->GetCell();
+  {
+    std::vector<std::unique_ptr<Thread>> threads;
+    for (int i = 0; i < kNumThreads; ++i) {
+      threads.emplace_back(Env::Default()->StartThread(
+          ThreadOptions(), "sampler_test", [cell, i]() {
+            for (int j = 0; j < 100; ++j) cell->Add(i % 3);
+          }));
+    }
+  }
+  Histogram expected({1.0, 2.0, DBL_MAX});
+  for (int i = 0; i < kNumThreads; ++i) {
+    for (int j = 0; j < 100; ++j) expected.Add(i % 3);
+  }
+  EqHistograms(expected, cell->value());
+}
+
+void BM_SamplerAdd(::testing::benchmark::State& state) {
+  static auto* sampler = Sampler<0>::New(
+      {"/tensorflow/test/sampler_benchmark", "Sampler for benchmarks."},
+      Buckets::Exponential(1, 2, 30));
+  SamplerCell* cell = sampler->GetCell();
+  for (auto s : state) {
+    cell->Add(1000);
+  }
+}
+BENCHMARK(BM_SamplerAdd)->Threads(1)->Threads(8)->Threads(16);
+
 TEST(ExplicitSamplerTest, SameName) {
   auto* same_sampler = Sampler<1>::New({"/tensorflow/test/sampler_with_labels",
                                         "Sampler with one label.", "MyLabel"},
@@ -190,6 +190,47 @@ class PhiloxRandom {
     return counter;
   }
 
+  // Computes the next kBlocks results of operator() into `output` and skips
+  // past them. The blocks are computed side by side, one per lane, so that
+  // the compiler can vectorize the rounds across blocks.
+  template <int kBlocks>
+  PHILOX_DEVICE_INLINE void Generate(ResultType* output) {
+    uint32_t c0[kBlocks];
+    uint32_t c1[kBlocks];
+    uint32_t c2[kBlocks];
+    uint32_t c3[kBlocks];
+    for (int b = 0; b < kBlocks; ++b) {
+      c0[b] = counter_[0];
+      c1[b] = counter_[1];
+      c2[b] = counter_[2];
+      c3[b] = counter_[3];
+      SkipOne();
+    }
+
+    uint32_t key0 = key_[0];
+    uint32_t key1 = key_[1];
+    for (int round = 0; round < 10; ++round) {
+      for (int b = 0; b < kBlocks; ++b) {
+        // The same as ComputeSingleRound.
+        const uint64_t product0 = static_cast<uint64_t>(kPhiloxM4x32A) * c0[b];
+        const uint64_t product1 = static_cast<uint64_t>(kPhiloxM4x32B) * c2[b];
+        c0[b] = static_cast<uint32_t>(product1 >> 32) ^ c1[b] ^ key0;
+        c2[b] = static_cast<uint32_t>(product0 >> 32) ^ c3[b] ^ key1;
+        c1[b] = static_cast<uint32_t>(product1);
+        c3[b] = static_cast<uint32_t>(product0);
+      }
+      key0 += kPhiloxW32A;
+      key1 += kPhiloxW32B;
+    }
+
+    for (int b = 0; b < kBlocks; ++b) {
+      output[b][0] = c0[b];
+      output[b][1] = c1[b];
+      output[b][2] = c2[b];
+      output[b][3] = c3[b];
+    }
+  }
+
  private:
   // We use the same constants as recommended by the original paper.
   static constexpr uint32_t kPhiloxW32A = 0x9E3779B9;
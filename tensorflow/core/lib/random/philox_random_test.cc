@@ -68,6 +68,32 @@ TEST(PhiloxRandomTest, SkipMatchTest) {
   }
 }
 
+// Checks that generating a batch of blocks at once returns the same blocks
+// as generating them one by one, including across a carry in the counter.
+TEST(PhiloxRandomTest, GenerateMatchTest) {
+  constexpr int kBlocks = 16;
+  PhiloxRandom gen(GetTestSeed());
+  gen.Skip(0xfffffff8);
+  PhiloxRandom batched_gen = gen;
+
+  for (int iteration = 0; iteration < 4; ++iteration) {
+    PhiloxRandom::ResultType blocks[kBlocks];
+    batched_gen.Generate<kBlocks>(blocks);
+    for (int b = 0; b < kBlocks; ++b) {
+      const PhiloxRandom::ResultType expected = gen();
+      for (int i = 0; i < PhiloxRandom::kResultElementCount; ++i) {
+        ASSERT_EQ(blocks[b][i], expected[i]) << iteration << " " << b;
+      }
+    }
+  }
+  // Both generators continue at the same counter.
+  const PhiloxRandom::ResultType expected = gen();
+  const PhiloxRandom::ResultType actual = batched_gen();
+  for (int i = 0; i < PhiloxRandom::kResultElementCount; ++i) {
+    EXPECT_EQ(actual[i], expected[i]);
+  }
+}
+
 }  // namespace
 }  // namespace random
 }  // namespace tensorflow
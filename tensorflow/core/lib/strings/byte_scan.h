@@ -0,0 +1,155 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Byte-scanning primitives shared by the string kernels.  Each routine
+// processes 16 bytes at a time with SSE2 when the compiler targets it, and
+// falls back to a portable scalar loop otherwise; both paths return the same
+// results.
+
+#ifndef TENSORFLOW_CORE_LIB_STRINGS_BYTE_SCAN_H_
+#define TENSORFLOW_CORE_LIB_STRINGS_BYTE_SCAN_H_
+
+#include <cstring>
+
+#include "tensorflow/core/platform/stringpiece.h"
+#include "tensorflow/core/platform/types.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace tensorflow {
+namespace strings {
+
+// A set of bytes that can be searched for in a string.  Construct it once and
+// reuse it across many searches: small sets (up to kMaxVectorBytes) are
+// matched with vector compares, larger ones with a lookup table.
+class ByteSet {
+ public:
+  static constexpr int kMaxVectorBytes = 4;
+
+  explicit ByteSet(StringPiece chars) : num_bytes_(0) {
+    memset(table_, 0, sizeof(table_));
+    for (char c : chars) {
+      const uint8 b = static_cast<uint8>(c);
+      if (table_[b]) continue;
+      table_[b] = true;
+      if (num_bytes_ < kMaxVectorBytes) bytes_[num_bytes_] = c;
+      ++num_bytes_;
+    }
+  }
+
+  bool contains(char c) const { return table_[static_cast<uint8>(c)]; }
+
+  // Returns the position of the first byte of `s` at or after `pos` that is
+  // in this set, or StringPiece::npos if there is none.
+  size_t FindFirstIn(StringPiece s, size_t pos = 0) const {
+    if (pos >= s.size() || num_bytes_ == 0) return StringPiece::npos;
+    const char* data = s.data();
+    const size_t size = s.size();
+    if (num_bytes_ == 1) {
+      const void* hit = memchr(data + pos, bytes_[0], size - pos);
+      return hit == nullptr ? StringPiece::npos
+                            : static_cast<const char*>(hit) - data;
+    }
+#if defined(__SSE2__)
+    if (num_bytes_ <= kMaxVectorBytes) {
+      __m128i needles[kMaxVectorBytes];
+      for (int k = 0; k < num_bytes_; ++k) {
+        needles[k] = _mm_set1_epi8(bytes_[k]);
+      }
+      for (; pos + 16 <= size; pos += 16) {
+        const __m128i v =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        __m128i match = _mm_cmpeq_epi8(v, needles[0]);
+        for (int k = 1; k < num_bytes_; ++k) {
+          match = _mm_or_si128(match, _mm_cmpeq_epi8(v, needles[k]));
+        }
+        const int mask = _mm_movemask_epi8(match);
+        if (mask != 0) return pos + __builtin_ctz(mask);
+      }
+    }
+#endif
+    for (; pos < size; ++pos) {
+      if (contains(data[pos])) return pos;
+    }
+    return StringPiece::npos;
+  }
+
+ private:
+  bool table_[256];
+  char bytes_[kMaxVectorBytes];
+  int num_bytes_;
+};
+
+// Returns the position of the first byte of `s` at or after `pos` that is one
+// of `chars`, or StringPiece::npos if there is none.
+inline size_t FindFirstOf(StringPiece s, StringPiece chars, size_t pos = 0) {
+  return ByteSet(chars).FindFirstIn(s, pos);
+}
+
+// Returns the number of UTF-8 continuation bytes (10xxxxxx) in `s`.  For
+// structurally valid UTF-8, s.size() minus this count is the number of code
+// points.
+inline size_t CountUTF8TrailBytes(StringPiece s) {
+  const char* data = s.data();
+  const size_t size = s.size();
+  size_t pos = 0;
+  size_t count = 0;
+#if defined(__SSE2__)
+  // As signed bytes, continuation bytes are exactly those below -0x40.
+  const __m128i threshold = _mm_set1_epi8(static_cast<char>(0xC0));
+  for (; pos + 16 <= size; pos += 16) {
+    const __m128i v =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+    count += __builtin_popcount(
+        _mm_movemask_epi8(_mm_cmplt_epi8(v, threshold)));
+  }
+#endif
+  for (; pos < size; ++pos) {
+    count += (static_cast<uint8>(data[pos]) & 0xC0) == 0x80;
+  }
+  return count;
+}
+
+// Returns the number of code points in the UTF-8 string `s`, counting every
+// byte that is not a continuation byte.
+inline size_t CountUTF8Chars(StringPiece s) {
+  return s.size() - CountUTF8TrailBytes(s);
+}
+
+// Returns true if every byte of `s` is 7-bit ASCII.
+inline bool IsAscii(StringPiece s) {
+  const char* data = s.data();
+  const size_t size = s.size();
+  size_t pos = 0;
+#if defined(__SSE2__)
+  __m128i acc = _mm_setzero_si128();
+  for (; pos + 16 <= size; pos += 16) {
+    acc = _mm_or_si128(
+        acc, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos)));
+  }
+  if (_mm_movemask_epi8(acc) != 0) return false;
+#endif
+  for (; pos < size; ++pos) {
+    if (static_cast<uint8>(data[pos]) & 0x80) return false;
+  }
+  return true;
+}
+
+}  // namespace strings
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_LIB_STRINGS_BYTE_SCAN_H_
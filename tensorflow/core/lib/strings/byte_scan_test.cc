@@ -0,0 +1,76 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/strings/byte_scan.h"
+
+#include <string>
+
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace strings {
+namespace {
+
+// Compares against std::string::find_first_of for every start position, with
+// the matches landing both inside and past the vectorized prefix.
+void CheckFindFirstOf(const std::string& s, const std::string& chars) {
+  ByteSet set(chars);
+  for (size_t pos = 0; pos <= s.size() + 1; ++pos) {
+    EXPECT_EQ(s.find_first_of(chars, pos), set.FindFirstIn(s, pos))
+        << "s=\"" << s << "\" chars=\"" << chars << "\" pos=" << pos;
+  }
+}
+
+TEST(ByteScan, FindFirstOf) {
+  const std::string s =
+      "the quick brown fox, jumps over; the lazy dog\n and\rmore:end";
+  for (const char* chars : {"", ",", "\n", ",;", ",;\n", ",;\n\r", ",;\n\r:",
+                            "xyz", "zq", "\xff"}) {
+    CheckFindFirstOf(s, chars);
+  }
+  CheckFindFirstOf("", ",");
+  CheckFindFirstOf(std::string(100, 'a') + ",", ",;");
+  CheckFindFirstOf(std::string(100, 'a') + "\xe2", ",;\xe2");
+  EXPECT_EQ(StringPiece::npos, FindFirstOf("abc", "abc", 3));
+  EXPECT_EQ(1, FindFirstOf("abcabc", "cbb"));
+}
+
+TEST(ByteScan, CountUTF8Chars) {
+  EXPECT_EQ(0, CountUTF8Chars(""));
+  EXPECT_EQ(5, CountUTF8Chars("hello"));
+  // "\xc3\xa9" is U+00E9 and "\xe2\x82\xac" is U+20AC.
+  std::string s;
+  size_t expected = 0;
+  for (int i = 0; i < 20; ++i) {
+    s += "a\xc3\xa9\xe2\x82\xac";
+    expected += 3;
+    EXPECT_EQ(expected, CountUTF8Chars(s));
+    EXPECT_EQ(s.size() - expected, CountUTF8TrailBytes(s));
+  }
+}
+
+TEST(ByteScan, IsAscii) {
+  EXPECT_TRUE(IsAscii(""));
+  EXPECT_TRUE(IsAscii(std::string(37, 'x')));
+  for (size_t i = 0; i < 37; ++i) {
+    std::string s(37, 'x');
+    s[i] = '\x80';
+    EXPECT_FALSE(IsAscii(s)) << i;
+  }
+}
+
+}  // namespace
+}  // namespace strings
+}  // namespace tensorflow
@@ -1191,6 +1191,30 @@ REGISTER_OP("Gather")
       return Status::OK();
     });
 
+// --------------------------------------------------------------------------
+REGISTER_OP("MultiGather")
+    .Input("params: N * T")
+    .Input("indices: N * Tindices")
+    .Output("output: N * T")
+    .Attr("N: int >= 1")
+    .Attr("T: type")
+    .Attr("Tindices: {int32,int64}")
+    .SetShapeFn([](InferenceContext* c) {
+      int num_tables;
+      TF_RETURN_IF_ERROR(c->GetAttr("N", &num_tables));
+      for (int i = 0; i < num_tables; ++i) {
+        ShapeHandle unused;
+        TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(i), 1, &unused));
+        ShapeHandle params_subshape;
+        TF_RETURN_IF_ERROR(c->Subshape(c->input(i), 1, &params_subshape));
+        ShapeHandle out;
+        TF_RETURN_IF_ERROR(c->Concatenate(c->input(num_tables + i),
+                                          params_subshape, &out));
+        c->set_output(i, out);
+      }
+      return Status::OK();
+    });
+
 // --------------------------------------------------------------------------
 REGISTER_OP("GatherV2")
     .Input("params: Tparams")
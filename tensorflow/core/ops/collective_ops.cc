@@ -138,6 +138,7 @@ REGISTER_OP("CollectiveReduceV2")
     .Attr("timeout_seconds: float = 0")
     .Attr("Nordering_token: int >= 0 = 0")
     .Attr("max_subdivs_per_device: int = -1")
+    .Attr("wire_format: {'native', 'bfloat16', 'float16'} = 'native'")
     .SetIsStateful()
     .SetIsDistributedCommunication()
     .SetShapeFn(shape_inference::UnchangedShape);
@@ -155,6 +155,33 @@ REGISTER_OP("ParallelDynamicStitch")
     .Attr("T : type")
     .SetShapeFn(DynamicStitchShapeFunction);
 
+REGISTER_OP("ShardedGather")
+    .Input("params: N * Tparams")
+    .Input("ids: Tindices")
+    .Output("output: Tparams")
+    .Attr("partition_strategy: string = 'mod'")
+    .Attr("N: int >= 1")
+    .Attr("Tparams: type")
+    .Attr("Tindices: {int32, int64}")
+    .SetShapeFn([](InferenceContext* c) {
+      int32_t num_shards;
+      TF_RETURN_IF_ERROR(c->GetAttr("N", &num_shards));
+      // Every shard has rank >= 1 and the same row shape.
+      ShapeHandle row_shape = c->UnknownShape();
+      for (int i = 0; i < num_shards; ++i) {
+        ShapeHandle params_shape;
+        TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(i), 1, &params_shape));
+        ShapeHandle rest;
+        TF_RETURN_IF_ERROR(c->Subshape(params_shape, 1, &rest));
+        TF_RETURN_IF_ERROR(c->Merge(row_shape, rest, &row_shape));
+      }
+      ShapeHandle output_shape;
+      TF_RETURN_IF_ERROR(
+          c->Concatenate(c->input(num_shards), row_shape, &output_shape));
+      c->set_output(0, output_shape);
+      return Status::OK();
+    });
+
 // --------------------------------------------------------------------------
 
 namespace {
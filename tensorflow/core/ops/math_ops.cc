@@ -1011,6 +1011,33 @@ _FusedConv2D output.
 expected to create these operators.
 )doc");
 
+REGISTER_OP("_FusedElementwise")
+    .Input("x: Tx")
+    .Input("args: num_args * T")
+    .Output("y: T")
+    .Attr("T: {float, double}")
+    .Attr("Tx: {half, bfloat16, float, double, int32, int64}")
+    .Attr("num_args: int >= 0")
+    .Attr("fused_ops: list(string) = []")
+    .SetShapeFn(shape_inference::UnchangedShape)
+    .Doc(R"doc(
+Performs a chain of element-wise operations in a single pass over the input.
+
+`x` is first converted to type T (if `Tx` differs from T). The series of
+operations that follows is specified by the `fused_ops` attribute, which is a
+list of TF op names specified as strings (e.g. "Relu"). They are performed in
+order, where the (first) input to each op is the output of the preceding op.
+
+Currently supported unary ops are {"Abs","Exp","Log","Neg","Relu","Relu6",
+"Rsqrt","Sigmoid","Sqrt","Square","Tanh"}, and supported binary ops are
+{"Add","AddV2","Maximum","Minimum","Mul","RealDiv","Sub"}. The second input to
+each binary op is the next tensor in `args`, which must either have the shape
+of `x` or be a scalar.
+
+*NOTE*: Do not invoke this operator directly in Python. Grappler is
+expected to create these operators.
+)doc");
+
 // --------------------------------------------------------------------------
 
 // For operations where the output is a reduction function along some
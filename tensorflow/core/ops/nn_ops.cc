@@ -329,6 +329,65 @@ REGISTER_OP("_FusedBatchNormGradEx")
     .Doc(R"doc(
 Internal FusedBatchNormGrad operation: reserved for internal use.
 
+Do not invoke this operator directly in Python. A fusion optimization is
+expected to create these operators.
+)doc");
+
+REGISTER_OP("_FusedLayerNorm")
+    .Input("x: T")
+    .Input("scale: T")
+    .Input("offset: T")
+    .Output("y: T")
+    .Attr("T: {float}")
+    .Attr("epsilon: float = 0.001")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle x;
+      TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(0), 1, &x));
+      DimensionHandle depth = c->Dim(x, -1);
+      for (int i = 1; i < 3; ++i) {
+        ShapeHandle vec;
+        TF_RETURN_IF_ERROR(c->WithRank(c->input(i), 1, &vec));
+        TF_RETURN_IF_ERROR(c->Merge(depth, c->Dim(vec, 0), &depth));
+      }
+      TF_RETURN_IF_ERROR(c->ReplaceDim(x, -1, depth, &x));
+      c->set_output(0, x);
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Normalizes `x` over its innermost dimension, then scales and shifts it:
+  y = (x - mean(x)) * rsqrt(variance(x) + epsilon) * scale + offset
+
+Do not invoke this operator directly in Python. A fusion optimization is
+expected to create these operators.
+)doc");
+
+REGISTER_OP("_FusedAttention")
+    .Input("query: T")
+    .Input("key: T")
+    .Input("value: T")
+    .Input("args: num_args * T")
+    .Output("y: T")
+    .Attr("T: {float}")
+    .Attr("scale: float = 1.0")
+    .Attr("num_args: int >= 0 = 0")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle query;
+      TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(0), 3, &query));
+      ShapeHandle value;
+      TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(2), 3, &value));
+      ShapeHandle y;
+      TF_RETURN_IF_ERROR(c->ReplaceDim(query, -1, c->Dim(value, -1), &y));
+      c->set_output(0, y);
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Computes scaled dot-product attention on the innermost two dimensions:
+  y = Softmax(BatchMatMul(query, key, adj_y=true) * scale + mask) * value
+
+`args` is either empty or holds the `mask`, which has the rank of the scores
+and may broadcast along any of their dimensions. The batch dimensions of
+`query`, `key` and `value` must be equal.
+
 Do not invoke this operator directly in Python. A fusion optimization is
 expected to create these operators.
 )doc");
@@ -3146,8 +3205,9 @@ REGISTER_OP("QuantizedMatMulWithBiasAndDequantize")
       TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 1, &unused));
       TF_RETURN_IF_ERROR(c->WithRank(c->input(3), 0, &unused));
       TF_RETURN_IF_ERROR(c->WithRank(c->input(4), 0, &unused));
-      TF_RETURN_IF_ERROR(c->WithRank(c->input(5), 0, &unused));
-      TF_RETURN_IF_ERROR(c->WithRank(c->input(6), 0, &unused));
+      // The weight range may be given per output channel.
+      TF_RETURN_IF_ERROR(c->WithRankAtMost(c->input(5), 1, &unused));
+      TF_RETURN_IF_ERROR(c->WithRankAtMost(c->input(6), 1, &unused));
       TF_RETURN_IF_ERROR(c->WithRank(c->input(7), 0, &unused));
       TF_RETURN_IF_ERROR(c->WithRank(c->input(8), 0, &unused));
 
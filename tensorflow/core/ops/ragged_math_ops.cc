@@ -23,6 +23,8 @@ using shape_inference::InferenceContext;
 using shape_inference::ShapeHandle;
 
 Status RaggedRangeShapeFn(InferenceContext* c);
+Status RaggedReduceShapeFn(InferenceContext* c);
+Status RaggedMatMulShapeFn(InferenceContext* c);
 
 //==============================================================================
 // Registered Ops
@@ -38,6 +40,24 @@ REGISTER_OP("RaggedRange")
     .Attr("Tsplits: {int32, int64} = DT_INT64")
     .SetShapeFn(RaggedRangeShapeFn);
 
+REGISTER_OP("RaggedReduce")
+    .Input("values: T")
+    .Input("row_splits: Tsplits")
+    .Output("output: T")
+    .Attr("T: {bfloat16, half, float, double, int32, int64}")
+    .Attr("Tsplits: {int32, int64} = DT_INT64")
+    .Attr("reduction: {'sum', 'mean', 'max', 'min', 'prod'}")
+    .SetShapeFn(RaggedReduceShapeFn);
+
+REGISTER_OP("RaggedMatMul")
+    .Input("values: T")
+    .Input("row_splits: Tsplits")
+    .Input("weights: T")
+    .Output("output: T")
+    .Attr("T: {bfloat16, half, float, double}")
+    .Attr("Tsplits: {int32, int64} = DT_INT64")
+    .SetShapeFn(RaggedMatMulShapeFn);
+
 //==============================================================================
 // Shape Functions
 //==============================================================================
@@ -78,4 +98,34 @@ Status RaggedRangeShapeFn(InferenceContext* c) {
   return Status::OK();
 }
 
+Status RaggedReduceShapeFn(InferenceContext* c) {
+  ShapeHandle values;
+  ShapeHandle row_splits;
+  TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(0), 1, &values));
+  TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &row_splits));
+  DimensionHandle num_rows;
+  TF_RETURN_IF_ERROR(c->Subtract(c->Dim(row_splits, 0), 1, &num_rows));
+  ShapeHandle output;
+  TF_RETURN_IF_ERROR(c->ReplaceDim(values, 0, num_rows, &output));
+  c->set_output(0, output);
+  return Status::OK();
+}
+
+Status RaggedMatMulShapeFn(InferenceContext* c) {
+  ShapeHandle values;
+  ShapeHandle row_splits;
+  ShapeHandle weights;
+  TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 2, &values));
+  TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &row_splits));
+  TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 3, &weights));
+  DimensionHandle unused;
+  TF_RETURN_IF_ERROR(
+      c->Merge(c->Dim(values, 1), c->Dim(weights, 1), &unused));
+  DimensionHandle batch_size;
+  TF_RETURN_IF_ERROR(c->Subtract(c->Dim(row_splits, 0), 1, &batch_size));
+  TF_RETURN_IF_ERROR(c->Merge(batch_size, c->Dim(weights, 0), &unused));
+  c->set_output(0, c->Matrix(c->Dim(values, 0), c->Dim(weights, 2)));
+  return Status::OK();
+}
+
 }  // namespace tensorflow
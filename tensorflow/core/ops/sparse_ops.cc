@@ -119,6 +119,32 @@ REGISTER_OP("SparseTensorDenseMatMul")
       return Status::OK();
     });
 
+REGISTER_OP("BlockSparseDenseMatMul")
+    .Input("a_block_row_splits: Tindices")
+    .Input("a_block_col_indices: Tindices")
+    .Input("a_block_values: T")
+    .Input("a_shape: int64")
+    .Input("b: T")
+    .Output("product: T")
+    .Attr("T: {float, double}")
+    .Attr("Tindices: {int32,int64} = DT_INT64")
+    .SetShapeFn([](InferenceContext* c) {
+      DimensionHandle unused_dim;
+      ShapeHandle unused;
+      ShapeHandle b;
+      ShapeHandle a_shape;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 1, &unused));  // row_splits
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &unused));  // col_indices
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 3, &unused));  // values
+      TF_RETURN_IF_ERROR(c->MakeShapeFromShapeTensor(3, &a_shape));
+      TF_RETURN_IF_ERROR(c->WithRank(a_shape, 2, &a_shape));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(4), 2, &b));
+      TF_RETURN_IF_ERROR(
+          c->Merge(c->Dim(a_shape, 1), c->Dim(b, 0), &unused_dim));
+      c->set_output(0, c->Matrix(c->Dim(a_shape, 0), c->Dim(b, 1)));
+      return Status::OK();
+    });
+
 REGISTER_OP("SerializeSparse")
     .Input("sparse_indices: int64")
     .Input("sparse_values: T")
@@ -115,6 +115,28 @@ REGISTER_OP("StatelessRandomGetKeyCounterAlg")
       return Status::OK();
     });
 
+REGISTER_OP("StatelessDropout")
+    .Input("x: T")
+    .Input("rate: T")
+    .Input("key: uint64")
+    .Input("counter: uint64")
+    .Input("alg: int32")
+    .Output("y: T")
+    .Attr("T: {half, bfloat16, float, double}")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 0, &unused));
+      ShapeHandle key;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 1, &key));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(3), 1, &unused));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(4), 0, &unused));
+      DimensionHandle unused_dim;
+      TF_RETURN_IF_ERROR(
+          c->WithValue(c->Dim(key, 0), RNG_KEY_SIZE, &unused_dim));
+      c->set_output(0, c->input(0));
+      return Status::OK();
+    });
+
 REGISTER_OP("StatelessRandomGetKeyCounter")
     .Input("seed: Tseed")
     .Output("key: uint64")
@@ -1173,4 +1173,92 @@ REGISTER_OP("ResourceApplyPowerSign")
     .Attr("use_locking: bool = false")
     .SetShapeFn(ApplyPowerSignShapeFn</*is_resource=*/true>);
 
+// The multi-variable apply ops take `num_slots` lists of N resource variables,
+// then `num_scalars` scalar hyperparameters, then N gradients.
+static Status MultiApplyShapeFn(InferenceContext* c, int num_slots,
+                                int num_scalars) {
+  int n;
+  TF_RETURN_IF_ERROR(c->GetAttr("N", &n));
+  ShapeHandle unused;
+  for (int i = 0; i < num_scalars; ++i) {
+    TF_RETURN_IF_ERROR(c->WithRank(c->input(num_slots * n + i), 0, &unused));
+  }
+  for (int i = 0; i < n; ++i) {
+    ShapeHandle s = ShapeOrHandleShape</*is_resource=*/true>(c, i);  // var
+    for (int slot = 1; slot < num_slots; ++slot) {
+      TF_RETURN_IF_ERROR(c->Merge(
+          s, ShapeOrHandleShape</*is_resource=*/true>(c, slot * n + i), &s));
+    }
+    TF_RETURN_IF_ERROR(
+        c->Merge(s, c->input(num_slots * n + num_scalars + i), &s));  // grad
+  }
+  return Status::OK();
+}
+
+REGISTER_OP("ResourceMultiApplyAdam")
+    .Input("var: N * resource")
+    .Input("m: N * resource")
+    .Input("v: N * resource")
+    .Input("beta1_power: T")
+    .Input("beta2_power: T")
+    .Input("lr: T")
+    .Input("beta1: T")
+    .Input("beta2: T")
+    .Input("epsilon: T")
+    .Input("grad: N * T")
+    .Attr("N: int >= 1")
+    .Attr("T: {float, double}")
+    .Attr("use_locking: bool = false")
+    .Attr("use_nesterov: bool = false")
+    .SetShapeFn([](InferenceContext* c) {
+      return MultiApplyShapeFn(c, /*num_slots=*/3, /*num_scalars=*/6);
+    });
+
+REGISTER_OP("ResourceMultiApplyAdagrad")
+    .Input("var: N * resource")
+    .Input("accum: N * resource")
+    .Input("lr: T")
+    .Input("epsilon: T")
+    .Input("grad: N * T")
+    .Attr("N: int >= 1")
+    .Attr("T: {float, double}")
+    .Attr("use_locking: bool = false")
+    .Attr("update_slots: bool = true")
+    .SetShapeFn([](InferenceContext* c) {
+      return MultiApplyShapeFn(c, /*num_slots=*/2, /*num_scalars=*/2);
+    });
+
+REGISTER_OP("ResourceMultiApplyMomentum")
+    .Input("var: N * resource")
+    .Input("accum: N * resource")
+    .Input("lr: T")
+    .Input("momentum: T")
+    .Input("grad: N * T")
+    .Attr("N: int >= 1")
+    .Attr("T: {float, double}")
+    .Attr("use_locking: bool = false")
+    .Attr("use_nesterov: bool = false")
+    .SetShapeFn([](InferenceContext* c) {
+      return MultiApplyShapeFn(c, /*num_slots=*/2, /*num_scalars=*/2);
+    });
+
+REGISTER_OP("ResourceMultiApplyLamb")
+    .Input("var: N * resource")
+    .Input("m: N * resource")
+    .Input("v: N * resource")
+    .Input("beta1_power: T")
+    .Input("beta2_power: T")
+    .Input("lr: T")
+    .Input("beta1: T")
+    .Input("beta2: T")
+    .Input("epsilon: T")
+    .Input("weight_decay: T")
+    .Input("grad: N * T")
+    .Attr("N: int >= 1")
+    .Attr("T: {float, double}")
+    .Attr("use_locking: bool = false")
+    .SetShapeFn([](InferenceContext* c) {
+      return MultiApplyShapeFn(c, /*num_slots=*/3, /*num_scalars=*/7);
+    });
+
 }  // namespace tensorflow
@@ -19,6 +19,7 @@ limitations under the License.
 #include <unistd.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -32,7 +33,9 @@ limitations under the License.
 #endif
 #include "absl/base/macros.h"
 #include "json/json.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/cloud/curl_http_request.h"
 #include "tensorflow/core/platform/cloud/file_block_cache.h"
 #include "tensorflow/core/platform/cloud/google_auth_provider.h"
@@ -65,6 +68,11 @@ constexpr char kGcsUploadUriBase[] =
 constexpr char kStorageHost[] = "storage.googleapis.com";
 constexpr char kBucketMetadataLocationKey[] = "location";
 constexpr size_t kReadAppendableFileBufferSize = 1024 * 1024;  // In bytes.
+constexpr size_t kCopyBufferSize = 1024 * 1024;                 // In bytes.
+// The maximum number of objects GCS composes in a single request.
+constexpr int kMaxComposeSources = 32;
+// The maximum number of concurrent ranged requests of a single ReadV().
+constexpr int kMaxConcurrentRangeReads = 8;
 constexpr int kGetChildrenDefaultPageSize = 1000;
 // The HTTP response code "308 Resume Incomplete".
 constexpr uint64 HTTP_CODE_RESUME_INCOMPLETE = 308;
@@ -146,6 +154,20 @@ constexpr char kAppendMode[] = "GCS_APPEND_MODE";
 // objects.
 constexpr char kComposeAppend[] = "compose";
 
+// The environment variable that enables parallel composite uploads of files of
+// at least this size (in MB). Each file is uploaded as several temporary
+// objects in parallel, which are then composed into the destination object.
+// This is disabled by default as a failed upload may strand temporary objects.
+constexpr char kParallelUploadMinSize[] = "GCS_PARALLEL_UPLOAD_MIN_SIZE_MB";
+// The environment variable that overrides the number of parts of a parallel
+// composite upload (at most 32).
+constexpr char kParallelUploadParts[] = "GCS_PARALLEL_UPLOAD_PARTS";
+constexpr int kDefaultParallelUploadParts = 8;
+// The environment variable that overrides the maximum number of blocks fetched
+// concurrently by a read spanning several blocks of the block cache.
+constexpr char kMaxParallelBlockFetches[] =
+    "GCS_READ_CACHE_MAX_PARALLEL_FETCHES";
+
 Status GetTmpFilename(string* filename) {
   *filename = io::GetTempFilename("");
   return Status::OK();
@@ -283,6 +305,36 @@ class GcsRandomAccessFile : public RandomAccessFile {
     return read_fn_(filename_, offset, n, result, scratch);
   }
 
+  /// Issues the ranged reads of up to kMaxConcurrentRangeReads requests at a
+  /// time. Thread safe.
+  Status ReadV(std::vector<ReadRequest>* requests) const override {
+    const int num_requests = requests->size();
+    std::atomic<int> next_request(0);
+    auto read_requests = [&]() {
+      for (int i = next_request++; i < num_requests; i = next_request++) {
+        ReadRequest& request = (*requests)[i];
+        request.status = read_fn_(filename_, request.offset, request.n,
+                                  &request.result, request.scratch);
+      }
+    };
+    const int num_helpers =
+        std::min(num_requests, kMaxConcurrentRangeReads) - 1;
+    BlockingCounter helpers_done(std::max(num_helpers, 0));
+    for (int i = 0; i < num_helpers; ++i) {
+      Env::Default()->SchedClosure([&read_requests, &helpers_done]() {
+        read_requests();
+        helpers_done.DecrementCount();
+      });
+    }
+    read_requests();
+    helpers_done.Wait();
+    Status status;
+    for (const ReadRequest& request : *requests) {
+      status.Update(request.status);
+    }
+    return status;
+  }
+
  private:
   /// The filename of this file.
   const string filename_;
@@ -567,35 +619,20 @@ class GcsWritableFile : public WritableFile {
                             io::Basename(object_), ".", start_offset_);
       }
     }
-    TF_RETURN_IF_ERROR(CreateNewUploadSession(start_offset, object_to_upload,
-                                              &session_handle));
-    uint64 already_uploaded = 0;
-    bool first_attempt = true;
-    const Status upload_status = RetryingUtils::CallWithRetries(
-        [&first_attempt, &already_uploaded, &session_handle, &start_offset,
-         this]() {
-          if (session_handle.resumable && !first_attempt) {
-            bool completed;
-            TF_RETURN_IF_ERROR(RequestUploadSessionStatus(
-                session_handle.session_uri, &completed, &already_uploaded));
-            LOG(INFO) << "### RequestUploadSessionStatus: completed = "
-                      << completed
-                      << ", already_uploaded = " << already_uploaded
-                      << ", file = " << GetGcsPath();
-            if (completed) {
-              // Erase the file from the file cache on every successful write.
-              file_cache_erase_();
-              // It's unclear why UploadToSession didn't return OK in the
-              // previous attempt, but GCS reports that the file is fully
-              // uploaded, so succeed.
-              return Status::OK();
-            }
-          }
-          first_attempt = false;
-          return UploadToSession(session_handle.session_uri, start_offset,
-                                 already_uploaded);
-        },
-        retry_config_);
+    uint64 file_size;
+    TF_RETURN_IF_ERROR(GetCurrentFileSize(&file_size));
+    const GcsFileSystem::ParallelUploadConfig parallel_upload =
+        filesystem_->parallel_upload_config();
+    Status upload_status;
+    if (!should_compose && parallel_upload.num_parts > 1 && file_size > 0 &&
+        file_size >= parallel_upload.min_file_size) {
+      upload_status = ParallelUpload(parallel_upload, file_size);
+    } else {
+      TF_RETURN_IF_ERROR(CreateNewUploadSession(
+          start_offset, object_to_upload, file_size, &session_handle));
+      upload_status = UploadWithRetries(session_handle, tmp_content_filename_,
+                                        start_offset, file_size);
+    }
     if (upload_status.code() == errors::Code::NOT_FOUND) {
       // GCS docs recommend retrying the whole upload. We're relying on the
       // RetryingFileSystem to retry the Sync() call.
@@ -632,14 +669,176 @@ class GcsWritableFile : public WritableFile {
 
   /// Initiates a new resumable upload session.
   Status CreateNewUploadSession(uint64 start_offset,
-                                std::string object_to_upload,
+                                std::string object_to_upload, uint64 file_size,
                                 UploadSessionHandle* session_handle) {
-    uint64 file_size;
-    TF_RETURN_IF_ERROR(GetCurrentFileSize(&file_size));
     return session_creator_(start_offset, object_to_upload, bucket_, file_size,
                             GetGcsPath(), session_handle);
   }
 
+  /// Uploads the content of `content_filename` from `start_offset` to
+  /// `file_size` to the session, resuming failed uploads.
+  Status UploadWithRetries(const UploadSessionHandle& session_handle,
+                           const string& content_filename, uint64 start_offset,
+                           uint64 file_size) {
+    uint64 already_uploaded = 0;
+    bool first_attempt = true;
+    return RetryingUtils::CallWithRetries(
+        [&first_attempt, &already_uploaded, &session_handle, &content_filename,
+         start_offset, file_size, this]() {
+          if (session_handle.resumable && !first_attempt) {
+            bool completed;
+            TF_RETURN_IF_ERROR(RequestUploadSessionStatus(
+                session_handle.session_uri, file_size, &completed,
+                &already_uploaded));
+            LOG(INFO) << "### RequestUploadSessionStatus: completed = "
+                      << completed
+                      << ", already_uploaded = " << already_uploaded
+                      << ", file = " << GetGcsPath();
+            if (completed) {
+              // Erase the file from the file cache on every successful write.
+              file_cache_erase_();
+              // It's unclear why UploadToSession didn't return OK in the
+              // previous attempt, but GCS reports that the file is fully
+              // uploaded, so succeed.
+              return Status::OK();
+            }
+          }
+          first_attempt = false;
+          return UploadToSession(session_handle.session_uri, content_filename,
+                                 start_offset, already_uploaded, file_size);
+        },
+        retry_config_);
+  }
+
+  /// \brief Uploads the file as parts, then composes them into the object.
+  ///
+  /// The parts are uploaded concurrently as temporary objects, which are
+  /// deleted once composed, or if any part fails to upload.
+  Status ParallelUpload(const GcsFileSystem::ParallelUploadConfig& config,
+                        uint64 file_size) {
+    const int max_parts = std::min(config.num_parts, kMaxComposeSources);
+    const uint64 part_size = (file_size + max_parts - 1) / max_parts;
+    std::vector<string> part_objects;
+    for (uint64 offset = 0; offset < file_size; offset += part_size) {
+      part_objects.push_back(strings::StrCat(
+          io::Dirname(object_), "/.tmpparallel/", io::Basename(object_), ".",
+          part_objects.size()));
+    }
+    VLOG(3) << "ParallelUpload: " << GetGcsPath() << " as "
+            << part_objects.size() << " parts";
+    const int num_parts = part_objects.size();
+    std::vector<Status> part_statuses(num_parts);
+    std::atomic<int> next_part(0);
+    auto upload_parts = [&]() {
+      for (int i = next_part++; i < num_parts; i = next_part++) {
+        const uint64 offset = i * part_size;
+        part_statuses[i] =
+            UploadPart(part_objects[i], offset,
+                       std::min<uint64>(part_size, file_size - offset));
+      }
+    };
+    const int num_threads =
+        config.max_concurrent_uploads > 0
+            ? std::min(config.max_concurrent_uploads, num_parts)
+            : num_parts;
+    BlockingCounter helpers_done(num_threads - 1);
+    for (int i = 1; i < num_threads; ++i) {
+      Env::Default()->SchedClosure([&upload_parts, &helpers_done]() {
+        upload_parts();
+        helpers_done.DecrementCount();
+      });
+    }
+    upload_parts();
+    helpers_done.Wait();
+
+    Status status;
+    for (const Status& part_status : part_statuses) {
+      status.Update(part_status);
+    }
+    if (status.ok()) {
+      status = ComposeObjects(part_objects);
+    }
+    for (const string& part_object : part_objects) {
+      const string part_path = GetGcsPathWithObject(part_object);
+      Status delete_status = RetryingUtils::DeleteWithRetries(
+          [&part_path, this]() {
+            return filesystem_->DeleteFile(part_path, nullptr);
+          },
+          retry_config_);
+      if (!delete_status.ok() && !errors::IsNotFound(delete_status)) {
+        LOG(WARNING) << "Could not delete the temporary object " << part_path
+                     << ": " << delete_status;
+      }
+    }
+    if (status.ok()) {
+      file_cache_erase_();
+    }
+    return status;
+  }
+
+  /// Uploads `size` bytes of the file from `offset` on to `part_object`.
+  Status UploadPart(const string& part_object, uint64 offset, uint64 size) {
+    // Uploads send whole files, so copy the part to its own temporary file.
+    string part_filename;
+    TF_RETURN_IF_ERROR(GetTmpFilename(&part_filename));
+    auto remove_part_file = gtl::MakeCleanup(
+        [&part_filename]() { std::remove(part_filename.c_str()); });
+    TF_RETURN_IF_ERROR(CopyFileRange(offset, size, part_filename));
+    UploadSessionHandle session_handle;
+    TF_RETURN_IF_ERROR(
+        CreateNewUploadSession(0, part_object, size, &session_handle));
+    return UploadWithRetries(session_handle, part_filename, 0, size);
+  }
+
+  /// Copies `size` bytes of the internal temporary file from `offset` on to a
+  /// new file `filename`.
+  Status CopyFileRange(uint64 offset, uint64 size, const string& filename) {
+    std::ifstream in(tmp_content_filename_, std::ifstream::binary);
+    std::ofstream out(filename, std::ofstream::binary);
+    in.seekg(offset);
+    std::vector<char> buffer(std::min<uint64>(size, kCopyBufferSize));
+    for (uint64 copied = 0; copied < size && in.good() && out.good();) {
+      const uint64 n = std::min<uint64>(buffer.size(), size - copied);
+      in.read(buffer.data(), n);
+      out.write(buffer.data(), in.gcount());
+      copied += in.gcount();
+    }
+    out.flush();
+    if (!in.good() || !out.good()) {
+      return errors::Internal("Could not copy part of the internal temporary "
+                              "file for a parallel upload.");
+    }
+    return Status::OK();
+  }
+
+  /// Composes `source_objects`, in order, into the object.
+  Status ComposeObjects(const std::vector<string>& source_objects) {
+    VLOG(3) << "ComposeObjects: " << source_objects.size() << " objects to "
+            << GetGcsPath();
+    std::vector<string> sources;
+    for (const string& source_object : source_objects) {
+      sources.push_back(strings::StrCat("{'name': '", source_object, "'}"));
+    }
+    const string request_body = strings::StrCat(
+        "{'sourceObjects': [", absl::StrJoin(sources, ","), "]}");
+    return RetryingUtils::CallWithRetries(
+        [&request_body, this]() {
+          std::unique_ptr<HttpRequest> request;
+          TF_RETURN_IF_ERROR(filesystem_->CreateHttpRequest(&request));
+          request->SetUri(strings::StrCat(kGcsUriBase, "b/", bucket_, "/o/",
+                                          request->EscapeString(object_),
+                                          "/compose"));
+          request->SetTimeouts(timeouts_->connect, timeouts_->idle,
+                               timeouts_->metadata);
+          request->AddHeader("content-type", "application/json");
+          request->SetPostFromBuffer(request_body.c_str(), request_body.size());
+          TF_RETURN_WITH_CONTEXT_IF_ERROR(request->Send(),
+                                          " when composing to ", GetGcsPath());
+          return Status::OK();
+        },
+        retry_config_);
+  }
+
   /// Appends the data of append_object to the original object and deletes
   /// append_object.
   Status AppendObject(string append_object) {
@@ -685,22 +884,20 @@ class GcsWritableFile : public WritableFile {
   /// If the upload has already succeeded, sets 'completed' to true.
   /// Otherwise sets 'completed' to false and 'uploaded' to the currently
   /// uploaded size in bytes.
-  Status RequestUploadSessionStatus(const string& session_uri, bool* completed,
+  Status RequestUploadSessionStatus(const string& session_uri,
+                                    uint64 file_size, bool* completed,
                                     uint64* uploaded) {
-    uint64 file_size;
-    TF_RETURN_IF_ERROR(GetCurrentFileSize(&file_size));
     return status_poller_(session_uri, file_size, GetGcsPath(), completed,
                           uploaded);
   }
 
   /// Uploads data to object.
-  Status UploadToSession(const string& session_uri, uint64 start_offset,
-                         uint64 already_uploaded) {
-    uint64 file_size;
-    TF_RETURN_IF_ERROR(GetCurrentFileSize(&file_size));
+  Status UploadToSession(const string& session_uri,
+                         const string& content_filename, uint64 start_offset,
+                         uint64 already_uploaded, uint64 file_size) {
     Status status =
         object_uploader_(session_uri, start_offset, already_uploaded,
-                         tmp_content_filename_, file_size, GetGcsPath());
+                         content_filename, file_size, GetGcsPath());
     if (status.ok()) {
       // Erase the file from the file cache on every successful write.
       // Note: Only local cache, this does nothing on distributed cache. The
@@ -800,6 +997,10 @@ GcsFileSystem::GcsFileSystem(bool make_default_cache) {
   if (GetEnvVar(kMaxStaleness, strings::safe_strtou64, &value)) {
     max_staleness = value;
   }
+
+  if (GetEnvVar(kMaxParallelBlockFetches, strings::safe_strtou64, &value)) {
+    max_parallel_block_fetches_ = value;
+  }
   if (!make_default_cache) {
     max_bytes = 0;
   }
@@ -926,6 +1127,15 @@ GcsFileSystem::GcsFileSystem(bool make_default_cache) {
   } else {
     compose_append_ = false;
   }
+
+  if (GetEnvVar(kParallelUploadMinSize, strings::safe_strtou64, &value)) {
+    parallel_upload_.min_file_size = value * 1024 * 1024;
+    parallel_upload_.num_parts = kDefaultParallelUploadParts;
+    if (GetEnvVar(kParallelUploadParts, strings::safe_strtou64, &value)) {
+      parallel_upload_.num_parts =
+          std::min<uint64>(value, kMaxComposeSources);
+    }
+  }
 }
 
 GcsFileSystem::GcsFileSystem(
@@ -955,6 +1165,17 @@ GcsFileSystem::GcsFileSystem(
       compose_append_(compose_append),
       additional_header_(additional_header) {}
 
+void GcsFileSystem::SetParallelUploadConfig(
+    const ParallelUploadConfig& config) {
+  mutex_lock l(mu_);
+  parallel_upload_ = config;
+}
+
+GcsFileSystem::ParallelUploadConfig GcsFileSystem::parallel_upload_config() {
+  tf_shared_lock l(mu_);
+  return parallel_upload_;
+}
+
 Status GcsFileSystem::NewRandomAccessFile(
     const string& fname, TransactionToken* token,
     std::unique_ptr<RandomAccessFile>* result) {
@@ -1033,7 +1254,8 @@ std::unique_ptr<FileBlockCache> GcsFileSystem::MakeFileBlockCache(
              size_t* bytes_transferred) {
         return LoadBufferFromGCS(filename, offset, n, buffer,
                                  bytes_transferred);
-      }));
+      },
+      Env::Default(), max_parallel_block_fetches_));
 
   // Check if cache is enabled here to avoid unnecessary mutex contention.
   cache_enabled_ = file_block_cache->IsCacheEnabled();
@@ -215,6 +215,9 @@ class GcsFileSystem : public FileSystem {
   }
 
   bool compose_append() const { return compose_append_; }
+  size_t max_parallel_block_fetches() const {
+    return max_parallel_block_fetches_;
+  }
   string additional_header_name() const {
     return additional_header_ ? additional_header_->first : "";
   }
@@ -267,6 +270,22 @@ class GcsFileSystem : public FileSystem {
           write(write) {}
   };
 
+  /// Structure containing the configuration of parallel composite uploads.
+  ///
+  /// Files of at least `min_file_size` bytes are uploaded as up to `num_parts`
+  /// temporary objects, `max_concurrent_uploads` at a time (all of them if 0),
+  /// which are then composed into the destination object. Parallel uploads are
+  /// disabled if `num_parts` is less than 2.
+  struct ParallelUploadConfig {
+    uint64 min_file_size = 0;
+    int num_parts = 0;
+    int max_concurrent_uploads = 0;
+  };
+
+  /// Sets the configuration of the uploads of subsequently synced files.
+  void SetParallelUploadConfig(const ParallelUploadConfig& config);
+  ParallelUploadConfig parallel_upload_config();
+
   Status CreateHttpRequest(std::unique_ptr<HttpRequest>* request);
 
   /// \brief Sets a new AuthProvider on the GCS FileSystem.
@@ -415,6 +434,10 @@ class GcsFileSystem : public FileSystem {
   // Reads smaller than block_size_ will trigger a read of block_size_.
   uint64 block_size_;
 
+  // The maximum number of blocks fetched concurrently by a single read. Must be
+  // declared before file_block_cache_, which is created with it.
+  size_t max_parallel_block_fetches_ = 1;
+
   // block_cache_lock_ protects the file_block_cache_ pointer (Note that
   // FileBlockCache instances are themselves threadsafe).
   mutex block_cache_lock_;
@@ -435,6 +458,7 @@ class GcsFileSystem : public FileSystem {
   std::unique_ptr<BucketLocationCache> bucket_location_cache_;
   std::unordered_set<string> allowed_locations_;
   bool compose_append_;
+  ParallelUploadConfig parallel_upload_ TF_GUARDED_BY(mu_);
 
   GcsStatsInterface* stats_ = nullptr;  // Not owned.
 
@@ -1004,6 +1004,87 @@ TEST(GcsFileSystemTest, NewWritableFile) {
   TF_EXPECT_OK(wfile->Close());
 }
 
+TEST(GcsFileSystemTest, NewWritableFile_ParallelUpload) {
+  std::vector<HttpRequest*> requests(
+      {new FakeHttpRequest(
+           "Uri: https://www.googleapis.com/upload/storage/v1/b/bucket/o?"
+           "uploadType=resumable&name=path%2F.tmpparallel%2Fwriteable.0\n"
+           "Auth Token: fake_token\n"
+           "Header X-Upload-Content-Length: 9\n"
+           "Post: yes\n"
+           "Timeouts: 5 1 10\n",
+           "", {{"Location", "https://custom/upload/location0"}}),
+       new FakeHttpRequest("Uri: https://custom/upload/location0\n"
+                           "Auth Token: fake_token\n"
+                           "Header Content-Range: bytes 0-8/9\n"
+                           "Timeouts: 5 1 30\n"
+                           "Put body: content1,\n",
+                           ""),
+       new FakeHttpRequest(
+           "Uri: https://www.googleapis.com/upload/storage/v1/b/bucket/o?"
+           "uploadType=resumable&name=path%2F.tmpparallel%2Fwriteable.1\n"
+           "Auth Token: fake_token\n"
+           "Header X-Upload-Content-Length: 8\n"
+           "Post: yes\n"
+           "Timeouts: 5 1 10\n",
+           "", {{"Location", "https://custom/upload/location1"}}),
+       new FakeHttpRequest("Uri: https://custom/upload/location1\n"
+                           "Auth Token: fake_token\n"
+                           "Header Content-Range: bytes 0-7/8\n"
+                           "Timeouts: 5 1 30\n"
+                           "Put body: content2\n",
+                           ""),
+       // Compose the parts into the object.
+       new FakeHttpRequest("Uri: "
+                           "https://www.googleapis.com/storage/v1/b/bucket/o/"
+                           "path%2Fwriteable/compose\n"
+                           "Auth Token: fake_token\n"
+                           "Timeouts: 5 1 10\n"
+                           "Header content-type: application/json\n"
+                           "Post body: {'sourceObjects': [{'name': "
+                           "'path/.tmpparallel/writeable.0'},{'name': "
+                           "'path/.tmpparallel/writeable.1'}]}\n",
+                           ""),
+       // Delete the temporary objects.
+       new FakeHttpRequest("Uri: "
+                           "https://www.googleapis.com/storage/v1/b/bucket/o/"
+                           "path%2F.tmpparallel%2Fwriteable.0\n"
+                           "Auth Token: fake_token\n"
+                           "Timeouts: 5 1 10\n"
+                           "Delete: yes\n",
+                           ""),
+       new FakeHttpRequest("Uri: "
+                           "https://www.googleapis.com/storage/v1/b/bucket/o/"
+                           "path%2F.tmpparallel%2Fwriteable.1\n"
+                           "Auth Token: fake_token\n"
+                           "Timeouts: 5 1 10\n"
+                           "Delete: yes\n",
+                           "")});
+  GcsFileSystem fs(
+      std::unique_ptr<AuthProvider>(new FakeAuthProvider),
+      std::unique_ptr<HttpRequest::Factory>(
+          new FakeHttpRequestFactory(&requests)),
+      std::unique_ptr<ZoneProvider>(new FakeZoneProvider), 8 /* block size */,
+      8 /* max bytes */, 0 /* max staleness */, 3600 /* stat cache max age */,
+      0 /* stat cache max entries */, 0 /* matching paths cache max age */,
+      0 /* matching paths cache max entries */, kTestRetryConfig,
+      kTestTimeoutConfig, *kAllowedLocationsDefault,
+      nullptr /* gcs additional header */, false /* compose append */);
+  GcsFileSystem::ParallelUploadConfig parallel_upload;
+  parallel_upload.min_file_size = 16;
+  parallel_upload.num_parts = 2;
+  // Upload the parts one at a time, in the order of the expected requests.
+  parallel_upload.max_concurrent_uploads = 1;
+  fs.SetParallelUploadConfig(parallel_upload);
+
+  std::unique_ptr<WritableFile> wfile;
+  TF_EXPECT_OK(
+      fs.NewWritableFile("gs://bucket/path/writeable", nullptr, &wfile));
+  TF_EXPECT_OK(wfile->Append("content1,"));
+  TF_EXPECT_OK(wfile->Append("content2"));
+  TF_EXPECT_OK(wfile->Close());
+}
+
 TEST(GcsFileSystemTest, NewWritableFile_ResumeUploadSucceeds) {
   std::vector<HttpRequest*> requests(
       {new FakeHttpRequest(
@@ -3696,6 +3777,28 @@ TEST(GcsFileSystemTest, OverrideCacheParameters) {
   EXPECT_EQ(40, fs5.timeouts().write);
 }
 
+TEST(GcsFileSystemTest, OverrideParallelTransferParameters) {
+  GcsFileSystem fs1;
+  EXPECT_EQ(1, fs1.max_parallel_block_fetches());
+  EXPECT_EQ(0, fs1.parallel_upload_config().num_parts);
+
+  setenv("GCS_READ_CACHE_MAX_PARALLEL_FETCHES", "4", 1);
+  setenv("GCS_PARALLEL_UPLOAD_MIN_SIZE_MB", "64", 1);
+  GcsFileSystem fs2;
+  EXPECT_EQ(4, fs2.max_parallel_block_fetches());
+  EXPECT_EQ(64 * 1024 * 1024, fs2.parallel_upload_config().min_file_size);
+  EXPECT_EQ(8, fs2.parallel_upload_config().num_parts);
+
+  // Parallel uploads compose at most 32 parts.
+  setenv("GCS_PARALLEL_UPLOAD_PARTS", "64", 1);
+  GcsFileSystem fs3;
+  EXPECT_EQ(32, fs3.parallel_upload_config().num_parts);
+
+  unsetenv("GCS_READ_CACHE_MAX_PARALLEL_FETCHES");
+  unsetenv("GCS_PARALLEL_UPLOAD_MIN_SIZE_MB");
+  unsetenv("GCS_PARALLEL_UPLOAD_PARTS");
+}
+
 TEST(GcsFileSystemTest, CreateHttpRequest) {
   std::vector<HttpRequest*> requests(
       {// IsDirectory is checking whether there are children objects.
@@ -14,9 +14,11 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/core/platform/cloud/ram_file_block_cache.h"
+#include <atomic>
 #include <cstring>
 #include <memory>
 #include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/env.h"
 
 namespace tensorflow {
@@ -182,6 +184,38 @@ Status RamFileBlockCache::Read(const string& filename, size_t offset, size_t n,
   if (finish < offset + n) {
     finish += block_size_;
   }
+  // If the read spans several blocks, start fetching the ones after the first
+  // block concurrently. The loop below consumes the blocks in order, waiting
+  // for the ones still being fetched, or fetching itself the ones no helper
+  // has started on yet.
+  const size_t num_blocks = (finish - start) / block_size_;
+  const size_t num_helpers = std::min(num_blocks, max_parallel_fetches_) - 1;
+  std::atomic<size_t> next_prefetch(1);
+  std::atomic<bool> stop_prefetch(false);
+  BlockingCounter helpers_done(num_helpers);
+  for (size_t i = 0; i < num_helpers; ++i) {
+    env_->SchedClosure([&, this]() {
+      for (size_t b = next_prefetch++; b < num_blocks && !stop_prefetch;
+           b = next_prefetch++) {
+        Key key = std::make_pair(filename, start + b * block_size_);
+        // Errors are reported when the read itself reaches the block.
+        MaybeFetch(key, Lookup(key)).IgnoreError();
+      }
+      helpers_done.DecrementCount();
+    });
+  }
+  // Blocks at or past `eof_pos` were only fetched ahead of the read, and are
+  // dropped once the helpers are done.
+  size_t eof_pos = finish;
+  bool prefetch_finished = num_helpers == 0;
+  auto finish_prefetch = [&, this]() {
+    if (prefetch_finished) return;
+    prefetch_finished = true;
+    stop_prefetch = true;
+    helpers_done.Wait();
+    RemoveBlocksPastEof(filename, eof_pos, finish);
+  };
+  auto finish_prefetch_on_return = gtl::MakeCleanup(finish_prefetch);
   size_t total_bytes_transferred = 0;
   // Now iterate through the blocks, reading them one at a time.
   for (size_t pos = start; pos < finish; pos += block_size_) {
@@ -191,6 +225,12 @@ Status RamFileBlockCache::Read(const string& filename, size_t offset, size_t n,
     std::shared_ptr<Block> block = Lookup(key);
     DCHECK(block) << "No block for key " << key.first << "@" << key.second;
     TF_RETURN_IF_ERROR(MaybeFetch(key, block));
+    if (block->data.size() < block_size_) {
+      // A partial block signals EOF. Drop any blocks fetched past it before
+      // they make the cache contents look inconsistent.
+      eof_pos = pos + block_size_;
+      finish_prefetch();
+    }
     TF_RETURN_IF_ERROR(UpdateLRU(key, block));
     // Copy the relevant portion of the block into the result buffer.
     const auto& data = block->data;
@@ -227,6 +267,18 @@ Status RamFileBlockCache::Read(const string& filename, size_t offset, size_t n,
   return Status::OK();
 }
 
+void RamFileBlockCache::RemoveBlocksPastEof(const string& filename,
+                                            size_t start, size_t finish) {
+  mutex_lock lock(mu_);
+  auto it = block_map_.lower_bound(std::make_pair(filename, start));
+  while (it != block_map_.end() && it->first.first == filename &&
+         it->first.second < finish) {
+    auto next = std::next(it);
+    RemoveBlock(it);
+    it = next;
+  }
+}
+
 bool RamFileBlockCache::ValidateAndUpdateFileSignature(const string& filename,
                                                        int64_t file_signature) {
   mutex_lock lock(mu_);
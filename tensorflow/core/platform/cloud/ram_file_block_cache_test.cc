@@ -513,6 +513,56 @@ TEST(RamFileBlockCacheTest, ParallelReads) {
   // executed, or 10 seconds have passed).
 }
 
+TEST(RamFileBlockCacheTest, ParallelBlockFetches) {
+  // A single read of `blocks` blocks should fetch them all concurrently. The
+  // fetcher fails unless it is called by `blocks` threads at once.
+  const int blocks = 4;
+  BlockingCounter counter(blocks);
+  auto fetcher = [&counter](const string& filename, size_t offset, size_t n,
+                            char* buffer, size_t* bytes_transferred) {
+    counter.DecrementCount();
+    if (!counter.WaitFor(std::chrono::seconds(10))) {
+      return errors::FailedPrecondition("desired concurrency not reached");
+    }
+    memset(buffer, 'a' + offset / n, n);
+    *bytes_transferred = n;
+    return Status::OK();
+  };
+  const int block_size = 8;
+  RamFileBlockCache cache(block_size, 2 * blocks * block_size, 0, fetcher,
+                          Env::Default(), blocks);
+  std::vector<char> out;
+  TF_EXPECT_OK(ReadCache(&cache, "a", 4, (blocks - 1) * block_size, &out));
+  std::string want = "aaaabbbbbbbbccccccccdddd";
+  EXPECT_EQ(std::string(out.begin(), out.end()), want);
+  EXPECT_EQ(cache.CacheSize(), blocks * block_size);
+}
+
+TEST(RamFileBlockCacheTest, ParallelBlockFetchesPastEof) {
+  // Blocks fetched ahead of a read past the end of a 20-byte file should not
+  // remain in the cache.
+  const size_t block_size = 8;
+  const size_t file_size = 20;
+  auto fetcher = [file_size](const string& filename, size_t offset, size_t n,
+                             char* buffer, size_t* bytes_transferred) {
+    size_t bytes_to_copy = offset < file_size
+                               ? std::min<size_t>(file_size - offset, n)
+                               : 0;
+    memset(buffer, 'x', bytes_to_copy);
+    *bytes_transferred = bytes_to_copy;
+    return Status::OK();
+  };
+  RamFileBlockCache cache(block_size, 16 * block_size, 0, fetcher,
+                          Env::Default(), 8);
+  std::vector<char> out;
+  TF_EXPECT_OK(ReadCache(&cache, "", 0, 8 * block_size, &out));
+  EXPECT_EQ(out.size(), file_size);
+  EXPECT_EQ(cache.CacheSize(), file_size);
+  // The partial last block is still consistent with the cached blocks.
+  TF_EXPECT_OK(ReadCache(&cache, "", 2 * block_size, block_size, &out));
+  EXPECT_EQ(out.size(), file_size - 2 * block_size);
+}
+
 TEST(RamFileBlockCacheTest, CoalesceConcurrentReads) {
   // Concurrent reads to the same file blocks should be de-duplicated.
   const size_t block_size = 16;
@@ -21,6 +21,7 @@ limitations under the License.
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/cord.h"
+#include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/null_file_system.h"
 #include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/protobuf.h"
@@ -90,6 +91,58 @@ TEST_F(DefaultEnvTest, IncompleteReadOutOfRange) {
   EXPECT_EQ(input, result);
 }
 
+TEST_F(DefaultEnvTest, ReadV) {
+  const string filename = io::JoinPath(BaseDir(), "read_v");
+  const string input = CreateTestFile(env_, filename, 100);
+  std::unique_ptr<RandomAccessFile> f;
+  TF_EXPECT_OK(env_->NewRandomAccessFile(filename, &f));
+
+  char scratch[3][10];
+  std::vector<RandomAccessFile::ReadRequest> requests(3);
+  requests[0].offset = 50;
+  requests[0].n = 10;
+  requests[1].offset = 0;
+  requests[1].n = 10;
+  requests[2].offset = 95;
+  requests[2].n = 10;
+  for (int i = 0; i < 3; ++i) requests[i].scratch = scratch[i];
+
+  // The read past EOF fails, but doesn't affect the other requests.
+  EXPECT_EQ(error::OUT_OF_RANGE, f->ReadV(&requests).code());
+  TF_EXPECT_OK(requests[0].status);
+  EXPECT_EQ(input.substr(50, 10), requests[0].result);
+  TF_EXPECT_OK(requests[1].status);
+  EXPECT_EQ(input.substr(0, 10), requests[1].result);
+  EXPECT_EQ(error::OUT_OF_RANGE, requests[2].status.code());
+  EXPECT_EQ(input.substr(95), requests[2].result);
+}
+
+TEST_F(DefaultEnvTest, ReadVAsync) {
+  const string filename = io::JoinPath(BaseDir(), "read_v_async");
+  const string input = CreateTestFile(env_, filename, 100);
+  std::unique_ptr<RandomAccessFile> f;
+  TF_EXPECT_OK(env_->NewRandomAccessFile(filename, &f));
+
+  char scratch[2][20];
+  std::vector<RandomAccessFile::ReadRequest> requests(2);
+  requests[0].offset = 10;
+  requests[0].n = 20;
+  requests[1].offset = 70;
+  requests[1].n = 20;
+  for (int i = 0; i < 2; ++i) requests[i].scratch = scratch[i];
+
+  Notification done;
+  Status status = errors::Unknown("Not done");
+  f->ReadVAsync(&requests, [&](const Status& s) {
+    status = s;
+    done.Notify();
+  });
+  done.WaitForNotification();
+  TF_EXPECT_OK(status);
+  EXPECT_EQ(input.substr(10, 20), requests[0].result);
+  EXPECT_EQ(input.substr(70, 20), requests[1].result);
+}
+
 TEST_F(DefaultEnvTest, ReadFileToString) {
   for (const int length : {0, 1, 1212, 2553, 4928, 8196, 9000, (1 << 20) - 1,
                            1 << 20, (1 << 20) + 1, (256 << 20) + 100}) {
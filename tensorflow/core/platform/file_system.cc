@@ -35,6 +35,7 @@ limitations under the License.
 #include "tensorflow/core/platform/scanner.h"
 #include "tensorflow/core/platform/str_util.h"
 #include "tensorflow/core/platform/strcat.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 
@@ -441,6 +442,29 @@ string FileSystem::CreateURI(StringPiece scheme, StringPiece host,
   return strings::StrCat(scheme, "://", host, path);
 }
 
+Status RandomAccessFile::ReadV(std::vector<ReadRequest>* requests) const {
+  Status status;
+  for (ReadRequest& request : *requests) {
+    request.status =
+        Read(request.offset, request.n, &request.result, request.scratch);
+    status.Update(request.status);
+  }
+  return status;
+}
+
+void RandomAccessFile::ReadVAsync(
+    std::vector<ReadRequest>* requests,
+    std::function<void(const Status&)> done) const {
+  // Enough threads to keep several devices or remote connections busy, while
+  // bounding the threads used however many reads are outstanding.
+  static constexpr int kNumAsyncReadThreads = 16;
+  static thread::ThreadPool* pool = new thread::ThreadPool(
+      Env::Default(), "random_access_file_read_async", kNumAsyncReadThreads);
+  pool->Schedule([this, requests, done = std::move(done)]() {
+    done(ReadV(requests));
+  });
+}
+
 std::string FileSystem::DecodeTransaction(const TransactionToken* token) {
   // TODO(sami): Switch using StrCat when void* is supported
   if (token) {
@@ -774,6 +774,39 @@ class RandomAccessFile {
   virtual tensorflow::Status Read(uint64 offset, size_t n, StringPiece* result,
                                   char* scratch) const = 0;
 
+  /// \brief A range of the file to read with ReadV() or ReadVAsync().
+  struct ReadRequest {
+    uint64 offset = 0;
+    size_t n = 0;
+    /// Holds at least `n` bytes, as for Read().
+    char* scratch = nullptr;
+    /// Set to the data that was read, as by Read().
+    StringPiece result;
+    /// Set to the status Read() returns for the range.
+    tensorflow::Status status;
+  };
+
+  /// \brief Reads several ranges of the file.
+  ///
+  /// Sets the `result` and `status` of every request as Read() would, and
+  /// returns the first non-OK request status, if any. The ranges may be read
+  /// in any order and concurrently. The default implementation reads them one
+  /// after the other.
+  ///
+  /// Safe for concurrent use by multiple threads.
+  virtual tensorflow::Status ReadV(std::vector<ReadRequest>* requests) const;
+
+  /// \brief Asynchronously reads several ranges of the file.
+  ///
+  /// Like ReadV(), but returns immediately and calls `done` with the status
+  /// ReadV() would return once all requests are complete. `requests` and the
+  /// file must stay alive until then. The default implementation runs ReadV()
+  /// on a small thread pool shared by all files, so outstanding reads do not
+  /// each need a thread of their own.
+  virtual void ReadVAsync(
+      std::vector<ReadRequest>* requests,
+      std::function<void(const tensorflow::Status&)> done) const;
+
 #if defined(TF_CORD_SUPPORT)
   /// \brief Read up to `n` bytes from the file starting at `offset`.
   virtual tensorflow::Status Read(uint64 offset, size_t n,
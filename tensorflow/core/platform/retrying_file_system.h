@@ -189,6 +189,21 @@ class RetryingRandomAccessFile : public RandomAccessFile {
         retry_config_);
   }
 
+  Status ReadV(std::vector<ReadRequest>* requests) const override {
+    // Let the base file read all the ranges at once, then read the ranges
+    // that failed again one by one, with retries.
+    base_file_->ReadV(requests).IgnoreError();
+    Status status;
+    for (ReadRequest& request : *requests) {
+      if (!request.status.ok() && !errors::IsOutOfRange(request.status)) {
+        request.status =
+            Read(request.offset, request.n, &request.result, request.scratch);
+      }
+      status.Update(request.status);
+    }
+    return status;
+  }
+
  private:
   std::unique_ptr<RandomAccessFile> base_file_;
   const RetryConfig retry_config_;
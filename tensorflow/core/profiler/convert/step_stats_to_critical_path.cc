@@ -0,0 +1,195 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/profiler/convert/step_stats_to_critical_path.h"
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/graph/tensor_id.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/utils/math_utils.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace {
+
+struct OpNode {
+  const NodeDef* def = nullptr;
+  std::string device;
+  bool executed = false;
+  uint64 duration_ps = 0;
+  std::vector<int> inputs;
+  std::vector<int> outputs;
+  // Earliest finish and latest finish times relative to the step start.
+  uint64 earliest_end_ps = 0;
+  uint64 latest_end_ps = 0;
+  // The input that finishes last, or -1.
+  int critical_input = -1;
+};
+
+uint64 StartTimePs(const NodeExecStats& stats) {
+  return stats.all_start_nanos() != 0
+             ? NanoToPico(stats.all_start_nanos())
+             : MicroToPico(stats.all_start_micros());
+}
+
+uint64 DurationPs(const NodeExecStats& stats) {
+  return stats.all_end_rel_nanos() != 0
+             ? NanoToPico(stats.all_end_rel_nanos())
+             : MicroToPico(stats.all_end_rel_micros());
+}
+
+bool IsNextIteration(const NodeDef& def) {
+  return def.op() == "NextIteration" || def.op() == "RefNextIteration";
+}
+
+// Returns the nodes of the graph in topological order.
+Status TopologicalOrder(const std::vector<OpNode>& nodes,
+                        std::vector<int>* order) {
+  std::vector<int> pending(nodes.size());
+  for (int i = 0; i < nodes.size(); ++i) {
+    pending[i] = nodes[i].inputs.size();
+    if (pending[i] == 0) order->push_back(i);
+  }
+  for (int next = 0; next < order->size(); ++next) {
+    for (int output : nodes[(*order)[next]].outputs) {
+      if (--pending[output] == 0) order->push_back(output);
+    }
+  }
+  if (order->size() != nodes.size()) {
+    for (int i = 0; i < nodes.size(); ++i) {
+      if (pending[i] > 0) {
+        return errors::InvalidArgument("The graph has a cycle through node ",
+                                       nodes[i].def->name());
+      }
+    }
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+Status ConvertStepStatsToCriticalPath(const GraphDef& graph,
+                                      const StepStats& step_stats,
+                                      CriticalPath* critical_path) {
+  std::vector<OpNode> nodes(graph.node_size());
+  absl::flat_hash_map<absl::string_view, int> node_ids;
+  for (int i = 0; i < graph.node_size(); ++i) {
+    nodes[i].def = &graph.node(i);
+    node_ids.emplace(graph.node(i).name(), i);
+  }
+  for (int i = 0; i < graph.node_size(); ++i) {
+    for (const std::string& input : graph.node(i).input()) {
+      auto it = node_ids.find(ParseTensorName(input).node());
+      if (it == node_ids.end()) {
+        return errors::InvalidArgument("Node ", graph.node(i).name(),
+                                       " has an unknown input ", input);
+      }
+      if (IsNextIteration(*nodes[it->second].def)) continue;
+      nodes[i].inputs.push_back(it->second);
+      nodes[it->second].outputs.push_back(i);
+    }
+  }
+
+  uint64 step_start_ps = std::numeric_limits<uint64>::max();
+  uint64 step_end_ps = 0;
+  for (const DeviceStepStats& device_stats : step_stats.dev_stats()) {
+    for (const NodeExecStats& stats : device_stats.node_stats()) {
+      auto it = node_ids.find(stats.node_name());
+      if (it == node_ids.end()) continue;
+      OpNode& node = nodes[it->second];
+      node.executed = true;
+      node.device = device_stats.device();
+      node.duration_ps += DurationPs(stats);
+      const uint64 start_ps = StartTimePs(stats);
+      step_start_ps = std::min(step_start_ps, start_ps);
+      step_end_ps = std::max(step_end_ps, start_ps + DurationPs(stats));
+    }
+  }
+
+  std::vector<int> order;
+  TF_RETURN_IF_ERROR(TopologicalOrder(nodes, &order));
+
+  // Forward pass: every op starts as soon as its last input is done.
+  int last = -1;
+  for (int id : order) {
+    OpNode& node = nodes[id];
+    uint64 start_ps = 0;
+    for (int input : node.inputs) {
+      if (nodes[input].earliest_end_ps >= start_ps) {
+        start_ps = nodes[input].earliest_end_ps;
+        node.critical_input = input;
+      }
+    }
+    node.earliest_end_ps = start_ps + node.duration_ps;
+    if (last == -1 || node.earliest_end_ps > nodes[last].earliest_end_ps) {
+      last = id;
+    }
+  }
+  const uint64 critical_path_ps = last == -1 ? 0 : nodes[last].earliest_end_ps;
+
+  // Backward pass: every op ends as late as its outputs allow.
+  for (auto it = order.rbegin(); it != order.rend(); ++it) {
+    OpNode& node = nodes[*it];
+    node.latest_end_ps = critical_path_ps;
+    for (int output : node.outputs) {
+      node.latest_end_ps =
+          std::min(node.latest_end_ps,
+                   nodes[output].latest_end_ps - nodes[output].duration_ps);
+    }
+  }
+
+  std::vector<bool> on_critical_path(nodes.size(), false);
+  std::vector<int> path;
+  for (int id = last; id != -1; id = nodes[id].critical_input) {
+    on_critical_path[id] = true;
+    if (nodes[id].executed) path.push_back(id);
+  }
+
+  critical_path->Clear();
+  if (step_end_ps > 0) {
+    critical_path->set_step_time_ps(step_end_ps - step_start_ps);
+  }
+  critical_path->set_critical_path_time_ps(critical_path_ps);
+  for (auto it = path.rbegin(); it != path.rend(); ++it) {
+    critical_path->add_critical_path(nodes[*it].def->name());
+  }
+  std::vector<int> executed;
+  for (int i = 0; i < nodes.size(); ++i) {
+    if (nodes[i].executed) executed.push_back(i);
+  }
+  std::stable_sort(executed.begin(), executed.end(), [&nodes](int a, int b) {
+    return nodes[a].duration_ps > nodes[b].duration_ps;
+  });
+  for (int id : executed) {
+    const OpNode& node = nodes[id];
+    CriticalPathOp* op = critical_path->add_ops();
+    op->set_name(node.def->name());
+    op->set_type(node.def->op());
+    op->set_device(node.device);
+    op->set_duration_ps(node.duration_ps);
+    op->set_earliest_start_ps(node.earliest_end_ps - node.duration_ps);
+    op->set_slack_ps(node.latest_end_ps - node.earliest_end_ps);
+    op->set_on_critical_path(on_critical_path[id]);
+  }
+  return Status::OK();
+}
+
+}  // namespace profiler
+}  // namespace tensorflow
@@ -0,0 +1,42 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_PROFILER_CONVERT_STEP_STATS_TO_CRITICAL_PATH_H_
+#define TENSORFLOW_CORE_PROFILER_CONVERT_STEP_STATS_TO_CRITICAL_PATH_H_
+
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/profiler/protobuf/critical_path.pb.h"
+
+namespace tensorflow {
+namespace profiler {
+
+// Computes the critical path of a step through `graph` from the per-node
+// execution times the executor recorded in `step_stats` (e.g. the
+// RunMetadata of a traced step and its partition graphs). The dependencies
+// are the data and control inputs of the graph nodes; NextIteration back
+// edges are ignored, and an op executed several times (e.g. in a loop) counts
+// with its total duration. Nodes without execution stats take no time, and
+// stats of nodes that are not in `graph` (e.g. per stream GPU stats) are
+// ignored.
+Status ConvertStepStatsToCriticalPath(const GraphDef& graph,
+                                      const StepStats& step_stats,
+                                      CriticalPath* critical_path);
+
+}  // namespace profiler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_PROFILER_CONVERT_STEP_STATS_TO_CRITICAL_PATH_H_
@@ -0,0 +1,124 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/profiler/convert/step_stats_to_critical_path.h"
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/profiler/protobuf/critical_path.pb.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace {
+
+using ::testing::ElementsAre;
+
+void AddNode(const std::string& name, const std::string& op,
+             const std::vector<std::string>& inputs, GraphDef* graph) {
+  NodeDef* node = graph->add_node();
+  node->set_name(name);
+  node->set_op(op);
+  for (const std::string& input : inputs) node->add_input(input);
+}
+
+void AddStats(const std::string& name, int64_t start_us, int64_t duration_us,
+              DeviceStepStats* device_stats) {
+  NodeExecStats* stats = device_stats->add_node_stats();
+  stats->set_node_name(name);
+  stats->set_all_start_micros(start_us);
+  stats->set_all_end_rel_micros(duration_us);
+}
+
+const CriticalPathOp* FindOp(const CriticalPath& critical_path,
+                             const std::string& name) {
+  for (const CriticalPathOp& op : critical_path.ops()) {
+    if (op.name() == name) return &op;
+  }
+  return nullptr;
+}
+
+TEST(StepStatsToCriticalPathTest, Diamond) {
+  // a feeds b and c, which both feed d.
+  GraphDef graph;
+  AddNode("a", "Const", {}, &graph);
+  AddNode("b", "MatMul", {"a", "a"}, &graph);
+  AddNode("c", "Relu", {"a:0"}, &graph);
+  AddNode("d", "Add", {"b", "c", "^a"}, &graph);
+  StepStats step_stats;
+  DeviceStepStats* device_stats = step_stats.add_dev_stats();
+  device_stats->set_device("/device:CPU:0");
+  AddStats("a", 100, 1, device_stats);
+  AddStats("b", 102, 5, device_stats);
+  AddStats("c", 101, 2, device_stats);
+  AddStats("d", 107, 1, device_stats);
+
+  CriticalPath critical_path;
+  TF_ASSERT_OK(
+      ConvertStepStatsToCriticalPath(graph, step_stats, &critical_path));
+  EXPECT_EQ(critical_path.step_time_ps(), 8000000);
+  EXPECT_EQ(critical_path.critical_path_time_ps(), 7000000);
+  EXPECT_THAT(critical_path.critical_path(), ElementsAre("a", "b", "d"));
+  ASSERT_EQ(critical_path.ops_size(), 4);
+  EXPECT_EQ(critical_path.ops(0).name(), "b");
+
+  const CriticalPathOp* c = FindOp(critical_path, "c");
+  ASSERT_NE(c, nullptr);
+  EXPECT_EQ(c->type(), "Relu");
+  EXPECT_EQ(c->device(), "/device:CPU:0");
+  EXPECT_EQ(c->earliest_start_ps(), 1000000);
+  EXPECT_EQ(c->slack_ps(), 3000000);
+  EXPECT_FALSE(c->on_critical_path());
+  EXPECT_EQ(FindOp(critical_path, "b")->slack_ps(), 0);
+  EXPECT_TRUE(FindOp(critical_path, "b")->on_critical_path());
+}
+
+TEST(StepStatsToCriticalPathTest, IgnoresBackEdges) {
+  GraphDef graph;
+  AddNode("enter", "Enter", {}, &graph);
+  AddNode("merge", "Merge", {"enter", "next"}, &graph);
+  AddNode("body", "Mul", {"merge"}, &graph);
+  AddNode("next", "NextIteration", {"body"}, &graph);
+  StepStats step_stats;
+  DeviceStepStats* device_stats = step_stats.add_dev_stats();
+  // Two iterations of the loop.
+  AddStats("merge", 0, 1, device_stats);
+  AddStats("body", 1, 3, device_stats);
+  AddStats("merge", 4, 1, device_stats);
+  AddStats("body", 5, 3, device_stats);
+
+  CriticalPath critical_path;
+  TF_ASSERT_OK(
+      ConvertStepStatsToCriticalPath(graph, step_stats, &critical_path));
+  EXPECT_EQ(critical_path.critical_path_time_ps(), 8000000);
+  EXPECT_THAT(critical_path.critical_path(), ElementsAre("merge", "body"));
+}
+
+TEST(StepStatsToCriticalPathTest, Cycle) {
+  GraphDef graph;
+  AddNode("a", "Identity", {"b"}, &graph);
+  AddNode("b", "Identity", {"a"}, &graph);
+  CriticalPath critical_path;
+  EXPECT_FALSE(
+      ConvertStepStatsToCriticalPath(graph, StepStats(), &critical_path).ok());
+}
+
+}  // namespace
+}  // namespace profiler
+}  // namespace tensorflow
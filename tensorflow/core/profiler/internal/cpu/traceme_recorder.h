@@ -16,6 +16,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_PROFILER_INTERNAL_CPU_TRACEME_RECORDER_H_
 
 #include <atomic>
+#include <climits>
 #include <deque>
 #include <memory>
 #include <string>
@@ -27,6 +28,16 @@ limitations under the License.
 #include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/platform/types.h"
 
+// TraceMes with a level above TF_PROFILER_MAX_TRACE_LEVEL are compiled out:
+// for such levels TraceMeRecorder::Active() is false without reading the
+// runtime trace level, so when the level is a constant the compiler drops the
+// name generation and the recording altogether. Build with e.g.
+// --copt=-DTF_PROFILER_MAX_TRACE_LEVEL=2 to remove the verbose (cheap op)
+// instrumentation from hot paths. By default no level is compiled out.
+#ifndef TF_PROFILER_MAX_TRACE_LEVEL
+#define TF_PROFILER_MAX_TRACE_LEVEL INT_MAX
+#endif
+
 namespace tensorflow {
 namespace profiler {
 namespace internal {
@@ -89,9 +100,13 @@ class TraceMeRecorder {
   // Events passed to Record after Stop has started will be dropped.
   static Events Stop() { return Get()->StopRecording(); }
 
+  // The highest level that can be recorded in this build.
+  static constexpr int kMaxLevel = TF_PROFILER_MAX_TRACE_LEVEL;
+
   // Returns whether we're currently recording. Racy, but cheap!
   static inline bool Active(int level = 1) {
-    return internal::g_trace_level.load(std::memory_order_acquire) >= level;
+    return level <= kMaxLevel &&
+           internal::g_trace_level.load(std::memory_order_acquire) >= level;
   }
 
   // Default value for trace_level_ when tracing is disabled
@@ -57,6 +57,16 @@ TEST(RecorderTest, SingleThreaded) {
               ElementsAre(Named("during1"), Named("during2")));
 }
 
+TEST(RecorderTest, ActiveLevels) {
+  EXPECT_FALSE(TraceMeRecorder::Active());
+  TraceMeRecorder::Start(/*level=*/2);
+  EXPECT_TRUE(TraceMeRecorder::Active(1));
+  EXPECT_EQ(TraceMeRecorder::Active(2), TraceMeRecorder::kMaxLevel >= 2);
+  EXPECT_FALSE(TraceMeRecorder::Active(3));
+  TraceMeRecorder::Stop();
+  EXPECT_FALSE(TraceMeRecorder::Active());
+}
+
 // Checks the functional behavior of the recorder, when used from several
 // unsynchronized threads.
 //
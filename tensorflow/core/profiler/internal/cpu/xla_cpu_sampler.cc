@@ -0,0 +1,181 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__clang__) && __cplusplus >= 201703L  // clang C++17
+#define TF_PROFILER_DISABLE_CXX17_WARNINGS \
+  _Pragma("clang diagnostic push")         \
+      _Pragma("clang diagnostic ignored \"-Wc++98-c++11-c++14-compat\"")
+#define TF_PROFILER_ENABLE_CXX17_WARNINGS _Pragma("clang diagnostic pop")
+#else
+#define TF_PROFILER_DISABLE_CXX17_WARNINGS
+#define TF_PROFILER_ENABLE_CXX17_WARNINGS
+#endif
+
+TF_PROFILER_DISABLE_CXX17_WARNINGS
+#include "tensorflow/compiler/xla/service/cpu/hlo_sampler.h"
+#include "tensorflow/compiler/xla/service/hlo_module.h"
+#include "tensorflow/compiler/xla/service/xla_debug_info_manager.h"
+TF_PROFILER_ENABLE_CXX17_WARNINGS
+#include "absl/container/flat_hash_map.h"
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/time.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/profiler/lib/profiler_factory.h"
+#include "tensorflow/core/profiler/lib/profiler_interface.h"
+#include "tensorflow/core/profiler/profiler_options.pb.h"
+#include "tensorflow/core/profiler/protobuf/xplane.pb.h"
+#include "tensorflow/core/profiler/utils/time_utils.h"
+#include "tensorflow/core/profiler/utils/xplane_builder.h"
+#include "tensorflow/core/profiler/utils/xplane_schema.h"
+#include "tensorflow/core/profiler/utils/xplane_utils.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace {
+
+// Resolves the unique ids recorded by the sampler to module and instruction
+// names, using the modules registered with XlaDebugInfoManager.
+class HloNameResolver {
+ public:
+  struct ModuleNames {
+    std::string module_name;
+    absl::flat_hash_map<int, std::string> instruction_names;
+  };
+
+  const ModuleNames& Get(int module_id) {
+    auto it = modules_.find(module_id);
+    if (it != modules_.end()) return it->second;
+    ModuleNames& names = modules_[module_id];
+    std::shared_ptr<const xla::HloModule> module =
+        xla::XlaDebugInfoManager::Get()->FindModule(module_id);
+    if (module == nullptr) {
+      names.module_name = absl::StrCat("module.", module_id);
+      return names;
+    }
+    names.module_name = module->name();
+    for (const xla::HloComputation* computation : module->computations()) {
+      for (const xla::HloInstruction* instruction :
+           computation->instructions()) {
+        names.instruction_names[instruction->unique_id()] =
+            instruction->name();
+      }
+    }
+    return names;
+  }
+
+ private:
+  absl::flat_hash_map<int, ModuleNames> modules_;
+};
+
+// Samples the HLO instruction each XLA:CPU thread is executing and converts
+// the sampled runs into XEvents, one XLine per thread. Only executables
+// compiled with --xla_cpu_enable_hlo_sampling publish their instructions.
+//
+// Thread-safety: This class is go/thread-compatible.
+class XlaCpuSampler : public ProfilerInterface {
+ public:
+  explicit XlaCpuSampler(absl::Duration period) : sampler_(period) {}
+
+  Status Start() override {
+    if (recording_) {
+      return errors::Internal("XlaCpuSampler already started");
+    }
+    start_timestamp_ns_ = GetCurrentTimeNanos();
+    sampler_.Start();
+    recording_ = true;
+    return Status::OK();
+  }
+
+  Status Stop() override {
+    if (!recording_) {
+      return errors::Internal("XlaCpuSampler not started");
+    }
+    runs_ = sampler_.Stop();
+    recording_ = false;
+    return Status::OK();
+  }
+
+  Status CollectData(XSpace* space) override {
+    if (recording_) {
+      return errors::Internal("XlaCpuSampler not stopped");
+    }
+    if (runs_.empty()) {
+      return Status::OK();
+    }
+    XPlaneBuilder plane(
+        FindOrAddMutablePlaneWithName(space, kXlaCpuSamplesPlaneName));
+    const XStatMetadata& hlo_op_stat =
+        *plane.GetOrCreateStatMetadata(GetStatTypeStr(StatType::kHloOp));
+    const XStatMetadata& hlo_module_stat =
+        *plane.GetOrCreateStatMetadata(GetStatTypeStr(StatType::kHloModule));
+    HloNameResolver resolver;
+    for (const xla::cpu::HloSampler::Run& run : std::exchange(runs_, {})) {
+      const HloNameResolver::ModuleNames& names = resolver.Get(run.module_id);
+      auto it = names.instruction_names.find(run.instruction_id);
+      std::string instruction_name =
+          it != names.instruction_names.end()
+              ? it->second
+              : absl::StrCat("hlo.", run.instruction_id);
+
+      XLineBuilder line = plane.GetOrCreateLine(run.thread_id);
+      line.SetNameIfEmpty(kXlaOpLineName);
+      line.SetTimestampNs(start_timestamp_ns_);
+      XEventBuilder event =
+          line.AddEvent(*plane.GetOrCreateEventMetadata(instruction_name));
+      event.SetTimestampNs(run.start_ns);
+      event.SetDurationNs(run.end_ns - run.start_ns);
+      event.AddStatValue(hlo_op_stat, instruction_name);
+      event.AddStatValue(hlo_module_stat, names.module_name);
+    }
+    return Status::OK();
+  }
+
+ private:
+  xla::cpu::HloSampler sampler_;
+  bool recording_ = false;
+  uint64 start_timestamp_ns_ = 0;
+  std::vector<xla::cpu::HloSampler::Run> runs_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(XlaCpuSampler);
+};
+
+std::unique_ptr<ProfilerInterface> CreateXlaCpuSampler(
+    const ProfileOptions& options) {
+  // HLO executions are traced starting at host trace level 2; level 3 samples
+  // at a finer granularity.
+  if (options.host_tracer_level() < 2) return nullptr;
+  const absl::Duration period = options.host_tracer_level() >= 3
+                                    ? absl::Microseconds(100)
+                                    : absl::Milliseconds(1);
+  return absl::make_unique<XlaCpuSampler>(period);
+}
+
+}  // namespace
+
+auto register_xla_cpu_sampler_factory = [] {
+  RegisterProfilerFactory(&CreateXlaCpuSampler);
+  return 0;
+}();
+
+}  // namespace profiler
+}  // namespace tensorflow
@@ -20,7 +20,11 @@ limitations under the License.
 #include "grpcpp/support/status.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_replace.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/env_time.h"
 #include "tensorflow/core/platform/errors.h"
@@ -32,6 +36,7 @@ limitations under the License.
 #include "tensorflow/core/profiler/profiler_service.grpc.pb.h"
 #include "tensorflow/core/profiler/profiler_service.pb.h"
 #include "tensorflow/core/profiler/protobuf/xplane.pb.h"
+#include "tensorflow/core/profiler/rpc/sampling_profiler.h"
 #include "tensorflow/core/profiler/utils/file_system_utils.h"
 #include "tensorflow/core/profiler/utils/xplane_utils.h"
 
@@ -69,16 +74,46 @@ Status CollectDataToRepository(const ProfileRequest& request,
   return WriteBinaryProto(Env::Default(), out_path, xspace);
 }
 
+// The number of ops listed per device type by the Monitor RPC at monitoring
+// level 2 and above.
+constexpr int kMonitorTopOps = 10;
+
 class ProfilerServiceImpl : public grpc::ProfilerService::Service {
  public:
+  explicit ProfilerServiceImpl(SamplingProfiler* sampler) : sampler_(sampler) {}
+
+  // Reports the op metrics of the samples taken by the sampling profiler in
+  // the last `duration_ms`, or of all samples in memory if it is 0.
   ::grpc::Status Monitor(::grpc::ServerContext* ctx, const MonitorRequest* req,
                          MonitorResponse* response) override {
-    return ::grpc::Status(::grpc::StatusCode::UNIMPLEMENTED, "unimplemented.");
+    if (sampler_ == nullptr) {
+      return ::grpc::Status(::grpc::StatusCode::UNIMPLEMENTED,
+                            "Monitoring requires continuous sampling, which is "
+                            "enabled by TF_PROFILER_SAMPLING_PERIOD_MS.");
+    }
+    const absl::Time now = absl::Now();
+    const absl::Time since =
+        req->duration_ms() == 0
+            ? absl::InfinitePast()
+            : now - absl::Milliseconds(req->duration_ms());
+    const int top_n = req->monitoring_level() >= 2 ? kMonitorTopOps : 0;
+    std::string data =
+        SamplingSummaryToString(sampler_->Summarize(since), top_n);
+    if (req->timestamp()) {
+      data = absl::StrCat("Timestamp: ", absl::FormatTime(now), "\n", data);
+    }
+    response->set_data(std::move(data));
+    return ::grpc::Status::OK;
   }
 
   ::grpc::Status Profile(::grpc::ServerContext* ctx, const ProfileRequest* req,
                          ProfileResponse* response) override {
     VLOG(1) << "Received a profile request: " << req->DebugString();
+    // Only one ProfilerSession can be active at a time.
+    if (sampler_ != nullptr) sampler_->Pause();
+    auto resume_sampling = gtl::MakeCleanup([this] {
+      if (sampler_ != nullptr) sampler_->Resume();
+    });
     std::unique_ptr<ProfilerSession> profiler =
         ProfilerSession::Create(req->opts());
     Status status = profiler->Status();
@@ -124,6 +159,9 @@ class ProfilerServiceImpl : public grpc::ProfilerService::Service {
     return it != stop_signals_per_session_.end() && it->second;
   }
 
+  // Takes samples for Monitor, if continuous sampling is enabled. Not owned.
+  SamplingProfiler* const sampler_;
+
   mutex mutex_;
   absl::flat_hash_map<std::string, bool> stop_signals_per_session_
       ABSL_GUARDED_BY(mutex_);
@@ -132,7 +170,7 @@ class ProfilerServiceImpl : public grpc::ProfilerService::Service {
 }  // namespace
 
 std::unique_ptr<grpc::ProfilerService::Service> CreateProfilerService() {
-  return absl::make_unique<ProfilerServiceImpl>();
+  return absl::make_unique<ProfilerServiceImpl>(SamplingProfiler::Global());
 }
 
 }  // namespace profiler
@@ -0,0 +1,230 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/profiler/rpc/sampling_profiler.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/profiler/convert/op_metrics_db_combiner.h"
+#include "tensorflow/core/profiler/convert/xplane_to_op_stats.h"
+#include "tensorflow/core/profiler/lib/profiler_session.h"
+#include "tensorflow/core/profiler/protobuf/op_stats.pb.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace {
+
+int64_t ToMillis(absl::Duration d) { return absl::ToInt64Milliseconds(d); }
+
+void AppendTopOps(const OpMetricsDb& db, int top_n, std::string* out) {
+  std::vector<const OpMetrics*> metrics;
+  metrics.reserve(db.metrics_db_size());
+  for (const OpMetrics& m : db.metrics_db()) metrics.push_back(&m);
+  top_n = std::min<int>(top_n, metrics.size());
+  std::partial_sort(metrics.begin(), metrics.begin() + top_n, metrics.end(),
+                    [](const OpMetrics* a, const OpMetrics* b) {
+                      return a->self_time_ps() > b->self_time_ps();
+                    });
+  for (int i = 0; i < top_n; ++i) {
+    const OpMetrics& m = *metrics[i];
+    absl::StrAppendFormat(
+        out, "  %s (%s): self %.3f ms, total %.3f ms, %u occurrences\n",
+        m.name(), m.category(), m.self_time_ps() / 1e9, m.time_ps() / 1e9,
+        m.occurrences());
+  }
+}
+
+std::unique_ptr<SamplingProfiler> CreateFromEnv() {
+  int64_t period_ms;
+  int64_t duration_ms;
+  int64_t max_samples;
+  Status s = ReadInt64FromEnvVar("TF_PROFILER_SAMPLING_PERIOD_MS", 0,
+                                 &period_ms);
+  if (s.ok()) {
+    s = ReadInt64FromEnvVar("TF_PROFILER_SAMPLE_DURATION_MS", 1000,
+                            &duration_ms);
+  }
+  if (s.ok()) {
+    s = ReadInt64FromEnvVar("TF_PROFILER_MAX_SAMPLES", 60, &max_samples);
+  }
+  if (!s.ok()) {
+    LOG(ERROR) << "Not sampling: " << s;
+    return nullptr;
+  }
+  if (period_ms <= 0) return nullptr;
+  if (duration_ms <= 0 || duration_ms >= period_ms || max_samples <= 0) {
+    LOG(ERROR) << "Not sampling: the sample duration (" << duration_ms
+               << " ms) must be positive and shorter than the sampling period ("
+               << period_ms << " ms), and at least one sample must be kept.";
+    return nullptr;
+  }
+
+  SamplingProfilerOptions options;
+  options.sampling_period = absl::Milliseconds(period_ms);
+  options.sample_duration = absl::Milliseconds(duration_ms);
+  options.max_samples = max_samples;
+  options.profile_options = ProfilerSession::DefaultOptions();
+  // Python tracing is too expensive to leave on.
+  options.profile_options.set_python_tracer_level(0);
+  auto profiler = std::make_unique<SamplingProfiler>(options);
+  profiler->Start();
+  return profiler;
+}
+
+}  // namespace
+
+SamplingProfiler* SamplingProfiler::Global() {
+  static SamplingProfiler* profiler = CreateFromEnv().release();
+  return profiler;
+}
+
+SamplingProfiler::SamplingProfiler(const SamplingProfilerOptions& options,
+                                   Env* env)
+    : options_(options), env_(env) {}
+
+SamplingProfiler::~SamplingProfiler() {
+  {
+    mutex_lock l(mu_);
+    stopping_ = true;
+    cond_var_.notify_all();
+  }
+  // Joins the sampling thread.
+  thread_.reset();
+}
+
+void SamplingProfiler::Start() {
+  DCHECK(thread_ == nullptr);
+  LOG(INFO) << "Sampling the profile for "
+            << absl::FormatDuration(options_.sample_duration) << " every "
+            << absl::FormatDuration(options_.sampling_period);
+  thread_.reset(env_->StartThread(ThreadOptions(), "tf_sampling_profiler",
+                                  [this]() { Run(); }));
+}
+
+void SamplingProfiler::Pause() {
+  mutex_lock l(mu_);
+  ++num_pauses_;
+  cond_var_.notify_all();
+  while (sampling_) cond_var_.wait(l);
+}
+
+void SamplingProfiler::Resume() {
+  mutex_lock l(mu_);
+  DCHECK_GT(num_pauses_, 0);
+  --num_pauses_;
+  cond_var_.notify_all();
+}
+
+void SamplingProfiler::Run() {
+  absl::Time next_sample = absl::Now() + options_.sampling_period;
+  while (true) {
+    {
+      mutex_lock l(mu_);
+      while (!stopping_ && (num_pauses_ > 0 || absl::Now() < next_sample)) {
+        const int64_t wait_ms =
+            num_pauses_ > 0 ? ToMillis(options_.sampling_period)
+                            : ToMillis(next_sample - absl::Now()) + 1;
+        WaitForMilliseconds(&l, &cond_var_, wait_ms);
+      }
+      if (stopping_) return;
+      sampling_ = true;
+    }
+    next_sample = absl::Now() + options_.sampling_period;
+    TakeSample();
+    mutex_lock l(mu_);
+    sampling_ = false;
+    cond_var_.notify_all();
+  }
+}
+
+void SamplingProfiler::TakeSample() {
+  const absl::Time start = absl::Now();
+  std::unique_ptr<ProfilerSession> session =
+      ProfilerSession::Create(options_.profile_options);
+  if (!session->Status().ok()) {
+    VLOG(1) << "Skipping profile sample: " << session->Status();
+    return;
+  }
+  {
+    const absl::Time end = start + options_.sample_duration;
+    mutex_lock l(mu_);
+    while (!stopping_ && num_pauses_ == 0 && absl::Now() < end) {
+      WaitForMilliseconds(&l, &cond_var_, ToMillis(end - absl::Now()) + 1);
+    }
+  }
+  XSpace space;
+  Status s = session->CollectData(&space);
+  const absl::Duration duration = absl::Now() - start;
+  session.reset();
+  if (!s.ok()) {
+    VLOG(1) << "Dropping profile sample: " << s;
+    return;
+  }
+
+  OpStatsOptions op_stats_options;
+  op_stats_options.generate_op_metrics_db = true;
+  OpStats op_stats = ConvertXSpaceToOpStats(space, op_stats_options);
+  AddSample(start, duration,
+            std::move(*op_stats.mutable_host_op_metrics_db()),
+            std::move(*op_stats.mutable_device_op_metrics_db()));
+}
+
+void SamplingProfiler::AddSample(absl::Time start, absl::Duration duration,
+                                 OpMetricsDb host_op_metrics_db,
+                                 OpMetricsDb device_op_metrics_db) {
+  mutex_lock l(mu_);
+  samples_.push_back({start, duration, std::move(host_op_metrics_db),
+                      std::move(device_op_metrics_db)});
+  while (samples_.size() > options_.max_samples) samples_.pop_front();
+}
+
+SamplingProfiler::Summary SamplingProfiler::Summarize(absl::Time since) const {
+  Summary summary;
+  OpMetricsDbCombiner host_combiner(&summary.host_op_metrics_db);
+  OpMetricsDbCombiner device_combiner(&summary.device_op_metrics_db);
+  mutex_lock l(mu_);
+  for (const Sample& sample : samples_) {
+    if (sample.start < since) continue;
+    ++summary.num_samples;
+    summary.sampled_time += sample.duration;
+    host_combiner.Combine(sample.host_op_metrics_db);
+    device_combiner.Combine(sample.device_op_metrics_db);
+  }
+  return summary;
+}
+
+std::string SamplingSummaryToString(const SamplingProfiler::Summary& summary,
+                                    int top_n) {
+  std::string out =
+      absl::StrCat(summary.num_samples, " samples covering ",
+                   absl::FormatDuration(summary.sampled_time), "\n");
+  absl::StrAppendFormat(
+      &out, "Host op time: %.3f ms\n",
+      summary.host_op_metrics_db.total_op_time_ps() / 1e9);
+  AppendTopOps(summary.host_op_metrics_db, top_n, &out);
+  absl::StrAppendFormat(
+      &out, "Device op time: %.3f ms\n",
+      summary.device_op_metrics_db.total_op_time_ps() / 1e9);
+  AppendTopOps(summary.device_op_metrics_db, top_n, &out);
+  return out;
+}
+
+}  // namespace profiler
+}  // namespace tensorflow
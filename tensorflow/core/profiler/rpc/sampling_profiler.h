@@ -0,0 +1,130 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_PROFILER_RPC_SAMPLING_PROFILER_H_
+#define TENSORFLOW_CORE_PROFILER_RPC_SAMPLING_PROFILER_H_
+
+#include <deque>
+#include <memory>
+#include <string>
+
+#include "absl/time/time.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/profiler/profiler_options.pb.h"
+#include "tensorflow/core/profiler/protobuf/op_metrics.pb.h"
+#include "tensorflow/core/profiler/protobuf/xplane.pb.h"
+
+namespace tensorflow {
+namespace profiler {
+
+struct SamplingProfilerOptions {
+  // Time between the starts of two consecutive samples.
+  absl::Duration sampling_period = absl::Seconds(60);
+  // How long each sample profiles for. The overhead of continuous sampling is
+  // roughly the overhead of tracing times sample_duration / sampling_period.
+  absl::Duration sample_duration = absl::Seconds(1);
+  // The number of most recent samples kept in memory.
+  int max_samples = 60;
+  // Options for the ProfilerSession of each sample.
+  ProfileOptions profile_options;
+};
+
+// Continuously profiles a small fraction of the time and keeps the per-op
+// metrics of the most recent samples in memory, so that they can be queried
+// (e.g. through the Monitor RPC of the profiler service) without a manual
+// trace capture.
+//
+// Every `sampling_period`, a background thread traces for `sample_duration`,
+// converts the trace to host and device OpMetricsDbs and drops it. Samples
+// are skipped while another ProfilerSession is active or while paused.
+class SamplingProfiler {
+ public:
+  // Aggregated op metrics over a number of samples.
+  struct Summary {
+    int num_samples = 0;
+    absl::Duration sampled_time;
+    OpMetricsDb host_op_metrics_db;
+    OpMetricsDb device_op_metrics_db;
+  };
+
+  // Returns the process-wide sampling profiler, started on first use, or
+  // nullptr if sampling is disabled. Sampling is enabled by setting
+  // TF_PROFILER_SAMPLING_PERIOD_MS to a positive value; the sample duration
+  // and the number of samples kept are read from
+  // TF_PROFILER_SAMPLE_DURATION_MS and TF_PROFILER_MAX_SAMPLES.
+  static SamplingProfiler* Global();
+
+  explicit SamplingProfiler(const SamplingProfilerOptions& options,
+                            Env* env = Env::Default());
+
+  // Stops the sampling thread, if any.
+  ~SamplingProfiler();
+
+  SamplingProfiler(const SamplingProfiler&) = delete;
+  void operator=(const SamplingProfiler&) = delete;
+
+  // Starts the sampling thread.
+  void Start();
+
+  // Stops taking samples until a matching Resume(). Cuts the sample in flight
+  // short, and returns once it completed so that the caller can start its own
+  // ProfilerSession.
+  void Pause();
+  void Resume();
+
+  // Records a sample that started at `start` and lasted `duration`. Called by
+  // the sampling thread; exposed for testing.
+  void AddSample(absl::Time start, absl::Duration duration,
+                 OpMetricsDb host_op_metrics_db,
+                 OpMetricsDb device_op_metrics_db);
+
+  // Combines the samples that started at or after `since`.
+  Summary Summarize(absl::Time since) const;
+
+ private:
+  struct Sample {
+    absl::Time start;
+    absl::Duration duration;
+    OpMetricsDb host_op_metrics_db;
+    OpMetricsDb device_op_metrics_db;
+  };
+
+  void Run();
+  // Traces for up to `sample_duration` and records the result.
+  void TakeSample();
+
+  const SamplingProfilerOptions options_;
+  Env* const env_;
+
+  mutable mutex mu_;
+  condition_variable cond_var_;
+  std::deque<Sample> samples_ TF_GUARDED_BY(mu_);
+  int num_pauses_ TF_GUARDED_BY(mu_) = 0;
+  bool sampling_ TF_GUARDED_BY(mu_) = false;
+  bool stopping_ TF_GUARDED_BY(mu_) = false;
+  std::unique_ptr<Thread> thread_;
+};
+
+// Formats `summary` for the Monitor RPC. Lists the `top_n` ops with the most
+// self time on the host and on devices; with `top_n` == 0 only the totals are
+// printed.
+std::string SamplingSummaryToString(const SamplingProfiler::Summary& summary,
+                                    int top_n);
+
+}  // namespace profiler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_PROFILER_RPC_SAMPLING_PROFILER_H_
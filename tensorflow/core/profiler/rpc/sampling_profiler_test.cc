@@ -0,0 +1,96 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/profiler/rpc/sampling_profiler.h"
+
+#include "absl/time/time.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/profiler/protobuf/op_metrics.pb.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace {
+
+OpMetricsDb MakeDb(const std::string& op, uint64 self_time_ps) {
+  OpMetricsDb db;
+  OpMetrics* metrics = db.add_metrics_db();
+  metrics->set_name(op);
+  metrics->set_category("MatMul");
+  metrics->set_occurrences(1);
+  metrics->set_time_ps(self_time_ps);
+  metrics->set_self_time_ps(self_time_ps);
+  db.set_total_op_time_ps(self_time_ps);
+  return db;
+}
+
+TEST(SamplingProfilerTest, SummarizesSamplesInWindow) {
+  SamplingProfilerOptions options;
+  SamplingProfiler profiler(options);
+  const absl::Time t0 = absl::FromUnixSeconds(1000);
+  profiler.AddSample(t0, absl::Seconds(1), MakeDb("a", 1000), OpMetricsDb());
+  profiler.AddSample(t0 + absl::Seconds(60), absl::Seconds(1),
+                     MakeDb("a", 2000), MakeDb("b", 500));
+
+  SamplingProfiler::Summary all = profiler.Summarize(absl::InfinitePast());
+  EXPECT_EQ(all.num_samples, 2);
+  EXPECT_EQ(all.sampled_time, absl::Seconds(2));
+  ASSERT_EQ(all.host_op_metrics_db.metrics_db_size(), 1);
+  EXPECT_EQ(all.host_op_metrics_db.metrics_db(0).occurrences(), 2);
+  EXPECT_EQ(all.host_op_metrics_db.metrics_db(0).self_time_ps(), 3000);
+  EXPECT_EQ(all.device_op_metrics_db.metrics_db_size(), 1);
+
+  SamplingProfiler::Summary recent =
+      profiler.Summarize(t0 + absl::Seconds(30));
+  EXPECT_EQ(recent.num_samples, 1);
+  EXPECT_EQ(recent.host_op_metrics_db.metrics_db(0).self_time_ps(), 2000);
+}
+
+TEST(SamplingProfilerTest, KeepsMostRecentSamples) {
+  SamplingProfilerOptions options;
+  options.max_samples = 2;
+  SamplingProfiler profiler(options);
+  const absl::Time t0 = absl::FromUnixSeconds(1000);
+  for (int i = 0; i < 5; ++i) {
+    profiler.AddSample(t0 + absl::Seconds(i), absl::Seconds(1),
+                       MakeDb("a", 1000), OpMetricsDb());
+  }
+  SamplingProfiler::Summary all = profiler.Summarize(absl::InfinitePast());
+  EXPECT_EQ(all.num_samples, 2);
+  EXPECT_EQ(all.host_op_metrics_db.metrics_db(0).self_time_ps(), 2000);
+}
+
+TEST(SamplingProfilerTest, SummaryToString) {
+  SamplingProfiler::Summary summary;
+  summary.num_samples = 1;
+  summary.sampled_time = absl::Seconds(1);
+  summary.host_op_metrics_db = MakeDb("matmul_op", 2000000000);
+
+  const std::string totals = SamplingSummaryToString(summary, /*top_n=*/0);
+  EXPECT_NE(totals.find("1 samples covering 1s"), std::string::npos);
+  EXPECT_NE(totals.find("Host op time: 2.000 ms"), std::string::npos);
+  EXPECT_EQ(totals.find("matmul_op"), std::string::npos);
+
+  const std::string top = SamplingSummaryToString(summary, /*top_n=*/10);
+  EXPECT_NE(top.find("matmul_op (MatMul): self 2.000 ms"), std::string::npos);
+}
+
+TEST(SamplingProfilerTest, PauseWithoutThread) {
+  SamplingProfiler profiler(SamplingProfilerOptions{});
+  profiler.Pause();
+  profiler.Resume();
+}
+
+}  // namespace
+}  // namespace profiler
+}  // namespace tensorflow
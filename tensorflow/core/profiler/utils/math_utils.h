@@ -32,6 +32,7 @@ inline double PicoToUni(uint64_t p) { return p / 1E12; }
 inline uint64_t NanoToPico(uint64_t n) { return n * 1000; }
 inline double NanoToMicro(uint64_t n) { return n / 1E3; }
 inline double NanoToMilli(uint64_t n) { return n / 1E6; }
+inline uint64_t MicroToPico(uint64_t u) { return u * 1000000; }
 inline double MicroToNano(double u) { return u * 1E3; }
 inline double MicroToMilli(double u) { return u / 1E3; }
 inline uint64_t MilliToPico(double m) { return m * 1E9; }
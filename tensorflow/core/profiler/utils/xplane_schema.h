@@ -52,6 +52,8 @@ TF_CONST_INIT extern const absl::string_view kMetadataPlaneName;
 TF_CONST_INIT extern const absl::string_view kTFStreamzPlaneName;
 // Name of XPlane that contains events from python tracer.
 TF_CONST_INIT extern const absl::string_view kPythonTracerPlaneName;
+// Name of XPlane that contains sampled XLA:CPU HLO executions.
+TF_CONST_INIT extern const absl::string_view kXlaCpuSamplesPlaneName;
 
 // Names of XLines that contain ML-level events.
 TF_CONST_INIT extern const absl::string_view kStepLineName;
@@ -19,6 +19,7 @@ limitations under the License.
 #include <string>
 #include <vector>
 
+#include "absl/types/span.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -274,6 +275,27 @@ class Session {
         "RunCallable with threadpool is not supported for this session.");
   }
 
+  /// \brief Invokes the subgraph named by `handle` like `RunCallable()`, but
+  /// writes the fetched values into the caller-allocated tensors in
+  /// `fetch_buffers`.
+  ///
+  /// `fetch_buffers` must contain one initialized tensor per name in
+  /// `CallableOptions::fetch()`, with the type and shape of the fetched value.
+  /// The tensors may share a caller-owned buffer (e.g. through a custom
+  /// `TensorBuffer`), which must remain valid until this method returns. The
+  /// kernels that produce the fetched values on a CPU device allocate their
+  /// outputs directly in these buffers when they can. Otherwise, the values are
+  /// copied into them, so only types for which `DataTypeCanUseMemcpy()` holds
+  /// are supported.
+  /// NOTE: This API is still experimental and may change.
+  virtual Status RunCallableWithFetchBuffers(
+      CallableHandle handle, const std::vector<Tensor>& feed_tensors,
+      absl::Span<Tensor> fetch_buffers, RunMetadata* run_metadata,
+      const thread::ThreadPoolOptions& threadpool_options) {
+    return errors::Unimplemented(
+        "RunCallableWithFetchBuffers is not supported for this session.");
+  }
+
   /// \brief Releases resources associated with the given `handle` in this
   /// session.
   /// NOTE: This API is still experimental and may change.
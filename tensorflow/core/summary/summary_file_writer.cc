@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/core/framework/summary.pb.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/summary/summary_converter.h"
 #include "tensorflow/core/util/events_writer.h"
 #include "tensorflow/core/util/ptr_util.h"
@@ -29,13 +30,28 @@ limitations under the License.
 namespace tensorflow {
 namespace {
 
+auto* async_dropped_events = monitoring::Counter<0>::New(
+    "/tensorflow/core/summary_file_writer/async_dropped_events",
+    "The number of summary events dropped because the queue of an "
+    "asynchronous summary file writer was full.");
+
+auto* async_blocked_writes = monitoring::Counter<0>::New(
+    "/tensorflow/core/summary_file_writer/async_blocked_writes",
+    "The number of summary writes that waited for the queue of an "
+    "asynchronous summary file writer to drain.");
+
 class SummaryFileWriter : public SummaryWriterInterface {
  public:
-  SummaryFileWriter(int max_queue, int flush_millis, Env* env)
+  // If max_pending is positive, events are written from a background thread
+  // and at most max_pending of them are queued.
+  SummaryFileWriter(int max_queue, int flush_millis, int max_pending,
+                    bool drop_when_full, Env* env)
       : SummaryWriterInterface(),
         is_initialized_(false),
         max_queue_(max_queue),
         flush_millis_(flush_millis),
+        max_pending_(max_pending),
+        drop_when_full_(drop_when_full),
         env_(env) {}
 
   Status Initialize(const string& logdir, const string& filename_suffix) {
@@ -62,10 +78,16 @@ class SummaryFileWriter : public SummaryWriterInterface {
         "Could not initialize events writer.");
     last_flush_ = env_->NowMicros();
     is_initialized_ = true;
+    if (max_pending_ > 0) {
+      flush_thread_.reset(env_->StartThread(ThreadOptions(),
+                                            "summary_file_writer",
+                                            [this]() { FlushLoop(); }));
+    }
     return Status::OK();
   }
 
   Status Flush() override {
+    if (max_pending_ > 0) return AsyncFlush();
     mutex_lock ml(mu_);
     if (!is_initialized_) {
       return errors::FailedPrecondition("Class was not properly initialized.");
@@ -74,6 +96,15 @@ class SummaryFileWriter : public SummaryWriterInterface {
   }
 
   ~SummaryFileWriter() override {
+    if (flush_thread_) {
+      {
+        mutex_lock ml(mu_);
+        stopping_ = true;
+        cond_var_.notify_all();
+      }
+      // Joins the thread.
+      flush_thread_.reset();
+    }
     (void)Flush();  // Ignore errors.
   }
 
@@ -150,6 +181,7 @@ class SummaryFileWriter : public SummaryWriterInterface {
   }
 
   Status WriteEvent(std::unique_ptr<Event> event) override {
+    if (max_pending_ > 0) return AsyncWriteEvent(std::move(event));
     mutex_lock ml(mu_);
     queue_.emplace_back(std::move(event));
     if (queue_.size() > max_queue_ ||
@@ -167,25 +199,114 @@ class SummaryFileWriter : public SummaryWriterInterface {
   }
 
   Status InternalFlush() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-    for (const std::unique_ptr<Event>& e : queue_) {
+    Status s = WriteEvents(queue_);
+    queue_.clear();
+    TF_RETURN_IF_ERROR(s);
+    last_flush_ = env_->NowMicros();
+    return Status::OK();
+  }
+
+  // Queues the event for the background thread and returns the error of the
+  // last background write, if any.
+  Status AsyncWriteEvent(std::unique_ptr<Event> event) {
+    mutex_lock ml(mu_);
+    if (queue_.size() >= max_pending_) {
+      if (drop_when_full_) {
+        async_dropped_events->GetCell()->IncrementBy(1);
+        return ConsumeAsyncStatus();
+      }
+      async_blocked_writes->GetCell()->IncrementBy(1);
+      cond_var_.notify_all();
+      while (queue_.size() >= max_pending_ && !stopping_) cond_var_.wait(ml);
+    }
+    queue_.emplace_back(std::move(event));
+    if (queue_.size() > max_queue_) cond_var_.notify_all();
+    return ConsumeAsyncStatus();
+  }
+
+  Status ConsumeAsyncStatus() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    Status s = async_status_;
+    async_status_ = Status::OK();
+    return s;
+  }
+
+  // Writes and flushes the queued events on the calling thread.
+  Status AsyncFlush() {
+    mutex_lock wl(writer_mu_);
+    std::vector<std::unique_ptr<Event>> events;
+    {
+      mutex_lock ml(mu_);
+      if (!is_initialized_) {
+        return errors::FailedPrecondition(
+            "Class was not properly initialized.");
+      }
+      events.swap(queue_);
+      cond_var_.notify_all();
+    }
+    Status s = WriteEvents(events);
+    mutex_lock ml(mu_);
+    last_flush_ = env_->NowMicros();
+    s.Update(ConsumeAsyncStatus());
+    return s;
+  }
+
+  // Requires mu_ in synchronous mode and writer_mu_ in asynchronous mode.
+  Status WriteEvents(const std::vector<std::unique_ptr<Event>>& events) {
+    for (const std::unique_ptr<Event>& e : events) {
       events_writer_->WriteEvent(*e);
     }
-    queue_.clear();
     TF_RETURN_WITH_CONTEXT_IF_ERROR(events_writer_->Flush(),
                                     "Could not flush events file.");
-    last_flush_ = env_->NowMicros();
     return Status::OK();
   }
 
+  // Flushes whenever more than max_queue events are queued or flush_millis
+  // passed since the last flush.
+  void FlushLoop() {
+    while (true) {
+      {
+        mutex_lock ml(mu_);
+        while (!stopping_ && queue_.size() <= max_queue_) {
+          const int64_t wait_millis =
+              flush_millis_ -
+              static_cast<int64_t>(env_->NowMicros() - last_flush_) / 1000;
+          if (wait_millis <= 0) break;
+          WaitForMilliseconds(&ml, &cond_var_, wait_millis);
+        }
+        if (stopping_) return;
+        if (queue_.empty()) {
+          last_flush_ = env_->NowMicros();
+          continue;
+        }
+      }
+      Status s = AsyncFlush();
+      if (!s.ok()) {
+        mutex_lock ml(mu_);
+        async_status_.Update(s);
+      }
+    }
+  }
+
   bool is_initialized_;
   const int max_queue_;
   const int flush_millis_;
+  const int max_pending_;
+  const bool drop_when_full_;
   uint64 last_flush_;
   Env* env_;
+  // In asynchronous mode, serializes the writes to events_writer_ and is
+  // acquired before mu_.
+  mutex writer_mu_;
   mutex mu_;
+  condition_variable cond_var_;
+  bool stopping_ TF_GUARDED_BY(mu_) = false;
+  // The first error of the background thread since the last write.
+  Status async_status_ TF_GUARDED_BY(mu_);
+  std::unique_ptr<Thread> flush_thread_;
   std::vector<std::unique_ptr<Event>> queue_ TF_GUARDED_BY(mu_);
-  // A pointer to allow deferred construction.
-  std::unique_ptr<EventsWriter> events_writer_ TF_GUARDED_BY(mu_);
+  // A pointer to allow deferred construction. Guarded by mu_ in synchronous
+  // mode and by writer_mu_ in asynchronous mode.
+  std::unique_ptr<EventsWriter> events_writer_;
   std::vector<std::pair<string, SummaryMetadata>> registered_summaries_
       TF_GUARDED_BY(mu_);
 };
@@ -196,7 +317,19 @@ Status CreateSummaryFileWriter(int max_queue, int flush_millis,
                                const string& logdir,
                                const string& filename_suffix, Env* env,
                                SummaryWriterInterface** result) {
-  SummaryFileWriter* w = new SummaryFileWriter(max_queue, flush_millis, env);
+  return CreateAsyncSummaryFileWriter(max_queue, flush_millis,
+                                      /*max_pending=*/0,
+                                      /*drop_when_full=*/false, logdir,
+                                      filename_suffix, env, result);
+}
+
+Status CreateAsyncSummaryFileWriter(int max_queue, int flush_millis,
+                                    int max_pending, bool drop_when_full,
+                                    const string& logdir,
+                                    const string& filename_suffix, Env* env,
+                                    SummaryWriterInterface** result) {
+  SummaryFileWriter* w = new SummaryFileWriter(
+      max_queue, flush_millis, max_pending, drop_when_full, env);
   const Status s = w->Initialize(logdir, filename_suffix);
   if (!s.ok()) {
     w->Unref();
@@ -38,6 +38,23 @@ Status CreateSummaryFileWriter(int max_queue, int flush_millis,
                                const string& filename_suffix, Env* env,
                                SummaryWriterInterface** result);
 
+/// \brief Creates a SummaryWriterInterface which writes to a file from a
+/// background thread.
+///
+/// Like CreateSummaryFileWriter, except that the events are serialized,
+/// written and flushed by a background thread, so that slow file systems do
+/// not stall the threads writing summaries. The background thread flushes
+/// once more than max_queue events are queued or flush_millis milliseconds
+/// passed. At most max_pending events are queued: when the queue is full,
+/// writes drop their event if drop_when_full is true, and otherwise wait for
+/// the background thread to catch up. Errors of the background thread are
+/// returned by the next write or Flush().
+Status CreateAsyncSummaryFileWriter(int max_queue, int flush_millis,
+                                    int max_pending, bool drop_when_full,
+                                    const string& logdir,
+                                    const string& filename_suffix, Env* env,
+                                    SummaryWriterInterface** result);
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_SUMMARY_SUMMARY_FILE_WRITER_H_
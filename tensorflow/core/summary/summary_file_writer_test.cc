@@ -87,6 +87,30 @@ class SummaryFileWriterTest : public ::testing::Test {
     return Status::OK();
   }
 
+  // Returns the steps of the events in the file written for `test_name`.
+  std::vector<int64_t> ReadSteps(const string& test_name) {
+    std::vector<string> files;
+    TF_CHECK_OK(env_.GetChildren(testing::TmpDir(), &files));
+    std::vector<int64_t> steps;
+    for (const string& f : files) {
+      if (!absl::StrContains(f, test_name)) continue;
+      std::unique_ptr<RandomAccessFile> read_file;
+      TF_CHECK_OK(env_.NewRandomAccessFile(io::JoinPath(testing::TmpDir(), f),
+                                           &read_file));
+      io::RecordReader reader(read_file.get(), io::RecordReaderOptions());
+      tstring record;
+      uint64 offset = 0;
+      // The first event is irrelevant.
+      TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+      while (reader.ReadRecord(&offset, &record).ok()) {
+        Event e;
+        e.ParseFromString(record);
+        steps.push_back(e.step());
+      }
+    }
+    return steps;
+  }
+
   FakeClockEnv env_;
 };
 
@@ -259,6 +283,45 @@ TEST_F(SummaryFileWriterTest, WallTime) {
       [](const Event& e) { EXPECT_EQ(e.wall_time(), 7.023); }));
 }
 
+std::unique_ptr<Event> MakeEvent(int64_t step) {
+  std::unique_ptr<Event> e{new Event};
+  e->set_step(step);
+  return e;
+}
+
+TEST_F(SummaryFileWriterTest, AsyncWritesInOrder) {
+  SummaryWriterInterface* writer;
+  TF_CHECK_OK(CreateAsyncSummaryFileWriter(
+      /*max_queue=*/3, /*flush_millis=*/1, /*max_pending=*/4,
+      /*drop_when_full=*/false, testing::TmpDir(), "async_test", &env_,
+      &writer));
+  for (int i = 0; i < 100; ++i) {
+    TF_CHECK_OK(writer->WriteEvent(MakeEvent(i)));
+  }
+  TF_CHECK_OK(writer->Flush());
+  writer->Unref();
+  std::vector<int64_t> steps = ReadSteps("async_test");
+  ASSERT_EQ(steps.size(), 100);
+  for (int i = 0; i < 100; ++i) EXPECT_EQ(steps[i], i);
+}
+
+TEST_F(SummaryFileWriterTest, AsyncDropsWhenFull) {
+  SummaryWriterInterface* writer;
+  // The background thread never flushes: the queue never exceeds max_queue
+  // and the fake clock does not advance.
+  TF_CHECK_OK(CreateAsyncSummaryFileWriter(
+      /*max_queue=*/10, /*flush_millis=*/1000, /*max_pending=*/2,
+      /*drop_when_full=*/true, testing::TmpDir(), "async_drop_test", &env_,
+      &writer));
+  for (int i = 0; i < 5; ++i) {
+    TF_CHECK_OK(writer->WriteEvent(MakeEvent(i)));
+  }
+  TF_CHECK_OK(writer->Flush());
+  TF_CHECK_OK(writer->WriteEvent(MakeEvent(5)));
+  writer->Unref();
+  EXPECT_EQ(ReadSteps("async_drop_test"), std::vector<int64_t>({0, 1, 5}));
+}
+
 TEST_F(SummaryFileWriterTest, AvoidFilenameCollision) {
   // Keep unique with all other test names in this file.
   string test_name = "avoid_filename_collision_test";
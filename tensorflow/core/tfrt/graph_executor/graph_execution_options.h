@@ -47,6 +47,19 @@ struct GraphExecutionOptions {
   tensorflow::SessionMetadata model_metadata;
 
   tensorflow::TfrtCompileOptions compile_options;
+
+  // The maximum number of loaded client graphs kept by a `GraphExecutor`. When
+  // exceeded, the least recently used one is dropped and will be recompiled
+  // on its next use. Zero means no limit.
+  int max_loaded_client_graphs = 0;
+
+  // If true, a request whose feeds and targets match an already loaded client
+  // graph, and whose fetches are a subset of that graph's fetches, runs that
+  // graph instead of compiling a new one. This saves load time and memory for
+  // models with many overlapping signatures, at the cost of computing the
+  // unused fetches. Only enable it if computing extra fetches has no side
+  // effects.
+  bool reuse_client_graphs_with_more_fetches = false;
 };
 
 // Per-request options for graph execution.
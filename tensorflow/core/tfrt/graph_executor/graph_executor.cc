@@ -25,6 +25,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "absl/time/clock.h"
@@ -35,6 +36,7 @@ limitations under the License.
 #include "tensorflow/compiler/mlir/tfrt/translate/import_model.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
@@ -74,6 +76,24 @@ constexpr char kDeadlineExceededMessage[] = "Deadline exceeded.";
 constexpr char kTensorNameJoiningDelimiter[] = "-";
 constexpr char kArgumentTypeJoiningDelimiter[] = "^";
 
+auto* client_graph_cache_hits = tensorflow::monitoring::Counter<1>::New(
+    "/tensorflow/tfrt/graph_executor/client_graph_cache_hits",
+    "The number of requests served by a cached client graph.", "model_name");
+
+auto* client_graph_cache_misses = tensorflow::monitoring::Counter<1>::New(
+    "/tensorflow/tfrt/graph_executor/client_graph_cache_misses",
+    "The number of requests that compiled a new client graph.", "model_name");
+
+auto* client_graph_cache_reuses = tensorflow::monitoring::Counter<1>::New(
+    "/tensorflow/tfrt/graph_executor/client_graph_cache_reuses",
+    "The number of new input/output combinations served by an existing client "
+    "graph with more fetches.",
+    "model_name");
+
+auto* client_graph_cache_evictions = tensorflow::monitoring::Counter<1>::New(
+    "/tensorflow/tfrt/graph_executor/client_graph_cache_evictions",
+    "The number of client graphs evicted from the cache.", "model_name");
+
 }  // namespace
 
 StatusOr<std::unique_ptr<RequestInfo>> SetUpRequestContext(
@@ -367,10 +387,11 @@ tensorflow::Status GraphExecutor::Run(
   std::sort(sorted_target_node_names.begin(), sorted_target_node_names.end());
 
   // Load the client graph.
-  TF_ASSIGN_OR_RETURN(const LoadedClientGraph& loaded_client_graph,
+  TF_ASSIGN_OR_RETURN(LoadedClientGraphRef loaded_client_graph_ref,
                       GetOrCreateLoadedClientGraph(
                           sorted_input_names, sorted_input_dtypes,
                           sorted_output_names, sorted_target_node_names));
+  const LoadedClientGraph& loaded_client_graph = *loaded_client_graph_ref.graph;
 
   const auto* func = loaded_client_graph.bef_file->GetFunction(
       tensorflow::kImportModelDefaultGraphFuncName);
@@ -392,12 +413,14 @@ tensorflow::Status GraphExecutor::Run(
       req_deadline_tracker_));
 
   // Create the outputs from the actual function results, which are sorted
-  // according to the output tensor names.
-  auto flat_output_iter = flat_outputs.begin();
-  outputs->resize(flat_outputs.size());
-  for (int original_index : output_original_indices) {
-    (*outputs)[original_index] = std::move(*flat_output_iter);
-    ++flat_output_iter;
+  // according to the output tensor names of the loaded client graph.
+  const std::vector<int>& output_indices =
+      loaded_client_graph_ref.output_indices;
+  outputs->resize(output_original_indices.size());
+  for (int i = 0; i < output_original_indices.size(); ++i) {
+    const int flat_index = output_indices.empty() ? i : output_indices[i];
+    (*outputs)[output_original_indices[i]] =
+        std::move(flat_outputs[flat_index]);
   }
 
   return tensorflow::Status::OK();
@@ -411,6 +434,13 @@ StatusOr<std::unique_ptr<GraphExecutor::LoadedClientGraph>>
 GraphExecutor::LoadClientGraph(const GraphExecutor::ClientGraph& client_graph) {
   auto loaded_client_graph = std::make_unique<LoadedClientGraph>();
   loaded_client_graph->name = client_graph.name;
+  for (const auto& input_node : client_graph.input_nodes) {
+    loaded_client_graph->input_names.push_back(input_node.first);
+  }
+  std::sort(loaded_client_graph->input_names.begin(),
+            loaded_client_graph->input_names.end());
+  loaded_client_graph->output_names = client_graph.output_nodes;
+  loaded_client_graph->target_names = client_graph.target_nodes;
   loaded_client_graph->resource_context = CreateResourceContext(
       runtime(), tpu_model_resource_, options_.compile_options.tpu_target);
 
@@ -489,7 +519,7 @@ tensorflow::Status GraphExecutor::InitBef(
   return tensorflow::Status::OK();
 }
 
-StatusOr<std::reference_wrapper<const GraphExecutor::LoadedClientGraph>>
+StatusOr<GraphExecutor::LoadedClientGraphRef>
 GraphExecutor::GetOrCreateLoadedClientGraph(
     absl::Span<const std::string> input_tensor_names,
     absl::Span<const tensorflow::DataType> input_tensor_dtypes,
@@ -504,13 +534,33 @@ GraphExecutor::GetOrCreateLoadedClientGraph(
       kArgumentTypeJoiningDelimiter,
       absl::StrJoin(target_tensor_names, kTensorNameJoiningDelimiter));
 
+  const std::string& model_name = options_.model_metadata.name();
   tensorflow::mutex_lock l(loaded_client_graphs_mu_);
 
   // Cache hit; return immediately.
   const auto iter = loaded_client_graphs_.find(joined_name);
-  if (iter != loaded_client_graphs_.end()) return {*iter->second};
+  if (iter != loaded_client_graphs_.end()) {
+    client_graph_cache_hits->GetCell(model_name)->IncrementBy(1);
+    loaded_client_graphs_lru_.splice(loaded_client_graphs_lru_.begin(),
+                                     loaded_client_graphs_lru_,
+                                     iter->second.lru_iter);
+    return iter->second.ref;
+  }
+
+  // A graph compiled for more fetches can serve this request as well.
+  if (options_.reuse_client_graphs_with_more_fetches) {
+    absl::optional<LoadedClientGraphRef> ref =
+        FindLoadedClientGraphWithMoreFetches(
+            input_tensor_names, output_tensor_names, target_tensor_names);
+    if (ref.has_value()) {
+      client_graph_cache_reuses->GetCell(model_name)->IncrementBy(1);
+      InsertLoadedClientGraph(joined_name, *ref);
+      return *std::move(ref);
+    }
+  }
 
   // Cache miss; populate a `ClientGraph` and load it.
+  client_graph_cache_misses->GetCell(model_name)->IncrementBy(1);
   tensorflow::GraphImportConfig::InputArrays input_nodes;
   DCHECK_EQ(input_tensor_names.size(), input_tensor_dtypes.size());
   for (int i = 0; i < input_tensor_names.size(); ++i) {
@@ -530,9 +580,62 @@ GraphExecutor::GetOrCreateLoadedClientGraph(
   TF_ASSIGN_OR_RETURN(auto loaded_client_graph, LoadClientGraph(client_graph));
 
   // Store the new loaded client graph in cache and return.
-  const auto* loaded_client_graph_ptr = loaded_client_graph.get();
-  loaded_client_graphs_[joined_name] = std::move(loaded_client_graph);
-  return {*loaded_client_graph_ptr};
+  LoadedClientGraphRef ref{std::move(loaded_client_graph), {}};
+  InsertLoadedClientGraph(joined_name, ref);
+  return ref;
+}
+
+absl::optional<GraphExecutor::LoadedClientGraphRef>
+GraphExecutor::FindLoadedClientGraphWithMoreFetches(
+    absl::Span<const std::string> input_tensor_names,
+    absl::Span<const std::string> output_tensor_names,
+    absl::Span<const std::string> target_tensor_names) {
+  // Search in recency order so that the hottest graph is preferred.
+  for (const std::string& name : loaded_client_graphs_lru_) {
+    const LoadedClientGraphRef& candidate =
+        loaded_client_graphs_.find(name)->second.ref;
+    const LoadedClientGraph& graph = *candidate.graph;
+    if (!absl::c_equal(graph.input_names, input_tensor_names) ||
+        !absl::c_equal(graph.target_names, target_tensor_names)) {
+      continue;
+    }
+    // Both lists of output names are sorted, so they can be merged in one
+    // pass. Duplicated names in the request map to the same output.
+    std::vector<int> output_indices;
+    output_indices.reserve(output_tensor_names.size());
+    int j = 0;
+    for (const std::string& output_name : output_tensor_names) {
+      while (j < graph.output_names.size() &&
+             graph.output_names[j] < output_name) {
+        ++j;
+      }
+      if (j == graph.output_names.size() ||
+          graph.output_names[j] != output_name) {
+        break;
+      }
+      output_indices.push_back(j);
+    }
+    if (output_indices.size() == output_tensor_names.size()) {
+      return LoadedClientGraphRef{candidate.graph, std::move(output_indices)};
+    }
+  }
+  return absl::nullopt;
+}
+
+void GraphExecutor::InsertLoadedClientGraph(const std::string& joined_name,
+                                            LoadedClientGraphRef ref) {
+  loaded_client_graphs_lru_.push_front(joined_name);
+  loaded_client_graphs_[joined_name] = {std::move(ref),
+                                        loaded_client_graphs_lru_.begin()};
+  if (options_.max_loaded_client_graphs <= 0) return;
+  while (loaded_client_graphs_lru_.size() >
+         static_cast<size_t>(options_.max_loaded_client_graphs)) {
+    VLOG(1) << "Evicting client graph " << loaded_client_graphs_lru_.back();
+    loaded_client_graphs_.erase(loaded_client_graphs_lru_.back());
+    loaded_client_graphs_lru_.pop_back();
+    client_graph_cache_evictions->GetCell(options_.model_metadata.name())
+        ->IncrementBy(1);
+  }
 }
 
 }  // namespace tfrt_stub
@@ -16,10 +16,14 @@ limitations under the License.
 #define TENSORFLOW_CORE_TFRT_GRAPH_EXECUTOR_GRAPH_EXECUTOR_H_
 
 #include <functional>
+#include <list>
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/optional.h"
 #include "mlir/IR/BuiltinOps.h"  // from @llvm-project
 #include "tensorflow/core/common_runtime/graph_execution_state.h"
 #include "tensorflow/core/protobuf/config.pb.h"
@@ -119,6 +123,10 @@ class GraphExecutor {
   // The loading result of a `ClientGraph`.
   struct LoadedClientGraph {
     std::string name;
+    // The sorted input/output/target names the graph was compiled for.
+    std::vector<std::string> input_names;
+    std::vector<std::string> output_names;
+    std::vector<std::string> target_names;
     tfrt::BefBuffer bef;
     tfrt::RCReference<tfrt::BEFFile> bef_file;
     std::unique_ptr<tfrt::ResourceContext> resource_context;
@@ -148,16 +156,38 @@ class GraphExecutor {
   tensorflow::Status InitBef(tfrt::BEFFile* bef_file,
                              tfrt::ResourceContext* resource_context);
 
-  // Returns a `LoadedClientGraph` given input/output tensor info. If there is
+  // A loaded client graph that can serve a request, and where to find the
+  // requested outputs among its outputs.
+  struct LoadedClientGraphRef {
+    std::shared_ptr<const LoadedClientGraph> graph;
+    // For the i-th requested output in sorted order, its index in the outputs
+    // of `graph`. Empty if `graph` has exactly the requested outputs.
+    std::vector<int> output_indices;
+  };
+
+  // Returns the `LoadedClientGraph` given input/output tensor info. If there is
   // no existing one yet, creates one first.
-  StatusOr<std::reference_wrapper<const GraphExecutor::LoadedClientGraph>>
-  GetOrCreateLoadedClientGraph(
+  StatusOr<LoadedClientGraphRef> GetOrCreateLoadedClientGraph(
       absl::Span<const std::string> input_tensor_names,
       absl::Span<const tensorflow::DataType> input_tensor_dtypes,
       absl::Span<const std::string> output_tensor_names,
       absl::Span<const std::string> target_tensor_names)
       TF_LOCKS_EXCLUDED(loaded_client_graphs_mu_);
 
+  // Finds a loaded client graph with the given inputs and targets whose outputs
+  // include `output_tensor_names`, or returns nullopt.
+  absl::optional<LoadedClientGraphRef> FindLoadedClientGraphWithMoreFetches(
+      absl::Span<const std::string> input_tensor_names,
+      absl::Span<const std::string> output_tensor_names,
+      absl::Span<const std::string> target_tensor_names)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(loaded_client_graphs_mu_);
+
+  // Caches `ref` under `joined_name` as the most recently used entry, evicting
+  // the least recently used entries beyond `max_loaded_client_graphs`.
+  void InsertLoadedClientGraph(const std::string& joined_name,
+                               LoadedClientGraphRef ref)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(loaded_client_graphs_mu_);
+
   const tensorflow::tfrt_stub::Runtime& runtime() const {
     DCHECK(options_.runtime);
     return *options_.runtime;
@@ -172,13 +202,21 @@ class GraphExecutor {
 
   tfrt::RequestDeadlineTracker req_deadline_tracker_;
 
+  struct LoadedClientGraphCacheEntry {
+    LoadedClientGraphRef ref;
+    std::list<std::string>::iterator lru_iter;
+  };
+
   tensorflow::mutex loaded_client_graphs_mu_;
-  // Caches `LoadedClientGraph` by the joined name.
-  // For pointer stability of values in `absl::flat_hash_map<>`, additional
-  // `std::unique_ptr<>` is necessary. (See https://abseil.io/tips/136.)
-  absl::flat_hash_map<std::string /*joined_name*/,
-                      std::unique_ptr<LoadedClientGraph>>
+  // Caches `LoadedClientGraph` by the joined name. The graphs are shared so
+  // that an entry can be evicted while a request is still running it, and so
+  // that several entries can refer to one graph when
+  // `reuse_client_graphs_with_more_fetches` is enabled.
+  absl::flat_hash_map<std::string /*joined_name*/, LoadedClientGraphCacheEntry>
       loaded_client_graphs_ TF_GUARDED_BY(loaded_client_graphs_mu_);
+  // The joined names in `loaded_client_graphs_`, most recently used first.
+  std::list<std::string> loaded_client_graphs_lru_
+      TF_GUARDED_BY(loaded_client_graphs_mu_);
 };
 
 }  // namespace tfrt_stub
@@ -0,0 +1,121 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Benchmarks of the per-node overhead of the TFRT `GraphExecutor`, on the same
+// synthetic graphs as "common_runtime/executor_overhead_benchmark_test.cc".
+//
+// Run with --benchmark_filter=all; set TEST_REPORT_FILE_PREFIX to record the
+// results as `BenchmarkEntries` protos.
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/executor_benchmark_util.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/tfrt/graph_executor/graph_executor.h"
+#include "tensorflow/core/tfrt/saved_model/saved_model_testutil.h"
+
+namespace tensorflow {
+namespace tfrt_stub {
+namespace {
+
+// Owns a `GraphExecutor` for `graph`, and the state it depends on.
+class BenchmarkGraphExecutor {
+ public:
+  explicit BenchmarkGraphExecutor(const test::ExecutorBenchmarkGraph& graph)
+      : runtime_(DefaultTfrtRuntime(/*num_threads=*/4)),
+        tpu_model_resource_(std::make_unique<tfrt::tpu::TpuModelResource>()) {
+    GraphExecutor::Options options(runtime_.get());
+    auto fallback_state = FallbackState::Create(
+        CreateDefaultSessionOptions(options), graph.graph_def.library());
+    TF_CHECK_OK(fallback_state.status());
+    fallback_state_ = std::move(fallback_state).ValueOrDie();
+    auto graph_executor =
+        GraphExecutor::Create(std::move(options), *fallback_state_,
+                              tpu_model_resource_.get(), graph.graph_def);
+    TF_CHECK_OK(graph_executor.status());
+    graph_executor_ = std::move(graph_executor).ValueOrDie();
+    inputs_.push_back(
+        {test::kExecutorBenchmarkInput, test::ExecutorBenchmarkFeed()});
+    output_names_.push_back(test::kExecutorBenchmarkOutput);
+  }
+
+  Status Run(std::vector<Tensor>* outputs) {
+    return graph_executor_->Run(/*run_options=*/{}, inputs_, output_names_,
+                                /*target_tensor_names=*/{}, outputs);
+  }
+
+ private:
+  std::unique_ptr<Runtime> runtime_;
+  std::unique_ptr<tfrt::tpu::TpuModelResource> tpu_model_resource_;
+  std::unique_ptr<FallbackState> fallback_state_;
+  std::unique_ptr<GraphExecutor> graph_executor_;
+  std::vector<std::pair<std::string, Tensor>> inputs_;
+  std::vector<std::string> output_names_;
+};
+
+void CheckGraph(const test::ExecutorBenchmarkGraph& graph) {
+  BenchmarkGraphExecutor graph_executor(graph);
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(graph_executor.Run(&outputs));
+  ASSERT_EQ(1, outputs.size());
+  test::ExpectTensorEqual<float>(
+      test::AsScalar<float>(graph.expected_output), outputs[0]);
+}
+
+TEST(GraphExecutorBenchmarkTest, Graphs) {
+  CheckGraph(test::ChainGraph(16));
+  CheckGraph(test::FanOutGraph(16));
+  CheckGraph(test::WhileLoopGraph(16));
+  CheckGraph(test::ConstFeedsGraph(16));
+}
+
+void RunGraphExecutorBenchmark(const test::ExecutorBenchmarkGraph& graph,
+                               ::testing::benchmark::State& state) {
+  BenchmarkGraphExecutor graph_executor(graph);
+  std::vector<Tensor> outputs;
+  // Warm up, so that one-time initialization is not measured.
+  TF_CHECK_OK(graph_executor.Run(&outputs));
+  for (auto s : state) {
+    outputs.clear();
+    TF_CHECK_OK(graph_executor.Run(&outputs));
+  }
+  test::SetExecutorBenchmarkCounters(graph, state);
+}
+
+// Benchmarks running the graph built by `BUILDER(state.range(0))` under the
+// TFRT `GraphExecutor`.
+#define BM_GRAPH_EXECUTOR(NAME, BUILDER)                                  \
+  void BM_TfrtGraphExecutor_##NAME(::testing::benchmark::State& state) {  \
+    RunGraphExecutorBenchmark(test::BUILDER(state.range(0)), state);     \
+  }                                                                       \
+  BENCHMARK(BM_TfrtGraphExecutor_##NAME)
+
+BM_GRAPH_EXECUTOR(Chain, ChainGraph)->Arg(1)->Arg(64)->Arg(1024);
+BM_GRAPH_EXECUTOR(FanOut, FanOutGraph)->Arg(64)->Arg(1024);
+BM_GRAPH_EXECUTOR(WhileLoop, WhileLoopGraph)->Arg(64)->Arg(1024);
+BM_GRAPH_EXECUTOR(ConstFeeds, ConstFeedsGraph)->Arg(64)->Arg(1024);
+
+#undef BM_GRAPH_EXECUTOR
+
+}  // namespace
+}  // namespace tfrt_stub
+}  // namespace tensorflow
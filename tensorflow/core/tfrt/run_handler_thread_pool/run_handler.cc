@@ -13,7 +13,10 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <time.h>
+
 #include <atomic>
+#include <memory>
 #define EIGEN_USE_THREADS
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
@@ -40,6 +43,41 @@ namespace {
 typedef typename internal::RunHandlerEnvironment::Task Task;
 typedef Eigen::RunQueue<Task, 1024> Queue;
 
+constexpr char kInterOpCpuTimeCostType[] = "run_handler_inter_op_cpu_time";
+constexpr char kIntraOpCpuTimeCostType[] = "run_handler_intra_op_cpu_time";
+
+// Returns the CPU time consumed by the calling thread, in nanoseconds. Falls
+// back to wall time where per-thread CPU clocks are unavailable.
+int64_t ThreadCpuTimeNanos() {
+#if defined(__linux__)
+  timespec ts;
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0) {
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+  }
+#endif
+  return tensorflow::Env::Default()->NowNanos();
+}
+
+// The CPU time spent in the closures of one request. It is shared with the
+// closures so that a closure finishing after its handler has been reused does
+// not count towards the next request.
+struct CpuTimeCounters {
+  std::atomic<int64_t> inter_op_nanos{0};
+  std::atomic<int64_t> intra_op_nanos{0};
+};
+
+TaskFunction WrapWithCpuTimer(std::atomic<int64_t>* counter,
+                              std::shared_ptr<CpuTimeCounters> counters,
+                              TaskFunction fn) {
+  return TaskFunction([counter, counters = std::move(counters),
+                       fn = std::move(fn)]() mutable {
+    const int64_t start_nanos = ThreadCpuTimeNanos();
+    fn();
+    counter->fetch_add(ThreadCpuTimeNanos() - start_nanos,
+                       std::memory_order_relaxed);
+  });
+}
+
 }  // namespace
 
 namespace internal {
@@ -677,6 +715,19 @@ class RunHandler::Impl {
 
   int64_t priority() const { return options_.priority; }
 
+  absl::Duration inter_op_cpu_time() const {
+    return cpu_time_counters_ == nullptr
+               ? absl::ZeroDuration()
+               : absl::Nanoseconds(cpu_time_counters_->inter_op_nanos.load(
+                     std::memory_order_relaxed));
+  }
+  absl::Duration intra_op_cpu_time() const {
+    return cpu_time_counters_ == nullptr
+               ? absl::ZeroDuration()
+               : absl::Nanoseconds(cpu_time_counters_->intra_op_nanos.load(
+                     std::memory_order_relaxed));
+  }
+
  private:
   class RunHandlerEigenThreadPool
       : public tensorflow::thread::ThreadPoolInterface {
@@ -704,6 +755,8 @@ class RunHandler::Impl {
   int64_t step_id_;
   internal::ThreadWorkSource tws_;
   RunHandlerOptions options_;
+  // Null unless `options_.record_cpu_time` is set.
+  std::shared_ptr<CpuTimeCounters> cpu_time_counters_;
 };
 
 // Contains shared state across all run handlers present in the pool. Also
@@ -994,12 +1047,20 @@ RunHandler::Impl::Impl(RunHandlerPool::Impl* pool_impl)
 
 void RunHandler::Impl::ScheduleInterOpClosure(TaskFunction fn) {
   VLOG(3) << "Scheduling inter work for  " << tws()->GetTracemeId();
+  if (cpu_time_counters_ != nullptr) {
+    fn = WrapWithCpuTimer(&cpu_time_counters_->inter_op_nanos,
+                          cpu_time_counters_, std::move(fn));
+  }
   pool_impl_->run_handler_thread_pool()->AddWorkToQueue(tws(), true,
                                                         std::move(fn));
 }
 
 void RunHandler::Impl::ScheduleIntraOpClosure(TaskFunction fn) {
   VLOG(3) << "Scheduling intra work for " << tws()->GetTracemeId();
+  if (cpu_time_counters_ != nullptr) {
+    fn = WrapWithCpuTimer(&cpu_time_counters_->intra_op_nanos,
+                          cpu_time_counters_, std::move(fn));
+  }
   pool_impl_->run_handler_thread_pool()->AddWorkToQueue(tws(), false,
                                                         std::move(fn));
 }
@@ -1010,6 +1071,9 @@ void RunHandler::Impl::Reset(int64_t step_id,
   step_id_ = step_id;
   options_ = options;
   tws_.SetTracemeId(step_id);
+  cpu_time_counters_ = options.record_cpu_time
+                           ? std::make_shared<CpuTimeCounters>()
+                           : nullptr;
 }
 
 int RunHandler::Impl::RunHandlerEigenThreadPool::NumThreads() const {
@@ -1052,6 +1116,14 @@ int RunHandler::NumThreads() const {
 
 int64_t RunHandler::step_id() const { return impl_->step_id(); }
 
+absl::Duration RunHandler::inter_op_cpu_time() const {
+  return impl_->inter_op_cpu_time();
+}
+
+absl::Duration RunHandler::intra_op_cpu_time() const {
+  return impl_->intra_op_cpu_time();
+}
+
 tensorflow::thread::ThreadPoolInterface*
 RunHandler::AsIntraThreadPoolInterface() const {
   return impl_->thread_pool_interface();
@@ -1059,6 +1131,14 @@ RunHandler::AsIntraThreadPoolInterface() const {
 
 RunHandler::~RunHandler() { impl_->pool_impl()->ReleaseHandler(impl_); }
 
+RunHandlerWorkQueue::~RunHandlerWorkQueue() {
+  if (request_cost_ != nullptr) {
+    request_cost_->RecordCost(
+        {{kInterOpCpuTimeCostType, run_handler_->inter_op_cpu_time()},
+         {kIntraOpCpuTimeCostType, run_handler_->intra_op_cpu_time()}});
+  }
+}
+
 int RunHandlerWorkQueue::GetParallelismLevel() const {
   return run_handler_->NumThreads();
 }
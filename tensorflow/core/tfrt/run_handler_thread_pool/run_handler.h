@@ -18,6 +18,8 @@ limitations under the License.
 
 #include <cstddef>
 
+#include "absl/time/time.h"
+#include "tensorflow/core/common_runtime/request_cost.h"
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/histogram/histogram.h"
 #include "tensorflow/core/platform/context.h"
@@ -37,10 +39,14 @@ class RunHandler;
 
 // Options for RunHanler.
 struct RunHandlerOptions {
-  RunHandlerOptions() : priority(0) {}
+  RunHandlerOptions() : priority(0), record_cpu_time(false) {}
 
   // Request priority.
   int priority;
+
+  // If true, the thread CPU time spent in the closures scheduled on the
+  // handler is accumulated, and can be read through RunHandler.
+  bool record_cpu_time;
 };
 
 // RunHandlerPool is a fixed size pool of pre-allocated RunHandlers
@@ -154,6 +160,11 @@ class RunHandler {
 
   int64_t step_id() const;
 
+  // The thread CPU time spent so far in the inter-op and intra-op closures of
+  // this handler. Always zero unless RunHandlerOptions::record_cpu_time is set.
+  absl::Duration inter_op_cpu_time() const;
+  absl::Duration intra_op_cpu_time() const;
+
   ~RunHandler();
 
  private:
@@ -411,11 +422,15 @@ class RunHandlerThreadPool {
 
 class RunHandlerWorkQueue : public tensorflow::tfrt_stub::WorkQueueInterface {
  public:
-  explicit RunHandlerWorkQueue(std::unique_ptr<RunHandler> run_handler)
-      : run_handler_(std::move(run_handler)) {
+  // If `request_cost` is not null, the CPU time recorded by `run_handler` is
+  // added to it when the work queue is destroyed, i.e. when the request is
+  // done. `request_cost` must outlive the work queue.
+  explicit RunHandlerWorkQueue(std::unique_ptr<RunHandler> run_handler,
+                               tensorflow::RequestCost* request_cost = nullptr)
+      : run_handler_(std::move(run_handler)), request_cost_(request_cost) {
     DCHECK(run_handler_);
   }
-  ~RunHandlerWorkQueue() override = default;
+  ~RunHandlerWorkQueue() override;
 
   std::string name() const override { return "run_handler"; }
 
@@ -438,6 +453,7 @@ class RunHandlerWorkQueue : public tensorflow::tfrt_stub::WorkQueueInterface {
 
  private:
   std::unique_ptr<RunHandler> run_handler_;
+  tensorflow::RequestCost* request_cost_;  // NOT OWNED.
 };
 
 }  // end namespace tf
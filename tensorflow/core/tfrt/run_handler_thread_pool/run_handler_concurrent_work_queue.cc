@@ -16,6 +16,7 @@ limitations under the License.
 
 #include <memory>
 
+#include "tensorflow/core/common_runtime/cost_util.h"
 #include "tensorflow/core/tfrt/run_handler_thread_pool/run_handler.h"
 #include "tfrt/host_context/async_dispatch.h"  // from @tf_runtime
 #include "tfrt/host_context/async_value.h"  // from @tf_runtime
@@ -54,6 +55,10 @@ RunHandlerThreadWorkQueue::RunHandlerThreadWorkQueue(const Options& options)
   pool_options.wait_if_no_active_request = options.wait_if_no_active_request;
   pool_options.use_adaptive_waiting_time = options.use_adaptive_waiting_time;
   handler_pool_ = absl::make_unique<RunHandlerPool>(pool_options);
+
+  if (options.record_request_cpu_time) {
+    request_cost_accessor_ = tensorflow::CreateRequestCostAccessor();
+  }
 }
 
 tensorflow::StatusOr<std::unique_ptr<tensorflow::tfrt_stub::WorkQueueInterface>>
@@ -63,6 +68,10 @@ RunHandlerThreadWorkQueue::InitializeRequest(
   DCHECK(intra_op_threadpool);
   RunHandlerOptions options;
   options.priority = request_context_builder->request_options().priority;
+  tensorflow::RequestCost* request_cost =
+      request_cost_accessor_ ? request_cost_accessor_->GetRequestCost()
+                             : nullptr;
+  options.record_cpu_time = request_cost != nullptr;
   std::unique_ptr<RunHandler> handler = handler_pool_->Get(
       request_context_builder->id(), options_.init_timeout_ms, options);
   if (!handler) {
@@ -73,7 +82,8 @@ RunHandlerThreadWorkQueue::InitializeRequest(
 
   *intra_op_threadpool = handler->AsIntraThreadPoolInterface();
 
-  return {std::make_unique<RunHandlerWorkQueue>(std::move(handler))};
+  return {
+      std::make_unique<RunHandlerWorkQueue>(std::move(handler), request_cost)};
 }
 
 void RunHandlerThreadWorkQueue::AddTask(TaskFunction work) {
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <memory>
 
+#include "tensorflow/core/common_runtime/request_cost_accessor.h"
 #include "tensorflow/core/platform/strcat.h"
 #include "tensorflow/core/tfrt/run_handler_thread_pool/run_handler.h"
 #include "tensorflow/core/tfrt/runtime/work_queue_interface.h"
@@ -74,6 +75,11 @@ class RunHandlerThreadWorkQueue
 
     // If true, threads will be waken up by new tasks.
     bool enable_wake_up = true;
+
+    // If true, the CPU time spent in the inter-op and intra-op work of a
+    // request is added to the RequestCost of the rpc that initialized it, as
+    // given by the RequestCostAccessor configured in env.
+    bool record_request_cpu_time = false;
   };
 
   explicit RunHandlerThreadWorkQueue(const Options& options);
@@ -115,6 +121,10 @@ class RunHandlerThreadWorkQueue
   // back to the pool once it is done.
   std::unique_ptr<RunHandlerPool> handler_pool_;
 
+  // Null unless `options_.record_request_cpu_time` is set and an accessor is
+  // configured.
+  std::unique_ptr<tensorflow::RequestCostAccessor> request_cost_accessor_;
+
   // An id assigned to each request for tracing purpose.
   static std::atomic_int_fast64_t step_id_counter_;
 
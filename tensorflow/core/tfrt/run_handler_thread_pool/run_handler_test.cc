@@ -29,6 +29,7 @@ limitations under the License.
 #include "absl/synchronization/barrier.h"
 #include "absl/synchronization/notification.h"
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/common_runtime/request_cost.h"
 #include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
@@ -117,6 +118,42 @@ TEST(RunHandlerUtilTest, PrioritySchedulingTest) {
   EXPECT_EQ(sorted_active_list[3], 1);
 }
 
+TEST(RunHandlerUtilTest, RecordCpuTime) {
+  RunHandlerPool::Options options;
+  options.num_intra_op_threads = 1;
+  options.num_inter_op_threads = 1;
+  RunHandlerPool pool(options);
+
+  RunHandlerOptions handler_options;
+  handler_options.record_cpu_time = true;
+  std::unique_ptr<RunHandler> handler =
+      pool.Get(/*step_id=*/0, /*timeout_in_ms=*/0, handler_options);
+  RunHandler* handler_ptr = handler.get();
+  handler->ScheduleInterOpClosure(TaskFunction([]() {
+    // Spin for a while to accumulate some CPU time.
+    volatile int64_t sum = 0;
+    for (int64_t i = 0; i < 10000000; ++i) sum += i;
+  }));
+  // The time is recorded right after the closure returns.
+  while (handler->inter_op_cpu_time() == absl::ZeroDuration()) {
+    tensorflow::Env::Default()->SleepForMicroseconds(1000);
+  }
+  const absl::Duration inter_op_cpu_time = handler->inter_op_cpu_time();
+  EXPECT_EQ(handler->intra_op_cpu_time(), absl::ZeroDuration());
+
+  // The work queue reports the recorded time when destroyed.
+  tensorflow::RequestCost request_cost;
+  {
+    RunHandlerWorkQueue work_queue(std::move(handler), &request_cost);
+    EXPECT_EQ(handler_ptr->inter_op_cpu_time(), inter_op_cpu_time);
+  }
+  const auto costs = request_cost.GetCosts();
+  ASSERT_TRUE(costs.contains("run_handler_inter_op_cpu_time"));
+  ASSERT_TRUE(costs.contains("run_handler_intra_op_cpu_time"));
+  EXPECT_EQ(costs.at("run_handler_inter_op_cpu_time"), inter_op_cpu_time);
+  EXPECT_EQ(costs.at("run_handler_intra_op_cpu_time"), absl::ZeroDuration());
+}
+
 TEST(RunHandlerUtilTest, IntraOpThreadPool) {
   int num_threads = 2;
   RunHandlerPool::Options pool_options;
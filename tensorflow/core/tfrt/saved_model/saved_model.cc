@@ -16,6 +16,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <cstddef>
+#include <cstring>
 #include <string>
 #include <utility>
 #include <vector>
@@ -120,6 +121,11 @@ auto* saved_model_init_time_seconds =
         "/tensorflow/tfrt/saved_model/init_time",
         "Record the initialization time for the savedmodel.", "model_name");
 
+auto* saved_model_warmup_time_seconds =
+    tensorflow::monitoring::Gauge<int64_t, 1>::New(
+        "/tensorflow/tfrt/saved_model/warmup_time",
+        "Record the warmup time for the savedmodel.", "model_name");
+
 tensorflow::Tensor CreateScalarStringTensor(absl::string_view str) {
   return tensorflow::Tensor(tensorflow::tstring(str));
 }
@@ -542,12 +548,26 @@ std::unique_ptr<SavedModel> SavedModelImpl::LoadSavedModel(
                               std::move(*meta_graph_def.mutable_graph_def())));
 
     // Finally, create the saved model.
-    return {std::make_unique<SavedModelImpl>(
+    auto saved_model = std::make_unique<SavedModelImpl>(
         std::move(options), std::move(meta_graph_def), std::move(bef),
         std::move(bef_file),
         std::move(initializers_and_signatures.signature_map),
         std::move(fallback_state), std::move(tpu_model_resource),
-        std::move(resource_context), std::move(graph_executor))};
+        std::move(resource_context), std::move(graph_executor));
+
+    // Step 4: Optionally warm up the signatures, so that the model is only
+    // reported as loaded once it can serve requests at full speed.
+    if (saved_model->options_.enable_warmup) {
+      auto warmup_start_time = absl::Now();
+      saved_model->Warmup();
+      auto warmup_duration = absl::Now() - warmup_start_time;
+      saved_model_warmup_time_seconds->GetCell(std::string(saved_model_dir))
+          ->Set(absl::ToInt64Seconds(warmup_duration));
+      LOG(INFO) << "TFRT finished warming up savedmodel. Took "
+                << absl::ToInt64Milliseconds(warmup_duration) << " ms.";
+    }
+
+    return {std::move(saved_model)};
   }();
 
   if (!statusor_saved_model.ok()) {
@@ -623,6 +643,67 @@ tensorflow::Status IsInputSpecsCorrect(
 }
 }  // namespace
 
+namespace {
+
+// Creates zero-filled inputs matching the input specs of `signature`, with
+// unknown dimensions set to 1 and tensors of unknown rank made scalars.
+tensorflow::StatusOr<std::vector<tensorflow::Tensor>> CreateWarmupInputs(
+    const internal::Signature& signature) {
+  std::vector<tensorflow::Tensor> inputs;
+  inputs.reserve(signature.input_specs.size());
+  for (const auto& spec : signature.input_specs) {
+    if (!tensorflow::DataTypeCanUseMemcpy(spec.dtype) &&
+        spec.dtype != tensorflow::DT_STRING) {
+      return tensorflow::errors::Unimplemented(
+          "Cannot create warmup input of type ",
+          tensorflow::DataTypeString(spec.dtype));
+    }
+    tensorflow::TensorShape shape;
+    for (int i = 0; i < spec.shape.dims(); ++i) {
+      const int64_t dim_size = spec.shape.dim_size(i);
+      shape.AddDim(dim_size < 0 ? 1 : dim_size);
+    }
+    tensorflow::Tensor input(spec.dtype, shape);
+    if (spec.dtype != tensorflow::DT_STRING) {
+      std::memset(input.data(), 0, input.TotalBytes());
+    }
+    inputs.push_back(std::move(input));
+  }
+  return inputs;
+}
+
+}  // namespace
+
+void SavedModelImpl::Warmup() {
+  for (const auto& p : signatures_) {
+    const std::string& name = p.first;
+
+    // With lazy loading, loading the signature creates its fallback kernels
+    // even if it cannot be run below.
+    if (options_.enable_lazy_loading) {
+      auto loading_result = GetOrCreateLoadingResult({name});
+      if (!loading_result.ok()) {
+        LOG(WARNING) << "Failed to load signature " << name
+                     << " during warmup: " << loading_result.status();
+        continue;
+      }
+    }
+
+    auto inputs = CreateWarmupInputs(p.second);
+    if (!inputs.ok()) {
+      VLOG(1) << "Skipping warmup run of signature " << name << ": "
+              << inputs.status();
+      continue;
+    }
+    std::vector<tensorflow::Tensor> outputs;
+    auto status = Run(/*run_options=*/{}, name, *inputs, &outputs);
+    if (!status.ok()) {
+      LOG(WARNING) << "Warmup run of signature " << name
+                   << " failed: " << status;
+    }
+  }
+}
+
 tensorflow::Status SavedModelImpl::Run(
     const RunOptions& run_options, absl::string_view name,
     absl::Span<const tensorflow::Tensor> inputs,
@@ -130,6 +130,15 @@ class SavedModel {
     // the individual signatures will be loaded along with the saved model.
     bool enable_lazy_loading = false;
 
+    // If true, every signature is run once with synthetic inputs before
+    // loading returns, so that the first requests do not pay for one-time
+    // initialization. With `enable_lazy_loading`, this also compiles every
+    // signature and creates its fallback kernels ahead of time. The inputs
+    // are zero-filled tensors (empty strings for DT_STRING) shaped after the
+    // signature, with unknown dimensions set to 1. Warmup failures are logged
+    // and do not fail the loading.
+    bool enable_warmup = false;
+
     GraphExecutionOptions graph_execution_options;
   };
 
@@ -282,6 +291,10 @@ class SavedModelImpl final : public SavedModel {
   GetOrCreateLoadingResult(absl::Span<const std::string> names)
       TF_LOCKS_EXCLUDED(loading_result_cache_mu_);
 
+  // Runs every signature once with synthetic inputs. See
+  // `Options::enable_warmup`.
+  void Warmup();
+
   // Runs `func` with the given inputs, and outputs the result.
   tensorflow::Status RunInternal(const RunOptions& run_options,
                                  absl::string_view signature_name,
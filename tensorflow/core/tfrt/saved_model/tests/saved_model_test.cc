@@ -84,6 +84,35 @@ INSTANTIATE_TEST_SUITE_P(
         TestParams{0, 1, 1}, TestParams{1, 0, 0}, TestParams{1, 0, 1},
         TestParams{1, 1, 0}, TestParams{1, 1, 1}));
 
+TEST(SavedModelTest, Warmup) {
+  std::string saved_model_dir = tensorflow::GetDataDependencyFilepath(
+      "tensorflow/core/tfrt/saved_model/tests/toy_v1");
+
+  for (bool enable_lazy_loading : {false, true}) {
+    auto runtime = DefaultTfrtRuntime(/*num_threads=*/1);
+    auto options = DefaultSavedModelOptions(runtime.get());
+    options.enable_lazy_loading = enable_lazy_loading;
+    options.enable_warmup = true;
+
+    tensorflow::Status status;
+    auto saved_model =
+        SavedModelImpl::LoadSavedModel(options, saved_model_dir,
+                                       /*tags=*/{"serve"}, &status);
+    TF_ASSERT_OK(status);
+
+    // Set input 'x' to [[1, 1, 1]]
+    std::vector<tensorflow::Tensor> inputs;
+    inputs.push_back(
+        CreateTfTensor<int32_t>(/*shape=*/{1, 3}, /*data=*/{1, 1, 1}));
+
+    std::vector<tensorflow::Tensor> outputs;
+    TF_ASSERT_OK(saved_model->Run({}, "toy", inputs, &outputs));
+    ASSERT_EQ(outputs.size(), 1);
+    EXPECT_THAT(GetTfTensorData<int32_t>(outputs[0]),
+                ::testing::ElementsAreArray({6}));
+  }
+}
+
 TEST(SavedModelTest, BasicV2) {
   // SavedModel toy contains a graph of a single 'tf.AddV2' op. It is generated
   // using the following python code:
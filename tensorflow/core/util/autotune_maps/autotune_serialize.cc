@@ -21,6 +21,9 @@ limitations under the License.
 #include <unordered_map>
 #include <vector>
 
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/str_util.h"
 #include "tensorflow/core/util/activation_mode.h"
 #include "tensorflow/core/util/autotune_maps/autotune_map.pb.h"
@@ -40,6 +43,25 @@ using stream_executor::dnn::AlgorithmConfigProto;
 using stream_executor::dnn::AlgorithmDesc;
 using stream_executor::dnn::AlgorithmProto;
 
+// Returns the version of the DNN library used by the first GPU, or an empty
+// string if it can't be determined.
+std::string GetDnnVersion() {
+#if GOOGLE_CUDA
+  const char *platform_name = "CUDA";
+#else
+  const char *platform_name = "ROCM";
+#endif
+  auto platform = se::MultiPlatformManager::PlatformWithName(platform_name);
+  if (!platform.ok()) return "";
+  auto executor = platform.ValueOrDie()->ExecutorForDevice(0);
+  if (!executor.ok() || executor.ValueOrDie()->AsDnn() == nullptr) return "";
+  auto version = executor.ValueOrDie()->AsDnn()->GetVersion();
+  if (!version.ok()) return "";
+  return absl::StrCat(version.ValueOrDie().major_version(), ".",
+                      version.ValueOrDie().minor_version(), ".",
+                      version.ValueOrDie().patch());
+}
+
 template <typename Op>
 ConvMapProto ConvMapToProto(
     const AutotuneMap<ConvParameters, AutotuneEntry<Op>> &autotune_map) {
@@ -184,6 +206,7 @@ Status SerializeAutotuneMaps(std::string *output) {
   *proto.mutable_conv_map() = ConvMapToProto(*ConvAutotuneMap::GetInstance());
   *proto.mutable_fused_conv_map() =
       ConvMapToProto(*FusedConvAutotuneMap::GetInstance());
+  proto.set_dnn_version(GetDnnVersion());
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
   *output = autotune_maps_utils::SerializeProtoDeterministic(proto);
   return Status::OK();
@@ -199,6 +222,16 @@ Status LoadSerializedAutotuneMaps(absl::string_view s) {
     return errors::InvalidArgument(
         "Failed to parse the autotune maps from string.");
   }
+  // Algorithms tuned against another version of the DNN library may be
+  // slower or no longer supported, so don't load them.
+  const std::string dnn_version = GetDnnVersion();
+  if (!proto.dnn_version().empty() && !dnn_version.empty() &&
+      proto.dnn_version() != dnn_version) {
+    return errors::Aborted(
+        "Aborted because the loaded autotune results were tuned with DNN "
+        "library version ",
+        proto.dnn_version(), " but the runtime uses version ", dnn_version);
+  }
   TF_RETURN_IF_ERROR(
       PopulateConvMap(proto.conv_map(), ConvAutotuneMap::GetInstance()));
   TF_RETURN_IF_ERROR(PopulateConvMap(proto.fused_conv_map(),
@@ -208,6 +241,60 @@ Status LoadSerializedAutotuneMaps(absl::string_view s) {
   return Status::OK();
 }
 
+Status LoadAutotuneMapsFromFile(const std::string &path) {
+  std::string serialized;
+  TF_RETURN_IF_ERROR(ReadFileToString(Env::Default(), path, &serialized));
+  return LoadSerializedAutotuneMaps(serialized);
+}
+
+Status SaveAutotuneMapsToFile(const std::string &path) {
+  std::string serialized;
+  TF_RETURN_IF_ERROR(SerializeAutotuneMaps(&serialized));
+  // Write to a temporary file first so that concurrent readers never see a
+  // partially written file.
+  Env *env = Env::Default();
+  std::string tmp_path = path;
+  if (!env->CreateUniqueFileName(&tmp_path, ".tmp")) {
+    return errors::Internal("Failed to create a temporary file name for ",
+                            path);
+  }
+  TF_RETURN_IF_ERROR(WriteStringToFile(env, tmp_path, serialized));
+  return env->RenameFile(tmp_path, path);
+}
+
+void StartAutotuneMapsWriteBack(const std::string &path,
+                                int64_t interval_secs) {
+  static mutex *mu = new mutex;
+  static Thread *thread = nullptr;
+  mutex_lock l(*mu);
+  if (thread != nullptr) {
+    LOG(WARNING) << "Autotune maps write-back is already running; ignoring "
+                 << path;
+    return;
+  }
+  // The thread runs for the lifetime of the process and is never joined.
+  thread = Env::Default()->StartThread(
+      ThreadOptions(), "autotune_maps_write_back", [path, interval_secs]() {
+        std::string last_written;
+        while (true) {
+          Env::Default()->SleepForMicroseconds(interval_secs * 1000000);
+          std::string serialized;
+          if (!SerializeAutotuneMaps(&serialized).ok() ||
+              serialized == last_written) {
+            continue;
+          }
+          Status s = SaveAutotuneMapsToFile(path);
+          if (!s.ok()) {
+            LOG(WARNING) << "Failed to write autotune maps to " << path << ": "
+                         << s;
+            continue;
+          }
+          VLOG(1) << "Wrote autotune maps to " << path;
+          last_written = std::move(serialized);
+        }
+      });
+}
+
 void ResetAutotuneMaps() {
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
   ConvAutotuneMap::GetInstance()->ClearMap();
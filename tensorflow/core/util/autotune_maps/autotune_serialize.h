@@ -25,6 +25,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_UTIL_AUTOTUNE_MAPS_AUTOTUNE_SERIALIZE_H_
 #define TENSORFLOW_CORE_UTIL_AUTOTUNE_MAPS_AUTOTUNE_SERIALIZE_H_
 
+#include <cstdint>
 #include <string>
 
 #include "tensorflow/core/platform/status.h"
@@ -40,6 +41,20 @@ Status LoadSerializedAutotuneMaps(absl::string_view s);
 // LoadSerializedAutotuneMaps.
 Status SerializeAutotuneMaps(std::string* output);
 
+// Like LoadSerializedAutotuneMaps, but reads the serialized maps from the file
+// at `path`, as written by SaveAutotuneMapsToFile.
+Status LoadAutotuneMapsFromFile(const std::string& path);
+
+// Serializes all the autotune maps and atomically replaces the file at `path`
+// with them.
+Status SaveAutotuneMapsToFile(const std::string& path);
+
+// Starts a background thread that calls SaveAutotuneMapsToFile(path) every
+// `interval_secs` seconds whenever the autotune maps have changed, so results
+// tuned by a long-running process are kept for later ones. Only the first
+// call in a process starts a thread; later calls are ignored.
+void StartAutotuneMapsWriteBack(const std::string& path, int64_t interval_secs);
+
 // Resets all autotune maps. For test use only.
 void ResetAutotuneMaps();
 
@@ -19,6 +19,7 @@ limitations under the License.
 #include "tensorflow/core/util/autotune_maps/autotune_serialize.h"
 
 #include "absl/types/variant.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/status_matchers.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/util/autotune_maps/conv_autotune_maps.h"
@@ -173,6 +174,42 @@ TEST(AutotuneSerializeTest, VersionControl) {
                HasSubstr("Aborted because the loaded autotune results")));
   EXPECT_EQ(ConvAutotuneMap::GetInstance()->GetMap().size(), 0);
 }
+
+// Tests that autotune maps written by SaveAutotuneMapsToFile are restored by
+// LoadAutotuneMapsFromFile.
+TEST(AutotuneSerializeTest, FileRoundTrip) {
+  TF_CHECK_OK(GpuDriver::Init());
+  ResetAutotuneMaps();
+  ConvParameters conv_params_example = {
+      /*batch=*/1,
+      /*in_depths=*/1,
+      /*in=*/{{1, 1}},
+      /*data_format=*/TensorFormat::FORMAT_NCHW,
+      /*out_depths=*/1,
+      /*filter=*/{{1, 1}},
+      /*dilation=*/{{1, 1}},
+      /*stride=*/{{1, 1}},
+      /*padding=*/{{1, 1}},
+      /*dtype=*/DataType::DT_FLOAT,
+      /*device_id=*/0,
+      /*group_count=*/1};
+  AlgorithmDesc algorithm(/*algo_id=*/1, /*use_tensor_ops=*/true);
+  AutotuneEntry<se::dnn::ConvOp> example(algorithm, absl::nullopt);
+  ConvAutotuneMap::GetInstance()->Insert(conv_params_example, example);
+
+  const std::string path =
+      io::JoinPath(testing::TmpDir(), "autotune_maps_round_trip");
+  TF_CHECK_OK(SaveAutotuneMapsToFile(path));
+  ResetAutotuneMaps();
+  TF_CHECK_OK(LoadAutotuneMapsFromFile(path));
+  AutotuneEntry<se::dnn::ConvOp> entry;
+  EXPECT_TRUE(
+      ConvAutotuneMap::GetInstance()->Find(conv_params_example, &entry));
+  EXPECT_EQ(entry, example);
+
+  EXPECT_THAT(LoadAutotuneMapsFromFile(path + ".missing"),
+              StatusIs(error::NOT_FOUND));
+}
 }  // namespace
 }  // namespace tensorflow
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
@@ -33,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/platform/byte_order.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/protobuf.h"
+#include "tensorflow/core/util/packed_wire_decoding.h"
 #include "tensorflow/core/util/presized_cuckoo_map.h"
 #include "tensorflow/core/util/sparse/sparse_tensor.h"
 
@@ -113,6 +114,21 @@ constexpr uint8 kVarintTag(uint32 tag) { return (tag << 3) | 0; }
 constexpr uint8 kDelimitedTag(uint32 tag) { return (tag << 3) | 2; }
 constexpr uint8 kFixed32Tag(uint32 tag) { return (tag << 3) | 5; }
 
+// Sets `*begin` to the `length` bytes at the current position of `stream`,
+// which must read from a flat array, and skips past them.
+bool ReadPackedBody(protobuf::io::CodedInputStream* stream, uint32 length,
+                    const uint8** begin) {
+  DCHECK(stream != nullptr);
+  const void* ptr = nullptr;
+  int size = 0;
+  if (length > 0 && (!stream->GetDirectBufferPointer(&ptr, &size) ||
+                     static_cast<uint32>(size) < length)) {
+    return false;
+  }
+  *begin = static_cast<const uint8*>(ptr);
+  return stream->Skip(length);
+}
+
 namespace parsed {
 
 // ParseDataType has to be called first, then appropriate ParseZzzzList.
@@ -299,15 +315,23 @@ class Feature {
         if (!stream.ExpectTag(kDelimitedTag(1))) return false;  // packed tag
         uint32 packed_length;
         if (!stream.ReadVarint32(&packed_length)) return false;
-        auto packed_limit = stream.PushLimit(packed_length);
-
-        while (!stream.ExpectAtEnd()) {
-          protobuf_uint64 n;  // There is no API for int64
-          if (!stream.ReadVarint64(&n)) return false;
-          int64_list->push_back(static_cast<int64_t>(n));
+        const uint8* packed_begin;
+        if (!ReadPackedBody(&stream, packed_length, &packed_begin)) {
+          return false;
         }
-
-        stream.PopLimit(packed_limit);
+        const uint8* packed_end = packed_begin + packed_length;
+        const int64_t num_values = CountPackedVarints(packed_begin, packed_end);
+        if (num_values < 0) return false;
+
+        // As in `ParseFloatList`, the size after resizing can be less than
+        // requested in case of a LimitedArraySlice.
+        const size_t initial_size = int64_list->size();
+        int64_list->resize(initial_size + num_values);
+        const int64_t max_values = int64_list->size() - initial_size;
+        const int64_t num_decoded =
+            DecodePackedVarints(packed_begin, packed_end, max_values,
+                                int64_list->data() + initial_size);
+        if (num_decoded != num_values) return false;
       } else {  // non-packed
         while (!stream.ExpectAtEnd()) {
           if (!stream.ExpectTag(kVarintTag(1))) return false;
@@ -1920,18 +1944,29 @@ inline int ParseFloatFeature(protobuf::io::CodedInputStream* stream,
           !stream->ReadVarint32(&packed_length)) {
         return -1;
       }
-      auto packed_limit = stream->PushLimit(packed_length);
-      while (!stream->ExpectAtEnd()) {
-        uint32 buffer32;
-        if (!stream->ReadLittleEndian32(&buffer32)) {
+      constexpr uint32 kNumFloatBytes = 4;
+      if (packed_length % kNumFloatBytes != 0) {
+        return -1;
+      }
+      num_elements = packed_length / kNumFloatBytes;
+      if (out == nullptr) {
+        if (!stream->Skip(packed_length)) {
           return -1;
         }
-        if (out != nullptr) {
+      } else if (port::kLittleEndian) {
+        // The packed body is the array of floats.
+        if (!stream->ReadRaw(out, packed_length)) {
+          return -1;
+        }
+      } else {
+        for (int i = 0; i < num_elements; ++i) {
+          uint32 buffer32;
+          if (!stream->ReadLittleEndian32(&buffer32)) {
+            return -1;
+          }
           *out++ = absl::bit_cast<float>(buffer32);
         }
-        num_elements++;
       }
-      stream->PopLimit(packed_limit);
     } else if (peek_tag == kFixed32Tag(1)) {
       while (!stream->ExpectAtEnd()) {
         uint32 buffer32;
@@ -1971,18 +2006,19 @@ inline int ParseInt64Feature(protobuf::io::CodedInputStream* stream,
           !stream->ReadVarint32(&packed_length)) {
         return -1;
       }
-      auto packed_limit = stream->PushLimit(packed_length);
-      while (!stream->ExpectAtEnd()) {
-        protobuf_uint64 n;  // There is no API for int64
-        if (!stream->ReadVarint64(&n)) {
-          return -1;
-        }
-        if (out != nullptr) {
-          *out++ = n;
-        }
-        num_elements++;
+      const uint8* packed_begin;
+      if (!ReadPackedBody(stream, packed_length, &packed_begin)) {
+        return -1;
+      }
+      const uint8* packed_end = packed_begin + packed_length;
+      const int64_t num_values =
+          out == nullptr ? CountPackedVarints(packed_begin, packed_end)
+                         : DecodePackedVarints(packed_begin, packed_end,
+                                               packed_length, out);
+      if (num_values < 0) {
+        return -1;
       }
-      stream->PopLimit(packed_limit);
+      num_elements = num_values;
     } else if (peek_tag == kVarintTag(1)) {
       while (!stream->ExpectAtEnd()) {
         protobuf_uint64 n;  // There is no API for int64
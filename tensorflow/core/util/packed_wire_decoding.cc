@@ -0,0 +1,324 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/util/packed_wire_decoding.h"
+
+#include <cstring>
+
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/platform.h"
+
+// The SIMD decoders are compiled on x86 with GCC and Clang, whose `target`
+// attribute lets the AVX2 decoder be built without compiling the whole file
+// for AVX2. SSE2 is part of x86-64.
+#if defined(PLATFORM_IS_X86) && defined(__x86_64__) && \
+    !defined(IS_MOBILE_PLATFORM) && (defined(__GNUC__) || defined(__clang__))
+#define TF_PACKED_WIRE_DECODING_USE_SIMD
+#include <immintrin.h>
+#endif
+
+namespace tensorflow {
+namespace example {
+namespace {
+
+// The maximum number of bytes of a 64-bit varint.
+constexpr int kMaxVarint64Bytes = 10;
+constexpr uint64 kContinuationBits = 0x8080808080808080ULL;
+
+// Decodes the varint at `*p` into `*value`, and advances `*p` past it.
+// Returns false if there is no valid varint before `end`.
+inline bool DecodeVarint(const uint8** p, const uint8* end, uint64* value) {
+  const uint8* const q = *p;
+  uint64 result = 0;
+  if (end - q >= kMaxVarint64Bytes) {
+    // The common case, with a fixed number of iterations.
+    for (int i = 0; i < kMaxVarint64Bytes; ++i) {
+      const uint8 byte = q[i];
+      result |= static_cast<uint64>(byte & 0x7F) << (7 * i);
+      if ((byte & 0x80) == 0) {
+        *p = q + i + 1;
+        *value = result;
+        return true;
+      }
+    }
+    return false;
+  }
+  for (int i = 0; q + i < end; ++i) {
+    const uint8 byte = q[i];
+    result |= static_cast<uint64>(byte & 0x7F) << (7 * i);
+    if ((byte & 0x80) == 0) {
+      *p = q + i + 1;
+      *value = result;
+      return true;
+    }
+  }
+  return false;
+}
+
+// Decodes the varints that start in `[*p, window_end)` into `out`, and
+// advances `*p` past them.
+inline bool DecodeWindow(const uint8** p, const uint8* window_end,
+                         const uint8* end, int64_t* out, int64_t* n) {
+  while (*p < window_end) {
+    uint64 value;
+    if (!DecodeVarint(p, end, &value)) {
+      return false;
+    }
+    out[(*n)++] = static_cast<int64_t>(value);
+  }
+  return true;
+}
+
+// Stores `value` as the `*n`-th value, if it is one of the first `max_values`.
+inline void Store(uint64 value, int64_t max_values, int64_t* out, int64_t* n) {
+  if (*n < max_values) {
+    out[*n] = static_cast<int64_t>(value);
+  }
+  ++*n;
+}
+
+// Decodes `[p, end)` one varint at a time, starting with the `n`-th value.
+int64_t DecodeTail(const uint8* p, const uint8* end, int64_t max_values,
+                   int64_t* out, int64_t n) {
+  while (p < end) {
+    uint64 value;
+    if (!DecodeVarint(&p, end, &value)) {
+      return -1;
+    }
+    Store(value, max_values, out, &n);
+  }
+  return n;
+}
+
+int64_t CountTail(const uint8* p, const uint8* end, int64_t n) {
+  for (; p < end; ++p) {
+    n += (*p & 0x80) == 0;
+  }
+  return n;
+}
+
+int64_t CountScalar(const uint8* begin, const uint8* end) {
+  const uint8* p = begin;
+  int64_t n = 0;
+  for (; end - p >= 8; p += 8) {
+    uint64 word;
+    std::memcpy(&word, p, sizeof(word));
+    // Counts the bytes whose continuation bit is clear.
+    uint64 terminators = ~word & kContinuationBits;
+    for (; terminators != 0; terminators &= terminators - 1) {
+      ++n;
+    }
+  }
+  return CountTail(p, end, n);
+}
+
+int64_t DecodeScalar(const uint8* begin, const uint8* end, int64_t max_values,
+                     int64_t* out) {
+  const uint8* p = begin;
+  int64_t n = 0;
+  // At most 8 varints start in each window of 8 bytes.
+  while (end - p >= 8 && n + 8 <= max_values) {
+    uint64 word;
+    std::memcpy(&word, p, sizeof(word));
+    if ((word & kContinuationBits) == 0) {
+      // Eight single-byte varints.
+      for (int i = 0; i < 8; ++i) {
+        out[n + i] = p[i];
+      }
+      n += 8;
+      p += 8;
+    } else if (!DecodeWindow(&p, p + 8, end, out, &n)) {
+      return -1;
+    }
+  }
+  return DecodeTail(p, end, max_values, out, n);
+}
+
+#ifdef TF_PACKED_WIRE_DECODING_USE_SIMD
+
+int64_t CountSse2(const uint8* begin, const uint8* end) {
+  const uint8* p = begin;
+  int64_t n = 0;
+  for (; end - p >= 16; p += 16) {
+    const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    const uint32 continuations = _mm_movemask_epi8(bytes);
+    n += 16 - __builtin_popcount(continuations);
+  }
+  return CountTail(p, end, n);
+}
+
+// Widens the 16 bytes of `bytes` into `out[0, 16)`.
+inline void WidenSse2(__m128i bytes, int64_t* out) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i words[2] = {_mm_unpacklo_epi8(bytes, zero),
+                            _mm_unpackhi_epi8(bytes, zero)};
+  __m128i* dst = reinterpret_cast<__m128i*>(out);
+  for (int i = 0; i < 2; ++i) {
+    const __m128i dwords[2] = {_mm_unpacklo_epi16(words[i], zero),
+                               _mm_unpackhi_epi16(words[i], zero)};
+    for (int j = 0; j < 2; ++j) {
+      _mm_storeu_si128(dst++, _mm_unpacklo_epi32(dwords[j], zero));
+      _mm_storeu_si128(dst++, _mm_unpackhi_epi32(dwords[j], zero));
+    }
+  }
+}
+
+int64_t DecodeSse2(const uint8* begin, const uint8* end, int64_t max_values,
+                   int64_t* out) {
+  const uint8* p = begin;
+  int64_t n = 0;
+  while (end - p >= 16 && n + 16 <= max_values) {
+    const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    const uint32 continuations = _mm_movemask_epi8(bytes);
+    if (continuations == 0) {
+      WidenSse2(bytes, out + n);
+      n += 16;
+      p += 16;
+      continue;
+    }
+    // Copies the single-byte varints before the first multi-byte one, and
+    // decodes the rest of the window one varint at a time.
+    const uint8* const window_end = p + 16;
+    const int num_single_bytes = __builtin_ctz(continuations);
+    for (int i = 0; i < num_single_bytes; ++i) {
+      out[n + i] = p[i];
+    }
+    n += num_single_bytes;
+    p += num_single_bytes;
+    if (!DecodeWindow(&p, window_end, end, out, &n)) {
+      return -1;
+    }
+  }
+  return DecodeTail(p, end, max_values, out, n);
+}
+
+__attribute__((target("avx2"))) int64_t CountAvx2(const uint8* begin,
+                                                  const uint8* end) {
+  const uint8* p = begin;
+  int64_t n = 0;
+  for (; end - p >= 32; p += 32) {
+    const __m256i bytes =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    const uint32 continuations = _mm256_movemask_epi8(bytes);
+    n += 32 - __builtin_popcount(continuations);
+  }
+  return CountTail(p, end, n);
+}
+
+__attribute__((target("avx2"))) int64_t DecodeAvx2(const uint8* begin,
+                                                   const uint8* end,
+                                                   int64_t max_values,
+                                                   int64_t* out) {
+  const uint8* p = begin;
+  int64_t n = 0;
+  while (end - p >= 32 && n + 32 <= max_values) {
+    const __m256i bytes =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    const uint32 continuations = _mm256_movemask_epi8(bytes);
+    // Widens the single-byte varints before the first multi-byte one, four at
+    // a time; a whole window of 32 of them is the common case. The rest of the
+    // window is decoded one varint at a time.
+    const uint8* const window_end = p + 32;
+    const int num_single_bytes =
+        continuations == 0 ? 32 : __builtin_ctz(continuations);
+    int i = 0;
+    for (; i + 4 <= num_single_bytes; i += 4) {
+      int32 quad;
+      std::memcpy(&quad, p + i, sizeof(quad));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + n + i),
+                          _mm256_cvtepu8_epi64(_mm_cvtsi32_si128(quad)));
+    }
+    for (; i < num_single_bytes; ++i) {
+      out[n + i] = p[i];
+    }
+    n += num_single_bytes;
+    p += num_single_bytes;
+    if (!DecodeWindow(&p, window_end, end, out, &n)) {
+      return -1;
+    }
+  }
+  return DecodeTail(p, end, max_values, out, n);
+}
+
+#endif  // TF_PACKED_WIRE_DECODING_USE_SIMD
+
+VarintDecoder Resolve(VarintDecoder decoder) {
+  if (decoder != VarintDecoder::kDefault) {
+    DCHECK(IsVarintDecoderSupported(decoder));
+    return decoder;
+  }
+  static const VarintDecoder default_decoder = []() {
+    for (VarintDecoder decoder : {VarintDecoder::kAvx2, VarintDecoder::kSse2}) {
+      if (IsVarintDecoderSupported(decoder)) {
+        return decoder;
+      }
+    }
+    return VarintDecoder::kScalar;
+  }();
+  return default_decoder;
+}
+
+}  // namespace
+
+bool IsVarintDecoderSupported(VarintDecoder decoder) {
+  switch (decoder) {
+    case VarintDecoder::kDefault:
+    case VarintDecoder::kScalar:
+      return true;
+#ifdef TF_PACKED_WIRE_DECODING_USE_SIMD
+    case VarintDecoder::kSse2:
+      return true;
+    case VarintDecoder::kAvx2:
+      return port::TestCPUFeature(port::CPUFeature::AVX2);
+#endif  // TF_PACKED_WIRE_DECODING_USE_SIMD
+    default:
+      return false;
+  }
+}
+
+int64_t CountPackedVarints(const uint8* begin, const uint8* end,
+                           VarintDecoder decoder) {
+  if (begin < end && (end[-1] & 0x80) != 0) {
+    return -1;
+  }
+  switch (Resolve(decoder)) {
+#ifdef TF_PACKED_WIRE_DECODING_USE_SIMD
+    case VarintDecoder::kAvx2:
+      return CountAvx2(begin, end);
+    case VarintDecoder::kSse2:
+      return CountSse2(begin, end);
+#endif  // TF_PACKED_WIRE_DECODING_USE_SIMD
+    default:
+      return CountScalar(begin, end);
+  }
+}
+
+int64_t DecodePackedVarints(const uint8* begin, const uint8* end,
+                            int64_t max_values, int64_t* out,
+                            VarintDecoder decoder) {
+  switch (Resolve(decoder)) {
+#ifdef TF_PACKED_WIRE_DECODING_USE_SIMD
+    case VarintDecoder::kAvx2:
+      return DecodeAvx2(begin, end, max_values, out);
+    case VarintDecoder::kSse2:
+      return DecodeSse2(begin, end, max_values, out);
+#endif  // TF_PACKED_WIRE_DECODING_USE_SIMD
+    default:
+      return DecodeScalar(begin, end, max_values, out);
+  }
+}
+
+}  // namespace example
+}  // namespace tensorflow
@@ -0,0 +1,57 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_UTIL_PACKED_WIRE_DECODING_H_
+#define TENSORFLOW_CORE_UTIL_PACKED_WIRE_DECODING_H_
+
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace example {
+
+// Decoding of the bodies of packed repeated varint fields of the protocol
+// buffer wire format, such as the `value` field of an `Int64List`.
+//
+// The decoders look for runs of single-byte varints, which dominate the lists
+// of small integers (ids, labels, counts) found in most feature schemas, and
+// widen whole runs at once. On x86 the runs are found with SSE2, or with AVX2
+// when `port::TestCPUFeature` reports it, and with 64-bit word operations
+// elsewhere.
+
+// The implementations of the decoding functions. `kDefault` is the fastest one
+// supported by the CPU; the others are exposed for tests and benchmarks.
+enum class VarintDecoder { kDefault, kScalar, kSse2, kAvx2 };
+
+// Returns whether `decoder` can be used on this CPU.
+bool IsVarintDecoderSupported(VarintDecoder decoder);
+
+// Returns the number of varints in the packed body `[begin, end)`, or -1 if it
+// does not end with a complete varint.
+int64_t CountPackedVarints(const uint8* begin, const uint8* end,
+                           VarintDecoder decoder = VarintDecoder::kDefault);
+
+// Decodes the varints of the packed body `[begin, end)`, and stores the first
+// `max_values` of them in `out`. Returns the number of varints, including the
+// ones that were not stored, or -1 if the body is not a sequence of valid
+// varints.
+//
+// REQUIRES: `IsVarintDecoderSupported(decoder)`.
+int64_t DecodePackedVarints(const uint8* begin, const uint8* end,
+                            int64_t max_values, int64_t* out,
+                            VarintDecoder decoder = VarintDecoder::kDefault);
+
+}  // namespace example
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_UTIL_PACKED_WIRE_DECODING_H_
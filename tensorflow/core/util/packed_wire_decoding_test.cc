@@ -0,0 +1,233 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/util/packed_wire_decoding.h"
+
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/protobuf.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace example {
+namespace {
+
+constexpr VarintDecoder kDecoders[] = {
+    VarintDecoder::kDefault, VarintDecoder::kScalar, VarintDecoder::kSse2,
+    VarintDecoder::kAvx2};
+
+// The distributions of the values of typical int64 features.
+enum class Values {
+  kSmall,   // Labels, counts and small ids, encoded in one byte.
+  kVocab,   // Ids in a vocabulary of a million entries.
+  kHashed,  // 64-bit hashes or fingerprints.
+  kMixed,   // Mostly small values, with a few large ones.
+};
+
+void AppendVarint(uint64 value, std::vector<uint8>* bytes) {
+  while (value >= 0x80) {
+    bytes->push_back(static_cast<uint8>(value) | 0x80);
+    value >>= 7;
+  }
+  bytes->push_back(static_cast<uint8>(value));
+}
+
+std::vector<int64_t> MakeValues(Values distribution, int n) {
+  random::PhiloxRandom philox(301, 17);
+  random::SimplePhilox rnd(&philox);
+  std::vector<int64_t> values;
+  for (int i = 0; i < n; ++i) {
+    switch (distribution) {
+      case Values::kSmall:
+        values.push_back(rnd.Uniform(128));
+        break;
+      case Values::kVocab:
+        values.push_back(rnd.Uniform(1 << 20));
+        break;
+      case Values::kHashed:
+        values.push_back(rnd.Rand64());
+        break;
+      case Values::kMixed:
+        values.push_back(rnd.OneIn(10) ? rnd.Rand64() : rnd.Uniform(128));
+        break;
+    }
+  }
+  return values;
+}
+
+std::vector<uint8> Encode(const std::vector<int64_t>& values) {
+  std::vector<uint8> bytes;
+  for (int64_t value : values) {
+    AppendVarint(value, &bytes);
+  }
+  return bytes;
+}
+
+// Decodes the packed body the way `example_proto_fast_parsing` used to.
+int64_t DecodeWithCodedInputStream(const std::vector<uint8>& bytes,
+                                   int64_t* out) {
+  protobuf::io::CodedInputStream stream(bytes.data(), bytes.size());
+  int64_t n = 0;
+  while (!stream.ExpectAtEnd()) {
+    protobuf_uint64 value;
+    if (!stream.ReadVarint64(&value)) return -1;
+    out[n++] = value;
+  }
+  return n;
+}
+
+TEST(PackedWireDecodingTest, DecodesAllDistributions) {
+  for (Values distribution :
+       {Values::kSmall, Values::kVocab, Values::kHashed, Values::kMixed}) {
+    // Covers bodies shorter than, and not a multiple of, the SIMD widths.
+    for (int n : {0, 1, 7, 16, 31, 33, 1000}) {
+      const std::vector<int64_t> values = MakeValues(distribution, n);
+      const std::vector<uint8> bytes = Encode(values);
+      for (VarintDecoder decoder : kDecoders) {
+        if (!IsVarintDecoderSupported(decoder)) continue;
+        SCOPED_TRACE(absl::StrCat("distribution ",
+                                  static_cast<int>(distribution), ", n ", n,
+                                  ", decoder ", static_cast<int>(decoder)));
+        EXPECT_EQ(CountPackedVarints(bytes.data(), bytes.data() + bytes.size(),
+                                     decoder),
+                  n);
+        std::vector<int64_t> out(n);
+        EXPECT_EQ(DecodePackedVarints(bytes.data(), bytes.data() + bytes.size(),
+                                      n, out.data(), decoder),
+                  n);
+        EXPECT_EQ(out, values);
+      }
+    }
+  }
+}
+
+TEST(PackedWireDecodingTest, StoresAtMostMaxValues) {
+  const std::vector<int64_t> values = MakeValues(Values::kMixed, 100);
+  const std::vector<uint8> bytes = Encode(values);
+  for (VarintDecoder decoder : kDecoders) {
+    if (!IsVarintDecoderSupported(decoder)) continue;
+    std::vector<int64_t> out(100, -1);
+    EXPECT_EQ(DecodePackedVarints(bytes.data(), bytes.data() + bytes.size(),
+                                  40, out.data(), decoder),
+              100);
+    EXPECT_EQ(std::vector<int64_t>(out.begin(), out.begin() + 40),
+              std::vector<int64_t>(values.begin(), values.begin() + 40));
+    EXPECT_EQ(out[40], -1);
+  }
+}
+
+TEST(PackedWireDecodingTest, RejectsInvalidBodies) {
+  std::vector<uint8> truncated = Encode(MakeValues(Values::kSmall, 40));
+  truncated.push_back(0x80);
+  // Eleven bytes with the continuation bit set, then a terminator.
+  std::vector<uint8> too_long = Encode(MakeValues(Values::kSmall, 40));
+  too_long.insert(too_long.end(), 11, 0xFF);
+  too_long.push_back(0x01);
+  for (VarintDecoder decoder : kDecoders) {
+    if (!IsVarintDecoderSupported(decoder)) continue;
+    std::vector<int64_t> out(100);
+    EXPECT_EQ(CountPackedVarints(truncated.data(),
+                                 truncated.data() + truncated.size(), decoder),
+              -1);
+    EXPECT_EQ(DecodePackedVarints(truncated.data(),
+                                  truncated.data() + truncated.size(),
+                                  out.size(), out.data(), decoder),
+              -1);
+    EXPECT_EQ(DecodePackedVarints(too_long.data(),
+                                  too_long.data() + too_long.size(),
+                                  out.size(), out.data(), decoder),
+              -1);
+  }
+}
+
+TEST(PackedWireDecodingTest, MatchesCodedInputStream) {
+  const std::vector<int64_t> values = MakeValues(Values::kMixed, 1000);
+  const std::vector<uint8> bytes = Encode(values);
+  std::vector<int64_t> expected(values.size());
+  ASSERT_EQ(DecodeWithCodedInputStream(bytes, expected.data()), 1000);
+  std::vector<int64_t> out(values.size());
+  ASSERT_EQ(DecodePackedVarints(bytes.data(), bytes.data() + bytes.size(),
+                                out.size(), out.data()),
+            1000);
+  EXPECT_EQ(out, expected);
+}
+
+// Benchmarks decoding a packed body of `state.range(1)` values of the
+// distribution `state.range(0)`, with `decoder`, or with the
+// `CodedInputStream` loop when `decoder` is null.
+void RunDecodeBenchmark(const VarintDecoder* decoder,
+                        ::testing::benchmark::State& state) {
+  if (decoder != nullptr && !IsVarintDecoderSupported(*decoder)) {
+    state.SkipWithError("Unsupported decoder.");
+    return;
+  }
+  const std::vector<int64_t> values =
+      MakeValues(static_cast<Values>(state.range(0)), state.range(1));
+  const std::vector<uint8> bytes = Encode(values);
+  std::vector<int64_t> out(values.size());
+  for (auto s : state) {
+    const int64_t n =
+        decoder == nullptr
+            ? DecodeWithCodedInputStream(bytes, out.data())
+            : DecodePackedVarints(bytes.data(), bytes.data() + bytes.size(),
+                                  out.size(), out.data(), *decoder);
+    testing::DoNotOptimize(n);
+  }
+  state.SetItemsProcessed(state.iterations() * values.size());
+  state.SetBytesProcessed(state.iterations() * bytes.size());
+}
+
+void BM_DecodeCodedInputStream(::testing::benchmark::State& state) {
+  RunDecodeBenchmark(nullptr, state);
+}
+
+void BM_DecodeScalar(::testing::benchmark::State& state) {
+  const VarintDecoder decoder = VarintDecoder::kScalar;
+  RunDecodeBenchmark(&decoder, state);
+}
+
+void BM_DecodeSse2(::testing::benchmark::State& state) {
+  const VarintDecoder decoder = VarintDecoder::kSse2;
+  RunDecodeBenchmark(&decoder, state);
+}
+
+void BM_DecodeAvx2(::testing::benchmark::State& state) {
+  const VarintDecoder decoder = VarintDecoder::kAvx2;
+  RunDecodeBenchmark(&decoder, state);
+}
+
+// The arguments are the distribution of the values and the number of values.
+#define BM_DECODE_ARGS(BM)                                                \
+  BENCHMARK(BM)                                                           \
+      ->ArgPair(static_cast<int>(Values::kSmall), 16)                     \
+      ->ArgPair(static_cast<int>(Values::kSmall), 1024)                   \
+      ->ArgPair(static_cast<int>(Values::kVocab), 16)                     \
+      ->ArgPair(static_cast<int>(Values::kVocab), 1024)                   \
+      ->ArgPair(static_cast<int>(Values::kHashed), 1024)                  \
+      ->ArgPair(static_cast<int>(Values::kMixed), 1024)
+
+BM_DECODE_ARGS(BM_DecodeCodedInputStream);
+BM_DECODE_ARGS(BM_DecodeScalar);
+BM_DECODE_ARGS(BM_DecodeSse2);
+BM_DECODE_ARGS(BM_DecodeAvx2);
+
+#undef BM_DECODE_ARGS
+
+}  // namespace
+}  // namespace example
+}  // namespace tensorflow
@@ -19,8 +19,11 @@ limitations under the License.
 #include <cstdlib>
 #include <cstring>
 #include <memory>
+#include <numeric>
 #include <utility>
 
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
@@ -44,6 +47,7 @@ limitations under the License.
 #include "tensorflow/core/platform/cord.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/mem.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/saved_tensor_slice_util.h"
 #include "tensorflow/core/util/tensor_bundle/byte_swap.h"
@@ -409,12 +413,86 @@ Status PadAlignment(FileOutputBuffer* out, int alignment, int64_t* size) {
   return status;
 }
 
+// Appends the contents of "val" to "out", which already holds "*size" bytes,
+// followed by the padding to "alignment".  On OK, fills in the offset, size
+// and checksum of "entry" and updates "*size".
+Status AppendTensor(const Tensor& val, int alignment, FileOutputBuffer* out,
+                    int64_t* size, BundleEntryProto* entry) {
+  entry->set_offset(*size);
+
+  size_t data_bytes_written = 0;
+  uint32 crc32c = 0;
+  out->clear_crc32c();
+  if (val.dtype() == DT_STRING) {
+    TF_RETURN_IF_ERROR(
+        WriteStringTensor(val, out, &data_bytes_written, &crc32c));
+  } else if (val.dtype() == DT_VARIANT) {
+    TF_RETURN_IF_ERROR(
+        WriteVariantTensor(val, out, &data_bytes_written, &crc32c));
+  } else {
+    TF_RETURN_IF_ERROR(WriteTensor(val, out, &data_bytes_written));
+    crc32c = out->crc32c();
+  }
+
+  entry->set_size(data_bytes_written);
+  entry->set_crc32c(crc32c::Mask(crc32c));
+  *size += data_bytes_written;
+  return PadAlignment(out, alignment, size);
+}
+
+// Returns an estimate of the number of bytes "val" occupies in a data file,
+// used to balance tensors over data files.
+int64_t EstimateWrittenBytes(const Tensor& val) {
+  if (val.dtype() != DT_STRING) return val.TotalBytes();
+  const tstring* strings = GetStringBackingBuffer(val);
+  int64_t bytes = 0;
+  for (int64_t i = 0; i < val.NumElements(); ++i) {
+    bytes += strings[i].size() + 1;
+  }
+  return bytes;
+}
+
+// A TensorBuffer aliasing part of a memory mapped data file, which it keeps
+// mapped.  It does not own its memory, so the tensors it backs are treated as
+// shared and copied before any update.
+class MappedTensorBuffer : public TensorBuffer {
+ public:
+  MappedTensorBuffer(std::shared_ptr<ReadOnlyMemoryRegion> region,
+                     const char* data, size_t size)
+      : TensorBuffer(const_cast<char*>(data)),
+        region_(std::move(region)),
+        size_(size) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("BundleReaderMappedMemory");
+    proto->set_ptr(reinterpret_cast<uintptr_t>(data()));
+  }
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const std::shared_ptr<ReadOnlyMemoryRegion> region_;
+  const size_t size_;
+};
+
 }  // namespace
 
 BundleWriter::BundleWriter(Env* env, StringPiece prefix, const Options& options)
-    : env_(env), options_(options), prefix_(prefix), out_(nullptr), size_(0) {
+    : env_(env),
+      options_(options),
+      prefix_(prefix),
+      out_(nullptr),
+      size_(0),
+      num_shards_(1) {
   status_ = env_->HasAtomicMove(prefix_, &use_temp_file_);
   if (!status_.ok()) return;
+  if (options_.num_data_files < 1) {
+    status_ = errors::InvalidArgument("num_data_files must be >= 1, got ",
+                                      options_.num_data_files);
+    return;
+  }
 
   data_path_ = DataFilename(prefix_, 0, 1);
   metadata_path_ = MetaFilename(prefix_);
@@ -428,6 +506,11 @@ BundleWriter::BundleWriter(Env* env, StringPiece prefix, const Options& options)
   if (!status_.ok() && !errors::IsAlreadyExists(status_)) {
     return;
   }
+  // The data files are only created by Finish() once their number is known.
+  if (options_.num_data_files > 1) {
+    status_ = Status::OK();
+    return;
+  }
 
   std::unique_ptr<WritableFile> wrapper;
   status_ = env_->NewWritableFile(data_path_, &wrapper);
@@ -451,27 +534,15 @@ Status BundleWriter::Add(StringPiece key, const Tensor& val) {
   entry->set_dtype(val.dtype());
   val.shape().AsProto(entry->mutable_shape());
   entry->set_shard_id(0);
-  entry->set_offset(size_);
-
-  // Updates the data file.
-  size_t data_bytes_written = 0;
-  uint32 crc32c = 0;
-  out_->clear_crc32c();
-  if (val.dtype() == DT_STRING) {
-    status_ = WriteStringTensor(val, out_.get(), &data_bytes_written, &crc32c);
-  } else if (val.dtype() == DT_VARIANT) {
-    status_ = WriteVariantTensor(val, out_.get(), &data_bytes_written, &crc32c);
-  } else {
-    status_ = WriteTensor(val, out_.get(), &data_bytes_written);
-    crc32c = out_->crc32c();
+  if (options_.num_data_files > 1) {
+    // Written by Finish().
+    pending_.emplace_back(key_string, val);
+    return status_;
   }
 
-  if (status_.ok()) {
-    entry->set_size(data_bytes_written);
-    entry->set_crc32c(crc32c::Mask(crc32c));
-    size_ += data_bytes_written;
-    status_ = PadAlignment(out_.get(), options_.data_alignment, &size_);
-  }
+  // Updates the data file.
+  status_ =
+      AppendTensor(val, options_.data_alignment, out_.get(), &size_, entry);
   return status_;
 }
 
@@ -516,9 +587,100 @@ Status BundleWriter::AddSlice(StringPiece full_tensor_key,
   return status_;
 }
 
+Status BundleWriter::WriteDataFiles() {
+  // Never create empty data files, which would not be referenced by any entry
+  // and hence not be renamed by MergeBundles().
+  num_shards_ = std::max<int>(
+      1, std::min<size_t>(options_.num_data_files, pending_.size()));
+
+  // Balances the tensors over the data files by assigning the largest tensors
+  // first, each to the data file with the fewest bytes so far.
+  std::vector<int64_t> sizes(pending_.size());
+  std::vector<int> order(pending_.size());
+  for (int i = 0; i < pending_.size(); ++i) {
+    sizes[i] = EstimateWrittenBytes(pending_[i].second);
+    order[i] = i;
+  }
+  std::stable_sort(order.begin(), order.end(),
+                   [&sizes](int a, int b) { return sizes[a] > sizes[b]; });
+  // Tensors of each data file, in the order they were added.
+  std::vector<std::vector<int>> tensors_per_file(num_shards_);
+  std::vector<std::pair<int64_t, int>> file_loads(num_shards_);
+  for (int i : order) {
+    const int file = std::min_element(file_loads.begin(), file_loads.end()) -
+                     file_loads.begin();
+    file_loads[file].first += sizes[i];
+    ++file_loads[file].second;
+    tensors_per_file[file].push_back(i);
+  }
+  for (auto& tensors : tensors_per_file) {
+    std::sort(tensors.begin(), tensors.end());
+  }
+
+  // Resolves everything shared across threads upfront, so that each thread
+  // only touches the entries and the status of its own data file.
+  std::vector<BundleEntryProto*> pending_entries(pending_.size());
+  for (int i = 0; i < pending_.size(); ++i) {
+    pending_entries[i] = &entries_[pending_[i].first];
+  }
+  std::vector<string> data_paths(num_shards_);
+  for (int file = 0; file < num_shards_; ++file) {
+    data_paths[file] = DataFilename(prefix_, file, num_shards_);
+    if (use_temp_file_) {
+      data_paths[file] =
+          strings::StrCat(data_paths[file], ".tempstate", random::New64());
+    }
+  }
+  std::vector<Status> statuses(num_shards_);
+  auto write_data_file = [&](int file) {
+    VLOG(1) << "Writing to file " << data_paths[file];
+    std::unique_ptr<WritableFile> wrapper;
+    Status s = env_->NewWritableFile(data_paths[file], &wrapper);
+    if (!s.ok()) {
+      statuses[file] = s;
+      return;
+    }
+    FileOutputBuffer out(wrapper.release(), 8 << 20 /* 8MB write buffer */);
+    int64_t size = 0;
+    for (int i : tensors_per_file[file]) {
+      pending_entries[i]->set_shard_id(file);
+      s = AppendTensor(pending_[i].second, options_.data_alignment, &out,
+                       &size, pending_entries[i]);
+      if (!s.ok()) break;
+    }
+    s.Update(out.Close());
+    statuses[file] = s;
+  };
+  if (num_shards_ == 1) {
+    write_data_file(0);
+  } else {
+    thread::ThreadPool pool(env_, "bundle_writer", num_shards_);
+    for (int file = 0; file < num_shards_; ++file) {
+      pool.Schedule([&write_data_file, file]() { write_data_file(file); });
+    }
+    // The destructor of "pool" waits for the data files to be written.
+  }
+  pending_.clear();
+
+  Status status;
+  for (const Status& s : statuses) status.Update(s);
+  for (int file = 0; file < num_shards_; ++file) {
+    if (!status.ok()) {
+      Env::Default()->DeleteFile(data_paths[file]).IgnoreError();
+    } else if (use_temp_file_) {
+      status.Update(Env::Default()->RenameFile(
+          data_paths[file], DataFilename(prefix_, file, num_shards_)));
+    }
+  }
+  return status;
+}
+
 // TODO(zongheng): on metadata write failure or !status_.ok(), consider removing
 // the orphaned data file.
 Status BundleWriter::Finish() {
+  if (status_.ok() && options_.num_data_files > 1) {
+    status_ = WriteDataFiles();
+  }
   if (out_) {
     status_.Update(out_->Close());
     out_ = nullptr;
@@ -544,7 +706,7 @@ Status BundleWriter::Finish() {
     table::TableBuilder builder(options, file.get());
     // Header entry.
     BundleHeaderProto header;
-    header.set_num_shards(1);
+    header.set_num_shards(num_shards_);
     header.set_endianness(BundleHeaderProto::LITTLE);
     if (!port::kLittleEndian) header.set_endianness(BundleHeaderProto::BIG);
     VersionDef* version = header.mutable_version();
@@ -743,13 +905,15 @@ Status MergeBundles(Env* env, gtl::ArraySlice<tstring> prefixes,
 
 // Interface for reading a tensor bundle.
 
-BundleReader::BundleReader(Env* env, StringPiece prefix)
+BundleReader::BundleReader(Env* env, StringPiece prefix,
+                           const Options& options)
     : env_(env),
       prefix_(prefix),
       metadata_(nullptr),
       table_(nullptr),
       index_cache_(nullptr),
       iter_(nullptr),
+      memmap_data_files_(options.memmap_data_files),
       need_to_swap_bytes_(false) {
   const string filename = MetaFilename(prefix_);
   uint64 file_size;
@@ -825,7 +989,7 @@ Status BundleReader::GetBundleEntryProto(StringPiece key,
                                          BundleEntryProto* entry) {
   entry->Clear();
   TF_CHECK_OK(status_);
-  Seek(key);
+  SeekForward(key);
   if (!iter_->Valid() || iter_->key() != key) {
     return errors::NotFound("Key ", key, " not found in checkpoint");
   }
@@ -842,7 +1006,104 @@ Status BundleReader::GetBundleEntryProto(StringPiece key,
   return Status::OK();
 }
 
+void BundleReader::SeekForward(StringPiece key) {
+  // Consecutive keys are usually in the same table block, where a step is
+  // much cheaper than a binary search of the index and the block.
+  static constexpr int kMaxForwardSteps = 2;
+  bool moved = false;
+  for (int i = 0; i < kMaxForwardSteps && iter_->Valid() && iter_->key() < key;
+       ++i) {
+    iter_->Next();
+    moved = true;
+  }
+  // Stepping forward only lands at the first key no less than "key" if the
+  // reader started before it.
+  if (iter_->Valid() &&
+      (iter_->key() == key || (moved && iter_->key() > key))) {
+    return;
+  }
+  Seek(key);
+}
+
+Status BundleReader::GetDataFile(int32_t shard_id,
+                                 io::InputBuffer** buffered_file) {
+  io::InputBuffer*& data_file = data_[shard_id];
+  if (data_file == nullptr) {
+    std::unique_ptr<RandomAccessFile> file = nullptr;
+    TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(
+        DataFilename(prefix_, shard_id, num_shards_), &file));
+    // The InputBuffer and RandomAccessFile objects are both released in dtor.
+    data_file = new io::InputBuffer(file.release(), kBufferSize);
+  }
+  *buffered_file = data_file;
+  return Status::OK();
+}
+
+Status BundleReader::GetMappedValue(const BundleEntryProto& entry,
+                                    Tensor* val, bool* aliased) {
+  *aliased = false;
+  if (!memmap_data_files_ || need_to_swap_bytes_ ||
+      !DataTypeCanUseMemcpy(entry.dtype())) {
+    return Status::OK();
+  }
+  const bool allocated = val->NumElements() > 0;
+  const DataType dtype = allocated ? val->dtype() : entry.dtype();
+  const TensorShape shape =
+      allocated ? val->shape() : TensorShape(entry.shape());
+  // Sizes that do not match are reported by GetValue().
+  if (shape.num_elements() == 0 ||
+      entry.size() != shape.num_elements() * DataTypeSize(dtype)) {
+    return Status::OK();
+  }
+
+  std::shared_ptr<ReadOnlyMemoryRegion>& region =
+      mapped_data_[entry.shard_id()];
+  if (region == nullptr) {
+    std::unique_ptr<ReadOnlyMemoryRegion> new_region;
+    Status s = env_->NewReadOnlyMemoryRegionFromFile(
+        DataFilename(prefix_, entry.shard_id(), num_shards_), &new_region);
+    if (errors::IsUnimplemented(s)) {
+      LOG(WARNING) << "Memory mapping is not supported for the data files of "
+                   << prefix_ << ", reading them instead: " << s;
+      memmap_data_files_ = false;
+      return Status::OK();
+    }
+    TF_RETURN_IF_ERROR(s);
+    region = std::move(new_region);
+  }
+  if (entry.offset() + entry.size() > region->length()) {
+    return errors::DataLoss("TensorBundle at ", prefix_, " shard ",
+                            entry.shard_id(), ": entry at offset ",
+                            entry.offset(), " of ", entry.size(),
+                            " bytes exceeds the data file size ",
+                            region->length());
+  }
+  const char* data =
+      static_cast<const char*>(region->data()) + entry.offset();
+  if (reinterpret_cast<uintptr_t>(data) % Allocator::kAllocatorAlignment != 0) {
+    return Status::OK();
+  }
+
+  const uint32 actual_crc32c = crc32c::Value(data, entry.size());
+  if (crc32c::Unmask(entry.crc32c()) != actual_crc32c) {
+    return errors::DataLoss(
+        "TensorBundle at ", prefix_, " shard ", entry.shard_id(), " (",
+        entry.size(), " bytes): Checksum does not match: stored ",
+        strings::Printf("%08u", crc32c::Unmask(entry.crc32c())),
+        " vs. calculated on the mapped bytes ", actual_crc32c);
+  }
+  MappedTensorBuffer* buf = new MappedTensorBuffer(region, data, entry.size());
+  *val = Tensor(dtype, shape, buf);
+  buf->Unref();
+  *aliased = true;
+  return Status::OK();
+}
+
 Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
+  bool aliased;
+  TF_RETURN_IF_ERROR(GetMappedValue(entry, val, &aliased));
+  if (aliased) return Status::OK();
+
   Tensor* ret = val;
   const TensorShape stored_shape(TensorShape(entry.shape()));
   if (val->NumElements() == 0) {
@@ -871,17 +1132,8 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
     }
   }
 
-  // Open the data file if it has not been opened.
-  io::InputBuffer* buffered_file = data_[entry.shard_id()];
-  if (buffered_file == nullptr) {
-    std::unique_ptr<RandomAccessFile> file = nullptr;
-    TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(
-        DataFilename(prefix_, entry.shard_id(), num_shards_), &file));
-    buffered_file = new io::InputBuffer(file.release(), kBufferSize);
-    // The InputBuffer and RandomAccessFile objects are both released in dtor.
-    data_[entry.shard_id()] = buffered_file;
-  }
-  CHECK(buffered_file != nullptr);
+  io::InputBuffer* buffered_file;
+  TF_RETURN_IF_ERROR(GetDataFile(entry.shard_id(), &buffered_file));
 
   TF_RETURN_IF_ERROR(buffered_file->Seek(entry.offset()));
   uint32 actual_crc32c = 0;
@@ -952,6 +1204,157 @@ Status BundleReader::Lookup(StringPiece key, Tensor* val) {
   }
 }
 
+Status BundleReader::LookupMany(gtl::ArraySlice<string> keys,
+                                gtl::ArraySlice<Tensor*> vals,
+                                int num_threads) {
+  CHECK_EQ(keys.size(), vals.size());
+  // Maximum number of bytes read by one coalesced read, and of unused bytes
+  // (e.g. alignment padding) between two tensors that are still coalesced.
+  static constexpr int64_t kMaxReadBytes = 16 << 20;
+  static constexpr int64_t kMaxGapBytes = 64 << 10;
+
+  struct TensorRead {
+    BundleEntryProto entry;
+    Tensor* val;
+  };
+  // The metadata entries are read in key order, so that the table is walked
+  // forward in one pass instead of being searched once per key.
+  std::vector<int> key_order(keys.size());
+  std::iota(key_order.begin(), key_order.end(), 0);
+  std::sort(key_order.begin(), key_order.end(),
+            [&keys](int a, int b) { return keys[a] < keys[b]; });
+  std::vector<BundleEntryProto> entries(keys.size());
+  for (int i : key_order) {
+    TF_RETURN_IF_ERROR(GetBundleEntryProto(keys[i], &entries[i]));
+  }
+
+  std::vector<TensorRead> reads;
+  std::vector<int> other_keys;
+  for (int i = 0; i < keys.size(); ++i) {
+    CHECK(vals[i] != nullptr);
+    BundleEntryProto& entry = entries[i];
+    if (!entry.slices().empty() || !DataTypeCanUseMemcpy(entry.dtype()) ||
+        vals[i]->NumElements() == 0) {
+      other_keys.push_back(i);
+      continue;
+    }
+    bool aliased;
+    TF_RETURN_IF_ERROR(GetMappedValue(entry, vals[i], &aliased));
+    if (aliased) continue;
+    if (entry.size() != vals[i]->TotalBytes()) {
+      return errors::DataLoss("Invalid size in bundle entry: key ", keys[i],
+                              "; stored size ", entry.size(),
+                              "; expected size ", vals[i]->TotalBytes());
+    }
+    reads.push_back({std::move(entry), vals[i]});
+  }
+  std::sort(reads.begin(), reads.end(),
+            [](const TensorRead& a, const TensorRead& b) {
+              return std::make_pair(a.entry.shard_id(), a.entry.offset()) <
+                     std::make_pair(b.entry.shard_id(), b.entry.offset());
+            });
+
+  // A contiguous range of a data file holding reads[begin, end).
+  struct CoalescedRead {
+    RandomAccessFile* file;
+    int64_t offset;
+    int64_t size;
+    int begin;
+    int end;
+  };
+  std::vector<CoalescedRead> coalesced_reads;
+  for (int i = 0; i < reads.size(); ++i) {
+    const BundleEntryProto& entry = reads[i].entry;
+    if (i > 0 && reads[i - 1].entry.shard_id() == entry.shard_id()) {
+      CoalescedRead& last = coalesced_reads.back();
+      const int64_t gap = entry.offset() - (last.offset + last.size);
+      if (gap >= 0 && gap <= kMaxGapBytes &&
+          last.size + gap + entry.size() <= kMaxReadBytes) {
+        last.size += gap + entry.size();
+        last.end = i + 1;
+        continue;
+      }
+    }
+    io::InputBuffer* buffered_file;
+    TF_RETURN_IF_ERROR(GetDataFile(entry.shard_id(), &buffered_file));
+    coalesced_reads.push_back(
+        {buffered_file->file(), entry.offset(), entry.size(), i, i + 1});
+  }
+
+  // RandomAccessFile::Read() is thread-safe, and each TensorRead belongs to a
+  // single coalesced read, so these may run concurrently.
+  auto run = [&](const CoalescedRead& read) -> Status {
+    // A lone tensor is read directly into its buffer.
+    std::unique_ptr<char[]> staging;
+    char* scratch = GetBackingBuffer(*reads[read.begin].val);
+    if (read.end - read.begin > 1) {
+      staging.reset(new char[read.size]);
+      scratch = staging.get();
+    }
+    StringPiece data;
+    TF_RETURN_IF_ERROR(read.file->Read(read.offset, read.size, &data, scratch));
+    if (data.size() != read.size) {
+      return errors::DataLoss("TensorBundle at ", prefix_, ": read ",
+                              data.size(), " bytes at offset ", read.offset,
+                              "; expected ", read.size);
+    }
+    for (int i = read.begin; i < read.end; ++i) {
+      const BundleEntryProto& entry = reads[i].entry;
+      char* backing_buffer = GetBackingBuffer(*reads[i].val);
+      const char* src = data.data() + (entry.offset() - read.offset);
+      if (src != backing_buffer) {
+        memmove(backing_buffer, src, entry.size());
+      }
+      // Note that we compute the checksum *before* byte-swapping.
+      const uint32 actual_crc32c = crc32c::Value(backing_buffer, entry.size());
+      if (crc32c::Unmask(entry.crc32c()) != actual_crc32c) {
+        return errors::DataLoss(
+            "TensorBundle at ", prefix_, " shard ", entry.shard_id(), " (",
+            entry.size(), " bytes): Checksum does not match: stored ",
+            strings::Printf("%08u", crc32c::Unmask(entry.crc32c())),
+            " vs. calculated on the restored bytes ", actual_crc32c);
+      }
+      if (need_to_swap_bytes_) {
+        TF_RETURN_IF_ERROR(ByteSwapTensor(reads[i].val));
+      }
+    }
+    return Status::OK();
+  };
+
+  std::vector<Status> statuses(coalesced_reads.size());
+  Status status;
+  {
+    // The calling thread takes the first coalesced read.
+    std::unique_ptr<thread::ThreadPool> pool;
+    const int pool_size =
+        std::min<int>(num_threads - 1, coalesced_reads.size() - 1);
+    if (pool_size > 0) {
+      pool.reset(new thread::ThreadPool(env_, "bundle_reader", pool_size));
+      for (int i = 1; i < coalesced_reads.size(); ++i) {
+        pool->Schedule([&run, &statuses, &coalesced_reads, i]() {
+          statuses[i] = run(coalesced_reads[i]);
+        });
+      }
+    } else {
+      for (int i = 1; i < coalesced_reads.size(); ++i) {
+        statuses[i] = run(coalesced_reads[i]);
+      }
+    }
+    if (!coalesced_reads.empty()) {
+      statuses[0] = run(coalesced_reads[0]);
+    }
+    // The other tensors only use "data_" and the metadata table, which the
+    // coalesced reads do not touch.
+    for (int i : other_keys) {
+      status.Update(Lookup(keys[i], vals[i]));
+      if (!status.ok()) break;
+    }
+    // The destructor of "pool" waits for the coalesced reads.
+  }
+  for (const Status& s : statuses) status.Update(s);
+  return status;
+}
+
 Status BundleReader::ReadCurrent(Tensor* val) {
   CHECK(val != nullptr);
   BundleEntryProto entry;
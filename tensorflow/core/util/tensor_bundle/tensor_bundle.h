@@ -38,8 +38,11 @@ limitations under the License.
 //   BundleReader reader(env, "/fs/model/train/ckpt-step/ckpt");
 //   reader.Lookup("name", &tensor);
 //
-// A tensor bundle can be built using BundleWriter.  Each BundleWriter builds a
-// single data file bundle.  Multiple bundles can then be merged by
+// A tensor bundle can be built using BundleWriter.  By default each
+// BundleWriter builds a single data file bundle; with
+// BundleWriter::Options::num_data_files > 1 it spreads the tensors over several
+// data files that are written concurrently.  Multiple bundles can then be
+// merged by
 // MergeBundles() without reading and writing large chunk of data: it reads the
 // metadata files and outputs a single merged metadata.  Typical usage:
 //
@@ -62,8 +65,11 @@ limitations under the License.
 #define TENSORFLOW_CORE_UTIL_TENSOR_BUNDLE_TENSOR_BUNDLE_H_
 
 #include <map>
+#include <memory>
 #include <string>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
@@ -116,12 +122,24 @@ class BundleWriter {
     // Alignment, in bytes, for tensor data.
     // Must be >= 1. The default size of 1 densely packs tensors.
     int data_alignment{1};
+
+    // Maximum number of data files the tensors are spread over.
+    // Must be >= 1. With the default of 1, the tensors are streamed into a
+    // single data file as they are added.  Otherwise Add() only records the
+    // tensors, and Finish() balances them by size over up to this many data
+    // files and writes (and checksums) the files concurrently, one thread per
+    // file.  The resulting bundle is read by BundleReader and merged by
+    // MergeBundles() like any other multi-shard bundle.
+    int num_data_files{1};
   };
   BundleWriter(Env* env, StringPiece prefix,
                const Options& options = Options());
 
   // Adds the tensor "val" under key "key".
   // Across calls "key" must be unique but can be added in any order.
+  //
+  // If options.num_data_files > 1, "val" is only written by Finish(), so its
+  // contents must not be modified until Finish() returns.
   Status Add(StringPiece key, const Tensor& val);
 
   // Partitioned variables support.
@@ -150,6 +168,9 @@ class BundleWriter {
   Status status() const { return status_; }
 
  private:
+  // Writes the tensors recorded in "pending_" over multiple data files.
+  Status WriteDataFiles();
+
   Env* const env_;  // Not owned.
   const Options options_;
   const string prefix_;
@@ -159,6 +180,11 @@ class BundleWriter {
   std::unique_ptr<FileOutputBuffer> out_;
   int64_t size_;  // Number of bytes written into out_.
   std::map<string, BundleEntryProto> entries_;
+  // Tensors added but not yet written, in the order they were added.  Only
+  // used when options_.num_data_files > 1.
+  std::vector<std::pair<string, Tensor>> pending_;
+  // Number of data files of the finished bundle.
+  int num_shards_;
   Status status_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(BundleWriter);
@@ -186,7 +212,22 @@ Status MergeBundles(Env* env, gtl::ArraySlice<tstring> prefixes,
 // All threads accessing the same BundleReader must synchronize.
 class BundleReader {
  public:
-  BundleReader(Env* const env, StringPiece prefix);
+  struct Options {
+    Options() {}
+    // If true, the data files are memory mapped, and the non-partitioned
+    // tensors of memcpy-able dtypes are returned as read-only tensors that
+    // alias the mapping instead of copies: such tensors consume no private
+    // memory, and bundles opened by several readers share the page cache.
+    // Their buffers do not own their memory, so they are never forwarded or
+    // updated in place.  Only tensors stored at offsets aligned to
+    // Allocator::kAllocatorAlignment (see BundleWriter::Options::
+    // data_alignment) in this machine's byte order are aliased; everything
+    // else, or filesystems without memory mapping support, fall back to
+    // reading copies.
+    bool memmap_data_files{false};
+  };
+  BundleReader(Env* const env, StringPiece prefix,
+               const Options& options = Options());
   ~BundleReader();
 
   // Is ok() iff the reader construction is successful (completed the read of
@@ -235,6 +276,19 @@ class BundleReader {
   // REQUIRES: status().ok()
   Status Lookup(StringPiece key, Tensor* val) TF_MUST_USE_RESULT;
 
+  // Looks up the tensors keyed by "keys" into "vals", which must be allocated
+  // as for "Lookup()".  Equivalent to calling "Lookup()" on each pair, but the
+  // non-partitioned tensors of memcpy-able dtypes are read in file order with
+  // few large I/Os: neighbouring tensors of a data file are coalesced into
+  // reads of up to 16MB, which are issued concurrently from "num_threads"
+  // threads along with the checksum validation.  The remaining tensors are
+  // read from the calling thread while those reads are in flight.
+  //
+  // On error, "vals" may contain nonsense data.
+  // REQUIRES: status().ok() && keys.size() == vals.size()
+  Status LookupMany(gtl::ArraySlice<string> keys, gtl::ArraySlice<Tensor*> vals,
+                    int num_threads = 1) TF_MUST_USE_RESULT;
+
   // Looks up the tensor pointed to by the internal iterator.
   //
   // On error, "val" may contain nonsense data.
@@ -286,11 +340,28 @@ class BundleReader {
   Status GetBundleEntryProto(StringPiece key,
                              BundleEntryProto* entry) TF_MUST_USE_RESULT;
 
+  // Positions the reader like Seek(key), but first tries a few steps forward
+  // from the current position, which avoids searching the index when keys
+  // are visited in sorted order.
+  // REQUIRES: status().ok()
+  void SeekForward(StringPiece key);
+
   // Reads the tensor value described by the metadata proto "entry".
   // Usage for "val" follows the comment of "Lookup()".
   Status GetValue(const BundleEntryProto& entry,
                   Tensor* val) TF_MUST_USE_RESULT;
 
+  // Returns the buffered data file of shard "shard_id", opening it if it has
+  // not been opened.
+  Status GetDataFile(int32_t shard_id,
+                     io::InputBuffer** buffered_file) TF_MUST_USE_RESULT;
+
+  // If the data files are memory mapped and "entry" can be aliased, sets
+  // "aliased" and sets "val" to a tensor backed by the mapping of "entry".
+  // Usage for "val" follows the comment of "Lookup()".
+  Status GetMappedValue(const BundleEntryProto& entry, Tensor* val,
+                        bool* aliased) TF_MUST_USE_RESULT;
+
   // Reads the slice described by "slice_spec".  The corresponding full tensor
   // has key "ful_tensor_key" and metadata proto "full_tensor_entry".
   // REQUIRES: full_tensor_entry.slices_size() > 0
@@ -310,6 +381,12 @@ class BundleReader {
   // Owned the InputBuffer objects and their underlying RandomAccessFile's.
   std::unordered_map<int32, io::InputBuffer*> data_;
 
+  // Whether the data files are memory mapped, and the mappings of the data
+  // files that have been mapped.  Shared with the tensors aliasing them.
+  bool memmap_data_files_;
+  std::unordered_map<int32, std::shared_ptr<ReadOnlyMemoryRegion>>
+      mapped_data_;
+
   // Maps each partitioned tensor's key to its stored slices (represented in a
   // TensorSliceSet).  Populated on-demand.
   std::unordered_map<string, checkpoint::TensorSliceSet*> tensor_slices_;
@@ -16,9 +16,12 @@ limitations under the License.
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 
 #include <random>
+#include <set>
 #include <string>
 #include <vector>
 
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/tensor_description.pb.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.pb.h"
@@ -30,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/lib/io/table_builder.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/protobuf/error_codes.pb.h"
@@ -889,6 +893,106 @@ TEST(TensorBundleTest, DirectoryStructure) {
                           "merged.data-00001-of-00002"});
 }
 
+TEST(TensorBundleTest, MultipleDataFiles) {
+  Env* env = Env::Default();
+  const TensorShape kFullShape({5, 10});
+  const TensorSlice kSlice1 = TensorSlice::ParseOrDie("-:0,1");
+  const TensorSlice kSlice2 = TensorSlice::ParseOrDie("-:1,9");
+  Tensor strings(DT_STRING, TensorShape({2}));
+  strings.flat<tstring>()(0) = "hello";
+  strings.flat<tstring>()(1) = string(1000, 'x');
+  {
+    BundleWriter::Options opts;
+    opts.num_data_files = 3;
+    opts.data_alignment = 8;
+    BundleWriter writer(env, Prefix("multi"), opts);
+    TF_EXPECT_OK(writer.Add("big", Constant<float>(1., TensorShape({1000}))));
+    TF_EXPECT_OK(writer.Add("small", Constant_2x3<int32>(2)));
+    TF_EXPECT_OK(writer.Add("strings", strings));
+    TF_EXPECT_OK(writer.AddSlice("sliced", kFullShape, kSlice1,
+                                 Constant<float>(0., TensorShape({5, 1}))));
+    TF_EXPECT_OK(writer.AddSlice("sliced", kFullShape, kSlice2,
+                                 Constant<float>(1., TensorShape({5, 9}))));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  for (int i = 0; i < 3; ++i) {
+    TF_EXPECT_OK(env->FileExists(DataFilename(Prefix("multi"), i, 3)));
+  }
+
+  // Each data file holds at least one tensor.
+  std::set<int> shard_ids;
+  {
+    BundleReader reader(env, Prefix("multi"));
+    TF_ASSERT_OK(reader.status());
+    reader.Seek(kHeaderEntryKey);
+    for (reader.Next(); reader.Valid(); reader.Next()) {
+      BundleEntryProto entry;
+      ASSERT_TRUE(entry.ParseFromArray(reader.value().data(),
+                                       reader.value().size()));
+      if (entry.slices().empty()) shard_ids.insert(entry.shard_id());
+    }
+    EXPECT_THAT(shard_ids, ElementsAre(0, 1, 2));
+
+    Expect<float>(&reader, "big", Constant<float>(1., TensorShape({1000})));
+    Expect<int32>(&reader, "small", Constant_2x3<int32>(2));
+    Expect<tstring>(&reader, "strings", strings);
+    Tensor expected_val(DT_FLOAT, TensorShape({5, 2}));
+    test::FillFn<float>(&expected_val,
+                        [](int offset) -> float { return offset % 2; });
+    Tensor val(DT_FLOAT, TensorShape({5, 2}));
+    TF_ASSERT_OK(
+        reader.LookupSlice("sliced", TensorSlice::ParseOrDie("-:0,2"), &val));
+    test::ExpectTensorEqual<float>(val, expected_val);
+  }
+
+  // A multi-file bundle merges like any other bundle.
+  {
+    BundleWriter writer(env, Prefix("single"));
+    TF_EXPECT_OK(writer.Add("other", Constant_2x3<float>(3.)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  const string kMerged = Prefix("merged_multi");
+  TF_ASSERT_OK(MergeBundles(env, {Prefix("multi"), Prefix("single")}, kMerged));
+  for (int i = 0; i < 4; ++i) {
+    TF_EXPECT_OK(env->FileExists(DataFilename(kMerged, i, 4)));
+  }
+  BundleReader reader(env, kMerged);
+  TF_ASSERT_OK(reader.status());
+  Expect<float>(&reader, "big", Constant<float>(1., TensorShape({1000})));
+  Expect<int32>(&reader, "small", Constant_2x3<int32>(2));
+  Expect<tstring>(&reader, "strings", strings);
+  Expect<float>(&reader, "other", Constant_2x3<float>(3.));
+}
+
+TEST(TensorBundleTest, MultipleDataFilesFewTensors) {
+  Env* env = Env::Default();
+  BundleWriter::Options opts;
+  opts.num_data_files = 4;
+  {
+    BundleWriter writer(env, Prefix("few"), opts);
+    TF_EXPECT_OK(writer.Add("foo", Constant_2x3<float>(1.)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  // No empty data files are created.
+  TF_EXPECT_OK(env->FileExists(DataFilename(Prefix("few"), 0, 1)));
+  EXPECT_FALSE(env->FileExists(DataFilename(Prefix("few"), 0, 4)).ok());
+  BundleReader reader(env, Prefix("few"));
+  TF_ASSERT_OK(reader.status());
+  Expect<float>(&reader, "foo", Constant_2x3<float>(1.));
+
+  {
+    BundleWriter writer(env, Prefix("none"), opts);
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader empty_reader(env, Prefix("none"));
+  TF_ASSERT_OK(empty_reader.status());
+  EXPECT_TRUE(AllTensorKeys(&empty_reader).empty());
+
+  opts.num_data_files = 0;
+  BundleWriter writer(env, Prefix("invalid"), opts);
+  EXPECT_EQ(error::INVALID_ARGUMENT, writer.status().code());
+}
+
 TEST(TensorBundleTest, SortForSequentialAccess) {
   Env* env = Env::Default();
   const std::vector<string> kBundlePrefixes = {Prefix("worker0"),
@@ -926,6 +1030,139 @@ TEST(TensorBundleTest, SortForSequentialAccess) {
                           "tensor-1-2", "tensor-1-1", "tensor-1-0"));
 }
 
+TEST(TensorBundleTest, LookupMany) {
+  Env* env = Env::Default();
+  const TensorShape kFullShape({5, 10});
+  Tensor strings(DT_STRING, TensorShape({2}));
+  strings.flat<tstring>()(0) = "hello";
+  strings.flat<tstring>()(1) = "world";
+  {
+    BundleWriter::Options opts;
+    opts.num_data_files = 2;
+    opts.data_alignment = 64;
+    BundleWriter writer(env, Prefix("many"), opts);
+    for (int i = 0; i < 10; ++i) {
+      TF_EXPECT_OK(writer.Add(strings::StrCat("tensor-", i),
+                              Constant<float>(i, TensorShape({100 * i + 1}))));
+    }
+    TF_EXPECT_OK(writer.Add("empty", Constant<int64_t>(0, TensorShape({0}))));
+    TF_EXPECT_OK(writer.Add("strings", strings));
+    TF_EXPECT_OK(writer.AddSlice("sliced", kFullShape,
+                                 TensorSlice::ParseOrDie("-:0,10"),
+                                 Constant<int32>(7, kFullShape)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+
+  BundleReader reader(env, Prefix("many"));
+  TF_ASSERT_OK(reader.status());
+  std::vector<string> keys = {"sliced", "empty", "strings"};
+  std::vector<Tensor> vals = {Tensor(DT_INT32, kFullShape),
+                              Tensor(DT_INT64, TensorShape({0})),
+                              Tensor(DT_STRING, TensorShape({2}))};
+  for (int i = 9; i >= 0; --i) {
+    keys.push_back(strings::StrCat("tensor-", i));
+    vals.push_back(Tensor(DT_FLOAT, TensorShape({100 * i + 1})));
+  }
+  std::vector<Tensor*> val_ptrs;
+  for (Tensor& val : vals) val_ptrs.push_back(&val);
+  for (int num_threads : {1, 4}) {
+    TF_ASSERT_OK(reader.LookupMany(keys, val_ptrs, num_threads));
+    test::ExpectTensorEqual<int32>(vals[0], Constant<int32>(7, kFullShape));
+    EXPECT_EQ(0, vals[1].NumElements());
+    test::ExpectTensorEqual<tstring>(vals[2], strings);
+    for (int i = 9; i >= 0; --i) {
+      test::ExpectTensorEqual<float>(
+          vals[12 - i], Constant<float>(i, TensorShape({100 * i + 1})));
+    }
+  }
+
+  Tensor wrong_size(DT_FLOAT, TensorShape({2}));
+  Tensor* wrong_size_ptr = &wrong_size;
+  EXPECT_EQ(error::DATA_LOSS,
+            reader.LookupMany({"tensor-3"}, {wrong_size_ptr}).code());
+  Tensor tensor;
+  Tensor* tensor_ptr = &tensor;
+  EXPECT_EQ(error::NOT_FOUND,
+            reader.LookupMany({"nonexist"}, {tensor_ptr}).code());
+}
+
+TEST(TensorBundleTest, LookupInAnyOrder) {
+  Env* env = Env::Default();
+  {
+    BundleWriter writer(env, Prefix("any_order"));
+    for (int i = 0; i < 100; ++i) {
+      TF_EXPECT_OK(writer.Add(strings::Printf("tensor-%03d", 2 * i),
+                              Constant<int32>(2 * i, TensorShape({2}))));
+    }
+    TF_ASSERT_OK(writer.Finish());
+  }
+
+  BundleReader reader(env, Prefix("any_order"));
+  TF_ASSERT_OK(reader.status());
+  // Ascending, repeated, descending and distant keys, and missing keys just
+  // after, just before and far from the last key.
+  for (int i : {0, 2, 4, 4, 6, 2, 0, 198, 8, 100, 98, 96, 150, 152}) {
+    Tensor val(DT_INT32, TensorShape({2}));
+    TF_ASSERT_OK(reader.Lookup(strings::Printf("tensor-%03d", i), &val));
+    test::ExpectTensorEqual<int32>(val, Constant<int32>(i, TensorShape({2})));
+  }
+  for (int i : {153, 151, 199, 1, 3}) {
+    Tensor val(DT_INT32, TensorShape({2}));
+    EXPECT_EQ(error::NOT_FOUND,
+              reader.Lookup(strings::Printf("tensor-%03d", i), &val).code());
+  }
+}
+
+// Returns the name of the allocator of the buffer backing "val".
+string AllocatorName(const Tensor& val) {
+  TensorDescription description;
+  val.FillDescription(&description);
+  return description.allocation_description().allocator_name();
+}
+
+TEST(TensorBundleTest, MemmappedDataFiles) {
+  Env* env = Env::Default();
+  Tensor strings(DT_STRING, TensorShape({1}));
+  strings.flat<tstring>()(0) = "hello";
+  for (int alignment : {1, 64}) {
+    const string prefix = Prefix(strings::StrCat("mapped", alignment));
+    {
+      BundleWriter::Options opts;
+      opts.data_alignment = alignment;
+      BundleWriter writer(env, prefix, opts);
+      TF_EXPECT_OK(writer.Add("a", Constant<int8>(1, TensorShape({3}))));
+      TF_EXPECT_OK(writer.Add("b", Constant_2x3<float>(2.)));
+      TF_EXPECT_OK(writer.Add("c", strings));
+      TF_ASSERT_OK(writer.Finish());
+    }
+    BundleReader::Options reader_opts;
+    reader_opts.memmap_data_files = true;
+    Tensor a(DT_INT8, TensorShape({3}));
+    Tensor b;
+    Tensor ab_copy(DT_FLOAT, TensorShape({2, 3}));
+    {
+      BundleReader reader(env, prefix, reader_opts);
+      TF_ASSERT_OK(reader.status());
+      TF_ASSERT_OK(reader.Lookup("a", &a));
+      reader.Seek("b");
+      TF_ASSERT_OK(reader.ReadCurrent(&b));
+      TF_ASSERT_OK(reader.LookupMany({"b"}, {&ab_copy}));
+      Expect<tstring>(&reader, "c", strings);
+    }
+    // The mapped tensors outlive the reader.
+    test::ExpectTensorEqual<int8>(a, Constant<int8>(1, TensorShape({3})));
+    test::ExpectTensorEqual<float>(b, Constant_2x3<float>(2.));
+    test::ExpectTensorEqual<float>(ab_copy, Constant_2x3<float>(2.));
+    // "a" is the first tensor of the data file, so it is always aligned; "b"
+    // follows it, so it is only aligned with padding.
+    EXPECT_EQ("BundleReaderMappedMemory", AllocatorName(a));
+    EXPECT_FALSE(a.RefCountIsOne());
+    EXPECT_EQ(alignment == 64, AllocatorName(b) == "BundleReaderMappedMemory");
+    EXPECT_EQ(alignment == 64,
+              AllocatorName(ab_copy) == "BundleReaderMappedMemory");
+  }
+}
+
 TEST(TensorBundleTest, Error) {
   {  // Dup keys.
     BundleWriter writer(Env::Default(), Prefix("dup"));
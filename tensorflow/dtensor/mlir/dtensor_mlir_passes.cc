@@ -161,6 +161,10 @@ void CreateDTensorMLIRPass(const mlir::TF::StandardPipelineOptions &options,
   // const only had one usage) as part of layout propagation.
   pm->addPass(mlir::createCSEPass());
 
+  // Merges consecutive relayouts and removes relayout round trips emitted by
+  // the expansion of neighboring ops.
+  pm->addNestedPass<mlir::func::FuncOp>(CreateDTensorRelayoutOptimization());
+
   // Lower the AllGather collectives. This has to happen before the all reduce
   // optimizations and AllGather may emit an AllReduce.
   pm->addPass(CreateDTensorAllGatherLoweringPass());
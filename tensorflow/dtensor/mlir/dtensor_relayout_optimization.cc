@@ -0,0 +1,188 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <vector>
+
+#include "llvm/ADT/SmallPtrSet.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"  // from @llvm-project
+#include "mlir/IR/BuiltinTypes.h"  // from @llvm-project
+#include "mlir/IR/Operation.h"  // from @llvm-project
+#include "mlir/IR/Value.h"  // from @llvm-project
+#include "mlir/Support/LogicalResult.h"  // from @llvm-project
+#include "mlir/Transforms/Passes.h"  // from @llvm-project
+#include "tensorflow/compiler/mlir/tensorflow/ir/tf_ops.h"
+#include "tensorflow/dtensor/cc/tensor_layout.h"
+#include "tensorflow/dtensor/mlir/dtensor_dialect/ir/dtensor_attributes.h"
+#include "tensorflow/dtensor/mlir/dtensor_mlir_passes.h"
+#include "tensorflow/dtensor/mlir/dtensor_mlir_passes_classes.h"
+#include "tensorflow/dtensor/mlir/ir/tf_dtensor.h"
+
+namespace tensorflow {
+namespace dtensor {
+namespace {
+
+constexpr char kInputLayoutAttr[] = "input_layout";
+
+// Returns the number of bytes of `value`, or -1 if its shape is not static.
+int64_t NumBytes(mlir::Value value) {
+  auto type = value.getType().dyn_cast<mlir::RankedTensorType>();
+  if (!type || !type.hasStaticShape() || !type.getElementType().isIntOrFloat())
+    return -1;
+  return type.getNumElements() * ((type.getElementTypeBitWidth() + 7) / 8);
+}
+
+// Makes `op`, a DTensorAllGather or DTensorAllScatter, read `input` instead of
+// its current operand. `input_layout` is the layout of `input`.
+void SetInput(mlir::Operation* op, mlir::Value input,
+              const Layout& input_layout) {
+  op->setOperand(0, input);
+  op->setAttr(kInputLayoutAttr,
+              mlir::dtensor::LayoutAttr::get(op->getContext(), input_layout));
+}
+
+// Relayouts are emitted independently for each op during SPMD expansion, so
+// the relayout of an op's output and the relayout of its consumer's input
+// often end up next to each other. The following are simplified, per
+// producer/consumer pair:
+//
+//  * AllGather(AllGather(x)) and AllScatter(AllScatter(x)) become a single
+//    AllGather (resp. AllScatter) from the layout of `x` when the inner op
+//    has no other user, so gathers along several mesh dimensions become one
+//    collective.
+//  * AllScatter(AllGather(x)) and AllGather(AllScatter(x)) are replaced by
+//    `x` when the final layout is the layout of `x`.
+//
+// Producers that are left without users are removed.
+void SimplifyRelayouts(mlir::func::FuncOp function, int* num_merged,
+                       int* num_round_trips) {
+  std::vector<mlir::Operation*> candidates;
+  function.walk([&](mlir::Operation* op) {
+    if (mlir::isa<mlir::TF::DTensorAllGatherOp, mlir::TF::DTensorAllScatterOp>(
+            op))
+      candidates.push_back(op);
+  });
+
+  // Ops are visited in program order, so the producer of each candidate is
+  // already simplified when the candidate is visited, and chains of more than
+  // two relayouts collapse.
+  std::vector<mlir::Operation*> maybe_dead;
+  for (mlir::Operation* op : candidates) {
+    mlir::Operation* producer = op->getOperand(0).getDefiningOp();
+    if (producer == nullptr) continue;
+
+    if (auto all_gather = mlir::dyn_cast<mlir::TF::DTensorAllGatherOp>(op)) {
+      auto producer_gather =
+          mlir::dyn_cast<mlir::TF::DTensorAllGatherOp>(producer);
+      if (producer_gather && producer->hasOneUse()) {
+        SetInput(op, producer_gather.input(), producer_gather.input_layout());
+        maybe_dead.push_back(producer);
+        ++*num_merged;
+      } else if (auto producer_scatter =
+                     mlir::dyn_cast<mlir::TF::DTensorAllScatterOp>(producer)) {
+        if (all_gather.output_layout() != producer_scatter.input_layout())
+          continue;
+        all_gather.output().replaceAllUsesWith(producer_scatter.input());
+        maybe_dead.push_back(producer);
+        maybe_dead.push_back(op);
+        ++*num_round_trips;
+      }
+    } else {
+      auto all_scatter = mlir::cast<mlir::TF::DTensorAllScatterOp>(op);
+      auto producer_scatter =
+          mlir::dyn_cast<mlir::TF::DTensorAllScatterOp>(producer);
+      if (producer_scatter && producer->hasOneUse()) {
+        SetInput(op, producer_scatter.input(), producer_scatter.input_layout());
+        maybe_dead.push_back(producer);
+        ++*num_merged;
+      } else if (auto producer_gather =
+                     mlir::dyn_cast<mlir::TF::DTensorAllGatherOp>(producer)) {
+        if (all_scatter.output_layout() != producer_gather.input_layout())
+          continue;
+        all_scatter.output().replaceAllUsesWith(producer_gather.input());
+        maybe_dead.push_back(producer);
+        maybe_dead.push_back(op);
+        ++*num_round_trips;
+      }
+    }
+  }
+
+  // Producers come before their users in `maybe_dead`, so erase in reverse.
+  // An op may have been added more than once.
+  llvm::SmallPtrSet<mlir::Operation*, 16> erased;
+  for (auto it = maybe_dead.rbegin(); it != maybe_dead.rend(); ++it) {
+    mlir::Operation* op = *it;
+    if (erased.contains(op) || !op->use_empty()) continue;
+    erased.insert(op);
+    op->erase();
+  }
+}
+
+// Logs the number of collectives left in `function` and the number of bytes
+// each device sends or receives per step, as far as shapes are static.
+void ReportCommunication(mlir::func::FuncOp function) {
+  int num_collectives = 0;
+  int64_t num_bytes = 0;
+  bool all_static = true;
+  auto count = [&](mlir::Value communicated) {
+    ++num_collectives;
+    const int64_t bytes = NumBytes(communicated);
+    if (bytes < 0) {
+      all_static = false;
+    } else {
+      num_bytes += bytes;
+    }
+  };
+  function.walk([&](mlir::Operation* op) {
+    if (auto all_gather = mlir::dyn_cast<mlir::TF::DTensorAllGatherOp>(op)) {
+      count(all_gather.output());
+    } else if (auto all_reduce =
+                   mlir::dyn_cast<mlir::TF::DTensorAllReduceOp>(op)) {
+      count(all_reduce.input());
+    } else if (auto reduce_scatter =
+                   mlir::dyn_cast<mlir::TF::DTensorReduceScatterOp>(op)) {
+      count(reduce_scatter.input());
+    }
+  });
+  VLOG(1) << "Function " << function.getName().str() << " has "
+          << num_collectives << " collectives communicating "
+          << (all_static ? "" : "at least ") << num_bytes
+          << " bytes per device and step.";
+}
+
+// MLIR pass that merges consecutive relayouts and removes relayout round
+// trips.
+struct DTensorRelayoutOptimization
+    : public DTensorRelayoutOptimizationBase<DTensorRelayoutOptimization> {
+  void runOnOperation() override {
+    mlir::func::FuncOp function = getOperation();
+    int num_merged = 0;
+    int num_round_trips = 0;
+    SimplifyRelayouts(function, &num_merged, &num_round_trips);
+    VLOG(2) << "Merged " << num_merged << " relayouts and removed "
+            << num_round_trips << " relayout round trips in "
+            << function.getName().str();
+    if (VLOG_IS_ON(1)) ReportCommunication(function);
+  }
+};
+
+}  // namespace
+
+std::unique_ptr<mlir::OperationPass<mlir::func::FuncOp>>
+CreateDTensorRelayoutOptimization() {
+  return std::make_unique<DTensorRelayoutOptimization>();
+}
+
+}  // namespace dtensor
+}  // namespace tensorflow
@@ -59,6 +59,15 @@ std::intptr_t ArenaPlanner::BasePointer(TfLiteAllocationType type) {
 TfLiteStatus ArenaPlanner::ResetAllocations() {
   TF_LITE_ENSURE_STATUS(arena_.ClearPlan());
   TF_LITE_ENSURE_STATUS(persistent_arena_.ClearPlan());
+  // Keep the allocations made since the last reset, if any, as a starting
+  // point for the next ExecuteAllocations() calls.
+  if (std::any_of(allocs_.begin(), allocs_.end(),
+                  [](const ArenaAllocWithUsageInterval& alloc) {
+                    return alloc.tensor != -1;
+                  })) {
+    previous_allocs_.swap(allocs_);
+  }
+  reusing_previous_allocs_ = !previous_allocs_.empty();
   allocs_.clear();
   allocs_.resize(graph_info_->num_tensors());
   return kTfLiteOk;
@@ -80,8 +89,11 @@ TfLiteStatus ArenaPlanner::ResetAllocationsAfter(int node) {
 }
 
 TfLiteStatus ArenaPlanner::PlanAllocations() {
-  // Invalidate any existing data.
+  // Invalidate any existing data. The graph may have changed, so previous
+  // allocations cannot be reused either.
   TF_LITE_ENSURE_STATUS(ResetAllocations());
+  previous_allocs_.clear();
+  reusing_previous_allocs_ = false;
   // Maybe other verb instead of 'Assigned'
   alloc_node_.assign(graph_info_->num_tensors(), kNodeNotAssigned);
   dealloc_node_.assign(graph_info_->num_tensors(), kNodeNotAssigned);
@@ -106,7 +118,9 @@ TfLiteStatus ArenaPlanner::PlanAllocations() {
       return kTfLiteOk;
     }
     TF_LITE_ENSURE(context_, dealloc_node_[tensor] == kNodeNotAssigned);
-    dealloc_node_[tensor] = node;
+    // Nodes that may run concurrently with `node` must not see the tensor's
+    // memory reused, so keep it alive until the last of them.
+    dealloc_node_[tensor] = graph_info_->last_concurrent_node(node);
     return kTfLiteOk;
   };
 
@@ -200,7 +214,7 @@ TfLiteStatus ArenaPlanner::ExecuteAllocations(int first_node, int last_node) {
       int tensor_index = node_temporaries->data[j];
       alloc_node_[tensor_index] = i;
       if (!preserve_all_tensors_) {
-        dealloc_node_[tensor_index] = i;
+        dealloc_node_[tensor_index] = graph_info_->last_concurrent_node(i);
       }
     }
   }
@@ -312,6 +326,29 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(int first_node, int last_node) {
     }
   }
 
+  if (reusing_previous_allocs_ && CanReusePreviousAllocations(tensor_order)) {
+    for (const auto& tensor_index : tensor_order) {
+      TfLiteTensor& tensor = *graph_info_->tensor(tensor_index);
+      if (tensor.allocation_type == kTfLiteArenaRw) {
+        allocs_[tensor_index] = previous_allocs_[tensor_index];
+        // Zero-sized tensors are left unallocated, as in a fresh plan.
+        if (tensor.bytes == 0) {
+          allocs_[tensor_index].size = 0;
+        }
+        TF_LITE_ENSURE_STATUS(
+            arena_.AllocateAt(context_, allocs_[tensor_index]));
+      }
+      if (tensor.allocation_type == kTfLiteArenaRwPersistent &&
+          allocs_[tensor_index].size == 0) {
+        allocs_[tensor_index] = previous_allocs_[tensor_index];
+        TF_LITE_ENSURE_STATUS(
+            persistent_arena_.AllocateAt(context_, allocs_[tensor_index]));
+      }
+    }
+    return kTfLiteOk;
+  }
+  reusing_previous_allocs_ = false;
+
   // Vector of ids of already allocated tensors, ordered by offset.
   for (const auto& tensor_index : tensor_order) {
     TfLiteTensor& tensor = *graph_info_->tensor(tensor_index);
@@ -334,6 +371,33 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(int first_node, int last_node) {
   return kTfLiteOk;
 }
 
+bool ArenaPlanner::CanReusePreviousAllocations(
+    const std::vector<int32_t>& tensor_order) {
+  for (const auto& tensor_index : tensor_order) {
+    const TfLiteTensor& tensor = *graph_info_->tensor(tensor_index);
+    int32_t last_node;
+    if (tensor.allocation_type == kTfLiteArenaRw) {
+      last_node = dealloc_node_[tensor_index];
+    } else if (tensor.allocation_type == kTfLiteArenaRwPersistent &&
+               allocs_[tensor_index].size == 0) {
+      last_node = std::numeric_limits<int32_t>::max();
+    } else {
+      continue;
+    }
+    if (tensor_index >= static_cast<int32_t>(previous_allocs_.size())) {
+      return false;
+    }
+    const ArenaAllocWithUsageInterval& previous =
+        previous_allocs_[tensor_index];
+    if (previous.tensor != tensor_index ||
+        previous.first_node != alloc_node_[tensor_index] ||
+        previous.last_node != last_node || previous.size < tensor.bytes) {
+      return false;
+    }
+  }
+  return true;
+}
+
 TfLiteStatus ArenaPlanner::ResolveTensorAllocation(int tensor_index) {
   TfLiteTensor& tensor = *graph_info_->tensor(tensor_index);
   if (tensor.allocation_type == kTfLiteArenaRw) {
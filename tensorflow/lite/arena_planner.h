@@ -43,6 +43,11 @@ struct AllocationInfo;
 // execution. Since dynamic tensors don't have sizes until after the
 // corresponding operation is executed, this class supports incremental
 // planning.
+//
+// When allocations are reset without the graph changing, e.g. because an input
+// was resized, the offsets from the previous execution are reused for as long
+// as every tensor still fits in the space it was given, which turns resizing
+// to a smaller or equal size into a cheap operation.
 class ArenaPlanner : public MemoryPlanner {
  public:
   // Ownership of 'context' is not taken and it must remain util the
@@ -86,6 +91,11 @@ class ArenaPlanner : public MemoryPlanner {
   // for all tensors affected by ops in the interval [first_node, last_node].
   TfLiteStatus CalculateAllocations(int first_node, int last_node);
 
+  // Returns true if all the tensors in `tensor_order` that need to be
+  // allocated fit into their allocation from `previous_allocs_`, with the same
+  // usage interval.
+  bool CanReusePreviousAllocations(const std::vector<int32_t>& tensor_order);
+
   // Assign absolute memory location to a tensor, based on its relative
   // position inside the corresponding arena buffer.
   TfLiteStatus ResolveTensorAllocation(int tensor_index);
@@ -104,6 +114,13 @@ class ArenaPlanner : public MemoryPlanner {
   // Stores allocation data for all tensors.
   std::vector<ArenaAllocWithUsageInterval> allocs_;
 
+  // Allocation data as of the last ResetAllocations() call, and whether all
+  // allocations made since then were taken from it. Offsets can only be
+  // reused while the latter holds, as otherwise they may overlap with newly
+  // planned tensors.
+  std::vector<ArenaAllocWithUsageInterval> previous_allocs_;
+  bool reusing_previous_allocs_ = false;
+
   // First node, that uses the tensor. It needs to be allocated before
   // execution of the node's operation.
   std::vector<int32_t> alloc_node_;
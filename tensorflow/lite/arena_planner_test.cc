@@ -160,6 +160,23 @@ class TestGraphInfo : public GraphInfo {
   TestGraph* graph_;
 };
 
+// A TestGraphInfo whose nodes run in groups that may execute concurrently.
+// `last_concurrent_node[i]` is the last node of the group containing `i`.
+class ConcurrentTestGraphInfo : public TestGraphInfo {
+ public:
+  ConcurrentTestGraphInfo(TestGraph* graph,
+                          std::vector<size_t> last_concurrent_node)
+      : TestGraphInfo(graph),
+        last_concurrent_node_(std::move(last_concurrent_node)) {}
+
+  size_t last_concurrent_node(size_t index) const override {
+    return last_concurrent_node_[index];
+  }
+
+ private:
+  std::vector<size_t> last_concurrent_node_;
+};
+
 void ReportError(TfLiteContext* context, const char* format, ...) {
   const size_t kBufferSize = 1024;
   char temp_buffer[kBufferSize];
@@ -184,6 +201,19 @@ class ArenaPlannerTest : public ::testing::Test {
     CHECK(planner_->PlanAllocations() == kTfLiteOk);
   }
 
+  void SetConcurrentGraph(TestGraph* graph,
+                          std::vector<size_t> last_concurrent_node) {
+    graph_ = graph;
+    context_.ReportError = ReportError;
+    planner_.reset(new ArenaPlanner(
+        &context_,
+        std::unique_ptr<GraphInfo>(new ConcurrentTestGraphInfo(
+            graph, std::move(last_concurrent_node))),
+        /*preserve_all_tensors=*/false, kTensorAlignment));
+    CHECK(planner_->ResetAllocations() == kTfLiteOk);
+    CHECK(planner_->PlanAllocations() == kTfLiteOk);
+  }
+
   void SwapGraph(TestGraph* graph) {
     graph_->Swap(graph);
     CHECK(planner_->PlanAllocations() == kTfLiteOk);
@@ -292,6 +322,39 @@ TEST_F(ArenaPlannerTest, SimpleGraph) {
   EXPECT_EQ(GetOffset(1), 4);
 }
 
+TEST_F(ArenaPlannerTest, ConcurrentNodesDoNotShareMemory) {
+  // The second and third op may run at the same time, so tensor 1 (last read
+  // by the second op) must stay alive while the third op writes tensors 3 and
+  // 4. Run sequentially, the temporary 4 simply takes over tensor 1's memory.
+  auto make_graph = [] {
+    return TestGraph({0},
+                     {
+                         /* in, out, tmp */
+                         {{0}, {1}, {}},     // First op
+                         {{1}, {2}, {}},     // Second op
+                         {{0}, {3}, {4}},    // Third op
+                         {{2, 3}, {5}, {}},  // Fourth op
+                     },
+                     {5});
+  };
+  auto overlap = [this](int t1, int t2) {
+    return GetOffset(t1) < GetOffsetAfter(t2) &&
+           GetOffset(t2) < GetOffsetAfter(t1);
+  };
+
+  TestGraph sequential_graph = make_graph();
+  SetGraph(&sequential_graph);
+  Execute(0, 10);
+  EXPECT_TRUE(overlap(1, 4));
+
+  TestGraph concurrent_graph = make_graph();
+  SetConcurrentGraph(&concurrent_graph, {0, 2, 2, 3});
+  Execute(0, 10);
+  EXPECT_FALSE(overlap(1, 3));
+  EXPECT_FALSE(overlap(1, 4));
+  EXPECT_FALSE(overlap(2, 4));
+}
+
 TEST_F(ArenaPlannerTest, SimpleGraphInputsPreserved) {
   TestGraph graph({0, 1},
                   {
@@ -651,6 +714,42 @@ TEST_F(ArenaPlannerTest, ModifiedGraph_DeallocateNonPersistentArena) {
   EXPECT_EQ(GetOffset(3), GetOffsetAfter(1));
 }
 
+TEST_F(ArenaPlannerTest, ResizeReusesPreviousOffsets) {
+  TestGraph graph({0, 1},
+                  {
+                      /* in, out, tmp */
+                      {{0, 1}, {2}, {}},     // First op
+                      {{2, 0}, {4, 5}, {}},  // Second op
+                      {{4, 5}, {3}, {}}      // Third op
+                  },
+                  {3});
+  SetGraph(&graph);
+  Execute(0, 10);
+  std::vector<std::ptrdiff_t> offsets;
+  for (int i = 0; i <= 5; ++i) {
+    offsets.push_back(GetOffset(i));
+  }
+
+  // Shrinking tensors keeps them where they were, rather than packing them
+  // anew.
+  (*graph.tensors())[0].bytes = 1;
+  (*graph.tensors())[5].bytes = 4;
+  CHECK(planner_->ResetAllocations() == kTfLiteOk);
+  Execute(0, 10);
+  for (int i = 0; i <= 5; ++i) {
+    EXPECT_EQ(GetOffset(i), offsets[i]) << "tensor " << i;
+  }
+
+  // Growing a tensor beyond its previous size needs a new plan.
+  (*graph.tensors())[4].bytes = 100;
+  CHECK(planner_->ResetAllocations() == kTfLiteOk);
+  Execute(0, 10);
+  EXPECT_EQ(GetOffset(0), 0);
+  EXPECT_EQ(GetOffset(1), 4);
+  EXPECT_EQ(GetOffset(4), GetOffsetAfter(1));
+  EXPECT_EQ(GetOffset(3), GetOffsetAfter(4));
+}
+
 TEST_F(ArenaPlannerTest, ComplexGraph) {
   TestGraph graph({0},
                   {
@@ -24,6 +24,7 @@ limitations under the License.
 #include <cstring>
 #include <iterator>
 #include <memory>
+#include <numeric>
 #include <string>
 #include <utility>
 #include <vector>
@@ -38,7 +39,9 @@ limitations under the License.
 #include "tensorflow/lite/core/api/tensor_utils.h"
 #include "tensorflow/lite/core/macros.h"
 #include "tensorflow/lite/experimental/resource/resource_base.h"
+#include "tensorflow/lite/external_cpu_backend_context.h"
 #include "tensorflow/lite/graph_info.h"
+#include "tensorflow/lite/inter_op_thread_pool.h"
 #include "tensorflow/lite/memory_planner.h"
 #include "tensorflow/lite/minimal_logging.h"
 #include "tensorflow/lite/schema/schema_generated.h"
@@ -220,11 +223,22 @@ class InterpreterInfo : public GraphInfo {
   const std::vector<int>& variables() const override {
     return subgraph_->variables();
   }
+  size_t last_concurrent_node(size_t index) const override {
+    const std::vector<size_t>& last = subgraph_->last_concurrent_node_;
+    return index < last.size() ? last[index] : index;
+  }
 
  public:
   Subgraph* subgraph_;
 };
 
+struct Subgraph::InterOpWorker {
+  // Copy of the subgraph's context that only differs in the external contexts
+  // it hands out and in running kernels single-threaded.
+  TfLiteContext context;
+  ExternalCpuBackendContext cpu_backend_context;
+};
+
 Subgraph::Subgraph(ErrorReporter* error_reporter,
                    TfLiteExternalContext** external_contexts,
                    std::vector<std::unique_ptr<Subgraph>>* subgraphs,
@@ -749,6 +763,9 @@ TfLiteStatus Subgraph::AllocateTensors() {
   next_execution_plan_index_to_prepare_ = 0;
   next_execution_plan_index_to_plan_allocation_ = 0;
   next_original_execution_plan_index_to_prepare_ = 0;
+  if (inter_op_thread_pool_) {
+    TF_LITE_ENSURE_STATUS(ScheduleConcurrentNodes());
+  }
   if (memory_planner_) {
     TF_LITE_ENSURE_STATUS(memory_planner_->ResetAllocations());
   }
@@ -1067,9 +1084,12 @@ TfLiteStatus Subgraph::PrepareOpsAndTensors() {
   next_execution_plan_index_to_prepare_ = last_exec_plan_index_prepared + 1;
 
   // Execute arena allocations.
-  TF_LITE_ENSURE_STATUS(memory_planner_->ExecuteAllocations(
-      next_execution_plan_index_to_plan_allocation_,
-      last_exec_plan_index_prepared));
+  {
+    TFLITE_SCOPED_TAGGED_DEFAULT_PROFILE(profiler_.get(), "ExecuteAllocations");
+    TF_LITE_ENSURE_STATUS(memory_planner_->ExecuteAllocations(
+        next_execution_plan_index_to_plan_allocation_,
+        last_exec_plan_index_prepared));
+  }
 
   if (!custom_allocations_.empty()) {
     // Verify custom allocations for output tensors from the ops that have just
@@ -1156,6 +1176,8 @@ TfLiteStatus Subgraph::Invoke() {
   }
   TFLITE_SCOPED_TAGGED_DEFAULT_PROFILE(profiler_.get(), "Invoke");
 
+  if (CanInvokeConcurrently()) return InvokeConcurrently();
+
   // Invocations are always done in node order.
   // Note that calling Invoke repeatedly will cause the original memory plan to
   // be reused, unless either ResizeInputTensor() or AllocateTensors() has been
@@ -1176,37 +1198,7 @@ TfLiteStatus Subgraph::Invoke() {
     if (profiler_) op_name = GetTFLiteOpName(registration);
     TFLITE_SCOPED_TAGGED_OPERATOR_PROFILE(profiler_.get(), op_name, node_index);
 
-    for (int i = 0; i < node.inputs->size; ++i) {
-      int tensor_index = node.inputs->data[i];
-      if (tensor_index == kTfLiteOptionalTensor) {
-        continue;
-      }
-      TfLiteTensor* tensor = &tensors_[tensor_index];
-      if (tensor->delegate && tensor->delegate != node.delegate &&
-          tensor->data_is_stale) {
-        TF_LITE_ENSURE_STATUS(EnsureTensorDataIsReadable(tensor_index));
-      }
-      if (tensor->data.raw == nullptr && tensor->bytes > 0) {
-        if (registration.builtin_code == kTfLiteBuiltinReshape && i == 1 &&
-            tensor->dims->size != 1) {
-          // In general, having a tensor here with no buffer will be an error.
-          // However, for the reshape operator, the second input tensor is
-          // sometimes only used for the shape, not for the data. Thus, null
-          // buffer is ok in this situation.
-          // The situation where null buffer is not ok for reshape operator is
-          // only when there are 2 inputs given to the node and the one
-          // corresponding to the shape (i == 1) is a vector that contains all
-          // dimensions. See `GetOutputShape()` function in
-          // `tensorflow/lite/kernels/reshape.cc`
-          continue;
-        } else {
-          // In all other cases, we need to return an error as otherwise we will
-          // trigger a null pointer dereference (likely).
-          ReportError("Input tensor %d lacks data", tensor_index);
-          return kTfLiteError;
-        }
-      }
-    }
+    TF_LITE_ENSURE_STATUS(EnsureNodeInputsAreReadable(node, registration));
 
     if (check_cancelled_func_ != nullptr &&
         check_cancelled_func_(cancellation_data_)) {
@@ -1247,6 +1239,197 @@ TfLiteStatus Subgraph::Invoke() {
   return status;
 }
 
+TfLiteStatus Subgraph::EnsureNodeInputsAreReadable(
+    const TfLiteNode& node, const TfLiteRegistration& registration) {
+  for (int i = 0; i < node.inputs->size; ++i) {
+    int tensor_index = node.inputs->data[i];
+    if (tensor_index == kTfLiteOptionalTensor) {
+      continue;
+    }
+    TfLiteTensor* tensor = &tensors_[tensor_index];
+    if (tensor->delegate && tensor->delegate != node.delegate &&
+        tensor->data_is_stale) {
+      TF_LITE_ENSURE_STATUS(EnsureTensorDataIsReadable(tensor_index));
+    }
+    if (tensor->data.raw == nullptr && tensor->bytes > 0) {
+      if (registration.builtin_code == kTfLiteBuiltinReshape && i == 1 &&
+          tensor->dims->size != 1) {
+        // In general, having a tensor here with no buffer will be an error.
+        // However, for the reshape operator, the second input tensor is
+        // sometimes only used for the shape, not for the data. Thus, null
+        // buffer is ok in this situation.
+        // The situation where null buffer is not ok for reshape operator is
+        // only when there are 2 inputs given to the node and the one
+        // corresponding to the shape (i == 1) is a vector that contains all
+        // dimensions. See `GetOutputShape()` function in
+        // `tensorflow/lite/kernels/reshape.cc`
+        continue;
+      } else {
+        // In all other cases, we need to return an error as otherwise we will
+        // trigger a null pointer dereference (likely).
+        ReportError("Input tensor %d lacks data", tensor_index);
+        return kTfLiteError;
+      }
+    }
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus Subgraph::ScheduleConcurrentNodes() {
+  // Nodes that must not run alongside any other node: delegate kernels may
+  // share state across partitions, control flow ops invoke other subgraphs,
+  // resource ops and variables are stateful, and custom ops are opaque.
+  auto is_barrier = [this](size_t execution_plan_index) {
+    const auto& node_and_reg =
+        nodes_and_registration_[execution_plan_[execution_plan_index]];
+    const TfLiteNode& node = node_and_reg.first;
+    if (node.delegate != nullptr || node.might_have_side_effect) return true;
+    switch (node_and_reg.second.builtin_code) {
+      case kTfLiteBuiltinCustom:
+      case kTfLiteBuiltinWhile:
+      case kTfLiteBuiltinIf:
+      case kTfLiteBuiltinCallOnce:
+      case kTfLiteBuiltinVarHandle:
+      case kTfLiteBuiltinReadVariable:
+      case kTfLiteBuiltinAssignVariable:
+      case kTfLiteBuiltinHashtable:
+      case kTfLiteBuiltinHashtableFind:
+      case kTfLiteBuiltinHashtableImport:
+      case kTfLiteBuiltinHashtableSize:
+        return true;
+      default:
+        break;
+    }
+    for (const TfLiteIntArray* tensors : {node.inputs, node.outputs}) {
+      for (int tensor_index : TfLiteIntArrayView(tensors)) {
+        if (tensor_index != kTfLiteOptionalTensor &&
+            tensors_[tensor_index].is_variable) {
+          return true;
+        }
+      }
+    }
+    return false;
+  };
+  const std::vector<int> levels =
+      ComputeConcurrentNodeLevels(CreateGraphInfo().get(), is_barrier);
+
+  // Reorder the plan level by level. Levels respect all dependencies, so any
+  // order within a level is valid; keeping the original one is deterministic.
+  std::vector<int> order(execution_plan_.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&levels](int a, int b) { return levels[a] < levels[b]; });
+  std::vector<int> plan;
+  std::vector<int> level_ends;
+  std::vector<size_t> last_concurrent_node(order.size());
+  plan.reserve(order.size());
+  for (size_t i = 0; i < order.size(); ++i) {
+    plan.push_back(execution_plan_[order[i]]);
+    if (i + 1 == order.size() || levels[order[i]] != levels[order[i + 1]]) {
+      const size_t level_begin = level_ends.empty() ? 0 : level_ends.back();
+      std::fill(last_concurrent_node.begin() + level_begin,
+                last_concurrent_node.begin() + i + 1, i);
+      level_ends.push_back(i + 1);
+    }
+  }
+
+  const bool schedule_changed = plan != execution_plan_ ||
+                                last_concurrent_node != last_concurrent_node_;
+  execution_plan_ = plan;
+  concurrent_execution_plan_ = std::move(plan);
+  concurrent_level_ends_ = std::move(level_ends);
+  last_concurrent_node_ = std::move(last_concurrent_node);
+  if (schedule_changed && memory_planner_) {
+    TF_LITE_ENSURE_STATUS(memory_planner_->PlanAllocations());
+  }
+  return kTfLiteOk;
+}
+
+bool Subgraph::CanInvokeConcurrently() const {
+  // The level schedule assumes a fully prepared graph with a static memory
+  // plan, and profilers are not safe to use from several threads.
+  return inter_op_thread_pool_ != nullptr &&
+         concurrent_level_ends_.size() < execution_plan_.size() &&
+         concurrent_execution_plan_ == execution_plan_ &&
+         next_execution_plan_index_to_prepare_ ==
+             static_cast<int>(execution_plan_.size()) &&
+         !has_dynamic_tensors_ && profiler_ == nullptr;
+}
+
+TfLiteStatus Subgraph::InvokeConcurrently() {
+  for (auto& worker : inter_op_workers_) {
+    worker->context = context_;
+    worker->context.recommended_num_threads = 1;
+    worker->context.GetExternalContext = GetInterOpWorkerExternalContext;
+  }
+  std::vector<TfLiteStatus> statuses;
+
+  int level_begin = 0;
+  for (const int level_end : concurrent_level_ends_) {
+    for (int i = level_begin; i < level_end; ++i) {
+      const auto& node_and_reg = nodes_and_registration_[execution_plan_[i]];
+      TF_LITE_ENSURE_STATUS(
+          EnsureNodeInputsAreReadable(node_and_reg.first, node_and_reg.second));
+    }
+
+    if (check_cancelled_func_ != nullptr &&
+        check_cancelled_func_(cancellation_data_)) {
+      ReportError("Client requested cancel during Invoke()");
+      return kTfLiteError;
+    }
+
+    EnsureTensorsVectorCapacity();
+    tensor_resized_since_op_invoke_ = false;
+    const int num_nodes = level_end - level_begin;
+    statuses.assign(num_nodes, kTfLiteOk);
+    if (num_nodes == 1) {
+      auto& node_and_reg =
+          nodes_and_registration_[execution_plan_[level_begin]];
+      statuses[0] = OpInvoke(node_and_reg.second, &node_and_reg.first);
+    } else {
+      for (auto& worker : inter_op_workers_) {
+        worker->context.tensors = context_.tensors;
+        worker->context.tensors_size = context_.tensors_size;
+      }
+      inter_op_thread_pool_->ParallelFor(
+          num_nodes, [this, level_begin, &statuses](int worker, int i) {
+            TfLiteContext* context = &context_;
+            if (worker > 0) context = &inter_op_workers_[worker - 1]->context;
+            auto& node_and_reg =
+                nodes_and_registration_[execution_plan_[level_begin + i]];
+            statuses[i] =
+                OpInvoke(context, node_and_reg.second, &node_and_reg.first);
+          });
+    }
+
+    for (int i = level_begin; i < level_end; ++i) {
+      const int node_index = execution_plan_[i];
+      const auto& node_and_reg = nodes_and_registration_[node_index];
+      if (statuses[i - level_begin] != kTfLiteOk) {
+        return ReportOpError(&context_, node_and_reg.first,
+                             node_and_reg.second, node_index,
+                             "failed to invoke");
+      }
+      // Release dynamic tensor memory if configured by the user.
+      MaybeReleaseDynamicInputs(node_and_reg.first, node_index);
+    }
+    level_begin = level_end;
+  }
+
+  return kTfLiteOk;
+}
+
+TfLiteExternalContext* Subgraph::GetInterOpWorkerExternalContext(
+    struct TfLiteContext* context, TfLiteExternalContextType type) {
+  auto* subgraph = static_cast<Subgraph*>(context->impl_);
+  if (type == kTfLiteCpuBackendContext) {
+    for (auto& worker : subgraph->inter_op_workers_) {
+      if (&worker->context == context) return &worker->cpu_backend_context;
+    }
+  }
+  return subgraph->GetExternalContext(type);
+}
+
 TfLiteStatus Subgraph::ResizeTensor(TfLiteContext* context,
                                     TfLiteTensor* tensor,
                                     TfLiteIntArray* new_size) {
@@ -1517,6 +1700,21 @@ void Subgraph::UseDynamicAllocationForLargeTensors(
   }
 }
 
+void Subgraph::SetInterOpParallelism(int num_threads) {
+  inter_op_parallelism_ = std::max(num_threads, 1);
+  inter_op_thread_pool_.reset();
+  inter_op_workers_.clear();
+  concurrent_execution_plan_.clear();
+  concurrent_level_ends_.clear();
+  last_concurrent_node_.clear();
+  if (inter_op_parallelism_ > 1) {
+    inter_op_thread_pool_.reset(new InterOpThreadPool(inter_op_parallelism_));
+    for (int i = 1; i < inter_op_parallelism_; ++i) {
+      inter_op_workers_.emplace_back(new InterOpWorker);
+    }
+  }
+}
+
 void Subgraph::SwitchToDelegateContext() {
   context_.GetNodeAndRegistration = GetNodeAndRegistration;
   context_.ReplaceNodeSubsetsWithDelegateKernels =
@@ -40,6 +40,8 @@ limitations under the License.
 namespace tflite {
 
 class SingleOpModel;  // Class for friend declarations.
+class InterpreterInfo;  // Class for friend declarations.
+class InterOpThreadPool;
 
 namespace delegates {
 namespace test_utils {
@@ -387,6 +389,18 @@ class Subgraph {
   void UseDynamicAllocationForLargeTensors(
       int large_tensors_threshods_in_bytes);
 
+  /// WARNING: This is an experimental API and subject to change.
+  /// Run nodes that do not depend on each other concurrently, using up to
+  /// `num_threads` threads (including the one calling `Invoke`). Nodes are
+  /// grouped into levels of mutually independent nodes and the execution plan
+  /// is reordered level by level; the memory plan keeps the tensors of a level
+  /// apart. Delegate kernels, control flow, resource and custom ops, and nodes
+  /// touching variable tensors are never run concurrently with other nodes.
+  /// Invocations fall back to sequential execution while the graph has
+  /// dynamic tensors or a profiler is installed. A value <= 1 disables
+  /// concurrent execution. This API must be called before `AllocateTensors`.
+  void SetInterOpParallelism(int num_threads);
+
   // WARNING: This is an experimental API and subject to change.
   // Remove unused inputs of the subgraph. It checks usage of inputs and mark it
   // as kTfLiteOptionalTensor if the input is not used in graph execution.
@@ -395,7 +409,11 @@ class Subgraph {
 
  private:
   friend class InterpreterBuilder;
+  friend class InterpreterInfo;
   friend class TestDelegate;
+
+  // Per-thread state used to run nodes concurrently. Defined in subgraph.cc.
+  struct InterOpWorker;
   // SubgraphAwareProfiler wraps an actual TFLite profiler, such as a
   // BufferedProfiler instance, and takes care of event profiling/tracing in a
   // certain subgraph.
@@ -477,10 +495,40 @@ class Subgraph {
 
   // Invoke the operator represented by 'node'.
   TfLiteStatus OpInvoke(const TfLiteRegistration& op_reg, TfLiteNode* node) {
+    return OpInvoke(&context_, op_reg, node);
+  }
+
+  // Invoke the operator represented by 'node' with the given context, which is
+  // either `context_` or the context of an inter-op worker.
+  static TfLiteStatus OpInvoke(TfLiteContext* context,
+                               const TfLiteRegistration& op_reg,
+                               TfLiteNode* node) {
     if (op_reg.invoke == nullptr) return kTfLiteError;
-    return op_reg.invoke(&context_, node);
+    return op_reg.invoke(context, node);
   }
 
+  // Make sure the inputs of 'node' can be read by its kernel: copy stale
+  // delegate data back to the CPU and check that all inputs have a buffer.
+  TfLiteStatus EnsureNodeInputsAreReadable(
+      const TfLiteNode& node, const TfLiteRegistration& registration);
+
+  // Group the execution plan into levels of independent nodes and reorder it
+  // level by level (see `SetInterOpParallelism`). Replans the memory if the
+  // schedule changed.
+  TfLiteStatus ScheduleConcurrentNodes();
+
+  // Returns true if the current state allows `InvokeConcurrently`.
+  bool CanInvokeConcurrently() const;
+
+  // Invoke the execution plan level by level, running the nodes of a level on
+  // the inter-op thread pool.
+  TfLiteStatus InvokeConcurrently();
+
+  // GetExternalContext implementation for inter-op worker contexts. Gives
+  // each worker its own single-threaded CPU backend context.
+  static TfLiteExternalContext* GetInterOpWorkerExternalContext(
+      struct TfLiteContext* context, TfLiteExternalContextType type);
+
   // Call OpPrepare() for as many ops as possible, allocating memory for their
   // tensors. If an op containing dynamic tensors is found, preparation will be
   // postponed until this function is called again. This allows the interpreter
@@ -878,6 +926,27 @@ class Subgraph {
   // List of tensors which are large and have a static shape. The memory of
   // these tensors should be allocated before the graph execution.
   std::set<int> large_static_shape_tensors_;
+
+  // Maximum number of nodes run at the same time. See `SetInterOpParallelism`.
+  int inter_op_parallelism_ = 1;
+
+  // The execution plan `ScheduleConcurrentNodes` produced. Concurrent
+  // invocation is only valid while `execution_plan_` still matches it.
+  std::vector<int> concurrent_execution_plan_;
+
+  // Exclusive end execution plan index of every level of independent nodes.
+  std::vector<int> concurrent_level_ends_;
+
+  // For every execution plan index, the last index of its level.
+  std::vector<size_t> last_concurrent_node_;
+
+  // Workers 1..n-1 of the inter-op thread pool; worker 0 is the calling thread
+  // and uses `context_`.
+  std::vector<std::unique_ptr<InterOpWorker>> inter_op_workers_;
+
+  // Thread pool running the nodes of a level. Declared last so that its
+  // threads are joined before any state they use is destroyed.
+  std::unique_ptr<InterOpThreadPool> inter_op_thread_pool_;
 };
 
 }  // namespace tflite
@@ -24,6 +24,7 @@ limitations under the License.
 
 #include <cstdint>
 #include <memory>
+#include <string>
 
 #include "absl/types/span.h"
 #include "tensorflow/lite/delegates/gpu/api.h"
@@ -67,6 +68,12 @@ struct InferenceEnvironmentProperties {
 
   // Indicates whether fast CL->GL synchronization is supported.
   bool is_cl_to_gl_fast_sync_supported = false;
+
+  // Identifies the GPU vendor, device, platform and driver of the environment.
+  // Data produced by BuildSerializedModel or GetSerializedBinaryCache is only
+  // valid for environments with the same device_id, which makes it suitable as
+  // part of a persistent cache key.
+  std::string device_id;
 };
 
 // Environment manages all resources that need to stay until any inference is
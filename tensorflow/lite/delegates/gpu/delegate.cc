@@ -369,16 +369,17 @@ class DelegateKernel {
       RETURN_IF_ERROR(cl_environment_->NewInferenceBuilder(
           options, std::move(*graph), builder));
     } else {
+      // The environment is needed either way, and its device id is part of the
+      // serialization key.
+      RETURN_IF_ERROR(cl::NewInferenceEnvironment(env_options, &cl_environment_,
+                                                  &properties));
       // If serialization data is found, initialize CL from it & return early.
       if (MaybeInitializeSerializedOpenCL(context, delegate_params, builder,
-                                          &options, &env_options, &properties,
-                                          serialization)
+                                          &options, properties, serialization)
               .ok()) {
         return absl::OkStatus();
       }
 
-      RETURN_IF_ERROR(cl::NewInferenceEnvironment(env_options, &cl_environment_,
-                                                  &properties));
       *graph_is_destroyed = true;
       std::vector<uint8_t> serialized_model;
       RETURN_IF_ERROR(cl_environment_->BuildSerializedModel(
@@ -387,7 +388,8 @@ class DelegateKernel {
           cl_environment_->NewInferenceBuilder(serialized_model, builder));
 
       RETURN_IF_ERROR(SaveSerializedOpenCL(context, delegate_params, &options,
-                                           serialization, serialized_model));
+                                           properties, serialization,
+                                           serialized_model));
     }
 
     TFLITE_LOG_PROD_ONCE(tflite::TFLITE_LOG_INFO,
@@ -395,20 +397,29 @@ class DelegateKernel {
     return absl::OkStatus();
   }
 
-  // Returns Ok only if serialized data is successsfully found.
+  // Custom key of the serialized OpenCL model. The serialized model holds
+  // compiled program binaries and tuned work group sizes, so it is only valid
+  // for the same inference options and the same device and driver.
+  static std::string SerializedOpenClKey(
+      const cl::InferenceOptions* options,
+      const cl::InferenceEnvironmentProperties& properties) {
+    return std::string(kSerializedDataPrefix) +
+           delegates::StrFingerprint(options, sizeof(cl::InferenceOptions)) +
+           "_" +
+           delegates::StrFingerprint(properties.device_id.data(),
+                                     properties.device_id.size());
+  }
+
+  // Returns Ok only if serialized data is successsfully found and restored
+  // into `cl_environment_`, which must already exist.
   absl::Status MaybeInitializeSerializedOpenCL(
       TfLiteContext* context, const TfLiteDelegateParams* delegate_params,
       std::unique_ptr<InferenceBuilder>* builder, cl::InferenceOptions* options,
-      cl::InferenceEnvironmentOptions* env_options,
-      cl::InferenceEnvironmentProperties* properties,
+      const cl::InferenceEnvironmentProperties& properties,
       Serialization* serialization) {
     if (!serialization) return absl::InvalidArgumentError("No serialization");
-    // We use a fingerprint of the options to ensure compatibility.
-    std::string options_fingerprint =
-        delegates::StrFingerprint(options, sizeof(cl::InferenceOptions));
     auto data_key = serialization->GetEntryForKernel(
-        std::string(kSerializedDataPrefix) + options_fingerprint, context,
-        delegate_params);
+        SerializedOpenClKey(options, properties), context, delegate_params);
 
     std::string model_data;
     auto model_data_status = data_key.GetData(context, &model_data);
@@ -416,8 +427,8 @@ class DelegateKernel {
       absl::Span<const uint8_t> model_span = absl::Span<const uint8_t>{
           reinterpret_cast<const uint8_t*>(model_data.data()),
           model_data.size()};
-      RETURN_IF_ERROR(cl::NewInferenceEnvironment(
-          *env_options, &cl_environment_, properties));
+      // A stale or corrupted entry is not fatal: the caller rebuilds the model
+      // and overwrites the entry.
       RETURN_IF_ERROR(
           cl_environment_->NewInferenceBuilder(model_span, builder));
       TFLITE_LOG_PROD_ONCE(
@@ -432,17 +443,15 @@ class DelegateKernel {
   // Returns Ok only if serialization happens successfully.
   absl::Status SaveSerializedOpenCL(
       TfLiteContext* context, const TfLiteDelegateParams* delegate_params,
-      cl::InferenceOptions* options, Serialization* serialization,
+      cl::InferenceOptions* options,
+      const cl::InferenceEnvironmentProperties& properties,
+      Serialization* serialization,
       const std::vector<uint8_t>& serialized_model) {
     if (!serialization) return absl::InvalidArgumentError("No serialization");
-    // We use a fingerprint of the options to ensure compatibility.
-    std::string options_fingerprint =
-        delegates::StrFingerprint(options, sizeof(cl::InferenceOptions));
 
     // Save data.
     auto data_key = serialization->GetEntryForKernel(
-        std::string(kSerializedDataPrefix) + options_fingerprint, context,
-        delegate_params);
+        SerializedOpenClKey(options, properties), context, delegate_params);
     auto save_status = data_key.SetData(
         context, reinterpret_cast<const char*>(serialized_model.data()),
         serialized_model.size());
@@ -60,6 +60,9 @@ enum TfLiteGpuExperimentalFlags {
   // at the cost of space on disk.
   // Delegate performs serialization the first time it is applied with a new
   // model or inference params. Later initializations are fast.
+  // Serialized entries hold compiled kernels, tuned work group sizes and the
+  // chosen tensor storage, and are keyed by the GPU device and driver as well,
+  // so a driver update transparently triggers re-serialization.
   // ModifyGraphWithDelegate will fail if data cannot be serialized.
   //
   // NOTE: User also needs to set serialization_dir & model_token in
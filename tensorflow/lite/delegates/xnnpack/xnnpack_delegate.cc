@@ -21,6 +21,8 @@ limitations under the License.
 #include <cstring>
 #include <limits>
 #include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <shared_mutex>  // NOLINT(build/c++14)
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -40,7 +42,16 @@ limitations under the License.
 #include "tensorflow/lite/minimal_logging.h"
 #include "tensorflow/lite/tools/optimize/reduced_precision_support.h"
 
-struct TfLiteXNNPackDelegateWeightsCache;
+struct TfLiteXNNPackDelegateWeightsCache {
+  xnn_weights_cache_t cache = nullptr;
+  // Creating a runtime may grow, and thus move, the packed weights of all
+  // runtimes sharing the cache. Runtime creation holds `mutex` exclusively,
+  // invocations hold it shared.
+  std::shared_timed_mutex mutex;
+  // Bumped on every runtime creation, so that runtimes set up earlier know to
+  // set up again. Guarded by `mutex`.
+  uint64_t generation = 0;
+};
 
 namespace tflite {
 namespace xnnpack {
@@ -106,12 +117,8 @@ class Delegate {
 #endif
   }
 
-  xnn_weights_cache_t weights_cache() const {
-    if (options_.weights_cache == nullptr) {
-      return nullptr;
-    } else {
-      return reinterpret_cast<xnn_weights_cache_t>(options_.weights_cache);
-    }
+  TfLiteXNNPackDelegateWeightsCache* weights_cache() const {
+    return options_.weights_cache;
   }
 
  private:
@@ -597,8 +604,18 @@ class Subgraph {
         }
       }
     }
-    status = xnn_create_runtime_v3(subgraph.get(), delegate.weights_cache(),
-                                   delegate.threadpool(), flags, &runtime_ptr);
+    TfLiteXNNPackDelegateWeightsCache* weights_cache = delegate.weights_cache();
+    if (weights_cache == nullptr) {
+      status = xnn_create_runtime_v3(subgraph.get(), /*weights_cache=*/nullptr,
+                                     delegate.threadpool(), flags,
+                                     &runtime_ptr);
+    } else {
+      std::lock_guard<std::shared_timed_mutex> lock(weights_cache->mutex);
+      status = xnn_create_runtime_v3(subgraph.get(), weights_cache->cache,
+                                     delegate.threadpool(), flags,
+                                     &runtime_ptr);
+      ++weights_cache->generation;
+    }
     if (status != xnn_status_success) {
       TF_LITE_KERNEL_LOG(context, "failed to create XNNPACK runtime");
       return nullptr;
@@ -610,7 +627,17 @@ class Subgraph {
   TfLiteStatus Prepare(TfLiteContext* context) { return kTfLiteOk; }
 
   TfLiteStatus Invoke(TfLiteContext* context) {
+    std::shared_lock<std::shared_timed_mutex> weights_cache_lock;
     bool any_pointers_changed = false;
+    if (weights_cache_ != nullptr) {
+      weights_cache_lock =
+          std::shared_lock<std::shared_timed_mutex>(weights_cache_->mutex);
+      if (weights_cache_generation_ != weights_cache_->generation) {
+        // Packed weights may have moved since the last setup.
+        any_pointers_changed = true;
+        weights_cache_generation_ = weights_cache_->generation;
+      }
+    }
     for (std::pair<int, void*> io_info : externals_) {
       const TfLiteTensor& tensor = context->tensors[io_info.first];
       void* data_pointer = &dummy_data_;
@@ -4282,7 +4309,8 @@ class Subgraph {
  private:
   Subgraph(const Delegate& delegate, xnn_runtime_t runtime,
            const std::unordered_set<int>& externals)
-      : runtime_(runtime, &xnn_delete_runtime) {
+      : runtime_(runtime, &xnn_delete_runtime),
+        weights_cache_(delegate.weights_cache()) {
     for (int t : externals) {
       externals_[t] = nullptr;
     }
@@ -4295,6 +4323,10 @@ class Subgraph {
   // Mapping from TFLite Tensor IDs (same as XNNPACK Value IDs) for
   // input/output tensors in the delegated subgraph to their data locations.
   std::unordered_map<int, void*> externals_;
+  // Weights cache shared with other runtimes, if any, and its generation as of
+  // the last xnn_setup_runtime call.
+  TfLiteXNNPackDelegateWeightsCache* weights_cache_ = nullptr;
+  uint64_t weights_cache_generation_ = 0;
   // Memory location to use for 0-size extenal tensors, as TFLite init their
   // data pointer to nullptr, and XNNPACK requires valid data pointers.
   char dummy_data_{0};
@@ -4729,17 +4761,22 @@ TfLiteXNNPackDelegateWeightsCache* TfLiteXNNPackDelegateWeightsCacheCreate() {
     return nullptr;
   }
 
-  xnn_weights_cache_t weights_cache;
-  xnn_create_weights_cache(&weights_cache);
-  return reinterpret_cast<TfLiteXNNPackDelegateWeightsCache*>(weights_cache);
+  auto weights_cache = new TfLiteXNNPackDelegateWeightsCache;
+  status = xnn_create_weights_cache(&weights_cache->cache);
+  if (status != xnn_status_success) {
+    delete weights_cache;
+    xnn_deinitialize();
+    return nullptr;
+  }
+  return weights_cache;
 }
 
 void TfLiteXNNPackWeightsCacheDelete(TfLiteXNNPackDelegateWeightsCache* cache) {
   if (cache == nullptr) {
     return;
   }
-  auto weights_cache = reinterpret_cast<xnn_weights_cache_t>(cache);
-  xnn_delete_weights_cache(weights_cache);
+  xnn_delete_weights_cache(cache->cache);
+  delete cache;
   xnn_deinitialize();
 }
 
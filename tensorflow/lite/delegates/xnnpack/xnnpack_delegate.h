@@ -69,7 +69,12 @@ TFL_CAPI_EXPORT void* TfLiteXNNPackDelegateGetThreadPool(
 TFL_CAPI_EXPORT void TfLiteXNNPackDelegateDelete(TfLiteDelegate* delegate);
 
 // Creates a new weights cache that can be shared with multiple delegate
-// instances.
+// instances, e.g. by all interpreters of a process that load the same model.
+// Weights are looked up by their contents, so each distinct weight tensor is
+// packed once and every delegate using the cache reads the packed copy. It is
+// safe to apply and invoke delegates sharing a cache from different threads,
+// but applying such a delegate waits for in-flight invocations of the others.
+// The cache must outlive all delegates using it.
 TFL_CAPI_EXPORT struct TfLiteXNNPackDelegateWeightsCache*
 TfLiteXNNPackDelegateWeightsCacheCreate();
 // Destroys a weights cache created with
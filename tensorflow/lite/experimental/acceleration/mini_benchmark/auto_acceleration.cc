@@ -0,0 +1,104 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/experimental/acceleration/mini_benchmark/auto_acceleration.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "flatbuffers/flatbuffers.h"  // from @flatbuffers
+#include "tensorflow/lite/minimal_logging.h"
+
+namespace tflite {
+namespace acceleration {
+namespace {
+
+// Maps the delegate to the name its plugin is registered under, using the same
+// names as the Validator so that the delegate that is used is the one that was
+// benchmarked. Returns nullptr for unsupported delegates.
+const char* DelegatePluginName(Delegate delegate) {
+  switch (delegate) {
+    case Delegate_NNAPI:
+      return "NnapiPlugin";
+    case Delegate_GPU:
+      return "GpuPlugin";
+    case Delegate_XNNPACK:
+      return "XNNPackPlugin";
+    default:
+      return nullptr;
+  }
+}
+
+}  // namespace
+
+MinibenchmarkStatus AutoAcceleration::Apply(InterpreterBuilder* builder) {
+  if (!mini_benchmark_ || !builder) {
+    return kMinibenchmarkPreconditionNotMet;
+  }
+  selected_delegate_ = Delegate_NONE;
+  delegate_.reset();
+  delegate_plugin_.reset();
+
+  const ComputeSettingsT best = mini_benchmark_->GetBestAcceleration();
+  if (!best.tflite_settings) {
+    // No completed benchmark yet (or nothing to benchmark): run on CPU this
+    // time and let the tests make progress in the background.
+    if (mini_benchmark_->NumRemainingAccelerationTests() != 0) {
+      mini_benchmark_->TriggerMiniBenchmark();
+    }
+    return kMinibenchmarkSuccess;
+  }
+
+  const Delegate delegate = best.tflite_settings->delegate;
+  if (delegate == Delegate_NONE) {
+    // The benchmark concluded that CPU is the best choice.
+    return kMinibenchmarkSuccess;
+  }
+  const char* plugin_name = DelegatePluginName(delegate);
+  if (!plugin_name) {
+    return kMinibenchmarkDelegateNotSupported;
+  }
+
+  flatbuffers::FlatBufferBuilder fbb;
+  fbb.Finish(TFLiteSettings::Pack(fbb, best.tflite_settings.get()));
+  const TFLiteSettings* tflite_settings =
+      flatbuffers::GetRoot<TFLiteSettings>(fbb.GetBufferPointer());
+  std::unique_ptr<delegates::DelegatePluginInterface> plugin =
+      delegates::DelegatePluginRegistry::CreateByName(plugin_name,
+                                                      *tflite_settings);
+  if (!plugin) {
+    TFLITE_LOG_PROD(TFLITE_LOG_WARNING,
+                    "Delegate plugin %s selected by the mini-benchmark is not "
+                    "linked in, running on CPU.",
+                    plugin_name);
+    return kMinibenchmarkDelegatePluginNotFound;
+  }
+  delegates::TfLiteDelegatePtr created = plugin->Create();
+  if (!created) {
+    TFLITE_LOG_PROD(TFLITE_LOG_WARNING,
+                    "Failed to create delegate from %s, running on CPU.",
+                    plugin_name);
+    return kMinibenchmarkDelegateNotSupported;
+  }
+
+  delegate_plugin_ = std::move(plugin);
+  delegate_ = std::move(created);
+  selected_delegate_ = delegate;
+  builder->AddDelegate(delegate_.get());
+  return kMinibenchmarkSuccess;
+}
+
+}  // namespace acceleration
+}  // namespace tflite
@@ -0,0 +1,71 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_EXPERIMENTAL_ACCELERATION_MINI_BENCHMARK_AUTO_ACCELERATION_H_
+#define TENSORFLOW_LITE_EXPERIMENTAL_ACCELERATION_MINI_BENCHMARK_AUTO_ACCELERATION_H_
+
+#include <memory>
+
+#include "tensorflow/lite/experimental/acceleration/configuration/configuration_generated.h"
+#include "tensorflow/lite/experimental/acceleration/configuration/delegate_registry.h"
+#include "tensorflow/lite/experimental/acceleration/mini_benchmark/mini_benchmark.h"
+#include "tensorflow/lite/experimental/acceleration/mini_benchmark/status_codes.h"
+#include "tensorflow/lite/interpreter_builder.h"
+
+namespace tflite {
+namespace acceleration {
+
+// Applies the "auto" acceleration policy to an InterpreterBuilder: the delegate
+// that the mini-benchmark found to be the fastest one producing correct results
+// on this device is added to the builder. While no such result is available
+// yet, the mini-benchmark is triggered in the background and the interpreter
+// stays on CPU; later loads then pick up the persisted decision.
+//
+// The delegate created by Apply() is owned by this object, whose lifetime must
+// therefore be at least as long as that of any Interpreter built with the
+// builder.
+//
+// Instances are thread-compatible.
+class AutoAcceleration {
+ public:
+  // `mini_benchmark` is not owned and must outlive this object.
+  explicit AutoAcceleration(MiniBenchmark* mini_benchmark)
+      : mini_benchmark_(mini_benchmark) {}
+
+  // Selects the best acceleration found so far and adds the corresponding
+  // delegate, if any, to `builder`. Returns kMinibenchmarkSuccess if the
+  // builder was set up (possibly for CPU only), or the error that prevented
+  // the selected delegate from being created. In the latter case no delegate
+  // is added, so the builder can still be used to run on CPU.
+  MinibenchmarkStatus Apply(InterpreterBuilder* builder);
+
+  // The delegate chosen by the last call to Apply(), Delegate_NONE if running
+  // on CPU.
+  Delegate selected_delegate() const { return selected_delegate_; }
+
+  AutoAcceleration(const AutoAcceleration&) = delete;
+  AutoAcceleration& operator=(const AutoAcceleration&) = delete;
+
+ private:
+  MiniBenchmark* mini_benchmark_;
+  Delegate selected_delegate_ = Delegate_NONE;
+  std::unique_ptr<delegates::DelegatePluginInterface> delegate_plugin_;
+  delegates::TfLiteDelegatePtr delegate_ =
+      delegates::TfLiteDelegatePtr(nullptr, [](TfLiteDelegate*) {});
+};
+
+}  // namespace acceleration
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_EXPERIMENTAL_ACCELERATION_MINI_BENCHMARK_AUTO_ACCELERATION_H_
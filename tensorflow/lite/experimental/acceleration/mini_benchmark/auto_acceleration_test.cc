@@ -0,0 +1,124 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/experimental/acceleration/mini_benchmark/auto_acceleration.h"
+
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/experimental/acceleration/configuration/configuration_generated.h"
+#include "tensorflow/lite/experimental/acceleration/mini_benchmark/status_codes.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/kernels/register.h"
+#include "tensorflow/lite/model_builder.h"
+
+namespace tflite {
+namespace acceleration {
+namespace {
+
+// A MiniBenchmark that returns a fixed best acceleration.
+class FakeMiniBenchmark : public MiniBenchmark {
+ public:
+  explicit FakeMiniBenchmark(Delegate best_delegate, bool has_result = true,
+                             int remaining_tests = 0)
+      : best_delegate_(best_delegate),
+        has_result_(has_result),
+        remaining_tests_(remaining_tests) {}
+
+  ComputeSettingsT GetBestAcceleration() override {
+    ComputeSettingsT settings;
+    if (has_result_) {
+      settings.tflite_settings = std::make_unique<TFLiteSettingsT>();
+      settings.tflite_settings->delegate = best_delegate_;
+    }
+    return settings;
+  }
+  void TriggerMiniBenchmark() override { ++num_triggers_; }
+  void SetEventTimeoutForTesting(int64_t) override {}
+  std::vector<MiniBenchmarkEventT> MarkAndGetEventsToLog() override {
+    return {};
+  }
+  int NumRemainingAccelerationTests() override { return remaining_tests_; }
+
+  int num_triggers() const { return num_triggers_; }
+
+ private:
+  Delegate best_delegate_;
+  bool has_result_;
+  int remaining_tests_;
+  int num_triggers_ = 0;
+};
+
+class AutoAccelerationTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    model_ = FlatBufferModel::BuildFromFile(
+        "tensorflow/lite/testdata/add.bin");
+    ASSERT_NE(model_, nullptr);
+    builder_ = std::make_unique<InterpreterBuilder>(*model_, resolver_);
+  }
+
+  void BuildAndInvoke() {
+    std::unique_ptr<Interpreter> interpreter;
+    ASSERT_EQ((*builder_)(&interpreter), kTfLiteOk);
+    ASSERT_EQ(interpreter->AllocateTensors(), kTfLiteOk);
+    EXPECT_EQ(interpreter->Invoke(), kTfLiteOk);
+  }
+
+  std::unique_ptr<FlatBufferModel> model_;
+  ops::builtin::BuiltinOpResolverWithoutDefaultDelegates resolver_;
+  std::unique_ptr<InterpreterBuilder> builder_;
+};
+
+TEST_F(AutoAccelerationTest, TriggersBenchmarkWhenNoResultYet) {
+  FakeMiniBenchmark mini_benchmark(Delegate_NONE, /*has_result=*/false,
+                                   /*remaining_tests=*/1);
+  AutoAcceleration auto_acceleration(&mini_benchmark);
+  EXPECT_EQ(auto_acceleration.Apply(builder_.get()), kMinibenchmarkSuccess);
+  EXPECT_EQ(auto_acceleration.selected_delegate(), Delegate_NONE);
+  EXPECT_EQ(mini_benchmark.num_triggers(), 1);
+  BuildAndInvoke();
+}
+
+TEST_F(AutoAccelerationTest, StaysOnCpuWhenCpuIsBest) {
+  FakeMiniBenchmark mini_benchmark(Delegate_NONE);
+  AutoAcceleration auto_acceleration(&mini_benchmark);
+  EXPECT_EQ(auto_acceleration.Apply(builder_.get()), kMinibenchmarkSuccess);
+  EXPECT_EQ(auto_acceleration.selected_delegate(), Delegate_NONE);
+  EXPECT_EQ(mini_benchmark.num_triggers(), 0);
+  BuildAndInvoke();
+}
+
+TEST_F(AutoAccelerationTest, AppliesBestDelegate) {
+  FakeMiniBenchmark mini_benchmark(Delegate_XNNPACK);
+  AutoAcceleration auto_acceleration(&mini_benchmark);
+  EXPECT_EQ(auto_acceleration.Apply(builder_.get()), kMinibenchmarkSuccess);
+  EXPECT_EQ(auto_acceleration.selected_delegate(), Delegate_XNNPACK);
+  BuildAndInvoke();
+}
+
+TEST_F(AutoAccelerationTest, FallsBackToCpuWhenPluginIsMissing) {
+  // The GPU plugin is not linked into this test.
+  FakeMiniBenchmark mini_benchmark(Delegate_GPU);
+  AutoAcceleration auto_acceleration(&mini_benchmark);
+  EXPECT_EQ(auto_acceleration.Apply(builder_.get()),
+            kMinibenchmarkDelegatePluginNotFound);
+  EXPECT_EQ(auto_acceleration.selected_delegate(), Delegate_NONE);
+  BuildAndInvoke();
+}
+
+}  // namespace
+}  // namespace acceleration
+}  // namespace tflite
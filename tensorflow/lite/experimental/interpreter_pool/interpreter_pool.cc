@@ -0,0 +1,129 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/experimental/interpreter_pool/interpreter_pool.h"
+
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <utility>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/delegates/xnnpack/xnnpack_delegate.h"
+#include "tensorflow/lite/interpreter_builder.h"
+
+namespace tflite {
+namespace experimental {
+
+InterpreterPool::Lease::Lease(Lease&& other)
+    : pool_(other.pool_), interpreter_(other.interpreter_) {
+  other.pool_ = nullptr;
+  other.interpreter_ = nullptr;
+}
+
+InterpreterPool::Lease& InterpreterPool::Lease::operator=(Lease&& other) {
+  if (this != &other) {
+    if (pool_ != nullptr) pool_->Release(interpreter_);
+    pool_ = other.pool_;
+    interpreter_ = other.interpreter_;
+    other.pool_ = nullptr;
+    other.interpreter_ = nullptr;
+  }
+  return *this;
+}
+
+InterpreterPool::Lease::~Lease() {
+  if (pool_ != nullptr) pool_->Release(interpreter_);
+}
+
+std::unique_ptr<InterpreterPool> InterpreterPool::Create(
+    const FlatBufferModel& model, const OpResolver& op_resolver,
+    const Options& options, ErrorReporter* error_reporter) {
+  if (options.num_contexts < 1) {
+    TF_LITE_REPORT_ERROR(error_reporter,
+                         "InterpreterPool needs at least one context, got %d.",
+                         options.num_contexts);
+    return nullptr;
+  }
+  WeightsCachePtr weights_cache(nullptr, TfLiteXNNPackWeightsCacheDelete);
+  if (options.use_xnnpack) {
+    weights_cache.reset(TfLiteXNNPackDelegateWeightsCacheCreate());
+    if (weights_cache == nullptr) {
+      TF_LITE_REPORT_ERROR(error_reporter,
+                           "Failed to create the XNNPACK weights cache.");
+      return nullptr;
+    }
+  }
+  std::unique_ptr<InterpreterPool> pool(
+      new InterpreterPool(std::move(weights_cache)));
+
+  // Contexts are built one at a time: the weights cache is only filled while
+  // delegates are applied, after which it is only read from.
+  pool->contexts_.resize(options.num_contexts);
+  for (Context& context : pool->contexts_) {
+    InterpreterBuilder builder(model, op_resolver);
+    if (builder.SetNumThreads(options.num_threads) != kTfLiteOk ||
+        builder(&context.interpreter) != kTfLiteOk) {
+      TF_LITE_REPORT_ERROR(error_reporter,
+                           "Failed to build an InterpreterPool context.");
+      return nullptr;
+    }
+    if (options.use_xnnpack) {
+      TfLiteXNNPackDelegateOptions xnnpack_options =
+          TfLiteXNNPackDelegateOptionsDefault();
+      // Note that we don't want to use the thread pool for num_threads == 1.
+      xnnpack_options.num_threads =
+          options.num_threads > 1 ? options.num_threads : 0;
+      xnnpack_options.weights_cache = pool->weights_cache_.get();
+      context.delegate = Interpreter::TfLiteDelegatePtr(
+          TfLiteXNNPackDelegateCreate(&xnnpack_options),
+          TfLiteXNNPackDelegateDelete);
+      if (context.delegate == nullptr ||
+          context.interpreter->ModifyGraphWithDelegate(
+              context.delegate.get()) != kTfLiteOk) {
+        TF_LITE_REPORT_ERROR(
+            error_reporter,
+            "Failed to apply XNNPACK to an InterpreterPool context.");
+        return nullptr;
+      }
+    }
+    if (context.interpreter->AllocateTensors() != kTfLiteOk) {
+      TF_LITE_REPORT_ERROR(
+          error_reporter,
+          "Failed to allocate tensors of an InterpreterPool context.");
+      return nullptr;
+    }
+    pool->free_interpreters_.push_back(context.interpreter.get());
+  }
+  return pool;
+}
+
+InterpreterPool::Lease InterpreterPool::Acquire() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  context_released_.wait(lock, [this] { return !free_interpreters_.empty(); });
+  Interpreter* interpreter = free_interpreters_.back();
+  free_interpreters_.pop_back();
+  return Lease(this, interpreter);
+}
+
+void InterpreterPool::Release(Interpreter* interpreter) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    free_interpreters_.push_back(interpreter);
+  }
+  context_released_.notify_one();
+}
+
+}  // namespace experimental
+}  // namespace tflite
@@ -0,0 +1,137 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_EXPERIMENTAL_INTERPRETER_POOL_INTERPRETER_POOL_H_
+#define TENSORFLOW_LITE_EXPERIMENTAL_INTERPRETER_POOL_INTERPRETER_POOL_H_
+
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/core/api/error_reporter.h"
+#include "tensorflow/lite/core/api/op_resolver.h"
+#include "tensorflow/lite/delegates/xnnpack/xnnpack_delegate.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/model_builder.h"
+
+namespace tflite {
+namespace experimental {
+
+/// A fixed set of execution contexts for serving concurrent requests on a
+/// single model.
+///
+/// Every context is an `Interpreter` with its own tensors and arena, so
+/// contexts can be invoked from different threads at the same time. What is
+/// immutable is shared: constant tensors of all contexts point into the
+/// buffer of the same `FlatBufferModel`, and all contexts delegate to XNNPACK
+/// through a single weights cache, so weights are packed once per model
+/// rather than once per context.
+///
+/// Usage:
+///
+/// <pre><code>
+/// auto pool = InterpreterPool::Create(*model, resolver, options);
+/// // On any serving thread:
+/// InterpreterPool::Lease context = pool->Acquire();
+/// std::copy(..., context->typed_input_tensor<float>(0));
+/// context->Invoke();
+/// </code></pre>
+///
+/// The pool must outlive all its leases, and `model` must outlive the pool.
+/// `op_resolver` should not provide default delegates (see
+/// `BuiltinOpResolverWithoutDefaultDelegates`), since these would be applied to
+/// every context without sharing their weights.
+///
+/// WARNING: This is an experimental API and subject to change.
+class InterpreterPool {
+ public:
+  struct Options {
+    /// Number of contexts, i.e. the maximum number of concurrent invocations.
+    int num_contexts = 1;
+    /// Number of threads each context uses for a single invocation.
+    int num_threads = 1;
+    /// Whether to delegate to XNNPACK with weights shared across contexts.
+    bool use_xnnpack = true;
+  };
+
+  /// Exclusive access to one context, which goes back to the pool when the
+  /// lease is destroyed.
+  class Lease {
+   public:
+    Lease(Lease&& other);
+    Lease& operator=(Lease&& other);
+    ~Lease();
+
+    Interpreter* get() const { return interpreter_; }
+    Interpreter* operator->() const { return interpreter_; }
+    Interpreter& operator*() const { return *interpreter_; }
+
+   private:
+    friend class InterpreterPool;
+    Lease(InterpreterPool* pool, Interpreter* interpreter)
+        : pool_(pool), interpreter_(interpreter) {}
+
+    InterpreterPool* pool_;
+    Interpreter* interpreter_;
+  };
+
+  /// Builds `options.num_contexts` contexts for `model` and allocates their
+  /// tensors. Returns nullptr, after reporting the error to `error_reporter`,
+  /// if any of them fails to build.
+  static std::unique_ptr<InterpreterPool> Create(
+      const FlatBufferModel& model, const OpResolver& op_resolver,
+      const Options& options = Options(),
+      ErrorReporter* error_reporter = DefaultErrorReporter());
+
+  InterpreterPool(const InterpreterPool&) = delete;
+  InterpreterPool& operator=(const InterpreterPool&) = delete;
+
+  /// Blocks until a context is free and leases it to the caller.
+  Lease Acquire();
+
+  int num_contexts() const { return contexts_.size(); }
+
+ private:
+  using WeightsCachePtr =
+      std::unique_ptr<TfLiteXNNPackDelegateWeightsCache,
+                      void (*)(TfLiteXNNPackDelegateWeightsCache*)>;
+
+  struct Context {
+    // Declared first so that it outlives the interpreter applying it.
+    Interpreter::TfLiteDelegatePtr delegate{nullptr, [](TfLiteDelegate*) {}};
+    std::unique_ptr<Interpreter> interpreter;
+  };
+
+  explicit InterpreterPool(WeightsCachePtr weights_cache)
+      : weights_cache_(std::move(weights_cache)) {}
+
+  void Release(Interpreter* interpreter);
+
+  // Declared first so that it outlives the delegates of all contexts.
+  WeightsCachePtr weights_cache_;
+  std::vector<Context> contexts_;
+
+  std::mutex mutex_;
+  std::condition_variable context_released_;
+  std::vector<Interpreter*> free_interpreters_;
+};
+
+}  // namespace experimental
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_EXPERIMENTAL_INTERPRETER_POOL_INTERPRETER_POOL_H_
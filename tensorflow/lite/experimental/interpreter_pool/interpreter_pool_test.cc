@@ -0,0 +1,130 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/experimental/interpreter_pool/interpreter_pool.h"
+
+#include <algorithm>
+#include <memory>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/kernels/register.h"
+#include "tensorflow/lite/model_builder.h"
+
+namespace tflite {
+namespace experimental {
+namespace {
+
+// testdata/add.bin computes `output = (input + input) + input`.
+constexpr char kAddModel[] = "tensorflow/lite/testdata/add.bin";
+
+void InvokeAndCheck(Interpreter* interpreter, float value) {
+  TfLiteTensor* input = interpreter->input_tensor(0);
+  const int num_elements = input->bytes / sizeof(float);
+  std::fill_n(interpreter->typed_input_tensor<float>(0), num_elements, value);
+  ASSERT_EQ(interpreter->Invoke(), kTfLiteOk);
+  const float* output = interpreter->typed_output_tensor<float>(0);
+  for (int i = 0; i < num_elements; ++i) {
+    ASSERT_EQ(output[i], 3 * value);
+  }
+}
+
+class InterpreterPoolTest : public ::testing::TestWithParam<bool> {
+ protected:
+  void SetUp() override {
+    model_ = FlatBufferModel::BuildFromFile(kAddModel);
+    ASSERT_NE(model_, nullptr);
+  }
+
+  InterpreterPool::Options MakeOptions(int num_contexts) {
+    InterpreterPool::Options options;
+    options.num_contexts = num_contexts;
+    options.use_xnnpack = GetParam();
+    return options;
+  }
+
+  std::unique_ptr<FlatBufferModel> model_;
+  ops::builtin::BuiltinOpResolverWithoutDefaultDelegates resolver_;
+};
+
+TEST_P(InterpreterPoolTest, ContextsHaveSeparateTensors) {
+  auto pool = InterpreterPool::Create(*model_, resolver_, MakeOptions(2));
+  ASSERT_NE(pool, nullptr);
+  EXPECT_EQ(pool->num_contexts(), 2);
+
+  InterpreterPool::Lease first = pool->Acquire();
+  InterpreterPool::Lease second = pool->Acquire();
+  ASSERT_NE(first.get(), second.get());
+  EXPECT_NE(first->typed_input_tensor<float>(0),
+            second->typed_input_tensor<float>(0));
+  EXPECT_NE(first->typed_output_tensor<float>(0),
+            second->typed_output_tensor<float>(0));
+
+  InvokeAndCheck(first.get(), 1.0f);
+  InvokeAndCheck(second.get(), 2.0f);
+  // Running the second context must not have clobbered the first one.
+  EXPECT_EQ(first->typed_output_tensor<float>(0)[0], 3.0f);
+}
+
+TEST_P(InterpreterPoolTest, ReleasedContextIsReused) {
+  auto pool = InterpreterPool::Create(*model_, resolver_, MakeOptions(1));
+  ASSERT_NE(pool, nullptr);
+
+  Interpreter* interpreter;
+  {
+    InterpreterPool::Lease lease = pool->Acquire();
+    interpreter = lease.get();
+    InterpreterPool::Lease moved = std::move(lease);
+    EXPECT_EQ(moved.get(), interpreter);
+  }
+  EXPECT_EQ(pool->Acquire().get(), interpreter);
+}
+
+TEST_P(InterpreterPoolTest, ConcurrentInvocations) {
+  constexpr int kNumContexts = 2;
+  constexpr int kNumThreads = 4;
+  constexpr int kNumInvocations = 50;
+  auto pool =
+      InterpreterPool::Create(*model_, resolver_, MakeOptions(kNumContexts));
+  ASSERT_NE(pool, nullptr);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([&pool, t] {
+      for (int i = 0; i < kNumInvocations; ++i) {
+        InterpreterPool::Lease context = pool->Acquire();
+        InvokeAndCheck(context.get(), t * kNumInvocations + i);
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+}
+
+TEST_P(InterpreterPoolTest, RejectsEmptyPool) {
+  EXPECT_EQ(InterpreterPool::Create(*model_, resolver_, MakeOptions(0)),
+            nullptr);
+}
+
+INSTANTIATE_TEST_SUITE_P(InterpreterPool, InterpreterPoolTest,
+                         ::testing::Bool());
+
+}  // namespace
+}  // namespace experimental
+}  // namespace tflite
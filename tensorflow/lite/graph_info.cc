@@ -15,6 +15,7 @@ limitations under the License.
 #include "tensorflow/lite/graph_info.h"
 
 #include <algorithm>
+#include <functional>
 #include <vector>
 
 #include "tensorflow/lite/c/common.h"
@@ -249,4 +250,55 @@ TfLiteStatus PartitionGraphIntoIndependentNodeSubsets(
   return kTfLiteOk;
 }
 
+std::vector<int> ComputeConcurrentNodeLevels(
+    const GraphInfo* info, const std::function<bool(size_t)>& is_barrier) {
+  const size_t num_nodes = info->num_execution_nodes();
+  std::vector<int> levels(num_nodes, 0);
+  // Per tensor, the level of its most recent writer and the highest level of
+  // the nodes that read it since then, or -1 if there was none.
+  std::vector<int> write_level(info->num_tensors(), -1);
+  std::vector<int> read_level(info->num_tensors(), -1);
+  // Lowest level a node may take because of an earlier barrier, and the
+  // highest level assigned so far.
+  int min_level = 0;
+  int max_level = -1;
+  for (size_t i = 0; i < num_nodes; ++i) {
+    const TfLiteNode& node = info->node(i);
+    int level = min_level;
+    if (is_barrier(i)) {
+      level = std::max(level, max_level + 1);
+    } else {
+      for (int tensor : TfLiteIntArrayView(node.inputs)) {
+        if (tensor == kTfLiteOptionalTensor) continue;
+        level = std::max(level, write_level[tensor] + 1);
+      }
+      for (const TfLiteIntArray* tensors : {node.outputs, node.intermediates}) {
+        if (tensors == nullptr) continue;
+        for (int tensor : TfLiteIntArrayView(tensors)) {
+          if (tensor == kTfLiteOptionalTensor) continue;
+          level = std::max(
+              level, std::max(write_level[tensor], read_level[tensor]) + 1);
+        }
+      }
+    }
+    levels[i] = level;
+    max_level = std::max(max_level, level);
+    if (is_barrier(i)) min_level = level + 1;
+
+    for (int tensor : TfLiteIntArrayView(node.inputs)) {
+      if (tensor == kTfLiteOptionalTensor) continue;
+      read_level[tensor] = std::max(read_level[tensor], level);
+    }
+    for (const TfLiteIntArray* tensors : {node.outputs, node.intermediates}) {
+      if (tensors == nullptr) continue;
+      for (int tensor : TfLiteIntArrayView(tensors)) {
+        if (tensor == kTfLiteOptionalTensor) continue;
+        write_level[tensor] = level;
+        read_level[tensor] = -1;
+      }
+    }
+  }
+  return levels;
+}
+
 }  // namespace tflite
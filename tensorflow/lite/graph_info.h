@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <stddef.h>
 
+#include <functional>
 #include <vector>
 
 #include "tensorflow/lite/c/common.h"
@@ -61,6 +62,12 @@ class GraphInfo {
 
   // Returns the indices of the variable tensors.
   virtual const std::vector<int>& variables() const = 0;
+
+  // Returns the execution-plan index of the last node that may run
+  // concurrently with the node at execution-plan index `index`. Memory planners
+  // must keep tensors released by `index` alive until that node has run. The
+  // default is sequential execution, where this is `index` itself.
+  virtual size_t last_concurrent_node(size_t index) const { return index; }
 };
 
 // Represents a subset of nodes in a TensorFlow Lite graph.
@@ -90,6 +97,16 @@ TfLiteStatus PartitionGraphIntoIndependentNodeSubsets(
     const GraphInfo* info, const TfLiteIntArray* nodes_to_partition,
     std::vector<NodeSubset>* node_subsets);
 
+// Assigns every node in the execution plan of `info` a concurrency level such
+// that a node only depends on nodes with a strictly lower level: a node reading
+// a tensor comes after its writer, and a node writing a tensor comes after all
+// earlier readers and writers of it. Nodes for which `is_barrier` returns true
+// get a level of their own and every later node is placed after them. Nodes
+// that share a level may therefore run concurrently. Returns one level per
+// execution-plan index; levels start at 0 and are dense.
+std::vector<int> ComputeConcurrentNodeLevels(
+    const GraphInfo* info, const std::function<bool(size_t)>& is_barrier);
+
 }  // namespace tflite
 
 #endif  // TENSORFLOW_LITE_GRAPH_INFO_H_
@@ -387,5 +387,48 @@ TEST(PartitionTest, Nodes4PartitionNodes3_WithControlDependency) {
       {expected_subgraph0, expected_subgraph1, expected_subgraph2});
 }
 
+// Two independent branches share levels; the node joining them comes after.
+//
+//   0 -> [0] -> 1 -> [2] -> 3
+//   0 -> [1] -> 2 -/
+TEST(ConcurrentNodeLevelsTest, IndependentBranches) {
+  SimpleTestGraph graph;
+  graph.AddTensors(5);
+  graph.AddNode({0}, {1});
+  graph.AddNode({0}, {2});
+  graph.AddNode({1}, {3});
+  graph.AddNode({2}, {4});
+  graph.AddNode({3, 4}, {0});
+  graph.SetInputsAndOutputs({0}, {0});
+  EXPECT_EQ(ComputeConcurrentNodeLevels(&graph, [](size_t) { return false; }),
+            std::vector<int>({0, 0, 1, 1, 2}));
+}
+
+// A node overwriting a tensor must wait for the nodes reading it.
+TEST(ConcurrentNodeLevelsTest, WriteAfterRead) {
+  SimpleTestGraph graph;
+  graph.AddTensors(4);
+  graph.AddNode({0}, {1});
+  graph.AddNode({1}, {2});
+  graph.AddNode({0}, {3});
+  graph.AddNode({3}, {1});
+  graph.SetInputsAndOutputs({0}, {1, 2});
+  EXPECT_EQ(ComputeConcurrentNodeLevels(&graph, [](size_t) { return false; }),
+            std::vector<int>({0, 1, 0, 2}));
+}
+
+// Barriers are never grouped with other nodes and nothing moves across them.
+TEST(ConcurrentNodeLevelsTest, Barrier) {
+  SimpleTestGraph graph;
+  graph.AddTensors(4);
+  graph.AddNode({0}, {1});
+  graph.AddNode({0}, {2});
+  graph.AddNode({0}, {3});
+  graph.SetInputsAndOutputs({0}, {1, 2, 3});
+  EXPECT_EQ(
+      ComputeConcurrentNodeLevels(&graph, [](size_t i) { return i == 1; }),
+      std::vector<int>({0, 1, 2}));
+}
+
 }  // namespace
 }  // namespace tflite
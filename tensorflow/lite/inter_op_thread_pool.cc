@@ -0,0 +1,90 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/inter_op_thread_pool.h"
+
+#include <functional>
+#include <mutex>  // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+
+namespace tflite {
+
+InterOpThreadPool::InterOpThreadPool(int num_threads)
+    : num_threads_(num_threads < 1 ? 1 : num_threads) {
+  threads_.reserve(num_threads_ - 1);
+  for (int worker = 1; worker < num_threads_; ++worker) {
+    threads_.emplace_back([this, worker] { WorkerLoop(worker); });
+  }
+}
+
+InterOpThreadPool::~InterOpThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    shutdown_ = true;
+  }
+  job_cv_.notify_all();
+  for (auto& thread : threads_) thread.join();
+}
+
+void InterOpThreadPool::ParallelFor(int count,
+                                    const std::function<void(int, int)>& fn) {
+  if (count <= 0) return;
+  if (count == 1 || threads_.empty()) {
+    for (int i = 0; i < count; ++i) fn(0, i);
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    fn_ = &fn;
+    count_ = count;
+    next_index_.store(0, std::memory_order_relaxed);
+    busy_threads_ = static_cast<int>(threads_.size());
+    ++job_generation_;
+  }
+  job_cv_.notify_all();
+  RunTasks(/*worker=*/0);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_cv_.wait(lock, [this] { return busy_threads_ == 0; });
+  fn_ = nullptr;
+}
+
+void InterOpThreadPool::WorkerLoop(int worker) {
+  uint64_t seen_generation = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      job_cv_.wait(lock, [this, seen_generation] {
+        return shutdown_ || job_generation_ != seen_generation;
+      });
+      if (shutdown_) return;
+      seen_generation = job_generation_;
+    }
+    RunTasks(worker);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (--busy_threads_ == 0) done_cv_.notify_one();
+    }
+  }
+}
+
+void InterOpThreadPool::RunTasks(int worker) {
+  while (true) {
+    const int index = next_index_.fetch_add(1, std::memory_order_relaxed);
+    if (index >= count_) return;
+    (*fn_)(worker, index);
+  }
+}
+
+}  // namespace tflite
@@ -0,0 +1,81 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_INTER_OP_THREAD_POOL_H_
+#define TENSORFLOW_LITE_INTER_OP_THREAD_POOL_H_
+
+#include <atomic>
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <cstdint>
+#include <functional>
+#include <mutex>  // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+namespace tflite {
+
+// WARNING: This is an experimental interface that is subject to change.
+//
+// A small fixed-size thread pool used by the interpreter to run independent
+// nodes of a graph concurrently. Unlike the kernel-level pools (ruy, gemmlowp,
+// Eigen), which split the work of a single op, this pool distributes whole ops.
+//
+// The calling thread always takes part in the work, so a pool created with
+// `num_threads` workers spawns `num_threads - 1` threads.
+class InterOpThreadPool {
+ public:
+  explicit InterOpThreadPool(int num_threads);
+  ~InterOpThreadPool();
+
+  // Total number of workers, including the calling thread.
+  int num_threads() const { return num_threads_; }
+
+  // Runs `fn(worker, index)` for every `index` in [0, `count`) and blocks until
+  // all calls returned. `worker` identifies the executing worker and lies in
+  // [0, num_threads()); the calling thread is worker 0. Calls made by the same
+  // worker never overlap. Must not be called concurrently or re-entrantly.
+  void ParallelFor(int count, const std::function<void(int, int)>& fn);
+
+ private:
+  InterOpThreadPool(const InterOpThreadPool&) = delete;
+  InterOpThreadPool& operator=(const InterOpThreadPool&) = delete;
+
+  void WorkerLoop(int worker);
+
+  // Claims and runs indices of the current job until none are left.
+  void RunTasks(int worker);
+
+  const int num_threads_;
+  std::vector<std::thread> threads_;
+
+  std::mutex mutex_;
+  // Signalled when a new job is published or the pool shuts down.
+  std::condition_variable job_cv_;
+  // Signalled when the last worker finished the current job.
+  std::condition_variable done_cv_;
+  // Incremented for every job so that workers notice a new one.
+  uint64_t job_generation_ = 0;
+  // Number of spawned threads still working on the current job.
+  int busy_threads_ = 0;
+  bool shutdown_ = false;
+
+  // The current job. Only written while no spawned thread is busy.
+  const std::function<void(int, int)>* fn_ = nullptr;
+  int count_ = 0;
+  std::atomic<int> next_index_{0};
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_INTER_OP_THREAD_POOL_H_
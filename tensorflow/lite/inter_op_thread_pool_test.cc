@@ -0,0 +1,69 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/inter_op_thread_pool.h"
+
+#include <atomic>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/lite/testing/util.h"
+
+namespace tflite {
+namespace {
+
+TEST(InterOpThreadPoolTest, RunsEveryIndexOnce) {
+  InterOpThreadPool pool(4);
+  EXPECT_EQ(pool.num_threads(), 4);
+  for (int count : {0, 1, 3, 4, 100}) {
+    std::vector<std::atomic<int>> calls(count);
+    for (auto& c : calls) c = 0;
+    pool.ParallelFor(count, [&calls](int worker, int index) {
+      EXPECT_GE(worker, 0);
+      EXPECT_LT(worker, 4);
+      calls[index]++;
+    });
+    for (int i = 0; i < count; ++i) EXPECT_EQ(calls[i], 1) << i;
+  }
+}
+
+TEST(InterOpThreadPoolTest, WorkersDoNotOverlap) {
+  InterOpThreadPool pool(3);
+  std::vector<std::atomic<int>> active(pool.num_threads());
+  for (auto& a : active) a = 0;
+  std::atomic<int> total{0};
+  for (int job = 0; job < 50; ++job) {
+    pool.ParallelFor(16, [&](int worker, int index) {
+      EXPECT_EQ(active[worker]++, 0);
+      total += index;
+      active[worker]--;
+    });
+  }
+  EXPECT_EQ(total, 50 * (15 * 16 / 2));
+}
+
+TEST(InterOpThreadPoolTest, SingleThreadRunsInline) {
+  InterOpThreadPool pool(0);
+  EXPECT_EQ(pool.num_threads(), 1);
+  std::vector<int> order;
+  pool.ParallelFor(3, [&order](int worker, int index) {
+    EXPECT_EQ(worker, 0);
+    order.push_back(index);
+  });
+  EXPECT_THAT(order, ::testing::ElementsAre(0, 1, 2));
+}
+
+}  // namespace
+}  // namespace tflite
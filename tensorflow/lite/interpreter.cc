@@ -463,6 +463,11 @@ TfLiteStatus Interpreter::ApplyOptionsImpl(InterpreterOptions* options) {
         options->GetDynamicAllocationForLargeTensors());
     main_subgraph->EnsureDynamicTensorsAreReleased();
   }
+
+  // Handle `experimental_inter_op_parallelism_`.
+  if (options->GetInterOpParallelism() > 1) {
+    subgraphs_[0]->SetInterOpParallelism(options->GetInterOpParallelism());
+  }
   return kTfLiteOk;
 }
 
@@ -70,7 +70,8 @@ class InterpreterOptions {
   InterpreterOptions()
       : experimental_preserve_all_tensors_(false),
         experimental_ensure_dynamic_tensors_are_released_(false),
-        experimental_dynamic_allocation_for_large_tensors_(0) {}
+        experimental_dynamic_allocation_for_large_tensors_(0),
+        experimental_inter_op_parallelism_(1) {}
 
   /// Preserving all intermediates tensors for debugging.
   /// WARNING: This is an experimental API and subject to change.
@@ -115,10 +116,24 @@ class InterpreterOptions {
     return experimental_dynamic_allocation_for_large_tensors_;
   }
 
+  /// Run independent nodes of the primary subgraph concurrently on up to
+  /// `num_threads` threads. Each concurrently running kernel uses a single
+  /// thread of its own, so this mostly helps graphs with parallel branches of
+  /// small ops. Values <= 1 keep the default sequential execution.
+  /// WARNING: This is an experimental API and subject to change.
+  void SetInterOpParallelism(int num_threads) {
+    experimental_inter_op_parallelism_ = num_threads > 1 ? num_threads : 1;
+  }
+
+  /// Returns the number of threads used to run independent nodes.
+  /// WARNING: This is an experimental API and subject to change.
+  int GetInterOpParallelism() { return experimental_inter_op_parallelism_; }
+
  private:
   bool experimental_preserve_all_tensors_;
   bool experimental_ensure_dynamic_tensors_are_released_;
   int experimental_dynamic_allocation_for_large_tensors_;
+  int experimental_inter_op_parallelism_;
 };
 
 /// An interpreter for a graph of nodes that input and output from tensors.
@@ -1113,6 +1113,61 @@ TEST(BasicInterpreter, ReleaseDynamicTensors) {
   ASSERT_EQ(interpreter.tensor(3)->bytes, sizeof(float) * 6 * 6);
 }
 
+TEST(BasicInterpreter, InterOpParallelism) {
+  // Two branches, neg(neg(x)) and abs(x), joined by an add. The abs node does
+  // not depend on the first branch, so it can run alongside its first node.
+  auto build = [](Interpreter* interpreter, int num_threads) {
+    InterpreterOptions options;
+    options.SetInterOpParallelism(num_threads);
+    interpreter->ApplyOptions(&options);
+    interpreter->AddTensors(5);
+    interpreter->SetInputs({0});
+    interpreter->SetOutputs({4});
+    TfLiteQuantizationParams quant;
+    for (int i = 0; i < 5; ++i) {
+      interpreter->SetTensorParametersReadWrite(
+          /*tensor_index=*/i, /*type=*/kTfLiteFloat32, /*name=*/"",
+          /*dims=*/{2}, /*quantization=*/quant);
+    }
+    TfLiteRegistration* neg_op = tflite::ops::builtin::Register_NEG();
+    TfLiteRegistration* abs_op = tflite::ops::builtin::Register_ABS();
+    TfLiteRegistration* add_op = tflite::ops::builtin::Register_ADD();
+    auto* add_params =
+        reinterpret_cast<TfLiteAddParams*>(malloc(sizeof(TfLiteAddParams)));
+    add_params->activation = kTfLiteActNone;
+    add_params->pot_scale_int16 = false;
+    interpreter->AddNodeWithParameters({0}, {1}, nullptr, 0, nullptr, neg_op);
+    interpreter->AddNodeWithParameters({1}, {2}, nullptr, 0, nullptr, neg_op);
+    interpreter->AddNodeWithParameters({0}, {3}, nullptr, 0, nullptr, abs_op);
+    interpreter->AddNodeWithParameters({2, 3}, {4}, nullptr, 0, add_params,
+                                       add_op);
+  };
+
+  Interpreter sequential;
+  build(&sequential, 1);
+  ASSERT_EQ(sequential.AllocateTensors(), kTfLiteOk);
+  EXPECT_THAT(sequential.execution_plan(), testing::ElementsAre(0, 1, 2, 3));
+
+  Interpreter concurrent;
+  build(&concurrent, 2);
+  ASSERT_EQ(concurrent.AllocateTensors(), kTfLiteOk);
+  EXPECT_THAT(concurrent.execution_plan(), testing::ElementsAre(0, 2, 1, 3));
+
+  for (int run = 0; run < 10; ++run) {
+    const float x[] = {1.0f * run, -2.0f};
+    for (Interpreter* interpreter : {&sequential, &concurrent}) {
+      memcpy(interpreter->typed_tensor<float>(0), x, sizeof(x));
+      ASSERT_EQ(interpreter->Invoke(), kTfLiteOk);
+    }
+    const float* expected = sequential.typed_tensor<float>(4);
+    const float* actual = concurrent.typed_tensor<float>(4);
+    EXPECT_EQ(expected[0], 2.0f * run);
+    EXPECT_EQ(expected[1], 0.0f);
+    EXPECT_EQ(actual[0], expected[0]);
+    EXPECT_EQ(actual[1], expected[1]);
+  }
+}
+
 TEST(InterpreterTensorsCapacityTest, TestWithinHeadroom) {
   Interpreter interpreter;
   ASSERT_EQ(interpreter.AddTensors(Interpreter::kTensorsReservedCapacity),
@@ -21,6 +21,7 @@ limitations under the License.
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
+#include "tensorflow/lite/kernels/shared_constant_cache.h"
 
 namespace tflite {
 namespace ops {
@@ -50,11 +51,44 @@ void Free(TfLiteContext* context, void* buffer) {
   delete reinterpret_cast<OpData*>(buffer);
 }
 
+TfLiteStatus DensifyImpl(TfLiteContext* context, const TfLiteTensor* input,
+                         TfLiteTensor* output) {
+  switch (input->type) {
+    case kTfLiteFloat32:
+      reference_ops::Densify(input->sparsity, GetTensorShape(input),
+                             GetTensorData<float>(input),
+                             GetTensorShape(output),
+                             GetTensorData<float>(output), context);
+      break;
+    case kTfLiteFloat16:
+      reference_ops::Densify(input->sparsity, GetTensorShape(input),
+                             GetTensorData<Eigen::half>(input),
+                             GetTensorShape(output),
+                             GetTensorData<Eigen::half>(output), context);
+      break;
+    case kTfLiteInt8:
+      reference_ops::Densify(input->sparsity, GetTensorShape(input),
+                             GetTensorData<int8_t>(input),
+                             GetTensorShape(output),
+                             GetTensorData<int8_t>(output), context);
+      break;
+
+    default:
+      context->ReportError(context, "Type %d not supported.", input->type);
+      return kTfLiteError;
+  }
+  return kTfLiteOk;
+}
+
 TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   TF_LITE_ENSURE_EQ(context, NumInputs(node), 1);
   TF_LITE_ENSURE_EQ(context, NumOutputs(node), 1);
 
   OpContext op_context(context, node);
+  // The output was mapped from the shared constant cache by an earlier call.
+  if (op_context.output->allocation_type == kTfLiteMmapRo) {
+    return kTfLiteOk;
+  }
 
   TF_LITE_ENSURE(context, op_context.input->type != kTfLiteString);
   TF_LITE_ENSURE(context, IsConstantTensor(op_context.input));
@@ -63,8 +97,18 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   op_context.output->type = op_context.input->type;
   op_context.output->allocation_type = kTfLiteArenaRwPersistent;
 
-  return context->ResizeTensor(context, op_context.output,
-                               TfLiteIntArrayCopy(op_context.input->dims));
+  TF_LITE_ENSURE_OK(
+      context, context->ResizeTensor(context, op_context.output,
+                                     TfLiteIntArrayCopy(op_context.input->dims)));
+
+  // Dense weights can be shared between processes instead.
+  OpData* op_data = reinterpret_cast<OpData*>(node->user_data);
+  return MapDerivedConstantTensor(
+      context, "densify", op_context.input, op_context.output,
+      [context, &op_context](TfLiteTensor* output) {
+        return DensifyImpl(context, op_context.input, output);
+      },
+      &op_data->dense_weights_initialized);
 }
 
 TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
@@ -74,35 +118,8 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
     return kTfLiteOk;
   }
 
-  switch (op_context.input->type) {
-    case kTfLiteFloat32:
-      reference_ops::Densify(op_context.input->sparsity,
-                             GetTensorShape(op_context.input),
-                             GetTensorData<float>(op_context.input),
-                             GetTensorShape(op_context.output),
-                             GetTensorData<float>(op_context.output), context);
-      break;
-    case kTfLiteFloat16:
-      reference_ops::Densify(
-          op_context.input->sparsity, GetTensorShape(op_context.input),
-          GetTensorData<Eigen::half>(op_context.input),
-          GetTensorShape(op_context.output),
-          GetTensorData<Eigen::half>(op_context.output), context);
-      break;
-    case kTfLiteInt8:
-      reference_ops::Densify(op_context.input->sparsity,
-                             GetTensorShape(op_context.input),
-                             GetTensorData<int8_t>(op_context.input),
-                             GetTensorShape(op_context.output),
-                             GetTensorData<int8_t>(op_context.output), context);
-      break;
-
-    default:
-      context->ReportError(context, "Type %d not supported.",
-                           op_context.input->type);
-      return kTfLiteError;
-  }
-
+  TF_LITE_ENSURE_OK(context,
+                    DensifyImpl(context, op_context.input, op_context.output));
   op_data->dense_weights_initialized = true;
   return kTfLiteOk;
 }
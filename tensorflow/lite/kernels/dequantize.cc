@@ -19,6 +19,7 @@ limitations under the License.
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/kernels/internal/optimized/neon_check.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
+#include "tensorflow/lite/kernels/shared_constant_cache.h"
 
 namespace tflite {
 namespace ops {
@@ -54,6 +55,10 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   TF_LITE_ENSURE_EQ(context, NumOutputs(node), 1);
 
   OpContext op_context(context, node);
+  // The output was mapped from the shared constant cache by an earlier call.
+  if (op_context.output->allocation_type == kTfLiteMmapRo) {
+    return kTfLiteOk;
+  }
 
   TF_LITE_ENSURE(context, op_context.input->type == kTfLiteUInt8 ||
                               op_context.input->type == kTfLiteInt8 ||
@@ -70,8 +75,24 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   if (IsConstantTensor(op_context.input)) {
     op_context.output->allocation_type = kTfLiteArenaRwPersistent;
   }
-  return context->ResizeTensor(context, op_context.output,
-                               TfLiteIntArrayCopy(op_context.input->dims));
+  TF_LITE_ENSURE_OK(
+      context, context->ResizeTensor(context, op_context.output,
+                                     TfLiteIntArrayCopy(op_context.input->dims)));
+
+  // Dequantized constants can be shared between processes instead.
+  if (IsConstantTensor(op_context.input)) {
+    OpData* op_data = reinterpret_cast<OpData*>(node->user_data);
+    TF_LITE_ENSURE_OK(
+        context,
+        MapDerivedConstantTensor(
+            context, "dequantize", op_context.input, op_context.output,
+            [context, node, &op_context](TfLiteTensor* output) {
+              return DequantizeImpl<kReference>(context, node,
+                                                op_context.input, output);
+            },
+            &op_data->float_dequantized_weights_initialized));
+  }
+  return kTfLiteOk;
 }
 
 template <KernelType kernel_type>
@@ -1561,6 +1561,39 @@ TEST_P(SparseFullyConnectedOpTest, Simple1x4TestMultiThreaded) {
   }
 }
 
+TEST_P(SparseFullyConnectedOpTest, Simple1x4TestMultiThreadedSingleBatch) {
+  std::initializer_list<float> weight_data = {
+      1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12,  // u = 0
+      0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  0,  0,   // u = 1
+      1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12,  // u = 2
+      1, 2, 3, 4, 0, 0, 0, 0, 0, 0,  0,  0,   // u = 3
+  };
+  TensorData weight = {};
+  weight.type = TensorType_FLOAT32;
+  weight.shape = {4, 12};
+  weight.traversal_order = {0, 1, 2};
+  weight.format = {kTfLiteDimDense, kTfLiteDimSparseCSR};
+  weight.block_map = {1};
+  weight.block_size = {4};
+  // With a single batch the work is split along the rows of the weights.
+  for (int num_threads = 1; num_threads <= 5; num_threads++) {
+    SparseFullyConnectedOpModel<float> m(
+        GetRegistration(),
+        /*units=*/4, /*batches=*/1,
+        /*input=*/{TensorType_FLOAT32, {1, 12}}, weight, weight_data,
+        /*output=*/{TensorType_FLOAT32},
+        /*bias_tensor_optional=*/false, /*num_threads=*/num_threads);
+    m.SetBias({1, 2, 3, 4});
+
+    m.SetInput({1, 2, 3, 4, 5, 6, 7, 8, -9, -10, 11, 12});
+
+    ASSERT_EQ(m.InvokeUnchecked(), kTfLiteOk);
+
+    EXPECT_THAT(m.GetOutputShape(), ElementsAre(1, 4));
+    EXPECT_THAT(m.GetOutput(), ElementsAre(289, 2, 291, 34));
+  }
+}
+
 TEST_P(SparseFullyConnectedOpTest, Simple1x4TestMultiThreadedMoreBatches) {
   std::initializer_list<float> weight_data = {
       1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12,  // u = 0
@@ -1816,6 +1849,45 @@ TEST_P(SparseQuantizedFullyConnectedOpTest, Simple1x16Test) {
   EXPECT_THAT(m.GetOutput(), ElementsAre(11, 2, 25, 0, 2, 21));
 }
 
+TEST_P(SparseQuantizedFullyConnectedOpTest, Simple1x16TestMultiThreaded) {
+  std::vector<float> weight_data = {
+      1,  2,  3,  4,  -1, -2, -3, -4, 1,  2,  3,  4, -4, -3, -2, -1,  // u = 0
+      0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0, 0,  0,  0,  0,   // u = 1
+      -1, -2, -3, -4, 4,  3,  2,  1,  -1, -2, -3, 4, 1,  2,  3,  4,   // u = 2
+  };
+  TensorData weight = {TensorType_INT8, {3, 16}, 0, 0, 1};
+  weight.traversal_order = {0, 1, 2};
+  weight.format = {kTfLiteDimDense, kTfLiteDimSparseCSR};
+  weight.block_map = {1};
+  weight.block_size = {16};
+  for (int batches : {1, 2}) {
+    for (int num_threads = 1; num_threads <= 4; num_threads++) {
+      SparseQuantizedFullyConnectedOpModel m(
+          GetRegistration(),
+          /*units=*/3, batches,
+          /*input=*/{TensorType_INT8, {batches, 16}, 0, 0, 1}, weight,
+          weight_data,
+          /*output=*/{TensorType_INT8, {}, 0, 0, 1},
+          /*bias_tensor_optional=*/false, num_threads);
+
+      m.SetBias({1, 2, 3});
+      std::vector<float> input = {
+          1, 2, 3, 4, 1, 2, 3, 4, 1, 2, 3, 4, 1, 2, 3, 4,  // b = 0
+          4, 3, 2, 1, 4, 3, 2, 1, 4, 3, 2, 1, 4, 3, 2, 1,  // b = 1
+      };
+      input.resize(batches * 16);
+      m.SetInput(input);
+
+      ASSERT_EQ(m.InvokeUnchecked(), kTfLiteOk);
+
+      EXPECT_THAT(m.GetOutputShape(), ElementsAre(batches, 3));
+      std::vector<int8_t> expected = {11, 2, 25, 0, 2, 21};
+      expected.resize(batches * 3);
+      EXPECT_THAT(m.GetOutput(), ElementsAreArray(expected));
+    }
+  }
+}
+
 TEST_P(SparseQuantizedFullyConnectedOpTest, Simple1x16TestNoBias) {
   std::vector<float> weight_data = {
       1,  2,  3,  4,  -1, -2, -3, -4, 1,  2,  3,  4, -4, -3, -2, -1,  // u = 0
@@ -80,9 +80,11 @@ inline void FullyConnectedSparseWeight1x16Impl(
     const RuntimeShape& weights_shape, const int8_t* weights_data,
     const RuntimeShape& bias_shape, const int32_t* bias_data,
     const RuntimeShape& output_shape, int8_t* output_data, int thread_start,
-    int thread_end, const CpuBackendContext& cpu_backend_context) {
+    int thread_end, int row_start, int row_end,
+    const CpuBackendContext& cpu_backend_context) {
   ruy::profiler::ScopeLabel label("FullyConnected");
   ruy::profiler::ScopeLabel inner_label("1x16 Block Sparse");
+  constexpr int kBlockSize = 16;
 
   const int input_dims_count = input_shape.DimensionsCount();
   const int output_dims_count = output_shape.DimensionsCount();
@@ -102,12 +104,29 @@ inline void FullyConnectedSparseWeight1x16Impl(
   const int* w1_segments = sparsity.dim_metadata[1].array_segments->data;
   const int* w1_indices = sparsity.dim_metadata[1].array_indices->data;
 
-  tensor_utils::SparseMatrixBatchVectorMultiplyAccumulate1x16(
-      weights_data, w1_segments, w1_indices, weights_shape.Dims(0),
-      weights_shape.Dims(1), input_data + thread_start * input_depth, bias_data,
-      batches, input_offset, output_multiplier, output_shift, output_offset,
-      output_activation_min, output_activation_max,
-      output_data + thread_start * output_depth);
+  if (row_start == 0 && row_end == output_depth) {
+    tensor_utils::SparseMatrixBatchVectorMultiplyAccumulate1x16(
+        weights_data, w1_segments, w1_indices, weights_shape.Dims(0),
+        weights_shape.Dims(1), input_data + thread_start * input_depth,
+        bias_data, batches, input_offset, output_multiplier, output_shift,
+        output_offset, output_activation_min, output_activation_max,
+        output_data + thread_start * output_depth);
+    return;
+  }
+  // A slice of rows is a smaller sparse matrix whose blocks start at the
+  // slice's first segment. Its output rows are strided by `output_depth`, so
+  // run it one batch at a time.
+  const int8_t* slice_weights =
+      weights_data + w1_segments[row_start] * kBlockSize;
+  const int32_t* slice_bias = bias_data ? bias_data + row_start : nullptr;
+  for (int b = thread_start; b < thread_end; ++b) {
+    tensor_utils::SparseMatrixBatchVectorMultiplyAccumulate1x16(
+        slice_weights, w1_segments + row_start, w1_indices, row_end - row_start,
+        weights_shape.Dims(1), input_data + b * input_depth, slice_bias,
+        /*n_batch=*/1, input_offset, output_multiplier, output_shift,
+        output_offset, output_activation_min, output_activation_max,
+        output_data + b * output_depth + row_start);
+  }
 }
 
 inline void FullyConnectedSparseWeight1x4Impl(
@@ -116,9 +135,11 @@ inline void FullyConnectedSparseWeight1x4Impl(
     const RuntimeShape& weights_shape, const float* weights_data,
     const RuntimeShape& bias_shape, const float* bias_data,
     const RuntimeShape& output_shape, float* output_data, int thread_start,
-    int thread_end, const CpuBackendContext& cpu_backend_context) {
+    int thread_end, int row_start, int row_end,
+    const CpuBackendContext& cpu_backend_context) {
   ruy::profiler::ScopeLabel label("FullyConnected");
   ruy::profiler::ScopeLabel inner_label("1x4 Block Sparse");
+  constexpr int kBlockSize = 4;
   const float output_activation_min = params.float_activation_min;
   const float output_activation_max = params.float_activation_max;
 
@@ -133,14 +154,27 @@ inline void FullyConnectedSparseWeight1x4Impl(
   const int* w1_segments = sparsity.dim_metadata[1].array_segments->data;
   const int* w1_indices = sparsity.dim_metadata[1].array_indices->data;
 
-  tensor_utils::SparseMatrixBatchVectorMultiplyAccumulate1x4(
-      weights_data, w1_segments, w1_indices, weights_shape.Dims(0),
-      weights_shape.Dims(1), input_data + thread_start * input_depth, batches,
-      output_data + thread_start * output_depth);
+  if (row_start == 0 && row_end == output_depth) {
+    tensor_utils::SparseMatrixBatchVectorMultiplyAccumulate1x4(
+        weights_data, w1_segments, w1_indices, weights_shape.Dims(0),
+        weights_shape.Dims(1), input_data + thread_start * input_depth,
+        batches, output_data + thread_start * output_depth);
+  } else {
+    // See FullyConnectedSparseWeight1x16Impl.
+    const float* slice_weights =
+        weights_data + w1_segments[row_start] * kBlockSize;
+    for (int b = thread_start; b < thread_end; ++b) {
+      tensor_utils::SparseMatrixBatchVectorMultiplyAccumulate1x4(
+          slice_weights, w1_segments + row_start, w1_indices,
+          row_end - row_start, weights_shape.Dims(1),
+          input_data + b * input_depth, /*n_batch=*/1,
+          output_data + b * output_depth + row_start);
+    }
+  }
 
   ruy::profiler::ScopeLabel activation_label("activation function");
   for (int b = thread_start; b < thread_end; ++b) {
-    for (int i = 0; i < output_depth; ++i) {
+    for (int i = row_start; i < row_end; ++i) {
       float total = output_data[b * output_depth + i];
       const float bias_value = bias_data ? bias_data[i] : 0;
       output_data[b * output_depth + i] = ActivationFunctionWithMinMax(
@@ -149,15 +183,27 @@ inline void FullyConnectedSparseWeight1x4Impl(
   }
 }
 
-struct FullyConnectedSparseWeight1x4Task : cpu_backend_threadpool::Task {
-  FullyConnectedSparseWeight1x4Task(
-      const TfLiteSparsity& sparsity, const FullyConnectedParams& params,
-      const RuntimeShape& input_shape, const float* input_data,
-      const RuntimeShape& weights_shape, const float* weights_data,
-      const RuntimeShape& bias_shape, const float* bias_data,
-      const RuntimeShape& output_shape, float* output_data, int thread_start,
-      int thread_end, const CpuBackendContext& cpu_backend_context_x)
-      : sparsity(sparsity),
+template <typename InputScalar, typename WeightsScalar, typename BiasScalar,
+          typename OutputScalar>
+struct FullyConnectedSparseWeightBlockTask : cpu_backend_threadpool::Task {
+  using ImplFn = void (*)(const TfLiteSparsity&, const FullyConnectedParams&,
+                          const RuntimeShape&, const InputScalar*,
+                          const RuntimeShape&, const WeightsScalar*,
+                          const RuntimeShape&, const BiasScalar*,
+                          const RuntimeShape&, OutputScalar*, int, int, int,
+                          int, const CpuBackendContext&);
+
+  FullyConnectedSparseWeightBlockTask(
+      ImplFn impl, const TfLiteSparsity& sparsity,
+      const FullyConnectedParams& params, const RuntimeShape& input_shape,
+      const InputScalar* input_data, const RuntimeShape& weights_shape,
+      const WeightsScalar* weights_data, const RuntimeShape& bias_shape,
+      const BiasScalar* bias_data, const RuntimeShape& output_shape,
+      OutputScalar* output_data, int thread_start, int thread_end,
+      int row_start, int row_end,
+      const CpuBackendContext& cpu_backend_context_x)
+      : impl(impl),
+        sparsity(sparsity),
         params(params),
         input_shape(input_shape),
         input_data(input_data),
@@ -169,31 +215,110 @@ struct FullyConnectedSparseWeight1x4Task : cpu_backend_threadpool::Task {
         output_data(output_data),
         thread_start(thread_start),
         thread_end(thread_end),
+        row_start(row_start),
+        row_end(row_end),
         cpu_backend_context(cpu_backend_context_x) {}
 
   void Run() override {
-    FullyConnectedSparseWeight1x4Impl(
-        sparsity, params, input_shape, input_data, weights_shape, weights_data,
-        bias_shape, bias_data, output_shape, output_data, thread_start,
-        thread_end, cpu_backend_context);
+    impl(sparsity, params, input_shape, input_data, weights_shape, weights_data,
+         bias_shape, bias_data, output_shape, output_data, thread_start,
+         thread_end, row_start, row_end, cpu_backend_context);
   }
 
  private:
+  ImplFn impl;
   const TfLiteSparsity& sparsity;
   const FullyConnectedParams& params;
   const RuntimeShape& input_shape;
-  const float* input_data;
+  const InputScalar* input_data;
   const RuntimeShape& weights_shape;
-  const float* weights_data;
+  const WeightsScalar* weights_data;
   const RuntimeShape& bias_shape;
-  const float* bias_data;
+  const BiasScalar* bias_data;
   const RuntimeShape& output_shape;
-  float* output_data;
+  OutputScalar* output_data;
   int thread_start;
   int thread_end;
+  int row_start;
+  int row_end;
   const CpuBackendContext& cpu_backend_context;
 };
 
+// Runs a block sparse kernel on the cpu backend thread pool. With at least as
+// many batches as threads the work is sliced along the batch dimension.
+// Otherwise, which includes the common single-batch case, it is sliced along
+// the rows of the weights, balancing the number of non-zero blocks per thread
+// so that every thread streams a similar share of the weights.
+template <typename InputScalar, typename WeightsScalar, typename BiasScalar,
+          typename OutputScalar>
+inline void FullyConnectedSparseWeightBlockMultiThreaded(
+    typename FullyConnectedSparseWeightBlockTask<
+        InputScalar, WeightsScalar, BiasScalar, OutputScalar>::ImplFn impl,
+    const TfLiteSparsity& sparsity, const FullyConnectedParams& params,
+    const RuntimeShape& input_shape, const InputScalar* input_data,
+    const RuntimeShape& weights_shape, const WeightsScalar* weights_data,
+    const RuntimeShape& bias_shape, const BiasScalar* bias_data,
+    const RuntimeShape& output_shape, OutputScalar* output_data,
+    CpuBackendContext* cpu_backend_context) {
+  using Task = FullyConnectedSparseWeightBlockTask<InputScalar, WeightsScalar,
+                                                   BiasScalar, OutputScalar>;
+  const int max_threads = cpu_backend_context->max_num_threads();
+  const int batches =
+      FlatSizeSkipDim(output_shape, output_shape.DimensionsCount() - 1);
+  const int rows = weights_shape.Dims(0);
+  const int* w1_segments = sparsity.dim_metadata[1].array_segments->data;
+
+  std::vector<Task> tasks;
+  if (batches >= max_threads || rows < 2) {
+    const int thread_count = std::max(1, std::min(batches, max_threads));
+    if (thread_count == 1) {
+      return impl(sparsity, params, input_shape, input_data, weights_shape,
+                  weights_data, bias_shape, bias_data, output_shape,
+                  output_data, 0, batches, 0, rows, *cpu_backend_context);
+    }
+    tasks.reserve(thread_count);
+    int thread_start = 0;
+    for (int i = 0; i < thread_count; ++i) {
+      // This makes sure the workload is relatively balanced when batches is
+      // not a multiple of thread_count. The first mod(batches, thread_count)
+      // tasks need to process one more batch than the rest.
+      int thread_end = thread_start + batches / thread_count;
+      if (i < batches % thread_count) thread_end++;
+
+      tasks.emplace_back(impl, sparsity, params, input_shape, input_data,
+                         weights_shape, weights_data, bias_shape, bias_data,
+                         output_shape, output_data, thread_start, thread_end,
+                         0, rows, *cpu_backend_context);
+      thread_start = thread_end;
+    }
+  } else {
+    const int thread_count = std::min(rows, max_threads);
+    const int total_blocks = w1_segments[rows];
+    tasks.reserve(thread_count);
+    int row_start = 0;
+    for (int i = 0; i < thread_count; ++i) {
+      // End the slice once it holds its share of the non-zero blocks, but
+      // leave at least one row to every later slice.
+      const int64_t target_blocks =
+          static_cast<int64_t>(total_blocks) * (i + 1) / thread_count;
+      int row_end = row_start + 1;
+      while (row_end < rows - (thread_count - 1 - i) &&
+             w1_segments[row_end] < target_blocks) {
+        row_end++;
+      }
+      if (i == thread_count - 1) row_end = rows;
+
+      tasks.emplace_back(impl, sparsity, params, input_shape, input_data,
+                         weights_shape, weights_data, bias_shape, bias_data,
+                         output_shape, output_data, 0, batches, row_start,
+                         row_end, *cpu_backend_context);
+      row_start = row_end;
+    }
+  }
+  cpu_backend_threadpool::Execute(tasks.size(), tasks.data(),
+                                  cpu_backend_context);
+}
+
 inline void FullyConnectedSparseWeight1x16(
     const TfLiteSparsity& sparsity, const FullyConnectedParams& params,
     const RuntimeShape& input_shape, const int8_t* input_data,
@@ -204,20 +329,13 @@ inline void FullyConnectedSparseWeight1x16(
   const int output_elements = output_shape.FlatSize();
   memset(output_data, 0, output_elements * sizeof(int8_t));
 
-  const int batches =
-      FlatSizeSkipDim(output_shape, output_shape.DimensionsCount() - 1);
-
-  // TODO(b/220851507): Add multi-thread support for quantized sparse kernel.
-  return FullyConnectedSparseWeight1x16Impl(
-      sparsity, params, input_shape, input_data, weights_shape, weights_data,
-      bias_shape, bias_data, output_shape, output_data, 0, batches,
-      *cpu_backend_context);
+  FullyConnectedSparseWeightBlockMultiThreaded<int8_t, int8_t, int32_t,
+                                               int8_t>(
+      FullyConnectedSparseWeight1x16Impl, sparsity, params, input_shape,
+      input_data, weights_shape, weights_data, bias_shape, bias_data,
+      output_shape, output_data, cpu_backend_context);
 }
 
-// The multi-threaded kernel slices the workload along the batch dimension. If
-// there's not enough batches of data, the number of threads used is equal to
-// the batch size. We can improve this later with slicing along the row
-// dimension of the weight.
 inline void FullyConnectedSparseWeight1x4(
     const TfLiteSparsity& sparsity, const FullyConnectedParams& params,
     const RuntimeShape& input_shape, const float* input_data,
@@ -228,34 +346,10 @@ inline void FullyConnectedSparseWeight1x4(
   const int output_elements = output_shape.FlatSize();
   memset(output_data, 0, output_elements * sizeof(float));
 
-  const int max_threads = cpu_backend_context->max_num_threads();
-  const int batches =
-      FlatSizeSkipDim(output_shape, output_shape.DimensionsCount() - 1);
-  const int thread_count = std::max(1, std::min(batches, max_threads));
-  if (thread_count == 1) {
-    return FullyConnectedSparseWeight1x4Impl(
-        sparsity, params, input_shape, input_data, weights_shape, weights_data,
-        bias_shape, bias_data, output_shape, output_data, 0, batches,
-        *cpu_backend_context);
-  }
-  std::vector<FullyConnectedSparseWeight1x4Task> tasks;
-  tasks.reserve(thread_count);
-  int thread_start = 0;
-  for (int i = 0; i < thread_count; ++i) {
-    // This makes sure the workload is relatively balanced when batches is not a
-    // multiple of thread_count. The first mod(batches, thread_count) tasks need
-    // to process one more batch than the rest.
-    int thread_end = thread_start + batches / thread_count;
-    if (i < batches % thread_count) thread_end++;
-
-    tasks.emplace_back(sparsity, params, input_shape, input_data, weights_shape,
-                       weights_data, bias_shape, bias_data, output_shape,
-                       output_data, thread_start, thread_end,
-                       *cpu_backend_context);
-    thread_start = thread_end;
-  }
-  cpu_backend_threadpool::Execute(tasks.size(), tasks.data(),
-                                  cpu_backend_context);
+  FullyConnectedSparseWeightBlockMultiThreaded<float, float, float, float>(
+      FullyConnectedSparseWeight1x4Impl, sparsity, params, input_shape,
+      input_data, weights_shape, weights_data, bias_shape, bias_data,
+      output_shape, output_data, cpu_backend_context);
 }
 
 }  // namespace optimized_ops
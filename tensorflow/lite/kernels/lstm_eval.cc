@@ -26,10 +26,13 @@ limitations under the License.
 #include "tensorflow/lite/c/builtin_op_data.h"
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/kernels/cpu_backend_gemm.h"
+#include "tensorflow/lite/kernels/cpu_backend_gemm_params.h"
 #include "tensorflow/lite/kernels/internal/compatibility.h"
 #include "tensorflow/lite/kernels/internal/kernel_utils.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
 #include "tensorflow/lite/kernels/internal/tensor_utils.h"
+#include "tensorflow/lite/kernels/kernel_util.h"
 #include "tensorflow/lite/kernels/op_macros.h"
 
 namespace tflite {
@@ -139,6 +142,8 @@ inline float GetTensorScale(const TfLiteTensor* tensor) {
 //   cell_to_gate_weights      | n_cell               | y (peephole)
 //   gate_bias                 | n_cell               |
 //   layer_norm_coefficients   | n_cell               | y (layer norm)
+// Precomputed input contribution (see PrecomputeLstmGateInputFloat):
+//   input_gate_contribution   | n_cell               | y
 // Output vector:
 //   gate                      | n_cell               |
 // Scalar parameters:
@@ -147,6 +152,10 @@ inline float GetTensorScale(const TfLiteTensor* tensor) {
 //   activation                                 - activation to use.
 //   is_input_all_zeros, is_aux_input_all_zeros - if input vectors are all zero.
 //   use_layer_norm                             - if doing layer norm LSTM.
+//
+// When input_gate_contribution is given it already holds
+// input_to_gate_weights * input, plus gate_bias unless doing layer norm, and
+// replaces both the bias initialization and the input matrix multiplication.
 inline void CalculateLstmGateFloat(
     const float* input, const float* input_to_gate_weights,
     const float* aux_input, const float* aux_input_to_gate_weights,
@@ -156,20 +165,23 @@ inline void CalculateLstmGateFloat(
     const int n_batch, const int n_input, const int n_aux_input,
     const int n_output, const int n_cell,
     const TfLiteFusedActivation activation, float* gate,
-    const bool is_input_all_zeros, const bool is_aux_input_all_zeros) {
+    const bool is_input_all_zeros, const bool is_aux_input_all_zeros,
+    const float* input_gate_contribution) {
   const bool use_peephole = (cell_to_gate_weights != nullptr);
   const bool use_layer_norm = (layer_norm_coefficients != nullptr);
 
   // Initialize scratch buffers with bias for regular lstm or initialize with
   // zero for layer norm lstm.
-  if (use_layer_norm) {
+  if (input_gate_contribution) {
+    std::copy_n(input_gate_contribution, n_cell * n_batch, gate);
+  } else if (use_layer_norm) {
     std::fill_n(gate, n_cell * n_batch, 0.0f);
   } else {
     tensor_utils::VectorBatchVectorAssign(gate_bias, n_cell, n_batch, gate);
   }
   // For each batch and cell: compute input_weight * input.
-  // Skip if input is all zeros.
-  if (!is_input_all_zeros) {
+  // Skip if input is all zeros or if it has been precomputed.
+  if (!is_input_all_zeros && !input_gate_contribution) {
     tensor_utils::MatrixBatchVectorMultiplyAccumulate(
         input_to_gate_weights, n_cell, n_input, input, n_batch, gate);
   }
@@ -200,6 +212,43 @@ inline void CalculateLstmGateFloat(
                                         gate);
 }
 
+// Computes the input contribution to a gate for a whole sequence at once:
+//   input_gate_contribution = input_to_gate_weights * input (+ gate_bias)
+// for all n_vectors input vectors of size n_input, which must be contiguous.
+// The result holds n_vectors consecutive vectors of size n_cell, laid out like
+// the gate scratch buffers of consecutive steps. The bias is added only when
+// gate_bias is not null, i.e. it must be null for layer norm LSTM.
+//
+// A single GEMM over all time steps replaces n_vectors / n_batch
+// matrix-vector products per gate. Constant weights (is_constant_weights) are
+// prepacked once by the GEMM backend and reused across invocations.
+void PrecomputeLstmGateInputFloat(const float* input_to_gate_weights,
+                                  bool is_constant_weights,
+                                  const float* gate_bias, const float* input,
+                                  int n_vectors, int n_input, int n_cell,
+                                  float* input_gate_contribution,
+                                  CpuBackendContext* context) {
+  cpu_backend_gemm::MatrixParams<float> lhs_params;
+  lhs_params.order = cpu_backend_gemm::Order::kRowMajor;
+  lhs_params.rows = n_cell;
+  lhs_params.cols = n_input;
+  lhs_params.cache_policy =
+      cpu_backend_gemm::DefaultCachePolicy(is_constant_weights);
+  cpu_backend_gemm::MatrixParams<float> rhs_params;
+  rhs_params.order = cpu_backend_gemm::Order::kColMajor;
+  rhs_params.rows = n_input;
+  rhs_params.cols = n_vectors;
+  cpu_backend_gemm::MatrixParams<float> dst_params;
+  dst_params.order = cpu_backend_gemm::Order::kColMajor;
+  dst_params.rows = n_cell;
+  dst_params.cols = n_vectors;
+  cpu_backend_gemm::GemmParams<float, float> gemm_params;
+  gemm_params.bias = gate_bias;
+  cpu_backend_gemm::Gemm(lhs_params, input_to_gate_weights, rhs_params, input,
+                         dst_params, input_gate_contribution, gemm_params,
+                         context);
+}
+
 // Updates the LSTM cell state, used by both float and hybrid LSTM versions.
 //
 // Implements the following formula:
@@ -792,6 +841,13 @@ void CalculateLstmOutputInteger8x8_8(
 //   cell_layer_norm_coefficients_ptr   - optional
 //   output_layer_norm_coefficients_ptr - optional
 //
+// Precomputed input contributions of size 'n_batch * n_cell' (see
+// PrecomputeLstmGateInputFloat), used instead of input_ptr when not null:
+//   input_gate_contribution_ptr       - optional
+//   forget_gate_contribution_ptr      - optional
+//   cell_gate_contribution_ptr        - optional
+//   output_gate_contribution_ptr      - optional
+//
 // The pointers to the cell and output state and the output are updated.
 //
 // The pointers input_ptr, aux_input_ptr, and output_ptr point to data aligned
@@ -831,7 +887,11 @@ inline void LstmStepFloat(
     const TfLiteLSTMParams* params, int n_batch, int n_cell, int n_input,
     int n_aux_input, int n_output, int output_batch_leading_dim,
     float* output_state_ptr, float* cell_state_ptr, float* scratch0,
-    float* scratch1, float* scratch2, float* scratch3, float* output_ptr) {
+    float* scratch1, float* scratch2, float* scratch3,
+    const float* input_gate_contribution_ptr,
+    const float* forget_gate_contribution_ptr,
+    const float* cell_gate_contribution_ptr,
+    const float* output_gate_contribution_ptr, float* output_ptr) {
   ruy::profiler::ScopeLabel label("LstmStepFloat");
   // Since we have already checked that weights are all there or none, we can
   // check the existence of only one to the get the condition.
@@ -843,8 +903,10 @@ inline void LstmStepFloat(
   float* cell_gate_scratch = scratch2;
   float* output_gate_scratch = scratch3;
 
-  // Check if inputs are all zeros so we can skip some computations.
+  // Check if inputs are all zeros so we can skip some computations. This is
+  // not needed when the input contribution has been precomputed.
   const bool is_input_all_zeros =
+      forget_gate_contribution_ptr == nullptr &&
       tensor_utils::IsZeroVector(input_ptr, n_batch * n_input);
   const bool is_aux_input_all_zeros =
       (aux_input_ptr == nullptr ||
@@ -858,7 +920,8 @@ inline void LstmStepFloat(
         cell_to_input_weights_ptr, input_layer_norm_coefficients_ptr,
         input_gate_bias_ptr, n_batch, n_input, n_aux_input, n_output, n_cell,
         /*activation=*/kTfLiteActSigmoid, input_gate_scratch,
-        is_input_all_zeros, is_aux_input_all_zeros);
+        is_input_all_zeros, is_aux_input_all_zeros,
+        input_gate_contribution_ptr);
   }
   // Calculate the forget gate.
   CalculateLstmGateFloat(
@@ -868,7 +931,7 @@ inline void LstmStepFloat(
       cell_to_forget_weights_ptr, forget_layer_norm_coefficients_ptr,
       forget_gate_bias_ptr, n_batch, n_input, n_aux_input, n_output, n_cell,
       /*activation=*/kTfLiteActSigmoid, forget_gate_scratch, is_input_all_zeros,
-      is_aux_input_all_zeros);
+      is_aux_input_all_zeros, forget_gate_contribution_ptr);
   // Calculate the cell update gate.
   CalculateLstmGateFloat(input_ptr, input_to_cell_weights_ptr, aux_input_ptr,
                          aux_input_to_cell_weights_ptr, output_state_ptr,
@@ -877,7 +940,8 @@ inline void LstmStepFloat(
                          cell_layer_norm_coefficients_ptr, cell_gate_bias_ptr,
                          n_batch, n_input, n_aux_input, n_output, n_cell,
                          params->activation, cell_gate_scratch,
-                         is_input_all_zeros, is_aux_input_all_zeros);
+                         is_input_all_zeros, is_aux_input_all_zeros,
+                         cell_gate_contribution_ptr);
   // Update the cell state.
   UpdateLstmCellFloat(n_batch, n_cell, cell_state_ptr, input_gate_scratch,
                       forget_gate_scratch, cell_gate_scratch, use_cifg,
@@ -890,7 +954,7 @@ inline void LstmStepFloat(
       cell_to_output_weights_ptr, output_layer_norm_coefficients_ptr,
       output_gate_bias_ptr, n_batch, n_input, n_aux_input, n_output, n_cell,
       /*activation=*/kTfLiteActSigmoid, output_gate_scratch, is_input_all_zeros,
-      is_aux_input_all_zeros);
+      is_aux_input_all_zeros, output_gate_contribution_ptr);
   // Update the output state.
   CalculateLstmOutputFloat(n_batch, n_cell, n_output, cell_state_ptr,
                            output_gate_scratch, params->activation,
@@ -1712,7 +1776,8 @@ TfLiteStatus EvalFloat(
     const TfLiteTensor* projection_weights, const TfLiteTensor* projection_bias,
     const TfLiteLSTMParams* params, bool forward_sequence, bool time_major,
     int output_offset, TfLiteTensor* scratch_buffer, TfLiteTensor* output_state,
-    TfLiteTensor* cell_state, TfLiteTensor* output) {
+    TfLiteTensor* cell_state, TfLiteTensor* output,
+    CpuBackendContext* context) {
   TF_LITE_ASSERT(input->dims->size >= 2 && input->dims->size <= 3);
   int max_time, n_batch;
   if (input->dims->size == 3) {
@@ -1751,6 +1816,58 @@ TfLiteStatus EvalFloat(
     output_gate_scratch = scratch_buffer_ptr + 3 * n_cell * n_batch;
   }
 
+  // If the scratch buffer has room for the input contribution of every step,
+  // compute it for the whole sequence up front, one GEMM per gate. The per-step
+  // work is then left with the recurrent part only.
+  const int n_gates = use_cifg ? 3 : 4;
+  const int n_vectors = max_time * n_batch;
+  const bool precompute_input =
+      context != nullptr && aux_input == nullptr && max_time > 1 &&
+      scratch_buffer->bytes >=
+          sizeof(float) * n_gates * n_cell * (n_batch + n_vectors);
+  const float* input_gate_contribution = nullptr;
+  const float* forget_gate_contribution = nullptr;
+  const float* cell_gate_contribution = nullptr;
+  const float* output_gate_contribution = nullptr;
+  if (precompute_input) {
+    ruy::profiler::ScopeLabel label("LstmPrecomputeInputFloat");
+    float* contribution_ptr = scratch_buffer_ptr + n_gates * n_cell * n_batch;
+    // With layer norm the bias is added after normalization, so it must not be
+    // folded into the input contribution.
+    const auto precompute = [&](const TfLiteTensor* input_to_gate_weights,
+                                const TfLiteTensor* layer_norm_coefficients,
+                                const TfLiteTensor* gate_bias) {
+      PrecomputeLstmGateInputFloat(
+          GetTensorData<float>(input_to_gate_weights),
+          IsConstantTensor(input_to_gate_weights),
+          layer_norm_coefficients ? nullptr : GetTensorData<float>(gate_bias),
+          GetTensorData<float>(input), n_vectors, n_input, n_cell,
+          contribution_ptr, context);
+      const float* result = contribution_ptr;
+      contribution_ptr += n_vectors * n_cell;
+      return result;
+    };
+    if (!use_cifg) {
+      input_gate_contribution =
+          precompute(input_to_input_weights, input_layer_norm_coefficients,
+                     input_gate_bias);
+    }
+    forget_gate_contribution =
+        precompute(input_to_forget_weights, forget_layer_norm_coefficients,
+                   forget_gate_bias);
+    cell_gate_contribution = precompute(
+        input_to_cell_weights, cell_layer_norm_coefficients, cell_gate_bias);
+    output_gate_contribution =
+        precompute(input_to_output_weights, output_layer_norm_coefficients,
+                   output_gate_bias);
+  }
+  // Returns the precomputed input contribution of the vectors starting at
+  // vector_offset, or nullptr if it has not been precomputed.
+  const auto contribution_at = [n_cell](const float* contribution,
+                                        int vector_offset) -> const float* {
+    return contribution ? contribution + vector_offset * n_cell : nullptr;
+  };
+
   const int output_batch_leading_dim =
       output->dims->data[output->dims->size - 1];
   if (time_major) {
@@ -1798,7 +1915,12 @@ TfLiteStatus EvalFloat(
           n_input, aux_input_size, n_output, output_batch_leading_dim,
           GetTensorData<float>(output_state), GetTensorData<float>(cell_state),
           input_gate_scratch, forget_gate_scratch, cell_gate_scratch,
-          output_gate_scratch, output_ptr);
+          output_gate_scratch,
+          contribution_at(input_gate_contribution, t_rel * n_batch),
+          contribution_at(forget_gate_contribution, t_rel * n_batch),
+          contribution_at(cell_gate_contribution, t_rel * n_batch),
+          contribution_at(output_gate_contribution, t_rel * n_batch),
+          output_ptr);
     }
   } else {
     for (int b = 0; b < n_batch; b++) {
@@ -1859,7 +1981,12 @@ TfLiteStatus EvalFloat(
             n_cell, n_input, aux_input_size, n_output, output_batch_leading_dim,
             output_state_ptr, cell_state_ptr, input_gate_scratch_ptr,
             forget_gate_scratch_ptr, cell_gate_scratch_ptr,
-            output_gate_scratch_ptr, output_ptr);
+            output_gate_scratch_ptr,
+            contribution_at(input_gate_contribution, time_offset),
+            contribution_at(forget_gate_contribution, time_offset),
+            contribution_at(cell_gate_contribution, time_offset),
+            contribution_at(output_gate_contribution, time_offset),
+            output_ptr);
       }
     }
   }
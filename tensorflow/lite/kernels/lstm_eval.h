@@ -95,6 +95,10 @@ struct IntegerLstmParameter {
   int32_t intermediate_zp[12];
 };
 
+// If `scratch_buffer` has room for max_time + 1 batches of gate scratch (see
+// the unidirectional sequence LSTM) and `context` is given, the input
+// contribution to all gates is computed for the whole sequence up front, using
+// one GEMM per gate, instead of one matrix-vector product per gate and step.
 TfLiteStatus EvalFloat(
     const TfLiteTensor* input, const TfLiteTensor* input_to_input_weights,
     const TfLiteTensor* input_to_forget_weights,
@@ -121,7 +125,8 @@ TfLiteStatus EvalFloat(
     const TfLiteTensor* projection_weights, const TfLiteTensor* projection_bias,
     const TfLiteLSTMParams* params, bool forward_sequence, bool time_major,
     int output_offset, TfLiteTensor* scratch_buffer, TfLiteTensor* output_state,
-    TfLiteTensor* cell_state, TfLiteTensor* output);
+    TfLiteTensor* cell_state, TfLiteTensor* output,
+    CpuBackendContext* context);
 
 TfLiteStatus EvalHybrid(
     const TfLiteTensor* input, const TfLiteTensor* input_to_input_weights,
@@ -0,0 +1,228 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/kernels/shared_constant_cache.h"
+
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <utility>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  // !defined(_WIN32)
+
+#include "tensorflow/lite/c/common.h"
+
+namespace tflite {
+namespace {
+
+TfLiteStatus RefreshSharedConstantCache(TfLiteContext* context) {
+  return kTfLiteOk;
+}
+
+// 64-bit FNV-1a.
+class Fingerprint {
+ public:
+  void Add(const void* data, size_t size) {
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; ++i) {
+      hash_ = (hash_ ^ bytes[i]) * 0x100000001b3ULL;
+    }
+  }
+  template <typename T>
+  void Add(const T& value) {
+    Add(&value, sizeof(value));
+  }
+  void AddArray(const TfLiteIntArray* array) {
+    if (array == nullptr) {
+      Add(-1);
+      return;
+    }
+    Add(array->size);
+    Add(array->data, array->size * sizeof(array->data[0]));
+  }
+  void AddArray(const TfLiteFloatArray* array) {
+    if (array == nullptr) {
+      Add(-1);
+      return;
+    }
+    Add(array->size);
+    Add(array->data, array->size * sizeof(array->data[0]));
+  }
+
+  uint64_t hash() const { return hash_; }
+
+ private:
+  uint64_t hash_ = 0xcbf29ce484222325ULL;
+};
+
+}  // namespace
+
+SharedConstantCache::SharedConstantCache(std::string directory)
+    : directory_(std::move(directory)) {
+  type = kTfLiteSharedConstantCacheContext;
+  Refresh = RefreshSharedConstantCache;
+}
+
+SharedConstantCache::~SharedConstantCache() {
+#if !defined(_WIN32)
+  for (const auto& mapping : mappings_) {
+    munmap(mapping.first, mapping.second);
+  }
+#endif  // !defined(_WIN32)
+}
+
+SharedConstantCache* SharedConstantCache::GetFromContext(
+    TfLiteContext* context) {
+  return static_cast<SharedConstantCache*>(
+      context->GetExternalContext(context, kTfLiteSharedConstantCacheContext));
+}
+
+std::string SharedConstantCache::Key(const char* op_name,
+                                     const TfLiteTensor& input,
+                                     const TfLiteTensor& output) {
+  Fingerprint fingerprint;
+  fingerprint.Add(input.type);
+  fingerprint.AddArray(input.dims);
+  fingerprint.Add(input.bytes);
+  if (input.data.raw != nullptr) {
+    fingerprint.Add(input.data.raw, input.bytes);
+  }
+  fingerprint.Add(input.params);
+  fingerprint.Add(input.quantization.type);
+  if (input.quantization.type == kTfLiteAffineQuantization) {
+    const auto* params = static_cast<const TfLiteAffineQuantization*>(
+        input.quantization.params);
+    if (params != nullptr) {
+      fingerprint.AddArray(params->scale);
+      fingerprint.AddArray(params->zero_point);
+      fingerprint.Add(params->quantized_dimension);
+    }
+  }
+  if (input.sparsity != nullptr) {
+    const TfLiteSparsity& sparsity = *input.sparsity;
+    fingerprint.AddArray(sparsity.traversal_order);
+    fingerprint.AddArray(sparsity.block_map);
+    fingerprint.Add(sparsity.dim_metadata_size);
+    for (int i = 0; i < sparsity.dim_metadata_size; ++i) {
+      const TfLiteDimensionMetadata& metadata = sparsity.dim_metadata[i];
+      fingerprint.Add(metadata.format);
+      fingerprint.Add(metadata.dense_size);
+      fingerprint.AddArray(metadata.array_segments);
+      fingerprint.AddArray(metadata.array_indices);
+    }
+  }
+  fingerprint.Add(output.type);
+  fingerprint.AddArray(output.dims);
+
+  char hash[17];
+  snprintf(hash, sizeof(hash), "%016" PRIx64, fingerprint.hash());
+  return std::string(op_name) + "_" + std::to_string(output.bytes) + "_" +
+         hash;
+}
+
+TfLiteStatus MapDerivedConstantTensor(
+    TfLiteContext* context, const char* op_name, const TfLiteTensor* input,
+    TfLiteTensor* output,
+    const std::function<TfLiteStatus(TfLiteTensor*)>& fill, bool* mapped) {
+  *mapped = false;
+  SharedConstantCache* cache = SharedConstantCache::GetFromContext(context);
+  if (cache == nullptr || output->type == kTfLiteString) return kTfLiteOk;
+
+  const void* data = cache->GetOrCreate(
+      SharedConstantCache::Key(op_name, *input, *output), output->bytes,
+      [output, &fill](void* buffer) {
+        output->data.raw = static_cast<char*>(buffer);
+        const TfLiteStatus status = fill(output);
+        output->data.raw = nullptr;
+        return status;
+      });
+  if (data == nullptr) return kTfLiteOk;
+  output->allocation_type = kTfLiteMmapRo;
+  output->data.raw_const = static_cast<const char*>(data);
+  *mapped = true;
+  return kTfLiteOk;
+}
+
+#if !defined(_WIN32)
+
+const void* SharedConstantCache::GetOrCreate(
+    const std::string& key, size_t bytes,
+    const std::function<TfLiteStatus(void*)>& fill) {
+  if (bytes == 0) return nullptr;
+  std::lock_guard<std::mutex> lock(mutex_);
+  const std::string path = directory_ + "/" + key + ".bin";
+  if (const void* data = Map(path, bytes)) {
+    return data;
+  }
+
+  // Write the entry to a private temporary file and atomically rename it into
+  // place, so that other processes only ever see complete entries.
+  const std::string temp_path =
+      path + ".tmp." + std::to_string(static_cast<int64_t>(getpid()));
+  const int fd = open(temp_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) return nullptr;
+  bool written = false;
+  if (ftruncate(fd, bytes) == 0) {
+    void* buffer =
+        mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (buffer != MAP_FAILED) {
+      written = fill(buffer) == kTfLiteOk;
+      munmap(buffer, bytes);
+    }
+  }
+  close(fd);
+  if (!written || rename(temp_path.c_str(), path.c_str()) != 0) {
+    unlink(temp_path.c_str());
+    return nullptr;
+  }
+  return Map(path, bytes);
+}
+
+const void* SharedConstantCache::Map(const std::string& path, size_t bytes) {
+  const int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) return nullptr;
+  struct stat file_stat;
+  void* data = MAP_FAILED;
+  if (fstat(fd, &file_stat) == 0 &&
+      static_cast<size_t>(file_stat.st_size) == bytes) {
+    data = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+  }
+  // The mapping stays valid after the file descriptor is closed.
+  close(fd);
+  if (data == MAP_FAILED) return nullptr;
+  mappings_.emplace_back(data, bytes);
+  return data;
+}
+
+#else  // !defined(_WIN32)
+
+const void* SharedConstantCache::GetOrCreate(
+    const std::string& key, size_t bytes,
+    const std::function<TfLiteStatus(void*)>& fill) {
+  return nullptr;
+}
+
+const void* SharedConstantCache::Map(const std::string& path, size_t bytes) {
+  return nullptr;
+}
+
+#endif  // !defined(_WIN32)
+
+}  // namespace tflite
@@ -0,0 +1,105 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_KERNELS_SHARED_CONSTANT_CACHE_H_
+#define TENSORFLOW_LITE_KERNELS_SHARED_CONSTANT_CACHE_H_
+
+#include <cstddef>
+#include <functional>
+#include <mutex>  // NOLINT(build/c++11)
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/lite/c/common.h"
+
+namespace tflite {
+
+// A cache for tensors that kernels derive from constant tensors during
+// Prepare, e.g. the dense weights produced by DENSIFY or the float weights
+// produced by DEQUANTIZE. Without it each interpreter keeps such tensors in
+// its private persistent arena, which for an fp16 or sparse model doubles the
+// resident memory.
+//
+// Each derived tensor is stored in its own file inside `directory` and mapped
+// read-only and shared, so every process serving the same model maps the same
+// page cache pages. The files are keyed by the contents of everything the
+// derived tensor depends on (see Key()), so a directory can be shared between
+// models and stale files are never picked up.
+//
+// Usage:
+//   SharedConstantCache cache("/var/cache/tflite");
+//   interpreter->SetExternalContext(kTfLiteSharedConstantCacheContext, &cache);
+//   interpreter->AllocateTensors();
+//
+// The external context must be set before the tensors are allocated (or a
+// delegate is applied), and the cache must outlive the interpreter, since it
+// owns the mappings the tensors point to. Kernels that find the cache turn
+// their derived outputs into kTfLiteMmapRo tensors, so downstream kernels also
+// treat them as constants.
+//
+// Only supported on POSIX platforms; elsewhere GetOrCreate() always fails and
+// kernels keep their regular behavior.
+class SharedConstantCache : public TfLiteExternalContext {
+ public:
+  explicit SharedConstantCache(std::string directory);
+  ~SharedConstantCache();
+
+  SharedConstantCache(const SharedConstantCache&) = delete;
+  SharedConstantCache& operator=(const SharedConstantCache&) = delete;
+
+  // Returns the cache set on `context`, or nullptr if there is none.
+  static SharedConstantCache* GetFromContext(TfLiteContext* context);
+
+  // Returns a key identifying the tensor that `op_name` derives from `input`
+  // into `output`. It covers the op name, the input type, shape, data,
+  // quantization and sparsity parameters, and the output type and shape.
+  static std::string Key(const char* op_name, const TfLiteTensor& input,
+                         const TfLiteTensor& output);
+
+  // Returns a read-only mapping of the `bytes` bytes stored under `key`. If no
+  // such entry exists yet, `fill` is called to write it into a writable
+  // buffer of `bytes` bytes first. Returns nullptr if the entry can't be
+  // mapped or created, including when `fill` fails; callers then fall back to
+  // computing the tensor themselves.
+  //
+  // Thread-safe. Concurrent processes may compute the same entry, in which
+  // case one of the identical results is kept.
+  const void* GetOrCreate(const std::string& key, size_t bytes,
+                          const std::function<TfLiteStatus(void*)>& fill);
+
+ private:
+  const void* Map(const std::string& path, size_t bytes);
+
+  const std::string directory_;
+  std::mutex mutex_;
+  // Mappings owned by the cache, released on destruction.
+  std::vector<std::pair<void*, size_t>> mappings_;
+};
+
+// For kernels: if a SharedConstantCache is set on `context`, backs `output`,
+// which `op_name` derives from the constant `input` and which has already been
+// resized, with a shared read-only mapping. On a cache miss `fill` is called
+// once to compute `output`, whose data then points to a writable buffer. On
+// success `output` becomes a kTfLiteMmapRo tensor and `*mapped` is set to
+// true; otherwise `output` is left unchanged and the kernel should compute it
+// as usual.
+TfLiteStatus MapDerivedConstantTensor(
+    TfLiteContext* context, const char* op_name, const TfLiteTensor* input,
+    TfLiteTensor* output,
+    const std::function<TfLiteStatus(TfLiteTensor*)>& fill, bool* mapped);
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_SHARED_CONSTANT_CACHE_H_
@@ -0,0 +1,148 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/kernels/shared_constant_cache.h"
+
+#include <stdlib.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/c/common.h"
+
+namespace tflite {
+namespace {
+
+// Returns a new empty directory, so that tests don't see earlier entries.
+std::string NewDirectory() {
+  std::string path = ::testing::TempDir() + "/shared_constant_cache_XXXXXX";
+  EXPECT_NE(mkdtemp(&path[0]), nullptr);
+  return path;
+}
+
+class SharedConstantCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    input_.type = kTfLiteInt8;
+    input_.dims = TfLiteIntArrayCreate(1);
+    input_.dims->data[0] = input_data_.size();
+    input_.data.raw = reinterpret_cast<char*>(input_data_.data());
+    input_.bytes = input_data_.size();
+    input_.allocation_type = kTfLiteMmapRo;
+
+    output_.type = kTfLiteFloat32;
+    output_.dims = TfLiteIntArrayCopy(input_.dims);
+    output_.bytes = input_data_.size() * sizeof(float);
+    output_.allocation_type = kTfLiteArenaRwPersistent;
+
+    context_.impl_ = this;
+    context_.GetExternalContext = [](TfLiteContext* context,
+                                     TfLiteExternalContextType type) {
+      auto* test = static_cast<SharedConstantCacheTest*>(context->impl_);
+      return type == kTfLiteSharedConstantCacheContext ? test->external_context_
+                                                       : nullptr;
+    };
+  }
+
+  void TearDown() override {
+    TfLiteIntArrayFree(input_.dims);
+    TfLiteIntArrayFree(output_.dims);
+  }
+
+  // Converts the input to float, counting the calls.
+  TfLiteStatus Fill(TfLiteTensor* output) {
+    ++num_fills_;
+    for (size_t i = 0; i < input_data_.size(); ++i) {
+      output->data.f[i] = input_data_[i];
+    }
+    return kTfLiteOk;
+  }
+
+  TfLiteStatus Map(bool* mapped) {
+    return MapDerivedConstantTensor(
+        &context_, "test", &input_, &output_,
+        [this](TfLiteTensor* output) { return Fill(output); }, mapped);
+  }
+
+  std::vector<int8_t> input_data_ = {1, -2, 3, -4};
+  TfLiteTensor input_ = {};
+  TfLiteTensor output_ = {};
+  TfLiteContext context_ = {};
+  TfLiteExternalContext* external_context_ = nullptr;
+  int num_fills_ = 0;
+};
+
+TEST_F(SharedConstantCacheTest, KeyDependsOnInputData) {
+  const std::string key = SharedConstantCache::Key("test", input_, output_);
+  EXPECT_EQ(key, SharedConstantCache::Key("test", input_, output_));
+  EXPECT_NE(key, SharedConstantCache::Key("other", input_, output_));
+  input_data_[0] = 5;
+  EXPECT_NE(key, SharedConstantCache::Key("test", input_, output_));
+}
+
+TEST_F(SharedConstantCacheTest, NoCacheLeavesOutputUnchanged) {
+  bool mapped = true;
+  ASSERT_EQ(Map(&mapped), kTfLiteOk);
+  EXPECT_FALSE(mapped);
+  EXPECT_EQ(output_.allocation_type, kTfLiteArenaRwPersistent);
+  EXPECT_EQ(num_fills_, 0);
+}
+
+TEST_F(SharedConstantCacheTest, EntriesAreSharedBetweenCaches) {
+  const std::string directory = NewDirectory();
+  {
+    SharedConstantCache cache(directory);
+    external_context_ = &cache;
+    bool mapped = false;
+    ASSERT_EQ(Map(&mapped), kTfLiteOk);
+    ASSERT_TRUE(mapped);
+    EXPECT_EQ(output_.allocation_type, kTfLiteMmapRo);
+    EXPECT_EQ(output_.data.f[3], -4.0f);
+    EXPECT_EQ(num_fills_, 1);
+  }
+
+  // A second cache, e.g. in another process, maps the stored entry.
+  output_.allocation_type = kTfLiteArenaRwPersistent;
+  output_.data.raw = nullptr;
+  SharedConstantCache cache(directory);
+  external_context_ = &cache;
+  bool mapped = false;
+  ASSERT_EQ(Map(&mapped), kTfLiteOk);
+  ASSERT_TRUE(mapped);
+  EXPECT_EQ(num_fills_, 1);
+  EXPECT_EQ(std::memcmp(output_.data.f, std::vector<float>{1, -2, 3, -4}.data(),
+                        output_.bytes),
+            0);
+}
+
+TEST_F(SharedConstantCacheTest, FailedFillIsNotCached) {
+  SharedConstantCache cache(NewDirectory());
+  const void* data = cache.GetOrCreate("failed_fill", sizeof(float),
+                                       [](void*) { return kTfLiteError; });
+  EXPECT_EQ(data, nullptr);
+  int num_fills = 0;
+  data = cache.GetOrCreate("failed_fill", sizeof(float), [&](void* buffer) {
+    ++num_fills;
+    *static_cast<float*>(buffer) = 1.0f;
+    return kTfLiteOk;
+  });
+  ASSERT_NE(data, nullptr);
+  EXPECT_EQ(*static_cast<const float*>(data), 1.0f);
+  EXPECT_EQ(num_fills, 1);
+}
+
+}  // namespace
+}  // namespace tflite
@@ -977,6 +977,13 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
     // Reserving space for Input, Cell, Forget, Output gates
     scratch_buffer_size->data[1] = n_cell * 4;
   }
+  // For float sequences, also reserve space for the input contribution to the
+  // gates at every step, which lstm_eval::EvalFloat then computes up front.
+  const int max_time =
+      time_major ? input->dims->data[0] : input->dims->data[1];
+  if (input_to_output_weights->type == kTfLiteFloat32 && max_time > 1) {
+    scratch_buffer_size->data[0] = n_batch * (max_time + 1);
+  }
   TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
                                                    scratch_buffer_size));
 
@@ -1343,7 +1350,7 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
           projection_weights, projection_bias, &lstm_params,
           /*forward_sequence=*/true, time_major,
           /*output_offset=*/0, scratch_buffer, output_state, cell_state,
-          output);
+          output, CpuBackendContext::GetFromContext(context));
     }
     case kTfLiteUInt8:
     case kTfLiteInt8: {
@@ -16,9 +16,11 @@ limitations under the License.
 #define TENSORFLOW_LITE_PROFILING_BUFFERED_PROFILER_H_
 
 #include <cstdint>
+#include <memory>
 #include <vector>
 
 #include "tensorflow/lite/core/api/profiler.h"
+#include "tensorflow/lite/profiling/hardware_counters.h"
 #include "tensorflow/lite/profiling/profile_buffer.h"
 
 namespace tflite {
@@ -111,6 +113,18 @@ class BufferedProfiler : public tflite::Profiler {
                      event_metadata2);
   }
 
+  // Records the hardware counters (cycles, instructions and last-level cache
+  // misses) of every operator invocation. Counters are read for the calling
+  // thread, which must be the thread that invokes the interpreter. Returns
+  // false if hardware counters are not available on the platform.
+  bool EnableHardwareCounters() {
+    if (hw_counter_reader_ == nullptr) {
+      hw_counter_reader_ = hardware::HardwareCounterReader::Create();
+    }
+    buffer_.SetHardwareCounterReader(hw_counter_reader_.get());
+    return hw_counter_reader_ != nullptr;
+  }
+
   void StartProfiling() { buffer_.SetEnabled(true); }
   void StopProfiling() { buffer_.SetEnabled(false); }
   void Reset() { buffer_.Reset(); }
@@ -130,6 +144,8 @@ class BufferedProfiler : public tflite::Profiler {
 
  private:
   ProfileBuffer* GetProfileBuffer() { return &buffer_; }
+  // Declared before 'buffer_' as the buffer refers to it.
+  std::unique_ptr<hardware::HardwareCounterReader> hw_counter_reader_;
   ProfileBuffer buffer_;
   const uint64_t supported_event_types_;
 };
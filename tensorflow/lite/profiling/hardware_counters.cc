@@ -0,0 +1,103 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/profiling/hardware_counters.h"
+
+#if defined(__linux__) || defined(__ANDROID__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace tflite {
+namespace profiling {
+namespace hardware {
+
+const int64_t HardwareCounters::kValueNotSet = -1;
+
+#if defined(__linux__) || defined(__ANDROID__)
+namespace {
+
+constexpr int kNumCounters = 3;
+
+int OpenCounter(uint64_t config, int group_fd) {
+  perf_event_attr attr = {};
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.size = sizeof(attr);
+  attr.config = config;
+  attr.disabled = group_fd == -1 ? 1 : 0;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_GROUP;
+  // Count the calling thread (pid 0) on any cpu (-1).
+  return static_cast<int>(
+      syscall(__NR_perf_event_open, &attr, 0, -1, group_fd, 0));
+}
+
+}  // namespace
+
+std::unique_ptr<HardwareCounterReader> HardwareCounterReader::Create() {
+  const int group_fd = OpenCounter(PERF_COUNT_HW_CPU_CYCLES, -1);
+  if (group_fd == -1) return nullptr;
+  std::unique_ptr<HardwareCounterReader> reader(
+      new HardwareCounterReader(group_fd));
+  reader->member_fds_[0] = OpenCounter(PERF_COUNT_HW_INSTRUCTIONS, group_fd);
+  reader->member_fds_[1] = OpenCounter(PERF_COUNT_HW_CACHE_MISSES, group_fd);
+  if (reader->member_fds_[0] == -1 || reader->member_fds_[1] == -1) {
+    return nullptr;
+  }
+  if (ioctl(group_fd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP) == -1 ||
+      ioctl(group_fd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP) == -1) {
+    return nullptr;
+  }
+  return reader;
+}
+
+HardwareCounterReader::~HardwareCounterReader() {
+  for (int fd : member_fds_) {
+    if (fd != -1) close(fd);
+  }
+  close(group_fd_);
+}
+
+HardwareCounters HardwareCounterReader::Read() const {
+  HardwareCounters result;
+  // With PERF_FORMAT_GROUP the kernel returns the number of counters followed
+  // by their values in the order they were added to the group.
+  uint64_t values[1 + kNumCounters];
+  if (read(group_fd_, values, sizeof(values)) != sizeof(values) ||
+      values[0] != kNumCounters) {
+    return result;
+  }
+  result.cycles = static_cast<int64_t>(values[1]);
+  result.instructions = static_cast<int64_t>(values[2]);
+  result.cache_misses = static_cast<int64_t>(values[3]);
+  return result;
+}
+#else
+std::unique_ptr<HardwareCounterReader> HardwareCounterReader::Create() {
+  return nullptr;
+}
+
+HardwareCounterReader::~HardwareCounterReader() {}
+
+HardwareCounters HardwareCounterReader::Read() const {
+  return HardwareCounters();
+}
+#endif
+
+}  // namespace hardware
+}  // namespace profiling
+}  // namespace tflite
@@ -0,0 +1,96 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_PROFILING_HARDWARE_COUNTERS_H_
+#define TENSORFLOW_LITE_PROFILING_HARDWARE_COUNTERS_H_
+
+#include <cstdint>
+#include <memory>
+
+namespace tflite {
+namespace profiling {
+namespace hardware {
+
+// A snapshot of the per-thread hardware performance counters.
+struct HardwareCounters {
+  static const int64_t kValueNotSet;
+
+  HardwareCounters()
+      : cycles(kValueNotSet),
+        instructions(kValueNotSet),
+        cache_misses(kValueNotSet) {}
+
+  // Returns true if all the counters in this snapshot hold a valid value.
+  bool IsValid() const {
+    return cycles != kValueNotSet && instructions != kValueNotSet &&
+           cache_misses != kValueNotSet;
+  }
+
+  // Number of CPU cycles. This is an alias to PERF_COUNT_HW_CPU_CYCLES.
+  int64_t cycles;
+
+  // Number of retired instructions. This is an alias to
+  // PERF_COUNT_HW_INSTRUCTIONS.
+  int64_t instructions;
+
+  // Number of last-level cache misses. This is an alias to
+  // PERF_COUNT_HW_CACHE_MISSES.
+  int64_t cache_misses;
+
+  HardwareCounters operator-(HardwareCounters const& obj) const {
+    HardwareCounters res;
+    if (IsValid() && obj.IsValid()) {
+      res.cycles = cycles - obj.cycles;
+      res.instructions = instructions - obj.instructions;
+      res.cache_misses = cache_misses - obj.cache_misses;
+    }
+    return res;
+  }
+};
+
+// Reads the hardware performance counters of the calling thread through the
+// perf_event_open(2) interface. The counters are opened as one group so that
+// all of them are read atomically with a single read(2) call.
+// Note: this currently only works on Linux-based systems (including Android)
+// where the kernel allows unprivileged access to the counters (see
+// /proc/sys/kernel/perf_event_paranoid). This class is *not thread safe* and
+// counts the events of the thread that created it only.
+class HardwareCounterReader {
+ public:
+  // Returns a reader that counts the events of the calling thread, or nullptr
+  // if hardware counters are not available on the platform.
+  static std::unique_ptr<HardwareCounterReader> Create();
+
+  ~HardwareCounterReader();
+
+  // Returns the current value of the counters. The returned snapshot is not
+  // valid if reading the counters failed.
+  HardwareCounters Read() const;
+
+ private:
+  explicit HardwareCounterReader(int group_fd) : group_fd_(group_fd) {}
+  HardwareCounterReader(const HardwareCounterReader&) = delete;
+  HardwareCounterReader& operator=(const HardwareCounterReader&) = delete;
+
+  // The file descriptor of the group leader (the cycle counter) and of the
+  // other members of the group (instructions and cache misses).
+  int group_fd_;
+  int member_fds_[2] = {-1, -1};
+};
+
+}  // namespace hardware
+}  // namespace profiling
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_PROFILING_HARDWARE_COUNTERS_H_
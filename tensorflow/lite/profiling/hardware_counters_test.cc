@@ -0,0 +1,72 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/profiling/hardware_counters.h"
+
+#include <gtest/gtest.h>
+
+namespace tflite {
+namespace profiling {
+namespace hardware {
+
+TEST(HardwareCounters, DefaultIsNotValid) {
+  HardwareCounters counters;
+  EXPECT_EQ(HardwareCounters::kValueNotSet, counters.cycles);
+  EXPECT_EQ(HardwareCounters::kValueNotSet, counters.instructions);
+  EXPECT_EQ(HardwareCounters::kValueNotSet, counters.cache_misses);
+  EXPECT_FALSE(counters.IsValid());
+}
+
+TEST(HardwareCounters, Sub) {
+  HardwareCounters begin, end;
+  begin.cycles = 100;
+  begin.instructions = 50;
+  begin.cache_misses = 3;
+
+  end.cycles = 1100;
+  end.instructions = 2050;
+  end.cache_misses = 10;
+
+  const auto delta = end - begin;
+  EXPECT_TRUE(delta.IsValid());
+  EXPECT_EQ(1000, delta.cycles);
+  EXPECT_EQ(2000, delta.instructions);
+  EXPECT_EQ(7, delta.cache_misses);
+
+  // The difference with an invalid snapshot is invalid.
+  EXPECT_FALSE((end - HardwareCounters()).IsValid());
+  EXPECT_FALSE((HardwareCounters() - begin).IsValid());
+}
+
+TEST(HardwareCounterReader, Read) {
+  auto reader = HardwareCounterReader::Create();
+  if (reader == nullptr) {
+    // Hardware counters may not be available, e.g. in virtual machines or when
+    // perf_event_paranoid does not allow unprivileged access.
+    GTEST_SKIP();
+  }
+  const auto begin = reader->Read();
+  ASSERT_TRUE(begin.IsValid());
+  volatile int sum = 0;
+  for (int i = 0; i < 100000; ++i) sum += i;
+  const auto end = reader->Read();
+  ASSERT_TRUE(end.IsValid());
+  EXPECT_GT(end.instructions, begin.instructions);
+  EXPECT_GE(end.cycles, begin.cycles);
+  EXPECT_GE(end.cache_misses, begin.cache_misses);
+}
+
+}  // namespace hardware
+}  // namespace profiling
+}  // namespace tflite
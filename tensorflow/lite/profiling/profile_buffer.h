@@ -22,6 +22,7 @@ limitations under the License.
 #include <vector>
 
 #include "tensorflow/lite/core/api/profiler.h"
+#include "tensorflow/lite/profiling/hardware_counters.h"
 #include "tensorflow/lite/profiling/memory_info.h"
 #include "tensorflow/lite/profiling/time.h"
 
@@ -48,6 +49,11 @@ struct ProfileEvent {
   memory::MemoryUsage begin_mem_usage;
   // The memory usage when the event ends.
   memory::MemoryUsage end_mem_usage;
+  // The hardware counters when the event begins. Only recorded for
+  // OPERATOR_INVOKE_EVENT when the buffer has a hardware counter reader.
+  hardware::HardwareCounters begin_hw_counters;
+  // The hardware counters when the event ends.
+  hardware::HardwareCounters end_hw_counters;
 
   // The field containing the type of event. This must be one of the event types
   // in EventType.
@@ -70,7 +76,8 @@ class ProfileBuffer {
       : enabled_(enabled),
         current_index_(0),
         event_buffer_(max_num_entries),
-        allow_dynamic_expansion_(allow_dynamic_expansion) {}
+        allow_dynamic_expansion_(allow_dynamic_expansion),
+        hw_counter_reader_(nullptr) {}
 
   // Adds an event to the buffer with begin timestamp set to the current
   // timestamp. Returns a handle to event that can be used to call EndEvent. If
@@ -96,6 +103,13 @@ class ProfileBuffer {
     if (event_type != Profiler::EventType::OPERATOR_INVOKE_EVENT) {
       event_buffer_[index].begin_mem_usage = memory::GetMemoryUsage();
     }
+    event_buffer_[index].end_hw_counters = hardware::HardwareCounters();
+    if (event_type == Profiler::EventType::OPERATOR_INVOKE_EVENT &&
+        hw_counter_reader_ != nullptr) {
+      event_buffer_[index].begin_hw_counters = hw_counter_reader_->Read();
+    } else {
+      event_buffer_[index].begin_hw_counters = hardware::HardwareCounters();
+    }
     current_index_++;
     return index;
   }
@@ -103,6 +117,13 @@ class ProfileBuffer {
   // Sets the enabled state of buffer to |enabled|
   void SetEnabled(bool enabled) { enabled_ = enabled; }
 
+  // Sets the reader used to record hardware counters of operator invocations.
+  // Passing nullptr disables recording. The reader must outlive the buffer.
+  void SetHardwareCounterReader(
+      const hardware::HardwareCounterReader* hw_counter_reader) {
+    hw_counter_reader_ = hw_counter_reader;
+  }
+
   // Sets the end timestamp for event for the handle to current time.
   // If the buffer is disabled or previous event has been overwritten this
   // operation has not effect.
@@ -120,6 +141,12 @@ class ProfileBuffer {
     }
 
     int event_index = event_handle % max_size;
+    if (hw_counter_reader_ != nullptr &&
+        event_buffer_[event_index].begin_hw_counters.IsValid()) {
+      // Read the counters before anything else so that the profiling overhead
+      // is not attributed to the event.
+      event_buffer_[event_index].end_hw_counters = hw_counter_reader_->Read();
+    }
     event_buffer_[event_index].end_timestamp_us = time::NowMicros();
     if (event_buffer_[event_index].event_type !=
         Profiler::EventType::OPERATOR_INVOKE_EVENT) {
@@ -150,6 +177,8 @@ class ProfileBuffer {
     event_buffer_[index].extra_event_metadata = event_metadata2;
     event_buffer_[index].begin_timestamp_us = start;
     event_buffer_[index].end_timestamp_us = end;
+    event_buffer_[index].begin_hw_counters = hardware::HardwareCounters();
+    event_buffer_[index].end_hw_counters = hardware::HardwareCounters();
     current_index_++;
   }
 
@@ -204,6 +233,7 @@ class ProfileBuffer {
   uint32_t current_index_;
   std::vector<ProfileEvent> event_buffer_;
   const bool allow_dynamic_expansion_;
+  const hardware::HardwareCounterReader* hw_counter_reader_;
 };
 
 }  // namespace profiling
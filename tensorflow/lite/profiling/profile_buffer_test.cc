@@ -138,6 +138,29 @@ TEST(ProfileBufferTest, Enable) {
   EXPECT_EQ(1, buffer.Size());
 }
 
+TEST(ProfileBufferTest, HardwareCounters) {
+  auto reader = hardware::HardwareCounterReader::Create();
+  ProfileBuffer buffer(/*max_size*/ 10, /*enabled*/ true);
+  buffer.SetHardwareCounterReader(reader.get());
+  auto op_handle = buffer.BeginEvent(
+      "op", ProfileEvent::EventType::OPERATOR_INVOKE_EVENT,
+      /*event_metadata1*/ 0, /*event_metadata2*/ 0);
+  auto other_handle =
+      buffer.BeginEvent("hello", ProfileEvent::EventType::DEFAULT,
+                        /*event_metadata1*/ 42, /*event_metadata2*/ 0);
+  buffer.EndEvent(other_handle);
+  buffer.EndEvent(op_handle);
+
+  auto events = GetProfileEvents(buffer);
+  ASSERT_EQ(2, events.size());
+  // Only operator invocations record hardware counters, and only when they
+  // are available on the platform.
+  EXPECT_EQ(reader != nullptr, events[0]->begin_hw_counters.IsValid());
+  EXPECT_EQ(reader != nullptr, events[0]->end_hw_counters.IsValid());
+  EXPECT_FALSE(events[1]->begin_hw_counters.IsValid());
+  EXPECT_FALSE(events[1]->end_hw_counters.IsValid());
+}
+
 }  // namespace
 }  // namespace profiling
 }  // namespace tflite
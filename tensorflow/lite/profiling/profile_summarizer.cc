@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/lite/profiling/profile_summarizer.h"
 
+#include <algorithm>
+#include <iomanip>
 #include <memory>
 #include <sstream>
 
@@ -156,6 +158,21 @@ void ProfileSummarizer::ProcessProfiles(
       stats_calculator->AddNodeStats(node_name_in_stats, type_in_stats,
                                      node_num, start_us, node_exec_time,
                                      0 /*memory */);
+
+      const hardware::HardwareCounters node_hw_counters =
+          event->end_hw_counters - event->begin_hw_counters;
+      if (node_hw_counters.IsValid()) {
+        auto& hw_stats =
+            hw_counter_stats_map_[subgraph_index][node_name_in_stats];
+        if (hw_stats.times_called == 0) {
+          hw_stats.type = type_in_stats;
+          hw_stats.run_order = node_num;
+        }
+        ++hw_stats.times_called;
+        hw_stats.cycles += node_hw_counters.cycles;
+        hw_stats.instructions += node_hw_counters.instructions;
+        hw_stats.cache_misses += node_hw_counters.cache_misses;
+      }
     } else if (event->event_type ==
                Profiler::EventType::DELEGATE_OPERATOR_INVOKE_EVENT) {
       const std::string node_name(event->tag);
@@ -205,6 +222,90 @@ void ProfileSummarizer::ProcessProfiles(
   }
 }
 
+std::string ProfileSummarizer::GetHardwareCounterString() const {
+  if (hw_counter_stats_map_.empty()) return "";
+  const bool format_as_csv =
+      summary_formatter_->GetStatSummarizerOptions().format_as_csv;
+
+  std::stringstream stream;
+  stream.setf(std::ios::fixed, std::ios::floatfield);
+  stream << std::setprecision(3);
+  auto init_field = [&stream](int width) -> std::stringstream& {
+    stream << "\t" << std::right << std::setw(width);
+    return stream;
+  };
+  for (const auto& subgraph_stats : hw_counter_stats_map_) {
+    std::string title = "Hardware Counters by Run Order";
+    if (subgraph_stats.first != 0) {
+      title = "Subgraph (index: " + std::to_string(subgraph_stats.first) +
+              ") " + title;
+    }
+    stream << "============================== " << title
+           << " ==============================" << std::endl;
+    if (format_as_csv) {
+      stream << "node type, avg cycles, avg instructions, IPC, "
+                "avg LLC misses, LLC MPKI, invocations, name";
+    } else {
+      init_field(24) << "[node type]";
+      init_field(14) << "[avg cycles]";
+      init_field(14) << "[avg instrs]";
+      init_field(7) << "[IPC]";
+      init_field(14) << "[avg LLC miss]";
+      init_field(10) << "[LLC MPKI]";
+      init_field(9) << "[invocations]";
+      stream << "\t"
+             << "[Name]";
+    }
+    stream << std::endl;
+
+    std::vector<std::pair<std::string, const HardwareCounterStats*>> nodes;
+    for (const auto& node : subgraph_stats.second) {
+      nodes.emplace_back(node.first, &node.second);
+    }
+    std::sort(nodes.begin(), nodes.end(), [](const auto& a, const auto& b) {
+      return a.second->run_order < b.second->run_order;
+    });
+    for (const auto& node : nodes) {
+      const HardwareCounterStats& hw_stats = *node.second;
+      const double avg_cycles =
+          static_cast<double>(hw_stats.cycles) / hw_stats.times_called;
+      const double avg_instructions =
+          static_cast<double>(hw_stats.instructions) / hw_stats.times_called;
+      const double avg_cache_misses =
+          static_cast<double>(hw_stats.cache_misses) / hw_stats.times_called;
+      const double ipc =
+          hw_stats.cycles > 0
+              ? static_cast<double>(hw_stats.instructions) / hw_stats.cycles
+              : 0.0;
+      // Last-level cache misses per thousand instructions.
+      const double mpki = hw_stats.instructions > 0
+                              ? hw_stats.cache_misses * 1000.0 /
+                                    hw_stats.instructions
+                              : 0.0;
+      if (format_as_csv) {
+        std::string name(node.first);
+        std::replace(name.begin(), name.end(), ',', '\t');
+        stream << hw_stats.type << ", " << avg_cycles << ", "
+               << avg_instructions << ", " << ipc << ", " << avg_cache_misses
+               << ", " << mpki << ", " << hw_stats.times_called << ", "
+               << name;
+      } else {
+        init_field(24) << hw_stats.type;
+        init_field(14) << avg_cycles;
+        init_field(14) << avg_instructions;
+        init_field(7) << ipc;
+        init_field(14) << avg_cache_misses;
+        init_field(10) << mpki;
+        init_field(9) << hw_stats.times_called;
+        stream << "\t" << node.first;
+      }
+      stream << std::endl;
+    }
+    stream << std::endl;
+  }
+  return stream.str();
+}
+
 tensorflow::StatsCalculator* ProfileSummarizer::GetStatsCalculator(
     uint32_t subgraph_index) {
   if (stats_calculator_map_.count(subgraph_index) == 0) {
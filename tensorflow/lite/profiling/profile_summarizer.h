@@ -17,7 +17,9 @@ limitations under the License.
 #define TENSORFLOW_LITE_PROFILING_PROFILE_SUMMARIZER_H_
 
 #include <functional>
+#include <map>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "tensorflow/core/util/stats_calculator.h"
@@ -44,9 +46,15 @@ class ProfileSummarizer {
   // summary_formatter_.
   std::string GetOutputString() {
     return summary_formatter_->GetOutputString(stats_calculator_map_,
-                                               *delegate_stats_calculator_);
+                                               *delegate_stats_calculator_) +
+           GetHardwareCounterString();
   }
 
+  // Returns a string detailing the accumulated hardware counters of operator
+  // invocations, or an empty string if no hardware counters were recorded.
+  // See BufferedProfiler::EnableHardwareCounters.
+  std::string GetHardwareCounterString() const;
+
   std::string GetShortSummary() {
     return summary_formatter_->GetShortSummary(stats_calculator_map_,
                                                *delegate_stats_calculator_);
@@ -63,12 +71,26 @@ class ProfileSummarizer {
   }
 
  private:
+  // Hardware counters accumulated over all invocations of a node.
+  struct HardwareCounterStats {
+    std::string type;
+    int64_t run_order = 0;
+    int64_t times_called = 0;
+    int64_t cycles = 0;
+    int64_t instructions = 0;
+    int64_t cache_misses = 0;
+  };
+
   // Map storing stats per subgraph.
   std::map<uint32_t, std::unique_ptr<tensorflow::StatsCalculator>>
       stats_calculator_map_;
 
   std::unique_ptr<tensorflow::StatsCalculator> delegate_stats_calculator_;
 
+  // Map storing hardware counter stats per subgraph, keyed by node name.
+  std::map<uint32_t, std::map<std::string, HardwareCounterStats>>
+      hw_counter_stats_map_;
+
   // Summary formatter for customized output formats.
   std::shared_ptr<ProfileSummaryFormatter> summary_formatter_;
 };
@@ -149,6 +149,61 @@ TEST(ProfileSummarizerTest, InterpreterPlusProfilingDetails) {
       << output;
 }
 
+TEST(ProfileSummarizerTest, HardwareCounters) {
+  BufferedProfiler profiler(1024);
+  SimpleOpModel m;
+  m.Init(RegisterSimpleOp);
+  auto interpreter = m.GetInterpreter();
+  interpreter->SetProfiler(&profiler);
+  profiler.StartProfiling();
+  m.SetInputs(1, 2);
+  ASSERT_EQ(m.InvokeUnchecked(), kTfLiteOk);
+  profiler.StopProfiling();
+
+  // Fake the counters so that the test does not depend on the availability of
+  // hardware counters on the test machine.
+  std::vector<ProfileEvent> events;
+  for (const ProfileEvent* event : profiler.GetProfileEvents()) {
+    events.push_back(*event);
+    if (event->event_type == Profiler::EventType::OPERATOR_INVOKE_EVENT) {
+      events.back().begin_hw_counters.cycles = 1000;
+      events.back().begin_hw_counters.instructions = 1000;
+      events.back().begin_hw_counters.cache_misses = 0;
+      events.back().end_hw_counters.cycles = 2000;
+      events.back().end_hw_counters.instructions = 3000;
+      events.back().end_hw_counters.cache_misses = 4;
+    }
+  }
+  std::vector<const ProfileEvent*> event_ptrs;
+  for (const ProfileEvent& event : events) event_ptrs.push_back(&event);
+
+  ProfileSummarizer summarizer(std::make_shared<ProfileSummaryCSVFormatter>());
+  EXPECT_TRUE(summarizer.GetHardwareCounterString().empty());
+  summarizer.ProcessProfiles(event_ptrs, *interpreter);
+  auto output = summarizer.GetHardwareCounterString();
+  // 1000 cycles, 2000 instructions, IPC 2, 4 misses over 2000 instructions.
+  EXPECT_THAT(output, testing::HasSubstr("Hardware Counters by Run Order"));
+  EXPECT_THAT(output,
+              testing::HasSubstr("SimpleOpEval, 1000.000, 2000.000, 2.000, "
+                                 "4.000, 2.000, 1, "));
+  EXPECT_THAT(summarizer.GetOutputString(), testing::HasSubstr(output));
+}
+
+TEST(ProfileSummarizerTest, NoHardwareCounters) {
+  BufferedProfiler profiler(1024);
+  SimpleOpModel m;
+  m.Init(RegisterSimpleOp);
+  auto interpreter = m.GetInterpreter();
+  interpreter->SetProfiler(&profiler);
+  profiler.StartProfiling();
+  m.SetInputs(1, 2);
+  ASSERT_EQ(m.InvokeUnchecked(), kTfLiteOk);
+  profiler.StopProfiling();
+  ProfileSummarizer summarizer;
+  summarizer.ProcessProfiles(profiler.GetProfileEvents(), *interpreter);
+  EXPECT_TRUE(summarizer.GetHardwareCounterString().empty());
+}
+
 // A simple test that performs `ADD` if condition is true, and `MUL` otherwise.
 // The computation is: `cond ? a + b : a * b`.
 class ProfileSummarizerIfOpTest : public subgraph_test_util::ControlFlowOpTest {
@@ -91,6 +91,18 @@ TfLiteStatus SimpleMemoryArena::Allocate(
   return kTfLiteOk;
 }
 
+TfLiteStatus SimpleMemoryArena::AllocateAt(
+    TfLiteContext* context, const ArenaAllocWithUsageInterval& alloc) {
+  if (alloc.size == 0) {
+    return kTfLiteOk;
+  }
+  high_water_mark_ = std::max(high_water_mark_, alloc.offset + alloc.size);
+  auto insertion_it =
+      std::upper_bound(ordered_allocs_.begin(), ordered_allocs_.end(), alloc);
+  ordered_allocs_.insert(insertion_it, alloc);
+  return kTfLiteOk;
+}
+
 TfLiteStatus SimpleMemoryArena::Deallocate(
     TfLiteContext* context, const ArenaAllocWithUsageInterval& alloc) {
   if (alloc.size == 0) {
@@ -114,6 +126,10 @@ TfLiteStatus SimpleMemoryArena::Deallocate(
 TfLiteStatus SimpleMemoryArena::Commit(TfLiteContext* context) {
   size_t required_size = RequiredBufferSize();
   if (required_size > underlying_buffer_size_) {
+    if (underlying_buffer_size_ > 0) {
+      required_size = std::max(
+          required_size, underlying_buffer_size_ + underlying_buffer_size_ / 2);
+    }
     char* new_alloc = new char[required_size];
     char* new_underlying_buffer_aligned_ptr = reinterpret_cast<char*>(
         AlignTo(arena_alignment_, reinterpret_cast<intptr_t>(new_alloc)));
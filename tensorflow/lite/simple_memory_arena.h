@@ -76,6 +76,13 @@ class SimpleMemoryArena {
                         int32_t tensor, int32_t first_node, int32_t last_node,
                         ArenaAllocWithUsageInterval* new_alloc);
 
+  // Schedule an allocation that keeps the offset it was given by a previous
+  // call to Allocate(), e.g. before the plan was cleared. The caller must make
+  // sure that it doesn't overlap with any other allocation whose usage
+  // interval intersects with its own.
+  TfLiteStatus AllocateAt(TfLiteContext* context,
+                          const ArenaAllocWithUsageInterval& alloc);
+
   TfLiteStatus Deallocate(TfLiteContext* context,
                           const ArenaAllocWithUsageInterval& alloc);
 
@@ -86,6 +93,11 @@ class SimpleMemoryArena {
     return arena_alignment_ + high_water_mark_ + padding;
   }
 
+  // Makes the underlying buffer at least RequiredBufferSize() bytes large. If
+  // a buffer has to be grown, rather than allocated for the first time, it is
+  // grown by at least half of its size, so that a series of growing plans
+  // (e.g. as inputs get resized) moves the buffer a logarithmic number of
+  // times.
   TfLiteStatus Commit(TfLiteContext* context);
 
   TfLiteStatus ResolveAlloc(TfLiteContext* context,
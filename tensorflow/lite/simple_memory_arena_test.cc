@@ -156,6 +156,69 @@ TEST(SimpleMemoryArenaTest, TestClearBuffer) {
   EXPECT_NE(resolved_ptr, nullptr);
 }
 
+TEST(SimpleMemoryArenaTest, TestAllocateAtPreviousOffsets) {
+  TfLiteContext context;
+  context.ReportError = ReportError;
+  SimpleMemoryArena arena(64);
+  ArenaAllocWithUsageInterval allocs[3];
+
+  arena.Allocate(&context, 32, 2047, 0, 0, 2, &allocs[0]);
+  arena.Allocate(&context, 32, 2047, 1, 1, 2, &allocs[1]);
+  ASSERT_EQ(arena.Commit(&context), kTfLiteOk);
+  const size_t buffer_size = arena.GetBufferSize();
+
+  arena.ClearPlan();
+
+  // Restore the second allocation at its old offset. New allocations must be
+  // planned around it.
+  ASSERT_EQ(arena.AllocateAt(&context, allocs[1]), kTfLiteOk);
+  arena.Allocate(&context, 32, 1023, 2, 0, 1, &allocs[2]);
+  ASSERT_EQ(arena.Commit(&context), kTfLiteOk);
+
+  EXPECT_EQ(allocs[1].offset, 2048);
+  EXPECT_EQ(allocs[2].offset, 0);
+  EXPECT_EQ(arena.GetBufferSize(), buffer_size);
+}
+
+TEST(SimpleMemoryArenaTest, TestGrowthHeadroom) {
+  TfLiteContext context;
+  context.ReportError = ReportError;
+  SimpleMemoryArena arena(64);
+  ArenaAllocWithUsageInterval alloc;
+
+  // The first commit allocates just what is required.
+  arena.Allocate(&context, 32, 4096, 0, 0, 2, &alloc);
+  ASSERT_EQ(arena.Commit(&context), kTfLiteOk);
+  const size_t initial_size = arena.GetBufferSize();
+  EXPECT_EQ(initial_size, arena.RequiredBufferSize());
+
+  // Growing a bit grows the buffer by half.
+  arena.ClearPlan();
+  arena.Allocate(&context, 32, 4160, 0, 0, 2, &alloc);
+  ASSERT_EQ(arena.Commit(&context), kTfLiteOk);
+  EXPECT_EQ(arena.GetBufferSize(), initial_size + initial_size / 2);
+  const std::intptr_t base_pointer = arena.BasePointer();
+
+  // Which leaves room to grow further without moving.
+  arena.ClearPlan();
+  arena.Allocate(&context, 32, 6000, 0, 0, 2, &alloc);
+  ASSERT_EQ(arena.Commit(&context), kTfLiteOk);
+  EXPECT_EQ(arena.BasePointer(), base_pointer);
+
+  // Growing a lot grows the buffer to the required size.
+  arena.ClearPlan();
+  arena.Allocate(&context, 32, 65536, 0, 0, 2, &alloc);
+  ASSERT_EQ(arena.Commit(&context), kTfLiteOk);
+  EXPECT_EQ(arena.GetBufferSize(), arena.RequiredBufferSize());
+
+  // After the buffer is released, the next commit is exact again.
+  arena.ReleaseBuffer();
+  arena.ClearPlan();
+  arena.Allocate(&context, 32, 4096, 0, 0, 2, &alloc);
+  ASSERT_EQ(arena.Commit(&context), kTfLiteOk);
+  EXPECT_EQ(arena.GetBufferSize(), initial_size);
+}
+
 // Test parameterized by whether ClearBuffer() is called before ClearPlan(), or
 // vice versa.
 class BufferAndPlanClearingTest : public ::testing::Test,
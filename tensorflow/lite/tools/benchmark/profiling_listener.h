@@ -34,7 +34,8 @@ class ProfilingListener : public BenchmarkListener {
       Interpreter* interpreter, uint32_t max_num_initial_entries,
       bool allow_dynamic_buffer_increase, const std::string& csv_file_path = "",
       std::shared_ptr<profiling::ProfileSummaryFormatter> summarizer_formatter =
-          std::make_shared<profiling::ProfileSummaryDefaultFormatter>());
+          std::make_shared<profiling::ProfileSummaryDefaultFormatter>(),
+      bool enable_hardware_counters = false);
 
   void OnBenchmarkStart(const BenchmarkParams& params) override;
 
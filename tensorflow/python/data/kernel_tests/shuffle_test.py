@@ -516,6 +516,23 @@ class ShuffleRandomAccessTest(test_base.DatasetTestBase,
     with self.assertRaises(errors.OutOfRangeError):
       self.evaluate(random_access.at(dataset, 0))
 
+  @combinations.generate(test_base.default_test_combinations())
+  def testSingleElement(self):
+    dataset = dataset_ops.Dataset.from_tensor_slices([42]).shuffle(
+        buffer_size=100, seed=7)
+    self.assertEqual(self.evaluate(random_access.at(dataset, 0)), 42)
+
+  @combinations.generate(test_base.eager_only_combinations())
+  def testLargeDatasetIsPermutation(self):
+    dataset = dataset_ops.Dataset.range(5000).shuffle(
+        buffer_size=10, seed=3)
+    shuffled = [
+        self.evaluate(random_access.at(dataset, i)) for i in range(5000)
+    ]
+    # Random access permutes the whole input, whatever the buffer size.
+    self.assertNotEqual(shuffled[:10], list(range(10)))
+    self.assertAllEqual(sorted(shuffled), list(range(5000)))
+
   @combinations.generate(test_base.eager_only_combinations())
   def testBasicWithoutSeedEager(self):
     dataset = dataset_ops.Dataset.from_tensor_slices([1, 2, 3, 4, 5])
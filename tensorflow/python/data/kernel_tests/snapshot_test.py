@@ -26,6 +26,7 @@ from tensorflow.python.data.kernel_tests import checkpoint_test_base
 from tensorflow.python.data.kernel_tests import test_base
 from tensorflow.python.data.kernel_tests import tf_record_test_base
 from tensorflow.python.data.ops import dataset_ops
+from tensorflow.python.data.ops import options as options_lib
 from tensorflow.python.data.ops import readers as core_readers
 from tensorflow.python.framework import combinations
 from tensorflow.python.framework import errors
@@ -320,6 +321,65 @@ class SnapshotTest(tf_record_test_base.TFRecordTestBase,
         num_runs_per_fingerprint=2,
         num_snapshot_shards_per_run=multiprocessing.cpu_count())
 
+  def _commitEveryElement(self):
+    # Writers commit their progress before reading each element, and treat
+    # unfinalized runs as interrupted right away.
+    os.environ["TF_SNAPSHOT_COMMIT_INTERVAL_SECS"] = "0"
+    self.addCleanup(os.environ.pop, "TF_SNAPSHOT_COMMIT_INTERVAL_SECS")
+
+  def _runDirectories(self):
+    dirlist = listdir_and_filter(
+        self._snapshot_dir,
+        lambda p: not (is_graphdef_file(p) or is_temp_file(p)))
+    self.assertLen(dirlist, 1)
+    fingerprint_dir = os.path.join(self._snapshot_dir, dirlist[0])
+    return listdir_and_filter(
+        fingerprint_dir,
+        lambda p: not (is_temp_file(p) or p == "snapshot.metadata"))
+
+  @combinations.generate(test_base.eager_only_combinations())
+  def testWriteSnapshotDatasetResumesInterruptedRun(self):
+    self._commitEveryElement()
+    dataset1 = dataset_ops.Dataset.range(10)
+    dataset1 = dataset1.snapshot(path=self._snapshot_dir)
+    next1 = self.getNext(dataset1)
+    for i in range(5):
+      self.assertEqual(i, self.evaluate(next1()))
+    # Interrupts the run after the first 4 elements were committed.
+    del next1
+    interrupted_runs = self._runDirectories()
+    self.assertLen(interrupted_runs, 1)
+
+    # The run is resumed under a new run ID, and its committed elements are
+    # produced from the input without being written again.
+    dataset2 = dataset_ops.Dataset.range(10)
+    dataset2 = dataset2.snapshot(path=self._snapshot_dir)
+    self.assertDatasetProduces(dataset2, list(range(10)))
+    resumed_runs = self._runDirectories()
+    self.assertLen(resumed_runs, 1)
+    self.assertNotEqual(resumed_runs, interrupted_runs)
+
+    dataset3 = dataset_ops.Dataset.range(10)
+    dataset3 = dataset3.snapshot(path=self._snapshot_dir)
+    self.assertDatasetProducesSet(dataset3, list(range(10)))
+
+  @combinations.generate(test_base.eager_only_combinations())
+  def testWriteSnapshotDatasetDoesNotResumeNondeterministicRun(self):
+    self._commitEveryElement()
+    options = options_lib.Options()
+    options.deterministic = False
+    dataset1 = dataset_ops.Dataset.range(10).with_options(options)
+    dataset1 = dataset1.snapshot(path=self._snapshot_dir)
+    next1 = self.getNext(dataset1)
+    for i in range(5):
+      self.assertEqual(i, self.evaluate(next1()))
+    del next1
+
+    dataset2 = dataset_ops.Dataset.range(10).with_options(options)
+    dataset2 = dataset2.snapshot(path=self._snapshot_dir)
+    self.assertDatasetProduces(dataset2, list(range(10)))
+    self.assertLen(self._runDirectories(), 2)
+
   @combinations.generate(test_base.default_test_combinations())
   def testWriteSnapshotCustomShardFunction(self):
     dataset = dataset_ops.Dataset.range(1000)
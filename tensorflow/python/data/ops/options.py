@@ -40,11 +40,17 @@ class AutotuneAlgorithm(enum.Enum):
 
   MAX_PARALLELISM: Similar to HILL_CLIMB but uses a relaxed stopping condition,
   allowing the optimization to oversubscribe the CPU.
+
+  BUDGETED_HILL_CLIMB: Similar to HILL_CLIMB but only takes steps that keep the
+  estimated CPU usage within the CPU budget and the buffered memory within the
+  RAM budget, preferring the steps with the largest benefit per unit of CPU and
+  RAM they use.
   """
   DEFAULT = 0
   HILL_CLIMB = 1
   GRADIENT_DESCENT = 2
   MAX_PARALLELISM = 3
+  BUDGETED_HILL_CLIMB = 4
 
   @classmethod
   def _to_proto(cls, obj):
@@ -56,6 +62,8 @@ class AutotuneAlgorithm(enum.Enum):
       return model_pb2.AutotuneAlgorithm.GRADIENT_DESCENT
     if obj == cls.MAX_PARALLELISM:
       return model_pb2.AutotuneAlgorithm.MAX_PARALLELISM
+    if obj == cls.BUDGETED_HILL_CLIMB:
+      return model_pb2.AutotuneAlgorithm.BUDGETED_HILL_CLIMB
     raise ValueError(
         f"Invalid `obj.` Supported values include `DEFAULT`, `HILL_CLIMB` and "
         f"`GRADIENT_DESCENT`. Got {obj.name}.")
@@ -70,6 +78,8 @@ class AutotuneAlgorithm(enum.Enum):
       return cls.GRADIENT_DESCENT
     if pb == model_pb2.AutotuneAlgorithm.MAX_PARALLELISM:
       return cls.MAX_PARALLELISM
+    if pb == model_pb2.AutotuneAlgorithm.BUDGETED_HILL_CLIMB:
+      return cls.BUDGETED_HILL_CLIMB
     raise ValueError(f"Invalid `pb.` Supported values include `DEFAULT`, "
                      f"`HILL_CLIMB` and `GRADIENT_DESCENT`. Got {pb}.")
 
@@ -86,7 +86,8 @@ class _OptionsExported(object):
   def __init__(self,
                bytes_per_pack=0,
                timeout_seconds=None,
-               implementation=CommunicationImplementation.AUTO):
+               implementation=CommunicationImplementation.AUTO,
+               wire_format="native"):
     """Creates a CollectiveHints.
 
     Args:
@@ -107,6 +108,12 @@ class _OptionsExported(object):
         `AUTO`, `RING`, and `NCCL`. NCCL is generally more performant for GPU,
         but doesn't work for CPU. This only works for
         `tf.distribute.experimental.MultiWorkerMirroredStrategy`.
+      wire_format: a string, the format in which all-reduces of float32 and
+        float64 tensors send their values between devices. Possible values are
+        `native`, `bfloat16` and `float16`. The narrower formats halve or
+        quarter the bytes on the wire at the cost of precision, while the
+        accumulation stays in the native format. This is only respected by the
+        `RING` implementation.
 
     Raises:
       ValueError: When arguments have invalid value.
@@ -120,7 +127,8 @@ class Options(object):
   def __init__(self,
                bytes_per_pack=0,
                timeout_seconds=None,
-               implementation=CommunicationImplementation.AUTO):
+               implementation=CommunicationImplementation.AUTO,
+               wire_format="native"):
     if bytes_per_pack < 0:
       raise ValueError(
           f"Argument `bytes_per_pack` must be >=0, Received {bytes_per_pack}.")
@@ -130,9 +138,14 @@ class Options(object):
       raise ValueError(
           "Argument `implementation` must be instance of "
           "`tf.distribute.experimental.CommunicationImplementation`.")
+    if wire_format not in ("native", "bfloat16", "float16"):
+      raise ValueError(
+          "Argument `wire_format` must be one of `native`, `bfloat16` or "
+          f"`float16`. Received {wire_format}.")
     self.bytes_per_pack = bytes_per_pack
     self.timeout_seconds = timeout_seconds
     self.implementation = implementation
+    self.wire_format = wire_format
 
   __init__.__doc__ = _OptionsExported.__init__.__doc__
 
@@ -157,12 +170,15 @@ class Options(object):
       merged.timeout_seconds = options.timeout_seconds
     if options.implementation != CommunicationImplementation.AUTO:
       merged.implementation = options.implementation
+    if options.wire_format != "native":
+      merged.wire_format = options.wire_format
     return merged
 
   def __str__(self):
     return (f"Options(bytes_per_pack={self.bytes_per_pack},"
             f"timeout_seconds={self.timeout_seconds}, "
-            f"implementation={self.implementation})")
+            f"implementation={self.implementation}, "
+            f"wire_format={self.wire_format})")
 
 
 @tf_export("distribute.experimental.CollectiveHints")
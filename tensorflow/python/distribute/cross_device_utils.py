@@ -349,6 +349,9 @@ class CollectiveReplicaLauncher(object):
     instance_key = self._next_instance_key()
     options = self._options.merge(options)
     ordering_token = self._get_ordering_token()
+    wire_format = options.wire_format
+    if input_tensor.dtype not in (dtypes.float32, dtypes.float64):
+      wire_format = "native"
     with ops.device(self._device), \
          self._control_input(control_input):
       return collective_ops.all_reduce_v2(
@@ -358,7 +361,8 @@ class CollectiveReplicaLauncher(object):
           instance_key,
           communication_hint=options.implementation.value,
           timeout=options.timeout_seconds,
-          ordering_token=ordering_token)
+          ordering_token=ordering_token,
+          wire_format=wire_format)
 
   def _all_gather(self, input_tensor: core.TensorLike,
                   options: Optional[collective_util.Options]) -> core.Tensor:
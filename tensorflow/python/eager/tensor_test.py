@@ -107,6 +107,12 @@ class TFETensorTest(test_util.TensorFlowTestCase):
     with self.assertRaisesRegex(TypeError, "Invalid dtype argument value"):
       ops.EagerTensor(values, device=ctx.device_name, dtype=12345)
 
+  def testReadOnlyNumpyValue(self):
+    values = np.arange(6, dtype=np.float32).reshape(2, 3)
+    values.flags.writeable = False
+    t = _create_tensor(values)
+    self.assertAllEqual(values, t.numpy())
+
   def testNumpyOrderHandling(self):
     n = np.array([[1, 2], [3, 4]], order="F")
     t = _create_tensor(n)
@@ -197,6 +203,14 @@ class TFETensorTest(test_util.TensorFlowTestCase):
     self.assertEqual(dtypes.int64, t.dtype)
     t = _create_tensor(2**33)
     self.assertEqual(dtypes.int64, t.dtype)
+    t = _create_tensor([[1, 2], [3, 2**33]])
+    self.assertEqual(dtypes.int64, t.dtype)
+    self.assertAllEqual([[1, 2], [3, 2**33]], t.numpy())
+    t = _create_tensor([[1, 2], [3, -2**31]])
+    self.assertEqual(dtypes.int32, t.dtype)
+    self.assertAllEqual([[1, 2], [3, -2**31]], t.numpy())
+    t = _create_tensor([1, 2**33, 2.5])
+    self.assertEqual(dtypes.float32, t.dtype)
 
   def testTensorCreationFailure(self):
     with self.assertRaises(ValueError):
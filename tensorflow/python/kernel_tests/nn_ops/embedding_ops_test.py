@@ -697,10 +697,11 @@ class EmbeddingLookupSparseTest(test.TestCase):
     grouped_ignored_weights = self._GroupByBatchEntry(
         np.ones(np.sum(vals_per_batch_entry)), vals_per_batch_entry)
 
-    for num_shards, combiner, dtype, ignore_weights in itertools.product(
-        [1, 5], ["sum", "mean", "sqrtn"],
-        [dtypes.float16, dtypes.bfloat16, dtypes.float32, dtypes.float64],
-        [True, False]):
+    for (num_shards, combiner, dtype, ignore_weights,
+         combine_on_shards) in itertools.product(
+             [1, 5], ["sum", "mean", "sqrtn"],
+             [dtypes.float16, dtypes.bfloat16, dtypes.float32, dtypes.float64],
+             [True, False], [False, True]):
 
       with self.cached_session():
         p, params, feed_dict = _EmbeddingParams(
@@ -709,7 +710,8 @@ class EmbeddingLookupSparseTest(test.TestCase):
             p,
             sp_ids,
             None if ignore_weights else sp_weights,
-            combiner=combiner)
+            combiner=combiner,
+            combine_on_shards=combine_on_shards)
 
         self.assertEqual(embedding_sum.get_shape().as_list(),
                          expected_lookup_result_shape)
@@ -769,9 +771,10 @@ class EmbeddingLookupSparseTest(test.TestCase):
     sp_ids, sp_weights, _, _, _ = (self._RandomIdsAndWeights(
         batch_size, vocab_size))
 
-    for num_shards, combiner, dtype, ignore_weights in itertools.product(
-        [1, 3], ["sum", "mean", "sqrtn"], [dtypes.float32,
-                                           dtypes.float64], [True, False]):
+    for (num_shards, combiner, dtype, ignore_weights,
+         combine_on_shards) in itertools.product(
+             [1, 3], ["sum", "mean", "sqrtn"], [dtypes.float32, dtypes.float64],
+             [True, False], [False, True]):
       with self.cached_session():
         x, params, _ = _EmbeddingParams(
             num_shards, vocab_size, shape=param_shape, dtype=dtype)
@@ -780,7 +783,8 @@ class EmbeddingLookupSparseTest(test.TestCase):
             x,
             sp_ids,
             None if ignore_weights else sp_weights,
-            combiner=combiner)
+            combiner=combiner,
+            combine_on_shards=combine_on_shards)
         x_name = [_PName(i) for i in range(num_shards)]
         x_init_value = [params[x_n + ":0"] for x_n in x_name]
         x_shape = [i.shape for i in x_init_value]
@@ -466,6 +466,25 @@ class StatelessOpsTest(test.TestCase, parameterized.TestCase):
     alg = gen_stateless_random_ops_v2.stateless_random_get_alg()
     self.assertAllEqual(alg.shape, [])
 
+  @parameterized.parameters(['float16', 'bfloat16', 'float32', 'float64'])
+  @test_util.run_v2_only
+  def testStatelessDropoutMatchesUniform(self, dtype):
+    # An odd number of elements covers the partial last group of samples.
+    shape = [7, 37]
+    with ops.device('/cpu:0'):
+      key, counter = (
+          gen_stateless_random_ops_v2.stateless_random_get_key_counter(
+              [1, 2]))
+      alg = gen_stateless_random_ops_v2.stateless_random_get_alg()
+      x = random_ops.random_normal(shape, dtype=dtype)
+      rate = constant_op.constant(0.3, dtype=dtype)
+      y = gen_stateless_random_ops_v2.stateless_dropout(
+          x, rate, key, counter, alg)
+      uniform = gen_stateless_random_ops_v2.stateless_random_uniform_v2(
+          shape, key, counter, alg, dtype=dtype)
+      expected = x / (1 - rate) * math_ops.cast(uniform >= rate, dtype)
+    self.assertAllEqual(y, expected)
+
   def assertDTypeEqual(self, a, b):
     self.assertEqual(dtypes.as_dtype(a), dtypes.as_dtype(b))
 
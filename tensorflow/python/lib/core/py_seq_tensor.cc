@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/python/lib/core/py_seq_tensor.h"
 
+#include <algorithm>
+
 #include "tensorflow/c/eager/tfe_context_internal.h"
 #include "tensorflow/c/eager/tfe_tensorhandle_internal.h"
 #include "tensorflow/c/tensor_interface.h"
@@ -231,11 +233,48 @@ const char ErrorFoundFloat[] =
     "Can't convert Python sequence with floating point values to integer "
     "Tensor.";
 
+// Calls `visit(scalar)` on each scalar of the nested sequence `obj`, in
+// row-major order, checking that `obj` has the inferred shape. Stops at the
+// first error returned by `visit`.
+//
+// Note that this requires shape.dims() >= 1.
+template <class Visitor>
+const char* VisitScalars(PyObject* obj, int depth, ConverterState* state,
+                         Visitor& visit) {
+  if (TF_PREDICT_FALSE(obj == nullptr)) {
+    return ErrorConverting;
+  }
+
+  Safe_PyObjectPtr seq = make_safe(PySequence_Fast(obj, ""));
+  if (TF_PREDICT_FALSE(seq == nullptr)) return ErrorRectangular;
+
+  const int64_t s = state->inferred_shape[depth];
+  if (TF_PREDICT_FALSE(s != PySequence_Fast_GET_SIZE(seq.get()))) {
+    return ErrorRectangular;
+  }
+
+  if (state->inferred_shape.size() - depth > 1) {
+    /* Iterate over outer dim, and recursively convert each element. */
+    for (int64_t i = 0; i < s; ++i) {
+      const char* error = VisitScalars(PySequence_Fast_GET_ITEM(seq.get(), i),
+                                       depth + 1, state, visit);
+      if (TF_PREDICT_FALSE(error != nullptr)) return error;
+    }
+  } else {
+    PyObject** l = PySequence_Fast_ITEMS(seq.get());
+    for (int64_t i = 0; i < s; ++i) {
+      auto scalar = ZeroDimArrayToScalar(l[i], state);
+      const char* error = visit(scalar);
+      Py_DECREF(scalar);
+      if (TF_PREDICT_FALSE(error != nullptr)) return error;
+    }
+  }
+  return nullptr;
+}
+
 // Defines a converter that recursively converts an object into
 // an array of type T using the conversion function defined by the
 // traits class in a ConvertScalar function.
-//
-// Note that these helper functions require shape.dims() >= 1.
 template <class T>
 struct ConverterTraits {
   static const tensorflow::DataType kTypeEnum;
@@ -246,36 +285,12 @@ template <class T>
 struct Converter {
   static const char* Helper(PyObject* obj, int depth, ConverterState* state,
                             T** buf) {
-    if (TF_PREDICT_FALSE(obj == nullptr)) {
-      return ErrorConverting;
-    }
-
-    Safe_PyObjectPtr seq = make_safe(PySequence_Fast(obj, ""));
-    if (TF_PREDICT_FALSE(seq == nullptr)) return ErrorRectangular;
-
-    const int64_t s = state->inferred_shape[depth];
-    if (TF_PREDICT_FALSE(s != PySequence_Fast_GET_SIZE(seq.get()))) {
-      return ErrorRectangular;
-    }
-
-    if (state->inferred_shape.size() - depth > 1) {
-      /* Iterate over outer dim, and recursively convert each element. */
-      for (int64_t i = 0; i < s; ++i) {
-        const char* error = Helper(PySequence_Fast_GET_ITEM(seq.get(), i),
-                                   depth + 1, state, buf);
-        if (TF_PREDICT_FALSE(error != nullptr)) return error;
-      }
-    } else {
-      PyObject** l = PySequence_Fast_ITEMS(seq.get());
-      for (int64_t i = 0; i < s; ++i) {
-        auto scalar = ZeroDimArrayToScalar(l[i], state);
-        const char* error = ConverterTraits<T>::ConvertScalar(scalar, *buf);
-        Py_DECREF(scalar);
-        if (TF_PREDICT_FALSE(error != nullptr)) return error;
-        ++*buf;
-      }
-    }
-    return nullptr;
+    auto visit = [buf](PyObject* scalar) {
+      const char* error = ConverterTraits<T>::ConvertScalar(scalar, *buf);
+      ++*buf;
+      return error;
+    };
+    return VisitScalars(obj, depth, state, visit);
   }
 
   static Status Convert(TFE_Context* ctx, PyObject* obj, ConverterState* state,
@@ -437,6 +452,67 @@ struct ConverterTraits<int32> {
 
 typedef Converter<int32> Int32Converter;
 
+// Converts Python integers to an int32 tensor, or to an int64 tensor if one of
+// them does not fit in 32 bits. Trying Int32Converter and then Int64Converter
+// walks the Python objects twice when a large integer comes late in the
+// sequence; instead, the int32 values converted so far are widened into an
+// int64 tensor when the first large integer is found, and the conversion
+// continues from there.
+struct Int32OrInt64Converter {
+  static Status Convert(TFE_Context* ctx, PyObject* obj, ConverterState* state,
+                        TFE_TensorHandle** h, const char** error) {
+    if (state->inferred_shape.empty()) {
+      Status status = Int32Converter::Convert(ctx, obj, state, h, error);
+      if (*error == ErrorFoundInt64) {
+        status = Int64Converter::Convert(ctx, obj, state, h, error);
+      }
+      return status;
+    }
+
+    AbstractTensorInterface* t =
+        ConverterTraits<int32>::CreateTensor(ctx, state->inferred_shape);
+    if (t == nullptr) {
+      return errors::Internal("Cannot create tensor.");
+    }
+    if (t->NumElements() > 0) {
+      int32* buf32 = static_cast<int32*>(t->Data());
+      int64_t* buf64 = nullptr;
+      int64_t i = 0;
+      auto visit = [&](PyObject* scalar) -> const char* {
+        int64_t value;
+        const char* scalar_error =
+            ConverterTraits<int64_t>::ConvertScalar(scalar, &value);
+        if (TF_PREDICT_FALSE(scalar_error != nullptr)) return scalar_error;
+        if (TF_PREDICT_TRUE(buf64 == nullptr)) {
+          buf32[i] = static_cast<int32>(value);
+          if (TF_PREDICT_TRUE(buf32[i] == value)) {
+            ++i;
+            return nullptr;
+          }
+          AbstractTensorInterface* t64 =
+              ConverterTraits<int64_t>::CreateTensor(ctx,
+                                                     state->inferred_shape);
+          if (t64 == nullptr) return ErrorConverting;
+          buf64 = static_cast<int64_t*>(t64->Data());
+          std::copy(buf32, buf32 + i, buf64);
+          t->Release();
+          t = t64;
+        }
+        buf64[i++] = value;
+        return nullptr;
+      };
+      *error = VisitScalars(obj, 0, state, visit);
+      if (*error != nullptr) {
+        t->Release();
+        return errors::InvalidArgument(*error);
+      }
+    }
+    *h = tensorflow::wrap(tensorflow::unwrap(ctx)->CreateLocalHandle(t));
+    t->Release();
+    return Status::OK();
+  }
+};
+
 // Floating-point support
 
 // Returns `true` if `out` overflows when converted from `as_double`.
@@ -748,8 +824,10 @@ TFE_TensorHandle* PySeqToTFE_TensorHandle(TFE_Context* ctx, PyObject* obj,
 
     Safe_PyObjectPtr safe_value(nullptr);
     // Use Numpy to convert between types if needed.
+    // Read-only arrays are fine as long as they are contiguous and aligned:
+    // the tensor only reads from the shared buffer.
     if ((desired_np_dtype >= 0 && desired_np_dtype != array_dtype) ||
-        !PyArray_ISCARRAY(array)) {
+        !PyArray_ISCARRAY_RO(array)) {
       int new_dtype = desired_np_dtype >= 0 ? desired_np_dtype : array_dtype;
       safe_value = tensorflow::make_safe(
           PyArray_FromAny(obj, PyArray_DescrFromType(new_dtype), 0, 0,
@@ -850,10 +928,8 @@ TFE_TensorHandle* PySeqToTFE_TensorHandle(TFE_Context* ctx, PyObject* obj,
 
     case DT_INT64:
       if (requested_dtype == DT_INVALID) {
-        status = Int32Converter::Convert(ctx, obj, &state, &handle, &error);
-        if (error == ErrorFoundInt64) {
-          status = Int64Converter::Convert(ctx, obj, &state, &handle, &error);
-        }
+        status =
+            Int32OrInt64Converter::Convert(ctx, obj, &state, &handle, &error);
         if (error == ErrorFoundFloat) {
           status = FloatConverter::Convert(ctx, obj, &state, &handle, &error);
         }
@@ -102,6 +102,7 @@ def all_reduce_v2(t,
                   timeout=0,
                   ordering_token=None,
                   max_subdivs_per_device=-1,
+                  wire_format='native',
                   name=None):
   """Reduces tensors collectively, across devices.
 
@@ -132,6 +133,9 @@ def all_reduce_v2(t,
       parallelize processing of each per-device tensor. Setting to -1 disables
       subdivision and reverts to previous behavior of not sub-dividing tensor.
       Setting to 0 uses sytem defaults.
+    wire_format: the format in which the ring implementation sends the values
+      of float32 and float64 tensors between devices, while accumulating them
+      in their own type.  Options include `native`, `bfloat16` and `float16`.
     name: name of the Op.
 
   Returns:
@@ -153,6 +157,7 @@ def all_reduce_v2(t,
       timeout_seconds=timeout,
       ordering_token=ordering_token,
       max_subdivs_per_device=max_subdivs_per_device,
+      wire_format=wire_format,
       name=name)
 
 
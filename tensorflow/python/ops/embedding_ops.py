@@ -87,6 +87,68 @@ def _colocate_with(param):
     return ops.colocate_with(param)
 
 
+def _partition_ids(params, flat_ids, partition_strategy):
+  """Assigns the flat ids `flat_ids` to the partitions `params`.
+
+  Args:
+    params: A list of tensors, the partitions of the embedding tensor.
+    flat_ids: A 1-D `Tensor` of ids.
+    partition_strategy: Either `"mod"` or `"div"`.
+
+  Returns:
+    A pair of the int32 partition of each id and its index in its partition.
+
+  Raises:
+    ValueError: If `partition_strategy` is not recognized.
+  """
+  np = len(params)  # Number of partitions
+  if partition_strategy == "mod":
+    p_assignments = flat_ids % np
+    new_ids = flat_ids // np
+  elif partition_strategy == "div":
+    # Compute num_total_ids as the sum of dim-0 of params, then assign to
+    # partitions based on a constant number of ids per partition. Optimize
+    # if we already know the full shape statically.
+    dim_0_size = tensor_shape.Dimension(
+        tensor_shape.dimension_value(params[0].get_shape()[0]))
+    for p in range(1, np):
+      dim_0_size += tensor_shape.Dimension(
+          tensor_shape.dimension_value(params[p].get_shape()[0]))
+    if dim_0_size.value:
+      num_total_ids = constant_op.constant(dim_0_size.value, flat_ids.dtype)
+    else:
+      dim_0_sizes = []
+      for p in range(np):
+        param_p_dim = tensor_shape.dimension_value(params[p].get_shape()[0])
+        if param_p_dim is not None:
+          dim_0_sizes.append(param_p_dim)
+        else:
+          with _colocate_with(params[p]):
+            dim_0_sizes.append(array_ops.shape(params[p])[0])
+      num_total_ids = math_ops.reduce_sum(
+          math_ops.cast(array_ops.stack(dim_0_sizes), flat_ids.dtype))
+    ids_per_partition = num_total_ids // np
+    extras = num_total_ids % np
+
+    p_assignments = math_ops.maximum(flat_ids // (ids_per_partition + 1),
+                                     (flat_ids - extras) //
+                                     ids_per_partition)
+
+    # Emulate a conditional using a boolean indicator tensor
+    new_ids = array_ops.where(p_assignments < extras,
+                              flat_ids % (ids_per_partition + 1),
+                              (flat_ids - extras) % ids_per_partition)
+  else:
+    raise ValueError(
+        f"Unrecognized partition strategy: {partition_strategy}."
+        "Must be one of either `mod` or `div`.")
+
+  # Cast partition assignments to int32 for use in dynamic_partition.
+  # There really should not be more than 2^32 partitions.
+  p_assignments = math_ops.cast(p_assignments, dtypes.int32)
+  return p_assignments, new_ids
+
+
 def _embedding_lookup_and_transform(params,
                                     ids,
                                     partition_strategy="mod",
@@ -157,51 +219,8 @@ def _embedding_lookup_and_transform(params,
       flat_ids = array_ops.reshape(ids, [-1])
       original_indices = math_ops.range(array_ops.size(flat_ids))
 
-      # Create p_assignments and set new_ids depending on the strategy.
-      if partition_strategy == "mod":
-        p_assignments = flat_ids % np
-        new_ids = flat_ids // np
-      elif partition_strategy == "div":
-        # Compute num_total_ids as the sum of dim-0 of params, then assign to
-        # partitions based on a constant number of ids per partition. Optimize
-        # if we already know the full shape statically.
-        dim_0_size = tensor_shape.Dimension(
-            tensor_shape.dimension_value(params[0].get_shape()[0]))
-        for p in range(1, np):
-          dim_0_size += tensor_shape.Dimension(
-              tensor_shape.dimension_value(params[p].get_shape()[0]))
-        if dim_0_size.value:
-          num_total_ids = constant_op.constant(dim_0_size.value, flat_ids.dtype)
-        else:
-          dim_0_sizes = []
-          for p in range(np):
-            param_p_dim = tensor_shape.dimension_value(params[p].get_shape()[0])
-            if param_p_dim is not None:
-              dim_0_sizes.append(param_p_dim)
-            else:
-              with _colocate_with(params[p]):
-                dim_0_sizes.append(array_ops.shape(params[p])[0])
-          num_total_ids = math_ops.reduce_sum(
-              math_ops.cast(array_ops.stack(dim_0_sizes), flat_ids.dtype))
-        ids_per_partition = num_total_ids // np
-        extras = num_total_ids % np
-
-        p_assignments = math_ops.maximum(flat_ids // (ids_per_partition + 1),
-                                         (flat_ids - extras) //
-                                         ids_per_partition)
-
-        # Emulate a conditional using a boolean indicator tensor
-        new_ids = array_ops.where(p_assignments < extras,
-                                  flat_ids % (ids_per_partition + 1),
-                                  (flat_ids - extras) % ids_per_partition)
-      else:
-        raise ValueError(
-            f"Unrecognized partition strategy: {partition_strategy}."
-            "Must be one of either `mod` or `div`.")
-
-      # Cast partition assignments to int32 for use in dynamic_partition.
-      # There really should not be more than 2^32 partitions.
-      p_assignments = math_ops.cast(p_assignments, dtypes.int32)
+      p_assignments, new_ids = _partition_ids(params, flat_ids,
+                                              partition_strategy)
       # Partition list of ids based on assignments into np separate lists
       gather_ids = data_flow_ops.dynamic_partition(new_ids, p_assignments, np)
       # Similarly, partition the original indices.
@@ -410,7 +429,8 @@ def embedding_lookup_sparse(params,
                             partition_strategy="mod",
                             name=None,
                             combiner=None,
-                            max_norm=None):
+                            max_norm=None,
+                            combine_on_shards=False):
   """Looks up embeddings for the given ids and weights from a list of tensors.
 
   This op assumes that there is at least one id for each row in the dense tensor
@@ -445,6 +465,12 @@ def embedding_lookup_sparse(params,
       of the squares of the weights. Defaults to `mean`.
     max_norm: If not `None`, each embedding is clipped if its l2-norm is larger
       than this value, before combining.
+    combine_on_shards: If `True`, the weighted sum of the embeddings of each
+      row is computed separately for the ids of each element of `params`,
+      colocated with it, so that one partial sum per row, rather than each
+      looked up embedding, is transferred from the device of each element.
+      This reduces network traffic when `params` are placed on parameter
+      servers and rows hold many ids. Defaults to `False`.
 
   Returns:
     A dense tensor representing the combined embeddings for the
@@ -513,6 +539,11 @@ def embedding_lookup_sparse(params,
 
   with ops.name_scope(name, "embedding_lookup_sparse",
                       params + [sp_ids]) as name:
+    if combine_on_shards:
+      return _embedding_lookup_sparse_on_shards(params, sp_ids, sp_weights,
+                                                partition_strategy, combiner,
+                                                max_norm, name)
+
     segment_ids = sp_ids.indices[:, 0]
 
     ids = sp_ids.values
@@ -588,6 +619,106 @@ def embedding_lookup_sparse(params,
     return embeddings
 
 
+def _embedding_lookup_sparse_on_shards(params, sp_ids, sp_weights,
+                                       partition_strategy, combiner, max_norm,
+                                       name):
+  """Implements `embedding_lookup_sparse` with `combine_on_shards=True`.
+
+  The ids, weights and row indices are partitioned like the ids of
+  `embedding_lookup`.  Colocated with each element of `params`, its unique ids
+  are looked up and their weighted embeddings summed per row.  The partial
+  sums are then added up, and divided by the weight of each row for the
+  "mean" and "sqrtn" combiners.
+
+  Args:
+    params: A list of tensors or resource variables.
+    sp_ids: See `embedding_lookup_sparse`.
+    sp_weights: See `embedding_lookup_sparse`.
+    partition_strategy: See `embedding_lookup_sparse`.
+    combiner: One of "mean", "sqrtn" and "sum".
+    max_norm: See `embedding_lookup_sparse`.
+    name: The name of the returned tensor.
+
+  Returns:
+    The combined embeddings.
+  """
+  np = len(params)  # Number of partitions
+  # Preserve the resource variable status to avoid accidental dense reads.
+  if not any(
+      isinstance(p, resource_variable_ops.BaseResourceVariable)
+      for p in params):
+    params = ops.convert_n_to_tensor_or_indexed_slices(params, name="params")
+  segment_ids = math_ops.cast(sp_ids.indices[:, 0], dtypes.int32)
+  num_segments = math_ops.maximum(math_ops.reduce_max(segment_ids) + 1, 0)
+  ids = sp_ids.values
+  weights = None if sp_weights is None else sp_weights.values
+
+  if np == 1:
+    p_ids = [ids]
+    p_segment_ids = [segment_ids]
+    p_weights = [weights]
+  else:
+    p_assignments, new_ids = _partition_ids(params, ids, partition_strategy)
+    p_ids = data_flow_ops.dynamic_partition(new_ids, p_assignments, np)
+    p_segment_ids = data_flow_ops.dynamic_partition(segment_ids,
+                                                    p_assignments, np)
+    p_weights = (
+        [None] * np if weights is None else
+        data_flow_ops.dynamic_partition(weights, p_assignments, np))
+
+  partial_sums = []
+  for p in range(np):
+    with ops.device_v2(None):
+      with _colocate_with(params[p]):
+        unique_ids, idx = array_ops.unique(p_ids[p])
+        embeddings = _clip(
+            array_ops.gather(params[p], unique_ids), unique_ids, max_norm)
+        if embeddings.dtype in (dtypes.float16, dtypes.bfloat16):
+          # Cast low-precision embeddings to float32 during the computation
+          # to avoid numerical issues.
+          embeddings = math_ops.cast(embeddings, dtypes.float32)
+        if p_weights[p] is None:
+          partial_sum = math_ops.sparse_segment_sum(
+              embeddings, idx, p_segment_ids[p], num_segments=num_segments)
+        else:
+          embeddings = array_ops.gather(embeddings, idx)
+          partial_sum = math_ops.unsorted_segment_sum(
+              embeddings * _broadcastable_to(
+                  math_ops.cast(p_weights[p], embeddings.dtype), embeddings),
+              p_segment_ids[p], num_segments)
+    partial_sums.append(partial_sum)
+  result = math_ops.add_n(partial_sums)
+
+  if combiner != "sum":
+    if weights is None:
+      weights = array_ops.ones_like(segment_ids, dtype=result.dtype)
+    else:
+      weights = math_ops.cast(weights, result.dtype)
+    if combiner == "sqrtn":
+      weights = math_ops.pow(weights, 2)
+    weight_sum = math_ops.unsorted_segment_sum(weights, segment_ids,
+                                               num_segments)
+    if combiner == "sqrtn":
+      weight_sum = math_ops.sqrt(weight_sum)
+    result = math_ops.div_no_nan(result, _broadcastable_to(weight_sum, result))
+
+  if result.dtype != params[0].dtype:
+    result = math_ops.cast(result, params[0].dtype)
+  result = array_ops.identity(result, name=name)
+  element_shape = params[0].get_shape()[1:]
+  for p in params[1:]:
+    element_shape = element_shape.merge_with(p.get_shape()[1:])
+  result.set_shape(tensor_shape.TensorShape([None]).concatenate(element_shape))
+  return result
+
+
+def _broadcastable_to(x, y):
+  """Reshapes the 1-D `x` to broadcast along the inner dimensions of `y`."""
+  ones_shape = array_ops.expand_dims(array_ops.rank(y) - 1, 0)
+  ones = array_ops.ones(ones_shape, dtype=dtypes.int32)
+  return array_ops.reshape(x, array_ops.concat([array_ops.shape(x), ones], 0))
+
+
 @tf_export("nn.embedding_lookup_sparse", v1=[])
 @dispatch.add_dispatch_support
 def embedding_lookup_sparse_v2(params,
@@ -595,7 +726,8 @@ def embedding_lookup_sparse_v2(params,
                                sp_weights,
                                combiner=None,
                                max_norm=None,
-                               name=None):
+                               name=None,
+                               combine_on_shards=False):
   """Looks up embeddings for the given ids and weights from a list of tensors.
 
   This op assumes that there is at least one id for each row in the dense tensor
@@ -634,6 +766,12 @@ def embedding_lookup_sparse_v2(params,
     max_norm: If not `None`, each embedding is clipped if its l2-norm is larger
       than this value, before combining.
     name: Optional name for the op.
+    combine_on_shards: If `True`, the weighted sum of the embeddings of each
+      row is computed separately for the ids of each element of `params`,
+      colocated with it, so that one partial sum per row, rather than each
+      looked up embedding, is transferred from the device of each element.
+      This reduces network traffic when `params` are placed on parameter
+      servers and rows hold many ids. Defaults to `False`.
 
   Returns:
     A dense tensor representing the combined embeddings for the
@@ -676,7 +814,7 @@ def embedding_lookup_sparse_v2(params,
     ValueError: If `combiner` is not one of {"mean", "sqrtn", "sum"}.
   """
   return embedding_lookup_sparse(params, sp_ids, sp_weights, "div", name,
-                                 combiner, max_norm)
+                                 combiner, max_norm, combine_on_shards)
 
 
 @tf_export("nn.safe_embedding_lookup_sparse", v1=[])
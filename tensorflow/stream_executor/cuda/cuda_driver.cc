@@ -146,11 +146,18 @@ ScopedActivateContext::ScopedActivateContext(GpuContext* cuda_context) {
 
   // If this is an outermost scope, we must not assume that the CUDA context has
   // been left in the same state we left it. Other code may have run on this
-  // thread and altered the context.
+  // thread and altered the context. Querying the current context is much
+  // cheaper than setting it, and on threads that only ever use one context
+  // (e.g. one issuing a stream of small kernel launches) it avoids the set.
   if (tls->depth == 0) {
-    VLOG(3) << "ScopedActivateContext switching to " << cuda_context->id();
-    FAIL_IF_CUDA_RES_ERROR(cuCtxSetCurrent(cuda_context->context()),
-                           "Failed setting context");
+    CUcontext current = nullptr;
+    if (tls->id != cuda_context->id() ||
+        cuCtxGetCurrent(&current) != CUDA_SUCCESS ||
+        current != cuda_context->context()) {
+      VLOG(3) << "ScopedActivateContext switching to " << cuda_context->id();
+      FAIL_IF_CUDA_RES_ERROR(cuCtxSetCurrent(cuda_context->context()),
+                             "Failed setting context");
+    }
     tls->depth = 1;
     tls->id = cuda_context->id();
     tls->context = cuda_context;
@@ -1076,6 +1083,82 @@ GpuDriver::CreateMemoryHandle(GpuContext* context, uint64_t bytes) {
   return false;
 }
 
+/* static */ port::Status GpuDriver::StreamBeginCapture(GpuContext* context,
+                                                        CUstream stream) {
+  ScopedActivateContext activated{context};
+  CHECK(stream != nullptr);
+  RETURN_IF_CUDA_RES_ERROR(
+      cuStreamBeginCapture(stream, CU_STREAM_CAPTURE_MODE_RELAXED),
+      "Failed to begin capturing CUDA stream");
+  return port::Status::OK();
+}
+
+/* static */ port::Status GpuDriver::StreamEndCapture(GpuContext* context,
+                                                      CUstream stream,
+                                                      CUgraph* graph) {
+  ScopedActivateContext activated{context};
+  CHECK(stream != nullptr);
+  RETURN_IF_CUDA_RES_ERROR(cuStreamEndCapture(stream, graph),
+                           "Failed to end capturing CUDA stream");
+  return port::Status::OK();
+}
+
+/* static */ port::Status GpuDriver::GraphInstantiate(GpuContext* context,
+                                                      CUgraph graph,
+                                                      CUgraphExec* exec) {
+  ScopedActivateContext activated{context};
+  RETURN_IF_CUDA_RES_ERROR(
+      cuGraphInstantiate(exec, graph, /*phErrorNode=*/nullptr,
+                         /*logBuffer=*/nullptr, /*bufferSize=*/0),
+      "Failed to instantiate CUDA graph");
+  return port::Status::OK();
+}
+
+/* static */ port::StatusOr<bool> GpuDriver::GraphExecUpdate(
+    GpuContext* context, CUgraphExec exec, CUgraph graph) {
+#if CUDA_VERSION >= 10020
+  ScopedActivateContext activated{context};
+  CUgraphNode error_node;
+  CUgraphExecUpdateResult result;
+  CUresult res = cuGraphExecUpdate(exec, graph, &error_node, &result);
+  if (res == CUDA_ERROR_GRAPH_EXEC_UPDATE_FAILURE) {
+    VLOG(2) << "CUDA graph cannot be updated in place, update result: "
+            << result;
+    return false;
+  }
+  RETURN_IF_CUDA_RES_ERROR(res, "Failed to update CUDA graph");
+  return true;
+#else
+  return false;
+#endif  // CUDA_VERSION >= 10020
+}
+
+/* static */ port::Status GpuDriver::GraphLaunch(GpuContext* context,
+                                                 CUgraphExec exec,
+                                                 CUstream stream) {
+  ScopedActivateContext activated{context};
+  RETURN_IF_CUDA_RES_ERROR(cuGraphLaunch(exec, stream),
+                           "Failed to launch CUDA graph");
+  return port::Status::OK();
+}
+
+/* static */ void GpuDriver::DestroyGraph(GpuContext* context, CUgraph graph) {
+  ScopedActivateContext activated{context};
+  CUresult res = cuGraphDestroy(graph);
+  if (res != CUDA_SUCCESS) {
+    LOG(ERROR) << "failed to destroy CUDA graph: " << ToString(res);
+  }
+}
+
+/* static */ void GpuDriver::DestroyGraphExec(GpuContext* context,
+                                              CUgraphExec exec) {
+  ScopedActivateContext activated{context};
+  CUresult res = cuGraphExecDestroy(exec);
+  if (res != CUDA_SUCCESS) {
+    LOG(ERROR) << "failed to destroy CUDA graph exec: " << ToString(res);
+  }
+}
+
 /* static */ port::Status GpuDriver::SynchronousMemcpyD2H(GpuContext* context,
                                                           void* host_dst,
                                                           CUdeviceptr gpu_src,
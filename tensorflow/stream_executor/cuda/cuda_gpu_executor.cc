@@ -460,10 +460,10 @@ port::Status GpuExecutor::Launch(Stream* stream, const ThreadDim& thread_dims,
     }
   }
 
-  if (cuda_kernel->GetPreferredCacheConfig() !=
-      KernelCacheConfig::kNoPreference) {
+  if (cuda_kernel->ShouldApplyCacheConfig()) {
     TF_RETURN_IF_ERROR(GpuDriver::FuncSetCacheConfig(
         cufunc, cuda_kernel->GetGpuCacheConfig()));
+    cuda_kernel->MarkCacheConfigApplied();
   }
 
   void** kernel_params = const_cast<void**>(args.argument_addresses().data());
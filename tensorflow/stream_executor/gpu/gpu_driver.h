@@ -409,6 +409,47 @@ class GpuDriver {
   // the stream immediately after this returns).
   static bool IsStreamIdle(GpuContext* context, GpuStreamHandle stream);
 
+  // Starts capturing the operations enqueued onto stream into a graph, via
+  // cuStreamBeginCapture. The operations are not executed until the graph is
+  // instantiated and launched. The capture is relaxed, so that operations
+  // which can't be captured (e.g. lazily creating a library handle) are still
+  // allowed meanwhile.
+  //
+  // https://docs.nvidia.com/cuda/cuda-driver-api/group__CUDA__STREAM.html#group__CUDA__STREAM_1g767167da0bbf07157dc20b6c258a2143
+  static port::Status StreamBeginCapture(GpuContext* context,
+                                         GpuStreamHandle stream);
+
+  // Ends the capture started by StreamBeginCapture on stream and returns the
+  // graph of the operations captured, via cuStreamEndCapture.
+  static port::Status StreamEndCapture(GpuContext* context,
+                                       GpuStreamHandle stream,
+                                       GpuGraphHandle* graph);
+
+  // Creates an executable graph from graph, via cuGraphInstantiate.
+  static port::Status GraphInstantiate(GpuContext* context,
+                                       GpuGraphHandle graph,
+                                       GpuGraphExecHandle* exec);
+
+  // Replaces the parameters of the nodes of exec (e.g. kernel arguments or
+  // memcpy addresses) by those of graph, via cuGraphExecUpdate. Returns false
+  // if exec cannot be updated in place, e.g. because the topology of graph
+  // differs from that exec was instantiated from.
+  //
+  // https://docs.nvidia.com/cuda/cuda-driver-api/group__CUDA__GRAPH.html#group__CUDA__GRAPH_1g96efefc56df46927da7297f122adfb9f
+  static port::StatusOr<bool> GraphExecUpdate(GpuContext* context,
+                                              GpuGraphExecHandle exec,
+                                              GpuGraphHandle graph);
+
+  // Enqueues the execution of exec onto stream, via cuGraphLaunch.
+  static port::Status GraphLaunch(GpuContext* context, GpuGraphExecHandle exec,
+                                  GpuStreamHandle stream);
+
+  // Destroys graph, via cuGraphDestroy.
+  static void DestroyGraph(GpuContext* context, GpuGraphHandle graph);
+
+  // Destroys exec, via cuGraphExecDestroy.
+  static void DestroyGraphExec(GpuContext* context, GpuGraphExecHandle exec);
+
   // Returns whether code in the from context can access memory in the to
   // context via cuDeviceCanAccessPeer.
   // http://docs.nvidia.com/cuda/cuda-driver-api/group__CUDA__PEER__ACCESS.html#group__CUDA__PEER__ACCESS_1g496bdaae1f632ebfb695b99d2c40f19e
@@ -22,6 +22,8 @@ limitations under the License.
 #ifndef TENSORFLOW_STREAM_EXECUTOR_GPU_GPU_KERNEL_H_
 #define TENSORFLOW_STREAM_EXECUTOR_GPU_GPU_KERNEL_H_
 
+#include <atomic>
+
 #include "tensorflow/stream_executor/gpu/gpu_driver.h"
 #include "tensorflow/stream_executor/kernel_cache_config.h"
 #include "tensorflow/stream_executor/platform/logging.h"
@@ -68,6 +70,7 @@ class GpuKernel : public internal::KernelInterface {
   // configuration preference.
   void SetPreferredCacheConfig(KernelCacheConfig config) override {
     preferred_cache_config_ = config;
+    cache_config_applied_.store(false, std::memory_order_relaxed);
   }
 
   // Returns the current kernel cache configuration preference.
@@ -79,12 +82,31 @@ class GpuKernel : public internal::KernelInterface {
   // CUfunc_cache.
   GpuFuncCachePreference GetGpuCacheConfig() const;
 
+  // Returns true if the cache configuration preference still needs to be
+  // applied to the function handle. The preference is a property of the
+  // function, so GpuExecutor::Launch only needs to set it on the first launch
+  // after it changes rather than on every launch. Concurrent launches may both
+  // apply it, which is harmless.
+  bool ShouldApplyCacheConfig() const {
+    return preferred_cache_config_ != KernelCacheConfig::kNoPreference &&
+           !cache_config_applied_.load(std::memory_order_relaxed);
+  }
+
+  // Records that the cache configuration preference was successfully applied
+  // to the function handle. Launches retry until it is.
+  void MarkCacheConfigApplied() const {
+    cache_config_applied_.store(true, std::memory_order_relaxed);
+  }
+
  private:
   GpuFunctionHandle gpu_function_;  // Wrapped CUDA kernel handle.
   unsigned arity_;  // Number of formal parameters the kernel takes.
 
   // Preferred (but not required) cache configuration for this kernel.
   KernelCacheConfig preferred_cache_config_;
+
+  // Whether preferred_cache_config_ has been applied to gpu_function_.
+  mutable std::atomic<bool> cache_config_applied_{false};
 };
 
 // Given a platform-independent kernel datatype, returns the (const) internal
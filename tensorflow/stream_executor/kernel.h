@@ -401,11 +401,14 @@ class KernelArgsArray : public KernelArgsArrayBase {
     static_assert(sizeof(T) <= kMaxGenericArgSize,
                   "Please adjust kMaxGenericArgSize");
     static_assert(std::is_pod<T>::value, "Only pod types supported!");
+    // Slots are kMaxGenericArgSize apart in storage aligned to that size, so
+    // each one is suitably aligned for T without a per-argument check.
+    static_assert(kMaxGenericArgSize % alignof(T) == 0,
+                  "Argument alignment must divide kMaxGenericArgSize");
     char *generic_arg_storage =
         &generic_arguments_[number_of_generic_arguments_++ *
                             kMaxGenericArgSize];
 
-    CHECK_EQ(reinterpret_cast<uintptr_t>(generic_arg_storage) % alignof(T), 0);
     std::memcpy(generic_arg_storage, &arg, sizeof(T));
 
     argument_addresses_[number_of_argument_addresses_] = generic_arg_storage;
@@ -840,6 +840,46 @@ GpuDriver::ContextGetSharedMemConfig(GpuContext* context) {
   return false;
 }
 
+/* static */ port::Status GpuDriver::StreamBeginCapture(
+    GpuContext* context, GpuStreamHandle stream) {
+  return port::Status{
+      port::error::UNIMPLEMENTED,
+      "Feature not supported on ROCm platform (StreamBeginCapture)"};
+}
+
+/* static */ port::Status GpuDriver::StreamEndCapture(GpuContext* context,
+                                                      GpuStreamHandle stream,
+                                                      GpuGraphHandle* graph) {
+  return port::Status{
+      port::error::UNIMPLEMENTED,
+      "Feature not supported on ROCm platform (StreamEndCapture)"};
+}
+
+/* static */ port::Status GpuDriver::GraphInstantiate(
+    GpuContext* context, GpuGraphHandle graph, GpuGraphExecHandle* exec) {
+  return port::Status{
+      port::error::UNIMPLEMENTED,
+      "Feature not supported on ROCm platform (GraphInstantiate)"};
+}
+
+/* static */ port::StatusOr<bool> GpuDriver::GraphExecUpdate(
+    GpuContext* context, GpuGraphExecHandle exec, GpuGraphHandle graph) {
+  return false;
+}
+
+/* static */ port::Status GpuDriver::GraphLaunch(GpuContext* context,
+                                                 GpuGraphExecHandle exec,
+                                                 GpuStreamHandle stream) {
+  return port::Status{port::error::UNIMPLEMENTED,
+                      "Feature not supported on ROCm platform (GraphLaunch)"};
+}
+
+/* static */ void GpuDriver::DestroyGraph(GpuContext* context,
+                                          GpuGraphHandle graph) {}
+
+/* static */ void GpuDriver::DestroyGraphExec(GpuContext* context,
+                                              GpuGraphExecHandle exec) {}
+
 /* static */ port::Status GpuDriver::SynchronousMemcpyD2H(
     GpuContext* context, void* host_dst, hipDeviceptr_t gpu_src,
     uint64_t size) {
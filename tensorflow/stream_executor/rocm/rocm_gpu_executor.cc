@@ -317,10 +317,10 @@ port::Status GpuExecutor::Launch(Stream* stream, const ThreadDim& thread_dims,
     }
   }
 
-  if (rocm_kernel->GetPreferredCacheConfig() !=
-      KernelCacheConfig::kNoPreference) {
+  if (rocm_kernel->ShouldApplyCacheConfig()) {
     TF_RETURN_IF_ERROR(GpuDriver::FuncSetCacheConfig(
         hipfunc, rocm_kernel->GetGpuCacheConfig()));
+    rocm_kernel->MarkCacheConfigApplied();
   }
 
   // prepare kernargs